@@ -40,6 +40,30 @@ void ExecuteCmd::getStatus(unsigned long cmdId, bool &bFinished, std::string &lo
     mutex_.unlock();
 }
 
+bool ExecuteCmd::waitStatus(unsigned long cmdId, unsigned int timeoutMs, bool &bFinished, std::string &outLogChunk)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, cmdId]() {
+        auto it = findCmd(cmdId);
+        return it == executingCmds_.end() || (*it)->bFinished || !(*it)->log.empty();
+    });
+
+    auto it = findCmd(cmdId);
+    if (it == executingCmds_.end())
+    {
+        return false;
+    }
+    bFinished = (*it)->bFinished;
+    outLogChunk.swap((*it)->log);
+    (*it)->log.clear();
+    if (bFinished)
+    {
+        delete (*it);
+        executingCmds_.erase(it);
+    }
+    return true;
+}
+
 void ExecuteCmd::clearCmds()
 {
     mutex_.lock();
@@ -49,6 +73,7 @@ void ExecuteCmd::clearCmds()
     }
     executingCmds_.clear();
     mutex_.unlock();
+    condition_.notify_all();
 }
 
 
@@ -59,57 +84,63 @@ ExecuteCmd::ExecuteCmd() : curCmdId_(0)
 
 void ExecuteCmd::runCmd(unsigned long cmdId, std::string cmd)
 {
-    std::string strReply;
-     
     // run openvpn command
     FILE *file = popen(cmd.c_str(), "r");
     if (file)
     {
+        // the lines are handed to waitStatus() as they come
         char szLine[4096];
         while(fgets(szLine, sizeof(szLine), file) != 0)
         {
-            if (instance().isCmdExist(cmdId))
-            {
-                strReply += szLine;
-            }
+            instance().appendLog(cmdId, szLine);
         }
         pclose(file);
-        instance().cmdFinished(cmdId, true, strReply);
+        instance().cmdFinished(cmdId, true);
     }
     else
     {
-        instance().cmdFinished(cmdId, false, std::string());
+        instance().cmdFinished(cmdId, false);
     }
 }
 
-void ExecuteCmd::cmdFinished(unsigned long cmdId, bool bSuccess, std::string log)
+void ExecuteCmd::cmdFinished(unsigned long cmdId, bool bSuccess)
 {
     mutex_.lock();
-    for (auto it = executingCmds_.begin(); it != executingCmds_.end(); ++it)
+    auto it = findCmd(cmdId);
+    if (it != executingCmds_.end())
     {
-        if ((*it)->cmdId == cmdId)
-        {
-            (*it)->bFinished = true;
-            (*it)->bSuccess = bSuccess;
-            (*it)->log = log;
-            break;
-        }
+        (*it)->bFinished = true;
+        (*it)->bSuccess = bSuccess;
     }
     mutex_.unlock();
+    condition_.notify_all();
 }
 
-bool ExecuteCmd::isCmdExist(unsigned long cmdId)
+bool ExecuteCmd::appendLog(unsigned long cmdId, const char *str)
 {
     mutex_.lock();
-    bool bFound = false;
+    auto it = findCmd(cmdId);
+    bool bFound = (it != executingCmds_.end());
+    if (bFound)
+    {
+        (*it)->log += str;
+    }
+    mutex_.unlock();
+    if (bFound)
+    {
+        condition_.notify_all();
+    }
+    return bFound;
+}
+
+std::list<ExecuteCmd::CmdDescr *>::iterator ExecuteCmd::findCmd(unsigned long cmdId)
+{
     for (auto it = executingCmds_.begin(); it != executingCmds_.end(); ++it)
     {
         if ((*it)->cmdId == cmdId)
         {
-            bFound = true;
-            break;
+            return it;
         }
     }
-    mutex_.unlock();
-    return bFound;
+    return executingCmds_.end();
 }
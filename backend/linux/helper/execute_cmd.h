@@ -5,6 +5,7 @@
 #include <string>
 #include <list>
 #include <mutex>
+#include <condition_variable>
 
 class ExecuteCmd
 {
@@ -17,6 +18,10 @@ public:
     
     unsigned long execute(const char *cmd);
     void getStatus(unsigned long cmdId, bool &bFinished, std::string &log);
+    // waits up to timeoutMs for the command to finish or print something, outLogChunk is the output since
+    // the previous call (the whole output without the chunks already taken when it finished)
+    // returns false if there is no such command
+    bool waitStatus(unsigned long cmdId, unsigned int timeoutMs, bool &bFinished, std::string &outLogChunk);
     void clearCmds();
 
 private:
@@ -25,8 +30,8 @@ private:
     unsigned long curCmdId_;
     
     static void runCmd(unsigned long cmdId, std::string cmd);
-    void cmdFinished(unsigned long cmdId, bool bSuccess, std::string log);
-    bool isCmdExist(unsigned long cmdId);
+    void cmdFinished(unsigned long cmdId, bool bSuccess);
+    bool appendLog(unsigned long cmdId, const char *str);
     
     struct CmdDescr
     {
@@ -37,7 +42,9 @@ private:
     };
     
     std::list<CmdDescr *> executingCmds_;
+    std::list<CmdDescr *>::iterator findCmd(unsigned long cmdId);
     std::mutex mutex_;
+    std::condition_variable condition_;     // a command printed something or finished
 };
 
 #endif /* defined(____ExecuteCmd__) */
@@ -13,6 +13,8 @@ LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_serialization.a
 LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_thread.a
 LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_filesystem.a
 LIBS += -L$$BUILD_LIBS_PATH/openssl/lib -lssl -lcrypto
+# libsystemd (sd-bus) is loaded at runtime
+LIBS += -ldl
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -34,11 +36,13 @@ SOURCES += \
         ipc/helper_security.cpp \
         logger.cpp \
         main.cpp \
+        resolved_dbus.cpp \
         server.cpp \
         utils.cpp \
         wireguard/wireguardadapter.cpp \
         wireguard/wireguardcommunicator.cpp \
-        wireguard/wireguardcontroller.cpp
+        wireguard/wireguardcontroller.cpp \
+        worker_pool.cpp
 
 HEADERS += \
     ../../../common/utils/executable_signature/executable_signature.h \
@@ -49,8 +53,10 @@ HEADERS += \
     execute_cmd.h \
     ipc/helper_security.h \
     logger.h \
+    resolved_dbus.h \
     server.h \
     utils.h \
     wireguard/wireguardadapter.h \
     wireguard/wireguardcommunicator.h \
-    wireguard/wireguardcontroller.h
+    wireguard/wireguardcontroller.h \
+    worker_pool.h
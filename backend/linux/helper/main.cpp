@@ -29,6 +29,10 @@ int main(int argc, const char *argv[])
 
     // restore firewall setting on OS reboot, if there are saved rules on /etc/windscribe dir
 
+    if (Utils::isFileExists("/etc/windscribe/rules.nft"))
+    {
+        Utils::executeCommand("nft -f /etc/windscribe/rules.nft");
+    }
     if (Utils::isFileExists("/etc/windscribe/rules.v4"))
     {
         Utils::executeCommand("iptables-restore -n < /etc/windscribe/rules.v4");
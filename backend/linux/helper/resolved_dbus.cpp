@@ -0,0 +1,213 @@
+#include "resolved_dbus.h"
+#include "logger.h"
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#include <string.h>
+#include <sys/socket.h>
+
+namespace
+{
+
+const char *DBUS_DEST = "org.freedesktop.resolve1";
+const char *DBUS_NODE = "/org/freedesktop/resolve1";
+const char *DBUS_INTERFACE = "org.freedesktop.resolve1.Manager";
+
+// the layout of sd_bus_error from sd-bus.h, the rest of sd-bus is opaque
+struct sd_bus_error
+{
+    const char *name;
+    const char *message;
+    int _need_free;
+};
+
+struct sd_bus;
+struct sd_bus_message;
+
+template<typename T>
+bool resolveSymbol(void *handle, T &func, const char *name)
+{
+    func = reinterpret_cast<T>(dlsym(handle, name));
+    return func != nullptr;
+}
+
+}
+
+struct ResolvedDbus::SdBus
+{
+    void *handle = nullptr;
+    int (*open_system)(sd_bus **bus) = nullptr;
+    sd_bus *(*bus_unref)(sd_bus *bus) = nullptr;
+    int (*new_method_call)(sd_bus *bus, sd_bus_message **m, const char *destination, const char *path,
+                           const char *interface, const char *member) = nullptr;
+    int (*append)(sd_bus_message *m, const char *types, ...) = nullptr;
+    int (*append_array)(sd_bus_message *m, char type, const void *ptr, size_t size) = nullptr;
+    int (*open_container)(sd_bus_message *m, char type, const char *contents) = nullptr;
+    int (*close_container)(sd_bus_message *m) = nullptr;
+    int (*call)(sd_bus *bus, sd_bus_message *m, uint64_t usec, sd_bus_error *ret_error, sd_bus_message **reply) = nullptr;
+    sd_bus_message *(*message_unref)(sd_bus_message *m) = nullptr;
+    void (*error_free)(sd_bus_error *e) = nullptr;
+
+    // the answers cached before the change would still be served for the old servers
+    void flushCaches(sd_bus *bus)
+    {
+        sd_bus_message *m = nullptr;
+        sd_bus_error error = { nullptr, nullptr, 0 };
+        int r = new_method_call(bus, &m, DBUS_DEST, DBUS_NODE, DBUS_INTERFACE, "FlushCaches");
+        if (r >= 0) r = call(bus, m, 0, &error, nullptr);
+        if (r < 0)
+            Logger::instance().out("ResolvedDbus: FlushCaches failed: %s", error.message ? error.message : strerror(-r));
+        error_free(&error);
+        message_unref(m);
+    }
+};
+
+ResolvedDbus::ResolvedDbus() : sdBus_(nullptr)
+{
+}
+
+ResolvedDbus::~ResolvedDbus()
+{
+    if (sdBus_)
+    {
+        if (sdBus_->handle)
+            dlclose(sdBus_->handle);
+        delete sdBus_;
+    }
+}
+
+bool ResolvedDbus::load()
+{
+    if (sdBus_)
+        return sdBus_->handle != nullptr;
+
+    // tried once
+    sdBus_ = new SdBus();
+    void *handle = dlopen("libsystemd.so.0", RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        Logger::instance().out("ResolvedDbus: libsystemd not loaded: %s", dlerror());
+        return false;
+    }
+
+    const bool isOk = resolveSymbol(handle, sdBus_->open_system, "sd_bus_open_system")
+        && resolveSymbol(handle, sdBus_->bus_unref, "sd_bus_unref")
+        && resolveSymbol(handle, sdBus_->new_method_call, "sd_bus_message_new_method_call")
+        && resolveSymbol(handle, sdBus_->append, "sd_bus_message_append")
+        && resolveSymbol(handle, sdBus_->append_array, "sd_bus_message_append_array")
+        && resolveSymbol(handle, sdBus_->open_container, "sd_bus_message_open_container")
+        && resolveSymbol(handle, sdBus_->close_container, "sd_bus_message_close_container")
+        && resolveSymbol(handle, sdBus_->call, "sd_bus_call")
+        && resolveSymbol(handle, sdBus_->message_unref, "sd_bus_message_unref")
+        && resolveSymbol(handle, sdBus_->error_free, "sd_bus_error_free");
+    if (!isOk)
+    {
+        Logger::instance().out("ResolvedDbus: libsystemd has no sd-bus");
+        dlclose(handle);
+        return false;
+    }
+    sdBus_->handle = handle;
+    return true;
+}
+
+bool ResolvedDbus::setLinkDns(int ifIndex, const std::vector<std::string> &dnsServers)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!load())
+        return false;
+
+    sd_bus *bus = nullptr;
+    if (sdBus_->open_system(&bus) < 0)
+    {
+        Logger::instance().out("ResolvedDbus: can't connect to the system bus");
+        return false;
+    }
+
+    bool bRet = true;
+    sd_bus_message *m = nullptr;
+    sd_bus_error error = { nullptr, nullptr, 0 };
+
+    // SetLinkDNS(ia(iay))
+    int r = sdBus_->new_method_call(bus, &m, DBUS_DEST, DBUS_NODE, DBUS_INTERFACE, "SetLinkDNS");
+    if (r >= 0) r = sdBus_->append(m, "i", ifIndex);
+    if (r >= 0) r = sdBus_->open_container(m, 'a', "(iay)");
+    for (size_t i = 0; r >= 0 && i < dnsServers.size(); ++i)
+    {
+        unsigned char addr[16];
+        int family = AF_INET;
+        size_t size = 4;
+        if (inet_pton(AF_INET, dnsServers[i].c_str(), addr) != 1)
+        {
+            family = AF_INET6;
+            size = 16;
+            if (inet_pton(AF_INET6, dnsServers[i].c_str(), addr) != 1)
+            {
+                Logger::instance().out("ResolvedDbus: not an IP address: %s", dnsServers[i].c_str());
+                r = -1;
+                break;
+            }
+        }
+        r = sdBus_->open_container(m, 'r', "iay");
+        if (r >= 0) r = sdBus_->append(m, "i", family);
+        if (r >= 0) r = sdBus_->append_array(m, 'y', addr, size);
+        if (r >= 0) r = sdBus_->close_container(m);
+    }
+    if (r >= 0) r = sdBus_->close_container(m);
+    if (r >= 0) r = sdBus_->call(bus, m, 0, &error, nullptr);
+    if (r < 0)
+    {
+        Logger::instance().out("ResolvedDbus: SetLinkDNS failed: %s", error.message ? error.message : strerror(-r));
+        bRet = false;
+    }
+    sdBus_->error_free(&error);
+    sdBus_->message_unref(m);
+    m = nullptr;
+
+    // SetLinkDomains(ia(sb)), the routing domain "." as "dhcp-option DOMAIN-ROUTE ." for the script
+    if (bRet)
+    {
+        r = sdBus_->new_method_call(bus, &m, DBUS_DEST, DBUS_NODE, DBUS_INTERFACE, "SetLinkDomains");
+        if (r >= 0) r = sdBus_->append(m, "i", ifIndex);
+        if (r >= 0) r = sdBus_->append(m, "a(sb)", 1, ".", 1);
+        if (r >= 0) r = sdBus_->call(bus, m, 0, &error, nullptr);
+        if (r < 0)
+        {
+            Logger::instance().out("ResolvedDbus: SetLinkDomains failed: %s", error.message ? error.message : strerror(-r));
+            bRet = false;
+        }
+        sdBus_->error_free(&error);
+        sdBus_->message_unref(m);
+    }
+    if (bRet)
+        sdBus_->flushCaches(bus);
+
+    sdBus_->bus_unref(bus);
+    return bRet;
+}
+
+bool ResolvedDbus::revertLink(int ifIndex)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!load())
+        return false;
+
+    sd_bus *bus = nullptr;
+    if (sdBus_->open_system(&bus) < 0)
+    {
+        Logger::instance().out("ResolvedDbus: can't connect to the system bus");
+        return false;
+    }
+
+    sd_bus_message *m = nullptr;
+    sd_bus_error error = { nullptr, nullptr, 0 };
+    int r = sdBus_->new_method_call(bus, &m, DBUS_DEST, DBUS_NODE, DBUS_INTERFACE, "RevertLink");
+    if (r >= 0) r = sdBus_->append(m, "i", ifIndex);
+    if (r >= 0) r = sdBus_->call(bus, m, 0, &error, nullptr);
+    if (r < 0)
+        Logger::instance().out("ResolvedDbus: RevertLink failed: %s", error.message ? error.message : strerror(-r));
+    sdBus_->error_free(&error);
+    sdBus_->message_unref(m);
+    if (r >= 0)
+        sdBus_->flushCaches(bus);
+    sdBus_->bus_unref(bus);
+    return r >= 0;
+}
@@ -0,0 +1,37 @@
+#ifndef ResolvedDbus_h
+#define ResolvedDbus_h
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The link DNS of systemd-resolved set directly over D-Bus (org.freedesktop.resolve1), as the update-systemd-resolved
+// script does with busctl, without the shell and the processes. libsystemd (sd-bus) is loaded at runtime, the calls
+// fail if it or the resolved service is not there and the callers fall back to the script.
+class ResolvedDbus
+{
+public:
+    static ResolvedDbus &instance()
+    {
+        static ResolvedDbus i;
+        return i;
+    }
+
+    // the servers (IPv4 or IPv6) for the link and "." as its routing domain, so all the queries go to them
+    bool setLinkDns(int ifIndex, const std::vector<std::string> &dnsServers);
+    bool revertLink(int ifIndex);
+
+private:
+    ResolvedDbus();
+    ~ResolvedDbus();
+    ResolvedDbus(const ResolvedDbus &) = delete;
+    ResolvedDbus &operator=(const ResolvedDbus &) = delete;
+
+    struct SdBus;
+    std::mutex mutex_;
+    SdBus *sdBus_;
+
+    bool load();
+};
+
+#endif // ResolvedDbus_h
@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <string>
+#include <algorithm>
 
 #include <boost/bind.hpp>
 #include <boost/archive/text_oarchive.hpp>
@@ -23,15 +24,23 @@
 
 #define SOCK_PATH "/var/run/windscribe_helper_socket2"
 
-Server::Server()
+Server::Server() : workerPool_(WORKER_THREADS_COUNT), isWaitStopped_(false)
 {
     acceptor_ = NULL;
     //files_ = NULL;
+    waitThread_ = std::thread(&Server::waitThread, this);
 }
 
 Server::~Server()
 {
     service_.stop();
+
+    {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        isWaitStopped_ = true;
+    }
+    waitCondition_.notify_all();
+    waitThread_.join();
     
     if (acceptor_)
     {
@@ -46,16 +55,24 @@ Server::~Server()
     unlink(SOCK_PATH);
 }
 
-bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer)
+Server::HANDLE_RESULT Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, bool isSession, unsigned int &outRequestId,
+                                                   int &outCmdId, CMD_ANSWER &outCmdAnswer, std::string &outShellCmd,
+                                                   CMD_WAIT_CMD_STATUS &outWaitCmd)
 {
+    const size_t requestIdSize = isSession ? sizeof(outRequestId) : 0;
     // not enough data for read command
-    if (buf->size() < sizeof(int)*3)
+    if (buf->size() < requestIdSize + sizeof(int)*3)
     {
-        return false;
+        return HANDLE_NEED_MORE_DATA;
     }
     
     const char *bufPtr = boost::asio::buffer_cast<const char*>(buf->data());
     size_t headerSize = 0;
+    if (isSession)
+    {
+        memcpy(&outRequestId, bufPtr, sizeof(outRequestId));
+        headerSize += sizeof(outRequestId);
+    }
     int cmdId;
     memcpy(&cmdId, bufPtr + headerSize, sizeof(cmdId));
     headerSize += sizeof(cmdId);
@@ -69,7 +86,7 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
     // not enough data for read command
     if (buf->size() < (headerSize + length))
     {
-        return false;
+        return HANDLE_NEED_MORE_DATA;
     }
 
     struct ucred peerCred;
@@ -79,13 +96,13 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
     if ((retCode != 0) || (lenPeerCred != sizeof(peerCred)))
     {
         Logger::instance().out("getsockopt(SO_PEERCRED) failed (%d).", errno);
-        return false;
+        return HANDLE_NEED_MORE_DATA;
     }
 
     // check process id
     if (!HelperSecurity::instance().verifyProcessId(peerCred.pid))
     {
-        return false;
+        return HANDLE_NEED_MORE_DATA;
     }
 
     std::vector<char> vector(length);
@@ -93,31 +110,21 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
     std::string str(vector.begin(), vector.end());
     std::istringstream stream(str);
     boost::archive::text_iarchive ia(stream, boost::archive::no_header);
+    buf->consume(headerSize + length);
+    outCmdId = cmdId;
     
-    if (cmdId == HELPER_CMD_EXECUTE)
+    if (cmdId == HELPER_CMD_OPEN_SESSION)
+    {
+        outCmdAnswer.executed = isSession ? 0 : 1;
+    }
+    else if (cmdId == HELPER_CMD_EXECUTE)
     {
         CMD_EXECUTE cmdExecute;
         ia >> cmdExecute;
-        
-        std::string strReply;
-        
-        FILE *file = popen(cmdExecute.cmdline.c_str(), "r");
-        if (file)
-        {
-            char szLine[4096];
-            while(fgets(szLine, sizeof(szLine), file) != 0)
-            {
-                strReply += szLine;
-            }
-            retCode = pclose(file);
-            outCmdAnswer.exitCode = WEXITSTATUS(retCode);
-            outCmdAnswer.executed = 1;
-            outCmdAnswer.body = strReply;
-        }
-        else
-        {
-            outCmdAnswer.executed = 0;
-        }
+
+        // answered when the command finishes on the worker pool
+        outShellCmd = cmdExecute.cmdline;
+        return HANDLE_EXECUTE_SHELL_CMD;
     }
     else if (cmdId == HELPER_CMD_EXECUTE_OPENVPN)
     {
@@ -147,6 +154,11 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
             outCmdAnswer.executed = 2;
         }
     }
+    else if (cmdId == HELPER_CMD_WAIT_CMD_STATUS)
+    {
+        ia >> outWaitCmd;
+        return HANDLE_WAIT_CMD_STATUS;
+    }
     else if (cmdId == HELPER_CMD_CLEAR_CMDS)
     {
         CMD_CLEAR_CMDS cmd;
@@ -301,44 +313,153 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
         }*/
     }
 
-    buf->consume(headerSize + length);
+    return HANDLE_ANSWERED;
+}
 
-    return true;
+void Server::startRead(connection_ptr connection)
+{
+    if (!connection->isReading && !connection->isClosed)
+    {
+        connection->isReading = true;
+        boost::asio::async_read(*connection->sock, connection->buf, boost::asio::transfer_at_least(1),
+                                connection->strand.wrap(boost::bind(&Server::receiveCmdHandle, this, connection, _1, _2)));
+    }
 }
 
-void Server::receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, const boost::system::error_code& ec, std::size_t bytes_transferred)
+void Server::receiveCmdHandle(connection_ptr connection, const boost::system::error_code& ec, std::size_t bytes_transferred)
 {
     UNUSED(bytes_transferred);
 
+    connection->isReading = false;
     if (!ec.value())
     {
-        // read and handle commands
-        while (true)
+        handleCommands(connection);
+    }
+    else
+    {
+        closeConnection(connection);
+    }
+}
+
+void Server::handleCommands(connection_ptr connection)
+{
+    // read and handle commands, the ones after a running shell command wait for its answer
+    while (!connection->isExecuting && !connection->isClosed)
+    {
+        CMD_ANSWER cmdAnswer;
+        std::string shellCmd;
+        CMD_WAIT_CMD_STATUS waitCmd;
+        unsigned int requestId = 0;
+        int cmdId = -1;
+        HANDLE_RESULT result = readAndHandleCommand(connection->sock, &connection->buf, connection->isSession, requestId, cmdId,
+                                                    cmdAnswer, shellCmd, waitCmd);
+        if (result == HANDLE_NEED_MORE_DATA)
         {
-            CMD_ANSWER cmdAnswer;
-            if (!readAndHandleCommand(sock, buf.get(), cmdAnswer))
-            {
-                // goto receive next commands
-                boost::asio::async_read(*sock, *buf, boost::asio::transfer_at_least(1),
-                                        boost::bind(&Server::receiveCmdHandle, this, sock, buf, _1, _2));
-                break;
-            }
-            else
-            {
-                if (!sendAnswerCmd(sock, cmdAnswer))
+            break;
+        }
+        else if (result == HANDLE_EXECUTE_SHELL_CMD)
+        {
+            connection->isExecuting = true;
+            connection->executingRequestId = requestId;
+            connection->executingTaskId = workerPool_.execute(shellCmd,
+                [this, connection](bool bExecuted, int exitCode, const std::string &output)
                 {
-                    Logger::instance().out("client app disconnected");
-                    HelperSecurity::instance().reset();
-                    return;
-                }
+                    CMD_ANSWER cmdAnswer;
+                    cmdAnswer.executed = bExecuted ? 1 : 0;
+                    cmdAnswer.exitCode = exitCode;
+                    cmdAnswer.body = output;
+                    connection->strand.post(boost::bind(&Server::shellCmdExecuted, this, connection, cmdAnswer));
+                });
+        }
+        else if (result == HANDLE_WAIT_CMD_STATUS)
+        {
+            // answered the same way as a shell command, from waitThread_
+            connection->isExecuting = true;
+            connection->executingRequestId = requestId;
+            connection->executingTaskId = 0;
+            queueCmdStatusWait(connection, waitCmd.cmdId, std::min(waitCmd.timeoutMs, (unsigned int)MAX_WAIT_CMD_STATUS_MS));
+        }
+        else if (!sendAnswerCmd(connection->sock, connection->isSession, requestId, cmdAnswer))
+        {
+            closeConnection(connection);
+            return;
+        }
+        else if (cmdId == HELPER_CMD_OPEN_SESSION && cmdAnswer.executed == 1)
+        {
+            connection->isSession = true;
+        }
+    }
+    // goto receive next commands
+    startRead(connection);
+}
+
+void Server::shellCmdExecuted(connection_ptr connection, const CMD_ANSWER &cmdAnswer)
+{
+    connection->isExecuting = false;
+    if (connection->isClosed)
+    {
+        return;
+    }
+    if (!sendAnswerCmd(connection->sock, connection->isSession, connection->executingRequestId, cmdAnswer))
+    {
+        closeConnection(connection);
+        return;
+    }
+    handleCommands(connection);
+}
+
+void Server::queueCmdStatusWait(connection_ptr connection, unsigned long cmdId, unsigned int timeoutMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        waitQueue_.push_back({ connection, cmdId, timeoutMs });
+    }
+    waitCondition_.notify_one();
+}
+
+void Server::waitThread()
+{
+    while (true)
+    {
+        CmdStatusWait wait;
+        {
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            waitCondition_.wait(lock, [this] { return isWaitStopped_ || !waitQueue_.empty(); });
+            if (isWaitStopped_)
+            {
+                return;
             }
+            wait = waitQueue_.front();
+            waitQueue_.pop_front();
         }
+
+        CMD_ANSWER cmdAnswer;
+        bool bFinished = false;
+        // a command which doesn't exist (cleared) is over too
+        if (!ExecuteCmd::instance().waitStatus(wait.cmdId, wait.timeoutMs, bFinished, cmdAnswer.body))
+        {
+            bFinished = true;
+        }
+        cmdAnswer.executed = bFinished ? 1 : 2;
+        wait.connection->strand.post(boost::bind(&Server::shellCmdExecuted, this, wait.connection, cmdAnswer));
     }
-    else
+}
+
+void Server::closeConnection(connection_ptr connection)
+{
+    if (connection->isClosed)
     {
-        Logger::instance().out("client app disconnected");
-        HelperSecurity::instance().reset();
+        return;
     }
+    connection->isClosed = true;
+    Logger::instance().out("client app disconnected");
+    HelperSecurity::instance().reset();
+    if (connection->isExecuting && connection->executingTaskId != 0)
+    {
+        workerPool_.cancel(connection->executingTaskId);
+    }
+    boost::system::error_code ec;
+    connection->sock->close(ec);
 }
 
 void Server::acceptHandler(const boost::system::error_code & ec, socket_ptr sock)
@@ -348,9 +469,8 @@ void Server::acceptHandler(const boost::system::error_code & ec, socket_ptr sock
         Logger::instance().out("client app connected");
                 
         HelperSecurity::instance().reset();
-        boost::shared_ptr<boost::asio::streambuf> buf(new boost::asio::streambuf);
-        boost::asio::async_read(*sock, *buf, boost::asio::transfer_at_least(1),
-                                    boost::bind(&Server::receiveCmdHandle, this, sock, buf, _1, _2));
+        connection_ptr connection(new Connection(sock, service_));
+        connection->strand.post(boost::bind(&Server::startRead, this, connection));
     }
     
     startAccept();
@@ -367,7 +487,7 @@ void Server::runService()
     service_.run();
 }
 
-bool Server::sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer)
+bool Server::sendAnswerCmd(socket_ptr sock, bool isSession, unsigned int requestId, const CMD_ANSWER &cmdAnswer)
 {
     std::stringstream stream;
     boost::archive::text_oarchive oa(stream, boost::archive::no_header);
@@ -376,6 +496,14 @@ bool Server::sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer)
     int length = (int)str.length();
     // send answer to client
     boost::system::error_code er;
+    if (isSession)
+    {
+        boost::asio::write(*sock, boost::asio::buffer(&requestId, sizeof(requestId)), boost::asio::transfer_exactly(sizeof(requestId)), er);
+        if (er.value())
+        {
+            return false;
+        }
+    }
     boost::asio::write(*sock, boost::asio::buffer(&length, sizeof(length)), boost::asio::transfer_exactly(sizeof(length)), er);
     if (er.value())
     {
@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <vector>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <list>
@@ -12,6 +14,7 @@
 #include "../../posix_common/helper_commands.h"
 #include "wireguard/wireguardadapter.h"
 #include "wireguard/wireguardcontroller.h"
+#include "worker_pool.h"
 
 
 typedef boost::shared_ptr<boost::asio::local::stream_protocol::socket> socket_ptr;
@@ -31,15 +34,64 @@ private:
     boost::asio::local::stream_protocol::acceptor *acceptor_;
     
     //Files *files_;
-   
-    bool readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer);
+
+    enum { WORKER_THREADS_COUNT = 4 };
+    WorkerPool workerPool_;
+
+    // The commands of a connection are answered in order. A shell command runs on workerPool_ (a wait for an unblocking
+    // command on waitThread_, executingTaskId is 0), meanwhile the socket is still read (the following commands
+    // wait in the buffer) and a disconnect cancels the command.
+    // After HELPER_CMD_OPEN_SESSION (isSession) the commands and the answers are prefixed with the request ids.
+    struct Connection
+    {
+        socket_ptr sock;
+        boost::asio::streambuf buf;
+        boost::asio::io_service::strand strand;
+        bool isReading;
+        bool isExecuting;
+        unsigned long executingTaskId;
+        unsigned int executingRequestId;
+        bool isClosed;
+        bool isSession;
+
+        Connection(socket_ptr s, boost::asio::io_service &service) : sock(s), strand(service),
+            isReading(false), isExecuting(false), executingTaskId(0), executingRequestId(0), isClosed(false), isSession(false) {}
+    };
+    typedef boost::shared_ptr<Connection> connection_ptr;
+
+    // the longest HELPER_CMD_WAIT_CMD_STATUS, the client asks again after it; short because the waits of all
+    // the connections are served one by one on waitThread_
+    enum { MAX_WAIT_CMD_STATUS_MS = 500 };
+
+    struct CmdStatusWait
+    {
+        connection_ptr connection;
+        unsigned long cmdId;
+        unsigned int timeoutMs;
+    };
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+    std::list<CmdStatusWait> waitQueue_;
+    bool isWaitStopped_;
+    std::thread waitThread_;
+
+    enum HANDLE_RESULT { HANDLE_NEED_MORE_DATA, HANDLE_ANSWERED, HANDLE_EXECUTE_SHELL_CMD, HANDLE_WAIT_CMD_STATUS };
+    HANDLE_RESULT readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, bool isSession, unsigned int &outRequestId,
+                                       int &outCmdId, CMD_ANSWER &outCmdAnswer, std::string &outShellCmd,
+                                       CMD_WAIT_CMD_STATUS &outWaitCmd);
     
-    void receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, const boost::system::error_code& ec, std::size_t bytes_transferred);
+    void startRead(connection_ptr connection);
+    void receiveCmdHandle(connection_ptr connection, const boost::system::error_code& ec, std::size_t bytes_transferred);
+    void handleCommands(connection_ptr connection);
+    void shellCmdExecuted(connection_ptr connection, const CMD_ANSWER &cmdAnswer);
+    void queueCmdStatusWait(connection_ptr connection, unsigned long cmdId, unsigned int timeoutMs);
+    void waitThread();
+    void closeConnection(connection_ptr connection);
     void acceptHandler(const boost::system::error_code & ec, socket_ptr sock);
     void startAccept();
     void runService();
     
-    bool sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer);
+    bool sendAnswerCmd(socket_ptr sock, bool isSession, unsigned int requestId, const CMD_ANSWER &cmdAnswer);
 };
 
 #endif /* defined(____Server__) */
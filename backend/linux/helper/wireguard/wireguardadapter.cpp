@@ -3,10 +3,12 @@
 #include "execute_cmd.h"
 #include "utils.h"
 #include "logger.h"
+#include "resolved_dbus.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <net/if.h>
 #include <sstream>
 
 namespace
@@ -30,7 +32,7 @@ bool RunBlockingCommands(const std::vector<std::string> &cmdlist)
 }
 
 WireGuardAdapter::WireGuardAdapter(const std::string &name)
-    : name_(name), is_dns_server_set_(false), has_default_route_(false), fwmark_(0)
+    : name_(name), is_dns_server_set_(false), dns_dbus_if_index_(0), has_default_route_(false), fwmark_(0)
 {
     comment_ = "\"Windscribe daemon rule for " + name_ + "\"";
 }
@@ -63,6 +65,24 @@ bool WireGuardAdapter::setDnsServers(const std::string &addressList, const std::
                          + dns_servers_list[i] + "\" ");
     }
     is_dns_server_set_ = true;
+
+    // systemd-resolved is set with the D-Bus calls of the script, but without the shell and busctl processes;
+    // the script is the fallback (and the only way for the other DNS managers)
+    dns_dbus_if_index_ = 0;
+    if (boost::algorithm::ends_with(dns_script_name_, "/update-systemd-resolved")) {
+        std::vector<std::string> servers;
+        for (const auto &server : dns_servers_list) {
+            if (!server.empty())
+                servers.push_back(server);
+        }
+        const int ifIndex = if_nametoindex(getName().c_str());
+        if (ifIndex > 0 && ResolvedDbus::instance().setLinkDns(ifIndex, servers)) {
+            dns_dbus_if_index_ = ifIndex;
+            return runDnsLeakProtect("up " + getName());
+        }
+        Logger::instance().out("Failed to set DNS over D-Bus, running the script");
+    }
+
     std::vector<std::string> cmdlist;
     if (access(dns_script_name_.c_str(), X_OK) != 0)
         cmdlist.push_back("chmod +x \"" + dns_script_name_ + "\"");
@@ -169,6 +189,11 @@ bool WireGuardAdapter::flushDnsServer()
     if (!is_dns_server_set_)
         return true;
     is_dns_server_set_ = false;
+    if (dns_dbus_if_index_ > 0) {
+        ResolvedDbus::instance().revertLink(dns_dbus_if_index_);
+        dns_dbus_if_index_ = 0;
+        return runDnsLeakProtect("down");
+    }
     std::vector<std::string> cmdlist;
     if (access(dns_script_name_.c_str(), X_OK) != 0)
         cmdlist.push_back("chmod +x \"" + dns_script_name_ + "\"");
@@ -176,6 +201,18 @@ bool WireGuardAdapter::flushDnsServer()
     return RunBlockingCommands(cmdlist);
 }
 
+bool WireGuardAdapter::runDnsLeakProtect(const std::string &args)
+{
+    // the part of the script after the D-Bus calls, it is next to the script
+    const std::string dir = dns_script_name_.substr(0, dns_script_name_.find_last_of('/'));
+    const std::string script = dir + "/dns-leak-protect";
+    std::vector<std::string> cmdlist;
+    if (access(script.c_str(), X_OK) != 0)
+        cmdlist.push_back("chmod +x \"" + script + "\"");
+    cmdlist.push_back("\"" + script + "\" " + args);
+    return RunBlockingCommands(cmdlist);
+}
+
 bool WireGuardAdapter::addFirewallRules(const std::string &ipAddress, uint32_t fwmark)
 {
     Utils::executeCommand("sysctl -q net.ipv4.conf.all.src_valid_mark=1");
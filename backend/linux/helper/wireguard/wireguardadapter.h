@@ -22,12 +22,14 @@ public:
 
 private:
     bool flushDnsServer();
+    bool runDnsLeakProtect(const std::string &args);
 
     std::string name_;
     std::string comment_;
     std::string dns_script_name_;
     bool is_dns_server_set_;
     std::string dns_script_command_;
+    int dns_dbus_if_index_;    // the link set over D-Bus instead of the script, 0 if not
     bool has_default_route_;
 
     std::vector<std::string> allowedIps_;
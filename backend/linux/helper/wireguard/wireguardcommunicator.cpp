@@ -2,9 +2,10 @@
 #include "../../../posix_common/helper_commands.h"
 #include "utils.h"
 #include "logger.h"
-#include <regex>
+#include <algorithm>
+#include <cassert>
+#include <sstream>
 #include <type_traits>
-#include <boost/algorithm/string/trim.hpp>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/un.h>
@@ -30,7 +31,7 @@ stringToValue(const std::string &str)
 }  // namespace
 
 WireGuardCommunicator::Connection::Connection(const std::string &deviceName)
-    : status_(Status::NO_ACCESS), socketHandle_(-1), fileHandle_(nullptr)
+    : status_(Status::NO_ACCESS), socketHandle_(-1)
 {
     struct sockaddr_un addr;
     addr.sun_family = AF_UNIX;
@@ -45,53 +46,52 @@ WireGuardCommunicator::Connection::Connection(const std::string &deviceName)
     } while (attempt < CONNECTION_ATTEMPT_COUNT);
     if (socketHandle_ == -1)
         return;
-    fileHandle_ = fdopen(socketHandle_, "r+");
-    if (!fileHandle_) {
-        if (socketHandle_ >= 0) {
-            close(socketHandle_);
-            socketHandle_ = -1;
-        }
-        return;
-    }
     status_ = Status::OK;
 }
 
 WireGuardCommunicator::Connection::~Connection()
 {
-    if (fileHandle_)
-        fclose(fileHandle_);
     if (socketHandle_ >= 0)
         close(socketHandle_);
 }
 
-bool WireGuardCommunicator::Connection::getOutput(ResultMap *results_map) const
+bool WireGuardCommunicator::Connection::transact(const std::string &request, ResultList *results)
 {
-    if (!fileHandle_)
+    if (socketHandle_ < 0)
         return false;
-    std::string output;
-    output.reserve(1024);
-    for (;;) {
-        auto c = static_cast<char>(fgetc(fileHandle_));
-        if (c < 0)
-            break;
-        output.push_back(c);
+
+    for (size_t sent = 0; sent < request.size();) {
+        const auto ret = send(socketHandle_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        sent += static_cast<size_t>(ret);
     }
-    boost::trim(output);
-    if (output.empty())
-        return false;
-    if (results_map && !results_map->empty()) {
-        std::regex output_rx("(^|\n)(\\w+)=(\\w+)(?=\n|$)");
-        std::sregex_iterator it(output.begin(), output.end(), output_rx), end;
-        for (; it != end; ++it) {
-            if (it->size() != 4)
+
+    // the response is "key=value" lines terminated by an empty line
+    std::string line;
+    char buf[4096];
+    for (;;) {
+        const auto ret = recv(socketHandle_, buf, sizeof(buf), 0);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        for (ssize_t i = 0; i < ret; ++i) {
+            if (buf[i] != '\n') {
+                line.push_back(buf[i]);
                 continue;
-            const auto &match = *it;
-            auto mapitem = results_map->find(match[2].str());
-            if (mapitem != results_map->end())
-                mapitem->second = match[3].str();
+            }
+            if (line.empty())
+                return true;
+            const auto pos = line.find('=');
+            if (results && pos != std::string::npos)
+                results->emplace_back(line.substr(0, pos), line.substr(pos + 1));
+            line.clear();
         }
     }
-    return true;
 }
 
 bool WireGuardCommunicator::Connection::connect(struct sockaddr_un *address)
@@ -136,80 +136,110 @@ bool WireGuardCommunicator::Connection::connect(struct sockaddr_un *address)
 void WireGuardCommunicator::setDeviceName(const std::string &deviceName)
 {
     assert(!deviceName.empty());
+    std::lock_guard<std::mutex> lock(mutex_);
     deviceName_ = deviceName;
+    connection_.reset();
+}
+
+bool WireGuardCommunicator::transact(const std::string &request,
+    Connection::ResultList *results, Connection::Status *status)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the daemons before UAPI pipelining close the connection after each request, reconnect once then
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!connection_)
+            connection_.reset(new Connection(deviceName_));
+        *status = connection_->getStatus();
+        if (*status != Connection::Status::OK) {
+            connection_.reset();
+            return false;
+        }
+        if (results)
+            results->clear();
+        if (connection_->transact(request, results))
+            return true;
+        connection_.reset();
+    }
+    return false;
+}
+
+void WireGuardCommunicator::resetConnection()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    connection_.reset();
 }
 
 bool WireGuardCommunicator::configure(const std::string &clientPrivateKey,
     const std::string &peerPublicKey, const std::string &peerPresharedKey,
     const std::string &peerEndpoint, const std::vector<std::string> &allowedIps, uint32_t fwmark)
 {
-    Connection connection(deviceName_);
-    if (connection.getStatus() != Connection::Status::OK) {
+    // Build set command.
+    std::ostringstream request;
+    request << "set=1\n"
+            << "fwmark=" << fwmark << "\n"
+            << "private_key=" << clientPrivateKey << "\n"
+            << "replace_peers=true\n"
+            << "public_key=" << peerPublicKey << "\n"
+            << "endpoint=" << peerEndpoint << "\n"
+            << "persistent_keepalive_interval=0\n";
+    if (!peerPresharedKey.empty())
+        request << "preshared_key=" << peerPresharedKey << "\n";
+    request << "replace_allowed_ips=true\n";
+    for (const auto &ip : allowedIps)
+        request << "allowed_ip=" << ip << "\n";
+    request << "\n";
+
+    Connection::ResultList results;
+    Connection::Status status;
+    if (!transact(request.str(), &results, &status)) {
         Logger::instance().out("WireGuardCommunicator::configure(): no connection to daemon");
         return false;
     }
 
-    // Send set command.
-    fputs("set=1\n", connection);
-    fprintf(connection,
-        "fwmark=%u\n"
-        "private_key=%s\n"
-        "replace_peers=true\n"
-        "public_key=%s\n"
-        "endpoint=%s\n"
-        "persistent_keepalive_interval=0\n",
-        fwmark, clientPrivateKey.c_str(), peerPublicKey.c_str(), peerEndpoint.c_str());
-    if (!peerPresharedKey.empty())
-        fprintf(connection, "preshared_key=%s\n", peerPresharedKey.c_str());
-    fprintf(connection, "%s", "replace_allowed_ips=true\n");
-    for (const auto &ip : allowedIps)
-        fprintf(connection, "allowed_ip=%s\n", ip.c_str());
-    fputs("\n", connection);
-    fflush(connection);
-
     // Check results.
-    Connection::ResultMap results{ std::make_pair("errno", "") };
-    bool success = connection.getOutput(&results);
-    for (auto it = results.begin(); it != results.end(); ++it)
-        {
-            Logger::instance().out("%s = %s", it->first.c_str(), it->second.c_str());
-        }
-    if (success)
-        success = stringToValue<int>(results["errno"]) == 0;
-    return success;
+    int errnoValue = -1;
+    for (const auto &result : results) {
+        Logger::instance().out("%s = %s", result.first.c_str(), result.second.c_str());
+        if (result.first == "errno")
+            errnoValue = stringToValue<int>(result.second);
+    }
+    return errnoValue == 0;
 }
 
 unsigned long WireGuardCommunicator::getStatus(unsigned int *errorCode,
     unsigned long long *bytesReceived, unsigned long long *bytesTransmitted)
 {
-    Connection connection(deviceName_);
-    const auto connection_status = connection.getStatus();
-    if (connection_status != Connection::Status::OK) {
-        if (connection.getStatus() == Connection::Status::NO_SOCKET)
+    Connection::ResultList results;
+    Connection::Status connection_status;
+    if (!transact("get=1\n\n", &results, &connection_status)) {
+        if (connection_status == Connection::Status::OK
+            || connection_status == Connection::Status::NO_SOCKET)
             return WIREGUARD_STATE_STARTING;
         if (errorCode)
             *errorCode = static_cast<unsigned int>(errno);
         return WIREGUARD_STATE_ERROR;
     }
 
-    // Send get command.
-    fputs("get=1\n\n", connection);
-    fflush(connection);
-
-    Connection::ResultMap results{
-        std::make_pair("errno", ""),
-        std::make_pair("listen_port", ""),
-        std::make_pair("public_key", ""),
-        std::make_pair("rx_bytes", ""),
-        std::make_pair("tx_bytes", ""),
-        std::make_pair("last_handshake_time_sec", "")
-    };
-    bool success = connection.getOutput(&results);
-    if (!success)
-        return WIREGUARD_STATE_STARTING;
+    unsigned int errno_value = 0;
+    bool is_listening = false, has_peer = false;
+    unsigned long long rx_bytes = 0, tx_bytes = 0, last_handshake = 0;
+    for (const auto &result : results) {
+        const auto &key = result.first;
+        if (key == "errno")
+            errno_value = stringToValue<unsigned int>(result.second);
+        else if (key == "listen_port")
+            is_listening = true;
+        else if (key == "public_key")
+            has_peer = true;
+        else if (key == "rx_bytes")
+            rx_bytes += stringToValue<unsigned long long>(result.second);
+        else if (key == "tx_bytes")
+            tx_bytes += stringToValue<unsigned long long>(result.second);
+        else if (key == "last_handshake_time_sec")
+            last_handshake = std::max(last_handshake, stringToValue<unsigned long long>(result.second));
+    }
 
     // Check for errors.
-    const auto errno_value = stringToValue<unsigned int>(results["errno"]);
     if (errno_value != 0) {
         if (errorCode)
             *errorCode = errno_value;
@@ -217,20 +247,20 @@ unsigned long WireGuardCommunicator::getStatus(unsigned int *errorCode,
     }
 
     // Check if not yet listening.
-    if (results["listen_port"].empty())
+    if (!is_listening)
         return WIREGUARD_STATE_STARTING;
 
     // Check for handshake.
-    if (stringToValue<unsigned long long>(results["last_handshake_time_sec"]) > 0) {
+    if (last_handshake > 0) {
         if (bytesReceived)
-            *bytesReceived = stringToValue<unsigned long long>(results["rx_bytes"]);
+            *bytesReceived = rx_bytes;
         if (bytesTransmitted)
-            *bytesTransmitted = stringToValue<unsigned long long>(results["tx_bytes"]);
+            *bytesTransmitted = tx_bytes;
         return WIREGUARD_STATE_ACTIVE;
     }
 
     // If endpoint is set, we are connecting, otherwise simply listening.
-    if (!results["public_key"].empty())
+    if (has_peer)
         return WIREGUARD_STATE_CONNECTING;
     return WIREGUARD_STATE_LISTENING;
 }
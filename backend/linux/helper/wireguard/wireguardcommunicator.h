@@ -1,10 +1,14 @@
 #ifndef WireGuardCommunicator_h
 #define WireGuardCommunicator_h
 
-#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+// Talks to the wireguard-go daemon over its UAPI socket. The connection is kept between the calls
+// (the daemon serves several requests per connection) and is reopened once if the daemon closed it.
 class WireGuardCommunicator
 {
 public:
@@ -14,21 +18,23 @@ public:
     bool configure(const std::string &clientPrivateKey, const std::string &peerPublicKey,
         const std::string &peerPresharedKey, const std::string &peerEndpoint,
         const std::vector<std::string> &allowedIps, uint32_t fwmark);
+    // one "get" request for the device and all the peers: rx/tx are summed, the latest handshake is taken
     unsigned long getStatus(unsigned int *errorCode, unsigned long long *bytesReceived,
                             unsigned long long *bytesTransmitted);
+    void resetConnection();
 
 private:
     class Connection
     {
     public:
         enum class Status { OK, NO_SOCKET, NO_ACCESS };
-        using ResultMap = std::map<std::string, std::string>;
+        using ResultList = std::vector<std::pair<std::string, std::string>>;
 
         explicit Connection(const std::string &deviceName);
         ~Connection();
-        bool getOutput(ResultMap *results_map) const;
+        // sends the request and reads the response up to the empty line, false if the connection is broken
+        bool transact(const std::string &request, ResultList *results);
         Status getStatus() const { return status_; }
-        operator FILE*() const { return fileHandle_; }
     private:
         bool connect(struct sockaddr_un *address);
 
@@ -36,10 +42,14 @@ private:
         static constexpr int CONNECTION_BETWEEN_WAIT_MS = 100;
         Status status_;
         int socketHandle_;
-        FILE *fileHandle_;
     };
 
+    // returns the connection status, results are valid if it is OK and the function returns true
+    bool transact(const std::string &request, Connection::ResultList *results, Connection::Status *status);
+
     std::string deviceName_;
+    std::mutex mutex_;
+    std::unique_ptr<Connection> connection_;
 };
 
 #endif  // WireGuardCommunicator_h
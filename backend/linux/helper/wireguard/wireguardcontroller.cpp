@@ -7,6 +7,10 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
 
 WireGuardController::WireGuardController()
     : comm_(new WireGuardCommunicator), daemonCmdId_(0), is_initialized_(false)
@@ -28,6 +32,7 @@ void WireGuardController::reset()
 
     adapter_->disableRouting();
     adapter_.reset();
+    comm_->resetConnection();
     is_initialized_ = false;
 }
 
@@ -88,30 +93,66 @@ uint32_t WireGuardController::getFwmark()
 {
     uint32_t fwmark = 51820;        // initial default fwmark (taken from wireguard tools sources)
 
-    // check for the fwmark busy
-    while (true)
+    // ip prints the tables with a name in rt_tables by the name, not by the id
+    std::map<std::string, uint32_t> tableIds;
+    for (const char *path : { "/usr/share/iproute2/rt_tables", "/etc/iproute2/rt_tables" })
     {
-        std::vector<std::string> args;
-        args.push_back("-4");
-        args.push_back("route");
-        args.push_back("show");
-        args.push_back("table");
-        args.push_back(std::to_string(fwmark));
-
-        std::string outputIp4, outputIp6;
-        Utils::executeCommand("ip", args, &outputIp4, false);
-        // check the same for ipv6
-        args[0] = "-6";
-        Utils::executeCommand("ip", args, &outputIp6, false);
-        if (outputIp4.empty() && outputIp6.empty())
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
         {
-            break;
+            std::istringstream lineStream(line);
+            std::string id, name;
+            if (!(lineStream >> id >> name) || id[0] == '#')
+            {
+                continue;
+            }
+            char *end = nullptr;
+            const unsigned long table = strtoul(id.c_str(), &end, 0);
+            if (end != id.c_str() && *end == '\0')
+            {
+                tableIds[name] = static_cast<uint32_t>(table);
+            }
         }
-        else
+    }
+
+    // the tables in use, from one listing of all the tables instead of a command per candidate
+    std::set<uint32_t> usedTables;
+    for (const char *family : { "-4", "-6" })
+    {
+        std::string output;
+        Utils::executeCommand("ip", { family, "route", "show", "table", "all" }, &output, false);
+        std::istringstream stream(output);
+        std::string token;
+        bool isTableToken = false;
+        while (stream >> token)
         {
-            fwmark++;
+            if (isTableToken)
+            {
+                char *end = nullptr;
+                const unsigned long table = strtoul(token.c_str(), &end, 10);
+                if (end != token.c_str() && *end == '\0')
+                {
+                    usedTables.insert(static_cast<uint32_t>(table));
+                }
+                else
+                {
+                    auto it = tableIds.find(token);
+                    if (it != tableIds.end())
+                    {
+                        usedTables.insert(it->second);
+                    }
+                }
+            }
+            isTableToken = (token == "table");
         }
     }
 
+    // check for the fwmark busy
+    while (usedTables.find(fwmark) != usedTables.end())
+    {
+        fwmark++;
+    }
+
     return fwmark;
 }
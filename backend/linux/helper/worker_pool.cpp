@@ -0,0 +1,199 @@
+#include "worker_pool.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "logger.h"
+
+WorkerPool::WorkerPool(size_t threadsCount) : nextTaskId_(0), isStopped_(false)
+{
+    for (size_t i = 0; i < threadsCount; ++i)
+    {
+        threads_.emplace_back(&WorkerPool::workerThread, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+        for (const std::shared_ptr<Task> &task : running_)
+        {
+            task->isCanceled = true;
+            if (task->pid > 0)
+            {
+                kill(-task->pid, SIGKILL);
+            }
+        }
+    }
+    condition_.notify_all();
+    for (std::thread &t : threads_)
+    {
+        t.join();
+    }
+}
+
+unsigned long WorkerPool::execute(const std::string &cmdline, Callback callback)
+{
+    std::shared_ptr<Task> task(new Task());
+    task->cmdline = cmdline;
+    task->callback = callback;
+    task->pid = -1;
+    task->isCanceled = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task->id = ++nextTaskId_;
+        queue_.push_back(task);
+    }
+    condition_.notify_one();
+    return task->id;
+}
+
+void WorkerPool::cancel(unsigned long taskId)
+{
+    std::shared_ptr<Task> queuedTask;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = queue_.begin(); it != queue_.end(); ++it)
+        {
+            if ((*it)->id == taskId)
+            {
+                queuedTask = *it;
+                queue_.erase(it);
+                break;
+            }
+        }
+        if (!queuedTask)
+        {
+            for (const std::shared_ptr<Task> &task : running_)
+            {
+                if (task->id == taskId)
+                {
+                    // runTask() calls the callback when the process exits
+                    task->isCanceled = true;
+                    if (task->pid > 0)
+                    {
+                        Logger::instance().out("Cancel command: %s", task->cmdline.c_str());
+                        kill(-task->pid, SIGKILL);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    if (queuedTask)
+    {
+        queuedTask->callback(false, 0, std::string());
+    }
+}
+
+void WorkerPool::workerThread()
+{
+    while (true)
+    {
+        std::shared_ptr<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return isStopped_ || !queue_.empty(); });
+            if (isStopped_)
+            {
+                return;
+            }
+            task = queue_.front();
+            queue_.pop_front();
+            running_.push_back(task);
+        }
+        runTask(task);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.remove(task);
+        }
+    }
+}
+
+void WorkerPool::runTask(const std::shared_ptr<Task> &task)
+{
+    int fd = -1;
+    const pid_t pid = startProcess(task->cmdline, fd);
+    if (pid == -1)
+    {
+        task->callback(false, 0, std::string());
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task->pid = pid;
+        // cancelled while the process was starting
+        if (task->isCanceled)
+        {
+            kill(-pid, SIGKILL);
+        }
+    }
+
+    std::string output;
+    char buf[4096];
+    while (true)
+    {
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n > 0)
+        {
+            output.append(buf, n);
+        }
+        else if (n == 0 || errno != EINTR)
+        {
+            break;
+        }
+    }
+    close(fd);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR)
+    {
+    }
+
+    bool isCanceled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task->pid = -1;
+        isCanceled = task->isCanceled;
+    }
+    if (isCanceled)
+    {
+        task->callback(false, 0, std::string());
+    }
+    else
+    {
+        task->callback(true, WEXITSTATUS(status), output);
+    }
+}
+
+pid_t WorkerPool::startProcess(const std::string &cmdline, int &outFd)
+{
+    // as popen(cmdline, "r"), but in a new process group to kill the command with its children
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1)
+    {
+        return -1;
+    }
+    const pid_t pid = fork();
+    if (pid == -1)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", cmdline.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    // also in the parent, so kill(-pid) works before the child gets to setpgid()
+    setpgid(pid, pid);
+    close(fds[1]);
+    outFd = fds[0];
+    return pid;
+}
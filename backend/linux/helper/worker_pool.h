@@ -0,0 +1,53 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+// Runs the shell commands (iptables-restore, ip, wg, the DNS scripts, ...) on a fixed number of threads,
+// so a slow command doesn't block the server threads; the commands over the limit wait in the queue.
+// Each command runs in its own process group and can be cancelled.
+class WorkerPool
+{
+public:
+    typedef std::function<void(bool bExecuted, int exitCode, const std::string &output)> Callback;
+
+    explicit WorkerPool(size_t threadsCount);
+    ~WorkerPool();
+
+    // the callback is called from a worker thread with the exit code and the stdout of the command
+    unsigned long execute(const std::string &cmdline, Callback callback);
+    // removes the command from the queue or kills it, the callback is called with bExecuted == false
+    void cancel(unsigned long taskId);
+
+private:
+    struct Task
+    {
+        unsigned long id;
+        std::string cmdline;
+        Callback callback;
+        pid_t pid;
+        bool isCanceled;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::list<std::shared_ptr<Task> > queue_;
+    std::list<std::shared_ptr<Task> > running_;
+    std::vector<std::thread> threads_;
+    unsigned long nextTaskId_;
+    bool isStopped_;
+
+    void workerThread();
+    void runTask(const std::shared_ptr<Task> &task);
+    pid_t startProcess(const std::string &cmdline, int &outFd);
+};
+
+#endif // WORKER_POOL_H
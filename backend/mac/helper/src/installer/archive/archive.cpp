@@ -1,6 +1,7 @@
 #include "archive.h"
 #include <locale>
 #include <codecvt>
+#include <unordered_map>
 
 static const ISzAlloc g_Alloc = { SzAlloc, SzFree };
 
@@ -756,6 +757,16 @@ void Archive::calcTotal(const std::list<std::wstring> &files, const std::list<st
 
  this->file_list = files;
  this->path_list = paths;
+ path_by_index.assign(paths.begin(), paths.end());
+
+ // the lookups of extractionFile are by the index then, not by the search in the lists
+ unordered_map<wstring, Int32> index_by_name;
+ Int32 n = 0;
+ for (const wstring &file : file_list)
+ {
+  index_by_name.emplace(file, n++);
+ }
+ list_index.assign(db.NumFiles, -1);
 
 //Calculation of the size of the unpacked files
  for (UInt32 i = 0; i < db.NumFiles; i++)
@@ -769,8 +780,10 @@ void Archive::calcTotal(const std::list<std::wstring> &files, const std::list<st
 
    //We look for in the list
     wstring  file_name1 = wstring(file_name.begin(), file_name.end());
-   if(std::find(file_list.begin(), file_list.end(), file_name1) != file_list.end())
+   auto it = index_by_name.find(file_name1);
+   if(it != index_by_name.end())
    {
+    list_index[i] = it->second;
     importantTotalUnpacked += fileSize;
    }
 
@@ -807,23 +820,8 @@ SRes Archive::extractionFile(const UInt32 &i)
  }
 
  //The file which needs to be derived is found
- bool extract=false;
- unsigned int n=0;
- u16string source1;
-
- //We look for in the list
- wstring  file_name1 = wstring(file_name.begin(), file_name.end());
-
- for (std::list<wstring>::iterator it=file_list.begin(); it != file_list.end(); ++it)
-   {
-    if(*it==file_name1)
-    {
-     extract=true;
-
-     break;
-    }
-    n++;
-   }
+ bool extract = i < list_index.size() && list_index[i] >= 0;
+ unsigned int n = extract ? static_cast<unsigned int>(list_index[i]) : 0;
 
 
  if(extract==true)
@@ -876,9 +874,7 @@ SRes Archive::extractionFile(const UInt32 &i)
        std::u16string str;
 
 
-       std::list<wstring>::iterator it1 = path_list.begin();
-       std::advance(it1,n);
-       str = std::u16string((*it1).begin(), (*it1).end());
+       str = std::u16string(path_by_index[n].begin(), path_by_index[n].end());
 
        str.resize(str.length()+1);
        str.back() = '/';
@@ -920,33 +916,47 @@ SRes Archive::extractionFile(const UInt32 &i)
                CBuf buf;
                Buf_Init(&buf);
                Utf16_To_Char(&buf, destPath MY_FILE_CODE_PAGE_PARAM);
-               char *symlinkStr = new char[processedSize];
+               char *symlinkStr = new char[processedSize + 1];
                memcpy(symlinkStr, outBuffer + offset, processedSize);
                symlinkStr[processedSize] = '\0';
-               symlink(symlinkStr, reinterpret_cast<const char *>(buf.data));
-               lchown(reinterpret_cast<const char *>(buf.data), userId_, groupId_);
+               const char *linkPath = reinterpret_cast<const char *>(buf.data);
+               unlink(linkPath);
+               symlink(symlinkStr, linkPath);
+               lchown(linkPath, userId_, groupId_);
                PrintLF();
                Buf_Free(&buf, &g_Alloc);
                delete[] symlinkStr;
                return res;
            }
            
-           else
-           {
-                if(OutFile_OpenUtf16(&outFile, destPath))
-                 {
-                  PrintString(destPath);
-                  PrintError("can not open output file");
-                  res = SZ_ERROR_FAIL;
-                  return res;
-                 }
-           }
        }
 
        processedSize = outSizeProcessed;
 
        printPercent(processedSize);
 
+#ifndef _WIN32
+       // a new inode rather than a rewrite of the existing file, the pages of a running binary mapped from it
+       // stay as they are (a rewrite in place invalidates its code signature and the process is killed)
+       {
+           CBuf buf;
+           Buf_Init(&buf);
+           if (Utf16_To_Char(&buf, destPath) == 0)
+           {
+               unlink(reinterpret_cast<const char *>(buf.data));
+           }
+           Buf_Free(&buf, &g_Alloc);
+       }
+#endif
+
+       if(OutFile_OpenUtf16(&outFile, destPath))
+       {
+        PrintString(destPath);
+        PrintError("can not open output file");
+        res = SZ_ERROR_FAIL;
+        return res;
+       }
+
        //Saving of the unpacked file
        if((File_Write(&outFile, outBuffer + offset, &processedSize) != 0) || (processedSize != outSizeProcessed))
        {
@@ -53,6 +53,7 @@ typedef struct
 
 #include <string>
 #include <list>
+#include <vector>
 #include <fstream>
 
 typedef struct
@@ -102,6 +103,8 @@ class Archive
 
     std::list<std::wstring> file_list;
     std::list<std::wstring> path_list;
+    std::vector<std::wstring> path_by_index;    // path_list by the index in file_list
+    std::vector<Int32> list_index;              // the index in file_list by the index in the archive, -1 if not extracted
 
     CSzArEx db;
     ISzAlloc allocImp;
@@ -191,6 +194,9 @@ class Archive
     SRes extractionFile(const UInt32 &i);
     UInt64 getPercent();
     UInt64 getMaxPercent();
+    // the unpacked bytes of the files to extract, and of the extracted ones
+    UInt64 getTotalSize() const { return Total; }
+    UInt64 getCompletedSize() const { return Completed; }
     bool is_finish();
     SRes finish();
     std::wstring getLastError();
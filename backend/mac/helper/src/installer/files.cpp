@@ -1,5 +1,7 @@
 #include "files.h"
 #include "logger.h"
+#include <algorithm>
+#include <chrono>
 
 Files::Files(const std::wstring &archivePath, const std::wstring &installPath, uid_t userId, gid_t groupId) : userId_(userId),
     groupId_(groupId), archive_(NULL),
@@ -49,29 +51,31 @@ int Files::executeStep()
 	}
 	else
 	{
-		SRes res = archive_->extractionFile(curFileInd_);
-		if (res != SZ_OK)
+		const auto startTime = std::chrono::steady_clock::now();
+		do
 		{
-			archive_->finish();
-            LOG("Can't extract files");
-			lastError_ = "Can't extract file.";
-			return -1;
-		}
-		else 
-		{
-			int progress = ((double)curFileInd_ / (double)archive_->getNumFiles()) * 100.0;
+			SRes res = archive_->extractionFile(curFileInd_);
+			if (res != SZ_OK)
+			{
+				archive_->finish();
+				LOG("Can't extract files");
+				lastError_ = "Can't extract file.";
+				return -1;
+			}
 
 			if (curFileInd_ >= (archive_->getNumFiles() - 1))
 			{
 				archive_->finish();
 				return 100;
 			}
-			else
-			{
-                curFileInd_++;
-			}
-			return progress;
-		}
+			curFileInd_++;
+		} while (std::chrono::steady_clock::now() - startTime < std::chrono::milliseconds(STEP_TIME_MS));
+
+		// by the bytes, a framework binary takes longer than a hundred of small resources
+		const UInt64 total = archive_->getTotalSize();
+		const int progress = total > 0 ? static_cast<int>(archive_->getCompletedSize() * 100 / total)
+		                               : static_cast<int>(curFileInd_ * 100 / archive_->getNumFiles());
+		return std::min(progress, 99);
 	}
 
 	return 100;
@@ -4,6 +4,9 @@
 #include <list>
 #include "archive/archive.h"
 
+// Extracts the archive into the install path, which the installer has emptied (the old bundle is removed, writing over
+// it broke the code signature of the running app). Single-threaded: the payload is one solid LZMA block. No clonefile
+// or hardlinks: the source is the archive, not files on disk.
 class Files
 {
 public:
@@ -25,6 +28,9 @@ public:
    std::list<std::wstring> pathList_;
    std::string lastError_;
 
+   // the files are extracted for up to STEP_TIME_MS per executeStep, one call per file was a round trip per file
+   static constexpr int STEP_TIME_MS = 100;
+
    void eraseSubStr(std::wstring &mainStr, const std::wstring &toErase);
    void fillPathList();
    std::wstring getFileName(const std::wstring &s);
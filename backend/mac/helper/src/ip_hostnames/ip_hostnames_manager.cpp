@@ -1,5 +1,6 @@
 #include "ip_hostnames_manager.h"
 #include "logger.h"
+#include <algorithm>
 
 IpHostnamesManager::IpHostnamesManager(): isEnabled_(false), isExcludeMode_(true)
 {
@@ -47,3 +48,21 @@ void IpHostnamesManager::setSettings(bool isExclude, const std::vector<std::stri
         ipRoutes_.setIps(defaultRouteIp_, ipsLatest_);
     }
 }
+
+void IpHostnamesManager::updateIps(const std::vector<std::string> &added, const std::vector<std::string> &removed)
+{
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    
+    for (const auto &ip: removed)
+    {
+        ipsLatest_.erase(std::remove(ipsLatest_.begin(), ipsLatest_.end(), ip), ipsLatest_.end());
+    }
+    ipsLatest_.insert(ipsLatest_.end(), added.begin(), added.end());
+    
+    if (isEnabled_)
+    {
+        // the removed routes first, an entry can be removed and added with another spelling
+        ipRoutes_.removeIps(removed);
+        ipRoutes_.addIps(defaultRouteIp_, added);
+    }
+}
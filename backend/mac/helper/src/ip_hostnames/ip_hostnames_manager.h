@@ -15,6 +15,8 @@ public:
     void enable(const std::string &ipAddress);
     void disable();
     void setSettings(bool isExclude, const std::vector<std::string> &ips, const std::vector<std::string> &hosts);
+    // the delta of the ips and hosts in the same mode, only the routes of these entries are changed
+    void updateIps(const std::vector<std::string> &added, const std::vector<std::string> &removed);
     
 private:
     IpRoutes ipRoutes_;
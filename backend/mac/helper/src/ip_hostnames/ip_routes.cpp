@@ -1,6 +1,7 @@
 #include "ip_routes.h"
 #include "utils.h"
 #include "logger.h"
+#include "../routes_manager/routing_socket.h"
 #include <set>
 
 void IpRoutes::setIps(const std::string &defaultRouteIp, const std::vector<std::string> &ips)
@@ -25,17 +26,20 @@ void IpRoutes::setIps(const std::string &defaultRouteIp, const std::vector<std::
     }
     
     // delete routes
+    std::vector<RoutingSocket::Route> batch;
     for (auto ip = ipsDelete.begin(); ip != ipsDelete.end(); ++ip)
     {
         auto fr = activeRoutes_.find(*ip);
         if (fr != activeRoutes_.end())
         {
-            deleteRoute(fr->second);
+            deleteRoute(fr->second, batch);
             activeRoutes_.erase(fr);
         }
     }
+    RoutingSocket::remove(batch);
     
     // add routes
+    batch.clear();
     for (auto ip = ipsSet.begin(); ip != ipsSet.end(); ++ip)
     {
         auto ar = activeRoutes_.find(*ip);
@@ -48,32 +52,94 @@ void IpRoutes::setIps(const std::string &defaultRouteIp, const std::vector<std::
             RouteDescr rd;
             rd.ip = *ip;
             rd.defaultRouteIp = defaultRouteIp;
-            addRoute(rd);
+            addRoute(rd, batch);
             activeRoutes_[*ip] = rd;
         }
     }
+    RoutingSocket::add(batch);
+}
+
+void IpRoutes::addIps(const std::string &defaultRouteIp, const std::vector<std::string> &ips)
+{
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    
+    std::vector<RoutingSocket::Route> batch;
+    for (const auto &ip: ips)
+    {
+        if (activeRoutes_.find(ip) == activeRoutes_.end())
+        {
+            RouteDescr rd;
+            rd.ip = ip;
+            rd.defaultRouteIp = defaultRouteIp;
+            addRoute(rd, batch);
+            activeRoutes_[ip] = rd;
+        }
+    }
+    RoutingSocket::add(batch);
+}
+
+void IpRoutes::removeIps(const std::vector<std::string> &ips)
+{
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    
+    std::vector<RoutingSocket::Route> batch;
+    for (const auto &ip: ips)
+    {
+        auto fr = activeRoutes_.find(ip);
+        if (fr != activeRoutes_.end())
+        {
+            deleteRoute(fr->second, batch);
+            activeRoutes_.erase(fr);
+        }
+    }
+    RoutingSocket::remove(batch);
 }
 
 void IpRoutes::clear()
 {
     std::lock_guard<std::recursive_mutex> guard(mutex_);
+    std::vector<RoutingSocket::Route> batch;
     for (auto it = activeRoutes_.begin(); it != activeRoutes_.end(); ++it)
     {
-        deleteRoute(it->second);
+        deleteRoute(it->second, batch);
     }
+    RoutingSocket::remove(batch);
     activeRoutes_.clear();
 }
 
-void IpRoutes::addRoute(const RouteDescr &rd)
+RoutingSocket::Route IpRoutes::toRoutingSocketRoute(const RouteDescr &rd)
 {
+    RoutingSocket::Route route;
+    route.ip = rd.ip;
+    route.gateway = rd.defaultRouteIp;
+    return route;
+}
+
+void IpRoutes::addRoute(const RouteDescr &rd, std::vector<RoutingSocket::Route> &batch)
+{
+    const RoutingSocket::Route route = toRoutingSocketRoute(rd);
+    if (RoutingSocket::isSupported(route))
+    {
+        batch.push_back(route);
+        return;
+    }
+
+    // hostnames are resolved by the "route" command
     std::string cmd = "route add -net " + rd.ip + " " + rd.defaultRouteIp;
     LOG("cmd: %s", cmd.c_str());
     
     Utils::executeCommand(cmd);
 }
 
-void IpRoutes::deleteRoute(const RouteDescr &rd)
+void IpRoutes::deleteRoute(const RouteDescr &rd, std::vector<RoutingSocket::Route> &batch)
 {
+    const RoutingSocket::Route route = toRoutingSocketRoute(rd);
+    if (RoutingSocket::isSupported(route))
+    {
+        batch.push_back(route);
+        return;
+    }
+
     std::string cmd = "route delete -net " + rd.ip + " " + rd.defaultRouteIp;
     LOG("cmd: %s", cmd.c_str());
     Utils::executeCommand(cmd);
@@ -5,12 +5,15 @@
 #include <vector>
 #include <mutex>
 #include <map>
+#include "../routes_manager/routing_socket.h"
 
-// manage Ip route via "route add" and "route delete" commands
+// manage Ip routes via the routing socket in batches ("route add" and "route delete" commands for the hostnames)
 class IpRoutes
 {
 public:
     void setIps(const std::string &defaultRouteIp, const std::vector<std::string> &ips);
+    void addIps(const std::string &defaultRouteIp, const std::vector<std::string> &ips);
+    void removeIps(const std::vector<std::string> &ips);
     void clear();
     
 private:
@@ -24,8 +27,10 @@ private:
     
     std::map<std::string, RouteDescr> activeRoutes_;
     
-    void addRoute(const RouteDescr &rd);
-    void deleteRoute(const RouteDescr &rd);
+    // the numeric routes go to the batch, the hostnames are executed right away
+    void addRoute(const RouteDescr &rd, std::vector<RoutingSocket::Route> &batch);
+    void deleteRoute(const RouteDescr &rd, std::vector<RoutingSocket::Route> &batch);
+    static RoutingSocket::Route toRoutingSocketRoute(const RouteDescr &rd);
 };
 
 #endif /* IpRoutes_h */
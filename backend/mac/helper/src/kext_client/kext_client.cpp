@@ -10,8 +10,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <libproc.h>
+#include <algorithm>
 
-#define KEXT_MSG_REPLY        0
+#define KEXT_MSG_REPLY                  0
+#define KEXT_MSG_INVALIDATE_VERDICTS    1
 
 KextClient::KextClient() : sock_(-1), isConnected_(false), thread_(NULL), bFinishThread_(false)
 {
@@ -123,14 +125,33 @@ void KextClient::setConnectParams(CMD_SEND_CONNECT_STATUS &connectStatus)
 {
     std::lock_guard<std::mutex> guard(mutex_);
     connectStatus_ = connectStatus;
+    invalidateKextVerdicts();
 }
 
 void KextClient::setSplitTunnelingParams(bool isExclude, const std::vector<std::string> &apps)
 {
     std::lock_guard<std::mutex> guard(mutex_);
     isExclude_ = isExclude;
-    apps_ = apps;
+    userApps_ = apps;
+    apps_ = userApps_;
     applyExtraRules(apps_);
+    invalidateKextVerdicts();
+}
+
+void KextClient::updateApps(const std::vector<std::string> &added, const std::vector<std::string> &removed)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const auto &path: removed)
+    {
+        userApps_.erase(std::remove(userApps_.begin(), userApps_.end(), path), userApps_.end());
+    }
+    userApps_.insert(userApps_.end(), added.begin(), added.end());
+    
+    // the extra rules are shared by several apps, rebuilt from the list
+    apps_ = userApps_;
+    applyExtraRules(apps_);
+    // the kext doesn't know the paths of its cached verdicts, all are dropped, the kext stays connected
+    invalidateKextVerdicts();
 }
 
 void KextClient::readSocketThread()
@@ -171,6 +192,18 @@ void KextClient::readSocketThread()
     }
 }
 
+// the kext caches the verdicts per process, they depend on the split tunneling and connect params
+void KextClient::invalidateKextVerdicts()
+{
+    if (isConnected_)
+    {
+        if (setsockopt(sock_, SYSPROTO_CONTROL, KEXT_MSG_INVALIDATE_VERDICTS, NULL, 0))
+        {
+            LOG("Failed to invalidate the kext verdicts: %d", errno);
+        }
+    }
+}
+
 bool KextClient::recvAll(int socket, void *buffer, size_t length)
 {
     char *ptr = (char*) buffer;
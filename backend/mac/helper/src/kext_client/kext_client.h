@@ -17,6 +17,8 @@ public:
     
     void setConnectParams(CMD_SEND_CONNECT_STATUS &connectStatus);
     void setSplitTunnelingParams(bool isExclude, const std::vector<std::string> &apps);
+    // the delta of the app list in the same mode
+    void updateApps(const std::vector<std::string> &added, const std::vector<std::string> &removed);
     
 private:
     
@@ -62,13 +64,15 @@ private:
     bool isExclude_;
     CMD_SEND_CONNECT_STATUS connectStatus_;
     std::vector<std::string> windscribeExecutables_;
-    std::vector<std::string> apps_;
+    std::vector<std::string> userApps_;     // as set by the GUI
+    std::vector<std::string> apps_;         // userApps_ with the extra rules
     
     const std::string WEBKIT_FRAMEWORK_PATH = std::string("/System/Library/Frameworks/WebKit.framework");
     const std::string STAGED_WEBKIT_FRAMEWORK_PATH = std::string("/System/Library/StagedFrameworks/Safari/WebKit.framework");
     
     void readSocketThread();
     bool recvAll(int socket, void *buffer, size_t length);
+    void invalidateKextVerdicts();
     
     void applyExtraRules(std::vector<std::string> &apps);
     bool verifyApp(const std::string &appPath, std::string &outBindIp, bool &isExclude);
@@ -0,0 +1,35 @@
+#ifndef Ipv6Manager_h
+#define Ipv6Manager_h
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// IPv6 of all network services through SCPreferences, in one committed transaction (instead of the networksetup
+// processes per service). The states before disableIpv6() are kept by service ID and restored by restoreIpv6(),
+// a service added meanwhile gets IPv6 enabled. The states are saved to STATES_FILE too, so the ones left by a crash
+// or a reboot of the helper are restored by restoreSavedOnStartup().
+class Ipv6Manager
+{
+public:
+    Ipv6Manager();
+    ~Ipv6Manager();
+
+    bool disableIpv6();
+    bool restoreIpv6();
+    // restores the states saved by the previous run of the helper, if it didn't restore them itself
+    void restoreSavedOnStartup();
+
+private:
+    static constexpr const char *STATES_DIR = "/Library/Application Support/com.windscribe.helper.macos";
+    static constexpr const char *STATES_FILE = "/Library/Application Support/com.windscribe.helper.macos/ipv6_states";
+
+    std::mutex mutex_;
+    std::map<std::string, bool> savedStates_;   // service ID -> IPv6 enabled
+
+    bool apply(bool isDisable);
+    void loadStates();
+    void saveStates();
+};
+
+#endif /* Ipv6Manager_h */
@@ -0,0 +1,182 @@
+#include "ipv6_manager.h"
+#import <SystemConfiguration/SystemConfiguration.h>
+#include <fstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logger.h"
+
+namespace {
+
+std::string toStdString(CFStringRef str)
+{
+    char buf[256];
+    if (!str || !CFStringGetCString(str, buf, sizeof(buf), kCFStringEncodingUTF8))
+    {
+        return std::string();
+    }
+    return buf;
+}
+
+} // namespace
+
+Ipv6Manager::Ipv6Manager()
+{
+}
+
+Ipv6Manager::~Ipv6Manager()
+{
+}
+
+bool Ipv6Manager::disableIpv6()
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return apply(true);
+}
+
+bool Ipv6Manager::restoreIpv6()
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return apply(false);
+}
+
+void Ipv6Manager::restoreSavedOnStartup()
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    loadStates();
+    if (!savedStates_.empty())
+    {
+        LOG("Ipv6Manager: restoring the IPv6 states left by the previous run");
+        apply(false);
+    }
+}
+
+bool Ipv6Manager::apply(bool isDisable)
+{
+    SCPreferencesRef prefs = SCPreferencesCreate(kCFAllocatorDefault, CFSTR("WindscribeIpv6"), NULL);
+    if (!prefs)
+    {
+        LOG("Ipv6Manager: SCPreferencesCreate failed: %s", SCErrorString(SCError()));
+        return false;
+    }
+    if (!SCPreferencesLock(prefs, true))
+    {
+        LOG("Ipv6Manager: SCPreferencesLock failed: %s", SCErrorString(SCError()));
+        CFRelease(prefs);
+        return false;
+    }
+
+    int countChanged = 0;
+    CFArrayRef services = SCNetworkServiceCopyAll(prefs);
+    const CFIndex countServices = services ? CFArrayGetCount(services) : 0;
+    for (CFIndex i = 0; i < countServices; ++i)
+    {
+        SCNetworkServiceRef service = (SCNetworkServiceRef)CFArrayGetValueAtIndex(services, i);
+        SCNetworkProtocolRef protocol = SCNetworkServiceCopyProtocol(service, kSCNetworkProtocolTypeIPv6);
+        if (!protocol)
+        {
+            continue;
+        }
+
+        const std::string serviceId = toStdString(SCNetworkServiceGetServiceID(service));
+        const bool isEnabled = SCNetworkProtocolGetEnabled(protocol);
+        bool isNeedEnabled = isEnabled;
+        if (isDisable)
+        {
+            // the services with IPv6 already off stay off after the restore, a repeated disable keeps the states
+            // of the first one
+            savedStates_.insert(std::make_pair(serviceId, isEnabled));
+            isNeedEnabled = false;
+        }
+        else
+        {
+            auto it = savedStates_.find(serviceId);
+            isNeedEnabled = (it != savedStates_.end()) ? it->second : true;
+        }
+
+        if (isNeedEnabled != isEnabled)
+        {
+            if (SCNetworkProtocolSetEnabled(protocol, isNeedEnabled))
+            {
+                countChanged++;
+            }
+            else
+            {
+                LOG("Ipv6Manager: failed to change the service %s: %s", serviceId.c_str(), SCErrorString(SCError()));
+            }
+        }
+        CFRelease(protocol);
+    }
+    if (services)
+    {
+        CFRelease(services);
+    }
+
+    // saved before the commit, the services may be disabled even if it reports a failure
+    if (isDisable)
+    {
+        saveStates();
+    }
+
+    bool bRet = true;
+    if (countChanged > 0)
+    {
+        // all the services are applied at once
+        bRet = SCPreferencesCommitChanges(prefs) && SCPreferencesApplyChanges(prefs);
+        if (!bRet)
+        {
+            LOG("Ipv6Manager: failed to commit the changes: %s", SCErrorString(SCError()));
+        }
+    }
+    SCPreferencesUnlock(prefs);
+    CFRelease(prefs);
+
+    if (!isDisable && bRet)
+    {
+        savedStates_.clear();
+        saveStates();
+    }
+    LOG("Ipv6Manager: IPv6 %s, %d of %ld services changed", isDisable ? "disabled" : "restored", countChanged, (long)countServices);
+    return bRet;
+}
+
+void Ipv6Manager::loadStates()
+{
+    savedStates_.clear();
+    std::ifstream file(STATES_FILE);
+    std::string serviceId;
+    int isEnabled;
+    while (file >> serviceId >> isEnabled)
+    {
+        savedStates_[serviceId] = (isEnabled != 0);
+    }
+}
+
+void Ipv6Manager::saveStates()
+{
+    if (savedStates_.empty())
+    {
+        unlink(STATES_FILE);
+        return;
+    }
+
+    mkdir(STATES_DIR, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    // written to a temporary file and renamed, a crash doesn't leave a partial file
+    const std::string tempFile = std::string(STATES_FILE) + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::trunc);
+        for (const auto &it : savedStates_)
+        {
+            file << it.first << " " << (it.second ? 1 : 0) << "\n";
+        }
+        if (!file)
+        {
+            LOG("Ipv6Manager: can't write %s", tempFile.c_str());
+            return;
+        }
+    }
+    if (rename(tempFile.c_str(), STATES_FILE) != 0)
+    {
+        LOG("Ipv6Manager: can't rename %s", tempFile.c_str());
+    }
+}
@@ -1,4 +1,5 @@
 #include "routes.h"
+#include "routing_socket.h"
 #include "utils.h"
 #include "logger.h"
 
@@ -10,6 +11,11 @@ void Routes::add(const std::string &ip, const std::string &gateway, const std::s
     rd.mask = mask;
     routes_.push_back(rd);
     
+    if (RoutingSocket::isSupported(rd))
+    {
+        RoutingSocket::add(std::vector<RoutingSocket::Route>(1, rd));
+        return;
+    }
     std::string cmd = "route add -net " + ip + " " + gateway + " " + mask;
     LOG("execute: %s", cmd.c_str());
     Utils::executeCommand(cmd);
@@ -22,6 +28,11 @@ void Routes::addWithInterface(const std::string &ip, const std::string &interfac
     rd.interface = interface;
     routes_.push_back(rd);
     
+    if (RoutingSocket::isSupported(rd))
+    {
+        RoutingSocket::add(std::vector<RoutingSocket::Route>(1, rd));
+        return;
+    }
     std::string cmd = "route -q -n add -inet " + ip + " -interface " + interface;
     LOG("execute: %s", cmd.c_str());
     Utils::executeCommand(cmd);
@@ -30,9 +41,15 @@ void Routes::addWithInterface(const std::string &ip, const std::string &interfac
 
 void Routes::clear()
 {
+    // the installed routes are deleted in one batch
+    std::vector<RoutingSocket::Route> batch;
     for(auto const& rd: routes_)
     {
-        if (rd.interface.empty())
+        if (RoutingSocket::isSupported(rd))
+        {
+            batch.push_back(rd);
+        }
+        else if (rd.interface.empty())
         {
             std::string cmd = "route delete -net " + rd.ip + " " + rd.gateway + " " + rd.mask;
             LOG("execute: %s", cmd.c_str());
@@ -45,5 +62,6 @@ void Routes::clear()
             Utils::executeCommand(cmd);
         }
     }
+    RoutingSocket::remove(batch);
     routes_.clear();
 }
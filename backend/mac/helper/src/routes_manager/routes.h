@@ -3,9 +3,10 @@
 
 #include <string>
 #include <vector>
+#include "routing_socket.h"
 
 
-// helper for add and clear routes via system "route" command
+// helper for add and clear routes via the routing socket (the "route" command for the non-numeric addresses)
 class Routes
 {
 public:
@@ -14,13 +15,7 @@ public:
     void clear();
     
 private:
-    struct RouteDescr
-    {
-        std::string ip;
-        std::string gateway;
-        std::string mask;
-        std::string interface;
-    };
+    typedef RoutingSocket::Route RouteDescr;
     
     std::vector<RouteDescr> routes_;
 };
@@ -0,0 +1,231 @@
+#include "routing_socket.h"
+#include "logger.h"
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// the sockaddrs in the routing messages are aligned to sizeof(uint32_t)
+size_t roundUp(size_t len)
+{
+    return len > 0 ? (1 + ((len - 1) | (sizeof(uint32_t) - 1))) : sizeof(uint32_t);
+}
+
+void appendSockaddr(std::vector<char> &message, const void *sa, size_t len)
+{
+    const size_t offset = message.size();
+    message.resize(offset + roundUp(len), 0);
+    memcpy(message.data() + offset, sa, len);
+}
+
+bool parseIp(const std::string &str, in_addr &addr, int &prefix)
+{
+    const size_t slash = str.find('/');
+    prefix = 32;
+    if (slash != std::string::npos)
+    {
+        char *end = nullptr;
+        const long p = strtol(str.c_str() + slash + 1, &end, 10);
+        if (*end != '\0' || end == str.c_str() + slash + 1 || p < 0 || p > 32)
+        {
+            return false;
+        }
+        prefix = static_cast<int>(p);
+    }
+    return inet_pton(AF_INET, str.substr(0, slash).c_str(), &addr) == 1;
+}
+
+sockaddr_in makeSockaddrIn(in_addr addr)
+{
+    sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_len = sizeof(sin);
+    sin.sin_family = AF_INET;
+    sin.sin_addr = addr;
+    return sin;
+}
+
+// the link-level address of the interface, as the "route -interface" does
+bool getInterfaceSockaddr(const std::string &interface, sockaddr_dl &sdl)
+{
+    bool isFound = false;
+    struct ifaddrs *ifap = nullptr;
+    if (getifaddrs(&ifap) == 0)
+    {
+        for (struct ifaddrs *ifa = ifap; ifa; ifa = ifa->ifa_next)
+        {
+            if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_LINK && interface == ifa->ifa_name)
+            {
+                memcpy(&sdl, ifa->ifa_addr, std::min(sizeof(sdl), static_cast<size_t>(ifa->ifa_addr->sa_len)));
+                isFound = true;
+                break;
+            }
+        }
+        freeifaddrs(ifap);
+    }
+    if (!isFound)
+    {
+        const unsigned int index = if_nametoindex(interface.c_str());
+        if (index == 0)
+        {
+            return false;
+        }
+        memset(&sdl, 0, sizeof(sdl));
+        sdl.sdl_len = sizeof(sdl);
+        sdl.sdl_family = AF_LINK;
+        sdl.sdl_index = index;
+    }
+    return true;
+}
+
+} // namespace
+
+bool RoutingSocket::isSupported(const Route &route)
+{
+    in_addr addr;
+    int prefix;
+    if (!parseIp(route.ip, addr, prefix))
+    {
+        return false;
+    }
+    if (!route.interface.empty())
+    {
+        return true;
+    }
+    return inet_pton(AF_INET, route.gateway.c_str(), &addr) == 1 &&
+           (route.mask.empty() || inet_pton(AF_INET, route.mask.c_str(), &addr) == 1);
+}
+
+int RoutingSocket::add(const std::vector<Route> &routes)
+{
+    return execute(RTM_ADD, routes);
+}
+
+int RoutingSocket::remove(const std::vector<Route> &routes)
+{
+    return execute(RTM_DELETE, routes);
+}
+
+int RoutingSocket::execute(int type, const std::vector<Route> &routes)
+{
+    if (routes.empty())
+    {
+        return 0;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const char *typeName = (type == RTM_ADD) ? "add" : "delete";
+
+    int s = socket(PF_ROUTE, SOCK_RAW, AF_INET);
+    if (s < 0)
+    {
+        LOG("RoutingSocket: socket(PF_ROUTE) failed, errno = %d", errno);
+        return static_cast<int>(routes.size());
+    }
+    // the replies aren't read, the errors are returned by write()
+    shutdown(s, SHUT_RD);
+
+    int failedCount = 0;
+    int seq = 0;
+    std::vector<char> message;
+    for (const Route &route : routes)
+    {
+        if (!makeMessage(type, ++seq, route, message))
+        {
+            LOG("RoutingSocket: incorrect route %s", route.ip.c_str());
+            failedCount++;
+            continue;
+        }
+        if (write(s, message.data(), message.size()) < 0)
+        {
+            // already existing routes on add and missing ones on delete are fine
+            if (!(type == RTM_ADD && errno == EEXIST) && !(type == RTM_DELETE && errno == ESRCH))
+            {
+                LOG("RoutingSocket: %s route %s failed, errno = %d", typeName, route.ip.c_str(), errno);
+                failedCount++;
+            }
+        }
+    }
+    close(s);
+
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    LOG("RoutingSocket: %s %d routes, %d failed, %lld ms", typeName, static_cast<int>(routes.size()), failedCount, static_cast<long long>(elapsedMs));
+    return failedCount;
+}
+
+bool RoutingSocket::makeMessage(int type, int seq, const Route &route, std::vector<char> &message)
+{
+    in_addr dst;
+    int prefix;
+    if (!parseIp(route.ip, dst, prefix))
+    {
+        return false;
+    }
+
+    in_addr mask;
+    if (!route.mask.empty())
+    {
+        if (inet_pton(AF_INET, route.mask.c_str(), &mask) != 1)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        mask.s_addr = htonl(prefix == 0 ? 0 : (0xFFFFFFFFu << (32 - prefix)));
+    }
+    const bool isHost = mask.s_addr == 0xFFFFFFFFu;
+    dst.s_addr &= mask.s_addr;
+
+    message.assign(sizeof(rt_msghdr), 0);
+    rt_msghdr *hdr = reinterpret_cast<rt_msghdr *>(message.data());
+    hdr->rtm_version = RTM_VERSION;
+    hdr->rtm_type = type;
+    hdr->rtm_seq = seq;
+    hdr->rtm_flags = RTF_UP | RTF_STATIC | (isHost ? RTF_HOST : 0);
+    hdr->rtm_addrs = RTA_DST | RTA_GATEWAY | (isHost ? 0 : RTA_NETMASK);
+
+    // the order of the sockaddrs is RTA_DST, RTA_GATEWAY, RTA_NETMASK
+    const sockaddr_in sinDst = makeSockaddrIn(dst);
+    appendSockaddr(message, &sinDst, sizeof(sinDst));
+
+    if (route.interface.empty())
+    {
+        in_addr gateway;
+        if (inet_pton(AF_INET, route.gateway.c_str(), &gateway) != 1)
+        {
+            return false;
+        }
+        reinterpret_cast<rt_msghdr *>(message.data())->rtm_flags |= RTF_GATEWAY;
+        const sockaddr_in sinGateway = makeSockaddrIn(gateway);
+        appendSockaddr(message, &sinGateway, sizeof(sinGateway));
+    }
+    else
+    {
+        sockaddr_dl sdl;
+        if (!getInterfaceSockaddr(route.interface, sdl))
+        {
+            return false;
+        }
+        appendSockaddr(message, &sdl, sdl.sdl_len);
+    }
+
+    if (!isHost)
+    {
+        const sockaddr_in sinMask = makeSockaddrIn(mask);
+        appendSockaddr(message, &sinMask, sizeof(sinMask));
+    }
+
+    reinterpret_cast<rt_msghdr *>(message.data())->rtm_msglen = static_cast<u_short>(message.size());
+    return true;
+}
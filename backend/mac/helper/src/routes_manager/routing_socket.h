@@ -0,0 +1,31 @@
+#ifndef RoutingSocket_h
+#define RoutingSocket_h
+
+#include <string>
+#include <vector>
+
+// adds and deletes routes with the messages to the PF_ROUTE socket, without the "route" command process per route
+class RoutingSocket
+{
+public:
+    struct Route
+    {
+        std::string ip;             // address or CIDR (1.2.3.0/24); an address without mask is a host route
+        std::string gateway;        // gateway address, or
+        std::string mask;           // dotted mask, overrides the CIDR mask if not empty
+        std::string interface;      // interface name for the routes via interface (gateway is empty)
+    };
+
+    // true if the route can be set with the routing socket (numeric addresses only, the hostnames go to the "route" command)
+    static bool isSupported(const Route &route);
+
+    // all the routes of the batch go through one socket, returns the number of the failed ones (logged)
+    static int add(const std::vector<Route> &routes);
+    static int remove(const std::vector<Route> &routes);
+
+private:
+    static int execute(int type, const std::vector<Route> &routes);
+    static bool makeMessage(int type, int seq, const Route &route, std::vector<char> &message);
+};
+
+#endif /* RoutingSocket_h */
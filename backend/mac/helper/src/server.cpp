@@ -46,16 +46,23 @@ Server::~Server()
     unlink(SOCK_PATH);
 }
 
-bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer)
+bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, bool isSession, unsigned int &outRequestId,
+                                  int &outCmdId, CMD_ANSWER &outCmdAnswer)
 {
+    const size_t requestIdSize = isSession ? sizeof(outRequestId) : 0;
     // not enough data for read command
-    if (buf->size() < sizeof(int)*3)
+    if (buf->size() < requestIdSize + sizeof(int)*3)
     {
         return false;
     }
     
     const char *bufPtr = boost::asio::buffer_cast<const char*>(buf->data());
     size_t headerSize = 0;
+    if (isSession)
+    {
+        memcpy(&outRequestId, bufPtr, sizeof(outRequestId));
+        headerSize += sizeof(outRequestId);
+    }
     int cmdId;
     memcpy(&cmdId, bufPtr + headerSize, sizeof(cmdId));
     headerSize += sizeof(cmdId);
@@ -89,8 +96,13 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
     std::string str(bufPtr + headerSize, length);
     std::istringstream stream(str);
     boost::archive::text_iarchive ia(stream, boost::archive::no_header);
+    outCmdId = cmdId;
     
-    if (cmdId == HELPER_CMD_EXECUTE)
+    if (cmdId == HELPER_CMD_OPEN_SESSION)
+    {
+        outCmdAnswer.executed = isSession ? 0 : 1;
+    }
+    else if (cmdId == HELPER_CMD_EXECUTE)
     {
         CMD_EXECUTE cmdExecute;
         ia >> cmdExecute;
@@ -325,13 +337,22 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
             outCmdAnswer.executed = 0;
         }
     }
+    else if (cmdId == HELPER_CMD_SET_IPV6_ENABLED)
+    {
+        CMD_SET_IPV6_ENABLED cmd;
+        ia >> cmd;
+
+        const bool bSuccess = cmd.isEnabled ? ipv6Manager_.restoreIpv6() : ipv6Manager_.disableIpv6();
+        outCmdAnswer.executed = bSuccess ? 1 : 0;
+    }
 
     buf->consume(headerSize + length);
 
     return true;
 }
 
-void Server::receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, const boost::system::error_code& ec, std::size_t bytes_transferred)
+void Server::receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, boost::shared_ptr<bool> isSession,
+                              const boost::system::error_code& ec, std::size_t bytes_transferred)
 {
     if (!ec.value())
     {
@@ -339,21 +360,27 @@ void Server::receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::st
         while (true)
         {
             CMD_ANSWER cmdAnswer;
-            if (!readAndHandleCommand(sock, buf.get(), cmdAnswer))
+            unsigned int requestId = 0;
+            int cmdId = -1;
+            if (!readAndHandleCommand(sock, buf.get(), *isSession, requestId, cmdId, cmdAnswer))
             {
                 // goto receive next commands
                 boost::asio::async_read(*sock, *buf, boost::asio::transfer_at_least(1),
-                                        boost::bind(&Server::receiveCmdHandle, this, sock, buf, _1, _2));
+                                        boost::bind(&Server::receiveCmdHandle, this, sock, buf, isSession, _1, _2));
                 break;
             }
             else
             {
-                if (!sendAnswerCmd(sock, cmdAnswer))
+                if (!sendAnswerCmd(sock, *isSession, requestId, cmdAnswer))
                 {
                     LOG("client app disconnected");
                     HelperSecurity::instance().reset();
                     return;
                 }
+                if (cmdId == HELPER_CMD_OPEN_SESSION && cmdAnswer.executed == 1)
+                {
+                    *isSession = true;
+                }
             }
         }
     }
@@ -372,8 +399,9 @@ void Server::acceptHandler(const boost::system::error_code & ec, socket_ptr sock
                 
         HelperSecurity::instance().reset();
         boost::shared_ptr<boost::asio::streambuf> buf(new boost::asio::streambuf);
+        boost::shared_ptr<bool> isSession(new bool(false));
         boost::asio::async_read(*sock, *buf, boost::asio::transfer_at_least(1),
-                                    boost::bind(&Server::receiveCmdHandle, this, sock, buf, _1, _2));
+                                    boost::bind(&Server::receiveCmdHandle, this, sock, buf, isSession, _1, _2));
     }
     
     startAccept();
@@ -390,7 +418,7 @@ void Server::runService()
     service_.run();
 }
 
-bool Server::sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer)
+bool Server::sendAnswerCmd(socket_ptr sock, bool isSession, unsigned int requestId, const CMD_ANSWER &cmdAnswer)
 {
     std::stringstream stream;
     boost::archive::text_oarchive oa(stream, boost::archive::no_header);
@@ -399,6 +427,14 @@ bool Server::sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer)
     int length = (int)str.length();
     // send answer to client
     boost::system::error_code er;
+    if (isSession)
+    {
+        boost::asio::write(*sock, boost::asio::buffer(&requestId, sizeof(requestId)), boost::asio::transfer_exactly(sizeof(requestId)), er);
+        if (er.value())
+        {
+            return false;
+        }
+    }
     boost::asio::write(*sock, boost::asio::buffer(&length, sizeof(length)), boost::asio::transfer_exactly(sizeof(length)), er);
     if (er.value())
     {
@@ -419,6 +455,9 @@ void Server::run()
 {
     system("mkdir -p /var/run");
 
+    // before the app connects, it disables IPv6 again on its next connect to the VPN
+    ipv6Manager_.restoreSavedOnStartup();
+
     ::unlink(SOCK_PATH);
 
     boost::asio::local::stream_protocol::endpoint ep(SOCK_PATH);
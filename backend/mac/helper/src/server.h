@@ -15,6 +15,7 @@
 #include "wireguardadapter.h"
 #include "wireguardcontroller.h"
 #include "installer/files.h"
+#include "network_services/ipv6_manager.h"
 
 typedef boost::shared_ptr<boost::asio::local::stream_protocol::socket> socket_ptr;
 
@@ -28,19 +29,23 @@ public:
 private:
     SplitTunneling splitTunneling_;
     WireGuardController wireGuardController_;
+    Ipv6Manager ipv6Manager_;
     boost::asio::io_service service_;
     boost::asio::local::stream_protocol::acceptor *acceptor_;
     
     Files *files_;
    
-    bool readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer);
+    // isSession is set after HELPER_CMD_OPEN_SESSION, then the commands and the answers are prefixed with the request ids
+    bool readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, bool isSession, unsigned int &outRequestId,
+                              int &outCmdId, CMD_ANSWER &outCmdAnswer);
     
-    void receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, const boost::system::error_code& ec, std::size_t bytes_transferred);
+    void receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, boost::shared_ptr<bool> isSession,
+                          const boost::system::error_code& ec, std::size_t bytes_transferred);
     void acceptHandler(const boost::system::error_code & ec, socket_ptr sock);
     void startAccept();
     void runService();
     
-    bool sendAnswerCmd(socket_ptr sock, const CMD_ANSWER &cmdAnswer);
+    bool sendAnswerCmd(socket_ptr sock, bool isSession, unsigned int requestId, const CMD_ANSWER &cmdAnswer);
 };
 
 #endif /* defined(____Server__) */
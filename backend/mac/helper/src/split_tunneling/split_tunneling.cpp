@@ -1,8 +1,10 @@
 #include "split_tunneling.h"
 #include "utils.h"
 #include "logger.h"
+#include <algorithm>
+#include <iterator>
 
-SplitTunneling::SplitTunneling(): isExclude_(false)
+SplitTunneling::SplitTunneling(): isExclude_(false), isParamsSet_(false), policyVersion_(0)
 {
     isSplitTunnelActive_ = false;
     isExclude_ = false;
@@ -35,18 +37,67 @@ void SplitTunneling::setSplitTunnelingParams(bool isActive, bool isExclude, cons
     std::lock_guard<std::mutex> guard(mutex_);
     
     LOG("isSplitTunnelingActive: %d, prisExcludeotocol: %d", isActive, isExclude);
+    
+    std::set<std::string> appsSet(apps.begin(), apps.end());
+    std::set<std::string> ipsAndHostsSet(ips.begin(), ips.end());
+    ipsAndHostsSet.insert(hosts.begin(), hosts.end());
+    
+    if (isParamsSet_ && isActive == isSplitTunnelActive_ && isExclude == isExclude_)
+    {
+        // the same mode, only the added and removed entries are applied, the kext stays connected
+        // and the routes of the other entries are untouched
+        std::vector<std::string> appsAdded, appsRemoved, ipsAdded, ipsRemoved;
+        diff(apps_, appsSet, appsAdded, appsRemoved);
+        diff(ipsAndHosts_, ipsAndHostsSet, ipsAdded, ipsRemoved);
+        
+        if (appsAdded.empty() && appsRemoved.empty() && ipsAdded.empty() && ipsRemoved.empty())
+        {
+            return;
+        }
+        
+        policyVersion_++;
+        LOG("Split tunneling policy version %u: apps +%zu -%zu, ips and hosts +%zu -%zu", policyVersion_,
+            appsAdded.size(), appsRemoved.size(), ipsAdded.size(), ipsRemoved.size());
+        
+        if (!appsAdded.empty() || !appsRemoved.empty())
+        {
+            kextClient_.updateApps(appsAdded, appsRemoved);
+        }
+        if (!ipsAdded.empty() || !ipsRemoved.empty())
+        {
+            ipHostnamesManager_.updateIps(ipsAdded, ipsRemoved);
+        }
+        
+        apps_.swap(appsSet);
+        ipsAndHosts_.swap(ipsAndHostsSet);
+        return;
+    }
+    
+    policyVersion_++;
+    LOG("Split tunneling policy version %u: full update", policyVersion_);
         
     isSplitTunnelActive_ = isActive;
     isExclude_ = isExclude;
+    isParamsSet_ = true;
+    apps_.swap(appsSet);
+    ipsAndHosts_.swap(ipsAndHostsSet);
     
-    kextClient_.setSplitTunnelingParams(isExclude, apps);
+    kextClient_.setSplitTunnelingParams(isExclude, std::vector<std::string>(apps_.begin(), apps_.end()));
     
-    ipHostnamesManager_.setSettings(isExclude, ips, hosts);
+    ipHostnamesManager_.setSettings(isExclude, std::vector<std::string>(ipsAndHosts_.begin(), ipsAndHosts_.end()),
+                                    std::vector<std::string>());
     
     routesManager_.updateState(connectStatus_, isSplitTunnelActive_, isExclude_);
     updateState();
 }
 
+// the entries of cur not in prev and the entries of prev not in cur
+void SplitTunneling::diff(const std::set<std::string> &prev, const std::set<std::string> &cur,
+                          std::vector<std::string> &added, std::vector<std::string> &removed)
+{
+    std::set_difference(cur.begin(), cur.end(), prev.begin(), prev.end(), std::back_inserter(added));
+    std::set_difference(prev.begin(), prev.end(), cur.begin(), cur.end(), std::back_inserter(removed));
+}
 
 void SplitTunneling::updateState()
 {
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <mutex>
+#include <set>
 #include <vector>
 #include "../kext_client/kext_client.h"
 #include "../routes_manager/routes_manager.h"
@@ -30,12 +31,20 @@ private:
     bool isSplitTunnelActive_;
     bool isExclude_;
     
+    // the last applied lists, a change of the lists only is applied as a delta (without updateState)
+    bool isParamsSet_;
+    unsigned int policyVersion_;
+    std::set<std::string> apps_;
+    std::set<std::string> ipsAndHosts_;
+    
     KextClient kextClient_;
     RoutesManager routesManager_;
     IpHostnamesManager ipHostnamesManager_;
         
     void updateState();
     
+    static void diff(const std::set<std::string> &prev, const std::set<std::string> &cur,
+                     std::vector<std::string> &added, std::vector<std::string> &removed);
 };
 
 #endif /* SplitTunneling_h */
@@ -17,13 +17,127 @@ const uint32_t no_requested_port = htonl((uint32_t)-1);
 // This is not vital information, so it's not the end of the world if it ultimately overflows and wraps around
 u_int32_t               connectionId = 1;
 
+// The connection buckets are the top 8 bits of the multiplicative hash
+#define CONN_HASH_SIZE 256
+#define APP_PATH_HASH_SIZE 64
+// Freed entries are kept for reuse up to this count, so the sockets churn doesn't go to OSMalloc
+#define MAX_FREE_CONN_ENTRIES 256
+
 TAILQ_HEAD(pia_connection_list, conn_entry);
+LIST_HEAD(conn_bucket, conn_entry);
+LIST_HEAD(app_path_bucket, app_path_entry);
 
 static struct pia_connection_list g_conn_list;
+static struct conn_bucket g_conn_by_pid[CONN_HASH_SIZE];
+static struct conn_bucket g_conn_by_port[CONN_HASH_SIZE];
+static struct app_path_bucket g_app_paths[APP_PATH_HASH_SIZE];
+
+// free list of the entries, linked with pid_link
+static struct conn_bucket g_free_conn_list;
+static uint32_t g_free_conn_count = 0;
+
+static inline uint32_t pid_bucket(int pid)
+{
+    return ((uint32_t)pid * 2654435761u) >> 24;
+}
+
+// Keyed by the port only: a connection bound to 0.0.0.0 matches any source IP
+static inline uint32_t port_bucket(uint32_t source_port)
+{
+    return (source_port * 2654435761u) >> 24;
+}
+
+// FNV-1a
+static uint32_t hash_string(const char *str)
+{
+    uint32_t h = 2166136261u;
+    for(; *str; ++str)
+    {
+        h ^= (uint8_t)*str;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Must be called with g_connection_mutex held
+static struct app_path_entry *intern_app_path(const char *app_path)
+{
+    const uint32_t hash = hash_string(app_path);
+    struct app_path_bucket *bucket = &g_app_paths[hash & (APP_PATH_HASH_SIZE - 1)];
+    struct app_path_entry *app;
+    LIST_FOREACH(app, bucket, link)
+    {
+        if(app->hash == hash && strcmp(app->path, app_path) == 0)
+        {
+            app->ref_count++;
+            return app;
+        }
+    }
+
+    // the path comes from the helper's response, it's at most PATH_MAX
+    const uint32_t alloc_size = (uint32_t)(sizeof(struct app_path_entry) + strlen(app_path) + 1);
+    app = pia_malloc(alloc_size);
+    if(!app) return NULL;
+    strncpy_(app->path, app_path, alloc_size - sizeof(struct app_path_entry));
+    app->hash = hash;
+    app->ref_count = 1;
+    app->alloc_size = alloc_size;
+    LIST_INSERT_HEAD(bucket, app, link);
+    return app;
+}
+
+// Must be called with g_connection_mutex held
+static void release_app_path(struct app_path_entry *app)
+{
+    if(app && --app->ref_count == 0)
+    {
+        LIST_REMOVE(app, link);
+        pia_free(app, app->alloc_size);
+    }
+}
+
+// Must be called with g_connection_mutex held
+static void unlink_conn(struct conn_entry *entry)
+{
+    TAILQ_REMOVE(&g_conn_list, entry, link);
+    LIST_REMOVE(entry, pid_link);
+    if(entry->in_port_hash)
+    {
+        LIST_REMOVE(entry, port_link);
+        entry->in_port_hash = false;
+    }
+    release_app_path(entry->app);
+    entry->app = NULL;
+}
+
+// Must be called with g_connection_mutex held
+static void free_conn(struct conn_entry *entry)
+{
+    if(g_free_conn_count < MAX_FREE_CONN_ENTRIES)
+    {
+        LIST_INSERT_HEAD(&g_free_conn_list, entry, pid_link);
+        g_free_conn_count++;
+    }
+    else
+    {
+        pia_free(entry, sizeof(struct conn_entry));
+    }
+}
 
 void init_conn_list()
 {
     TAILQ_INIT(&g_conn_list);
+    for(int i = 0; i < CONN_HASH_SIZE; ++i)
+    {
+        LIST_INIT(&g_conn_by_pid[i]);
+        LIST_INIT(&g_conn_by_port[i]);
+    }
+    for(int i = 0; i < APP_PATH_HASH_SIZE; ++i)
+    {
+        LIST_INIT(&g_app_paths[i]);
+    }
+    LIST_INIT(&g_free_conn_list);
+    g_free_conn_count = 0;
 }
 
 void cleanup_conn_list()
@@ -35,9 +149,15 @@ void cleanup_conn_list()
     for(entry = TAILQ_FIRST(&g_conn_list); entry; entry = next_entry)
     {
         next_entry = TAILQ_NEXT(entry, link);
-        TAILQ_REMOVE(&g_conn_list, entry, link);
+        unlink_conn(entry);
+        pia_free(entry, sizeof(struct conn_entry));
+    }
+    while((entry = LIST_FIRST(&g_free_conn_list)) != NULL)
+    {
+        LIST_REMOVE(entry, pid_link);
         pia_free(entry, sizeof(struct conn_entry));
     }
+    g_free_conn_count = 0;
     log("Deleted all connection entries");
     lck_mtx_unlock(g_connection_mutex);
 }
@@ -48,31 +168,49 @@ void conn_remove(struct conn_entry *entry)
         return;
     
     lck_mtx_lock(g_connection_mutex);
-    // Remove entry from list
-    TAILQ_REMOVE(&g_conn_list, entry, link);
-    
     log("id %d Removing an instance of: name %s with pid %d\n", entry->desc.id, entry->desc.name, entry->desc.pid);
+
+    // Remove entry from the list and the indexes
+    unlink_conn(entry);
     
-    // Free the memory for the entry
-    pia_free(entry, sizeof(struct conn_entry));
+    // Free the memory for the entry (or keep it for reuse)
+    free_conn(entry);
     
     lck_mtx_unlock(g_connection_mutex);
 }
 
+// Must be called with g_connection_mutex held
 static struct conn_entry *__internal_add_conn(const char *app_path, int pid,
                                               uint32_t bind_ip, int socket_type,
                                               enum connection_type_t connection_type,
                                               enum RuleType rule_type)
 {
-    struct conn_entry* entry = pia_malloc(sizeof(struct conn_entry));
-    if(!entry) return NULL;
+    struct conn_entry* entry = LIST_FIRST(&g_free_conn_list);
+    if(entry)
+    {
+        LIST_REMOVE(entry, pid_link);
+        g_free_conn_count--;
+        bzero(entry, sizeof(struct conn_entry));
+    }
+    else
+    {
+        entry = pia_malloc(sizeof(struct conn_entry));
+        if(!entry) return NULL;
+    }
+
+    entry->app = intern_app_path(app_path);
+    if(!entry->app)
+    {
+        free_conn(entry);
+        return NULL;
+    }
     
     // Increment the connection ID
     // A unique identifier for each connection so we can trace connection life-cycles in the logs
     OSIncrementAtomic(&connectionId);
     
-    strncpy_(entry->desc.name, basename(app_path), PATH_MAX);
-    strncpy_(entry->desc.path, app_path, PATH_MAX);
+    entry->desc.name = basename(entry->app->path);
+    entry->desc.path = entry->app->path;
     entry->desc.id = connectionId;
     entry->desc.pid = pid;
     entry->desc.bound = false;
@@ -87,6 +225,10 @@ static struct conn_entry *__internal_add_conn(const char *app_path, int pid,
     
     // Should be SOCK_STREAM or SOCK_DGRAM
     entry->desc.socket_type = socket_type;
+
+    entry->in_port_hash = false;
+    TAILQ_INSERT_TAIL(&g_conn_list, entry, link);
+    LIST_INSERT_HEAD(&g_conn_by_pid[pid_bucket(pid)], entry, pid_link);
     
     return entry;
 }
@@ -97,26 +239,47 @@ struct conn_entry *add_conn(const char *app_path, int pid, uint32_t bind_ip,
                             enum connection_type_t connection_type,
                             enum RuleType rule_type)
 {
+    lck_mtx_lock(g_connection_mutex);
     struct conn_entry* entry = __internal_add_conn(app_path, pid, bind_ip,
                                                    socket_type, connection_type,
                                                    rule_type);
-    if(!entry) return NULL;
-    
-    lck_mtx_lock(g_connection_mutex);
-    TAILQ_INSERT_TAIL(&g_conn_list, entry, link);
+    if(entry)
+    {
+        log("id %d Adding: name %s with pid %d\n", entry->desc.id, entry->desc.name, entry->desc.pid);
+    }
     lck_mtx_unlock(g_connection_mutex);
-    log("id %d Adding: name %s with pid %d\n", entry->desc.id, entry->desc.name, entry->desc.pid);
     
     return entry;
 }
 
+void conn_set_source(struct conn_entry *entry, uint32_t source_ip, uint32_t source_port)
+{
+    if(!entry)
+        return;
+
+    lck_mtx_lock(g_connection_mutex);
+    if(entry->in_port_hash && entry->desc.source_port != source_port)
+    {
+        LIST_REMOVE(entry, port_link);
+        entry->in_port_hash = false;
+    }
+    entry->desc.source_ip = source_ip;
+    entry->desc.source_port = source_port;
+    // connections without a source port never match a packet
+    if(!entry->in_port_hash && source_port)
+    {
+        LIST_INSERT_HEAD(&g_conn_by_port[port_bucket(source_port)], entry, port_link);
+        entry->in_port_hash = true;
+    }
+    lck_mtx_unlock(g_connection_mutex);
+}
+
 static struct conn_entry *
 __internal_find_conn_by_pid(int pid, enum connection_type_t connection_type)
 {
-    struct conn_entry *entry, *next_entry;
-    for(entry = TAILQ_FIRST(&g_conn_list); entry; entry = next_entry)
+    struct conn_entry *entry;
+    LIST_FOREACH(entry, &g_conn_by_pid[pid_bucket(pid)], pid_link)
     {
-        next_entry = TAILQ_NEXT(entry, link);
         if(entry->desc.pid == pid && (entry->desc.connection_type == connection_type || entry->desc.connection_type == any_connection))
         {
             return entry;
@@ -138,12 +301,10 @@ find_conn_by_pid(int pid, enum connection_type_t connection_type)
 bool matches_conn(uint32_t source_ip, uint32_t source_port, int pid)
 {
     bool foundMatch = false;
-    struct conn_entry *entry, *next_entry;
+    struct conn_entry *entry;
     lck_mtx_lock(g_connection_mutex);
-    for(entry = TAILQ_FIRST(&g_conn_list); entry; entry = next_entry)
+    LIST_FOREACH(entry, &g_conn_by_port[port_bucket(source_port)], port_link)
     {
-        next_entry = TAILQ_NEXT(entry, link);
-
         // The port must always match (this also ensures that connections that
         // don't have a source yet don't match all packets; source port is 0)
         if(source_port != entry->desc.source_port)
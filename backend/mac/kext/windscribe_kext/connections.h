@@ -29,11 +29,21 @@ enum RuleType
 
 extern const uint32_t no_requested_port;
 
+// The app paths are interned, the connections of an app share one copy.
+struct app_path_entry
+{
+    LIST_ENTRY(app_path_entry)     link;
+    uint32_t                       hash;
+    uint32_t                       ref_count;
+    uint32_t                       alloc_size;
+    char                           path[];
+};
+
 // All addresses/ports are in network byte order.
 struct connection_descriptor
 {
-    char name[PATH_MAX];
-    char path[PATH_MAX];
+    const char *name;   // points into path
+    const char *path;   // interned, valid while the entry exists
     int pid;
     
     // Once a source address has been observed for a socket (whether we bound it
@@ -43,6 +53,8 @@ struct connection_descriptor
     //
     // For IPv4, this always results in source_ip/source_port being set, but for
     // IPv6, we can only store an "any" address.
+    //
+    // The source is changed only with conn_set_source(), the entry is indexed by the source port.
     boolean_t bound;
     uint32_t source_ip;
     uint32_t source_port;
@@ -63,9 +75,15 @@ struct connection_descriptor
     int socket_type;
 };
 
+// Fixed-size entries, reused from a free list. Besides the list of all entries, they are
+// in the hash buckets by pid and by source port (when the source port is set).
 struct conn_entry
 {
     TAILQ_ENTRY(conn_entry)        link;
+    LIST_ENTRY(conn_entry)         pid_link;
+    LIST_ENTRY(conn_entry)         port_link;
+    boolean_t                      in_port_hash;
+    struct app_path_entry          *app;
     struct connection_descriptor   desc;
 };
 
@@ -81,6 +99,8 @@ struct conn_entry * find_conn_by_pid(int pid, enum connection_type_t connection_
 // * If the specified pid is nonzero, it must match the PID for the known
 //   connection.
 bool matches_conn(uint32_t source_ip, uint32_t source_port, int pid);
+// Set the observed source address of the connection (updates the index by the source port).
+void conn_set_source(struct conn_entry *entry, uint32_t source_ip, uint32_t source_port);
 void cleanup_conn_list(void);
 void conn_remove(struct conn_entry *entry);
 
@@ -8,11 +8,13 @@
 #include "mutexes.h"
 ///#include "conn_management.h"
 #include "utils.h"
+#include "verdict_cache.h"
 #include "windscribe_kext.h"
 
 
 // {set,get}sockopt() option identifiers
-#define KEXT_MSG_REPLY        0
+#define KEXT_MSG_REPLY                  0
+#define KEXT_MSG_INVALIDATE_VERDICTS    1   // the split tunneling or connect params have changed in the daemon
 
 int                     g_daemon_pid = -1;
 
@@ -139,6 +141,9 @@ errno_t ws_ctl_disconnect(kern_ctl_ref ctl_ref, u_int32_t unit, void *unitinfo)
     ctl_connected--;
     lck_mtx_unlock(g_message_mutex);
     
+    // the next daemon can have another policy
+    verdict_cache_invalidate_all();
+    
     char name[PATH_MAX] = {0};
     proc_selfname(name, sizeof(name));
     log("Client with pid %d and name %s disconnected, count connected clients %u\n", proc_selfpid(), name, ctl_connected);
@@ -206,6 +211,10 @@ errno_t ws_ctl_set(kern_ctl_ref ctl_ref, u_int32_t unit, void *unitinfo, int opt
             lck_mtx_unlock(g_message_mutex);
         }
         break;
+            
+    case KEXT_MSG_INVALIDATE_VERDICTS:
+        verdict_cache_invalidate_all();
+        break;
 
     default:
         ret = ENOTSUP;
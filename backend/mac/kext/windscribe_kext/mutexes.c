@@ -6,6 +6,7 @@ OSMallocTag             g_osm_tag = NULL;
 lck_grp_t               *g_mutex_group = NULL;
 lck_mtx_t               *g_message_mutex = NULL;
 lck_mtx_t               *g_connection_mutex = NULL;
+lck_mtx_t               *g_verdict_mutex = NULL;
 
 int setup_mutexes(void)
 {
@@ -26,6 +27,10 @@ int setup_mutexes(void)
     if (!g_message_mutex)
         return -1;
     
+    g_verdict_mutex = lck_mtx_alloc_init(g_mutex_group, LCK_ATTR_NULL);
+    if (!g_verdict_mutex)
+        return -1;
+    
     return 0;
 }
 
@@ -33,11 +38,13 @@ void cleanup_mutexes(void)
 {
     if(g_connection_mutex) lck_mtx_free(g_connection_mutex, g_mutex_group);
     if (g_message_mutex) lck_mtx_free(g_message_mutex, g_mutex_group);
+    if (g_verdict_mutex) lck_mtx_free(g_verdict_mutex, g_mutex_group);
     if (g_mutex_group) lck_grp_free(g_mutex_group);
     if (g_osm_tag) OSMalloc_Tagfree(g_osm_tag);
     
     g_connection_mutex = NULL;
     g_message_mutex = NULL;
+    g_verdict_mutex = NULL;
     g_mutex_group = NULL;
     g_osm_tag = NULL;
 }
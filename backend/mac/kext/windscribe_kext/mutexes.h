@@ -5,6 +5,7 @@
 
 extern lck_mtx_t               *g_message_mutex;
 extern lck_mtx_t               *g_connection_mutex;
+extern lck_mtx_t               *g_verdict_mutex;
 
 int setup_mutexes(void);
 void cleanup_mutexes(void);
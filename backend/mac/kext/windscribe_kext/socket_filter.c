@@ -3,6 +3,7 @@
 #include "windscribe_kext.h"
 #include "messaging.h"
 #include "connections.h"
+#include "verdict_cache.h"
 
 #include <stddef.h>
 
@@ -163,8 +164,7 @@ static errno_t bind_attached_socket(socket_t so, struct conn_entry *entry, uint3
     }
     sock_getsockname(so, (struct sockaddr*)&source, sizeof(struct sockaddr));
 
-    entry->desc.source_ip = source.sin_addr.s_addr;
-    entry->desc.source_port = source.sin_port;
+    conn_set_source(entry, source.sin_addr.s_addr, source.sin_port);
     entry->desc.dest_ip = 0;
     entry->desc.dest_port = 0;
 
@@ -224,8 +224,7 @@ static errno_t check_inbound_socket(void *cookie, socket_t so,
 
         log("id %d Inbound socket (%s): %s", entry->desc.id, callback_name, addr);
         entry->desc.bound = true;
-        entry->desc.source_ip = source.sin_addr.s_addr;
-        entry->desc.source_port = source.sin_port;
+        conn_set_source(entry, source.sin_addr.s_addr, source.sin_port);
     }
 
     return 0;
@@ -275,8 +274,7 @@ static errno_t check_socket_rebind(void *cookie, socket_t so,
         {
             store_ip_and_port_addr(&source, addr, sizeof(addr));
             log("id %d Already bound (%s): %s", entry->desc.id, callback_name, addr);
-            entry->desc.source_ip = source.sin_addr.s_addr;
-            entry->desc.source_port = source.sin_port;
+            conn_set_source(entry, source.sin_addr.s_addr, source.sin_port);
             // If, somehow, we still have a requested port, then we failed to apply it
             if(entry->desc.requested_port != no_requested_port)
             {
@@ -336,16 +334,31 @@ static errno_t ws_attach(void **cookie, socket_t so)
     proc_selfname(name, PATH_MAX);
     pid = proc_selfpid();
     
-    proc_name(pid, pathbuf, sizeof(pathbuf));
-
     {
-        ProcQuery proc_query = { .command = VerifyApp, .pid = proc_selfpid(), .socket_type = socket_type };
-        ProcQuery proc_response = {0};
+        struct verdict verdict = {0};
         
-        if (send_message_and_wait_for_reply(&proc_query, &proc_response))
-            return ENOPOLICY;
+        // the daemon is asked only for the processes not in the cache
+        if (!verdict_cache_lookup(pid, &verdict, pathbuf, sizeof(pathbuf)))
+        {
+            ProcQuery proc_query = { .command = VerifyApp, .pid = pid, .socket_type = socket_type };
+            ProcQuery proc_response = {0};
+            const uint32_t generation = verdict_cache_generation();
+            
+            if (send_message_and_wait_for_reply(&proc_query, &proc_response))
+                return ENOPOLICY;
+            
+            verdict_cache_insert(pid, generation, proc_response.accept, proc_response.rule_type,
+                                 proc_response.bind_ip, proc_response.app_path);
+            
+            verdict.accept = proc_response.accept;
+            verdict.rule_type = proc_response.rule_type;
+            verdict.bind_ip = proc_response.bind_ip;
+            strncpy_(pathbuf, proc_response.app_path, sizeof(pathbuf));
+            pathbuf[sizeof(pathbuf) - 1] = 0;
+            verdict.app_path = pathbuf;
+        }
         
-        if (!proc_response.accept)
+        if (!verdict.accept)
         {
             // Verification was denied (the process was not in the exclusions list)
             // so we do not bind to this socket
@@ -353,10 +366,10 @@ static errno_t ws_attach(void **cookie, socket_t so)
         }
         
         // Add the connection to our connections list (this entry also serves as the cookie for our socket filter)
-        struct conn_entry *entry = add_conn(proc_response.app_path, proc_response.pid,
-                                            proc_response.bind_ip, socket_type,
+        struct conn_entry *entry = add_conn(verdict.app_path, pid,
+                                            verdict.bind_ip, socket_type,
                                             sflt_connection,
-                                            proc_response.rule_type);
+                                            verdict.rule_type);
         
         if(!entry)
             return ENOPOLICY;
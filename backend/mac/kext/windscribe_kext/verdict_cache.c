@@ -0,0 +1,184 @@
+#include "verdict_cache.h"
+#include "mutexes.h"
+#include "utils.h"
+
+#include <sys/systm.h>
+#include <sys/time.h>
+#include <sys/kauth.h>
+#include <sys/proc.h>
+#include <libkern/OSAtomic.h>
+
+// Must be a power of 2
+#define VERDICT_CACHE_SIZE  256
+#define VERDICT_TTL_SEC     30
+
+struct verdict_entry
+{
+    int pid;                    // 0 if the slot is empty
+    time_t expires;             // uptime seconds
+    uint32_t app_path_size;
+    struct verdict verdict;
+};
+
+static struct verdict_entry g_verdicts[VERDICT_CACHE_SIZE];
+static uint32_t g_generation = 0;
+
+static kauth_listener_t g_exec_listener = NULL;
+static SInt32 g_exec_listener_calls = 0;
+
+static time_t uptime_sec(void)
+{
+    struct timeval tv;
+    microuptime(&tv);
+    return tv.tv_sec;
+}
+
+// Must be called with g_verdict_mutex held
+static void clear_entry(struct verdict_entry *entry)
+{
+    if(entry->verdict.app_path)
+        pia_free(entry->verdict.app_path, entry->app_path_size);
+    bzero(entry, sizeof(struct verdict_entry));
+}
+
+// The exec'ing process is the current one, it can be another app now
+static int exec_listener(kauth_cred_t credential, void *idata, kauth_action_t action,
+                         uintptr_t arg0, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+    OSIncrementAtomic(&g_exec_listener_calls);
+    if(action == KAUTH_FILEOP_EXEC)
+        verdict_cache_invalidate_pid(proc_selfpid());
+    OSDecrementAtomic(&g_exec_listener_calls);
+    return KAUTH_RESULT_DEFER;
+}
+
+int init_verdict_cache(void)
+{
+    bzero(g_verdicts, sizeof(g_verdicts));
+    g_exec_listener = kauth_listen_scope(KAUTH_SCOPE_FILEOP, exec_listener, NULL);
+    if(!g_exec_listener)
+    {
+        log("Could not register the exec listener\n");
+        return -1;
+    }
+    return 0;
+}
+
+void cleanup_verdict_cache(void)
+{
+    if(g_exec_listener)
+    {
+        kauth_unlisten_scope(g_exec_listener);
+        g_exec_listener = NULL;
+        
+        // kauth_unlisten_scope() doesn't wait for the callbacks already running
+        while(g_exec_listener_calls > 0)
+        {
+            struct timespec ts = { .tv_sec = 0, .tv_nsec = 10000000 };
+            msleep(&g_exec_listener_calls, NULL, 0, "cleanup_verdict_cache", &ts);
+        }
+    }
+    
+    if(g_verdict_mutex)
+        verdict_cache_invalidate_all();
+}
+
+uint32_t verdict_cache_generation(void)
+{
+    lck_mtx_lock(g_verdict_mutex);
+    uint32_t generation = g_generation;
+    lck_mtx_unlock(g_verdict_mutex);
+    return generation;
+}
+
+bool verdict_cache_lookup(int pid, struct verdict *out, char *app_path_buf, size_t app_path_buf_size)
+{
+    bool found = false;
+    
+    lck_mtx_lock(g_verdict_mutex);
+    struct verdict_entry *entry = &g_verdicts[pid & (VERDICT_CACHE_SIZE - 1)];
+    if(entry->pid == pid)
+    {
+        if(entry->expires <= uptime_sec())
+        {
+            clear_entry(entry);
+        }
+        else
+        {
+            *out = entry->verdict;
+            out->app_path = NULL;
+            if(entry->verdict.app_path)
+            {
+                strncpy_(app_path_buf, entry->verdict.app_path, app_path_buf_size);
+                app_path_buf[app_path_buf_size - 1] = 0;
+                out->app_path = app_path_buf;
+            }
+            found = true;
+        }
+    }
+    lck_mtx_unlock(g_verdict_mutex);
+    
+    return found;
+}
+
+void verdict_cache_insert(int pid, uint32_t generation, int accept, enum RuleType rule_type,
+                          uint32_t bind_ip, const char *app_path)
+{
+    if(pid <= 0)
+        return;
+    
+    // allocated before taking the lock, the path comes from the helper's response, it's at most PATH_MAX
+    char *path_copy = NULL;
+    uint32_t path_size = 0;
+    if(accept)
+    {
+        path_size = (uint32_t)strlen(app_path) + 1;
+        path_copy = pia_malloc(path_size);
+        if(!path_copy)
+            return;
+        strncpy_(path_copy, app_path, path_size);
+    }
+    
+    lck_mtx_lock(g_verdict_mutex);
+    if(generation == g_generation)
+    {
+        // a collision replaces the older process
+        struct verdict_entry *entry = &g_verdicts[pid & (VERDICT_CACHE_SIZE - 1)];
+        clear_entry(entry);
+        entry->pid = pid;
+        entry->expires = uptime_sec() + VERDICT_TTL_SEC;
+        entry->app_path_size = path_size;
+        entry->verdict.accept = accept;
+        entry->verdict.rule_type = rule_type;
+        entry->verdict.bind_ip = bind_ip;
+        entry->verdict.app_path = path_copy;
+        path_copy = NULL;
+    }
+    lck_mtx_unlock(g_verdict_mutex);
+    
+    // the policy has changed while the daemon was asked
+    if(path_copy)
+        pia_free(path_copy, path_size);
+}
+
+void verdict_cache_invalidate_pid(int pid)
+{
+    lck_mtx_lock(g_verdict_mutex);
+    struct verdict_entry *entry = &g_verdicts[pid & (VERDICT_CACHE_SIZE - 1)];
+    if(entry->pid == pid)
+        clear_entry(entry);
+    lck_mtx_unlock(g_verdict_mutex);
+}
+
+void verdict_cache_invalidate_all(void)
+{
+    lck_mtx_lock(g_verdict_mutex);
+    g_generation++;
+    for(int i = 0; i < VERDICT_CACHE_SIZE; ++i)
+    {
+        if(g_verdicts[i].pid)
+            clear_entry(&g_verdicts[i]);
+    }
+    lck_mtx_unlock(g_verdict_mutex);
+    log_debug("Verdict cache invalidated, generation %u", g_generation);
+}
@@ -0,0 +1,31 @@
+#ifndef verdict_cache_h
+#define verdict_cache_h
+
+#include <sys/types.h>
+#include "connections.h"
+
+// The verdicts of the daemon for the processes, so the sockets of a known process don't wait for an
+// upcall to the daemon. The table is direct-mapped by pid. An entry is dropped when the process
+// calls exec (kauth fileop listener), on a policy change in the daemon (ws_ctl_set), when the daemon
+// disconnects, and after VERDICT_TTL_SEC (the pid could be reused after the process has exited).
+struct verdict
+{
+    int accept;
+    enum RuleType rule_type;
+    uint32_t bind_ip;
+    char *app_path;     // allocated only for the accepted processes, NULL otherwise
+};
+
+int init_verdict_cache(void);
+void cleanup_verdict_cache(void);
+
+// The generation changes with each invalidation, the verdict of an upcall started before it is not stored.
+uint32_t verdict_cache_generation(void);
+// Returns true and copies the verdict (app_path into the buffer) if the pid is in the cache.
+bool verdict_cache_lookup(int pid, struct verdict *out, char *app_path_buf, size_t app_path_buf_size);
+void verdict_cache_insert(int pid, uint32_t generation, int accept, enum RuleType rule_type,
+                          uint32_t bind_ip, const char *app_path);
+void verdict_cache_invalidate_pid(int pid);
+void verdict_cache_invalidate_all(void);
+
+#endif /* verdict_cache_h */
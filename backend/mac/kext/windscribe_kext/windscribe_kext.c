@@ -11,6 +11,7 @@
 #include "mutexes.h"
 #include "socket_filter.h"
 #include "connections.h"
+#include "verdict_cache.h"
 
 
 kern_return_t WindscribeKext_start(kmod_info_t * ki, void *d)
@@ -22,6 +23,11 @@ kern_return_t WindscribeKext_start(kmod_info_t * ki, void *d)
         goto bail;
     }
     
+    if (init_verdict_cache())
+    {
+        goto bail;
+    }
+    
     if (register_kernel_control())
     {
         goto bail;
@@ -36,9 +42,10 @@ kern_return_t WindscribeKext_start(kmod_info_t * ki, void *d)
     return KERN_SUCCESS;
 
 bail:
-    cleanup_mutexes();
     unregister_kernel_control();
     unregister_socket_filters();
+    cleanup_verdict_cache();
+    cleanup_mutexes();
     log("Windscribe kext failed to start.\n");
 
     return KERN_FAILURE;
@@ -59,6 +66,7 @@ kern_return_t WindscribeKext_stop(kmod_info_t *ki, void *d)
     }
     
     cleanup_conn_list();
+    cleanup_verdict_cache();
     cleanup_mutexes();
     
     log("Windscribe kext stopped.\n");
@@ -25,6 +25,19 @@
 
 #define HELPER_CMD_APPLY_CUSTOM_DNS             15
 
+// answered with executed = 1 by the helpers which support it, after that each command of the connection is prefixed
+// with a request id (unsigned int) and each answer with the request id of its command, so the client can send
+// the next commands without waiting for the answers (the commands are still executed and answered in order)
+#define HELPER_CMD_OPEN_SESSION                 16
+
+// mac only, IPv6 of all the network services in one transaction
+#define HELPER_CMD_SET_IPV6_ENABLED             17
+
+// linux only, answered when the unblocking command finishes or prints something, or after the timeout:
+// executed = 1 finished, 2 still executing, the body is the output since the previous wait
+// (answered with executed = 0 by the helpers which don't support it)
+#define HELPER_CMD_WAIT_CMD_STATUS              18
+
 
 
 
@@ -47,6 +60,12 @@ struct CMD_CLEAR_CMDS
 {
 };
 
+struct CMD_WAIT_CMD_STATUS
+{
+    unsigned long cmdId;
+    unsigned int timeoutMs;
+};
+
 struct CMD_SET_KEYCHAIN_ITEM
 {
     std::string username;
@@ -162,4 +181,9 @@ struct CMD_APPLY_CUSTOM_DNS
     std::string networkService;
 };
 
+struct CMD_SET_IPV6_ENABLED
+{
+    bool isEnabled;
+};
+
 #endif
@@ -41,6 +41,14 @@ void serialize(Archive &ar, CMD_GET_CMD_STATUS &a, const unsigned int version)
     ar & a.cmdId;
 }
 
+template<class Archive>
+void serialize(Archive &ar, CMD_WAIT_CMD_STATUS &a, const unsigned int version)
+{
+    UNUSED(version);
+    ar & a.cmdId;
+    ar & a.timeoutMs;
+}
+
 template<class Archive>
 void serialize(Archive &ar, CMD_CLEAR_CMDS &a, const unsigned int version)
 {
@@ -147,6 +155,13 @@ void serialize(Archive &ar, CMD_APPLY_CUSTOM_DNS &a, const unsigned int version)
     ar & a.networkService;
 }
 
+template<class Archive>
+void serialize(Archive &ar, CMD_SET_IPV6_ENABLED &a, const unsigned int version)
+{
+    UNUSED(version);
+    ar & a.isEnabled;
+}
+
 }
 }
 
@@ -0,0 +1,183 @@
+#include <ntddk.h>
+#pragma warning(disable : 4201)
+#include <fwpsk.h>
+
+#include "AppTable.h"
+#include "WindscribeCallout.h"
+
+#define APP_TABLE_POOL_TAG	'tAsW'
+
+typedef struct APP_SLOT_
+{
+	UINT32 hash;
+	UINT32 size;
+	const UINT8 *data;		// NULL if the slot is empty
+	UINT32 index;
+} APP_SLOT;
+
+typedef struct APP_TABLE_
+{
+	UINT32 version;
+	UINT32 slotMask;		// the slot count is a power of 2
+	APP_SLOT *slots;
+	UINT8 *ids;				// the copy of the ioctl input
+} APP_TABLE;
+
+static EX_SPIN_LOCK g_appTableLock = 0;
+static APP_TABLE *g_appTable = NULL;
+
+static UINT32 HashAppId(const UINT8 *data, UINT32 size)
+{
+	// FNV-1a
+	UINT32 hash = 2166136261;
+	for (UINT32 i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+static VOID FreeTable(APP_TABLE *table)
+{
+	if (table)
+	{
+		if (table->slots)
+		{
+			ExFreePoolWithTag(table->slots, APP_TABLE_POOL_TAG);
+		}
+		if (table->ids)
+		{
+			ExFreePoolWithTag(table->ids, APP_TABLE_POOL_TAG);
+		}
+		ExFreePoolWithTag(table, APP_TABLE_POOL_TAG);
+	}
+}
+
+VOID AppTableInit()
+{
+	g_appTableLock = 0;
+	g_appTable = NULL;
+}
+
+VOID AppTableFree()
+{
+	KIRQL oldIrql = ExAcquireSpinLockExclusive(&g_appTableLock);
+	APP_TABLE *table = g_appTable;
+	g_appTable = NULL;
+	ExReleaseSpinLockExclusive(&g_appTableLock, oldIrql);
+
+	FreeTable(table);
+}
+
+NTSTATUS AppTableSet(_In_reads_bytes_(size) const VOID *data, SIZE_T size)
+{
+	if (size < sizeof(WINDSCRIBE_APPS_HEADER))
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+	const WINDSCRIBE_APPS_HEADER *header = (const WINDSCRIBE_APPS_HEADER *)data;
+	if (header->count > WINDSCRIBE_MAX_APPS)
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	APP_TABLE *table = (APP_TABLE *)ExAllocatePoolWithTag(NonPagedPool, sizeof(APP_TABLE), APP_TABLE_POOL_TAG);
+	if (!table)
+	{
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+	RtlZeroMemory(table, sizeof(APP_TABLE));
+	table->version = header->version;
+
+	// at most half full
+	UINT32 slotCount = 16;
+	while (slotCount < header->count * 2)
+	{
+		slotCount *= 2;
+	}
+	table->slotMask = slotCount - 1;
+	table->slots = (APP_SLOT *)ExAllocatePoolWithTag(NonPagedPool, slotCount * sizeof(APP_SLOT), APP_TABLE_POOL_TAG);
+	table->ids = (UINT8 *)ExAllocatePoolWithTag(NonPagedPool, size, APP_TABLE_POOL_TAG);
+	if (!table->slots || !table->ids)
+	{
+		FreeTable(table);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+	RtlZeroMemory(table->slots, slotCount * sizeof(APP_SLOT));
+	RtlCopyMemory(table->ids, data, size);
+
+	SIZE_T offset = sizeof(WINDSCRIBE_APPS_HEADER);
+	for (UINT32 i = 0; i < header->count; ++i)
+	{
+		if (offset + sizeof(UINT32) > size)
+		{
+			FreeTable(table);
+			return STATUS_INVALID_PARAMETER;
+		}
+		const UINT32 idSize = *(const UINT32 *)(table->ids + offset);
+		offset += sizeof(UINT32);
+		if (idSize == 0 || idSize > WINDSCRIBE_MAX_APP_ID_SIZE || offset + idSize > size)
+		{
+			FreeTable(table);
+			return STATUS_INVALID_PARAMETER;
+		}
+		const UINT8 *idData = table->ids + offset;
+		offset += (idSize + 3) & ~3;
+
+		const UINT32 hash = HashAppId(idData, idSize);
+		UINT32 slot = hash & table->slotMask;
+		while (table->slots[slot].data)
+		{
+			slot = (slot + 1) & table->slotMask;
+		}
+		table->slots[slot].hash = hash;
+		table->slots[slot].size = idSize;
+		table->slots[slot].data = idData;
+		table->slots[slot].index = i;
+	}
+
+	KIRQL oldIrql = ExAcquireSpinLockExclusive(&g_appTableLock);
+	APP_TABLE *oldTable = g_appTable;
+	g_appTable = table;
+	ExReleaseSpinLockExclusive(&g_appTableLock, oldIrql);
+
+	FreeTable(oldTable);
+
+	KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: apps table version %u, %u apps\n",
+		header->version, header->count));
+	return STATUS_SUCCESS;
+}
+
+BOOLEAN AppTableLookup(_In_ const FWP_BYTE_BLOB *appId, _Out_ UINT32 *version, _Out_ UINT32 *appIndex)
+{
+	BOOLEAN found = FALSE;
+	*version = 0;
+	*appIndex = MAXUINT32;
+
+	if (!appId || !appId->data || appId->size == 0)
+	{
+		return FALSE;
+	}
+	const UINT32 hash = HashAppId(appId->data, appId->size);
+
+	KIRQL oldIrql = ExAcquireSpinLockShared(&g_appTableLock);
+	const APP_TABLE *table = g_appTable;
+	if (table)
+	{
+		*version = table->version;
+		for (UINT32 slot = hash & table->slotMask; table->slots[slot].data; slot = (slot + 1) & table->slotMask)
+		{
+			const APP_SLOT *s = &table->slots[slot];
+			if (s->hash == hash && s->size == appId->size && RtlCompareMemory(s->data, appId->data, s->size) == s->size)
+			{
+				*appIndex = s->index;
+				found = TRUE;
+				break;
+			}
+		}
+	}
+	ExReleaseSpinLockShared(&g_appTableLock, oldIrql);
+
+	return found;
+}
@@ -0,0 +1,16 @@
+#ifndef APP_TABLE_H
+#define APP_TABLE_H
+
+// The app ids of the split tunnel (IOCTL_WINDSCRIBE_SET_APPS) in an open addressing hash table, so a single
+// filter serves all the apps with an O(1) lookup per flow. The table is replaced as a whole, the lookups
+// run under a shared spin lock at IRQL <= DISPATCH_LEVEL.
+
+VOID AppTableInit();
+VOID AppTableFree();
+
+NTSTATUS AppTableSet(_In_reads_bytes_(size) const VOID *data, SIZE_T size);
+
+// returns TRUE and the index of the app in the table if the app id is in the table
+BOOLEAN AppTableLookup(_In_ const FWP_BYTE_BLOB *appId, _Out_ UINT32 *version, _Out_ UINT32 *appIndex);
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "CalloutFunctions.h"
 #include "WindscribeCallout.h"
+#include "AppTable.h"
+#include "FlowEvents.h"
 
 #define IPV4_ADDRESS_LENGTH  4
 
@@ -26,7 +28,6 @@ ClassifyFn(
 	IN OUT FWPS_CLASSIFY_OUT0* classifyOut
 )
 {
-	UNREFERENCED_PARAMETER(inMetaValues);
 	UNREFERENCED_PARAMETER(flowContext);
 
 	NT_ASSERT(inFixedValues);
@@ -39,13 +40,30 @@ ClassifyFn(
 	NT_ASSERT(filter->providerContext);
 	NT_ASSERT(filter->providerContext->type == FWPM_GENERAL_CONTEXT);
 	NT_ASSERT(filter->providerContext->dataBuffer);
-	NT_ASSERT(filter->providerContext->dataBuffer->size == sizeof(WINDSCRIBE_CALLOUT_DATA));
+	NT_ASSERT(filter->providerContext->dataBuffer->size >= sizeof(UINT32));
 	NT_ASSERT(filter->providerContext->dataBuffer->data);
 
 	NTSTATUS status = STATUS_SUCCESS;
 	UINT64 classifyHandle = 0;
 	FWPS_BIND_REQUEST *bindRequest = NULL;
 	WINDSCRIBE_CALLOUT_DATA *calloutData = (WINDSCRIBE_CALLOUT_DATA *)filter->providerContext->dataBuffer->data;
+	WINDSCRIBE_FLOW_EVENT flowEvent = { 0 };
+
+	// the filter of the service without the flag has the app in its condition
+	if (filter->providerContext->dataBuffer->size >= sizeof(WINDSCRIBE_CALLOUT_DATA) &&
+		(calloutData->flags & WINDSCRIBE_CALLOUT_FLAG_APP_TABLE))
+	{
+		const FWP_VALUE0 *appIdValue = &inFixedValues->incomingValue[FWPS_FIELD_ALE_BIND_REDIRECT_V4_ALE_APP_ID].value;
+		if (appIdValue->type != FWP_BYTE_BLOB_TYPE ||
+			!AppTableLookup(appIdValue->byteBlob, &flowEvent.version, &flowEvent.appIndex))
+		{
+			return;
+		}
+	}
+	else
+	{
+		flowEvent.appIndex = MAXUINT32;
+	}
 
 	if (layerData && classifyContext)
 	{
@@ -88,6 +106,7 @@ ClassifyFn(
 
 			UINT32 addr;
 			RtlCopyMemory(&addr, INETADDR_ADDRESS((SOCKADDR *)&(bindRequest->localAddressAndPort)), IPV4_ADDRESS_LENGTH);
+			flowEvent.originalIp = addr;
 			UCHAR strIp[256];
 			ULONG len = 200;
 			HlprIPAddressV4ValueToString(addr, (PWSTR)strIp, &len);
@@ -101,6 +120,7 @@ ClassifyFn(
 			HlprIPAddressV4ValueToString(addr2, (PWSTR)strIp2, &len2);
 
 			KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: replaced %S -> %S\n", strIp, strIp2));
+			flowEvent.redirectedIp = addr2;
 
 			classifyOut->actionType = FWP_ACTION_PERMIT;
 
@@ -124,6 +144,14 @@ ClassifyFn(
 				}
 				classifyOut->actionType = FWP_ACTION_BLOCK;
 			}
+
+			KeQuerySystemTime((PLARGE_INTEGER)&flowEvent.time);
+			if (FWPS_IS_METADATA_FIELD_PRESENT(inMetaValues, FWPS_METADATA_FIELD_PROCESS_ID))
+			{
+				flowEvent.processId = inMetaValues->processId;
+			}
+			flowEvent.status = status;
+			FlowEventsAdd(&flowEvent);
 		}
 	}
 }
@@ -4,12 +4,15 @@
 #include <fwpsk.h>
 #include "WindscribeCallout.h"
 #include "CalloutFunctions.h"
+#include "AppTable.h"
+#include "FlowEvents.h"
 
 WDFDEVICE wdfDevice = NULL;
 // Variable for the run-time callout identifier
 UINT32 CalloutId = 0;
 
 EVT_WDF_DRIVER_UNLOAD UnloadFunc;
+EVT_WDF_IO_QUEUE_IO_DEVICE_CONTROL DeviceControlFunc;
 
 NTSTATUS
 DriverEntry(
@@ -23,6 +26,12 @@ DriverEntry(
 	PWDFDEVICE_INIT deviceInit;
 	PDEVICE_OBJECT deviceObject = NULL;
 	FWPS_CALLOUT1 callout = { 0 };
+	WDF_IO_QUEUE_CONFIG queueConfig;
+	DECLARE_CONST_UNICODE_STRING(deviceName, WINDSCRIBE_SPLIT_TUNNEL_DEVICE_NAME);
+	DECLARE_CONST_UNICODE_STRING(symlinkName, WINDSCRIBE_SPLIT_TUNNEL_SYMLINK_NAME);
+
+	AppTableInit();
+	FlowEventsInit();
 
 	// Initialize the driver configuration object
 	WDF_DRIVER_CONFIG_INIT(&config, WDF_NO_EVENT_CALLBACK);
@@ -39,8 +48,8 @@ DriverEntry(
 		return status;
 	}
 
-	// Allocate a device initialization structure
-	deviceInit = WdfControlDeviceInitAllocate(driver, &SDDL_DEVOBJ_KERNEL_ONLY);
+	// Allocate a device initialization structure, the service (LocalSystem) sends the ioctls
+	deviceInit = WdfControlDeviceInitAllocate(driver, &SDDL_DEVOBJ_SYS_ALL_ADM_ALL);
 	if (deviceInit == NULL)
 	{
 		KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: WdfControlDeviceInitAllocate failed\n"));
@@ -50,7 +59,13 @@ DriverEntry(
 	// Set the device characteristics
 	WdfDeviceInitSetCharacteristics(deviceInit, FILE_DEVICE_SECURE_OPEN, FALSE);
 	WdfDeviceInitSetDeviceType(deviceInit, FILE_DEVICE_NETWORK);
-	WdfDeviceInitSetCharacteristics(deviceInit, FILE_AUTOGENERATED_DEVICE_NAME, TRUE);
+	status = WdfDeviceInitAssignName(deviceInit, &deviceName);
+	if (status != STATUS_SUCCESS)
+	{
+		KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: WdfDeviceInitAssignName failed\n"));
+		WdfDeviceInitFree(deviceInit);
+		return status;
+	}
 
 	// Create a framework device object
 	status = WdfDeviceCreate(&deviceInit, WDF_NO_OBJECT_ATTRIBUTES, &wdfDevice);
@@ -58,6 +73,22 @@ DriverEntry(
 	// Check status
 	if (status == STATUS_SUCCESS) 
 	{
+		status = WdfDeviceCreateSymbolicLink(wdfDevice, &symlinkName);
+		if (status != STATUS_SUCCESS)
+		{
+			KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: WdfDeviceCreateSymbolicLink failed\n"));
+			return status;
+		}
+
+		WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(&queueConfig, WdfIoQueueDispatchSequential);
+		queueConfig.EvtIoDeviceControl = DeviceControlFunc;
+		status = WdfIoQueueCreate(wdfDevice, &queueConfig, WDF_NO_OBJECT_ATTRIBUTES, WDF_NO_HANDLE);
+		if (status != STATUS_SUCCESS)
+		{
+			KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: WdfIoQueueCreate failed\n"));
+			return status;
+		}
+
 		// Initialization of the framework device object is complete
 		WdfControlFinishInitializing(wdfDevice);
 
@@ -105,5 +136,36 @@ VOID UnloadFunc(_In_ WDFDRIVER Driver)
 	// Delete the framework device object
 	WdfObjectDelete(wdfDevice);
 
+	AppTableFree();
+
 	KdPrintEx((DPFLTR_IHVDRIVER_ID, DPFLTR_INFO_LEVEL, "WindscribeSplitTunnel: UnloadFunc finished successfully\n"));
-}
\ No newline at end of file
+}
+
+VOID DeviceControlFunc(_In_ WDFQUEUE Queue, _In_ WDFREQUEST Request, _In_ size_t OutputBufferLength,
+	_In_ size_t InputBufferLength, _In_ ULONG IoControlCode)
+{
+	UNREFERENCED_PARAMETER(Queue);
+	NTSTATUS status = STATUS_INVALID_DEVICE_REQUEST;
+	ULONG_PTR information = 0;
+	PVOID buffer = NULL;
+	size_t bufferSize = 0;
+
+	if (IoControlCode == IOCTL_WINDSCRIBE_SET_APPS)
+	{
+		status = WdfRequestRetrieveInputBuffer(Request, sizeof(WINDSCRIBE_APPS_HEADER), &buffer, &bufferSize);
+		if (status == STATUS_SUCCESS)
+		{
+			status = AppTableSet(buffer, min(bufferSize, InputBufferLength));
+		}
+	}
+	else if (IoControlCode == IOCTL_WINDSCRIBE_GET_EVENTS)
+	{
+		status = WdfRequestRetrieveOutputBuffer(Request, sizeof(WINDSCRIBE_EVENTS_HEADER), &buffer, &bufferSize);
+		if (status == STATUS_SUCCESS)
+		{
+			information = FlowEventsRead(buffer, min(bufferSize, OutputBufferLength));
+		}
+	}
+
+	WdfRequestCompleteWithInformation(Request, status, information);
+}
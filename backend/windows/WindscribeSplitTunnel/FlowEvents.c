@@ -0,0 +1,63 @@
+#include <ntddk.h>
+
+#include "FlowEvents.h"
+
+static KSPIN_LOCK g_flowEventsLock;
+static WINDSCRIBE_FLOW_EVENT g_flowEvents[FLOW_EVENTS_COUNT];
+static UINT32 g_flowEventsHead = 0;		// the next write
+static UINT32 g_flowEventsCount = 0;
+static UINT32 g_flowEventsDropped = 0;
+
+VOID FlowEventsInit()
+{
+	KeInitializeSpinLock(&g_flowEventsLock);
+	g_flowEventsHead = 0;
+	g_flowEventsCount = 0;
+	g_flowEventsDropped = 0;
+}
+
+VOID FlowEventsAdd(_In_ const WINDSCRIBE_FLOW_EVENT *flowEvent)
+{
+	KIRQL oldIrql;
+	KeAcquireSpinLock(&g_flowEventsLock, &oldIrql);
+	g_flowEvents[g_flowEventsHead] = *flowEvent;
+	g_flowEventsHead = (g_flowEventsHead + 1) % FLOW_EVENTS_COUNT;
+	if (g_flowEventsCount < FLOW_EVENTS_COUNT)
+	{
+		g_flowEventsCount++;
+	}
+	else
+	{
+		g_flowEventsDropped++;
+	}
+	KeReleaseSpinLock(&g_flowEventsLock, oldIrql);
+}
+
+SIZE_T FlowEventsRead(_Out_writes_bytes_(size) VOID *buffer, SIZE_T size)
+{
+	if (size < sizeof(WINDSCRIBE_EVENTS_HEADER))
+	{
+		return 0;
+	}
+	WINDSCRIBE_EVENTS_HEADER *header = (WINDSCRIBE_EVENTS_HEADER *)buffer;
+	WINDSCRIBE_FLOW_EVENT *events = (WINDSCRIBE_FLOW_EVENT *)(header + 1);
+	const SIZE_T maxCount = (size - sizeof(WINDSCRIBE_EVENTS_HEADER)) / sizeof(WINDSCRIBE_FLOW_EVENT);
+
+	KIRQL oldIrql;
+	KeAcquireSpinLock(&g_flowEventsLock, &oldIrql);
+	const UINT32 count = (UINT32)min(maxCount, g_flowEventsCount);
+	// the oldest first
+	UINT32 ind = (g_flowEventsHead + FLOW_EVENTS_COUNT - g_flowEventsCount) % FLOW_EVENTS_COUNT;
+	for (UINT32 i = 0; i < count; ++i)
+	{
+		events[i] = g_flowEvents[ind];
+		ind = (ind + 1) % FLOW_EVENTS_COUNT;
+	}
+	g_flowEventsCount -= count;
+	header->count = count;
+	header->dropped = g_flowEventsDropped;
+	g_flowEventsDropped = 0;
+	KeReleaseSpinLock(&g_flowEventsLock, oldIrql);
+
+	return sizeof(WINDSCRIBE_EVENTS_HEADER) + count * sizeof(WINDSCRIBE_FLOW_EVENT);
+}
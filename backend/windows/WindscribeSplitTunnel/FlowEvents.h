@@ -0,0 +1,16 @@
+#ifndef FLOW_EVENTS_H
+#define FLOW_EVENTS_H
+
+#include "WindscribeCallout.h"
+
+// The redirected flows for the diagnostics of the service, a ring of the last FLOW_EVENTS_COUNT events
+// which is drained by IOCTL_WINDSCRIBE_GET_EVENTS. Safe at IRQL <= DISPATCH_LEVEL.
+
+#define FLOW_EVENTS_COUNT	1024
+
+VOID FlowEventsInit();
+VOID FlowEventsAdd(_In_ const WINDSCRIBE_FLOW_EVENT *flowEvent);
+// copies the events which fit into the buffer and removes them from the ring, returns the size written
+SIZE_T FlowEventsRead(_Out_writes_bytes_(size) VOID *buffer, SIZE_T size);
+
+#endif
@@ -12,9 +12,53 @@ DEFINE_GUID(
 );
 
 
+// the filter matches all apps, the callout redirects only the apps of the table (IOCTL_WINDSCRIBE_SET_APPS);
+// without the flag the filter matches one app
+#define WINDSCRIBE_CALLOUT_FLAG_APP_TABLE	0x1
+
 typedef struct WINDSCRIBE_CALLOUT_DATA_
 {
 	UINT32 localIp;
+	UINT32 flags;
 } WINDSCRIBE_CALLOUT_DATA;
 
+
+// The control device of the driver (\\.\WindscribeSplitTunnel for the service), the same definitions are in
+// windscribe_service/split_tunneling/callout_filter.cpp
+#define WINDSCRIBE_SPLIT_TUNNEL_DEVICE_NAME		L"\\Device\\WindscribeSplitTunnel"
+#define WINDSCRIBE_SPLIT_TUNNEL_SYMLINK_NAME	L"\\DosDevices\\WindscribeSplitTunnel"
+
+// Input: WINDSCRIBE_APPS_HEADER followed by the app ids, each one is a UINT32 size and the bytes, padded to 4 bytes.
+// The table replaces the previous one.
+#define IOCTL_WINDSCRIBE_SET_APPS	CTL_CODE(FILE_DEVICE_NETWORK, 0x800, METHOD_BUFFERED, FILE_WRITE_ACCESS)
+// Output: WINDSCRIBE_EVENTS_HEADER followed by the flow events, the oldest first. The events are removed from the ring.
+#define IOCTL_WINDSCRIBE_GET_EVENTS	CTL_CODE(FILE_DEVICE_NETWORK, 0x801, METHOD_BUFFERED, FILE_READ_ACCESS)
+
+#define WINDSCRIBE_MAX_APPS			65536
+#define WINDSCRIBE_MAX_APP_ID_SIZE	4096
+
+typedef struct WINDSCRIBE_APPS_HEADER_
+{
+	UINT32 version;
+	UINT32 count;
+} WINDSCRIBE_APPS_HEADER;
+
+typedef struct WINDSCRIBE_FLOW_EVENT_
+{
+	UINT64 time;			// system time, 100 ns units
+	UINT64 processId;
+	UINT32 version;			// of the apps table, 0 if none
+	UINT32 appIndex;		// in the apps table, MAXUINT32 if none
+	UINT32 originalIp;
+	UINT32 redirectedIp;
+	INT32 status;
+	UINT32 reserved;
+} WINDSCRIBE_FLOW_EVENT;
+
+typedef struct WINDSCRIBE_EVENTS_HEADER_
+{
+	UINT32 count;
+	UINT32 dropped;			// overwritten in the ring since the last read
+} WINDSCRIBE_EVENTS_HEADER;
+
 #endif
@@ -1,29 +1,15 @@
 #include "all_headers.h"
 #include "adapters_info.h"
 #include "logger.h"
+#include "network_snapshot.h"
 
-AdaptersInfo::AdaptersInfo()
+AdaptersInfo::AdaptersInfo(bool isRefresh)
 {
-	ULONG ulAdapterInfoSize = 4096;
-    adapterInfoBuffer_.reset(new unsigned char[ulAdapterInfoSize]);
-
-    DWORD result = ::GetAdaptersAddresses(AF_UNSPEC, NULL, NULL, (PIP_ADAPTER_ADDRESSES)adapterInfoBuffer_.get(), &ulAdapterInfoSize);
-
-	if (result == ERROR_BUFFER_OVERFLOW)
+	adapterInfoBuffer_ = NetworkSnapshot::instance().adapters(isRefresh);
+	if (adapterInfoBuffer_)
 	{
-        adapterInfoBuffer_.reset(new unsigned char[ulAdapterInfoSize]);
-        result = ::GetAdaptersAddresses(AF_UNSPEC, NULL, NULL, (PIP_ADAPTER_ADDRESSES)adapterInfoBuffer_.get(), &ulAdapterInfoSize);
-    }
-
-	if (result == ERROR_SUCCESS)
-	{
-		pAdapterInfo_ = (PIP_ADAPTER_ADDRESSES)adapterInfoBuffer_.get();
+		pAdapterInfo_ = (PIP_ADAPTER_ADDRESSES)&(*adapterInfoBuffer_)[0];
 	}
-	else
-	{
-        adapterInfoBuffer_.reset();
-        Logger::instance().out(L"AdaptersInfo - GetAdaptersAddresses failed %lu", ::GetLastError());
-    }
 }
 
 
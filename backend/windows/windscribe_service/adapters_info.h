@@ -1,17 +1,18 @@
 #pragma once
 
-// wrapper for API GetAdaptersAddresses and util functions
+// wrapper for the adapters snapshot (GetAdaptersAddresses) and util functions
 class AdaptersInfo
 {
 public:
-	AdaptersInfo();
+	// isRefresh for a fresh snapshot, when the adapter may have just appeared
+	explicit AdaptersInfo(bool isRefresh = false);
 
 	bool isWindscribeAdapter(NET_IFINDEX index) const;
 	bool getWindscribeIkev2AdapterInfo(NET_IFINDEX &outIfIndex, std::wstring &outIp);
 	std::vector<NET_IFINDEX> getTAPAdapters();
 
 private:
-	std::unique_ptr< unsigned char[] > adapterInfoBuffer_;
+	std::shared_ptr<const std::vector<unsigned char>> adapterInfoBuffer_;
     PIP_ADAPTER_ADDRESSES pAdapterInfo_ = NULL;
 
 private:
@@ -30,6 +30,8 @@
 #define BOOST_AUTO_LINK_TAGGED 1
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/string.hpp>
 
@@ -37,6 +39,7 @@
 // C RunTime Header Files
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <mutex>
 #include <vector>
 #include <map>
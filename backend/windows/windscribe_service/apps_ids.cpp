@@ -2,6 +2,9 @@
 #include "apps_ids.h"
 #include "utils.h"
 
+std::mutex AppsIds::cacheMutex_;
+std::map<std::wstring, AppsIds::CachedAppId> AppsIds::cache_;
+
 AppsIds::AppsIds() 
 {
 }
@@ -90,19 +93,55 @@ void AppsIds::addFromListImpl(const std::vector<std::wstring> &apps)
 {
 	for (auto it = apps.begin(); it != apps.end(); ++it)
 	{
-		FWP_BYTE_BLOB *fwpApplicationByteBlob = NULL;
-		if (FwpmGetAppIdFromFileName(it->c_str(), &fwpApplicationByteBlob) == ERROR_SUCCESS)
+		std::vector<UINT8> id;
+		if (getAppIdCached(*it, id))
 		{
 			FWP_BYTE_BLOB blob;
-			blob.size = fwpApplicationByteBlob->size;
+			blob.size = static_cast<UINT32>(id.size());
 			blob.data = new UINT8[blob.size];
-			memcpy(blob.data, fwpApplicationByteBlob->data, blob.size);
+			memcpy(blob.data, id.data(), blob.size);
 
 			appIds_.push_back(blob);
+		}
+	}
+}
 
-			FwpmFreeMemory((void **)&fwpApplicationByteBlob);
+bool AppsIds::getAppIdCached(const std::wstring &path, std::vector<UINT8> &id)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	const bool isFileInfo = GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &fad) != 0;
+	const ULONGLONG fileSize = isFileInfo ? ((static_cast<ULONGLONG>(fad.nFileSizeHigh) << 32) | fad.nFileSizeLow) : 0;
+
+	std::lock_guard<std::mutex> lock(cacheMutex_);
+	auto it = cache_.find(path);
+	if (it != cache_.end())
+	{
+		if (isFileInfo && it->second.fileSize == fileSize && CompareFileTime(&it->second.lastWriteTime, &fad.ftLastWriteTime) == 0)
+		{
+			id = it->second.id;
+			return true;
 		}
+		// the file is changed or removed
+		cache_.erase(it);
 	}
+
+	FWP_BYTE_BLOB *fwpApplicationByteBlob = NULL;
+	if (FwpmGetAppIdFromFileName(path.c_str(), &fwpApplicationByteBlob) != ERROR_SUCCESS)
+	{
+		return false;
+	}
+	id.assign(fwpApplicationByteBlob->data, fwpApplicationByteBlob->data + fwpApplicationByteBlob->size);
+	FwpmFreeMemory((void **)&fwpApplicationByteBlob);
+
+	if (isFileInfo)
+	{
+		CachedAppId cached;
+		cached.id = id;
+		cached.lastWriteTime = fad.ftLastWriteTime;
+		cached.fileSize = fileSize;
+		cache_[path] = cached;
+	}
+	return true;
 }
 
 void AppsIds::addFromAppsImpl(const AppsIds &a)
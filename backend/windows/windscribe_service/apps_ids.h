@@ -19,6 +19,18 @@ public:
 private:
 	std::vector<FWP_BYTE_BLOB> appIds_;
 
+	// FwpmGetAppIdFromFileName results by path, a cached id is used while the file's write time and size are the same
+	struct CachedAppId
+	{
+		std::vector<UINT8> id;
+		FILETIME lastWriteTime;
+		ULONGLONG fileSize;
+	};
+	static std::mutex cacheMutex_;
+	static std::map<std::wstring, CachedAppId> cache_;
+
+	static bool getAppIdCached(const std::wstring &path, std::vector<UINT8> &id);
+
 	void clear();
 	void addFromListImpl(const std::vector<std::wstring> &apps);
 	void addFromAppsImpl(const AppsIds &a);
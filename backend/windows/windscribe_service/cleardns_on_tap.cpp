@@ -1,23 +1,17 @@
 #include "all_headers.h"
 #include "cleardns_on_tap.h"
+#include "network_snapshot.h"
 
 void ClearDnsOnTap::clearDns()
 {
-	ULONG ulAdapterInfoSize = sizeof(IP_ADAPTER_INFO);
-	std::vector<unsigned char> pAdapterInfo(ulAdapterInfoSize);
-
-	if (GetAdaptersInfo((IP_ADAPTER_INFO *)&pAdapterInfo[0], &ulAdapterInfoSize) == ERROR_BUFFER_OVERFLOW) // out of buff
-	{
-		pAdapterInfo.resize(ulAdapterInfoSize);
-	}
-
-	if (GetAdaptersInfo((IP_ADAPTER_INFO *)&pAdapterInfo[0], &ulAdapterInfoSize) == ERROR_SUCCESS)
+	const std::shared_ptr<const std::vector<unsigned char>> adapters = NetworkSnapshot::instance().adapters();
+	if (adapters)
 	{
-		IP_ADAPTER_INFO *ai = (IP_ADAPTER_INFO *)&pAdapterInfo[0];
+		PIP_ADAPTER_ADDRESSES ai = (PIP_ADAPTER_ADDRESSES)&(*adapters)[0];
 
 		do
 		{
-			if (strstr(ai->Description, "Windscribe VPN") != 0)
+			if (wcsstr(ai->Description, L"Windscribe VPN") != 0)
 			{
 				regClearDNS(ai->AdapterName);
 			}
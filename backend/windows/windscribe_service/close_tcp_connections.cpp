@@ -1,125 +1,140 @@
 #include "all_headers.h"
 #include "close_tcp_connections.h"
-#include <cwctype>
+#include "process_monitor.h"
+#include "logger.h"
 
 // static
 void CloseTcpConnections::closeAllTcpConnections(bool keepLocalSockets, bool isExclude /*= true*/, const std::vector<std::wstring> &apps/* = std::vector<std::wstring>()*/)
 {
-	PMIB_TCPTABLE2 pTcpTable = NULL;
-	DWORD dwSize = 0;
-	DWORD dwRetVal = 0;
+	const ULONGLONG startTime = GetTickCount64();
 
-	pTcpTable = (MIB_TCPTABLE2 *)malloc(sizeof(MIB_TCPTABLE2));
-	if (pTcpTable == NULL)
+	// one snapshot of the connections with the owners, the listening sockets aren't included
+	std::vector<BYTE> buf(sizeof(MIB_TCPTABLE_OWNER_PID));
+	DWORD dwSize = static_cast<DWORD>(buf.size());
+	DWORD dwRetVal;
+	while ((dwRetVal = GetExtendedTcpTable(&buf[0], &dwSize, FALSE, AF_INET, TCP_TABLE_OWNER_PID_CONNECTIONS, 0)) == ERROR_INSUFFICIENT_BUFFER)
 	{
+		buf.resize(dwSize);
+	}
+	if (dwRetVal != NO_ERROR)
+	{
+		Logger::instance().out(L"CloseTcpConnections::closeAllTcpConnections(), GetExtendedTcpTable failed: %lu", dwRetVal);
 		return;
 	}
+	const MIB_TCPTABLE_OWNER_PID *pTcpTable = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID *>(&buf[0]);
 
-	dwSize = sizeof(MIB_TCPTABLE2);
-	// Make an initial call to GetTcpTable to get the necessary size into the dwSize variable
-	if ((dwRetVal = GetTcpTable2(pTcpTable, &dwSize, TRUE)) == ERROR_INSUFFICIENT_BUFFER)
+	// the owners are matched by pid, the paths of the owners are taken from the process index once
+	std::set<DWORD> ownerPids;
+	for (DWORD i = 0; i < pTcpTable->dwNumEntries; i++)
 	{
-		free(pTcpTable);
-		pTcpTable = (MIB_TCPTABLE2 *)malloc(dwSize);
-		if (pTcpTable == NULL)
-		{
-			return;
-		}
+		ownerPids.insert(pTcpTable->table[i].dwOwningPid);
+	}
+	std::vector<std::wstring> normalizedApps;
+	normalizedApps.reserve(apps.size());
+	for (const auto &app : apps)
+	{
+		normalizedApps.push_back(ProcessMonitor::normalizePath(app));
+	}
+	const std::set<DWORD> windscribePids = ProcessMonitor::instance().getPidsOfApps(std::vector<std::wstring>(1, L"windscribe"), ownerPids);
+	const std::set<DWORD> appsPids = ProcessMonitor::instance().getPidsOfApps(normalizedApps, ownerPids);
+
+	std::vector<MIB_TCPROW> rows;
+	for (DWORD i = 0; i < pTcpTable->dwNumEntries; i++)
+	{
+		const MIB_TCPROW_OWNER_PID &entry = pTcpTable->table[i];
+		// Do not close listening sockets.
+		if (entry.dwState == MIB_TCP_STATE_LISTEN)
+			continue;
+		// Do not close LAN sockets, if explicitly requested.
+		if (keepLocalSockets && isLocalAddress(entry.dwRemoteAddr))
+			continue;
+		// Do not close Windscribe sockets.
+		if (windscribePids.find(entry.dwOwningPid) != windscribePids.end())
+			continue;
+		// don't close apps sockets in the exclusive mode, don't close not apps sockets in the inclusive one
+		if ((appsPids.find(entry.dwOwningPid) != appsPids.end()) == isExclude)
+			continue;
+
+		MIB_TCPROW row;
+		row.dwState = MIB_TCP_STATE_DELETE_TCB;
+		row.dwLocalAddr = entry.dwLocalAddr;
+		row.dwLocalPort = entry.dwLocalPort;
+		row.dwRemoteAddr = entry.dwRemoteAddr;
+		row.dwRemotePort = entry.dwRemotePort;
+		rows.push_back(row);
+	}
+
+	const size_t closedCount = deleteTcpRows(rows);
+	Logger::instance().out(L"CloseTcpConnections::closeAllTcpConnections(), closed %zu of %zu connections (%lu total) in %llu ms",
+		closedCount, rows.size(), pTcpTable->dwNumEntries, GetTickCount64() - startTime);
+}
+
+// static
+size_t CloseTcpConnections::deleteTcpRows(std::vector<MIB_TCPROW> &rows)
+{
+	if (rows.empty())
+	{
+		return 0;
 	}
 
-	// Make a second call to GetTcpTable to get the actual data we require
-	if ((dwRetVal = GetTcpTable2(pTcpTable, &dwSize, TRUE)) == NO_ERROR)
+	// each SetTcpEntry is a synchronous call to the TCP/IP driver, the batches go in parallel
+	const size_t batchesCount = (std::min)(static_cast<size_t>(MAX_PARALLEL_BATCHES), (rows.size() + MIN_BATCH_SIZE - 1) / MIN_BATCH_SIZE);
+	const size_t batchSize = (rows.size() + batchesCount - 1) / batchesCount;
+
+	std::vector<DeleteBatch> batches(batchesCount);
+	std::vector<HANDLE> threads;
+	for (size_t i = 0; i < batchesCount; ++i)
 	{
-        for (int i = 0; i < (int)pTcpTable->dwNumEntries; i++)
-        {
-            auto *entry = &pTcpTable->table[i];
-            // Do not close listening sockets.
-            if (entry->dwState == MIB_TCP_STATE_LISTEN)
-                continue;
-            // Do not close LAN sockets, if explicitly requested.
-            if (keepLocalSockets && isLocalAddress(entry->dwRemoteAddr))
-                continue;
-            // Do not close Windscribe sockets.
-            if (isWindscribeProcessName(entry->dwOwningPid))
-                continue;
-
-			// don't close apps sockets
-			if (isExclude)
+		batches[i].begin = &rows[0] + i * batchSize;
+		batches[i].end = &rows[0] + (std::min)(rows.size(), (i + 1) * batchSize);
+		batches[i].closedCount = 0;
+		// the first batch is done in this thread
+		if (i > 0)
+		{
+			HANDLE hThread = CreateThread(NULL, 0, deleteBatchThread, &batches[i], 0, NULL);
+			if (hThread != NULL)
 			{
-				bool bSkip = false;
-				for (auto app : apps)
-				{
-					if (isAppSocket(entry->dwOwningPid, app))
-					{
-						bSkip = true;
-						break;
-					}
-				}
-				if (bSkip)
-					continue;
+				threads.push_back(hThread);
 			}
-			// // don't close not apps sockets
 			else
 			{
-				bool bFound = false;
-				for (auto app : apps)
-				{
-					if (isAppSocket(entry->dwOwningPid, app))
-					{
-						bFound = true;
-						break;
-					}
-				}
-				if (!bFound)
-					continue;
+				deleteBatchThread(&batches[i]);
 			}
+		}
+	}
+	deleteBatchThread(&batches[0]);
 
-            entry->dwState = MIB_TCP_STATE_DELETE_TCB;
-            SetTcpEntry(reinterpret_cast<MIB_TCPROW *>(entry));
-        }
+	if (!threads.empty())
+	{
+		WaitForMultipleObjects(static_cast<DWORD>(threads.size()), &threads[0], TRUE, INFINITE);
+		for (HANDLE hThread : threads)
+		{
+			CloseHandle(hThread);
+		}
 	}
 
-	if (pTcpTable != NULL) 
+	size_t closedCount = 0;
+	for (const auto &batch : batches)
 	{
-		free(pTcpTable);
+		closedCount += batch.closedCount;
 	}
+	return closedCount;
 }
 
 // static
-bool CloseTcpConnections::isWindscribeProcessName(DWORD dwPid)
-{
-	return isAppSocket(dwPid, L"windscribe");
-}
-
-//static 
-bool CloseTcpConnections::isAppSocket(DWORD dwPid, const std::wstring &app)
+DWORD WINAPI CloseTcpConnections::deleteBatchThread(LPVOID lpParam)
 {
-	std::wstring lowerApp = app;
-	std::transform(lowerApp.begin(), lowerApp.end(), lowerApp.begin(),
-		[](wchar_t c) {return static_cast<wchar_t>(std::towlower(c)); });
-
-	std::replace(lowerApp.begin(), lowerApp.end(), L'/', L'\\');
-
-	bool bRet = false;
-	HANDLE processHandle = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, dwPid);
-	if (processHandle != NULL)
+	DeleteBatch *batch = static_cast<DeleteBatch *>(lpParam);
+	for (MIB_TCPROW *row = batch->begin; row != batch->end; ++row)
 	{
-		TCHAR filename[MAX_PATH];
-		if (GetModuleFileNameEx(processHandle, NULL, filename, MAX_PATH) != 0)
+		if (SetTcpEntry(row) == NO_ERROR)
 		{
-			_wcslwr(filename);
-			if (wcsstr(filename, lowerApp.c_str()/* L"windscribe")*/) != 0)
-			{
-				bRet = true;
-			}
+			batch->closedCount++;
 		}
-		CloseHandle(processHandle);
 	}
-
-	return bRet;
+	return 0;
 }
 
-
 namespace
 {
     // Helper class to generate a 32-bit IP address from bytes in network order.
@@ -5,8 +5,18 @@ class CloseTcpConnections
 public:
     static void closeAllTcpConnections(bool keepLocalSockets, bool isExclude = true, const std::vector<std::wstring> &apps = std::vector<std::wstring>());
 private:
-    static bool isWindscribeProcessName(DWORD dwPid);
-	static bool isAppSocket(DWORD dwPid, const std::wstring &app);
+	enum { MAX_PARALLEL_BATCHES = 4, MIN_BATCH_SIZE = 64 };
+
+	struct DeleteBatch
+	{
+		MIB_TCPROW *begin;
+		MIB_TCPROW *end;
+		size_t closedCount;
+	};
+
+	// returns the number of the deleted connections
+	static size_t deleteTcpRows(std::vector<MIB_TCPROW> &rows);
+	static DWORD WINAPI deleteBatchThread(LPVOID lpParam);
 	static bool isLocalAddress(DWORD address);
 };
 
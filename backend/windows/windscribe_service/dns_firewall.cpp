@@ -2,6 +2,7 @@
 
 #include "dns_firewall.h"
 #include "logger.h"
+#include "network_snapshot.h"
 #include "utils.h"
 #include "ip_address/ip4_address_and_mask.h"
 
@@ -9,7 +10,7 @@
 #define UUID_LAYER_DNS L"7e4a5678-bc70-45e8-8674-21a8e610fd02"
 
 
-DnsFirewall::DnsFirewall(FwpmWrapper &fwmpWrapper) : fwmpWrapper_(fwmpWrapper), bCurrentState_(false)
+DnsFirewall::DnsFirewall(FwpmWrapper &fwmpWrapper) : fwmpWrapper_(fwmpWrapper), bCurrentState_(false), isFiltersKnown_(false)
 {
 	WSADATA wsaData;
 	WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -30,6 +31,8 @@ void DnsFirewall::disable()
 
 		fwmpWrapper_.beginTransaction();
 		bCurrentState_ = false;
+		isFiltersKnown_ = false;
+		filterIds_.clear();
 		
 		if (Utils::deleteSublayerAndAllFilters(hEngine, &subLayerGUID_))
 		{
@@ -47,6 +50,33 @@ void DnsFirewall::disable()
 
 void DnsFirewall::enable()
 {
+	const ULONGLONG startTime = GetTickCount64();
+	const std::vector<std::wstring> dnsServers = getDnsServers();
+	std::set<std::wstring> ips;
+	for (size_t i = 0; i < dnsServers.size(); ++i)
+	{
+		if (excludeIps_.find(dnsServers[i]) != excludeIps_.cend())
+		{
+			Logger::instance().out(L"DnsFirewall::enable(), ip excluded: %s", dnsServers[i].c_str());
+			continue;
+		}
+		ips.insert(dnsServers[i]);
+	}
+
+	// if already enabled with the known filters, apply only the difference
+	if (bCurrentState_ && isFiltersKnown_)
+	{
+		HANDLE hEngine = fwmpWrapper_.getHandleAndLock();
+		fwmpWrapper_.beginTransaction();
+		size_t added, deleted;
+		isFiltersKnown_ = updateFilters(hEngine, ips, added, deleted);
+		isFiltersKnown_ = fwmpWrapper_.endTransaction() && isFiltersKnown_;
+		fwmpWrapper_.unlock();
+		Logger::instance().out(L"DnsFirewall::enable(), filters updated: %zu total, %zu added, %zu deleted, %llu ms",
+			ips.size(), added, deleted, GetTickCount64() - startTime);
+		return;
+	}
+
 	// if already enabled, first remove previous filter
 	if (bCurrentState_)
 	{
@@ -72,12 +102,14 @@ void DnsFirewall::enable()
 		fwmpWrapper_.unlock();
 		return;
 	}
-	
-	addFilters(hEngine);
 
-	fwmpWrapper_.endTransaction();
+	filterIds_.clear();
+	size_t added, deleted;
+	isFiltersKnown_ = updateFilters(hEngine, ips, added, deleted);
+	isFiltersKnown_ = fwmpWrapper_.endTransaction() && isFiltersKnown_;
 	fwmpWrapper_.unlock();
 	bCurrentState_ = true;
+	Logger::instance().out(L"DnsFirewall::enable(), all filters added: %zu filters, %llu ms", ips.size(), GetTickCount64() - startTime);
 }
 
 void DnsFirewall::setExcludeIps(const std::vector<std::wstring>& ips)
@@ -85,91 +117,102 @@ void DnsFirewall::setExcludeIps(const std::vector<std::wstring>& ips)
 	excludeIps_ = std::unordered_set<std::wstring>(ips.cbegin(), ips.cend());
 }
 
-void DnsFirewall::addFilters(HANDLE engineHandle)
+bool DnsFirewall::updateFilters(HANDLE engineHandle, const std::set<std::wstring> &ips, size_t &outAdded, size_t &outDeleted)
 {
-	std::vector<std::wstring> dnsServers = getDnsServers();
-	// add block filter for DNS ips for protocol UDP port 53
-	for (size_t i = 0; i < dnsServers.size(); ++i)
+	bool bRet = true;
+	outAdded = outDeleted = 0;
+
+	for (std::map<std::wstring, UINT64>::iterator it = filterIds_.begin(); it != filterIds_.end(); )
 	{
-		if (excludeIps_.find(dnsServers[i]) != excludeIps_.cend()) {
-			Logger::instance().out(L"DnsFirewall::addFilters(), ip excluded: ", dnsServers[i].c_str());
-			continue;
-		}
-		std::vector<FWPM_FILTER_CONDITION0> condition(2);
-		FWP_V4_ADDR_AND_MASK addrMask;
-		memset(&condition[0], 0, sizeof(FWPM_FILTER_CONDITION0) * 2);
-
-		DWORD dwFwAPiRetCode;
-		FWPM_FILTER0 filter = { 0 };
-
-		filter.subLayerKey = subLayerGUID_;
-		filter.displayData.name = (wchar_t *)FIREWALL_SUBLAYER_DNS_NAMEW;
-		filter.layerKey = FWPM_LAYER_ALE_AUTH_CONNECT_V4;
-		filter.action.type = FWP_ACTION_BLOCK;
-		filter.flags = 0;
-		filter.weight.type = FWP_UINT8;
-		filter.weight.uint8 = 0x00;
-		filter.filterCondition = &condition[0];
-		filter.numFilterConditions = 2;
-
-		condition[0].fieldKey = FWPM_CONDITION_IP_REMOTE_ADDRESS;
-		condition[0].matchType = FWP_MATCH_EQUAL;
-		condition[0].conditionValue.type = FWP_V4_ADDR_MASK;
-		condition[0].conditionValue.v4AddrMask = &addrMask;
-
-		Ip4AddressAndMask ipAddress(dnsServers[i].c_str());
-		addrMask.addr = ipAddress.ipHostOrder();
-		addrMask.mask = ipAddress.maskHostOrder();
-
-		condition[1].fieldKey = FWPM_CONDITION_IP_REMOTE_PORT;
-		condition[1].matchType = FWP_MATCH_EQUAL;
-		condition[1].conditionValue.type = FWP_UINT16;
-		condition[1].conditionValue.uint16 = 53;
-
-		UINT64 filterId;
-		dwFwAPiRetCode = FwpmFilterAdd0(engineHandle, &filter, NULL, &filterId);
-		if (dwFwAPiRetCode != ERROR_SUCCESS)
+		if (ips.find(it->first) == ips.end())
 		{
-			Logger::instance().out(L"DnsFirewall::addFilters(), FwpmFilterAdd0 failed");
+			if (it->second != 0 && FwpmFilterDeleteById0(engineHandle, it->second) != ERROR_SUCCESS)
+			{
+				Logger::instance().out(L"DnsFirewall::updateFilters(), FwpmFilterDeleteById0 failed");
+				bRet = false;
+			}
+			it = filterIds_.erase(it);
+			outDeleted++;
 		}
 		else
 		{
-			Logger::instance().out(L"added dns filter for %s", dnsServers[i].c_str());
+			++it;
+		}
+	}
+
+	for (std::set<std::wstring>::const_iterator it = ips.begin(); it != ips.end(); ++it)
+	{
+		if (filterIds_.find(*it) == filterIds_.end())
+		{
+			UINT64 filterId = addFilter(engineHandle, *it);
+			if (filterId == 0)
+			{
+				bRet = false;
+			}
+			filterIds_[*it] = filterId;
+			outAdded++;
 		}
 	}
+	return bRet;
+}
+
+// add block filter for DNS ip for protocol UDP port 53, returns 0 on failure
+UINT64 DnsFirewall::addFilter(HANDLE engineHandle, const std::wstring &ip)
+{
+	std::vector<FWPM_FILTER_CONDITION0> condition(2);
+	FWP_V4_ADDR_AND_MASK addrMask;
+	memset(&condition[0], 0, sizeof(FWPM_FILTER_CONDITION0) * 2);
+
+	DWORD dwFwAPiRetCode;
+	FWPM_FILTER0 filter = { 0 };
+
+	filter.subLayerKey = subLayerGUID_;
+	filter.displayData.name = (wchar_t *)FIREWALL_SUBLAYER_DNS_NAMEW;
+	filter.layerKey = FWPM_LAYER_ALE_AUTH_CONNECT_V4;
+	filter.action.type = FWP_ACTION_BLOCK;
+	filter.flags = 0;
+	filter.weight.type = FWP_UINT8;
+	filter.weight.uint8 = 0x00;
+	filter.filterCondition = &condition[0];
+	filter.numFilterConditions = 2;
+
+	condition[0].fieldKey = FWPM_CONDITION_IP_REMOTE_ADDRESS;
+	condition[0].matchType = FWP_MATCH_EQUAL;
+	condition[0].conditionValue.type = FWP_V4_ADDR_MASK;
+	condition[0].conditionValue.v4AddrMask = &addrMask;
+
+	Ip4AddressAndMask ipAddress(ip.c_str());
+	addrMask.addr = ipAddress.ipHostOrder();
+	addrMask.mask = ipAddress.maskHostOrder();
+
+	condition[1].fieldKey = FWPM_CONDITION_IP_REMOTE_PORT;
+	condition[1].matchType = FWP_MATCH_EQUAL;
+	condition[1].conditionValue.type = FWP_UINT16;
+	condition[1].conditionValue.uint16 = 53;
+
+	UINT64 filterId = 0;
+	dwFwAPiRetCode = FwpmFilterAdd0(engineHandle, &filter, NULL, &filterId);
+	if (dwFwAPiRetCode != ERROR_SUCCESS)
+	{
+		Logger::instance().out(L"DnsFirewall::addFilter(), FwpmFilterAdd0 failed");
+		return 0;
+	}
+	Logger::instance().out(L"added dns filter for %s", ip.c_str());
+	return filterId;
 }
 
 std::vector<std::wstring> DnsFirewall::getDnsServers()
 {
 	std::vector<std::wstring> dnsServers;
 
-	DWORD dwRetVal = 0;
-	ULONG outBufLen = 0;
-	ULONG iterations = 0;
-	const int MAX_TRIES = 5;
-	std::vector<unsigned char> arr;
-	arr.resize(1);
-
-	outBufLen = static_cast<ULONG>(arr.size());
-	do {
-		dwRetVal = GetAdaptersAddresses(AF_UNSPEC, NULL, NULL, (PIP_ADAPTER_ADDRESSES)&arr[0], &outBufLen);
-		if (dwRetVal == ERROR_BUFFER_OVERFLOW)
-		{
-			arr.resize(outBufLen);
-		}
-		else
-		{
-			break;
-		}
-		iterations++;
-	} while ((dwRetVal == ERROR_BUFFER_OVERFLOW) && (iterations < MAX_TRIES));
-
-	if (dwRetVal != NO_ERROR)
+	// the DNS servers change without notifications, the snapshot is always refreshed here (for the other readers too)
+	const std::shared_ptr<const std::vector<unsigned char>> arr = NetworkSnapshot::instance().adapters(true);
+	if (!arr)
 	{
 		return dnsServers;
 	}
 
-	PIP_ADAPTER_ADDRESSES pCurrAddresses = (PIP_ADAPTER_ADDRESSES)&arr[0];
+	PIP_ADAPTER_ADDRESSES pCurrAddresses = (PIP_ADAPTER_ADDRESSES)&(*arr)[0];
 	while (pCurrAddresses)
 	{
         // Warning: we control the FriendlyName of the wireguard-nt adapter, but not the Description.
@@ -20,7 +20,13 @@ private:
 	FwpmWrapper &fwmpWrapper_;
 	std::unordered_set<std::wstring> excludeIps_;
 
-	void addFilters(HANDLE engineHandle);
+	// the installed block filters keyed by DNS server IP, valid while isFiltersKnown_; if the sublayer is on,
+	// enable() only adds and deletes the filters that differ
+	std::map<std::wstring, UINT64> filterIds_;
+	bool isFiltersKnown_;
+
+	UINT64 addFilter(HANDLE engineHandle, const std::wstring &ip);
+	bool updateFilters(HANDLE engineHandle, const std::set<std::wstring> &ips, size_t &outAdded, size_t &outDeleted);
 	std::vector<std::wstring> getDnsServers();
 
 };
@@ -13,7 +13,7 @@
 unsigned long ExecuteCmd::blockingCmdId_ = 0;
 ExecuteCmd *ExecuteCmd::this_ = NULL;
 
-ExecuteCmd::ExecuteCmd()
+ExecuteCmd::ExecuteCmd() : eventsCount_(0)
 {
     this_ = this;
 }
@@ -113,7 +113,7 @@ MessagePacketResult ExecuteCmd::executeUnblockingCmd(const wchar_t *cmd, const w
     ZeroMemory( &pi, sizeof(pi) );
 	if (CreateProcess(NULL, szCmd, NULL, NULL, TRUE, CREATE_NO_WINDOW | NORMAL_PRIORITY_CLASS, NULL, szWorkingDir, &si, &pi))
     {
-		blockingCmd->pipeForProcess.startReading();
+		blockingCmd->pipeForProcess.startReading([this]() { notifyWaiters(); });
 		blockingCmd->szEventName = szEventName;
 		blockingCmd->hProcess = pi.hProcess;
         blockingCmd->hThread = pi.hThread;
@@ -168,6 +168,52 @@ MessagePacketResult ExecuteCmd::getUnblockingCmdStatus(unsigned long cmdId)
     return mpr;
 }
 
+MessagePacketResult ExecuteCmd::waitUnblockingCmdStatus(unsigned long cmdId, unsigned long timeoutMs)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true)
+    {
+        unsigned long eventsCount;
+        {
+            std::lock_guard<std::mutex> lock(eventsMutex_);
+            eventsCount = eventsCount_;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(blockingCmds_.begin(), blockingCmds_.end(), [cmdId](const BlockingCmd *blockingCmd) {
+                return blockingCmd->id == cmdId;
+            });
+            if (it == blockingCmds_.end())
+            {
+                return MessagePacketResult();
+            }
+
+            BlockingCmd *blockingCmd = *it;
+            MessagePacketResult mpr;
+            mpr.success = true;
+            if (blockingCmd->bFinished)
+            {
+                mpr.exitCode = blockingCmd->dwExitCode;
+                mpr.blockingCmdFinished = true;
+                mpr.additionalString = blockingCmd->strLogOutput;
+                blockingCmds_.erase(it);
+                delete blockingCmd;
+                return mpr;
+            }
+            mpr.blockingCmdFinished = false;
+            mpr.additionalString = blockingCmd->pipeForProcess.takeOutput();
+            if (!mpr.additionalString.empty() || std::chrono::steady_clock::now() >= deadline)
+            {
+                return mpr;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(eventsMutex_);
+        eventsCondition_.wait_until(lock, deadline, [this, eventsCount]() { return eventsCount_ != eventsCount; });
+    }
+}
+
 MessagePacketResult ExecuteCmd::getActiveUnblockingCmdCount()
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -179,8 +225,11 @@ MessagePacketResult ExecuteCmd::getActiveUnblockingCmdCount()
 
 MessagePacketResult ExecuteCmd::clearUnblockingCmd(unsigned long id)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    clearCmd(id);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clearCmd(id);
+    }
+    notifyWaiters();
     MessagePacketResult mpr;
     mpr.success = true;
     return mpr;
@@ -213,6 +262,7 @@ void ExecuteCmd::waitOrTimerCallback(PVOID lpParameter, BOOLEAN /*timerOrWaitFir
     UnregisterWaitEx(blockingCmd->hWait, NULL);
 
     blockingCmd->bFinished = true;
+    this_->notifyWaiters();
 
 	// set event if specified
 	if (!blockingCmd->szEventName.empty())
@@ -231,6 +281,15 @@ void ExecuteCmd::waitOrTimerCallback(PVOID lpParameter, BOOLEAN /*timerOrWaitFir
 	}
 }
 
+void ExecuteCmd::notifyWaiters()
+{
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex_);
+        eventsCount_++;
+    }
+    eventsCondition_.notify_all();
+}
+
 void ExecuteCmd::terminateCmd(unsigned long id, unsigned long waitTimeout)
 {
     for (auto it = blockingCmds_.begin(); it != blockingCmds_.end(); ++it)
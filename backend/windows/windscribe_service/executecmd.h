@@ -3,6 +3,7 @@
 
 #include "ipc/servicecommunication.h"
 #include "pipe_for_process.h"
+#include <condition_variable>
 
 class ExecuteCmd
 {
@@ -16,6 +17,7 @@ public:
 	MessagePacketResult executeBlockingCmd(wchar_t *cmd, HANDLE user_token = INVALID_HANDLE_VALUE);
 	MessagePacketResult executeUnblockingCmd(const wchar_t *cmd, const wchar_t *szEventName, const wchar_t *szWorkingDir);
 	MessagePacketResult getUnblockingCmdStatus(unsigned long cmdId);
+	MessagePacketResult waitUnblockingCmdStatus(unsigned long cmdId, unsigned long timeoutMs);
     MessagePacketResult getActiveUnblockingCmdCount();
 	MessagePacketResult clearUnblockingCmd(unsigned long id);
     MessagePacketResult suspendUnblockingCmd(unsigned long id);
@@ -49,6 +51,13 @@ private:
     std::vector<BlockingCmd *> blockingCmds_;
     std::mutex mutex_;
 
+    // waitUnblockingCmdStatus() waits for a change of eventsCount_ (an output or a finished command), the separate
+    // mutex is never held with mutex_ by the waiters, the pipe read callbacks don't take mutex_ at all
+    std::mutex eventsMutex_;
+    std::condition_variable eventsCondition_;
+    unsigned long eventsCount_;
+    void notifyWaiters();
+
     static VOID CALLBACK waitOrTimerCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired);
     static ExecuteCmd *this_;
 
@@ -7,7 +7,7 @@
 
 
 FirewallFilter::FirewallFilter(FwpmWrapper &fwpmWrapper) :
-    fwpmWrapper_(fwpmWrapper), lastAllowLocalTraffic_(false), isSplitTunnelingEnabled_(false),
+    fwpmWrapper_(fwpmWrapper), lastAllowLocalTraffic_(false), isIpFiltersKnown_(false), isSplitTunnelingEnabled_(false),
     isSplitTunnelingExclusiveMode_(false)
 {
 	UuidFromString((RPC_WSTR)UUID_LAYER, &subLayerGUID_);
@@ -21,11 +21,28 @@ void FirewallFilter::on(const wchar_t *ip, bool bAllowLocalTraffic)
 {
 	std::lock_guard<std::recursive_mutex> guard(mutex_);
 
+	const ULONGLONG startTime = GetTickCount64();
+	const std::set<IpAndMask> ips = collapseIps(split(ip, L';'));
+	AdaptersInfo ai;
+	const std::vector<NET_IFINDEX> taps = ai.getTAPAdapters();
+
 	HANDLE hEngine = fwpmWrapper_.getHandleAndLock();
 
 	fwpmWrapper_.beginTransaction();
 
-	if (currentStatusImpl(hEngine) == true)
+	const bool isOn = currentStatusImpl(hEngine);
+	if (isOn && isIpFiltersKnown_ && lastAllowLocalTraffic_ == bAllowLocalTraffic && lastTaps_ == taps)
+	{
+		size_t added, deleted;
+		isIpFiltersKnown_ = updateIpFilters(hEngine, ips, added, deleted);
+		isIpFiltersKnown_ = fwpmWrapper_.endTransaction() && isIpFiltersKnown_;
+		fwpmWrapper_.unlock();
+		Logger::instance().out(L"FirewallFilter::on(), IP filters updated: %zu total, %zu added, %zu deleted, %llu ms",
+			ips.size(), added, deleted, GetTickCount64() - startTime);
+		return;
+	}
+
+	if (isOn)
     {
 		offImpl(hEngine);
     }
@@ -40,15 +57,19 @@ void FirewallFilter::on(const wchar_t *ip, bool bAllowLocalTraffic)
     DWORD dwRet = FwpmSubLayerAdd0(hEngine, &subLayer, NULL );
     if (dwRet == ERROR_SUCCESS)
     {
-		addFilters(hEngine, ip, bAllowLocalTraffic);
+		addFilters(hEngine, taps, ips, bAllowLocalTraffic);
+		isIpFiltersKnown_ = true;
+		lastAllowLocalTraffic_ = bAllowLocalTraffic;
+		lastTaps_ = taps;
     }
 	else
 	{
 		Logger::instance().out(L"FirewallFilter::on(), FwpmSubLayerAdd0 failed");
 	}
 
-	fwpmWrapper_.endTransaction();
+	isIpFiltersKnown_ = fwpmWrapper_.endTransaction() && isIpFiltersKnown_;
 	fwpmWrapper_.unlock();
+	Logger::instance().out(L"FirewallFilter::on(), all filters added: %zu IP filters, %llu ms", ips.size(), GetTickCount64() - startTime);
 }
 
 void FirewallFilter::off()
@@ -90,6 +111,8 @@ void FirewallFilter::offImpl(HANDLE engineHandle)
 	}
 	filterIdsApps_.clear();
 	filterIdsSplitRoutingIps_.clear();
+	filterIdsIps_.clear();
+	isIpFiltersKnown_ = false;
 }
 
 void FirewallFilter::setSplitTunnelingEnabled()
@@ -170,13 +193,8 @@ void FirewallFilter::setSplitTunnelingWhitelistIps(const std::vector<Ip4AddressA
 	fwpmWrapper_.unlock();
 }
 
-void FirewallFilter::addFilters(HANDLE engineHandle, const wchar_t *ip, bool bAllowLocalTraffic)
+void FirewallFilter::addFilters(HANDLE engineHandle, const std::vector<NET_IFINDEX> &taps, const std::set<IpAndMask> &ips, bool bAllowLocalTraffic)
 {
-    std::vector<std::wstring> ipAddresses = split(ip, L';');
-
-	AdaptersInfo ai;
-	std::vector<NET_IFINDEX> taps = ai.getTAPAdapters();
-
     DWORD dwFwAPiRetCode;
 
     // add block filter for all IPs, for all adapters.
@@ -202,7 +220,7 @@ void FirewallFilter::addFilters(HANDLE engineHandle, const wchar_t *ip, bool bAl
     }
 
     // add permit filter for TAP-adapters
-    for (std::vector<NET_IFINDEX>::iterator it = taps.begin(); it != taps.end(); ++it)
+    for (std::vector<NET_IFINDEX>::const_iterator it = taps.begin(); it != taps.end(); ++it)
     {
 		addPermitFilterForAdapter(engineHandle, *it, 1);
     }
@@ -238,47 +256,17 @@ void FirewallFilter::addFilters(HANDLE engineHandle, const wchar_t *ip, bool bAl
     }
 
     // add permit filter IPv6 for TAP-adapters
-    for (std::vector<NET_IFINDEX>::iterator it = taps.begin(); it != taps.end(); ++it)
+    for (std::vector<NET_IFINDEX>::const_iterator it = taps.begin(); it != taps.end(); ++it)
     {
 		Utils::addPermitFilterIPv6ForAdapter(*it, 1, (wchar_t *)FIREWALL_SUBLAYER_NAMEW, subLayerGUID_, engineHandle);
     }
 
 
     // add permit filter for specific IPs
-    for (size_t i = 0; i < ipAddresses.size(); ++i)
+    filterIdsIps_.clear();
+    for (std::set<IpAndMask>::const_iterator it = ips.begin(); it != ips.end(); ++it)
     {
-        {
-            FWPM_FILTER0 filter = {0};
-            std::vector<FWPM_FILTER_CONDITION0> condition(1);
-            FWP_V4_ADDR_AND_MASK addrMask;
-            memset(&condition[0], 0, sizeof(FWPM_FILTER_CONDITION0) * 1);
-
-            filter.subLayerKey = subLayerGUID_;
-            filter.displayData.name = (wchar_t *)FIREWALL_SUBLAYER_NAMEW;
-            filter.layerKey = FWPM_LAYER_ALE_AUTH_CONNECT_V4;
-			filter.flags = FWPM_SUBLAYER_FLAG_PERSISTENT;
-            filter.action.type = FWP_ACTION_PERMIT;
-            filter.weight.type = FWP_UINT8;
-            filter.weight.uint8 = 0x02;
-            filter.filterCondition = &condition[0];
-            filter.numFilterConditions = 1;
-
-            condition[0].fieldKey = FWPM_CONDITION_IP_REMOTE_ADDRESS;
-            condition[0].matchType = FWP_MATCH_EQUAL;
-            condition[0].conditionValue.type = FWP_V4_ADDR_MASK;
-            condition[0].conditionValue.v4AddrMask = &addrMask;
-
-			Ip4AddressAndMask ipAddr(ipAddresses[i].c_str());
-			addrMask.addr = ipAddr.ipHostOrder();
-            addrMask.mask = ipAddr.maskHostOrder();
-
-            UINT64 filterId;
-            dwFwAPiRetCode = FwpmFilterAdd0(engineHandle, &filter, NULL, &filterId);
-            if (dwFwAPiRetCode != ERROR_SUCCESS)
-            {
-                Logger::instance().out(L"Error 21 (0x%X)", dwFwAPiRetCode);
-            }
-        }
+        filterIdsIps_[*it] = addPermitFilterForIp(engineHandle, *it);
     }
 
     // add permit filter (Exec("netsh advfirewall firewall add rule name=\"VPN - Out - DHCP\" dir=out action=allow protocol=UDP
@@ -595,6 +583,122 @@ void FirewallFilter::addFilters(HANDLE engineHandle, const wchar_t *ip, bool bAl
     }
 }
 
+UINT64 FirewallFilter::addPermitFilterForIp(HANDLE engineHandle, const IpAndMask &ip)
+{
+    FWPM_FILTER0 filter = {0};
+    std::vector<FWPM_FILTER_CONDITION0> condition(1);
+    FWP_V4_ADDR_AND_MASK addrMask;
+    memset(&condition[0], 0, sizeof(FWPM_FILTER_CONDITION0) * 1);
+
+    filter.subLayerKey = subLayerGUID_;
+    filter.displayData.name = (wchar_t *)FIREWALL_SUBLAYER_NAMEW;
+    filter.layerKey = FWPM_LAYER_ALE_AUTH_CONNECT_V4;
+    filter.flags = FWPM_SUBLAYER_FLAG_PERSISTENT;
+    filter.action.type = FWP_ACTION_PERMIT;
+    filter.weight.type = FWP_UINT8;
+    filter.weight.uint8 = 0x02;
+    filter.filterCondition = &condition[0];
+    filter.numFilterConditions = 1;
+
+    condition[0].fieldKey = FWPM_CONDITION_IP_REMOTE_ADDRESS;
+    condition[0].matchType = FWP_MATCH_EQUAL;
+    condition[0].conditionValue.type = FWP_V4_ADDR_MASK;
+    condition[0].conditionValue.v4AddrMask = &addrMask;
+
+    addrMask.addr = ip.first;
+    addrMask.mask = ip.second;
+
+    UINT64 filterId = 0;
+    DWORD dwFwAPiRetCode = FwpmFilterAdd0(engineHandle, &filter, NULL, &filterId);
+    if (dwFwAPiRetCode != ERROR_SUCCESS)
+    {
+        Logger::instance().out(L"Error 21 (0x%X)", dwFwAPiRetCode);
+    }
+    return filterId;
+}
+
+bool FirewallFilter::updateIpFilters(HANDLE engineHandle, const std::set<IpAndMask> &ips, size_t &outAdded, size_t &outDeleted)
+{
+    bool bRet = true;
+    outAdded = outDeleted = 0;
+
+    for (std::map<IpAndMask, UINT64>::iterator it = filterIdsIps_.begin(); it != filterIdsIps_.end(); )
+    {
+        if (ips.find(it->first) == ips.end())
+        {
+            if (it->second != 0 && FwpmFilterDeleteById0(engineHandle, it->second) != ERROR_SUCCESS)
+            {
+                Logger::instance().out(L"FirewallFilter::updateIpFilters(), FwpmFilterDeleteById0 failed");
+                bRet = false;
+            }
+            it = filterIdsIps_.erase(it);
+            outDeleted++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (std::set<IpAndMask>::const_iterator it = ips.begin(); it != ips.end(); ++it)
+    {
+        if (filterIdsIps_.find(*it) == filterIdsIps_.end())
+        {
+            UINT64 filterId = addPermitFilterForIp(engineHandle, *it);
+            if (filterId == 0)
+            {
+                bRet = false;
+            }
+            filterIdsIps_[*it] = filterId;
+            outAdded++;
+        }
+    }
+    return bRet;
+}
+
+// Merges the overlapping and contiguous addresses and ranges and splits the result into the minimal number of
+// address/mask blocks, so a list of thousands of node IPs gives fewer filters and the same list gives the same filters.
+std::set<FirewallFilter::IpAndMask> FirewallFilter::collapseIps(const std::vector<std::wstring> &ipAddresses)
+{
+    std::vector<std::pair<UINT64, UINT64> > ranges;     // [first, last] in host order
+    ranges.reserve(ipAddresses.size());
+    for (size_t i = 0; i < ipAddresses.size(); ++i)
+    {
+        Ip4AddressAndMask ipAddr(ipAddresses[i].c_str());
+        if (ipAddr.isValid())
+        {
+            const UINT32 first = ipAddr.ipHostOrder() & ipAddr.maskHostOrder();
+            ranges.push_back(std::make_pair(first, first | ~ipAddr.maskHostOrder()));
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+
+    std::set<IpAndMask> result;
+    size_t i = 0;
+    while (i < ranges.size())
+    {
+        UINT64 first = ranges[i].first;
+        UINT64 last = ranges[i].second;
+        for (++i; i < ranges.size() && ranges[i].first <= last + 1; ++i)
+        {
+            last = (std::max)(last, ranges[i].second);
+        }
+
+        while (first <= last)
+        {
+            // the largest block aligned at first which doesn't go over last
+            UINT64 size = (first == 0) ? (1ULL << 32) : (first & (~first + 1));
+            while (first + size - 1 > last)
+            {
+                size >>= 1;
+            }
+            result.insert(std::make_pair(static_cast<UINT32>(first), static_cast<UINT32>(~(size - 1))));
+            first += size;
+        }
+    }
+    return result;
+}
+
 UINT64 FirewallFilter::addPermitFilterForAdapter(HANDLE engineHandle, NET_LUID luid, UINT8 weight)
 {
     // add permit filter for TAP.
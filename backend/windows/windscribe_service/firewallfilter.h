@@ -32,10 +32,20 @@ private:
 	std::recursive_mutex mutex_;
 	bool lastAllowLocalTraffic_;
 
+	// the installed permit filters for the IPs (address and mask in host order, prefix-collapsed), valid while
+	// isIpFiltersKnown_; if the other filters don't change, on() only adds and deletes the IP filters that differ
+	typedef std::pair<UINT32, UINT32> IpAndMask;
+	std::map<IpAndMask, UINT64> filterIdsIps_;
+	bool isIpFiltersKnown_;
+	std::vector<NET_IFINDEX> lastTaps_;
+
 	bool currentStatusImpl(HANDLE engineHandle);
 	void offImpl(HANDLE engineHandle);
 
-	void addFilters(HANDLE engineHandle, const wchar_t *ip, bool bAllowLocalTraffic);
+	void addFilters(HANDLE engineHandle, const std::vector<NET_IFINDEX> &taps, const std::set<IpAndMask> &ips, bool bAllowLocalTraffic);
+	UINT64 addPermitFilterForIp(HANDLE engineHandle, const IpAndMask &ip);
+	bool updateIpFilters(HANDLE engineHandle, const std::set<IpAndMask> &ips, size_t &outAdded, size_t &outDeleted);
+	static std::set<IpAndMask> collapseIps(const std::vector<std::wstring> &ipAddresses);
 	void addPermitFilterForAdapter(HANDLE engineHandle, NET_IFINDEX tapInd, UINT8 weight);
 	UINT64 addPermitFilterForAdapter(HANDLE engineHandle, NET_LUID luid, UINT8 weight);
 	
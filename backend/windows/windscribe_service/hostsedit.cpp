@@ -1,9 +1,38 @@
 #include "all_headers.h"
 #include "hostsedit.h"
+#include <unordered_set>
 
 #pragma comment(lib, "Shlwapi.lib")
 
-HostsEdit::HostsEdit() : szTitle_(L"added by Windscribe, do not modify.")
+namespace {
+// removes the newline at the end of the line read by fgetws
+std::wstring chompLine(const wchar_t *buf)
+{
+	std::wstring line = buf;
+	while (!line.empty() && (line.back() == L'\n' || line.back() == L'\r'))
+	{
+		line.pop_back();
+	}
+	return line;
+}
+
+// the host entry without the comment and surrounding whitespaces, used as the key to compare the entries
+std::wstring hostKey(const std::wstring &line)
+{
+	const size_t commentPos = line.find(L'#');
+	const size_t end = line.find_last_not_of(L" \t", commentPos == std::wstring::npos ? std::wstring::npos : commentPos - 1);
+	const size_t begin = line.find_first_not_of(L" \t");
+	if (commentPos == 0 || begin == std::wstring::npos || end == std::wstring::npos || begin > end)
+	{
+		return std::wstring();
+	}
+	return line.substr(begin, end - begin + 1);
+}
+}
+
+HostsEdit::HostsEdit() : szTitle_(L"added by Windscribe, do not modify."),
+	beginMarker_(L"# begin: " + szTitle_), endMarker_(L"# end: " + szTitle_),
+	lastHostsHash_(0), isLastValid_(false)
 {
     wchar_t szPath[MAX_PATH];
     GetSystemDirectory(szPath, MAX_PATH);
@@ -67,59 +96,108 @@ bool HostsEdit::removeWindscribeHosts()
 
 bool HostsEdit::addHosts(std::wstring szHosts)
 {
+	const size_t hostsHash = std::hash<std::wstring>()(szHosts);
+	FileState fileState;
+	if (isLastValid_ && hostsHash == lastHostsHash_ && getFileState(getHostsPath(), fileState) && fileState == lastFileState_)
+	{
+		return true;
+	}
+
 	FILE *file = _wfopen(getHostsPath().c_str(), L"a+");
+	if (!file)
+	{
+		return false;
+	}
 
-	if (file)
+	// the lines outside of the section are kept as is, the section is read as a single block
+	std::vector<std::wstring> strs;
+	std::unordered_set<std::wstring> userHosts;
+	std::wstring oldSection;
+	size_t sectionPos = std::wstring::npos;
+	bool inSection = false;
+	bool hasLegacyHosts = false;
+	wchar_t buf[10000];
+	while (fgetws(buf, 10000, file))
 	{
-		//first read all strings from file to vector
-		std::vector<std::wstring> strs;
-		wchar_t buf[10000];
-		while (!feof(file))
+		const std::wstring line = chompLine(buf);
+		if (line == beginMarker_)
 		{
-			fgetws(buf, 10000, file);
-			strs.push_back(buf);
+			sectionPos = strs.size();
+			inSection = true;
 		}
-
-		std::vector<std::wstring> hosts = split(szHosts, L';');
-		std::vector<std::wstring> added_hosts;
-		for (std::vector<std::wstring>::iterator it = hosts.begin(); it != hosts.end(); ++it)
+		else if (line == endMarker_)
 		{
-			if (!stringInVector(strs, *it))
-			{
-				added_hosts.push_back(*it);
-			}
+			inSection = false;
 		}
-
-		if (added_hosts.size() > 0)
+		else if (inSection)
 		{
-			// write newline to end of file, if needed
-			fseek(file, 1, SEEK_END);
-			char c;
-			fread(&c, 1, 1, file);
-
-			if (c != '\n')
-			{
-                fseek(file, 0, SEEK_END);
-				fputws(L"\n", file);
-			}
+			oldSection += line;
+			oldSection += L'\n';
 		}
-		for (std::vector<std::wstring>::iterator it = added_hosts.begin(); it != added_hosts.end(); ++it)
+		else if (wcsstr(line.c_str(), szTitle_.c_str()) != NULL)
 		{
-			fputws(it->c_str(), file);
-			fputws(L"   #", file);
-			fputws(szTitle_.c_str(), file);
-			if (it != added_hosts.end() - 1)
-			{
-				fputws(L"\n", file);
-			}
+			// hosts added by the previous versions without the section
+			hasLegacyHosts = true;
+		}
+		else
+		{
+			userHosts.insert(hostKey(line));
+			strs.push_back(line);
 		}
-		fclose(file);
+	}
+	fclose(file);
+
+	std::wstring newSection;
+	std::unordered_set<std::wstring> addedHosts;
+	std::vector<std::wstring> hosts = split(szHosts, L';');
+	for (std::vector<std::wstring>::iterator it = hosts.begin(); it != hosts.end(); ++it)
+	{
+		const std::wstring key = hostKey(*it);
+		if (key.empty() || userHosts.count(key) > 0 || !addedHosts.insert(key).second)
+		{
+			continue;
+		}
+		newSection += *it;
+		newSection += L"   #";
+		newSection += szTitle_;
+		newSection += L'\n';
+	}
+
+	const bool hasSection = sectionPos != std::wstring::npos;
+	if (!hasLegacyHosts && newSection == oldSection && hasSection == !newSection.empty())
+	{
+		rememberAddedHosts(hostsHash, getHostsPath());
 		return true;
 	}
-	else
+
+	FILE *fileTmp = _wfopen(getTempHostsPath().c_str(), L"w");
+	if (!fileTmp)
+	{
+		return false;
+	}
+
+	if (!newSection.empty())
+	{
+		newSection.insert(0, beginMarker_ + L"\n");
+		newSection += endMarker_;
+		strs.insert(hasSection ? strs.begin() + sectionPos : strs.end(), newSection);
+	}
+	for (std::vector<std::wstring>::iterator it = strs.begin(); it != strs.end(); ++it)
+	{
+		fputws(it->c_str(), fileTmp);
+		if (it != strs.end() - 1)
+		{
+			fputws(L"\n", fileTmp);
+		}
+	}
+	fclose(fileTmp);
+
+	if (MoveFileEx(getTempHostsPath().c_str(), getHostsPath().c_str(), MOVEFILE_REPLACE_EXISTING) == 0)
 	{
 		return false;
 	}
+	rememberAddedHosts(hostsHash, getHostsPath());
+	return true;
 }
 
 bool HostsEdit::removeHosts()
@@ -186,16 +264,22 @@ std::wstring HostsEdit::getTempHostsPath()
     return szPath;
 }
 
-bool HostsEdit::stringInVector(std::vector<std::wstring> &vec, std::wstring &str)
+bool HostsEdit::getFileState(const std::wstring &path, FileState &state)
 {
-	for (std::vector<std::wstring>::iterator it = vec.begin(); it != vec.end(); ++it)
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data))
 	{
-		if (wcsstr(it->c_str(), str.c_str()) != NULL)
-		{
-			return true;
-		}
+		return false;
 	}
-	return false;
+	state.size = (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	state.lastWriteTime = data.ftLastWriteTime;
+	return true;
+}
+
+void HostsEdit::rememberAddedHosts(size_t hostsHash, const std::wstring &path)
+{
+	lastHostsHash_ = hostsHash;
+	isLastValid_ = getFileState(path, lastFileState_);
 }
 
 std::vector<std::wstring> &HostsEdit::split(const std::wstring &s, wchar_t delim, std::vector<std::wstring> &elems)
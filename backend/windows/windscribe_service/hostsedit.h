@@ -8,16 +8,37 @@ public:
     virtual ~HostsEdit();
 
     bool removeWindscribeHosts();
+	// the hosts are kept in the section between beginMarker_ and endMarker_, the rest of the file is copied as is,
+	// the file is replaced through a temp file only if the section changes
 	bool addHosts(std::wstring szHosts);
 	bool removeHosts();
 
 private:
+	struct FileState
+	{
+		ULONGLONG size;
+		FILETIME lastWriteTime;
+
+		bool operator==(const FileState &other) const
+		{
+			return size == other.size && CompareFileTime(&lastWriteTime, &other.lastWriteTime) == 0;
+		}
+	};
+
 	std::wstring szTitle_;
+	std::wstring beginMarker_;
+	std::wstring endMarker_;
     std::wstring szSystemDir_;
 
+	// the hosts of the last addHosts() and the state of the file after it, to skip the same call if the file isn't changed
+	size_t lastHostsHash_;
+	FileState lastFileState_;
+	bool isLastValid_;
+
     std::wstring getHostsPath();
     std::wstring getTempHostsPath();
-	bool stringInVector(std::vector<std::wstring> &vec, std::wstring &str);
+	bool getFileState(const std::wstring &path, FileState &state);
+	void rememberAddedHosts(size_t hostsHash, const std::wstring &path);
 	std::vector<std::wstring> &split(const std::wstring &s, wchar_t delim, std::vector<std::wstring> &elems);
 	std::vector<std::wstring> split(const std::wstring &s, wchar_t delim);
 };
@@ -1,14 +1,21 @@
 #include "all_headers.h"
 #include "IcsManager.h"
+#include "logger.h"
 
-
-IcsManager::IcsManager()
+IcsManager::IcsManager() : isFinishing_(false), isTaskRunning_(false), tasksFinished_(0), netSharingManager_(NULL),
+	isConnectionsValid_(false), hNetShell_(NULL), ncFreeNetconProperties_(NULL)
 {
-	
+	thread_ = std::thread(&IcsManager::threadFunc, this);
 }
 
 IcsManager::~IcsManager()
 {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isFinishing_ = true;
+	}
+	condition_.notify_all();
+	thread_.join();
 }
 
 bool IcsManager::isSupported()
@@ -29,4 +36,473 @@ bool IcsManager::isSupported()
 	}
 
 	return (bInstalled == VARIANT_TRUE);
-}
\ No newline at end of file
+}
+
+bool IcsManager::saveSettings(const std::wstring &configPath)
+{
+	Task task;
+	task.type = TASK_SAVE;
+	task.configPath = configPath;
+	return executeAndWait(std::move(task));
+}
+
+bool IcsManager::restoreSettings(const std::wstring &configPath)
+{
+	Task task;
+	task.type = TASK_RESTORE;
+	task.configPath = configPath;
+	return executeAndWait(std::move(task));
+}
+
+bool IcsManager::changeSettings(const std::wstring &publicGuid, const std::wstring &privateGuid, const std::wstring &eventName)
+{
+	Task task;
+	task.type = TASK_CHANGE;
+	task.outResult = NULL;
+	if (UuidFromString((RPC_WSTR)publicGuid.c_str(), &task.publicGuid) != RPC_S_OK ||
+		UuidFromString((RPC_WSTR)privateGuid.c_str(), &task.privateGuid) != RPC_S_OK)
+	{
+		Logger::instance().out(L"IcsManager::changeSettings, incorrect guid");
+		return false;
+	}
+	task.eventName = eventName;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		// the client sends the change on every state of the VPN connection, only the last one matters,
+		// the running task has read its guids already and isn't merged with
+		const bool isBackRunning = isTaskRunning_ && tasks_.size() == 1;
+		if (!tasks_.empty() && !isBackRunning && tasks_.back().type == TASK_CHANGE && tasks_.back().eventName == eventName)
+		{
+			tasks_.back().publicGuid = task.publicGuid;
+			tasks_.back().privateGuid = task.privateGuid;
+		}
+		else
+		{
+			tasks_.push_back(std::move(task));
+		}
+	}
+	condition_.notify_all();
+	return true;
+}
+
+bool IcsManager::executeAndWait(Task &&task)
+{
+	bool result = false;
+	task.outResult = &result;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	tasks_.push_back(std::move(task));
+	const unsigned long long taskNumber = tasksFinished_ + tasks_.size();
+	condition_.notify_all();
+	condition_.wait(lock, [this, taskNumber] { return tasksFinished_ >= taskNumber; });
+	return result;
+}
+
+void IcsManager::threadFunc()
+{
+	CoInitializeEx(0, COINIT_MULTITHREADED);
+	hNetShell_ = LoadLibrary(L"netshell.dll");
+	if (hNetShell_)
+	{
+		ncFreeNetconProperties_ = (PFNNcFreeNetconProperties)GetProcAddress(hNetShell_, "NcFreeNetconProperties");
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true)
+	{
+		condition_.wait(lock, [this] { return isFinishing_ || !tasks_.empty(); });
+		if (tasks_.empty())
+		{
+			break;
+		}
+		const Task task = tasks_.front();
+		isTaskRunning_ = true;
+		lock.unlock();
+
+		const bool result = executeTask(task);
+		if (!task.eventName.empty())
+		{
+			signalEvent(task.eventName);
+		}
+
+		lock.lock();
+		tasks_.pop_front();
+		isTaskRunning_ = false;
+		tasksFinished_++;
+		if (task.outResult)
+		{
+			*task.outResult = result;
+		}
+		condition_.notify_all();
+	}
+	lock.unlock();
+
+	clearConnections();
+	if (netSharingManager_)
+	{
+		netSharingManager_->Release();
+		netSharingManager_ = NULL;
+	}
+	if (hNetShell_)
+	{
+		FreeLibrary(hNetShell_);
+	}
+	CoUninitialize();
+}
+
+bool IcsManager::executeTask(const Task &task)
+{
+	if (!initSharingManager())
+	{
+		return false;
+	}
+
+	bool result = false;
+	if (task.type == TASK_SAVE)
+	{
+		result = save(task.configPath);
+	}
+	else if (task.type == TASK_RESTORE)
+	{
+		result = restore(task.configPath);
+	}
+	else if (task.type == TASK_CHANGE)
+	{
+		result = change(task.publicGuid, task.privateGuid);
+	}
+	return result;
+}
+
+bool IcsManager::initSharingManager()
+{
+	if (netSharingManager_)
+	{
+		return true;
+	}
+	HRESULT hr = ::CoCreateInstance(__uuidof(NetSharingManager), NULL, CLSCTX_ALL, __uuidof(INetSharingManager), (void**)&netSharingManager_);
+	if (hr != S_OK)
+	{
+		Logger::instance().out(L"IcsManager, CoCreateInstance NetSharingManager failed, %ld", hr);
+		netSharingManager_ = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool IcsManager::enumConnections()
+{
+	clearConnections();
+
+	INetSharingEveryConnectionCollection *pConnectionsList = NULL;
+	HRESULT hr = netSharingManager_->get_EnumEveryConnection(&pConnectionsList);
+	if (hr != S_OK)
+	{
+		Logger::instance().out(L"IcsManager, get_EnumEveryConnection failed, %ld", hr);
+		return false;
+	}
+
+	IUnknown *pUnkEnum = NULL;
+	hr = pConnectionsList->get__NewEnum(&pUnkEnum);
+	pConnectionsList->Release();
+	if (hr != S_OK)
+	{
+		Logger::instance().out(L"IcsManager, get__NewEnum failed, %ld", hr);
+		return false;
+	}
+
+	IEnumNetSharingEveryConnection *pNSEConn = NULL;
+	hr = pUnkEnum->QueryInterface(__uuidof(IEnumNetSharingEveryConnection), (void**)&pNSEConn);
+	pUnkEnum->Release();
+	if (hr != S_OK)
+	{
+		Logger::instance().out(L"IcsManager, QueryInterface IEnumNetSharingEveryConnection failed, %ld", hr);
+		return false;
+	}
+
+	VARIANT varItem;
+	VariantInit(&varItem);
+	while (pNSEConn->Next(1, &varItem, NULL) == S_OK)
+	{
+		INetConnection *pNetConnection = NULL;
+		if ((V_VT(&varItem) == VT_UNKNOWN) && V_UNKNOWN(&varItem) &&
+			V_UNKNOWN(&varItem)->QueryInterface(__uuidof(INetConnection), (void**)&pNetConnection) == S_OK)
+		{
+			NETCON_PROPERTIES *pProps = NULL;
+			INetSharingConfiguration *pConfiguration = NULL;
+			if (pNetConnection->GetProperties(&pProps) == S_OK &&
+				netSharingManager_->get_INetSharingConfigurationForINetConnection(pNetConnection, &pConfiguration) == S_OK)
+			{
+				Connection connection;
+				connection.guid = pProps->guidId;
+				connection.name = pProps->pszwName ? pProps->pszwName : L"";
+				connection.netConnection = pNetConnection;
+				connection.configuration = pConfiguration;
+				connections_.push_back(connection);
+				pNetConnection = NULL;
+			}
+			if (pProps && ncFreeNetconProperties_)
+			{
+				ncFreeNetconProperties_(pProps);
+			}
+			if (pNetConnection)
+			{
+				pNetConnection->Release();
+			}
+		}
+		VariantClear(&varItem);
+	}
+	pNSEConn->Release();
+
+	isConnectionsValid_ = true;
+	Logger::instance().out(L"IcsManager, enumerated %d connections", static_cast<int>(connections_.size()));
+	return true;
+}
+
+void IcsManager::clearConnections()
+{
+	for (Connection &connection : connections_)
+	{
+		connection.configuration->Release();
+		connection.netConnection->Release();
+	}
+	connections_.clear();
+	isConnectionsValid_ = false;
+}
+
+IcsManager::Connection *IcsManager::findConnection(const GUID &guid)
+{
+	for (Connection &connection : connections_)
+	{
+		if (connection.guid == guid)
+		{
+			return &connection;
+		}
+	}
+	return NULL;
+}
+
+bool IcsManager::save(const std::wstring &configPath)
+{
+	// the snapshot must include the connections added since the last enumeration
+	if (!enumConnections())
+	{
+		return false;
+	}
+
+	std::vector<SHARING_OPTIONS> vectorSaved;
+	for (const Connection &connection : connections_)
+	{
+		SHARING_OPTIONS opt;
+		opt.guid = connection.guid;
+		if (connection.configuration->get_SharingEnabled(&opt.bSharingEnabled) != S_OK ||
+			connection.configuration->get_SharingConnectionType(&opt.typeOfSharing) != S_OK)
+		{
+			Logger::instance().out(L"IcsManager::save, can't get the sharing state of %s", connection.name.c_str());
+			continue;
+		}
+		vectorSaved.push_back(opt);
+	}
+
+	FILE *file = _wfopen(configPath.c_str(), L"wb");
+	if (!file)
+	{
+		Logger::instance().out(L"IcsManager::save, can't create file: %s", configPath.c_str());
+		return false;
+	}
+	const size_t sz = vectorSaved.size();
+	bool bRet = fwrite(&sz, sizeof(sz), 1, file) == 1 &&
+		(sz == 0 || fwrite(vectorSaved.data(), sizeof(SHARING_OPTIONS), sz, file) == sz);
+	fclose(file);
+	if (!bRet)
+	{
+		Logger::instance().out(L"IcsManager::save, can't write to file: %s", configPath.c_str());
+	}
+	return bRet;
+}
+
+bool IcsManager::restore(const std::wstring &configPath)
+{
+	std::vector<SHARING_OPTIONS> vectorSaved;
+	FILE *file = _wfopen(configPath.c_str(), L"rb");
+	if (!file)
+	{
+		Logger::instance().out(L"IcsManager::restore, can't open file: %s", configPath.c_str());
+		return false;
+	}
+	size_t sz = 0;
+	bool bRet = fread(&sz, sizeof(sz), 1, file) == 1 && sz < 4096;
+	if (bRet)
+	{
+		vectorSaved.resize(sz);
+		bRet = sz == 0 || fread(vectorSaved.data(), sizeof(SHARING_OPTIONS), sz, file) == sz;
+	}
+	fclose(file);
+	if (!bRet)
+	{
+		Logger::instance().out(L"IcsManager::restore, can't read file: %s", configPath.c_str());
+		return false;
+	}
+
+	if (!isConnectionsValid_ && !enumConnections())
+	{
+		return false;
+	}
+	bool isRefreshed = false;
+	for (const SHARING_OPTIONS &opt : vectorSaved)
+	{
+		Connection *connection = findConnection(opt.guid);
+		if (!connection && !isRefreshed)
+		{
+			isRefreshed = true;
+			if (!enumConnections())
+			{
+				return false;
+			}
+			connection = findConnection(opt.guid);
+		}
+		// the connection was removed since the save
+		if (!connection)
+		{
+			continue;
+		}
+		if (!applyState(*connection, opt.bSharingEnabled == VARIANT_TRUE, opt.typeOfSharing))
+		{
+			Logger::instance().out(L"IcsManager::restore, failed for %s", connection->name.c_str());
+		}
+	}
+	return true;
+}
+
+bool IcsManager::change(const GUID &publicGuid, const GUID &privateGuid)
+{
+	struct State
+	{
+		Connection *connection;
+		VARIANT_BOOL bEnabled;
+		SHARINGCONNECTIONTYPE type;
+	};
+
+	// the second attempt is with the fresh enumeration, if the first one didn't find the connections or a call failed
+	for (int attempt = 0; attempt < 2; ++attempt)
+	{
+		if ((attempt > 0 || !isConnectionsValid_) && !enumConnections())
+		{
+			return false;
+		}
+
+		Connection *connectionPublic = findConnection(publicGuid);
+		Connection *connectionPrivate = findConnection(privateGuid);
+		if (connectionPublic == NULL || connectionPrivate == NULL)
+		{
+			if (attempt > 0)
+			{
+				Logger::instance().out(L"IcsManager::change, not found %s network connection by guid", connectionPublic == NULL ? L"public" : L"private");
+			}
+			continue;
+		}
+
+		std::vector<State> states;
+		states.reserve(connections_.size());
+		bool isReadFailed = false;
+		for (Connection &connection : connections_)
+		{
+			State state = { &connection, VARIANT_FALSE, ICSSHARINGTYPE_PUBLIC };
+			if (connection.configuration->get_SharingEnabled(&state.bEnabled) != S_OK ||
+				connection.configuration->get_SharingConnectionType(&state.type) != S_OK)
+			{
+				isReadFailed = true;
+				break;
+			}
+			states.push_back(state);
+		}
+		if (isReadFailed)
+		{
+			continue;
+		}
+
+		// only one public and one private connection can be shared at a time, so all the disables go first
+		std::vector<State> toEnable;
+		std::vector<Connection *> toDisable;
+		for (const State &state : states)
+		{
+			const bool isTarget = state.connection == connectionPublic || state.connection == connectionPrivate;
+			const SHARINGCONNECTIONTYPE targetType = state.connection == connectionPublic ? ICSSHARINGTYPE_PUBLIC : ICSSHARINGTYPE_PRIVATE;
+			const bool isEnabled = state.bEnabled == VARIANT_TRUE;
+			if (isEnabled && (!isTarget || state.type != targetType))
+			{
+				toDisable.push_back(state.connection);
+			}
+			if (isTarget && (!isEnabled || state.type != targetType))
+			{
+				State target = { state.connection, VARIANT_TRUE, targetType };
+				toEnable.push_back(target);
+			}
+		}
+
+		if (toDisable.empty() && toEnable.empty())
+		{
+			Logger::instance().out(L"IcsManager::change, nothing need to change");
+			return true;
+		}
+
+		bool isFailed = false;
+		for (Connection *connection : toDisable)
+		{
+			HRESULT hr = connection->configuration->DisableSharing();
+			if (hr != S_OK)
+			{
+				Logger::instance().out(L"IcsManager::change, DisableSharing failed for %s, %ld", connection->name.c_str(), hr);
+				isFailed = true;
+			}
+		}
+		for (const State &state : toEnable)
+		{
+			HRESULT hr = state.connection->configuration->EnableSharing(state.type);
+			if (hr != S_OK)
+			{
+				Logger::instance().out(L"IcsManager::change, EnableSharing failed for %s, %ld", state.connection->name.c_str(), hr);
+				isFailed = true;
+			}
+		}
+		if (!isFailed)
+		{
+			Logger::instance().out(L"IcsManager::change, disabled %d, enabled %d connections", static_cast<int>(toDisable.size()), static_cast<int>(toEnable.size()));
+			return true;
+		}
+	}
+	return false;
+}
+
+bool IcsManager::applyState(Connection &connection, bool isEnabled, SHARINGCONNECTIONTYPE type)
+{
+	VARIANT_BOOL bSharingEnabled = VARIANT_FALSE;
+	SHARINGCONNECTIONTYPE typeOfSharing = ICSSHARINGTYPE_PUBLIC;
+	if (connection.configuration->get_SharingEnabled(&bSharingEnabled) != S_OK ||
+		connection.configuration->get_SharingConnectionType(&typeOfSharing) != S_OK)
+	{
+		isConnectionsValid_ = false;
+		return false;
+	}
+
+	if ((bSharingEnabled == VARIANT_TRUE) == isEnabled && (!isEnabled || typeOfSharing == type))
+	{
+		return true;
+	}
+	HRESULT hr = isEnabled ? connection.configuration->EnableSharing(type) : connection.configuration->DisableSharing();
+	return hr == S_OK;
+}
+
+void IcsManager::signalEvent(const std::wstring &eventName)
+{
+	HANDLE hEvent = OpenEvent(EVENT_MODIFY_STATE, FALSE, eventName.c_str());
+	if (hEvent != NULL)
+	{
+		SetEvent(hEvent);
+		CloseHandle(hEvent);
+	}
+	else
+	{
+		Logger::instance().out(L"IcsManager, OpenEvent failed, err=%d", GetLastError());
+	}
+}
@@ -1,5 +1,14 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+// Internet Connection Sharing for the Wi-Fi sharing of the client. Keeps one INetSharingManager and the enumeration
+// of the connections with their sharing configurations for the lifetime of the service, the enumeration is refreshed
+// only when a connection isn't found in it or a call on a cached connection fails (the adapter was removed).
+// All the COM calls are made on the own thread of the manager: saveSettings and restoreSettings wait for the result,
+// changeSettings is queued (a newer request replaces a queued one, not the running one) and signals the named event when it's applied.
 class IcsManager
 {
 public:
@@ -7,5 +16,70 @@ public:
 	~IcsManager();
 
 	bool isSupported();
-};
 
+	// the sharing state of all the connections, in the file format of ChangeIcs.exe -save/-restore
+	bool saveSettings(const std::wstring &configPath);
+	bool restoreSettings(const std::wstring &configPath);
+	// shares the public connection to the private one, disables the sharing on the rest connections in the same pass
+	bool changeSettings(const std::wstring &publicGuid, const std::wstring &privateGuid, const std::wstring &eventName);
+
+private:
+	enum TASK_TYPE { TASK_SAVE, TASK_RESTORE, TASK_CHANGE };
+
+	struct Task
+	{
+		TASK_TYPE type;
+		std::wstring configPath;
+		GUID publicGuid;
+		GUID privateGuid;
+		std::wstring eventName;
+		bool *outResult;        // set under the mutex when the task is finished, NULL for the queued changes
+	};
+
+	struct Connection
+	{
+		GUID guid;
+		std::wstring name;
+		INetConnection *netConnection;
+		INetSharingConfiguration *configuration;
+	};
+
+	typedef struct
+	{
+		GUID guid;
+		VARIANT_BOOL bSharingEnabled;
+		SHARINGCONNECTIONTYPE typeOfSharing;
+	} SHARING_OPTIONS;
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<Task> tasks_;
+	bool isFinishing_;
+	bool isTaskRunning_;                    // the front of tasks_ is being executed, it's popped when finished
+	unsigned long long tasksFinished_;      // for the waits of saveSettings and restoreSettings
+	std::thread thread_;
+
+	// the thread of the manager only
+	INetSharingManager *netSharingManager_;
+	std::vector<Connection> connections_;
+	bool isConnectionsValid_;
+	typedef void (WINAPI *PFNNcFreeNetconProperties)(NETCON_PROPERTIES *pProps);
+	HMODULE hNetShell_;
+	PFNNcFreeNetconProperties ncFreeNetconProperties_;
+
+	bool executeAndWait(Task &&task);
+	void threadFunc();
+	bool executeTask(const Task &task);
+
+	bool initSharingManager();
+	bool enumConnections();
+	void clearConnections();
+	Connection *findConnection(const GUID &guid);
+
+	bool save(const std::wstring &configPath);
+	bool restore(const std::wstring &configPath);
+	bool change(const GUID &publicGuid, const GUID &privateGuid);
+	bool applyState(Connection &connection, bool isEnabled, SHARINGCONNECTIONTYPE type);
+
+	static void signalEvent(const std::wstring &eventName);
+};
@@ -10,6 +10,15 @@
 namespace
 {
 static const TCHAR kWindscribeConnectionName[] = TEXT("Windscribe IKEv2");
+static const TCHAR kNumCustomPolicy[] = TEXT("1");
+static const TCHAR kCustomIPSecPolicies[] = TEXT("020000000400000005000000080000000500000005000000");
+
+bool isPhoneBookValueSet(const TCHAR *key, const TCHAR *value, const TCHAR *pbk_path)
+{
+    TCHAR buffer[128] = {};
+    GetPrivateProfileString(kWindscribeConnectionName, key, L"", buffer, _countof(buffer), pbk_path);
+    return wcscmp(buffer, value) == 0;
+}
 
 // RAII helper for security impersonation as an active logged on user.
 // This is essential because phone books are specific to the user.
@@ -71,12 +80,15 @@ bool IKEv2IPSec::setIKEv2IPSecParametersInPhoneBook()
         if (pbk_handle == INVALID_HANDLE_VALUE)
             continue;
         CloseHandle(pbk_handle);
+        // The parameters are kept by the entry between the connects, the phonebook isn't rewritten then.
+        if (isPhoneBookValueSet(L"NumCustomPolicy", kNumCustomPolicy, pbk_path) &&
+            isPhoneBookValueSet(L"CustomIPSecPolicies", kCustomIPSecPolicies, pbk_path))
+            return true;
         // Write custom IPSec parameters to the phonebook.
         if (!WritePrivateProfileString(
-            kWindscribeConnectionName, L"NumCustomPolicy", L"1", pbk_path) ||
+            kWindscribeConnectionName, L"NumCustomPolicy", kNumCustomPolicy, pbk_path) ||
             !WritePrivateProfileString(
-                kWindscribeConnectionName, L"CustomIPSecPolicies",
-                L"020000000400000005000000080000000500000005000000", pbk_path)) {
+                kWindscribeConnectionName, L"CustomIPSecPolicies", kCustomIPSecPolicies, pbk_path)) {
             // This is a valid phonebook, but we cannot write it. Don't try other locations, they
             // won't make any sense; better to try other IPSec setup functions, like PowerShell.
             Logger::instance().out(L"Phonebook is not accessible: %ls", pbk_path);
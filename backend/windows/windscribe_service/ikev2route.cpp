@@ -3,12 +3,13 @@
 #include "adapters_info.h"
 #include "ip_address/ip4_address_and_mask.h"
 #include "logger.h"
+#include "network_snapshot.h"
 
 #pragma comment(lib, "Ntdll.lib")
 
 bool IKEv2Route::addRouteForIKEv2()
 {
-	AdaptersInfo ai;
+	AdaptersInfo ai(true);
 	IF_INDEX ifIndex;
 	std::wstring ip;
 
@@ -32,6 +33,7 @@ bool IKEv2Route::addRouteForIKEv2()
 			row.dwForwardMetric1 = interfaceRow.Metric;
 
 			DWORD status = CreateIpForwardEntry(&row);
+			NetworkSnapshot::instance().invalidateRoutes();
 			return status == NO_ERROR;
 		}
 		else
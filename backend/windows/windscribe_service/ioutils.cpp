@@ -40,3 +40,47 @@ bool IOUtils::writeAll(HANDLE hPipe, const char *buf, DWORD len)
     }
     return true;
 }
+
+bool IOUtils::readAllOrStop(HANDLE hPipe, char *buf, DWORD len, HANDLE hStopEvent)
+{
+    HANDLE hEvent = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (hEvent == NULL)
+    {
+        return false;
+    }
+
+    char *ptr = buf;
+    bool bRet = true;
+    while (len > 0)
+    {
+        OVERLAPPED overlapped = { 0 };
+        overlapped.hEvent = hEvent;
+        DWORD dwRead = 0;
+        if (!::ReadFile(hPipe, ptr, len, &dwRead, &overlapped))
+        {
+            if (::GetLastError() != ERROR_IO_PENDING && ::GetLastError() != ERROR_MORE_DATA)
+            {
+                bRet = false;
+                break;
+            }
+            HANDLE hEvents[2] = { hStopEvent, hEvent };
+            if (::WaitForMultipleObjects(2, hEvents, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+            {
+                ::CancelIo(hPipe);
+                ::GetOverlappedResult(hPipe, &overlapped, &dwRead, TRUE);
+                bRet = false;
+                break;
+            }
+            if (!::GetOverlappedResult(hPipe, &overlapped, &dwRead, FALSE) && ::GetLastError() != ERROR_MORE_DATA)
+            {
+                bRet = false;
+                break;
+            }
+        }
+        ptr += dwRead;
+        len -= dwRead;
+    }
+
+    ::CloseHandle(hEvent);
+    return bRet;
+}
@@ -6,6 +6,8 @@ class IOUtils
 public:
     static bool readAll(HANDLE hPipe, char *buf, DWORD len);
     static bool writeAll(HANDLE hPipe, const char *buf, DWORD len);
+    // for the pipe opened with FILE_FLAG_OVERLAPPED, waits for the data and returns false if hStopEvent is set
+    static bool readAllOrStop(HANDLE hPipe, char *buf, DWORD len, HANDLE hStopEvent);
 };
 
 #endif // IOUTILS_H
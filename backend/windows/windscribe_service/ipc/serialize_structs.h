@@ -86,6 +86,14 @@ void serialize(Archive & ar, CMD_CHECK_UNBLOCKING_CMD_STATUS & g, const unsigned
     ar & g.cmdId;
 }
 
+template<class Archive>
+void serialize(Archive & ar, CMD_WAIT_UNBLOCKING_CMD_STATUS & g, const unsigned int version)
+{
+    UNREFERENCED_PARAMETER(version);
+    ar & g.cmdId;
+    ar & g.timeoutMs;
+}
+
 template<class Archive>
 void serialize(Archive & ar, CMD_CLEAR_UNBLOCKING_CMD & g, const unsigned int version)
 {
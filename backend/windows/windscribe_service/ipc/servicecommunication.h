@@ -54,7 +54,18 @@
 #define AA_COMMAND_MAKE_HOSTS_FILE_WRITABLE                 50
 #define AA_COMMAND_REINSTALL_TAP_DRIVER                     51
 #define AA_COMMAND_REINSTALL_WINTUN_DRIVER                  52
-
+// the pipe stays open after this command, the next commands are prefixed with a request id, the replies too
+// the body is the requested SESSION_PROTOCOL_VERSION (unsigned long), the reply has the accepted one in exitCode
+#define AA_COMMAND_OPEN_SESSION                             53
+// answered when the unblocking command finishes or prints something, or after timeoutMs, additionalString is
+// the output since the previous wait (the old services answer with success = false, as for an unknown command id)
+#define AA_COMMAND_WAIT_UNBLOCKING_CMD_STATUS               54
+
+// 0 - boost text archives (as the commands without a session)
+// 1 - boost binary archives for the commands and the replies of the session
+#define SESSION_PROTOCOL_VERSION                            1
+
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -74,6 +85,12 @@ struct CMD_CHECK_UNBLOCKING_CMD_STATUS
     unsigned long cmdId;
 };
 
+struct CMD_WAIT_UNBLOCKING_CMD_STATUS
+{
+    unsigned long cmdId;
+    unsigned long timeoutMs;
+};
+
 struct CMD_ENABLE_FIREWALL_ON_BOOT
 {
     bool bEnable;
@@ -133,7 +150,7 @@ struct CMD_UPDATE_ICS
     std::wstring         szConfigPath;
     std::wstring         szPublicGuid;
     std::wstring         szPrivateGuid;
-    std::wstring         szEventName;
+    std::wstring         szEventName;   // change only, signaled by the service when the change is applied
 };
 
 struct CMD_WHITELIST_PORTS
@@ -260,6 +277,44 @@ enum WireGuardServiceState
     WIREGUARD_STATE_ACTIVE,     // WireGuard is connected.
 };
 
+// WireGuard statistics published by the service to the shared memory while the tunnel is installed,
+// so the engine reads them without a command round trip. Written by one thread with a sequence lock:
+// the sequence is odd while the block is being written, a reader retries if it changed during the copy.
+#define WIREGUARD_STATS_MAPPING_NAME L"Global\\WindscribeWireGuardStats"
+#define WIREGUARD_STATS_UPDATE_INTERVAL_MS 250
+
+struct WireGuardStatsBlock
+{
+    volatile LONG64 sequence;
+    UINT32 state;               // WireGuardServiceState
+    UINT64 lastHandshake;       // FILETIME of the latest handshake, 0 if none
+    UINT64 txBytes;
+    UINT64 rxBytes;
+    UINT64 updateTime;          // GetTickCount64() of the update
+    char endpoint[64];          // "ip:port" of the peer
+};
+
+inline bool readWireGuardStatsBlock(const WireGuardStatsBlock *block, WireGuardStatsBlock &out)
+{
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+        const LONG64 seq1 = block->sequence;
+        if (seq1 & 1)
+        {
+            YieldProcessor();
+            continue;
+        }
+        MemoryBarrier();
+        memcpy(&out, const_cast<const WireGuardStatsBlock *>(block), sizeof(out));
+        MemoryBarrier();
+        if (block->sequence == seq1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 struct MessagePacketResult
 {
 	__int64 id;
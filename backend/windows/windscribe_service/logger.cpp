@@ -3,51 +3,191 @@
 
 void Logger::out(const wchar_t *format, ...)
 {
-    EnterCriticalSection(&cs_);
+    va_list args;
+    va_start(args, format);
+    vout(format, args);
+    va_end(args);
+}
+
+void Logger::out(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vout(format, args);
+	va_end(args);
+}
+
+void Logger::outVerbose(const wchar_t *format, ...)
+{
+    if (!isVerboseEnabled_)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vout(format, args);
+    va_end(args);
+}
+
+void Logger::outVerbose(const char *format, ...)
+{
+    if (!isVerboseEnabled_)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vout(format, args);
+    va_end(args);
+}
+
+void Logger::vout(const wchar_t *format, va_list args)
+{
+    if (!file_)
+    {
+        return;
+    }
+    wchar_t buffer2[10000];
+    _vsnwprintf(buffer2, 10000, format, args);
+    buffer2[9999] = L'\0';
+
+    Line line;
+    line.isWide = true;
+    line.wstr = L"[" + time_helper_.getCurrentTimeString<wchar_t>() + L"] [service]\t " + std::wstring(buffer2) + L"\n";
+    const size_t bytes = line.wstr.size() * sizeof(wchar_t);
+    enqueue(std::move(line), bytes);
+}
+
+void Logger::vout(const char *format, va_list args)
+{
+    if (!file_)
+    {
+        return;
+    }
+    char buffer2[10000];
+    _vsnprintf(buffer2, 10000, format, args);
+    buffer2[9999] = '\0';
+
+    Line line;
+    line.isWide = false;
+    line.str = "[" + time_helper_.getCurrentTimeString<char>() + "] [service]\t " + std::string(buffer2) + "\n";
+    const size_t bytes = line.str.size();
+    enqueue(std::move(line), bytes);
+}
+
+void Logger::enqueue(Line &&line, size_t bytes)
+{
+    bool isNeedWakeUp = false;
+    {
+        std::lock_guard<std::mutex> locker(queueMutex_);
+        if (queue_.size() >= MAX_QUEUE_SIZE)
+        {
+            droppedLines_++;
+            return;
+        }
+        queue_.push_back(std::move(line));
+        queueBytes_ += bytes;
+        isNeedWakeUp = (queueBytes_ >= FLUSH_SIZE);
+    }
+    if (isNeedWakeUp)
+    {
+        queueCondition_.notify_one();
+    }
+}
+
+void Logger::flush()
+{
     if (file_)
     {
-        va_list args;
-        va_start (args, format);
-        wchar_t buffer2[10000];
-        _vsnwprintf (buffer2, 10000, format, args);
+        writeQueue();
+    }
+}
 
-        std::wstring strTime = time_helper_.getCurrentTimeString<wchar_t>();
-        std::wstring str = L"[" + strTime + L"] [service]\t " + std::wstring(buffer2) + L"\n";
-#ifdef _DEBUG
-		wprintf(L"%s", str.c_str());
-#else
-        fputws(str.c_str(), file_);
-#endif
-        fflush(file_);
-        va_end (args);
+void Logger::flushOnCrash()
+{
+    // the crashed thread may hold a lock, then the queue is skipped rather than hang before TerminateProcess
+    if (!file_ || !TryEnterCriticalSection(&cs_))
+    {
+        return;
     }
+    std::unique_lock<std::mutex> locker(queueMutex_, std::try_to_lock);
+    if (locker.owns_lock())
+    {
+        std::deque<Line> lines;
+        size_t droppedLines;
+        takeQueue(lines, droppedLines);
+        locker.unlock();
+        writeLines(lines, droppedLines);
+    }
+    fflush(file_);
     LeaveCriticalSection(&cs_);
 }
 
-void Logger::out(const char *format, ...)
+void Logger::writerThreadFunc()
+{
+    std::unique_lock<std::mutex> locker(queueMutex_);
+    while (!isFinishing_)
+    {
+        queueCondition_.wait_for(locker, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]() {
+            return isFinishing_ || queueBytes_ >= FLUSH_SIZE;
+        });
+        if (queue_.empty() && droppedLines_ == 0)
+        {
+            continue;
+        }
+        locker.unlock();
+        writeQueue();
+        locker.lock();
+    }
+}
+
+void Logger::writeQueue()
+{
+    // the queue is taken under the file lock, so the batches of the writer thread and flush() are written in order
+    EnterCriticalSection(&cs_);
+    std::deque<Line> lines;
+    size_t droppedLines;
+    {
+        std::lock_guard<std::mutex> locker(queueMutex_);
+        takeQueue(lines, droppedLines);
+    }
+    writeLines(lines, droppedLines);
+    fflush(file_);
+    LeaveCriticalSection(&cs_);
+}
+
+void Logger::takeQueue(std::deque<Line> &lines, size_t &droppedLines)
 {
-	EnterCriticalSection(&cs_);
-	if (file_)
-	{
-		va_list args;
-		va_start(args, format);
-		char buffer2[10000];
-		_vsnprintf(buffer2, 10000, format, args);
+    lines.swap(queue_);
+    queueBytes_ = 0;
+    droppedLines = droppedLines_;
+    droppedLines_ = 0;
+}
 
-		std::string strTime = time_helper_.getCurrentTimeString<char>();
-		std::string str = "[" + strTime + "] [service]\t " + std::string(buffer2) + "\n";
+void Logger::writeLines(std::deque<Line> &lines, size_t droppedLines)
+{
+    for (const Line &line : lines)
+    {
 #ifdef _DEBUG
-		printf("%s", str.c_str());
+        if (line.isWide)
+            wprintf(L"%s", line.wstr.c_str());
+        else
+            printf("%s", line.str.c_str());
 #else
-		fputs(str.c_str(), file_);
+        if (line.isWide)
+            fputws(line.wstr.c_str(), file_);
+        else
+            fputs(line.str.c_str(), file_);
 #endif
-		fflush(file_);
-		va_end(args);
-	}
-	LeaveCriticalSection(&cs_);
+    }
+    if (droppedLines > 0)
+    {
+        fprintf(file_, "[%s] [service]\t Logger: %zu lines dropped, the queue was full\n",
+                time_helper_.getCurrentTimeString<char>().c_str(), droppedLines);
+    }
 }
 
-Logger::Logger()
+Logger::Logger() : queueBytes_(0), droppedLines_(0), isFinishing_(false)
 {
     InitializeCriticalSection(&cs_);
     wchar_t buffer[MAX_PATH];
@@ -64,12 +204,33 @@ Logger::Logger()
     }
 
     file_ = _wfopen(filePath.c_str(), L"w+");
+    if (file_)
+    {
+        setvbuf(file_, NULL, _IOFBF, FLUSH_SIZE);
+        writerThread_ = std::thread(&Logger::writerThreadFunc, this);
+    }
+
+#ifdef _DEBUG
+    isVerboseEnabled_ = true;
+#else
+    isVerboseEnabled_ = readVerboseSetting();
+#endif
 }
 
 Logger::~Logger()
 {
+    if (writerThread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> locker(queueMutex_);
+            isFinishing_ = true;
+        }
+        queueCondition_.notify_one();
+        writerThread_.join();
+    }
     if (file_)
     {
+        flush();
         fclose(file_);
     }
     DeleteCriticalSection(&cs_);
@@ -81,6 +242,16 @@ bool Logger::isFileExist(const std::wstring &fileName)
     return infile.good();
 }
 
+bool Logger::readVerboseSetting()
+{
+    // read directly, Registry logs through the Logger
+    DWORD value = 0;
+    DWORD size = sizeof(value);
+    const LSTATUS status = RegGetValue(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Windscribe\\Windscribe", L"ServiceVerboseLogging",
+                                       RRF_RT_REG_DWORD, NULL, &value, &size);
+    return status == ERROR_SUCCESS && value == 1;
+}
+
 void Logger::debugOut(const char *format, ...)
 {
     va_list arg_list;
@@ -1,8 +1,19 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "date_time_helper.h"
 
+// The lines are formatted by the calling thread and queued, a background thread writes them to the file and flushes it
+// once a second or when FLUSH_SIZE bytes are pending, so the service threads (WFP, split tunneling callbacks, ExecuteCmd)
+// don't wait for the disk. If the queue is full, the lines are dropped and their count is logged.
+// flush() writes the queue synchronously on the shutdown, flushOnCrash() does the same for the crash handler but skips
+// the queue if its locks are taken.
+// The verbose lines (outVerbose) are enabled by the DWORD ServiceVerboseLogging = 1 in HKLM\SOFTWARE\Windscribe\Windscribe
+// (or in debug builds), when disabled they aren't even formatted.
 class Logger
 {
 public:
@@ -14,19 +25,54 @@ public:
 
     void out(const wchar_t *format, ...);
 	void out(const char *format, ...);
+    void outVerbose(const wchar_t *format, ...);
+    void outVerbose(const char *format, ...);
     void debugOut(const char *format, ...);
 
+    bool isVerboseEnabled() const { return isVerboseEnabled_; }
+    void flush();
+    void flushOnCrash();
+
 private:
     Logger();
     ~Logger();
     Logger(const Logger &) = delete;
     Logger &operator=(const Logger &) = delete;
 
+    static constexpr size_t MAX_QUEUE_SIZE = 4096;     // lines
+    static constexpr size_t FLUSH_SIZE = 64 * 1024;    // bytes
+    static constexpr int FLUSH_INTERVAL_MS = 1000;
+
+    struct Line
+    {
+        bool isWide;
+        std::string str;
+        std::wstring wstr;
+    };
+
     FILE *file_;
-    CRITICAL_SECTION cs_;
+    CRITICAL_SECTION cs_;          // the file, held by the writer thread and flush()
     DateTimeHelper time_helper_;
+    bool isVerboseEnabled_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueCondition_;
+    std::deque<Line> queue_;
+    size_t queueBytes_;
+    size_t droppedLines_;
+    bool isFinishing_;
+    std::thread writerThread_;
+
+    void vout(const wchar_t *format, va_list args);
+    void vout(const char *format, va_list args);
+    void enqueue(Line &&line, size_t bytes);
+    void writerThreadFunc();
+    void writeQueue();
+    void takeQueue(std::deque<Line> &lines, size_t &droppedLines);     // under queueMutex_
+    void writeLines(std::deque<Line> &lines, size_t droppedLines);
 
     bool isFileExist(const std::wstring &fileName);
+    static bool readVerboseSetting();
 };
 
 #endif // LOGGER_H
@@ -0,0 +1,179 @@
+#include "all_headers.h"
+#include "network_snapshot.h"
+#include "logger.h"
+
+namespace {
+const ULONGLONG MAX_SNAPSHOT_AGE_MS = 5000;
+const int MAX_TRIES = 5;
+}
+
+NetworkSnapshot::NetworkSnapshot() : hInterfaceNotify_(NULL), hAddressNotify_(NULL), hRouteNotify_(NULL)
+{
+}
+
+NetworkSnapshot::~NetworkSnapshot()
+{
+	stop();
+}
+
+void NetworkSnapshot::start()
+{
+	if (hInterfaceNotify_ || hAddressNotify_ || hRouteNotify_)
+	{
+		return;
+	}
+
+	// without the notifications the snapshots are still used, up to their max age
+	DWORD dwErr = NotifyIpInterfaceChange(AF_UNSPEC, onInterfaceChange, this, FALSE, &hInterfaceNotify_);
+	if (dwErr != NO_ERROR)
+	{
+		Logger::instance().out(L"NetworkSnapshot::start(), NotifyIpInterfaceChange failed: %lu", dwErr);
+		hInterfaceNotify_ = NULL;
+	}
+	dwErr = NotifyUnicastIpAddressChange(AF_UNSPEC, onAddressChange, this, FALSE, &hAddressNotify_);
+	if (dwErr != NO_ERROR)
+	{
+		Logger::instance().out(L"NetworkSnapshot::start(), NotifyUnicastIpAddressChange failed: %lu", dwErr);
+		hAddressNotify_ = NULL;
+	}
+	dwErr = NotifyRouteChange2(AF_INET, onRouteChange, this, FALSE, &hRouteNotify_);
+	if (dwErr != NO_ERROR)
+	{
+		Logger::instance().out(L"NetworkSnapshot::start(), NotifyRouteChange2 failed: %lu", dwErr);
+		hRouteNotify_ = NULL;
+	}
+}
+
+void NetworkSnapshot::stop()
+{
+	// CancelMibChangeNotify2 waits for the running callbacks
+	for (HANDLE *handle : { &hInterfaceNotify_, &hAddressNotify_, &hRouteNotify_ })
+	{
+		if (*handle)
+		{
+			CancelMibChangeNotify2(*handle);
+			*handle = NULL;
+		}
+	}
+	invalidateAdapters();
+	invalidateRoutes();
+}
+
+std::shared_ptr<const std::vector<unsigned char>> NetworkSnapshot::adapters(bool isRefresh)
+{
+	return get(adapters_, isRefresh, queryAdapters);
+}
+
+std::shared_ptr<const std::vector<unsigned char>> NetworkSnapshot::routes()
+{
+	return get(routes_, false, queryRoutes);
+}
+
+void NetworkSnapshot::invalidateAdapters()
+{
+	invalidate(adapters_);
+}
+
+void NetworkSnapshot::invalidateRoutes()
+{
+	invalidate(routes_);
+}
+
+std::shared_ptr<const std::vector<unsigned char>> NetworkSnapshot::get(Snapshot &snapshot, bool isRefresh,
+	std::shared_ptr<const std::vector<unsigned char>> (*query)())
+{
+	unsigned int generation;
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		if (!isRefresh && isFresh(snapshot))
+		{
+			return snapshot.data;
+		}
+		generation = snapshot.generation;
+	}
+
+	// queried without the lock, the result of a query overtaken by a change is returned but not kept
+	const ULONGLONG time = GetTickCount64();
+	std::shared_ptr<const std::vector<unsigned char>> data = query();
+	std::lock_guard<std::mutex> guard(mutex_);
+	if (data && snapshot.generation == generation)
+	{
+		snapshot.data = data;
+		snapshot.time = time;
+		snapshot.isValid = true;
+	}
+	return data;
+}
+
+void NetworkSnapshot::invalidate(Snapshot &snapshot)
+{
+	std::lock_guard<std::mutex> guard(mutex_);
+	snapshot.isValid = false;
+	snapshot.data.reset();
+	snapshot.generation++;
+}
+
+bool NetworkSnapshot::isFresh(const Snapshot &snapshot) const
+{
+	return snapshot.isValid && GetTickCount64() - snapshot.time < MAX_SNAPSHOT_AGE_MS;
+}
+
+std::shared_ptr<const std::vector<unsigned char>> NetworkSnapshot::queryAdapters()
+{
+	auto arr = std::make_shared<std::vector<unsigned char>>(16384);
+	ULONG outBufLen = static_cast<ULONG>(arr->size());
+	DWORD dwRetVal = ERROR_BUFFER_OVERFLOW;
+	for (int i = 0; i < MAX_TRIES && dwRetVal == ERROR_BUFFER_OVERFLOW; ++i)
+	{
+		dwRetVal = GetAdaptersAddresses(AF_UNSPEC, NULL, NULL, (PIP_ADAPTER_ADDRESSES)&(*arr)[0], &outBufLen);
+		if (dwRetVal == ERROR_BUFFER_OVERFLOW)
+		{
+			arr->resize(outBufLen);
+		}
+	}
+	if (dwRetVal != NO_ERROR)
+	{
+		Logger::instance().out(L"NetworkSnapshot, GetAdaptersAddresses failed %lu", dwRetVal);
+		return nullptr;
+	}
+	return arr;
+}
+
+std::shared_ptr<const std::vector<unsigned char>> NetworkSnapshot::queryRoutes()
+{
+	auto arr = std::make_shared<std::vector<unsigned char>>(sizeof(MIB_IPFORWARDROW) * 32);
+	ULONG ulSize = static_cast<ULONG>(arr->size());
+	DWORD dwStatus = ERROR_INSUFFICIENT_BUFFER;
+	for (int i = 0; i < MAX_TRIES && dwStatus == ERROR_INSUFFICIENT_BUFFER; ++i)
+	{
+		dwStatus = GetIpForwardTable((MIB_IPFORWARDTABLE *)&(*arr)[0], &ulSize, FALSE);
+		if (dwStatus == ERROR_INSUFFICIENT_BUFFER)
+		{
+			arr->resize(ulSize);
+		}
+	}
+	if (dwStatus != NO_ERROR)
+	{
+		Logger::instance().out(L"NetworkSnapshot, GetIpForwardTable failed %lu", dwStatus);
+		return nullptr;
+	}
+	return arr;
+}
+
+VOID NETIOAPI_API_ NetworkSnapshot::onInterfaceChange(PVOID context, PMIB_IPINTERFACE_ROW /*row*/, MIB_NOTIFICATION_TYPE /*type*/)
+{
+	// the interface metrics and states are also in the routes
+	NetworkSnapshot *that = static_cast<NetworkSnapshot *>(context);
+	that->invalidateAdapters();
+	that->invalidateRoutes();
+}
+
+VOID NETIOAPI_API_ NetworkSnapshot::onAddressChange(PVOID context, PMIB_UNICASTIPADDRESS_ROW /*row*/, MIB_NOTIFICATION_TYPE /*type*/)
+{
+	static_cast<NetworkSnapshot *>(context)->invalidateAdapters();
+}
+
+VOID NETIOAPI_API_ NetworkSnapshot::onRouteChange(PVOID context, PMIB_IPFORWARD_ROW2 /*row*/, MIB_NOTIFICATION_TYPE /*type*/)
+{
+	static_cast<NetworkSnapshot *>(context)->invalidateRoutes();
+}
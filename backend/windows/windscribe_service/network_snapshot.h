@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+
+// Service-wide cache of the adapters (GetAdaptersAddresses) and the IPv4 route table (GetIpForwardTable).
+// A snapshot is taken on the first request after a change and shared by the readers, a reader keeps a consistent
+// (immutable) one for as long as it holds it. The changes come from the NotifyIpInterfaceChange,
+// NotifyUnicastIpAddressChange and NotifyRouteChange2 callbacks, the route changes of the service itself invalidate
+// the routes at once (the callbacks are asynchronous). DNS server changes have no notification, the readers of
+// the DNS servers ask for a refresh; a snapshot also expires after a few seconds as a safety net.
+class NetworkSnapshot
+{
+public:
+	static NetworkSnapshot &instance()
+	{
+		static NetworkSnapshot i;
+		return i;
+	}
+
+	void start();
+	void stop();
+
+	// the IP_ADAPTER_ADDRESSES list (AF_UNSPEC, default flags), nullptr on error
+	std::shared_ptr<const std::vector<unsigned char>> adapters(bool isRefresh = false);
+	// the MIB_IPFORWARDTABLE, nullptr on error
+	std::shared_ptr<const std::vector<unsigned char>> routes();
+
+	void invalidateAdapters();
+	void invalidateRoutes();
+
+private:
+	NetworkSnapshot();
+	~NetworkSnapshot();
+	NetworkSnapshot(const NetworkSnapshot &) = delete;
+	NetworkSnapshot &operator=(const NetworkSnapshot &) = delete;
+
+	struct Snapshot
+	{
+		std::shared_ptr<const std::vector<unsigned char>> data;
+		ULONGLONG time = 0;
+		bool isValid = false;
+		unsigned int generation = 0;    // incremented on every change
+	};
+
+	std::mutex mutex_;
+	Snapshot adapters_;
+	Snapshot routes_;
+	HANDLE hInterfaceNotify_;
+	HANDLE hAddressNotify_;
+	HANDLE hRouteNotify_;
+
+	bool isFresh(const Snapshot &snapshot) const;
+	std::shared_ptr<const std::vector<unsigned char>> get(Snapshot &snapshot, bool isRefresh,
+		std::shared_ptr<const std::vector<unsigned char>> (*query)());
+	void invalidate(Snapshot &snapshot);
+
+	static std::shared_ptr<const std::vector<unsigned char>> queryAdapters();
+	static std::shared_ptr<const std::vector<unsigned char>> queryRoutes();
+
+	static VOID NETIOAPI_API_ onInterfaceChange(PVOID context, PMIB_IPINTERFACE_ROW row, MIB_NOTIFICATION_TYPE type);
+	static VOID NETIOAPI_API_ onAddressChange(PVOID context, PMIB_UNICASTIPADDRESS_ROW row, MIB_NOTIFICATION_TYPE type);
+	static VOID NETIOAPI_API_ onRouteChange(PVOID context, PMIB_IPFORWARD_ROW2 row, MIB_NOTIFICATION_TYPE type);
+};
@@ -1,10 +1,9 @@
 #include "all_headers.h"
 #include "pipe_for_process.h"
-#include "../../../common/utils/crashhandler.h"
 
 unsigned long PipeForProcess::pipeSerialNumber_ = 0;
 
-PipeForProcess::PipeForProcess() : hReadPipe_(NULL), hWritePipe_(NULL), hThread_(NULL), hStopEvent_(NULL), is_suspended_output_(false)
+PipeForProcess::PipeForProcess() : hReadPipe_(NULL), hWritePipe_(NULL), io_(NULL), is_suspended_output_(false), is_stopped_(true)
 {
 	SECURITY_ATTRIBUTES sa;
 	ZeroMemory(&sa, sizeof(sa));
@@ -16,11 +15,19 @@ PipeForProcess::PipeForProcess() : hReadPipe_(NULL), hWritePipe_(NULL), hThread_
 		hReadPipe_ = NULL;
 		hWritePipe_ = NULL;
 	}
+	else
+	{
+		io_ = CreateThreadpoolIo(hReadPipe_, ioCallback, this, NULL);
+	}
 }
 
 PipeForProcess::~PipeForProcess()
 {
-	stopThread();
+	stopReading();
+	if (io_)
+	{
+		CloseThreadpoolIo(io_);
+	}
 	if (hReadPipe_)
 	{
 		CloseHandle(hReadPipe_);
@@ -36,23 +43,38 @@ HANDLE PipeForProcess::getPipeHandle()
 	return hWritePipe_;
 }
 
-void PipeForProcess::startReading()
+void PipeForProcess::startReading(std::function<void()> onOutput)
 {
+	if (!io_)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
 	output_.clear();
 	is_suspended_output_ = false;
-	hStopEvent_ = CreateEvent(NULL, TRUE, FALSE, NULL);
-	hThread_ = CreateThread(NULL, 0, readThread, this, 0, NULL);
+	onOutput_ = onOutput;
+	is_stopped_ = !startRead();
 }
 
 void PipeForProcess::suspendReading()
 {
+	std::lock_guard<std::mutex> lock(mutex_);
 	is_suspended_output_ = true;
 	output_.clear();
 }
 
+std::string PipeForProcess::takeOutput()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::string output;
+	output.swap(output_);
+	return output;
+}
+
 std::string PipeForProcess::stopAndGetOutput()
 {
-	stopThread();
+	stopReading();
+	std::lock_guard<std::mutex> lock(mutex_);
 	return output_;
 }
 
@@ -111,63 +133,57 @@ BOOL APIENTRY PipeForProcess::myCreatePipeEx(OUT LPHANDLE lpReadPipe, OUT LPHAND
 	return TRUE;
 }
 
-DWORD WINAPI PipeForProcess::readThread(LPVOID lpParam)
+bool PipeForProcess::startRead()
 {
-    BIND_CRASH_HANDLER_FOR_THREAD();
-	PipeForProcess *this_ = static_cast<PipeForProcess *>(lpParam);
-
-	HANDLE hEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
-	if (hEvent == NULL)
+	// called with mutex_ locked
+	memset(&overlapped_, 0, sizeof(overlapped_));
+	StartThreadpoolIo(io_);
+	if (!::ReadFile(hReadPipe_, buf_, BUFFER_SIZE, NULL, &overlapped_) && GetLastError() != ERROR_IO_PENDING)
 	{
-		return 0;
+		// no completion will come for this read
+		CancelThreadpoolIo(io_);
+		return false;
 	}
-	
-	const int BUFFER_SIZE = 4096;
-	char buf[BUFFER_SIZE + 1];
-	DWORD readword;
-
-	OVERLAPPED overlapped;
-	memset(&overlapped, 0, sizeof(overlapped));
-	overlapped.hEvent = hEvent;
+	return true;
+}
 
-	HANDLE hEvents[2];
-	hEvents[0] = this_->hStopEvent_;
-	hEvents[1] = hEvent;
+VOID CALLBACK PipeForProcess::ioCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PVOID /*overlapped*/, ULONG ioResult,
+										 ULONG_PTR bytesTransferred, PTP_IO /*io*/)
+{
+	PipeForProcess *this_ = static_cast<PipeForProcess *>(context);
 
-	while (true)
+	bool isAppended = false;
 	{
-		::ReadFile(this_->hReadPipe_, buf, BUFFER_SIZE, &readword, &overlapped);
-
-		DWORD dwWait = WaitForMultipleObjects(2, hEvents, FALSE, INFINITE);
-		if (dwWait == WAIT_OBJECT_0)
+		std::lock_guard<std::mutex> lock(this_->mutex_);
+		if (ioResult == NO_ERROR && bytesTransferred != 0 && !this_->is_suspended_output_)
 		{
-			break;
+			this_->buf_[bytesTransferred] = '\0';
+			this_->output_ += this_->buf_;
+			isAppended = true;
 		}
-		else if (dwWait == (WAIT_OBJECT_0 + 1))
+		// the read cancelled by stopReading() or a broken pipe ends the reading
+		if (ioResult != NO_ERROR || this_->is_stopped_ || !this_->startRead())
 		{
-			GetOverlappedResult(this_->hReadPipe_, &overlapped, &readword, FALSE);
-			if (readword != 0 && !this_->is_suspended_output_)
-			{
-				buf[readword] = '\0';
-				std::string cstemp = buf;
-				this_->output_ += cstemp;
-			}
+			this_->is_stopped_ = true;
 		}
 	}
-
-	CloseHandle(hEvent);
-	return 0;
+	if (isAppended && this_->onOutput_)
+	{
+		this_->onOutput_();
+	}
 }
 
-void PipeForProcess::stopThread()
+void PipeForProcess::stopReading()
 {
-	if (hThread_)
+	if (!io_)
 	{
-		SetEvent(hStopEvent_);
-		WaitForSingleObject(hThread_, INFINITE);
-		CloseHandle(hStopEvent_);
-		CloseHandle(hThread_);
-		hStopEvent_ = NULL;
-		hThread_ = NULL;
+		return;
 	}
-}
\ No newline at end of file
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_stopped_ = true;
+	}
+	// the pending read completes with ERROR_OPERATION_ABORTED and its callback doesn't start another one
+	CancelIoEx(hReadPipe_, &overlapped_);
+	WaitForThreadpoolIoCallbacks(io_, FALSE);
+}
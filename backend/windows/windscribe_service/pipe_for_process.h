@@ -7,25 +7,38 @@ public:
 	~PipeForProcess();
 
 	HANDLE getPipeHandle();
-	void startReading();
+	// onOutput is called from a thread pool thread after each piece of the output
+	void startReading(std::function<void()> onOutput = std::function<void()>());
 	void suspendReading();
+	// the output since the previous call, while the process runs
+	std::string takeOutput();
 	std::string stopAndGetOutput();
 
 private:
 	static unsigned long pipeSerialNumber_;
 	const int PIPE_SIZE = 16000;
 
+	static const int BUFFER_SIZE = 4096;
+
 	HANDLE hReadPipe_;
 	HANDLE hWritePipe_;
-	HANDLE hThread_;
-	HANDLE hStopEvent_;
+	// the reads complete on the completion port of the process thread pool, the running commands share its
+	// threads instead of a read thread per command; one read is pending at a time
+	PTP_IO io_;
+	OVERLAPPED overlapped_;
+	char buf_[BUFFER_SIZE + 1];
+	std::mutex mutex_;	// output_, is_suspended_output_ and is_stopped_, the io callback and the callers
 	std::string output_;
 	bool is_suspended_output_;
+	bool is_stopped_;
+	std::function<void()> onOutput_;
 
 	static BOOL APIENTRY myCreatePipeEx(OUT LPHANDLE lpReadPipe, OUT LPHANDLE lpWritePipe, IN LPSECURITY_ATTRIBUTES lpPipeAttributes,
 								 IN DWORD nSize, DWORD dwReadMode, DWORD dwWriteMode);
-	static DWORD WINAPI readThread(LPVOID lpParam);
-	void stopThread();
+	static VOID CALLBACK ioCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG ioResult,
+									ULONG_PTR bytesTransferred, PTP_IO io);
+	bool startRead();
+	void stopReading();
 
 };
 
@@ -0,0 +1,333 @@
+#include "all_headers.h"
+#include "process_monitor.h"
+#include "logger.h"
+#include "../../../common/utils/crashhandler.h"
+#include <tdh.h>
+#include <cwctype>
+
+namespace {
+// Microsoft-Windows-Kernel-Process {22FB2CD6-0E7B-422B-A0C7-2FAD1FD0E716}
+const GUID KERNEL_PROCESS_PROVIDER = { 0x22fb2cd6, 0x0e7b, 0x422b, { 0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16 } };
+const ULONGLONG WINEVENT_KEYWORD_PROCESS = 0x10;
+const USHORT EVENT_ID_PROCESS_START = 1;
+const USHORT EVENT_ID_PROCESS_STOP = 2;
+const wchar_t *SESSION_NAME = L"WindscribeProcessMonitor";
+
+bool getUInt32Property(PEVENT_RECORD pEvent, const wchar_t *name, ULONG &value)
+{
+	PROPERTY_DATA_DESCRIPTOR descriptor;
+	descriptor.PropertyName = reinterpret_cast<ULONGLONG>(name);
+	descriptor.ArrayIndex = ULONG_MAX;
+	descriptor.Reserved = 0;
+	return TdhGetProperty(pEvent, 0, NULL, 1, &descriptor, sizeof(value), reinterpret_cast<PBYTE>(&value)) == ERROR_SUCCESS;
+}
+
+bool getStringProperty(PEVENT_RECORD pEvent, const wchar_t *name, std::wstring &value)
+{
+	PROPERTY_DATA_DESCRIPTOR descriptor;
+	descriptor.PropertyName = reinterpret_cast<ULONGLONG>(name);
+	descriptor.ArrayIndex = ULONG_MAX;
+	descriptor.Reserved = 0;
+	ULONG size = 0;
+	if (TdhGetPropertySize(pEvent, 0, NULL, 1, &descriptor, &size) != ERROR_SUCCESS || size < sizeof(wchar_t))
+	{
+		return false;
+	}
+	std::vector<wchar_t> buf(size / sizeof(wchar_t) + 1, 0);
+	if (TdhGetProperty(pEvent, 0, NULL, 1, &descriptor, size, reinterpret_cast<PBYTE>(&buf[0])) != ERROR_SUCCESS)
+	{
+		return false;
+	}
+	value = &buf[0];
+	return true;
+}
+}
+
+ProcessMonitor::ProcessMonitor() : isRunning_(false), hSession_(0), hTrace_(INVALID_PROCESSTRACE_HANDLE), hThread_(NULL)
+{
+}
+
+ProcessMonitor::~ProcessMonitor()
+{
+	stop();
+}
+
+void ProcessMonitor::start()
+{
+	if (isRunning_)
+	{
+		return;
+	}
+	// the events go to the index from the start, the snapshot fills the processes started before
+	if (!startTrace())
+	{
+		Logger::instance().out(L"ProcessMonitor::start(), ETW session isn't started, the process paths will be queried on demand");
+		return;
+	}
+	takeSnapshot();
+	isRunning_ = true;
+}
+
+void ProcessMonitor::stop()
+{
+	if (!isRunning_)
+	{
+		return;
+	}
+	stopTrace();
+	isRunning_ = false;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	processes_.clear();
+}
+
+std::wstring ProcessMonitor::getProcessPath(DWORD pid)
+{
+	if (isRunning_)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = processes_.find(pid);
+		if (it != processes_.end())
+		{
+			return it->second;
+		}
+	}
+	// not monitored or the start event is late
+	return normalizePath(queryProcessPath(pid));
+}
+
+std::set<DWORD> ProcessMonitor::getPidsOfApps(const std::vector<std::wstring> &normalizedApps, const std::set<DWORD> &pids)
+{
+	std::set<DWORD> appsPids;
+	if (normalizedApps.empty())
+	{
+		return appsPids;
+	}
+
+	auto matches = [&normalizedApps](const std::wstring &path) {
+		for (const auto &app : normalizedApps)
+		{
+			if (path.find(app) != std::wstring::npos)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	std::vector<DWORD> missingPids;
+	if (isRunning_)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (DWORD pid : pids)
+		{
+			auto it = processes_.find(pid);
+			if (it == processes_.end())
+			{
+				missingPids.push_back(pid);
+			}
+			else if (matches(it->second))
+			{
+				appsPids.insert(pid);
+			}
+		}
+	}
+	else
+	{
+		missingPids.assign(pids.begin(), pids.end());
+	}
+
+	// not monitored or the start event is late, queried from the process as getProcessPath() does
+	for (DWORD pid : missingPids)
+	{
+		const std::wstring path = normalizePath(queryProcessPath(pid));
+		if (!path.empty() && matches(path))
+		{
+			appsPids.insert(pid);
+		}
+	}
+	return appsPids;
+}
+
+std::wstring ProcessMonitor::normalizePath(const std::wstring &path)
+{
+	std::wstring str = path;
+	std::transform(str.begin(), str.end(), str.begin(),
+		[](wchar_t c) {return static_cast<wchar_t>(std::towlower(c)); });
+	std::replace(str.begin(), str.end(), L'/', L'\\');
+	return str;
+}
+
+bool ProcessMonitor::startTrace()
+{
+	const size_t nameSize = (wcslen(SESSION_NAME) + 1) * sizeof(wchar_t);
+	sessionProperties_.assign(sizeof(EVENT_TRACE_PROPERTIES) + nameSize, 0);
+	EVENT_TRACE_PROPERTIES *props = reinterpret_cast<EVENT_TRACE_PROPERTIES *>(&sessionProperties_[0]);
+	props->Wnode.BufferSize = static_cast<ULONG>(sessionProperties_.size());
+	props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+	props->Wnode.ClientContext = 1;		// QueryPerformanceCounter timestamps
+	props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+	props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+	// a session left from the previous run of the service (crash) is stopped
+	ControlTrace(0, SESSION_NAME, props, EVENT_TRACE_CONTROL_STOP);
+	props->Wnode.BufferSize = static_cast<ULONG>(sessionProperties_.size());
+	props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+	ULONG status = StartTrace(&hSession_, SESSION_NAME, props);
+	if (status != ERROR_SUCCESS)
+	{
+		Logger::instance().out(L"ProcessMonitor::startTrace(), StartTrace failed: %lu", status);
+		hSession_ = 0;
+		return false;
+	}
+
+	status = EnableTraceEx2(hSession_, &KERNEL_PROCESS_PROVIDER, EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+		TRACE_LEVEL_INFORMATION, WINEVENT_KEYWORD_PROCESS, 0, 0, NULL);
+	if (status != ERROR_SUCCESS)
+	{
+		Logger::instance().out(L"ProcessMonitor::startTrace(), EnableTraceEx2 failed: %lu", status);
+		stopTrace();
+		return false;
+	}
+
+	EVENT_TRACE_LOGFILE logFile;
+	memset(&logFile, 0, sizeof(logFile));
+	logFile.LoggerName = const_cast<wchar_t *>(SESSION_NAME);
+	logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+	logFile.EventRecordCallback = eventRecordCallback;
+	logFile.Context = this;
+	hTrace_ = OpenTrace(&logFile);
+	if (hTrace_ == INVALID_PROCESSTRACE_HANDLE)
+	{
+		Logger::instance().out(L"ProcessMonitor::startTrace(), OpenTrace failed: %lu", GetLastError());
+		stopTrace();
+		return false;
+	}
+
+	hThread_ = CreateThread(NULL, 0, traceThread, this, 0, NULL);
+	if (hThread_ == NULL)
+	{
+		stopTrace();
+		return false;
+	}
+	return true;
+}
+
+void ProcessMonitor::stopTrace()
+{
+	if (hSession_ != 0)
+	{
+		EVENT_TRACE_PROPERTIES *props = reinterpret_cast<EVENT_TRACE_PROPERTIES *>(&sessionProperties_[0]);
+		ControlTrace(hSession_, NULL, props, EVENT_TRACE_CONTROL_STOP);
+		hSession_ = 0;
+	}
+	if (hTrace_ != INVALID_PROCESSTRACE_HANDLE)
+	{
+		// ProcessTrace() returns after the trace is closed
+		CloseTrace(hTrace_);
+		hTrace_ = INVALID_PROCESSTRACE_HANDLE;
+	}
+	if (hThread_ != NULL)
+	{
+		WaitForSingleObject(hThread_, INFINITE);
+		CloseHandle(hThread_);
+		hThread_ = NULL;
+	}
+}
+
+void ProcessMonitor::takeSnapshot()
+{
+	HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+	if (hSnapshot == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	PROCESSENTRY32 pe;
+	pe.dwSize = sizeof(pe);
+	if (Process32First(hSnapshot, &pe))
+	{
+		do
+		{
+			const std::wstring path = normalizePath(queryProcessPath(pe.th32ProcessID));
+			if (!path.empty())
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				// the start event may already have come
+				processes_.insert(std::make_pair(pe.th32ProcessID, path));
+			}
+		} while (Process32Next(hSnapshot, &pe));
+	}
+	CloseHandle(hSnapshot);
+}
+
+std::wstring ProcessMonitor::queryProcessPath(DWORD pid)
+{
+	std::wstring path;
+	HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+	if (hProcess != NULL)
+	{
+		wchar_t filename[MAX_PATH];
+		DWORD size = MAX_PATH;
+		if (QueryFullProcessImageName(hProcess, 0, filename, &size))
+		{
+			path.assign(filename, size);
+		}
+		CloseHandle(hProcess);
+	}
+	return path;
+}
+
+DWORD WINAPI ProcessMonitor::traceThread(LPVOID lpParam)
+{
+	BIND_CRASH_HANDLER_FOR_THREAD();
+	ProcessMonitor *this_ = static_cast<ProcessMonitor *>(lpParam);
+	ULONG status = ProcessTrace(&this_->hTrace_, 1, NULL, NULL);
+	if (status != ERROR_SUCCESS && status != ERROR_CANCELLED)
+	{
+		Logger::instance().out(L"ProcessMonitor::traceThread(), ProcessTrace failed: %lu", status);
+	}
+	return 0;
+}
+
+VOID WINAPI ProcessMonitor::eventRecordCallback(PEVENT_RECORD pEvent)
+{
+	static_cast<ProcessMonitor *>(pEvent->UserContext)->onEvent(pEvent);
+}
+
+void ProcessMonitor::onEvent(PEVENT_RECORD pEvent)
+{
+	if (!IsEqualGUID(pEvent->EventHeader.ProviderId, KERNEL_PROCESS_PROVIDER))
+	{
+		return;
+	}
+
+	const USHORT id = pEvent->EventHeader.EventDescriptor.Id;
+	if (id == EVENT_ID_PROCESS_START)
+	{
+		ULONG pid;
+		std::wstring imageName;
+		if (getUInt32Property(pEvent, L"ProcessID", pid) && getStringProperty(pEvent, L"ImageName", imageName))
+		{
+			// the image name is a device path (\Device\HarddiskVolume3\...), the split tunneling apps
+			// are matched by the part of the path after the drive, so the DOS path is taken from the process if possible
+			std::wstring path = queryProcessPath(pid);
+			if (path.empty())
+			{
+				path = imageName;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			processes_[pid] = normalizePath(path);
+		}
+	}
+	else if (id == EVENT_ID_PROCESS_STOP)
+	{
+		ULONG pid;
+		if (getUInt32Property(pEvent, L"ProcessID", pid))
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			processes_.erase(pid);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <evntrace.h>
+#include <evntcons.h>
+#include <atomic>
+
+// Live index pid -> executable path, updated from the process start/stop events
+// (the ETW Microsoft-Windows-Kernel-Process provider) after an initial snapshot.
+// If the ETW session can't be started, the paths are queried from the processes each time.
+class ProcessMonitor
+{
+public:
+	static ProcessMonitor &instance()
+	{
+		static ProcessMonitor i;
+		return i;
+	}
+
+	void start();
+	void stop();
+
+	// lowercase path with the backslashes, empty if unknown
+	std::wstring getProcessPath(DWORD pid);
+	// the pids of the apps among the pids, from the index (the ones not in it are queried);
+	// an app is a part of the path (normalized) as in the split tunneling apps list
+	std::set<DWORD> getPidsOfApps(const std::vector<std::wstring> &normalizedApps, const std::set<DWORD> &pids);
+
+	static std::wstring normalizePath(const std::wstring &path);
+
+private:
+	ProcessMonitor();
+	~ProcessMonitor();
+	ProcessMonitor(const ProcessMonitor &) = delete;
+	ProcessMonitor &operator=(const ProcessMonitor &) = delete;
+
+	std::mutex mutex_;
+	std::map<DWORD, std::wstring> processes_;
+	std::atomic<bool> isRunning_;
+
+	TRACEHANDLE hSession_;
+	TRACEHANDLE hTrace_;
+	HANDLE hThread_;
+	std::vector<BYTE> sessionProperties_;
+
+	bool startTrace();
+	void stopTrace();
+	void takeSnapshot();
+	static std::wstring queryProcessPath(DWORD pid);
+
+	static DWORD WINAPI traceThread(LPVOID lpParam);
+	static VOID WINAPI eventRecordCallback(PEVENT_RECORD pEvent);
+	void onEvent(PEVENT_RECORD pEvent);
+};
@@ -2,6 +2,7 @@
 #include "callout_filter.h"
 #include "../logger.h"
 #include "../utils.h"
+#include <winioctl.h>
 
 
 DEFINE_GUID(
@@ -29,16 +30,60 @@ DEFINE_GUID(
 );
 
 
+// the same definitions are in WindscribeSplitTunnel/WindscribeCallout.h
+#define WINDSCRIBE_CALLOUT_FLAG_APP_TABLE	0x1
+
 typedef struct WINDSCRIBE_CALLOUT_DATA_
 {
 	UINT32 localIp;
+	UINT32 flags;
 } WINDSCRIBE_CALLOUT_DATA;
 
+#define WINDSCRIBE_SPLIT_TUNNEL_DEVICE_PATH	L"\\\\.\\WindscribeSplitTunnel"
+#define IOCTL_WINDSCRIBE_SET_APPS	CTL_CODE(FILE_DEVICE_NETWORK, 0x800, METHOD_BUFFERED, FILE_WRITE_ACCESS)
+#define IOCTL_WINDSCRIBE_GET_EVENTS	CTL_CODE(FILE_DEVICE_NETWORK, 0x801, METHOD_BUFFERED, FILE_READ_ACCESS)
+
+typedef struct WINDSCRIBE_APPS_HEADER_
+{
+	UINT32 version;
+	UINT32 count;
+} WINDSCRIBE_APPS_HEADER;
+
+typedef struct WINDSCRIBE_FLOW_EVENT_
+{
+	UINT64 time;
+	UINT64 processId;
+	UINT32 version;
+	UINT32 appIndex;
+	UINT32 originalIp;
+	UINT32 redirectedIp;
+	INT32 status;
+	UINT32 reserved;
+} WINDSCRIBE_FLOW_EVENT;
+
+typedef struct WINDSCRIBE_EVENTS_HEADER_
+{
+	UINT32 count;
+	UINT32 dropped;
+} WINDSCRIBE_EVENTS_HEADER;
+
+// the size of the ring in the driver
+#define WINDSCRIBE_FLOW_EVENTS_COUNT	1024
 
-CalloutFilter::CalloutFilter(FwpmWrapper &fwmpWrapper): fwmpWrapper_(fwmpWrapper), isEnabled_(false), prevIp_(0)
+
+CalloutFilter::CalloutFilter(FwpmWrapper &fwmpWrapper): fwmpWrapper_(fwmpWrapper), isEnabled_(false), prevIp_(0),
+	hDriver_(INVALID_HANDLE_VALUE), isAppTableMode_(false), appTableVersion_(0)
 {
 }
 
+CalloutFilter::~CalloutFilter()
+{
+	if (hDriver_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hDriver_);
+	}
+}
+
 void CalloutFilter::enable(UINT32 ip, const AppsIds &appsIds)
 {
 	std::lock_guard<std::recursive_mutex> guard(mutex_);
@@ -51,6 +96,25 @@ void CalloutFilter::enable(UINT32 ip, const AppsIds &appsIds)
 		return;
 	}
 
+	// the same provider context, only the apps filters (or the apps table of the driver) change
+	if (isEnabled_ && ip == prevIp_)
+	{
+		if (isAppTableMode_)
+		{
+			logDriverFlowEvents();
+			AppsIds newAppsIds = appsIds;
+			if (setDriverApps(newAppsIds))
+			{
+				appsIds_ = newAppsIds;
+			}
+		}
+		else
+		{
+			updateFilters(appsIds);
+		}
+		return;
+	}
+
 	if (isEnabled_)
 	{
 		Logger::instance().out(L"CalloutFilter: disable before enable");
@@ -60,10 +124,14 @@ void CalloutFilter::enable(UINT32 ip, const AppsIds &appsIds)
 	appsIds_ = appsIds;
 	prevIp_ = ip;
 
+	// the table is in the driver before the filter which uses it
+	isAppTableMode_ = openDriver() && setDriverApps(appsIds_);
+	Logger::instance().out(L"CalloutFilter::enable(), apps table of the driver: %d", isAppTableMode_);
+
 	HANDLE hEngine = fwmpWrapper_.getHandleAndLock();
 	fwmpWrapper_.beginTransaction();
 
-	if (!addProviderContext(hEngine, CALLOUT_PROVIDER_CONTEXT_IP_GUID, ip))
+	if (!addProviderContext(hEngine, CALLOUT_PROVIDER_CONTEXT_IP_GUID, ip, isAppTableMode_ ? WINDSCRIBE_CALLOUT_FLAG_APP_TABLE : 0))
 	{
 		Logger::instance().out(L"CalloutFilter::enable(), addProviderContext failed");
 	}
@@ -86,9 +154,36 @@ void CalloutFilter::enable(UINT32 ip, const AppsIds &appsIds)
 		Logger::instance().out(L"CalloutFilter::enable(), addSubLayer failed");
 	}
 
-	if (!addFilter(hEngine))
+	if (isAppTableMode_)
+	{
+		UINT64 filterId;
+		if (addFilter(hEngine, NULL, filterId))
+		{
+			filterIds_[std::vector<UINT8>()] = filterId;
+		}
+		else
+		{
+			Logger::instance().out(L"CalloutFilter::enable(), addFilter failed");
+		}
+	}
+
+	for (size_t i = 0; i < appsIds_.count() && !isAppTableMode_; ++i)
 	{
-		Logger::instance().out(L"CalloutFilter::enable(), addFilter failed");
+		FWP_BYTE_BLOB *appId = appsIds_.getAppId(i);
+		std::vector<UINT8> key(appId->data, appId->data + appId->size);
+		UINT64 filterId;
+		if (filterIds_.find(key) != filterIds_.end())
+		{
+			continue;
+		}
+		if (addFilter(hEngine, appId, filterId))
+		{
+			filterIds_[key] = filterId;
+		}
+		else
+		{
+			Logger::instance().out(L"CalloutFilter::enable(), addFilter failed");
+		}
 	}
 
 	fwmpWrapper_.endTransaction();
@@ -103,19 +198,82 @@ void CalloutFilter::disable()
 
 	if (!isEnabled_)
 	{
+		closeDriver();
 		return;
 	}
 	Logger::instance().out(L"CalloutFilter::disable()");
 	removeAllFilters(fwmpWrapper_);
+	filterIds_.clear();
+	if (isAppTableMode_)
+	{
+		logDriverFlowEvents();
+		AppsIds empty;
+		setDriverApps(empty);
+		isAppTableMode_ = false;
+	}
+	closeDriver();
 	isEnabled_ = false;
 }
 
-bool CalloutFilter::addProviderContext(HANDLE engineHandle, const GUID &guid, UINT32 ip)
+void CalloutFilter::updateFilters(const AppsIds &appsIds)
+{
+	std::map<std::vector<UINT8>, FWP_BYTE_BLOB *> newIds;
+	AppsIds newAppsIds = appsIds;
+	for (size_t i = 0; i < newAppsIds.count(); ++i)
+	{
+		FWP_BYTE_BLOB *appId = newAppsIds.getAppId(i);
+		newIds[std::vector<UINT8>(appId->data, appId->data + appId->size)] = appId;
+	}
+
+	HANDLE hEngine = fwmpWrapper_.getHandleAndLock();
+	fwmpWrapper_.beginTransaction();
+
+	size_t removedCount = 0, addedCount = 0;
+	for (auto it = filterIds_.begin(); it != filterIds_.end(); )
+	{
+		if (newIds.find(it->first) == newIds.end())
+		{
+			FwpmFilterDeleteById0(hEngine, it->second);
+			it = filterIds_.erase(it);
+			removedCount++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+	for (const auto &it : newIds)
+	{
+		if (filterIds_.find(it.first) != filterIds_.end())
+		{
+			continue;
+		}
+		UINT64 filterId;
+		if (addFilter(hEngine, it.second, filterId))
+		{
+			filterIds_[it.first] = filterId;
+			addedCount++;
+		}
+		else
+		{
+			Logger::instance().out(L"CalloutFilter::updateFilters(), addFilter failed");
+		}
+	}
+
+	fwmpWrapper_.endTransaction();
+	fwmpWrapper_.unlock();
+
+	appsIds_ = newAppsIds;
+	Logger::instance().out(L"CalloutFilter::updateFilters(), removed %zu, added %zu", removedCount, addedCount);
+}
+
+bool CalloutFilter::addProviderContext(HANDLE engineHandle, const GUID &guid, UINT32 ip, UINT32 flags)
 {
 	bool bRet = true;
 	WINDSCRIBE_CALLOUT_DATA proxyData;
 	FWP_BYTE_BLOB         byteBlob = { 0 };
 	proxyData.localIp = ip;
+	proxyData.flags = flags;
 
 	FWPM_PROVIDER_CONTEXT1 providerContext = { 0 };
 	UINT64 providerContextId;
@@ -153,47 +311,138 @@ bool CalloutFilter::addSubLayer(HANDLE engineHandle)
 	return true;
 }
 
-bool CalloutFilter::addFilter(HANDLE engineHandle)
+bool CalloutFilter::addFilter(HANDLE engineHandle, FWP_BYTE_BLOB *appId, UINT64 &filterId)
+{
+	FWPM_FILTER_CONDITION condition = { 0 };
+	condition.fieldKey = FWPM_CONDITION_ALE_APP_ID;
+	condition.matchType = FWP_MATCH_EQUAL;
+	condition.conditionValue.type = FWP_BYTE_BLOB_TYPE;
+	condition.conditionValue.byteBlob = appId;
+
+	FWPM_FILTER filter = { 0 };
+	filter.subLayerKey = SUBLAYER_CALLOUT_GUID;
+	filter.layerKey = FWPM_LAYER_ALE_BIND_REDIRECT_V4;
+	filter.displayData.name = (wchar_t *)L"Windscribe filter for callout driver";
+	filter.weight.type = FWP_UINT8;
+	filter.weight.uint8 = 0x00;
+	filter.providerContextKey = CALLOUT_PROVIDER_CONTEXT_IP_GUID;
+	filter.flags |= FWPM_FILTER_FLAG_HAS_PROVIDER_CONTEXT;
+	filter.numFilterConditions = appId ? 1 : 0;
+	filter.filterCondition = appId ? &condition : NULL;
+	filter.action.type = FWP_ACTION_CALLOUT_UNKNOWN;
+	filter.action.calloutKey = WINDSCRIBE_CALLOUT_GUID;
+
+	DWORD ret = FwpmFilterAdd(engineHandle, &filter, NULL, &filterId);
+	return ret == ERROR_SUCCESS;
+}
+
+bool CalloutFilter::openDriver()
+{
+	if (hDriver_ == INVALID_HANDLE_VALUE)
+	{
+		hDriver_ = CreateFileW(WINDSCRIBE_SPLIT_TUNNEL_DEVICE_PATH, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+		if (hDriver_ == INVALID_HANDLE_VALUE)
+		{
+			// the older driver has no control device
+			Logger::instance().out(L"CalloutFilter::openDriver(), CreateFile failed: %u", GetLastError());
+			return false;
+		}
+	}
+	return true;
+}
+
+void CalloutFilter::closeDriver()
+{
+	// the driver service is stopped after the disable, an open handle keeps the driver from unloading
+	// and would be stale for the next enable()
+	if (hDriver_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hDriver_);
+		hDriver_ = INVALID_HANDLE_VALUE;
+	}
+}
+
+bool CalloutFilter::setDriverApps(AppsIds &appsIds)
+{
+	if (hDriver_ == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	WINDSCRIBE_APPS_HEADER header;
+	header.version = ++appTableVersion_;
+	header.count = static_cast<UINT32>(appsIds.count());
+
+	std::vector<UINT8> buf(reinterpret_cast<const UINT8 *>(&header), reinterpret_cast<const UINT8 *>(&header) + sizeof(header));
+	for (size_t i = 0; i < appsIds.count(); ++i)
+	{
+		const FWP_BYTE_BLOB *appId = appsIds.getAppId(i);
+		const UINT32 size = appId->size;
+		buf.insert(buf.end(), reinterpret_cast<const UINT8 *>(&size), reinterpret_cast<const UINT8 *>(&size) + sizeof(size));
+		buf.insert(buf.end(), appId->data, appId->data + appId->size);
+		buf.resize((buf.size() + 3) & ~static_cast<size_t>(3));
+	}
+
+	DWORD bytesReturned = 0;
+	if (!DeviceIoControl(hDriver_, IOCTL_WINDSCRIBE_SET_APPS, buf.data(), static_cast<DWORD>(buf.size()), NULL, 0, &bytesReturned, NULL))
+	{
+		Logger::instance().out(L"CalloutFilter::setDriverApps(), DeviceIoControl failed: %u", GetLastError());
+		return false;
+	}
+	Logger::instance().out(L"CalloutFilter::setDriverApps(), version %u, %u apps", header.version, header.count);
+	return true;
+}
+
+void CalloutFilter::logDriverFlowEvents()
 {
-	bool retValue = true;
+	if (hDriver_ == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
 
-	if (appsIds_.count() == 0)
+	std::vector<UINT8> buf(sizeof(WINDSCRIBE_EVENTS_HEADER) + WINDSCRIBE_FLOW_EVENTS_COUNT * sizeof(WINDSCRIBE_FLOW_EVENT));
+	DWORD bytesReturned = 0;
+	if (!DeviceIoControl(hDriver_, IOCTL_WINDSCRIBE_GET_EVENTS, NULL, 0, buf.data(), static_cast<DWORD>(buf.size()), &bytesReturned, NULL) ||
+		bytesReturned < sizeof(WINDSCRIBE_EVENTS_HEADER))
 	{
-		return true;
+		Logger::instance().out(L"CalloutFilter::logDriverFlowEvents(), DeviceIoControl failed: %u", GetLastError());
+		return;
 	}
 
+	const WINDSCRIBE_EVENTS_HEADER *header = reinterpret_cast<const WINDSCRIBE_EVENTS_HEADER *>(buf.data());
+	const WINDSCRIBE_FLOW_EVENT *events = reinterpret_cast<const WINDSCRIBE_FLOW_EVENT *>(header + 1);
+
+	// the flows of the current table by app, the events of the older tables are counted only
+	std::map<UINT32, UINT32> countByApp;
+	UINT32 failedCount = 0, olderCount = 0;
+	for (UINT32 i = 0; i < header->count; ++i)
 	{
-		std::vector<FWPM_FILTER_CONDITION> conditions(appsIds_.count());
-		for (size_t i = 0; i < appsIds_.count(); ++i)
+		if (events[i].status != 0)
 		{
-			conditions[i].fieldKey = FWPM_CONDITION_ALE_APP_ID;
-			conditions[i].matchType = FWP_MATCH_EQUAL;
-			conditions[i].conditionValue.type = FWP_BYTE_BLOB_TYPE;
-			conditions[i].conditionValue.byteBlob = appsIds_.getAppId(i);
+			failedCount++;
 		}
-
-		FWPM_FILTER filter = { 0 };
-		filter.subLayerKey = SUBLAYER_CALLOUT_GUID;
-		filter.layerKey = FWPM_LAYER_ALE_BIND_REDIRECT_V4;
-		filter.displayData.name = (wchar_t *)L"Windscribe filter for callout driver";
-		filter.weight.type = FWP_UINT8;
-		filter.weight.uint8 = 0x00;
-		filter.providerContextKey = CALLOUT_PROVIDER_CONTEXT_IP_GUID;
-		filter.flags |= FWPM_FILTER_FLAG_HAS_PROVIDER_CONTEXT;
-		filter.numFilterConditions = static_cast<UINT32>(conditions.size());
-		if (conditions.size() > 0)
+		if (events[i].version == appTableVersion_)
 		{
-			filter.filterCondition = &conditions[0];
+			countByApp[events[i].appIndex]++;
+		}
+		else
+		{
+			olderCount++;
 		}
-		filter.action.type = FWP_ACTION_CALLOUT_UNKNOWN;
-		filter.action.calloutKey = WINDSCRIBE_CALLOUT_GUID;
-
-		UINT64 filterId;
-		DWORD ret = FwpmFilterAdd(engineHandle, &filter, NULL, &filterId);
-		retValue = (ret == ERROR_SUCCESS);
 	}
 
-	return retValue;
+	Logger::instance().out(L"CalloutFilter: %u redirected flows (%u failed, %u dropped, %u for the previous apps)",
+		header->count, failedCount, header->dropped, olderCount);
+	for (const auto &it : countByApp)
+	{
+		const FWP_BYTE_BLOB *appId = appsIds_.getAppId(it.first);
+		if (appId)
+		{
+			// the app id is the NT path of the executable
+			std::wstring path(reinterpret_cast<const wchar_t *>(appId->data), appId->size / sizeof(wchar_t));
+			Logger::instance().out(L"CalloutFilter:    %s: %u", path.c_str(), it.second);
+		}
+	}
 }
 
 bool CalloutFilter::deleteSublayer(HANDLE engineHandle)
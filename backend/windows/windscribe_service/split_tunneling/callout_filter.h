@@ -7,6 +7,7 @@ class CalloutFilter
 {
 public:
 	explicit CalloutFilter(FwpmWrapper &fwmpWrapper);
+	~CalloutFilter();
 
 	void enable(UINT32 ip, const AppsIds &appsIds);
 	void disable();
@@ -14,9 +15,20 @@ public:
 	static bool removeAllFilters(FwpmWrapper &fwmpWrapper);
 
 private:
-	bool addProviderContext(HANDLE engineHandle, const GUID &guid, UINT32 ip);
+	bool addProviderContext(HANDLE engineHandle, const GUID &guid, UINT32 ip, UINT32 flags);
 	bool addSubLayer(HANDLE engineHandle);
-	bool addFilter(HANDLE engineHandle);
+	// one filter per app, so the apps can be added/removed without rebuilding the others;
+	// a filter without the app matches all the apps (the apps table of the driver)
+	bool addFilter(HANDLE engineHandle, FWP_BYTE_BLOB *appId, UINT64 &filterId);
+	void updateFilters(const AppsIds &appsIds);
+
+	// the driver with the control device gets the apps as one hashed table and a single filter, the older
+	// driver gets one filter per app
+	bool openDriver();
+	void closeDriver();
+	bool setDriverApps(AppsIds &appsIds);
+	// the redirected flows per app since the last call, to the log
+	void logDriverFlowEvents();
 
 	static bool deleteSublayer(HANDLE engineHandle);
 
@@ -27,5 +39,10 @@ private:
 
 	AppsIds appsIds_;
 	DWORD prevIp_;
+	std::map<std::vector<UINT8>, UINT64> filterIds_;	// by app id
+
+	HANDLE hDriver_;
+	bool isAppTableMode_;
+	UINT32 appTableVersion_;
 };
 
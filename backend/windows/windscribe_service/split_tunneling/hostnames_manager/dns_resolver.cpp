@@ -7,6 +7,12 @@
 
 DnsResolver *DnsResolver::this_ = NULL;
 
+namespace {
+const int DNS_CLASS_IN = 1;
+const int DNS_TYPE_A = 1;
+const int MAX_ADDRESSES_PER_HOST = 32;
+}
+
 DnsResolver::DnsResolver()
 	: bStopCalled_(false)
 	, bNeedFinish_(false)
@@ -50,50 +56,43 @@ void DnsResolver::stop()
 	bStopCalled_ = true;
 }
 
-void DnsResolver::resolveDomains(const std::vector<std::string> &hostnames)
+bool DnsResolver::resolveDomains(const std::vector<std::string> &hostnames)
 {
     std::lock_guard<std::mutex> lock(mutex_);
 	{
-		// cancel any lookups currently in channel
-		if (!hostnamesInProgress_.empty())
-		{
-			ares_cancel(channel_);
-			ares_destroy(channel_);
-			this_->channel_ = NULL;
-		}
-		else
-		{
-			assert(channel_ == NULL);
-		}
-        hostnamesInProgress_.clear();
-        hostinfoResults_.clear();
-
-		struct ares_options options;
-		int optmask = 0;
-		memset(&options, 0, sizeof(options));
-		optmask |= ARES_OPT_TRIES;
-		options.tries = 1;
-
-		int status = ares_init_options(&channel_, &options, optmask);
-		if (status != ARES_SUCCESS)
+		if (channel_ == NULL)
 		{
-			Logger::instance().out("ares_init_options failed: %s", ares_strerror(status));
-			return;
+			struct ares_options options;
+			int optmask = 0;
+			memset(&options, 0, sizeof(options));
+			optmask |= ARES_OPT_TRIES;
+			options.tries = 1;
+
+			int status = ares_init_options(&channel_, &options, optmask);
+			if (status != ARES_SUCCESS)
+			{
+				Logger::instance().out("ares_init_options failed: %s", ares_strerror(status));
+				channel_ = NULL;
+				return false;
+			}
 		}
 
-
 		// filter for unique hostnames and execute request
 		for (auto &hostname : hostnames)
 		{
-			USER_ARG *userArg = new USER_ARG();
-			userArg->hostname = hostname;
-			ares_gethostbyname(channel_, hostname.c_str(), AF_INET, aresLookupFinishedCallback, userArg);
-			hostnamesInProgress_.insert(hostname);
+			if (hostnamesInProgress_.insert(hostname).second)
+			{
+				USER_ARG *userArg = new USER_ARG();
+				userArg->hostname = hostname;
+				// a query instead of ares_gethostbyname() to get the TTLs of the records
+				ares_search(channel_, hostname.c_str(), DNS_CLASS_IN, DNS_TYPE_A, aresLookupFinishedCallback, userArg);
+			}
 		}
 	}
 
 	// kick thread
 	waitCondition_.notify_all();
+	return true;
 }
 
 void DnsResolver::cancelAll()
@@ -106,34 +105,40 @@ void DnsResolver::cancelAll()
 		ares_destroy(channel_);
 	}
 	channel_ = NULL;
+	hostinfoResults_.clear();
 }
 
 
-void DnsResolver::aresLookupFinishedCallback(void * arg, int status, int /*timeouts*/, struct hostent * host)
+void DnsResolver::aresLookupFinishedCallback(void * arg, int status, int /*timeouts*/, unsigned char *abuf, int alen)
 {
 	USER_ARG *userArg = static_cast<USER_ARG *>(arg);
 
 	// cancel and fail cases
-	if (status == ARES_ECANCELLED)
+	if (status == ARES_ECANCELLED || status == ARES_EDESTRUCTION)
 	{
+		delete userArg;
 		return;
 	}
 
 	HostInfo hostInfo;
 	hostInfo.hostname = userArg->hostname;
 
-	if (status != ARES_SUCCESS)
+	struct ares_addrttl addrttls[MAX_ADDRESSES_PER_HOST];
+	int naddrttls = MAX_ADDRESSES_PER_HOST;
+	if (status != ARES_SUCCESS || ares_parse_a_reply(abuf, alen, NULL, addrttls, &naddrttls) != ARES_SUCCESS)
 	{
 		hostInfo.error = true;
 	}
 	else
 	{
 		// add ips
-		for (char **p = host->h_addr_list; *p; p++)
+		for (int i = 0; i < naddrttls; ++i)
 		{
 			char addr_buf[46] = "??";
-			ares_inet_ntop(host->h_addrtype, *p, addr_buf, sizeof(addr_buf));
+			ares_inet_ntop(AF_INET, &addrttls[i].ipaddr, addr_buf, sizeof(addr_buf));
 			hostInfo.addresses.push_back(std::string(addr_buf));
+			const unsigned int ttl = addrttls[i].ttl > 0 ? addrttls[i].ttl : 0;
+			hostInfo.ttl = (i == 0) ? ttl : (std::min)(hostInfo.ttl, ttl);
 		}
 	}
 
@@ -142,7 +147,9 @@ void DnsResolver::aresLookupFinishedCallback(void * arg, int status, int /*timeo
 	
 	if (this_->hostnamesInProgress_.empty())
 	{
-		this_->resolveDomainsCallback_(this_->hostinfoResults_);
+		std::map<std::string, HostInfo> results;
+		results.swap(this_->hostinfoResults_);
+		this_->resolveDomainsCallback_(results);
 	}
 
 	delete userArg;
@@ -12,9 +12,10 @@ public:
 	{
         std::string hostname;
 		std::vector<std::string> addresses;
+		unsigned int ttl;		// seconds, the minimum of the A records
 		bool error;
 
-        HostInfo() : error(false) {}
+        HostInfo() : ttl(0), error(false) {}
 	};
 
 	explicit DnsResolver();
@@ -24,7 +25,10 @@ public:
 
 	void stop();
 
-	void resolveDomains(const std::vector<std::string> &hostnames);
+	// all the lookups run in parallel in one channel; the hostnames already in progress aren't queried again,
+	// the callback is called with the results when no lookups are left in progress;
+	// returns false if the channel can't be created, the callback isn't called then
+	bool resolveDomains(const std::vector<std::string> &hostnames);
 	void cancelAll();
 	void setResolveDomainsCallbackHandler(std::function<void(std::map<std::string, HostInfo>)> resolveDomainsCallback);
 
@@ -53,7 +57,7 @@ private:
 	// thread specific
 	HANDLE hThread_;
 	static DWORD WINAPI threadFunc(LPVOID n);
-	static void aresLookupFinishedCallback(void *arg, int status, int timeouts, struct hostent *host);
+	static void aresLookupFinishedCallback(void *arg, int status, int timeouts, unsigned char *abuf, int alen);
 
 	bool processChannel(ares_channel channel);
 };
@@ -1,14 +1,34 @@
 #include "../../all_headers.h"
 #include "hostnames_manager.h"
 #include "../../logger.h"
+#include "../../../../../common/utils/crashhandler.h"
 
-HostnamesManager::HostnamesManager(FirewallFilter &firewallFilter): firewallFilter_(firewallFilter), isEnabled_(false), isExcludeMode_(true)
+namespace {
+// the TTL is clamped to this range, a failed lookup is retried after RETRY_AFTER_ERROR_MS with the previous ips kept
+const ULONGLONG MIN_TTL_MS = 60 * 1000;
+const ULONGLONG MAX_TTL_MS = 60 * 60 * 1000;
+const ULONGLONG RETRY_AFTER_ERROR_MS = 30 * 1000;
+}
+
+HostnamesManager::HostnamesManager(FirewallFilter &firewallFilter): firewallFilter_(firewallFilter), isEnabled_(false), isExcludeMode_(true),
+	ifIndex_(0), bNeedFinish_(false)
 {
 	dnsResolver_.setResolveDomainsCallbackHandler(std::bind(&HostnamesManager::dnsResolverCallback, this, std::placeholders::_1));
+
+	DWORD threadId;
+	hRefreshThread_ = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)refreshThreadFunc, (LPVOID)this, 0, &threadId);
 }
 
 HostnamesManager::~HostnamesManager()
 {
+	{
+		std::lock_guard<std::recursive_mutex> guard(mutex_);
+		bNeedFinish_ = true;
+		refreshCondition_.notify_all();
+	}
+	WaitForSingleObject(hRefreshThread_, INFINITE);
+	CloseHandle(hRefreshThread_);
+
 	dnsResolver_.stop();
 }
 
@@ -18,64 +38,192 @@ void HostnamesManager::enable(const std::string &gatewayIp, unsigned long ifInde
 
 	gatewayIp_ = gatewayIp;
 	ifIndex_ = ifIndex;
-	ipRoutes_.clear();
-	ipRoutes_.setIps(gatewayIp_, ifIndex_, ipsLatest_);
-	firewallFilter_.setSplitTunnelingWhitelistIps(ipsLatest_);
-	dnsResolver_.cancelAll();
-	dnsResolver_.resolveDomains(hostsLatest_);
-
 	isEnabled_ = true;
+
+	// the cached ips are routed right away, the hosts are re-resolved since the DNS server may have changed
+	ipRoutes_.clear();
+	applyIps();
+	for (auto &it : hosts_)
+	{
+		it.second.expiryTime = 0;
+	}
+	refreshCondition_.notify_all();
 }
 
 void HostnamesManager::disable()
 {
-	std::lock_guard<std::recursive_mutex> guard(mutex_);
-
-	if (!isEnabled_)
 	{
-		return;
+		std::lock_guard<std::recursive_mutex> guard(mutex_);
+
+		if (!isEnabled_)
+		{
+			return;
+		}
+		ipRoutes_.clear();
+		isEnabled_ = false;
 	}
-	ipRoutes_.clear();
 
 	dnsResolver_.cancelAll();
-	isEnabled_ = false; 
+
+	std::lock_guard<std::recursive_mutex> guard(mutex_);
+	for (auto &it : hosts_)
+	{
+		it.second.isResolving = false;
+	}
 }
 
 void HostnamesManager::setSettings(bool isExclude, const std::vector<Ip4AddressAndMask> &ips, const std::vector<std::string> &hosts)
 {
 	std::lock_guard<std::recursive_mutex> guard(mutex_);
 	ipsLatest_ = ips;
-	hostsLatest_ = hosts;
 	isExcludeMode_ = isExclude;
+
+	// keep the cache for the hosts that are still in the list
+	std::map<std::string, HostEntry> newHosts;
+	for (const auto &hostname : hosts)
+	{
+		auto it = hosts_.find(hostname);
+		newHosts[hostname] = (it != hosts_.end()) ? it->second : HostEntry();
+	}
+	hosts_.swap(newHosts);
+
+	if (isEnabled_)
+	{
+		applyIps();
+	}
+	refreshCondition_.notify_all();
 }
 
 void HostnamesManager::dnsResolverCallback(std::map<std::string, DnsResolver::HostInfo> hostInfos)
 {
 	std::lock_guard<std::recursive_mutex> guard(mutex_);
 
-	std::vector<Ip4AddressAndMask> hostsIps;
+	const ULONGLONG curTime = GetTickCount64();
+	bool isChanged = false;
 	for (auto it = hostInfos.begin(); it != hostInfos.end(); ++it)
 	{
-		if (!it->second.error)
+		auto entry = hosts_.find(it->first);
+		if (entry == hosts_.end())
 		{
-			std::vector<std::string> addresses = it->second.addresses;
-			for (auto addr = addresses.begin(); addr != addresses.end(); ++addr)
-			{
-				hostsIps.push_back(Ip4AddressAndMask(addr->c_str()));
-				Logger::instance().out("RoutesManager::dnsResolverCallback(), Resolved : %s, IP: %s", it->first.c_str(), addr->c_str());
-			}
+			continue;	// removed from the settings meanwhile
+		}
+		entry->second.isResolving = false;
+
+		if (it->second.error)
+		{
+			entry->second.expiryTime = curTime + RETRY_AFTER_ERROR_MS;
+			Logger::instance().out("HostnamesManager::dnsResolverCallback(), Failed resolve : %s", it->first.c_str());
+			continue;
 		}
-		else
+
+		const ULONGLONG ttlMs = (std::max)(MIN_TTL_MS, (std::min)(MAX_TTL_MS, static_cast<ULONGLONG>(it->second.ttl) * 1000));
+		entry->second.expiryTime = curTime + ttlMs;
+
+		std::set<Ip4AddressAndMask> ips;
+		for (const auto &addr : it->second.addresses)
 		{
-			Logger::instance().out("RoutesManager::dnsResolverCallback(), Failed resolve : %s", it->first.c_str());
+			ips.insert(Ip4AddressAndMask(addr.c_str()));
+		}
+		if (ips != entry->second.ips)
+		{
+			entry->second.ips.swap(ips);
+			isChanged = true;
+			for (const auto &addr : it->second.addresses)
+			{
+				Logger::instance().outVerbose("HostnamesManager::dnsResolverCallback(), Resolved : %s, IP: %s", it->first.c_str(), addr.c_str());
+			}
 		}
 	}
 
-	hostsIps.insert(hostsIps.end(), ipsLatest_.begin(), ipsLatest_.end());
+	if (isEnabled_ && isChanged)
+	{
+		applyIps();
+	}
+	refreshCondition_.notify_all();
+}
 
-	if (isEnabled_)
+void HostnamesManager::applyIps()
+{
+	std::set<Ip4AddressAndMask> allIps(ipsLatest_.begin(), ipsLatest_.end());
+	for (const auto &it : hosts_)
 	{
-		ipRoutes_.setIps(gatewayIp_, ifIndex_, hostsIps);
-		firewallFilter_.setSplitTunnelingWhitelistIps(hostsIps);
+		allIps.insert(it.second.ips.begin(), it.second.ips.end());
 	}
-}
\ No newline at end of file
+
+	// sorted, so the firewall filter doesn't see a change when only the order differs
+	const std::vector<Ip4AddressAndMask> ips(allIps.begin(), allIps.end());
+	ipRoutes_.setIps(gatewayIp_, ifIndex_, ips);
+	firewallFilter_.setSplitTunnelingWhitelistIps(ips);
+}
+
+DWORD __stdcall HostnamesManager::refreshThreadFunc(LPVOID n)
+{
+	BIND_CRASH_HANDLER_FOR_THREAD();
+	HostnamesManager *manager = static_cast<HostnamesManager *>(n);
+
+	while (true)
+	{
+		std::vector<std::string> hostsToResolve;
+		{
+			std::unique_lock<std::recursive_mutex> lock(manager->mutex_);
+			if (manager->bNeedFinish_)
+			{
+				break;
+			}
+
+			const ULONGLONG curTime = GetTickCount64();
+			ULONGLONG nextExpiryTime = 0;
+			if (manager->isEnabled_)
+			{
+				for (auto &it : manager->hosts_)
+				{
+					if (it.second.isResolving)
+					{
+						continue;
+					}
+					if (it.second.expiryTime <= curTime)
+					{
+						it.second.isResolving = true;
+						hostsToResolve.push_back(it.first);
+					}
+					else if (nextExpiryTime == 0 || it.second.expiryTime < nextExpiryTime)
+					{
+						nextExpiryTime = it.second.expiryTime;
+					}
+				}
+			}
+
+			if (hostsToResolve.empty())
+			{
+				if (nextExpiryTime == 0)
+				{
+					manager->refreshCondition_.wait(lock);
+				}
+				else
+				{
+					manager->refreshCondition_.wait_for(lock, std::chrono::milliseconds(nextExpiryTime - curTime));
+				}
+				continue;
+			}
+		}
+
+		// all the lookups go in parallel, the results come in dnsResolverCallback
+		if (!manager->dnsResolver_.resolveDomains(hostsToResolve))
+		{
+			// no results will come, retry these hosts later
+			std::lock_guard<std::recursive_mutex> guard(manager->mutex_);
+			const ULONGLONG retryTime = GetTickCount64() + RETRY_AFTER_ERROR_MS;
+			for (const auto &hostname : hostsToResolve)
+			{
+				auto it = manager->hosts_.find(hostname);
+				if (it != manager->hosts_.end())
+				{
+					it->second.isResolving = false;
+					it->second.expiryTime = retryTime;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <condition_variable>
+
 #include "../../ip_address/ip4_address_and_mask.h"
 #include "../../firewallfilter.h"
 #include "dns_resolver.h"
 #include "ip_routes.h"
 
+// Keeps the routes and the firewall whitelist for the split tunneling ips and hostnames.
+// The resolved ips are cached per hostname and re-resolved in the background when the TTL expires,
+// only the changes are applied to the routes (IpRoutes diffs them).
 class HostnamesManager
 {
 public:
@@ -16,24 +21,38 @@ public:
 	void setSettings(bool isExclude, const std::vector<Ip4AddressAndMask> &ips, const std::vector<std::string> &hosts);
 
 private:
+	struct HostEntry
+	{
+		std::set<Ip4AddressAndMask> ips;
+		ULONGLONG expiryTime;		// GetTickCount64(), 0 if never resolved
+		bool isResolving;
+
+		HostEntry() : expiryTime(0), isResolving(false) {}
+	};
+
 	FirewallFilter &firewallFilter_;
 	DnsResolver dnsResolver_;
 	IpRoutes ipRoutes_;
 
 	bool isEnabled_;
+	// the lock order is mutex_ after the DnsResolver lock (its callback), so the resolver is called without mutex_
 	std::recursive_mutex mutex_;
 
 	bool isExcludeMode_;
 
 	// latest ips and hosts list
 	std::vector<Ip4AddressAndMask> ipsLatest_;
-	std::vector<std::string> hostsLatest_;
+	std::map<std::string, HostEntry> hosts_;
 
 	std::string gatewayIp_;
 	unsigned long ifIndex_;
 
+	// re-resolves the expired hosts
+	HANDLE hRefreshThread_;
+	std::condition_variable_any refreshCondition_;
+	bool bNeedFinish_;
 
+	static DWORD WINAPI refreshThreadFunc(LPVOID n);
 	void dnsResolverCallback(std::map<std::string, DnsResolver::HostInfo> hostInfos);
-
+	void applyIps();
 };
-
@@ -1,29 +1,18 @@
 #include "../all_headers.h"
 #include "ip_forward_table.h"
+#include "../network_snapshot.h"
 
 
 IpForwardTable::IpForwardTable(): maxMetric_(0)
 {
-	ULONG ulSize = sizeof(MIB_IPFORWARDROW) * 32;
-	ipForwardVector_.resize(ulSize);
-	
-	DWORD dwStatus = 0;
-	dwStatus = GetIpForwardTable((MIB_IPFORWARDTABLE *)&ipForwardVector_[0], &ulSize, FALSE);
-
-	if (dwStatus == ERROR_INSUFFICIENT_BUFFER)
-	{
-		ipForwardVector_.resize(ulSize);
-		dwStatus = GetIpForwardTable((MIB_IPFORWARDTABLE *)&ipForwardVector_[0], &ulSize, FALSE);
-	}
-
-	if (dwStatus != ERROR_SUCCESS)
+	ipForwardVector_ = NetworkSnapshot::instance().routes();
+	if (!ipForwardVector_)
 	{
-		ipForwardVector_.clear();
 		pIpForwardTable = nullptr;
 	}
 	else
 	{
-		pIpForwardTable = (MIB_IPFORWARDTABLE *)&ipForwardVector_[0];
+		pIpForwardTable = (const MIB_IPFORWARDTABLE *)&(*ipForwardVector_)[0];
 
 		for (DWORD ind = 0; ind < pIpForwardTable->dwNumEntries; ++ind)
 		{
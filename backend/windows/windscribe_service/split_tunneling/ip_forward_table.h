@@ -1,6 +1,6 @@
 #pragma once
 
-// wrapper for API GetIpForwardTable and util functions
+// wrapper for the routes snapshot (GetIpForwardTable) and util functions
 class IpForwardTable
 {
 public:
@@ -11,8 +11,8 @@ public:
 	ULONG getMaxMetric() const { return maxMetric_; }
 
 private:
-	std::vector<unsigned char> ipForwardVector_;
-	MIB_IPFORWARDTABLE *pIpForwardTable;
+	std::shared_ptr<const std::vector<unsigned char>> ipForwardVector_;
+	const MIB_IPFORWARDTABLE *pIpForwardTable;
 	ULONG maxMetric_;
 };
 
@@ -3,6 +3,7 @@
 #include "routes.h"
 #include "../ip_address/ip4_address_and_mask.h"
 #include "../logger.h"
+#include "../network_snapshot.h"
 
 Routes::Routes()
 {
@@ -10,8 +11,7 @@ Routes::Routes()
 
 void Routes::deleteRoute(const IpForwardTable &curRouteTable, const std::string &destIp, const std::string &maskIp, const std::string &gatewayIp, unsigned long ifIndex)
 {
-	std::string log = "Routes::deleteRoute(), destIp=" + destIp + ", maskIp=" + maskIp + ", gatewayIp=" + gatewayIp;
-	Logger::instance().out("%s", log.c_str());
+	Logger::instance().outVerbose("Routes::deleteRoute(), destIp=%s, maskIp=%s, gatewayIp=%s", destIp.c_str(), maskIp.c_str(), gatewayIp.c_str());
 	Ip4AddressAndMask dest(destIp.c_str());
 	Ip4AddressAndMask mask(maskIp.c_str());
 	Ip4AddressAndMask gateway(gatewayIp.c_str());
@@ -25,6 +25,7 @@ void Routes::deleteRoute(const IpForwardTable &curRouteTable, const std::string
 			{
 				MIB_IPFORWARDROW rowCopy = *row;
 				DWORD dwErr = DeleteIpForwardEntry(&rowCopy);
+				NetworkSnapshot::instance().invalidateRoutes();
 				if (dwErr == NO_ERROR)
 				{
 					deletedRoutes_.push_back(*row);
@@ -40,8 +41,7 @@ void Routes::deleteRoute(const IpForwardTable &curRouteTable, const std::string
 }
 void Routes::addRoute(const IpForwardTable &curRouteTable, const std::string &destIp, const std::string &maskIp, const std::string &gatewayIp, unsigned long ifIndex, bool useMaxMetric)
 {
-	std::string log = "Routes::addRoute(), destIp=" + destIp + ", maskIp=" + maskIp + ", gatewayIp=" + gatewayIp;
-	Logger::instance().out("%s", log.c_str());
+	Logger::instance().outVerbose("Routes::addRoute(), destIp=%s, maskIp=%s, gatewayIp=%s", destIp.c_str(), maskIp.c_str(), gatewayIp.c_str());
 	Ip4AddressAndMask dest(destIp.c_str());
 	Ip4AddressAndMask mask(maskIp.c_str());
 	Ip4AddressAndMask gateway(gatewayIp.c_str());
@@ -78,6 +78,7 @@ void Routes::addRoute(const IpForwardTable &curRouteTable, const std::string &de
 	row.dwForwardIfIndex = ifIndex;
 
 	DWORD dwErr = CreateIpForwardEntry(&row);
+	NetworkSnapshot::instance().invalidateRoutes();
 	if (dwErr == NO_ERROR)
 	{
 		addedRoutes_.push_back(row);
@@ -117,4 +118,5 @@ void Routes::revertRoutes()
 		}
 	}
 	addedRoutes_.clear();
+	NetworkSnapshot::instance().invalidateRoutes();
 }
\ No newline at end of file
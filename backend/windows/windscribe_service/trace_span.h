@@ -0,0 +1,70 @@
+#ifndef TRACE_SPAN_H
+#define TRACE_SPAN_H
+
+#include "logger.h"
+
+// The spans of the startup timeline, the same log lines as TraceSpan of the client (common/utils/tracespan.h):
+// "trace_span service <start, us since the epoch> <duration, us> <thread id> <name>".
+// MergeLog::mergeTraces() of the client merges them with the spans of the GUI and the engine.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name) : name_(name), startUs_(nowUs())
+    {
+    }
+
+    ~TraceSpan()
+    {
+        record(name_, startUs_);
+    }
+
+    static long long nowUs()
+    {
+        // the system time has the precision of the timer tick only, so the performance counter
+        // is added to the time of the first call
+        static const long long baseUs = systemTimeUs();
+        static const LARGE_INTEGER baseCounter = performanceCounter();
+        static const LARGE_INTEGER frequency = performanceFrequency();
+        const LARGE_INTEGER counter = performanceCounter();
+        return baseUs + (counter.QuadPart - baseCounter.QuadPart) * 1000000 / frequency.QuadPart;
+    }
+
+    static void record(const char *name, long long startUs)
+    {
+        Logger::instance().out("trace_span service %lld %lld %lu %s", startUs, nowUs() - startUs, GetCurrentThreadId(), name);
+    }
+
+private:
+    const char *name_;
+    long long startUs_;
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    static long long systemTimeUs()
+    {
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        ULARGE_INTEGER time;
+        time.LowPart = ft.dwLowDateTime;
+        time.HighPart = ft.dwHighDateTime;
+        // 100 ns intervals since 1601
+        return static_cast<long long>((time.QuadPart - 116444736000000000ULL) / 10);
+    }
+
+    static LARGE_INTEGER performanceCounter()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter;
+    }
+
+    static LARGE_INTEGER performanceFrequency()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return frequency;
+    }
+};
+
+#endif // TRACE_SPAN_H
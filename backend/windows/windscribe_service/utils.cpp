@@ -182,8 +182,18 @@ bool verifyWindscribeProcessPath(HANDLE hPipe)
 #if defined(USE_SIGNATURE_CHECK)
     // NOTE: a test project is archived with issue 546 for testing this method.
     
-   static DWORD pidVerified = 0;
-   
+   // the signature check is slow, so each client process is verified once; a reused PID or another executable
+   // gives another key. The pipe workers call this concurrently.
+   struct VerifiedClient
+   {
+      DWORD pid;
+      ULONGLONG creationTime;
+      std::wstring path;
+   };
+   static std::mutex verifiedClientsMutex;
+   static std::vector<VerifiedClient> verifiedClients;
+   const size_t MAX_VERIFIED_CLIENTS = 8;
+
    std::wostringstream output;
 
    DWORD pidClient = 0;
@@ -195,10 +205,6 @@ bool verifyWindscribeProcessPath(HANDLE hPipe)
       return false;
    }
 
-   if ((pidClient > 0) && (pidClient == pidVerified)) {
-      return true;
-   }
-
    WinUtils::Win32Handle processHandle(::OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pidClient));
    if (!processHandle.isValid())
    {
@@ -207,6 +213,15 @@ bool verifyWindscribeProcessPath(HANDLE hPipe)
       return false;
    }
 
+   FILETIME creationTime, exitTime, kernelTime, userTime;
+   if (!::GetProcessTimes(processHandle.getHandle(), &creationTime, &exitTime, &kernelTime, &userTime))
+   {
+      output << "GetProcessTimes failed. Err = " << ::GetLastError();
+      Logger::instance().out(output.str().c_str());
+      return false;
+   }
+   const ULONGLONG clientCreationTime = (static_cast<ULONGLONG>(creationTime.dwHighDateTime) << 32) | creationTime.dwLowDateTime;
+
    wchar_t path[MAX_PATH];
    if (::GetModuleFileNameEx(processHandle.getHandle(), NULL, path, MAX_PATH) == 0)
    {
@@ -215,6 +230,17 @@ bool verifyWindscribeProcessPath(HANDLE hPipe)
       return false;
    }
 
+   {
+      std::lock_guard<std::mutex> lock(verifiedClientsMutex);
+      for (const VerifiedClient &client : verifiedClients)
+      {
+         if (client.pid == pidClient && client.creationTime == clientCreationTime && client.path == path)
+         {
+            return true;
+         }
+      }
+   }
+
    std::wstring windscribeExePath = getExePath() + std::wstring(L"\\Windscribe.exe");
 
    if (!iequals(windscribeExePath, path))
@@ -235,7 +261,12 @@ bool verifyWindscribeProcessPath(HANDLE hPipe)
    //output << "verifyWindscribeProcessPath signature verified for " << std::wstring(path);
    //Logger::instance().out(output.str().c_str());
 
-   pidVerified = pidClient;
+   std::lock_guard<std::mutex> lock(verifiedClientsMutex);
+   if (verifiedClients.size() >= MAX_VERIFIED_CLIENTS)
+   {
+      verifiedClients.erase(verifiedClients.begin());
+   }
+   verifiedClients.push_back({ pidClient, clientCreationTime, path });
    return true;
 #else
     (void)hPipe;
@@ -387,6 +418,32 @@ GUID guidFromString(const std::wstring &str)
     return reqGUID;
 }
 
+DWORD setInterfaceMetric(const std::wstring &interfaceName, ADDRESS_FAMILY family, ULONG metric)
+{
+    NET_LUID luid;
+    DWORD ret = ConvertInterfaceAliasToLuid(interfaceName.c_str(), &luid);
+    if (ret != NO_ERROR) {
+        return ret;
+    }
+
+    MIB_IPINTERFACE_ROW row;
+    InitializeIpInterfaceEntry(&row);
+    row.Family = family;
+    row.InterfaceLuid = luid;
+    ret = GetIpInterfaceEntry(&row);
+    if (ret != NO_ERROR) {
+        return ret;
+    }
+
+    row.UseAutomaticMetric = FALSE;
+    row.Metric = metric;
+    // SetIpInterfaceEntry fails for IPv4 with the value read by GetIpInterfaceEntry
+    if (family == AF_INET) {
+        row.SitePrefixLength = 0;
+    }
+    return SetIpInterfaceEntry(&row);
+}
+
 bool isWindows7()
 {
     static int isWindows7 = -1;
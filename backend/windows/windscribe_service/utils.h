@@ -27,6 +27,8 @@ namespace Utils
 
 	void callNetworkAdapterMethod(const std::wstring &methodName, const std::wstring &adapterRegistryName);
     GUID guidFromString(const std::wstring &str);
+    // sets the metric of the interface with the friendly name through IP Helper, returns the error code
+    DWORD setInterfaceMetric(const std::wstring &interfaceName, ADDRESS_FAMILY family, ULONG metric);
 
     bool isWindows7();
 };
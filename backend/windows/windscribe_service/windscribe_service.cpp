@@ -4,11 +4,14 @@
 #include "dns_firewall.h"
 #include "firewallfilter.h"
 #include "logger.h"
+#include "trace_span.h"
 #include "ipc/servicecommunication.h"
 #include "icsmanager.h"
 #include "sys_ipv6_controller.h"
 #include "hostsedit.h"
 #include "get_active_processes.h"
+#include "process_monitor.h"
+#include "network_snapshot.h"
 #include "pipe_for_process.h"
 #include "executecmd.h"
 #include "reinstall_wan_ikev2.h"
@@ -29,6 +32,13 @@
 
 #define SERVICE_NAME  (L"WindscribeService")
 #define SERVICE_PIPE_NAME  (L"\\\\.\\pipe\\WindscribeService")
+// each pipe instance is served by its own worker thread, so a long command or the session of one client
+// doesn't block the other clients
+#define PIPE_INSTANCES_COUNT  4
+// the bulk payloads (the process list, the split tunneling apps) fit in one message
+#define PIPE_BUFFER_SIZE  (64 * 1024)
+// the longest AA_COMMAND_WAIT_UNBLOCKING_CMD_STATUS
+#define MAX_WAIT_UNBLOCKING_CMD_STATUS_MS  5000UL
 
 SERVICE_STATUS        g_ServiceStatus = { 0 };
 SERVICE_STATUS_HANDLE g_StatusHandle = NULL;
@@ -49,10 +59,34 @@ struct SPLIT_TUNNELING_PARS
 
 SPLIT_TUNNELING_PARS g_SplitTunnelingPars;
 
+// the objects shared by the pipe workers
+struct SERVICE_OBJECTS
+{
+	IcsManager *icsManager;
+	FirewallFilter *firewallFilter;
+	Ipv6Firewall *ipv6Firewall;
+	DnsFirewall *dnsFirewall;
+	SysIpv6Controller *sysIpv6Controller;
+	HostsEdit *hostsEdit;
+	GetActiveProcesses *getActiveProcesses;
+	SplitTunneling *splitTunnelling;
+	WireGuardController *wireGuardController;
+};
+
+// the concurrency of the commands of the pipe workers: the queries only read the state and run in parallel,
+// the changes (firewall, routes, DNS, adapters, split tunneling, the processes started with the inherited handles)
+// are serialized by g_StateMutex, the driver reinstalls are serialized between themselves only by g_DeviceMutex
+std::mutex g_StateMutex;
+std::mutex g_DeviceMutex;
+
+long long g_WorkerStartUs = 0;
+std::atomic<bool> g_IsFirstCommandTraced(false);
+
 
 VOID WINAPI serviceMain(DWORD argc, LPTSTR *argv);
 VOID WINAPI serviceCtrlHandler(DWORD);
 DWORD WINAPI serviceWorkerThread(LPVOID lpParam);
+DWORD WINAPI pipeWorkerThread(LPVOID lpParam);
 BOOL isElevated();
 
 int main(int argc, char *argv[])
@@ -253,6 +287,8 @@ VOID WINAPI serviceCtrlHandler(DWORD CtrlCode)
 		WaitForSingleObject(g_hThread, INFINITE);
 		CloseHandle(g_hThread);
 		g_hThread = NULL;
+		// the process may be killed by the shutdown before the static destructors
+		Logger::instance().flush();
 		break;
 
 	default:
@@ -286,8 +322,8 @@ HANDLE CreatePipe()
 		HANDLE hPipe = ::CreateNamedPipe(SERVICE_PIPE_NAME,
 			PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED, PIPE_TYPE_MESSAGE |
 			PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
-			1, 4096,
-			4096, NMPWAIT_USE_DEFAULT_WAIT, &sa);
+			PIPE_INSTANCES_COUNT, PIPE_BUFFER_SIZE,
+			PIPE_BUFFER_SIZE, NMPWAIT_USE_DEFAULT_WAIT, &sa);
 
         if (hPipe == INVALID_HANDLE_VALUE) {
             Logger::instance().out(L"CreateNamedPipe failed (%lu)", ::GetLastError());
@@ -334,16 +370,14 @@ std::string getHelperVersion()
 	return s;
 }
 
-MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, IcsManager &icsManager, FirewallFilter &firewallFilter, Ipv6Firewall &ipv6Firewall, DnsFirewall &dnsFirewall,
+template<class Archive>
+MessagePacketResult processMessagePacket(int cmdId, Archive &ia, IcsManager &icsManager, FirewallFilter &firewallFilter, Ipv6Firewall &ipv6Firewall, DnsFirewall &dnsFirewall,
 										 SysIpv6Controller &sysIpv6Controller, HostsEdit &hostsEdit, GetActiveProcesses &getActiveProcesses,
 										 SplitTunneling &splitTunnelling, WireGuardController &wireGuardController)
 {
 	MessagePacketResult mpr;
 	mpr.success = false;
 
-	std::istringstream  stream(packet);
-	boost::archive::text_iarchive ia(stream, boost::archive::no_header);
-
 	if (cmdId == AA_COMMAND_FIREWALL_ON)
 	{
 		CMD_FIREWALL_ON cmdFirewallOn;
@@ -443,6 +477,14 @@ MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, I
 		ia >> checkUnblockingCmdStatus;
 		mpr = ExecuteCmd::instance().getUnblockingCmdStatus(checkUnblockingCmdStatus.cmdId);
 	}
+	else if (cmdId == AA_COMMAND_WAIT_UNBLOCKING_CMD_STATUS)
+	{
+		// blocks only the worker thread of this pipe
+		CMD_WAIT_UNBLOCKING_CMD_STATUS waitUnblockingCmdStatus;
+		ia >> waitUnblockingCmdStatus;
+		mpr = ExecuteCmd::instance().waitUnblockingCmdStatus(waitUnblockingCmdStatus.cmdId,
+			(std::min)(waitUnblockingCmdStatus.timeoutMs, MAX_WAIT_UNBLOCKING_CMD_STATUS_MS));
+	}
 	else if (cmdId == AA_COMMAND_GET_UNBLOCKING_CMD_COUNT)
 	{
 		mpr = ExecuteCmd::instance().getActiveUnblockingCmdCount();
@@ -583,16 +625,28 @@ MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, I
 		CMD_SET_METRIC cmdSetMetric;
 		ia >> cmdSetMetric;
 
-		wchar_t setMetricCmd[MAX_PATH];
-		wcscpy(setMetricCmd, L"netsh int ");
-		wcscat(setMetricCmd, cmdSetMetric.szInterfaceType.c_str());
-		wcscat(setMetricCmd, L" set interface interface=\"");
-		wcscat(setMetricCmd, cmdSetMetric.szInterfaceName.c_str());
-		wcscat(setMetricCmd, L"\" metric=");
-		wcscat(setMetricCmd, cmdSetMetric.szMetricNumber.c_str());
-		
-		Logger::instance().out(L"AA_COMMAND_SET_METRIC, cmd=%s", setMetricCmd);
-		mpr = ExecuteCmd::instance().executeBlockingCmd(setMetricCmd);
+		// in place through IP Helper, netsh is started only if it fails
+		const ADDRESS_FAMILY family = (cmdSetMetric.szInterfaceType == L"ipv6") ? AF_INET6 : AF_INET;
+		const DWORD ret = Utils::setInterfaceMetric(cmdSetMetric.szInterfaceName, family, wcstoul(cmdSetMetric.szMetricNumber.c_str(), NULL, 10));
+		if (ret == NO_ERROR)
+		{
+			Logger::instance().out(L"AA_COMMAND_SET_METRIC, %s metric=%s for \"%s\"", cmdSetMetric.szInterfaceType.c_str(), cmdSetMetric.szMetricNumber.c_str(), cmdSetMetric.szInterfaceName.c_str());
+			mpr.success = true;
+			mpr.additionalString = "Ok.";
+		}
+		else
+		{
+			wchar_t setMetricCmd[MAX_PATH];
+			wcscpy(setMetricCmd, L"netsh int ");
+			wcscat(setMetricCmd, cmdSetMetric.szInterfaceType.c_str());
+			wcscat(setMetricCmd, L" set interface interface=\"");
+			wcscat(setMetricCmd, cmdSetMetric.szInterfaceName.c_str());
+			wcscat(setMetricCmd, L"\" metric=");
+			wcscat(setMetricCmd, cmdSetMetric.szMetricNumber.c_str());
+
+			Logger::instance().out(L"AA_COMMAND_SET_METRIC, SetIpInterfaceEntry failed (%lu), cmd=%s", ret, setMetricCmd);
+			mpr = ExecuteCmd::instance().executeBlockingCmd(setMetricCmd);
+		}
 	}
 	else if (cmdId == AA_COMMAND_WMIC_ENABLE)
 	{
@@ -699,32 +753,20 @@ MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, I
 		CMD_UPDATE_ICS cmdUpdateIcs;
 		ia >> cmdUpdateIcs;
 
-		// make command line
-		std::wstring strCmd = L"\"" + Utils::getExePath() + L"\\ChangeIcs.exe\"";
 		if (cmdUpdateIcs.cmd == 0)  // save
 		{
-			strCmd += L" -save \"";
-			strCmd += cmdUpdateIcs.szConfigPath;
-			strCmd += L"\"";
-			mpr = ExecuteCmd::instance().executeUnblockingCmd(strCmd.c_str(), cmdUpdateIcs.szEventName.c_str(), NULL);
-			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, cmd=%s", strCmd.c_str());
+			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, save %s", cmdUpdateIcs.szConfigPath.c_str());
+			mpr.success = icsManager.saveSettings(cmdUpdateIcs.szConfigPath);
 		}
 		else if (cmdUpdateIcs.cmd == 1) // restore
 		{
-			strCmd += L" -restore \"";
-			strCmd += cmdUpdateIcs.szConfigPath;
-			strCmd += L"\"";
-			mpr = ExecuteCmd::instance().executeUnblockingCmd(strCmd.c_str(), cmdUpdateIcs.szEventName.c_str(), NULL);
-			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, cmd=%s", strCmd.c_str());
+			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, restore %s", cmdUpdateIcs.szConfigPath.c_str());
+			mpr.success = icsManager.restoreSettings(cmdUpdateIcs.szConfigPath);
 		}
-		else if (cmdUpdateIcs.cmd == 2) // change
+		else if (cmdUpdateIcs.cmd == 2) // change, the event is signaled when it's applied
 		{
-			strCmd += L" -change ";
-			strCmd += cmdUpdateIcs.szPublicGuid;
-			strCmd += L" ";
-			strCmd += cmdUpdateIcs.szPrivateGuid;
-			mpr = ExecuteCmd::instance().executeUnblockingCmd(strCmd.c_str(), cmdUpdateIcs.szEventName.c_str(), NULL);
-			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, cmd=%s", strCmd.c_str());
+			Logger::instance().out(L"AA_COMMAND_UPDATE_ICS, change %s %s", cmdUpdateIcs.szPublicGuid.c_str(), cmdUpdateIcs.szPrivateGuid.c_str());
+			mpr.success = icsManager.changeSettings(cmdUpdateIcs.szPublicGuid, cmdUpdateIcs.szPrivateGuid, cmdUpdateIcs.szEventName);
 		}
 		else
 		{
@@ -994,11 +1036,38 @@ MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, I
 	return mpr;
 }
 
-bool writeMessagePacketResult(HANDLE hPipe, MessagePacketResult &mpr)
+MessagePacketResult processMessagePacket(int cmdId, const std::string &packet, bool isBinary, IcsManager &icsManager, FirewallFilter &firewallFilter, Ipv6Firewall &ipv6Firewall, DnsFirewall &dnsFirewall,
+										 SysIpv6Controller &sysIpv6Controller, HostsEdit &hostsEdit, GetActiveProcesses &getActiveProcesses,
+										 SplitTunneling &splitTunnelling, WireGuardController &wireGuardController)
+{
+	std::istringstream stream(packet);
+	if (isBinary)
+	{
+		boost::archive::binary_iarchive ia(stream, boost::archive::no_header);
+		return processMessagePacket(cmdId, ia, icsManager, firewallFilter, ipv6Firewall, dnsFirewall,
+			sysIpv6Controller, hostsEdit, getActiveProcesses, splitTunnelling, wireGuardController);
+	}
+	else
+	{
+		boost::archive::text_iarchive ia(stream, boost::archive::no_header);
+		return processMessagePacket(cmdId, ia, icsManager, firewallFilter, ipv6Firewall, dnsFirewall,
+			sysIpv6Controller, hostsEdit, getActiveProcesses, splitTunnelling, wireGuardController);
+	}
+}
+
+bool writeMessagePacketResult(HANDLE hPipe, MessagePacketResult &mpr, bool isBinary = false)
 {
 	std::stringstream stream;
-	boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-	oa << mpr;
+	if (isBinary)
+	{
+		boost::archive::binary_oarchive oa(stream, boost::archive::no_header);
+		oa << mpr;
+	}
+	else
+	{
+		boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+		oa << mpr;
+	}
 	const std::string str = stream.str();
 
 	// first 4 bytes - size of buffer
@@ -1015,58 +1084,68 @@ bool writeMessagePacketResult(HANDLE hPipe, MessagePacketResult &mpr)
 	return false;
 }
 
-DWORD WINAPI serviceWorkerThread(LPVOID)
+// nullptr for the queries
+std::mutex *commandMutex(int cmdId)
 {
-	CoInitializeEx(0, COINIT_MULTITHREADED);
-    BIND_CRASH_HANDLER_FOR_THREAD();
+	switch (cmdId)
+	{
+	case AA_COMMAND_GET_HELPER_VERSION:
+	case AA_COMMAND_CHECK_UNBLOCKING_CMD_STATUS:
+	case AA_COMMAND_WAIT_UNBLOCKING_CMD_STATUS:
+	case AA_COMMAND_GET_UNBLOCKING_CMD_COUNT:
+	case AA_COMMAND_FIREWALL_STATUS:
+	case AA_COMMAND_OS_IPV6_STATE:
+	case AA_COMMAND_IS_SUPPORTED_ICS:
+	case AA_COMMAND_ENUM_PROCESSES:
+		return nullptr;
+	case AA_COMMAND_REINSTALL_WAN_IKEV2:
+	case AA_COMMAND_ENABLE_WAN_IKEV2:
+	case AA_COMMAND_REINSTALL_TAP_DRIVER:
+	case AA_COMMAND_REINSTALL_WINTUN_DRIVER:
+		return &g_DeviceMutex;
+	default:
+		return &g_StateMutex;
+	}
+}
 
-	FwpmWrapper	  fwpmHandleWrapper;
-	if (!fwpmHandleWrapper.isInitialized())
+MessagePacketResult executeCommand(int cmdId, const std::string &packet, bool isBinary, SERVICE_OBJECTS &o)
+{
+	std::unique_lock<std::mutex> lock;
+	std::mutex *mutex = commandMutex(cmdId);
+	if (mutex)
 	{
-		return 0;
+		lock = std::unique_lock<std::mutex>(*mutex);
 	}
+	return processMessagePacket(cmdId, packet, isBinary, *o.icsManager, *o.firewallFilter, *o.ipv6Firewall, *o.dnsFirewall,
+		*o.sysIpv6Controller, *o.hostsEdit, *o.getActiveProcesses, *o.splitTunnelling, *o.wireGuardController);
+}
 
-	IcsManager          icsManager;
-	FirewallFilter      firewallFilter(fwpmHandleWrapper);
-	Ipv6Firewall		ipv6Firewall(fwpmHandleWrapper);
-	DnsFirewall			dnsFirewall(fwpmHandleWrapper);
-	SysIpv6Controller   sysIpv6Controller;
-	HostsEdit			hostsEdit;
-	GetActiveProcesses  getActiveProcesses;
-	SplitTunneling      splitTunnelling(firewallFilter, fwpmHandleWrapper);
-    WireGuardController wireGuardController;
-
-	Logger::instance().out(L"Service started");
+DWORD WINAPI pipeWorkerThread(LPVOID lpParam)
+{
+	CoInitializeEx(0, COINIT_MULTITHREADED);
+	BIND_CRASH_HANDLER_FOR_THREAD();
+	SERVICE_OBJECTS &objects = *static_cast<SERVICE_OBJECTS *>(lpParam);
 
 	HANDLE hPipe = CreatePipe();
 	if (hPipe == INVALID_HANDLE_VALUE)
 	{
+		CoUninitialize();
 		return 0;
 	}
 
 	HANDLE hEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
 	if (hEvent == NULL)
 	{
+		CloseHandle(hPipe);
+		CoUninitialize();
 		return 0;
 	}
 
-	// Tell the service controller we are started
-	g_ServiceStatus.dwControlsAccepted = SERVICE_ACCEPT_STOP | SERVICE_ACCEPT_SHUTDOWN;
-	g_ServiceStatus.dwCurrentState = SERVICE_RUNNING;
-	g_ServiceStatus.dwWin32ExitCode = 0;
-	g_ServiceStatus.dwCheckPoint = 0;
-
-	if (SetServiceStatus(g_StatusHandle, &g_ServiceStatus) == FALSE)
-	{
-		//OutputDebugString(_T(
-		//"My Sample Service: ServiceMain: SetServiceStatus returned error"));
-	}
-
 	OVERLAPPED overlapped;
+	ZeroMemory(&overlapped, sizeof(overlapped));
 	overlapped.hEvent = hEvent;
 
 	HANDLE hEvents[2];
-
 	hEvents[0] = g_ServiceStopEvent;
 	hEvents[1] = hEvent;
 
@@ -1087,6 +1166,10 @@ DWORD WINAPI serviceWorkerThread(LPVOID)
             unsigned long sizeOfBuf;
             if (IOUtils::readAll(hPipe, (char *)&cmdId, sizeof(cmdId)))
             {
+               if (!g_IsFirstCommandTraced.exchange(true))
+               {
+                  TraceSpan::record("first client command (from the service start)", g_WorkerStartUs);
+               }
                if (IOUtils::readAll(hPipe, (char *)&sizeOfBuf, sizeof(sizeOfBuf)))
                {
                   std::string strData;
@@ -1099,9 +1182,44 @@ DWORD WINAPI serviceWorkerThread(LPVOID)
                      }
                   }
 
-                  MessagePacketResult mpr = processMessagePacket(cmdId, strData, icsManager, firewallFilter, ipv6Firewall, dnsFirewall,
-                     sysIpv6Controller, hostsEdit, getActiveProcesses, splitTunnelling, wireGuardController);
-                  writeMessagePacketResult(hPipe, mpr);
+                  if (cmdId == AA_COMMAND_OPEN_SESSION)
+                  {
+                     // the client keeps the pipe open, the commands are read until it disconnects or the service stops
+                     unsigned long protocolVersion = 0;
+                     if (strData.size() == sizeof(protocolVersion))
+                     {
+                        memcpy(&protocolVersion, strData.data(), sizeof(protocolVersion));
+                     }
+                     const bool isBinary = protocolVersion >= 1;
+                     MessagePacketResult mpr;
+                     mpr.success = true;
+                     mpr.exitCode = isBinary ? 1 : 0;
+                     bool bSessionOk = writeMessagePacketResult(hPipe, mpr);
+                     while (bSessionOk)
+                     {
+                        unsigned long requestId;
+                        bSessionOk = IOUtils::readAllOrStop(hPipe, (char *)&requestId, sizeof(requestId), g_ServiceStopEvent) &&
+                                     IOUtils::readAllOrStop(hPipe, (char *)&cmdId, sizeof(cmdId), g_ServiceStopEvent) &&
+                                     IOUtils::readAllOrStop(hPipe, (char *)&sizeOfBuf, sizeof(sizeOfBuf), g_ServiceStopEvent);
+                        if (!bSessionOk)
+                        {
+                           break;
+                        }
+                        std::vector<char> buffer(sizeOfBuf);
+                        if (sizeOfBuf > 0 && !IOUtils::readAllOrStop(hPipe, buffer.data(), sizeOfBuf, g_ServiceStopEvent))
+                        {
+                           break;
+                        }
+
+                        mpr = executeCommand(cmdId, std::string(buffer.begin(), buffer.end()), isBinary, objects);
+                        bSessionOk = IOUtils::writeAll(hPipe, (char *)&requestId, sizeof(requestId)) && writeMessagePacketResult(hPipe, mpr, isBinary);
+                     }
+                  }
+                  else
+                  {
+                     MessagePacketResult mpr = executeCommand(cmdId, strData, false, objects);
+                     writeMessagePacketResult(hPipe, mpr);
+                  }
                }
             }
          }
@@ -1113,6 +1231,74 @@ DWORD WINAPI serviceWorkerThread(LPVOID)
 
 	CloseHandle(hEvent);
 	CloseHandle(hPipe);
+	CoUninitialize();
+	return 0;
+}
+
+DWORD WINAPI serviceWorkerThread(LPVOID)
+{
+	CoInitializeEx(0, COINIT_MULTITHREADED);
+    BIND_CRASH_HANDLER_FOR_THREAD();
+	g_WorkerStartUs = TraceSpan::nowUs();
+
+	FwpmWrapper	  fwpmHandleWrapper;
+	if (!fwpmHandleWrapper.isInitialized())
+	{
+		return 0;
+	}
+
+	IcsManager          icsManager;
+	FirewallFilter      firewallFilter(fwpmHandleWrapper);
+	Ipv6Firewall		ipv6Firewall(fwpmHandleWrapper);
+	DnsFirewall			dnsFirewall(fwpmHandleWrapper);
+	SysIpv6Controller   sysIpv6Controller;
+	HostsEdit			hostsEdit;
+	GetActiveProcesses  getActiveProcesses;
+	SplitTunneling      splitTunnelling(firewallFilter, fwpmHandleWrapper);
+    WireGuardController wireGuardController;
+
+	SERVICE_OBJECTS objects = { &icsManager, &firewallFilter, &ipv6Firewall, &dnsFirewall, &sysIpv6Controller, &hostsEdit,
+								&getActiveProcesses, &splitTunnelling, &wireGuardController };
+
+	Logger::instance().out(L"Service started");
+	TraceSpan::record("service init", g_WorkerStartUs);
+	ProcessMonitor::instance().start();
+	NetworkSnapshot::instance().start();
+
+	std::vector<HANDLE> workers;
+	for (int i = 0; i < PIPE_INSTANCES_COUNT; ++i)
+	{
+		HANDLE hWorker = CreateThread(NULL, 0, pipeWorkerThread, &objects, 0, NULL);
+		if (hWorker == NULL)
+		{
+			Logger::instance().out(L"Can't create the pipe worker thread (%lu)", ::GetLastError());
+			continue;
+		}
+		workers.push_back(hWorker);
+	}
+
+	// Tell the service controller we are started
+	g_ServiceStatus.dwControlsAccepted = SERVICE_ACCEPT_STOP | SERVICE_ACCEPT_SHUTDOWN;
+	g_ServiceStatus.dwCurrentState = SERVICE_RUNNING;
+	g_ServiceStatus.dwWin32ExitCode = 0;
+	g_ServiceStatus.dwCheckPoint = 0;
+
+	if (SetServiceStatus(g_StatusHandle, &g_ServiceStatus) == FALSE)
+	{
+		//OutputDebugString(_T(
+		//"My Sample Service: ServiceMain: SetServiceStatus returned error"));
+	}
+
+	// the workers finish on the stop event
+	WaitForSingleObject(g_ServiceStopEvent, INFINITE);
+	if (!workers.empty())
+	{
+		WaitForMultipleObjects(static_cast<DWORD>(workers.size()), &workers[0], TRUE, INFINITE);
+	}
+	for (HANDLE hWorker : workers)
+	{
+		CloseHandle(hWorker);
+	}
 
 	// turn off split tunneling
 	CMD_CONNECT_STATUS connectStatus = { 0 };
@@ -1120,6 +1306,8 @@ DWORD WINAPI serviceWorkerThread(LPVOID)
 	splitTunnelling.setConnectStatus(connectStatus);
 	//splitTunnelling.stop();
 
+	ProcessMonitor::instance().stop();
+	NetworkSnapshot::instance().stop();
 	CoUninitialize();
 	Logger::instance().out(L"Service stopped");
 
@@ -27,6 +27,11 @@ WireGuardController::WireGuardController()
 {
 }
 
+WireGuardController::~WireGuardController()
+{
+    stopStatsPublisher();
+}
+
 bool WireGuardController::installService(const std::wstring &exeName, const std::wstring &configFile)
 {
     is_initialized_ = false;
@@ -69,6 +74,7 @@ bool WireGuardController::installService(const std::wstring &exeName, const std:
         svcCtrl.setServiceSIDType(SERVICE_SID_TYPE_UNRESTRICTED);
 
         is_initialized_ = true;
+        startStatsPublisher();
     }
     catch (std::system_error& ex)
     {
@@ -81,6 +87,7 @@ bool WireGuardController::installService(const std::wstring &exeName, const std:
 bool WireGuardController::deleteService()
 {
     is_initialized_ = false;
+    stopStatsPublisher();
 
     if (serviceName_.empty()) {
         return true;
@@ -130,73 +137,236 @@ UINT WireGuardController::getStatus(UINT64& lastHandshake, UINT64& txBytes, UINT
                 "WireGuardController::getStatus - the WireGuard tunnel is not initialized");
         }
 
-        WinUtils::Win32Handle hDriver(getKernelInterfaceHandle());
+        // the publisher thread has queried the driver recently, don't enumerate the devices again
+        WireGuardStatsBlock block;
+        if (statsBlock_ && readWireGuardStatsBlock(statsBlock_, block) &&
+            block.state == WIREGUARD_STATE_ACTIVE && ::GetTickCount64() - block.updateTime < 4 * WIREGUARD_STATS_UPDATE_INTERVAL_MS)
+        {
+            lastHandshake = block.lastHandshake;
+            txBytes = block.txBytes;
+            rxBytes = block.rxBytes;
+            return result;
+        }
 
-        // Look at kernel_get_device() in wireguard-windows-0.5.3\.deps\src\ipc-windows.h for
-        // sample code showing how to parse the structures returned from the wireguard-nt
-        // kernel driver when we send it the WG_IOCTL_GET io control command.
+        WinUtils::Win32Handle hDriver(getKernelInterfaceHandle());
+        PeerStats stats;
+        queryDriver(hDriver.getHandle(), stats);
+        lastHandshake = stats.lastHandshake;
+        txBytes = stats.txBytes;
+        rxBytes = stats.rxBytes;
+    }
+    catch (std::system_error& ex)
+    {
+        result = WIREGUARD_STATE_ERROR;
+        Logger::instance().out("WireGuardController::getStatus - %s", ex.what());
+    }
 
-        DWORD bufferSize = 4096;
-        std::unique_ptr< BYTE[] > buffer(new BYTE[bufferSize]);
+    return result;
+}
 
-        // Only perform max 3 attempts, just in case we keep getting ERROR_MORE_DATA for some reason.
-        BOOL apiResult = FALSE;
-        for (int i = 0; !apiResult && i < 3; ++i)
-        {
-            apiResult = ::DeviceIoControl(hDriver.getHandle(), WG_IOCTL_GET, NULL, 0, buffer.get(),
-                                          bufferSize, &bufferSize, NULL);
-            if (!apiResult)
-            {
-                if (::GetLastError() != ERROR_MORE_DATA) {
-                    throw std::system_error(::GetLastError(), std::generic_category(),
-                        "WireGuardController::getStatus - DeviceIoControl failed");
-                }
+void WireGuardController::queryDriver(HANDLE hDriver, PeerStats &stats)
+{
+    // Look at kernel_get_device() in wireguard-windows-0.5.3\.deps\src\ipc-windows.h for
+    // sample code showing how to parse the structures returned from the wireguard-nt
+    // kernel driver when we send it the WG_IOCTL_GET io control command.
 
-                buffer.reset(new BYTE[bufferSize]);
-            }
-        }
+    DWORD bufferSize = 4096;
+    std::unique_ptr< BYTE[] > buffer(new BYTE[bufferSize]);
 
+    // Only perform max 3 attempts, just in case we keep getting ERROR_MORE_DATA for some reason.
+    BOOL apiResult = FALSE;
+    for (int i = 0; !apiResult && i < 3; ++i)
+    {
+        apiResult = ::DeviceIoControl(hDriver, WG_IOCTL_GET, NULL, 0, buffer.get(),
+                                      bufferSize, &bufferSize, NULL);
         if (!apiResult)
         {
-            throw std::system_error(ERROR_UNIDENTIFIED_ERROR, std::generic_category(),
-                "WireGuardController::getStatus - DeviceIoControl failed repeatedly");
+            if (::GetLastError() != ERROR_MORE_DATA) {
+                throw std::system_error(::GetLastError(), std::generic_category(),
+                    "WireGuardController::getStatus - DeviceIoControl failed");
+            }
+
+            buffer.reset(new BYTE[bufferSize]);
         }
+    }
 
-        if (bufferSize < sizeof(WG_IOCTL_INTERFACE))
-        {
+    if (!apiResult)
+    {
+        throw std::system_error(ERROR_UNIDENTIFIED_ERROR, std::generic_category(),
+            "WireGuardController::getStatus - DeviceIoControl failed repeatedly");
+    }
+
+    if (bufferSize < sizeof(WG_IOCTL_INTERFACE))
+    {
+        throw std::system_error(ERROR_INVALID_DATA, std::generic_category(),
+            std::string("WireGuardController::getStatus - DeviceIoControl returned ") + std::to_string(bufferSize) +
+            std::string(" bytes, expected ") + std::to_string(sizeof(WG_IOCTL_INTERFACE)));
+    }
+
+    stats = PeerStats();
+
+    WG_IOCTL_INTERFACE* wgInterface = (WG_IOCTL_INTERFACE*)buffer.get();
+    if (wgInterface->PeersCount > 0)
+    {
+        if (bufferSize < sizeof(WG_IOCTL_INTERFACE) + sizeof(WG_IOCTL_PEER)) {
             throw std::system_error(ERROR_INVALID_DATA, std::generic_category(),
                 std::string("WireGuardController::getStatus - DeviceIoControl returned ") + std::to_string(bufferSize) +
-                std::string(" bytes, expected ") + std::to_string(sizeof(WG_IOCTL_INTERFACE)));
+                std::string(" bytes, expected ") + std::to_string(sizeof(WG_IOCTL_INTERFACE) + sizeof(WG_IOCTL_PEER)));
         }
 
-        WG_IOCTL_INTERFACE* wgInterface = (WG_IOCTL_INTERFACE*)buffer.get();
-        if (wgInterface->PeersCount > 0)
+        WG_IOCTL_PEER* wgPeerInfo = (WG_IOCTL_PEER*)(buffer.get() + sizeof(WG_IOCTL_INTERFACE));
+        stats.lastHandshake = wgPeerInfo->LastHandshake;
+        stats.txBytes = wgPeerInfo->TxBytes;
+        stats.rxBytes = wgPeerInfo->RxBytes;
+
+        if (wgPeerInfo->Flags & WG_IOCTL_PEER_HAS_ENDPOINT)
         {
-            if (bufferSize < sizeof(WG_IOCTL_INTERFACE) + sizeof(WG_IOCTL_PEER)) {
-                throw std::system_error(ERROR_INVALID_DATA, std::generic_category(),
-                    std::string("WireGuardController::getStatus - DeviceIoControl returned ") + std::to_string(bufferSize) +
-                    std::string(" bytes, expected ") + std::to_string(sizeof(WG_IOCTL_INTERFACE) + sizeof(WG_IOCTL_PEER)));
+            char addr[INET6_ADDRSTRLEN] = {};
+            const SOCKADDR_INET &endpoint = wgPeerInfo->Endpoint;
+            if (endpoint.si_family == AF_INET &&
+                ::inet_ntop(AF_INET, &endpoint.Ipv4.sin_addr, addr, sizeof(addr)) != NULL)
+            {
+                stats.endpoint = std::string(addr) + ":" + std::to_string(::ntohs(endpoint.Ipv4.sin_port));
+            }
+            else if (endpoint.si_family == AF_INET6 &&
+                     ::inet_ntop(AF_INET6, &endpoint.Ipv6.sin6_addr, addr, sizeof(addr)) != NULL)
+            {
+                stats.endpoint = std::string("[") + addr + "]:" + std::to_string(::ntohs(endpoint.Ipv6.sin6_port));
             }
+        }
+    }
+}
+
+void WireGuardController::startStatsPublisher()
+{
+    stopStatsPublisher();
 
-            WG_IOCTL_PEER* wgPeerInfo = (WG_IOCTL_PEER*)(buffer.get() + sizeof(WG_IOCTL_INTERFACE));
-            lastHandshake = wgPeerInfo->LastHandshake;
-            txBytes = wgPeerInfo->TxBytes;
-            rxBytes = wgPeerInfo->RxBytes;
+    // SYSTEM has full access, the authenticated users (the engine) can only read the block
+    PSECURITY_DESCRIPTOR pSD = NULL;
+    if (!::ConvertStringSecurityDescriptorToSecurityDescriptorW(L"D:(A;;GA;;;SY)(A;;GR;;;AU)", SDDL_REVISION_1, &pSD, NULL))
+    {
+        Logger::instance().out("WireGuardController::startStatsPublisher - ConvertStringSecurityDescriptorToSecurityDescriptor failed: %lu", ::GetLastError());
+        return;
+    }
+    SECURITY_ATTRIBUTES sa;
+    sa.nLength = sizeof(sa);
+    sa.lpSecurityDescriptor = pSD;
+    sa.bInheritHandle = FALSE;
+
+    hStatsMapping_ = ::CreateFileMappingW(INVALID_HANDLE_VALUE, &sa, PAGE_READWRITE, 0, sizeof(WireGuardStatsBlock),
+                                          WIREGUARD_STATS_MAPPING_NAME);
+    ::LocalFree(pSD);
+    if (hStatsMapping_ == NULL)
+    {
+        Logger::instance().out("WireGuardController::startStatsPublisher - CreateFileMapping failed: %lu", ::GetLastError());
+        return;
+    }
+
+    statsBlock_ = (WireGuardStatsBlock *)::MapViewOfFile(hStatsMapping_, FILE_MAP_WRITE, 0, 0, sizeof(WireGuardStatsBlock));
+    if (statsBlock_ == nullptr)
+    {
+        Logger::instance().out("WireGuardController::startStatsPublisher - MapViewOfFile failed: %lu", ::GetLastError());
+        ::CloseHandle(hStatsMapping_);
+        hStatsMapping_ = NULL;
+        return;
+    }
+
+    // the sequence continues from the previous tunnel if the engine still has the mapping open
+    publishStats(WIREGUARD_STATE_STARTING, PeerStats());
+
+    hStatsStopEvent_ = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+    hStatsThread_ = ::CreateThread(NULL, 0, statsThread, this, 0, NULL);
+    if (hStatsThread_ == NULL)
+    {
+        Logger::instance().out("WireGuardController::startStatsPublisher - CreateThread failed: %lu", ::GetLastError());
+    }
+}
+
+void WireGuardController::stopStatsPublisher()
+{
+    if (hStatsThread_ != NULL)
+    {
+        ::SetEvent(hStatsStopEvent_);
+        ::WaitForSingleObject(hStatsThread_, INFINITE);
+        ::CloseHandle(hStatsThread_);
+        hStatsThread_ = NULL;
+    }
+    if (hStatsStopEvent_ != NULL)
+    {
+        ::CloseHandle(hStatsStopEvent_);
+        hStatsStopEvent_ = NULL;
+    }
+    if (statsBlock_ != nullptr)
+    {
+        publishStats(WIREGUARD_STATE_NONE, PeerStats());
+        ::UnmapViewOfFile(statsBlock_);
+        statsBlock_ = nullptr;
+    }
+    if (hStatsMapping_ != NULL)
+    {
+        ::CloseHandle(hStatsMapping_);
+        hStatsMapping_ = NULL;
+    }
+}
+
+void WireGuardController::publishStats(UINT state, const PeerStats &stats)
+{
+    // the only writer, the readers retry while the sequence is odd or has changed
+    const LONG64 seq = statsBlock_->sequence;
+    statsBlock_->sequence = seq + 1;
+    MemoryBarrier();
+    statsBlock_->state = state;
+    statsBlock_->lastHandshake = stats.lastHandshake;
+    statsBlock_->txBytes = stats.txBytes;
+    statsBlock_->rxBytes = stats.rxBytes;
+    statsBlock_->updateTime = ::GetTickCount64();
+    strncpy_s(statsBlock_->endpoint, sizeof(statsBlock_->endpoint), stats.endpoint.c_str(), _TRUNCATE);
+    MemoryBarrier();
+    statsBlock_->sequence = seq + 2;
+}
+
+DWORD WINAPI WireGuardController::statsThread(LPVOID lpParam)
+{
+    WireGuardController *this_ = static_cast<WireGuardController *>(lpParam);
+
+    // the device enumeration is the expensive part of the query, the driver handle is reopened only on errors
+    HANDLE hDriver = INVALID_HANDLE_VALUE;
+    DWORD lastError = ERROR_SUCCESS;
+    do
+    {
+        UINT state = WIREGUARD_STATE_ACTIVE;
+        PeerStats stats;
+        try
+        {
+            if (hDriver == INVALID_HANDLE_VALUE) {
+                hDriver = this_->getKernelInterfaceHandle();
+            }
+            queryDriver(hDriver, stats);
+            lastError = ERROR_SUCCESS;
         }
-        else
+        catch (std::system_error& ex)
         {
-            lastHandshake = 0;
-            txBytes = 0;
-            rxBytes = 0;
+            if (hDriver != INVALID_HANDLE_VALUE)
+            {
+                ::CloseHandle(hDriver);
+                hDriver = INVALID_HANDLE_VALUE;
+            }
+            // the adapter doesn't exist until the tunnel service has started
+            state = WIREGUARD_STATE_STARTING;
+            if ((DWORD)ex.code().value() != lastError)
+            {
+                lastError = ex.code().value();
+                Logger::instance().out("WireGuardController::statsThread - %s", ex.what());
+            }
         }
+        this_->publishStats(state, stats);
     }
-    catch (std::system_error& ex)
-    {
-        result = WIREGUARD_STATE_ERROR;
-        Logger::instance().out("WireGuardController::getStatus - %s", ex.what());
-    }
+    while (::WaitForSingleObject(this_->hStatsStopEvent_, WIREGUARD_STATS_UPDATE_INTERVAL_MS) == WAIT_TIMEOUT);
 
-    return result;
+    if (hDriver != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(hDriver);
+    }
+    return 0;
 }
 
 HANDLE WireGuardController::getKernelInterfaceHandle() const
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "../ipc/servicecommunication.h"
+
 class WireGuardController final
 {
 public:
     explicit WireGuardController();
+    ~WireGuardController();
 
     bool installService(const std::wstring &exeName, const std::wstring &configFile);
     bool deleteService();
@@ -11,8 +14,28 @@ public:
     UINT getStatus(UINT64& lastHandshake, UINT64& txBytes, UINT64& rxBytes) const;
 
 private:
+    struct PeerStats
+    {
+        UINT64 lastHandshake = 0;
+        UINT64 txBytes = 0;
+        UINT64 rxBytes = 0;
+        std::string endpoint;
+    };
+
     bool is_initialized_ = false;
 
+    // the thread publishing the stats to the shared memory block, with the driver handle kept open
+    HANDLE hStatsMapping_ = NULL;
+    WireGuardStatsBlock *statsBlock_ = nullptr;
+    HANDLE hStatsThread_ = NULL;
+    HANDLE hStatsStopEvent_ = NULL;
+
+    void startStatsPublisher();
+    void stopStatsPublisher();
+    void publishStats(UINT state, const PeerStats &stats);
+    static DWORD WINAPI statsThread(LPVOID lpParam);
+    static void queryDriver(HANDLE hDriver, PeerStats &stats);
+
     std::string serviceName_;
     std::wstring deviceName_;
     std::wstring exeName_;
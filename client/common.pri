@@ -58,14 +58,21 @@ SOURCES += \
     $$COMMON_PATH/utils/languagesutil.cpp \
     $$COMMON_PATH/utils/logger.cpp \
     $$COMMON_PATH/utils/mergelog.cpp \
+    $$COMMON_PATH/utils/settingsstore.cpp \
+    $$COMMON_PATH/utils/tracespan.cpp \
+    $$COMMON_PATH/utils/eventloopwatchdog.cpp \
     $$COMMON_PATH/utils/utils.cpp \
     $$COMMON_PATH/utils/widgetutils.cpp \
     $$COMMON_PATH/utils/executable_signature/executable_signature.cpp \
+    $$COMMON_PATH/utils/ipset.cpp \
+    $$COMMON_PATH/utils/lanranges.cpp \
     $$COMMON_PATH/utils/ipvalidation.cpp \
     $$COMMON_PATH/version/appversion.cpp \
     $$COMMON_PATH/utils/hardcodedsettings.cpp \
     $$COMMON_PATH/utils/simplecrypt.cpp \
+    $$COMMON_PATH/utils/aesgcmcrypt.cpp \
     $$COMMON_PATH/ipc/commandfactory.cpp \
+    $$COMMON_PATH/ipc/commandstats.cpp \
     $$COMMON_PATH/ipc/connection.cpp \
     $$COMMON_PATH/ipc/server.cpp \
     $$COMMON_PATH/ipc/generated_proto/clientcommands.pb.cc \
@@ -82,19 +89,28 @@ HEADERS += \
     $$COMMON_PATH/utils/extraconfig.h \
     $$COMMON_PATH/utils/languagesutil.h \
     $$COMMON_PATH/utils/logger.h \
+    $$COMMON_PATH/utils/logringbuffer.h \
     $$COMMON_PATH/utils/mergelog.h \
+    $$COMMON_PATH/utils/settingsstore.h \
+    $$COMMON_PATH/utils/tracespan.h \
+    $$COMMON_PATH/utils/eventloopwatchdog.h \
     $$COMMON_PATH/utils/multiline_message_logger.h \
+    $$COMMON_PATH/utils/multipatternmatcher.h \
     $$COMMON_PATH/utils/utils.h \
     $$COMMON_PATH/utils/protobuf_includes.h \
     $$COMMON_PATH/utils/widgetutils.h \
     $$COMMON_PATH/utils/executable_signature/executable_signature.h \
+    $$COMMON_PATH/utils/ipset.h \
+    $$COMMON_PATH/utils/lanranges.h \
     $$COMMON_PATH/utils/ipvalidation.h \
     $$COMMON_PATH/version/appversion.h \
     $$COMMON_PATH/version/windscribe_version.h \
     $$COMMON_PATH/utils/hardcodedsettings.h \
     $$COMMON_PATH/utils/simplecrypt.h \
+    $$COMMON_PATH/utils/aesgcmcrypt.h \
     $$COMMON_PATH/ipc/command.h \
     $$COMMON_PATH/ipc/commandfactory.h \
+    $$COMMON_PATH/ipc/commandstats.h \
     $$COMMON_PATH/ipc/connection.h \
     $$COMMON_PATH/ipc/iconnection.h \
     $$COMMON_PATH/ipc/iserver.h \
@@ -21,7 +21,9 @@ SOURCES += $$PWD/engine/connectionmanager/adapterutils_win.cpp \
            $$PWD/engine/helper/windscribeinstallhelper_win.cpp \
            $$PWD/engine/connectionmanager/ikev2connection_win.cpp \
            $$PWD/engine/measurementcpuusage.cpp \
+           $$PWD/engine/processtelemetry_win.cpp \
            $$PWD/engine/ping/pinghost_icmp_win.cpp \
+           $$PWD/engine/mtuprober_win.cpp \
            $$PWD/engine/connectionmanager/ikev2connectiondisconnectlogic_win.cpp \
            $$PWD/engine/macaddresscontroller/macaddresscontroller_win.cpp \
            $$PWD/engine/networkdetectionmanager/networkdetectionmanager_win.cpp \
@@ -47,6 +49,7 @@ HEADERS += $$PWD/engine/connectionmanager/adapterutils_win.h \
            $$PWD/engine/helper/windscribeinstallhelper_win.h \
            $$PWD/engine/connectionmanager/ikev2connection_win.h \
            $$PWD/engine/measurementcpuusage.h \
+           $$PWD/engine/processtelemetry_win.h \
            $$PWD/engine/ping/pinghost_icmp_win.h \
            $$PWD/engine/connectionmanager/ikev2connectiondisconnectlogic_win.h \
            $$PWD/engine/macaddresscontroller/macaddresscontroller_win.h \
@@ -63,6 +66,7 @@ SOURCES += $$PWD/engine/firewall/firewallcontroller_mac.cpp \
            $$PWD/engine/ipv6controller_mac.cpp \
            $$PWD/engine/connectionmanager/networkextensionlog_mac.cpp \
            $$PWD/engine/ping/pinghost_icmp_mac.cpp \
+           $$PWD/engine/mtuprober_posix.cpp \
            $$PWD/engine/networkdetectionmanager/networkdetectionmanager_mac.cpp \
            $$PWD/engine/helper/helper_posix.cpp \
            $$PWD/engine/helper/helper_mac.cpp \
@@ -109,6 +113,7 @@ linux {
 SOURCES += \
            $$PWD/utils/dnsscripts_linux.cpp \
            $$PWD/engine/ping/pinghost_icmp_mac.cpp \
+           $$PWD/engine/mtuprober_posix.cpp \
            $$PWD/engine/dnsresolver/dnsutils_linux.cpp \
            $$PWD/engine/helper/helper_posix.cpp \
            $$PWD/engine/helper/helper_linux.cpp \
@@ -135,9 +140,11 @@ HEADERS += \
 
 
 SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
+    $$PWD/engine/apiinfo/apiinfosnapshot.cpp \
     $$PWD/engine/apiinfo/checkupdate.cpp \
     $$PWD/engine/apiinfo/sessionstatus.cpp \
     $$PWD/engine/apiinfo/location.cpp \
+    $$PWD/engine/apiinfo/locationsarena.cpp \
     $$PWD/engine/apiinfo/group.cpp \
     $$PWD/engine/apiinfo/node.cpp \
     $$PWD/engine/apiinfo/notification.cpp \
@@ -145,6 +152,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/apiinfo/staticips.cpp \
     $$PWD/engine/apiinfo/servercredentials.cpp \
     $$PWD/engine/autoupdater/downloadhelper.cpp \
+    $$PWD/engine/autoupdater/updatepatch.cpp \
     $$PWD/engine/ping/keepalivemanager.cpp \
     $$PWD/engine/locationsmodel/enginelocationsmodel.cpp \
     $$PWD/engine/locationsmodel/apilocationsmodel.cpp \
@@ -152,6 +160,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/locationsmodel/locationitem.cpp \
     $$PWD/engine/locationsmodel/pingipscontroller.cpp \
     $$PWD/engine/locationsmodel/pingstorage.cpp \
+    $$PWD/engine/locationsmodel/latencystats.cpp \
     $$PWD/engine/locationsmodel/bestlocation.cpp \
     $$PWD/engine/locationsmodel/baselocationinfo.cpp \
     $$PWD/engine/locationsmodel/mutablelocationinfo.cpp \
@@ -159,6 +168,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/locationsmodel/pinglog.cpp \
     $$PWD/engine/locationsmodel/failedpinglogcontroller.cpp \
     $$PWD/engine/locationsmodel/nodeselectionalgorithm.cpp \
+    $$PWD/engine/locationsmodel/nodehealth.cpp \
     $$PWD/engine/packetsizecontroller.cpp \
     $$PWD/engine/enginesettings.cpp \
     $$PWD/engine/tempscripts_mac.cpp \
@@ -167,7 +177,6 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/proxy/proxysettings.cpp \
     $$PWD/engine/types/connectionsettings.cpp \
     $$PWD/engine/getmyipcontroller.cpp \
-    $$PWD/engine/firewall/uniqueiplist.cpp \
     $$PWD/engine/firewall/firewallexceptions.cpp \
     $$PWD/engine/firewall/firewallcontroller.cpp \
     $$PWD/engine/proxy/proxyservercontroller.cpp \
@@ -176,11 +185,17 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/connectionmanager/adaptergatewayinfo.cpp \
     $$PWD/engine/connectionmanager/stunnelmanager.cpp \
     $$PWD/engine/connectionmanager/testvpntunnel.cpp \
+    $$PWD/engine/connectionmanager/throughputmeter.cpp \
+    $$PWD/engine/connectionmanager/tunnelspeedtest.cpp \
     $$PWD/engine/connectionmanager/openvpnconnection.cpp \
+    $$PWD/engine/connectionmanager/openvpnmanagementline.cpp \
     $$PWD/engine/connectionmanager/connsettingspolicy/autoconnsettingspolicy.cpp \
+    $$PWD/engine/connectionmanager/connsettingspolicy/connectionhistory.cpp \
     $$PWD/engine/connectionmanager/connsettingspolicy/manualconnsettingspolicy.cpp \
     $$PWD/engine/connectionmanager/connsettingspolicy/customconfigconnsettingspolicy.cpp \
     $$PWD/engine/connectionmanager/connectionmanager.cpp \
+    $$PWD/engine/connectionmanager/connectionracer.cpp \
+    $$PWD/engine/connectionmanager/connecttimeline.cpp \
     $$PWD/engine/connectionmanager/availableport.cpp \
     $$PWD/engine/macaddresscontroller/imacaddresscontroller.cpp \
     $$PWD/engine/logincontroller/getapiaccessips.cpp \
@@ -190,6 +205,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyconnectionmanager.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyconnection.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyrequestparser.cpp \
+    $$PWD/engine/vpnshare/httpproxyserver/httpproxyscanner.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyrequest.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxywebanswer.cpp \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxywebanswerparser.cpp \
@@ -199,6 +215,8 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxyreadexactly.cpp \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxyidentreqparser.cpp \
     $$PWD/engine/vpnshare/socketutils/socketwriteall.cpp \
+    $$PWD/engine/vpnshare/socketutils/socketrelay.cpp \
+    $$PWD/engine/vpnshare/socketutils/proxythreadpool.cpp \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxycommandparser.cpp \
     $$PWD/engine/vpnshare/vpnsharecontroller.cpp \
     $$PWD/engine/vpnshare/connecteduserscounter.cpp \
@@ -209,6 +227,8 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/serverapi/curlnetworkmanager.cpp \
     $$PWD/engine/serverapi/curlrequest.cpp \
     $$PWD/engine/serverapi/dnscache.cpp \
+    $$PWD/engine/serverapi/locationsjsonstreamparser.cpp \
+    $$PWD/engine/serverapi/jsonanswerstream.cpp \
     $$PWD/engine/serverapi/serverapi.cpp \
     $$PWD/engine/engine.cpp \
     $$PWD/engine/crossplatformobjectfactory.cpp \
@@ -218,9 +238,14 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/dnsresolver/dnsrequest.cpp \
     $$PWD/engine/dnsresolver/dnsserversconfiguration.cpp \
     $$PWD/engine/dnsresolver/dnsresolver.cpp \
+    $$PWD/engine/dnsresolver/dohresolver.cpp \
+    $$PWD/engine/dnsresolver/hostnameresolvecache.cpp \
     $$PWD/engine/types/protocoltype.cpp \
     $$PWD/engine/tests/sessionandlocations_test.cpp \
-    $$PWD/engine/sessionstatustimer.cpp \
+    $$PWD/engine/inittaskgraph.cpp \
+    $$PWD/engine/refreshscheduler.cpp \
+    $$PWD/engine/enginemetrics.cpp \
+    $$PWD/engine/metricsserver.cpp \
     $$PWD/engine/connectionmanager/wstunnelmanager.cpp \
     $$PWD/engine/customconfigs/customconfigs.cpp \
     $$PWD/engine/customconfigs/customconfigtype.cpp \
@@ -230,11 +255,15 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/customconfigs/parseovpnconfigline.cpp \
     $$PWD/engine/customconfigs/customovpnauthcredentialsstorage.cpp \
     $$PWD/engine/ping/pinghost_tcp.cpp \
+    $$PWD/engine/ping/tcppingworker.cpp \
     $$PWD/engine/ping/pinghost.cpp \
     $$PWD/engine/customconfigs/customconfigsdirwatcher.cpp \
     $$PWD/engine/wireguardconfig/wireguardconfig.cpp \
+    $$PWD/engine/wireguardconfig/allowedips.cpp \
     $$PWD/engine/wireguardconfig/getwireguardconfig.cpp \
     $$PWD/engine/wireguardconfig/getwireguardconfiginloop.cpp \
+    $$PWD/engine/wireguardconfig/wireguardconnectcache.cpp \
+    $$PWD/engine/wireguardconfig/wireguardconfigprefetcher.cpp \
     $$PWD/engine/getdeviceid.cpp \
     $$PWD/engineserver.cpp \
     $$PWD/clientconnectiondescr.cpp \
@@ -254,6 +283,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/locationsmodel/locationitem.h \
     $$PWD/engine/locationsmodel/pingipscontroller.h \
     $$PWD/engine/locationsmodel/pingstorage.h \
+    $$PWD/engine/locationsmodel/latencystats.h \
     $$PWD/engine/locationsmodel/bestlocation.h \
     $$PWD/engine/locationsmodel/locationnode.h \
     $$PWD/engine/locationsmodel/baselocationinfo.h \
@@ -262,9 +292,12 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/locationsmodel/pinglog.h \
     $$PWD/engine/locationsmodel/failedpinglogcontroller.h \
     $$PWD/engine/locationsmodel/nodeselectionalgorithm.h \
+    $$PWD/engine/locationsmodel/nodehealth.h \
     $$PWD/engine/apiinfo/apiinfo.h \
+    $$PWD/engine/apiinfo/apiinfosnapshot.h \
     $$PWD/engine/apiinfo/sessionstatus.h \
     $$PWD/engine/apiinfo/location.h \
+    $$PWD/engine/apiinfo/locationsarena.h \
     $$PWD/engine/apiinfo/group.h \
     $$PWD/engine/apiinfo/node.h \
     $$PWD/engine/apiinfo/notification.h \
@@ -274,10 +307,12 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/connectionmanager/adaptergatewayinfo.h \
     $$PWD/engine/connectionmanager/makeovpnfile.h \
     $$PWD/engine/autoupdater/downloadhelper.h \
+    $$PWD/engine/autoupdater/updatepatch.h \
     $$PWD/engine/macaddresscontroller/imacaddresscontroller.h \
     $$PWD/engine/networkdetectionmanager/inetworkdetectionmanager.h \
     $$PWD/engine/ping/keepalivemanager.h \
     $$PWD/engine/packetsizecontroller.h \
+    $$PWD/engine/mtuprober.h \
     $$PWD/engine/enginesettings.h \
     $$PWD/engine/connectionmanager/stunnelmanager.h \
     $$PWD/engine/tempscripts_mac.h \
@@ -286,23 +321,28 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/proxy/proxysettings.h \
     $$PWD/engine/types/connectionsettings.h \
     $$PWD/engine/getmyipcontroller.h \
-    $$PWD/engine/firewall/uniqueiplist.h \
     $$PWD/engine/helper/ihelper.h \
     $$PWD/engine/firewall/firewallcontroller.h \
     $$PWD/engine/firewall/firewallexceptions.h \
     $$PWD/engine/proxy/proxyservercontroller.h \
     $$PWD/engine/connectionmanager/testvpntunnel.h \
+    $$PWD/engine/connectionmanager/throughputmeter.h \
+    $$PWD/engine/connectionmanager/tunnelspeedtest.h \
     $$PWD/engine/types/dnsresolutionsettings.h \
     $$PWD/engine/connectionmanager/iconnection.h \
     $$PWD/engine/connectionmanager/openvpnconnection.h \
+    $$PWD/engine/connectionmanager/openvpnmanagementline.h \
     $$PWD/engine/connectionmanager/isleepevents.h \
     $$PWD/utils/boost_includes.h \
     $$PWD/engine/types/types.h \
     $$PWD/engine/connectionmanager/connsettingspolicy/baseconnsettingspolicy.h \
     $$PWD/engine/connectionmanager/connsettingspolicy/autoconnsettingspolicy.h \
+    $$PWD/engine/connectionmanager/connsettingspolicy/connectionhistory.h \
     $$PWD/engine/connectionmanager/connsettingspolicy/manualconnsettingspolicy.h \
     $$PWD/engine/connectionmanager/connsettingspolicy/customconfigconnsettingspolicy.h \
     $$PWD/engine/connectionmanager/connectionmanager.h \
+    $$PWD/engine/connectionmanager/connectionracer.h \
+    $$PWD/engine/connectionmanager/connecttimeline.h \
     $$PWD/engine/logincontroller/getapiaccessips.h \
     $$PWD/engine/helper/initializehelper.h \
     $$PWD/engine/refetchservercredentialshelper.h \
@@ -311,6 +351,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyconnectionmanager.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyconnection.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyrequestparser.h \
+    $$PWD/engine/vpnshare/httpproxyserver/httpproxyscanner.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyrequest.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxyheader.h \
     $$PWD/engine/vpnshare/httpproxyserver/httpproxywebanswer.h \
@@ -322,6 +363,8 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxyreadexactly.h \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxyidentreqparser.h \
     $$PWD/engine/vpnshare/socketutils/socketwriteall.h \
+    $$PWD/engine/vpnshare/socketutils/socketrelay.h \
+    $$PWD/engine/vpnshare/socketutils/proxythreadpool.h \
     $$PWD/engine/vpnshare/socksproxyserver/socksproxycommandparser.h \
     $$PWD/engine/vpnshare/vpnsharecontroller.h \
     $$PWD/engine/vpnshare/connecteduserscounter.h \
@@ -332,6 +375,8 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/serverapi/curlnetworkmanager.h \
     $$PWD/engine/serverapi/curlrequest.h \
     $$PWD/engine/serverapi/dnscache.h \
+    $$PWD/engine/serverapi/locationsjsonstreamparser.h \
+    $$PWD/engine/serverapi/jsonanswerstream.h \
     $$PWD/engine/serverapi/serverapi.h \
     $$PWD/engine/engine.h \
     $$PWD/engine/crossplatformobjectfactory.h \
@@ -342,9 +387,14 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/dnsresolver/dnsrequest.h \
     $$PWD/engine/dnsresolver/dnsserversconfiguration.h \
     $$PWD/engine/dnsresolver/dnsresolver.h \
+    $$PWD/engine/dnsresolver/dohresolver.h \
+    $$PWD/engine/dnsresolver/hostnameresolvecache.h \
     $$PWD/engine/types/protocoltype.h \
     $$PWD/engine/tests/sessionandlocations_test.h \
-    $$PWD/engine/sessionstatustimer.h \
+    $$PWD/engine/inittaskgraph.h \
+    $$PWD/engine/refreshscheduler.h \
+    $$PWD/engine/enginemetrics.h \
+    $$PWD/engine/metricsserver.h \
     $$PWD/engine/connectionmanager/wstunnelmanager.h \
     $$PWD/engine/customconfigs/icustomconfig.h \
     $$PWD/engine/customconfigs/customconfigtype.h \
@@ -357,11 +407,15 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/ping/icmp_header.h \
     $$PWD/engine/ping/ipv4_header.h \
     $$PWD/engine/ping/pinghost_tcp.h \
+    $$PWD/engine/ping/tcppingworker.h \
     $$PWD/engine/ping/pinghost.h \
     $$PWD/engine/customconfigs/customconfigsdirwatcher.h \
     $$PWD/engine/wireguardconfig/wireguardconfig.h \
+    $$PWD/engine/wireguardconfig/allowedips.h \
     $$PWD/engine/wireguardconfig/getwireguardconfig.h \
     $$PWD/engine/wireguardconfig/getwireguardconfiginloop.h \
+    $$PWD/engine/wireguardconfig/wireguardconnectcache.h \
+    $$PWD/engine/wireguardconfig/wireguardconfigprefetcher.h \
     $$PWD/engine/getdeviceid.h \
     $$PWD/engineserver.h \
     $$PWD/clientconnectiondescr.h \
@@ -376,3 +430,10 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
 
 RESOURCES += \
     $$PWD/engine.qrc
+
+# the record/replay of the network answers (engine/tests/networkrecorder.h), only in the debug and the benchmark builds
+CONFIG(debug, debug|release)|network_recorder {
+    DEFINES += WINDSCRIBE_NETWORK_RECORDER
+    SOURCES += $$PWD/engine/tests/networkrecorder.cpp
+    HEADERS += $$PWD/engine/tests/networkrecorder.h
+}
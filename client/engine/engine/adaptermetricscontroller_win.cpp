@@ -98,10 +98,9 @@ void AdapterMetricsController_win::updateMetrics(const QString &adapterName, IHe
             {
                 setupIPv4Metric--;
             }
-            QString cmd = "netsh int ipv4 set interface interface=\"" + tapFriendlyName + "\" metric=" + QString::number(setupIPv4Metric);
-            qCDebug(LOG_BASIC) << "Execute cmd:" << cmd;
+            qCDebug(LOG_BASIC) << "Set ipv4 metric of" << tapFriendlyName << "to" << setupIPv4Metric;
             QString answer = helper_win->executeSetMetric("ipv4", tapFriendlyName, QString::number(setupIPv4Metric));
-            qCDebug(LOG_BASIC) << "Answer from netsh cmd:" << answer;
+            qCDebug(LOG_BASIC) << "Answer from the helper:" << answer;
         }
         if (tapAdapterIPv6Enabled && tapAdapterIPv6Metric >= minIPv6Metric)
         {
@@ -110,10 +109,9 @@ void AdapterMetricsController_win::updateMetrics(const QString &adapterName, IHe
             {
                 setupIPv6Metric--;
             }
-            QString cmd = "netsh int ipv6 set interface interface=\"" + tapFriendlyName + "\" metric=" + QString::number(setupIPv6Metric);
-            qCDebug(LOG_BASIC) << "Execute cmd:" << cmd;
+            qCDebug(LOG_BASIC) << "Set ipv6 metric of" << tapFriendlyName << "to" << setupIPv6Metric;
             QString answer = helper_win->executeSetMetric("ipv6", tapFriendlyName, QString::number(setupIPv6Metric));
-            qCDebug(LOG_BASIC) << "Answer from netsh cmd:" << answer;
+            qCDebug(LOG_BASIC) << "Answer from the helper:" << answer;
         }
     }
     else
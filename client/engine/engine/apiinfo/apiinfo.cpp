@@ -1,13 +1,17 @@
 #include "apiinfo.h"
+#include <QHash>
 #include <QThread>
 #include <QSettings>
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 #include "utils/utils.h"
+#include "utils/tracespan.h"
 #include "utils/protobuf_includes.h"
+#include "apiinfosnapshot.h"
 
 namespace apiinfo {
 
-ApiInfo::ApiInfo() : simpleCrypt_(0x4572A4ACF31A31BA), threadId_(QThread::currentThreadId())
+ApiInfo::ApiInfo() : crypt_(0x4572A4ACF31A31BA), threadId_(QThread::currentThreadId())
 {
 }
 
@@ -21,8 +25,7 @@ void ApiInfo::setSessionStatus(const SessionStatus &value)
 {
     Q_ASSERT(threadId_ == QThread::currentThreadId());
     sessionStatus_ = value;
-    QSettings settings;
-    settings.setValue("userId", sessionStatus_.getUserId());    // need for uninstaller program for open post uninstall webpage
+    SettingsStore::instance().setValue("userId", sessionStatus_.getUserId());    // need for uninstaller program for open post uninstall webpage
 }
 
 void ApiInfo::setLocations(const QVector<Location> &value)
@@ -75,12 +78,17 @@ void ApiInfo::setOvpnConfig(const QString &value)
     ovpnConfigSetTimestamp_ = QDateTime::currentDateTimeUtc();
 }
 
+void ApiInfo::setServerCredentialsAndOvpnConfig(const ServerCredentials &serverCredentials, const QString &ovpnConfig)
+{
+    setServerCredentials(serverCredentials);
+    setOvpnConfig(ovpnConfig);
+}
+
 // return empty string if auth hash not exist in the settings
 QString ApiInfo::getAuthHash()
 {
     QString authHash;
-    QSettings settings2;
-    authHash = settings2.value("authHash", "").toString();
+    authHash = SettingsStore::instance().value("authHash", "").toString();
     if (authHash.isEmpty())
     {
         // try load from settings of the app ver1
@@ -92,8 +100,7 @@ QString ApiInfo::getAuthHash()
 
 void ApiInfo::setAuthHash(const QString &authHash)
 {
-    QSettings settings;
-    settings.setValue("authHash", authHash);
+    SettingsStore::instance().setValue("authHash", authHash);
 }
 
 PortMap ApiInfo::getPortMap() const
@@ -124,26 +131,36 @@ void ApiInfo::saveToSettings()
 {
     Q_ASSERT(threadId_ == QThread::currentThreadId());
 
-    QSettings settings;
-    ProtoApiInfo::ApiInfo protoApiInfo;
-
-    *protoApiInfo.mutable_session_status() = sessionStatus_.getProtoBuf();
+    SettingsStore &settings = SettingsStore::instance();
 
+    // the locations are stored in a separate section, the rest of the fields in another one
+    ProtoApiInfo::ApiInfo protoLocations;
     for (const Location &l : locations_)
     {
-        *protoApiInfo.add_locations() = l.getProtoBuf();
+        *protoLocations.add_locations() = l.getProtoBuf();
     }
 
+    ProtoApiInfo::ApiInfo protoApiInfo;
+    *protoApiInfo.mutable_session_status() = sessionStatus_.getProtoBuf();
     *protoApiInfo.mutable_server_credentials() = serverCredentials_.getProtoBuf();
     protoApiInfo.set_ovpn_config(ovpnConfig_.toStdString());
     *protoApiInfo.mutable_port_map() = portMap_.getProtoBuf();
     *protoApiInfo.mutable_static_ips() = staticIps_.getProtoBuf();
 
-    size_t size = protoApiInfo.ByteSizeLong();
-    QByteArray arr(size, Qt::Uninitialized);
-    protoApiInfo.SerializeToArray(arr.data(), size);
+    QMap<ApiInfoSnapshot::SECTION_TYPE, QByteArray> sections;
+    sections[ApiInfoSnapshot::SECTION_SESSION_AND_CONFIGS] = crypt_.encryptToByteArray(serializeProtoBuf(protoApiInfo));
+    sections[ApiInfoSnapshot::SECTION_LOCATIONS] = crypt_.encryptToByteArray(serializeProtoBuf(protoLocations));
 
-    settings.setValue("apiInfo", simpleCrypt_.encryptToString(arr));
+    if (ApiInfoSnapshot::save(sections))
+    {
+        settings.remove("apiInfo");
+    }
+    else
+    {
+        // fallback to the old format
+        protoApiInfo.MergeFrom(protoLocations);
+        settings.setValue("apiInfo", crypt_.encryptToString(serializeProtoBuf(protoApiInfo)));
+    }
 
     if (!sessionStatus_.getRevisionHash().isEmpty())
     {
@@ -157,11 +174,9 @@ void ApiInfo::saveToSettings()
 
 void ApiInfo::removeFromSettings()
 {
-    {
-        QSettings settings;
-        settings.remove("apiInfo");
-        settings.remove("authHash");
-    }
+    ApiInfoSnapshot::remove();
+    SettingsStore::instance().remove("apiInfo");
+    SettingsStore::instance().remove("authHash");
     // remove from first version too
     {
         QSettings settings1("Windscribe", "Windscribe");
@@ -170,91 +185,132 @@ void ApiInfo::removeFromSettings()
     }
 }
 
+bool ApiInfo::isExistInSettings()
+{
+    // the snapshot is validated by the hashes, without decrypting and parsing
+    ApiInfoSnapshot snapshot;
+    if (snapshot.open())
+    {
+        return true;
+    }
+    ApiInfo apiInfo;
+    return apiInfo.loadFromSettings();
+}
+
 bool ApiInfo::loadFromSettings()
 {
     Q_ASSERT(threadId_ == QThread::currentThreadId());
-    QSettings settings;
-    QString s = settings.value("apiInfo", "").toString();
-    if (!s.isEmpty())
+    TraceSpan traceSpan("engine", "ApiInfo::loadFromSettings");
+    SettingsStore &settings = SettingsStore::instance();
+    ProtoApiInfo::ApiInfo protoApiInfo;
+
+    ApiInfoSnapshot snapshot;
+    if (snapshot.open())
     {
-        QByteArray arr = simpleCrypt_.decryptToByteArray(s);
-        ProtoApiInfo::ApiInfo protoApiInfo;
-        if (!protoApiInfo.ParseFromArray(arr.data(), arr.size()))
+        ProtoApiInfo::ApiInfo protoLocations;
+        const QByteArray arr = crypt_.decryptToByteArray(snapshot.section(ApiInfoSnapshot::SECTION_SESSION_AND_CONFIGS));
+        const QByteArray arrLocations = crypt_.decryptToByteArray(snapshot.section(ApiInfoSnapshot::SECTION_LOCATIONS));
+        if (!protoApiInfo.ParseFromArray(arr.data(), arr.size()) ||
+            !protoLocations.ParseFromArray(arrLocations.data(), arrLocations.size()))
         {
             return false;
         }
-
-        sessionStatus_.initFromProtoBuf(protoApiInfo.session_status());
-
-        locations_.clear();
-        for (int i = 0; i < protoApiInfo.locations_size(); ++i)
+        protoApiInfo.MergeFrom(protoLocations);
+    }
+    else
+    {
+        // the old format, will be converted to the snapshot on the next save
+        QString s = settings.value("apiInfo", "").toString();
+        if (s.isEmpty())
         {
-            Location location;
-            location.initFromProtoBuf(protoApiInfo.locations(i));
-            locations_ << location;
+            return false;
         }
+        QByteArray arr = crypt_.decryptToByteArray(s);
+        if (!protoApiInfo.ParseFromArray(arr.data(), arr.size()))
+        {
+            return false;
+        }
+    }
 
-        forceDisconnectNodes_.clear();
-        serverCredentials_ = ServerCredentials(protoApiInfo.server_credentials());
-        ovpnConfig_ = QString::fromStdString(protoApiInfo.ovpn_config());
-        portMap_.initFromProtoBuf(protoApiInfo.port_map());
-        staticIps_.initFromProtoBuf(protoApiInfo.static_ips());
+    sessionStatus_.initFromProtoBuf(protoApiInfo.session_status());
 
-        sessionStatus_.setRevisionHash(settings.value("revisionHash", "").toString());
-        return true;
-    }
-    else
+    locations_.clear();
+    locations_.reserve(protoApiInfo.locations_size());
+    for (int i = 0; i < protoApiInfo.locations_size(); ++i)
     {
-        return false;
+        Location location;
+        location.initFromProtoBuf(protoApiInfo.locations(i));
+        locations_ << location;
     }
+
+    forceDisconnectNodes_.clear();
+    serverCredentials_ = ServerCredentials(protoApiInfo.server_credentials());
+    ovpnConfig_ = QString::fromStdString(protoApiInfo.ovpn_config());
+    portMap_.initFromProtoBuf(protoApiInfo.port_map());
+    staticIps_.initFromProtoBuf(protoApiInfo.static_ips());
+
+    sessionStatus_.setRevisionHash(settings.value("revisionHash", "").toString());
+    return true;
+}
+
+QByteArray ApiInfo::serializeProtoBuf(const ProtoApiInfo::ApiInfo &protoApiInfo)
+{
+    size_t size = protoApiInfo.ByteSizeLong();
+    QByteArray arr(size, Qt::Uninitialized);
+    protoApiInfo.SerializeToArray(arr.data(), size);
+    return arr;
 }
 
 void ApiInfo::mergeWindflixLocations()
 {
-    // Build a new list of server locations to merge, removing them from the old list.
+    // Split the list in one pass into the kept locations and the ones to merge (removing from the vector in place is quadratic).
     // Currently we merge all WindFlix locations into the corresponding global locations.
+    QVector<Location> locations;
     QVector<Location> locationsToMerge;
-    QMutableVectorIterator<Location> it(locations_);
-    while (it.hasNext()) {
-        Location &location = it.next();
-        if (location.getName().startsWith("WINDFLIX")) {
-            locationsToMerge.append(location);
-            it.remove();
+    locations.reserve(locations_.size());
+    for (const Location &location : qAsConst(locations_))
+    {
+        if (location.getName().startsWith("WINDFLIX"))
+        {
+            locationsToMerge << location;
+        }
+        else
+        {
+            locations << location;
         }
     }
-    if (!locationsToMerge.size())
+    if (locationsToMerge.isEmpty())
         return;
 
-    // Map city names to locations for faster lookups.
-    QHash<QString, Location *> location_hash;
-    for (auto &location: locations_) {
+    // Map country code and city to the index of the location, the groups are joined in one pass over them.
+    QHash<QString, int> locationIndexes;
+    for (int l = 0; l < locations.size(); ++l)
+    {
+        const Location &location = locations[l];
         for (int i = 0; i < location.groupsCount(); ++i)
         {
-            const Group group = location.getGroup(i);
-            location_hash.insert(location.getCountryCode() + group.getCity(), &location);
+            locationIndexes.insert(location.getCountryCode() + location.getGroup(i).getCity(), l);
         }
     }
 
     // Merge the locations.
-    QMutableVectorIterator<Location> itm(locationsToMerge);
-    while (itm.hasNext()) {
-        Location &location = itm.next();
-        const auto country_code = location.getCountryCode();
-
+    for (const Location &location : qAsConst(locationsToMerge))
+    {
+        const QString countryCode = location.getCountryCode();
         for (int i = 0; i < location.groupsCount(); ++i)
         {
             Group group = location.getGroup(i);
             group.setOverrideDnsHostName(location.getDnsHostName());
 
-            auto target = location_hash.find(country_code + group.getCity());
-            Q_ASSERT(target != location_hash.end());
-            if (target != location_hash.end())
+            const auto target = locationIndexes.constFind(countryCode + group.getCity());
+            Q_ASSERT(target != locationIndexes.constEnd());
+            if (target != locationIndexes.constEnd())
             {
-                target.value()->addGroup(group);
+                locations[target.value()].addGroup(group);
             }
         }
-        itm.remove();
     }
+    locations_ = locations;
 }
 
 bool ApiInfo::ovpnConfigRefetchRequired() const
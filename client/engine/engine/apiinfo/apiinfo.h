@@ -8,11 +8,15 @@
 #include <QMap>
 #include "portmap.h"
 #include "servercredentials.h"
-#include "utils/simplecrypt.h"
+#include "utils/aesgcmcrypt.h"
 #include "location.h"
 #include "staticips.h"
 #include "sessionstatus.h"
 
+namespace ProtoApiInfo {
+class ApiInfo;
+}
+
 namespace apiinfo {
 
 class ApiInfo
@@ -35,6 +39,8 @@ public:
     QString getOvpnConfig() const;
     void setOvpnConfig(const QString &value);
     bool ovpnConfigRefetchRequired() const;
+    // the credentials and the config of one refetch, a connect never sees one of them without the other
+    void setServerCredentialsAndOvpnConfig(const ServerCredentials &serverCredentials, const QString &ovpnConfig);
 
     // auth hash is stored in a separate value in QSettings
     static QString getAuthHash();
@@ -49,9 +55,11 @@ public:
     bool loadFromSettings();
     void saveToSettings();
     static void removeFromSettings();
+    static bool isExistInSettings();
 
 private:
     void mergeWindflixLocations();
+    static QByteArray serializeProtoBuf(const ProtoApiInfo::ApiInfo &protoApiInfo);
 
     SessionStatus sessionStatus_;
     QVector<Location> locations_;
@@ -61,7 +69,7 @@ private:
     PortMap portMap_;
     StaticIps staticIps_;
 
-    SimpleCrypt simpleCrypt_;
+    AesGcmCrypt crypt_;
 
     // for check thread id, access to the class must be from a single thread
     Qt::HANDLE threadId_;
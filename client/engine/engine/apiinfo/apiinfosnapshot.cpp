@@ -0,0 +1,188 @@
+#include "apiinfosnapshot.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include "utils/logger.h"
+
+namespace apiinfo {
+
+namespace {
+
+quint32 readUInt32(const uchar *data, qint64 offset)
+{
+    return qFromLittleEndian<quint32>(data + offset);
+}
+
+quint64 readUInt64(const uchar *data, qint64 offset)
+{
+    return qFromLittleEndian<quint64>(data + offset);
+}
+
+void appendUInt32(QByteArray &arr, quint32 value)
+{
+    uchar buf[sizeof(quint32)];
+    qToLittleEndian<quint32>(value, buf);
+    arr.append(reinterpret_cast<const char *>(buf), sizeof(buf));
+}
+
+void appendUInt64(QByteArray &arr, quint64 value)
+{
+    uchar buf[sizeof(quint64)];
+    qToLittleEndian<quint64>(value, buf);
+    arr.append(reinterpret_cast<const char *>(buf), sizeof(buf));
+}
+
+// the first 64 bits of SHA-256
+quint64 sectionHash(const char *data, int size)
+{
+    const QByteArray digest = QCryptographicHash::hash(QByteArray::fromRawData(data, size), QCryptographicHash::Sha256);
+    return qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(digest.constData()));
+}
+
+} // namespace
+
+ApiInfoSnapshot::ApiInfoSnapshot() : file_(filePath()), data_(nullptr)
+{
+}
+
+ApiInfoSnapshot::~ApiInfoSnapshot()
+{
+    close();
+}
+
+bool ApiInfoSnapshot::open()
+{
+    close();
+
+    if (!file_.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const qint64 fileSize = file_.size();
+    if (fileSize < HEADER_SIZE)
+    {
+        qCDebug(LOG_BASIC) << "ApiInfoSnapshot: file is too small";
+        close();
+        return false;
+    }
+
+    data_ = file_.map(0, fileSize);
+    if (!data_)
+    {
+        qCDebug(LOG_BASIC) << "ApiInfoSnapshot: can't map the file:" << file_.errorString();
+        close();
+        return false;
+    }
+
+    const quint32 sectionsCount = readUInt32(data_, 2 * sizeof(quint32));
+    if (readUInt32(data_, 0) != MAGIC || readUInt32(data_, sizeof(quint32)) != VERSION ||
+        sectionsCount > static_cast<quint32>(MAX_SECTIONS_COUNT) ||
+        fileSize < HEADER_SIZE + static_cast<qint64>(sectionsCount) * SECTION_ENTRY_SIZE)
+    {
+        qCDebug(LOG_BASIC) << "ApiInfoSnapshot: incorrect header or unsupported version";
+        close();
+        return false;
+    }
+
+    for (quint32 i = 0; i < sectionsCount; ++i)
+    {
+        const qint64 entryOffset = HEADER_SIZE + static_cast<qint64>(i) * SECTION_ENTRY_SIZE;
+        const quint32 type = readUInt32(data_, entryOffset);
+        const quint32 offset = readUInt32(data_, entryOffset + sizeof(quint32));
+        const quint32 size = readUInt32(data_, entryOffset + 2 * sizeof(quint32));
+        const quint64 hash = readUInt64(data_, entryOffset + 3 * sizeof(quint32));
+
+        if (static_cast<qint64>(offset) + size > fileSize)
+        {
+            qCDebug(LOG_BASIC) << "ApiInfoSnapshot: section" << type << "is out of the file";
+            close();
+            return false;
+        }
+
+        const char *sectionData = reinterpret_cast<const char *>(data_ + offset);
+        if (sectionHash(sectionData, static_cast<int>(size)) != hash)
+        {
+            qCDebug(LOG_BASIC) << "ApiInfoSnapshot: incorrect hash of the section" << type;
+            close();
+            return false;
+        }
+
+        sections_[static_cast<SECTION_TYPE>(type)] = QByteArray::fromRawData(sectionData, static_cast<int>(size));
+    }
+
+    return true;
+}
+
+void ApiInfoSnapshot::close()
+{
+    sections_.clear();
+    if (data_)
+    {
+        file_.unmap(data_);
+        data_ = nullptr;
+    }
+    file_.close();
+}
+
+bool ApiInfoSnapshot::isOpen() const
+{
+    return data_ != nullptr;
+}
+
+QByteArray ApiInfoSnapshot::section(SECTION_TYPE type) const
+{
+    return sections_.value(type);
+}
+
+bool ApiInfoSnapshot::save(const QMap<SECTION_TYPE, QByteArray> &sections)
+{
+    QByteArray arr;
+    appendUInt32(arr, MAGIC);
+    appendUInt32(arr, VERSION);
+    appendUInt32(arr, sections.count());
+
+    quint32 offset = HEADER_SIZE + sections.count() * SECTION_ENTRY_SIZE;
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it)
+    {
+        appendUInt32(arr, it.key());
+        appendUInt32(arr, offset);
+        appendUInt32(arr, it.value().size());
+        appendUInt64(arr, sectionHash(it.value().constData(), it.value().size()));
+        offset += it.value().size();
+    }
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it)
+    {
+        arr.append(it.value());
+    }
+
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::DataLocation));
+
+    // QSaveFile replaces the old file only if the new one has been written completely
+    QSaveFile file(filePath());
+    if (!file.open(QIODevice::WriteOnly) || file.write(arr) != arr.size() || !file.commit())
+    {
+        qCDebug(LOG_BASIC) << "ApiInfoSnapshot: can't write the file:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void ApiInfoSnapshot::remove()
+{
+    QFile::remove(filePath());
+}
+
+bool ApiInfoSnapshot::isExists()
+{
+    return QFile::exists(filePath());
+}
+
+QString ApiInfoSnapshot::filePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/apiinfo.bin";
+}
+
+} //namespace apiinfo
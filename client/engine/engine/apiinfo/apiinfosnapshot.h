@@ -0,0 +1,50 @@
+#ifndef APIINFO_APIINFOSNAPSHOT_H
+#define APIINFO_APIINFOSNAPSHOT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+
+namespace apiinfo {
+
+// Binary snapshot file of ApiInfo in the app data folder.
+// Layout: header (magic, version, sections count), table of sections (type, offset, size, hash), data of the sections.
+// The hash is the first 64 bits of SHA-256 of the section. The sections are stored as they were given (ApiInfo passes
+// them already encrypted), so the file can be validated by the hashes without decrypting it. The file is memory-mapped for reading.
+class ApiInfoSnapshot
+{
+public:
+    enum SECTION_TYPE { SECTION_SESSION_AND_CONFIGS = 1, SECTION_LOCATIONS = 2 };
+
+    ApiInfoSnapshot();
+    ~ApiInfoSnapshot();
+
+    // maps the file and validates the header and the hashes of the sections
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    // the returned array references the mapped memory and is valid until close()
+    QByteArray section(SECTION_TYPE type) const;
+
+    static bool save(const QMap<SECTION_TYPE, QByteArray> &sections);
+    static void remove();
+    static bool isExists();
+
+private:
+    static constexpr quint32 MAGIC = 0x49415357;    // "WSAI"
+    static constexpr quint32 VERSION = 2;
+    static constexpr int HEADER_SIZE = 3 * sizeof(quint32);
+    static constexpr int SECTION_ENTRY_SIZE = 3 * sizeof(quint32) + sizeof(quint64);
+    static constexpr int MAX_SECTIONS_COUNT = 16;
+
+    QFile file_;
+    uchar *data_;
+    QMap<SECTION_TYPE, QByteArray> sections_;
+
+    static QString filePath();
+};
+
+} //namespace apiinfo
+
+#endif // APIINFO_APIINFOSNAPSHOT_H
@@ -0,0 +1,109 @@
+#include "locationsarena.h"
+#include <QHostAddress>
+
+namespace apiinfo {
+
+LocationsArena::LocationsArena() : strings_(1)
+{
+}
+
+LocationsArena::LocationsArena(const QVector<Location> &locations) : strings_(1)
+{
+    QHash<QString, int> indexes;
+
+    int groupsCount = 0;
+    int nodesCount = 0;
+    for (const Location &l : locations)
+    {
+        groupsCount += l.groupsCount();
+        for (int i = 0; i < l.groupsCount(); ++i)
+        {
+            nodesCount += l.getGroup(i).getNodesCount();
+        }
+    }
+    locations_.reserve(locations.count());
+    groups_.reserve(groupsCount);
+    nodes_.reserve(nodesCount);
+
+    for (const Location &l : locations)
+    {
+        LocationEntry le;
+        le.id = LocationID::createTopApiLocationId(l.getId());
+        le.apiId = l.getId();
+        le.name = addString(l.getName(), indexes);
+        le.countryCode = addString(l.getCountryCode(), indexes);
+        le.dnsHostName = addString(l.getDnsHostName(), indexes);
+        le.isPremiumOnly = l.isPremiumOnly();
+        le.p2p = l.getP2P();
+        le.groupsBegin = groups_.count();
+
+        for (int i = 0; i < l.groupsCount(); ++i)
+        {
+            const Group group = l.getGroup(i);
+            GroupEntry ge;
+            ge.id = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick());
+            ge.city = addString(group.getCity(), indexes);
+            ge.nick = addString(group.getNick(), indexes);
+            ge.pingIp = addString(group.getPingIp(), indexes);
+            ge.pingIpV4 = ipToInt(group.getPingIp());
+            ge.wgPubKey = addString(group.getWgPubKey(), indexes);
+            ge.ovpnX509 = addString(group.getOvpnX509(), indexes);
+            ge.dnsHostName = addString(group.getDnsHostName(), indexes);
+            ge.isPro = group.isPro();
+            ge.linkSpeed = group.getLinkSpeed();
+            ge.health = group.getHealth();
+            ge.nodesBegin = nodes_.count();
+
+            for (int n = 0; n < group.getNodesCount(); ++n)
+            {
+                const Node &node = group.getNode(n);
+                NodeEntry ne;
+                for (int ip = 0; ip < 3; ++ip)
+                {
+                    ne.ips[ip] = ipToInt(node.getIp(ip));
+                }
+                ne.hostname = addString(node.getHostname(), indexes);
+                ne.weight = node.getWeight();
+                ne.isForceDisconnect = node.isForceDisconnect();
+                nodes_ << ne;
+            }
+
+            ge.nodesEnd = nodes_.count();
+            groups_ << ge;
+        }
+
+        le.groupsEnd = groups_.count();
+        locations_ << le;
+    }
+}
+
+quint32 LocationsArena::ipToInt(const QString &ip)
+{
+    bool ok = false;
+    const quint32 ipv4 = QHostAddress(ip).toIPv4Address(&ok);
+    return ok ? ipv4 : 0;
+}
+
+QString LocationsArena::ipToString(quint32 ip)
+{
+    return ip == 0 ? QString() : QHostAddress(ip).toString();
+}
+
+int LocationsArena::addString(const QString &str, QHash<QString, int> &indexes)
+{
+    if (str.isEmpty())
+    {
+        return 0;
+    }
+    auto it = indexes.constFind(str);
+    if (it != indexes.constEnd())
+    {
+        return it.value();
+    }
+    const int ind = strings_.count();
+    strings_ << str;
+    indexes.insert(str, ind);
+    return ind;
+}
+
+} //namespace apiinfo
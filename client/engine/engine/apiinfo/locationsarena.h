@@ -0,0 +1,85 @@
+#ifndef APIINFO_LOCATIONSARENA_H
+#define APIINFO_LOCATIONSARENA_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "location.h"
+#include "types/locationid.h"
+
+namespace apiinfo {
+
+// Immutable flat snapshot of the locations for the read-mostly consumers (the pings, the best location detection and
+// the list for the GUI). The nodes, the groups and the locations are stored in three contiguous arrays, the groups and
+// the locations reference their children by the index ranges. The strings are deduplicated into one pool and
+// referenced by index, the node IPs (always IPv4 from the API) are stored as integers.
+class LocationsArena
+{
+public:
+    struct NodeEntry
+    {
+        quint32 ips[3];
+        int hostname;
+        int weight;
+        bool isForceDisconnect;
+    };
+
+    struct GroupEntry
+    {
+        LocationID id;
+        int city;
+        int nick;
+        int pingIp;
+        quint32 pingIpV4;
+        int wgPubKey;
+        int ovpnX509;
+        int dnsHostName;
+        bool isPro;
+        int linkSpeed;
+        int health;
+        int nodesBegin;
+        int nodesEnd;
+
+        bool isDisabled() const { return nodesBegin == nodesEnd; }
+    };
+
+    struct LocationEntry
+    {
+        LocationID id;
+        int apiId;
+        int name;
+        int countryCode;
+        int dnsHostName;
+        bool isPremiumOnly;
+        int p2p;
+        int groupsBegin;
+        int groupsEnd;
+    };
+
+    LocationsArena();
+    explicit LocationsArena(const QVector<Location> &locations);
+
+    int locationsCount() const { return locations_.count(); }
+    const LocationEntry &location(int ind) const { return locations_[ind]; }
+    // of all locations, use the ranges of LocationEntry for the groups of one location
+    int groupsCount() const { return groups_.count(); }
+    const GroupEntry &group(int ind) const { return groups_[ind]; }
+    const NodeEntry &node(int ind) const { return nodes_[ind]; }
+    const QString &string(int ind) const { return strings_[ind]; }
+
+    // 0 if the ip is not an IPv4 address
+    static quint32 ipToInt(const QString &ip);
+    static QString ipToString(quint32 ip);
+
+private:
+    QVector<NodeEntry> nodes_;
+    QVector<GroupEntry> groups_;
+    QVector<LocationEntry> locations_;
+    QVector<QString> strings_;      // the index 0 is the empty string
+
+    int addString(const QString &str, QHash<QString, int> &indexes);
+};
+
+} //namespace apiinfo
+
+#endif // APIINFO_LOCATIONSARENA_H
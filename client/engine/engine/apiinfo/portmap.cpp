@@ -2,6 +2,7 @@
 
 #include <QJsonObject>
 #include <QMetaType>
+#include <algorithm>
 
 const int typeIdPortMap = qRegisterMetaType<apiinfo::PortMap>("apiinfo::PortMap");
 
@@ -33,6 +34,7 @@ bool PortMap::initFromJson(const QJsonArray &jsonArray)
         d->items_ << portItem;
     }
 
+    buildIndex();
     return true;
 }
 
@@ -51,6 +53,7 @@ void PortMap::initFromProtoBuf(const ProtoApiInfo::PortMap &portMap)
         }
         d->items_ << pi;
     }
+    buildIndex();
 }
 
 ProtoApiInfo::PortMap PortMap::getProtoBuf() const
@@ -103,45 +106,37 @@ const PortItem *PortMap::getPortItemByHeading(const QString &heading) const
 
 const PortItem *PortMap::getPortItemByProtocolType(const ProtocolType &protocol) const
 {
-    for (const PortItem &portItem : d->items_)
-    {
-        if (portItem.protocol.isEqual(protocol))
-        {
-            return &portItem;
-        }
-    }
-    return NULL;
+    const auto it = d->protocolIndex_.constFind(protocol.getType());
+    return it != d->protocolIndex_.constEnd() ? &d->items_[it.value()] : NULL;
 }
 
 int PortMap::getUseIpInd(const ProtocolType &connectionProtocol) const
 {
-    for (const PortItem &portItem : d->items_)
+    const PortItem *portItem = getPortItemByProtocolType(connectionProtocol);
+    if (portItem)
     {
-        if (portItem.protocol.isEqual(connectionProtocol))
+        if (portItem->use == "ip")
+            return 0;
+        else if (portItem->use == "ip2")
+            return 1;
+        else if (portItem->use == "ip3")
+            return 2;
+        // for ikev2 protocol, use 0 ind for ip
+        else if (portItem->use == "hostname")
+            return 0;
+        else
         {
-            if (portItem.use == "ip")
-                return 0;
-            else if (portItem.use == "ip2")
-                return 1;
-            else if (portItem.use == "ip3")
-                return 2;
-            // for ikev2 protocol, use 0 ind for ip
-            else if (portItem.use == "hostname")
-                return 0;
-            else
-            {
-                Q_ASSERT(false);
-                return -1;
-            }
+            Q_ASSERT(false);
+            return -1;
         }
     }
     Q_ASSERT(false);
     return -1;
 }
 
-QVector<PortItem> &PortMap::items()
+const QVector<int> &PortMap::autoConnectOrder() const
 {
-    return d->items_;
+    return d->autoConnectOrder_;
 }
 
 const QVector<PortItem> &PortMap::const_items() const
@@ -149,4 +144,29 @@ const QVector<PortItem> &PortMap::const_items() const
     return d->items_;
 }
 
+void PortMap::buildIndex()
+{
+    d->protocolIndex_.clear();
+    d->autoConnectOrder_.clear();
+    for (int i = 0; i < d->items_.count(); ++i)
+    {
+        const ProtocolType::PROTOCOL_TYPE type = d->items_[i].protocol.getType();
+        // the first item of the protocol is used, as the linear search did
+        if (!d->protocolIndex_.contains(type))
+        {
+            d->protocolIndex_.insert(type, i);
+        }
+        if (type != ProtocolType::PROTOCOL_UNINITIALIZED && type != ProtocolType::PROTOCOL_WSTUNNEL &&
+            type != ProtocolType::PROTOCOL_WIREGUARD)
+        {
+            d->autoConnectOrder_ << i;
+        }
+    }
+    // the enum is in the failover order
+    const QVector<PortItem> &items = d->items_;
+    std::stable_sort(d->autoConnectOrder_.begin(), d->autoConnectOrder_.end(), [&items](int i1, int i2) {
+        return items[i1].protocol.getType() < items[i2].protocol.getType();
+    });
+}
+
 } //namespace apiinfo
@@ -1,6 +1,7 @@
 #ifndef APIINFO_PORTMAP_H
 #define APIINFO_PORTMAP_H
 
+#include <QHash>
 #include <QJsonArray>
 #include <QSharedDataPointer>
 #include <QVector>
@@ -24,11 +25,16 @@ public:
 
     PortMapData(const PortMapData &other)
         : QSharedData(other),
-          items_(other.items_) {}
+          items_(other.items_),
+          protocolIndex_(other.protocolIndex_),
+          autoConnectOrder_(other.autoConnectOrder_) {}
 
     ~PortMapData() {}
 
     QVector<PortItem> items_;
+    // built once with the items, they don't change after that
+    QHash<int, int> protocolIndex_;     // ProtocolType::PROTOCOL_TYPE -> index in items_
+    QVector<int> autoConnectOrder_;
 };
 
 // implicitly shared class PortMap
@@ -47,8 +53,10 @@ public:
     const PortItem *getPortItemByHeading(const QString &heading) const;
     const PortItem *getPortItemByProtocolType(const ProtocolType &protocol) const;
     int getUseIpInd(const ProtocolType &connectionProtocol) const;
+    // indices of the items tried by the automatic connection mode, in the failover order:
+    // ikev2, udp, tcp, stealth (wstunnel and WireGuard are for the manual mode only)
+    const QVector<int> &autoConnectOrder() const;
 
-    QVector<PortItem> &items();
     const QVector<PortItem> &const_items() const;
 
     PortMap& operator=(const PortMap&) = default;
@@ -56,6 +64,8 @@ public:
 
 private:
     QSharedDataPointer<PortMapData> d;
+
+    void buildIndex();
 };
 
 } //namespace apiinfo
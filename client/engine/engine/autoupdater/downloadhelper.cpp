@@ -1,19 +1,39 @@
 #include "downloadhelper.h"
 
 #include "utils/logger.h"
+#include <QCryptographicHash>
 #include <QStandardPaths>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
+#include <QSettings>
+#include <QTimer>
 #include "names.h"
+#include "updatepatch.h"
 #include "engine/networkaccessmanager/networkaccessmanager.h"
+#include "utils/extraconfig.h"
 #include "utils/utils.h"
+#include "version/appversion.h"
 
 #ifdef Q_OS_LINUX
 #include "utils/linuxutils.h"
 #endif
 
+namespace {
+
+const char *SETTINGS_PATCH_BASE_VERSION = "autoUpdate/patchBaseVersion";          // the version the base installer is installed as
+const char *SETTINGS_CANDIDATE_DOWNLOADED_BY = "autoUpdate/candidateDownloadedBy"; // the version which downloaded the candidate
+const char *SETTINGS_PARTIAL_URL_PREFIX = "autoUpdate/partialUrl/";
+
+} // namespace
+
 DownloadHelper::DownloadHelper(QObject *parent, NetworkAccessManager *networkAccessManager, const QString &platform) : QObject(parent)
   , networkAccessManager_(networkAccessManager)
+  , reply_(nullptr)
+  , stage_(STAGE_FULL)
+  , resumeOffset_(0)
+  , bytesReceived_(0)
+  , resumeAttempts_(0)
   , busy_(false)
   , platform_(platform)
   , downloadDirectory_(QStandardPaths::writableLocation(QStandardPaths::DataLocation))
@@ -22,30 +42,17 @@ DownloadHelper::DownloadHelper(QObject *parent, NetworkAccessManager *networkAcc
 
 {
     removeAutoUpdateInstallerFiles();
+    updatePatchBase();
 }
 
 DownloadHelper::~DownloadHelper()
 {
-    abortAllReplies();
-    deleteAllReplies();
+    abortReply();
 }
 
 const QString DownloadHelper::downloadInstallerPath()
 {
-#ifdef Q_OS_WIN
-    const QString path = downloadInstallerPathWithoutExtension() + ".exe";
-#elif defined Q_OS_MAC
-    const QString path = downloadInstallerPathWithoutExtension() + ".dmg";
-#elif defined Q_OS_LINUX
-    QString path;
-    if(platform_ == LinuxUtils::DEB_PLATFORM_NAME) { // if getPlatformName() fails, we should never get this far anyway
-        path = downloadInstallerPathWithoutExtension() + ".deb";
-    }
-    else {
-        path = downloadInstallerPathWithoutExtension() + ".rpm";
-    }
-#endif
-    return path;
+    return downloadInstallerPathWithoutExtension() + extension();
 }
 
 const QString DownloadHelper::downloadInstallerPathWithoutExtension()
@@ -60,9 +67,8 @@ const QString DownloadHelper::downloadInstallerPathWithoutExtension()
     return path;
 }
 
-void DownloadHelper::get(QMap<QString, QString> downloads)
+void DownloadHelper::getInstaller(const QString &url, const QString &sha256)
 {
-    // assume get() should only run one set of downloads at a time
     if (busy_)
     {
         qCDebug(LOG_DOWNLOADER) << "Downloader is busy. Try again later";
@@ -70,10 +76,19 @@ void DownloadHelper::get(QMap<QString, QString> downloads)
     }
 
     busy_ = true;
+    state_ = DOWNLOAD_STATE_RUNNING;
     progressPercent_ = 0;
-    for (const auto & download : downloads.keys())
+    url_ = url;
+    sha256_ = sha256;
+
+    // the result of the patch can be verified only with the hash
+    if (!sha256_.isEmpty() && QFile::exists(patchBasePath()))
     {
-        getInner(download, downloads[download]);
+        startStage(STAGE_PATCH);
+    }
+    else
+    {
+        startStage(STAGE_FULL);
     }
 }
 
@@ -85,12 +100,24 @@ void DownloadHelper::stop()
         return;
     }
 
+    // the partial file is kept, the next download of the same url continues it
     qCDebug(LOG_DOWNLOADER) << "Stopping download";
-    abortAllReplies();
-    deleteAllReplies();
+    abortReply();
     busy_ = false;
 }
 
+void DownloadHelper::keepInstallerForNextUpdate()
+{
+    QFile::remove(candidatePath());
+    if (!QFile::copy(downloadInstallerPath(), candidatePath()))
+    {
+        qCDebug(LOG_DOWNLOADER) << "Failed to keep the installer for the next update";
+        return;
+    }
+    QSettings settings;
+    settings.setValue(SETTINGS_CANDIDATE_DOWNLOADED_BY, AppVersion::instance().semanticVersionString());
+}
+
 DownloadHelper::DownloadState DownloadHelper::state()
 {
     return state_;
@@ -98,81 +125,77 @@ DownloadHelper::DownloadState DownloadHelper::state()
 
 void DownloadHelper::onReplyFinished()
 {
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
+    if (sender() != reply_)
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that finished in monitored replies list";
+        qCDebug(LOG_DOWNLOADER) << "Finished reply is not the current download";
         return;
     }
-    replies_[reply].done = true;
 
-    // if any reply fails, we fail
-    if (!reply->isSuccess())
+    const bool success = reply_->isSuccess();
+    if (success)
     {
-        qCDebug(LOG_DOWNLOADER) << "Download failed";
-        abortAllReplies();
-        deleteAllReplies();
-        busy_ = false;
-        emit finished(DOWNLOAD_STATE_FAIL);
-        return;
+        onReplyReadyRead();
     }
+    disconnect(reply_);
+    reply_->deleteLater();
+    reply_ = nullptr;
+    file_.close();
 
-    if (allRepliesDone())
+    if (!success && stage_ == STAGE_FULL && resumeAttempts_ < MAX_RESUME_ATTEMPTS)
     {
-        qCDebug(LOG_DOWNLOADER) << "Download finished successfully";
-        deleteAllReplies();
-        busy_ = false;
-        emit finished(DOWNLOAD_STATE_SUCCESS);
+        // nothing received after the resume, possibly the server doesn't support the ranges
+        if (bytesReceived_ == 0 && resumeOffset_ > 0)
+        {
+            QFile::remove(file_.fileName());
+        }
+        resumeAttempts_++;
+        qCDebug(LOG_DOWNLOADER) << "Download interrupted at" << resumeOffset_ + bytesReceived_ << "bytes, resuming in"
+                                << RESUME_DELAY_MS / 1000 << "s, attempt" << resumeAttempts_;
+        QTimer::singleShot(RESUME_DELAY_MS, this, SLOT(onResumeTimer()));
         return;
     }
 
-    // still waiting on replies
-    qCDebug(LOG_DOWNLOADER) << "Download single file successful";
+    finishStage(success);
 }
 
 void DownloadHelper::onReplyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
+    if (sender() != reply_ || bytesTotal <= 0)
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that progressed in monitored replies list";
         return;
     }
-    replies_[reply].bytesReceived = bytesReceived;
-    replies_[reply].bytesTotal = bytesTotal;
 
-    // recompute total progress
-    qint64 sum = 0;
-    qint64 total = 0;
-    for (const auto & fileAndProgress : replies_.values())
+    // the sizes reported by the reply exclude the part downloaded before the resume
+    const uint progressPercent = static_cast<uint>((resumeOffset_ + bytesReceived) * 100 / (resumeOffset_ + bytesTotal));
+    if (progressPercent != progressPercent_)
     {
-        sum += fileAndProgress.bytesReceived;
-        total += fileAndProgress.bytesTotal;
+        progressPercent_ = progressPercent;
+        emit progressChanged(progressPercent_);
     }
-
-    // qCDebug(LOG_DOWNLOADER) << "Bytes received: " << bytesReceived << ", Bytes Total: " << bytesTotal;
-    progressPercent_ = (double) sum / (double) total * 100;
-
-    // qCDebug(LOG_DOWNLOADER) << "Downloading: " << progressPercent_;
-    emit progressChanged(progressPercent_);
 }
 
 void DownloadHelper::onReplyReadyRead()
 {
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
+    if (!reply_)
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that emitted ready read in monitored replies list";
         return;
     }
-    QByteArray arr = reply->readAll();
+    QByteArray arr = reply_->readAll();
 
     if (!arr.isEmpty())
     {
-        auto &file = replies_[reply].file;
-        if (file->isOpen())
+        // the part is appended only to a 206 of the range, a 200 is the whole file from the start
+        if (resumeOffset_ > 0 && bytesReceived_ == 0 && reply_->httpStatusCode() != 206 && file_.isOpen())
         {
-            file->write(arr);
+            qCDebug(LOG_DOWNLOADER) << "The server ignored the range (HTTP" << reply_->httpStatusCode()
+                                    << "), downloading from the start";
+            file_.resize(0);
+            resumeOffset_ = 0;
+        }
+        if (file_.isOpen())
+        {
+            file_.write(arr);
+            bytesReceived_ += arr.size();
         }
         else
         {
@@ -181,27 +204,190 @@ void DownloadHelper::onReplyReadyRead()
     }
 }
 
-void DownloadHelper::getInner(const QString url, const QString targetFilenamePath)
+void DownloadHelper::onResumeTimer()
+{
+    // the download could be stopped during the delay
+    if (busy_ && !reply_)
+    {
+        startDownload();
+    }
+}
+
+QString DownloadHelper::extension() const
 {
-    // remove a previously used file if it exists
-    QFile::remove(targetFilenamePath);
-    qCDebug(LOG_DOWNLOADER) << "Starting download from url: " << url;
+#ifdef Q_OS_WIN
+    return ".exe";
+#elif defined Q_OS_MAC
+    return ".dmg";
+#elif defined Q_OS_LINUX
+    // if getPlatformName() fails, we should never get this far anyway
+    return platform_ == LinuxUtils::DEB_PLATFORM_NAME ? ".deb" : ".rpm";
+#endif
+}
+
+QString DownloadHelper::patchBasePath() const
+{
+    return downloadDirectory_ + "/update_base" + extension();
+}
+
+QString DownloadHelper::candidatePath() const
+{
+    return downloadDirectory_ + "/update_candidate" + extension();
+}
 
-    FileAndProgress fileAndProgess;
-    fileAndProgess.file = QSharedPointer<QFile>::create(targetFilenamePath); // unnecessary copy?
-    if (!fileAndProgess.file->open(QIODevice::WriteOnly))
+QString DownloadHelper::patchPath() const
+{
+    return downloadDirectory_ + "/update.patch";
+}
+
+QString DownloadHelper::currentUrl() const
+{
+    // the patches are published next to the installer, one for each version they apply to
+    if (stage_ == STAGE_PATCH)
+    {
+        return url_ + ".patch-from-" + AppVersion::instance().semanticVersionString();
+    }
+    return url_;
+}
+
+QString DownloadHelper::currentTargetPath()
+{
+    return stage_ == STAGE_PATCH ? patchPath() : downloadInstallerPath();
+}
+
+void DownloadHelper::startStage(Stage stage)
+{
+    stage_ = stage;
+    resumeAttempts_ = 0;
+    progressPercent_ = 0;
+    startDownload();
+}
+
+void DownloadHelper::startDownload()
+{
+    const QString partPath = currentTargetPath() + ".part";
+    const QString url = currentUrl();
+
+    // the partial file is continued only if it's of the same url
+    {
+        QSettings settings;
+        const QString settingsKey = QString(SETTINGS_PARTIAL_URL_PREFIX) + QFileInfo(partPath).fileName();
+        if (settings.value(settingsKey).toString() != url)
+        {
+            QFile::remove(partPath);
+            settings.setValue(settingsKey, url);
+        }
+    }
+
+    file_.setFileName(partPath);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Append))
     {
         qCDebug(LOG_DOWNLOADER) << "Failed to open file for download" << url;
+        finishStage(false);
         return;
     }
+    resumeOffset_ = file_.size();
+    bytesReceived_ = 0;
+
+    qCDebug(LOG_DOWNLOADER) << "Starting download from url: " << url << "from offset" << resumeOffset_;
 
     NetworkRequest request(QUrl(url), 60000 * 5, true);     // timeout 5 mins
+    request.setResumeFrom(resumeOffset_);
+    request.setMaxReceiveSpeed(maxSpeed());
 
-    NetworkReply *reply = networkAccessManager_->get(request);
-    replies_.insert(reply, fileAndProgess);
-    connect(reply, SIGNAL(finished()), SLOT(onReplyFinished()));
-    connect(reply, SIGNAL(progress(qint64,qint64)), SLOT(onReplyDownloadProgress(qint64,qint64)));
-    connect(reply, SIGNAL(readyRead()), SLOT(onReplyReadyRead()));
+    reply_ = networkAccessManager_->get(request);
+    connect(reply_, SIGNAL(finished()), SLOT(onReplyFinished()));
+    connect(reply_, SIGNAL(progress(qint64,qint64)), SLOT(onReplyDownloadProgress(qint64,qint64)));
+    connect(reply_, SIGNAL(readyRead()), SLOT(onReplyReadyRead()));
+}
+
+void DownloadHelper::finishStage(bool success)
+{
+    const QString partPath = currentTargetPath() + ".part";
+    const QString targetPath = currentTargetPath();
+    if (success)
+    {
+        QFile::remove(targetPath);
+        success = QFile::rename(partPath, targetPath);
+    }
+
+    if (stage_ == STAGE_PATCH)
+    {
+        if (success && applyPatch())
+        {
+            qCDebug(LOG_DOWNLOADER) << "Download finished successfully (patch)";
+            finish(DOWNLOAD_STATE_SUCCESS);
+            return;
+        }
+        QFile::remove(partPath);
+        QFile::remove(patchPath());
+        qCDebug(LOG_DOWNLOADER) << "Patch is not available, downloading the full installer";
+        startStage(STAGE_FULL);
+        return;
+    }
+
+    if (success)
+    {
+        qCDebug(LOG_DOWNLOADER) << "Download finished successfully";
+        finish(DOWNLOAD_STATE_SUCCESS);
+    }
+    else
+    {
+        qCDebug(LOG_DOWNLOADER) << "Download failed";
+        finish(DOWNLOAD_STATE_FAIL);
+    }
+}
+
+void DownloadHelper::finish(DownloadState state)
+{
+    busy_ = false;
+    state_ = state;
+    emit finished(state);
+}
+
+bool DownloadHelper::applyPatch()
+{
+    const QString installerPath = downloadInstallerPath();
+    QString error;
+    if (!UpdatePatch::apply(patchBasePath(), patchPath(), installerPath, error))
+    {
+        qCDebug(LOG_DOWNLOADER) << "Failed to apply the patch:" << error;
+        QFile::remove(installerPath);
+        return false;
+    }
+    if (!isSha256Equal(installerPath, sha256_))
+    {
+        qCDebug(LOG_DOWNLOADER) << "The patched installer doesn't match the hash";
+        QFile::remove(installerPath);
+        return false;
+    }
+
+    qCDebug(LOG_DOWNLOADER) << "Patch of" << QFileInfo(patchPath()).size() << "bytes applied, installer size"
+                            << QFileInfo(installerPath).size();
+    QFile::remove(patchPath());
+    return true;
+}
+
+bool DownloadHelper::isSha256Equal(const QString &path, const QString &sha256)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+    {
+        return false;
+    }
+    return QString::fromLatin1(hash.result().toHex()).compare(sha256, Qt::CaseInsensitive) == 0;
+}
+
+qint64 DownloadHelper::maxSpeed()
+{
+    bool success = false;
+    const int speedKbps = ExtraConfig::instance().getUpdateDownloadSpeedLimit(success);
+    return success ? speedKbps * 1024LL : DEFAULT_MAX_SPEED;
 }
 
 void DownloadHelper::removeAutoUpdateInstallerFiles()
@@ -213,6 +399,7 @@ void DownloadHelper::removeAutoUpdateInstallerFiles()
         qCDebug(LOG_DOWNLOADER) << "Removing auto-update installer";
         QFile::remove(installerPath);
     }
+    QFile::remove(patchPath());
 
 #ifdef Q_OS_MAC
     // remove temp installer.app on mac:
@@ -226,34 +413,40 @@ void DownloadHelper::removeAutoUpdateInstallerFiles()
 #endif
 }
 
-bool DownloadHelper::allRepliesDone()
+void DownloadHelper::updatePatchBase()
 {
-    for (const auto &fp : replies_.values())
+    QSettings settings;
+    const QString currentVersion = AppVersion::instance().semanticVersionString();
+
+    // the version has changed since the candidate was downloaded, so it's installed (most likely the candidate itself,
+    // otherwise the hash check of the patch result fails and the full installer is downloaded)
+    const QString downloadedBy = settings.value(SETTINGS_CANDIDATE_DOWNLOADED_BY).toString();
+    if (QFile::exists(candidatePath()) && !downloadedBy.isEmpty() && downloadedBy != currentVersion)
     {
-        // breaks
-        if (!fp.done)
+        QFile::remove(patchBasePath());
+        if (QFile::rename(candidatePath(), patchBasePath()))
         {
-            return false;
+            qCDebug(LOG_DOWNLOADER) << "Keeping the installer of" << currentVersion << "for the update patches";
+            settings.setValue(SETTINGS_PATCH_BASE_VERSION, currentVersion);
         }
+        settings.remove(SETTINGS_CANDIDATE_DOWNLOADED_BY);
     }
-    return true;
-}
 
-void DownloadHelper::abortAllReplies()
-{
-    for (const auto &reply : replies_.keys())
+    if (QFile::exists(patchBasePath()) && settings.value(SETTINGS_PATCH_BASE_VERSION).toString() != currentVersion)
     {
-        reply->abort();
+        qCDebug(LOG_DOWNLOADER) << "Removing the installer of the previous version";
+        QFile::remove(patchBasePath());
     }
 }
 
-void DownloadHelper::deleteAllReplies()
+void DownloadHelper::abortReply()
 {
-    while (!replies_.empty())
+    if (reply_)
     {
-        NetworkReply *reply = replies_.firstKey();
-        disconnect(reply);
-        replies_.remove(reply);
-        reply->deleteLater();
+        disconnect(reply_);
+        reply_->abort();
+        reply_->deleteLater();
+        reply_ = nullptr;
     }
+    file_.close();
 }
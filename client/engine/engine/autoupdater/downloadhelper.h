@@ -5,11 +5,14 @@
 #include <QObject>
 #include <QFile>
 #include <QSharedPointer>
-#include <QMap>
 
 class NetworkAccessManager;
 class NetworkReply;
 
+// Downloads the installer of the update. If the installer of the installed version is kept from the previous update,
+// the patch against it is downloaded first (see UpdatePatch), the result is accepted only if it matches the sha256
+// of the installer, otherwise the full installer is downloaded. The downloads are resumed from the partial file
+// after the interruptions (also after the restart of the app) and run under a bandwidth cap.
 class DownloadHelper : public QObject
 {
     Q_OBJECT
@@ -27,9 +30,13 @@ public:
     const QString downloadInstallerPath();
     const QString downloadInstallerPathWithoutExtension();
 
-    void get(QMap<QString, QString> downloads);
+    void getInstaller(const QString &url, const QString &sha256);
     void stop();
 
+    // called after the successful download, the installer becomes the base of the next patch
+    // if the app is updated when it starts next time
+    void keepInstallerForNextUpdate();
+
     DownloadState state();
 
 signals:
@@ -40,18 +47,24 @@ private slots:
     void onReplyFinished();
     void onReplyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void onReplyReadyRead();
+    void onResumeTimer();
 
 private:
-    NetworkAccessManager *networkAccessManager_;
+    static constexpr int MAX_RESUME_ATTEMPTS = 5;
+    static constexpr int RESUME_DELAY_MS = 5000;
+    static constexpr qint64 DEFAULT_MAX_SPEED = 2 * 1024 * 1024;   // bytes per second
 
-    struct FileAndProgress {
-        QSharedPointer<QFile> file;
-        qint64 bytesReceived = 0;
-        qint64 bytesTotal = 0;
-        bool done = false;
-    };
+    enum Stage { STAGE_PATCH, STAGE_FULL };
 
-    QMap<NetworkReply*, FileAndProgress> replies_;
+    NetworkAccessManager *networkAccessManager_;
+    NetworkReply *reply_;
+    QFile file_;
+    Stage stage_;
+    QString url_;
+    QString sha256_;
+    qint64 resumeOffset_;
+    qint64 bytesReceived_;
+    int resumeAttempts_;
     bool busy_;
     const QString platform_;
 
@@ -59,12 +72,24 @@ private:
     uint progressPercent_;
     DownloadState state_;
 
-    void getInner(const QString url, const QString targetFilenamePath);
-    void removeAutoUpdateInstallerFiles();
-    bool allRepliesDone();
-    void abortAllReplies();
-    void deleteAllReplies();
+    QString extension() const;
+    QString patchBasePath() const;
+    QString candidatePath() const;
+    QString patchPath() const;
+    QString currentUrl() const;
+    QString currentTargetPath();
+
+    void startStage(Stage stage);
+    void startDownload();
+    void finishStage(bool success);
+    void finish(DownloadState state);
+    bool applyPatch();
+    static bool isSha256Equal(const QString &path, const QString &sha256);
+    static qint64 maxSpeed();
 
+    void removeAutoUpdateInstallerFiles();
+    void updatePatchBase();
+    void abortReply();
 };
 
 #endif // DOWNLOADHELPER_H
@@ -0,0 +1,113 @@
+#include "updatepatch.h"
+
+#include <QDataStream>
+#include <QFile>
+
+namespace {
+
+const char PATCH_MAGIC[] = "WSPATCH1";
+const int PATCH_MAGIC_LENGTH = 8;
+
+enum { COMMAND_COPY = 0, COMMAND_INSERT = 1 };
+
+} // namespace
+
+bool UpdatePatch::apply(const QString &basePath, const QString &patchPath, const QString &outPath, QString &outError)
+{
+    QFile patchFile(patchPath);
+    if (!patchFile.open(QIODevice::ReadOnly))
+    {
+        outError = "can't open the patch";
+        return false;
+    }
+    const QByteArray patchData = patchFile.readAll();
+    patchFile.close();
+
+    // a missing patch is downloaded as an error page, so the magic is checked first
+    if (patchData.size() < PATCH_MAGIC_LENGTH + 8 || !patchData.startsWith(QByteArray(PATCH_MAGIC, PATCH_MAGIC_LENGTH)))
+    {
+        outError = "not a patch";
+        return false;
+    }
+
+    quint64 resultSize = 0;
+    {
+        QDataStream stream(patchData.mid(PATCH_MAGIC_LENGTH, 8));
+        stream >> resultSize;
+    }
+    const QByteArray commands = qUncompress(patchData.mid(PATCH_MAGIC_LENGTH + 8));
+    if (commands.isEmpty())
+    {
+        outError = "can't uncompress the patch";
+        return false;
+    }
+
+    QFile baseFile(basePath);
+    if (!baseFile.open(QIODevice::ReadOnly))
+    {
+        outError = "can't open the base file";
+        return false;
+    }
+    const qint64 baseSize = baseFile.size();
+    const uchar *base = baseFile.map(0, baseSize);
+    if (!base && baseSize > 0)
+    {
+        outError = "can't map the base file";
+        return false;
+    }
+
+    QFile outFile(outPath);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        outError = "can't open the output file";
+        return false;
+    }
+
+    QDataStream stream(commands);
+    quint64 written = 0;
+    while (!stream.atEnd())
+    {
+        quint8 command;
+        stream >> command;
+        if (command == COMMAND_COPY)
+        {
+            quint64 offset;
+            quint32 length;
+            stream >> offset >> length;
+            if (stream.status() != QDataStream::Ok || offset > static_cast<quint64>(baseSize) || length > baseSize - offset)
+            {
+                outError = "incorrect copy command";
+                return false;
+            }
+            if (outFile.write(reinterpret_cast<const char *>(base + offset), length) != length)
+            {
+                outError = "can't write the output file";
+                return false;
+            }
+            written += length;
+        }
+        else if (command == COMMAND_INSERT)
+        {
+            QByteArray data;
+            stream >> data;
+            if (stream.status() != QDataStream::Ok || outFile.write(data) != data.size())
+            {
+                outError = "incorrect insert command";
+                return false;
+            }
+            written += data.size();
+        }
+        else
+        {
+            outError = "unknown command";
+            return false;
+        }
+    }
+
+    if (written != resultSize)
+    {
+        outError = "incorrect size of the result";
+        return false;
+    }
+    return outFile.flush();
+}
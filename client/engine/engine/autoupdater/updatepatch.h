@@ -0,0 +1,17 @@
+#ifndef UPDATEPATCH_H
+#define UPDATEPATCH_H
+
+#include <QString>
+
+// Binary patch of the installer against the installer of the installed version (made by tools/make_update_patch.py).
+// Format: the magic "WSPATCH1", the size of the result (quint64), then the commands compressed by qCompress:
+//   quint8 0 (copy), quint64 offset, quint32 length - the bytes from the base file
+//   quint8 1 (insert), quint32 length, the bytes - the new bytes
+// All the numbers are big-endian (QDataStream). The result is verified by the caller with the installer's hash.
+class UpdatePatch
+{
+public:
+    static bool apply(const QString &basePath, const QString &patchPath, const QString &outPath, QString &outError);
+};
+
+#endif // UPDATEPATCH_H
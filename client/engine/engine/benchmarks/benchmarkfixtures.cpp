@@ -0,0 +1,163 @@
+#include "benchmarkfixtures.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace BenchmarkFixtures {
+
+namespace {
+
+QString ipForIndex(int base, int ind)
+{
+    return QString("%1.%2.%3.%4").arg(base).arg((ind >> 16) & 0xFF).arg((ind >> 8) & 0xFF).arg(ind & 0xFF);
+}
+
+} // namespace
+
+QByteArray serverLocationsJson(int locationsCount, int groupsPerLocation, int nodesPerGroup)
+{
+    QJsonArray data;
+    int groupId = 0;
+    int nodeInd = 0;
+    for (int l = 0; l < locationsCount; ++l)
+    {
+        QJsonArray groups;
+        for (int g = 0; g < groupsPerLocation; ++g)
+        {
+            QJsonArray nodes;
+            for (int n = 0; n < nodesPerGroup; ++n)
+            {
+                QJsonObject node;
+                node["ip"] = ipForIndex(10, nodeInd);
+                node["ip2"] = ipForIndex(11, nodeInd);
+                node["ip3"] = ipForIndex(12, nodeInd);
+                node["hostname"] = QString("node-%1.windscribe.com").arg(nodeInd);
+                node["weight"] = 1 + (nodeInd % 10);
+                // a few nodes are being removed from the rotation, as in the real list
+                if (nodeInd % 97 == 0)
+                {
+                    node["force_disconnect"] = 1;
+                }
+                nodes.append(node);
+                nodeInd++;
+            }
+
+            QJsonObject group;
+            group["id"] = groupId;
+            group["city"] = QString("City %1").arg(groupId);
+            group["nick"] = QString("Nick %1").arg(groupId);
+            group["pro"] = (g % 2);
+            group["ping_ip"] = ipForIndex(13, groupId);
+            group["wg_pubkey"] = QString("pubkey%1abcdefghijklmnopqrstuvwxyz0123456789=").arg(groupId);
+            group["ovpn_x509"] = QString("group-%1.windscribe.com").arg(groupId);
+            group["link_speed"] = QString::number(groupId % 3 == 0 ? 10000 : 1000);
+            group["health"] = groupId % 100;
+            group["nodes"] = nodes;
+            groups.append(group);
+            groupId++;
+        }
+
+        QJsonObject location;
+        location["id"] = l + 1;
+        location["name"] = QString("Location %1").arg(l);
+        location["country_code"] = QString("%1%2").arg(QChar('A' + (l / 26) % 26)).arg(QChar('A' + l % 26));
+        location["premium_only"] = (l % 5 == 0) ? 1 : 0;
+        location["p2p"] = 1;
+        location["dns_hostname"] = QString("location-%1.windscribe.com").arg(l);
+        location["groups"] = groups;
+        data.append(location);
+    }
+
+    QJsonObject info;
+    info["revision"] = 1;
+    info["revision_hash"] = "0123456789abcdef0123456789abcdef01234567";
+    info["changed"] = 1;
+    info["fc"] = 0;
+
+    QJsonObject root;
+    root["info"] = info;
+    root["data"] = data;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QString ovpnConfig()
+{
+    QString config = "client\r\n"
+                     "dev tun\r\n"
+                     "resolv-retry infinite\r\n"
+                     "nobind\r\n"
+                     "persist-key\r\n"
+                     "persist-tun\r\n"
+                     "remote-cert-tls server\r\n"
+                     "auth-user-pass\r\n"
+                     "cipher AES-256-GCM\r\n"
+                     "auth SHA512\r\n"
+                     "verb 2\r\n"
+                     "mute-replay-warnings\r\n"
+                     "reneg-sec 432000\r\n"
+                     "key-direction 1\r\n";
+
+    // the certificate and the tls-auth key, of the real size
+    config += "<ca>\r\n-----BEGIN CERTIFICATE-----\r\n";
+    for (int i = 0; i < 30; ++i)
+    {
+        config += QString(64, QChar('A' + i % 26)) + "\r\n";
+    }
+    config += "-----END CERTIFICATE-----\r\n</ca>\r\n";
+    config += "<tls-auth>\r\n-----BEGIN OpenVPN Static key V1-----\r\n";
+    for (int i = 0; i < 16; ++i)
+    {
+        config += QString(32, QChar('a' + i % 6)) + "\r\n";
+    }
+    config += "-----END OpenVPN Static key V1-----\r\n</tls-auth>\r\n";
+    return config;
+}
+
+QByteArray logFile(int linesCount, qint64 startMs, int stepMs, const QString &prefix)
+{
+    QByteArray result;
+    result.reserve(linesCount * 80);
+    for (int i = 0; i < linesCount; ++i)
+    {
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(startMs + qint64(i) * stepMs, Qt::UTC);
+        result += "[" + time.toString("ddMMyy hh:mm:ss:zzz").toLatin1() + "]\t ";
+        result += prefix.toLatin1();
+        result += " message number " + QByteArray::number(i) + ", some payload of the usual length\n";
+    }
+    return result;
+}
+
+QByteArray httpProxyRequest(int headersCount)
+{
+    QByteArray result = "GET http://www.example.com/path/to/page.html?query=value&other=1 HTTP/1.1\r\n"
+                        "Host: www.example.com\r\n"
+                        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36\r\n"
+                        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                        "Proxy-Connection: keep-alive\r\n";
+    for (int i = 0; i < headersCount; ++i)
+    {
+        result += "X-Custom-Header-" + QByteArray::number(i) + ": value " + QByteArray::number(i) +
+                  " of the header with some text\r\n";
+    }
+    result += "\r\n";
+    return result;
+}
+
+QByteArray httpProxyWebAnswer(int headersCount)
+{
+    QByteArray result = "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/html; charset=UTF-8\r\n"
+                        "Content-Length: 65536\r\n"
+                        "Cache-Control: max-age=604800\r\n";
+    for (int i = 0; i < headersCount; ++i)
+    {
+        result += "X-Custom-Header-" + QByteArray::number(i) + ": value " + QByteArray::number(i) +
+                  " of the header with some text\r\n";
+    }
+    result += "\r\n";
+    return result;
+}
+
+} // namespace BenchmarkFixtures
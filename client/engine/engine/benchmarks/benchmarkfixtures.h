@@ -0,0 +1,33 @@
+#ifndef BENCHMARKFIXTURES_H
+#define BENCHMARKFIXTURES_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// Canned data for the benchmarks, generated deterministically so the runs of different releases are comparable.
+// The default sizes are close to the production server list: ~100 locations, ~4 groups (cities) per location
+// and ~8 nodes per group.
+namespace BenchmarkFixtures {
+
+constexpr int LOCATIONS_COUNT = 100;
+constexpr int GROUPS_PER_LOCATION = 4;
+constexpr int NODES_PER_GROUP = 8;
+
+// the ServerLocations answer: {"info": {...}, "data": [{location}, ...]}
+QByteArray serverLocationsJson(int locationsCount = LOCATIONS_COUNT, int groupsPerLocation = GROUPS_PER_LOCATION,
+                               int nodesPerGroup = NODES_PER_GROUP);
+
+// the OpenVPN config as returned by the ServerConfigs request
+QString ovpnConfig();
+
+// the log lines "[ddMMyy hh:mm:ss:zzz] text", sorted by time; the files are interleaved when startMs differ
+QByteArray logFile(int linesCount, qint64 startMs, int stepMs, const QString &prefix);
+
+// the request of a browser to the HTTP proxy and the answer of a web server, with the given number of extra headers
+QByteArray httpProxyRequest(int headersCount);
+QByteArray httpProxyWebAnswer(int headersCount);
+
+} // namespace BenchmarkFixtures
+
+#endif // BENCHMARKFIXTURES_H
@@ -0,0 +1,122 @@
+QT += core gui network svg widgets testlib
+
+TEMPLATE = app
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+TARGET = enginebenchmarks
+
+DEFINES += QT_MESSAGELOGCONTEXT
+
+COMMON_PATH = $$PWD/../../../../common
+BUILD_LIBS_PATH = $$PWD/../../../../build-libs
+
+INCLUDEPATH += $$COMMON_PATH
+
+# benchServerLocationsReplay replays the recorded answers (engine/tests/networkrecorder.h)
+CONFIG += network_recorder
+
+# the libraries of the engine, the same as in client.pro
+win32 {
+    DEFINES += "WINVER=0x0601"
+    DEFINES += "_WIN32_WINNT=0x0601"
+    DEFINES += "PIO_APC_ROUTINE_DEFINED"
+
+    LIBS += Ws2_32.lib Advapi32.lib Iphlpapi.lib \
+    Wininet.lib User32.lib Sensapi.lib Dnsapi.lib \
+    Ole32.lib Shlwapi.lib Version.lib Psapi.lib \
+    rasapi32.lib Pdh.lib Shell32.lib netapi32.lib msi.lib
+
+    CONFIG(release, debug|release){
+        INCLUDEPATH += $$BUILD_LIBS_PATH/protobuf/release/include
+        LIBS += -L$$BUILD_LIBS_PATH/protobuf/release/lib -llibprotobuf
+    }
+    CONFIG(debug, debug|release){
+        INCLUDEPATH += $$BUILD_LIBS_PATH/protobuf/debug/include
+        LIBS += -L$$BUILD_LIBS_PATH/protobuf/debug/lib -llibprotobufd
+    }
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/boost/include
+    LIBS += -L"$$BUILD_LIBS_PATH/boost/lib"
+
+    INCLUDEPATH += "$$BUILD_LIBS_PATH/curl/include"
+    LIBS += -L"$$BUILD_LIBS_PATH/curl/lib" -llibcurl
+
+    INCLUDEPATH += "$$BUILD_LIBS_PATH/cares/dll_x32/include"
+    LIBS += -L"$$BUILD_LIBS_PATH/cares/dll_x32/lib" -lcares
+
+    INCLUDEPATH += "$$BUILD_LIBS_PATH/openssl/include"
+    LIBS += -L"$$BUILD_LIBS_PATH/openssl/lib" -llibeay32 -lssleay32
+
+    # Supress protobuf linker warnings
+    QMAKE_LFLAGS += /IGNORE:4099
+
+    QMAKE_CXXFLAGS_RELEASE -= -Zc:strictStrings
+    QMAKE_CFLAGS_RELEASE -= -Zc:strictStrings
+    QMAKE_CFLAGS -= -Zc:strictStrings
+    QMAKE_CXXFLAGS -= -Zc:strictStrings
+} # win32
+
+macx {
+    LIBS += -framework Foundation
+    LIBS += -framework AppKit
+    LIBS += -framework CoreFoundation
+    LIBS += -framework CoreServices
+    LIBS += -framework Security
+    LIBS += -framework SystemConfiguration
+    LIBS += -framework ServiceManagement
+    LIBS += -framework ApplicationServices
+    LIBS += -framework NetworkExtension
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/protobuf/include
+    LIBS += -L$$BUILD_LIBS_PATH/protobuf/lib -lprotobuf
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/boost/include
+    LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_serialization.a
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/openssl/include
+    LIBS += -L$$BUILD_LIBS_PATH/openssl/lib -lssl -lcrypto
+    INCLUDEPATH += $$BUILD_LIBS_PATH/curl/include
+    LIBS += -L$$BUILD_LIBS_PATH/curl/lib/ -lcurl
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/cares/include
+    LIBS += -L$$BUILD_LIBS_PATH/cares/lib -lcares
+
+    QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-deprecated-declarations
+    QMAKE_MACOSX_DEPLOYMENT_TARGET = 10.11
+} # macx
+
+linux {
+    QMAKE_CXXFLAGS_WARN_ON += -Wno-deprecated-copy
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/protobuf/include
+    LIBS += -L$$BUILD_LIBS_PATH/protobuf/lib -lprotobuf
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/openssl/include
+    LIBS += -L$$BUILD_LIBS_PATH/openssl/lib -lssl -lcrypto
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/curl/include
+    LIBS += -L$$BUILD_LIBS_PATH/curl/lib/ -lcurl
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/cares/include
+    LIBS += -L$$BUILD_LIBS_PATH/cares/lib -lcares
+
+    INCLUDEPATH += $$BUILD_LIBS_PATH/boost/include
+    LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_filesystem.a
+    LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_serialization.a
+} # linux
+
+SOURCES += \
+    main.cpp \
+    benchmarkfixtures.cpp \
+    tst_enginebenchmarks.cpp
+
+HEADERS += \
+    benchmarkfixtures.h \
+    tst_enginebenchmarks.h
+
+include(../../../common.pri)
+include(../../engine.pri)
+
+exists($$COMMON_PATH/utils/hardcodedsecrets.ini) {
+    RESOURCES += $$PWD/../../../secrets.qrc
+}
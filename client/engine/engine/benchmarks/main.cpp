@@ -0,0 +1,106 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QXmlStreamReader>
+#include "tst_enginebenchmarks.h"
+#include "version/windscribe_version.h"
+
+// Usage: enginebenchmarks [-json <file>] [QtTest options]
+// With -json the results are also written as JSON to track the regressions across releases:
+// {"version": "2.4.11", "timestamp": "...", "results": [{"name", "tag", "metric", "value", "iterations"}, ...]},
+// where value is per iteration, in the units of the metric.
+
+namespace {
+
+bool convertResultsToJson(const QString &xmlFilename, const QString &jsonFilename)
+{
+    QFile xmlFile(xmlFilename);
+    if (!xmlFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QJsonArray results;
+    QString functionName;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd())
+    {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+        {
+            continue;
+        }
+        if (xml.name() == QLatin1String("TestFunction"))
+        {
+            functionName = xml.attributes().value("name").toString();
+        }
+        else if (xml.name() == QLatin1String("BenchmarkResult"))
+        {
+            // the value of the XML log is the total of all iterations
+            const int iterations = xml.attributes().value("iterations").toInt();
+            QJsonObject result;
+            result["name"] = functionName;
+            result["tag"] = xml.attributes().value("tag").toString();
+            result["metric"] = xml.attributes().value("metric").toString();
+            result["value"] = iterations > 0 ? xml.attributes().value("value").toDouble() / iterations : 0.0;
+            result["iterations"] = iterations;
+            results.append(result);
+        }
+    }
+    if (xml.hasError())
+    {
+        return false;
+    }
+
+    QJsonObject root;
+    root["version"] = QString(WINDSCRIBE_VERSION_STR);
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = results;
+
+    QFile jsonFile(jsonFilename);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // keep the settings and the data files of the benchmarks apart from the installed application
+    app.setOrganizationName("WindscribeBenchmarks");
+    app.setApplicationName("WindscribeEngineBenchmarks");
+    QStandardPaths::setTestModeEnabled(true);
+
+    QStringList args = app.arguments();
+    QString jsonFilename;
+    const int jsonInd = args.indexOf("-json");
+    if (jsonInd != -1 && jsonInd + 1 < args.size())
+    {
+        jsonFilename = args[jsonInd + 1];
+        args.removeAt(jsonInd + 1);
+        args.removeAt(jsonInd);
+    }
+
+    QTemporaryDir tempDir;
+    const QString xmlFilename = tempDir.filePath("results.xml");
+    if (!jsonFilename.isEmpty())
+    {
+        args << "-o" << "-,txt" << "-o" << xmlFilename + ",xml";
+    }
+
+    BenchmarkEngine benchmarkEngine;
+    int status = QTest::qExec(&benchmarkEngine, args);
+
+    if (!jsonFilename.isEmpty() && !convertResultsToJson(xmlFilename, jsonFilename))
+    {
+        qWarning() << "Can't write the results to" << jsonFilename;
+        status |= 1;
+    }
+    return status;
+}
@@ -0,0 +1,436 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "tst_enginebenchmarks.h"
+#include "benchmarkfixtures.h"
+#include "engine/apiinfo/apiinfo.h"
+#include "engine/apiinfo/apiinfosnapshot.h"
+#include "engine/apiinfo/locationsarena.h"
+#include "engine/connectionmanager/makeovpnfile.h"
+#include "engine/locationsmodel/locationnode.h"
+#include "engine/locationsmodel/nodeselectionalgorithm.h"
+#include "engine/networkaccessmanager/dnscache2.h"
+#include "engine/serverapi/curlnetworkmanager.h"
+#include "engine/serverapi/locationsjsonstreamparser.h"
+#include "engine/tests/networkrecorder.h"
+#include "engine/vpnshare/httpproxyserver/httpproxyrequestparser.h"
+#include "engine/vpnshare/httpproxyserver/httpproxywebanswerparser.h"
+#include "engine/vpnshare/socksproxyserver/socksproxycommandparser.h"
+#include "engine/vpnshare/socksproxyserver/socksproxyidentreqparser.h"
+#include "ipc/connection.h"
+#include "ipc/protobufcommand.h"
+#include "ipc/server.h"
+#include "utils/clean_sensitive_info.h"
+#include "utils/mergelog.h"
+#include "utils/settingsstore.h"
+
+namespace {
+
+// the size of the chunks passed by curl to the write callback
+constexpr int CURL_CHUNK_SIZE = 16 * 1024;
+constexpr int IPC_COMMANDS_COUNT = 1000;
+constexpr int LOG_LINES_COUNT = 20000;
+// the parsers are created per connection, so one iteration is this many connections
+constexpr int PARSES_COUNT = 1000;
+
+void writeFile(const QString &filename, const QByteArray &data)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(data), qint64(data.size()));
+}
+
+QVector< QSharedPointer<const locationsmodel::BaseNode> > makeNodes(int count)
+{
+    QVector< QSharedPointer<const locationsmodel::BaseNode> > nodes;
+    for (int i = 0; i < count; ++i)
+    {
+        const QString ip = QString("10.0.%1.%2").arg(i / 256).arg(i % 256);
+        nodes << QSharedPointer<const locationsmodel::BaseNode>(new locationsmodel::ApiLocationNode(
+                     QStringList() << ip << ip << ip, QString("node-%1.windscribe.com").arg(i), 1 + i % 10, QString()));
+    }
+    return nodes;
+}
+
+// not ApiInfo::removeFromSettings(), it also removes the auth hash from the settings of the app ver1
+void removeApiInfo()
+{
+    apiinfo::ApiInfoSnapshot::remove();
+    SettingsStore::instance().remove("apiInfo");
+    SettingsStore::instance().remove("revisionHash");
+}
+
+} // namespace
+
+BenchmarkEngine::BenchmarkEngine()
+{
+}
+
+BenchmarkEngine::~BenchmarkEngine()
+{
+}
+
+void BenchmarkEngine::initTestCase()
+{
+    QVERIFY(tempDir_.isValid());
+    locationsJson_ = BenchmarkFixtures::serverLocationsJson();
+
+    LocationsJsonStreamParser parser;
+    parser.addData(locationsJson_.constData(), locationsJson_.size());
+    QVERIFY(parser.isCompleted());
+    locations_ = parser.locations();
+    QCOMPARE(locations_.size(), BenchmarkFixtures::LOCATIONS_COUNT);
+}
+
+void BenchmarkEngine::benchServerLocationsStreamParse()
+{
+    QBENCHMARK {
+        LocationsJsonStreamParser parser;
+        for (int pos = 0; pos < locationsJson_.size(); pos += CURL_CHUNK_SIZE)
+        {
+            parser.addData(locationsJson_.constData() + pos, qMin(CURL_CHUNK_SIZE, locationsJson_.size() - pos));
+        }
+        QVERIFY(parser.isCompleted());
+    }
+}
+
+void BenchmarkEngine::benchServerLocationsDocumentParse()
+{
+    // the whole answer through QJsonDocument, for comparison with the streaming parser
+    QBENCHMARK {
+        const QJsonDocument doc = QJsonDocument::fromJson(locationsJson_);
+        const QJsonArray data = doc.object()["data"].toArray();
+        QVector<apiinfo::Location> locations;
+        QStringList forceDisconnectNodes;
+        for (const QJsonValue &value : data)
+        {
+            apiinfo::Location location;
+            QVERIFY(location.initFromJson(value.toObject(), forceDisconnectNodes));
+            locations << location;
+        }
+    }
+}
+
+void BenchmarkEngine::benchServerLocationsReplay()
+{
+    // the ServerLocations answer through CurlNetworkManager replayed by NetworkRecorder, without the recorded latency
+    const QString url = "https://api.windscribe.com/ServerLocations?session_auth_hash=hash&time=0";
+    const QString filename = tempDir_.filePath("network_record.txt");
+    QFile::remove(filename);
+    QVERIFY(NetworkRecorder::instance().startRecord(filename));
+    NetworkRecorder::ApiAnswer answer;
+    answer.httpCode = 200;
+    answer.body = locationsJson_;
+    NetworkRecorder::instance().recordApi(NetworkRecorder::apiKey("GET", url), answer);
+    QVERIFY(NetworkRecorder::instance().startReplay(filename, 0, 0));
+
+    CurlNetworkManager curlNetworkManager;
+    QBENCHMARK {
+        CurlRequest curlRequest;
+        curlRequest.setGetData(url);
+        curlRequest.setAnswerStreamFactory([]() { return new LocationsJsonStreamParser(); });
+        QSignalSpy spy(&curlNetworkManager, SIGNAL(finished(CurlRequest*)));
+        curlNetworkManager.get(&curlRequest, 5000, "api.windscribe.com", QStringList());
+        QVERIFY(spy.wait(10000));
+        QCOMPARE(curlRequest.getCurlRetCode(), CURLE_OK);
+        QVERIFY(static_cast<LocationsJsonStreamParser *>(curlRequest.getAnswerStream().data())->isCompleted());
+    }
+    NetworkRecorder::instance().stop();
+}
+
+void BenchmarkEngine::benchApiInfoSave()
+{
+    apiinfo::ApiInfo apiInfo;
+    apiInfo.setLocations(locations_);
+    apiInfo.setOvpnConfig(BenchmarkFixtures::ovpnConfig());
+
+    QBENCHMARK {
+        apiInfo.saveToSettings();
+    }
+    removeApiInfo();
+}
+
+void BenchmarkEngine::benchApiInfoLoad()
+{
+    {
+        apiinfo::ApiInfo apiInfo;
+        apiInfo.setLocations(locations_);
+        apiInfo.setOvpnConfig(BenchmarkFixtures::ovpnConfig());
+        apiInfo.saveToSettings();
+    }
+
+    QBENCHMARK {
+        apiinfo::ApiInfo apiInfo;
+        QVERIFY(apiInfo.loadFromSettings());
+    }
+    removeApiInfo();
+}
+
+void BenchmarkEngine::benchLocationsArenaRebuild()
+{
+    // the part of ApiLocationsModel::setLocations that depends on the size of the list
+    QBENCHMARK {
+        apiinfo::LocationsArena arena(locations_);
+        QCOMPARE(arena.locationsCount(), locations_.size());
+    }
+}
+
+void BenchmarkEngine::benchNodeSelectionRandom()
+{
+    const QVector< QSharedPointer<const locationsmodel::BaseNode> > nodes = makeNodes(BenchmarkFixtures::NODES_PER_GROUP * 4);
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+        {
+            locationsmodel::NodeSelectionAlgorithm::selectRandomNodeBasedOnWeight(nodes);
+        }
+    }
+}
+
+void BenchmarkEngine::benchNodeSelectionRendezvous()
+{
+    const QVector< QSharedPointer<const locationsmodel::BaseNode> > nodes = makeNodes(BenchmarkFixtures::NODES_PER_GROUP * 4);
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i)
+        {
+            locationsmodel::NodeSelectionAlgorithm::getNodesOrder(nodes, QString("device-%1").arg(i));
+        }
+    }
+}
+
+void BenchmarkEngine::benchDnsCacheLookup()
+{
+    DnsCache2 dnsCache(NULL);
+    int resolvedCount = 0;
+    bool isLastSuccess = false;
+    connect(&dnsCache, &DnsCache2::resolved, [&](bool success, const QStringList &, quint64, bool, int) {
+        resolvedCount++;
+        isLastSuccess = success;
+    });
+
+    // the first request goes to the resolver, the rest are answered from the cache
+    dnsCache.resolve("localhost", 0);
+    QTRY_COMPARE_WITH_TIMEOUT(resolvedCount, 1, 10000);
+    dnsCache.notifyFinished(0);
+    if (!isLastSuccess)
+    {
+        QSKIP("localhost is not resolved, the cache can't be filled");
+    }
+
+    quint64 id = 1;
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+        {
+            dnsCache.resolve("localhost", id);
+            dnsCache.notifyFinished(id);
+            id++;
+        }
+    }
+}
+
+void BenchmarkEngine::benchIpcConnectionFraming()
+{
+    IPC::Server server;
+    if (!server.start())
+    {
+        QSKIP("the IPC server can't be started, is the application running?");
+    }
+
+    IPC::Connection *serverConnection = NULL;
+    connect(&server, &IPC::Server::newConnection, [&](IPC::IConnection *connection) {
+        serverConnection = dynamic_cast<IPC::Connection *>(connection);
+    });
+
+    IPC::Connection clientConnection;
+    int state = -1;
+    connect(&clientConnection, &IPC::Connection::stateChanged, [&](int newState, IPC::IConnection *) {
+        state = newState;
+    });
+    clientConnection.connect();
+    QTRY_COMPARE_WITH_TIMEOUT(state, IPC::CONNECTION_CONNECTED, 10000);
+    QTRY_VERIFY_WITH_TIMEOUT(serverConnection != NULL, 10000);
+
+    int receivedCount = 0;
+    connect(serverConnection, &IPC::Connection::newCommand, [&](IPC::Command *cmd, IPC::IConnection *) {
+        delete cmd;
+        receivedCount++;
+    });
+
+    IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> cmd;
+    cmd.getProtoObj().set_bytes_in(1234567);
+    cmd.getProtoObj().set_bytes_out(7654321);
+
+    QBENCHMARK {
+        receivedCount = 0;
+        for (int i = 0; i < IPC_COMMANDS_COUNT; ++i)
+        {
+            clientConnection.sendCommand(cmd);
+        }
+        // QTRY_* would add its polling interval to the measured time
+        QDeadlineTimer deadline(10000);
+        while (receivedCount < IPC_COMMANDS_COUNT && !deadline.hasExpired())
+        {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 100);
+        }
+        QCOMPARE(receivedCount, IPC_COMMANDS_COUNT);
+    }
+
+    clientConnection.close();
+    delete serverConnection;
+}
+
+void BenchmarkEngine::benchMergeLog()
+{
+    const QString guiLog = tempDir_.filePath("log_gui.txt");
+    const QString serviceLog = tempDir_.filePath("windscribeservice.log");
+    const QString servicePrevLog = tempDir_.filePath("windscribeservice_prev.log");
+    const QString wireguardLog = tempDir_.filePath("WireguardServiceLog.txt");
+    const qint64 startMs = QDateTime::currentMSecsSinceEpoch() - qint64(LOG_LINES_COUNT) * 100;
+    writeFile(guiLog, BenchmarkFixtures::logFile(LOG_LINES_COUNT, startMs, 100, "gui"));
+    writeFile(serviceLog, BenchmarkFixtures::logFile(LOG_LINES_COUNT, startMs + 30, 100, "service"));
+    writeFile(servicePrevLog, BenchmarkFixtures::logFile(LOG_LINES_COUNT / 4, startMs - 100000, 100, "service prev"));
+    writeFile(wireguardLog, BenchmarkFixtures::logFile(LOG_LINES_COUNT / 4, startMs + 60, 400, "wireguard"));
+
+    QBENCHMARK {
+        const QString result = MergeLog::merge(guiLog, serviceLog, servicePrevLog, wireguardLog, true);
+        QVERIFY(!result.isEmpty());
+    }
+}
+
+void BenchmarkEngine::benchCleanSensitiveInfo()
+{
+    // the merged log of the debug log upload, every 16th line has a path under the home directory
+    const QString home = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+    const QString lines = QString::fromLatin1(BenchmarkFixtures::logFile(LOG_LINES_COUNT, 0, 100, "gui"));
+    QString log;
+    log.reserve(lines.size() + LOG_LINES_COUNT / 16 * (home.size() + 32));
+    int i = 0;
+    for (const QStringRef &line : lines.splitRef('\n', QString::SkipEmptyParts))
+    {
+        log += line;
+        if (i++ % 16 == 0)
+        {
+            log += " " + home + "/AppData/Local/Windscribe";
+        }
+        log += '\n';
+    }
+
+    QBENCHMARK {
+        const QString result = Utils::cleanSensitiveInfo(log);
+        QVERIFY(home.isEmpty() || !result.contains(home));
+    }
+}
+
+void BenchmarkEngine::benchMakeOvpnFile()
+{
+    const QString config = BenchmarkFixtures::ovpnConfig();
+    MakeOVPNFile makeOvpnFile;
+
+    // the retries with the other nodes of the location, the base part of the config is the same
+    int i = 0;
+    QBENCHMARK {
+        const QString ip = QString("10.0.%1.%2").arg((i / 256) % 256).arg(i % 256);
+        QVERIFY(makeOvpnFile.generate(config, ip, ProtocolType(ProtocolType::PROTOCOL_OPENVPN_UDP), 443, 0, 0,
+                                      QString(), "node.windscribe.com"));
+        i++;
+    }
+}
+
+// the parser benchmarks go together with the corpus harness in vpnshare/parserfuzz, which checks the correctness
+void BenchmarkEngine::benchHttpProxyRequestParser_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("connect") << QByteArray("CONNECT www.example.com:443 HTTP/1.1\r\nHost: www.example.com:443\r\n\r\n") << 0;
+    QTest::newRow("get") << BenchmarkFixtures::httpProxyRequest(0) << 0;
+    QTest::newRow("get, 30 headers") << BenchmarkFixtures::httpProxyRequest(30) << 0;
+    QTest::newRow("get, 30 headers, chunks of 64") << BenchmarkFixtures::httpProxyRequest(30) << 64;
+}
+
+void BenchmarkEngine::benchHttpProxyRequestParser()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(int, chunkSize);
+    const int step = chunkSize > 0 ? chunkSize : request.size();
+
+    QBENCHMARK {
+        for (int i = 0; i < PARSES_COUNT; ++i)
+        {
+            HttpProxyServer::HttpProxyRequestParser parser;
+            HttpProxyServer::TRI_BOOL res = HttpProxyServer::TRI_INDETERMINATE;
+            for (int pos = 0; pos < request.size() && res == HttpProxyServer::TRI_INDETERMINATE; pos += step)
+            {
+                quint32 parsed;
+                res = parser.parse(QByteArray::fromRawData(request.constData() + pos, qMin(step, request.size() - pos)), parsed);
+            }
+            QCOMPARE(res, HttpProxyServer::TRI_TRUE);
+        }
+    }
+}
+
+void BenchmarkEngine::benchHttpProxyWebAnswerParser_data()
+{
+    QTest::addColumn<QByteArray>("answer");
+
+    QTest::newRow("connection established") << QByteArray("HTTP/1.1 200 Connection established\r\n\r\n");
+    QTest::newRow("ok") << BenchmarkFixtures::httpProxyWebAnswer(0);
+    QTest::newRow("ok, 30 headers") << BenchmarkFixtures::httpProxyWebAnswer(30);
+}
+
+void BenchmarkEngine::benchHttpProxyWebAnswerParser()
+{
+    QFETCH(QByteArray, answer);
+
+    QBENCHMARK {
+        for (int i = 0; i < PARSES_COUNT; ++i)
+        {
+            HttpProxyServer::HttpProxyWebAnswerParser parser;
+            quint32 parsed;
+            QCOMPARE(parser.parse(answer, parsed), HttpProxyServer::TRI_TRUE);
+        }
+    }
+}
+
+void BenchmarkEngine::benchSocksProxyCommandParser_data()
+{
+    QTest::addColumn<QByteArray>("command");
+
+    // CONNECT to port 443
+    QTest::newRow("ipv4") << QByteArray("\x05\x01\x00\x01\x7F\x00\x00\x01\x01\xBB", 10);
+    QTest::newRow("ipv6") << (QByteArray("\x05\x01\x00\x04", 4) + QByteArray(16, '\x01') + QByteArray("\x01\xBB", 2));
+    QTest::newRow("domain") << (QByteArray("\x05\x01\x00\x03\x0F", 5) + "www.example.com" + QByteArray("\x01\xBB", 2));
+}
+
+void BenchmarkEngine::benchSocksProxyCommandParser()
+{
+    QFETCH(QByteArray, command);
+
+    QBENCHMARK {
+        for (int i = 0; i < PARSES_COUNT; ++i)
+        {
+            SocksProxyServer::SocksProxyCommandParser parser;
+            quint32 parsed;
+            QCOMPARE(parser.parse(command, parsed), SocksProxyServer::TRI_TRUE);
+        }
+    }
+}
+
+void BenchmarkEngine::benchSocksProxyIdentReqParser()
+{
+    // version 5, no authentication and username/password
+    const QByteArray identReq("\x05\x02\x00\x02", 4);
+
+    QBENCHMARK {
+        for (int i = 0; i < PARSES_COUNT; ++i)
+        {
+            SocksProxyServer::SocksProxyIdentReqParser parser;
+            quint32 parsed;
+            QVERIFY(parser.parse(identReq, parsed));
+        }
+    }
+}
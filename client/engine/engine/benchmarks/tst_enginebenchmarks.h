@@ -0,0 +1,50 @@
+#ifndef TESTENGINEBENCHMARKS_H
+#define TESTENGINEBENCHMARKS_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QVector>
+#include "engine/apiinfo/location.h"
+
+// QBENCHMARK measurements of the engine hot paths on the canned data from BenchmarkFixtures
+class BenchmarkEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchmarkEngine();
+    ~BenchmarkEngine();
+
+private slots:
+    void initTestCase();
+
+    void benchServerLocationsStreamParse();
+    void benchServerLocationsDocumentParse();
+    void benchServerLocationsReplay();
+    void benchApiInfoSave();
+    void benchApiInfoLoad();
+    void benchLocationsArenaRebuild();
+    void benchNodeSelectionRandom();
+    void benchNodeSelectionRendezvous();
+    void benchDnsCacheLookup();
+    void benchIpcConnectionFraming();
+    void benchMergeLog();
+    void benchCleanSensitiveInfo();
+    void benchMakeOvpnFile();
+    void benchHttpProxyRequestParser_data();
+    void benchHttpProxyRequestParser();
+    void benchHttpProxyWebAnswerParser_data();
+    void benchHttpProxyWebAnswerParser();
+    void benchSocksProxyCommandParser_data();
+    void benchSocksProxyCommandParser();
+    void benchSocksProxyIdentReqParser();
+
+private:
+    QByteArray locationsJson_;
+    QVector<apiinfo::Location> locations_;
+    QTemporaryDir tempDir_;
+};
+
+
+#endif // TESTENGINEBENCHMARKS_H
@@ -19,6 +19,8 @@
 #include "connsettingspolicy/autoconnsettingspolicy.h"
 #include "connsettingspolicy/manualconnsettingspolicy.h"
 #include "connsettingspolicy/customconfigconnsettingspolicy.h"
+#include "engine/wireguardconfig/wireguardconnectcache.h"
+#include "engine/locationsmodel/nodehealth.h"
 
 
 // Had to move this here to prevent a compile error with boost already including winsock.h
@@ -56,13 +58,19 @@ ConnectionManager::ConnectionManager(QObject *parent, IHelper *helper, INetworkD
     makeOVPNFile_(NULL),
     makeOVPNFileFromCustom_(NULL),
     testVPNTunnel_(NULL),
+    connectionRacer_(NULL),
+    bRaceDone_(false),
+    nodeRacer_(NULL),
+    bNodeRaceDone_(false),
     bNeedResetTap_(false),
     bIgnoreConnectionErrorsForOpenVpn_(false),
     bWasSuccessfullyConnectionAttempt_(false),
     state_(STATE_DISCONNECTED),
-    bLastIsOnline_(true),
     bWakeSignalReceived_(false),
-    currentConnectionDescr_()
+    bRoaming_(false),
+    bRoamOnNetworkUp_(false),
+    currentConnectionDescr_(),
+    isApplicationActive_(true)
 {
     connect(&timerReconnection_, SIGNAL(timeout()), SLOT(onTimerReconnection()));
 
@@ -76,6 +84,11 @@ ConnectionManager::ConnectionManager(QObject *parent, IHelper *helper, INetworkD
     testVPNTunnel_ = new TestVPNTunnel(this, serverAPI);
     connect(testVPNTunnel_, SIGNAL(testsFinished(bool, QString)), SLOT(onTunnelTestsFinished(bool, QString)));
 
+    connectionRacer_ = new ConnectionRacer(this);
+    connect(connectionRacer_, SIGNAL(finished(int)), SLOT(onConnectionRaceFinished(int)));
+    nodeRacer_ = new ConnectionRacer(this);
+    connect(nodeRacer_, SIGNAL(finished(int)), SLOT(onNodeRaceFinished(int)));
+
     makeOVPNFile_ = new MakeOVPNFile();
     makeOVPNFileFromCustom_ = new MakeOVPNFileFromCustom();
 
@@ -96,6 +109,18 @@ ConnectionManager::ConnectionManager(QObject *parent, IHelper *helper, INetworkD
 
     getWireGuardConfigInLoop_ = new GetWireGuardConfigInLoop(this, serverAPI, serverAPI->getAvailableUserRole());
     connect(getWireGuardConfigInLoop_, &GetWireGuardConfigInLoop::getWireGuardConfigAnswer, this, &ConnectionManager::onGetWireGuardConfigAnswer);
+
+    // the summary of the connection, whichever way it ends
+    connect(this, &ConnectionManager::reconnecting, this, [this]() { connectTimeline_.startConnection(); });
+    connect(this, &ConnectionManager::testTunnelResult, this, [this](bool success, const QString &) {
+        connectTimeline_.finishConnection(success ? "connected" : "connected, tunnel test failed");
+    });
+    connect(this, &ConnectionManager::disconnected, this, [this](DISCONNECT_REASON) {
+        connectTimeline_.finishConnection("disconnected");
+    });
+    connect(this, &ConnectionManager::errorDuringConnection, this, [this](ProtoTypes::ConnectError err) {
+        connectTimeline_.finishConnection(QString("error %1").arg((int)err));
+    });
 }
 
 ConnectionManager::~ConnectionManager()
@@ -124,6 +149,8 @@ void ConnectionManager::clickConnect(const QString &ovpnConfig, const apiinfo::S
     customConfigPath_ = customConfigPath;
 
     bWasSuccessfullyConnectionAttempt_ = false;
+    bRaceDone_ = false;
+    bNodeRaceDone_ = false;
 
     usernameForCustomOvpn_.clear();
     passwordForCustomOvpn_.clear();
@@ -139,7 +166,7 @@ void ConnectionManager::clickConnect(const QString &ovpnConfig, const apiinfo::S
     {
         if (connectionSettings.isAutomatic())
         {
-            connSettingsPolicy_.reset(new AutoConnSettingsPolicy(bli, portMap, proxySettings.isProxyEnabled()));
+            connSettingsPolicy_.reset(new AutoConnSettingsPolicy(bli, portMap, proxySettings.isProxyEnabled(), currentNetworkId()));
         }
         else
         {
@@ -152,6 +179,7 @@ void ConnectionManager::clickConnect(const QString &ovpnConfig, const apiinfo::S
 
     connSettingsPolicy_->debugLocationInfoToLog();
 
+    connectTimeline_.startConnection();
     doConnect();
 }
 
@@ -162,6 +190,10 @@ void ConnectionManager::clickDisconnect()
 
     timerWaitNetworkConnectivity_.stop();
     getWireGuardConfigInLoop_->stop();
+    connectionRacer_->stop();
+    nodeRacer_->stop();
+
+    connectTimeline_.finishAttempt("cancelled");
 
     if (state_ != STATE_DISCONNECTING_FROM_USER_CLICK)
     {
@@ -186,40 +218,52 @@ void ConnectionManager::clickDisconnect()
 
 void ConnectionManager::blockingDisconnect()
 {
-    if (connector_)
+    if (beginBlockingDisconnect())
     {
-        if (!connector_->isDisconnected())
-        {
-            testVPNTunnel_->stopTests();
-            connector_->blockSignals(true);
-            QElapsedTimer elapsedTimer;
-            elapsedTimer.start();
-            connector_->startDisconnect();
-            while (!connector_->isDisconnected())
-            {
-                QThread::msleep(1);
-                qApp->processEvents();
+        Utils::waitInEventLoop([this]() { return isBlockingDisconnectFinished(); }, BLOCKING_DISCONNECT_TIMEOUT_MS);
+        endBlockingDisconnect();
+    }
+}
 
-                if (elapsedTimer.elapsed() > 10000)
-                {
-                    qCDebug(LOG_CONNECTION) << "ConnectionManager::blockingDisconnect() delay more than 10 seconds";
-                    connector_->startDisconnect();
-                    break;
-                }
-            }
-            connector_->blockSignals(false);
-            doMacRestoreProcedures();
-            stunnelManager_->killProcess();
-            wstunnelManager_->killProcess();
+bool ConnectionManager::beginBlockingDisconnect()
+{
+    connectionRacer_->stop();
+    nodeRacer_->stop();
+    if (!connector_ || connector_->isDisconnected())
+    {
+        return false;
+    }
+    testVPNTunnel_->stopTests();
+    bRoaming_ = false;
+    bRoamOnNetworkUp_ = false;
+    connector_->blockSignals(true);
+    connector_->startDisconnect();
+    return true;
+}
 
-            if (!connSettingsPolicy_.isNull())
-            {
-                connSettingsPolicy_->reset();
-            }
+bool ConnectionManager::isBlockingDisconnectFinished()
+{
+    return connector_->isDisconnected();
+}
 
-            state_ = STATE_DISCONNECTED;
-        }
+void ConnectionManager::endBlockingDisconnect()
+{
+    if (!connector_->isDisconnected())
+    {
+        qCDebug(LOG_CONNECTION) << "ConnectionManager::blockingDisconnect() delay more than 10 seconds";
+        connector_->startDisconnect();
+    }
+    connector_->blockSignals(false);
+    doMacRestoreProcedures();
+    stunnelManager_->killProcess();
+    wstunnelManager_->killProcess();
+
+    if (!connSettingsPolicy_.isNull())
+    {
+        connSettingsPolicy_->reset();
     }
+
+    state_ = STATE_DISCONNECTED;
 }
 
 bool ConnectionManager::isDisconnected()
@@ -336,6 +380,9 @@ void ConnectionManager::onConnectionConnected(const AdapterGatewayInfo &connecti
     timerReconnection_.stop();
     getWireGuardConfigInLoop_->stop();
     state_ = STATE_CONNECTED;
+    connSettingsPolicy_->setLastConnectionTime(connectionAttemptTimer_.elapsed());
+    // the engine sends the routing, firewall and DNS commands to the helper in the handler, then starts the tunnel tests
+    connectTimeline_.startStage(ConnectTimeline::STAGE_HELPER);
     Q_EMIT connected();
 }
 
@@ -344,9 +391,20 @@ void ConnectionManager::onConnectionDisconnected()
     qCDebug(LOG_CONNECTION) << "ConnectionManager::onConnectionDisconnected(), state_ =" << state_;
 
     testVPNTunnel_->stopTests();
+    bRoaming_ = false;
+    bRoamOnNetworkUp_ = false;
     doMacRestoreProcedures();
-    stunnelManager_->killProcess();
-    wstunnelManager_->killProcess();
+    // a reconnect most likely goes to the same node, so the tunnel processes are kept for it
+    if (state_ == STATE_CONNECTED || state_ == STATE_RECONNECTING || state_ == STATE_WAKEUP_RECONNECTING)
+    {
+        stunnelManager_->releaseProcess();
+        wstunnelManager_->releaseProcess();
+    }
+    else
+    {
+        stunnelManager_->killProcess();
+        wstunnelManager_->killProcess();
+    }
     timerWaitNetworkConnectivity_.stop();
     getWireGuardConfigInLoop_->stop();
 
@@ -361,6 +419,7 @@ void ConnectionManager::onConnectionDisconnected()
         case STATE_CONNECTED:
             // goto reconnection state, start reconnection timer and do connection again
             Q_ASSERT(!timerReconnection_.isActive());
+            locationsmodel::NodeHealth::instance().putDisconnect(healthNodeHostname());
             timerReconnection_.start(MAX_RECONNECTION_TIME);
             state_ = STATE_RECONNECTING;
             Q_EMIT reconnecting();
@@ -459,6 +518,7 @@ void ConnectionManager::onConnectionReconnecting()
 
             if (!connector_->isDisconnected())
             {
+                locationsmodel::NodeHealth::instance().putDisconnect(healthNodeHostname());
                 if (state_ != STATE_RECONNECTING)
                 {
                     Q_EMIT reconnecting();
@@ -515,7 +575,9 @@ void ConnectionManager::onConnectionError(ProtoTypes::ConnectError err)
     }
 
     qCDebug(LOG_CONNECTION) << "ConnectionManager::onConnectionError(), state_ =" << state_ << ", error =" << (int)err;
+    connectTimeline_.finishAttempt(QString("error %1").arg((int)err));
     testVPNTunnel_->stopTests();
+    removeCachedWireGuardConfig();
 
     if ((err == ProtoTypes::ConnectError::AUTH_ERROR && bEmitAuthError_)
             || err == ProtoTypes::ConnectError::CANT_RUN_OPENVPN
@@ -663,8 +725,16 @@ void ConnectionManager::onSleepMode()
     {
         case STATE_DISCONNECTED:
             break;
-        case STATE_CONNECTING_FROM_USER_CLICK:
         case STATE_CONNECTED:
+            if (isRoamingPossible())
+            {
+                // the tunnel is kept, it's checked after the wake up
+                qCDebug(LOG_CONNECTION) << "ConnectionManager::onSleepMode(), keeping the WireGuard tunnel";
+                testVPNTunnel_->stopTests();
+                break;
+            }
+            // fall through
+        case STATE_CONNECTING_FROM_USER_CLICK:
         case STATE_RECONNECTING:
             Q_EMIT reconnecting();
             blockingDisconnect();
@@ -698,9 +768,23 @@ void ConnectionManager::onWakeMode()
 
     switch (state_)
     {
+        case STATE_CONNECTED:
+            if (isRoamingPossible())
+            {
+                if (networkDetectionManager_->isOnline())
+                {
+                    startRoaming();
+                }
+                else
+                {
+                    // the tunnel test would fail without the network, the tunnel is checked on the first network-up
+                    qCDebug(LOG_CONNECTION) << "ConnectionManager::onWakeMode(), no network yet, keeping the WireGuard tunnel";
+                    bRoamOnNetworkUp_ = true;
+                }
+            }
+            break;
         case STATE_DISCONNECTED:
         case STATE_CONNECTING_FROM_USER_CLICK:
-        case STATE_CONNECTED:
         case STATE_RECONNECTING:
         case STATE_WAIT_FOR_NETWORK_CONNECTIVITY:
         case STATE_DISCONNECTING_FROM_USER_CLICK:
@@ -717,13 +801,27 @@ void ConnectionManager::onWakeMode()
 void ConnectionManager::onNetworkOnlineStateChanged(bool isAlive)
 {
     qCDebug(LOG_CONNECTION) << "ConnectionManager::onNetworkOnlineStateChanged(), isAlive =" << isAlive << ", state_ =" << state_;
+    if (!isAlive)
+    {
+        connectionRacer_->stop();
+        nodeRacer_->stop();
+    }
+    else if (timerWaitNetworkConnectivity_.isActive() && state_ != STATE_WAIT_FOR_NETWORK_CONNECTIVITY)
+    {
+        // the connection waiting for the network resumes on the first network-up, the poll is only a fallback
+        onTimerWaitNetworkConnectivity();
+    }
+#ifndef Q_OS_MAC
+    else if (bRoamOnNetworkUp_ && state_ == STATE_CONNECTED && isRoamingPossible())
+    {
+        startRoaming();
+    }
+#endif
 #ifdef Q_OS_WIN
     Q_EMIT internetConnectivityChanged(isAlive);
 #elif defined Q_OS_MAC
     Q_EMIT internetConnectivityChanged(isAlive);
 
-    bLastIsOnline_ = isAlive;
-
     switch (state_)
     {
         case STATE_DISCONNECTED:
@@ -747,6 +845,10 @@ void ConnectionManager::onNetworkOnlineStateChanged(bool isAlive)
                 timerReconnection_.start(MAX_RECONNECTION_TIME);
                 connector_->startDisconnect();
             }
+            else if (isRoamingPossible())
+            {
+                startRoaming();
+            }
             else
             {
                 Q_EMIT reconnecting();
@@ -850,6 +952,8 @@ void ConnectionManager::doConnect()
         waitForNetworkConnectivity();
         return;
     }
+    connectTimeline_.startAttempt();
+    connectTimeline_.startStage(ConnectTimeline::STAGE_RESOLVE);
     defaultAdapterInfo_ = AdapterGatewayInfo::detectAndCreateDefaultAdaperInfo();
     qCDebug(LOG_CONNECTION) << "Default adapter and gateway:" << defaultAdapterInfo_.makeLogString();
 
@@ -858,7 +962,7 @@ void ConnectionManager::doConnect()
 
 void ConnectionManager::doConnectPart2()
 {
-
+    connectionAttemptTimer_.start();
     bIgnoreConnectionErrorsForOpenVpn_ = false;
 
     currentConnectionDescr_ = connSettingsPolicy_->getCurrentConnectionSettings();
@@ -869,10 +973,28 @@ void ConnectionManager::doConnectPart2()
         state_ = STATE_DISCONNECTED;
         timerReconnection_.stop();
         getWireGuardConfigInLoop_->stop();
+        connectTimeline_.finishAttempt("no active nodes");
         Q_EMIT errorDuringConnection(ProtoTypes::ConnectError::LOCATION_NO_ACTIVE_NODES);
         return;
     }
 
+    {
+        ProtoTypes::NetworkInterface networkInterface;
+        networkDetectionManager_->getCurrentNetworkInterface(networkInterface);
+        connectTimeline_.setDescription(currentConnectionDescr_.protocol.toLongString(), currentConnectionDescr_.port,
+                                        QString::fromStdString(ProtoTypes::NetworkInterfaceType_Name(networkInterface.interface_type())));
+    }
+
+    // the processes kept from the previous connection are reused only by the same protocol
+    if (currentConnectionDescr_.protocol.getType() != ProtocolType::PROTOCOL_STUNNEL)
+    {
+        stunnelManager_->killProcess();
+    }
+    if (currentConnectionDescr_.protocol.getType() != ProtocolType::PROTOCOL_WSTUNNEL)
+    {
+        wstunnelManager_->killProcess();
+    }
+
     if (currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_DEFAULT ||
             currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_STATIC_IPS)
     {
@@ -928,6 +1050,10 @@ void ConnectionManager::doConnectPart2()
                 return;
             }
 
+            if (currentConnectionDescr_.protocol.isStunnelOrWStunnelProtocol())
+            {
+                connectTimeline_.startStage(ConnectTimeline::STAGE_TUNNEL_PROCESS);
+            }
             if (currentConnectionDescr_.protocol.getType() == ProtocolType::PROTOCOL_STUNNEL)
             {
                 if(!stunnelManager_->runProcess())
@@ -968,6 +1094,7 @@ void ConnectionManager::doConnectPart2()
         else if (currentConnectionDescr_.protocol.isWireGuardProtocol())
         {
             qCDebug(LOG_CONNECTION) << "Requesting WireGuard config for hostname =" << currentConnectionDescr_.hostname;
+            connectTimeline_.startStage(ConnectTimeline::STAGE_WIREGUARD_CONFIG);
             getWireGuardConfigInLoop_->getWireGuardConfig(currentConnectionDescr_.hostname, false);
             return;
         }
@@ -1013,6 +1140,8 @@ void ConnectionManager::doConnectPart2()
 void ConnectionManager::doConnectPart3()
 {
     qCDebug(LOG_CONNECTION) << "Connecting to IP:" << currentConnectionDescr_.ip << " protocol:" << currentConnectionDescr_.protocol.toLongString() << " port:" << currentConnectionDescr_.port;
+    // includes the setup of the adapter, it's done by the connection itself
+    connectTimeline_.startStage(ConnectTimeline::STAGE_HANDSHAKE);
     Q_EMIT protocolPortChanged(currentConnectionDescr_.protocol.convertToProtobuf(), currentConnectionDescr_.port);
 
     if (currentConnectionDescr_.protocol.isWireGuardProtocol())
@@ -1096,6 +1225,7 @@ void ConnectionManager::doConnectPart3()
 // return true, if need finish reconnecting
 bool ConnectionManager::checkFails()
 {
+    locationsmodel::NodeHealth::instance().putConnectFailure(healthNodeHostname());
     connSettingsPolicy_->putFailedConnection();
     return connSettingsPolicy_->isFailed();
 }
@@ -1179,29 +1309,45 @@ void ConnectionManager::recreateConnector(ProtocolType protocol)
         connect(connector_, SIGNAL(requestUsername()), SLOT(onConnectionRequestUsername()), Qt::QueuedConnection);
         connect(connector_, SIGNAL(requestPassword()), SLOT(onConnectionRequestPassword()), Qt::QueuedConnection);
 
+        connector_->setApplicationActive(isApplicationActive_);
         currentProtocol_ = protocol;
     }
 }
 
 void ConnectionManager::restoreConnectionAfterWakeUp()
 {
-    if (bLastIsOnline_)
+    // without the network doConnect() waits for the first network-up (onNetworkOnlineStateChanged)
+    qCDebug(LOG_CONNECTION) << "ConnectionManager::restoreConnectionAfterWakeUp(), reconnecting, online ="
+                            << networkDetectionManager_->isOnline();
+    state_ = STATE_WAKEUP_RECONNECTING;
+    doConnect();
+}
+
+void ConnectionManager::onTunnelTestsFinished(bool bSuccess, const QString &ipAddress)
+{
+    connectTimeline_.finishAttempt(bSuccess ? "connected" : "tunnel test failed");
+
+    if (!bSuccess)
     {
-        qCDebug(LOG_CONNECTION) <<
-            "ConnectionManager::restoreConnectionAfterWakeUp(), reconnecting";
-        state_ = STATE_WAKEUP_RECONNECTING;
-        doConnect();
+        removeCachedWireGuardConfig();
     }
-    else
+
+    if (bRoaming_)
     {
-        qCDebug(LOG_CONNECTION) <<
-            "ConnectionManager::restoreConnectionAfterWakeUp(), waiting for network connectivity";
-        state_ = STATE_WAIT_FOR_NETWORK_CONNECTIVITY;
+        bRoaming_ = false;
+        if (!bSuccess && state_ == STATE_CONNECTED)
+        {
+            // the tunnel doesn't work over the new network, do the full reconnect
+            qCDebug(LOG_CONNECTION) << "The WireGuard tunnel doesn't work after roaming, reconnecting";
+            state_ = STATE_RECONNECTING;
+            Q_EMIT reconnecting();
+            startReconnectionTimer();
+            connector_->startDisconnect();
+            return;
+        }
+        qCDebug(LOG_CONNECTION) << "The WireGuard tunnel works after roaming";
     }
-}
 
-void ConnectionManager::onTunnelTestsFinished(bool bSuccess, const QString &ipAddress)
-{
     if (!bSuccess)
     {
         if (connSettingsPolicy_->isAutomaticMode())
@@ -1227,12 +1373,15 @@ void ConnectionManager::onTunnelTestsFinished(bool bSuccess, const QString &ipAd
         }
         else
         {
+            // checkFails() puts it for the automatic mode
+            locationsmodel::NodeHealth::instance().putConnectFailure(healthNodeHostname());
             Q_EMIT testTunnelResult(false, "");
         }
     }
     else
     {
         Q_EMIT testTunnelResult(true, ipAddress);
+        locationsmodel::NodeHealth::instance().putConnectSuccess(healthNodeHostname());
 
         // if connection mode is automatic, save last successfully connection settings
         bWasSuccessfullyConnectionAttempt_ = true;
@@ -1240,6 +1389,39 @@ void ConnectionManager::onTunnelTestsFinished(bool bSuccess, const QString &ipAd
     }
 }
 
+bool ConnectionManager::isRoamingPossible() const
+{
+    return connector_ != nullptr && currentProtocol_.isWireGuardProtocol();
+}
+
+void ConnectionManager::startRoaming()
+{
+    // the interface and the peer are kept, WireGuard sends from the new network itself, only the default adapter
+    // (for the endpoint route) and the dependent settings change
+    defaultAdapterInfo_ = AdapterGatewayInfo::detectAndCreateDefaultAdaperInfo();
+    qCDebug(LOG_CONNECTION) << "Roaming the WireGuard tunnel, default adapter and gateway:" << defaultAdapterInfo_.makeLogString();
+
+    bRoaming_ = true;
+    bRoamOnNetworkUp_ = false;
+    Q_EMIT roamed();
+    testVPNTunnel_->stopTests();
+    testVPNTunnel_->startTests(currentConnectionDescr_.protocol);
+}
+
+void ConnectionManager::removeCachedWireGuardConfig()
+{
+    // the cached address may be the reason of the failure, the next attempt to this server asks the API again
+    if (currentConnectionDescr_.protocol.isWireGuardProtocol() && currentConnectionDescr_.connectionNodeType != CONNECTION_NODE_CUSTOM_CONFIG)
+    {
+        WireGuardConnectCache::instance().remove(currentConnectionDescr_.hostname);
+    }
+}
+
+QString ConnectionManager::healthNodeHostname() const
+{
+    return currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_DEFAULT ? currentConnectionDescr_.hostname : QString();
+}
+
 void ConnectionManager::onTimerWaitNetworkConnectivity()
 {
     if (networkDetectionManager_->isOnline())
@@ -1264,6 +1446,41 @@ void ConnectionManager::onTimerWaitNetworkConnectivity()
 
 void ConnectionManager::onHostnamesResolved()
 {
+    if (!startNodeRace() && !startConnectionRace())
+    {
+        doConnectPart2();
+    }
+}
+
+void ConnectionManager::onNodeRaceFinished(int winnerIndex)
+{
+    if (state_ == STATE_DISCONNECTED || state_ == STATE_DISCONNECTING_FROM_USER_CLICK)
+    {
+        return;
+    }
+    if (winnerIndex >= 0 && winnerIndex < nodeRaceCandidates_.count())
+    {
+        qCDebug(LOG_CONNECTION) << "Node race winner:" << nodeRaceCandidates_[winnerIndex].ip;
+        connSettingsPolicy_->selectNodeRaceWinner(winnerIndex);
+    }
+    nodeRaceCandidates_.clear();
+    if (!startConnectionRace())
+    {
+        doConnectPart2();
+    }
+}
+
+void ConnectionManager::onConnectionRaceFinished(int winnerIndex)
+{
+    if (state_ == STATE_DISCONNECTED || state_ == STATE_DISCONNECTING_FROM_USER_CLICK)
+    {
+        return;
+    }
+    if (winnerIndex >= 0 && winnerIndex < raceCandidates_.count())
+    {
+        connSettingsPolicy_->selectRaceWinner(raceCandidates_[winnerIndex].protocol);
+    }
+    raceCandidates_.clear();
     doConnectPart2();
 }
 
@@ -1332,8 +1549,18 @@ void ConnectionManager::setPacketSize(ProtoTypes::PacketSize ps)
     packetSize_ = ps;
 }
 
+void ConnectionManager::setApplicationActive(bool isActive)
+{
+    isApplicationActive_ = isActive;
+    if (connector_)
+    {
+        connector_->setApplicationActive(isActive);
+    }
+}
+
 void ConnectionManager::startTunnelTests()
 {
+    connectTimeline_.startStage(ConnectTimeline::STAGE_TUNNEL_TEST);
     testVPNTunnel_->startTests(currentConnectionDescr_.protocol);
 }
 
@@ -1351,3 +1578,87 @@ ProtocolType ConnectionManager::currentProtocol() const
 {
     return currentProtocol_;
 }
+
+void ConnectionManager::writeConnectTimelineToLog() const
+{
+    connectTimeline_.writeHistoryToLog();
+}
+
+QString ConnectionManager::currentNetworkId() const
+{
+    ProtoTypes::NetworkInterface networkInterface;
+    networkDetectionManager_->getCurrentNetworkInterface(networkInterface);
+    return QString::fromStdString(networkInterface.network_or_ssid());
+}
+
+bool ConnectionManager::startConnectionRace()
+{
+    if (!connSettingsPolicy_->isAutomaticMode())
+    {
+        return false;
+    }
+    // the result is kept for the network until the connection is started by the user again
+    const QString networkId = currentNetworkId();
+    if (bRaceDone_ && networkId == raceNetworkId_)
+    {
+        return false;
+    }
+
+    const QVector<CurrentConnectionDescr> descrs = connSettingsPolicy_->getRaceCandidates();
+    if (descrs.count() < 2)
+    {
+        return false;
+    }
+
+    bRaceDone_ = true;
+    raceNetworkId_ = networkId;
+    raceCandidates_.clear();
+    for (const CurrentConnectionDescr &descr : descrs)
+    {
+        ConnectionRacer::Candidate candidate;
+        candidate.protocol = descr.protocol;
+        candidate.ip = descr.ip;
+        candidate.port = descr.port;
+        raceCandidates_ << candidate;
+    }
+    qCDebug(LOG_CONNECTION) << "Racing" << raceCandidates_.count() << "protocols before the connection";
+    connectTimeline_.startStage(ConnectTimeline::STAGE_RACE);
+    connectionRacer_->start(raceCandidates_);
+    return true;
+}
+
+bool ConnectionManager::startNodeRace()
+{
+    // the probes go directly to the nodes
+    if (bNodeRaceDone_ || lastProxySettings_.isProxyEnabled())
+    {
+        return false;
+    }
+    bNodeRaceDone_ = true;
+
+    const QVector<CurrentConnectionDescr> descrs = connSettingsPolicy_->getNodeRaceCandidates(NODE_RACE_CANDIDATES);
+    if (descrs.count() < 2 || !ConnectionRacer::isProbeSupported(descrs.first().protocol))
+    {
+        return false;
+    }
+    // the OpenVPN UDP nodes with tls-auth don't answer the probe, they are all neutral at NODE_RACE_TIMEOUT and the
+    // race would only delay the connection to the first one
+    if (descrs.first().protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
+    {
+        return false;
+    }
+
+    nodeRaceCandidates_.clear();
+    for (const CurrentConnectionDescr &descr : descrs)
+    {
+        ConnectionRacer::Candidate candidate;
+        candidate.protocol = descr.protocol;
+        candidate.ip = descr.ip;
+        candidate.port = descr.port;
+        nodeRaceCandidates_ << candidate;
+    }
+    qCDebug(LOG_CONNECTION) << "Racing" << nodeRaceCandidates_.count() << "nodes before the connection";
+    connectTimeline_.startStage(ConnectTimeline::STAGE_NODE_RACE);
+    nodeRacer_->start(nodeRaceCandidates_, NODE_RACE_TIMEOUT);
+    return true;
+}
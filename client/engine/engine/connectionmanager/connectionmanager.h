@@ -10,6 +10,8 @@
 #include "makeovpnfilefromcustom.h"
 
 #include "iconnection.h"
+#include "connectionracer.h"
+#include "connecttimeline.h"
 #include "testvpntunnel.h"
 #include "engine/types/protocoltype.h"
 #include "engine/wireguardconfig/wireguardconfig.h"
@@ -46,8 +48,15 @@ public:
 
     void clickDisconnect();
     void blockingDisconnect();
+    // blockingDisconnect() in steps, so the engine waits for the several disconnects at once:
+    // beginBlockingDisconnect() returns false if there is nothing to wait for, else endBlockingDisconnect() must follow
+    bool beginBlockingDisconnect();
+    bool isBlockingDisconnectFinished();
+    void endBlockingDisconnect();
     bool isDisconnected();
 
+    static constexpr int BLOCKING_DISCONNECT_TIMEOUT_MS = 10000;
+
     QString getLastConnectedIp();
     const AdapterGatewayInfo &getDefaultAdapterInfo() const;
     const AdapterGatewayInfo &getVpnAdapterInfo() const;
@@ -75,11 +84,13 @@ public:
 
     void setMss(int mss);
     void setPacketSize(ProtoTypes::PacketSize ps);
+    void setApplicationActive(bool isActive);
 
     void startTunnelTests();
     bool isAllowFirewallAfterConnection() const;
 
     ProtocolType currentProtocol() const;
+    void writeConnectTimelineToLog() const;
 
 signals:
     void connected();
@@ -94,6 +105,8 @@ signals:
     void internetConnectivityChanged(bool connectivity);
     void protocolPortChanged(const ProtoTypes::Protocol &protocol, const uint port);
     void wireGuardAtKeyLimit();
+    // the WireGuard tunnel is kept after the network change or the wake up, the routes and the firewall need the update
+    void roamed();
 
     void requestUsername(const QString &pathCustomOvpnConfig);
     void requestPassword(const QString &pathCustomOvpnConfig);
@@ -124,6 +137,8 @@ private slots:
     void onTimerWaitNetworkConnectivity();
 
     void onHostnamesResolved();
+    void onConnectionRaceFinished(int winnerIndex);
+    void onNodeRaceFinished(int winnerIndex);
 
     void onGetWireGuardConfigAnswer(SERVER_API_RET_CODE retCode, const WireGuardConfig &config);
 
@@ -161,6 +176,21 @@ private:
     MakeOVPNFileFromCustom *makeOVPNFileFromCustom_;
     TestVPNTunnel *testVPNTunnel_;
 
+    // in the automatic mode the protocols are raced once per connection and after the network changes
+    ConnectionRacer *connectionRacer_;
+    QVector<ConnectionRacer::Candidate> raceCandidates_;
+    QString raceNetworkId_;
+    bool bRaceDone_;
+    // the nodes of the location are raced once per connection from the user, with the protocol of the first attempt
+    ConnectionRacer *nodeRacer_;
+    QVector<ConnectionRacer::Candidate> nodeRaceCandidates_;
+    bool bNodeRaceDone_;
+    static constexpr int NODE_RACE_CANDIDATES = 3;
+    static constexpr int NODE_RACE_TIMEOUT = 300;
+
+    QElapsedTimer connectionAttemptTimer_;
+    ConnectTimeline connectTimeline_;
+
     bool bNeedResetTap_;
     bool bIgnoreConnectionErrorsForOpenVpn_;
     bool bWasSuccessfullyConnectionAttempt_;
@@ -170,8 +200,11 @@ private:
     enum { MAX_RECONNECTION_TIME = 60 * 60 * 1000 };  // 1 hour
 
     int state_;
-    bool bLastIsOnline_;
     bool bWakeSignalReceived_;
+    // the WireGuard tunnel is kept over the network change, the result of the tunnel test decides if it works
+    bool bRoaming_;
+    // woke up without the network, the kept WireGuard tunnel is tested on the first network-up
+    bool bRoamOnNetworkUp_;
 
     ProtocolType currentProtocol_;
 
@@ -181,6 +214,7 @@ private:
     QString passwordForCustomOvpn_;     // can be empty
 
     ProtoTypes::PacketSize packetSize_;
+    bool isApplicationActive_;
 
     WireGuardConfig wireGuardConfig_;
     GetWireGuardConfigInLoop *getWireGuardConfigInLoop_;
@@ -200,6 +234,14 @@ private:
     void waitForNetworkConnectivity();
     void recreateConnector(ProtocolType protocol);
     void restoreConnectionAfterWakeUp();
+    bool isRoamingPossible() const;
+    void startRoaming();
+    void removeCachedWireGuardConfig();
+    // the hostname for NodeHealth, empty for the custom configs and the static ips
+    QString healthNodeHostname() const;
+    QString currentNetworkId() const;
+    bool startConnectionRace();
+    bool startNodeRace();
 };
 
 #endif // CONNECTIONMANAGER_H
@@ -0,0 +1,410 @@
+#include "connectionracer.h"
+
+#include <QHostAddress>
+#include <QSslSocket>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QtEndian>
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+namespace {
+
+void appendRandomBytes(QByteArray &arr, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        arr.append(static_cast<char>(Utils::generateIntegerRandom(0, 255)));
+    }
+}
+
+void appendUint16(QByteArray &arr, quint16 value)
+{
+    const quint16 be = qToBigEndian(value);
+    arr.append(reinterpret_cast<const char *>(&be), sizeof(be));
+}
+
+void appendUint32(QByteArray &arr, quint32 value)
+{
+    const quint32 be = qToBigEndian(value);
+    arr.append(reinterpret_cast<const char *>(&be), sizeof(be));
+}
+
+const int IKE_HEADER_SIZE = 28;
+const int IKE_SPI_SIZE = 8;
+
+} // namespace
+
+ConnectionRacer::ConnectionRacer(QObject *parent) : QObject(parent)
+{
+    timeoutTimer_.setSingleShot(true);
+    connect(&timeoutTimer_, SIGNAL(timeout()), SLOT(onTimeout()));
+    connect(&resendTimer_, SIGNAL(timeout()), SLOT(onResendTimer()));
+}
+
+ConnectionRacer::~ConnectionRacer()
+{
+    stop();
+}
+
+void ConnectionRacer::start(const QVector<Candidate> &candidates, int timeoutMs, WINNER_ORDER winnerOrder)
+{
+    stop();
+    winnerOrder_ = winnerOrder;
+
+    probes_.clear();
+    probes_.reserve(candidates.count());
+    for (const Candidate &c : candidates)
+    {
+        Probe probe;
+        probe.candidate = c;
+        probes_ << probe;
+    }
+
+    neutralTimeMs_ = qMin(UDP_NEUTRAL_TIME, timeoutMs);
+    elapsedTimer_.start();
+    for (int i = 0; i < probes_.count(); ++i)
+    {
+        startProbe(i);
+    }
+    timeoutTimer_.start(timeoutMs);
+    resendTimer_.start(UDP_RESEND_INTERVAL);
+    checkFinished();
+}
+
+void ConnectionRacer::stop()
+{
+    timeoutTimer_.stop();
+    resendTimer_.stop();
+    closeSockets();
+    probes_.clear();
+}
+
+bool ConnectionRacer::isRunning() const
+{
+    return timeoutTimer_.isActive();
+}
+
+bool ConnectionRacer::isProbeSupported(const ProtocolType &protocol)
+{
+    return protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_TCP || protocol.getType() == ProtocolType::PROTOCOL_STUNNEL ||
+           protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP || protocol.isIkev2Protocol();
+}
+
+void ConnectionRacer::onSocketConnected()
+{
+    setProbeState(sender(), PROBE_SUCCESS);
+}
+
+void ConnectionRacer::onSocketEncrypted()
+{
+    setProbeState(sender(), PROBE_SUCCESS);
+}
+
+void ConnectionRacer::onSocketError()
+{
+    setProbeState(sender(), PROBE_FAILED);
+}
+
+void ConnectionRacer::onUdpReadyRead()
+{
+    QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
+    if (!socket)
+    {
+        return;
+    }
+    const int ind = socket->property("probeIndex").toInt();
+    if (ind < 0 || ind >= probes_.count())
+    {
+        return;
+    }
+
+    bool isAnswered = false;
+    while (socket->hasPendingDatagrams())
+    {
+        QByteArray datagram(static_cast<int>(socket->pendingDatagramSize()), Qt::Uninitialized);
+        const qint64 size = socket->readDatagram(datagram.data(), datagram.size());
+        if (size <= 0)
+        {
+            continue;
+        }
+        datagram.truncate(static_cast<int>(size));
+        if (probes_[ind].candidate.protocol.isIkev2Protocol())
+        {
+            // the reply to our IKE_SA_INIT has our initiator SPI (the first 8 bytes of the header)
+            isAnswered = isAnswered || (datagram.size() >= IKE_HEADER_SIZE && datagram.left(IKE_SPI_SIZE) == probes_[ind].request.left(IKE_SPI_SIZE));
+        }
+        else
+        {
+            isAnswered = true;
+        }
+    }
+    if (isAnswered)
+    {
+        setProbeState(socket, PROBE_SUCCESS);
+    }
+}
+
+void ConnectionRacer::onResendTimer()
+{
+    // UDP has no retransmits, the packets can be dropped on the way
+    for (Probe &probe : probes_)
+    {
+        if (probe.state == PROBE_PENDING && !probe.request.isEmpty())
+        {
+            sendUdpRequest(probe);
+        }
+    }
+    // the OpenVPN UDP probes without an answer become neutral
+    checkFinished();
+}
+
+void ConnectionRacer::onTimeout()
+{
+    for (int i = 0; i < probes_.count(); ++i)
+    {
+        if (probes_[i].state == PROBE_SUCCESS)
+        {
+            finish(i);
+            return;
+        }
+    }
+    finish(firstNeutral());
+}
+
+void ConnectionRacer::startProbe(int ind)
+{
+    Probe &probe = probes_[ind];
+    const ProtocolType &protocol = probe.candidate.protocol;
+
+    if (!isProbeSupported(protocol))
+    {
+        probe.state = PROBE_FAILED;
+        return;
+    }
+    else if (protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_TCP)
+    {
+        probe.socket = new QTcpSocket(this);
+        connect(probe.socket, SIGNAL(connected()), SLOT(onSocketConnected()));
+    }
+    else if (protocol.getType() == ProtocolType::PROTOCOL_STUNNEL)
+    {
+        QSslSocket *sslSocket = new QSslSocket(this);
+        // only the handshake is checked, the certificate is verified by stunnel itself
+        sslSocket->setPeerVerifyMode(QSslSocket::VerifyNone);
+        connect(sslSocket, SIGNAL(encrypted()), SLOT(onSocketEncrypted()));
+        probe.socket = sslSocket;
+    }
+    else if (protocol.isIkev2Protocol() || protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
+    {
+        probe.socket = new QUdpSocket(this);
+        probe.request = protocol.isIkev2Protocol() ? makeIkeSaInitRequest() : makeOpenVpnHardResetRequest();
+        connect(probe.socket, SIGNAL(readyRead()), SLOT(onUdpReadyRead()));
+    }
+
+    probe.socket->setProperty("probeIndex", ind);
+    // for UDP the error is the ICMP port unreachable
+    connect(probe.socket, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(onSocketError()));
+
+    if (QSslSocket *sslSocket = qobject_cast<QSslSocket *>(probe.socket))
+    {
+        sslSocket->connectToHostEncrypted(probe.candidate.ip, probe.candidate.port);
+    }
+    else if (qobject_cast<QUdpSocket *>(probe.socket))
+    {
+        probe.socket->connectToHost(QHostAddress(probe.candidate.ip), probe.candidate.port);
+        sendUdpRequest(probe);
+    }
+    else
+    {
+        probe.socket->connectToHost(QHostAddress(probe.candidate.ip), probe.candidate.port);
+    }
+}
+
+void ConnectionRacer::setProbeState(QObject *socket, PROBE_STATE state)
+{
+    if (!socket)
+    {
+        return;
+    }
+    const int ind = socket->property("probeIndex").toInt();
+    if (ind < 0 || ind >= probes_.count() || probes_[ind].socket != socket || probes_[ind].state != PROBE_PENDING)
+    {
+        return;
+    }
+    probes_[ind].state = state;
+    probes_[ind].elapsedMs = elapsedTimer_.elapsed();
+    checkFinished();
+}
+
+void ConnectionRacer::checkFinished()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    bool isPending = false;
+    for (int i = 0; i < probes_.count(); ++i)
+    {
+        if (probes_[i].state == PROBE_SUCCESS)
+        {
+            // the candidates before it have failed or are neutral (or don't matter for WINNER_FIRST_ANSWER),
+            // an answer is ranked above no answer
+            finish(i);
+            return;
+        }
+        else if (probes_[i].state == PROBE_PENDING && !isNeutral(probes_[i]))
+        {
+            if (winnerOrder_ == WINNER_PRIORITY)
+            {
+                // a candidate with the higher priority can still win
+                return;
+            }
+            isPending = true;
+        }
+    }
+    if (isPending)
+    {
+        return;
+    }
+    // nothing answered and nothing else can, the neutral candidates are the last resort
+    finish(firstNeutral());
+}
+
+bool ConnectionRacer::isNeutral(const Probe &probe) const
+{
+    return probe.state == PROBE_PENDING && probe.candidate.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP &&
+           elapsedTimer_.elapsed() >= neutralTimeMs_;
+}
+
+int ConnectionRacer::firstNeutral() const
+{
+    for (int i = 0; i < probes_.count(); ++i)
+    {
+        if (isNeutral(probes_[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ConnectionRacer::finish(int winnerIndex)
+{
+    timeoutTimer_.stop();
+    resendTimer_.stop();
+
+    for (const Probe &probe : qAsConst(probes_))
+    {
+        const char *result = probe.state == PROBE_SUCCESS ? "ok" : (probe.state == PROBE_FAILED ? "failed" :
+                             (isNeutral(probe) ? "no answer (neutral)" : "no answer"));
+        qCDebug(LOG_CONNECTION) << "Connection race:" << probe.candidate.protocol.toLongString() << probe.candidate.ip
+                                << probe.candidate.port << result << probe.elapsedMs << "ms";
+    }
+    qCDebug(LOG_CONNECTION) << "Connection race finished in" << elapsedTimer_.elapsed() << "ms, winner:"
+                            << (winnerIndex >= 0 ? probes_[winnerIndex].candidate.protocol.toLongString() : QString("none"));
+
+    closeSockets();
+    probes_.clear();
+    emit finished(winnerIndex);
+}
+
+void ConnectionRacer::closeSockets()
+{
+    for (Probe &probe : probes_)
+    {
+        if (probe.socket)
+        {
+            probe.socket->disconnect(this);
+            probe.socket->abort();
+            probe.socket->deleteLater();
+            probe.socket = nullptr;
+        }
+    }
+}
+
+void ConnectionRacer::sendUdpRequest(Probe &probe)
+{
+    QUdpSocket *socket = qobject_cast<QUdpSocket *>(probe.socket);
+    if (socket)
+    {
+        socket->write(probe.request);
+    }
+}
+
+QByteArray ConnectionRacer::makeIkeSaInitRequest()
+{
+    // RFC 7296: header, SA (AES-CBC-256, HMAC-SHA256 PRF and integrity, MODP-2048), KE, Nonce
+    // the KE data is random, any reply (an IKE_SA_INIT response or a notify) means the IKE service is reachable
+    const int SA_PAYLOAD_SIZE = 48;
+    const int KE_DATA_SIZE = 256;
+    const int KE_PAYLOAD_SIZE = 8 + KE_DATA_SIZE;
+    const int NONCE_DATA_SIZE = 32;
+    const int NONCE_PAYLOAD_SIZE = 4 + NONCE_DATA_SIZE;
+
+    QByteArray arr;
+    arr.reserve(IKE_HEADER_SIZE + SA_PAYLOAD_SIZE + KE_PAYLOAD_SIZE + NONCE_PAYLOAD_SIZE);
+
+    // header
+    appendRandomBytes(arr, IKE_SPI_SIZE);           // initiator SPI
+    arr.append(IKE_SPI_SIZE, '\0');                 // responder SPI
+    arr.append(static_cast<char>(33));              // next payload: SA
+    arr.append(static_cast<char>(0x20));            // version 2.0
+    arr.append(static_cast<char>(34));              // exchange type: IKE_SA_INIT
+    arr.append(static_cast<char>(0x08));            // flags: initiator
+    appendUint32(arr, 0);                           // message id
+    appendUint32(arr, IKE_HEADER_SIZE + SA_PAYLOAD_SIZE + KE_PAYLOAD_SIZE + NONCE_PAYLOAD_SIZE);
+
+    // SA payload with one proposal of 4 transforms
+    arr.append(static_cast<char>(34));              // next payload: KE
+    arr.append('\0');
+    appendUint16(arr, SA_PAYLOAD_SIZE);
+    arr.append('\0');                               // last proposal
+    arr.append('\0');
+    appendUint16(arr, SA_PAYLOAD_SIZE - 4);
+    arr.append(static_cast<char>(1));               // proposal number
+    arr.append(static_cast<char>(1));               // protocol id: IKE
+    arr.append('\0');                               // SPI size
+    arr.append(static_cast<char>(4));               // transforms count
+    // ENCR_AES_CBC with the key length attribute 256
+    arr.append(static_cast<char>(3)); arr.append('\0'); appendUint16(arr, 12);
+    arr.append(static_cast<char>(1)); arr.append('\0'); appendUint16(arr, 12);
+    appendUint16(arr, 0x800E); appendUint16(arr, 256);
+    // PRF_HMAC_SHA2_256
+    arr.append(static_cast<char>(3)); arr.append('\0'); appendUint16(arr, 8);
+    arr.append(static_cast<char>(2)); arr.append('\0'); appendUint16(arr, 5);
+    // AUTH_HMAC_SHA2_256_128
+    arr.append(static_cast<char>(3)); arr.append('\0'); appendUint16(arr, 8);
+    arr.append(static_cast<char>(3)); arr.append('\0'); appendUint16(arr, 12);
+    // DH group 14 (last transform)
+    arr.append('\0'); arr.append('\0'); appendUint16(arr, 8);
+    arr.append(static_cast<char>(4)); arr.append('\0'); appendUint16(arr, 14);
+
+    // KE payload
+    arr.append(static_cast<char>(40));              // next payload: Nonce
+    arr.append('\0');
+    appendUint16(arr, KE_PAYLOAD_SIZE);
+    appendUint16(arr, 14);                          // DH group
+    appendUint16(arr, 0);
+    appendRandomBytes(arr, KE_DATA_SIZE);
+
+    // Nonce payload
+    arr.append('\0');                               // no next payload
+    arr.append('\0');
+    appendUint16(arr, NONCE_PAYLOAD_SIZE);
+    appendRandomBytes(arr, NONCE_DATA_SIZE);
+
+    Q_ASSERT(arr.size() == IKE_HEADER_SIZE + SA_PAYLOAD_SIZE + KE_PAYLOAD_SIZE + NONCE_PAYLOAD_SIZE);
+    return arr;
+}
+
+QByteArray ConnectionRacer::makeOpenVpnHardResetRequest()
+{
+    // opcode P_CONTROL_HARD_RESET_CLIENT_V2 (7) with key id 0, session id, empty ack array, packet id 0
+    QByteArray arr;
+    arr.append(static_cast<char>(7 << 3));
+    appendRandomBytes(arr, 8);
+    arr.append('\0');
+    appendUint32(arr, 0);
+    return arr;
+}
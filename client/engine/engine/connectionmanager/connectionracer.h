@@ -0,0 +1,99 @@
+#ifndef CONNECTIONRACER_H
+#define CONNECTIONRACER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "engine/types/protocoltype.h"
+
+class QAbstractSocket;
+
+// Probes the protocols/ports of the automatic mode in parallel before the connection, so the blocked ones
+// are skipped without waiting for the full connection timeout of each of them.
+// The probes are lightweight handshakes without the credentials:
+//   OpenVPN TCP - TCP connect;
+//   stunnel - TLS handshake;
+//   IKEv2 - IKE_SA_INIT, any reply of the server with our SPI;
+//   OpenVPN UDP - P_CONTROL_HARD_RESET_CLIENT_V2, any reply. The server doesn't answer it if it requires tls-auth,
+//   so no answer is neutral: after UDP_NEUTRAL_TIME (or the race timeout if shorter) without the ICMP error the candidate
+//   isn't counted as failed, only the ICMP error makes it lose.
+// The winner is the first candidate in the given order which answered: the race finishes as soon as all
+// the candidates before the succeeded one have failed or are neutral, or at the timeout. A neutral candidate wins
+// only if none answered, the first one in the order. With WINNER_FIRST_ANSWER the order doesn't matter, the first
+// candidate which answered wins at once (for the endpoints without a preference, a blackholed first one would hold
+// the race until the timeout).
+// The same probes race the nodes of the location for one protocol before the connection, with a short timeout.
+class ConnectionRacer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Candidate
+    {
+        ProtocolType protocol;
+        QString ip;
+        uint port = 0;
+    };
+
+    enum WINNER_ORDER { WINNER_PRIORITY, WINNER_FIRST_ANSWER };
+
+    explicit ConnectionRacer(QObject *parent);
+    ~ConnectionRacer() override;
+
+    void start(const QVector<Candidate> &candidates, int timeoutMs = RACE_TIMEOUT, WINNER_ORDER winnerOrder = WINNER_PRIORITY);
+    // without the finished signal
+    void stop();
+    bool isRunning() const;
+
+    static bool isProbeSupported(const ProtocolType &protocol);
+
+signals:
+    // the index of the winner in the candidates, -1 if none answered
+    void finished(int winnerIndex);
+
+private slots:
+    void onSocketConnected();
+    void onSocketEncrypted();
+    void onSocketError();
+    void onUdpReadyRead();
+    void onResendTimer();
+    void onTimeout();
+
+private:
+    static constexpr int RACE_TIMEOUT = 3000;
+    static constexpr int UDP_RESEND_INTERVAL = 1000;
+    static constexpr int UDP_NEUTRAL_TIME = UDP_RESEND_INTERVAL;
+
+    enum PROBE_STATE { PROBE_PENDING, PROBE_SUCCESS, PROBE_FAILED };
+
+    struct Probe
+    {
+        Candidate candidate;
+        PROBE_STATE state = PROBE_PENDING;
+        QAbstractSocket *socket = nullptr;
+        QByteArray request;     // the UDP probes
+        qint64 elapsedMs = 0;
+    };
+
+    QVector<Probe> probes_;
+    QTimer timeoutTimer_;
+    QTimer resendTimer_;
+    QElapsedTimer elapsedTimer_;
+    int neutralTimeMs_ = UDP_NEUTRAL_TIME;
+    WINNER_ORDER winnerOrder_ = WINNER_PRIORITY;
+
+    void startProbe(int ind);
+    void setProbeState(QObject *socket, PROBE_STATE state);
+    void checkFinished();
+    bool isNeutral(const Probe &probe) const;
+    // -1 if none
+    int firstNeutral() const;
+    void finish(int winnerIndex);
+    void closeSockets();
+    void sendUdpRequest(Probe &probe);
+
+    static QByteArray makeIkeSaInitRequest();
+    static QByteArray makeOpenVpnHardResetRequest();
+};
+
+#endif // CONNECTIONRACER_H
@@ -0,0 +1,187 @@
+#include "connecttimeline.h"
+#include "utils/logger.h"
+#include "utils/tracespan.h"
+#include "engine/enginemetrics.h"
+
+#include <algorithm>
+
+namespace {
+
+// the trace spans keep the pointers to the names
+const char *const STAGE_NAMES[ConnectTimeline::STAGES_COUNT] = {
+    "resolve", "node race", "race", "wireguard config", "tunnel process", "handshake", "helper", "tunnel test"
+};
+
+} // namespace
+
+ConnectTimeline::ConnectTimeline() : isActive_(false), currentStage_(-1), stageStartUs_(0), historyHead_(0),
+    isConnectionActive_(false), connectionStartUs_(0), connectionAttempts_(0)
+{
+    history_.reserve(HISTORY_SIZE);
+    std::fill(connectionStageMs_, connectionStageMs_ + STAGES_COUNT, 0);
+    std::fill(connectionStagePasses_, connectionStagePasses_ + STAGES_COUNT, 0);
+}
+
+void ConnectTimeline::startAttempt()
+{
+    if (isActive_)
+    {
+        finishAttempt("failed");
+    }
+
+    current_.startUs = TraceSpan::nowUs();
+    current_.protocol.clear();
+    current_.port = 0;
+    current_.networkType.clear();
+    std::fill(current_.stageMs, current_.stageMs + STAGES_COUNT, -1);
+    current_.totalMs = 0;
+    current_.result.clear();
+    isActive_ = true;
+    currentStage_ = -1;
+}
+
+void ConnectTimeline::setDescription(const QString &protocol, uint port, const QString &networkType)
+{
+    current_.protocol = protocol;
+    current_.port = port;
+    current_.networkType = networkType;
+}
+
+void ConnectTimeline::startStage(STAGE stage)
+{
+    if (!isActive_)
+    {
+        return;
+    }
+    const qint64 nowUs = TraceSpan::nowUs();
+    endStage(nowUs);
+    currentStage_ = stage;
+    stageStartUs_ = nowUs;
+}
+
+void ConnectTimeline::finishAttempt(const QString &result)
+{
+    if (!isActive_)
+    {
+        return;
+    }
+    const qint64 nowUs = TraceSpan::nowUs();
+    endStage(nowUs);
+    current_.totalMs = (nowUs - current_.startUs) / 1000;
+    current_.result = result;
+    isActive_ = false;
+
+    EngineMetrics::instance().addCount("windscribe_connect_attempts_total", "result", result);
+    EngineMetrics::instance().observeMs("windscribe_connect_attempt_ms", current_.totalMs, "result", result);
+
+    qCDebug(LOG_CONNECTION) << "Connect attempt:" << toString(current_);
+
+    if (isConnectionActive_)
+    {
+        connectionAttempts_++;
+        for (int i = 0; i < STAGES_COUNT; ++i)
+        {
+            if (current_.stageMs[i] >= 0)
+            {
+                connectionStageMs_[i] += current_.stageMs[i];
+                connectionStagePasses_[i]++;
+            }
+        }
+    }
+
+    if (history_.count() < HISTORY_SIZE)
+    {
+        history_ << current_;
+    }
+    else
+    {
+        history_[historyHead_] = current_;
+    }
+    historyHead_ = (historyHead_ + 1) % HISTORY_SIZE;
+}
+
+void ConnectTimeline::startConnection()
+{
+    if (isConnectionActive_)
+    {
+        return;
+    }
+    isConnectionActive_ = true;
+    connectionStartUs_ = TraceSpan::nowUs();
+    connectionAttempts_ = 0;
+    std::fill(connectionStageMs_, connectionStageMs_ + STAGES_COUNT, 0);
+    std::fill(connectionStagePasses_, connectionStagePasses_ + STAGES_COUNT, 0);
+}
+
+void ConnectTimeline::finishConnection(const QString &result)
+{
+    if (!isConnectionActive_)
+    {
+        return;
+    }
+    finishAttempt(result);
+    isConnectionActive_ = false;
+
+    QString stages;
+    for (int i = 0; i < STAGES_COUNT; ++i)
+    {
+        if (connectionStagePasses_[i] > 0)
+        {
+            if (!stages.isEmpty())
+            {
+                stages += ", ";
+            }
+            stages += QString("%1 %2 ms in %3").arg(STAGE_NAMES[i]).arg(connectionStageMs_[i]).arg(connectionStagePasses_[i]);
+        }
+    }
+    qCDebug(LOG_CONNECTION) << "Connection summary:" << result << "in" << (TraceSpan::nowUs() - connectionStartUs_) / 1000
+                            << "ms," << connectionAttempts_ << "attempts, stages (total, attempts):" << qPrintable(stages);
+}
+
+void ConnectTimeline::writeHistoryToLog() const
+{
+    if (history_.isEmpty())
+    {
+        return;
+    }
+    qCDebug(LOG_CONNECTION) << "Last connect attempts:";
+    // the oldest first
+    const int first = history_.count() < HISTORY_SIZE ? 0 : historyHead_;
+    for (int i = 0; i < history_.count(); ++i)
+    {
+        qCDebug(LOG_CONNECTION) << "   " << toString(history_[(first + i) % history_.count()]);
+    }
+}
+
+void ConnectTimeline::endStage(qint64 nowUs)
+{
+    if (currentStage_ < 0)
+    {
+        return;
+    }
+    // a stage can be passed several times in an attempt (e.g. the handshake after a failed WireGuard config request)
+    const qint64 ms = (nowUs - stageStartUs_) / 1000;
+    current_.stageMs[currentStage_] = qMax<qint64>(current_.stageMs[currentStage_], 0) + ms;
+    TraceSpan::record("connect", STAGE_NAMES[currentStage_], stageStartUs_);
+    EngineMetrics::instance().observeMs("windscribe_connect_stage_ms", ms, "stage", STAGE_NAMES[currentStage_]);
+    currentStage_ = -1;
+}
+
+QString ConnectTimeline::toString(const Attempt &attempt)
+{
+    QString stages;
+    for (int i = 0; i < STAGES_COUNT; ++i)
+    {
+        if (attempt.stageMs[i] >= 0)
+        {
+            if (!stages.isEmpty())
+            {
+                stages += ", ";
+            }
+            stages += QString("%1 %2").arg(STAGE_NAMES[i]).arg(attempt.stageMs[i]);
+        }
+    }
+    return QString("%1:%2 %3, %4 in %5 ms (%6)").arg(attempt.protocol.isEmpty() ? "-" : attempt.protocol)
+            .arg(attempt.port).arg(attempt.networkType.isEmpty() ? "-" : attempt.networkType)
+            .arg(attempt.result).arg(attempt.totalMs).arg(stages);
+}
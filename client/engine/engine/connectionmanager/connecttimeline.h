@@ -0,0 +1,67 @@
+#ifndef CONNECTTIMELINE_H
+#define CONNECTTIMELINE_H
+
+#include <QString>
+#include <QVector>
+
+// The timing of the stages of the connection attempts, to find the stage which makes the connection slower.
+// The stages follow each other, startStage() ends the running one. Each stage is written to the log as a trace span
+// (the timeline of the log viewer), each attempt as one summary line with the protocol, port and network type.
+// The last HISTORY_SIZE attempts are kept for the debug log, the durations also go to EngineMetrics.
+// A connection (from the user click or the reconnect to the connected state or the give-up) can take several
+// attempts, its per-stage totals are written as one summary line when it finishes.
+class ConnectTimeline
+{
+public:
+    enum STAGE { STAGE_RESOLVE, STAGE_NODE_RACE, STAGE_RACE, STAGE_WIREGUARD_CONFIG, STAGE_TUNNEL_PROCESS, STAGE_HANDSHAKE,
+                 STAGE_HELPER, STAGE_TUNNEL_TEST, STAGES_COUNT };
+
+    ConnectTimeline();
+
+    // finishes the active attempt as failed, e.g. a retry after an error
+    void startAttempt();
+    void setDescription(const QString &protocol, uint port, const QString &networkType);
+    void startStage(STAGE stage);
+    void finishAttempt(const QString &result);
+    bool isActive() const { return isActive_; }
+
+    // startConnection() does nothing if the connection is already started, e.g. a reconnect during the connection
+    void startConnection();
+    // finishes the active attempt with the same result
+    void finishConnection(const QString &result);
+
+    void writeHistoryToLog() const;
+
+private:
+    enum { HISTORY_SIZE = 16 };
+
+    struct Attempt
+    {
+        qint64 startUs;
+        QString protocol;
+        uint port;
+        QString networkType;
+        qint64 stageMs[STAGES_COUNT];   // -1 if the stage is not passed
+        qint64 totalMs;
+        QString result;
+    };
+
+    Attempt current_;
+    bool isActive_;
+    int currentStage_;                  // -1 if none
+    qint64 stageStartUs_;
+
+    QVector<Attempt> history_;          // ring
+    int historyHead_;
+
+    bool isConnectionActive_;
+    qint64 connectionStartUs_;
+    int connectionAttempts_;
+    qint64 connectionStageMs_[STAGES_COUNT];
+    int connectionStagePasses_[STAGES_COUNT];   // the attempts which passed the stage
+
+    void endStage(qint64 nowUs);
+    static QString toString(const Attempt &attempt);
+};
+
+#endif // CONNECTTIMELINE_H
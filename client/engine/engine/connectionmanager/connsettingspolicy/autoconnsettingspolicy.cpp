@@ -2,15 +2,18 @@
 
 #include <QDataStream>
 #include <QSettings>
+#include <algorithm>
 #include "utils/logger.h"
 
 int AutoConnSettingsPolicy::failedIkev2Counter_ = 0;
 
 AutoConnSettingsPolicy::AutoConnSettingsPolicy(QSharedPointer<locationsmodel::BaseLocationInfo> bli,
-                                               const apiinfo::PortMap &portMap, bool isProxyEnabled)
+                                               const apiinfo::PortMap &portMap, bool isProxyEnabled, const QString &networkId)
+    : history_(networkId)
 {
     attemps_.clear();
     curAttempt_ = 0;
+    attempsPerNode_ = 0;
     bIsAllFailed_ = false;
     isFailedIkev2CounterAlreadyIncremented_ = false;
     portMap_ = portMap;
@@ -18,73 +21,64 @@ AutoConnSettingsPolicy::AutoConnSettingsPolicy(QSharedPointer<locationsmodel::Ba
     Q_ASSERT(!locationInfo_.isNull());
     Q_ASSERT(!locationInfo_->locationId().isCustomConfigsLocation());
 
-    // remove wstunnel and WireGuard protocols from portMap_ for automatic connection mode
-    QVector<apiinfo::PortItem>::iterator it = portMap_.items().begin();
-    while (it != portMap_.items().end())
+    ProtocolType lastSuccessProtocolSaved;
     {
-        if (it->protocol.getType() == ProtocolType::PROTOCOL_WSTUNNEL ||
-            it->protocol.getType() == ProtocolType::PROTOCOL_WIREGUARD)
-        {
-            it = portMap_.items().erase(it);
-        }
-        else
+        QSettings settings;
+        if (settings.contains("successConnectionProtocol"))
         {
-            ++it;
+            QByteArray arr = settings.value("successConnectionProtocol").toByteArray();
+            QDataStream stream(&arr, QIODevice::ReadOnly);
+            QString strProtocol;
+            stream >> strProtocol;
+            lastSuccessProtocolSaved = ProtocolType(strProtocol);
         }
     }
-
-    // sort portmap protocols in the following order: ikev2, udp, tcp, stealth
-    std::sort(portMap_.items().begin(), portMap_.items().end(), sortPortMapFunction);
-
-    ProtocolType lastSuccessProtocolSaved;
-    QSettings settings;
-    if (settings.contains("successConnectionProtocol"))
-    {
-        QByteArray arr = settings.value("successConnectionProtocol").toByteArray();
-        QDataStream stream(&arr, QIODevice::ReadOnly);
-        QString strProtocol;
-        stream >> strProtocol;
-        lastSuccessProtocolSaved = ProtocolType(strProtocol);
-    }
-
+    const ProtocolType networkBestProtocol = history_.bestProtocol();
 
     QVector<AttemptInfo> localAttemps;
-    for (int portMapInd = 0; portMapInd < portMap_.items().count(); ++portMapInd)
+    // the protocols of the automatic mode (without wstunnel and WireGuard) in the order ikev2, udp, tcp, stealth
+    for (int portMapInd : portMap_.autoConnectOrder())
     {
+        const apiinfo::PortItem &portItem = portMap_.const_items()[portMapInd];
         // skip udp protocol, if proxy enabled
-        if (isProxyEnabled && portMap_.items()[portMapInd].protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
+        if (isProxyEnabled && portItem.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
         {
             continue;
         }
         // skip ikev2 protocol if failed ikev2 attempts >= MAX_IKEV2_FAILED_ATTEMPTS
-        if (failedIkev2Counter_ >= MAX_IKEV2_FAILED_ATTEMPTS && portMap_.items()[portMapInd].protocol.isIkev2Protocol())
+        if (failedIkev2Counter_ >= MAX_IKEV2_FAILED_ATTEMPTS && portItem.protocol.isIkev2Protocol())
         {
             continue;
         }
 
         AttemptInfo attemptInfo;
-        attemptInfo.protocol = portMap_.items()[portMapInd].protocol;
-        Q_ASSERT(portMap_.items()[portMapInd].ports.count() > 0);
+        attemptInfo.protocol = portItem.protocol;
+        Q_ASSERT(portItem.ports.count() > 0);
         attemptInfo.portMapInd = portMapInd;
         attemptInfo.changeNode = false;
 
         localAttemps << attemptInfo;
     }
 
-    if (localAttemps.count() > 0)
+    // the protocols failed on this network recently are tried last
+    if (history_.isValid())
     {
-        localAttemps.last().changeNode = true;
+        std::stable_partition(localAttemps.begin(), localAttemps.end(), [this](const AttemptInfo &a) {
+            return !history_.isFailedRecently(a.protocol);
+        });
     }
 
-    // if we have successfully saved connection settings, then use it first (move on top list)
-    // but if first protocol ikev2, then use it second
-    if (lastSuccessProtocolSaved.isInitialized())
+    // the recent winner on this network goes first,
+    // otherwise the global successfully saved connection settings are used first (moved on top of the list),
+    // but if the first protocol is ikev2, then they are used second
+    const ProtocolType &firstProtocol = networkBestProtocol.isInitialized() ? networkBestProtocol : lastSuccessProtocolSaved;
+    if (firstProtocol.isInitialized() && !history_.isFailedRecently(firstProtocol))
     {
         AttemptInfo firstAttemptInfo;
         bool bFound = false;
         for (int i = 0; i < localAttemps.count(); ++i)
         {
-            if (localAttemps[i].protocol.isEqual(lastSuccessProtocolSaved))
+            if (localAttemps[i].protocol.isEqual(firstProtocol))
             {
                 firstAttemptInfo = localAttemps[i];
                 localAttemps.remove(i);
@@ -94,7 +88,7 @@ AutoConnSettingsPolicy::AutoConnSettingsPolicy(QSharedPointer<locationsmodel::Ba
         }
         if (bFound)
         {
-            if (localAttemps.count() > 0 && localAttemps.first().protocol.isIkev2Protocol())
+            if (!networkBestProtocol.isInitialized() && localAttemps.count() > 0 && localAttemps.first().protocol.isIkev2Protocol())
             {
                 localAttemps.insert(1, firstAttemptInfo);
             }
@@ -105,7 +99,13 @@ AutoConnSettingsPolicy::AutoConnSettingsPolicy(QSharedPointer<locationsmodel::Ba
         }
     }
 
+    if (localAttemps.count() > 0)
+    {
+        localAttemps.last().changeNode = true;
+    }
+
     // copy sorted localAttemps to attemps_
+    attempsPerNode_ = localAttemps.count();
     for (int nodeInd = 0; nodeInd < locationInfo_->nodesCount(); ++nodeInd)
     {
         attemps_ << localAttemps;
@@ -125,6 +125,10 @@ void AutoConnSettingsPolicy::debugLocationInfoToLog() const
 {
     qCDebug(LOG_CONNECTION) << "Connection settings: automatic";
     qCDebug(LOG_CONNECTION) << locationInfo_->getLogString();
+    if (history_.isValid())
+    {
+        qCDebug(LOG_CONNECTION) << "Connection history of the network:" << history_.logString();
+    }
 }
 
 void AutoConnSettingsPolicy::putFailedConnection()
@@ -134,6 +138,8 @@ void AutoConnSettingsPolicy::putFailedConnection()
         return;
     }
 
+    history_.putFailure(attemps_[curAttempt_].protocol, portMap_.const_items()[attemps_[curAttempt_].portMapInd].ports[0]);
+
     if (attemps_[curAttempt_].protocol.isIkev2Protocol() && !isFailedIkev2CounterAlreadyIncremented_)
     {
         failedIkev2Counter_++;
@@ -165,35 +171,7 @@ bool AutoConnSettingsPolicy::isFailed() const
 
 CurrentConnectionDescr AutoConnSettingsPolicy::getCurrentConnectionSettings() const
 {
-    CurrentConnectionDescr ccd;
-
-    ccd.connectionNodeType = CONNECTION_NODE_DEFAULT;
-    ccd.protocol = attemps_[curAttempt_].protocol;
-    ccd.port = portMap_.const_items()[attemps_[curAttempt_].portMapInd].ports[0];
-
-    int useIpInd = portMap_.getUseIpInd(ccd.protocol);
-    ccd.ip = locationInfo_->getIpForSelectedNode(useIpInd);
-    ccd.hostname = locationInfo_->getHostnameForSelectedNode();
-    ccd.dnsHostName = locationInfo_->getDnsName();
-    ccd.wgPeerPublicKey = locationInfo_->getWgPubKeyForSelectedNode();
-    ccd.verifyX509name = locationInfo_->getVerifyX509name();
-
-    // for static IP set additional fields
-    if (locationInfo_->locationId().isStaticIpsLocation())
-    {
-        ccd.connectionNodeType = CONNECTION_NODE_STATIC_IPS;
-        ccd.username = locationInfo_->getStaticIpUsername();
-        ccd.password = locationInfo_->getStaticIpPassword();
-        ccd.staticIpPorts = locationInfo_->getStaticIpPorts();
-
-        // for static ip with wireguard protocol override id to wg_ip
-        if (ccd.protocol.getType() == ProtocolType::PROTOCOL_WIREGUARD )
-        {
-            ccd.ip = locationInfo_->getWgIpForSelectedNode();
-        }
-    }
-
-    return ccd;
+    return makeConnectionDescr(attemps_[curAttempt_]);
 }
 
 void AutoConnSettingsPolicy::saveCurrentSuccessfullConnectionSettings()
@@ -214,6 +192,9 @@ void AutoConnSettingsPolicy::saveCurrentSuccessfullConnectionSettings()
         stream << protocol;
     }
     settings.setValue("successConnectionProtocol", arr);
+
+    history_.putSuccess(attemps_[curAttempt_].protocol, portMap_.const_items()[attemps_[curAttempt_].portMapInd].ports[0],
+                        lastConnectionTimeMs_);
 }
 
 bool AutoConnSettingsPolicy::isAutomaticMode()
@@ -227,44 +208,115 @@ void AutoConnSettingsPolicy::resolveHostnames()
     emit hostnamesResolved();
 }
 
-// sort portmap protocols in the following order: ikev2, udp, tcp, stealth
-// operator<
-bool AutoConnSettingsPolicy::sortPortMapFunction(const apiinfo::PortItem &p1, const apiinfo::PortItem &p2)
+QVector<CurrentConnectionDescr> AutoConnSettingsPolicy::getRaceCandidates() const
 {
-    if (p1.protocol.getType() == ProtocolType::PROTOCOL_IKEV2)
+    QVector<CurrentConnectionDescr> candidates;
+    if (attempsPerNode_ == 0 || bIsAllFailed_)
     {
-        return true;
+        return candidates;
     }
-    else if (p1.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
+    // the attempts of a node are consecutive, the last one changes the node
+    const int nodeEnd = (curAttempt_ / attempsPerNode_ + 1) * attempsPerNode_;
+    for (int i = curAttempt_; i < nodeEnd && i < attemps_.count(); ++i)
     {
-        if (p2.protocol.getType() == ProtocolType::PROTOCOL_IKEV2 || p2.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
-        {
-            return false;
-        }
-        else
-        {
-            return true;
-        }
+        candidates << makeConnectionDescr(attemps_[i]);
     }
-    else if (p1.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_TCP)
+    return candidates;
+}
+
+void AutoConnSettingsPolicy::selectRaceWinner(const ProtocolType &protocol)
+{
+    if (attempsPerNode_ == 0)
     {
-        if (p2.protocol.getType() == ProtocolType::PROTOCOL_IKEV2 || p2.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP
-                || p2.protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_TCP)
+        return;
+    }
+    const int nodeBegin = (curAttempt_ / attempsPerNode_) * attempsPerNode_;
+    const int nodeEnd = qMin(nodeBegin + attempsPerNode_, attemps_.count());
+    for (int i = curAttempt_; i < nodeEnd; ++i)
+    {
+        if (attemps_[i].protocol.isEqual(protocol))
         {
-            return false;
+            // the skipped protocols are tried after the winner if it fails
+            const AttemptInfo winner = attemps_[i];
+            attemps_.remove(i);
+            attemps_.insert(curAttempt_, winner);
+            for (int j = nodeBegin; j < nodeEnd; ++j)
+            {
+                attemps_[j].changeNode = (j == nodeEnd - 1);
+            }
+            return;
         }
-        else
+    }
+}
+
+QVector<CurrentConnectionDescr> AutoConnSettingsPolicy::getNodeRaceCandidates(int maxCount) const
+{
+    QVector<CurrentConnectionDescr> candidates;
+    // only before the first attempt on a node, the winner skips all the attempts of the nodes before it
+    if (attempsPerNode_ == 0 || bIsAllFailed_ || (curAttempt_ % attempsPerNode_) != 0 ||
+        locationInfo_->locationId().isStaticIpsLocation())
+    {
+        return candidates;
+    }
+    const CurrentConnectionDescr current = makeConnectionDescr(attemps_[curAttempt_]);
+    const int useIpInd = portMap_.getUseIpInd(current.protocol);
+    for (int i = 0; i < maxCount && curAttempt_ + i * attempsPerNode_ < attemps_.count(); ++i)
+    {
+        const int indNode = locationInfo_->getNodeInOrder(i);
+        if (indNode < 0)
         {
-            return true;
+            break;
         }
+        CurrentConnectionDescr ccd = current;
+        ccd.ip = locationInfo_->getIpForNode(indNode, useIpInd);
+        ccd.hostname = locationInfo_->getHostnameForNode(indNode);
+        candidates << ccd;
     }
-    else if (p1.protocol.getType() == ProtocolType::PROTOCOL_STUNNEL)
+    return candidates;
+}
+
+void AutoConnSettingsPolicy::selectNodeRaceWinner(int candidateIndex)
+{
+    if (candidateIndex <= 0 || attempsPerNode_ == 0 || curAttempt_ + candidateIndex * attempsPerNode_ >= attemps_.count())
     {
-        return false;
+        return;
     }
-    else
+    for (int i = 0; i < candidateIndex; ++i)
     {
-        Q_ASSERT(false);
+        locationInfo_->selectNextNode();
     }
-    return 0;
+    curAttempt_ += candidateIndex * attempsPerNode_;
+}
+
+CurrentConnectionDescr AutoConnSettingsPolicy::makeConnectionDescr(const AttemptInfo &attempt) const
+{
+    CurrentConnectionDescr ccd;
+
+    ccd.connectionNodeType = CONNECTION_NODE_DEFAULT;
+    ccd.protocol = attempt.protocol;
+    ccd.port = portMap_.const_items()[attempt.portMapInd].ports[0];
+
+    int useIpInd = portMap_.getUseIpInd(ccd.protocol);
+    ccd.ip = locationInfo_->getIpForSelectedNode(useIpInd);
+    ccd.hostname = locationInfo_->getHostnameForSelectedNode();
+    ccd.dnsHostName = locationInfo_->getDnsName();
+    ccd.wgPeerPublicKey = locationInfo_->getWgPubKeyForSelectedNode();
+    ccd.verifyX509name = locationInfo_->getVerifyX509name();
+
+    // for static IP set additional fields
+    if (locationInfo_->locationId().isStaticIpsLocation())
+    {
+        ccd.connectionNodeType = CONNECTION_NODE_STATIC_IPS;
+        ccd.username = locationInfo_->getStaticIpUsername();
+        ccd.password = locationInfo_->getStaticIpPassword();
+        ccd.staticIpPorts = locationInfo_->getStaticIpPorts();
+
+        // for static ip with wireguard protocol override id to wg_ip
+        if (ccd.protocol.getType() == ProtocolType::PROTOCOL_WIREGUARD )
+        {
+            ccd.ip = locationInfo_->getWgIpForSelectedNode();
+        }
+    }
+
+    return ccd;
 }
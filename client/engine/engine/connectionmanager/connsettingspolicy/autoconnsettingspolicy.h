@@ -2,6 +2,7 @@
 #define AUTOCONNSETTINGSPOLICY_H
 
 #include "baseconnsettingspolicy.h"
+#include "connectionhistory.h"
 #include "engine/locationsmodel/mutablelocationinfo.h"
 
 // // manage automatic connection mode (only for API and static ips locations)
@@ -9,7 +10,9 @@ class AutoConnSettingsPolicy : public BaseConnSettingsPolicy
 {
     Q_OBJECT
 public:
-    AutoConnSettingsPolicy(QSharedPointer<locationsmodel::BaseLocationInfo> bli, const apiinfo::PortMap &portMap, bool isProxyEnabled);
+    // the connection results are kept for the network (networkId is the network or SSID name), see ConnectionHistory
+    AutoConnSettingsPolicy(QSharedPointer<locationsmodel::BaseLocationInfo> bli, const apiinfo::PortMap &portMap, bool isProxyEnabled,
+                           const QString &networkId);
 
     void reset() override;
     void debugLocationInfoToLog() const override;
@@ -19,6 +22,10 @@ public:
     void saveCurrentSuccessfullConnectionSettings() override;
     bool isAutomaticMode() override;
     void resolveHostnames() override;
+    QVector<CurrentConnectionDescr> getRaceCandidates() const override;
+    void selectRaceWinner(const ProtocolType &protocol) override;
+    QVector<CurrentConnectionDescr> getNodeRaceCandidates(int maxCount) const override;
+    void selectNodeRaceWinner(int candidateIndex) override;
 
 private:
     struct AttemptInfo
@@ -30,6 +37,8 @@ private:
 
     QVector<AttemptInfo> attemps_;
     int curAttempt_;
+    int attempsPerNode_;
+    ConnectionHistory history_;
     static int failedIkev2Counter_;
     bool isFailedIkev2CounterAlreadyIncremented_;
     static const int MAX_IKEV2_FAILED_ATTEMPTS = 5;
@@ -38,7 +47,7 @@ private:
     apiinfo::PortMap portMap_;
     bool bIsAllFailed_;
 
-    static bool sortPortMapFunction(const apiinfo::PortItem &p1, const apiinfo::PortItem &p2);
+    CurrentConnectionDescr makeConnectionDescr(const AttemptInfo &attempt) const;
 };
 
 #endif // AUTOCONNSETTINGSPOLICY_H
@@ -1,6 +1,7 @@
 #ifndef BASECONNSETTINGSPOLICY_H
 #define BASECONNSETTINGSPOLICY_H
 
+#include <QVector>
 #include "engine/apiinfo/staticips.h"
 #include "engine/apiinfo/portmap.h"
 #include "engine/wireguardconfig/wireguardconfig.h"
@@ -45,7 +46,7 @@ class BaseConnSettingsPolicy : public QObject
 {
     Q_OBJECT
 public:
-    BaseConnSettingsPolicy() : QObject(nullptr), bStarted_(false) {}
+    BaseConnSettingsPolicy() : QObject(nullptr), bStarted_(false), lastConnectionTimeMs_(0) {}
     virtual ~BaseConnSettingsPolicy() {}
 
     //virtual void startWith(QSharedPointer<const locationsmodel::BaseLocationInfo> mli, const ConnectionSettings &connectionSettings,
@@ -58,6 +59,11 @@ public:
     {
         bStarted_ = false;
     }
+    // the time from the start of the current attempt to the connected state
+    void setLastConnectionTime(qint64 ms)
+    {
+        lastConnectionTimeMs_ = ms;
+    }
 
     virtual void reset() = 0;
     virtual void debugLocationInfoToLog() const = 0;
@@ -68,11 +74,28 @@ public:
     virtual bool isAutomaticMode() = 0;
     virtual void resolveHostnames() = 0;
 
+    // the remaining protocols/ports of the current node for ConnectionRacer, in the order of the attempts
+    // empty if the policy doesn't race the protocols
+    virtual QVector<CurrentConnectionDescr> getRaceCandidates() const { return QVector<CurrentConnectionDescr>(); }
+    // the protocol which answered first becomes the current attempt
+    virtual void selectRaceWinner(const ProtocolType &protocol) { Q_UNUSED(protocol); }
+
+    // the current attempt on the next nodes of the location, the current node first, at most maxCount
+    // empty if the policy doesn't race the nodes
+    virtual QVector<CurrentConnectionDescr> getNodeRaceCandidates(int maxCount) const
+    {
+        Q_UNUSED(maxCount);
+        return QVector<CurrentConnectionDescr>();
+    }
+    // the node which answered first becomes the current one, the index is in getNodeRaceCandidates()
+    virtual void selectNodeRaceWinner(int candidateIndex) { Q_UNUSED(candidateIndex); }
+
 signals:
     void hostnamesResolved();
 
 protected:
     bool bStarted_;
+    qint64 lastConnectionTimeMs_;
 };
 
 #endif // BASECONNSETTINGSPOLICY_H
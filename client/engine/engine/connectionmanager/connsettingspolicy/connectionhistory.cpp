@@ -0,0 +1,249 @@
+#include "connectionhistory.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QSettings>
+#include <QStringList>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+const char *SETTINGS_GROUP = "connectionHistory";
+const quint32 VERSION = 1;
+const double HALF_LIFE_SECS = 7 * 24 * 60 * 60;
+const double MIN_SUCCESS_WEIGHT = 0.1;  // a single success is forgotten in ~3 weeks
+const double FAILED_WEIGHT = 2.0;       // two failures during the last days
+const int MAX_NETWORKS = 50;
+
+qint64 currentTime()
+{
+    return QDateTime::currentSecsSinceEpoch();
+}
+
+} // namespace
+
+ConnectionHistory::ConnectionHistory(const QString &networkId)
+{
+    // the SSID is hashed, it can have the characters which QSettings doesn't allow in the keys
+    if (!networkId.isEmpty())
+    {
+        settingsKey_ = QString(SETTINGS_GROUP) + "/" +
+            QString::fromLatin1(QCryptographicHash::hash(networkId.toUtf8(), QCryptographicHash::Md5).toHex());
+        load();
+    }
+}
+
+ConnectionHistory::~ConnectionHistory()
+{
+    if (isModified_)
+    {
+        save();
+    }
+}
+
+void ConnectionHistory::putSuccess(const ProtocolType &protocol, uint port, qint64 connectionTimeMs)
+{
+    if (!isValid())
+    {
+        return;
+    }
+    Entry &entry = findOrAddEntry(protocol, port);
+    entry.successCount++;
+    entry.failuresSinceSuccess = 0;
+    entry.lastSuccessTime = currentTime();
+    entry.connectionTimeMs = static_cast<quint32>(qBound<qint64>(0, connectionTimeMs, UINT_MAX));
+    save();
+}
+
+void ConnectionHistory::putFailure(const ProtocolType &protocol, uint port)
+{
+    if (!isValid())
+    {
+        return;
+    }
+    Entry &entry = findOrAddEntry(protocol, port);
+    entry.failuresSinceSuccess++;
+    entry.lastFailureTime = currentTime();
+    isModified_ = true;
+}
+
+ProtocolType ConnectionHistory::bestProtocol() const
+{
+    const qint64 now = currentTime();
+    const Entry *best = nullptr;
+    double bestWeight = 0;
+    for (const Entry &entry : entries_)
+    {
+        if (entry.successCount == 0)
+        {
+            continue;
+        }
+        // the failures after the success make the winner less certain
+        const double weight = decay(entry.lastSuccessTime, now) / (1 + entry.failuresSinceSuccess);
+        if (weight < MIN_SUCCESS_WEIGHT)
+        {
+            continue;
+        }
+        if (!best || weight > bestWeight || (weight == bestWeight && entry.connectionTimeMs < best->connectionTimeMs))
+        {
+            best = &entry;
+            bestWeight = weight;
+        }
+    }
+    return best ? ProtocolType(best->protocol) : ProtocolType();
+}
+
+bool ConnectionHistory::isFailedRecently(const ProtocolType &protocol) const
+{
+    const Entry *entry = findEntry(protocol);
+    if (!entry || entry->failuresSinceSuccess == 0)
+    {
+        return false;
+    }
+    return entry->failuresSinceSuccess * decay(entry->lastFailureTime, currentTime()) >= FAILED_WEIGHT;
+}
+
+QString ConnectionHistory::logString() const
+{
+    QStringList list;
+    const qint64 now = currentTime();
+    for (const Entry &entry : entries_)
+    {
+        list << QString("%1:%2 success %3 (%4 h ago, %5 ms), failures %6").arg(entry.protocol).arg(entry.port)
+                .arg(entry.successCount).arg(entry.lastSuccessTime ? (now - entry.lastSuccessTime) / 3600 : -1)
+                .arg(entry.connectionTimeMs).arg(entry.failuresSinceSuccess);
+    }
+    return list.isEmpty() ? QString("empty") : list.join("; ");
+}
+
+ConnectionHistory::Entry &ConnectionHistory::findOrAddEntry(const ProtocolType &protocol, uint port)
+{
+    const QString strProtocol = protocol.toLongString();
+    for (Entry &entry : entries_)
+    {
+        if (entry.protocol == strProtocol)
+        {
+            // the port of the protocol can change in the port map
+            if (entry.port != port)
+            {
+                entry = Entry();
+                entry.protocol = strProtocol;
+                entry.port = port;
+            }
+            return entry;
+        }
+    }
+    Entry entry;
+    entry.protocol = strProtocol;
+    entry.port = port;
+    entries_ << entry;
+    return entries_.last();
+}
+
+const ConnectionHistory::Entry *ConnectionHistory::findEntry(const ProtocolType &protocol) const
+{
+    const QString strProtocol = protocol.toLongString();
+    for (const Entry &entry : entries_)
+    {
+        if (entry.protocol == strProtocol)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+double ConnectionHistory::decay(qint64 time, qint64 now)
+{
+    const qint64 age = qMax<qint64>(0, now - time);
+    return std::pow(0.5, age / HALF_LIFE_SECS);
+}
+
+void ConnectionHistory::load()
+{
+    QSettings settings;
+    QByteArray arr = settings.value(settingsKey_).toByteArray();
+    if (arr.isEmpty())
+    {
+        return;
+    }
+    isStored_ = true;
+
+    QDataStream stream(&arr, QIODevice::ReadOnly);
+    quint32 version;
+    qint64 lastUsedTime;
+    quint32 count;
+    stream >> version >> lastUsedTime >> count;
+    if (stream.status() != QDataStream::Ok || version != VERSION)
+    {
+        return;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        Entry entry;
+        stream >> entry.protocol >> entry.port >> entry.successCount >> entry.failuresSinceSuccess
+               >> entry.lastSuccessTime >> entry.lastFailureTime >> entry.connectionTimeMs;
+        entries_ << entry;
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        entries_.clear();
+    }
+}
+
+void ConnectionHistory::save()
+{
+    QByteArray arr;
+    {
+        QDataStream stream(&arr, QIODevice::WriteOnly);
+        stream << VERSION << currentTime() << static_cast<quint32>(entries_.count());
+        for (const Entry &entry : entries_)
+        {
+            stream << entry.protocol << entry.port << entry.successCount << entry.failuresSinceSuccess
+                   << entry.lastSuccessTime << entry.lastFailureTime << entry.connectionTimeMs;
+        }
+    }
+
+    {
+        QSettings settings;
+        settings.setValue(settingsKey_, arr);
+    }
+    isModified_ = false;
+    // only a new network can exceed the limit
+    if (!isStored_)
+    {
+        isStored_ = true;
+        removeOldNetworks();
+    }
+}
+
+void ConnectionHistory::removeOldNetworks()
+{
+    QSettings settings;
+    settings.beginGroup(SETTINGS_GROUP);
+    const QStringList keys = settings.childKeys();
+    if (keys.count() <= MAX_NETWORKS)
+    {
+        return;
+    }
+
+    // the networks not used for the longest time are removed
+    QVector<QPair<qint64, QString> > networks;
+    for (const QString &key : keys)
+    {
+        QByteArray arr = settings.value(key).toByteArray();
+        QDataStream stream(&arr, QIODevice::ReadOnly);
+        quint32 version = 0;
+        qint64 lastUsedTime = 0;
+        stream >> version >> lastUsedTime;
+        networks << qMakePair(version == VERSION ? lastUsedTime : 0, key);
+    }
+    std::sort(networks.begin(), networks.end());
+    for (int i = 0; i < networks.count() - MAX_NETWORKS; ++i)
+    {
+        settings.remove(networks[i].second);
+    }
+}
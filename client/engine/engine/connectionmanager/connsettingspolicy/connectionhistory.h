@@ -0,0 +1,57 @@
+#ifndef CONNECTIONHISTORY_H
+#define CONNECTIONHISTORY_H
+
+#include <QString>
+#include <QVector>
+#include "engine/types/protocoltype.h"
+
+// Persistent results of the automatic mode connections on one network (the network or SSID name of the
+// current interface): for each protocol/port the successes, the failures since the last success and the connect time.
+// The results decay with the age (half-life of a week), so the old winner is retried first only while it's recent,
+// and the protocol which failed on the network is tried last until its failures decay.
+// The failures are written to the settings with the next success or on the destruction, not on every attempt.
+class ConnectionHistory
+{
+public:
+    explicit ConnectionHistory(const QString &networkId);
+    ~ConnectionHistory();
+
+    bool isValid() const { return !settingsKey_.isEmpty(); }
+
+    void putSuccess(const ProtocolType &protocol, uint port, qint64 connectionTimeMs);
+    void putFailure(const ProtocolType &protocol, uint port);
+
+    // the protocol to try first, uninitialized if there is no recent success on the network
+    ProtocolType bestProtocol() const;
+    // the protocols failed recently without the successes after the failures
+    bool isFailedRecently(const ProtocolType &protocol) const;
+
+    QString logString() const;
+
+private:
+    struct Entry
+    {
+        QString protocol;   // ProtocolType::toLongString()
+        quint32 port = 0;
+        quint32 successCount = 0;
+        quint32 failuresSinceSuccess = 0;
+        qint64 lastSuccessTime = 0;     // the seconds since the epoch
+        qint64 lastFailureTime = 0;
+        quint32 connectionTimeMs = 0;   // of the last success
+    };
+
+    QString settingsKey_;
+    QVector<Entry> entries_;
+    bool isModified_ = false;
+    bool isStored_ = false;     // the network is already in the settings
+
+    Entry &findOrAddEntry(const ProtocolType &protocol, uint port);
+    const Entry *findEntry(const ProtocolType &protocol) const;
+    static double decay(qint64 time, qint64 now);
+
+    void load();
+    void save();
+    static void removeOldNetworks();
+};
+
+#endif // CONNECTIONHISTORY_H
@@ -102,3 +102,44 @@ void ManualConnSettingsPolicy::resolveHostnames()
     //nothing todo
     emit hostnamesResolved();
 }
+
+QVector<CurrentConnectionDescr> ManualConnSettingsPolicy::getNodeRaceCandidates(int maxCount) const
+{
+    QVector<CurrentConnectionDescr> candidates;
+    if (locationInfo_->locationId().isStaticIpsLocation())
+    {
+        return candidates;
+    }
+    const CurrentConnectionDescr current = getCurrentConnectionSettings();
+    if (current.connectionNodeType != CONNECTION_NODE_DEFAULT)
+    {
+        return candidates;
+    }
+    const int useIpInd = portMap_.getUseIpInd(current.protocol);
+    for (int i = 0; i < maxCount; ++i)
+    {
+        const int indNode = locationInfo_->getNodeInOrder(i);
+        if (indNode < 0)
+        {
+            break;
+        }
+        CurrentConnectionDescr ccd = current;
+        ccd.ip = locationInfo_->getIpForNode(indNode, useIpInd);
+        ccd.hostname = locationInfo_->getHostnameForNode(indNode);
+        candidates << ccd;
+    }
+    return candidates;
+}
+
+void ManualConnSettingsPolicy::selectNodeRaceWinner(int candidateIndex)
+{
+    if (candidateIndex <= 0)
+    {
+        return;
+    }
+    for (int i = 0; i < candidateIndex; ++i)
+    {
+        locationInfo_->selectNextNode();
+    }
+    failedManualModeCounter_ = 0;
+}
@@ -22,6 +22,8 @@ public:
     void saveCurrentSuccessfullConnectionSettings() override;
     bool isAutomaticMode() override;
     void resolveHostnames() override;
+    QVector<CurrentConnectionDescr> getNodeRaceCandidates(int maxCount) const override;
+    void selectNodeRaceWinner(int candidateIndex) override;
 
 private:
     QSharedPointer<locationsmodel::MutableLocationInfo> locationInfo_;
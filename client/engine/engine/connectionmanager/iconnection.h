@@ -28,6 +28,8 @@ public:
     virtual bool isDisconnected() const = 0;
     virtual ConnectionType getConnectionType() const = 0;
     virtual bool isAllowFirewallAfterCustomConfigConnection() const { return true; }
+    // the GUI window is active, the statistics can be polled less often when it isn't
+    virtual void setApplicationActive(bool isActive) { Q_UNUSED(isActive); }
 
     virtual void continueWithUsernameAndPassword(const QString &username, const QString &password) = 0;
     virtual void continueWithPassword(const QString &password) = 0;
@@ -14,6 +14,8 @@
 IKEv2Connection_win *IKEv2Connection_win::this_ = NULL;
 // static global variable, because we reinstall WAN only once during the lifetime of the process
 bool IKEv2Connection_win::wanReinstalled_ = false;
+IKEv2Connection_win::PhonebookEntryDesc IKEv2Connection_win::lastPhonebookEntry_;
+bool IKEv2Connection_win::isLastPhonebookEntryValid_ = false;
 
 
 IKEv2Connection_win::IKEv2Connection_win(QObject *parent, IHelper *helper) : IConnection(parent),
@@ -96,6 +98,7 @@ bool IKEv2Connection_win::isDisconnected() const
 
 void IKEv2Connection_win::removeIkev2ConnectionFromOS()
 {
+    isLastPhonebookEntryValid_ = false;
     DWORD dwErr = RasDeleteEntry(NULL, IKEV2_CONNECTION_NAME);
     if (dwErr != ERROR_SUCCESS && dwErr != ERROR_CANNOT_FIND_PHONEBOOK_ENTRY)
     {
@@ -359,52 +362,69 @@ void IKEv2Connection_win::doConnect()
     }
 
 
-    RASENTRY rasEntry;
-    memset(&rasEntry, 0, sizeof(rasEntry));
-    rasEntry.dwSize = offsetof(RASENTRY, ipv6addr);
-    //rasEntry.dwSize = sizeof(RASENTRY);
+    PhonebookEntryDesc entry;
+    entry.url = initialUrl_;
+    entry.deviceName = QString::fromWCharArray(devInfo.szDeviceName);
+    entry.isEnableIkev2Compression = initialEnableIkev2Compression_;
+    entry.username = initialUsername_;
+    entry.password = initialPassword_;
 
-    wcscpy_s(rasEntry.szLocalPhoneNumber, initialUrl_.toStdWString().c_str());
-    wcscpy_s(rasEntry.szDeviceName, devInfo.szDeviceName);
-    wcscpy_s(rasEntry.szDeviceType, devInfo.szDeviceType);
-
-    rasEntry.dwfOptions = RASEO_RequireEAP  /*| RASEO_RemoteDefaultGateway*/;
-    if (initialEnableIkev2Compression_)
+    const bool isEntryChanged = !isLastPhonebookEntryValid_ || !lastPhonebookEntry_.isSameEntry(entry) || !isPhonebookEntryExists();
+    if (isEntryChanged)
     {
-        rasEntry.dwfOptions = rasEntry.dwfOptions | RASEO_IpHeaderCompression | RASEO_SwCompression;
-    }
+        isLastPhonebookEntryValid_ = false;
 
-    rasEntry.dwfOptions2 = RASEO2_DontNegotiateMultilink | RASEO2_ReconnectIfDropped /*| RASEO2_IPv6RemoteDefaultGateway*/ | RASEO2_IPv4ExplicitMetric | RASEO2_IPv6ExplicitMetric;
-    rasEntry.dwFramingProtocol = RASFP_Ppp;
-    rasEntry.dwEncryptionType = ET_RequireMax;
-    rasEntry.dwType = RASET_Vpn;
-    rasEntry.dwVpnStrategy = VS_Ikev2Only;
-    rasEntry.dwfNetProtocols = RASNP_Ip | RASNP_Ipv6;
-    rasEntry.dwRedialCount = 3;
-    rasEntry.dwRedialPause = 60;
-    rasEntry.dwIPv4InterfaceMetric = 1;  // minimum ipv4 metric
-    rasEntry.dwIPv6InterfaceMetric = 1;  // minimum ipv6 metric
-    rasEntry.dwIdleDisconnectSeconds = 60;  // 60 sec disconnect timeout
-    //rasEntry.dwNetworkOutageTime = 60; // it's unclear whether this works or not.
-
-
-    DWORD dwErr = RasSetEntryProperties(NULL, IKEV2_CONNECTION_NAME, &rasEntry, rasEntry.dwSize, NULL, NULL);
-    if (dwErr != ERROR_SUCCESS)
-    {
-        if (dwErr == ERROR_INVALID_SIZE)
+        RASENTRY rasEntry;
+        memset(&rasEntry, 0, sizeof(rasEntry));
+        rasEntry.dwSize = offsetof(RASENTRY, ipv6addr);
+        //rasEntry.dwSize = sizeof(RASENTRY);
+
+        wcscpy_s(rasEntry.szLocalPhoneNumber, initialUrl_.toStdWString().c_str());
+        wcscpy_s(rasEntry.szDeviceName, devInfo.szDeviceName);
+        wcscpy_s(rasEntry.szDeviceType, devInfo.szDeviceType);
+
+        rasEntry.dwfOptions = RASEO_RequireEAP  /*| RASEO_RemoteDefaultGateway*/;
+        if (initialEnableIkev2Compression_)
         {
-            // try manual size (bug in 17133.1, https://answers.microsoft.com/en-us/insider/forum/insider_wintp-insider_update-insiderplat_pc/ras-error-632-on-windows-insider-build-17083/aacf68b9-3171-4342-ab9e-cbd4e278d4a7?page=2)
-            rasEntry.dwSize = 6720;
-            dwErr = RasSetEntryProperties(NULL, IKEV2_CONNECTION_NAME, &rasEntry, rasEntry.dwSize, NULL, NULL);
+            rasEntry.dwfOptions = rasEntry.dwfOptions | RASEO_IpHeaderCompression | RASEO_SwCompression;
         }
+
+        rasEntry.dwfOptions2 = RASEO2_DontNegotiateMultilink | RASEO2_ReconnectIfDropped /*| RASEO2_IPv6RemoteDefaultGateway*/ | RASEO2_IPv4ExplicitMetric | RASEO2_IPv6ExplicitMetric;
+        rasEntry.dwFramingProtocol = RASFP_Ppp;
+        rasEntry.dwEncryptionType = ET_RequireMax;
+        rasEntry.dwType = RASET_Vpn;
+        rasEntry.dwVpnStrategy = VS_Ikev2Only;
+        rasEntry.dwfNetProtocols = RASNP_Ip | RASNP_Ipv6;
+        rasEntry.dwRedialCount = 3;
+        rasEntry.dwRedialPause = 60;
+        rasEntry.dwIPv4InterfaceMetric = 1;  // minimum ipv4 metric
+        rasEntry.dwIPv6InterfaceMetric = 1;  // minimum ipv6 metric
+        rasEntry.dwIdleDisconnectSeconds = 60;  // 60 sec disconnect timeout
+        //rasEntry.dwNetworkOutageTime = 60; // it's unclear whether this works or not.
+
+
+        DWORD dwErr = RasSetEntryProperties(NULL, IKEV2_CONNECTION_NAME, &rasEntry, rasEntry.dwSize, NULL, NULL);
         if (dwErr != ERROR_SUCCESS)
         {
-            qCDebug(LOG_IKEV2) << "RasSetEntryProperties failed with error:" << dwErr;
-            state_ = STATE_DISCONNECTED;
-            emit error(ProtoTypes::ConnectError::IKEV_FAILED_SET_ENTRY_WIN);
-            return;
+            if (dwErr == ERROR_INVALID_SIZE)
+            {
+                // try manual size (bug in 17133.1, https://answers.microsoft.com/en-us/insider/forum/insider_wintp-insider_update-insiderplat_pc/ras-error-632-on-windows-insider-build-17083/aacf68b9-3171-4342-ab9e-cbd4e278d4a7?page=2)
+                rasEntry.dwSize = 6720;
+                dwErr = RasSetEntryProperties(NULL, IKEV2_CONNECTION_NAME, &rasEntry, rasEntry.dwSize, NULL, NULL);
+            }
+            if (dwErr != ERROR_SUCCESS)
+            {
+                qCDebug(LOG_IKEV2) << "RasSetEntryProperties failed with error:" << dwErr;
+                state_ = STATE_DISCONNECTED;
+                emit error(ProtoTypes::ConnectError::IKEV_FAILED_SET_ENTRY_WIN);
+                return;
+            }
         }
     }
+    else
+    {
+        entry.isIpsecParametersSet = lastPhonebookEntry_.isIpsecParametersSet;
+    }
 
     connHandle_ = NULL;
 
@@ -416,15 +436,21 @@ void IKEv2Connection_win::doConnect()
     wcscpy_s(dialparams.szUserName, initialUsername_.toStdWString().c_str());
     wcscpy_s(dialparams.szPassword, initialPassword_.toStdWString().c_str());
 
-    dwErr = RasSetEntryDialParams(NULL, &dialparams, FALSE);
-    if (dwErr != ERROR_SUCCESS)
+    if (isEntryChanged || lastPhonebookEntry_.username != entry.username || lastPhonebookEntry_.password != entry.password)
     {
-        qCDebug(LOG_IKEV2) << "RasSetEntryDialParams failed with error:" << dwErr;
-        state_ = STATE_DISCONNECTED;
-        emit error(ProtoTypes::ConnectError::IKEV_FAILED_SET_ENTRY_WIN);
-        return;
+        DWORD dwErr = RasSetEntryDialParams(NULL, &dialparams, FALSE);
+        if (dwErr != ERROR_SUCCESS)
+        {
+            qCDebug(LOG_IKEV2) << "RasSetEntryDialParams failed with error:" << dwErr;
+            state_ = STATE_DISCONNECTED;
+            emit error(ProtoTypes::ConnectError::IKEV_FAILED_SET_ENTRY_WIN);
+            return;
+        }
     }
 
+    lastPhonebookEntry_ = entry;
+    isLastPhonebookEntryValid_ = true;
+
     if (!helper_->addHosts(initialIp_ + " " + initialUrl_))
     {
         qCDebug(LOG_IKEV2) << "Can't modify hosts file";
@@ -433,13 +459,17 @@ void IKEv2Connection_win::doConnect()
         return;
     }
 
-    helper_->setIKEv2IPSecParameters();
+    // rewriting the entry drops the IPsec parameters of it
+    if (!lastPhonebookEntry_.isIpsecParametersSet)
+    {
+        lastPhonebookEntry_.isIpsecParametersSet = helper_->setIKEv2IPSecParameters();
+    }
     helper_->enableDnsLeaksProtection();
 
     // Connecting
     state_ = STATE_CONNECTING;
 
-    dwErr = RasDial(NULL, NULL, &dialparams, 1, (void *)staticRasDialFunc, &connHandle_);
+    DWORD dwErr = RasDial(NULL, NULL, &dialparams, 1, (void *)staticRasDialFunc, &connHandle_);
     if (dwErr != ERROR_SUCCESS)
     {
         qCDebug(LOG_IKEV2) << "RasDial failed with error:" << dwErr;
@@ -533,6 +563,12 @@ void IKEv2Connection_win::doBlockingDisconnect()
     disconnectLogic_.blockSignals(false);
 }
 
+bool IKEv2Connection_win::isPhonebookEntryExists()
+{
+    // the entry can be removed outside of the app
+    return RasValidateEntryName(NULL, IKEV2_CONNECTION_NAME) == ERROR_ALREADY_EXISTS;
+}
+
 bool IKEv2Connection_win::getIKEv2Device(tagRASDEVINFOW *outDevInfo)
 {
     RASDEVINFO *devInfo;
@@ -81,8 +81,30 @@ private:
     void initMapConnStates();
     QString rasConnStateToString(RASCONNSTATE state);
 
+    // the phonebook entry and the IPsec parameters written by the last connect, they persist in the OS between
+    // the connects, so they are rewritten only when the server or the settings change or the entry was removed
+    struct PhonebookEntryDesc
+    {
+        QString url;
+        QString deviceName;
+        bool isEnableIkev2Compression;
+        QString username;
+        QString password;
+        bool isIpsecParametersSet;
+
+        PhonebookEntryDesc() : isEnableIkev2Compression(false), isIpsecParametersSet(false) {}
+        bool isSameEntry(const PhonebookEntryDesc &other) const
+        {
+            return url == other.url && deviceName == other.deviceName && isEnableIkev2Compression == other.isEnableIkev2Compression;
+        }
+    };
+
+    static bool isPhonebookEntryExists();
+
     static IKEv2Connection_win *this_;
     static bool wanReinstalled_;
+    static PhonebookEntryDesc lastPhonebookEntry_;
+    static bool isLastPhonebookEntryValid_;
     static void CALLBACK staticRasDialFunc(HRASCONN hrasconn, UINT unMsg, RASCONNSTATE rascs, DWORD dwError, DWORD dwExtendedError);
 };
 
@@ -2,12 +2,32 @@
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
 
+#include <QElapsedTimer>
 #include <QProcess>
 
 IKEv2ConnectionDisconnectLogic_win::IKEv2ConnectionDisconnectLogic_win(QObject *parent) : QThread(parent),
-    cntRasHangUp_(0), connHandle_(NULL)
+    cntRasHangUp_(0), connHandle_(NULL), hDisconnectionEvent_(NULL)
 {
-    connect(&timer_, SIGNAL(timeout()), SLOT(onTimer()));
+    hDisconnectionEvent_ = CreateEvent(NULL, FALSE, FALSE, NULL);
+    disconnectionNotifier_.setHandle(hDisconnectionEvent_);
+    disconnectionNotifier_.setEnabled(false);
+    connect(&disconnectionNotifier_, SIGNAL(activated(HANDLE)), SLOT(onDisconnectionNotification()));
+
+    hangUpTimer_.setSingleShot(true);
+    hangUpTimer_.setInterval(HANG_UP_TIMEOUT_MS);
+    connect(&hangUpTimer_, SIGNAL(timeout()), SLOT(onHangUpTimer()));
+
+    checkStatusTimer_.setInterval(CHECK_STATUS_PERIOD_MS);
+    connect(&checkStatusTimer_, SIGNAL(timeout()), SLOT(onCheckStatusTimer()));
+}
+
+IKEv2ConnectionDisconnectLogic_win::~IKEv2ConnectionDisconnectLogic_win()
+{
+    disconnectionNotifier_.setEnabled(false);
+    if (hDisconnectionEvent_)
+    {
+        CloseHandle(hDisconnectionEvent_);
+    }
 }
 
 void IKEv2ConnectionDisconnectLogic_win::startDisconnect(HRASCONN connHandle)
@@ -17,19 +37,37 @@ void IKEv2ConnectionDisconnectLogic_win::startDisconnect(HRASCONN connHandle)
     cntRasHangUp_ = 1;
     connHandle_ = connHandle;
 
+    // registered before the hang up, so the notification can't be missed
+    ResetEvent(hDisconnectionEvent_);
+    const DWORD dwNotificationErr = RasConnectionNotification(connHandle_, hDisconnectionEvent_, RASCN_Disconnection);
+    if (dwNotificationErr != ERROR_SUCCESS)
+    {
+        // without the notification the status is checked periodically
+        qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::startDisconnect(), RasConnectionNotification return code:" << dwNotificationErr;
+    }
+
     DWORD dwErr = RasHangUp(connHandle_);
 
     qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::startDisconnect(), RasHangUp return code:" << dwErr;
     if (dwErr == ERROR_INVALID_HANDLE)
     {
-        connHandle_ = NULL;
-        waitForControlThreadFinish();
-        emit disconnected();
+        finishDisconnect();
     }
     else
     {
-        elapsedTimer_.start();
-        timer_.start(10);
+        hangUpTimer_.start();
+        // the notification isn't delivered if the connection is gone already
+        if (!checkStatus())
+        {
+            if (dwNotificationErr == ERROR_SUCCESS)
+            {
+                disconnectionNotifier_.setEnabled(true);
+            }
+            else
+            {
+                checkStatusTimer_.start();
+            }
+        }
     }
 }
 
@@ -40,46 +78,52 @@ bool IKEv2ConnectionDisconnectLogic_win::isDisconnected()
 
 void IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(HRASCONN connHandle)
 {
-    DWORD dwErr = RasHangUp(connHandle);
-    qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), RasHangUp return code:" << dwErr;
-    if (dwErr == ERROR_INVALID_HANDLE)
+    HANDLE hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (hEvent && RasConnectionNotification(connHandle, hEvent, RASCN_Disconnection) != ERROR_SUCCESS)
     {
-        return;
+        CloseHandle(hEvent);
+        hEvent = NULL;
     }
-    else
+
+    DWORD dwErr = RasHangUp(connHandle);
+    qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), RasHangUp return code:" << dwErr;
+    if (dwErr != ERROR_INVALID_HANDLE)
     {
         QElapsedTimer elapsedTimer;
         elapsedTimer.start();
+        bool isNotified = false;
 
-        while (true)
+        while (!isConnectionHandleReleased(connHandle))
         {
-            RASCONNSTATUS status;
-            memset(&status, 0, sizeof(status));
-            status.dwSize = sizeof(status);
-            DWORD err = RasGetConnectStatus(connHandle, &status);
-            if (err == ERROR_INVALID_HANDLE)
+            const qint64 remainingMs = HANG_UP_TIMEOUT_MS - elapsedTimer.elapsed();
+            if (remainingMs <= 0)
             {
-                qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), RasGetConnectStatus return code:" << err << ", we disconnected";
-                return;
+                qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), 3 sec elapsed";
+                qCDebug(LOG_IKEV2) << "Try console command: rasdial /DISCONNECT";
+                QProcess process;
+                process.start("rasdial", QStringList() << "/DISCONNECT");
+                process.waitForFinished();
+                break;
+            }
+            // the handle can stay valid for a moment after the notification, then the status is checked again shortly
+            if (hEvent && !isNotified)
+            {
+                isNotified = (WaitForSingleObject(hEvent, static_cast<DWORD>(remainingMs)) == WAIT_OBJECT_0);
             }
             else
             {
-
-                if (elapsedTimer.elapsed() > 3000)
-                {
-                    qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), 3 sec elapsed:" << err;
-                    qCDebug(LOG_IKEV2) << "Try console command: rasdial /DISCONNECT";
-                    QProcess process;
-                    process.start("rasdial", QStringList() << "/DISCONNECT");
-                    process.waitForFinished();
-                    return;
-                }
-                else
-                {
-                    Sleep(10);
-                }
+                Sleep(CHECK_STATUS_PERIOD_MS);
             }
         }
+        if (elapsedTimer.elapsed() < HANG_UP_TIMEOUT_MS)
+        {
+            qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::blockingDisconnect(), we disconnected";
+        }
+    }
+
+    if (hEvent)
+    {
+        CloseHandle(hEvent);
     }
 }
 
@@ -97,40 +141,61 @@ void IKEv2ConnectionDisconnectLogic_win::run()
     mutex_.unlock();
 }
 
-void IKEv2ConnectionDisconnectLogic_win::onTimer()
+void IKEv2ConnectionDisconnectLogic_win::onDisconnectionNotification()
 {
-    RASCONNSTATUS status;
-    memset(&status, 0, sizeof(status));
-    status.dwSize = sizeof(status);
-    DWORD err = RasGetConnectStatus(connHandle_, &status);
-    if (err == ERROR_INVALID_HANDLE)
+    if (connHandle_ && !checkStatus())
     {
-        waitForControlThreadFinish();
-        qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onTimer(), RasGetConnectStatus return code:" << err << ", we disconnected";
-        timer_.stop();
-        connHandle_ = NULL;
-        emit disconnected();
+        // notified, but the handle isn't released yet
+        checkStatusTimer_.start();
+    }
+}
+
+void IKEv2ConnectionDisconnectLogic_win::onHangUpTimer()
+{
+    if (!connHandle_)
+    {
+        return;
+    }
+
+    qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onHangUpTimer(), 3 sec elapsed";
+    if (cntRasHangUp_ < MAX_HANG_UP_CALLS)
+    {
+        DWORD err = RasHangUp(connHandle_);
+        qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onHangUpTimer(), call RasHangUp again:" << err;
+        cntRasHangUp_++;
+        hangUpTimer_.start();
+        checkStatus();
     }
     else
     {
-        // if 3 sec elapsed
-        if (elapsedTimer_.elapsed() > 3000)
-        {
-            qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onTimer(), 3 sec elapsed:" << err;
+        qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onHangUpTimer(), 3 calls RasHangUp failed";
+    }
+}
 
-            if (cntRasHangUp_ < 3)
-            {
-                err = RasHangUp(connHandle_);
-                elapsedTimer_.start();
-                qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onTimer(), call RasHangUp again:" << err;
-                cntRasHangUp_++;
-            }
-            else
-            {
-                qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::onTimer(), 3 calls RasHangUp failed";
-            }
-        }
+void IKEv2ConnectionDisconnectLogic_win::onCheckStatusTimer()
+{
+    checkStatus();
+}
+
+bool IKEv2ConnectionDisconnectLogic_win::checkStatus()
+{
+    if (isConnectionHandleReleased(connHandle_))
+    {
+        qCDebug(LOG_IKEV2) << "IKEv2ConnectionDisconnectLogic_win::checkStatus(), we disconnected";
+        finishDisconnect();
+        return true;
     }
+    return false;
+}
+
+void IKEv2ConnectionDisconnectLogic_win::finishDisconnect()
+{
+    disconnectionNotifier_.setEnabled(false);
+    hangUpTimer_.stop();
+    checkStatusTimer_.stop();
+    waitForControlThreadFinish();
+    connHandle_ = NULL;
+    emit disconnected();
 }
 
 void IKEv2ConnectionDisconnectLogic_win::waitForControlThreadFinish()
@@ -140,3 +205,11 @@ void IKEv2ConnectionDisconnectLogic_win::waitForControlThreadFinish()
     mutex_.unlock();
     wait();
 }
+
+bool IKEv2ConnectionDisconnectLogic_win::isConnectionHandleReleased(HRASCONN connHandle)
+{
+    RASCONNSTATUS status;
+    memset(&status, 0, sizeof(status));
+    status.dwSize = sizeof(status);
+    return RasGetConnectStatus(connHandle, &status) == ERROR_INVALID_HANDLE;
+}
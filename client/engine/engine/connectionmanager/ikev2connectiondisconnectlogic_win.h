@@ -6,15 +6,18 @@
 #include <ras.h>
 #include <raserror.h>
 #include <QTimer>
-#include <QElapsedTimer>
 #include <QWaitCondition>
+#include <QWinEventNotifier>
 #include <QMutex>
 
+// Hangs up the RAS connection and waits for the disconnection notification of RAS (RasConnectionNotification)
+// instead of polling RasGetConnectStatus, RasHangUp is repeated if the connection isn't gone in 3 seconds.
 class IKEv2ConnectionDisconnectLogic_win : public QThread
 {
     Q_OBJECT
 public:
     explicit IKEv2ConnectionDisconnectLogic_win(QObject *parent);
+    ~IKEv2ConnectionDisconnectLogic_win() override;
 
     void startDisconnect(HRASCONN connHandle);
     bool isDisconnected();
@@ -28,17 +31,28 @@ protected:
     virtual void run();
 
 private slots:
-    void onTimer();
+    void onDisconnectionNotification();
+    void onHangUpTimer();
+    void onCheckStatusTimer();
 
 private:
+    static constexpr int HANG_UP_TIMEOUT_MS = 3000;
+    static constexpr int MAX_HANG_UP_CALLS = 3;
+    static constexpr int CHECK_STATUS_PERIOD_MS = 10;
+
     int cntRasHangUp_;
     HRASCONN connHandle_;
-    QTimer timer_;
-    QElapsedTimer elapsedTimer_;
+    HANDLE hDisconnectionEvent_;
+    QWinEventNotifier disconnectionNotifier_;
+    QTimer hangUpTimer_;
+    QTimer checkStatusTimer_;       // the handle can stay valid for a moment after the notification
     QWaitCondition waitCondition_;
     QMutex mutex_;
 
+    bool checkStatus();
+    void finishDisconnect();
     void waitForControlThreadFinish();
+    static bool isConnectionHandleReleased(HRASCONN connHandle);
 };
 
 #endif // IKEV2CONNECTIONDISCONNECTLOGIC_WIN_H
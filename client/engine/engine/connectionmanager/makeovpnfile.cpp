@@ -13,19 +13,21 @@
     #include "utils/dnsscripts_linux.h"
 #endif
 
-MakeOVPNFile::MakeOVPNFile()
+MakeOVPNFile::MakeOVPNFile() : isBaseWritten_(false)
 {
     QString strPath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
     QDir dir(strPath);
     dir.mkpath(strPath);
     path_ = strPath + "/config.ovpn";
     file_.setFileName(path_);
+    basePath_ = strPath + "/config_base.ovpn";
 }
 
 MakeOVPNFile::~MakeOVPNFile()
 {
     file_.close();
     file_.remove();
+    QFile::remove(basePath_);
 }
 
 bool MakeOVPNFile::generate(const QString &ovpnData, const QString &ip, const ProtocolType &protocol, uint port,
@@ -44,33 +46,33 @@ bool MakeOVPNFile::generate(const QString &ovpnData, const QString &ip, const Pr
         }
     }
 
-    file_.resize(0);
-
     QString strExtraConfig = ExtraConfig::instance().getExtraConfigForOpenVpn();
     bool bExtraContainsRemote = strExtraConfig.contains("remote", Qt::CaseInsensitive);
 
-
-    QString newOvpnData = ExtraConfig::instance().modifyVerbParameter(ovpnData, strExtraConfig);
-
-
-    file_.write( newOvpnData.toLocal8Bit());
-
-    QString str;
-
+    BaseKey baseKey;
+    baseKey.ovpnData = ovpnData;
+    baseKey.extraConfig = strExtraConfig;
+    baseKey.blockOutsideDnsOption = blockOutsideDnsOption;
 #ifdef Q_OS_WIN
+    baseKey.isUseWinTun = OpenVpnVersionController::instance().isUseWinTun();
+#endif
 
-    if(blockOutsideDnsOption) {
-        str = "\r\nblock-outside-dns\r\n";
-        file_.write(str.toLocal8Bit());
-    }
+    QString newOvpnData = ExtraConfig::instance().modifyVerbParameter(ovpnData, strExtraConfig);
 
-    if (OpenVpnVersionController::instance().isUseWinTun())
+    if (!isBaseWritten_ || !(baseKey == baseKey_) || !QFile::exists(basePath_))
     {
-        str = "\r\nwindows-driver wintun\r\n";
-        file_.write(str.toLocal8Bit());
+        isBaseWritten_ = writeBase(baseKey, newOvpnData);
+        if (!isBaseWritten_)
+        {
+            return false;
+        }
+        baseKey_ = baseKey;
     }
 
-#endif
+    file_.resize(0);
+
+    QString str = QString("config \"%1\"\r\n").arg(basePath_);
+    file_.write(str.toLocal8Bit());
 
     if (protocol.getType() == ProtocolType::PROTOCOL_OPENVPN_UDP)
     {
@@ -138,40 +140,76 @@ bool MakeOVPNFile::generate(const QString &ovpnData, const QString &ip, const Pr
         file_.write(str.toLocal8Bit());
     }
 
+    // concatenate with windscribe_extra.conf file, if it exists
+    if (!strExtraConfig.isEmpty())
+    {
+        qCDebug(LOG_CONNECTION) << "Adding extra options to OVPN config:" << strExtraConfig;
+        file_.write(strExtraConfig.toUtf8());
+    }
+
+    file_.flush();
+
+    //qCDebug(LOG_CONNECTION) << "OVPN-config path:" << path_;
+    return true;
+}
+
+bool MakeOVPNFile::writeBase(const BaseKey &key, const QString &ovpnData)
+{
+#if !defined(Q_OS_WIN)
+    Q_UNUSED(key);
+#endif
+
+    QFile file(basePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCDebug(LOG_CONNECTION) << "Can't open config file:" << file.fileName();
+        return false;
+    }
+
+    file.write(ovpnData.toLocal8Bit());
+
+    QString str = "\r\n";
+    file.write(str.toLocal8Bit());
+
+#ifdef Q_OS_WIN
+
+    if(key.blockOutsideDnsOption) {
+        str = "\r\nblock-outside-dns\r\n";
+        file.write(str.toLocal8Bit());
+    }
+
+    if (key.isUseWinTun)
+    {
+        str = "\r\nwindows-driver wintun\r\n";
+        file.write(str.toLocal8Bit());
+    }
+
+#endif
+
 #ifdef Q_OS_MAC
     str = "--script-security 2\r\n";
-    file_.write(str.toLocal8Bit());
+    file.write(str.toLocal8Bit());
 
     QString strDnsPath = TempScripts_mac::instance().dnsScriptPath();
     if (strDnsPath.isEmpty()) {
         return false;
     }
     QString cmd1 = "\nup \"" + strDnsPath + " -up\"\n";
-    file_.write(cmd1.toUtf8());
+    file.write(cmd1.toUtf8());
 #elif defined(Q_OS_LINUX)
     str = "--script-security 2\r\n";
-    file_.write(str.toLocal8Bit());
+    file.write(str.toLocal8Bit());
 
     QString dnsScript = DnsScripts_linux::instance().scriptPath();
     QString cmd1 = "\nup " + dnsScript  + "\n";
     QString cmd2 = "down " + dnsScript + "\n";
     QString cmd3 = "down-pre\n";
     QString cmd4 = "dhcp-option DOMAIN-ROUTE .\n";   // prevent DNS leakage  and without it doesn't work update-systemd-resolved script
-    file_.write(cmd1.toUtf8());
-    file_.write(cmd2.toUtf8());
-    file_.write(cmd3.toUtf8());
-    file_.write(cmd4.toUtf8());
+    file.write(cmd1.toUtf8());
+    file.write(cmd2.toUtf8());
+    file.write(cmd3.toUtf8());
+    file.write(cmd4.toUtf8());
 #endif
 
-    // concatenate with windscribe_extra.conf file, if it exists
-    if (!strExtraConfig.isEmpty())
-    {
-        qCDebug(LOG_CONNECTION) << "Adding extra options to OVPN config:" << strExtraConfig;
-        file_.write(strExtraConfig.toUtf8());
-    }
-
-    file_.flush();
-
-    //qCDebug(LOG_CONNECTION) << "OVPN-config path:" << path_;
-    return true;
+    return file.error() == QFile::NoError;
 }
@@ -3,6 +3,9 @@
 #include <QTemporaryFile>
 #include "engine/types/protocoltype.h"
 
+// The config is written as two files: the base with the options which are the same for all the nodes (the config from
+// the API, the platform options), written only when they change, and the small config with the node specific options,
+// which includes the base with the "config" directive. So a retry with another node rewrites only the small file.
 class MakeOVPNFile
 {
 public:
@@ -17,6 +20,28 @@ public:
 private:
     QString path_;
     QFile file_;
+
+    // the inputs of the written base file
+    struct BaseKey
+    {
+        QString ovpnData;
+        QString extraConfig;
+        bool blockOutsideDnsOption;
+        bool isUseWinTun;
+
+        BaseKey() : blockOutsideDnsOption(false), isUseWinTun(false) {}
+        bool operator==(const BaseKey &other) const
+        {
+            return ovpnData == other.ovpnData && extraConfig == other.extraConfig &&
+                   blockOutsideDnsOption == other.blockOutsideDnsOption && isUseWinTun == other.isUseWinTun;
+        }
+    };
+
+    QString basePath_;
+    BaseKey baseKey_;
+    bool isBaseWritten_;
+
+    bool writeBase(const BaseKey &key, const QString &ovpnData);
 };
 
 #endif // MAKEOVPNFILE_H
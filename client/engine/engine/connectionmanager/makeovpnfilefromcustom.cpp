@@ -11,17 +11,20 @@
     #include "engine/tempscripts_mac.h"
 #endif
 
-MakeOVPNFileFromCustom::MakeOVPNFileFromCustom()
+MakeOVPNFileFromCustom::MakeOVPNFileFromCustom() : isBaseWritten_(false)
 {
     path_ = QStandardPaths::writableLocation(QStandardPaths::DataLocation)
           + "/windscribe_temp_config.ovpn";
     file_.setFileName(path_);
+    // not *.ovpn, so it's never listed as a custom config if the custom configs directory is the data directory
+    basePath_ = path_ + ".base";
 }
 
 MakeOVPNFileFromCustom::~MakeOVPNFileFromCustom()
 {
     file_.close();
     file_.remove();
+    QFile::remove(basePath_);
 }
 
 // write all of ovpnData to file and add remoteCommand with replaced ip
@@ -39,13 +42,21 @@ bool MakeOVPNFileFromCustom::generate(const QString &customConfigPath, const QSt
         return false;
     }
 
-    file_.resize(0);
+    if (!isBaseWritten_ || customConfigPath != baseCustomConfigPath_ || ovpnData != baseOvpnData_ || !QFile::exists(basePath_))
+    {
+        isBaseWritten_ = writeBase(customConfigPath, ovpnData);
+        if (!isBaseWritten_)
+        {
+            return false;
+        }
+        baseCustomConfigPath_ = customConfigPath;
+        baseOvpnData_ = ovpnData;
+    }
 
-    QString customConfigPathCopy(customConfigPath);
-    QString cd_command = QString("cd \"%1\"\n\n").arg(customConfigPathCopy.replace("\\", "/"));
-    file_.write(cd_command.toLocal8Bit());
+    file_.resize(0);
 
-    file_.write(ovpnData.toLocal8Bit());
+    QString config_command = QString("config \"%1\"\r\n").arg(basePath_);
+    file_.write(config_command.toLocal8Bit());
 
     QString line = remoteCommand;
     ParseOvpnConfigLine::OpenVpnLine openVpnLine = ParseOvpnConfigLine::processLine(remoteCommand);
@@ -56,6 +67,27 @@ bool MakeOVPNFileFromCustom::generate(const QString &customConfigPath, const QSt
         file_.write("\r\n");
     }
 
+    file_.flush();
+    return true;
+}
+
+bool MakeOVPNFileFromCustom::writeBase(const QString &customConfigPath, const QString &ovpnData)
+{
+    QFile file(basePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCDebug(LOG_CONNECTION) << "Can't open config file:" << file.fileName();
+        return false;
+    }
+
+    // the cd changes the directory for the rest of the config, so the relative paths of the custom config work
+    QString customConfigPathCopy(customConfigPath);
+    QString cd_command = QString("cd \"%1\"\n\n").arg(customConfigPathCopy.replace("\\", "/"));
+    file.write(cd_command.toLocal8Bit());
+
+    file.write(ovpnData.toLocal8Bit());
+    file.write("\r\n");
+
 #ifdef Q_OS_MAC
     // No need to set "script-security" here, because it is handled in the config parsing code.
     QString strDnsPath = TempScripts_mac::instance().dnsScriptPath();
@@ -63,10 +95,8 @@ bool MakeOVPNFileFromCustom::generate(const QString &customConfigPath, const QSt
         return false;
     }
     QString cmd1 = "\nup \"" + strDnsPath + " -up\"\n";
-    file_.write(cmd1.toUtf8());
+    file.write(cmd1.toUtf8());
 #endif
 
-    file_.flush();
-    return true;
+    return file.error() == QFile::NoError;
 }
-
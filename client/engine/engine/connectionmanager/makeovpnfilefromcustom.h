@@ -3,6 +3,8 @@
 #include <QTemporaryFile>
 #include "engine/types/protocoltype.h"
 
+// Same as MakeOVPNFile, the config of the custom file is written to the base file only when it changes, the config
+// with the remote of the node includes it.
 class MakeOVPNFileFromCustom
 {
 public:
@@ -15,6 +17,13 @@ public:
 private:
     QString path_;
     QFile file_;
+
+    QString basePath_;
+    QString baseCustomConfigPath_;
+    QString baseOvpnData_;
+    bool isBaseWritten_;
+
+    bool writeBase(const QString &customConfigPath, const QString &ovpnData);
 };
 
 #endif // MAKEOVPNFILEFROMCUSTOM_H
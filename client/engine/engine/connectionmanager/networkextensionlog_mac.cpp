@@ -1,101 +1,125 @@
 #include "networkextensionlog_mac.h"
 
-#include <QProcess>
-#include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
-#include <time.h>
-#include <xlocale.h>
+#include <QElapsedTimer>
+#include <QTimer>
 #include "utils/logger.h"
 
 NetworkExtensionLog_mac::NetworkExtensionLog_mac(QObject *parent) : QObject(parent),
-    isInitialTimestampInitialized_(false)
+    process_(nullptr), lastCollectedTimestamp_(0), restartDelayMs_(RESTART_DELAY_MIN_MS)
 {
-    // detect initial timestamp for latest record in log
-    collectNext();
-    if (!logs_.empty())
+    startStream();
+}
+
+NetworkExtensionLog_mac::~NetworkExtensionLog_mac()
+{
+    if (process_)
     {
-        initialTimestamp_ = (logs_.end() - 1).key();
-        isInitialTimestampInitialized_ = true;
-        logs_.clear();
+        process_->disconnect(this);
+        process_->kill();
+        process_->waitForFinished(1000);
     }
 }
 
 QMap<time_t, QString> NetworkExtensionLog_mac::collectNext()
 {
+    // drain the pipe, the records written just before the call may still be on the way from the log process
+    if (process_)
+    {
+        onReadyRead();
+        QElapsedTimer elapsed;
+        elapsed.start();
+        while (process_ && elapsed.elapsed() < DRAIN_TIMEOUT_MS && process_->waitForReadyRead(DRAIN_WAIT_MS))
+        {
+            // onReadyRead() is called from the readyReadStandardOutput signal
+        }
+    }
+
     QMap<time_t, QString> nextLogs;
-    //calc minutes for pass to log command
-    uint minutes;
+    for (auto it = logs_.upperBound(lastCollectedTimestamp_); it != logs_.end(); ++it)
+    {
+        nextLogs[it.key()] = it.value();
+    }
+    if (!logs_.isEmpty())
+    {
+        lastCollectedTimestamp_ = qMax(lastCollectedTimestamp_, (logs_.end() - 1).key());
+    }
+    return nextLogs;
+}
 
-    if (!lastTimeCollected_.isNull())
+void NetworkExtensionLog_mac::onReadyRead()
+{
+    pendingData_.append(process_->readAllStandardOutput());
+    int start = 0;
+    int end;
+    while ((end = pendingData_.indexOf('\n', start)) != -1)
     {
-        qint64 secs = lastTimeCollected_.secsTo(QDateTime::currentDateTime());
-        minutes = (secs + 30) / 60 + 2;    // +30 secs - extra protective interval
+        parseLine(pendingData_.mid(start, end - start));
+        start = end + 1;
     }
-    else
+    pendingData_.remove(0, start);
+}
+
+void NetworkExtensionLog_mac::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    qCDebug(LOG_NETWORK_EXTENSION_MAC) << "log stream process finished, exitCode =" << exitCode << ", exitStatus =" << exitStatus;
+    process_->deleteLater();
+    process_ = nullptr;
+    pendingData_.clear();
+
+    qCDebug(LOG_NETWORK_EXTENSION_MAC) << "restarting log stream in" << restartDelayMs_ << "ms";
+    QTimer::singleShot(restartDelayMs_, this, &NetworkExtensionLog_mac::startStream);
+    restartDelayMs_ = qMin(restartDelayMs_ * 2, int(RESTART_DELAY_MAX_MS));
+}
+
+void NetworkExtensionLog_mac::onProcessError(QProcess::ProcessError error)
+{
+    // there is no finished() if the process didn't start
+    if (error == QProcess::FailedToStart)
     {
-        minutes = 5;
+        onProcessFinished(-1, QProcess::CrashExit);
     }
+}
+
+void NetworkExtensionLog_mac::startStream()
+{
+    process_ = new QProcess(this);
+    connect(process_, SIGNAL(readyReadStandardOutput()), SLOT(onReadyRead()));
+    connect(process_, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onProcessFinished(int,QProcess::ExitStatus)));
+    connect(process_, SIGNAL(errorOccurred(QProcess::ProcessError)), SLOT(onProcessError(QProcess::ProcessError)));
 
-    QProcess process;
-    process.setProcessChannelMode(QProcess::MergedChannels);
     QStringList pars;
-    pars << "show";
-    //pars << "--predicate" << "(messageType=\"error\" && (subsystem == \"com.apple.networkextension\" || process == \"neagent\"))";
+    pars << "stream";
     pars << "--predicate" << "messageType == error and (subsystem == \"com.apple.networkextension\")";
-    pars << "--last" << QString::number(minutes) + "m";
-    pars << "--style" << "json";
+    pars << "--style" << "ndjson";
+    process_->start("log", pars);
+}
 
-    process.start("log", pars);
-    if (process.waitForFinished(10000))
+void NetworkExtensionLog_mac::parseLine(const QByteArray &line)
+{
+    // the stream starts with a plain text header line, skipped as non-json
+    QJsonParseError errCode;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &errCode);
+    if (errCode.error != QJsonParseError::NoError || !doc.isObject())
     {
+        return;
+    }
+    const QJsonObject jsonObj = doc.object();
+    if (!jsonObj.contains("machTimestamp") || !jsonObj.contains("eventMessage"))
+    {
+        qCDebug(LOG_NETWORK_EXTENSION_MAC) << "Can't parse json from log command (no field machTimestamp or eventMessage)";
+        return;
+    }
 
-        QJsonParseError errCode;
-        const QJsonDocument doc = QJsonDocument::fromJson(process.readAll(), &errCode);
-        if (errCode.error != QJsonParseError::NoError || !doc.isArray())
-        {
-            qCDebug(LOG_NETWORK_EXTENSION_MAC) << "Can't parse json from log command";
-            return nextLogs;
-        }
-        for (const QJsonValue &value : doc.array())
-        {
-            QJsonObject jsonObj = value.toObject();
-            if (!jsonObj.contains("machTimestamp"))
-            {
-                qCDebug(LOG_NETWORK_EXTENSION_MAC) << "Can't parse json from log command (no field machTimestamp)";
-                return nextLogs;
-            }
-            if (!jsonObj.contains("eventMessage"))
-            {
-                qCDebug(LOG_NETWORK_EXTENSION_MAC) << "Can't parse json from log command (no field eventMessage)";
-                return nextLogs;
-            }
-
-            quint64 t = jsonObj["machTimestamp"].toDouble();
-            //struct tm sometime;
-            //const char *formatString = "%Y-%m-%d %H:%M:%S %z";
-            //strptime_l(timestamp.toStdString().c_str(), formatString, &sometime, NULL);
-            //time_t t = mktime(&sometime);
-
-            if (!logs_.contains(t))
-            {
-                if (isInitialTimestampInitialized_)
-                {
-                    if (t > initialTimestamp_)
-                    {
-                        logs_[t] = jsonObj["eventMessage"].toString();
-                        nextLogs[t] = jsonObj["eventMessage"].toString();
-                    }
-                }
-                else
-                {
-                    logs_[t] = jsonObj["eventMessage"].toString();
-                    nextLogs[t] = jsonObj["eventMessage"].toString();
-                }
-            }
-        }
+    // the stream works, the next restart starts over with the shortest delay
+    restartDelayMs_ = RESTART_DELAY_MIN_MS;
 
-        lastTimeCollected_ = QDateTime::currentDateTime();
+    const quint64 t = jsonObj["machTimestamp"].toDouble();
+    logs_[t] = jsonObj["eventMessage"].toString();
+    while (logs_.size() > MAX_RING_SIZE)
+    {
+        logs_.erase(logs_.begin());
     }
-    return nextLogs;
 }
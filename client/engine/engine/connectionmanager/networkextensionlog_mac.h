@@ -3,22 +3,41 @@
 
 #include <QObject>
 #include <QMap>
-#include <QDateTime>
+#include <QProcess>
 
 // collect logs from system log from neagent process
+// The records are streamed by one "log stream" process for the lifetime of the object and kept in a bounded
+// ring, so collectNext() only takes the records appended since the previous call (no scan of the whole log).
+// The process is restarted with a backoff if it exits.
 class NetworkExtensionLog_mac : public QObject
 {
     Q_OBJECT
 public:
     explicit NetworkExtensionLog_mac(QObject *parent = nullptr);
+    ~NetworkExtensionLog_mac() override;
+
     QMap<time_t, QString> collectNext();
 
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+
 private:
-    bool isInitialTimestampInitialized_;
-    quint64 initialTimestamp_;
+    static constexpr int MAX_RING_SIZE = 1000;
+    static constexpr int DRAIN_WAIT_MS = 100;
+    static constexpr int DRAIN_TIMEOUT_MS = 500;
+    static constexpr int RESTART_DELAY_MIN_MS = 1000;
+    static constexpr int RESTART_DELAY_MAX_MS = 60000;
+
+    QProcess *process_;
+    QByteArray pendingData_;        // the incomplete last line
+    QMap<quint64, QString> logs_;   // ring, by machTimestamp
+    quint64 lastCollectedTimestamp_;
+    int restartDelayMs_;            // doubled on each restart of the log process, reset when records arrive
 
-    QMap<quint64, QString> logs_;
-    QDateTime lastTimeCollected_;
+    void startStream();
+    void parseLine(const QByteArray &line);
 };
 
 #endif // NETWORKEXTENSIONLOG_MAC_H
@@ -1,4 +1,5 @@
 #include "openvpnconnection.h"
+#include "openvpnmanagementline.h"
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
@@ -201,6 +202,7 @@ void OpenVPNConnection::funcRunOpenVPN()
     stateVariables_.openVpnPort = AvailablePort::getAvailablePort(DEFAULT_PORT);
 
     stateVariables_.elapsedTimer.start();
+    stateVariables_.openVpnOutput.clear();
 
     int retries = 0;
 
@@ -274,15 +276,17 @@ void OpenVPNConnection::funcConnectToOpenVPN(const boost::system::error_code& er
             return;
         }
 
-        // check if openvpn process already finished
-        QString logStr;
+        // check if openvpn process already finished, the helper holds the answer until the process prints
+        // something or finishes, so the next connect attempt follows the output of the process
+        QString logChunk;
         bool bFinished;
-        helper_->getUnblockingCmdStatus(stateVariables_.lastCmdId, logStr, bFinished);
+        helper_->waitUnblockingCmdStatus(stateVariables_.lastCmdId, WAIT_OPENVPN_STATUS_MS, logChunk, bFinished);
+        stateVariables_.openVpnOutput += logChunk;
 
         if (bFinished)
         {
             qCDebug(LOG_CONNECTION) << "openvpn process finished before connected to openvpn socket";
-            qCDebug(LOG_CONNECTION) << "answer from openvpn process, answer =" << logStr;
+            qCDebug(LOG_CONNECTION) << "answer from openvpn process, answer =" << stateVariables_.openVpnOutput;
 
             if (bStopThread_)
             {
@@ -317,61 +321,91 @@ void OpenVPNConnection::funcConnectToOpenVPN(const boost::system::error_code& er
 
 void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t bytes_transferred)
 {
-    Q_UNUSED(bytes_transferred);
     if (err.value() == 0)
     {
-        std::istream is(stateVariables_.buffer.get());
-        std::string resultLine;
-        std::getline(is, resultLine);
-
-        QString serverReply = QString::fromStdString(resultLine).trimmed();
+        // the line is parsed in place, bytes_transferred includes the "\n"
+        // (the input sequence of asio::streambuf is contiguous)
+        const OpenVPNManagementLine line(static_cast<const char *>(stateVariables_.buffer->data().data()), bytes_transferred);
 
         boost::system::error_code write_error;
-        // skip log out BYTECOUNT
-        if (!serverReply.contains(">BYTECOUNT:", Qt::CaseInsensitive))
+        // the statistics lines come every second, they don't need the QString and aren't logged
+        if (line.type() == OpenVPNManagementLine::TYPE_BYTECOUNT)
+        {
+            handleByteCount(line);
+        }
+        else
         {
-            qCDebug(LOG_OPENVPN) << serverReply;
+            handleMessage(line, write_error);
         }
-        if (serverReply.contains("HOLD:Waiting for hold release", Qt::CaseInsensitive))
+        stateVariables_.buffer->consume(bytes_transferred);
+
+        checkErrorAndContinue(write_error, true);
+    }
+    else
+    {
+        qCDebug(LOG_CONNECTION) << "Read from openvpn socket connection failed, error:" << QString::fromStdString(err.message());
+        setCurrentStateAndEmitDisconnected(STATUS_DISCONNECTED);
+    }
+}
+
+void OpenVPNConnection::handleByteCount(const OpenVPNManagementLine &line)
+{
+    quint64 l1, l2;
+    if (!line.parseByteCount(l1, l2))
+    {
+        return;
+    }
+    if (stateVariables_.bFirstCalcStat)
+    {
+        stateVariables_.prevBytesRcved = l1;
+        stateVariables_.prevBytesXmited = l2;
+        Q_EMIT statisticsUpdated(stateVariables_.prevBytesRcved, stateVariables_.prevBytesXmited, false);
+        stateVariables_.bFirstCalcStat = false;
+    }
+    else
+    {
+        Q_EMIT statisticsUpdated(l1 - stateVariables_.prevBytesRcved, l2 - stateVariables_.prevBytesXmited, false);
+        stateVariables_.prevBytesRcved = l1;
+        stateVariables_.prevBytesXmited = l2;
+    }
+}
+
+void OpenVPNConnection::handleMessage(const OpenVPNManagementLine &line, boost::system::error_code &write_error)
+{
+    const QString serverReply = line.toString();
+    qCDebug(LOG_OPENVPN) << serverReply;
+
+    switch (line.type())
+    {
+    case OpenVPNManagementLine::TYPE_HOLD:
+        if (serverReply.contains("Waiting for hold release", Qt::CaseInsensitive))
         {
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("state on all\n"), boost::asio::transfer_all(), write_error);
         }
-        else if (serverReply.startsWith("END") && stateVariables_.bWasStateNotification)
+        break;
+
+    case OpenVPNManagementLine::TYPE_END:
+        if (stateVariables_.bWasStateNotification)
         {
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("log on\n"), boost::asio::transfer_all(), write_error);
         }
-        else if (serverReply.contains("SUCCESS: real-time state notification set to ON", Qt::CaseInsensitive))
+        break;
+
+    case OpenVPNManagementLine::TYPE_SUCCESS:
+        if (serverReply.contains("real-time state notification set to ON", Qt::CaseInsensitive))
         {
             stateVariables_.bWasStateNotification = true;
             stateVariables_.isAcceptSigTermCommand_ = true;
         }
-        else if (serverReply.contains("SUCCESS: real-time log notification set to ON", Qt::CaseInsensitive))
+        else if (serverReply.contains("real-time log notification set to ON", Qt::CaseInsensitive))
         {
-            boost::asio::write(*stateVariables_.socket, boost::asio::buffer("bytecount 1\n"), boost::asio::transfer_all(), write_error);
+            const std::string cmd = "bytecount " + std::to_string(STATISTICS_INTERVAL) + "\n";
+            boost::asio::write(*stateVariables_.socket, boost::asio::buffer(cmd), boost::asio::transfer_all(), write_error);
         }
-        else if (serverReply.contains("SUCCESS: bytecount interval changed", Qt::CaseInsensitive))
+        else if (serverReply.contains("bytecount interval changed", Qt::CaseInsensitive))
         {
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("hold release\n"), boost::asio::transfer_all(), write_error);
         }
-        else if (serverReply.contains("PASSWORD:Need 'Auth' username/password", Qt::CaseInsensitive))
-        {
-            if (!username_.isEmpty())
-            {
-                char message[1024];
-                sprintf(message, "username \"Auth\" %s\n", username_.toUtf8().data());
-                boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message,strlen(message)), boost::asio::transfer_all(), write_error);
-            }
-            else
-            {
-                Q_EMIT requestUsername();
-            }
-        }
-        else if (serverReply.contains("PASSWORD:Need 'HTTP Proxy' username/password", Qt::CaseInsensitive))
-        {
-            char message[1024];
-            sprintf(message, "username \"HTTP Proxy\" %s\n", proxySettings_.getUsername().toUtf8().data());
-            boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message,strlen(message)), boost::asio::transfer_all(), write_error);
-        }
         else if (serverReply.contains("'HTTP Proxy' username entered, but not yet verified", Qt::CaseInsensitive))
         {
             char message[1024];
@@ -391,177 +425,193 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
                 Q_EMIT requestPassword();
             }
         }
-        else if (serverReply.contains("PASSWORD:Verification Failed: 'Auth'", Qt::CaseInsensitive))
+        break;
+
+    case OpenVPNManagementLine::TYPE_PASSWORD:
+        if (serverReply.contains("Need 'Auth' username/password", Qt::CaseInsensitive))
         {
-            Q_EMIT error(ProtoTypes::ConnectError::AUTH_ERROR);
-            if (!stateVariables_.bSigTermSent)
+            if (!username_.isEmpty())
             {
-                boost::asio::write(*stateVariables_.socket, boost::asio::buffer("signal SIGTERM\n"), boost::asio::transfer_all(), write_error);
-                helper_->clearUnblockingCmd(stateVariables_.lastCmdId);
-                stateVariables_.bSigTermSent = true;
+                char message[1024];
+                sprintf(message, "username \"Auth\" %s\n", username_.toUtf8().data());
+                boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message,strlen(message)), boost::asio::transfer_all(), write_error);
             }
-        }
-        else if (serverReply.contains("There are no TAP-Windows adapters on this system", Qt::CaseInsensitive))
-        {
-            if (!stateVariables_.bTapErrorEmited)
+            else
             {
-                Q_EMIT error(ProtoTypes::ConnectError::NO_INSTALLED_TUN_TAP);
-                stateVariables_.bTapErrorEmited = true;
-                if (!stateVariables_.bSigTermSent)
-                {
-                    boost::asio::write(*stateVariables_.socket, boost::asio::buffer("signal SIGTERM\n"), boost::asio::transfer_all(), write_error);
-                    helper_->clearUnblockingCmd(stateVariables_.lastCmdId);
-                    stateVariables_.bSigTermSent = true;
-                }
+                Q_EMIT requestUsername();
             }
         }
-        else if (serverReply.startsWith(">BYTECOUNT:", Qt::CaseInsensitive))
+        else if (serverReply.contains("Need 'HTTP Proxy' username/password", Qt::CaseInsensitive))
         {
-            QStringList pars = serverReply.split(":");
-            if (pars.count() > 1)
-            {
-                QStringList pars2 = pars[1].split(",");
-                if (pars2.count() == 2)
-                {
-                    quint64 l1 = pars2[0].toULongLong();
-                    quint64 l2 = pars2[1].toULongLong();
-                    if (stateVariables_.bFirstCalcStat)
-                    {
-                        stateVariables_.prevBytesRcved = l1;
-                        stateVariables_.prevBytesXmited = l2;
-                        Q_EMIT statisticsUpdated(stateVariables_.prevBytesRcved, stateVariables_.prevBytesXmited, false);
-                        stateVariables_.bFirstCalcStat = false;
-                    }
-                    else
-                    {
-                        Q_EMIT statisticsUpdated(l1 - stateVariables_.prevBytesRcved, l2 - stateVariables_.prevBytesXmited, false);
-                        stateVariables_.prevBytesRcved = l1;
-                        stateVariables_.prevBytesXmited = l2;
-                    }
-                }
-            }
+            char message[1024];
+            sprintf(message, "username \"HTTP Proxy\" %s\n", proxySettings_.getUsername().toUtf8().data());
+            boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message,strlen(message)), boost::asio::transfer_all(), write_error);
         }
-        else if (serverReply.startsWith(">STATE:", Qt::CaseInsensitive))
+        else if (serverReply.contains("Verification Failed: 'Auth'", Qt::CaseInsensitive))
         {
-            if (serverReply.contains("CONNECTED,SUCCESS", Qt::CaseInsensitive))
-            {
-#ifdef Q_OS_WIN
-                AdapterGatewayInfo windscribeAdapter = AdapterUtils_win::getWindscribeConnectedAdapterInfo();
-                if (!windscribeAdapter.isEmpty())
-                {
-                    if (connectionAdapterInfo_.adapterIp() != windscribeAdapter.adapterIp())
-                    {
-                        qCDebug(LOG_CONNECTION) << "Error: Adapter IP detected from openvpn log not equal to the adapter IP from AdapterUtils_win::getWindscribeConnectedAdapterInfo()";
-                        Q_ASSERT(false);
-                    }
-                    connectionAdapterInfo_.setAdapterName(windscribeAdapter.adapterName());
-                    connectionAdapterInfo_.setAdapterIp(windscribeAdapter.adapterIp());
-                    connectionAdapterInfo_.setDnsServers(windscribeAdapter.dnsServers());
-                    connectionAdapterInfo_.setIfIndex(windscribeAdapter.ifIndex());
-                }
-                else
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't detect connected Windscribe adapter";
-                }
-#endif
+            Q_EMIT error(ProtoTypes::ConnectError::AUTH_ERROR);
+            sendSigTerm(write_error);
+        }
+        break;
 
-                QString remoteIp;
-                if (parseConnectedSuccessReply(serverReply, remoteIp))
-                {
-                    connectionAdapterInfo_.setRemoteIp(remoteIp);
-                }
-                else
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't parse CONNECTED,SUCCESS control message";
-                }
-                setCurrentState(STATUS_CONNECTED);
-                Q_EMIT connected(connectionAdapterInfo_);
-            }
-            else if (serverReply.contains("CONNECTED,ERROR", Qt::CaseInsensitive))
-            {
-                setCurrentState(STATUS_CONNECTED);
-                Q_EMIT error(ProtoTypes::ConnectError::CONNECTED_ERROR);
-            }
-            else if (serverReply.contains("RECONNECTING", Qt::CaseInsensitive))
-            {
-                stateVariables_.isAcceptSigTermCommand_ = false;
-                stateVariables_.bWasStateNotification = false;
-                setCurrentState(STATUS_CONNECTED_TO_SOCKET);
-                Q_EMIT reconnecting();
-            }
+    case OpenVPNManagementLine::TYPE_STATE:
+        handleStateMessage(serverReply);
+        break;
+
+    case OpenVPNManagementLine::TYPE_LOG:
+        if (!checkNoTapAdapters(serverReply, write_error))
+        {
+            handleLogMessage(serverReply);
         }
-        else if (serverReply.startsWith(">LOG:", Qt::CaseInsensitive))
+        break;
+
+    case OpenVPNManagementLine::TYPE_FATAL:
+        if (!checkNoTapAdapters(serverReply, write_error) &&
+            serverReply.contains("All TAP-Windows adapters on this system are currently in use", Qt::CaseInsensitive))
         {
-            bool bContainsUDPWord = serverReply.contains("UDP", Qt::CaseInsensitive);
-            if (bContainsUDPWord && serverReply.contains("No buffer space available (WSAENOBUFS) (code=10055)", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("No Route to Host (WSAEHOSTUNREACH) (code=10065)", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("Can't assign requested address (code=49)", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("No buffer space available (code=55)", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::UDP_NO_BUFFER_SPACE);
-            }
-            else if (bContainsUDPWord && serverReply.contains("Network is down (code=50)", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::UDP_NETWORK_DOWN);
-            }
-            else if (serverReply.contains("write_wintun", Qt::CaseInsensitive) && serverReply.contains("head/tail value is over capacity", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::WINTUN_OVER_CAPACITY);
-            }
-            else if (serverReply.contains("TCP", Qt::CaseInsensitive) && serverReply.contains("failed", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::TCP_ERROR);
-            }
-            else if (serverReply.contains("Initialization Sequence Completed With Errors", Qt::CaseInsensitive))
-            {
-                Q_EMIT error(ProtoTypes::ConnectError::INITIALIZATION_SEQUENCE_COMPLETED_WITH_ERRORS);
-            }
-#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
-            else if (serverReply.contains("device", Qt::CaseInsensitive) && serverReply.contains("opened", Qt::CaseInsensitive))
+            Q_EMIT error(ProtoTypes::ConnectError::ALL_TAP_IN_USE);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+bool OpenVPNConnection::checkNoTapAdapters(const QString &serverReply, boost::system::error_code &write_error)
+{
+    if (!serverReply.contains("There are no TAP-Windows adapters on this system", Qt::CaseInsensitive))
+    {
+        return false;
+    }
+    if (!stateVariables_.bTapErrorEmited)
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::NO_INSTALLED_TUN_TAP);
+        stateVariables_.bTapErrorEmited = true;
+        sendSigTerm(write_error);
+    }
+    return true;
+}
+
+void OpenVPNConnection::sendSigTerm(boost::system::error_code &write_error)
+{
+    if (!stateVariables_.bSigTermSent)
+    {
+        boost::asio::write(*stateVariables_.socket, boost::asio::buffer("signal SIGTERM\n"), boost::asio::transfer_all(), write_error);
+        helper_->clearUnblockingCmd(stateVariables_.lastCmdId);
+        stateVariables_.bSigTermSent = true;
+    }
+}
+
+void OpenVPNConnection::handleStateMessage(const QString &serverReply)
+{
+    if (serverReply.contains("CONNECTED,SUCCESS", Qt::CaseInsensitive))
+    {
+#ifdef Q_OS_WIN
+        AdapterGatewayInfo windscribeAdapter = AdapterUtils_win::getWindscribeConnectedAdapterInfo();
+        if (!windscribeAdapter.isEmpty())
+        {
+            if (connectionAdapterInfo_.adapterIp() != windscribeAdapter.adapterIp())
             {
-                QString deviceName;
-                if (parseDeviceOpenedReply(serverReply, deviceName))
-                {
-                    connectionAdapterInfo_.setAdapterName(deviceName);
-                }
+                qCDebug(LOG_CONNECTION) << "Error: Adapter IP detected from openvpn log not equal to the adapter IP from AdapterUtils_win::getWindscribeConnectedAdapterInfo()";
+                Q_ASSERT(false);
             }
+            connectionAdapterInfo_.setAdapterName(windscribeAdapter.adapterName());
+            connectionAdapterInfo_.setAdapterIp(windscribeAdapter.adapterIp());
+            connectionAdapterInfo_.setDnsServers(windscribeAdapter.dnsServers());
+            connectionAdapterInfo_.setIfIndex(windscribeAdapter.ifIndex());
+        }
+        else
+        {
+            qCDebug(LOG_CONNECTION) << "Can't detect connected Windscribe adapter";
+        }
 #endif
-            else if (serverReply.contains("PUSH: Received control message:", Qt::CaseInsensitive))
-            {
-                bool isRedirectDefaultGateway = true;
-                if (!parsePushReply(serverReply, connectionAdapterInfo_, isRedirectDefaultGateway))
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't parse PUSH Received control message";
-                }
 
-                if (isRedirectDefaultGateway)
-                {
-                    // We are going to set up the default gateway, so firewall is allowed after
-                    // we have connected (unless the current custom config explicitly forbits this).
-                    isAllowFirewallAfterCustomConfigConnection_ = true;
-                }
-            }
+        QString remoteIp;
+        if (parseConnectedSuccessReply(serverReply, remoteIp))
+        {
+            connectionAdapterInfo_.setRemoteIp(remoteIp);
         }
-        else if (serverReply.contains(">FATAL:All TAP-Windows adapters on this system are currently in use", Qt::CaseInsensitive))
+        else
         {
-            Q_EMIT error(ProtoTypes::ConnectError::ALL_TAP_IN_USE);
+            qCDebug(LOG_CONNECTION) << "Can't parse CONNECTED,SUCCESS control message";
         }
+        setCurrentState(STATUS_CONNECTED);
+        Q_EMIT connected(connectionAdapterInfo_);
+    }
+    else if (serverReply.contains("CONNECTED,ERROR", Qt::CaseInsensitive))
+    {
+        setCurrentState(STATUS_CONNECTED);
+        Q_EMIT error(ProtoTypes::ConnectError::CONNECTED_ERROR);
+    }
+    else if (serverReply.contains("RECONNECTING", Qt::CaseInsensitive))
+    {
+        stateVariables_.isAcceptSigTermCommand_ = false;
+        stateVariables_.bWasStateNotification = false;
+        setCurrentState(STATUS_CONNECTED_TO_SOCKET);
+        Q_EMIT reconnecting();
+    }
+}
 
-        checkErrorAndContinue(write_error, true);
+void OpenVPNConnection::handleLogMessage(const QString &serverReply)
+{
+    bool bContainsUDPWord = serverReply.contains("UDP", Qt::CaseInsensitive);
+    if (bContainsUDPWord && serverReply.contains("No buffer space available (WSAENOBUFS) (code=10055)", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
     }
-    else
+    else if (bContainsUDPWord && serverReply.contains("No Route to Host (WSAEHOSTUNREACH) (code=10065)", Qt::CaseInsensitive))
     {
-        qCDebug(LOG_CONNECTION) << "Read from openvpn socket connection failed, error:" << QString::fromStdString(err.message());
-        setCurrentStateAndEmitDisconnected(STATUS_DISCONNECTED);
+        Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
+    }
+    else if (bContainsUDPWord && serverReply.contains("Can't assign requested address (code=49)", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::UDP_CANT_ASSIGN);
+    }
+    else if (bContainsUDPWord && serverReply.contains("No buffer space available (code=55)", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::UDP_NO_BUFFER_SPACE);
+    }
+    else if (bContainsUDPWord && serverReply.contains("Network is down (code=50)", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::UDP_NETWORK_DOWN);
+    }
+    else if (serverReply.contains("write_wintun", Qt::CaseInsensitive) && serverReply.contains("head/tail value is over capacity", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::WINTUN_OVER_CAPACITY);
+    }
+    else if (serverReply.contains("TCP", Qt::CaseInsensitive) && serverReply.contains("failed", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::TCP_ERROR);
+    }
+    else if (serverReply.contains("Initialization Sequence Completed With Errors", Qt::CaseInsensitive))
+    {
+        Q_EMIT error(ProtoTypes::ConnectError::INITIALIZATION_SEQUENCE_COMPLETED_WITH_ERRORS);
+    }
+#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
+    else if (serverReply.contains("device", Qt::CaseInsensitive) && serverReply.contains("opened", Qt::CaseInsensitive))
+    {
+        QString deviceName;
+        if (parseDeviceOpenedReply(serverReply, deviceName))
+        {
+            connectionAdapterInfo_.setAdapterName(deviceName);
+        }
+    }
+#endif
+    else if (serverReply.contains("PUSH: Received control message:", Qt::CaseInsensitive))
+    {
+        bool isRedirectDefaultGateway = true;
+        if (!parsePushReply(serverReply, connectionAdapterInfo_, isRedirectDefaultGateway))
+        {
+            qCDebug(LOG_CONNECTION) << "Can't parse PUSH Received control message";
+        }
+
+        if (isRedirectDefaultGateway)
+        {
+            // We are going to set up the default gateway, so firewall is allowed after
+            // we have connected (unless the current custom config explicitly forbits this).
+            isAllowFirewallAfterCustomConfigConnection_ = true;
+        }
     }
 }
 
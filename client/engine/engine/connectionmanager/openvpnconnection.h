@@ -11,6 +11,8 @@
 #include "utils/boost_includes.h"
 #include <atomic>
 
+class OpenVPNManagementLine;
+
 class OpenVPNConnection : public IConnection
 {
     Q_OBJECT
@@ -40,6 +42,10 @@ private slots:
 private:
     static constexpr int DEFAULT_PORT = 9544;
     static constexpr int MAX_WAIT_OPENVPN_ON_START = 20000;
+    // the helper answers earlier if the openvpn process prints something or finishes
+    static constexpr int WAIT_OPENVPN_STATUS_MS = 100;
+    // the interval of the ">BYTECOUNT:" notifications in seconds
+    static constexpr int STATISTICS_INTERVAL = 1;
 
     IHelper *helper_;
     std::atomic<bool> bStopThread_;
@@ -80,6 +86,7 @@ private:
 
         unsigned long lastCmdId;
         unsigned int openVpnPort;
+        QString openVpnOutput;      // of the process started by lastCmdId, before the connect to its socket
 
         QElapsedTimer elapsedTimer;
 
@@ -102,6 +109,7 @@ private:
             prevBytesXmited = 0;
             lastCmdId = 0;
             openVpnPort = 0;
+            openVpnOutput.clear();
             bWasSocketConnected = false;
             bNeedSendSigTerm = false;
             isAcceptSigTermCommand_ = false;
@@ -119,6 +127,12 @@ private:
     void funcRunOpenVPN();
     void funcConnectToOpenVPN(const boost::system::error_code& err);
     void handleRead(const boost::system::error_code& err, size_t bytes_transferred);
+    void handleByteCount(const OpenVPNManagementLine &line);
+    void handleMessage(const OpenVPNManagementLine &line, boost::system::error_code &write_error);
+    void handleStateMessage(const QString &serverReply);
+    void handleLogMessage(const QString &serverReply);
+    bool checkNoTapAdapters(const QString &serverReply, boost::system::error_code &write_error);
+    void sendSigTerm(boost::system::error_code &write_error);
     void funcDisconnect();
 
     void checkErrorAndContinue(boost::system::error_code &write_error, bool bWithAsyncReadCall);
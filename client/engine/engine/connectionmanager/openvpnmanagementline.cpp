@@ -0,0 +1,172 @@
+#include "openvpnmanagementline.h"
+#include <string.h>
+
+namespace {
+
+struct Prefix
+{
+    const char *str;
+    size_t size;
+    OpenVPNManagementLine::MESSAGE_TYPE type;
+};
+
+#define PREFIX(s, t) { s, sizeof(s) - 1, OpenVPNManagementLine::t }
+
+// by the first letter of the message, ">" is skipped for the real-time messages
+const Prefix REALTIME_PREFIXES[] = {
+    PREFIX("BYTECOUNT:", TYPE_BYTECOUNT),
+    PREFIX("STATE:", TYPE_STATE),
+    PREFIX("LOG:", TYPE_LOG),
+    PREFIX("PASSWORD:", TYPE_PASSWORD),
+    PREFIX("HOLD:", TYPE_HOLD),
+    PREFIX("FATAL:", TYPE_FATAL),
+    PREFIX("INFO:", TYPE_INFO)
+};
+
+const Prefix REPLY_PREFIXES[] = {
+    PREFIX("SUCCESS:", TYPE_SUCCESS),
+    PREFIX("ERROR:", TYPE_ERROR),
+    PREFIX("END", TYPE_END)
+};
+
+#undef PREFIX
+
+class PrefixTable
+{
+public:
+    template<size_t N>
+    explicit PrefixTable(const Prefix (&prefixes)[N])
+    {
+        memset(first_, 0, sizeof(first_));
+        memset(second_, 0, sizeof(second_));
+        for (const Prefix &p : prefixes)
+        {
+            const unsigned char c = static_cast<unsigned char>(p.str[0]);
+            if (first_[c] == nullptr)
+            {
+                first_[c] = &p;
+            }
+            else
+            {
+                second_[c] = &p;
+            }
+        }
+    }
+
+    const Prefix *find(const char *data, size_t size) const
+    {
+        if (size == 0)
+        {
+            return nullptr;
+        }
+        const unsigned char c = static_cast<unsigned char>(data[0]);
+        if (isMatch(first_[c], data, size))
+        {
+            return first_[c];
+        }
+        if (isMatch(second_[c], data, size))
+        {
+            return second_[c];
+        }
+        return nullptr;
+    }
+
+private:
+    // no more than two prefixes start with the same letter ("ERROR:" and "END")
+    const Prefix *first_[256];
+    const Prefix *second_[256];
+
+    static bool isMatch(const Prefix *p, const char *data, size_t size)
+    {
+        return p != nullptr && size >= p->size && memcmp(data, p->str, p->size) == 0;
+    }
+};
+
+const PrefixTable &realtimeTable()
+{
+    static const PrefixTable table(REALTIME_PREFIXES);
+    return table;
+}
+
+const PrefixTable &replyTable()
+{
+    static const PrefixTable table(REPLY_PREFIXES);
+    return table;
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+} // namespace
+
+OpenVPNManagementLine::OpenVPNManagementLine(const char *data, size_t size) : data_(data), size_(size), prefixSize_(0),
+    type_(TYPE_UNKNOWN)
+{
+    while (size_ > 0 && isSpace(data_[size_ - 1]))
+    {
+        size_--;
+    }
+    while (size_ > 0 && isSpace(data_[0]))
+    {
+        data_++;
+        size_--;
+    }
+
+    const Prefix *prefix = nullptr;
+    if (size_ > 0 && data_[0] == '>')
+    {
+        prefix = realtimeTable().find(data_ + 1, size_ - 1);
+        if (prefix)
+        {
+            prefixSize_ = prefix->size + 1;
+        }
+    }
+    else
+    {
+        prefix = replyTable().find(data_, size_);
+        if (prefix)
+        {
+            prefixSize_ = prefix->size;
+        }
+    }
+    if (prefix)
+    {
+        type_ = prefix->type;
+    }
+}
+
+bool OpenVPNManagementLine::parseByteCount(quint64 &outBytesIn, quint64 &outBytesOut) const
+{
+    if (type_ != TYPE_BYTECOUNT)
+    {
+        return false;
+    }
+    const char *p = payload();
+    const char *end = p + payloadSize();
+    if (!parseNumber(p, end, outBytesIn) || p == end || *p != ',')
+    {
+        return false;
+    }
+    ++p;
+    return parseNumber(p, end, outBytesOut) && p == end;
+}
+
+QString OpenVPNManagementLine::toString() const
+{
+    return QString::fromUtf8(data_, static_cast<int>(size_));
+}
+
+bool OpenVPNManagementLine::parseNumber(const char *&p, const char *end, quint64 &outValue)
+{
+    const char *begin = p;
+    quint64 value = 0;
+    while (p != end && *p >= '0' && *p <= '9')
+    {
+        value = value * 10 + static_cast<quint64>(*p - '0');
+        ++p;
+    }
+    outValue = value;
+    return p != begin;
+}
@@ -0,0 +1,38 @@
+#ifndef OPENVPNMANAGEMENTLINE_H
+#define OPENVPNMANAGEMENTLINE_H
+
+#include <QString>
+#include <stddef.h>
+
+// A line of the OpenVPN management interface, a view of the read buffer (not copied).
+// The type is found from the prefix with a table lookup: the real-time messages (">BYTECOUNT:", ">STATE:", ...)
+// and the command replies ("SUCCESS:", "ERROR:", "END"). The rest of the line is the payload.
+class OpenVPNManagementLine
+{
+public:
+    enum MESSAGE_TYPE { TYPE_UNKNOWN, TYPE_BYTECOUNT, TYPE_STATE, TYPE_LOG, TYPE_PASSWORD, TYPE_HOLD, TYPE_FATAL,
+                        TYPE_INFO, TYPE_SUCCESS, TYPE_ERROR, TYPE_END };
+
+    // the trailing "\r\n" and the whitespace are trimmed
+    OpenVPNManagementLine(const char *data, size_t size);
+
+    MESSAGE_TYPE type() const { return type_; }
+    const char *payload() const { return data_ + prefixSize_; }
+    size_t payloadSize() const { return size_ - prefixSize_; }
+
+    // ">BYTECOUNT:<bytes in>,<bytes out>", without the allocations
+    bool parseByteCount(quint64 &outBytesIn, quint64 &outBytesOut) const;
+
+    // the whole line
+    QString toString() const;
+
+private:
+    const char *data_;
+    size_t size_;
+    size_t prefixSize_;
+    MESSAGE_TYPE type_;
+
+    static bool parseNumber(const char *&p, const char *end, quint64 &outValue);
+};
+
+#endif // OPENVPNMANAGEMENTLINE_H
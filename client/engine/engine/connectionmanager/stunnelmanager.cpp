@@ -8,12 +8,15 @@
 
 
 
-StunnelManager::StunnelManager(QObject *parent) : QObject(parent), bProcessStarted_(false),
-                                                  portForStunnel_(0)
+StunnelManager::StunnelManager(QObject *parent) : QObject(parent), bProcessStarted_(false), bInUse_(false),
+                                                  portForStunnel_(0), port_(0)
 {
     process_ = new QProcess(this);
     connect(process_, SIGNAL(finished(int)), SLOT(onStunnelProcessFinished()));
 
+    idleTimer_.setSingleShot(true);
+    connect(&idleTimer_, SIGNAL(timeout()), SLOT(onIdleTimer()));
+
 #if defined Q_OS_WIN
     stunelExePath_ = QCoreApplication::applicationDirPath() + "/tstunnel.exe";
 #elif defined Q_OS_MAC
@@ -41,6 +44,14 @@ StunnelManager::~StunnelManager()
 
 bool StunnelManager::runProcess()
 {
+    idleTimer_.stop();
+    bInUse_ = true;
+    if (isProcessRunning())
+    {
+        qCDebug(LOG_BASIC) << "stunnel reused";
+        return true;
+    }
+
     ExecutableSignature sigCheck;
     if (!sigCheck.verifyWithSignCheck(stunelExePath_.toStdWString()))
     {
@@ -58,9 +69,17 @@ bool StunnelManager::runProcess()
 
 bool StunnelManager::setConfig(const QString &hostname, uint port)
 {
+    // the running process is kept for the same node, its port and config stay valid
+    if (isProcessRunning() && hostname == hostname_ && port == port_)
+    {
+        return true;
+    }
+
     killProcess();
     if (makeConfigFile(hostname, port))
     {
+        hostname_ = hostname;
+        port_ = port;
         return true;
     }
     else
@@ -71,6 +90,8 @@ bool StunnelManager::setConfig(const QString &hostname, uint port)
 
 void StunnelManager::killProcess()
 {
+    idleTimer_.stop();
+    bInUse_ = false;
     if (bProcessStarted_)
     {
         bProcessStarted_ = false;
@@ -89,6 +110,15 @@ void StunnelManager::killProcess()
     }
 }
 
+void StunnelManager::releaseProcess()
+{
+    bInUse_ = false;
+    if (bProcessStarted_)
+    {
+        idleTimer_.start(IDLE_TIMEOUT);
+    }
+}
+
 unsigned int StunnelManager::getStunnelPort()
 {
     return portForStunnel_;
@@ -101,11 +131,26 @@ void StunnelManager::onStunnelProcessFinished()
     {
         qCDebug(LOG_BASIC) << "Stunnel finished";
         qCDebug(LOG_BASIC) << process_->readAllStandardError();
-        emit stunnelFinished();
+        // an idle process isn't related to the current connection
+        if (bInUse_)
+        {
+            emit stunnelFinished();
+        }
     }
 #endif
 }
 
+void StunnelManager::onIdleTimer()
+{
+    qCDebug(LOG_BASIC) << "stunnel is idle for" << IDLE_TIMEOUT / 1000 << "seconds";
+    killProcess();
+}
+
+bool StunnelManager::isProcessRunning() const
+{
+    return bProcessStarted_ && process_->state() != QProcess::NotRunning;
+}
+
 bool StunnelManager::makeConfigFile(const QString &hostname, uint port)
 {
     QFile file(path_);
@@ -3,7 +3,10 @@
 
 #include <QObject>
 #include <QProcess>
+#include <QTimer>
 
+// Runs stunnel for the OpenVPN over stunnel. After the connection is finished the process is kept running for a while
+// (releaseProcess), so a reconnect to the same node reuses it instead of starting it again.
 class StunnelManager : public QObject
 {
     Q_OBJECT
@@ -14,6 +17,8 @@ public:
     bool setConfig(const QString &hostname, uint port);
     bool runProcess();
     void killProcess();
+    // the process isn't used anymore, it's killed if it isn't reused before the idle timeout
+    void releaseProcess();
 
     unsigned int getStunnelPort();
 
@@ -22,16 +27,27 @@ signals:
 
 private slots:
     void onStunnelProcessFinished();
+    void onIdleTimer();
 
 private:
     QString path_;
     QProcess    *process_;
     QString     stunelExePath_;
     bool bProcessStarted_;
+    bool bInUse_;
 
     static constexpr unsigned int DEFAULT_PORT = 1194;
     unsigned int portForStunnel_;
 
+    // the node of the running process
+    QString hostname_;
+    uint port_;
+
+    static constexpr int IDLE_TIMEOUT = 60000;
+    QTimer idleTimer_;
+
+    bool isProcessRunning() const;
+
     bool makeConfigFile(const QString &hostname, uint port);
 };
 
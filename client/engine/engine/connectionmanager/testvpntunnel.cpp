@@ -3,6 +3,7 @@
 #include "utils/logger.h"
 #include "utils/ipvalidation.h"
 #include "utils/extraconfig.h"
+#include "utils/tracespan.h"
 
 #if defined(Q_OS_WINDOWS)
 #include "utils/hardcodedsettings.h"
@@ -117,15 +118,19 @@ QStringList DnsQueryContext::ips() const
 #endif
 
 TestVPNTunnel::TestVPNTunnel(QObject *parent, ServerAPI *serverAPI) : QObject(parent),
-    serverAPI_(serverAPI), bRunning_(false), curTest_(1), cmdId_(0), doCustomTunnelTest_(false), doWin32TunnelTest_(false)
+    serverAPI_(serverAPI), bRunning_(false), curTest_(1), cmdId_(0), doCustomTunnelTest_(false), startUs_(0),
+    probesInFlight_(0), doWin32TunnelTest_(false)
 {
+    probeTimer_.setInterval(PROBE_INTERVAL);
+    connect(&probeTimer_, &QTimer::timeout, this, &TestVPNTunnel::onProbeTimer);
+
     #if defined(Q_OS_WINDOWS)
     dllHandle_ = NULL;
     DnsQueryEx_f = NULL;
     DnsCancelQuery_f = NULL;
 
     dnsQueryTimeout_.setSingleShot(true);
-    dnsQueryTimeout_.setInterval(PING_TEST_TIMEOUT_1 + PING_TEST_TIMEOUT_2 + PING_TEST_TIMEOUT_3);
+    dnsQueryTimeout_.setInterval(TOTAL_TIMEOUT);
     connect(&dnsQueryTimeout_, &QTimer::timeout, this, &TestVPNTunnel::onWin32DnsQueryTimeout);
     #endif
 }
@@ -144,8 +149,9 @@ void TestVPNTunnel::startTests(const ProtocolType &protocol)
     qCDebug(LOG_CONNECTION) << "TestVPNTunnel::startTests()";
 
     stopTests();
+    startUs_ = TraceSpan::nowUs();
 
-    connect(serverAPI_, &ServerAPI::pingTestAnswer, this, &TestVPNTunnel::onPingTestAnswer, Qt::QueuedConnection);
+    connect(serverAPI_, &ServerAPI::pingTestAnswer, this, &TestVPNTunnel::onPingTestAnswer, Qt::UniqueConnection | Qt::QueuedConnection);
 
     #if defined(Q_OS_WINDOWS)
     doWin32TunnelTest_ = protocol.isWireGuardProtocol() || (protocol.isOpenVpnProtocol() && OpenVpnVersionController::instance().isUseWinTun());
@@ -163,6 +169,8 @@ void TestVPNTunnel::startTests(const ProtocolType &protocol)
 
         doWin32TunnelTest_ = false;
     }
+    #else
+    Q_UNUSED(protocol);
     #endif
 
     bool advParamExists;
@@ -184,6 +192,12 @@ void TestVPNTunnel::startTestImpl()
 
     int timeout = ExtraConfig::instance().getTunnelTestTimeout(doCustomTunnelTest_);
 
+    bRunning_ = true;
+    curTest_ = 1;
+    elapsed_.start();
+    cmdId_++;
+    lastTimeForCallWithLog_ = QTime::currentTime();
+
     if (doCustomTunnelTest_)
     {
         bool advParamExists;
@@ -200,20 +214,19 @@ void TestVPNTunnel::startTestImpl()
         qCDebug(LOG_CONNECTION) << "Running custom tunnel test with" << attempts << "attempts, timeout of" << timeout << "ms, and retry delay of" << testRetryDelay_ << "ms";
 
         timeouts_.fill(timeout, attempts);
+
+        // the custom test keeps the configured sequence of the attempts
+        qCDebug(LOG_CONNECTION) << "Doing tunnel test 1";
+        serverAPI_->pingTest(cmdId_, timeouts_[curTest_ - 1], true);
     }
     else
     {
-        timeouts_ << PING_TEST_TIMEOUT_1 << PING_TEST_TIMEOUT_2 << PING_TEST_TIMEOUT_3;
+        // all the probes share cmdId_, so cancelPingTest() cancels the pending ones at once
+        qCDebug(LOG_CONNECTION) << "Doing tunnel tests, up to" << MAX_PROBES_IN_FLIGHT << "at once";
+        probesInFlight_ = 0;
+        startProbe();
+        probeTimer_.start();
     }
-
-    // start first test
-    qCDebug(LOG_CONNECTION) << "Doing tunnel test 1";
-    bRunning_ = true;
-    curTest_ = 1;
-    elapsed_.start();
-    cmdId_++;
-    lastTimeForCallWithLog_ = QTime::currentTime();
-    serverAPI_->pingTest(cmdId_, timeouts_[curTest_ - 1], true);
 }
 
 void TestVPNTunnel::stopTests()
@@ -221,6 +234,8 @@ void TestVPNTunnel::stopTests()
     if (bRunning_)
     {
         bRunning_ = false;
+        probeTimer_.stop();
+        probesInFlight_ = 0;
 
         if (doWin32TunnelTest_)
         {
@@ -249,29 +264,19 @@ void TestVPNTunnel::onPingTestAnswer(SERVER_API_RET_CODE retCode, const QString
         const QString trimmedData = data.trimmed();
         if (retCode == SERVER_RETURN_SUCCESS && IpValidation::instance().isIp(trimmedData))
         {
-            qCDebug(LOG_CONNECTION) << "Tunnel test " << QString::number(curTest_) << "successfully finished with IP:" << trimmedData;
-            bRunning_ = false;
-            doWin32TunnelTest_ = false;
-
-            #if defined(Q_OS_WINDOWS)
-            dnsQueryTimeout_.stop();
-            #endif
-
-            emit testsFinished(true, trimmedData);
+            qCDebug(LOG_CONNECTION) << "Tunnel test successfully finished with IP:" << trimmedData;
+            if (!doWin32TunnelTest_)
+            {
+                // the rest of the parallel probes are not needed anymore
+                serverAPI_->cancelPingTest(cmdId_);
+            }
+            finishTests(true, trimmedData);
         }
         else
         {
             if (doWin32TunnelTest_)
             {
-                bRunning_ = false;
-                doWin32TunnelTest_ = false;
-
-                #if defined(Q_OS_WINDOWS)
-                dnsQueryTimeout_.stop();
-                #endif
-
-                emit testsFinished(true, trimmedData);
-
+                finishTests(true, trimmedData);
                 return;
             }
 
@@ -286,32 +291,21 @@ void TestVPNTunnel::onPingTestAnswer(SERVER_API_RET_CODE retCode, const QString
                 }
                 else
                 {
-                    bRunning_ = false;
-                    emit testsFinished(false, "");
+                    finishTests(false, "");
                 }
             }
             else
             {
-                if (elapsed_.elapsed() < timeouts_[curTest_-1])
+                // the replacement probe is started by probeTimer_, not at once, so the fast failures
+                // (e.g. the network is unreachable) don't flood ServerAPI
+                if (probesInFlight_ > 0)
                 {
-                    // next ping attempt after 100 ms
-                    QTimer::singleShot(100, this, &TestVPNTunnel::doNextPingTest);
+                    probesInFlight_--;
                 }
-                else
+                if (probesInFlight_ == 0 && elapsed_.elapsed() >= TOTAL_TIMEOUT)
                 {
-                    qCDebug(LOG_CONNECTION) << "Tunnel test " << QString::number(curTest_) << "failed";
-
-                    if (curTest_ < timeouts_.size())
-                    {
-                        curTest_++;
-                        elapsed_.start();
-                        doNextPingTest();
-                    }
-                    else
-                    {
-                        bRunning_ = false;
-                        emit testsFinished(false, "");
-                    }
+                    qCDebug(LOG_CONNECTION) << "Tunnel tests failed";
+                    finishTests(false, "");
                 }
             }
         }
@@ -320,33 +314,72 @@ void TestVPNTunnel::onPingTestAnswer(SERVER_API_RET_CODE retCode, const QString
 
 void TestVPNTunnel::doNextPingTest()
 {
-    if (bRunning_ && curTest_ >= 1 && curTest_ <= timeouts_.size())
+    if (bRunning_ && doCustomTunnelTest_ && curTest_ >= 1 && curTest_ <= timeouts_.size())
     {
         cmdId_++;
+        serverAPI_->pingTest(cmdId_, timeouts_[curTest_-1], true);
+    }
+}
 
-        if (doCustomTunnelTest_)
+void TestVPNTunnel::onProbeTimer()
+{
+    if (!bRunning_)
+    {
+        probeTimer_.stop();
+        return;
+    }
+
+    if (elapsed_.elapsed() >= TOTAL_TIMEOUT)
+    {
+        probeTimer_.stop();
+        if (probesInFlight_ == 0)
         {
-            serverAPI_->pingTest(cmdId_, timeouts_[curTest_-1], true);
+            qCDebug(LOG_CONNECTION) << "Tunnel tests failed";
+            finishTests(false, "");
         }
-        else
-        {
-            // reduce log output (maximum 1 log output per 1 sec)
-            bool bWriteLog = lastTimeForCallWithLog_.msecsTo(QTime::currentTime()) > 1000;
-            if (bWriteLog)
-            {
-                lastTimeForCallWithLog_ = QTime::currentTime();
-            }
+        return;
+    }
 
-            if ((timeouts_[curTest_-1] - elapsed_.elapsed()) > 0)
-            {
-                serverAPI_->pingTest(cmdId_, timeouts_[curTest_-1] - elapsed_.elapsed(), bWriteLog);
-            }
-            else
-            {
-                serverAPI_->pingTest(cmdId_, 100, bWriteLog);
-            }
-        }
+    startProbe();
+}
+
+void TestVPNTunnel::startProbe()
+{
+    const qint64 remaining = TOTAL_TIMEOUT - elapsed_.elapsed();
+    if (probesInFlight_ >= MAX_PROBES_IN_FLIGHT || remaining <= 0)
+    {
+        return;
+    }
+
+    // reduce log output (maximum 1 log output per 1 sec)
+    bool bWriteLog = lastTimeForCallWithLog_.msecsTo(QTime::currentTime()) > 1000;
+    if (bWriteLog)
+    {
+        lastTimeForCallWithLog_ = QTime::currentTime();
     }
+
+    probesInFlight_++;
+    serverAPI_->pingTest(cmdId_, qMin<qint64>(remaining, PROBE_TIMEOUT), bWriteLog);
+}
+
+void TestVPNTunnel::finishTests(bool bSuccess, const QString &ipAddress)
+{
+    bRunning_ = false;
+    doWin32TunnelTest_ = false;
+    probeTimer_.stop();
+    probesInFlight_ = 0;
+
+    #if defined(Q_OS_WINDOWS)
+    dnsQueryTimeout_.stop();
+    #endif
+
+    if (bSuccess)
+    {
+        qCDebug(LOG_CONNECTION) << "Time to the verified tunnel:" << (TraceSpan::nowUs() - startUs_) / 1000 << "ms";
+        TraceSpan::record("engine", "tunnel test", startUs_);
+    }
+
+    emit testsFinished(bSuccess, ipAddress);
 }
 
 #if defined(Q_OS_WINDOWS)
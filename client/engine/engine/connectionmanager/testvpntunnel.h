@@ -21,6 +21,8 @@ class DnsQueryContext;
 #endif
 
 // do set of tests after VPN tunnel is established
+// by default several ping tests run at once (a new one is started every PROBE_INTERVAL while less than MAX_PROBES_IN_FLIGHT
+// are pending), the first successful answer finishes the tests, so a single lost or slow request doesn't delay the connected state
 class TestVPNTunnel : public QObject
 {
     Q_OBJECT
@@ -39,6 +41,7 @@ private slots:
     void onPingTestAnswer(SERVER_API_RET_CODE retCode, const QString &data);
     void doNextPingTest();
     void startTestImpl();
+    void onProbeTimer();
 
     #if defined(Q_OS_WINDOWS)
     bool initiateWin32TunnelTest();
@@ -55,16 +58,28 @@ private:
     QTime lastTimeForCallWithLog_;
     int testRetryDelay_;
     bool doCustomTunnelTest_;
+    qint64 startUs_;
+    QTimer probeTimer_;
+    int probesInFlight_;
 
     enum {
            PING_TEST_TIMEOUT_1 = 2000,
            PING_TEST_TIMEOUT_2 = 4000,
            PING_TEST_TIMEOUT_3 = 8000
        };
+    enum {
+           TOTAL_TIMEOUT = PING_TEST_TIMEOUT_1 + PING_TEST_TIMEOUT_2 + PING_TEST_TIMEOUT_3,
+           PROBE_TIMEOUT = PING_TEST_TIMEOUT_2,
+           PROBE_INTERVAL = 100,
+           MAX_PROBES_IN_FLIGHT = 3
+       };
     QVector<uint> timeouts_;
 
     bool doWin32TunnelTest_;
 
+    void startProbe();
+    void finishTests(bool bSuccess, const QString &ipAddress);
+
     #if defined(Q_OS_WINDOWS)
     typedef DNS_STATUS WINAPI DnsQueryEx_T(PDNS_QUERY_REQUEST pQueryRequest, PDNS_QUERY_RESULT pQueryResults, PDNS_QUERY_CANCEL pCancelHandle);
     typedef DNS_STATUS WINAPI DnsCancelQuery_T(PDNS_QUERY_CANCEL pCancelHandle);
@@ -0,0 +1,127 @@
+#include "throughputmeter.h"
+
+#include <math.h>
+#include "engine/enginemetrics.h"
+
+ThroughputMeter::ThroughputMeter(QObject *parent) : QObject(parent), history_(HISTORY_SIZE)
+{
+    connect(&sampleTimer_, SIGNAL(timeout()), SLOT(onSampleTimer()));
+    reset();
+}
+
+void ThroughputMeter::start()
+{
+    reset();
+    sampleElapsed_.start();
+    sampleTimer_.start(SAMPLE_INTERVAL);
+}
+
+void ThroughputMeter::stop()
+{
+    sampleTimer_.stop();
+    EngineMetrics::instance().setGauge("windscribe_tunnel_throughput_bytes_per_second", 0, "direction", "in");
+    EngineMetrics::instance().setGauge("windscribe_tunnel_throughput_bytes_per_second", 0, "direction", "out");
+}
+
+ProtoTypes::ThroughputHistory ThroughputMeter::history() const
+{
+    ProtoTypes::ThroughputHistory h;
+    h.set_interval_ms(SAMPLE_INTERVAL);
+    h.mutable_bytes_in()->Reserve(historyCount_);
+    h.mutable_bytes_out()->Reserve(historyCount_);
+    // the oldest sample first
+    int ind = (historyHead_ - historyCount_ + HISTORY_SIZE) % HISTORY_SIZE;
+    for (int i = 0; i < historyCount_; ++i)
+    {
+        h.add_bytes_in(history_[ind].bytesIn);
+        h.add_bytes_out(history_[ind].bytesOut);
+        ind = (ind + 1) % HISTORY_SIZE;
+    }
+    return h;
+}
+
+void ThroughputMeter::onStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes)
+{
+    quint64 deltaIn = bytesIn;
+    quint64 deltaOut = bytesOut;
+    if (isTotalBytes)
+    {
+        // the counters start again after a reconnect of the tunnel
+        deltaIn = bytesIn >= reportedTotalIn_ ? bytesIn - reportedTotalIn_ : bytesIn;
+        deltaOut = bytesOut >= reportedTotalOut_ ? bytesOut - reportedTotalOut_ : bytesOut;
+        reportedTotalIn_ = bytesIn;
+        reportedTotalOut_ = bytesOut;
+    }
+
+    totalIn_ += deltaIn;
+    totalOut_ += deltaOut;
+    sampleIn_ += deltaIn;
+    sampleOut_ += deltaOut;
+}
+
+void ThroughputMeter::onSampleTimer()
+{
+    // the real interval, the timer can be late on a busy thread
+    const double intervalSec = qMax<qint64>(sampleElapsed_.restart(), 1) / 1000.0;
+
+    Sample &sample = history_[historyHead_];
+    sample.bytesIn = sampleIn_;
+    sample.bytesOut = sampleOut_;
+    historyHead_ = (historyHead_ + 1) % HISTORY_SIZE;
+    historyCount_ = qMin(historyCount_ + 1, static_cast<int>(HISTORY_SIZE));
+
+    rate1s_.in = sampleIn_ / intervalSec;
+    rate1s_.out = sampleOut_ / intervalSec;
+    sampleIn_ = 0;
+    sampleOut_ = 0;
+
+    if (isFirstSample_)
+    {
+        rate10s_ = rate1s_;
+        rate60s_ = rate1s_;
+        isFirstSample_ = false;
+    }
+    else
+    {
+        updateEwma(rate10s_, rate1s_, intervalSec, 10.0);
+        updateEwma(rate60s_, rate1s_, intervalSec, 60.0);
+    }
+
+    ProtoTypes::Throughput throughput;
+    throughput.set_bytes_in(totalIn_);
+    throughput.set_bytes_out(totalOut_);
+    throughput.set_in_bps_1s(static_cast<quint64>(rate1s_.in * 8));
+    throughput.set_out_bps_1s(static_cast<quint64>(rate1s_.out * 8));
+    throughput.set_in_bps_10s(static_cast<quint64>(rate10s_.in * 8));
+    throughput.set_out_bps_10s(static_cast<quint64>(rate10s_.out * 8));
+    throughput.set_in_bps_60s(static_cast<quint64>(rate60s_.in * 8));
+    throughput.set_out_bps_60s(static_cast<quint64>(rate60s_.out * 8));
+    emit throughputUpdated(throughput);
+
+    EngineMetrics::instance().setGauge("windscribe_tunnel_throughput_bytes_per_second", rate10s_.in, "direction", "in");
+    EngineMetrics::instance().setGauge("windscribe_tunnel_throughput_bytes_per_second", rate10s_.out, "direction", "out");
+}
+
+void ThroughputMeter::reset()
+{
+    totalIn_ = 0;
+    totalOut_ = 0;
+    reportedTotalIn_ = 0;
+    reportedTotalOut_ = 0;
+    sampleIn_ = 0;
+    sampleOut_ = 0;
+    historyHead_ = 0;
+    historyCount_ = 0;
+    rate1s_ = Rate{0, 0};
+    rate10s_ = Rate{0, 0};
+    rate60s_ = Rate{0, 0};
+    isFirstSample_ = true;
+}
+
+void ThroughputMeter::updateEwma(Rate &rate, const Rate &current, double intervalSec, double windowSec)
+{
+    // the weight of the interval depends on its real length, so a late timer doesn't skew the average
+    const double alpha = 1.0 - exp(-intervalSec / windowSec);
+    rate.in += alpha * (current.in - rate.in);
+    rate.out += alpha * (current.out - rate.out);
+}
@@ -0,0 +1,75 @@
+#ifndef THROUGHPUTMETER_H
+#define THROUGHPUTMETER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "utils/protobuf_includes.h"
+
+// Aggregates the traffic statistics of the connection: the connections report either the increments or the totals
+// since the start (isTotalBytes), both are normalized here to the totals of the session.
+// Once per SAMPLE_INTERVAL the bytes of the interval are put to a fixed-size ring (the history for a graph) and
+// the rates are updated: the last interval and the exponential moving averages over 10 and 60 seconds.
+// The updates are emitted once per interval at most, only while the meter runs.
+class ThroughputMeter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThroughputMeter(QObject *parent);
+
+    void start();
+    void stop();
+
+    ProtoTypes::ThroughputHistory history() const;
+
+    enum { SAMPLE_INTERVAL = 1000, HISTORY_SIZE = 300 };
+
+public slots:
+    // from ConnectionManager::statisticsUpdated()
+    void onStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+
+signals:
+    void throughputUpdated(const ProtoTypes::Throughput &throughput);
+
+private slots:
+    void onSampleTimer();
+
+private:
+    struct Sample
+    {
+        quint64 bytesIn;
+        quint64 bytesOut;
+    };
+
+    struct Rate
+    {
+        double in;
+        double out;
+    };
+
+    QTimer sampleTimer_;
+    QElapsedTimer sampleElapsed_;
+
+    quint64 totalIn_;
+    quint64 totalOut_;
+    // the last totals of a connection reporting the totals, to get the increments
+    quint64 reportedTotalIn_;
+    quint64 reportedTotalOut_;
+    quint64 sampleIn_;
+    quint64 sampleOut_;
+
+    QVector<Sample> history_;
+    int historyHead_;       // the next sample is written here
+    int historyCount_;
+
+    Rate rate1s_;
+    Rate rate10s_;
+    Rate rate60s_;
+    bool isFirstSample_;
+
+    void reset();
+    static void updateEwma(Rate &rate, const Rate &current, double intervalSec, double windowSec);
+};
+
+#endif // THROUGHPUTMETER_H
@@ -0,0 +1,245 @@
+#include "tunnelspeedtest.h"
+#include "engine/networkaccessmanager/networkaccessmanager.h"
+#include "utils/logger.h"
+
+#include <algorithm>
+
+TunnelSpeedTest::TunnelSpeedTest(QObject *parent, NetworkAccessManager *networkAccessManager) : QObject(parent),
+    networkAccessManager_(networkAccessManager), pingHost_(this, nullptr), state_(STATE_NONE), isPingInFlight_(false),
+    bytes_(0), failedRequests_(0), pingsSent_(0), pingsLost_(0)
+{
+    connect(&pingHost_, SIGNAL(pingFinished(bool,int,QString,bool)), SLOT(onPingFinished(bool,int,QString,bool)));
+    connect(&pingTimer_, SIGNAL(timeout()), SLOT(onPingTimer()));
+    connect(&downloadTimer_, SIGNAL(timeout()), SLOT(onDownloadTimer()));
+    downloadTimer_.setSingleShot(true);
+}
+
+TunnelSpeedTest::~TunnelSpeedTest()
+{
+    stop();
+}
+
+void TunnelSpeedTest::start(const QString &url, const QString &gatewayIp)
+{
+    stop();
+
+    url_ = url;
+    gatewayIp_ = gatewayIp;
+    bytes_ = 0;
+    failedRequests_ = 0;
+    pingsSent_ = 0;
+    pingsLost_ = 0;
+    idleLatencies_.clear();
+    loadedLatencies_.clear();
+
+    qCDebug(LOG_CONNECTION) << "Tunnel speed test started, gateway:" << gatewayIp_ << ", url:" << url_;
+
+    if (gatewayIp_.isEmpty())
+    {
+        // no latency, the download only
+        startDownload();
+    }
+    else
+    {
+        state_ = STATE_IDLE_PINGS;
+        pingTimer_.start(IDLE_PING_INTERVAL);
+        sendPing();
+    }
+}
+
+void TunnelSpeedTest::stop()
+{
+    if (state_ != STATE_NONE)
+    {
+        qCDebug(LOG_CONNECTION) << "Tunnel speed test stopped";
+    }
+    state_ = STATE_NONE;
+    pingTimer_.stop();
+    downloadTimer_.stop();
+    pingHost_.clearPings();
+    isPingInFlight_ = false;
+    releaseReplies();
+}
+
+void TunnelSpeedTest::abort(const QString &error)
+{
+    if (state_ != STATE_NONE)
+    {
+        finish(error);
+    }
+}
+
+void TunnelSpeedTest::onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState)
+{
+    Q_UNUSED(isFromDisconnectedState);
+    if (state_ == STATE_NONE || ip != gatewayIp_)
+    {
+        return;
+    }
+
+    isPingInFlight_ = false;
+    if (!bSuccess)
+    {
+        pingsLost_++;
+    }
+    else if (state_ == STATE_IDLE_PINGS)
+    {
+        idleLatencies_ << timems;
+    }
+    else
+    {
+        loadedLatencies_ << timems;
+    }
+
+    if (state_ == STATE_IDLE_PINGS && pingsSent_ >= IDLE_PINGS_COUNT)
+    {
+        startDownload();
+    }
+}
+
+void TunnelSpeedTest::onPingTimer()
+{
+    // one ping at a time, a ping slower than the interval delays the next one
+    if (!isPingInFlight_ && (state_ == STATE_DOWNLOAD || pingsSent_ < IDLE_PINGS_COUNT))
+    {
+        sendPing();
+    }
+}
+
+void TunnelSpeedTest::onDownloadTimer()
+{
+    finish(QString());
+}
+
+void TunnelSpeedTest::onReplyReadyRead()
+{
+    NetworkReply *reply = qobject_cast<NetworkReply *>(sender());
+    if (reply && state_ == STATE_DOWNLOAD)
+    {
+        bytes_ += reply->readAll().size();
+    }
+}
+
+void TunnelSpeedTest::onReplyFinished()
+{
+    NetworkReply *reply = qobject_cast<NetworkReply *>(sender());
+    if (!reply || !replies_.contains(reply))
+    {
+        return;
+    }
+    replies_.removeOne(reply);
+    if (reply->isSuccess())
+    {
+        bytes_ += reply->readAll().size();
+    }
+    else
+    {
+        failedRequests_++;
+    }
+    reply->deleteLater();
+
+    if (state_ != STATE_DOWNLOAD)
+    {
+        return;
+    }
+    // a few failures are tolerated, the rest streams keep the load
+    if (failedRequests_ > STREAMS_COUNT)
+    {
+        finish(bytes_ > 0 ? QString() : "download failed");
+    }
+    else
+    {
+        startStream();
+    }
+}
+
+void TunnelSpeedTest::sendPing()
+{
+    isPingInFlight_ = true;
+    pingsSent_++;
+    pingHost_.addHostForPing(gatewayIp_, PingHost::PING_ICMP);
+}
+
+void TunnelSpeedTest::startDownload()
+{
+    state_ = STATE_DOWNLOAD;
+    if (!gatewayIp_.isEmpty())
+    {
+        pingTimer_.start(LOADED_PING_INTERVAL);
+    }
+    downloadElapsed_.start();
+    downloadTimer_.start(DOWNLOAD_DURATION);
+    for (int i = 0; i < STREAMS_COUNT; ++i)
+    {
+        startStream();
+    }
+}
+
+void TunnelSpeedTest::startStream()
+{
+    // the DNS cache is skipped, the name should be resolved by the DNS of the tunnel
+    NetworkRequest request(QUrl(url_), REQUEST_TIMEOUT, false);
+    NetworkReply *reply = networkAccessManager_->get(request);
+    connect(reply, SIGNAL(readyRead()), SLOT(onReplyReadyRead()));
+    connect(reply, SIGNAL(finished()), SLOT(onReplyFinished()));
+    replies_ << reply;
+}
+
+void TunnelSpeedTest::finish(const QString &error)
+{
+    const qint64 durationMs = downloadElapsed_.isValid() ? downloadElapsed_.elapsed() : 0;
+
+    ProtoTypes::TunnelSpeedTestResult result;
+    result.set_is_success(error.isEmpty());
+    if (!error.isEmpty())
+    {
+        result.set_error(error.toStdString());
+    }
+    result.set_bytes(bytes_);
+    result.set_duration_ms(static_cast<quint32>(durationMs));
+    result.set_streams_count(STREAMS_COUNT);
+    if (durationMs > 0)
+    {
+        // bits per millisecond is kbit/s
+        result.set_download_kbps(static_cast<quint32>(bytes_ * 8 / durationMs));
+    }
+    if (!idleLatencies_.isEmpty())
+    {
+        result.set_idle_latency_ms(median(idleLatencies_));
+    }
+    if (!loadedLatencies_.isEmpty())
+    {
+        result.set_loaded_latency_ms(median(loadedLatencies_));
+        result.set_loaded_latency_max_ms(*std::max_element(loadedLatencies_.begin(), loadedLatencies_.end()));
+    }
+    result.set_pings_sent(pingsSent_);
+    result.set_pings_lost(pingsLost_);
+
+    qCDebug(LOG_CONNECTION) << "Tunnel speed test finished:" << (error.isEmpty() ? "success" : error)
+                            << ", download:" << result.download_kbps() << "kbps (" << bytes_ << "bytes in" << durationMs << "ms,"
+                            << STREAMS_COUNT << "streams), latency idle:" << result.idle_latency_ms() << "ms, loaded:"
+                            << result.loaded_latency_ms() << "ms, max:" << result.loaded_latency_max_ms()
+                            << "ms, pings lost:" << pingsLost_ << "of" << pingsSent_;
+
+    state_ = STATE_NONE;
+    stop();
+    emit finished(result);
+}
+
+void TunnelSpeedTest::releaseReplies()
+{
+    for (NetworkReply *reply : qAsConst(replies_))
+    {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    replies_.clear();
+}
+
+int TunnelSpeedTest::median(QVector<int> values)
+{
+    const int ind = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + ind, values.end());
+    return values[ind];
+}
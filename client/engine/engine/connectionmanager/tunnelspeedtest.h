@@ -0,0 +1,78 @@
+#ifndef TUNNELSPEEDTEST_H
+#define TUNNELSPEEDTEST_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "engine/ping/pinghost.h"
+#include "utils/protobuf_includes.h"
+
+class NetworkAccessManager;
+class NetworkReply;
+
+// measures the connected tunnel: the idle latency (ICMP pings of the tunnel gateway), then the download throughput of
+// several parallel streams and the latency under that load (the same pings while the streams run),
+// the data of the streams is counted and dropped, a stream finished before the end of the test is started again
+class TunnelSpeedTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TunnelSpeedTest(QObject *parent, NetworkAccessManager *networkAccessManager);
+    virtual ~TunnelSpeedTest();
+
+    void start(const QString &url, const QString &gatewayIp);
+    void stop();
+    // stops the running test and emits finished() with the error
+    void abort(const QString &error);
+    bool isRunning() const { return state_ != STATE_NONE; }
+
+signals:
+    void finished(const ProtoTypes::TunnelSpeedTestResult &result);
+
+private slots:
+    void onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState);
+    void onPingTimer();
+    void onDownloadTimer();
+    void onReplyReadyRead();
+    void onReplyFinished();
+
+private:
+    enum STATE { STATE_NONE, STATE_IDLE_PINGS, STATE_DOWNLOAD };
+    enum {
+        IDLE_PINGS_COUNT = 5,
+        IDLE_PING_INTERVAL = 200,
+        LOADED_PING_INTERVAL = 250,
+        STREAMS_COUNT = 4,
+        DOWNLOAD_DURATION = 10000,
+        REQUEST_TIMEOUT = DOWNLOAD_DURATION + 5000
+    };
+
+    NetworkAccessManager *networkAccessManager_;
+    PingHost pingHost_;
+    QTimer pingTimer_;
+    QTimer downloadTimer_;
+    QElapsedTimer downloadElapsed_;
+
+    STATE state_;
+    QString url_;
+    QString gatewayIp_;
+    bool isPingInFlight_;
+    QVector<NetworkReply *> replies_;
+    quint64 bytes_;
+    int failedRequests_;
+    quint32 pingsSent_;
+    quint32 pingsLost_;
+    QVector<int> idleLatencies_;
+    QVector<int> loadedLatencies_;
+
+    void sendPing();
+    void startDownload();
+    void startStream();
+    void finish(const QString &error);
+    void releaseReplies();
+
+    static int median(QVector<int> values);
+};
+
+#endif // TUNNELSPEEDTEST_H
@@ -25,7 +25,8 @@ static const QString serviceIdentifier("WindscribeWireguard");
 WireGuardConnection::WireGuardConnection(QObject *parent, IHelper *helper)
     : IConnection(parent),
       helper_(dynamic_cast<Helper_win*>(helper)),
-      stopRequested_(false)
+      stopRequested_(false),
+      isApplicationActive_(true)
 {
 }
 
@@ -175,14 +176,20 @@ void WireGuardConnection::run()
         // If the wireguard service indicates that it has started, the adapter and tunnel are up.
         // Let's check if the client-server handshake, which indicates the tunnel is good-to-go, has happened yet.
         // onGetWireguardLogUpdates() is much less 'expensive' than calling onGetWireguardStats().
+        openStatsBlock();
         onGetWireguardLogUpdates();
         if (!connectedSignalEmited_) {
             onGetWireguardStats();
         }
 
+        connectionTimer_.start();
         QScopedPointer< QTimer > timerGetWireguardStats(new QTimer);
-        connect(timerGetWireguardStats.data(), &QTimer::timeout, this, &WireGuardConnection::onGetWireguardStats);
-        timerGetWireguardStats->start(5000);
+        QTimer *statsTimer = timerGetWireguardStats.data();
+        connect(statsTimer, &QTimer::timeout, statsTimer, [this, statsTimer]() {
+            statsTimer->setInterval(statsInterval());
+            QMetaObject::invokeMethod(this, "onGetWireguardStats", Qt::QueuedConnection);
+        });
+        timerGetWireguardStats->start(statsInterval());
 
         QScopedPointer< QTimer > timerCheckServiceRunning(new QTimer);
         connect(timerCheckServiceRunning.data(), &QTimer::timeout, this, &WireGuardConnection::onCheckServiceRunning);
@@ -196,7 +203,7 @@ void WireGuardConnection::run()
             exec();
         }
 
-        disconnect(timerGetWireguardStats.data(), &QTimer::timeout, nullptr, nullptr);
+        disconnect(statsTimer, &QTimer::timeout, nullptr, nullptr);
         disconnect(timerCheckServiceRunning.data(), &QTimer::timeout, nullptr, nullptr);
         disconnect(timerGetWireguardLogUpdates.data(), &QTimer::timeout, nullptr, nullptr);
 
@@ -206,6 +213,7 @@ void WireGuardConnection::run()
 
         // Get final receive/transmit byte counts.
         onGetWireguardStats();
+        closeStatsBlock();
 
         serviceCtrlManager_.closeSCM();
 
@@ -232,6 +240,7 @@ void WireGuardConnection::run()
     }
 
     wireguardLog_.reset();
+    closeStatsBlock();
 
     // Ensure the config file is deleted if something went awry during service install/startup.  If all goes well,
     // the wireguard service will delete the file when it exits.
@@ -248,6 +257,16 @@ void WireGuardConnection::run()
     }
 }
 
+void WireGuardConnection::setApplicationActive(bool isActive)
+{
+    const bool wasActive = isApplicationActive_.exchange(isActive);
+    // the counters are fresh when the window is shown, the timer switches to the active interval on its next tick
+    if (isActive && !wasActive && isRunning()) {
+        // called from the engine thread, the stats are read in the same place as for the timer
+        QMetaObject::invokeMethod(this, "onGetWireguardStats", Qt::QueuedConnection);
+    }
+}
+
 void WireGuardConnection::onCheckServiceRunning()
 {
     if (isDisconnected())
@@ -274,6 +293,11 @@ void WireGuardConnection::onGetWireguardLogUpdates()
 
 void WireGuardConnection::onGetWireguardStats()
 {
+    // the service publishes the stats to the shared memory, the helper is only the fallback
+    if (readStatsBlock()) {
+        return;
+    }
+
     // TODO: Need to periodically do this in order to retrieve the bytes received/transmitted
     // Would be nice if we could do this on-demand, as this information is only relevant when
     // the user wants to see it (see ConnectWindowItem::onConnectStateTextHoverEnter()).
@@ -316,3 +340,81 @@ QString WireGuardConnection::getWireGuardAdapterName()
 {
     return QString("WireGuardTunnel");
 }
+
+void WireGuardConnection::openStatsBlock()
+{
+    // the service creates the block when it installs the WireGuard service
+    hStatsMapping_ = ::OpenFileMappingW(FILE_MAP_READ, FALSE, WIREGUARD_STATS_MAPPING_NAME);
+    if (hStatsMapping_ == NULL)
+    {
+        qCDebug(LOG_CONNECTION) << "WireGuardConnection::openStatsBlock - OpenFileMapping failed:" << ::GetLastError()
+                                << ", the stats are requested from the helper";
+        return;
+    }
+    statsBlock_ = static_cast<const WireGuardStatsBlock *>(::MapViewOfFile(hStatsMapping_, FILE_MAP_READ, 0, 0, sizeof(WireGuardStatsBlock)));
+    if (statsBlock_ == nullptr)
+    {
+        qCDebug(LOG_CONNECTION) << "WireGuardConnection::openStatsBlock - MapViewOfFile failed:" << ::GetLastError();
+        ::CloseHandle(hStatsMapping_);
+        hStatsMapping_ = NULL;
+    }
+    lastRxBytes_ = 0;
+    lastTxBytes_ = 0;
+}
+
+void WireGuardConnection::closeStatsBlock()
+{
+    if (statsBlock_ != nullptr)
+    {
+        ::UnmapViewOfFile(statsBlock_);
+        statsBlock_ = nullptr;
+    }
+    if (hStatsMapping_ != NULL)
+    {
+        ::CloseHandle(hStatsMapping_);
+        hStatsMapping_ = NULL;
+    }
+}
+
+bool WireGuardConnection::readStatsBlock()
+{
+    if (statsBlock_ == nullptr) {
+        return false;
+    }
+
+    WireGuardStatsBlock block;
+    if (!readWireGuardStatsBlock(statsBlock_, block)) {
+        return false;
+    }
+    // the publisher thread of the service is stopped or stuck
+    if (::GetTickCount64() - block.updateTime > 4 * WIREGUARD_STATS_UPDATE_INTERVAL_MS) {
+        return false;
+    }
+    if (block.state != WIREGUARD_STATE_ACTIVE) {
+        return true;
+    }
+
+    if (!connectedSignalEmited_ && block.lastHandshake > 0)
+    {
+        connectedSignalEmited_ = true;
+        qCDebug(LOG_CONNECTION) << "WireGuardConnection - the handshake with" << QString::fromLatin1(block.endpoint, qstrnlen(block.endpoint, sizeof(block.endpoint)));
+        AdapterGatewayInfo info = AdapterUtils_win::getWireguardConnectedAdapterInfo(serviceIdentifier);
+        emit connected(info);
+    }
+
+    if (block.rxBytes != lastRxBytes_ || block.txBytes != lastTxBytes_)
+    {
+        lastRxBytes_ = block.rxBytes;
+        lastTxBytes_ = block.txBytes;
+        emit statisticsUpdated(block.rxBytes, block.txBytes, true);
+    }
+    return true;
+}
+
+int WireGuardConnection::statsInterval() const
+{
+    if (connectionTimer_.elapsed() < STATS_STARTUP_PERIOD) {
+        return WIREGUARD_STATS_UPDATE_INTERVAL_MS;
+    }
+    return isApplicationActive_ ? STATS_ACTIVE_INTERVAL : STATS_INACTIVE_INTERVAL;
+}
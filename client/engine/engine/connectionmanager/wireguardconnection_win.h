@@ -1,6 +1,7 @@
 #ifndef WIREGUARDCONNECTION_WIN_H
 #define WIREGUARDCONNECTION_WIN_H
 
+#include <QElapsedTimer>
 #include <QScopedPointer>
 
 #include <atomic>
@@ -23,6 +24,7 @@ public:
                       const WireGuardConfig *wireGuardConfig, bool isEnableIkev2Compression, bool isAutomaticConnectionMode) override;
     void startDisconnect() override;
     bool isDisconnected() const override;
+    void setApplicationActive(bool isActive) override;
 
     ConnectionType getConnectionType() const override { return ConnectionType::WIREGUARD; }
 
@@ -48,8 +50,28 @@ private:
     bool connectedSignalEmited_ = false;
     std::atomic<bool> stopRequested_;
 
+    // the stats block published by the service, read without the helper calls
+    HANDLE hStatsMapping_ = NULL;
+    const WireGuardStatsBlock *statsBlock_ = nullptr;
+    UINT64 lastRxBytes_ = 0;
+    UINT64 lastTxBytes_ = 0;
+
+    // The stats are read at the publishing rate of the service for the first seconds of the connection, so the
+    // handshake (or its absence) is noticed quickly, then every second for the counters of the GUI, and rarely
+    // when the GUI window isn't active. The interval is adjusted by the timer itself in the thread of run().
+    static constexpr int STATS_STARTUP_PERIOD = 10000;
+    static constexpr int STATS_ACTIVE_INTERVAL = 1000;
+    static constexpr int STATS_INACTIVE_INTERVAL = 5000;
+    std::atomic<bool> isApplicationActive_;
+    QElapsedTimer connectionTimer_;
+
 private:
     void onWireguardServiceStartupFailure() const;
+    void openStatsBlock();
+    void closeStatsBlock();
+    int statsInterval() const;
+    // returns false if the block isn't available or isn't updated by the service
+    bool readStatsBlock();
 };
 
 #endif // WIREGUARDCONNECTION_WIN_H
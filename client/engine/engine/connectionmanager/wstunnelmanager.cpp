@@ -2,13 +2,14 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QStandardPaths>
+#include <QTimer>
 #include "utils/logger.h"
 #include "availableport.h"
 #include "utils/executable_signature/executable_signature.h"
 
 
 WstunnelManager::WstunnelManager(QObject *parent) : QObject(parent), bProcessStarted_(false),
-                                                    bFirstMarketLineAfterStart_(false), port_(0)
+                                                    bFirstMarketLineAfterStart_(false), bInUse_(false), port_(0)
 {
     process_ = new QProcess(this);
     connect(process_, SIGNAL(started()), SLOT(onProcessStarted()));
@@ -17,6 +18,9 @@ WstunnelManager::WstunnelManager(QObject *parent) : QObject(parent), bProcessSta
     connect(process_, SIGNAL(errorOccurred(QProcess::ProcessError)), SLOT(onProcessErrorOccurred(QProcess::ProcessError)));
     process_->setProcessChannelMode(QProcess::MergedChannels);
 
+    idleTimer_.setSingleShot(true);
+    connect(&idleTimer_, SIGNAL(timeout()), SLOT(onIdleTimer()));
+
 #if defined Q_OS_WIN
     wstunelExePath_ = QCoreApplication::applicationDirPath() + "/wstunnel.exe";
 #elif defined Q_OS_MAC
@@ -35,6 +39,29 @@ WstunnelManager::~WstunnelManager()
 
 bool WstunnelManager::runProcess(const QString &hostname, unsigned int port, bool isUdp)
 {
+    QStringList args;
+    QString addr = QString("127.0.0.1:%1:127.0.0.1:1194").arg(port_);
+    QString hostaddr = QString("wss://%1:%2").arg(hostname).arg(port);
+    args << "--localToRemote" << addr << hostaddr << "--verbose" << "--upgradePathPrefix=/";
+    if (isUdp)
+    {
+        args << "--udp";
+    }
+
+    idleTimer_.stop();
+    if (isProcessRunning() && args == args_)
+    {
+        qCDebug(LOG_WSTUNNEL) << "wstunnel reused";
+        bInUse_ = true;
+        // if it's already listening, the caller expects the signal after the return, otherwise it comes from the output
+        if (!bFirstMarketLineAfterStart_)
+        {
+            QTimer::singleShot(0, this, SIGNAL(wstunnelStarted()));
+        }
+        return true;
+    }
+    killProcess();
+
     ExecutableSignature sigCheck;
     if (!sigCheck.verifyWithSignCheck(wstunelExePath_.toStdWString()))
     {
@@ -45,20 +72,16 @@ bool WstunnelManager::runProcess(const QString &hostname, unsigned int port, boo
     inputArr_.clear();
     bFirstMarketLineAfterStart_ = true;
     bProcessStarted_ = true;
-    QStringList args;
-    QString addr = QString("127.0.0.1:%1:127.0.0.1:1194").arg(port_);
-    QString hostaddr = QString("wss://%1:%2").arg(hostname).arg(port);
-    args << "--localToRemote" << addr << hostaddr << "--verbose" << "--upgradePathPrefix=/";
-    if (isUdp)
-    {
-        args << "--udp";
-    }
+    bInUse_ = true;
+    args_ = args;
     process_->start(wstunelExePath_, args);
     return true;
 }
 
 void WstunnelManager::killProcess()
 {
+    idleTimer_.stop();
+    bInUse_ = false;
     if (bProcessStarted_)
     {
         bProcessStarted_ = false;
@@ -76,9 +99,22 @@ void WstunnelManager::killProcess()
     }
 }
 
+void WstunnelManager::releaseProcess()
+{
+    bInUse_ = false;
+    if (bProcessStarted_)
+    {
+        idleTimer_.start(IDLE_TIMEOUT);
+    }
+}
+
 unsigned int WstunnelManager::getPort()
 {
-    port_ = AvailablePort::getAvailablePort(DEFAULT_PORT);
+    // the port of the running process is kept, it's released by the kill if the process isn't reused
+    if (!isProcessRunning())
+    {
+        port_ = AvailablePort::getAvailablePort(DEFAULT_PORT);
+    }
     return port_;
 }
 
@@ -94,7 +130,11 @@ void WstunnelManager::onProcessFinished()
     {
         qCDebug(LOG_WSTUNNEL) << "wstunnel finished";
         qCDebug(LOG_WSTUNNEL) << process_->readAllStandardError();
-        emit wstunnelFinished();
+        // an idle process isn't related to the current connection
+        if (bInUse_)
+        {
+            emit wstunnelFinished();
+        }
     }
 #endif
 }
@@ -117,7 +157,10 @@ void WstunnelManager::onReadyReadStandardOutput()
                 if (str.contains("WAIT for tcp connection on"))
                 {
                     bFirstMarketLineAfterStart_ = false;
-                    emit wstunnelStarted();
+                    if (bInUse_)
+                    {
+                        emit wstunnelStarted();
+                    }
                 }
             }
         }
@@ -133,6 +176,17 @@ void WstunnelManager::onProcessErrorOccurred(QProcess::ProcessError /*error*/)
     qCDebug(LOG_WSTUNNEL) << "wstunnel process error:" << process_->errorString();
 }
 
+void WstunnelManager::onIdleTimer()
+{
+    qCDebug(LOG_WSTUNNEL) << "wstunnel is idle for" << IDLE_TIMEOUT / 1000 << "seconds";
+    killProcess();
+}
+
+bool WstunnelManager::isProcessRunning() const
+{
+    return bProcessStarted_ && process_->state() != QProcess::NotRunning;
+}
+
 QString WstunnelManager::getNextStringFromInputBuffer(bool &bSuccess, int &outSize)
 {
     QString str;
@@ -3,7 +3,10 @@
 
 #include <QObject>
 #include <QProcess>
+#include <QTimer>
 
+// Runs wstunnel for the OpenVPN over websocket. As StunnelManager, the process is kept running for a while after
+// the connection (releaseProcess) and reused by a reconnect to the same node.
 class WstunnelManager : public QObject
 {
     Q_OBJECT
@@ -13,6 +16,8 @@ public:
 
     bool runProcess(const QString &hostname, unsigned int port, bool isUdp);
     void killProcess();
+    // the process isn't used anymore, it's killed if it isn't reused before the idle timeout
+    void releaseProcess();
 
     unsigned int getPort();
 
@@ -25,6 +30,7 @@ private slots:
     void onProcessFinished();
     void onReadyReadStandardOutput();
     void onProcessErrorOccurred(QProcess::ProcessError error);
+    void onIdleTimer();
 
 private:
     QProcess    *process_;
@@ -32,10 +38,19 @@ private:
     bool bProcessStarted_;
     QByteArray inputArr_;
     bool bFirstMarketLineAfterStart_;
+    bool bInUse_;
 
     static constexpr unsigned int DEFAULT_PORT = 1194;
     unsigned int port_;
 
+    // the arguments of the running process
+    QStringList args_;
+
+    static constexpr int IDLE_TIMEOUT = 60000;
+    QTimer idleTimer_;
+
+    bool isProcessRunning() const;
+
     QString getNextStringFromInputBuffer(bool &bSuccess, int &outSize);
 
 };
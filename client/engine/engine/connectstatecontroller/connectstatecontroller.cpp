@@ -1,10 +1,7 @@
 #include "connectstatecontroller.h"
+#include <QDateTime>
 
 ConnectStateController::ConnectStateController(QObject *parent) : IConnectStateController(parent),
-    state_(CONNECT_STATE_DISCONNECTED),
-    prevState_(CONNECT_STATE_DISCONNECTED),
-    disconnectReason_(DISCONNECTED_ITSELF),
-    err_(ProtoTypes::ConnectError::NO_CONNECT_ERROR),
     mutex_(QMutex::Recursive)
 {
 }
@@ -12,85 +9,79 @@ ConnectStateController::ConnectStateController(QObject *parent) : IConnectStateC
 void ConnectStateController::setConnectedState(const LocationID &location)
 {
     QMutexLocker locker(&mutex_);
-    if (state_ != CONNECT_STATE_CONNECTED)
+    if (currentState() != CONNECT_STATE_CONNECTED)
     {
-        prevState_ = state_;
-        state_ = CONNECT_STATE_CONNECTED;
-        err_ = ProtoTypes::ConnectError::NO_CONNECT_ERROR;
-        disconnectReason_ = DISCONNECTED_ITSELF;
-        location_ = location;
-        emit stateChanged(state_, disconnectReason_, err_, location_);
+        publish(CONNECT_STATE_CONNECTED, DISCONNECTED_ITSELF, ProtoTypes::ConnectError::NO_CONNECT_ERROR, location);
     }
 }
 
 void ConnectStateController::setDisconnectedState(DISCONNECT_REASON reason, ProtoTypes::ConnectError err)
 {
     QMutexLocker locker(&mutex_);
-    if (state_ != CONNECT_STATE_DISCONNECTED || reason == DISCONNECTED_WITH_ERROR)
+    if (currentState() != CONNECT_STATE_DISCONNECTED || reason == DISCONNECTED_WITH_ERROR)
     {
-        prevState_ = state_;
-        state_ = CONNECT_STATE_DISCONNECTED;
-        disconnectReason_ = reason;
-        err_ = err;
-        location_ = LocationID();   //reset
-        emit stateChanged(state_, disconnectReason_, err_, location_);
+        publish(CONNECT_STATE_DISCONNECTED, reason, err, LocationID());
     }
 }
 
 void ConnectStateController::setConnectingState(const LocationID &location)
 {
     QMutexLocker locker(&mutex_);
-    if (state_ != CONNECT_STATE_CONNECTING)
+    if (currentState() != CONNECT_STATE_CONNECTING)
     {
-        prevState_ = state_;
-        state_ = CONNECT_STATE_CONNECTING;
-        err_ = ProtoTypes::ConnectError::NO_CONNECT_ERROR;
-        disconnectReason_ = DISCONNECTED_ITSELF;
-        location_ = location;
-        emit stateChanged(state_, disconnectReason_, err_, location_);
+        publish(CONNECT_STATE_CONNECTING, DISCONNECTED_ITSELF, ProtoTypes::ConnectError::NO_CONNECT_ERROR, location);
     }
 }
 
 void ConnectStateController::setDisconnectingState()
 {
     QMutexLocker locker(&mutex_);
-    if (state_ != CONNECT_STATE_DISCONNECTING)
+    if (currentState() != CONNECT_STATE_DISCONNECTING)
     {
-        prevState_ = state_;
-        state_ = CONNECT_STATE_DISCONNECTING;
-        err_ = ProtoTypes::ConnectError::NO_CONNECT_ERROR;
-        disconnectReason_ = DISCONNECTED_ITSELF;
-        location_ = LocationID();   //reset
-        emit stateChanged(state_, disconnectReason_, err_, location_);
+        publish(CONNECT_STATE_DISCONNECTING, DISCONNECTED_ITSELF, ProtoTypes::ConnectError::NO_CONNECT_ERROR, LocationID());
     }
 }
 
-CONNECT_STATE ConnectStateController::currentState()
+ConnectStateSnapshot ConnectStateController::snapshot() const
 {
     QMutexLocker locker(&mutex_);
-    return state_;
+    return snapshot_;
+}
+
+CONNECT_STATE ConnectStateController::currentState()
+{
+    return snapshot().state;
 }
 
 CONNECT_STATE ConnectStateController::prevState()
 {
-    QMutexLocker locker(&mutex_);
-    return prevState_;
+    return snapshot().prevState;
 }
 
 DISCONNECT_REASON ConnectStateController::disconnectReason()
 {
-    QMutexLocker locker(&mutex_);
-    return disconnectReason_;
+    return snapshot().reason;
 }
 
 ProtoTypes::ConnectError ConnectStateController::connectionError()
 {
-    QMutexLocker locker(&mutex_);
-    return err_;
+    return snapshot().err;
 }
 
-const LocationID &ConnectStateController::locationId()
+LocationID ConnectStateController::locationId()
 {
-    QMutexLocker locker(&mutex_);
-    return location_;
+    return snapshot().location;
+}
+
+void ConnectStateController::publish(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location)
+{
+    snapshot_.prevState = snapshot_.state;
+    snapshot_.state = state;
+    snapshot_.reason = reason;
+    snapshot_.err = err;
+    snapshot_.location = location;
+    snapshot_.timestamp = QDateTime::currentMSecsSinceEpoch();
+    snapshot_.version++;
+
+    emit stateChanged(snapshot_.state, snapshot_.reason, snapshot_.err, snapshot_.location);
 }
@@ -18,20 +18,21 @@ public:
     void setConnectingState(const LocationID &location);
     void setDisconnectingState();
 
+    ConnectStateSnapshot snapshot() const override;
+
     virtual CONNECT_STATE currentState() override;
     virtual CONNECT_STATE prevState() override;
 
     DISCONNECT_REASON disconnectReason() override;
     ProtoTypes::ConnectError connectionError() override;
-    const LocationID& locationId() override;
+    LocationID locationId() override;
 
 private:
-    CONNECT_STATE state_;
-    CONNECT_STATE prevState_;
-    DISCONNECT_REASON disconnectReason_;
-    ProtoTypes::ConnectError err_;
-    LocationID location_;
-    QMutex mutex_;
+    // not lock-free: the readers copy the snapshot under mutex_, the critical section is only the copy
+    ConnectStateSnapshot snapshot_;
+    mutable QMutex mutex_;
+
+    void publish(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
 };
 
 #endif // CONNECTSTATECONTROLLER_H
@@ -6,6 +6,20 @@
 #include "engine/types/types.h"
 #include "types/locationid.h"
 
+// The connect state as a whole, the copy returned by IConnectStateController::snapshot() is consistent.
+struct ConnectStateSnapshot
+{
+    CONNECT_STATE state = CONNECT_STATE_DISCONNECTED;
+    CONNECT_STATE prevState = CONNECT_STATE_DISCONNECTED;
+    DISCONNECT_REASON reason = DISCONNECTED_ITSELF;
+    ProtoTypes::ConnectError err = ProtoTypes::ConnectError::NO_CONNECT_ERROR;
+    LocationID location;
+    qint64 timestamp = 0;   // of the change, msecs since epoch
+    quint64 version = 0;    // incremented on each change
+};
+
+// The getters can be called from any thread, the consumers which only check the state don't need
+// the stateChanged() signal.
 class IConnectStateController : public QObject
 {
     Q_OBJECT
@@ -13,12 +27,14 @@ public:
     explicit IConnectStateController(QObject *parent) : QObject(parent) {}
     virtual ~IConnectStateController() {}
 
+    virtual ConnectStateSnapshot snapshot() const = 0;
+
     virtual CONNECT_STATE currentState() = 0;
     virtual CONNECT_STATE prevState() = 0;
 
     virtual DISCONNECT_REASON disconnectReason() = 0;
     virtual ProtoTypes::ConnectError connectionError() = 0;
-    virtual const LocationID& locationId() = 0;
+    virtual LocationID locationId() = 0;
 
 signals:
     void stateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
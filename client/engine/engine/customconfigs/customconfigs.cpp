@@ -1,5 +1,12 @@
 #include "customconfigs.h"
+#include <QCryptographicHash>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRunnable>
+#include <QThreadPool>
+#include <functional>
+#include "utils/crashhandler.h"
 #include "utils/logger.h"
 #include "parseovpnconfigline.h"
 #include "ovpncustomconfig.h"
@@ -7,6 +14,25 @@
 
 namespace customconfigs {
 
+namespace {
+
+// runs CustomConfigs::parseFile() on a pool thread
+class ParseTask : public QRunnable
+{
+public:
+    explicit ParseTask(std::function<void()> func) : func_(func) {}
+    void run() override
+    {
+        BIND_CRASH_HANDLER_FOR_THREAD();
+        func_();
+    }
+
+private:
+    std::function<void()> func_;
+};
+
+} // namespace
+
 CustomConfigs::CustomConfigs(QObject *parent) : QObject(parent), dirWatcher_(NULL)
 {
 }
@@ -27,6 +53,8 @@ void CustomConfigs::changeDir(const QString &path)
         return;
     }
 
+    // the same filenames in another directory are other configs
+    files_.clear();
     if (!path.isEmpty())
     {
         dirWatcher_ = new CustomConfigsDirWatcher(this, path);
@@ -44,30 +72,116 @@ QVector<QSharedPointer<const ICustomConfig> > CustomConfigs::getConfigs()
 void CustomConfigs::onDirectoryChanged()
 {
     qDebug(LOG_CUSTOM_OVPN) << "custom_configs directory is changed";
-    parseDir();
-    emit changed();
+    if (parseDir())
+    {
+        emit changed();
+    }
 }
 
-void CustomConfigs::parseDir()
+bool CustomConfigs::parseDir()
 {
-    configs_.clear();
-
     if (!dirWatcher_)
-        return;
+    {
+        const bool isChanged = !configs_.isEmpty();
+        configs_.clear();
+        return isChanged;
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
 
-    QStringList fileList = dirWatcher_->curFiles();
+    const QStringList fileList = dirWatcher_->curFiles();
+    QHash<QString, FileItem> newFiles;
+    QStringList changedFiles;
     for (const QString &filename : fileList)
     {
-        QString filepath = dirWatcher_->curDir() + "/" + filename;
-        QSharedPointer<const ICustomConfig> config = makeCustomConfigFromFile(filepath);
+        const QFileInfo fi(dirWatcher_->curDir() + "/" + filename);
+        FileItem item = files_.value(filename);
+        if (item.config.isNull() || item.lastModified != fi.lastModified() || item.size != fi.size())
+        {
+            changedFiles << filename;
+        }
+        newFiles.insert(filename, item);
+    }
+
+    // the files are hashed and parsed in parallel, every task writes only its own item
+    QVector<FileItem *> changedItems;
+    for (const QString &filename : qAsConst(changedFiles))
+    {
+        changedItems << &newFiles[filename];
+    }
+    QThreadPool threadPool;
+    for (int i = 0; i < changedFiles.size(); ++i)
+    {
+        const QString filepath = dirWatcher_->curDir() + "/" + changedFiles[i];
+        FileItem *item = changedItems[i];
+        threadPool.start(new ParseTask([filepath, item]() { parseFile(filepath, *item); }));
+    }
+    threadPool.waitForDone();
+
+    int added = 0, updated = 0, removed = 0;
+    for (const QString &filename : qAsConst(changedFiles))
+    {
+        const FileItem oldItem = files_.value(filename);
+        if (oldItem.config.isNull())
+        {
+            added++;
+        }
+        else if (oldItem.config != newFiles[filename].config)
+        {
+            updated++;
+        }
+    }
+    for (auto it = files_.constBegin(); it != files_.constEnd(); ++it)
+    {
+        if (!newFiles.contains(it.key()))
+        {
+            removed++;
+        }
+    }
+
+    files_ = newFiles;
+    configs_.clear();
+    for (const QString &filename : fileList)
+    {
+        const QSharedPointer<const ICustomConfig> &config = files_[filename].config;
         if (!config.isNull())
         {
             configs_ << config;
         }
     }
+
+    qDebug(LOG_CUSTOM_OVPN) << "custom configs parsed:" << changedFiles.size() << "of" << fileList.size() << "files read,"
+                            << added << "added," << updated << "updated," << removed << "removed, in"
+                            << elapsedTimer.elapsed() << "ms";
+    return added > 0 || updated > 0 || removed > 0;
+}
+
+void CustomConfigs::parseFile(const QString &filepath, FileItem &item)
+{
+    const QFileInfo fi(filepath);
+    item.lastModified = fi.lastModified();
+    item.size = fi.size();
+
+    QByteArray hash;
+    QFile file(filepath);
+    if (file.open(QIODevice::ReadOnly))
+    {
+        QCryptographicHash cryptographicHash(QCryptographicHash::Sha1);
+        cryptographicHash.addData(&file);
+        hash = cryptographicHash.result();
+    }
+
+    // touched files with the same content keep their configs
+    if (!item.config.isNull() && !hash.isEmpty() && hash == item.hash)
+    {
+        return;
+    }
+    item.hash = hash;
+    item.config = makeCustomConfigFromFile(filepath, hash);
 }
 
-QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromFile(const QString &filepath)
+QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromFile(const QString &filepath, const QByteArray &hash)
 {
     QFileInfo fi(filepath);
     QString fileSuffix = fi.suffix();
@@ -77,7 +191,7 @@ QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromFile(cons
     }
     else if (fileSuffix.compare("conf", Qt::CaseInsensitive) == 0)
     {
-        return QSharedPointer<const ICustomConfig>(WireguardCustomConfig::makeFromFile(filepath));
+        return QSharedPointer<const ICustomConfig>(WireguardCustomConfig::makeFromFile(filepath, hash));
     }
 
     return NULL;
@@ -1,6 +1,8 @@
 #ifndef CUSTOMCONFIGS_H
 #define CUSTOMCONFIGS_H
 
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QSharedPointer>
 #include <QVector>
@@ -10,6 +12,8 @@
 namespace customconfigs {
 
 // parse custom configs directory, make ovpn configs location
+// only the files changed since the previous parse are parsed again (in parallel), the unchanged configs are kept
+// as the same objects, so the users can tell the updated configs by the pointers
 class CustomConfigs : public QObject
 {
     Q_OBJECT
@@ -26,11 +30,24 @@ private slots:
     void onDirectoryChanged();
 
 private:
-    void parseDir();
+    struct FileItem
+    {
+        QDateTime lastModified;
+        qint64 size;
+        QByteArray hash;
+        QSharedPointer<const ICustomConfig> config;
 
-    QSharedPointer<const ICustomConfig> makeCustomConfigFromFile(const QString &filepath);
+        FileItem() : size(0) {}
+    };
+
+    // returns true if any config was added, removed or updated
+    bool parseDir();
+
+    static void parseFile(const QString &filepath, FileItem &item);
+    static QSharedPointer<const ICustomConfig> makeCustomConfigFromFile(const QString &filepath, const QByteArray &hash);
 
     CustomConfigsDirWatcher *dirWatcher_;
+    QHash<QString, FileItem> files_;    // filename -> the state of the file when it was parsed
     QVector<QSharedPointer<const ICustomConfig>> configs_;
 };
 
@@ -1,6 +1,7 @@
 #include "customconfigsdirwatcher.h"
 
 #include <QDir>
+#include <QSet>
 #include <QStandardPaths>
 #include "utils/logger.h"
 
@@ -46,12 +47,6 @@ void CustomConfigsDirWatcher::onEmitTimer()
 
 void CustomConfigsDirWatcher::checkFiles(bool bWithEmitSignal, bool bFileChanged)
 {
-    // remove prev files from watch paths
-    for (const QString &filename : qAsConst(curFiles_))
-    {
-        dirWatcher_.removePath(path_ + "/" + filename);
-    }
-
     QDir dir(path_);
     QStringList filters;
     filters << "*.ovpn" << "*.conf";
@@ -67,8 +62,25 @@ void CustomConfigsDirWatcher::checkFiles(bool bWithEmitSignal, bool bFileChanged
             continue;
         }
         newFileList << filename;
+    }
 
-        dirWatcher_.addPath(path_ + "/" + filename);
+    // update the watch paths only for the added and removed files (and the replaced ones, which are dropped by the watcher)
+    const QSet<QString> curFilesSet = curFiles_.toSet();
+    const QSet<QString> newFilesSet = newFileList.toSet();
+    const QSet<QString> watchedFiles = dirWatcher_.files().toSet();
+    for (const QString &filename : curFilesSet)
+    {
+        if (!newFilesSet.contains(filename))
+        {
+            dirWatcher_.removePath(path_ + "/" + filename);
+        }
+    }
+    for (const QString &filename : newFilesSet)
+    {
+        if (!watchedFiles.contains(path_ + "/" + filename))
+        {
+            dirWatcher_.addPath(path_ + "/" + filename);
+        }
     }
 
     if ((!bFileChanged && newFileList != curFiles_) || bFileChanged)
@@ -2,7 +2,10 @@
 #include "utils/logger.h"
 #include "parseovpnconfigline.h"
 
+#include <QFile>
 #include <QFileInfo>
+#include <QTextCodec>
+#include <cstring>
 
 namespace customconfigs {
 
@@ -122,10 +125,82 @@ void OvpnCustomConfig::process()
         bool isTapDevice = false;
         bool bHasValidCipher = false;
         QString currentProtocol{ "udp" };
-        QTextStream in(&file);
-        while (!in.atEnd())
+        QByteArray ovpnData;
+
+        // the file is mapped (read if it can't be) and scanned as bytes, only the lines with the directives the client
+        // handles are decoded, the other lines and the inline blocks of certificates and keys are copied as slices
+        QByteArray fileData;
+        const char *data = nullptr;
+        qint64 size = file.size();
+        uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+        if (mapped)
         {
-            QString line = in.readLine();
+            data = reinterpret_cast<const char *>(mapped);
+        }
+        else
+        {
+            fileData = file.readAll();
+            data = fileData.constData();
+            size = fileData.size();
+        }
+
+        // decoded as QTextStream did: by the BOM if there is one, with the locale codec otherwise; a UTF-16/32 file
+        // is converted to UTF-8 first, the scan below needs an ASCII compatible encoding
+        QTextCodec *codec = QTextCodec::codecForUtfText(QByteArray::fromRawData(data, size), QTextCodec::codecForLocale());
+        if (codec != QTextCodec::codecForLocale() && codec->mibEnum() != 106)    // 106 is UTF-8
+        {
+            fileData = codec->toUnicode(data, size).toUtf8();
+            data = fileData.constData();
+            size = fileData.size();
+            codec = QTextCodec::codecForMib(106);
+        }
+        ovpnData.reserve(size + 64);
+
+        const char *end = data + size;
+        const char *p = data;
+        if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)   // UTF-8 BOM
+        {
+            p += 3;
+        }
+        QByteArray inlineBlockEndTag;
+        while (p < end)
+        {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+            const char *lineEnd = eol ? eol : end;
+            const char *next = eol ? eol + 1 : end;
+            if (lineEnd > p && *(lineEnd - 1) == '\r')
+            {
+                lineEnd--;
+            }
+
+            if (inlineBlockEndTag.isEmpty())
+            {
+                const QByteArray tag = ParseOvpnConfigLine::inlineDataBlockTag(p, lineEnd);
+                if (!tag.isEmpty())
+                {
+                    inlineBlockEndTag = "</" + tag + ">";
+                }
+            }
+            if (!inlineBlockEndTag.isEmpty())
+            {
+                if (QByteArray::fromRawData(p, lineEnd - p).contains(inlineBlockEndTag))
+                {
+                    inlineBlockEndTag.clear();
+                }
+                ovpnData.append(p, lineEnd - p).append('\n');
+                p = next;
+                continue;
+            }
+
+            if (!ParseOvpnConfigLine::isDirectiveLine(p, lineEnd))
+            {
+                ovpnData.append(p, lineEnd - p).append('\n');
+                p = next;
+                continue;
+            }
+
+            const QString line = codec->toUnicode(p, lineEnd - p);
+            p = next;
             ParseOvpnConfigLine::OpenVpnLine openVpnLine = ParseOvpnConfigLine::processLine(line);
             if (openVpnLine.type == ParseOvpnConfigLine::OVPN_CMD_REMOTE_IP) // remote ip
             {
@@ -153,7 +228,7 @@ void OvpnCustomConfig::process()
                 if (openVpnLine.verb < 3)
                     openVpnLine.verb = 3;
 
-                ovpnData_ += "verb " + QString::number(openVpnLine.verb) + "\n";
+                ovpnData += "verb " + QByteArray::number(openVpnLine.verb) + "\n";
                 bFoundVerbCommand = true;
             }
             else if (openVpnLine.type == ParseOvpnConfigLine::OVPN_CMD_SCRIPT_SECURITY) // script-security cmd
@@ -165,13 +240,13 @@ void OvpnCustomConfig::process()
                 if (openVpnLine.verb < 2)
                     openVpnLine.verb = 2;
 #endif
-                ovpnData_ += "script-security " + QString::number(openVpnLine.verb) + "\n";
+                ovpnData += "script-security " + QByteArray::number(openVpnLine.verb) + "\n";
                 bFoundScriptSecurityCommand = true;
             }
             else if (openVpnLine.type == ParseOvpnConfigLine::OVPN_CMD_CIPHER) // cipher cmd
             {
                 qDebug(LOG_CUSTOM_OVPN) << "Extracted cipher:" << openVpnLine.protocol;
-                ovpnData_ += line + "\n";
+                ovpnData += codec->fromUnicode(line) + "\n";
                 if (!openVpnLine.protocol.trimmed().isEmpty())
                     bHasValidCipher = true;
             }
@@ -199,7 +274,7 @@ void OvpnCustomConfig::process()
                         isTapDevice = true;
                 }
 
-                ovpnData_ += line + "\n";
+                ovpnData += codec->fromUnicode(line) + "\n";
             }
         }
 
@@ -213,19 +288,21 @@ void OvpnCustomConfig::process()
         }
 
         if (!bFoundVerbCommand)
-            ovpnData_ += "verb 3\n";
+            ovpnData += "verb 3\n";
 #ifdef Q_OS_MAC
         // Needed script-security at least 2 on Mac, to allow an "up" command for the DNS setup
         // script.
         if (!bFoundScriptSecurityCommand)
-            ovpnData_ += "script-security 2\n";
+            ovpnData += "script-security 2\n";
 #endif
 
         // The "BF-CBC" cipher was the default prior to OpenVPN 2.5.
         // To support old configs that used to work in older Windscribe distributions, add a default
         // cipher command when there is no such command in the config.
         if (!bHasValidCipher)
-            ovpnData_ += "cipher BF-CBC\n";
+            ovpnData += "cipher BF-CBC\n";
+
+        ovpnData_ = codec->toUnicode(ovpnData);
 
 #ifdef Q_OS_MAC
         if (isTapDevice)
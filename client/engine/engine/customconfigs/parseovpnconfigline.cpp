@@ -1,5 +1,41 @@
 #include "parseovpnconfigline.h"
 
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// the first words of the lines processLine() recognizes
+const char *DIRECTIVES[] = { "remote", "proto", "port", "verb", "dev", "cipher", "script-security", "pull-filter" };
+
+// the blocks of certificates and keys, unlike <connection> which holds directives
+const char *INLINE_DATA_BLOCKS[] = { "ca", "cert", "extra-certs", "key", "dh", "pkcs12", "secret", "tls-auth", "tls-crypt",
+                                     "tls-crypt-v2", "crl-verify", "auth-user-pass", "http-proxy-user-pass" };
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+const char *skipSpaces(const char *begin, const char *end)
+{
+    while (begin < end && isSpace(*begin))
+    {
+        begin++;
+    }
+    return begin;
+}
+
+bool containsCaseInsensitive(const char *begin, const char *end, const char *word)
+{
+    const char *wordEnd = word + qstrlen(word);
+    return std::search(begin, end, word, wordEnd, [](char c1, char c2) {
+        return std::tolower(static_cast<unsigned char>(c1)) == c2;
+    }) != end;
+}
+
+} // namespace
+
 ParseOvpnConfigLine::OpenVpnLine ParseOvpnConfigLine::processLine(const QString &line)
 {
     OpenVpnLine openVpnLine;
@@ -124,6 +160,55 @@ ParseOvpnConfigLine::OpenVpnLine ParseOvpnConfigLine::processLine(const QString
     return openVpnLine;
 }
 
+bool ParseOvpnConfigLine::isDirectiveLine(const char *begin, const char *end)
+{
+    // processLine() matches these anywhere in the line
+    if (containsCaseInsensitive(begin, end, "route-nopull") || containsCaseInsensitive(begin, end, "route-noexec"))
+    {
+        return true;
+    }
+
+    const char *word = skipSpaces(begin, end);
+    const char *wordEnd = word;
+    while (wordEnd < end && !isSpace(*wordEnd))
+    {
+        wordEnd++;
+    }
+    const uint len = wordEnd - word;
+    for (const char *directive : DIRECTIVES)
+    {
+        if (qstrlen(directive) == len && qstrnicmp(word, directive, len) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray ParseOvpnConfigLine::inlineDataBlockTag(const char *begin, const char *end)
+{
+    const char *tag = skipSpaces(begin, end);
+    if (tag == end || *tag != '<')
+    {
+        return QByteArray();
+    }
+    tag++;
+    const char *tagEnd = std::find(tag, end, '>');
+    if (tagEnd == end)
+    {
+        return QByteArray();
+    }
+    const uint len = tagEnd - tag;
+    for (const char *block : INLINE_DATA_BLOCKS)
+    {
+        if (qstrlen(block) == len && qstrncmp(tag, block, len) == 0)
+        {
+            return QByteArray(tag, len);
+        }
+    }
+    return QByteArray();
+}
+
 QStringList ParseOvpnConfigLine::splitLine(const QString &line)
 {
     QStringList res;
@@ -34,6 +34,12 @@ public:
 
     static OpenVpnLine processLine(const QString &line);
 
+    // byte level checks of an undecoded line (without the end of line)
+    // false if processLine() would return OVPN_CMD_UNKNOWN for the line, so it needs no decoding
+    static bool isDirectiveLine(const char *begin, const char *end);
+    // the tag if the line opens an inline data block (<ca>, <cert>, <key>, ...), it has no directives inside
+    static QByteArray inlineDataBlockTag(const char *begin, const char *end);
+
 private:
     static QStringList splitLine(const QString &line);
 };
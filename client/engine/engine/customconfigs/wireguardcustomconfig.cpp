@@ -1,11 +1,15 @@
 #include "wireguardcustomconfig.h"
 #include "utils/logger.h"
+#include "engine/wireguardconfig/allowedips.h"
 
 #include <QFileInfo>
 #include <QSettings>
 
 namespace customconfigs {
 
+QMutex WireguardCustomConfig::cacheMutex_;
+QCache<QByteArray, WireguardCustomConfig> WireguardCustomConfig::cache_(64);
+
 CUSTOM_CONFIG_TYPE WireguardCustomConfig::type() const
 {
     return CUSTOM_CONFIG_WIREGUARD;
@@ -57,14 +61,33 @@ QSharedPointer<WireGuardConfig> WireguardCustomConfig::getWireGuardConfig(const
 }
 
 // static
-ICustomConfig *WireguardCustomConfig::makeFromFile(const QString &filepath)
+ICustomConfig *WireguardCustomConfig::makeFromFile(const QString &filepath, const QByteArray &contentHash)
 {
-    WireguardCustomConfig *config = new WireguardCustomConfig();
+    WireguardCustomConfig *config = nullptr;
+    if (!contentHash.isEmpty())
+    {
+        QMutexLocker locker(&cacheMutex_);
+        if (const WireguardCustomConfig *cached = cache_.object(contentHash))
+        {
+            config = new WireguardCustomConfig(*cached);
+        }
+    }
+    if (!config)
+    {
+        config = new WireguardCustomConfig();
+        config->loadFromFile(filepath);  // here the config can change to incorrect
+        config->validate();
+        if (!contentHash.isEmpty())
+        {
+            QMutexLocker locker(&cacheMutex_);
+            cache_.insert(contentHash, new WireguardCustomConfig(*config));
+        }
+    }
+
+    // the names are of the file, not of the content
     QFileInfo fi(filepath);
     config->name_ = fi.completeBaseName();
     config->filename_ = fi.fileName();
-    config->loadFromFile(filepath);  // here the config can change to incorrect
-    config->validate();
     return config;
 }
 
@@ -106,6 +129,10 @@ void WireguardCustomConfig::loadFromFile(const QString &filepath)
     presharedKey_ = file.value("PresharedKey").toString();
     allowedIps_ =
         WireGuardConfig::stripIpv6Address(file.value("AllowedIPs", "0.0.0.0/0").toStringList());
+    // the split route lists are merged to fewer routes, the ones the parser doesn't understand go as they are
+    AllowedIps allowedIps;
+    if (allowedIps.parse(allowedIps_))
+        allowedIps_ = allowedIps.toString();
     if (!allowedIps_.contains("/0"))
         isAllowFirewallAfterConnection_ = false;
     QStringList endpointParts = file.value("Endpoint").toString().split(":");
@@ -3,6 +3,8 @@
 
 #include "icustomconfig.h"
 #include "engine/wireguardconfig/wireguardconfig.h"
+#include <QCache>
+#include <QMutex>
 #include <QSharedPointer>
 
 namespace customconfigs {
@@ -24,12 +26,16 @@ public:
     QSharedPointer<WireGuardConfig> getWireGuardConfig(const QString &endpointIp) const;
     uint getEndpointPort() const { return endpointPortNumber_; }
 
-    static ICustomConfig *makeFromFile(const QString &filepath);
+    // contentHash is the hash of the file, the configs with the same content are parsed once (empty to not use the cache)
+    static ICustomConfig *makeFromFile(const QString &filepath, const QByteArray &contentHash = QByteArray());
 
 private:
     void loadFromFile(const QString &filepath);
     void validate();
 
+    static QMutex cacheMutex_;      // the files are parsed on the pool threads
+    static QCache<QByteArray, WireguardCustomConfig> cache_;   // content hash -> the parsed and validated config
+
     QString errMessage_;
     QString name_;
     QString nick_;
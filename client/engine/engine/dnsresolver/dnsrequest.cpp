@@ -1,9 +1,17 @@
 #include "dnsrequest.h"
 #include "dnsresolver.h"
+#include "dnsserversconfiguration.h"
+#include "dohresolver.h"
+#include "utils/ipvalidation.h"
 #include "utils/logger.h"
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+#include "engine/tests/networkrecorder.h"
+#include <QDateTime>
+#include <QTimer>
+#endif
 
 DnsRequest::DnsRequest(QObject *parent, const QString &hostname, const QStringList &dnsServers, int timeoutMs /*= 5000*/)
-    : QObject(parent), hostname_(hostname), dnsServers_(dnsServers), timeoutMs_(timeoutMs), aresErrorCode_(ARES_SUCCESS)
+    : QObject(parent), hostname_(hostname), dnsServers_(dnsServers), timeoutMs_(timeoutMs), aresErrorCode_(ARES_SUCCESS), ttl_(0), isDoh_(false), startTime_(0)
 {
 
 }
@@ -27,6 +35,16 @@ bool DnsRequest::isError() const
     return aresErrorCode_ != ARES_SUCCESS || ips_.isEmpty();
 }
 
+bool DnsRequest::isNegativeAnswer() const
+{
+    return aresErrorCode_ == ARES_ENOTFOUND || aresErrorCode_ == ARES_ENODATA || aresErrorCode_ == ARES_ESERVFAIL;
+}
+
+int DnsRequest::ttl() const
+{
+    return ttl_;
+}
+
 QString DnsRequest::errorString()
 {
     return QString::fromStdString(ares_strerror(aresErrorCode_));
@@ -34,10 +52,38 @@ QString DnsRequest::errorString()
 
 void DnsRequest::lookup()
 {
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+   startTime_ = QDateTime::currentMSecsSinceEpoch();
+   if (NetworkRecorder::instance().isReplaying())
+   {
+       NetworkRecorder::DnsAnswer answer;
+       if (!NetworkRecorder::instance().replayDns(hostname_, answer))
+       {
+           answer.aresErrorCode = ARES_ENOTFOUND;
+       }
+       else if (answer.isLost)
+       {
+           answer.ips.clear();
+           answer.aresErrorCode = ARES_ETIMEOUT;
+       }
+       QTimer::singleShot(answer.timeMs, this, [this, answer]() { onResolved(answer.ips, answer.aresErrorCode, answer.ttl); });
+       return;
+   }
+#endif
+
    QSharedPointer<DnsRequestPrivate> obj = QSharedPointer<DnsRequestPrivate>(new DnsRequestPrivate, &QObject::deleteLater);
    obj->moveToThread(this->thread());
-   connect(obj.get(), SIGNAL(resolved(QStringList, int)), SLOT(onResolved(QStringList, int)));
-   DnsResolver::instance().lookup(hostname_, obj.staticCast<QObject>(), dnsServers_, timeoutMs_);
+   connect(obj.get(), SIGNAL(resolved(QStringList, int, int)), SLOT(onResolved(QStringList, int, int)));
+
+   // DNS-over-HTTPS only for the lookups with the servers of the DNS policy, the fallback is the plain DNS to these servers
+   const QString dohUrl = DnsServersConfiguration::instance().getDnsOverHttpsUrl();
+   isDoh_ = !dohUrl.isEmpty() && dnsServers_ == DnsServersConfiguration::instance().getCurrentDnsServers()
+            && !IpValidation::instance().isIp(hostname_)
+            && DohResolver::lookup(dohUrl, hostname_, obj.staticCast<QObject>(), timeoutMs_);
+   if (!isDoh_)
+   {
+       DnsResolver::instance().lookup(hostname_, obj.staticCast<QObject>(), dnsServers_, timeoutMs_);
+   }
 }
 
 void DnsRequest::lookupBlocked()
@@ -45,15 +91,125 @@ void DnsRequest::lookupBlocked()
     ips_ = DnsResolver::instance().lookupBlocked(hostname_, dnsServers_, timeoutMs_, &aresErrorCode_);
 }
 
-void DnsRequest::onResolved(const QStringList &ips, int aresErrorCode)
+void DnsRequest::onResolved(const QStringList &ips, int aresErrorCode, int ttl)
 {
+    if (isDoh_ && aresErrorCode == ARES_ECONNREFUSED)
+    {
+        qCDebug(LOG_DNS_RESOLVER) << "DNS-over-HTTPS failed for" << hostname_ << ", fallback to the plain DNS";
+        isDoh_ = false;
+        QSharedPointer<DnsRequestPrivate> obj = QSharedPointer<DnsRequestPrivate>(new DnsRequestPrivate, &QObject::deleteLater);
+        obj->moveToThread(this->thread());
+        connect(obj.get(), SIGNAL(resolved(QStringList, int, int)), SLOT(onResolved(QStringList, int, int)));
+        DnsResolver::instance().lookup(hostname_, obj.staticCast<QObject>(), dnsServers_, timeoutMs_);
+        return;
+    }
     aresErrorCode_ = aresErrorCode;
+    ttl_ = ttl;
     qCDebug(LOG_DNS_RESOLVER) << "Resolved " << hostname_ << ": " << ips << aresErrorCode;
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    if (NetworkRecorder::instance().isRecording())
+    {
+        NetworkRecorder::DnsAnswer answer;
+        answer.ips = ips;
+        answer.aresErrorCode = aresErrorCode;
+        answer.ttl = ttl;
+        answer.timeMs = static_cast<int>(QDateTime::currentMSecsSinceEpoch() - startTime_);
+        NetworkRecorder::instance().recordDns(hostname_, answer);
+    }
+#endif
     ips_ = ips;
     emit finished();
 }
 
-void DnsRequestPrivate::onResolved(const QStringList &ips, int aresErrorCode)
+void DnsRequestPrivate::onResolved(const QStringList &ips, int aresErrorCode, int ttl)
+{
+    emit resolved(ips, aresErrorCode, ttl);
+}
+
+void DnsBatchRequestPrivate::onResolved(const QString &hostname, const QStringList &ips, int aresErrorCode, int ttl)
+{
+    emit resolved(hostname, ips, aresErrorCode, ttl);
+}
+
+DnsBatchRequest::DnsBatchRequest(QObject *parent, const QStringList &hostnames, const QStringList &dnsServers, int timeoutMs /*= 5000*/)
+    : QObject(parent), dnsServers_(dnsServers), timeoutMs_(timeoutMs), unresolvedCount_(0)
+{
+    for (const QString &hostname : hostnames)
+    {
+        if (!hostnames_.contains(hostname))
+        {
+            hostnames_ << hostname;
+        }
+    }
+}
+
+DnsBatchRequest::~DnsBatchRequest()
+{
+}
+
+QStringList DnsBatchRequest::hostnames() const
+{
+    return hostnames_;
+}
+
+QStringList DnsBatchRequest::ips(const QString &hostname) const
+{
+    return results_.value(hostname).ips;
+}
+
+bool DnsBatchRequest::isError(const QString &hostname) const
+{
+    auto it = results_.constFind(hostname);
+    return it == results_.constEnd() || !it->isResolved || it->aresErrorCode != ARES_SUCCESS || it->ips.isEmpty();
+}
+
+int DnsBatchRequest::ttl(const QString &hostname) const
 {
-    emit resolved(ips, aresErrorCode);
+    return results_.value(hostname).ttl;
+}
+
+void DnsBatchRequest::lookup()
+{
+    results_.clear();
+    for (const QString &hostname : qAsConst(hostnames_))
+    {
+        RESULT result;
+        result.aresErrorCode = ARES_SUCCESS;
+        result.ttl = 0;
+        result.isResolved = false;
+        results_[hostname] = result;
+    }
+    unresolvedCount_ = hostnames_.count();
+
+    if (hostnames_.isEmpty())
+    {
+        QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+        return;
+    }
+
+    QSharedPointer<DnsBatchRequestPrivate> obj = QSharedPointer<DnsBatchRequestPrivate>(new DnsBatchRequestPrivate, &QObject::deleteLater);
+    obj->moveToThread(this->thread());
+    connect(obj.get(), SIGNAL(resolved(QString, QStringList, int, int)), SLOT(onResolved(QString, QStringList, int, int)));
+    DnsResolver::instance().lookup(hostnames_, obj.staticCast<QObject>(), dnsServers_, timeoutMs_);
+}
+
+void DnsBatchRequest::onResolved(const QString &hostname, const QStringList &ips, int aresErrorCode, int ttl)
+{
+    auto it = results_.find(hostname);
+    if (it == results_.end() || it->isResolved)
+    {
+        return;
+    }
+    it->ips = ips;
+    it->aresErrorCode = aresErrorCode;
+    it->ttl = ttl;
+    it->isResolved = true;
+    unresolvedCount_--;
+
+    qCDebug(LOG_DNS_RESOLVER) << "Resolved " << hostname << ": " << ips << aresErrorCode;
+    emit hostResolved(hostname, ips, isError(hostname));
+    if (unresolvedCount_ == 0)
+    {
+        emit finished();
+    }
 }
@@ -1,8 +1,10 @@
 #ifndef DNSREQUEST_H
 #define DNSREQUEST_H
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QStringList>
 
 // Required for managing the lifetime of an object in shared pointer
 class DnsRequestPrivate : public QObject
@@ -10,10 +12,10 @@ class DnsRequestPrivate : public QObject
     Q_OBJECT
 
 signals:
-    void resolved(const QStringList &ips, int aresErrorCode);
+    void resolved(const QStringList &ips, int aresErrorCode, int ttl);
 
 private slots:
-    void onResolved(const QStringList &ips, int aresErrorCode);
+    void onResolved(const QStringList &ips, int aresErrorCode, int ttl);
 };
 
 class DnsRequest : public QObject
@@ -26,6 +28,10 @@ public:
     QStringList ips() const;
     QString hostname() const;
     bool isError() const;
+    // true if the server answered that the name does not exist or failed (NXDOMAIN, NODATA, SERVFAIL)
+    bool isNegativeAnswer() const;
+    // TTL of the answer in seconds, 0 if unknown (for example, for IP addresses, hosts file entries and blocked lookups)
+    int ttl() const;
     QString errorString();
     void lookup();
     void lookupBlocked();
@@ -34,7 +40,7 @@ signals:
     void finished();
 
 private slots:
-    void onResolved(const QStringList &ips, int aresErrorCode);
+    void onResolved(const QStringList &ips, int aresErrorCode, int ttl);
 
 private:
     QString hostname_;
@@ -42,6 +48,58 @@ private:
     QStringList dnsServers_;
     int timeoutMs_;
     int aresErrorCode_;
+    int ttl_;
+    bool isDoh_;
+    qint64 startTime_;      // for NetworkRecorder
+};
+
+class DnsBatchRequestPrivate : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void resolved(const QString &hostname, const QStringList &ips, int aresErrorCode, int ttl);
+
+private slots:
+    void onResolved(const QString &hostname, const QStringList &ips, int aresErrorCode, int ttl);
+};
+
+// resolves several hostnames at once with the same DNS servers and timeout (and so the same c-ares channel),
+// hostResolved() is emitted for every hostname as soon as it's resolved and finished() after the last one
+class DnsBatchRequest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DnsBatchRequest(QObject *parent, const QStringList &hostnames, const QStringList &dnsServers, int timeoutMs = 5000);
+    virtual ~DnsBatchRequest();
+
+    QStringList hostnames() const;
+    QStringList ips(const QString &hostname) const;
+    bool isError(const QString &hostname) const;
+    int ttl(const QString &hostname) const;
+    void lookup();
+
+signals:
+    void hostResolved(const QString &hostname, const QStringList &ips, bool isError);
+    void finished();
+
+private slots:
+    void onResolved(const QString &hostname, const QStringList &ips, int aresErrorCode, int ttl);
+
+private:
+    struct RESULT
+    {
+        QStringList ips;
+        int aresErrorCode;
+        int ttl;
+        bool isResolved;
+    };
+
+    QStringList hostnames_;
+    QStringList dnsServers_;
+    int timeoutMs_;
+    QHash<QString, RESULT> results_;
+    int unresolvedCount_;
 };
 
 #endif // DNSREQUEST_H
@@ -8,12 +8,33 @@
     #include <arpa/inet.h>
     #include <netdb.h>
     #include <sys/select.h>
+    #include <poll.h>
 #endif
 
+namespace {
+
+#ifdef Q_OS_WIN
+typedef WSAPOLLFD PollFd;
+
+int pollSockets(PollFd *fds, int count, int timeoutMs)
+{
+    return WSAPoll(fds, count, timeoutMs);
+}
+#else
+typedef pollfd PollFd;
+
+int pollSockets(PollFd *fds, int count, int timeoutMs)
+{
+    return poll(fds, count, timeoutMs);
+}
+#endif
+
+} // namespace
+
 DnsResolver *DnsResolver::this_ = NULL;
 
 DnsResolver::DnsResolver(QObject *parent) : QThread(parent), bStopCalled_(false),
-    bNeedFinish_(false)
+    bNeedFinish_(false), bNeedFlushChannels_(false)
 {
     Q_ASSERT(this_ == NULL);
     this_ = this;
@@ -43,10 +64,34 @@ void DnsResolver::lookup(const QString &hostname, QSharedPointer<QObject> object
     ri.object = object;
     ri.dnsServers = dnsServers;
     ri.timeoutMs = timeoutMs;
+    ri.bWithHostname = false;
     queue_.enqueue(ri);
     waitCondition_.wakeAll();
 }
 
+void DnsResolver::lookup(const QStringList &hostnames, QSharedPointer<QObject> object, const QStringList &dnsServers, int timeoutMs)
+{
+    QMutexLocker locker(&mutex_);
+    for (const QString &hostname : hostnames)
+    {
+        REQUEST_INFO ri;
+        ri.hostname = hostname;
+        ri.object = object;
+        ri.dnsServers = dnsServers;
+        ri.timeoutMs = timeoutMs;
+        ri.bWithHostname = true;
+        queue_.enqueue(ri);
+    }
+    waitCondition_.wakeAll();
+}
+
+void DnsResolver::flushChannels()
+{
+    QMutexLocker locker(&mutex_);
+    bNeedFlushChannels_ = true;
+    waitCondition_.wakeAll();
+}
+
 QStringList DnsResolver::lookupBlocked(const QString &hostname, const QStringList &dnsServers, int timeoutMs, int *outErrorCode)
 {
     struct ares_options options;
@@ -94,56 +139,56 @@ void DnsResolver::run()
 {
     BIND_CRASH_HANDLER_FOR_THREAD();
 
-    QVector<CHANNEL_INFO> channels;
+    QHash<QString, CHANNEL_INFO *> channels;
 
     while (true)
     {
+        QQueue<REQUEST_INFO> requests;
+        bool bNeedFlushChannels;
         mutex_.lock();
-        REQUEST_INFO ri;
-        bool bExistRequest = false;
-        if (!queue_.isEmpty())
-        {
-            ri = queue_.dequeue();
-            bExistRequest = true;
-        }
+        requests.swap(queue_);
+        bNeedFlushChannels = bNeedFlushChannels_;
+        bNeedFlushChannels_ = false;
         mutex_.unlock();
 
-        if (bExistRequest)
+        if (bNeedFlushChannels)
         {
-            CHANNEL_INFO channelInfo;
-            if (initChannel(ri, channelInfo))
-            {
-                channels << channelInfo;
-            }
-            else
-            {
-                bool bSuccess = QMetaObject::invokeMethod(ri.object.get(), "onResolved",
-                                          Qt::QueuedConnection, Q_ARG(QStringList, QStringList()), Q_ARG(int, ARES_ENOTINITIALIZED));
-                Q_ASSERT(bSuccess);
-            }
+            moveChannelsOutOfPool(channels);
         }
 
-        bool bExistJob = false;
-        QVector<CHANNEL_INFO>::iterator it = channels.begin();
-        while (it != channels.end())
+        while (!requests.isEmpty())
         {
-            if (processChannel(it->channel))
+            REQUEST_INFO ri = requests.dequeue();
+            CHANNEL_INFO *channelInfo = getChannel(channels, ri);
+            if (channelInfo)
             {
-                bExistJob = true;
-                ++it;
+                submitRequest(channelInfo, ri);
             }
             else
             {
-                ares_destroy(it->channel);
-                it = channels.erase(it);
+                WAITER waiter;
+                waiter.object = ri.object;
+                waiter.bWithHostname = ri.bWithHostname;
+                notifyWaiter(waiter, ri.hostname, QStringList(), ARES_ENOTINITIALIZED, 0);
             }
         }
 
+        bool bExistJob = processChannels(channels);
+        removeExpiredChannels(channels);
+
         {
             QMutexLocker locker(&mutex_);
-            while (!bExistJob && queue_.isEmpty() && !bNeedFinish_)
+            if (!bExistJob && queue_.isEmpty() && !bNeedFinish_ && !bNeedFlushChannels_)
             {
-                waitCondition_.wait(&mutex_);
+                // wake up to destroy the idle channels if there are any
+                if (channels.isEmpty())
+                {
+                    waitCondition_.wait(&mutex_);
+                }
+                else
+                {
+                    waitCondition_.wait(&mutex_, CHANNEL_IDLE_TIMEOUT);
+                }
             }
             if (bNeedFinish_)
             {
@@ -157,12 +202,11 @@ void DnsResolver::run()
         QMutexLocker locker(&mutex_);
         queue_.clear();
     }
-    QVector<CHANNEL_INFO>::iterator it = channels.begin();
-    while (it != channels.end())
+    for (CHANNEL_INFO *channelInfo : qAsConst(channels))
     {
-        ares_destroy(it->channel);
-        it = channels.erase(it);
+        destroyChannel(channelInfo);
     }
+    channels.clear();
 }
 
 
@@ -222,36 +266,64 @@ void DnsResolver::createOptionsForAresChannel(const QStringList &dnsIps, int tim
     }
 }
 
-void DnsResolver::callback(void *arg, int status, int timeouts, hostent *host)
+void DnsResolver::callback(void *arg, int status, int timeouts, ares_addrinfo *res)
 {
     Q_UNUSED(timeouts);
     USER_ARG *userArg = static_cast<USER_ARG *>(arg);
-    if (status != ARES_SUCCESS)
-    {
-        //qCDebug(LOG_BASIC) << "DnsResolver::callback, request failed:" << status << timeouts;
-        bool bSuccess = QMetaObject::invokeMethod(userArg->object.get(), "onResolved",
-                                  Qt::QueuedConnection, Q_ARG(QStringList, QStringList()), Q_ARG(int, status));
-        Q_ASSERT(bSuccess);
-        delete userArg;
-        return;
-    }
+    userArg->channelInfo->pendingQueries--;
+    const QVector<WAITER> waiters = userArg->channelInfo->waiters.take(userArg->hostname);
 
     QStringList addresses;
-    for (char **p = host->h_addr_list; *p; p++)
+    int ttl = 0;
+    if (status == ARES_SUCCESS)
     {
-        char addr_buf[46] = "??";
-
-        ares_inet_ntop(host->h_addrtype, *p, addr_buf, sizeof(addr_buf));
-        addresses << QString::fromStdString(addr_buf);
+        // the TTL of the answer is the minimal TTL of its records
+        for (ares_addrinfo_node *node = res->nodes; node != NULL; node = node->ai_next)
+        {
+            if (node->ai_family != AF_INET)
+            {
+                continue;
+            }
+            char addr_buf[46] = "??";
+            ares_inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in *>(node->ai_addr)->sin_addr, addr_buf, sizeof(addr_buf));
+            QString address = QString::fromStdString(addr_buf);
+            if (!addresses.contains(address))
+            {
+                addresses << address;
+            }
+            if (node->ai_ttl > 0 && (ttl == 0 || node->ai_ttl < ttl))
+            {
+                ttl = node->ai_ttl;
+            }
+        }
+        ares_freeaddrinfo(res);
     }
 
-    bool bSuccess = QMetaObject::invokeMethod(userArg->object.get(), "onResolved",
-                              Qt::QueuedConnection, Q_ARG(QStringList, addresses), Q_ARG(int, status));
-    Q_ASSERT(bSuccess);
+    for (const WAITER &waiter : waiters)
+    {
+        notifyWaiter(waiter, userArg->hostname, addresses, status, ttl);
+    }
 
     delete userArg;
 }
 
+void DnsResolver::notifyWaiter(const WAITER &waiter, const QString &hostname, const QStringList &ips, int status, int ttl)
+{
+    bool bSuccess;
+    if (waiter.bWithHostname)
+    {
+        bSuccess = QMetaObject::invokeMethod(waiter.object.get(), "onResolved", Qt::QueuedConnection,
+                                             Q_ARG(QString, hostname), Q_ARG(QStringList, ips), Q_ARG(int, status), Q_ARG(int, ttl));
+    }
+    else
+    {
+        bSuccess = QMetaObject::invokeMethod(waiter.object.get(), "onResolved", Qt::QueuedConnection,
+                                             Q_ARG(QStringList, ips), Q_ARG(int, status), Q_ARG(int, ttl));
+    }
+    Q_ASSERT(bSuccess);
+    Q_UNUSED(bSuccess);
+}
+
 void DnsResolver::callbackForBlocked(void *arg, int status, int timeouts, hostent *host)
 {
     Q_UNUSED(timeouts);
@@ -277,51 +349,200 @@ void DnsResolver::callbackForBlocked(void *arg, int status, int timeouts, hosten
     userArg->errorCode = status;
 }
 
-bool DnsResolver::processChannel(ares_channel channel)
+DnsResolver::CHANNEL_INFO *DnsResolver::getChannel(QHash<QString, CHANNEL_INFO *> &channels, const REQUEST_INFO &ri)
 {
-    fd_set read_fds, write_fds;
-    int res;
-    int nfds;
-    struct timeval tvp;
-    tvp.tv_sec = 0;
-    tvp.tv_usec = 10000; // 10 ms max waiting time
-
-    FD_ZERO(&read_fds);
-    FD_ZERO(&write_fds);
-    nfds = ares_fds(channel, &read_fds, &write_fds);
-    if (nfds == 0)
-    {
-        return false;
-    }
+    const QStringList dnsIps = getDnsIps(ri.dnsServers);
+    const QString key = dnsIps.join(",") + "/" + QString::number(ri.timeoutMs);
 
-    res = select(nfds, &read_fds, &write_fds, NULL, &tvp);
-    if (res == -1)
+    auto it = channels.find(key);
+    if (it != channels.end())
     {
-        return false;
+        return it.value();
     }
-    ares_process(channel, &read_fds, &write_fds);
-    return true;
-}
 
-bool DnsResolver::initChannel(const REQUEST_INFO &ri, CHANNEL_INFO &outChannelInfo)
-{
     struct ares_options options;
     int optmask = 0;
 
-    createOptionsForAresChannel(getDnsIps(ri.dnsServers), ri.timeoutMs, options, optmask, &outChannelInfo);
-    int status = ares_init_options(&outChannelInfo.channel, &options, optmask);
+    QScopedPointer<CHANNEL_INFO> channelInfo(new CHANNEL_INFO());
+    createOptionsForAresChannel(dnsIps, ri.timeoutMs, options, optmask, channelInfo.data());
+    // keep the sockets open between the queries of the pooled channel
+    optmask |= ARES_OPT_FLAGS;
+    options.flags |= ARES_FLAG_STAYOPEN;
+
+    int status = ares_init_options(&channelInfo->channel, &options, optmask);
     if (status != ARES_SUCCESS)
     {
         qCDebug(LOG_BASIC) << "ares_init_options failed:" << QString::fromStdString(ares_strerror(status));
-        return false;
+        return nullptr;
     }
-    else
+
+    channelInfo->pendingQueries = 0;
+    channelInfo->isFlushed = false;
+    channelInfo->created.start();
+    channelInfo->lastUsed.start();
+    CHANNEL_INFO *result = channelInfo.take();
+    channels.insert(key, result);
+    return result;
+}
+
+void DnsResolver::submitRequest(CHANNEL_INFO *channelInfo, const REQUEST_INFO &ri)
+{
+    WAITER waiter;
+    waiter.object = ri.object;
+    waiter.bWithHostname = ri.bWithHostname;
+
+    channelInfo->lastUsed.start();
+
+    // the same name is already being resolved by this channel, wait for that answer
+    auto it = channelInfo->waiters.find(ri.hostname);
+    if (it != channelInfo->waiters.end())
+    {
+        it.value() << waiter;
+        return;
+    }
+    channelInfo->waiters[ri.hostname] << waiter;
+
+    USER_ARG *userArg = new USER_ARG();
+    userArg->hostname = ri.hostname;
+    userArg->channelInfo = channelInfo;
+
+    channelInfo->pendingQueries++;
+
+    // ares_getaddrinfo is used instead of ares_gethostbyname, because it also returns the TTL of the records
+    struct ares_addrinfo_hints hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_flags = ARES_AI_NOSORT;
+    ares_getaddrinfo(channelInfo->channel, ri.hostname.toStdString().c_str(), NULL, &hints, callback, userArg);
+}
+
+bool DnsResolver::processChannels(const QHash<QString, CHANNEL_INFO *> &channels)
+{
+    QVector<PollFd> fds;
+    QVector<ares_channel> fdChannels;
+    int timeoutMs = POLL_MAX_WAIT;
+    bool bExistJob = false;
+
+    for (CHANNEL_INFO *channelInfo : channels)
+    {
+        // the sockets of the idle channels stay open, but there is nothing to wait for on them
+        if (channelInfo->pendingQueries == 0)
+        {
+            continue;
+        }
+        bExistJob = true;
+
+        ares_socket_t socks[ARES_GETSOCK_MAXNUM];
+        int bitmask = ares_getsock(channelInfo->channel, socks, ARES_GETSOCK_MAXNUM);
+        for (int i = 0; i < ARES_GETSOCK_MAXNUM; ++i)
+        {
+            PollFd pfd;
+            pfd.fd = socks[i];
+            pfd.events = 0;
+            pfd.revents = 0;
+            if (ARES_GETSOCK_READABLE(bitmask, i))
+            {
+                pfd.events |= POLLIN;
+            }
+            if (ARES_GETSOCK_WRITABLE(bitmask, i))
+            {
+                pfd.events |= POLLOUT;
+            }
+            if (pfd.events != 0)
+            {
+                fds << pfd;
+                fdChannels << channelInfo->channel;
+            }
+        }
+
+        timeval maxtv;
+        maxtv.tv_sec = 0;
+        maxtv.tv_usec = POLL_MAX_WAIT * 1000;
+        timeval tv;
+        timeval *tvp = ares_timeout(channelInfo->channel, &maxtv, &tv);
+        timeoutMs = qMin(timeoutMs, static_cast<int>(tvp->tv_sec * 1000 + tvp->tv_usec / 1000));
+    }
+
+    if (!bExistJob)
     {
-        USER_ARG *userArg = new USER_ARG();
-        userArg->hostname = ri.hostname;
-        userArg->object = ri.object;
+        return false;
+    }
 
-        ares_gethostbyname(outChannelInfo.channel, ri.hostname.toStdString().c_str(), AF_INET, callback, userArg);
+    // the wait is short, so the new requests from the queue are picked up quickly
+    if (fds.isEmpty())
+    {
+        msleep(timeoutMs);
+    }
+    else if (pollSockets(fds.data(), fds.size(), timeoutMs) < 0)
+    {
+        // interrupted, the queries are still pending
         return true;
     }
+
+    for (int i = 0; i < fds.size(); ++i)
+    {
+        if (fds[i].revents != 0)
+        {
+            ares_socket_t readFd = (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) ? fds[i].fd : ARES_SOCKET_BAD;
+            ares_socket_t writeFd = (fds[i].revents & POLLOUT) ? fds[i].fd : ARES_SOCKET_BAD;
+            ares_process_fd(fdChannels[i], readFd, writeFd);
+        }
+    }
+
+    // the timeouts of the queries
+    for (CHANNEL_INFO *channelInfo : channels)
+    {
+        if (channelInfo->pendingQueries > 0)
+        {
+            ares_process_fd(channelInfo->channel, ARES_SOCKET_BAD, ARES_SOCKET_BAD);
+        }
+    }
+    return true;
+}
+
+void DnsResolver::removeExpiredChannels(QHash<QString, CHANNEL_INFO *> &channels)
+{
+    auto it = channels.begin();
+    while (it != channels.end())
+    {
+        CHANNEL_INFO *channelInfo = it.value();
+        if (channelInfo->pendingQueries == 0 &&
+            (channelInfo->isFlushed || channelInfo->lastUsed.elapsed() >= CHANNEL_IDLE_TIMEOUT ||
+             channelInfo->created.elapsed() >= CHANNEL_MAX_AGE))
+        {
+            destroyChannel(channelInfo);
+            it = channels.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void DnsResolver::moveChannelsOutOfPool(QHash<QString, CHANNEL_INFO *> &channels)
+{
+    // the channels with the pending queries stay processed under the keys which getChannel() never asks for
+    QHash<QString, CHANNEL_INFO *> flushed;
+    for (auto it = channels.begin(); it != channels.end(); ++it)
+    {
+        CHANNEL_INFO *channelInfo = it.value();
+        if (channelInfo->pendingQueries == 0)
+        {
+            destroyChannel(channelInfo);
+        }
+        else
+        {
+            channelInfo->isFlushed = true;
+            flushed.insert("#" + QString::number(reinterpret_cast<quintptr>(channelInfo)), channelInfo);
+        }
+    }
+    channels.swap(flushed);
+}
+
+void DnsResolver::destroyChannel(CHANNEL_INFO *channelInfo)
+{
+    // the callbacks of the pending queries are called with ARES_EDESTRUCTION from ares_destroy
+    ares_destroy(channelInfo->channel);
+    delete channelInfo;
 }
@@ -1,6 +1,8 @@
 #ifndef DNSRESOLVER_H
 #define DNSRESOLVER_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QQueue>
 #include <QThread>
 #include <QWaitCondition>
@@ -11,6 +13,9 @@
 #include "ares.h"
 
 // singleton for dns requests. Do not use it directly. Use DnsLookup instead
+// the channels are kept in a pool per set of DNS servers (and timeout) and reused by the next requests, with their sockets,
+// the sockets of all the channels are waited for in one poll()
+// the requests for a name which is already being resolved by the same channel wait for that query instead of sending a new one
 class DnsResolver : public QThread
 {
     Q_OBJECT
@@ -22,8 +27,14 @@ public:
         return s;
     }
 
+    // object gets onResolved(QStringList ips, int aresErrorCode, int ttl)
     void lookup(const QString &hostname, QSharedPointer<QObject> object, const QStringList &dnsServers, int timeoutMs);
+    // object gets onResolved(QString hostname, QStringList ips, int aresErrorCode, int ttl) for each of the hostnames
+    void lookup(const QStringList &hostnames, QSharedPointer<QObject> object, const QStringList &dnsServers, int timeoutMs);
     QStringList lookupBlocked(const QString &hostname, const QStringList &dnsServers, int timeoutMs, int *outErrorCode);
+    // the pooled channels aren't reused by the next requests (they are destroyed when their queries are done),
+    // called when the network or the connection changes, the OS default DNS servers of the channels are stale then
+    void flushChannels();
 
 private:
     explicit DnsResolver(QObject *parent = nullptr);
@@ -33,12 +44,6 @@ protected:
     virtual void run();
 
 private:
-    struct USER_ARG
-    {
-        QSharedPointer<QObject> object;
-        QString hostname;
-    };
-
     struct USER_ARG_FOR_BLOCKED
     {
         QStringList ips;
@@ -51,6 +56,13 @@ private:
         QStringList dnsServers;
         QSharedPointer<QObject> object;
         int timeoutMs;
+        bool bWithHostname;
+    };
+
+    struct WAITER
+    {
+        QSharedPointer<QObject> object;
+        bool bWithHostname;
     };
 
     struct CHANNEL_INFO
@@ -62,8 +74,23 @@ private:
 #else
         QVector<in_addr> dnsServers;
 #endif
+        int pendingQueries;
+        QHash<QString, QVector<WAITER> > waiters;     // by hostname, for the pending queries
+        QElapsedTimer created;
+        QElapsedTimer lastUsed;
+        bool isFlushed;     // not in the pool anymore, destroyed when idle
+    };
+
+    struct USER_ARG
+    {
+        QString hostname;
+        CHANNEL_INFO *channelInfo;
     };
 
+    // an idle channel is destroyed after CHANNEL_IDLE_TIMEOUT, any channel when it's idle and older than CHANNEL_MAX_AGE,
+    // so the channels with the OS default DNS servers catch up with the changes of the network
+    enum { CHANNEL_IDLE_TIMEOUT = 10000, CHANNEL_MAX_AGE = 60000, POLL_MAX_WAIT = 10 };
+
     AresLibraryInit aresLibraryInit_;
     bool bStopCalled_;
     QQueue<REQUEST_INFO> queue_;
@@ -71,16 +98,22 @@ private:
     QMutex mutex_;
     QWaitCondition waitCondition_;
     bool bNeedFinish_;
+    bool bNeedFlushChannels_;
 
     static DnsResolver *this_;
 
     QStringList getDnsIps(const QStringList &ips);
     void createOptionsForAresChannel(const QStringList &dnsIps, int timeoutMs, struct ares_options &options, int &optmask, CHANNEL_INFO *channelInfo);
-    static void callback(void *arg, int status, int timeouts, struct hostent *host);
+    static void callback(void *arg, int status, int timeouts, struct ares_addrinfo *res);
+    static void notifyWaiter(const WAITER &waiter, const QString &hostname, const QStringList &ips, int status, int ttl);
     static void callbackForBlocked(void *arg, int status, int timeouts, struct hostent *host);
+    CHANNEL_INFO *getChannel(QHash<QString, CHANNEL_INFO *> &channels, const REQUEST_INFO &ri);
+    void submitRequest(CHANNEL_INFO *channelInfo, const REQUEST_INFO &ri);
     // return false, if nothing to process more
-    bool processChannel(ares_channel channel);
-    bool initChannel(const REQUEST_INFO &ri, CHANNEL_INFO &outChannelInfo);
+    bool processChannels(const QHash<QString, CHANNEL_INFO *> &channels);
+    void removeExpiredChannels(QHash<QString, CHANNEL_INFO *> &channels);
+    void moveChannelsOutOfPool(QHash<QString, CHANNEL_INFO *> &channels);
+    void destroyChannel(CHANNEL_INFO *channelInfo);
 };
 
 #endif // DNSRESOLVER_H
@@ -7,7 +7,12 @@ void DnsServersConfiguration::setDnsServersPolicy(DNS_POLICY_TYPE policy)
 {
     QMutexLocker locker(&mutex_);
     ips = dnsPolicyTypeToStringList(policy);
-    if (ips.isEmpty())
+    dohUrl_ = (policy == DNS_TYPE_CLOUDFLARE_DOH) ? HardcodedSettings::instance().cloudflareDohUrl() : QString();
+    if (!dohUrl_.isEmpty())
+    {
+        qCDebug(LOG_BASIC) << "Changed DNS servers for DnsResolver to DNS-over-HTTPS:" << dohUrl_ << ", fallback:" << ips;
+    }
+    else if (ips.isEmpty())
     {
         qCDebug(LOG_BASIC) << "Changed DNS servers for DnsResolver to OS default";
     }
@@ -23,6 +28,12 @@ QStringList DnsServersConfiguration::getCurrentDnsServers() const
     return ips;
 }
 
+QString DnsServersConfiguration::getDnsOverHttpsUrl() const
+{
+    QMutexLocker locker(&mutex_);
+    return dohUrl_;
+}
+
 QStringList DnsServersConfiguration::dnsPolicyTypeToStringList(DNS_POLICY_TYPE dnsPolicyType)
 {
     if (dnsPolicyType == DNS_TYPE_OS_DEFAULT)
@@ -33,7 +44,7 @@ QStringList DnsServersConfiguration::dnsPolicyTypeToStringList(DNS_POLICY_TYPE d
     {
         return HardcodedSettings::instance().openDns();
     }
-    else if (dnsPolicyType == DNS_TYPE_CLOUDFLARE)
+    else if (dnsPolicyType == DNS_TYPE_CLOUDFLARE || dnsPolicyType == DNS_TYPE_CLOUDFLARE_DOH)
     {
         return QStringList() << HardcodedSettings::instance().cloudflareDns();
     }
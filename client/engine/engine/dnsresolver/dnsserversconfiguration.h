@@ -21,8 +21,13 @@ public:
 
     QStringList getCurrentDnsServers() const;
 
+    // if not empty, the names are resolved with DNS-over-HTTPS (DohResolver) at this URL,
+    // getCurrentDnsServers() are for the fallback to the plain DNS
+    QString getDnsOverHttpsUrl() const;
+
 private:
     QStringList ips;
+    QString dohUrl_;
     mutable QMutex mutex_;
 
     QStringList dnsPolicyTypeToStringList(DNS_POLICY_TYPE dnsPolicyType);
@@ -0,0 +1,145 @@
+#include "dohresolver.h"
+#include "ares.h"
+#include "engine/networkaccessmanager/networkaccessmanager.h"
+#include "utils/logger.h"
+
+#ifdef Q_OS_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+#endif
+
+namespace {
+const int MAX_ADDRESSES = 32;
+const int DNS_CLASS_IN = 1;
+const int DNS_TYPE_A = 1;
+}
+
+QMutex DohResolver::mutex_;
+DohResolver *DohResolver::this_ = nullptr;
+
+DohResolver::DohResolver(QObject *parent, NetworkAccessManager *networkAccessManager) : QObject(parent),
+    networkAccessManager_(networkAccessManager)
+{
+    QMutexLocker locker(&mutex_);
+    Q_ASSERT(this_ == nullptr);
+    this_ = this;
+}
+
+DohResolver::~DohResolver()
+{
+    QMutexLocker locker(&mutex_);
+    this_ = nullptr;
+}
+
+bool DohResolver::lookup(const QString &url, const QString &hostname, QSharedPointer<QObject> object, int timeoutMs)
+{
+    QMutexLocker locker(&mutex_);
+    if (this_ == nullptr)
+    {
+        return false;
+    }
+    DohResolver *resolver = this_;
+    QMetaObject::invokeMethod(resolver, [resolver, url, hostname, object, timeoutMs]() {
+        resolver->startLookup(url, hostname, object, timeoutMs);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void DohResolver::startLookup(const QString &url, const QString &hostname, QSharedPointer<QObject> object, int timeoutMs)
+{
+    const QString key = url + "/" + hostname;
+    auto it = waiters_.find(key);
+    if (it != waiters_.end())
+    {
+        it.value() << object;
+        return;
+    }
+
+    unsigned char *query = nullptr;
+    int queryLen = 0;
+    // the id is 0 as recommended for DoH, so the answers are cacheable by HTTP caches
+    int ret = ares_create_query(hostname.toUtf8().constData(), DNS_CLASS_IN, DNS_TYPE_A, 0, 1, &query, &queryLen, 0);
+    if (ret != ARES_SUCCESS)
+    {
+        QMetaObject::invokeMethod(object.get(), "onResolved", Qt::QueuedConnection,
+                                  Q_ARG(QStringList, QStringList()), Q_ARG(int, ret), Q_ARG(int, 0));
+        return;
+    }
+    QByteArray data(reinterpret_cast<const char *>(query), queryLen);
+    ares_free_string(query);
+
+    waiters_[key] << object;
+
+    NetworkRequest request(QUrl(url), timeoutMs, true);
+    request.setContentTypeHeader("Content-Type: application/dns-message");
+    NetworkReply *reply = networkAccessManager_->post(request, data);
+    reply->setProperty("key", key);
+    connect(reply, SIGNAL(finished()), SLOT(onReplyFinished()));
+}
+
+void DohResolver::onReplyFinished()
+{
+    NetworkReply *reply = qobject_cast<NetworkReply *>(sender());
+    const QString key = reply->property("key").toString();
+
+    QStringList ips;
+    int ttl = 0;
+    int errorCode = ARES_ECONNREFUSED;
+    if (reply->isSuccess())
+    {
+        parseAnswer(reply->readAll(), ips, ttl, errorCode);
+    }
+    else
+    {
+        qCDebug(LOG_DNS_RESOLVER) << "DNS-over-HTTPS request failed for" << key;
+    }
+    reply->deleteLater();
+
+    notifyWaiters(key, ips, errorCode, ttl);
+}
+
+void DohResolver::notifyWaiters(const QString &key, const QStringList &ips, int aresErrorCode, int ttl)
+{
+    const QVector<QSharedPointer<QObject> > objects = waiters_.take(key);
+    for (const QSharedPointer<QObject> &object : objects)
+    {
+        QMetaObject::invokeMethod(object.get(), "onResolved", Qt::QueuedConnection,
+                                  Q_ARG(QStringList, ips), Q_ARG(int, aresErrorCode), Q_ARG(int, ttl));
+    }
+}
+
+bool DohResolver::parseAnswer(const QByteArray &answer, QStringList &outIps, int &outTtl, int &outErrorCode)
+{
+    struct hostent *host = nullptr;
+    struct ares_addrttl addrttls[MAX_ADDRESSES];
+    int naddrttls = MAX_ADDRESSES;
+    outErrorCode = ares_parse_a_reply(reinterpret_cast<const unsigned char *>(answer.constData()), answer.size(),
+                                      &host, addrttls, &naddrttls);
+    if (outErrorCode != ARES_SUCCESS)
+    {
+        // a garbled answer (not a DNS message) is a failure of the server, not the answer for the name
+        if (outErrorCode == ARES_EBADRESP)
+        {
+            outErrorCode = ARES_ECONNREFUSED;
+        }
+        return false;
+    }
+
+    outTtl = 0;
+    for (int i = 0; i < naddrttls; ++i)
+    {
+        char ip[INET_ADDRSTRLEN];
+        if (inet_ntop(AF_INET, &addrttls[i].ipaddr, ip, sizeof(ip)) != nullptr)
+        {
+            outIps << QString::fromLatin1(ip);
+        }
+        if (i == 0 || addrttls[i].ttl < outTtl)
+        {
+            outTtl = addrttls[i].ttl;
+        }
+    }
+    ares_free_hostent(host);
+    return true;
+}
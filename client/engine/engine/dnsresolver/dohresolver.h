@@ -0,0 +1,44 @@
+#ifndef DOHRESOLVER_H
+#define DOHRESOLVER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+class NetworkAccessManager;
+class NetworkReply;
+
+// resolves the names with DNS-over-HTTPS (RFC 8484, POST of the wire format query) through NetworkAccessManager,
+// so the queries go over the pooled (and multiplexed with HTTP/2) connections of CurlNetworkManager2.
+// Lives in the engine thread, one instance which is registered for the static lookup(). Do not use it directly, use DnsRequest.
+class DohResolver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DohResolver(QObject *parent, NetworkAccessManager *networkAccessManager);
+    virtual ~DohResolver();
+
+    // thread safe, object gets onResolved(QStringList ips, int aresErrorCode, int ttl),
+    // ARES_ECONNREFUSED if the server could not be reached (for the fallback to the plain DNS)
+    // returns false if there is no resolver
+    static bool lookup(const QString &url, const QString &hostname, QSharedPointer<QObject> object, int timeoutMs);
+
+private slots:
+    void onReplyFinished();
+
+private:
+    static QMutex mutex_;
+    static DohResolver *this_;
+
+    NetworkAccessManager *networkAccessManager_;
+    // the objects waiting for a pending query, by url and hostname
+    QHash<QString, QVector<QSharedPointer<QObject> > > waiters_;
+
+    void startLookup(const QString &url, const QString &hostname, QSharedPointer<QObject> object, int timeoutMs);
+    void notifyWaiters(const QString &key, const QStringList &ips, int aresErrorCode, int ttl);
+    static bool parseAnswer(const QByteArray &answer, QStringList &outIps, int &outTtl, int &outErrorCode);
+};
+
+#endif // DOHRESOLVER_H
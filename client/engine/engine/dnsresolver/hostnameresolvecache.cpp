@@ -0,0 +1,111 @@
+#include "hostnameresolvecache.h"
+#include "dnsrequest.h"
+#include "dnsserversconfiguration.h"
+#include "utils/ipvalidation.h"
+#include "utils/logger.h"
+
+bool HostnameResolveCache::get(const QString &hostname, QStringList &ips)
+{
+    QMutexLocker locker(&mutex_);
+    auto it = entries_.find(hostname);
+    if (it == entries_.end())
+    {
+        return false;
+    }
+    if (it->expireTime <= QDateTime::currentDateTimeUtc())
+    {
+        entries_.erase(it);
+        return false;
+    }
+    ips = it->ips;
+    return true;
+}
+
+void HostnameResolveCache::put(const QString &hostname, const QStringList &ips, int ttl)
+{
+    if (ips.isEmpty())
+    {
+        return;
+    }
+    const int lifetime = ttl > 0 ? qBound(MIN_LIFETIME_SECS, ttl, MAX_LIFETIME_SECS) : DEFAULT_LIFETIME_SECS;
+
+    QMutexLocker locker(&mutex_);
+    Entry entry;
+    entry.ips = ips;
+    entry.expireTime = QDateTime::currentDateTimeUtc().addSecs(lifetime);
+    entries_[hostname] = entry;
+}
+
+void HostnameResolveCache::prefetch(const QStringList &hostnames)
+{
+    QStringList toResolve;
+    int generation;
+    {
+        QMutexLocker locker(&mutex_);
+        generation = generation_;
+        const QDateTime refreshTime = QDateTime::currentDateTimeUtc().addSecs(REFRESH_MARGIN_SECS);
+        for (const QString &hostname : hostnames)
+        {
+            if (hostname.isEmpty() || IpValidation::instance().isIp(hostname) || inProgress_.contains(hostname)
+                || toResolve.contains(hostname))
+            {
+                continue;
+            }
+            auto it = entries_.constFind(hostname);
+            if (it == entries_.constEnd() || it->expireTime <= refreshTime)
+            {
+                toResolve << hostname;
+                inProgress_.insert(hostname);
+            }
+        }
+    }
+
+    if (!toResolve.isEmpty())
+    {
+        qCDebug(LOG_BASIC) << "HostnameResolveCache prefetching" << toResolve.count() << "hostnames";
+        DnsBatchRequest *dnsRequest = new DnsBatchRequest(this, toResolve, DnsServersConfiguration::instance().getCurrentDnsServers());
+        dnsRequest->setProperty("generation", generation);
+        connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
+        dnsRequest->lookup();
+    }
+}
+
+void HostnameResolveCache::clear()
+{
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+    inProgress_.clear();
+    generation_++;
+}
+
+void HostnameResolveCache::onDnsRequestFinished()
+{
+    DnsBatchRequest *dnsRequest = qobject_cast<DnsBatchRequest *>(sender());
+    Q_ASSERT(dnsRequest != nullptr);
+
+    dnsRequest->deleteLater();
+    {
+        QMutexLocker locker(&mutex_);
+        if (dnsRequest->property("generation").toInt() != generation_)
+        {
+            // resolved on the previous network
+            return;
+        }
+    }
+
+    const QStringList hostnames = dnsRequest->hostnames();
+    for (const QString &hostname : hostnames)
+    {
+        if (!dnsRequest->isError(hostname))
+        {
+            put(hostname, dnsRequest->ips(hostname), dnsRequest->ttl(hostname));
+        }
+    }
+    {
+        QMutexLocker locker(&mutex_);
+        for (const QString &hostname : hostnames)
+        {
+            inProgress_.remove(hostname);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef HOSTNAMERESOLVECACHE_H
+#define HOSTNAMERESOLVECACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+// singleton, the resolved hostnames of the connection targets which are not IPs (the custom configs),
+// prefetched in the background when the configs are parsed, so the connect path doesn't wait for DNS.
+// An entry lives for the TTL of the answer (clamped to [MIN_LIFETIME_SECS, MAX_LIFETIME_SECS]),
+// the failed lookups are not cached.
+class HostnameResolveCache : public QObject
+{
+    Q_OBJECT
+public:
+    static HostnameResolveCache &instance()
+    {
+        static HostnameResolveCache hrc;
+        return hrc;
+    }
+
+    bool get(const QString &hostname, QStringList &ips);
+    void put(const QString &hostname, const QStringList &ips, int ttl);
+    // resolves the hostnames which are not cached or expire soon, the IPs are skipped
+    void prefetch(const QStringList &hostnames);
+    // on a network change, the answers of the prefetches in progress are dropped too
+    void clear();
+
+private slots:
+    void onDnsRequestFinished();
+
+private:
+    HostnameResolveCache() : generation_(0) {}
+
+    static constexpr int MIN_LIFETIME_SECS = 60;
+    static constexpr int MAX_LIFETIME_SECS = 60 * 60;
+    // for the answers without TTL (hosts file, DoH)
+    static constexpr int DEFAULT_LIFETIME_SECS = 5 * 60;
+    // prefetch() refreshes the entries which expire sooner
+    static constexpr int REFRESH_MARGIN_SECS = 30;
+
+    struct Entry
+    {
+        QStringList ips;
+        QDateTime expireTime;
+    };
+
+    QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    QSet<QString> inProgress_;
+    // incremented by clear(), the prefetches started before are not put into the cache
+    int generation_;
+};
+
+#endif // HOSTNAMERESOLVECACHE_H
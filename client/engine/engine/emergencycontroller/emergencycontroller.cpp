@@ -18,6 +18,7 @@
 
 EmergencyController::EmergencyController(QObject *parent, IHelper *helper) : QObject(parent),
     helper_(helper),
+    racer_(nullptr),
     serverApiUserRole_(0),
     state_(STATE_DISCONNECTED)
 {
@@ -39,6 +40,9 @@ EmergencyController::EmergencyController(QObject *parent, IHelper *helper) : QOb
      connect(connector_, SIGNAL(error(ProtoTypes::ConnectError)), SLOT(onConnectionError(ProtoTypes::ConnectError)), Qt::QueuedConnection);
 
      makeOVPNFile_ = new MakeOVPNFile();
+
+     racer_ = new ConnectionRacer(this);
+     connect(racer_, SIGNAL(finished(int)), SLOT(onRaceFinished(int)));
 }
 
 EmergencyController::~EmergencyController()
@@ -67,6 +71,8 @@ void EmergencyController::clickDisconnect()
     Q_ASSERT(state_ == STATE_CONNECTING_FROM_USER_CLICK || state_ == STATE_CONNECTED  ||
              state_ == STATE_DISCONNECTING_FROM_USER_CLICK || state_ == STATE_DISCONNECTED);
 
+    racer_->stop();
+
     if (state_ != STATE_DISCONNECTING_FROM_USER_CLICK)
     {
         state_ = STATE_DISCONNECTING_FROM_USER_CLICK;
@@ -97,31 +103,40 @@ bool EmergencyController::isDisconnected()
 
 void EmergencyController::blockingDisconnect()
 {
-    if (connector_)
+    if (beginBlockingDisconnect())
     {
-        if (!connector_->isDisconnected())
-        {
-            connector_->blockSignals(true);
-            QElapsedTimer elapsedTimer;
-            elapsedTimer.start();
-            connector_->startDisconnect();
-            while (!connector_->isDisconnected())
-            {
-                QThread::msleep(1);
-                qApp->processEvents();
+        Utils::waitInEventLoop([this]() { return isBlockingDisconnectFinished(); }, BLOCKING_DISCONNECT_TIMEOUT_MS);
+        endBlockingDisconnect();
+    }
+}
 
-                if (elapsedTimer.elapsed() > 10000)
-                {
-                    qCDebug(LOG_EMERGENCY_CONNECT) << "EmergencyController::blockingDisconnect() delay more than 10 seconds";
-                    connector_->startDisconnect();
-                    break;
-                }
-            }
-            connector_->blockSignals(false);
-            doMacRestoreProcedures();
-            state_ = STATE_DISCONNECTED;
-        }
+bool EmergencyController::beginBlockingDisconnect()
+{
+    racer_->stop();
+    if (!connector_ || connector_->isDisconnected())
+    {
+        return false;
     }
+    connector_->blockSignals(true);
+    connector_->startDisconnect();
+    return true;
+}
+
+bool EmergencyController::isBlockingDisconnectFinished()
+{
+    return connector_->isDisconnected();
+}
+
+void EmergencyController::endBlockingDisconnect()
+{
+    if (!connector_->isDisconnected())
+    {
+        qCDebug(LOG_EMERGENCY_CONNECT) << "EmergencyController::blockingDisconnect() delay more than 10 seconds";
+        connector_->startDisconnect();
+    }
+    connector_->blockSignals(false);
+    doMacRestoreProcedures();
+    state_ = STATE_DISCONNECTED;
 }
 
 const AdapterGatewayInfo &EmergencyController::getVpnAdapterInfo() const
@@ -180,8 +195,37 @@ void EmergencyController::onDnsRequestFinished()
         qCDebug(LOG_EMERGENCY_CONNECT) << "DNS resolve failed";
         addRandomHardcodedIpsToAttempts();
     }
-    doConnect();
     dnsRequest->deleteLater();
+
+    if (state_ != STATE_CONNECTING_FROM_USER_CLICK)
+    {
+        return;
+    }
+    if (!startRace())
+    {
+        doConnect();
+    }
+}
+
+void EmergencyController::onRaceFinished(int winnerIndex)
+{
+    if (state_ != STATE_CONNECTING_FROM_USER_CLICK)
+    {
+        return;
+    }
+    if (winnerIndex >= 0 && winnerIndex < raceAttemptInds_.count())
+    {
+        const CONNECT_ATTEMPT_INFO winner = attempts_[raceAttemptInds_[winnerIndex]];
+        qCDebug(LOG_EMERGENCY_CONNECT) << "Endpoint race winner:" << winner.ip << winner.protocol << winner.port;
+        attempts_.remove(raceAttemptInds_[winnerIndex]);
+        attempts_.prepend(winner);
+    }
+    else
+    {
+        qCDebug(LOG_EMERGENCY_CONNECT) << "No endpoint answered in the race, keep the order of the attempts";
+    }
+    raceAttemptInds_.clear();
+    doConnect();
 }
 
 void EmergencyController::onConnectionConnected(const AdapterGatewayInfo &connectionAdapterInfo)
@@ -371,6 +415,38 @@ void EmergencyController::doMacRestoreProcedures()
 #endif
 }
 
+bool EmergencyController::startRace()
+{
+    // the probes go directly to the endpoints
+    if (proxySettings_.isProxyEnabled())
+    {
+        return false;
+    }
+
+    QVector<ConnectionRacer::Candidate> candidates;
+    raceAttemptInds_.clear();
+    for (int i = 0; i < attempts_.count(); ++i)
+    {
+        if (attempts_[i].protocol == "tcp")
+        {
+            ConnectionRacer::Candidate candidate;
+            candidate.protocol = ProtocolType(ProtocolType::PROTOCOL_OPENVPN_TCP);
+            candidate.ip = attempts_[i].ip;
+            candidate.port = attempts_[i].port;
+            candidates << candidate;
+            raceAttemptInds_ << i;
+        }
+    }
+    if (candidates.isEmpty())
+    {
+        return false;
+    }
+
+    qCDebug(LOG_EMERGENCY_CONNECT) << "Racing" << candidates.count() << "endpoints before the connection";
+    racer_->start(candidates, RACE_TIMEOUT, ConnectionRacer::WINNER_FIRST_ANSWER);
+    return true;
+}
+
 void EmergencyController::addRandomHardcodedIpsToAttempts()
 {
     const QStringList ips = HardcodedSettings::instance().emergencyIps();
@@ -7,6 +7,7 @@
 #include "engine/types/types.h"
 #include "engine/connectionmanager/iconnection.h"
 #include "engine/connectionmanager/makeovpnfile.h"
+#include "engine/connectionmanager/connectionracer.h"
 
 #ifdef Q_OS_MAC
     #include "engine/connectionmanager/restorednsmanager_mac.h"
@@ -24,6 +25,12 @@ public:
     void clickDisconnect();
     bool isDisconnected();
     void blockingDisconnect();
+    // the steps of blockingDisconnect(), as in ConnectionManager
+    bool beginBlockingDisconnect();
+    bool isBlockingDisconnectFinished();
+    void endBlockingDisconnect();
+
+    static constexpr int BLOCKING_DISCONNECT_TIMEOUT_MS = 10000;
 
     const AdapterGatewayInfo &getVpnAdapterInfo() const;
 
@@ -36,6 +43,7 @@ signals:
 
 private slots:
     void onDnsRequestFinished();
+    void onRaceFinished(int winnerIndex);
 
     void onConnectionConnected(const AdapterGatewayInfo &connectionAdapterInfo);
     void onConnectionDisconnected();
@@ -60,6 +68,12 @@ private:
     };
     QVector<CONNECT_ATTEMPT_INFO> attempts_;
 
+    // the TCP endpoints are probed in parallel before the first attempt, the first one which answered goes first;
+    // the UDP ones can't be probed, the emergency servers require tls-auth and don't answer without the key
+    ConnectionRacer *racer_;
+    QVector<int> raceAttemptInds_;
+    static constexpr int RACE_TIMEOUT = 1500;
+
     QString lastIp_;
     uint serverApiUserRole_;
     int state_;
@@ -71,6 +85,7 @@ private:
     void doConnect();
     void doMacRestoreProcedures();
     void addRandomHardcodedIpsToAttempts();
+    bool startRace();
 };
 
 #endif // EMERGENCYCONTROLLER_H
@@ -5,16 +5,26 @@
 #include <QCryptographicHash>
 #include "utils/utils.h"
 #include "utils/logger.h"
+#include "utils/clean_sensitive_info.h"
 #include "utils/mergelog.h"
+#include "utils/tracespan.h"
+#include "utils/eventloopwatchdog.h"
+#include "utils/settingsstore.h"
 #include "utils/extraconfig.h"
+#include "utils/hardcodedsettings.h"
+#include "utils/ipset.h"
 #include "utils/ipvalidation.h"
 #include "utils/executable_signature/executable_signature.h"
 #include "connectionmanager/connectionmanager.h"
 #include "connectionmanager/finishactiveconnections.h"
+#include "locationsmodel/mutablelocationinfo.h"
+#include "enginemetrics.h"
 #include "proxy/proxyservercontroller.h"
 #include "connectstatecontroller/connectstatecontroller.h"
 #include "dnsresolver/dnsserversconfiguration.h"
+#include "dnsresolver/hostnameresolvecache.h"
 #include "dnsresolver/dnsrequest.h"
+#include "dnsresolver/dnsresolver.h"
 #include "dnsresolver/dnsutils.h"
 #include "crossplatformobjectfactory.h"
 #include "openvpnversioncontroller.h"
@@ -51,6 +61,7 @@ Engine::Engine(const EngineSettings &engineSettings) : QObject(nullptr),
     helper_(nullptr),
     firewallController_(nullptr),
     networkAccessManager_(nullptr),
+    dohResolver_(nullptr),
     serverAPI_(nullptr),
     connectionManager_(nullptr),
     connectStateController_(nullptr),
@@ -58,6 +69,7 @@ Engine::Engine(const EngineSettings &engineSettings) : QObject(nullptr),
     serverApiEditAccountDetailsUserRole_(0),
     serverApiAddEmailUserRole_(0),
     getMyIPController_(nullptr),
+    wireGuardConfigPrefetcher_(nullptr),
     vpnShareController_(nullptr),
     emergencyController_(nullptr),
     customConfigs_(nullptr),
@@ -65,18 +77,20 @@ Engine::Engine(const EngineSettings &engineSettings) : QObject(nullptr),
     networkDetectionManager_(nullptr),
     macAddressController_(nullptr),
     keepAliveManager_(nullptr),
+    tunnelSpeedTest_(nullptr),
+    throughputMeter_(nullptr),
+    metricsServer_(nullptr),
     packetSizeController_(nullptr),
 #ifdef Q_OS_WIN
     measurementCpuUsage_(nullptr),
 #endif
     inititalizeHelper_(nullptr),
+    initTaskGraph_(nullptr),
     bInitialized_(false),
     loginController_(nullptr),
     loginState_(LOGIN_NONE),
     loginSettingsMutex_(QMutex::Recursive),
-    updateServerResourcesTimer_(nullptr),
-    updateSessionStatusTimer_(nullptr),
-    notificationsUpdateTimer_(nullptr),
+    refreshScheduler_(nullptr),
     locationsModel_(nullptr),
     refetchServerCredentialsHelper_(nullptr),
     downloadHelper_(nullptr),
@@ -99,7 +113,6 @@ Engine::Engine(const EngineSettings &engineSettings) : QObject(nullptr),
     connectStateController_ = new ConnectStateController(nullptr);
     connect(connectStateController_, SIGNAL(stateChanged(CONNECT_STATE,DISCONNECT_REASON,ProtoTypes::ConnectError,LocationID)), SLOT(onConnectStateChanged(CONNECT_STATE,DISCONNECT_REASON,ProtoTypes::ConnectError,LocationID)));
     emergencyConnectStateController_ = new ConnectStateController(nullptr);
-    OpenVpnVersionController::instance().setUseWinTun(engineSettings.isUseWintun());
 #ifdef Q_OS_LINUX
     DnsScripts_linux::instance().setDnsManager(engineSettings.getDnsManager());
 #endif
@@ -191,9 +204,7 @@ bool Engine::isApiSavedSettingsExists()
 {
     if (!apiinfo::ApiInfo::getAuthHash().isEmpty())
     {
-        // try load ApiInfo from settings
-        apiinfo::ApiInfo apiInfo;
-        if (apiInfo.loadFromSettings())
+        if (apiinfo::ApiInfo::isExistInSettings())
         {
             return true;
         }
@@ -255,6 +266,16 @@ void Engine::getWebSessionToken(ProtoTypes::WebSessionPurpose purpose)
     QMetaObject::invokeMethod(this, "getWebSessionTokenImpl", Q_ARG(ProtoTypes::WebSessionPurpose, purpose));
 }
 
+void Engine::startTunnelSpeedTest()
+{
+    QMetaObject::invokeMethod(this, "startTunnelSpeedTestImpl");
+}
+
+void Engine::getThroughputHistory()
+{
+    QMetaObject::invokeMethod(this, "getThroughputHistoryImpl");
+}
+
 LoginSettings Engine::getLastLoginSettings()
 {
     QMutexLocker lockerLoginSettings(&loginSettingsMutex_);
@@ -571,6 +592,10 @@ void Engine::makeHostsFileWritableWin()
 
 void Engine::init()
 {
+    initStartUs_ = TraceSpan::nowUs();
+    isFirstServerLocationsTraced_ = false;
+    TraceSpan traceSpan("engine", "Engine::init");
+
 #ifdef Q_OS_WIN
     HRESULT hr = CoInitializeEx(0, COINIT_MULTITHREADED);
     if (FAILED(hr))
@@ -586,14 +611,41 @@ void Engine::init()
     connect(helper_, SIGNAL(lostConnectionToHelper()), SLOT(onLostConnectionToHelper()));
     helper_->startInstallHelper();
 
+    // the OpenVPN versions are detected in main(), before initPart2 reads the selected one
+    OpenVpnVersionController::instance().setUseWinTun(engineSettings_.isUseWintun());
+
+    // the helper connection and the network interfaces are independent, the objects of initPart2 need the helper
+    initTaskGraph_ = new InitTaskGraph(this);
+    connect(initTaskGraph_, SIGNAL(finished()), SLOT(onInitTasksFinished()));
+
+    initTaskGraph_->addTask("network interfaces", InitTaskGraph::THREAD_POOL, QStringList(), [this]() {
+#ifdef Q_OS_MAC
+        initNetworkInterfaces_ = NetworkUtils_mac::currentNetworkInterfaces(true);
+#elif defined Q_OS_WIN
+        initNetworkInterfaces_ = WinUtils::currentNetworkInterfaces(true);
+#endif
+    });
+    initTaskGraph_->addExternalTask("helper", QStringList());
+    initTaskGraph_->addTask("init part2", InitTaskGraph::THREAD_ENGINE, QStringList() << "helper" << "network interfaces", [this]() {
+        QMutexLocker locker(&mutex_);
+        bInitialized_ = true;
+        initPart2();
+    });
+    initTaskGraph_->addTask("finish active connections", InitTaskGraph::THREAD_ENGINE, QStringList() << "init part2", [this]() {
+        FinishActiveConnections::finishAllActiveConnections(helper_);
+    });
+
     inititalizeHelper_ = new InitializeHelper(this, helper_);
     connect(inititalizeHelper_, SIGNAL(finished(INIT_HELPER_RET)), SLOT(onInitializeHelper(INIT_HELPER_RET)));
+    initTaskGraph_->start();
     inititalizeHelper_->start();
 }
 
 // init part2 (after helper initialized)
 void Engine::initPart2()
 {
+    TraceSpan traceSpan("engine", "Engine::initPart2");
+
 #ifdef Q_OS_MAC
     Ipv6Controller_mac::instance().setHelper(helper_);
     ReachAbilityEvents::instance().init();
@@ -605,14 +657,8 @@ void Engine::initPart2()
     firewallExceptions_.setDnsPolicy(engineSettings_.getDnsPolicy());
 
     ProtoTypes::MacAddrSpoofing macAddrSpoofing = engineSettings_.getMacAddrSpoofing();
-    //todo refactor
-#ifdef Q_OS_MAC
-    *macAddrSpoofing.mutable_network_interfaces() = NetworkUtils_mac::currentNetworkInterfaces(true);
-#elif defined Q_OS_WIN
-    *macAddrSpoofing.mutable_network_interfaces() = WinUtils::currentNetworkInterfaces(true);
-#elif define Q_OS_LINUX
-    todo
-#endif
+    // read by the "network interfaces" init task
+    *macAddrSpoofing.mutable_network_interfaces() = initNetworkInterfaces_;
     setSettingsMacAddressSpoofing(macAddrSpoofing);
 
     connect(networkDetectionManager_, SIGNAL(onlineStateChanged(bool)), SLOT(onNetworkOnlineStateChange(bool)));
@@ -637,10 +683,14 @@ void Engine::initPart2()
     packetSizeController_->moveToThread(packetSizeControllerThread_);
     packetSizeControllerThread_->start(QThread::LowPriority);
 
+    EventLoopWatchdog::instance().watch(QThread::currentThread(), "engine");
+    EventLoopWatchdog::instance().watch(packetSizeControllerThread_, "packet size controller");
+
     firewallController_ = CrossPlatformObjectFactory::createFirewallController(this, helper_);
 
     networkAccessManager_ = new NetworkAccessManager(this);
     connect(networkAccessManager_, SIGNAL(whitelistIpsChanged(QSet<QString>)), SLOT(onWhitelistedIPsChanged(QSet<QString>)));
+    dohResolver_ = new DohResolver(this, networkAccessManager_);
 
     serverAPI_ = new ServerAPI(this);
     connect(serverAPI_, &ServerAPI::sessionAnswer, this, &Engine::onSessionAnswer, Qt::QueuedConnection);
@@ -679,23 +729,47 @@ void Engine::initPart2()
     connect(connectionManager_, SIGNAL(protocolPortChanged(ProtoTypes::Protocol, uint)), SLOT(onConnectionManagerProtocolPortChanged(ProtoTypes::Protocol, uint)));
     connect(connectionManager_, SIGNAL(internetConnectivityChanged(bool)), SLOT(onConnectionManagerInternetConnectivityChanged(bool)));
     connect(connectionManager_, SIGNAL(wireGuardAtKeyLimit()), SLOT(onConnectionManagerWireGuardAtKeyLimit()));
+    connect(connectionManager_, SIGNAL(roamed()), SLOT(onConnectionManagerRoamed()));
     connect(connectionManager_, SIGNAL(requestUsername(QString)), SLOT(onConnectionManagerRequestUsername(QString)));
     connect(connectionManager_, SIGNAL(requestPassword(QString)), SLOT(onConnectionManagerRequestPassword(QString)));
 
     locationsModel_ = new locationsmodel::LocationsModel(this, connectStateController_, networkDetectionManager_);
     connect(locationsModel_, SIGNAL(whitelistLocationsIpsChanged(QStringList)), SLOT(onLocationsModelWhitelistIpsChanged(QStringList)));
     connect(locationsModel_, SIGNAL(whitelistCustomConfigsIpsChanged(QStringList)), SLOT(onLocationsModelWhitelistCustomConfigIpsChanged(QStringList)));
+    connect(locationsModel_, SIGNAL(bestLocationUpdated(LocationID)), SLOT(onLocationsModelBestLocationUpdated(LocationID)));
 
     getMyIPController_ = new GetMyIPController(this, serverAPI_, networkDetectionManager_);
     connect(getMyIPController_, SIGNAL(answerMyIP(QString,bool,bool)), SLOT(onMyIpAnswer(QString,bool,bool)));
 
+    wireGuardConfigPrefetcher_ = new WireGuardConfigPrefetcher(this, serverAPI_);
+
     vpnShareController_ = new VpnShareController(this, helper_);
     connect(vpnShareController_, SIGNAL(connectedWifiUsersChanged(int)), SIGNAL(vpnSharingConnectedWifiUsersCountChanged(int)));
     connect(vpnShareController_, SIGNAL(connectedProxyUsersChanged(int)), SIGNAL(vpnSharingConnectedProxyUsersCountChanged(int)));
+    connect(vpnShareController_, SIGNAL(proxyTrafficChanged(ProtoTypes::ProxySharingTraffic)), SIGNAL(vpnSharingProxyTrafficChanged(ProtoTypes::ProxySharingTraffic)));
 
     keepAliveManager_ = new KeepAliveManager(this, connectStateController_);
+    connect(connectionManager_, SIGNAL(statisticsUpdated(quint64,quint64, bool)), keepAliveManager_, SLOT(onStatisticsUpdated(quint64,quint64, bool)));
     keepAliveManager_->setEnabled(engineSettings_.isKeepAliveEnabled());
 
+    throughputMeter_ = new ThroughputMeter(this);
+    connect(connectionManager_, SIGNAL(statisticsUpdated(quint64,quint64, bool)), throughputMeter_, SLOT(onStatisticsUpdated(quint64,quint64, bool)));
+    connect(throughputMeter_, SIGNAL(throughputUpdated(ProtoTypes::Throughput)), SIGNAL(throughputUpdated(ProtoTypes::Throughput)));
+
+    bool isMetricsPortSet;
+    const int metricsPort = ExtraConfig::instance().getMetricsPort(isMetricsPortSet);
+    if (isMetricsPortSet)
+    {
+        metricsServer_ = new MetricsServer(this);
+        if (metricsServer_->start(static_cast<quint16>(metricsPort)))
+        {
+            EngineMetrics::instance().setEnabled(true);
+        }
+    }
+
+    tunnelSpeedTest_ = new TunnelSpeedTest(this, networkAccessManager_);
+    connect(tunnelSpeedTest_, SIGNAL(finished(ProtoTypes::TunnelSpeedTestResult)), SIGNAL(tunnelSpeedTestFinished(ProtoTypes::TunnelSpeedTestResult)));
+
     emergencyController_ = new EmergencyController(this, helper_);
     emergencyController_->setPacketSize(packetSize_);
     connect(emergencyController_, SIGNAL(connected()), SLOT(onEmergencyControllerConnected()));
@@ -706,12 +780,11 @@ void Engine::initPart2()
     customConfigs_->changeDir(engineSettings_.getCustomOvpnConfigsPath());
     connect(customConfigs_, SIGNAL(changed()), SLOT(onCustomConfigsChanged()));
 
-    updateServerResourcesTimer_ = new QTimer(this);
-    connect(updateServerResourcesTimer_, &QTimer::timeout, this, &Engine::onUpdateServerResources);
-    updateSessionStatusTimer_ = new SessionStatusTimer(this, connectStateController_);
-    connect(updateSessionStatusTimer_, SIGNAL(needUpdateRightNow()), SLOT(onUpdateSessionStatusTimer()));
-    notificationsUpdateTimer_ = new QTimer(this);
-    connect(notificationsUpdateTimer_, SIGNAL(timeout()), SLOT(getNewNotifications()));
+    refreshScheduler_ = new RefreshScheduler(this, connectStateController_);
+    connect(refreshScheduler_, &RefreshScheduler::serverResourcesRefreshNeeded, this, &Engine::onUpdateServerResources);
+    connect(refreshScheduler_, SIGNAL(sessionStatusRefreshNeeded()), SLOT(onUpdateSessionStatusTimer()));
+    connect(refreshScheduler_, SIGNAL(notificationsRefreshNeeded()), SLOT(getNewNotifications()));
+    connect(refreshScheduler_, SIGNAL(serverCredentialsRefreshNeeded()), SLOT(onServerCredentialsRefreshNeeded()));
 
     downloadHelper_ = new DownloadHelper(this, networkAccessManager_, Utils::getPlatformName());
     connect(downloadHelper_, SIGNAL(finished(DownloadHelper::DownloadState)), SLOT(onDownloadHelperFinished(DownloadHelper::DownloadState)));
@@ -731,6 +804,7 @@ void Engine::initPart2()
     measurementCpuUsage_->setEnabled(engineSettings_.isCloseTcpSockets());
 #endif
 
+    connect(&ProxyServerController::instance(), SIGNAL(proxySettingsChanged()), SLOT(onProxySettingsChanged()));
     updateProxySettings();
     updateAdvancedParams();
 }
@@ -742,61 +816,63 @@ void Engine::onLostConnectionToHelper()
 
 void Engine::onInitializeHelper(INIT_HELPER_RET ret)
 {
+    TraceSpan::record("engine", "helper connect (from Engine::init)", initStartUs_);
+
     if (ret == INIT_HELPER_SUCCESS)
     {
-        QMutexLocker locker(&mutex_);
-        bInitialized_ = true;
-
-        initPart2();
+        // the rest of the init continues in onInitTasksFinished()
+        initTaskGraph_->finishExternalTask("helper");
+    }
+    else if (ret == INIT_HELPER_FAILED)
+    {
+        Q_EMIT initFinished(ENGINE_INIT_HELPER_FAILED);
+    }
+    else if (ret == INIT_HELPER_USER_CANCELED)
+    {
+        Q_EMIT initFinished(ENGINE_INIT_HELPER_USER_CANCELED);
+    }
+    else
+    {
+        Q_ASSERT(false);
+    }
+}
 
-        FinishActiveConnections::finishAllActiveConnections(helper_);
+void Engine::onInitTasksFinished()
+{
+    QMutexLocker locker(&mutex_);
 
 #ifdef Q_OS_MAC
-        QString kextPath = QCoreApplication::applicationDirPath() + "/../Helpers/WindscribeKext.kext";
-        kextPath = QDir::cleanPath(kextPath);
-        Helper_mac *helper_mac = dynamic_cast<Helper_mac *>(helper_);
-        if (helper_mac->setKextPath(kextPath))
-        {
-            qCDebug(LOG_BASIC) << "Kext path set:" << Utils::cleanSensitiveInfo(kextPath);
-        }
-        else
-        {
-            qCDebug(LOG_BASIC) << "Kext path set failed";
-            Q_EMIT initFinished(ENGINE_INIT_HELPER_FAILED);
-        }
+    QString kextPath = QCoreApplication::applicationDirPath() + "/../Helpers/WindscribeKext.kext";
+    kextPath = QDir::cleanPath(kextPath);
+    Helper_mac *helper_mac = dynamic_cast<Helper_mac *>(helper_);
+    if (helper_mac->setKextPath(kextPath))
+    {
+        qCDebug(LOG_BASIC) << "Kext path set:" << Utils::cleanSensitiveInfo(kextPath);
+    }
+    else
+    {
+        qCDebug(LOG_BASIC) << "Kext path set failed";
+        Q_EMIT initFinished(ENGINE_INIT_HELPER_FAILED);
+    }
 #endif
 
     // turn off split tunneling (for case the state remains from the last launch)
     helper_->sendConnectStatus(false, engineSettings_.isCloseTcpSockets(), engineSettings_.isAllowLanTraffic(), AdapterGatewayInfo(), AdapterGatewayInfo(), QString(), ProtocolType());
     helper_->setSplitTunnelingSettings(false, false, false, QStringList(), QStringList(), QStringList());
 
-
-    #ifdef Q_OS_WIN
-        // check BFE service status
-        if (!BFE_Service_win::instance().isBFEEnabled())
-        {
-            Q_EMIT initFinished(ENGINE_INIT_BFE_SERVICE_FAILED);
-        }
-        else
-        {
-            Q_EMIT initFinished(ENGINE_INIT_SUCCESS);
-        }
-    #else
-        Q_EMIT initFinished(ENGINE_INIT_SUCCESS);
-    #endif
-    }
-    else if (ret == INIT_HELPER_FAILED)
-    {
-        Q_EMIT initFinished(ENGINE_INIT_HELPER_FAILED);
-    }
-    else if (ret == INIT_HELPER_USER_CANCELED)
+#ifdef Q_OS_WIN
+    // check BFE service status
+    if (!BFE_Service_win::instance().isBFEEnabled())
     {
-        Q_EMIT initFinished(ENGINE_INIT_HELPER_USER_CANCELED);
+        Q_EMIT initFinished(ENGINE_INIT_BFE_SERVICE_FAILED);
     }
     else
     {
-        Q_ASSERT(false);
+        Q_EMIT initFinished(ENGINE_INIT_SUCCESS);
     }
+#else
+    Q_EMIT initFinished(ENGINE_INIT_SUCCESS);
+#endif
 }
 
 void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool isFirewallAlwaysOn, bool isLaunchOnStart)
@@ -818,17 +894,9 @@ void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool is
     }
 
     // stop timers
-    if (updateServerResourcesTimer_)
-    {
-        updateServerResourcesTimer_->stop();
-    }
-    if (updateSessionStatusTimer_)
-    {
-        updateSessionStatusTimer_->stop();
-    }
-    if (notificationsUpdateTimer_)
+    if (refreshScheduler_)
     {
-        notificationsUpdateTimer_->stop();
+        refreshScheduler_->stopAll();
     }
 
     if (!apiInfo_.isNull())
@@ -842,15 +910,28 @@ void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool is
         helper_->setNeedFinish();
     }
 
-    if (emergencyController_)
+    // both tunnels are stopped at once, with one deadline
+    const bool isEmergencyDisconnecting = emergencyController_ && emergencyController_->beginBlockingDisconnect();
+    const bool bWasIsConnected = connectionManager_ && !connectionManager_->isDisconnected();
+    const bool isDisconnecting = connectionManager_ && connectionManager_->beginBlockingDisconnect();
+    if (isEmergencyDisconnecting || isDisconnecting)
     {
-        emergencyController_->blockingDisconnect();
+        Utils::waitInEventLoop([this, isEmergencyDisconnecting, isDisconnecting]() {
+            return (!isEmergencyDisconnecting || emergencyController_->isBlockingDisconnectFinished()) &&
+                   (!isDisconnecting || connectionManager_->isBlockingDisconnectFinished());
+        }, ConnectionManager::BLOCKING_DISCONNECT_TIMEOUT_MS);
+        if (isEmergencyDisconnecting)
+        {
+            emergencyController_->endBlockingDisconnect();
+        }
+        if (isDisconnecting)
+        {
+            connectionManager_->endBlockingDisconnect();
+        }
     }
 
     if (connectionManager_)
     {
-        bool bWasIsConnected = !connectionManager_->isDisconnected();
-        connectionManager_->blockingDisconnect();
         if (bWasIsConnected)
         {
             #ifdef Q_OS_WIN
@@ -865,7 +946,6 @@ void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool is
 
         connectionManager_->removeIkev2ConnectionFromOS();
     }
-
     // turn off split tunneling
     if (helper_)
     {
@@ -954,25 +1034,32 @@ void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool is
 
     SAFE_DELETE(vpnShareController_);
     SAFE_DELETE(emergencyController_);
+    SAFE_DELETE(wireGuardConfigPrefetcher_);
     SAFE_DELETE(connectionManager_);
     SAFE_DELETE(customConfigs_);
     SAFE_DELETE(customOvpnAuthCredentialsStorage_);
     SAFE_DELETE(firewallController_);
     SAFE_DELETE(keepAliveManager_);
+    SAFE_DELETE(tunnelSpeedTest_);
+    SAFE_DELETE(throughputMeter_);
+    SAFE_DELETE(metricsServer_);
     SAFE_DELETE(inititalizeHelper_);
+    SAFE_DELETE(initTaskGraph_);
 #ifdef Q_OS_WIN
     SAFE_DELETE(measurementCpuUsage_);
 #endif
     SAFE_DELETE(helper_);
     SAFE_DELETE(getMyIPController_);
     SAFE_DELETE(serverAPI_);
-    SAFE_DELETE(updateServerResourcesTimer_);
-    SAFE_DELETE(updateSessionStatusTimer_);
-    SAFE_DELETE(notificationsUpdateTimer_);
+    SAFE_DELETE(refreshScheduler_);
     SAFE_DELETE(locationsModel_);
     SAFE_DELETE(networkDetectionManager_);
     SAFE_DELETE(downloadHelper_);
+    SAFE_DELETE(dohResolver_);
     SAFE_DELETE(networkAccessManager_);
+    EventLoopWatchdog::instance().unwatch(packetSizeControllerThread_);
+    EventLoopWatchdog::instance().unwatch(QThread::currentThread());
+    SettingsStore::instance().flush();
     isCleanupFinished_ = true;
     Q_EMIT cleanupFinished();
     qCDebug(LOG_BASIC) << "Cleanup finished";
@@ -1050,6 +1137,8 @@ void Engine::sendConfirmEmailImpl()
 void Engine::connectClickImpl(const LocationID &locationId)
 {
     locationId_ = locationId;
+    // the connection fetches its own config, don't load the API with the background requests
+    wireGuardConfigPrefetcher_->stop();
 
     // if connected, then first disconnect
     if (!connectionManager_->isDisconnected())
@@ -1113,10 +1202,29 @@ void Engine::sendDebugLogImpl()
     }
 #endif
 
+    qCDebug(LOG_BASIC) << "Event loops:" << qPrintable(EventLoopWatchdog::instance().summary());
+    if (locationsModel_)
+    {
+        locationsModel_->dumpPingLogDetails();
+    }
+    if (connectionManager_)
+    {
+        connectionManager_->writeConnectTimelineToLog();
+    }
+    // the process telemetry is Windows only, see processtelemetry_win.h
+#ifdef Q_OS_WIN
+    if (measurementCpuUsage_)
+    {
+        qCDebug(LOG_BASIC) << "Processes:" << qPrintable(measurementCpuUsage_->telemetrySummary());
+    }
+#endif
+
     QString log = MergeLog::mergePrevLogs(true);
     log += "================================================================================================================================================================================================\n";
     log += "================================================================================================================================================================================================\n";
     log += MergeLog::mergeLogs(true);
+    // one pass over the whole merged log for all the paths
+    log = Utils::cleanSensitiveInfo(log);
 
     /*
     // For testing merge log functionality
@@ -1140,6 +1248,33 @@ void Engine::getWebSessionTokenImpl(ProtoTypes::WebSessionPurpose purpose)
     serverAPI_->webSession(apiInfo_->getAuthHash(), userRole, true);
 }
 
+void Engine::startTunnelSpeedTestImpl()
+{
+    if (connectStateController_->currentState() != CONNECT_STATE_CONNECTED)
+    {
+        ProtoTypes::TunnelSpeedTestResult result;
+        result.set_error("not connected");
+        Q_EMIT tunnelSpeedTestFinished(result);
+        return;
+    }
+    if (tunnelSpeedTest_->isRunning())
+    {
+        return;
+    }
+
+    QString url = ExtraConfig::instance().getSpeedTestUrl();
+    if (url.isEmpty())
+    {
+        url = HardcodedSettings::instance().speedTestUrl();
+    }
+    tunnelSpeedTest_->start(url, connectionManager_->getVpnAdapterInfo().gateway());
+}
+
+void Engine::getThroughputHistoryImpl()
+{
+    Q_EMIT throughputHistory(throughputMeter_->history());
+}
+
 // function consists of two parts (first - disconnect if need, second - do other signout stuff)
 void Engine::signOutImpl(bool keepFirewallOn)
 {
@@ -1161,9 +1296,7 @@ void Engine::signOutImplAfterDisconnect(bool keepFirewallOn)
         SAFE_DELETE(loginController_);
         loginState_ = LOGIN_NONE;
     }
-    updateServerResourcesTimer_->stop();
-    updateSessionStatusTimer_->stop();
-    notificationsUpdateTimer_->stop();
+    refreshScheduler_->stopAll();
 
     locationsModel_->clear();
     prevSessionStatus_.clear();
@@ -1179,6 +1312,7 @@ void Engine::signOutImplAfterDisconnect(bool keepFirewallOn)
         apiInfo_.reset();
     }
     apiinfo::ApiInfo::removeFromSettings();
+    wireGuardConfigPrefetcher_->stop();
     GetWireGuardConfig::removeWireGuardSettings();
 
     if (!keepFirewallOn)
@@ -1407,6 +1541,7 @@ void Engine::onLoginControllerFinished(LOGIN_RET retCode, const apiinfo::ApiInfo
             getMyIPController_->getIPFromDisconnectedState(1);
         }
 
+        traceFirstServerLocations();
         apiInfo_.reset(new apiinfo::ApiInfo);
         *apiInfo_ = apiInfo;
         QString curRevisionHash = apiInfo_->getSessionStatus().getRevisionHash();
@@ -1428,8 +1563,9 @@ void Engine::onLoginControllerFinished(LOGIN_RET retCode, const apiinfo::ApiInfo
         updateServerLocations();
         updateSessionStatus();
         getNewNotifications();
-        notificationsUpdateTimer_->start(NOTIFICATIONS_UPDATE_PERIOD);
-        updateSessionStatusTimer_->start();
+        refreshScheduler_->start(RefreshScheduler::JOB_NOTIFICATIONS);
+        refreshScheduler_->start(RefreshScheduler::JOB_SESSION_STATUS);
+        refreshScheduler_->start(RefreshScheduler::JOB_SERVER_CREDENTIALS);
 
         if (!bFromConnectedToVPNState)
         {
@@ -1505,7 +1641,7 @@ void Engine::onReadyForNetworkRequests()
 {
     qCDebug(LOG_BASIC) << "Engine::onReadyForNetworkRequests()";
     serverAPI_->setRequestsEnabled(true);
-    updateServerResourcesTimer_->start(UPDATE_SERVER_RESOURCES_PERIOD);
+    refreshScheduler_->start(RefreshScheduler::JOB_SERVER_RESOURCES);
     checkForAppUpdate();
 
     if (connectionManager_->isDisconnected())
@@ -1514,7 +1650,8 @@ void Engine::onReadyForNetworkRequests()
     }
     else
     {
-        getMyIPController_->getIPFromConnectedState(1);
+        getMyIPController_->getIPFromConnectedState(1, connectionManager_->getLastConnectedIp(), connectionManager_->currentProtocol(),
+                                                    staticIpDeviceIdForCurrentConnection());
     }
 }
 
@@ -1531,6 +1668,7 @@ void Engine::onServerLocationsAnswer(SERVER_API_RET_CODE retCode, const QVector<
         {
             if (!serverLocations.isEmpty())
             {
+                traceFirstServerLocations();
                 apiInfo_->setLocations(serverLocations);
                 apiInfo_->setForceDisconnectNodes(forceDisconnectNodes);
                 updateServerLocations();
@@ -1756,6 +1894,8 @@ void Engine::onConnectionManagerConnected()
 {
     QString adapterName = connectionManager_->getVpnAdapterInfo().adapterName();
 
+    throughputMeter_->start();
+
 #ifdef Q_OS_WIN
     // wireguard-nt driver monitors metrics itself.
     if (!connectionManager_->currentProtocol().isWireGuardProtocol()) {
@@ -1875,7 +2015,8 @@ void Engine::onConnectionManagerConnected()
     locationsModel_->disableProxy();
 
     DnsServersConfiguration::instance().setDnsServersPolicy(DNS_TYPE_OS_DEFAULT);
-
+    // the OS default DNS servers are of the tunnel now
+    DnsResolver::instance().flushChannels();
 
     if (loginState_ == LOGIN_IN_PROGRESS)
     {
@@ -1901,15 +2042,33 @@ void Engine::onConnectionManagerConnected()
     connectStateController_->setConnectedState(locationId_);
 }
 
+void Engine::onConnectionManagerRoamed()
+{
+    // the new default adapter for the helper (routes) and the firewall, the tunnel itself is kept
+    helper_->sendConnectStatus(true, engineSettings_.isCloseTcpSockets(), engineSettings_.isAllowLanTraffic(),
+                               connectionManager_->getDefaultAdapterInfo(), connectionManager_->getCustomDnsAdapterGatewayInfo().adapterInfo,
+                               connectionManager_->getLastConnectedIp(), lastConnectingProtocol_);
+
+    if (firewallController_->firewallActualState())
+    {
+        firewallController_->firewallOn(firewallExceptions_.getIPAddressesForFirewallForConnectedState(connectionManager_->getLastConnectedIp()), engineSettings_.isAllowLanTraffic());
+    }
+}
+
 void Engine::onConnectionManagerDisconnected(DISCONNECT_REASON reason)
 {
     qCDebug(LOG_BASIC) << "on disconnected event";
 
+    tunnelSpeedTest_->abort("disconnected");
+    throughputMeter_->stop();
+
     if (connectionManager_->isStaticIpsLocation())
     {
         qCDebug(LOG_BASIC) << "the firewall rules are removed for static IPs location";
         firewallController_->deleteWhitelistPorts();
     }
+    // the OS default DNS servers are of the network again
+    DnsResolver::instance().flushChannels();
 
     // get sender source for additional actions in this handler
     QString senderSource;
@@ -1960,6 +2119,7 @@ void Engine::onConnectionManagerDisconnected(DISCONNECT_REASON reason)
             firewallController_->firewallOff();
             Q_EMIT firewallStateChanged(false);
         }
+        prefetchWireGuardConfigs();
     }
 
     connectStateController_->setDisconnectedState(reason, ProtoTypes::ConnectError::NO_CONNECT_ERROR);
@@ -2004,7 +2164,13 @@ void Engine::onConnectionManagerError(ProtoTypes::ConnectError err)
         else
         {
             // goto update server credentials and try connect again
-            if (refetchServerCredentialsHelper_ == NULL)
+            if (refetchServerCredentialsHelper_ != NULL && refetchServerCredentialsHelper_->property("background").isValid())
+            {
+                // the running background refresh continues with the connect
+                refetchServerCredentialsHelper_->setProperty("background", QVariant());
+                refetchServerCredentialsHelper_->setProperty("fromAuthError", true);
+            }
+            else if (refetchServerCredentialsHelper_ == NULL)
             {
                 // force update session status (for check blocked, banned account state)
                 serverAPI_->session(apiInfo_->getAuthHash(), serverApiUserRole_, true);
@@ -2121,9 +2287,19 @@ void Engine::onConnectionManagerProtocolPortChanged(const ProtoTypes::Protocol &
 void Engine::onConnectionManagerTestTunnelResult(bool success, const QString &ipAddress)
 {
     Q_EMIT testTunnelResult(success); // stops protocol/port flashing
+    if (success)
+    {
+        getMyIPController_->setTunnelIp(ipAddress, connectionManager_->getLastConnectedIp(), connectionManager_->currentProtocol(),
+                                        staticIpDeviceIdForCurrentConnection());
+    }
     Q_EMIT myIpUpdated(ipAddress, success, false); // sends IP address to UI // test should only occur in connected state
 }
 
+QString Engine::staticIpDeviceIdForCurrentConnection() const
+{
+    return connectionManager_->isStaticIpsLocation() ? GetDeviceId::instance().getDeviceId() : QString();
+}
+
 void Engine::onConnectionManagerWireGuardAtKeyLimit()
 {
     Q_EMIT wireGuardAtKeyLimit();
@@ -2196,7 +2372,10 @@ void Engine::detectAppropriatePacketSizeImpl()
             qCDebug(LOG_PACKET_SIZE) << "Detecting appropriate packet size";
             runningPacketDetection_ = true;
             Q_EMIT packetSizeDetectionStateChanged(true, false);
-            packetSizeController_->detectAppropriatePacketSize(serverAPI_->getHostname());
+            ProtoTypes::NetworkInterface networkInterface;
+            networkDetectionManager_->getCurrentNetworkInterface(networkInterface);
+            packetSizeController_->detectAppropriatePacketSize(serverAPI_->getHostname(),
+                                                               QString::fromStdString(networkInterface.network_or_ssid()));
         }
         else
         {
@@ -2224,9 +2403,7 @@ void Engine::updateVersionImpl(qint32 windowHandle)
 
     if (installerUrl_ != "")
     {
-        QMap<QString, QString> downloads;
-        downloads.insert(installerUrl_, downloadHelper_->downloadInstallerPath());
-        downloadHelper_->get(downloads);
+        downloadHelper_->getInstaller(installerUrl_, installerHash_);
     }
 }
 
@@ -2288,8 +2465,11 @@ void Engine::onDownloadHelperFinished(const DownloadHelper::DownloadState &state
         return;
     }
     qCDebug(LOG_AUTO_UPDATER) << "Installer signature valid";
+    downloadHelper_->keepInstallerForNextUpdate();
 #elif defined Q_OS_MAC
 
+    downloadHelper_->keepInstallerForNextUpdate();
+
     const QString tempInstallerFilename = autoUpdaterHelper_->copyInternalInstallerToTempFromDmg(installerPath_);
     QFile::remove(installerPath_);
 
@@ -2317,6 +2497,7 @@ void Engine::onDownloadHelperFinished(const DownloadHelper::DownloadState &state
         emit updateVersionChanged(0, ProtoTypes::UPDATE_VERSION_STATE_DONE, ProtoTypes::UPDATE_VERSION_ERROR_COMPARE_HASH_FAIL);
         return;
     }
+    downloadHelper_->keepInstallerForNextUpdate();
 #endif
 
     Q_EMIT updateVersionChanged(0, ProtoTypes::UPDATE_VERSION_STATE_RUNNING, ProtoTypes::UPDATE_VERSION_ERROR_NO_ERROR);
@@ -2419,14 +2600,30 @@ void Engine::onEmergencyControllerError(ProtoTypes::ConnectError err)
 void Engine::onRefetchServerCredentialsFinished(bool success, const apiinfo::ServerCredentials &serverCredentials, const QString &serverConfig)
 {
     bool bFromAuthError = refetchServerCredentialsHelper_->property("fromAuthError").isValid();
+    bool bBackground = refetchServerCredentialsHelper_->property("background").isValid();
     refetchServerCredentialsHelper_->deleteLater();
     refetchServerCredentialsHelper_ = NULL;
 
+    if (bBackground)
+    {
+        // the previous credentials and config stay in use if the refresh failed, they are refetched on the connect
+        // when they are not initialized only
+        if (success && !apiInfo_.isNull())
+        {
+            qCDebug(LOG_BASIC) << "Engine::onRefetchServerCredentialsFinished, background refresh successfully";
+            apiInfo_->setServerCredentialsAndOvpnConfig(serverCredentials, serverConfig);
+        }
+        else
+        {
+            qCDebug(LOG_BASIC) << "Engine::onRefetchServerCredentialsFinished, background refresh failed";
+        }
+        return;
+    }
+
     if (success)
     {
         qCDebug(LOG_BASIC) << "Engine::onRefetchServerCredentialsFinished, successfully";
-        apiInfo_->setServerCredentials(serverCredentials);
-        apiInfo_->setOvpnConfig(serverConfig);
+        apiInfo_->setServerCredentialsAndOvpnConfig(serverCredentials, serverConfig);
         doConnect(!bFromAuthError);
     }
     else
@@ -2437,6 +2634,19 @@ void Engine::onRefetchServerCredentialsFinished(bool success, const apiinfo::Ser
     }
 }
 
+void Engine::onServerCredentialsRefreshNeeded()
+{
+    if (apiInfo_.isNull() || refetchServerCredentialsHelper_ != NULL)
+    {
+        return;
+    }
+    qCDebug(LOG_BASIC) << "Refresh the server credentials and the ovpn config in the background";
+    refetchServerCredentialsHelper_ = new RefetchServerCredentialsHelper(this, apiInfo_->getAuthHash(), serverAPI_);
+    connect(refetchServerCredentialsHelper_, &RefetchServerCredentialsHelper::finished, this, &Engine::onRefetchServerCredentialsFinished);
+    refetchServerCredentialsHelper_->setProperty("background", true);
+    refetchServerCredentialsHelper_->startRefetch();
+}
+
 void Engine::getNewNotifications()
 {
     serverAPI_->notifications(apiInfo_->getAuthHash(), serverApiUserRole_, true);
@@ -2445,7 +2655,20 @@ void Engine::getNewNotifications()
 void Engine::onCustomConfigsChanged()
 {
     qCDebug(LOG_BASIC) << "Custom configs changed";
-    updateServerLocations();
+    // the API locations are not affected
+    const QVector<QSharedPointer<const customconfigs::ICustomConfig>> configs = customConfigs_->getConfigs();
+    locationsModel_->setCustomConfigLocations(configs);
+
+    // the hostnames of the remotes are resolved in the background, the connect doesn't wait for DNS then
+    QStringList hostnames;
+    for (const auto &config : configs)
+    {
+        if (config->isCorrect())
+        {
+            hostnames << config->hostnames();
+        }
+    }
+    HostnameResolveCache::instance().prefetch(hostnames);
 }
 
 void Engine::onLocationsModelWhitelistIpsChanged(const QStringList &ips)
@@ -2460,6 +2683,12 @@ void Engine::onLocationsModelWhitelistCustomConfigIpsChanged(const QStringList &
     updateFirewallSettings();
 }
 
+void Engine::onLocationsModelBestLocationUpdated(const LocationID &bestLocation)
+{
+    bestLocationId_ = bestLocation;
+    prefetchWireGuardConfigs();
+}
+
 void Engine::onNetworkOnlineStateChange(bool isOnline)
 {
     if (!isOnline && runningPacketDetection_)
@@ -2471,6 +2700,16 @@ void Engine::onNetworkOnlineStateChange(bool isOnline)
 
 void Engine::onNetworkChange(const ProtoTypes::NetworkInterface &networkInterface)
 {
+    const QString networkKey = QString::number(networkInterface.interface_index()) + "/" +
+                               QString::fromStdString(networkInterface.network_or_ssid());
+    if (ProxyServerController::instance().setNetwork(networkKey))
+    {
+        applyProxySettings();
+    }
+    DnsResolver::instance().flushChannels();
+    // the hostnames may resolve to other IPs on this network (split DNS, captive portals)
+    HostnameResolveCache::instance().clear();
+
     Q_EMIT networkChanged(networkInterface);
 }
 
@@ -2613,17 +2852,21 @@ void Engine::stopWifiSharingImpl()
 
 void Engine::applicationActivatedImpl()
 {
-    if (updateSessionStatusTimer_)
+    if (refreshScheduler_)
+    {
+        refreshScheduler_->applicationActivated();
+    }
+    if (connectionManager_)
     {
-        updateSessionStatusTimer_->applicationActivated();
+        connectionManager_->setApplicationActive(true);
     }
 }
 
 void Engine::applicationDeactivatedImpl()
 {
-    if (updateSessionStatusTimer_)
+    if (connectionManager_)
     {
-        updateSessionStatusTimer_->applicationDeactivated();
+        connectionManager_->setApplicationActive(false);
     }
 }
 
@@ -2636,8 +2879,19 @@ void Engine::setSettingsMacAddressSpoofingImpl(const ProtoTypes::MacAddrSpoofing
 void Engine::setSplitTunnelingSettingsImpl(bool isActive, bool isExclude, const QStringList &files, const QStringList &ips, const QStringList &hosts)
 {
     Q_ASSERT(helper_ != NULL);
+    // the duplicates and the overlapping IPv4 blocks are merged, so the backends add fewer routes and filters;
+    // IpSet keeps IPv4 only, the other entries (IPv6) are passed unchanged
+    IpSet ipv4Set;
+    QStringList otherIps;
+    for (const QString &ip : ips)
+    {
+        if (!ipv4Set.add(ip))
+        {
+            otherIps << ip;
+        }
+    }
     helper_->setSplitTunnelingSettings(isActive, isExclude, engineSettings_.isAllowLanTraffic(),
-                                       files, ips, hosts);
+                                       files, ipv4Set.toCidrList() + otherIps, hosts);
 }
 
 void Engine::startLoginController(const LoginSettings &loginSettings, bool bFromConnectedState)
@@ -2701,13 +2955,23 @@ void Engine::updateSessionStatus()
         if (prevSessionStatus_.getBillingPlanId() != ss.getBillingPlanId())
         {
             serverAPI_->notifications(apiInfo_->getAuthHash(), serverApiUserRole_, true);
-            notificationsUpdateTimer_->start(NOTIFICATIONS_UPDATE_PERIOD);
+            refreshScheduler_->start(RefreshScheduler::JOB_NOTIFICATIONS);
         }
 
         prevSessionStatus_ = ss;
     }
 }
 
+// the first locations from the server API (the login answer or serverLocations)
+void Engine::traceFirstServerLocations()
+{
+    if (!isFirstServerLocationsTraced_)
+    {
+        isFirstServerLocationsTraced_ = true;
+        TraceSpan::record("engine", "first server locations (from Engine::init)", initStartUs_);
+    }
+}
+
 void Engine::updateServerLocations()
 {
     qCDebug(LOG_BASIC) << "Servers locations changed";
@@ -2723,6 +2987,36 @@ void Engine::updateServerLocations()
     }
 }
 
+// while disconnected, fill the WireGuard config cache for the locations the user is likely to connect to next,
+// the best location and the last connected one
+void Engine::prefetchWireGuardConfigs()
+{
+    if (apiInfo_.isNull() || !connectionManager_->isDisconnected())
+    {
+        return;
+    }
+    if (!engineSettings_.connectionSettings().isAutomatic() && !engineSettings_.connectionSettings().protocol().isWireGuardProtocol())
+    {
+        return;
+    }
+
+    QStringList hostnames;
+    for (const LocationID &lid : { bestLocationId_, locationId_ })
+    {
+        if (!lid.isValid() || lid.isCustomConfigsLocation())
+        {
+            continue;
+        }
+        QSharedPointer<locationsmodel::MutableLocationInfo> mli =
+            qSharedPointerDynamicCast<locationsmodel::MutableLocationInfo>(locationsModel_->getMutableLocationInfoById(lid));
+        if (!mli.isNull() && mli->isExistSelectedNode())
+        {
+            hostnames << mli->getHostnameForSelectedNode();
+        }
+    }
+    wireGuardConfigPrefetcher_->prefetch(hostnames);
+}
+
 void Engine::updateFirewallSettings()
 {
     if (firewallController_->firewallActualState())
@@ -2788,10 +3082,7 @@ void Engine::doConnect(bool bEmitAuthError)
 {
     // before connect, update ICS sharing and wait for update ICS finished
     vpnShareController_->onConnectingOrConnectedToVPNEvent(OpenVpnVersionController::instance().isUseWinTun() ? "Windscribe Windtun420" : "Windscribe VPN");
-    while (vpnShareController_->isUpdateIcsInProgress())
-    {
-        QThread::msleep(1);
-    }
+    vpnShareController_->waitForUpdateIcsFinished();
 
     locationId_ = checkLocationIdExistingAndReturnNewIfNeed(locationId_);
 
@@ -2821,11 +3112,22 @@ void Engine::doConnect(bool bEmitAuthError)
 
     if (!apiInfo_.isNull())
     {
-        if ((!apiInfo_->getServerCredentials().isInitialized() || apiInfo_->ovpnConfigRefetchRequired()) && !locationId_.isCustomConfigsLocation())
+        // a stale config is still valid for the connect, it's refreshed in the background meanwhile
+        if (apiInfo_->getServerCredentials().isInitialized() && apiInfo_->ovpnConfigRefetchRequired() && !locationId_.isCustomConfigsLocation())
         {
-            qCDebug(LOG_BASIC) << "radius username/password empty or ovpn refetch config required, refetch server config and credentials";
+            onServerCredentialsRefreshNeeded();
+        }
 
-            if (refetchServerCredentialsHelper_ == NULL)
+        if (!apiInfo_->getServerCredentials().isInitialized() && !locationId_.isCustomConfigsLocation())
+        {
+            qCDebug(LOG_BASIC) << "radius username/password empty, refetch server config and credentials";
+
+            if (refetchServerCredentialsHelper_ != NULL)
+            {
+                // the connect waits for the running background refresh
+                refetchServerCredentialsHelper_->setProperty("background", QVariant());
+            }
+            else
             {
                 refetchServerCredentialsHelper_ = new RefetchServerCredentialsHelper(this, apiInfo_->getAuthHash(), serverAPI_);
                 connect(refetchServerCredentialsHelper_, &RefetchServerCredentialsHelper::finished, this, &Engine::onRefetchServerCredentialsFinished);
@@ -2943,15 +3245,24 @@ void Engine::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON /*reas
 
 void Engine::updateProxySettings()
 {
-    if (ProxyServerController::instance().updateProxySettings(engineSettings_.proxySettings())) {
-        const auto &proxySettings = ProxyServerController::instance().getCurrentProxySettings();
-        serverAPI_->setProxySettings(proxySettings);
-        locationsModel_->setProxySettings(proxySettings);
-        firewallExceptions_.setProxyIP(proxySettings);
-        updateFirewallSettings();
-        if (connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED)
-            getMyIPController_->getIPFromDisconnectedState(500);
-    }
+    if (ProxyServerController::instance().updateProxySettings(engineSettings_.proxySettings()))
+        applyProxySettings();
+}
+
+void Engine::onProxySettingsChanged()
+{
+    applyProxySettings();
+}
+
+void Engine::applyProxySettings()
+{
+    const auto &proxySettings = ProxyServerController::instance().getCurrentProxySettings();
+    serverAPI_->setProxySettings(proxySettings);
+    locationsModel_->setProxySettings(proxySettings);
+    firewallExceptions_.setProxyIP(proxySettings);
+    updateFirewallSettings();
+    if (connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED)
+        getMyIPController_->getIPFromDisconnectedState(500);
 }
 
 bool Engine::verifyContentsSha256(const QString &filename, const QString &compareHash)
@@ -16,8 +16,10 @@
 #include "engine/vpnshare/vpnsharecontroller.h"
 #include "engine/emergencycontroller/emergencycontroller.h"
 #include "getmyipcontroller.h"
+#include "wireguardconfig/wireguardconfigprefetcher.h"
 #include "enginesettings.h"
-#include "sessionstatustimer.h"
+#include "refreshscheduler.h"
+#include "inittaskgraph.h"
 #include "engine/customconfigs/customconfigs.h"
 #include "engine/customconfigs/customovpnauthcredentialsstorage.h"
 #include <atomic>
@@ -27,6 +29,10 @@
 #include "autoupdater/downloadhelper.h"
 #include "autoupdater/autoupdaterhelper_mac.h"
 #include "networkaccessmanager/networkaccessmanager.h"
+#include "dnsresolver/dohresolver.h"
+#include "connectionmanager/tunnelspeedtest.h"
+#include "connectionmanager/throughputmeter.h"
+#include "metricsserver.h"
 
 #ifdef Q_OS_WIN
     #include "measurementcpuusage.h"
@@ -65,6 +71,8 @@ public:
     void setIPv6EnabledInOS(bool b);
     bool IPv6StateInOS();
     void getWebSessionToken(ProtoTypes::WebSessionPurpose purpose);
+    void startTunnelSpeedTest();
+    void getThroughputHistory();
 
     LoginSettings getLastLoginSettings();
     QString getAuthHash();
@@ -141,6 +149,8 @@ signals:
     void updateVersionChanged(uint progressPercent, const ProtoTypes::UpdateVersionState &state, const ProtoTypes::UpdateVersionError &error);
     void myIpUpdated(const QString &ip, bool success, bool isDisconnected);
     void statisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+    void throughputUpdated(const ProtoTypes::Throughput &throughput);
+    void throughputHistory(const ProtoTypes::ThroughputHistory &history);
     void protocolPortChanged(const ProtoTypes::Protocol &protocol, const uint port);
 
     void requestUsername();
@@ -153,6 +163,7 @@ signals:
     void sendDebugLogFinished(bool bSuccess);
     void confirmEmailFinished(bool bSuccess);
     void webSessionToken(ProtoTypes::WebSessionPurpose purpose, const QString &tempSessionToken);
+    void tunnelSpeedTestFinished(const ProtoTypes::TunnelSpeedTestResult &result);
     void firewallStateChanged(bool isEnabled);
     void testTunnelResult(bool bSuccess);
     void lostConnectionToHelper();
@@ -160,6 +171,7 @@ signals:
     void wifiSharingStateChanged(bool bEnabled, const QString &ssid);
     void vpnSharingConnectedWifiUsersCountChanged(int usersCount);
     void vpnSharingConnectedProxyUsersCountChanged(int usersCount);
+    void vpnSharingProxyTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic);
 
     void signOutFinished();
 
@@ -184,6 +196,7 @@ signals:
 private slots:
     void onLostConnectionToHelper();
     void onInitializeHelper(INIT_HELPER_RET ret);
+    void onInitTasksFinished();
 
     void cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool isFirewallAlwaysOn, bool isLaunchOnStart);
     void clearCredentialsImpl();
@@ -196,6 +209,8 @@ private slots:
     void disconnectClickImpl();
     void sendDebugLogImpl();
     void getWebSessionTokenImpl(ProtoTypes::WebSessionPurpose purpose);
+    void startTunnelSpeedTestImpl();
+    void getThroughputHistoryImpl();
     void signOutImpl(bool keepFirewallOn);
     void signOutImplAfterDisconnect(bool keepFirewallOn);
     void continueWithUsernameAndPasswordImpl(const QString &username, const QString &password, bool bSave);
@@ -251,6 +266,7 @@ private slots:
     void onUpdateSessionStatusTimer();
 
     void onConnectionManagerConnected();
+    void onConnectionManagerRoamed();
     void onConnectionManagerDisconnected(DISCONNECT_REASON reason);
     void onConnectionManagerReconnecting();
     void onConnectionManagerError(ProtoTypes::ConnectError err);
@@ -283,6 +299,7 @@ private slots:
     void onEmergencyControllerError(ProtoTypes::ConnectError err);
 
     void onRefetchServerCredentialsFinished(bool success, const apiinfo::ServerCredentials &serverCredentials, const QString &serverConfig);
+    void onServerCredentialsRefreshNeeded();
 
     void getNewNotifications();
 
@@ -290,9 +307,11 @@ private slots:
 
     void onLocationsModelWhitelistIpsChanged(const QStringList &ips);
     void onLocationsModelWhitelistCustomConfigIpsChanged(const QStringList &ips);
+    void onLocationsModelBestLocationUpdated(const LocationID &bestLocation);
 
     void onNetworkOnlineStateChange(bool isOnline);
     void onNetworkChange(const ProtoTypes::NetworkInterface &networkInterface);
+    void onProxySettingsChanged();
     void onPacketSizeControllerPacketSizeChanged(bool isAuto, int mtu);
     void onPacketSizeControllerFinishedSizeDetection(bool isError);
 
@@ -315,12 +334,15 @@ private slots:
 private:
     void initPart2();
     void updateProxySettings();
+    void applyProxySettings();
+    QString staticIpDeviceIdForCurrentConnection() const;
     bool verifyContentsSha256(const QString &filename, const QString &compareHash);
 
     EngineSettings engineSettings_;
     IHelper *helper_;
     FirewallController *firewallController_;
     NetworkAccessManager *networkAccessManager_;
+    DohResolver *dohResolver_;
     ServerAPI *serverAPI_;
     ConnectionManager *connectionManager_;
     ConnectStateController *connectStateController_;
@@ -328,6 +350,7 @@ private:
     uint serverApiEditAccountDetailsUserRole_;
     uint serverApiAddEmailUserRole_;
     GetMyIPController *getMyIPController_;
+    WireGuardConfigPrefetcher *wireGuardConfigPrefetcher_;
     VpnShareController *vpnShareController_;
     EmergencyController *emergencyController_;
     ConnectStateController *emergencyConnectStateController_;
@@ -336,6 +359,9 @@ private:
     INetworkDetectionManager *networkDetectionManager_;
     IMacAddressController *macAddressController_;
     KeepAliveManager *keepAliveManager_;
+    TunnelSpeedTest *tunnelSpeedTest_;
+    ThroughputMeter *throughputMeter_;
+    MetricsServer *metricsServer_;
     PacketSizeController *packetSizeController_;
 
 #ifdef Q_OS_WIN
@@ -343,7 +369,11 @@ private:
 #endif
 
     InitializeHelper *inititalizeHelper_;
+    InitTaskGraph *initTaskGraph_;
+    ProtoTypes::NetworkInterfaces initNetworkInterfaces_;   // read on the thread pool during the init
     bool bInitialized_;
+    qint64 initStartUs_;                    // for the startup timeline
+    bool isFirstServerLocationsTraced_;
 
     QScopedPointer<apiinfo::ApiInfo> apiInfo_;
     LoginController *loginController_;
@@ -354,9 +384,7 @@ private:
     LoginSettings loginSettings_;
     QMutex loginSettingsMutex_;
 
-    QTimer *updateServerResourcesTimer_;
-    SessionStatusTimer *updateSessionStatusTimer_;
-    QTimer *notificationsUpdateTimer_;
+    RefreshScheduler *refreshScheduler_;
 
     locationsmodel::LocationsModel *locationsModel_;
 
@@ -379,6 +407,7 @@ private:
 
     LocationID locationId_;
     QString locationName_;
+    LocationID bestLocationId_;
 
     QString lastConnectingHostname_;
     ProtoTypes::Protocol lastConnectingProtocol_;
@@ -391,12 +420,11 @@ private:
     QThread *packetSizeControllerThread_;
     bool runningPacketDetection_;
 
-    enum {UPDATE_SERVER_RESOURCES_PERIOD = 24 * 60 * 60 * 1000}; // 24 hours
-    enum {NOTIFICATIONS_UPDATE_PERIOD = 60 * 60 * 1000}; // 1 hour
-
     void startLoginController(const LoginSettings &loginSettings, bool bFromConnectedState);
     void updateSessionStatus();
     void updateServerLocations();
+    void prefetchWireGuardConfigs();
+    void traceFirstServerLocations();
     void updateFirewallSettings();
 
     void addCustomRemoteIpToFirewallIfNeed();
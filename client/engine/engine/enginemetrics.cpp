@@ -0,0 +1,114 @@
+#include "enginemetrics.h"
+
+constexpr double EngineMetrics::BUCKET_LIMITS_MS[];
+
+void EngineMetrics::addCount(const char *name, const QString &labelName, const QString &labelValue, quint64 delta)
+{
+    if (!isEnabled_)
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    series(name, TYPE_COUNTER, labelName, labelValue).value += delta;
+}
+
+void EngineMetrics::setCount(const char *name, double value, const QString &labelName, const QString &labelValue)
+{
+    if (!isEnabled_)
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    series(name, TYPE_COUNTER, labelName, labelValue).value = value;
+}
+
+void EngineMetrics::setGauge(const char *name, double value, const QString &labelName, const QString &labelValue)
+{
+    if (!isEnabled_)
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    series(name, TYPE_GAUGE, labelName, labelValue).value = value;
+}
+
+void EngineMetrics::observeMs(const char *name, double ms, const QString &labelName, const QString &labelValue)
+{
+    if (!isEnabled_)
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    Histogram &h = series(name, TYPE_HISTOGRAM, labelName, labelValue).histogram;
+    int bucket = 0;
+    while (bucket < BUCKETS_COUNT && ms > BUCKET_LIMITS_MS[bucket])
+    {
+        bucket++;
+    }
+    h.buckets[bucket]++;
+    h.count++;
+    h.sum += ms;
+}
+
+QByteArray EngineMetrics::toPrometheusText() const
+{
+    QMutexLocker locker(&mutex_);
+
+    QByteArray out;
+    for (auto it = metrics_.constBegin(); it != metrics_.constEnd(); ++it)
+    {
+        const QByteArray name = it.key().toLatin1();
+        const Metric &metric = it.value();
+        static const char *TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+        out += "# TYPE " + name + " " + TYPE_NAMES[metric.type] + "\n";
+
+        for (const Series &s : metric.series)
+        {
+            if (metric.type != TYPE_HISTOGRAM)
+            {
+                out += name + s.labels.toUtf8() + " " + QByteArray::number(s.value, 'g', 15) + "\n";
+                continue;
+            }
+            // the buckets are cumulative in the format
+            quint64 cumulative = 0;
+            for (int i = 0; i <= BUCKETS_COUNT; ++i)
+            {
+                cumulative += s.histogram.buckets[i];
+                const QString le = i < BUCKETS_COUNT ? QString::number(BUCKET_LIMITS_MS[i]) : QString("+Inf");
+                out += name + "_bucket" + labelsWithBucket(s.labels, le).toUtf8() + " " + QByteArray::number(cumulative) + "\n";
+            }
+            out += name + "_sum" + s.labels.toUtf8() + " " + QByteArray::number(s.histogram.sum, 'f', 3) + "\n";
+            out += name + "_count" + s.labels.toUtf8() + " " + QByteArray::number(s.histogram.count) + "\n";
+        }
+    }
+    return out;
+}
+
+EngineMetrics::Series &EngineMetrics::series(const char *name, TYPE type, const QString &labelName, const QString &labelValue)
+{
+    Metric &metric = metrics_[QLatin1String(name)];
+    metric.type = type;
+    QString labels;
+    if (!labelName.isEmpty())
+    {
+        QString value = labelValue;
+        value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+        labels = labelName + "=\"" + value + "\"";
+    }
+    Series &s = metric.series[labels];
+    if (!labels.isEmpty() && s.labels.isEmpty())
+    {
+        s.labels = "{" + labels + "}";
+    }
+    return s;
+}
+
+QString EngineMetrics::labelsWithBucket(const QString &labels, const QString &le)
+{
+    const QString leLabel = "le=\"" + le + "\"";
+    if (labels.isEmpty())
+    {
+        return "{" + leLabel + "}";
+    }
+    return labels.left(labels.length() - 1) + "," + leLabel + "}";
+}
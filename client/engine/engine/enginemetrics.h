@@ -0,0 +1,72 @@
+#ifndef ENGINEMETRICS_H
+#define ENGINEMETRICS_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// The counters, gauges and latency histograms of the engine for the local metrics endpoint (see MetricsServer).
+// A series is the metric name with an optional label, e.g. ("windscribe_connect_stage_ms", "stage", "handshake").
+// The histograms have the fixed buckets in ms. Thread-safe. Nothing is recorded until setEnabled(true) (done when
+// the endpoint starts), the callers building the labels on hot paths check isEnabled() first.
+// toPrometheusText() gives the Prometheus text exposition format.
+class EngineMetrics
+{
+public:
+    static EngineMetrics &instance()
+    {
+        static EngineMetrics em;
+        return em;
+    }
+
+    void setEnabled(bool isEnabled) { isEnabled_ = isEnabled; }
+    bool isEnabled() const { return isEnabled_; }
+
+    void addCount(const char *name, const QString &labelName = QString(), const QString &labelValue = QString(), quint64 delta = 1);
+    // for the counters kept elsewhere (e.g. IPC::CommandStats), copied before the scrape
+    void setCount(const char *name, double value, const QString &labelName = QString(), const QString &labelValue = QString());
+    void setGauge(const char *name, double value, const QString &labelName = QString(), const QString &labelValue = QString());
+    void observeMs(const char *name, double ms, const QString &labelName = QString(), const QString &labelValue = QString());
+
+    QByteArray toPrometheusText() const;
+
+private:
+    EngineMetrics() : isEnabled_(false) {}
+
+    static constexpr int BUCKETS_COUNT = 10;
+    static constexpr double BUCKET_LIMITS_MS[BUCKETS_COUNT] = { 5, 10, 25, 50, 100, 250, 500, 1000, 5000, 10000 };
+
+    struct Histogram
+    {
+        quint64 buckets[BUCKETS_COUNT + 1] = {};    // the last one is +Inf
+        quint64 count = 0;
+        double sum = 0;
+    };
+
+    enum TYPE { TYPE_COUNTER, TYPE_GAUGE, TYPE_HISTOGRAM };
+
+    struct Series
+    {
+        QString labels;     // {name="value"} or empty
+        double value = 0;
+        Histogram histogram;
+    };
+
+    struct Metric
+    {
+        TYPE type;
+        QMap<QString, Series> series;
+    };
+
+    std::atomic<bool> isEnabled_;
+    mutable QMutex mutex_;
+    QMap<QString, Metric> metrics_;
+
+    Series &series(const char *name, TYPE type, const QString &labelName, const QString &labelValue);
+    static QString labelsWithBucket(const QString &labels, const QString &le);
+};
+
+#endif // ENGINEMETRICS_H
@@ -1,11 +1,12 @@
 #include "enginesettings.h"
 #include "ipc/protobufcommand.h"
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 #include "utils/winutils.h"
 
 const int typeIdEngineSettings = qRegisterMetaType<EngineSettings>("EngineSettings");
 
-EngineSettings::EngineSettings() : simpleCrypt_(0x4572A4ACF31A31BA)
+EngineSettings::EngineSettings() : crypt_(0x4572A4ACF31A31BA)
 {
 #if defined(Q_OS_LINUX)
     repairEngineSettings();
@@ -14,7 +15,7 @@ EngineSettings::EngineSettings() : simpleCrypt_(0x4572A4ACF31A31BA)
 
 EngineSettings::EngineSettings(const ProtoTypes::EngineSettings &s) :
     engineSettings_(s)
-  , simpleCrypt_(0x4572A4ACF31A31BA)
+  , crypt_(0x4572A4ACF31A31BA)
 {
 #if defined(Q_OS_LINUX)
     repairEngineSettings();
@@ -23,19 +24,17 @@ EngineSettings::EngineSettings(const ProtoTypes::EngineSettings &s) :
 
 void EngineSettings::saveToSettings()
 {
-    QSettings settings;
-
     size_t size = engineSettings_.ByteSizeLong();
     QByteArray arr(size, Qt::Uninitialized);
     engineSettings_.SerializeToArray(arr.data(), size);
 
     // Changed engineSettings to engineSettings2 when settings enrcyption was added.
-    settings.setValue("engineSettings2", simpleCrypt_.encryptToString(arr));
+    SettingsStore::instance().setValue("engineSettings2", crypt_.encryptToString(arr));
 }
 
 void EngineSettings::loadFromSettings()
 {
-    QSettings settings;
+    SettingsStore &settings = SettingsStore::instance();
 
     const bool containsEncryptedSettings = settings.contains("engineSettings2");
     const bool containsSettings = settings.contains("engineSettings");
@@ -46,7 +45,7 @@ void EngineSettings::loadFromSettings()
             qCDebug(LOG_BASIC) << "EngineSettings::loadFromSettings Engine Settings are encrypted. Decrypting Engine Settings...";
 
             const QString s = settings.value("engineSettings2", "").toString();
-            const QByteArray arr = simpleCrypt_.decryptToByteArray(s);
+            const QByteArray arr = crypt_.decryptToByteArray(s);
 
             if (!engineSettings_.ParseFromArray(arr.data(), arr.size()))
             {
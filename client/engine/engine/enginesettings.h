@@ -8,7 +8,7 @@
 #include "engine/types/dnsresolutionsettings.h"
 #include "engine/proxy/proxysettings.h"
 #include "ipc/command.h"
-#include "utils/simplecrypt.h"
+#include "utils/aesgcmcrypt.h"
 
 class EngineSettings
 {
@@ -52,7 +52,7 @@ public:
 private:
     ProtoTypes::EngineSettings engineSettings_;
 
-    SimpleCrypt simpleCrypt_;
+    AesGcmCrypt crypt_;
 
     void loadFromVersion1();
 
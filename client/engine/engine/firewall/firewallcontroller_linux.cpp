@@ -1,13 +1,16 @@
 #include "firewallcontroller_linux.h"
 #include <QStandardPaths>
 #include "utils/logger.h"
+#include "utils/lanranges.h"
 #include "utils/utils.h"
 #include <QDir>
 #include "engine/helper/ihelper.h"
+#include "firewallexceptions.h"
 
 FirewallController_linux::FirewallController_linux(QObject *parent, IHelper *helper) :
     FirewallController(parent), forceUpdateInterfaceToSkip_(false), mutex_(QMutex::Recursive),
-    comment_("\"Windscribe client rule\"")
+    comment_("\"Windscribe client rule\""), nftState_(NFT_UNKNOWN), isNftTableApplied_(false),
+    nftAppliedAllowLanTraffic_(false)
 {
     helper_ = dynamic_cast<Helper_linux *>(helper);
 
@@ -50,6 +53,11 @@ bool FirewallController_linux::firewallOff()
         QString cmd;
         int exitCode;
 
+        if (isNftAvailable())
+        {
+            firewallOffNft();
+            return true;
+        }
 
         // remove IPv4 rules
         removeWindscribeRules(comment_, false);
@@ -87,8 +95,15 @@ bool FirewallController_linux::firewallActualState()
         return false;
     }
 
-    int exitCode;
-    helper_->executeRootCommand("iptables --check INPUT -j windscribe_input -m comment --comment " + comment_ + " 2>&-", &exitCode);
+    int exitCode = -1;
+    if (isNftAvailable())
+    {
+        helper_->executeRootCommand("nft list chain inet windscribe input > /dev/null 2>&-", &exitCode);
+    }
+    else
+    {
+        helper_->executeRootCommand("iptables --check INPUT -j windscribe_input -m comment --comment " + comment_ + " 2>&-", &exitCode);
+    }
     return exitCode == 0;
 }
 
@@ -126,6 +141,11 @@ bool FirewallController_linux::firewallOnImpl(const QString &ip, bool bAllowLanT
 
     forceUpdateInterfaceToSkip_ = false;
 
+    if (isNftAvailable())
+    {
+        return firewallOnNft(ip, bAllowLanTraffic);
+    }
+
     // rules for IPv4
     {
         QFile file(pathToTempTable_);
@@ -149,30 +169,29 @@ bool FirewallController_linux::firewallOnImpl(const QString &ip, bool bAllowLanT
                 stream << "-A windscribe_output -o " + interfaceToSkip_ + " -j ACCEPT -m comment --comment " + comment_ + "\n";
             }
 
-            const QStringList ips = ip.split(';');
+            // single addresses and CIDR blocks
+            const QStringList ips = ip.split(';', QString::SkipEmptyParts);
             for (auto &i : ips)
             {
-                stream << "-A windscribe_input -s " + i + "/32 -j ACCEPT -m comment --comment " + comment_ + "\n";
-                stream << "-A windscribe_output -d " + i + "/32 -j ACCEPT -m comment --comment " + comment_ + "\n";
+                const QString block = i.contains('/') ? i : i + "/32";
+                stream << "-A windscribe_input -s " + block + " -j ACCEPT -m comment --comment " + comment_ + "\n";
+                stream << "-A windscribe_output -d " + block + " -j ACCEPT -m comment --comment " + comment_ + "\n";
             }
 
             if (bAllowLanTraffic)
             {
                 // Local Network
-                stream << "-A windscribe_input -s 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_ + "\n";
-                stream << "-A windscribe_output -d 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_ + "\n";
-
-                stream << "-A windscribe_input -s 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_ + "\n";
-                stream << "-A windscribe_output -d 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_ + "\n";
-
-                stream << "-A windscribe_input -s 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
-                stream << "-A windscribe_output -d 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
-
-                // Loopback addresses to the local host
-                stream << "-A windscribe_input -s 127.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
+                for (const QString &block : LanRanges::privateNetworks())
+                {
+                    stream << "-A windscribe_input -s " + block + " -j ACCEPT -m comment --comment " + comment_ + "\n";
+                    stream << "-A windscribe_output -d " + block + " -j ACCEPT -m comment --comment " + comment_ + "\n";
+                }
 
-                // Multicast addresses
-                stream << "-A windscribe_input -s 224.0.0.0/4 -j ACCEPT -m comment --comment " + comment_ + "\n";
+                // Loopback addresses to the local host, multicast addresses
+                for (const QString &block : LanRanges::inboundExtras())
+                {
+                    stream << "-A windscribe_input -s " + block + " -j ACCEPT -m comment --comment " + comment_ + "\n";
+                }
             }
 
             stream << "-A windscribe_input -j DROP -m comment --comment " + comment_ + "\n";
@@ -352,3 +371,171 @@ void FirewallController_linux::removeWindscribeRules(const QString &comment, boo
         QFile::remove(pathToTempTable_);
     }
 }
+
+bool FirewallController_linux::isNftAvailable()
+{
+    if (nftState_ == NFT_UNKNOWN && helper_->currentState() == IHelper::STATE_CONNECTED)
+    {
+        int exitCode = -1;
+        helper_->executeRootCommand("nft list tables > /dev/null 2>&-", &exitCode);
+        nftState_ = (exitCode == 0) ? NFT_AVAILABLE : NFT_UNAVAILABLE;
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "nftables" << (nftState_ == NFT_AVAILABLE ? "available" : "unavailable, use iptables");
+        if (nftState_ == NFT_AVAILABLE)
+        {
+            // the rules of the previous versions
+            removeWindscribeRules(comment_, false);
+            removeWindscribeRules(comment_, true);
+        }
+    }
+    return nftState_ == NFT_AVAILABLE;
+}
+
+bool FirewallController_linux::firewallOnNft(const QString &ip, bool bAllowLanTraffic)
+{
+    const QStringList ips = ip.split(';', QString::SkipEmptyParts);
+    const QString fullScript = nftTableScript(ips, bAllowLanTraffic);
+
+    bool bSuccess;
+    if (isNftTableApplied_ && nftAppliedInterfaceToSkip_ == interfaceToSkip_ && nftAppliedAllowLanTraffic_ == bAllowLanTraffic)
+    {
+        const FirewallExceptions::Diff diff = FirewallExceptions::diff(nftAppliedIps_, ips);
+        if (diff.isEmpty())
+        {
+            return true;
+        }
+        // the removed elements go first, the added ones may cover their addresses
+        QString script;
+        if (!diff.removed.isEmpty())
+        {
+            script += "delete element inet windscribe allowed_ips { " + diff.removed.join(", ") + " }\n";
+        }
+        if (!diff.added.isEmpty())
+        {
+            script += "add element inet windscribe allowed_ips { " + diff.added.join(", ") + " }\n";
+        }
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "nft set update: added" << diff.added.count() << ", removed" << diff.removed.count();
+        bSuccess = executeNftScript(script);
+    }
+    else
+    {
+        bSuccess = executeNftScript(fullScript);
+    }
+
+    isNftTableApplied_ = bSuccess;
+    nftAppliedInterfaceToSkip_ = interfaceToSkip_;
+    nftAppliedAllowLanTraffic_ = bAllowLanTraffic;
+    nftAppliedIps_ = ips;
+    if (!bSuccess)
+    {
+        return false;
+    }
+
+    // save the table to /etc/windscribe directory to make it restorable on OS boot with windscribe-helper
+    QFile file(pathToTempTable_);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(fullScript.toUtf8());
+        file.close();
+        int exitCode;
+        QString cmd = "cp " + pathToTempTable_ + " /etc/windscribe/rules.nft";
+        helper_->executeRootCommand(cmd, &exitCode);
+        if (exitCode != 0)
+        {
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+        }
+        file.remove();
+    }
+    return true;
+}
+
+void FirewallController_linux::firewallOffNft()
+{
+    isNftTableApplied_ = false;
+    nftAppliedIps_.clear();
+
+    const QStringList cmds = { "nft delete table inet windscribe 2>&-", "rm -f /etc/windscribe/rules.nft",
+                               "rm -f /etc/windscribe/rules.v4", "rm -f /etc/windscribe/rules.v6" };
+    for (const QString &cmd : cmds)
+    {
+        int exitCode;
+        helper_->executeRootCommand(cmd, &exitCode);
+        if (exitCode != 0)
+        {
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+        }
+    }
+}
+
+QString FirewallController_linux::nftTableScript(const QStringList &ips, bool bAllowLanTraffic) const
+{
+    // the same rules as for iptables: IPv6 is disabled, IPv4 is allowed to the loopback, the interface to skip, the IPs
+    // and the local network; "table" + "delete table" replaces the table in the same transaction
+    QString rules;
+    rules += "        meta nfproto ipv6 drop\n";
+    rules += "        %1 lo accept\n";
+    if (!interfaceToSkip_.isEmpty())
+    {
+        rules += "        %1name \"" + interfaceToSkip_ + "\" accept\n";
+    }
+    rules += "        ip %2 @allowed_ips accept\n";
+    if (bAllowLanTraffic)
+    {
+        rules += "        ip %2 { " + LanRanges::privateNetworks().join(", ") + " } accept\n";
+    }
+
+    QString inputRules = rules.arg("iif", "saddr");
+    if (bAllowLanTraffic)
+    {
+        // loopback addresses to the local host, multicast addresses
+        inputRules += "        ip saddr { " + LanRanges::inboundExtras().join(", ") + " } accept\n";
+    }
+    const QString outputRules = rules.arg("oif", "daddr");
+
+    QString script;
+    script += "table inet windscribe\n";
+    script += "delete table inet windscribe\n";
+    script += "table inet windscribe {\n";
+    script += "    set allowed_ips {\n";
+    script += "        type ipv4_addr\n";
+    script += "        flags interval\n";
+    if (!ips.isEmpty())
+    {
+        script += "        elements = { " + ips.join(", ") + " }\n";
+    }
+    script += "    }\n";
+    script += "    chain input {\n";
+    script += "        type filter hook input priority 0; policy accept;\n";
+    script += inputRules;
+    script += "        drop\n";
+    script += "    }\n";
+    script += "    chain output {\n";
+    script += "        type filter hook output priority 0; policy accept;\n";
+    script += outputRules;
+    script += "        drop\n";
+    script += "    }\n";
+    script += "}\n";
+    return script;
+}
+
+bool FirewallController_linux::executeNftScript(const QString &script)
+{
+    QFile file(pathToTempTable_);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't create file:" << pathToTempTable_;
+        return false;
+    }
+    file.write(script.toUtf8());
+    file.close();
+
+    int exitCode = -1;
+    QString cmd = "nft -f " + pathToTempTable_;
+    helper_->executeRootCommand(cmd, &exitCode);
+    file.remove();
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+        return false;
+    }
+    return true;
+}
@@ -30,9 +30,26 @@ private:
     QString pathToTempTable_;
     QString comment_;
 
+    // If nftables is available, the rules are in the own table "inet windscribe" (IPv4 and IPv6), applied with one
+    // atomic "nft -f" transaction; when only the IPs change, only the changed elements of the set of the allowed IPs
+    // are deleted and added.
+    // Otherwise the iptables rules below are used.
+    enum NFT_STATE { NFT_UNKNOWN, NFT_AVAILABLE, NFT_UNAVAILABLE };
+    NFT_STATE nftState_;
+    bool isNftTableApplied_;
+    QString nftAppliedInterfaceToSkip_;
+    bool nftAppliedAllowLanTraffic_;
+    QStringList nftAppliedIps_;
+
     bool firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
     QStringList getWindscribeRules(const QString &comment, bool modifyForDelete, bool isIPv6);
     void removeWindscribeRules(const QString &comment, bool isIPv6);
+
+    bool isNftAvailable();
+    bool firewallOnNft(const QString &ip, bool bAllowLanTraffic);
+    void firewallOffNft();
+    QString nftTableScript(const QStringList &ips, bool bAllowLanTraffic) const;
+    bool executeNftScript(const QString &script);
 };
 
 #endif // FIREWALLCONTROLLER_LINUX_H
@@ -1,11 +1,14 @@
 #include "firewallcontroller_mac.h"
 #include <QStandardPaths>
+#include "utils/lanranges.h"
 #include "utils/logger.h"
 #include <QDir>
 #include <QCoreApplication>
+#include "firewallexceptions.h"
 
 FirewallController_mac::FirewallController_mac(QObject *parent, IHelper *helper) :
-    FirewallController(parent), forceUpdateInterfaceToSkip_(false)
+    FirewallController(parent), forceUpdateInterfaceToSkip_(false), isRulesetApplied_(false),
+    appliedAllowLanTraffic_(false)
 {
     helper_ = dynamic_cast<Helper_mac *>(helper);
 }
@@ -47,8 +50,12 @@ bool FirewallController_mac::firewallOff()
         str = helper_->executeRootCommand("pfctl -d");
         qCDebug(LOG_FIREWALL_CONTROLLER) << "Output from disable firewall command: " << str;
 
-        // force delete the table "windscribe_ips"
+        // the anchor is not referenced by /etc/pf.conf, remove its rules and the table "windscribe_ips"
+        str = helper_->executeRootCommand("pfctl -a windscribe -F all");
+        // the table of the main ruleset of the previous versions
         str = helper_->executeRootCommand("pfctl -t windscribe_ips -T kill");
+        isRulesetApplied_ = false;
+        appliedIps_.clear();
 
         str = helper_->executeRootCommand("pfctl -si");
         qCDebug(LOG_FIREWALL_CONTROLLER) << "Output from status firewall command: " << str;
@@ -72,21 +79,11 @@ bool FirewallController_mac::firewallActualState()
     }
 
     // Additionally check the table "windscribe_ips", which will indicate that the firewall is enabled by our program.
-    QString tableReport = helper_->executeRootCommand("pfctl -t windscribe_ips -T show");
-    if (tableReport.isEmpty())
-    {
-        return false;
-    }
-
-    QString report = helper_->executeRootCommand("pfctl -si");
-    if (report.indexOf("Status: Enabled") != -1)
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    // Both checks in one command, the output is the two counts.
+    const QString report = helper_->executeRootCommand(
+        "pfctl -si 2>/dev/null | grep -c \"Status: Enabled\"; pfctl -a windscribe -t windscribe_ips -T show 2>/dev/null | wc -l");
+    const QStringList counts = report.simplified().split(' ');
+    return counts.size() == 2 && counts[0].toInt() > 0 && counts[1].toInt() > 0;
 }
 
 bool FirewallController_mac::whitelistPorts(const apiinfo::StaticIpPortsVector &ports)
@@ -110,14 +107,79 @@ bool FirewallController_mac::deleteWhitelistPorts()
 
 bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports )
 {
-    QString pfConfigFilePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    QDir dir(pfConfigFilePath);
-    dir.mkpath(pfConfigFilePath);
-    pfConfigFilePath += "/pf.conf";
-    qCDebug(LOG_BASIC) << pfConfigFilePath;
+    const QString dataPath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+    QDir dir(dataPath);
+    dir.mkpath(dataPath);
+    const QString pfConfigFilePath = dataPath + "/pf.conf";
+    const QString anchorFilePath = dataPath + "/pf_windscribe.conf";
+    const QString ipsFilePath = dataPath + "/pf_windscribe_ips.txt";
 
     forceUpdateInterfaceToSkip_ = false;
 
+    // the files are always kept up to date, enableFirewallOnBoot loads them at startup
+    const QStringList ips = ip.split(';', QString::SkipEmptyParts);
+    if (!writeFile(pfConfigFilePath, mainRuleset(anchorFilePath)) ||
+        !writeFile(anchorFilePath, anchorRules(ipsFilePath, bAllowLanTraffic, ports)) ||
+        !writeFile(ipsFilePath, ips.join("\n") + "\n"))
+    {
+        return false;
+    }
+
+    if (!isRulesetApplied_ || appliedInterfaceToSkip_ != interfaceToSkip_)
+    {
+        // Note:
+        // Be careful adding '-F all' to this command to fix an issue.  Adding it will prevent the
+        // OpenVPN over TCP and Stealth protocols from completing their connection setup.
+        QString reply = helper_->executeRootCommand("pfctl -v -f \"" + pfConfigFilePath + "\"");
+        //qCDebug(LOG_FIREWALL_CONTROLLER) << "Firewall on pfctl result:" << reply;
+        Q_UNUSED(reply);
+
+        helper_->executeRootCommand("pfctl -e");
+    }
+    else if (appliedAllowLanTraffic_ != bAllowLanTraffic || appliedPorts_ != ports)
+    {
+        // the rules of the anchor with the table, the main ruleset stays
+        helper_->executeRootCommand("pfctl -a windscribe -f \"" + anchorFilePath + "\"");
+    }
+    else
+    {
+        const FirewallExceptions::Diff diff = FirewallExceptions::diff(appliedIps_, ips);
+        int exitCode = 0;
+        if (diff.added.count() + diff.removed.count() <= MAX_TABLE_DELTA)
+        {
+            // the removed entries go first, the added ones may cover their addresses
+            if (!diff.removed.isEmpty())
+            {
+                helper_->executeRootCommand("pfctl -a windscribe -t windscribe_ips -T delete " + diff.removed.join(" "), &exitCode);
+            }
+            if (exitCode == 0 && !diff.added.isEmpty())
+            {
+                helper_->executeRootCommand("pfctl -a windscribe -t windscribe_ips -T add " + diff.added.join(" "), &exitCode);
+            }
+        }
+        else
+        {
+            helper_->executeRootCommand("pfctl -a windscribe -t windscribe_ips -T replace -f \"" + ipsFilePath + "\"", &exitCode);
+        }
+        if (exitCode != 0)
+        {
+            // the anchor was removed outside of the program, load everything again
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "pfctl table update failed, reloading the ruleset";
+            helper_->executeRootCommand("pfctl -v -f \"" + pfConfigFilePath + "\"");
+            helper_->executeRootCommand("pfctl -e");
+        }
+    }
+
+    isRulesetApplied_ = true;
+    appliedIps_ = ips;
+    appliedInterfaceToSkip_ = interfaceToSkip_;
+    appliedAllowLanTraffic_ = bAllowLanTraffic;
+    appliedPorts_ = ports;
+    return true;
+}
+
+QString FirewallController_mac::mainRuleset(const QString &anchorFilePath) const
+{
     QString pf = "";
     pf += "# Automatically generated by Windscribe. Any manual change will be overridden.\n";
     pf += "# Block policy, RST for quickly notice\n";
@@ -136,14 +198,24 @@ bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTra
     pf += "# Scrub\n";
     pf += "scrub in all\n"; // 2.9
 
+    pf += "# The rules are in the anchor, it is reloaded without the main ruleset\n";
+    pf += "anchor \"windscribe\" all\n";
+    pf += "load anchor \"windscribe\" from \"" + anchorFilePath + "\"\n";
+    return pf;
+}
+
+QString FirewallController_mac::anchorRules(const QString &ipsFilePath, bool bAllowLanTraffic,
+                                            const apiinfo::StaticIpPortsVector &ports) const
+{
+    QString pf = "";
+    pf += "# Automatically generated by Windscribe. Any manual change will be overridden.\n";
+    // not const, so the IPs can be replaced with "pfctl -T replace"
+    pf += "table <windscribe_ips> persist file \"" + ipsFilePath + "\"\n";
+
     pf += "# Drop everything that doesn't match a rule\n";
     pf += "block in all\n";
     pf += "block out all\n";
 
-    QString ips =ip;
-    ips = ips.replace(";", " ");
-    pf += "table <windscribe_ips> const { " + ips + " }\n";
-
     pf += "pass out quick inet proto udp from 0.0.0.0 to 255.255.255.255 port = 67\n";
     pf += "pass in quick proto udp from any to any port = 68\n";
 
@@ -162,18 +234,17 @@ bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTra
     if (bAllowLanTraffic)
     {
         // Local Network;
-        pf += "pass out quick inet from 192.168.0.0/16 to 192.168.0.0/16 flags S/SA keep state\n";
-        pf += "pass in quick inet from 192.168.0.0/16 to 192.168.0.0/16 flags S/SA keep state\n";
-        pf += "pass out quick inet from 172.16.0.0/12 to 172.16.0.0/12 flags S/SA keep state\n";
-        pf += "pass in quick inet from 172.16.0.0/12 to 172.16.0.0/12 flags S/SA keep state\n";
-        pf += "pass out quick inet from 10.0.0.0/8 to 10.0.0.0/8 flags S/SA keep state\n";
-        pf += "pass in quick inet from 10.0.0.0/8 to 10.0.0.0/8 flags S/SA keep state\n";
-
-        // Loopback addresses to the local host
-        pf += "pass in quick inet from 127.0.0.0/8 to 127.0.0.0/8 flags S/SA keep state\n";
+        for (const QString &block : LanRanges::privateNetworks())
+        {
+            pf += "pass out quick inet from " + block + " to " + block + " flags S/SA keep state\n";
+            pf += "pass in quick inet from " + block + " to " + block + " flags S/SA keep state\n";
+        }
 
-        // Multicast addresses
-        pf += "pass in quick inet from 224.0.0.0/4 to 224.0.0.0/4 flags S/SA keep state\n";
+        // Loopback addresses to the local host, multicast addresses
+        for (const QString &block : LanRanges::inboundExtras())
+        {
+            pf += "pass in quick inet from " + block + " to " + block + " flags S/SA keep state\n";
+        }
 
         // Allow AirDrop
         pf += "pass in quick on awdl0 inet6 proto udp from any to any port = 5353 keep state\n";
@@ -199,29 +270,20 @@ bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTra
         pf += "pass in quick proto udp from any to any port = 5353\n";
     }
 
-    QFile f(pfConfigFilePath);
-    if (f.open(QIODevice::WriteOnly))
-    {
-        QTextStream ts(&f);
-        ts << pf;
-        f.close();
-
-        // Note:
-        // Be careful adding '-F all' to this command to fix an issue.  Adding it will prevent the
-        // OpenVPN over TCP and Stealth protocols from completing their connection setup.
-
-        QString reply = helper_->executeRootCommand("pfctl -v -f \"" + pfConfigFilePath + "\"");
-        //qCDebug(LOG_FIREWALL_CONTROLLER) << "Firewall on pfctl result:" << reply;
-        Q_UNUSED(reply);
-
-        helper_->executeRootCommand("pfctl -e");
+    return pf;
+}
 
-        return true;
-    }
-    else
+bool FirewallController_mac::writeFile(const QString &filePath, const QString &data)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't write" << filePath;
         return false;
     }
+    QTextStream ts(&f);
+    ts << data;
+    return true;
 }
 
 void FirewallController_mac::setInterfaceToSkip_posix(const QString &interfaceToSkip)
@@ -27,7 +27,22 @@ private:
     QString interfaceToSkip_;
     bool forceUpdateInterfaceToSkip_;
     QMutex mutex_;
+
+    // The main ruleset (pf.conf) has only the options and the anchor "windscribe", which holds our rules and the table
+    // of the allowed IPs. The main ruleset is reloaded only when the interface to skip changes, the anchor only when
+    // the rules change; when only the IPs change, the changed entries of the table are deleted and added in place
+    // (the table is replaced from the file for the big changes).
+    static constexpr int MAX_TABLE_DELTA = 64;
+    bool isRulesetApplied_;
+    QString appliedInterfaceToSkip_;
+    bool appliedAllowLanTraffic_;
+    apiinfo::StaticIpPortsVector appliedPorts_;
+    QStringList appliedIps_;
+
     bool firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
+    QString mainRuleset(const QString &anchorFilePath) const;
+    QString anchorRules(const QString &ipsFilePath, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports) const;
+    static bool writeFile(const QString &filePath, const QString &data);
 };
 
 #endif // FIREWALLCONTROLLER_MAC_H
@@ -1,28 +1,42 @@
 #include "firewallexceptions.h"
-#include "uniqueiplist.h"
 #include <QThread>
 #include "utils/hardcodedsettings.h"
+#include "utils/ipset.h"
 #include "engine/dnsresolver/dnsutils.h"
 
+template<typename T> void FirewallExceptions::set(T &member, const T &value, bool *bChanged)
+{
+    const bool bDiffers = !(member == value);
+    if (bDiffers)
+    {
+        member = value;
+        version_++;
+    }
+    if (bChanged)
+    {
+        *bChanged = bDiffers;
+    }
+}
+
 void FirewallExceptions::setHostIPs(const QStringList &hostIPs)
 {
-    hostIPs_ = hostIPs;
+    set(hostIPs_, hostIPs);
 }
 
 void FirewallExceptions::setWhiteListedIPs(const QSet<QString> &ips)
 {
-    whitelistedIPs_ = ips;
+    set(whitelistedIPs_, ips);
 }
 
 void FirewallExceptions::setProxyIP(const ProxySettings &proxySettings)
 {
     if (proxySettings.option() == PROXY_OPTION_NONE)
     {
-        proxyIP_.clear();
+        set(proxyIP_, QString());
     }
     else if (proxySettings.option() == PROXY_OPTION_HTTP || proxySettings.option() == PROXY_OPTION_SOCKS)
     {
-        proxyIP_ = proxySettings.address();
+        set(proxyIP_, proxySettings.address());
     }
     else
     {
@@ -32,72 +46,53 @@ void FirewallExceptions::setProxyIP(const ProxySettings &proxySettings)
 
 void FirewallExceptions::setCustomRemoteIp(const QString &remoteIP, bool &bChanged)
 {
-    if (remoteIP_ != remoteIP)
-    {
-        remoteIP_ = remoteIP;
-        bChanged = true;
-    }
-    else
-    {
-        bChanged = false;
-    }
+    set(remoteIP_, remoteIP, &bChanged);
 }
 
 void FirewallExceptions::setConnectingIp(const QString &connectingIp, bool &bChanged)
 {
-    if (connectingIp_ != connectingIp)
-    {
-        connectingIp_ = connectingIp;
-        bChanged = true;
-    }
-    else
-    {
-        bChanged = false;
-    }
+    set(connectingIp_, connectingIp, &bChanged);
 }
 
 void FirewallExceptions::setDNSServerIp(const QString &dnsIp, bool &bChanged)
 {
-    if (dnsIp_ != dnsIp)
-    {
-        dnsIp_ = dnsIp;
-        bChanged = true;
-    }
-    else
-    {
-        bChanged = false;
-    }
+    set(dnsIp_, dnsIp, &bChanged);
 }
 
 void FirewallExceptions::setDnsPolicy(DNS_POLICY_TYPE dnsPolicy)
 {
-    dnsPolicyType_ = dnsPolicy;
+    set(dnsPolicyType_, dnsPolicy);
 }
 
 void FirewallExceptions::setLocationsPingIps(const QStringList &listIps)
 {
-    locationsPingIPs_ = listIps;
+    set(locationsPingIPs_, listIps);
 }
 
 void FirewallExceptions::setCustomConfigPingIps(const QStringList &listIps)
 {
-    customConfigsPingIPs_ = listIps;
+    set(customConfigsPingIPs_, listIps);
 }
 
-QString FirewallExceptions::getIPAddressesForFirewall() const
+QString FirewallExceptions::getIPAddressesForFirewall()
 {
     //Q_ASSERT(QApplication::instance()->thread() == QThread::currentThread());
 
-    UniqueIpList ipList;
+    updateOsDefaultDnsServers();
+    if (renderedVersion_ == version_)
+    {
+        return rendered_;
+    }
+
+    IpSet ipList;
     ipList.add("127.0.0.1");
 
     // add dns servers
     if (dnsPolicyType_ == DNS_TYPE_OS_DEFAULT)
     {
-        std::vector<std::wstring> listDns = DnsUtils::getOSDefaultDnsServers();
-        for (std::vector<std::wstring>::iterator it = listDns.begin(); it != listDns.end(); ++it)
+        for (const std::wstring &dns : osDefaultDnsServers_)
         {
-            ipList.add(QString::fromStdWString(*it));
+            ipList.add(QString::fromStdWString(dns));
         }
     }
     else if (dnsPolicyType_ == DNS_TYPE_OPEN_DNS)
@@ -107,7 +102,7 @@ QString FirewallExceptions::getIPAddressesForFirewall() const
             ipList.add(s);
         }
     }
-    else if (dnsPolicyType_ == DNS_TYPE_CLOUDFLARE)
+    else if (dnsPolicyType_ == DNS_TYPE_CLOUDFLARE || dnsPolicyType_ == DNS_TYPE_CLOUDFLARE_DOH)
     {
         for (const QString &s : HardcodedSettings::instance().cloudflareDns())
         {
@@ -187,22 +182,64 @@ QString FirewallExceptions::getIPAddressesForFirewall() const
         }
     }
 
-    return ipList.getFirewallString();
+    rendered_ = ipList.toFirewallString();
+    renderedVersion_ = version_;
+    return rendered_;
 }
 
-QString FirewallExceptions::getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const
+QString FirewallExceptions::getIPAddressesForFirewallForConnectedState(const QString &connectedIp)
 {
-    UniqueIpList ipList;
+    if (renderedConnectedVersion_ == version_ && renderedConnectedIp_ == connectedIp)
+    {
+        return renderedConnected_;
+    }
+
+    IpSet ipList;
     ipList.add("127.0.0.1");
     ipList.add(connectedIp);
     if (!remoteIP_.isEmpty())
     {
         ipList.add(remoteIP_);
     }
-    return ipList.getFirewallString();
+    renderedConnected_ = ipList.toFirewallString();
+    renderedConnectedVersion_ = version_;
+    renderedConnectedIp_ = connectedIp;
+    return renderedConnected_;
+}
+
+FirewallExceptions::Diff FirewallExceptions::diff(const QStringList &applied, const QStringList &current)
+{
+    // the blocks of IpSet are disjoint, so the added ones never overlap the kept ones
+    const QSet<QString> appliedSet = applied.toSet();
+    const QSet<QString> currentSet = current.toSet();
+    Diff d;
+    for (const QString &block : current)
+    {
+        if (!appliedSet.contains(block))
+        {
+            d.added << block;
+        }
+    }
+    for (const QString &block : applied)
+    {
+        if (!currentSet.contains(block))
+        {
+            d.removed << block;
+        }
+    }
+    return d;
+}
+
+void FirewallExceptions::updateOsDefaultDnsServers()
+{
+    if (dnsPolicyType_ == DNS_TYPE_OS_DEFAULT)
+    {
+        set(osDefaultDnsServers_, DnsUtils::getOSDefaultDnsServers());
+    }
 }
 
-FirewallExceptions::FirewallExceptions(): dnsPolicyType_(DNS_TYPE_OPEN_DNS)
+FirewallExceptions::FirewallExceptions(): dnsPolicyType_(DNS_TYPE_OPEN_DNS), version_(1), renderedVersion_(0),
+    renderedConnectedVersion_(0)
 {
 
 }
@@ -2,8 +2,13 @@
 #define FIREWALLEXCEPTIONS_H
 
 #include <QSharedPointer>
+#include <string>
+#include <vector>
 #include "engine/proxy/proxysettings.h"
 
+// The IPs allowed by the firewall, by their source. The version is incremented on every change of the set, the list
+// for the firewall is rendered once per version (and connected IP), so the firewall updates without a change of the
+// exceptions don't rebuild it and FirewallController skips them by the unchanged string.
 class FirewallExceptions
 {
 public:
@@ -23,8 +28,21 @@ public:
     void setLocationsPingIps(const QStringList &listIps);
     void setCustomConfigPingIps(const QStringList &listIps);
 
-    QString getIPAddressesForFirewall() const;
-    QString getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const;
+    quint64 version() const { return version_; }
+
+    // the CIDR blocks joined with ';', see IpSet::toFirewallString()
+    QString getIPAddressesForFirewall();
+    QString getIPAddressesForFirewallForConnectedState(const QString &connectedIp);
+
+    // the blocks of the current list which are not in the applied one and vice versa, for the firewalls which can
+    // change their set of the IPs by elements
+    struct Diff
+    {
+        QStringList added;
+        QStringList removed;
+        bool isEmpty() const { return added.isEmpty() && removed.isEmpty(); }
+    };
+    static Diff diff(const QStringList &applied, const QStringList &current);
 
 private:
     QStringList hostIPs_;
@@ -36,7 +54,18 @@ private:
     QString connectingIp_;
     QString dnsIp_;
     DNS_POLICY_TYPE dnsPolicyType_;
+    // for DNS_TYPE_OS_DEFAULT, they change without a setter and are checked on every read
+    std::vector<std::wstring> osDefaultDnsServers_;
+
+    quint64 version_;
+    quint64 renderedVersion_;
+    QString rendered_;
+    quint64 renderedConnectedVersion_;
+    QString renderedConnectedIp_;
+    QString renderedConnected_;
 
+    void updateOsDefaultDnsServers();
+    template<typename T> void set(T &member, const T &value, bool *bChanged = nullptr);
 };
 
 #endif // FIREWALLEXCEPTIONS_H
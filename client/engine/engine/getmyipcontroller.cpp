@@ -9,9 +9,10 @@ GetMyIPController::GetMyIPController(QObject *parent, ServerAPI *serverAPI, INet
     connect(&timer_, SIGNAL(timeout()), SLOT(onTimer()));
     timer_.setSingleShot(true);
     serverApiUserRole_ = serverAPI_->getAvailableUserRole();
+    elapsedTimer_.start();
 }
 
-void GetMyIPController::getIPFromConnectedState(int timeoutMs)
+void GetMyIPController::getIPFromConnectedState(int timeoutMs, const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId)
 {
     if (timer_.isActive())
     {
@@ -19,6 +20,7 @@ void GetMyIPController::getIPFromConnectedState(int timeoutMs)
     }
 
     requestForTimerIsDisconnected_ = false;
+    requestForTimerCacheKey_ = cacheKey(nodeIp, protocol, staticIpDeviceId);
     timer_.start(timeoutMs);
 }
 
@@ -30,11 +32,34 @@ void GetMyIPController::getIPFromDisconnectedState(int timeoutMs)
     }
 
     requestForTimerIsDisconnected_ = true;
+    requestForTimerCacheKey_.clear();
     timer_.start(timeoutMs);
 }
 
+void GetMyIPController::setTunnelIp(const QString &ip, const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId)
+{
+    if (!ip.isEmpty())
+    {
+        cache_[cacheKey(nodeIp, protocol, staticIpDeviceId)] = CachedIp{ ip, elapsedTimer_.elapsed() };
+    }
+}
+
 void GetMyIPController::onTimer()
 {
+    if (!requestForTimerIsDisconnected_)
+    {
+        auto it = cache_.find(requestForTimerCacheKey_);
+        if (it != cache_.end())
+        {
+            if (elapsedTimer_.elapsed() - it->timestampMs < CACHE_VALIDITY_MS)
+            {
+                emit answerMyIP(it->ip, true, false);
+                return;
+            }
+            cache_.erase(it);
+        }
+    }
+
     if (networkDetectionManager_->isOnline())
     {
         serverAPI_->myIP(requestForTimerIsDisconnected_, serverApiUserRole_, true);
@@ -57,7 +82,16 @@ void GetMyIPController::onMyIpAnswer(const QString &ip, bool success, bool isDis
         }
         else
         {
+            if (!isDisconnected && !requestForTimerIsDisconnected_)
+            {
+                cache_[requestForTimerCacheKey_] = CachedIp{ ip, elapsedTimer_.elapsed() };
+            }
             emit answerMyIP(ip, success, isDisconnected);
         }
     }
 }
+
+QString GetMyIPController::cacheKey(const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId)
+{
+    return nodeIp + "/" + protocol.toShortString() + "/" + staticIpDeviceId;
+}
@@ -1,10 +1,13 @@
 #ifndef GETMYIPCONTROLLER_H
 #define GETMYIPCONTROLLER_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
 #include <QQueue>
 #include <QTimer>
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
+#include "engine/types/protocoltype.h"
 
 class ServerAPI;
 
@@ -14,9 +17,14 @@ class GetMyIPController : public QObject
 public:
     explicit GetMyIPController(QObject *parent, ServerAPI *serverAPI, INetworkDetectionManager *networkDetectionManager);
 
-    void getIPFromConnectedState(int timeoutMs);
+    // the connection is identified by the node ip, the protocol and the device id for the static ips (empty otherwise),
+    // the ip is answered from the cache if it's known for the same connection within CACHE_VALIDITY_MS
+    void getIPFromConnectedState(int timeoutMs, const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId);
     void getIPFromDisconnectedState(int timeoutMs);
 
+    // the ip answered through the tunnel by the tunnel test
+    void setTunnelIp(const QString &ip, const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId);
+
 signals:
     void answerMyIP(const QString &ip, bool success, bool isDisconnected);
 
@@ -25,12 +33,26 @@ private slots:
     void onMyIpAnswer(const QString &ip, bool success, bool isDisconnected, uint userRole);
 
 private:
+    static constexpr int CACHE_VALIDITY_MS = 5 * 60 * 1000;
+
+    struct CachedIp
+    {
+        QString ip;
+        qint64 timestampMs;
+    };
+
     ServerAPI *serverAPI_;
     INetworkDetectionManager *networkDetectionManager_;
     uint serverApiUserRole_;
 
     bool requestForTimerIsDisconnected_;
+    QString requestForTimerCacheKey_;
     QTimer timer_;
+
+    QHash<QString, CachedIp> cache_;
+    QElapsedTimer elapsedTimer_;
+
+    static QString cacheKey(const QString &nodeIp, const ProtocolType &protocol, const QString &staticIpDeviceId);
 };
 
 #endif // GETMYIPCONTROLLER_H
@@ -322,6 +322,34 @@ bool Helper_mac::setDnsOfDynamicStoreEntry(const QString &ipAddress, const QStri
     return answerCmd.executed != 0;
 }
 
+bool Helper_mac::setIpv6Enabled(bool isEnabled)
+{
+    QMutexLocker locker(&mutex_);
+
+    CMD_SET_IPV6_ENABLED cmd;
+    cmd.isEnabled = isEnabled;
+
+    if (curState_ != STATE_CONNECTED)
+        return false;
+
+    std::stringstream stream;
+    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+    oa << cmd;
+
+    if (!sendCmdToHelper(HELPER_CMD_SET_IPV6_ENABLED, stream.str()))
+    {
+        return false;
+    }
+
+    CMD_ANSWER answerCmd;
+    if (!readAnswer(answerCmd))
+    {
+        return false;
+    }
+
+    return answerCmd.executed != 0;
+}
+
 
 bool Helper_mac::setKeychainUsernamePasswordImpl(const QString &username, const QString &password, bool *bExecuted)
 {
@@ -23,6 +23,8 @@ public:
     bool setKeychainUsernamePassword(const QString &username, const QString &password);
     bool setKextPath(const QString &kextPath);
     bool setDnsOfDynamicStoreEntry(const QString &ipAddress, const QString &dynEnties);
+    // all the network services in one transaction, the helper keeps the states before the disable
+    bool setIpv6Enabled(bool isEnabled);
 
 private:
     bool setKeychainUsernamePasswordImpl(const QString &username, const QString &password, bool *bExecuted);
@@ -30,9 +30,11 @@ using namespace boost::asio;
 
 Helper_posix *g_this_ = NULL;
 
-Helper_posix::Helper_posix(QObject *parent) : IHelper(parent), bIPV6State_(true), cmdId_(0), lastOpenVPNCmdId_(0)
+Helper_posix::Helper_posix(QObject *parent) : IHelper(parent), bIPV6State_(true), cmdId_(0), isWaitCmdStatusUnsupported_(false), lastOpenVPNCmdId_(0)
   , ep_(SOCK_PATH), bHelperConnectedEmitted_(false)
-  , curState_(STATE_INIT), bNeedFinish_(false), firstConnectToHelperErrorReported_(false)
+  , curState_(STATE_INIT), bNeedFinish_(false)
+  , sessionState_(SESSION_NOT_OPENED), nextRequestId_(0), waitingRequestId_(0), postedAnswers_(0)
+  , firstConnectToHelperErrorReported_(false)
 {
     Q_ASSERT(g_this_ == NULL);
     g_this_ = this;
@@ -95,6 +97,65 @@ void Helper_posix::getUnblockingCmdStatus(unsigned long cmdId, QString &outLog,
     }
 }
 
+void Helper_posix::waitUnblockingCmdStatus(unsigned long cmdId, int timeoutMs, QString &outLogChunk, bool &outFinished)
+{
+    // the helper answers the commands in order, so the wait is asked in slices and mutex_ is released between them
+    // for the other commands
+    outFinished = false;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    do
+    {
+        QMutexLocker locker(&mutex_);
+
+        if (curState_ != STATE_CONNECTED)
+        {
+            return;
+        }
+        if (isWaitCmdStatusUnsupported_)
+        {
+            break;
+        }
+
+        CMD_WAIT_CMD_STATUS cmd;
+        cmd.cmdId = cmdId;
+        cmd.timeoutMs = qBound(0, timeoutMs - static_cast<int>(elapsedTimer.elapsed()), static_cast<int>(WAIT_CMD_STATUS_SLICE_MS));
+
+        std::stringstream stream;
+        boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+        oa << cmd;
+
+        if (!sendCmdToHelper(HELPER_CMD_WAIT_CMD_STATUS, stream.str()))
+        {
+            doDisconnectAndReconnect();
+            return;
+        }
+        CMD_ANSWER answerCmd;
+        if (!readAnswer(answerCmd))
+        {
+            doDisconnectAndReconnect();
+            return;
+        }
+        if (answerCmd.executed == 0)
+        {
+            qCDebug(LOG_BASIC) << "The helper doesn't support HELPER_CMD_WAIT_CMD_STATUS, polling the commands";
+            isWaitCmdStatusUnsupported_ = true;
+            break;
+        }
+        outFinished = (answerCmd.executed == 1);
+        outLogChunk = QString::fromStdString(answerCmd.body);
+        if (outFinished || !outLogChunk.isEmpty())
+        {
+            return;
+        }
+    } while (elapsedTimer.elapsed() < timeoutMs);
+
+    if (isWaitCmdStatusUnsupported_)
+    {
+        getUnblockingCmdStatus(cmdId, outLogChunk, outFinished);
+    }
+}
+
 void Helper_posix::clearUnblockingCmd(unsigned long cmdId)
 {
     Q_UNUSED(cmdId);
@@ -112,19 +173,9 @@ void Helper_posix::clearUnblockingCmd(unsigned long cmdId)
     boost::archive::text_oarchive oa(stream, boost::archive::no_header);
     oa << cmd;
 
-    if (!sendCmdToHelper(HELPER_CMD_CLEAR_CMDS, stream.str()))
+    if (!postCmdToHelper(HELPER_CMD_CLEAR_CMDS, stream.str()))
     {
         doDisconnectAndReconnect();
-        return;
-    }
-    else
-    {
-        CMD_ANSWER answerCmd;
-        if (!readAnswer(answerCmd))
-        {
-            doDisconnectAndReconnect();
-            return;
-        }
     }
 }
 
@@ -168,20 +219,11 @@ bool Helper_posix::setSplitTunnelingSettings(bool isActive, bool isExclude,
     boost::archive::text_oarchive oa(stream, boost::archive::no_header);
     oa << cmdSplitTunnelingSettings;
 
-    if (!sendCmdToHelper(HELPER_CMD_SPLIT_TUNNELING_SETTINGS, stream.str()))
+    if (!postCmdToHelper(HELPER_CMD_SPLIT_TUNNELING_SETTINGS, stream.str()))
     {
         doDisconnectAndReconnect();
         return false;
     }
-    else
-    {
-        CMD_ANSWER answerCmd;
-        if (!readAnswer(answerCmd))
-        {
-            doDisconnectAndReconnect();
-            return false;
-        }
-    }
 
     return true;
 }
@@ -247,19 +289,9 @@ void Helper_posix::sendConnectStatus(bool isConnected, bool isCloseTcpSocket, bo
     boost::archive::text_oarchive oa(stream, boost::archive::no_header);
     oa << cmd;
 
-    if (!sendCmdToHelper(HELPER_CMD_SEND_CONNECT_STATUS, stream.str()))
+    if (!postCmdToHelper(HELPER_CMD_SEND_CONNECT_STATUS, stream.str()))
     {
         doDisconnectAndReconnect();
-        return;
-    }
-    else
-    {
-        CMD_ANSWER answerCmd;
-        if (!readAnswer(answerCmd))
-        {
-            doDisconnectAndReconnect();
-            return;
-        }
     }
 }
 
@@ -681,6 +713,8 @@ void Helper_posix::run()
 {
     BIND_CRASH_HANDLER_FOR_THREAD();
     firstConnectToHelperErrorReported_ = false;
+    sessionState_ = SESSION_NOT_OPENED;
+    postedAnswers_ = 0;
     io_service_.reset();
     reconnectElapsedTimer_.start();
     g_this_->socket_.reset(new boost::asio::local::stream_protocol::socket(io_service_));
@@ -746,8 +780,46 @@ void Helper_posix::doDisconnectAndReconnect()
 }
 
 bool Helper_posix::readAnswer(CMD_ANSWER &outAnswer)
+{
+    if (sessionState_ != SESSION_OPENED)
+    {
+        return readAnswerFrame(nullptr, outAnswer);
+    }
+
+    // the answers come in the order of the commands, skip the ones of the posted commands
+    while (true)
+    {
+        unsigned int requestId;
+        if (!readAnswerFrame(&requestId, outAnswer))
+        {
+            return false;
+        }
+        if (requestId == waitingRequestId_)
+        {
+            return true;
+        }
+        if (postedAnswers_ <= 0)
+        {
+            qCDebug(LOG_BASIC) << "Unexpected answer from the helper, request id:" << requestId << ", expected:" << waitingRequestId_;
+            return false;
+        }
+        postedAnswers_--;
+    }
+}
+
+bool Helper_posix::readAnswerFrame(unsigned int *outRequestId, CMD_ANSWER &outAnswer)
 {
     boost::system::error_code ec;
+    if (outRequestId)
+    {
+        boost::asio::read(*socket_, boost::asio::buffer(outRequestId, sizeof(*outRequestId)),
+                          boost::asio::transfer_exactly(sizeof(*outRequestId)), ec);
+        if (ec)
+        {
+            return false;
+        }
+    }
+
     int length;
     boost::asio::read(*socket_, boost::asio::buffer(&length, sizeof(length)),
                       boost::asio::transfer_exactly(sizeof(length)), ec);
@@ -774,7 +846,84 @@ bool Helper_posix::readAnswer(CMD_ANSWER &outAnswer)
     return true;
 }
 
+bool Helper_posix::readPostedAnswers()
+{
+    while (postedAnswers_ > 0)
+    {
+        unsigned int requestId;
+        CMD_ANSWER answer;
+        if (!readAnswerFrame(&requestId, answer))
+        {
+            return false;
+        }
+        postedAnswers_--;
+    }
+    return true;
+}
+
 bool Helper_posix::sendCmdToHelper(int cmdId, const std::string &data)
+{
+    if (sessionState_ == SESSION_NOT_OPENED && !openSession())
+    {
+        return false;
+    }
+
+    if (sessionState_ == SESSION_OPENED)
+    {
+        waitingRequestId_ = ++nextRequestId_;
+        boost::system::error_code ec;
+        boost::asio::write(*socket_, boost::asio::buffer(&waitingRequestId_, sizeof(waitingRequestId_)),
+                           boost::asio::transfer_exactly(sizeof(waitingRequestId_)), ec);
+        if (ec)
+        {
+            return false;
+        }
+    }
+    return writeCmd(cmdId, data);
+}
+
+bool Helper_posix::postCmdToHelper(int cmdId, const std::string &data)
+{
+    if (!sendCmdToHelper(cmdId, data))
+    {
+        return false;
+    }
+
+    if (sessionState_ == SESSION_OPENED)
+    {
+        postedAnswers_++;
+        // the helper blocks on writing the answers if they're not read, so don't let them pile up
+        return postedAnswers_ < MAX_POSTED_ANSWERS || readPostedAnswers();
+    }
+    else
+    {
+        CMD_ANSWER answerCmd;
+        return readAnswer(answerCmd);
+    }
+}
+
+bool Helper_posix::openSession()
+{
+    CMD_ANSWER answer;
+    if (!writeCmd(HELPER_CMD_OPEN_SESSION, "") || !readAnswerFrame(nullptr, answer))
+    {
+        return false;
+    }
+    if (answer.executed == 1)
+    {
+        sessionState_ = SESSION_OPENED;
+        postedAnswers_ = 0;
+    }
+    else
+    {
+        // the helper of a previous version, each command waits for its answer
+        qCDebug(LOG_BASIC) << "The helper doesn't support sessions, the commands are not pipelined";
+        sessionState_ = SESSION_UNSUPPORTED;
+    }
+    return true;
+}
+
+bool Helper_posix::writeCmd(int cmdId, const std::string &data)
 {
     int length = data.size();
     boost::system::error_code ec;
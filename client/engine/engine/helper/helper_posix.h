@@ -22,6 +22,7 @@ public:
     void setNeedFinish() override;
 
     void getUnblockingCmdStatus(unsigned long cmdId, QString &outLog, bool &outFinished) override;
+    void waitUnblockingCmdStatus(unsigned long cmdId, int timeoutMs, QString &outLogChunk, bool &outFinished) override;
     void clearUnblockingCmd(unsigned long cmdId) override;
     void suspendUnblockingCmd(unsigned long cmdId) override;
 
@@ -67,6 +68,8 @@ protected:
     } WAITING_DATA;
 
     enum { MAX_WAIT_HELPER = 5000 };
+    // the longest HELPER_CMD_WAIT_CMD_STATUS asked while holding mutex_, the same as the helper's limit
+    enum { WAIT_CMD_STATUS_SLICE_MS = 500 };
 
     QString interfaceToSkip_;
     bool bIPV6State_;
@@ -79,6 +82,7 @@ protected:
 
     QMutex mutex_;
     unsigned long cmdId_;
+    bool isWaitCmdStatusUnsupported_;   // HELPER_CMD_WAIT_CMD_STATUS answered with executed = 0 (mac helper)
 
     std::atomic<unsigned long> lastOpenVPNCmdId_;
 
@@ -106,6 +110,22 @@ protected:
 
     bool readAnswer(CMD_ANSWER &outAnswer);
     bool sendCmdToHelper(int cmdId, const std::string &data);
+    // for the commands whose answers are not needed: in the session it returns without waiting for the answer,
+    // the answer is read (and skipped) before the answer of the next command which waits
+    bool postCmdToHelper(int cmdId, const std::string &data);
+
+    // the session (HELPER_CMD_OPEN_SESSION) is opened with the first command after each connect to the helper
+    enum SESSION_STATE { SESSION_NOT_OPENED, SESSION_OPENED, SESSION_UNSUPPORTED };
+    enum { MAX_POSTED_ANSWERS = 16 };
+    SESSION_STATE sessionState_;
+    unsigned int nextRequestId_;
+    unsigned int waitingRequestId_;
+    int postedAnswers_;
+
+    bool openSession();
+    bool writeCmd(int cmdId, const std::string &data);
+    bool readAnswerFrame(unsigned int *outRequestId, CMD_ANSWER &outAnswer);
+    bool readPostedAnswers();
 
 private:
     bool firstConnectToHelperErrorReported_;
@@ -13,6 +13,7 @@
 #include "engine/types/wireguardtypes.h"
 #include "engine/connectionmanager/adaptergatewayinfo.h"
 #include "engine/types/protocoltype.h"
+#include "engine/enginemetrics.h"
 #include "utils/win32handle.h"
 
 #define SERVICE_PIPE_NAME  (L"\\\\.\\pipe\\WindscribeService")
@@ -23,7 +24,28 @@
 SC_HANDLE schSCManager_ = NULL;
 SC_HANDLE schService_ = NULL;
 
-Helper_win::Helper_win(QObject *parent) : IHelper(parent)
+template<typename T>
+MessagePacketResult Helper_win::sendCmdToHelper(int cmdId, const T &cmd)
+{
+    return sendCmdToHelperImpl(cmdId, [&cmd](bool isBinary) {
+        std::stringstream stream;
+        if (isBinary)
+        {
+            boost::archive::binary_oarchive oa(stream, boost::archive::no_header);
+            oa << cmd;
+        }
+        else
+        {
+            boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+            oa << cmd;
+        }
+        return stream.str();
+    });
+}
+
+Helper_win::Helper_win(QObject *parent) : IHelper(parent),
+    hSessionPipe_(INVALID_HANDLE_VALUE), isSessionUnsupported_(false), nextRequestId_(0),
+    commandsCount_(0), commandsTotalUs_(0), commandMaxUs_(0), commandMaxCmdId_(-1)
 {
     initVariables();
 }
@@ -41,6 +63,13 @@ Helper_win::~Helper_win()
     }
 #endif
 
+    closeSession();
+    if (commandsCount_ > 0)
+    {
+        qCDebug(LOG_BASIC) << "Helper commands:" << commandsCount_ << ", average time (us):" << commandsTotalUs_ / static_cast<qint64>(commandsCount_)
+                           << ", max time (us):" << commandMaxUs_ << "for cmd" << commandMaxCmdId_;
+    }
+
     if (schService_)
     {
         CloseServiceHandle(schService_);
@@ -110,11 +139,7 @@ void Helper_win::getUnblockingCmdStatus(unsigned long cmdId, QString &outLog, bo
     CMD_CHECK_UNBLOCKING_CMD_STATUS cmdCheckUnblockingCmdStatus;
     cmdCheckUnblockingCmdStatus.cmdId = cmdId;
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdCheckUnblockingCmdStatus;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CHECK_UNBLOCKING_CMD_STATUS, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CHECK_UNBLOCKING_CMD_STATUS, cmdCheckUnblockingCmdStatus);
 
     if (mpr.success)
     {
@@ -131,6 +156,29 @@ void Helper_win::getUnblockingCmdStatus(unsigned long cmdId, QString &outLog, bo
     }
 }
 
+void Helper_win::waitUnblockingCmdStatus(unsigned long cmdId, int timeoutMs, QString &outLogChunk, bool &outFinished)
+{
+    QMutexLocker locker(&mutex_);
+
+    CMD_WAIT_UNBLOCKING_CMD_STATUS cmdWaitUnblockingCmdStatus;
+    cmdWaitUnblockingCmdStatus.cmdId = cmdId;
+    cmdWaitUnblockingCmdStatus.timeoutMs = timeoutMs;
+
+    // an old service answers as for an unknown command, the same as a command not found, so the caller keeps polling
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WAIT_UNBLOCKING_CMD_STATUS, cmdWaitUnblockingCmdStatus);
+
+    if (mpr.success)
+    {
+        outFinished = mpr.blockingCmdFinished;
+        outLogChunk = QString::fromLocal8Bit(mpr.additionalString.c_str(), mpr.additionalString.size());
+    }
+    else
+    {
+        outFinished = false;
+        outLogChunk.clear();
+    }
+}
+
 void Helper_win::clearUnblockingCmd(unsigned long cmdId)
 {
     QMutexLocker locker(&mutex_);
@@ -138,11 +186,7 @@ void Helper_win::clearUnblockingCmd(unsigned long cmdId)
     CMD_CLEAR_UNBLOCKING_CMD cmdClearUnblockingCmd;
     cmdClearUnblockingCmd.blockingCmdId = cmdId;
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdClearUnblockingCmd;
-
-    sendCmdToHelper(AA_COMMAND_CLEAR_UNBLOCKING_CMD, stream.str());
+    sendCmdToHelper(AA_COMMAND_CLEAR_UNBLOCKING_CMD, cmdClearUnblockingCmd);
 }
 
 void Helper_win::suspendUnblockingCmd(unsigned long cmdId)
@@ -152,11 +196,7 @@ void Helper_win::suspendUnblockingCmd(unsigned long cmdId)
     CMD_SUSPEND_UNBLOCKING_CMD cmdSuspendUnblockingCmd;
     cmdSuspendUnblockingCmd.blockingCmdId = cmdId;
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdSuspendUnblockingCmd;
-
-    sendCmdToHelper(AA_COMMAND_SUSPEND_UNBLOCKING_CMD, stream.str());
+    sendCmdToHelper(AA_COMMAND_SUSPEND_UNBLOCKING_CMD, cmdSuspendUnblockingCmd);
 }
 
 bool Helper_win::setSplitTunnelingSettings(bool isActive, bool isExclude, bool isKeepLocalSockets,
@@ -185,11 +225,7 @@ bool Helper_win::setSplitTunnelingSettings(bool isActive, bool isExclude, bool i
         cmdSplitTunnelingSettings.hosts.push_back(hosts[i].toStdString());
     }
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdSplitTunnelingSettings;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SPLIT_TUNNELING_SETTINGS, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SPLIT_TUNNELING_SETTINGS, cmdSplitTunnelingSettings);
     return mpr.exitCode;
 }
 
@@ -246,11 +282,7 @@ void Helper_win::sendConnectStatus(bool isConnected, bool isCloseTcpSocket, bool
         cmd.remoteIp = vpnAdapter.remoteIp().toStdString();
     }
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmd;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CONNECT_STATUS, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CONNECT_STATUS, cmd);
 }
 
 bool Helper_win::setCustomDnsWhileConnected(bool isIkev2, unsigned long ifIndex, const QString &overrideDnsIpAddress)
@@ -263,11 +295,7 @@ bool Helper_win::setCustomDnsWhileConnected(bool isIkev2, unsigned long ifIndex,
     cmd.ifIndex = ifIndex;
     cmd.szDnsIpAddress = overrideDnsIpAddress.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmd;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_DNS_WHILE_CONNECTED, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_DNS_WHILE_CONNECTED, cmd);
     return mpr.exitCode == 0;
 }
 
@@ -290,11 +318,7 @@ IHelper::ExecuteError Helper_win::startWireGuard(const QString &exeName, const Q
     cmdStartWireGuard.szExecutable = exeName.toStdWString();
     cmdStartWireGuard.szDeviceName = deviceName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdStartWireGuard;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_START_WIREGUARD, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_START_WIREGUARD, cmdStartWireGuard);
     return mpr.success ? IHelper::EXECUTE_SUCCESS : IHelper::EXECUTE_ERROR;
 }
 
@@ -371,11 +395,7 @@ IHelper::ExecuteError Helper_win::executeOpenVPN(const QString &configPath, unsi
     cmdRunOpenVpn.httpPortNumber = httpPort;
     cmdRunOpenVpn.socksPortNumber = socksPort;
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdRunOpenVpn;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RUN_OPENVPN, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RUN_OPENVPN, cmdRunOpenVpn);
     outCmdId = mpr.blockingCmdId;
 
     return mpr.success ? IHelper::EXECUTE_SUCCESS : IHelper::EXECUTE_ERROR;
@@ -388,11 +408,7 @@ bool Helper_win::executeTaskKill(const QString &executableName)
     CMD_TASK_KILL cmdTaskKill;
     cmdTaskKill.szExecutableName = executableName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdTaskKill;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_TASK_KILL, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_TASK_KILL, cmdTaskKill);
 
     return mpr.success;
 }
@@ -403,11 +419,7 @@ bool Helper_win::executeResetTap(const QString &tapName)
     CMD_RESET_TAP cmdResetTap;
     cmdResetTap.szTapName = tapName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdResetTap;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RESET_TAP, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RESET_TAP, cmdResetTap);
 
     return mpr.success;
 }
@@ -421,11 +433,7 @@ QString Helper_win::executeSetMetric(const QString &interfaceType, const QString
     cmdSetMetric.szInterfaceName = interfaceName.toStdWString();
     cmdSetMetric.szMetricNumber = metricNumber.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdSetMetric;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SET_METRIC, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SET_METRIC, cmdSetMetric);
     return QString::fromLocal8Bit(mpr.additionalString.c_str(), mpr.additionalString.size());
 }
 
@@ -436,11 +444,7 @@ QString Helper_win::executeWmicEnable(const QString &adapterName)
     CMD_WMIC_ENABLE cmdWmicEnable;
     cmdWmicEnable.szAdapterName = adapterName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdWmicEnable;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WMIC_ENABLE, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WMIC_ENABLE, cmdWmicEnable);
     return QString::fromLocal8Bit(mpr.additionalString.c_str(), mpr.additionalString.size());
 }
 
@@ -451,27 +455,14 @@ QString Helper_win::executeWmicGetConfigManagerErrorCode(const QString &adapterN
     CMD_WMIC_GET_CONFIG_ERROR_CODE cmdWmicGetConfigErrorCode;
     cmdWmicGetConfigErrorCode.szAdapterName = adapterName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdWmicGetConfigErrorCode;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WMIC_GET_CONFIG_ERROR_CODE, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WMIC_GET_CONFIG_ERROR_CODE, cmdWmicGetConfigErrorCode);
     return QString::fromLocal8Bit(mpr.additionalString.c_str(), mpr.additionalString.size());
 }
 
-bool Helper_win::executeChangeIcs(int cmd, const QString &configPath, const QString &publicGuid, const QString &privateGuid, unsigned long &outCmdId, const QString &eventName)
+bool Helper_win::executeChangeIcs(int cmd, const QString &configPath, const QString &publicGuid, const QString &privateGuid, const QString &eventName)
 {
     QMutexLocker locker(&mutex_);
 
-    // check executable signature
-    QString updateIcsExePath = QCoreApplication::applicationDirPath() + "/ChangeIcs.exe";
-    ExecutableSignature sigCheck;
-    if (!sigCheck.verify(updateIcsExePath.toStdWString()))
-    {
-        qCDebug(LOG_CONNECTION) << "ChangeIcs executable signature incorrect: " << QString::fromStdString(sigCheck.lastError());
-        return false;
-    }
-
     CMD_UPDATE_ICS cmdUpdateIcs;
     cmdUpdateIcs.cmd = cmd;
     cmdUpdateIcs.szConfigPath = configPath.toStdWString();
@@ -479,13 +470,7 @@ bool Helper_win::executeChangeIcs(int cmd, const QString &configPath, const QStr
     cmdUpdateIcs.szPrivateGuid = privateGuid.toStdWString();
     cmdUpdateIcs.szEventName = eventName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdUpdateIcs;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_UPDATE_ICS, stream.str());
-    outCmdId = mpr.blockingCmdId;
-
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_UPDATE_ICS, cmdUpdateIcs);
     return mpr.success;
 }
 
@@ -498,11 +483,7 @@ bool Helper_win::executeChangeMtu(const QString &adapter, int mtu)
     cmdChangeMtu.storePersistent = false;
     cmdChangeMtu.szAdapterName = adapter.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdChangeMtu;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CHANGE_MTU, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_CHANGE_MTU, cmdChangeMtu);
     return mpr.success;
 }
 
@@ -576,11 +557,7 @@ bool Helper_win::addHosts(const QString &hosts)
     CMD_ADD_HOSTS cmdAddHosts;
     cmdAddHosts.hosts = hosts.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdAddHosts;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_ADD_HOSTS, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_ADD_HOSTS, cmdAddHosts);
     return mpr.success;
 }
 
@@ -597,13 +574,9 @@ void Helper_win::closeAllTcpConnections(bool isKeepLocalSockets)
     CMD_CLOSE_TCP_CONNECTIONS cmdCloseTcpConnections;
     cmdCloseTcpConnections.isKeepLocalSockets = isKeepLocalSockets;
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdCloseTcpConnections;
-
     qCDebug(LOG_BASIC) << "Close all active TCP connections (keepLocalSockets = "
                        << cmdCloseTcpConnections.isKeepLocalSockets << ")";
-    sendCmdToHelper(AA_COMMAND_CLOSE_TCP_CONNECTIONS, stream.str());
+    sendCmdToHelper(AA_COMMAND_CLOSE_TCP_CONNECTIONS, cmdCloseTcpConnections);
 }
 
 QStringList Helper_win::getProcessesList()
@@ -641,11 +614,7 @@ bool Helper_win::whitelistPorts(const QString &ports)
     CMD_WHITELIST_PORTS cmdWhitelistPorts;
     cmdWhitelistPorts.ports = ports.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdWhitelistPorts;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WHITELIST_PORTS, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_WHITELIST_PORTS, cmdWhitelistPorts);
     return mpr.success;
 }
 
@@ -673,11 +642,7 @@ void Helper_win::enableDnsLeaksProtection()
         cmdDisableDnsTraffic.excludedIps.push_back(customDnsIp_.toStdWString());
     }
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdDisableDnsTraffic;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_DISABLE_DNS_TRAFFIC, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_DISABLE_DNS_TRAFFIC, cmdDisableDnsTraffic);
 }
 
 void Helper_win::disableDnsLeaksProtection()
@@ -710,11 +675,7 @@ bool Helper_win::setMacAddressRegistryValueSz(QString subkeyInterfaceName, QStri
     cmdSetMacAddressRegistryValueSz.szInterfaceName = subkeyInterfaceName.toStdWString();
     cmdSetMacAddressRegistryValueSz.szValue = value.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdSetMacAddressRegistryValueSz;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SET_MAC_ADDRESS_REGISTRY_VALUE_SZ, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SET_MAC_ADDRESS_REGISTRY_VALUE_SZ, cmdSetMacAddressRegistryValueSz);
     return mpr.exitCode;
 }
 
@@ -725,11 +686,7 @@ bool Helper_win::removeMacAddressRegistryProperty(QString subkeyInterfaceName)
     CMD_REMOVE_MAC_ADDRESS_REGISTRY_PROPERTY cmdRemoveMacAddressRegistryProperty;
     cmdRemoveMacAddressRegistryProperty.szInterfaceName = subkeyInterfaceName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdRemoveMacAddressRegistryProperty;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REMOVE_MAC_ADDRESS_REGISTRY_PROPERTY, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REMOVE_MAC_ADDRESS_REGISTRY_PROPERTY, cmdRemoveMacAddressRegistryProperty);
     return mpr.exitCode;
 }
 
@@ -741,11 +698,7 @@ bool Helper_win::resetNetworkAdapter(QString subkeyInterfaceName, bool bringAdap
     cmdResetNetworkAdapter.bringBackUp = bringAdapterBackUp;
     cmdResetNetworkAdapter.szInterfaceName = subkeyInterfaceName.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdResetNetworkAdapter;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RESET_NETWORK_ADAPTER, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_RESET_NETWORK_ADAPTER, cmdResetNetworkAdapter);
     return mpr.exitCode;
 }
 
@@ -763,10 +716,11 @@ bool Helper_win::removeWindscribeNetworkProfiles()
     return mpr.exitCode;
 }
 
-void Helper_win::setIKEv2IPSecParameters()
+bool Helper_win::setIKEv2IPSecParameters()
 {
     QMutexLocker locker(&mutex_);
     MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_SET_IKEV2_IPSEC_PARAMETERS, std::string());
+    return mpr.success;
 }
 
 bool Helper_win::makeHostsFileWritable()
@@ -791,11 +745,7 @@ bool Helper_win::reinstallTapDriver(const QString &tapDriverDir)
     cmdReinstallTunDriver.driverDir.resize(tapDriverDir.size());
     tapDriverDir.toWCharArray(const_cast<wchar_t*>(cmdReinstallTunDriver.driverDir.data()));
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdReinstallTunDriver;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REINSTALL_TAP_DRIVER, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REINSTALL_TAP_DRIVER, cmdReinstallTunDriver);
     if(mpr.success) {
         qCDebug(LOG_BASIC) << "Tap driver was successfully re-installed.";
     }
@@ -813,11 +763,7 @@ bool Helper_win::reinstallWintunDriver(const QString &wintunDriverDir)
     cmdReinstallTunDriver.driverDir.resize(wintunDriverDir.size());
     wintunDriverDir.toWCharArray(const_cast<wchar_t*>(cmdReinstallTunDriver.driverDir.data()));
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdReinstallTunDriver;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REINSTALL_WINTUN_DRIVER, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_REINSTALL_WINTUN_DRIVER, cmdReinstallTunDriver);
     if(mpr.success) {
         qCDebug(LOG_BASIC) << "Wintun driver was successfully re-installed.";
     }
@@ -917,19 +863,65 @@ void Helper_win::run()
 
 MessagePacketResult Helper_win::sendCmdToHelper(int cmdId, const std::string &data)
 {
-    HANDLE hPipe = ::CreateFileW(SERVICE_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0);
-    if (hPipe == INVALID_HANDLE_VALUE)
+    return sendCmdToHelperImpl(cmdId, [&data](bool) { return data; });
+}
+
+MessagePacketResult Helper_win::sendCmdToHelperImpl(int cmdId, const std::function<std::string(bool isBinary)> &serializeData)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    MessagePacketResult mpr;
+    if (!isSessionUnsupported_)
     {
-        if (WaitNamedPipe(SERVICE_PIPE_NAME, MAX_WAIT_TIME_FOR_PIPE) == 0)
+        if (hSessionPipe_ != INVALID_HANDLE_VALUE || openSession())
         {
-            return MessagePacketResult();
+            const std::string data = serializeData(true);
+            bool isWritten;
+            if (!sendCmdInSession(cmdId, data, mpr, isWritten))
+            {
+                closeSession();
+                // the session could be broken by the restart of the service, the command wasn't received, so retry once
+                if (!isWritten && openSession())
+                {
+                    if (!sendCmdInSession(cmdId, data, mpr, isWritten))
+                    {
+                        closeSession();
+                    }
+                }
+            }
         }
+    }
+    if (isSessionUnsupported_)
+    {
+        mpr = sendCmdOnNewPipe(cmdId, serializeData(false));
+    }
 
-        hPipe = ::CreateFileW(SERVICE_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0);
-        if (hPipe == INVALID_HANDLE_VALUE)
-        {
-            return MessagePacketResult();
-        }
+    const qint64 elapsedUs = elapsedTimer.nsecsElapsed() / 1000;
+    commandsCount_++;
+    commandsTotalUs_ += elapsedUs;
+    if (elapsedUs > commandMaxUs_)
+    {
+        commandMaxUs_ = elapsedUs;
+        commandMaxCmdId_ = cmdId;
+    }
+    if (EngineMetrics::instance().isEnabled())
+    {
+        EngineMetrics::instance().observeMs("windscribe_helper_command_ms", elapsedUs / 1000.0, "command", QString::number(cmdId));
+    }
+    if (elapsedUs > SLOW_COMMAND_TIME_US)
+    {
+        qCDebug(LOG_BASIC) << "Helper command" << cmdId << "took" << elapsedUs / 1000 << "ms";
+    }
+    return mpr;
+}
+
+MessagePacketResult Helper_win::sendCmdOnNewPipe(int cmdId, const std::string &data)
+{
+    HANDLE hPipe = connectToServicePipe();
+    if (hPipe == INVALID_HANDLE_VALUE)
+    {
+        return MessagePacketResult();
     }
 
     WinUtils::Win32Handle closePipe(hPipe);
@@ -956,11 +948,107 @@ MessagePacketResult Helper_win::sendCmdToHelper(int cmdId, const std::string &da
         }
     }
 
-    // read MessagePacketResult
     MessagePacketResult mpr;
+    readMessagePacketResult(hPipe, mpr, false);
+    return mpr;
+}
+
+HANDLE Helper_win::connectToServicePipe()
+{
+    HANDLE hPipe = ::CreateFileW(SERVICE_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0);
+    if (hPipe == INVALID_HANDLE_VALUE)
+    {
+        if (WaitNamedPipe(SERVICE_PIPE_NAME, MAX_WAIT_TIME_FOR_PIPE) == 0)
+        {
+            return INVALID_HANDLE_VALUE;
+        }
+
+        hPipe = ::CreateFileW(SERVICE_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0);
+    }
+    return hPipe;
+}
+
+bool Helper_win::openSession()
+{
+    Q_ASSERT(hSessionPipe_ == INVALID_HANDLE_VALUE);
+    HANDLE hPipe = connectToServicePipe();
+    if (hPipe == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    const int cmdId = AA_COMMAND_OPEN_SESSION;
+    const unsigned long protocolVersion = SESSION_PROTOCOL_VERSION;
+    const unsigned long sizeOfBuf = sizeof(protocolVersion);
+    MessagePacketResult mpr;
+    if (!writeAllToPipe(hPipe, (const char *)&cmdId, sizeof(cmdId)) ||
+        !writeAllToPipe(hPipe, (const char *)&sizeOfBuf, sizeof(sizeOfBuf)) ||
+        !writeAllToPipe(hPipe, (const char *)&protocolVersion, sizeof(protocolVersion)) ||
+        !readMessagePacketResult(hPipe, mpr, false))
+    {
+        CloseHandle(hPipe);
+        return false;
+    }
+    if (!mpr.success || mpr.exitCode != SESSION_PROTOCOL_VERSION)
+    {
+        // the service from the previous version, it closes the pipe after each command
+        qCDebug(LOG_BASIC) << "The helper doesn't support sessions, a pipe is opened for each command";
+        CloseHandle(hPipe);
+        isSessionUnsupported_ = true;
+        return false;
+    }
+
+    hSessionPipe_ = hPipe;
+    return true;
+}
+
+void Helper_win::closeSession()
+{
+    if (hSessionPipe_ != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(hSessionPipe_);
+        hSessionPipe_ = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool Helper_win::sendCmdInSession(int cmdId, const std::string &data, MessagePacketResult &mpr, bool &isWritten)
+{
+    // request: request id, cmdId, size of buffer, body; reply: request id, MessagePacketResult
+    const unsigned long requestId = ++nextRequestId_;
+    const unsigned long sizeOfBuf = data.size();
+    std::string packet;
+    packet.reserve(sizeof(requestId) + sizeof(cmdId) + sizeof(sizeOfBuf) + sizeOfBuf);
+    packet.append((const char *)&requestId, sizeof(requestId));
+    packet.append((const char *)&cmdId, sizeof(cmdId));
+    packet.append((const char *)&sizeOfBuf, sizeof(sizeOfBuf));
+    packet.append(data);
+
+    isWritten = writeAllToPipe(hSessionPipe_, packet.c_str(), packet.size());
+    if (!isWritten)
+    {
+        return false;
+    }
+
+    unsigned long replyId;
+    if (!readAllFromPipe(hSessionPipe_, (char *)&replyId, sizeof(replyId)) || !readMessagePacketResult(hSessionPipe_, mpr, true))
+    {
+        return false;
+    }
+    if (replyId != requestId)
+    {
+        qCDebug(LOG_BASIC) << "Helper reply for the wrong request:" << replyId << ", expected:" << requestId;
+        mpr = MessagePacketResult();
+        return false;
+    }
+    return true;
+}
+
+bool Helper_win::readMessagePacketResult(HANDLE hPipe, MessagePacketResult &mpr, bool isBinary)
+{
+    unsigned long sizeOfBuf;
     if (!readAllFromPipe(hPipe, (char *)&sizeOfBuf, sizeof(sizeOfBuf)))
     {
-        return mpr;
+        return false;
     }
 
     if (sizeOfBuf > 0)
@@ -968,16 +1056,22 @@ MessagePacketResult Helper_win::sendCmdToHelper(int cmdId, const std::string &da
         QScopedArrayPointer<char> buf(new char[sizeOfBuf]);
         if (!readAllFromPipe(hPipe, buf.data(), sizeOfBuf))
         {
-            return mpr;
+            return false;
         }
 
         std::istringstream stream(std::string(buf.data(), sizeOfBuf));
-        boost::archive::text_iarchive ia(stream, boost::archive::no_header);
-
-        ia >> mpr;
+        if (isBinary)
+        {
+            boost::archive::binary_iarchive ia(stream, boost::archive::no_header);
+            ia >> mpr;
+        }
+        else
+        {
+            boost::archive::text_iarchive ia(stream, boost::archive::no_header);
+            ia >> mpr;
+        }
     }
-
-    return mpr;
+    return true;
 }
 
 bool Helper_win::disableIPv6()
@@ -1028,11 +1122,7 @@ bool Helper_win::firewallOn(const QString &ip, bool bAllowLanTraffic)
     cmdFirewallOn.allowLanTraffic = bAllowLanTraffic;
     cmdFirewallOn.ip = ip.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdFirewallOn;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_FIREWALL_ON, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_FIREWALL_ON, cmdFirewallOn);
     return mpr.success;
 }
 
@@ -1044,11 +1134,7 @@ bool Helper_win::firewallChange(const QString &ip, bool bAllowLanTraffic)
     cmdFirewallOn.allowLanTraffic = bAllowLanTraffic;
     cmdFirewallOn.ip = ip.toStdWString();
 
-    std::stringstream stream;
-    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
-    oa << cmdFirewallOn;
-
-    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_FIREWALL_CHANGE, stream.str());
+    MessagePacketResult mpr = sendCmdToHelper(AA_COMMAND_FIREWALL_CHANGE, cmdFirewallOn);
     return mpr.success;
 }
 
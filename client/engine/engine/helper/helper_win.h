@@ -5,6 +5,7 @@
 #include <QTimer>
 #include <QMutex>
 #include <atomic>
+#include <functional>
 #include <windows.h>
 #include "../../../../backend/windows/windscribe_service/ipc/servicecommunication.h"
 #include "../../../../backend/windows/windscribe_service/ipc/serialize_structs.h"
@@ -23,6 +24,7 @@ public:
     QString getHelperVersion() override;
 
     void getUnblockingCmdStatus(unsigned long cmdId, QString &outLog, bool &outFinished) override;
+    void waitUnblockingCmdStatus(unsigned long cmdId, int timeoutMs, QString &outLogChunk, bool &outFinished) override;
     void clearUnblockingCmd(unsigned long cmdId) override;
     void suspendUnblockingCmd(unsigned long cmdId) override;
 
@@ -51,7 +53,7 @@ public:
     QString executeWmicEnable(const QString &adapterName);
     QString executeWmicGetConfigManagerErrorCode(const QString &adapterName);
     bool executeChangeIcs(int cmd, const QString &configPath, const QString &publicGuid, const QString &privateGuid,
-                          unsigned long &outCmdId, const QString &eventName);
+                          const QString &eventName);
     bool executeChangeMtu(const QString &adapter, int mtu);
 
     bool clearDnsOnTap();
@@ -85,7 +87,7 @@ public:
 
     bool addIKEv2DefaultRoute();
     bool removeWindscribeNetworkProfiles();
-    void setIKEv2IPSecParameters();
+    bool setIKEv2IPSecParameters();
     bool makeHostsFileWritable();
     bool reinstallTapDriver(const QString& tapDriverDir);
     bool reinstallWintunDriver(const QString& wintunDriverDir);
@@ -99,6 +101,7 @@ private:
     enum {MAX_WAIT_TIME_FOR_HELPER = 30000};
     enum {MAX_WAIT_TIME_FOR_PIPE = 10000};
     enum {CHECK_UNBLOCKING_CMD_PERIOD = 2000};
+    enum {SLOW_COMMAND_TIME_US = 500000};
 
     QString helperLabel_;
     QString customDnsIp_;
@@ -108,7 +111,29 @@ private:
     bool bIPV6State_;
     QMutex mutex_;
 
+    // Commands go through a persistent session with the service (AA_COMMAND_OPEN_SESSION), each request is tagged
+    // with an id and the reply is matched by the id. A service without the sessions gets a new pipe per command.
+    HANDLE hSessionPipe_;
+    bool isSessionUnsupported_;
+    unsigned long nextRequestId_;
+
+    // latency of the commands
+    quint64 commandsCount_;
+    qint64 commandsTotalUs_;
+    qint64 commandMaxUs_;
+    int commandMaxCmdId_;
+
     MessagePacketResult sendCmdToHelper(int cmdId, const std::string &data);
+    // the command is serialized as a binary archive in the session and as a text archive for a new pipe
+    template<typename T> MessagePacketResult sendCmdToHelper(int cmdId, const T &cmd);
+    MessagePacketResult sendCmdToHelperImpl(int cmdId, const std::function<std::string(bool isBinary)> &serializeData);
+    MessagePacketResult sendCmdOnNewPipe(int cmdId, const std::string &data);
+    HANDLE connectToServicePipe();
+    bool openSession();
+    void closeSession();
+    // isWritten is false if the request was not written, then the service didn't execute it
+    bool sendCmdInSession(int cmdId, const std::string &data, MessagePacketResult &mpr, bool &isWritten);
+    bool readMessagePacketResult(HANDLE hPipe, MessagePacketResult &mpr, bool isBinary);
     bool disableIPv6();
     bool enableIPv6();
 
@@ -29,6 +29,9 @@ public:
     virtual QString getHelperVersion() = 0;
 
     virtual void getUnblockingCmdStatus(unsigned long cmdId, QString &outLog, bool &outFinished) = 0;
+    // returns when the command finishes or prints something, or after timeoutMs; outLogChunk is the output since
+    // the previous call (without waiting and the whole output at the end with the helpers which don't support it)
+    virtual void waitUnblockingCmdStatus(unsigned long cmdId, int timeoutMs, QString &outLogChunk, bool &outFinished) = 0;
     virtual void clearUnblockingCmd(unsigned long cmdId) = 0;
     virtual void suspendUnblockingCmd(unsigned long cmdId) = 0;
 
@@ -0,0 +1,211 @@
+#include "inittaskgraph.h"
+
+#include <QRunnable>
+#include "utils/crashhandler.h"
+#include "utils/logger.h"
+#include "utils/tracespan.h"
+
+namespace {
+
+class PoolTask : public QRunnable
+{
+public:
+    explicit PoolTask(std::function<void()> func) : func_(func) {}
+    void run() override
+    {
+        BIND_CRASH_HANDLER_FOR_THREAD();
+        func_();
+    }
+
+private:
+    std::function<void()> func_;
+};
+
+const char *threadName(InitTaskGraph::THREAD thread)
+{
+    switch (thread)
+    {
+        case InitTaskGraph::THREAD_ENGINE:
+            return "engine";
+        case InitTaskGraph::THREAD_POOL:
+            return "pool";
+        default:
+            return "external";
+    }
+}
+
+} // namespace
+
+InitTaskGraph::InitTaskGraph(QObject *parent) : QObject(parent), isStarted_(false), graphStartUs_(0), countFinished_(0)
+{
+}
+
+InitTaskGraph::~InitTaskGraph()
+{
+    // the pool tasks use the objects of the owner
+    threadPool_.waitForDone();
+}
+
+void InitTaskGraph::addTask(const QString &name, THREAD thread, const QStringList &dependencies, std::function<void()> func)
+{
+    Q_ASSERT(!isStarted_);
+    Q_ASSERT(indexOf(name) == -1);
+
+    Task task;
+    task.name = name.toUtf8();
+    task.thread = thread;
+    for (const QString &dependency : dependencies)
+    {
+        const int ind = indexOf(dependency);
+        Q_ASSERT(ind != -1);
+        if (ind != -1)
+        {
+            task.dependencies << ind;
+        }
+    }
+    task.func = func;
+    task.state = STATE_WAITING;
+    task.startUs = 0;
+    task.finishUs = 0;
+    tasks_ << task;
+}
+
+void InitTaskGraph::addExternalTask(const QString &name, const QStringList &dependencies)
+{
+    addTask(name, THREAD_EXTERNAL, dependencies, nullptr);
+}
+
+void InitTaskGraph::finishExternalTask(const QString &name)
+{
+    const int ind = indexOf(name);
+    Q_ASSERT(ind != -1 && tasks_[ind].thread == THREAD_EXTERNAL);
+    if (ind != -1 && tasks_[ind].state == STATE_RUNNING)
+    {
+        onTaskFinished(ind);
+    }
+}
+
+void InitTaskGraph::start()
+{
+    Q_ASSERT(!isStarted_);
+    isStarted_ = true;
+    graphStartUs_ = TraceSpan::nowUs();
+    startReadyTasks();
+}
+
+int InitTaskGraph::indexOf(const QString &name) const
+{
+    const QByteArray utf8Name = name.toUtf8();
+    for (int i = 0; i < tasks_.size(); ++i)
+    {
+        if (tasks_[i].name == utf8Name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void InitTaskGraph::startReadyTasks()
+{
+    for (int i = 0; i < tasks_.size(); ++i)
+    {
+        if (tasks_[i].state != STATE_WAITING)
+        {
+            continue;
+        }
+        bool isReady = true;
+        for (int dependency : qAsConst(tasks_[i].dependencies))
+        {
+            if (tasks_[dependency].state != STATE_FINISHED)
+            {
+                isReady = false;
+                break;
+            }
+        }
+        if (isReady)
+        {
+            runTask(i);
+        }
+    }
+}
+
+void InitTaskGraph::runTask(int ind)
+{
+    Task &task = tasks_[ind];
+    task.state = STATE_RUNNING;
+    task.startUs = TraceSpan::nowUs();
+
+    if (task.thread == THREAD_POOL)
+    {
+        const std::function<void()> func = task.func;
+        threadPool_.start(new PoolTask([this, ind, func]() {
+            func();
+            QMetaObject::invokeMethod(this, [this, ind]() { onTaskFinished(ind); }, Qt::QueuedConnection);
+        }));
+    }
+    else if (task.thread == THREAD_ENGINE)
+    {
+        // queued, so the tasks which became ready at the same time are started first
+        QMetaObject::invokeMethod(this, [this, ind]() {
+            tasks_[ind].func();
+            onTaskFinished(ind);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void InitTaskGraph::onTaskFinished(int ind)
+{
+    Task &task = tasks_[ind];
+    Q_ASSERT(task.state == STATE_RUNNING);
+    task.state = STATE_FINISHED;
+    task.finishUs = TraceSpan::nowUs();
+    TraceSpan::record("engine init", task.name.constData(), task.startUs);
+
+    countFinished_++;
+    if (countFinished_ == tasks_.size())
+    {
+        writeTimingsToLog();
+        emit finished();
+    }
+    else
+    {
+        startReadyTasks();
+    }
+}
+
+void InitTaskGraph::writeTimingsToLog() const
+{
+    qCDebug(LOG_BASIC) << "Engine init tasks, finished in" << (TraceSpan::nowUs() - graphStartUs_) / 1000 << "ms:";
+    int last = 0;
+    for (int i = 0; i < tasks_.size(); ++i)
+    {
+        const Task &task = tasks_[i];
+        qCDebug(LOG_BASIC).noquote() << QString("    %1 (%2): started at %3 ms, took %4 ms").arg(QString::fromUtf8(task.name))
+                                        .arg(threadName(task.thread)).arg((task.startUs - graphStartUs_) / 1000)
+                                        .arg((task.finishUs - task.startUs) / 1000);
+        if (task.finishUs > tasks_[last].finishUs)
+        {
+            last = i;
+        }
+    }
+
+    // from the last finished task back through the dependency which finished last
+    QStringList criticalPath;
+    int ind = last;
+    while (ind != -1)
+    {
+        const Task &task = tasks_[ind];
+        criticalPath.prepend(QString("%1 %2 ms").arg(QString::fromUtf8(task.name)).arg((task.finishUs - task.startUs) / 1000));
+        int next = -1;
+        for (int dependency : task.dependencies)
+        {
+            if (next == -1 || tasks_[dependency].finishUs > tasks_[next].finishUs)
+            {
+                next = dependency;
+            }
+        }
+        ind = next;
+    }
+    qCDebug(LOG_BASIC).noquote() << "Engine init critical path:" << criticalPath.join(" -> ");
+}
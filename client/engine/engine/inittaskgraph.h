@@ -0,0 +1,62 @@
+#ifndef INITTASKGRAPH_H
+#define INITTASKGRAPH_H
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+
+// The steps of the engine initialization with their dependencies. A task starts when all its dependencies
+// are finished, the independent ones run at the same time: the pool tasks on the own thread pool, the engine
+// tasks on the thread of the graph (for the QObjects), the external ones are asynchronous steps finished by
+// the owner (e.g. the helper connection).
+// Each task is written as a trace span, the timings and the critical path are written to the log at the end.
+// A failed external step is never finished, finished() isn't emitted then.
+class InitTaskGraph : public QObject
+{
+    Q_OBJECT
+public:
+    enum THREAD { THREAD_ENGINE, THREAD_POOL, THREAD_EXTERNAL };
+
+    explicit InitTaskGraph(QObject *parent);
+    virtual ~InitTaskGraph();
+
+    // the dependencies must be added before
+    void addTask(const QString &name, THREAD thread, const QStringList &dependencies, std::function<void()> func);
+    void addExternalTask(const QString &name, const QStringList &dependencies);
+    void finishExternalTask(const QString &name);
+
+    void start();
+
+signals:
+    void finished();
+
+private:
+    enum STATE { STATE_WAITING, STATE_RUNNING, STATE_FINISHED };
+
+    struct Task
+    {
+        QByteArray name;            // kept for the trace spans
+        THREAD thread;
+        QVector<int> dependencies;
+        std::function<void()> func;
+        STATE state;
+        qint64 startUs;
+        qint64 finishUs;
+    };
+
+    QVector<Task> tasks_;
+    QThreadPool threadPool_;
+    bool isStarted_;
+    qint64 graphStartUs_;
+    int countFinished_;
+
+    int indexOf(const QString &name) const;
+    void startReadyTasks();
+    void runTask(int ind);
+    void onTaskFinished(int ind);
+    void writeTimingsToLog() const;
+};
+
+#endif // INITTASKGRAPH_H
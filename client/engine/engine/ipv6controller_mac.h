@@ -3,8 +3,8 @@
 
 #include "engine/helper/helper_mac.h"
 
-#include <QMap>
-
+// IPv6 of the network services is changed by the helper through SCPreferences in one transaction,
+// the helper also keeps the states to restore
 class Ipv6Controller_mac
 {
 public:
@@ -24,15 +24,6 @@ private:
 
     bool bIsDisabled_;
     Helper_mac *helper_;
-
-
-    QMap<QString, QString> ipv6States_;
-
-    void saveIpv6States(const QStringList &networkIntefaces);
-    bool isEnabledIPv6(const QString &interface);
-    QString getStateFromSaved(const QString &interface);
-    QString getStateFromCmd(const QString &interface);
-
 };
 
 #endif // IPV6CONTROLLER_MAC_H
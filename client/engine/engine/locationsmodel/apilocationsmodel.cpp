@@ -1,14 +1,65 @@
 #include "apilocationsmodel.h"
 #include "utils/utils.h"
 #include <QFile>
+#include <QMap>
 #include <QTextStream>
+#include <algorithm>
+#include <limits.h>
 #include "utils/logger.h"
 #include "utils/ipvalidation.h"
+#include "utils/extraconfig.h"
+#include "engine/getdeviceid.h"
 #include "mutablelocationinfo.h"
 #include "nodeselectionalgorithm.h"
 
 namespace locationsmodel {
 
+namespace {
+
+// compares the lists in the form they are shown to the user, the ping times are sent separately by locationPingTimeChanged
+bool isSameForGui(const BestAndAllLocations &l1, const BestAndAllLocations &l2)
+{
+    if (l1.bestLocation != l2.bestLocation || l1.staticIpDeviceName != l2.staticIpDeviceName || l1.locations.isNull() != l2.locations.isNull())
+    {
+        return false;
+    }
+    if (l1.locations.isNull())
+    {
+        return true;
+    }
+    if (l1.locations->count() != l2.locations->count())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < l1.locations->count(); ++i)
+    {
+        const LocationItem &item1 = l1.locations->at(i);
+        const LocationItem &item2 = l2.locations->at(i);
+        if (item1.id != item2.id || item1.name != item2.name || item1.countryCode != item2.countryCode ||
+            item1.isPremiumOnly != item2.isPremiumOnly || item1.p2p != item2.p2p || item1.cities.count() != item2.cities.count())
+        {
+            return false;
+        }
+
+        for (int c = 0; c < item1.cities.count(); ++c)
+        {
+            const CityItem &city1 = item1.cities[c];
+            const CityItem &city2 = item2.cities[c];
+            if (city1.id != city2.id || city1.city != city2.city || city1.nick != city2.nick || city1.isPro != city2.isPro ||
+                city1.isDisabled != city2.isDisabled || city1.link_speed != city2.link_speed || city1.health != city2.health ||
+                city1.staticIpCountryCode != city2.staticIpCountryCode || city1.staticIpType != city2.staticIpType ||
+                city1.staticIp != city2.staticIp)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 ApiLocationsModel::ApiLocationsModel(QObject *parent, IConnectStateController *stateController, INetworkDetectionManager *networkDetectionManager, PingHost *pingHost) : QObject(parent),
     pingStorage_("pingStorage"),
     pingIpsController_(this, stateController, networkDetectionManager, pingHost, "ping_log.txt")
@@ -40,72 +91,150 @@ void ApiLocationsModel::setLocations(const QVector<apiinfo::Location> &locations
         return;
     }
 
+    logChanges(locations);
     locations_ = locations;
+    arena_ = apiinfo::LocationsArena(locations);
     staticIps_ = staticIps;
-
-    whitelistIps();
+    buildIndexes();
 
     // ping stuff
-    QVector<PingIpInfo> ips;
     QStringList stringListIps;
-    for (const apiinfo::Location &l : locations)
+    for (int i = 0; i < arena_.groupsCount(); ++i)
     {
-        for (int i = 0; i < l.groupsCount(); ++i)
-        {
-            QString pingIp = l.getGroup(i).getPingIp();
-            ips << PingIpInfo(pingIp, PingHost::PING_TCP);
-            stringListIps << pingIp;
-        }
+        stringListIps << arena_.string(arena_.group(i).pingIp);
     }
 
     // handle static ips location
     for (int i = 0; i < staticIps_.getIpsCount(); ++i)
     {
-        const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
-        QString pingIp = sid.getPingIp();
-        ips << PingIpInfo(pingIp, PingHost::PING_TCP);
-        stringListIps << pingIp;
+        stringListIps << staticIps_.getIp(i).getPingIp();
+    }
+
+    // the nodes of the groups may change without changing the ping IPs, no need to restart the pings then
+    if (stringListIps != lastPingIps_)
+    {
+        lastPingIps_ = stringListIps;
+        whitelistIps();
+        // ordered by the stored latencies, before they are updated for the new list
+        const QVector<PingIpInfo> ips = pingIpsInWarmUpOrder();
+        pingStorage_.updateNodes(stringListIps);
+        pingIpsController_.updateIps(ips);
+    }
+
+    BestAndAllLocations ball = generateLocationsUpdated();
+    if (isSameForGui(ball, lastSentLocations_))
+    {
+        qCDebug(LOG_BASIC) << "ApiLocationsModel::setLocations, the list of locations is not changed for the GUI";
+        return;
+    }
+    lastSentLocations_ = ball;
+    Q_EMIT locationsUpdated(ball.bestLocation, ball.staticIpDeviceName, ball.locations);
+}
+
+QVector<PingIpInfo> ApiLocationsModel::pingIpsInWarmUpOrder() const
+{
+    // one group per location is pinged first: the last best location, otherwise the enabled group with the lowest stored latency;
+    // the locations are ordered by that latency, the unknown ones last in the order of the API
+    struct WarmUpGroup
+    {
+        int group;
+        int latency;
+    };
+    const LocationID bestId = bestLocation_.isValid() ? bestLocation_.getId() : LocationID();
+    auto storedLatency = [this](int group) {
+        const int timeMs = pingStorage_.getNodeSpeed(arena_.string(arena_.group(group).pingIp)).toInt();
+        return timeMs >= 0 ? timeMs : INT_MAX;
+    };
+
+    QVector<WarmUpGroup> warmUpGroups;
+    QVector<bool> isWarmUp(arena_.groupsCount(), false);
+    for (int l = 0; l < arena_.locationsCount(); ++l)
+    {
+        const apiinfo::LocationsArena::LocationEntry &le = arena_.location(l);
+        WarmUpGroup best = { -1, INT_MAX };
+        for (int g = le.groupsBegin; g < le.groupsEnd; ++g)
+        {
+            if (bestId.isValid() && arena_.group(g).id == bestId)
+            {
+                best = { g, -1 };
+                break;
+            }
+            if (arena_.group(g).isDisabled())
+            {
+                continue;
+            }
+            const int latency = storedLatency(g);
+            if (best.group == -1 || latency < best.latency)
+            {
+                best = { g, latency };
+            }
+        }
+        if (best.group != -1)
+        {
+            warmUpGroups << best;
+            isWarmUp[best.group] = true;
+        }
     }
+    std::stable_sort(warmUpGroups.begin(), warmUpGroups.end(), [](const WarmUpGroup &g1, const WarmUpGroup &g2) {
+        return g1.latency < g2.latency;
+    });
 
-    pingStorage_.updateNodes(stringListIps);
-    pingIpsController_.updateIps(ips);
-    sendLocationsUpdated();
+    QVector<PingIpInfo> ips;
+    ips.reserve(arena_.groupsCount() + staticIps_.getIpsCount());
+    for (const WarmUpGroup &wg : qAsConst(warmUpGroups))
+    {
+        ips << PingIpInfo(arena_.string(arena_.group(wg.group).pingIp), PingHost::PING_TCP, true);
+    }
+    for (int i = 0; i < arena_.groupsCount(); ++i)
+    {
+        if (!isWarmUp[i])
+        {
+            ips << PingIpInfo(arena_.string(arena_.group(i).pingIp), PingHost::PING_TCP);
+        }
+    }
+    for (int i = 0; i < staticIps_.getIpsCount(); ++i)
+    {
+        ips << PingIpInfo(staticIps_.getIp(i).getPingIp(), PingHost::PING_TCP);
+    }
+    return ips;
 }
 
 void ApiLocationsModel::clear()
 {
     locations_.clear();
+    arena_ = apiinfo::LocationsArena();
     staticIps_ = apiinfo::StaticIps();
+    buildIndexes();
+    lastPingIps_.clear();
+    lastSentLocations_ = BestAndAllLocations();
     pingIpsController_.updateIps(QVector<PingIpInfo>());
     QSharedPointer<QVector<locationsmodel::LocationItem> > empty(new QVector<locationsmodel::LocationItem>());
     Q_EMIT locationsUpdated(LocationID(), QString(),  empty);
 }
 
+void ApiLocationsModel::dumpPingLogDetails()
+{
+    pingIpsController_.dumpPingLogDetails();
+}
+
 QSharedPointer<BaseLocationInfo> ApiLocationsModel::getMutableLocationInfoById(const LocationID &locationId)
 {
     LocationID modifiedLocationId = locationId;
 
     if (locationId.isStaticIpsLocation())
     {
-        if (staticIps_.getIpsCount() > 0)
+        const auto it = staticIpsIndexes_.constFind(locationId);
+        if (it != staticIpsIndexes_.constEnd())
         {
-            for (int i = 0; i < staticIps_.getIpsCount(); ++i)
-            {
-                const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
-                LocationID staticIpLocationId = LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp);
+            const apiinfo::StaticIpDescr &sid = staticIps_.getIp(it.value());
+            QVector< QSharedPointer<const BaseNode> > nodes;
 
-                if (staticIpLocationId == locationId)
-                {
-                    QVector< QSharedPointer<const BaseNode> > nodes;
+            QStringList ips;
+            ips << sid.nodeIP1 << sid.nodeIP2 << sid.nodeIP3;
+            nodes << QSharedPointer<BaseNode>(new StaticLocationNode(ips, sid.hostname, sid.wgPubKey, sid.wgIp, sid.dnsHostname, sid.username, sid.password, sid.getAllStaticIpIntPorts()));
 
-                    QStringList ips;
-                    ips << sid.nodeIP1 << sid.nodeIP2 << sid.nodeIP3;
-                    nodes << QSharedPointer<BaseNode>(new StaticLocationNode(ips, sid.hostname, sid.wgPubKey, sid.wgIp, sid.dnsHostname, sid.username, sid.password, sid.getAllStaticIpIntPorts()));
-
-                    QSharedPointer<BaseLocationInfo> bli(new MutableLocationInfo(locationId, sid.cityName + " - " + sid.staticIp, nodes, 0, "", sid.ovpnX509));
-                    return bli;
-                }
-            }
+            QSharedPointer<BaseLocationInfo> bli(new MutableLocationInfo(locationId, sid.cityName + " - " + sid.staticIp, nodes, QVector<int>() << 0, "", sid.ovpnX509));
+            return bli;
         }
     }
     else if (locationId.isBestLocation())
@@ -113,45 +242,43 @@ QSharedPointer<BaseLocationInfo> ApiLocationsModel::getMutableLocationInfoById(c
         modifiedLocationId = locationId.bestLocationToApiLocation();
     }
 
-    for (const apiinfo::Location &l : locations_)
+    const auto itLocation = locationsIndexes_.constFind(modifiedLocationId.toTopLevelLocation());
+    const auto itGroup = groupsIndexes_.constFind(modifiedLocationId);
+    if (itLocation == locationsIndexes_.constEnd() || itGroup == groupsIndexes_.constEnd())
     {
-        if (LocationID::createTopApiLocationId(l.getId()) == modifiedLocationId.toTopLevelLocation())
-        {
-            for (int i = 0; i < l.groupsCount(); ++i)
-            {
-                const apiinfo::Group group = l.getGroup(i);
-                if (LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick()) == modifiedLocationId)
-                {
-                    QVector< QSharedPointer<const BaseNode> > nodes;
-                    for (int n = 0; n < group.getNodesCount(); ++n)
-                    {
-                        const apiinfo::Node &apiInfoNode = group.getNode(n);
-                        QStringList ips;
-                        ips << apiInfoNode.getIp(0) << apiInfoNode.getIp(1) << apiInfoNode.getIp(2);
-                        nodes << QSharedPointer<const ApiLocationNode>(new ApiLocationNode(ips, apiInfoNode.getHostname(), apiInfoNode.getWeight(), group.getWgPubKey()));
-                    }
-
-                    // once API server list is updated so that the old WINDFLIX locations' dns_hostname matches that of the containing region this code can be removed
-                    QString dnsHostname;
-                    if (!group.getDnsHostName().isEmpty())
-                    {
-                        dnsHostname = group.getDnsHostName();
-                        qCDebug(LOG_BASIC) << "Overriding DNS hostname for old WINDFLIX location with: " << dnsHostname;
-                    }
-                    else
-                    {
-                        dnsHostname =  l.getDnsHostName();
-                    }
+        return NULL;
+    }
 
-                    int selectedNode = NodeSelectionAlgorithm::selectRandomNodeBasedOnWeight(nodes);
-                    QSharedPointer<BaseLocationInfo> bli(new MutableLocationInfo(modifiedLocationId, group.getCity() + " - " + group.getNick(), nodes, selectedNode,dnsHostname, group.getOvpnX509()));
-                    return bli;
-                }
-            }
+    const apiinfo::LocationsArena::LocationEntry &le = arena_.location(itLocation.value());
+    const apiinfo::LocationsArena::GroupEntry &group = arena_.group(itGroup.value());
+    QVector< QSharedPointer<const BaseNode> > nodes;
+    for (int n = group.nodesBegin; n < group.nodesEnd; ++n)
+    {
+        const apiinfo::LocationsArena::NodeEntry &apiInfoNode = arena_.node(n);
+        QStringList ips;
+        for (int ip = 0; ip < 3; ++ip)
+        {
+            ips << apiinfo::LocationsArena::ipToString(apiInfoNode.ips[ip]);
         }
+        nodes << QSharedPointer<const ApiLocationNode>(new ApiLocationNode(ips, arena_.string(apiInfoNode.hostname), apiInfoNode.weight, arena_.string(group.wgPubKey)));
+    }
+
+    // once API server list is updated so that the old WINDFLIX locations' dns_hostname matches that of the containing region this code can be removed
+    QString dnsHostname;
+    if (!arena_.string(group.dnsHostName).isEmpty())
+    {
+        dnsHostname = arena_.string(group.dnsHostName);
+        qCDebug(LOG_BASIC) << "Overriding DNS hostname for old WINDFLIX location with: " << dnsHostname;
+    }
+    else
+    {
+        dnsHostname = arena_.string(le.dnsHostName);
     }
 
-    return NULL;
+    const QString rendezvousKey = ExtraConfig::instance().getUseRendezvousNodeSelection() ? GetDeviceId::instance().getDeviceId() : QString();
+    const QVector<int> nodesOrder = NodeSelectionAlgorithm::getNodesOrder(nodes, rendezvousKey);
+    QSharedPointer<BaseLocationInfo> bli(new MutableLocationInfo(modifiedLocationId, arena_.string(group.city) + " - " + arena_.string(group.nick), nodes, nodesOrder, dnsHostname, arena_.string(group.ovpnX509)));
+    return bli;
 }
 
 void ApiLocationsModel::onPingInfoChanged(const QString &ip, int timems, bool isFromDisconnectedState)
@@ -167,29 +294,18 @@ void ApiLocationsModel::onPingInfoChanged(const QString &ip, int timems, bool is
         detectBestLocation(isAllNodesInDisconnectedState);
     }
 
-    for (const apiinfo::Location &l : locations_)
+    const QList<int> groups = groupsByPingIp_.values(ip);
+    for (int i : groups)
     {
-        for (int i = 0; i < l.groupsCount(); ++i)
-        {
-            const apiinfo::Group group = l.getGroup(i);
-            if (group.getPingIp() == ip)
-            {
-                Q_EMIT locationPingTimeChanged(LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick()), timems);
-            }
-        }
+        Q_EMIT locationPingTimeChanged(arena_.group(i).id, timems);
     }
 
     // handle static ips location
-    if (staticIps_.getIpsCount() > 0)
+    const QList<int> staticIps = staticIpsByPingIp_.values(ip);
+    for (int i : staticIps)
     {
-        for (int i = 0; i < staticIps_.getIpsCount(); ++i)
-        {
-            const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
-            if (sid.getPingIp() == ip)
-            {
-                Q_EMIT locationPingTimeChanged(LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp), timems);
-            }
-        }
+        const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
+        Q_EMIT locationPingTimeChanged(LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp), timems);
     }
 }
 
@@ -209,43 +325,47 @@ void ApiLocationsModel::detectBestLocation(bool isAllNodesInDisconnectedState)
 
     int prevBestLocationLatency = INT_MAX;
 
-    int ind = 0;
-    for (const apiinfo::Location &l : locations_)
+    for (int i = 0; i < arena_.groupsCount(); ++i)
     {
-        for (int i = 0; i < l.groupsCount(); ++i)
-        {
-            const apiinfo::Group group = l.getGroup(i);
+        const apiinfo::LocationsArena::GroupEntry &group = arena_.group(i);
 
-            if (group.isDisabled())
-            {
-                continue;
-            }
+        if (group.isDisabled())
+        {
+            continue;
+        }
 
-            LocationID lid = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick());
-            int latency = pingStorage_.getNodeSpeed(group.getPingIp()).toInt();
+        const LocationID &lid = group.id;
+        const QString &pingIp = arena_.string(group.pingIp);
+        int latency = pingStorage_.getNodeSpeed(pingIp).toInt();
 
-            // we assume a maximum ping time for three bars when no ping info
-            if (latency == PingTime::NO_PING_INFO)
-            {
-                latency = PingTime::LATENCY_STEP1;
-            }
-            else if (latency == PingTime::PING_FAILED)
-            {
-                latency = PingTime::MAX_LATENCY_FOR_PING_FAILED;
-            }
-
-            if (bestLocation_.isValid() && lid == bestLocation_.getId())
-            {
-                prevBestLocationLatency = latency;
-            }
-            if (latency != PingTime::PING_FAILED && latency < minLatency)
+        // we assume a maximum ping time for three bars when no ping info
+        if (latency == PingTime::NO_PING_INFO)
+        {
+            latency = PingTime::LATENCY_STEP1;
+        }
+        else if (latency == PingTime::PING_FAILED)
+        {
+            latency = PingTime::MAX_LATENCY_FOR_PING_FAILED;
+        }
+        else
+        {
+            // compare by the score of the recent pings (jitter and loss), not only by the last sample
+            const LatencyStats stats = pingStorage_.getNodeStats(pingIp);
+            if (!stats.isEmpty())
             {
-                minLatency = latency;
-                locationIdWithMinLatency = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick()) ;
+                latency = stats.score();
             }
         }
 
-        ind++;
+        if (bestLocation_.isValid() && lid == bestLocation_.getId())
+        {
+            prevBestLocationLatency = latency;
+        }
+        if (latency != PingTime::PING_FAILED && latency < minLatency)
+        {
+            minLatency = latency;
+            locationIdWithMinLatency = lid;
+        }
     }
 
     LocationID prevBestLocationId;
@@ -319,27 +439,29 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
     BestAndAllLocations ball;
     bool isBestLocationValid = false;
 
-    for (const apiinfo::Location &l : locations_)
+    for (int l = 0; l < arena_.locationsCount(); ++l)
     {
+        const apiinfo::LocationsArena::LocationEntry &le = arena_.location(l);
         LocationItem item;
-        item.id = LocationID::createTopApiLocationId(l.getId());
-        item.name = l.getName();
-        item.countryCode = l.getCountryCode();
-        item.isPremiumOnly = l.isPremiumOnly();
-        item.p2p = l.getP2P();
+        item.id = le.id;
+        item.name = arena_.string(le.name);
+        item.countryCode = arena_.string(le.countryCode);
+        item.isPremiumOnly = le.isPremiumOnly;
+        item.p2p = le.p2p;
 
-        for (int i = 0; i < l.groupsCount(); ++i)
+        for (int i = le.groupsBegin; i < le.groupsEnd; ++i)
         {
-            const apiinfo::Group group = l.getGroup(i);
+            const apiinfo::LocationsArena::GroupEntry &group = arena_.group(i);
             CityItem city;
-            city.id = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick());
-            city.city = group.getCity();
-            city.nick = group.getNick();
-            city.isPro = group.isPro();
-            city.pingTimeMs = pingStorage_.getNodeSpeed(group.getPingIp());
+            city.id = group.id;
+            city.city = arena_.string(group.city);
+            city.nick = arena_.string(group.nick);
+            city.isPro = group.isPro;
+            city.pingTimeMs = pingStorage_.getNodeSpeed(arena_.string(group.pingIp));
+            city.latencyStats = pingStorage_.getNodeStats(arena_.string(group.pingIp));
             city.isDisabled = group.isDisabled();
-            city.link_speed = group.getLinkSpeed();
-            city.health = group.getHealth();
+            city.link_speed = group.linkSpeed;
+            city.health = group.health;
             item.cities << city;
 
             if (!isBestLocationValid && bestLocation_.isValid() && bestLocation_.getId() == city.id && !city.isDisabled)
@@ -396,6 +518,7 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
             city.id = LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp);
             city.city = sid.cityName;
             city.pingTimeMs = pingStorage_.getNodeSpeed(sid.getPingIp());
+            city.latencyStats = pingStorage_.getNodeStats(sid.getPingIp());
             city.isPro = true;
             city.isDisabled = false;
             city.staticIpCountryCode = sid.countryCode;
@@ -413,21 +536,44 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
     return ball;
 }
 
-void ApiLocationsModel::sendLocationsUpdated()
+void ApiLocationsModel::buildIndexes()
 {
-    BestAndAllLocations ball = generateLocationsUpdated();
-    Q_EMIT locationsUpdated(ball.bestLocation, ball.staticIpDeviceName, ball.locations);
+    // built once per list, the lookups by ID and the pings (one per ping IP of each round) don't scan the list
+    locationsIndexes_.clear();
+    groupsIndexes_.clear();
+    staticIpsIndexes_.clear();
+    groupsByPingIp_.clear();
+    staticIpsByPingIp_.clear();
+
+    locationsIndexes_.reserve(arena_.locationsCount());
+    for (int l = 0; l < arena_.locationsCount(); ++l)
+    {
+        locationsIndexes_.insert(arena_.location(l).id, l);
+    }
+    groupsIndexes_.reserve(arena_.groupsCount());
+    groupsByPingIp_.reserve(arena_.groupsCount());
+    for (int i = 0; i < arena_.groupsCount(); ++i)
+    {
+        const apiinfo::LocationsArena::GroupEntry &group = arena_.group(i);
+        groupsIndexes_.insert(group.id, i);
+        groupsByPingIp_.insert(arena_.string(group.pingIp), i);
+    }
+    staticIpsIndexes_.reserve(staticIps_.getIpsCount());
+    staticIpsByPingIp_.reserve(staticIps_.getIpsCount());
+    for (int i = 0; i < staticIps_.getIpsCount(); ++i)
+    {
+        const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
+        staticIpsIndexes_.insert(LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp), i);
+        staticIpsByPingIp_.insert(sid.getPingIp(), i);
+    }
 }
 
 void ApiLocationsModel::whitelistIps()
 {
     QStringList ips;
-    for (const apiinfo::Location &l : locations_)
+    for (int i = 0; i < arena_.groupsCount(); ++i)
     {
-        for (int i = 0; i < l.groupsCount(); ++i)
-        {
-            ips << l.getGroup(i).getPingIp();
-        }
+        ips << arena_.string(arena_.group(i).pingIp);
     }
     ips << staticIps_.getAllPingIps();
     Q_EMIT whitelistIpsChanged(ips);
@@ -438,5 +584,35 @@ bool ApiLocationsModel::isChanged(const QVector<apiinfo::Location> &locations, c
     return locations_ != locations || staticIps_ != staticIps;
 }
 
+void ApiLocationsModel::logChanges(const QVector<apiinfo::Location> &locations)
+{
+    QMap<int, const apiinfo::Location *> oldLocations;
+    for (const apiinfo::Location &l : qAsConst(locations_))
+    {
+        oldLocations[l.getId()] = &l;
+    }
+
+    int added = 0, changed = 0;
+    for (const apiinfo::Location &l : locations)
+    {
+        auto it = oldLocations.find(l.getId());
+        if (it == oldLocations.end())
+        {
+            added++;
+        }
+        else
+        {
+            if (*it.value() != l)
+            {
+                changed++;
+            }
+            oldLocations.erase(it);
+        }
+    }
+
+    qCDebug(LOG_BASIC) << "ApiLocationsModel::setLocations, locations added:" << added << ", changed:" << changed
+                       << ", removed:" << oldLocations.count();
+}
+
 
 } //namespace locationsmodel
@@ -1,8 +1,10 @@
 #ifndef APILOCATIONSMODEL_H
 #define APILOCATIONSMODEL_H
 
+#include <QHash>
 #include <QObject>
 #include "engine/apiinfo/location.h"
+#include "engine/apiinfo/locationsarena.h"
 #include "engine/apiinfo/staticips.h"
 #include "types/locationid.h"
 #include "engine/proxy/proxysettings.h"
@@ -33,6 +35,7 @@ public:
     void generateLocationsUpdatedForCliOnly();
     void setLocations(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps);
     void clear();
+    void dumpPingLogDetails();
 
     QSharedPointer<BaseLocationInfo> getMutableLocationInfoById(const LocationID &locationId);
 
@@ -52,19 +55,34 @@ private slots:
 
 private:
     PingStorage pingStorage_;
-    QVector<apiinfo::Location> locations_;
+    QVector<apiinfo::Location> locations_;     // only to detect and log the changes
+    apiinfo::LocationsArena arena_;
     apiinfo::StaticIps staticIps_;
 
+    // indexes into arena_ and staticIps_, rebuilt with them
+    QHash<LocationID, int> locationsIndexes_;
+    QHash<LocationID, int> groupsIndexes_;
+    QHash<LocationID, int> staticIpsIndexes_;
+    QMultiHash<QString, int> groupsByPingIp_;
+    QMultiHash<QString, int> staticIpsByPingIp_;
+
     BestLocation bestLocation_;
 
     PingIpsController pingIpsController_;
 
+    // the last list sent with locationsUpdated, to skip the signal (and the GUI rebuild) if the update
+    // changed only the data invisible in the list, e.g. nodes of the groups
+    BestAndAllLocations lastSentLocations_;
+    QStringList lastPingIps_;
+
     void detectBestLocation(bool isAllNodesInDisconnectedState);
     BestAndAllLocations generateLocationsUpdated();
-    void sendLocationsUpdated();
+    void buildIndexes();
     void whitelistIps();
+    QVector<PingIpInfo> pingIpsInWarmUpOrder() const;
 
     bool isChanged(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps);
+    void logChanges(const QVector<apiinfo::Location> &locations);
 };
 
 } //namespace locationsmodel
@@ -1,6 +1,6 @@
 #include "bestlocation.h"
 
-#include <QSettings>
+#include "utils/settingsstore.h"
 
 namespace locationsmodel {
 
@@ -57,17 +57,15 @@ void BestLocation::saveToSettings()
         QByteArray arr(size, Qt::Uninitialized);
         b.SerializeToArray(arr.data(), size);
 
-        QSettings settings;
-        settings.setValue("bestLocation", arr);
+        SettingsStore::instance().setValue("bestLocation", arr);
     }
 }
 
 void BestLocation::loadFromSettings()
 {
-    QSettings settings;
-    if (settings.contains("bestLocation"))
+    if (SettingsStore::instance().contains("bestLocation"))
     {
-        QByteArray arr = settings.value("bestLocation").toByteArray();
+        QByteArray arr = SettingsStore::instance().value("bestLocation").toByteArray();
         ProtoApiInfo::BestLocation b;
         if (b.ParseFromArray(arr.data(), arr.size()))
         {
@@ -3,6 +3,7 @@
 #include "utils/logger.h"
 #include "engine/dnsresolver/dnsrequest.h"
 #include "engine/dnsresolver/dnsserversconfiguration.h"
+#include "engine/dnsresolver/hostnameresolvecache.h"
 #include "engine/customconfigs/ovpncustomconfig.h"
 #include "engine/customconfigs/wireguardcustomconfig.h"
 
@@ -78,7 +79,6 @@ void CustomConfigLocationInfo::resolveHostnamesForWireGuardConfig()
     globalPort_ = config->getEndpointPort();
     globalProtocol_ = "WireGuard";
 
-    bool isExistsHostnames = false;
     const auto remotes = config->hostnames();
     for (const auto &remote : remotes)
     {
@@ -90,19 +90,10 @@ void CustomConfigLocationInfo::resolveHostnamesForWireGuardConfig()
         {
             rd.isHostname = true;
             rd.isResolved = false;
-            isExistsHostnames = true;
-
-            DnsRequest *dnsRequest = new DnsRequest(this, remote, DnsServersConfiguration::instance().getCurrentDnsServers());
-            connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
-            dnsRequest->lookup();
         }
         remotes_ << rd;
     }
-    if (!isExistsHostnames)
-    {
-        bAllResolved_ = true;
-        emit hostnamesResolved();
-    }
+    lookupHostnames();
 }
 
 void CustomConfigLocationInfo::resolveHostnamesForOVPNConfig()
@@ -117,7 +108,6 @@ void CustomConfigLocationInfo::resolveHostnamesForOVPNConfig()
     globalPort_ = config->globalPort();
     globalProtocol_ = config->globalProtocol();
 
-    bool isExistsHostnames = false;
     const QVector<customconfigs::RemoteCommandLine> remotes = config->remotes();
     for (const auto &remote : remotes)
     {
@@ -145,19 +135,44 @@ void CustomConfigLocationInfo::resolveHostnamesForOVPNConfig()
             rd.remoteCmdLine = remote.originalRemoteCommand;
 
             remotes_ << rd;
+        }
+    }
+    lookupHostnames();
+}
 
-            isExistsHostnames = true;
-
-            DnsRequest *dnsRequest = new DnsRequest(this, remote.hostname, DnsServersConfiguration::instance().getCurrentDnsServers());
-            connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
-            dnsRequest->lookup();
+void CustomConfigLocationInfo::lookupHostnames()
+{
+    // the hostnames prefetched when the configs were parsed are not queried again
+    QStringList notCached;
+    for (int i = 0; i < remotes_.count(); ++i)
+    {
+        if (remotes_[i].isHostname && !remotes_[i].isResolved)
+        {
+            QStringList ips;
+            if (HostnameResolveCache::instance().get(remotes_[i].ipOrHostname_, ips))
+            {
+                remotes_[i].ipsForHostname_ = ips;
+                remotes_[i].isResolved = true;
+                qCDebug(LOG_CONNECTION) << "Hostname:" << remotes_[i].ipOrHostname_ << " from cache -> " << ips.join("; ");
+            }
+            else if (!notCached.contains(remotes_[i].ipOrHostname_))
+            {
+                notCached << remotes_[i].ipOrHostname_;
+            }
         }
     }
-    if (!isExistsHostnames)
+
+    if (notCached.isEmpty())
     {
         bAllResolved_ = true;
         emit hostnamesResolved();
+        return;
     }
+
+    // all the remotes are resolved by one batch, a hostname repeated in several remotes is queried once
+    DnsBatchRequest *dnsRequest = new DnsBatchRequest(this, notCached, DnsServersConfiguration::instance().getCurrentDnsServers());
+    connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
+    dnsRequest->lookup();
 }
 
 QString CustomConfigLocationInfo::getSelectedIp() const
@@ -290,45 +305,34 @@ QString CustomConfigLocationInfo::getLogString() const
 
 void CustomConfigLocationInfo::onDnsRequestFinished()
 {
-    DnsRequest *dnsRequest = qobject_cast<DnsRequest *>(sender());
+    DnsBatchRequest *dnsRequest = qobject_cast<DnsBatchRequest *>(sender());
     Q_ASSERT(dnsRequest != nullptr);
 
     for (int i = 0; i < remotes_.count(); ++i)
     {
-        if (remotes_[i].isHostname && remotes_[i].ipOrHostname_ == dnsRequest->hostname())
+        if (remotes_[i].isHostname && !remotes_[i].isResolved)
         {
             QString strIps;
-            for (const QString &ip : dnsRequest->ips())
+            for (const QString &ip : dnsRequest->ips(remotes_[i].ipOrHostname_))
             {
                 remotes_[i].ipsForHostname_ << ip;
                 strIps += ip + "; ";
             }
 
-            qCDebug(LOG_CONNECTION) << "Hostname:" << dnsRequest->hostname() << " resolved -> " << strIps;
+            qCDebug(LOG_CONNECTION) << "Hostname:" << remotes_[i].ipOrHostname_ << " resolved -> " << strIps;
             remotes_[i].isResolved = true;
-            break;
+            if (!dnsRequest->isError(remotes_[i].ipOrHostname_))
+            {
+                HostnameResolveCache::instance().put(remotes_[i].ipOrHostname_, remotes_[i].ipsForHostname_,
+                                                     dnsRequest->ttl(remotes_[i].ipOrHostname_));
+            }
         }
     }
 
-    if (isAllResolved())
-    {
-        bAllResolved_ = true;
-        emit hostnamesResolved();
-    }
+    bAllResolved_ = true;
+    emit hostnamesResolved();
     dnsRequest->deleteLater();
 }
 
-bool CustomConfigLocationInfo::isAllResolved() const
-{
-    for (int i = 0; i < remotes_.count(); ++i)
-    {
-        if (remotes_[i].isHostname && !remotes_[i].isResolved)
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
 
 } //namespace locationsmodel
@@ -56,6 +56,8 @@ private:
 
     void resolveHostnamesForWireGuardConfig();
     void resolveHostnamesForOVPNConfig();
+    // the hostnames of remotes_ which are not resolved yet
+    void lookupHostnames();
 
     QSharedPointer<const customconfigs::ICustomConfig> config_;
     QVector<RemoteDescr> remotes_;
@@ -67,8 +69,6 @@ private:
     int selectedHostname_;  // index in remotes_[selected].ipsForHostname, or 0 if
                             // remotes_[selected].isHostname == false
 
-    bool isAllResolved() const;
-
 };
 
 } //namespace locationsmodel
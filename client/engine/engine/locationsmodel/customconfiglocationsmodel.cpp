@@ -25,15 +25,29 @@ CustomConfigLocationsModel::CustomConfigLocationsModel(QObject *parent, IConnect
 void CustomConfigLocationsModel::setCustomConfigs(const QVector<QSharedPointer<const customconfigs::ICustomConfig> > &customConfigs)
 {
     // todo synchronize ping time for two instances of PingIpsController
-    // todo: check if configs actually changed
     // todo: dns-resolver cache
 
+    // CustomConfigs keeps the objects of the unchanged configs, so their resolved ips and ping times are kept
+    QHash<const customconfigs::ICustomConfig *, CustomConfigWithPingInfo> prevPingInfos;
+    for (const CustomConfigWithPingInfo &cc : qAsConst(pingInfos_))
+    {
+        prevPingInfos.insert(cc.customConfig.data(), cc);
+    }
+
     QStringList hostnamesForResolve;
-    QVector<PingIpInfo> allIps;
+    int keptCount = 0;
     // fill pingInfos_ array
     pingInfos_.clear();
     for (auto config : customConfigs)
     {
+        auto prevIt = prevPingInfos.constFind(config.data());
+        if (prevIt != prevPingInfos.constEnd())
+        {
+            pingInfos_ << *prevIt;
+            keptCount++;
+            continue;
+        }
+
         CustomConfigWithPingInfo cc;
         cc.customConfig = config;
 
@@ -47,7 +61,6 @@ void CustomConfigLocationsModel::setCustomConfigs(const QVector<QSharedPointer<c
 
             if (!ri.isHostname)
             {
-                allIps << PingIpInfo(hostname, PingHost::PING_ICMP);
                 ri.ipOrHostname.pingTime = pingStorage_.getNodeSpeed(hostname);
             }
             else
@@ -60,6 +73,8 @@ void CustomConfigLocationsModel::setCustomConfigs(const QVector<QSharedPointer<c
 
         pingInfos_ << cc;
     }
+    qCDebug(LOG_BASIC) << "Custom config locations:" << pingInfos_.size() - keptCount << "new or updated,"
+                       << prevPingInfos.size() - keptCount << "removed or updated";
 
     generateLocationsUpdated();
 
@@ -69,12 +84,11 @@ void CustomConfigLocationsModel::setCustomConfigs(const QVector<QSharedPointer<c
     }
     else
     {
-        for (const QString &hostname : hostnamesForResolve)
-        {
-            DnsRequest *dnsRequest = new DnsRequest(this, hostname, DnsServersConfiguration::instance().getCurrentDnsServers());
-            connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
-            dnsRequest->lookup();
-        }
+        // the remotes of all the configs are resolved by one batch, each one is applied as soon as it's resolved
+        DnsBatchRequest *dnsRequest = new DnsBatchRequest(this, hostnamesForResolve, DnsServersConfiguration::instance().getCurrentDnsServers());
+        connect(dnsRequest, SIGNAL(hostResolved(QString, QStringList, bool)), SLOT(onDnsRequestHostResolved(QString, QStringList)));
+        connect(dnsRequest, SIGNAL(finished()), dnsRequest, SLOT(deleteLater()));
+        dnsRequest->lookup();
     }
 }
 
@@ -86,6 +100,11 @@ void CustomConfigLocationsModel::clear()
     Q_EMIT locationsUpdated(empty);
 }
 
+void CustomConfigLocationsModel::dumpPingLogDetails()
+{
+    pingIpsController_.dumpPingLogDetails();
+}
+
 QSharedPointer<BaseLocationInfo> CustomConfigLocationsModel::getMutableLocationInfoById(const LocationID &locationId)
 {
     Q_ASSERT(locationId.isCustomConfigsLocation());
@@ -120,21 +139,18 @@ void CustomConfigLocationsModel::onNeedIncrementPingIteration()
     pingStorage_.incIteration();
 }
 
-void CustomConfigLocationsModel::onDnsRequestFinished()
+void CustomConfigLocationsModel::onDnsRequestHostResolved(const QString &hostname, const QStringList &ips)
 {
-    DnsRequest *dnsRequest = qobject_cast<DnsRequest *>(sender());
-    Q_ASSERT(dnsRequest != nullptr);
-
     for (auto it = pingInfos_.begin(); it != pingInfos_.end(); ++it)
     {
         for (auto remoteIt = it->remotes.begin(); remoteIt != it->remotes.end(); ++remoteIt)
         {
-            if (remoteIt->isHostname && remoteIt->ipOrHostname.ip == dnsRequest->hostname())
+            if (remoteIt->isHostname && remoteIt->ipOrHostname.ip == hostname)
             {
                 remoteIt->isResolved = true;
                 remoteIt->ips.clear();
 
-                for (const QString &ip : dnsRequest->ips())
+                for (const QString &ip : ips)
                 {
                     IpItem ipItem;
                     ipItem.ip = ip;
@@ -150,7 +166,6 @@ void CustomConfigLocationsModel::onDnsRequestFinished()
     {
         startPingAndWhitelistIps();
     }
-    dnsRequest->deleteLater();
 }
 
 bool CustomConfigLocationsModel::isAllResolved() const
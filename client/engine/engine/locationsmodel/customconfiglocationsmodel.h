@@ -28,6 +28,7 @@ public:
 
     void setCustomConfigs(const QVector<QSharedPointer<const customconfigs::ICustomConfig>> &customConfigs);
     void clear();
+    void dumpPingLogDetails();
 
     QSharedPointer<BaseLocationInfo> getMutableLocationInfoById(const LocationID &locationId);
 
@@ -43,7 +44,7 @@ signals:
 private slots:
     void onPingInfoChanged(const QString &ip, int timems, bool isFromDisconnectedState);
     void onNeedIncrementPingIteration();
-    void onDnsRequestFinished();
+    void onDnsRequestHostResolved(const QString &hostname, const QStringList &ips);
 
 private:
     PingStorage pingStorage_;
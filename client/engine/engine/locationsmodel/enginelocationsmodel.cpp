@@ -58,6 +58,12 @@ void LocationsModel::clear()
     customConfigLocationsModel_->clear();
 }
 
+void LocationsModel::dumpPingLogDetails()
+{
+    apiLocationsModel_->dumpPingLogDetails();
+    customConfigLocationsModel_->dumpPingLogDetails();
+}
+
 void LocationsModel::setProxySettings(const ProxySettings &proxySettings)
 {
     pingHost_->setProxySettings(proxySettings);
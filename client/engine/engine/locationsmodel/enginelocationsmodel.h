@@ -29,6 +29,7 @@ public:
     void setApiLocations(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps);
     void setCustomConfigLocations(const QVector<QSharedPointer<const customconfigs::ICustomConfig>> &customConfigs);
     void clear();
+    void dumpPingLogDetails();
 
     void setProxySettings(const ProxySettings &proxySettings);
     void disableProxy();
@@ -7,16 +7,25 @@ bool FailedPingLogController::logFailedIPs(const QString &ip)
 
     if (!failedPingIps_.contains(ip))
     {
-        qCDebug(LOG_PING) << "Ping failed for node: " << ip;
         failedPingIps_ << ip;
+        newFailedPingIps_ << ip;
         return true;
     }
     return false;
 }
 
+QStringList FailedPingLogController::takeNewFailedIPs()
+{
+    QMutexLocker locker(&mutex_);
+    QStringList ips;
+    ips.swap(newFailedPingIps_);
+    return ips;
+}
+
 void FailedPingLogController::clear()
 {
     QMutexLocker locker(&mutex_);
     failedPingIps_.clear();
+    newFailedPingIps_.clear();
     locations_.clear();
 }
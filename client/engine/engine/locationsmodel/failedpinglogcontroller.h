@@ -3,17 +3,22 @@
 
 #include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QMutex>
 
+// the failed nodes are reported once per updateIps(), in the summary of the sweep
 class FailedPingLogController
 {
 public:
     bool logFailedIPs(const QString &ip);
+    // the nodes failed since the previous call
+    QStringList takeNewFailedIPs();
     void clear();
 
 
 private:
     QSet<QString> failedPingIps_;
+    QStringList newFailedPingIps_;
     QSet<QString> locations_;
     QMutex mutex_;
 };
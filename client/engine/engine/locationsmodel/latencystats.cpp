@@ -0,0 +1,72 @@
+#include "latencystats.h"
+#include <algorithm>
+#include "types/pingtime.h"
+
+namespace locationsmodel {
+
+namespace {
+
+// nearest-rank method, sortedSamples must not be empty
+int percentile(const QVector<int> &sortedSamples, int percent)
+{
+    const int rank = (percent * sortedSamples.count() + 99) / 100;
+    return sortedSamples[qMax(rank, 1) - 1];
+}
+
+} // namespace
+
+LatencyStats LatencyStats::fromSamples(const QVector<int> &samples)
+{
+    LatencyStats stats;
+    stats.samplesCount = samples.count();
+    if (samples.isEmpty())
+    {
+        return stats;
+    }
+
+    QVector<int> successful;
+    successful.reserve(samples.count());
+    double ewma = 0;
+    int jitterSum = 0;
+    for (int timeMs : samples)
+    {
+        if (timeMs < 0)
+        {
+            continue;
+        }
+        if (successful.isEmpty())
+        {
+            ewma = timeMs;
+        }
+        else
+        {
+            ewma = EWMA_ALPHA * timeMs + (1.0 - EWMA_ALPHA) * ewma;
+            jitterSum += qAbs(timeMs - successful.last());
+        }
+        successful << timeMs;
+    }
+
+    stats.lossPercent = (samples.count() - successful.count()) * 100 / samples.count();
+    if (successful.isEmpty())
+    {
+        return stats;
+    }
+
+    stats.ewmaMs = qRound(ewma);
+    stats.jitterMs = successful.count() > 1 ? jitterSum / (successful.count() - 1) : 0;
+    std::sort(successful.begin(), successful.end());
+    stats.p50Ms = percentile(successful, 50);
+    stats.p95Ms = percentile(successful, 95);
+    return stats;
+}
+
+int LatencyStats::score() const
+{
+    if (lossPercent == 100)
+    {
+        return PingTime::MAX_LATENCY_FOR_PING_FAILED;
+    }
+    return qMax(ewmaMs, p50Ms) + JITTER_WEIGHT * jitterMs + (p95Ms - p50Ms) / 2 + lossPercent * LOSS_PENALTY_PER_PERCENT;
+}
+
+} //namespace locationsmodel
@@ -0,0 +1,37 @@
+#ifndef LOCATIONSMODEL_LATENCYSTATS_H
+#define LOCATIONSMODEL_LATENCYSTATS_H
+
+#include <QVector>
+
+namespace locationsmodel {
+
+// latency model of a node, calculated from the history of the last pings
+struct LatencyStats
+{
+    int samplesCount;
+    int ewmaMs;             // exponentially weighted moving average of the successful pings
+    int p50Ms;
+    int p95Ms;
+    int jitterMs;           // mean difference between the consecutive successful pings
+    int lossPercent;
+
+    LatencyStats() : samplesCount(0), ewmaMs(0), p50Ms(0), p95Ms(0), jitterMs(0), lossPercent(0) {}
+
+    bool isEmpty() const { return samplesCount == 0; }
+
+    // samples are ordered from oldest to newest, PingTime::PING_FAILED for the lost pings
+    static LatencyStats fromSamples(const QVector<int> &samples);
+
+    // the effective latency in ms for comparing the nodes, the lower the better
+    // a node with a good average but high variance or loss is scored worse than a stable one
+    int score() const;
+
+private:
+    static constexpr double EWMA_ALPHA = 0.3;
+    static constexpr int JITTER_WEIGHT = 2;
+    static constexpr int LOSS_PENALTY_PER_PERCENT = 20;     // 10% of lost pings add 200 ms
+};
+
+} //namespace locationsmodel
+
+#endif // LOCATIONSMODEL_LATENCYSTATS_H
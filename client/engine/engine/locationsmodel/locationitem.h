@@ -5,6 +5,7 @@
 #include <QVector>
 #include "types/pingtime.h"
 #include "types/locationid.h"
+#include "latencystats.h"
 #include "engine/customconfigs/customconfigtype.h"
 
 namespace locationsmodel {
@@ -15,6 +16,7 @@ struct CityItem
     QString city;
     QString nick;
     PingTime pingTimeMs;
+    LatencyStats latencyStats;
     bool isPro;
     bool isDisabled;
 
@@ -76,6 +78,12 @@ struct LocationItem
             city->set_custom_config_error_message(ci.customConfigErrorMessage.toStdString());
             city->set_link_speed(ci.link_speed);
             city->set_health(ci.health);
+            if (!ci.latencyStats.isEmpty())
+            {
+                city->set_ping_jitter(ci.latencyStats.jitterMs);
+                city->set_ping_p95(ci.latencyStats.p95Ms);
+                city->set_ping_loss_percent(ci.latencyStats.lossPercent);
+            }
         }
     }
 };
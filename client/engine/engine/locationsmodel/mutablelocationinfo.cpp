@@ -7,11 +7,13 @@
 
 namespace locationsmodel {
 
-MutableLocationInfo::MutableLocationInfo(const LocationID &locationId, const QString &name, const QVector< QSharedPointer<const BaseNode> > &nodes, int selectedNode,
+MutableLocationInfo::MutableLocationInfo(const LocationID &locationId, const QString &name, const QVector< QSharedPointer<const BaseNode> > &nodes, const QVector<int> &nodesOrder,
                                          const QString &dnsHostName, const QString &verifyX509name)
     : BaseLocationInfo(locationId, name)
     , nodes_(nodes)
-    , selectedNode_(selectedNode)
+    , nodesOrder_(nodesOrder)
+    , curNodeOrderInd_(0)
+    , selectedNode_(nodesOrder.isEmpty() ? -1 : nodesOrder.first())
     , dnsHostName_(dnsHostName)
     , verifyX509name_(verifyX509name)
 {
@@ -81,15 +83,32 @@ QString MutableLocationInfo::getIpForNode(int indNode, int indIp) const
     return nodes_[indNode]->getIp(indIp);
 }
 
-// goto next node or to first (if current selected last or incorrect)
+// goto next node in the order or to first (if current selected last)
 void MutableLocationInfo::selectNextNode()
 {
-    selectedNode_ ++;
-    if (selectedNode_ >= nodes_.count())
+    Q_ASSERT(nodesOrder_.count() > 0);
+    curNodeOrderInd_++;
+    if (curNodeOrderInd_ >= nodesOrder_.count())
     {
-        Q_ASSERT(nodes_.count() > 0);
-        selectedNode_ = 0;
+        curNodeOrderInd_ = 0;
     }
+    selectedNode_ = nodesOrder_.isEmpty() ? -1 : nodesOrder_[curNodeOrderInd_];
+}
+
+int MutableLocationInfo::getNodeInOrder(int offset) const
+{
+    Q_ASSERT(offset >= 0);
+    if (offset >= nodesOrder_.count())
+    {
+        return -1;
+    }
+    return nodesOrder_[(curNodeOrderInd_ + offset) % nodesOrder_.count()];
+}
+
+QString MutableLocationInfo::getHostnameForNode(int indNode) const
+{
+    Q_ASSERT(indNode >= 0 && indNode < nodes_.count());
+    return nodes_[indNode]->getHostname();
 }
 
 QString MutableLocationInfo::getIpForSelectedNode(int indIp) const
@@ -18,7 +18,7 @@ class MutableLocationInfo : public BaseLocationInfo
     Q_OBJECT
 public:
     explicit MutableLocationInfo(const LocationID &locationId, const QString &name,
-                                 const QVector< QSharedPointer<const BaseNode> > &nodes, int selectedNode,
+                                 const QVector< QSharedPointer<const BaseNode> > &nodes, const QVector<int> &nodesOrder,
                                  const QString &dnsHostName, const QString &verifyX509name);
 
 
@@ -31,6 +31,9 @@ public:
     QString getIpForNode(int indNode, int indIp) const;
 
     void selectNextNode();
+    // the node which selectNextNode() called offset times selects, -1 if the order has fewer nodes
+    int getNodeInOrder(int offset) const;
+    QString getHostnameForNode(int indNode) const;
 
     QString getIpForSelectedNode(int indIp) const;
     QString getHostnameForSelectedNode() const;
@@ -46,6 +49,8 @@ public slots:
 
 private:
     QVector< QSharedPointer<const BaseNode> > nodes_;
+    QVector<int> nodesOrder_;       // the order of the retries, see NodeSelectionAlgorithm::getNodesOrder()
+    int curNodeOrderInd_;
     int selectedNode_;
     QString dnsHostName_;
     QString verifyX509name_;
@@ -0,0 +1,169 @@
+#include "nodehealth.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include "utils/settingsstore.h"
+
+namespace locationsmodel {
+
+namespace {
+
+const char *SETTINGS_KEY = "nodeHealth";
+const quint32 VERSION = 2;     // 1 had the connect time of the last success
+const double HALF_LIFE_SECS = 60 * 60;
+const double FAILURE_WEIGHT = 1.0;
+const double DISCONNECT_WEIGHT = 0.5;   // two drops in a short time count as a failure
+const double FAILED_SCORE = 0.5;        // a failure during the last hour
+const double MIN_SCORE = 0.01;          // the entries without the success are forgotten in ~7 hours
+const int MAX_NODES = 500;
+
+qint64 currentTime()
+{
+    return QDateTime::currentSecsSinceEpoch();
+}
+
+} // namespace
+
+NodeHealth::NodeHealth()
+{
+    load();
+}
+
+void NodeHealth::putConnectSuccess(const QString &hostname)
+{
+    if (hostname.isEmpty())
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    Entry &entry = entries_[hostname];
+    entry.failureScore = 0;
+    entry.updateTime = currentTime();
+    entry.lastSuccessTime = entry.updateTime;
+    save();
+}
+
+void NodeHealth::putConnectFailure(const QString &hostname)
+{
+    addFailure(hostname, FAILURE_WEIGHT);
+}
+
+void NodeHealth::putDisconnect(const QString &hostname)
+{
+    addFailure(hostname, DISCONNECT_WEIGHT);
+}
+
+double NodeHealth::failureScore(const QString &hostname) const
+{
+    QMutexLocker locker(&mutex_);
+    auto it = entries_.constFind(hostname);
+    return it != entries_.constEnd() ? decayedScore(*it, currentTime()) : 0.0;
+}
+
+bool NodeHealth::isFailedRecently(const QString &hostname) const
+{
+    return failureScore(hostname) >= FAILED_SCORE;
+}
+
+void NodeHealth::addFailure(const QString &hostname, double weight)
+{
+    if (hostname.isEmpty())
+    {
+        return;
+    }
+    QMutexLocker locker(&mutex_);
+    const qint64 now = currentTime();
+    Entry &entry = entries_[hostname];
+    entry.failureScore = static_cast<float>(decayedScore(entry, now) + weight);
+    entry.updateTime = now;
+    save();
+}
+
+double NodeHealth::decayedScore(const Entry &entry, qint64 now)
+{
+    if (entry.failureScore <= 0)
+    {
+        return 0.0;
+    }
+    const qint64 age = qMax<qint64>(0, now - entry.updateTime);
+    return entry.failureScore * std::pow(0.5, age / HALF_LIFE_SECS);
+}
+
+void NodeHealth::load()
+{
+    QByteArray arr = SettingsStore::instance().value(SETTINGS_KEY).toByteArray();
+    if (arr.isEmpty())
+    {
+        return;
+    }
+
+    QDataStream stream(&arr, QIODevice::ReadOnly);
+    quint32 version;
+    quint32 count;
+    stream >> version >> count;
+    if (stream.status() != QDataStream::Ok || version != VERSION)
+    {
+        return;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString hostname;
+        Entry entry;
+        stream >> hostname >> entry.failureScore >> entry.updateTime >> entry.lastSuccessTime;
+        entries_.insert(hostname, entry);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        entries_.clear();
+    }
+}
+
+void NodeHealth::save()
+{
+    // called with mutex_ locked, the store coalesces the writes; the decayed failures without a success are dropped,
+    // then the oldest entries
+    const qint64 now = currentTime();
+    QVector<QPair<qint64, QString> > nodes;
+    nodes.reserve(entries_.count());
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it)
+    {
+        if (it->lastSuccessTime != 0 || decayedScore(*it, now) >= MIN_SCORE)
+        {
+            nodes << qMakePair(it->updateTime, it.key());
+        }
+    }
+    if (nodes.count() > MAX_NODES)
+    {
+        std::sort(nodes.begin(), nodes.end(), [](const QPair<qint64, QString> &n1, const QPair<qint64, QString> &n2) {
+            return n1.first > n2.first;
+        });
+        nodes.resize(MAX_NODES);
+    }
+    if (nodes.count() != entries_.count())
+    {
+        QHash<QString, Entry> keptEntries;
+        for (const QPair<qint64, QString> &node : qAsConst(nodes))
+        {
+            keptEntries.insert(node.second, entries_[node.second]);
+        }
+        entries_.swap(keptEntries);
+    }
+
+    QByteArray arr;
+    {
+        QDataStream stream(&arr, QIODevice::WriteOnly);
+        stream << VERSION << static_cast<quint32>(nodes.count());
+        for (const QPair<qint64, QString> &node : qAsConst(nodes))
+        {
+            const Entry &entry = entries_[node.second];
+            stream << node.second << entry.failureScore << entry.updateTime << entry.lastSuccessTime;
+        }
+    }
+
+    SettingsStore::instance().setValue(SETTINGS_KEY, arr);
+}
+
+} //namespace locationsmodel
@@ -0,0 +1,54 @@
+#ifndef NODEHEALTH_H
+#define NODEHEALTH_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+namespace locationsmodel {
+
+// Persistent outcomes of our connections per node (hostname): the failed attempts (including the failed tunnel tests)
+// and the drops of the established connections add to a failure score which decays with the age (half-life of an hour),
+// a success clears it. NodeSelectionAlgorithm puts the nodes with a recent failure after the others, so a repeated
+// connect and the retries of the connection policies go to the other nodes of the location first.
+// Each change is written through SettingsStore, so the failures survive a crash of the engine.
+class NodeHealth
+{
+public:
+    static NodeHealth &instance()
+    {
+        static NodeHealth nh;
+        return nh;
+    }
+
+    void putConnectSuccess(const QString &hostname);
+    void putConnectFailure(const QString &hostname);
+    void putDisconnect(const QString &hostname);
+
+    // the decayed failure score, 0 for the nodes without the failures since the last success
+    double failureScore(const QString &hostname) const;
+    bool isFailedRecently(const QString &hostname) const;
+
+private:
+    NodeHealth();
+
+    struct Entry
+    {
+        float failureScore = 0;         // at updateTime
+        qint64 updateTime = 0;          // the seconds since the epoch
+        qint64 lastSuccessTime = 0;
+    };
+
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+
+    void addFailure(const QString &hostname, double weight);
+    static double decayedScore(const Entry &entry, qint64 now);
+
+    void load();
+    void save();
+};
+
+} //namespace locationsmodel
+
+#endif // NODEHEALTH_H
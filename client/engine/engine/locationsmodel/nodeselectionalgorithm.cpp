@@ -1,8 +1,17 @@
 #include "nodeselectionalgorithm.h"
+#include <QCryptographicHash>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include "utils/utils.h"
+#include "nodehealth.h"
 
 namespace locationsmodel {
 
+QMutex NodeSelectionAlgorithm::mutex_;
+QHash<QVector<int>, NodeSelectionAlgorithm::AliasTable> NodeSelectionAlgorithm::aliasTables_;
+
 int NodeSelectionAlgorithm::selectRandomNodeBasedOnWeight(const QVector<QSharedPointer<const BaseNode> > &nodes)
 {
     if (nodes.count() == 1)
@@ -15,41 +24,176 @@ int NodeSelectionAlgorithm::selectRandomNodeBasedOnWeight(const QVector<QSharedP
     }
     else
     {
-        QVector<double> weights;
-        weights.reserve(nodes.size());
-        double sum_weights = 0;
-        for (int i = 0; i < nodes.size(); ++i)
+        const QVector<int> weights = getWeights(nodes);
+
+        AliasTable table;
+        {
+            QMutexLocker locker(&mutex_);
+            auto it = aliasTables_.find(weights);
+            if (it == aliasTables_.end())
+            {
+                if (aliasTables_.count() >= MAX_CACHED_ALIAS_TABLES)
+                {
+                    aliasTables_.clear();
+                }
+                it = aliasTables_.insert(weights, buildAliasTable(weights));
+            }
+            table = it.value();
+        }
+
+        const int column = Utils::generateIntegerRandom(0, weights.count() - 1);
+        return Utils::generateDoubleRandom(0.0, 1.0) < table.probability[column] ? column : table.alias[column];
+    }
+}
+
+QVector<int> NodeSelectionAlgorithm::getNodesOrder(const QVector<QSharedPointer<const BaseNode> > &nodes, const QString &rendezvousKey)
+{
+    if (nodes.isEmpty())
+    {
+        return QVector<int>();
+    }
+
+    const QVector<int> weights = getWeights(nodes);
+    QVector<int> order;
+    if (!rendezvousKey.isEmpty())
+    {
+        order = rendezvousOrder(nodes, weights, rendezvousKey);
+    }
+    else
+    {
+        // a rendezvous order with a random key is a weighted random order
+        const int selectedNode = selectRandomNodeBasedOnWeight(nodes);
+        order = rendezvousOrder(nodes, weights, QString::number(Utils::generateIntegerRandom(0, INT_MAX)));
+        order.removeOne(selectedNode);
+        order.prepend(selectedNode);
+    }
+    moveFailedNodesLast(nodes, order);
+    return order;
+}
+
+void NodeSelectionAlgorithm::moveFailedNodesLast(const QVector<QSharedPointer<const BaseNode> > &nodes, QVector<int> &order)
+{
+    QVector<double> scores(nodes.count(), 0.0);
+    bool isAnyFailed = false;
+    for (int i = 0; i < nodes.count(); ++i)
+    {
+        if (NodeHealth::instance().isFailedRecently(nodes[i]->getHostname()))
         {
-            double w = nodes[i]->getWeight();
-            weights << w;
-            sum_weights += w;
+            scores[i] = NodeHealth::instance().failureScore(nodes[i]->getHostname());
+            isAnyFailed = true;
         }
+    }
+    if (isAnyFailed)
+    {
+        std::stable_sort(order.begin(), order.end(), [&scores](int i1, int i2) {
+            return scores[i1] < scores[i2];
+        });
+    }
+}
 
-        QVector<double> p;
-        for (int i = 0; i < nodes.size(); ++i)
+QVector<int> NodeSelectionAlgorithm::getWeights(const QVector<QSharedPointer<const BaseNode> > &nodes)
+{
+    QVector<int> weights;
+    weights.reserve(nodes.count());
+    bool isAllZero = true;
+    for (const QSharedPointer<const BaseNode> &node : nodes)
+    {
+        const int w = qMax(node->getWeight(), 0);
+        weights << w;
+        if (w > 0)
         {
-            p << weights[i] / sum_weights;
+            isAllZero = false;
         }
-        return getRandomEvent(p);
     }
+    // no weights from the API, all nodes are equal
+    if (isAllZero)
+    {
+        weights.fill(1);
+    }
+    return weights;
 }
 
-int NodeSelectionAlgorithm::getRandomEvent(QVector<double> &p)
+NodeSelectionAlgorithm::AliasTable NodeSelectionAlgorithm::buildAliasTable(const QVector<int> &weights)
 {
-    Q_ASSERT(p.size() > 0);
-    const double eps = 1e-9;
+    const int n = weights.count();
+    double sumWeights = 0;
+    for (int w : weights)
+    {
+        sumWeights += w;
+    }
+
+    AliasTable table;
+    table.probability.resize(n);
+    table.alias.resize(n);
+
+    QVector<double> scaled(n);
+    QVector<int> smallList, largeList;  // "small" is a macro in the Windows headers
+    for (int i = 0; i < n; ++i)
+    {
+        scaled[i] = weights[i] * n / sumWeights;
+        if (scaled[i] < 1.0)
+        {
+            smallList << i;
+        }
+        else
+        {
+            largeList << i;
+        }
+    }
 
-    double r = Utils::generateDoubleRandom(0.0, 1.0); // generates a random number distribute in [0,1];
-    for (int i = 0; i < p.size(); ++i)
+    while (!smallList.isEmpty() && !largeList.isEmpty())
     {
-        r -= p[i];
-        if (r < eps)
+        const int s = smallList.takeLast();
+        const int l = largeList.last();
+        table.probability[s] = scaled[s];
+        table.alias[s] = l;
+        scaled[l] = scaled[l] + scaled[s] - 1.0;
+        if (scaled[l] < 1.0)
         {
-            return i;
+            largeList.removeLast();
+            smallList << l;
         }
     }
-    Q_ASSERT(false);
-    return 0;
+    // the rest are 1.0 up to the rounding errors
+    for (int i : qAsConst(largeList))
+    {
+        table.probability[i] = 1.0;
+        table.alias[i] = i;
+    }
+    for (int i : qAsConst(smallList))
+    {
+        table.probability[i] = 1.0;
+        table.alias[i] = i;
+    }
+    return table;
+}
+
+QVector<int> NodeSelectionAlgorithm::rendezvousOrder(const QVector<QSharedPointer<const BaseNode> > &nodes, const QVector<int> &weights, const QString &key)
+{
+    QVector<QPair<double, int> > scores;
+    scores.reserve(nodes.count());
+    for (int i = 0; i < nodes.count(); ++i)
+    {
+        // the hash must be the same between runs and Qt versions, so not qHash
+        const QByteArray hash = QCryptographicHash::hash((key + "/" + nodes[i]->getHostname()).toUtf8(), QCryptographicHash::Md5);
+        const quint64 h = qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(hash.constData()));
+        // uniform in (0, 1)
+        const double u = (static_cast<double>(h >> 11) + 0.5) / static_cast<double>(1ULL << 53);
+        const double score = weights[i] > 0 ? -weights[i] / std::log(u) : 0.0;
+        scores << qMakePair(score, i);
+    }
+
+    std::stable_sort(scores.begin(), scores.end(), [](const QPair<double, int> &s1, const QPair<double, int> &s2) {
+        return s1.first > s2.first;
+    });
+
+    QVector<int> order;
+    order.reserve(scores.count());
+    for (const QPair<double, int> &s : qAsConst(scores))
+    {
+        order << s.second;
+    }
+    return order;
 }
 
 } //namespace locationsmodel
@@ -1,6 +1,8 @@
 #ifndef NODESELECTIONALGORITHM_H
 #define NODESELECTIONALGORITHM_H
 
+#include <QHash>
+#include <QMutex>
 #include "locationnode.h"
 
 namespace locationsmodel {
@@ -10,8 +12,29 @@ class NodeSelectionAlgorithm
 public:
     static int selectRandomNodeBasedOnWeight(const QVector< QSharedPointer<const BaseNode> > &nodes);
 
+    // the order of the nodes for the connection and the retries, the first one is the selected node
+    // if rendezvousKey is empty, the first node is weighted random and the others follow in a weighted random order
+    // otherwise the order is the weighted rendezvous hash of the key (device id) with the hostnames: stable for
+    // the device and spread over the nodes by the weights, so the devices reconnecting at once don't pick the same nodes
+    static QVector<int> getNodesOrder(const QVector< QSharedPointer<const BaseNode> > &nodes, const QString &rendezvousKey);
+
 private:
-    static int getRandomEvent(QVector<double> &p);
+    // Vose's alias method, O(1) sampling after O(n) build
+    struct AliasTable
+    {
+        QVector<double> probability;
+        QVector<int> alias;
+    };
+
+    static constexpr int MAX_CACHED_ALIAS_TABLES = 256;
+
+    static QMutex mutex_;
+    static QHash<QVector<int>, AliasTable> aliasTables_;   // by the nodes weights, rebuilt only when the weights change
+
+    static QVector<int> getWeights(const QVector< QSharedPointer<const BaseNode> > &nodes);
+    static AliasTable buildAliasTable(const QVector<int> &weights);
+    static void moveFailedNodesLast(const QVector< QSharedPointer<const BaseNode> > &nodes, QVector<int> &order);
+    static QVector<int> rendezvousOrder(const QVector< QSharedPointer<const BaseNode> > &nodes, const QVector<int> &weights, const QString &key);
 };
 
 } //namespace locationsmodel
@@ -3,15 +3,22 @@
 #include "utils/utils.h"
 #include <QDebug>
 #include "utils/logger.h"
+#include "utils/tracespan.h"
+#include "engine/enginemetrics.h"
 
 namespace locationsmodel {
 
+constexpr int PingIpsController::RTT_BUCKET_LIMITS[];
+
 PingIpsController::PingIpsController(QObject *parent, IConnectStateController *stateController, INetworkDetectionManager *networkDetectionManager, PingHost *pingHost, const QString &log_filename) : QObject(parent),
     connectStateController_(stateController), networkDetectionManager_(networkDetectionManager),
-    pingLog_(log_filename), pingHost_(pingHost)
+    pingLog_(log_filename), pingHost_(pingHost), nextScheduleOrder_(0), maxPingsInFlight_(INITIAL_PINGS_IN_FLIGHT),
+    windowPingsCount_(0), windowFailedPingsCount_(0), firstSweepStartUs_(0), prevConnectState_(CONNECT_STATE_DISCONNECTED)
 {
     connect(pingHost_, SIGNAL(pingFinished(bool,int,QString, bool)), SLOT(onPingFinished(bool,int,QString, bool)));
     connect(&pingTimer_, SIGNAL(timeout()), SLOT(onPingTimer()));
+    dispatchTimer_.setSingleShot(true);
+    connect(&dispatchTimer_, SIGNAL(timeout()), SLOT(dispatchPings()));
 
     int pingHour = Utils::generateIntegerRandom(0, 23);
     int pingMinute = Utils::generateIntegerRandom(0, 59);
@@ -42,8 +49,28 @@ void PingIpsController::updateIps(const QVector<PingIpInfo> &ips)
         it.value().existThisIp = false;
     }
 
+    // the warm-up nodes are scheduled first, so they are sent first
+    QVector<const PingIpInfo *> ordered;
+    ordered.reserve(ips.count());
+    for (const PingIpInfo &ip_info : ips)
+    {
+        if (ip_info.isWarmUp_)
+        {
+            ordered << &ip_info;
+        }
+    }
     for (const PingIpInfo &ip_info : ips)
     {
+        if (!ip_info.isWarmUp_)
+        {
+            ordered << &ip_info;
+        }
+    }
+
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    for (const PingIpInfo *pIpInfo : qAsConst(ordered))
+    {
+        const PingIpInfo &ip_info = *pIpInfo;
         auto it = ips_.find(ip_info.ip_);
         if (it == ips_.end())
         {
@@ -56,7 +83,14 @@ void PingIpsController::updateIps(const QVector<PingIpInfo> &ips)
             pni.latestPingFromDisconnectedState_ = false;
             pni.nextTimeForFailedPing_ = 0;
             pni.pingType = ip_info.pingType_;
+            pni.scheduledTime = 0;
             ips_[ip_info.ip_] = pni;
+            // ping the new node as soon as possible
+            schedulePing(ip_info.ip_, curTime);
+            if (ip_info.isWarmUp_)
+            {
+                warmUpIps_.insert(ip_info.ip_);
+            }
         }
         else
         {
@@ -71,6 +105,8 @@ void PingIpsController::updateIps(const QVector<PingIpInfo> &ips)
         if (!it.value().existThisIp)
         {
             pingLog_.addLog("PingIpsController::updateIps", "removed unused ip: " + it.key());
+            firstSweepIps_.remove(it.key());
+            warmUpIps_.remove(it.key());
             it = ips_.erase(it);
         }
         else
@@ -79,8 +115,24 @@ void PingIpsController::updateIps(const QVector<PingIpInfo> &ips)
         }
     }
 
+    // the failed nodes of the previous list are reported before they are forgotten
+    writeSweepSummary();
     failedPingLogController_.clear();
 
+    if (!warmUpIps_.isEmpty())
+    {
+        pingLog_.addLog("PingIpsController::updateIps", "warm-up pings: " + QString::number(warmUpIps_.count()));
+    }
+
+    if (firstSweepStartUs_ == 0 && !ips_.isEmpty())
+    {
+        firstSweepStartUs_ = TraceSpan::nowUs();
+        for (auto it = ips_.cbegin(); it != ips_.cend(); ++it)
+        {
+            firstSweepIps_.insert(it.key());
+        }
+    }
+
     onPingTimer();
     pingTimer_.start(PING_TIMER_INTERVAL);
 }
@@ -109,52 +161,53 @@ void PingIpsController::onPingTimer()
         isNeedPingForNextDisconnectState_ = true;
     }
 
-    for (QHash<QString, PingNodeInfo>::iterator it = ips_.begin(); it != ips_.end(); ++it)
+    if (curConnectState == CONNECT_STATE_DISCONNECTED)
     {
-        PingNodeInfo pni = it.value();
-
-        if (it.value().bNowPinging_)
-        {
-            continue;
-        }
-
-        if ((bNeedPingByTime || isNeedPingForNextDisconnectState_) && curConnectState == CONNECT_STATE_DISCONNECTED)
+        if (bNeedPingByTime || isNeedPingForNextDisconnectState_)
         {
-            pingLog_.addLog("PingNodesController::onPingTimer", "start ping by time: " + it.key());
-            it.value().bNowPinging_ = true;
-            pingHost_->addHostForPing(it.key(), it.value().pingType);
+            pingLog_.addLog("PingNodesController::onPingTimer", "start ping all nodes by time");
+            isNeedPingForNextDisconnectState_ = false;
+            scheduleAllPings(false);
         }
-        else if (!pni.isExistPingAttempt)
+        else if (prevConnectState_ != CONNECT_STATE_DISCONNECTED)
         {
-            pingLog_.addLog("PingNodesController::onPingTimer", "start ping the new node: " + it.key());
-            it.value().bNowPinging_ = true;
-            pingHost_->addHostForPing(it.key(), it.value().pingType);
-        }
-        else if (pni.latestPingFailed_)
-        {
-            if (pni.nextTimeForFailedPing_ == 0 || QDateTime::currentMSecsSinceEpoch() >= pni.nextTimeForFailedPing_)
-            {
-                //pingLog_.addLog("PingNodesController::onPingTimer", "start ping because latest ping failed: " + it.key());
-                it.value().bNowPinging_ = true;
-                pingHost_->addHostForPing(it.key(), it.value().pingType);
-            }
-        }
-        else if (!pni.latestPingFromDisconnectedState_ && curConnectState == CONNECT_STATE_DISCONNECTED)
-        {
-            pingLog_.addLog("PingNodesController::onPingTimer", "start ping from disconnected state, because latest ping was in connected state: " + it.key());
-            it.value().bNowPinging_ = true;
-            pingHost_->addHostForPing(it.key(), it.value().pingType);
+            pingLog_.addLog("PingNodesController::onPingTimer", "start ping from disconnected state the nodes which latest ping was in connected state");
+            scheduleAllPings(true);
         }
     }
+    prevConnectState_ = curConnectState;
 
-    if (isNeedPingForNextDisconnectState_ && curConnectState == CONNECT_STATE_DISCONNECTED)
-    {
-        isNeedPingForNextDisconnectState_ = false;
-    }
+    removeLostPings();
+    dispatchPings();
+    writeSweepSummaryIfFinished();
+}
+
+void PingIpsController::dumpPingLogDetails()
+{
+    writeSweepSummary();
+    pingLog_.dumpDetails();
 }
 
 void PingIpsController::onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState)
 {
+    // PingHost is shared with other controllers, ignore the pings not sent by this one
+    if (pingsInFlight_.remove(ip) == 0)
+    {
+        return;
+    }
+    adaptPingsInFlight(bSuccess);
+    addToSweepStats(bSuccess, timems);
+
+    if (firstSweepIps_.remove(ip) && firstSweepIps_.isEmpty())
+    {
+        TraceSpan::record("engine", "first ping sweep", firstSweepStartUs_);
+    }
+    // a failed warm-up ping is repeated with the usual pings
+    if (warmUpIps_.remove(ip) && warmUpIps_.isEmpty() && firstSweepStartUs_ != 0)
+    {
+        TraceSpan::record("engine", "warm-up pings", firstSweepStartUs_);
+    }
+
     auto itNode = ips_.find(ip);
     if (itNode != ips_.end())
     {
@@ -163,7 +216,7 @@ void PingIpsController::onPingFinished(bool bSuccess, int timems, const QString
         {
             if (isFromDisconnectedState)
             {
-                pingLog_.addLog("PingIpsController::onPingFinished", "ping successfully from disconnected state: " + ip + " " + QString::number(timems) + "ms");
+                pingLog_.addDetail("PingIpsController::onPingFinished", "ping successfully from disconnected state: " + ip + " " + QString::number(timems) + "ms");
                 itNode.value().isExistPingAttempt = true;
                 itNode.value().latestPingFailed_ = false;
                 itNode.value().latestPingFromDisconnectedState_ = true;
@@ -172,12 +225,18 @@ void PingIpsController::onPingFinished(bool bSuccess, int timems, const QString
             }
             else
             {
-                pingLog_.addLog("PingIpsController::onPingFinished", "ping successfully from connected state: " + ip + " " + QString::number(timems) + "ms");
+                pingLog_.addDetail("PingIpsController::onPingFinished", "ping successfully from connected state: " + ip + " " + QString::number(timems) + "ms");
                 itNode.value().isExistPingAttempt = true;
                 itNode.value().latestPingFailed_ = false;
                 itNode.value().latestPingFromDisconnectedState_ = false;
                 itNode.value().failedPingsInRow = 0;
                 Q_EMIT pingInfoChanged(ip, timems, false);
+
+                // the state has changed to disconnected while the ping was in progress
+                if (connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED)
+                {
+                    schedulePing(ip, QDateTime::currentMSecsSinceEpoch());
+                }
             }
         }
         else
@@ -191,11 +250,11 @@ void PingIpsController::onPingFinished(bool bSuccess, int timems, const QString
                 //pingLog_.addLog("PingIpsController::onPingFinished", "ping failed 3 times at row: " + ip);
                 itNode.value().failedPingsInRow = 0;
                 // next ping attempt in 1 mins
-                itNode.value().nextTimeForFailedPing_ = QDateTime::currentMSecsSinceEpoch() + 1000 * 60;
+                itNode.value().nextTimeForFailedPing_ = QDateTime::currentMSecsSinceEpoch() + FAILED_PING_RETRY_INTERVAL;
                 Q_EMIT pingInfoChanged(ip, PingTime::PING_FAILED, isFromDisconnectedState);
                 if (failedPingLogController_.logFailedIPs(ip))
                 {
-                    pingLog_.addLog("PingIpsController::onPingFinished", "ping failed: " + ip);
+                    pingLog_.addDetail("PingIpsController::onPingFinished", "ping failed: " + ip);
                 }
             }
             else
@@ -203,8 +262,213 @@ void PingIpsController::onPingFinished(bool bSuccess, int timems, const QString
                 itNode.value().nextTimeForFailedPing_ = 0;
                 //pingLog_.addLog("PingIpsController::onPingFinished", "ping failed: " + ip);
             }
+            schedulePing(ip, qMax(itNode.value().nextTimeForFailedPing_, QDateTime::currentMSecsSinceEpoch() + PING_TIMER_INTERVAL));
+        }
+    }
+
+    dispatchPings();
+    writeSweepSummaryIfFinished();
+}
+
+void PingIpsController::dispatchPings()
+{
+    if (!networkDetectionManager_->isOnline())
+    {
+        return;
+    }
+
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    const int maxPingsInFlight = currentMaxPingsInFlight();
+    int sentCount = 0;
+    while (!queue_.empty() && queue_.top().time <= curTime && pingsInFlight_.count() < maxPingsInFlight && sentCount < BATCH_SIZE)
+    {
+        const ScheduledPing sp = queue_.top();
+        queue_.pop();
+
+        auto it = ips_.find(sp.ip);
+        if (it == ips_.end() || it.value().scheduledTime != sp.time || it.value().bNowPinging_)
+        {
+            continue;
+        }
+
+        it.value().scheduledTime = 0;
+        it.value().bNowPinging_ = true;
+        pingsInFlight_[sp.ip] = curTime;
+        if (sweepStats_.startTime == 0)
+        {
+            sweepStats_.startTime = curTime;
         }
+        pingHost_->addHostForPing(sp.ip, it.value().pingType);
+        sentCount++;
+    }
+
+    // the rest of the due pings are sent with the next batch, if there is room for them
+    if (!queue_.empty() && queue_.top().time <= curTime && pingsInFlight_.count() < maxPingsInFlight && !dispatchTimer_.isActive())
+    {
+        dispatchTimer_.start(BATCH_PACING_INTERVAL);
+    }
+}
+
+void PingIpsController::schedulePing(const QString &ip, qint64 time)
+{
+    auto it = ips_.find(ip);
+    if (it == ips_.end() || it.value().bNowPinging_)
+    {
+        return;
+    }
+    // the earliest time wins, the later entry in the queue will be skipped as outdated
+    if (it.value().scheduledTime != 0 && it.value().scheduledTime <= time)
+    {
+        return;
+    }
+    it.value().scheduledTime = time;
+    queue_.push(ScheduledPing{time, nextScheduleOrder_++, ip});
+}
+
+int PingIpsController::currentMaxPingsInFlight() const
+{
+    // the warm-up is short, the adapted limit applies to the rest
+    return warmUpIps_.isEmpty() ? maxPingsInFlight_ : qMax(maxPingsInFlight_, static_cast<int>(MAX_PINGS_IN_FLIGHT));
+}
+
+void PingIpsController::scheduleAllPings(bool onlyPingedFromConnectedState)
+{
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = ips_.constBegin(); it != ips_.constEnd(); ++it)
+    {
+        const PingNodeInfo &pni = it.value();
+        if (onlyPingedFromConnectedState && (!pni.isExistPingAttempt || pni.latestPingFailed_ || pni.latestPingFromDisconnectedState_))
+        {
+            continue;
+        }
+        schedulePing(it.key(), curTime);
+    }
+}
+
+void PingIpsController::removeLostPings()
+{
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    auto it = pingsInFlight_.begin();
+    while (it != pingsInFlight_.end())
+    {
+        if (curTime - it.value() > IN_FLIGHT_TIMEOUT)
+        {
+            const QString ip = it.key();
+            it = pingsInFlight_.erase(it);
+            pingLog_.addDetail("PingIpsController::removeLostPings", "no answer from PingHost for: " + ip);
+            sweepStats_.lostCount++;
+            warmUpIps_.remove(ip);
+
+            auto itNode = ips_.find(ip);
+            if (itNode != ips_.end())
+            {
+                itNode.value().bNowPinging_ = false;
+                schedulePing(ip, curTime);
+            }
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void PingIpsController::adaptPingsInFlight(bool bSuccess)
+{
+    windowPingsCount_++;
+    if (!bSuccess)
+    {
+        windowFailedPingsCount_++;
+    }
+    if (windowPingsCount_ < LOSS_WINDOW_SIZE)
+    {
+        return;
+    }
+
+    const int lossPercent = windowFailedPingsCount_ * 100 / windowPingsCount_;
+    const int prevMaxPingsInFlight = maxPingsInFlight_;
+    if (lossPercent >= HIGH_LOSS_PERCENT)
+    {
+        maxPingsInFlight_ = qMax(static_cast<int>(MIN_PINGS_IN_FLIGHT), maxPingsInFlight_ / 2);
+    }
+    else if (lossPercent <= LOW_LOSS_PERCENT)
+    {
+        maxPingsInFlight_ = qMin(static_cast<int>(MAX_PINGS_IN_FLIGHT), maxPingsInFlight_ + 2);
+    }
+
+    if (maxPingsInFlight_ != prevMaxPingsInFlight)
+    {
+        pingLog_.addLog("PingIpsController::adaptPingsInFlight", "loss " + QString::number(lossPercent) + "%, max pings in flight changed to "
+                        + QString::number(maxPingsInFlight_));
+    }
+    windowPingsCount_ = 0;
+    windowFailedPingsCount_ = 0;
+}
+
+void PingIpsController::addToSweepStats(bool bSuccess, int timems)
+{
+    if (!bSuccess)
+    {
+        sweepStats_.failedCount++;
+        return;
+    }
+    sweepStats_.successCount++;
+    int bucket = 0;
+    while (bucket < RTT_BUCKETS_COUNT - 1 && timems >= RTT_BUCKET_LIMITS[bucket])
+    {
+        bucket++;
+    }
+    sweepStats_.rttBuckets[bucket]++;
+}
+
+void PingIpsController::writeSweepSummaryIfFinished()
+{
+    if (sweepStats_.isEmpty() || !pingsInFlight_.isEmpty())
+    {
+        return;
+    }
+    // the outdated entries of the queue are skipped by dispatchPings(), so a due one may be outdated,
+    // then the summary is written on the next tick of the ping timer
+    if (!queue_.empty() && queue_.top().time <= QDateTime::currentMSecsSinceEpoch())
+    {
+        return;
+    }
+    writeSweepSummary();
+}
+
+void PingIpsController::writeSweepSummary()
+{
+    const QStringList newFailedIps = failedPingLogController_.takeNewFailedIPs();
+    if (sweepStats_.isEmpty() && newFailedIps.isEmpty())
+    {
+        return;
+    }
+
+    const int attemptsCount = sweepStats_.successCount + sweepStats_.failedCount + sweepStats_.lostCount;
+    QString str = QString("%1 pings, %2% ok, rtt").arg(attemptsCount)
+                  .arg(attemptsCount > 0 ? sweepStats_.successCount * 100 / attemptsCount : 0);
+    for (int i = 0; i < RTT_BUCKETS_COUNT; ++i)
+    {
+        str += (i < RTT_BUCKETS_COUNT - 1) ? QString(" <%1ms: ").arg(RTT_BUCKET_LIMITS[i])
+                                           : QString(" >=%1ms: ").arg(RTT_BUCKET_LIMITS[i - 1]);
+        str += QString::number(sweepStats_.rttBuckets[i]);
+    }
+    str += QString(", failed attempts: %1, lost: %2").arg(sweepStats_.failedCount).arg(sweepStats_.lostCount);
+    if (!newFailedIps.isEmpty())
+    {
+        str += ", failed nodes: " + newFailedIps.join(" ");
+        qCDebug(LOG_PING) << "Ping failed for nodes:" << newFailedIps.join(" ");
+    }
+    pingLog_.addLog("PingIpsController::writeSweepSummary", str);
+
+    if (sweepStats_.startTime != 0)
+    {
+        EngineMetrics::instance().observeMs("windscribe_ping_sweep_ms", QDateTime::currentMSecsSinceEpoch() - sweepStats_.startTime);
     }
+    EngineMetrics::instance().addCount("windscribe_pings_total", "result", "success", sweepStats_.successCount);
+    EngineMetrics::instance().addCount("windscribe_pings_total", "result", "failed", sweepStats_.failedCount);
+    EngineMetrics::instance().addCount("windscribe_pings_total", "result", "lost", sweepStats_.lostCount);
+    sweepStats_.clear();
 }
 
 } //namespace locationsmodel
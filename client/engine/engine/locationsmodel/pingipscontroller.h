@@ -4,8 +4,12 @@
 #include <QDateTime>
 #include <QObject>
 #include <QSet>
+#include <QTimer>
+#include <algorithm>
+#include <queue>
 #include "pingstorage.h"
 #include "engine/ping/pinghost.h"
+#include "engine/types/types.h"
 #include "pinglog.h"
 #include "failedpinglogcontroller.h"
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
@@ -16,14 +20,19 @@ struct PingIpInfo
 {
     QString ip_;     // ip or hostname
     PingHost::PING_TYPE pingType_;
+    bool isWarmUp_;  // pinged before the rest of the new nodes, one node per location for a quick latency of every location
 
-    PingIpInfo(const QString &ip, PingHost::PING_TYPE pingType) : ip_(ip), pingType_(pingType) {}
-    PingIpInfo() : pingType_(PingHost::PING_TCP) {}
+    PingIpInfo(const QString &ip, PingHost::PING_TYPE pingType, bool isWarmUp = false) : ip_(ip), pingType_(pingType), isWarmUp_(isWarmUp) {}
+    PingIpInfo() : pingType_(PingHost::PING_TCP), isWarmUp_(false) {}
 };
 
 
 // logic of ping all nodes (taken into account connected/disconnected state, latest ping time, repeat failed pings)
 // starts ping on updateIps(...) and repeat ping every 24 hours
+// The nodes are kept in a queue ordered by the time of the next ping. The due nodes are sent to PingHost in batches,
+// the number of pings in flight is limited and adapted to the measured loss (halved on high loss, increased slowly otherwise).
+// The new nodes are pinged in the order of updateIps(...), the warm-up nodes first and with the maximum number of pings in flight
+// until all of them are answered.
 class PingIpsController : public QObject
 {
     Q_OBJECT
@@ -32,6 +41,7 @@ public:
     explicit PingIpsController(QObject *parent, IConnectStateController *stateController, INetworkDetectionManager *networkDetectionManager, PingHost *pingHost, const QString &log_filename);
 
     void updateIps(const QVector<PingIpInfo> &ips);
+    void dumpPingLogDetails();
 
 signals:
     void pingInfoChanged(const QString &ip, int timems, bool isFromDisconnectedState);
@@ -41,10 +51,45 @@ signals:
 private slots:
     void onPingTimer();
     void onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState);
+    void dispatchPings();
 
 private:
     static constexpr int PING_TIMER_INTERVAL = 1000;
     static constexpr int MAX_FAILED_PING_IN_ROW = 3;
+    static constexpr int FAILED_PING_RETRY_INTERVAL = 60 * 1000;
+
+    // scheduler settings
+    static constexpr int BATCH_SIZE = 8;                // max pings sent to PingHost at once
+    static constexpr int BATCH_PACING_INTERVAL = 50;    // ms between the batches
+    static constexpr int MIN_PINGS_IN_FLIGHT = 2;
+    static constexpr int MAX_PINGS_IN_FLIGHT = 32;
+    static constexpr int INITIAL_PINGS_IN_FLIGHT = 16;
+    static constexpr int IN_FLIGHT_TIMEOUT = 15000;     // the ping is considered lost if PingHost did not answer in this time
+    static constexpr int LOSS_WINDOW_SIZE = 32;         // number of the ping results for calculating the loss
+    static constexpr int HIGH_LOSS_PERCENT = 30;
+    static constexpr int LOW_LOSS_PERCENT = 10;
+
+    // the results are counted per sweep (until no ping is in flight or due) and written to the log as one summary
+    static constexpr int RTT_BUCKETS_COUNT = 5;
+    static constexpr int RTT_BUCKET_LIMITS[RTT_BUCKETS_COUNT - 1] = { 50, 100, 200, 500 };
+
+    struct SweepStats
+    {
+        int successCount;
+        int failedCount;        // the single attempts, the node is failed after MAX_FAILED_PING_IN_ROW of them
+        int lostCount;
+        int rttBuckets[RTT_BUCKETS_COUNT];
+        qint64 startTime;       // when the first ping of the sweep was sent, 0 if none
+
+        SweepStats() { clear(); }
+        void clear()
+        {
+            successCount = failedCount = lostCount = 0;
+            startTime = 0;
+            std::fill(rttBuckets, rttBuckets + RTT_BUCKETS_COUNT, 0);
+        }
+        bool isEmpty() const { return successCount == 0 && failedCount == 0 && lostCount == 0; }
+    };
 
     struct PingNodeInfo
     {
@@ -56,6 +101,16 @@ private:
         bool bNowPinging_;
         bool existThisIp;  // used in function updateNodes for remove unused ips
         PingHost::PING_TYPE pingType;
+        qint64 scheduledTime;   // time of the next ping in the queue, 0 if not scheduled
+    };
+
+    struct ScheduledPing
+    {
+        qint64 time;
+        quint64 order;      // the pings of the same time are sent in the order of scheduling
+        QString ip;
+
+        bool operator>(const ScheduledPing &other) const { return time > other.time || (time == other.time && order > other.order); }
     };
 
     FailedPingLogController failedPingLogController_;
@@ -67,9 +122,35 @@ private:
     QHash<QString, PingNodeInfo> ips_;
     PingHost *pingHost_;
     QTimer pingTimer_;
+    QTimer dispatchTimer_;
+
+    // outdated entries (the node was removed or rescheduled) are skipped when they are taken from the queue
+    std::priority_queue<ScheduledPing, std::vector<ScheduledPing>, std::greater<ScheduledPing> > queue_;
+    QHash<QString, qint64> pingsInFlight_;     // ip -> time when the ping was sent
+    quint64 nextScheduleOrder_;
+    QSet<QString> warmUpIps_;                   // not answered yet
+    int maxPingsInFlight_;
+    int windowPingsCount_;
+    int windowFailedPingsCount_;
+
+    // the nodes of the first updateIps() not pinged yet, for the startup timeline
+    QSet<QString> firstSweepIps_;
+    qint64 firstSweepStartUs_;
+
+    SweepStats sweepStats_;
 
     QDateTime dtNextPingTime_;
     bool isNeedPingForNextDisconnectState_;
+    CONNECT_STATE prevConnectState_;
+
+    void schedulePing(const QString &ip, qint64 time);
+    int currentMaxPingsInFlight() const;
+    void scheduleAllPings(bool onlyPingedFromConnectedState);
+    void removeLostPings();
+    void adaptPingsInFlight(bool bSuccess);
+    void addToSweepStats(bool bSuccess, int timems);
+    void writeSweepSummaryIfFinished();
+    void writeSweepSummary();
 };
 
 } //namespace locationsmodel
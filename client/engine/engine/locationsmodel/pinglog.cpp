@@ -4,8 +4,9 @@
 #include <QDir>
 #include <QStandardPaths>
 #include <QDebug>
+#include "utils/logger.h"
 
-PingLog::PingLog(const QString &filename) : file_(NULL)
+PingLog::PingLog(const QString &filename) : file_(NULL), filename_(filename), droppedDetailsCount_(0)
 {
     QString logFilePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
     QDir dir(logFilePath);
@@ -36,3 +37,24 @@ void PingLog::addLog(const QString &tag, const QString &str)
     //qDebug() << tag << "\t\t" << str;
     textStream_.flush();
 }
+
+void PingLog::addDetail(const QString &tag, const QString &str)
+{
+    QMutexLocker locker(&mutex_);
+    if (details_.size() >= MAX_DETAILS)
+    {
+        details_.dequeue();
+        droppedDetailsCount_++;
+    }
+    details_.enqueue(QDateTime::currentDateTime().toString("ddMMyyyy HH:mm:ss") + "\t" + tag + "\t\t" + str);
+}
+
+void PingLog::dumpDetails()
+{
+    QMutexLocker locker(&mutex_);
+    qCDebug(LOG_PING) << "Latest ping results of" << filename_ << "(" << droppedDetailsCount_ << "older dropped):";
+    for (const QString &line : qAsConst(details_))
+    {
+        qCDebug(LOG_PING) << qPrintable(line);
+    }
+}
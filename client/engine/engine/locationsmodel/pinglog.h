@@ -4,7 +4,10 @@
 #include <QFile>
 #include <QTextStream>
 #include <QMutex>
+#include <QQueue>
 
+// The events are written to the file at once. The results of the single pings are kept in a bounded buffer in memory
+// instead, the controller writes a summary per sweep, the buffer is dumped to the debug log only when it is requested.
 class PingLog
 {
 public:
@@ -14,11 +17,18 @@ public:
     ~PingLog();
 
     void addLog(const QString &tag, const QString &str);
+    void addDetail(const QString &tag, const QString &str);
+    void dumpDetails();
 
 private:
+    static constexpr int MAX_DETAILS = 200;
+
     QMutex mutex_;
     QFile *file_;
     QTextStream textStream_;
+    QString filename_;
+    QQueue<QString> details_;
+    int droppedDetailsCount_;
 };
 
 #endif // PINGLOG_H
@@ -1,20 +1,31 @@
 #include "pingstorage.h"
 #include <QDataStream>
 #include <QDebug>
-#include <QSettings>
+#include <QDir>
+#include "utils/settingsstore.h"
+#include <QSet>
+#include <QStandardPaths>
+#include <algorithm>
+#include "utils/logger.h"
 #include "utils/protobuf_includes.h"
 
 namespace locationsmodel {
 
 PingStorage::PingStorage(const QString &settingsKeyName) : curIteration_(0),
-    settingsKeyName_(settingsKeyName)
+    settingsKeyName_(settingsKeyName), journalRecords_(0), unflushedRecords_(0)
 {
+    lastFlushTimer_.start();
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+    QDir().mkpath(dir);
+    journal_.setFileName(dir + "/" + settingsKeyName_ + ".journal");
+
     loadFromSettings();
+    replayJournal();
 }
 
 PingStorage::~PingStorage()
 {
-    saveToSettings();
+    compact();
 }
 
 void PingStorage::updateNodes(const QStringList &ips)
@@ -25,46 +36,80 @@ void PingStorage::updateNodes(const QStringList &ips)
         setIps.insert(ip);
     }
 
-    // find and remove unused nodes
-    auto it = hash_.begin();
-    while (it != hash_.end())
+    bool bChanged = false;
+
+    // find and remove unused nodes, the columns are compacted in place
+    int newCount = 0;
+    for (int i = 0; i < ips_.count(); ++i)
     {
-        if (!setIps.contains(it.key()))
+        if (!setIps.contains(ips_[i]))
         {
-            it = hash_.erase(it);
+            bChanged = true;
+            continue;
         }
-        else
+        if (newCount != i)
         {
-            ++it;
+            ips_[newCount] = ips_[i];
+            pingTimes_[newCount] = pingTimes_[i];
+            iterations_[newCount] = iterations_[i];
+            fromDisconnectedState_[newCount] = fromDisconnectedState_[i];
+            historyPos_[newCount] = historyPos_[i];
+            historyCount_[newCount] = historyCount_[i];
+            std::copy(history_.constBegin() + i * HISTORY_SIZE, history_.constBegin() + (i + 1) * HISTORY_SIZE,
+                      history_.begin() + newCount * HISTORY_SIZE);
         }
+        newCount++;
+    }
+    if (bChanged)
+    {
+        ips_.resize(newCount);
+        pingTimes_.resize(newCount);
+        iterations_.resize(newCount);
+        fromDisconnectedState_.resize(newCount);
+        historyPos_.resize(newCount);
+        historyCount_.resize(newCount);
+        history_.resize(newCount * HISTORY_SIZE);
+        rebuildIds();
     }
 
     // and new IPs
-    for (const QString &ip : setIps)
+    for (const QString &ip : qAsConst(setIps))
     {
-        if (!hash_.contains(ip))
+        if (findNode(ip) == -1)
         {
-            hash_[ip] = PingData();
+            addNode(ip);
+            bChanged = true;
         }
     }
 
+    // the removed nodes should not come back from the journal
+    if (bChanged)
+    {
+        compact();
+    }
 }
 
 void PingStorage::setNodePing(const QString &nodeIp, PingTime timeMs, bool fromDisconnectedState)
 {
-    PingData pd;
-    pd.timeMs_ = timeMs;
-    pd.iteration_ = curIteration_;
-    pd.fromDisconnectedState_ = fromDisconnectedState;
-    hash_[nodeIp] = pd;
+    int id = findNode(nodeIp);
+    if (id == -1)
+    {
+        id = addNode(nodeIp);
+    }
+    setNodePingImpl(id, timeMs.toInt(), curIteration_, fromDisconnectedState);
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream << static_cast<quint8>(JOURNAL_SET_PING) << nodeIp << static_cast<qint32>(timeMs.toInt()) << curIteration_ << fromDisconnectedState;
+    appendToJournal(record);
 }
 
 PingTime PingStorage::getNodeSpeed(const QString &nodeIp) const
 {
-    auto it = hash_.find(nodeIp);
-    if (it != hash_.end())
+    const int id = findNode(nodeIp);
+    if (id != -1)
     {
-        return it.value().timeMs_;
+        return pingTimes_[id];
     }
     else
     {
@@ -72,6 +117,11 @@ PingTime PingStorage::getNodeSpeed(const QString &nodeIp) const
     }
 }
 
+LatencyStats PingStorage::getNodeStats(const QString &nodeIp) const
+{
+    return LatencyStats::fromSamples(nodeHistory(nodeIp));
+}
+
 quint32 PingStorage::getCurrentIteration() const
 {
     return curIteration_;
@@ -80,6 +130,12 @@ quint32 PingStorage::getCurrentIteration() const
 void PingStorage::incIteration()
 {
     curIteration_++;
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream << static_cast<quint8>(JOURNAL_INC_ITERATION) << curIteration_;
+    // the pings of the finished iteration go to the disk with it
+    appendToJournal(record, true);
 }
 
 void PingStorage::getState(bool &isAllNodesHaveCurIteration, bool &isAllNodesInDisconnectedState)
@@ -87,58 +143,236 @@ void PingStorage::getState(bool &isAllNodesHaveCurIteration, bool &isAllNodesInD
     isAllNodesHaveCurIteration = true;
     isAllNodesInDisconnectedState = true;
 
-    for (auto it = hash_.begin(); it != hash_.end(); ++it)
+    for (int i = 0; i < ips_.count(); ++i)
     {
-        if (it.value().iteration_ != curIteration_)
+        if (iterations_[i] != curIteration_)
         {
             isAllNodesHaveCurIteration = false;
         }
-        if (!it.value().fromDisconnectedState_)
+        if (!fromDisconnectedState_[i])
         {
             isAllNodesInDisconnectedState = false;
         }
     }
 }
 
+int PingStorage::findNode(const QString &ip) const
+{
+    return ids_.value(ip, -1);
+}
+
+int PingStorage::addNode(const QString &ip)
+{
+    const int id = ips_.count();
+    ips_ << ip;
+    pingTimes_ << PingTime::NO_PING_INFO;
+    iterations_ << 0;
+    fromDisconnectedState_ << false;
+    historyPos_ << 0;
+    historyCount_ << 0;
+    history_.resize(history_.count() + HISTORY_SIZE);
+
+    ids_[ip] = id;
+    return id;
+}
+
+void PingStorage::rebuildIds()
+{
+    ids_.clear();
+    ids_.reserve(ips_.count());
+    for (int i = 0; i < ips_.count(); ++i)
+    {
+        ids_[ips_[i]] = i;
+    }
+}
+
+void PingStorage::setNodePingImpl(int id, int timeMs, quint32 iteration, bool fromDisconnectedState)
+{
+    pingTimes_[id] = timeMs;
+    iterations_[id] = iteration;
+    fromDisconnectedState_[id] = fromDisconnectedState;
+
+    if (timeMs >= 0 || timeMs == PingTime::PING_FAILED)
+    {
+        history_[id * HISTORY_SIZE + historyPos_[id]] = timeMs;
+        historyPos_[id] = (historyPos_[id] + 1) % HISTORY_SIZE;
+        if (historyCount_[id] < HISTORY_SIZE)
+        {
+            historyCount_[id]++;
+        }
+    }
+}
+
+QVector<int> PingStorage::nodeHistory(const QString &nodeIp) const
+{
+    QVector<int> samples;
+    const int id = findNode(nodeIp);
+    if (id != -1)
+    {
+        // oldest first
+        const int count = historyCount_[id];
+        const int start = (historyPos_[id] + HISTORY_SIZE - count) % HISTORY_SIZE;
+        for (int i = 0; i < count; ++i)
+        {
+            samples << history_[id * HISTORY_SIZE + (start + i) % HISTORY_SIZE];
+        }
+    }
+    return samples;
+}
+
+void PingStorage::appendToJournal(const QByteArray &record, bool isFlushNow)
+{
+    if (journalRecords_ >= MAX_JOURNAL_RECORDS)
+    {
+        compact();
+        return;
+    }
+
+    if (!journal_.isOpen() && !journal_.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        return;
+    }
+    journal_.write(record);
+    journalRecords_++;
+    unflushedRecords_++;
+    if (isFlushNow || unflushedRecords_ >= JOURNAL_FLUSH_RECORDS || lastFlushTimer_.elapsed() >= JOURNAL_FLUSH_INTERVAL_MS)
+    {
+        journal_.flush();
+        unflushedRecords_ = 0;
+        lastFlushTimer_.restart();
+    }
+}
+
+void PingStorage::replayJournal()
+{
+    if (!journal_.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream stream(&journal_);
+    int records = 0;
+    while (!stream.atEnd())
+    {
+        quint8 type;
+        stream >> type;
+        if (type == JOURNAL_SET_PING)
+        {
+            QString ip;
+            qint32 timeMs;
+            quint32 iteration;
+            bool fromDisconnectedState;
+            stream >> ip >> timeMs >> iteration >> fromDisconnectedState;
+            if (stream.status() != QDataStream::Ok)
+            {
+                break;
+            }
+            int id = findNode(ip);
+            if (id == -1)
+            {
+                id = addNode(ip);
+            }
+            setNodePingImpl(id, timeMs, iteration, fromDisconnectedState);
+        }
+        else if (type == JOURNAL_INC_ITERATION)
+        {
+            quint32 iteration;
+            stream >> iteration;
+            if (stream.status() != QDataStream::Ok)
+            {
+                break;
+            }
+            curIteration_ = iteration;
+        }
+        else
+        {
+            qCDebug(LOG_BASIC) << "PingStorage: incorrect journal record, the rest of" << journal_.fileName() << "is ignored";
+            break;
+        }
+        records++;
+    }
+    journal_.close();
+
+    // a torn record at the end (if the program was terminated) is dropped by the compaction
+    if (records > 0)
+    {
+        compact();
+    }
+    else
+    {
+        journal_.remove();
+    }
+}
+
+void PingStorage::compact()
+{
+    saveToSettings();
+
+    if (journal_.isOpen())
+    {
+        journal_.close();
+    }
+    // the journal is the only copy of the pings until the state is written, so not the deferred flush
+    if (SettingsStore::instance().flush())
+    {
+        journal_.remove();
+    }
+    journalRecords_ = 0;
+    unflushedRecords_ = 0;
+}
+
 void PingStorage::saveToSettings()
 {
     ProtoApiInfo::PingStorage storage;
 
     storage.set_cur_iteration(curIteration_);
-    for (auto it = hash_.begin(); it != hash_.end(); ++it)
+    for (int i = 0; i < ips_.count(); ++i)
     {
         ProtoApiInfo::PingData *pingData = storage.add_pings();
-        pingData->set_ip(it.key().toStdString());
-        pingData->set_pingtime(it.value().timeMs_.toInt());
-        pingData->set_iteration(it.value().iteration_);
-        pingData->set_from_disconnected_state(it.value().fromDisconnectedState_);
+        pingData->set_ip(ips_[i].toStdString());
+        pingData->set_pingtime(pingTimes_[i]);
+        pingData->set_iteration(iterations_[i]);
+        pingData->set_from_disconnected_state(fromDisconnectedState_[i]);
+
+        const int count = historyCount_[i];
+        const int start = (historyPos_[i] + HISTORY_SIZE - count) % HISTORY_SIZE;
+        for (int k = 0; k < count; ++k)
+        {
+            pingData->add_history(history_[i * HISTORY_SIZE + (start + k) % HISTORY_SIZE]);
+        }
     }
     size_t size = storage.ByteSizeLong();
     QByteArray arr(size, Qt::Uninitialized);
     storage.SerializeToArray(arr.data(), size);
 
-    QSettings settings;
-    settings.setValue(settingsKeyName_, arr);
+    SettingsStore::instance().setValue(settingsKeyName_, arr);
 }
 
 void PingStorage::loadFromSettings()
 {
-    QSettings settings;
-    if (settings.contains(settingsKeyName_))
+    if (SettingsStore::instance().contains(settingsKeyName_))
     {
-        QByteArray arr = settings.value(settingsKeyName_).toByteArray();
+        QByteArray arr = SettingsStore::instance().value(settingsKeyName_).toByteArray();
         ProtoApiInfo::PingStorage storage;
         if (storage.ParseFromArray(arr.data(), arr.size()))
         {
-            hash_.clear();
             curIteration_ = storage.cur_iteration();
             for (int i = 0; i < storage.pings_size(); ++i)
             {
-                PingData pd;
-                pd.timeMs_ = storage.pings(i).pingtime();
-                pd.iteration_ = storage.pings(i).iteration();
-                pd.fromDisconnectedState_ = storage.pings(i).from_disconnected_state();
-                hash_[QString::fromStdString(storage.pings(i).ip())] = pd;
+                const ProtoApiInfo::PingData &pd = storage.pings(i);
+                const QString ip = QString::fromStdString(pd.ip());
+                int id = findNode(ip);
+                if (id == -1)
+                {
+                    id = addNode(ip);
+                }
+                for (int k = qMax(0, pd.history_size() - HISTORY_SIZE); k < pd.history_size(); ++k)
+                {
+                    setNodePingImpl(id, pd.history(k), pd.iteration(), pd.from_disconnected_state());
+                }
+                pingTimes_[id] = pd.pingtime();
+                iterations_[id] = pd.iteration();
+                fromDisconnectedState_[id] = pd.from_disconnected_state();
             }
         }
     }
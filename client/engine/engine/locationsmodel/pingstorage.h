@@ -2,13 +2,19 @@
 #define PINGSTORAGE_H
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QHash>
-#include <QMutex>
+#include <QVector>
 #include "types/pingtime.h"
+#include "latencystats.h"
 
 namespace locationsmodel {
 
 // stores information about pings, persistent between runs of the program
+// Nodes are kept in columns indexed by a node id, the ids are looked up by the IP (or the hostname of a custom config)
+// in one hash, rebuilt when the columns are compacted.
+// The full state is saved in QSettings only on compaction, ping updates are appended to a journal file.
 class PingStorage
 {
 public:
@@ -20,26 +26,51 @@ public:
     void setNodePing(const QString &nodeIp, PingTime timeMs, bool fromDisconnectedState);
     PingTime getNodeSpeed(const QString &nodeIp) const;
 
+    // calculated from the last HISTORY_SIZE pings, empty if there are no samples
+    LatencyStats getNodeStats(const QString &nodeIp) const;
+
     quint32 getCurrentIteration() const;
     void incIteration();
 
     void getState(bool &isAllNodesHaveCurIteration, bool &isAllNodesInDisconnectedState);
 
 private:
+    static constexpr int HISTORY_SIZE = 8;
+    static constexpr int MAX_JOURNAL_RECORDS = 4096;   // the journal is compacted into QSettings after so many records
+    // the journal is flushed after so many records or so much time since the last flush, not on every ping
+    static constexpr int JOURNAL_FLUSH_RECORDS = 64;
+    static constexpr int JOURNAL_FLUSH_INTERVAL_MS = 5000;
+
+    enum JOURNAL_RECORD_TYPE { JOURNAL_SET_PING = 1, JOURNAL_INC_ITERATION = 2 };
 
-    struct PingData
-    {
-        PingTime timeMs_;
-        quint32 iteration_;
-        bool fromDisconnectedState_;
+    // columns, indexed by node id
+    QVector<QString> ips_;
+    QVector<int> pingTimes_;
+    QVector<quint32> iterations_;
+    QVector<bool> fromDisconnectedState_;
+    QVector<int> history_;          // HISTORY_SIZE samples per node (PingTime::PING_FAILED for the lost pings), ring
+    QVector<quint8> historyPos_;
+    QVector<quint8> historyCount_;
 
-        PingData() : iteration_(0), fromDisconnectedState_(false) {}
-    };
+    QHash<QString, int> ids_;
 
-    QHash<QString, PingData> hash_;
     quint32 curIteration_;
 
     QString settingsKeyName_;
+    QFile journal_;
+    int journalRecords_;
+    int unflushedRecords_;
+    QElapsedTimer lastFlushTimer_;
+
+    int findNode(const QString &ip) const;
+    int addNode(const QString &ip);
+    void rebuildIds();
+    void setNodePingImpl(int id, int timeMs, quint32 iteration, bool fromDisconnectedState);
+    QVector<int> nodeHistory(const QString &nodeIp) const;
+
+    void appendToJournal(const QByteArray &record, bool isFlushNow = false);
+    void replayJournal();
+    void compact();
 
     void saveToSettings();
     void loadFromSettings();
@@ -3,7 +3,7 @@
 #include "Utils/logger.h"
 
 MeasurementCpuUsage::MeasurementCpuUsage(QObject *parent, IHelper *helper, IConnectStateController *connectStateController) : QObject(parent),
-    bEnabled_(false)
+    bEnabled_(false), processTelemetry_(this)
 {
     helper_ = dynamic_cast<Helper_win *>(helper);
     Q_ASSERT(helper_);
@@ -45,8 +45,19 @@ void MeasurementCpuUsage::setEnabled(bool bEnabled)
     }
 }
 
+QString MeasurementCpuUsage::telemetrySummary() const
+{
+    return processTelemetry_.summary();
+}
+
 void MeasurementCpuUsage::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON /*reason*/, ProtoTypes::ConnectError /*err*/, const LocationID & /*location*/)
 {
+    // the processes of the tunnel are started and stopped around these states
+    if (state == CONNECT_STATE_CONNECTED || state == CONNECT_STATE_DISCONNECTED)
+    {
+        processTelemetry_.rescan();
+    }
+
     if (bEnabled_)
     {
         if (state == CONNECT_STATE_DISCONNECTED)
@@ -5,6 +5,7 @@
 #include <QHash>
 #include "helper/helper_win.h"
 #include "connectstatecontroller/iconnectstatecontroller.h"
+#include "processtelemetry_win.h"
 #include <pdh.h>
 
 class MeasurementCpuUsage : public QObject
@@ -15,6 +16,8 @@ public:
     virtual ~MeasurementCpuUsage();
 
     void setEnabled(bool bEnabled);
+    // the telemetry of the processes of the app, sampled regardless of setEnabled()
+    QString telemetrySummary() const;
 
 signals:
     void detectionCpuUsageAfterConnected(QStringList processesList);
@@ -27,6 +30,7 @@ private:
     Helper_win *helper_;
     PDH_HQUERY hQuery_;
     bool bEnabled_;
+    ProcessTelemetry_win processTelemetry_;
 
     struct UsageData
     {
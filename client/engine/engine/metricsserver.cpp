@@ -0,0 +1,91 @@
+#include "metricsserver.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+#include "enginemetrics.h"
+#include "ipc/commandstats.h"
+#include "utils/logger.h"
+
+MetricsServer::MetricsServer(QObject *parent) : QObject(parent)
+{
+    connect(&server_, SIGNAL(newConnection()), SLOT(onNewConnection()));
+}
+
+bool MetricsServer::start(quint16 port)
+{
+    if (!server_.listen(QHostAddress::LocalHost, port))
+    {
+        qCDebug(LOG_BASIC) << "Metrics endpoint can't listen on port" << port << ":" << server_.errorString();
+        return false;
+    }
+    qCDebug(LOG_BASIC) << "Metrics endpoint listens on 127.0.0.1:" << port;
+    return true;
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server_.nextPendingConnection())
+    {
+        connect(socket, SIGNAL(readyRead()), SLOT(onReadyRead()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        // the idle connections are not kept
+        QTimer::singleShot(READ_TIMEOUT, socket, SLOT(deleteLater()));
+    }
+}
+
+void MetricsServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket)
+    {
+        return;
+    }
+
+    // the request is read until the end of the headers, the body is ignored
+    QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+    if (!request.contains("\r\n\r\n"))
+    {
+        if (request.size() > MAX_REQUEST_SIZE)
+        {
+            socket->abort();
+            socket->deleteLater();
+        }
+        else
+        {
+            socket->setProperty("request", request);
+        }
+        return;
+    }
+    disconnect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    QByteArray status;
+    QByteArray body;
+    if (requestLine.count() >= 2 && requestLine[0] == "GET" && (requestLine[1] == "/metrics" || requestLine[1].startsWith("/metrics?")))
+    {
+        updateExternalMetrics();
+        status = "200 OK";
+        body = EngineMetrics::instance().toPrometheusText();
+    }
+    else
+    {
+        status = "404 Not Found";
+    }
+
+    socket->write("HTTP/1.1 " + status + "\r\n"
+                  "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                  "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                  "Connection: close\r\n\r\n" + body);
+    socket->disconnectFromHost();
+}
+
+void MetricsServer::updateExternalMetrics()
+{
+    const QHash<QString, IPC::CommandStats::Counters> ipcCounters = IPC::CommandStats::instance().counters();
+    for (auto it = ipcCounters.constBegin(); it != ipcCounters.constEnd(); ++it)
+    {
+        EngineMetrics::instance().setCount("windscribe_ipc_commands_total", it->count, "command", it.key());
+        EngineMetrics::instance().setCount("windscribe_ipc_command_bytes_total", it->bytes, "command", it.key());
+        EngineMetrics::instance().setCount("windscribe_ipc_command_time_ms_total", it->timeUs / 1000.0, "command", it.key());
+    }
+}
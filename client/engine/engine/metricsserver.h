@@ -0,0 +1,32 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+
+// Opt-in HTTP endpoint on 127.0.0.1 with the metrics of the engine for the monitoring agents:
+// GET /metrics answers EngineMetrics in the Prometheus text format, the rest is 404.
+// Enabled by ws-metrics-port in windscribe_extra.conf. One request per connection, no keep-alive.
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject *parent);
+
+    bool start(quint16 port);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    static constexpr int MAX_REQUEST_SIZE = 8192;
+    static constexpr int READ_TIMEOUT = 5000;
+
+    QTcpServer server_;
+
+    // the values kept outside of EngineMetrics
+    static void updateExternalMetrics();
+};
+
+#endif // METRICSSERVER_H
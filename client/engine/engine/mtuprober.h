@@ -0,0 +1,36 @@
+#ifndef MTUPROBER_H
+#define MTUPROBER_H
+
+#include <QString>
+#include <QVector>
+
+// Sends the ICMP echo requests of all the candidate sizes at once with the don't fragment flag and collects the replies
+// during a single timeout, so the packet size detection takes one round trip instead of a sequence of ping utility calls.
+// The sizes are the ICMP payload sizes, as for "ping -l" on Windows and "ping -s" on Mac/Linux.
+// Windows: IcmpSendEcho2 with IP_FLAG_DF. Mac/Linux: ICMP socket (datagram or raw) with IP_DONTFRAG/IP_MTU_DISCOVER.
+class MtuProber
+{
+public:
+    MtuProber();
+    ~MtuProber();
+
+    // false if the ICMP socket can't be opened (then the ping utility has to be used)
+    bool isValid() const;
+
+    // returns the largest size which got a reply, -1 if there are no replies at all
+    int probe(const QString &ip, const QVector<int> &sizes, int timeoutMs);
+
+private:
+    static constexpr int PROBES_PER_SIZE = 2;   // a single lost packet doesn't lower the result
+
+#ifdef Q_OS_WIN
+    void *icmpHandle_;
+#else
+    int socket_;
+    bool isRawSocket_;
+    unsigned short identifier_;
+    unsigned short nextSequenceNumber_;
+#endif
+};
+
+#endif // MTUPROBER_H
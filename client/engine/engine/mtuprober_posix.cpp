@@ -0,0 +1,193 @@
+#include "mtuprober.h"
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <sstream>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "utils/logger.h"
+#include "ping/icmp_header.h"
+#include "ping/ipv4_header.h"
+
+MtuProber::MtuProber() : socket_(-1), isRawSocket_(false),
+    identifier_(static_cast<unsigned short>(getpid() & 0xFFFF)), nextSequenceNumber_(0)
+{
+    // the datagram ICMP sockets do not require root (allowed on Mac and on Linux with net.ipv4.ping_group_range)
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+    if (socket_ < 0)
+    {
+        socket_ = ::socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+        isRawSocket_ = true;
+    }
+    if (socket_ < 0)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Can't open ICMP socket for MTU probes:" << strerror(errno);
+        return;
+    }
+
+    int flags = fcntl(socket_, F_GETFL, 0);
+    if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Can't set ICMP socket to non-blocking mode:" << strerror(errno);
+        ::close(socket_);
+        socket_ = -1;
+        return;
+    }
+
+    // set DF, the probes larger than the interface MTU fail right in sendto() with EMSGSIZE
+    bool isDontFragment = false;
+#if defined(IP_MTU_DISCOVER) && defined(IP_PMTUDISC_PROBE)
+    // PROBE, unlike DO, ignores the path MTU cached by the kernel, so the previous results don't affect the probes
+    int val = IP_PMTUDISC_PROBE;
+    isDontFragment = setsockopt(socket_, IPPROTO_IP, IP_MTU_DISCOVER, &val, sizeof(val)) == 0;
+#elif defined(IP_DONTFRAG)
+    int on = 1;
+    isDontFragment = setsockopt(socket_, IPPROTO_IP, IP_DONTFRAG, &on, sizeof(on)) == 0;
+#endif
+    if (!isDontFragment)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Can't set the don't fragment flag for ICMP socket:" << strerror(errno);
+        ::close(socket_);
+        socket_ = -1;
+        return;
+    }
+
+    int receiveBufferSize = 256 * 1024;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+}
+
+MtuProber::~MtuProber()
+{
+    if (socket_ >= 0)
+    {
+        ::close(socket_);
+    }
+}
+
+bool MtuProber::isValid() const
+{
+    return socket_ >= 0;
+}
+
+int MtuProber::probe(const QString &ip, const QVector<int> &sizes, int timeoutMs)
+{
+    if (socket_ < 0)
+    {
+        return -1;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, ip.toLatin1().constData(), &addr.sin_addr) != 1)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Incorrect IP for MTU probes:" << ip;
+        return -1;
+    }
+
+    // the sequence number identifies the size of the reply
+    QMap<unsigned short, int> sizeBySequenceNumber;
+    for (int size : sizes)
+    {
+        const std::string body(static_cast<size_t>(size), 'w');
+        for (int i = 0; i < PROBES_PER_SIZE; ++i)
+        {
+            const unsigned short sequenceNumber = nextSequenceNumber_++;
+            icmp_header echoRequest;
+            echoRequest.type(icmp_header::echo_request);
+            echoRequest.code(0);
+            echoRequest.identifier(identifier_);
+            echoRequest.sequence_number(sequenceNumber);
+            compute_checksum(echoRequest, body.begin(), body.end());
+
+            std::ostringstream os;
+            os << echoRequest << body;
+            const std::string packet = os.str();
+
+            if (sendto(socket_, packet.data(), packet.size(), 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0)
+            {
+                // EMSGSIZE is the expected result for the sizes above the interface MTU
+                if (errno != EMSGSIZE)
+                {
+                    qCDebug(LOG_PACKET_SIZE) << "Can't send MTU probe of size" << size << ":" << strerror(errno);
+                }
+                break;
+            }
+            sizeBySequenceNumber[sequenceNumber] = size;
+        }
+    }
+
+    int result = -1;
+    int largestPending = -1;
+    for (int size : qAsConst(sizeBySequenceNumber))
+    {
+        largestPending = qMax(largestPending, size);
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    std::vector<char> buf(65536);
+    // stop as soon as the largest sent size is answered, nothing can beat it
+    while (result < largestPending && elapsedTimer.elapsed() < timeoutMs)
+    {
+        pollfd pfd;
+        pfd.fd = socket_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int ret = poll(&pfd, 1, static_cast<int>(timeoutMs - elapsedTimer.elapsed()));
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            break;
+        }
+
+        while (true)
+        {
+            sockaddr_in from;
+            socklen_t fromLen = sizeof(from);
+            const ssize_t size = recvfrom(socket_, buf.data(), buf.size(), 0, reinterpret_cast<sockaddr *>(&from), &fromLen);
+            if (size <= 0)
+            {
+                break;
+            }
+            if (from.sin_addr.s_addr != addr.sin_addr.s_addr)
+            {
+                continue;
+            }
+
+            // the raw sockets (and the datagram sockets on Mac) return the packet with the IP header
+            std::istringstream is(std::string(buf.data(), static_cast<size_t>(size)));
+            if ((static_cast<unsigned char>(buf[0]) >> 4) == 4)
+            {
+                ipv4_header ipv4Header;
+                is >> ipv4Header;
+            }
+            icmp_header icmpHeader;
+            is >> icmpHeader;
+            if (!is || icmpHeader.type() != icmp_header::echo_reply)
+            {
+                continue;
+            }
+            // the kernel replaces the identifier for the datagram sockets on Linux, such sockets receive only own replies
+            if (isRawSocket_ && icmpHeader.identifier() != identifier_)
+            {
+                continue;
+            }
+            auto it = sizeBySequenceNumber.find(icmpHeader.sequence_number());
+            if (it != sizeBySequenceNumber.end())
+            {
+                result = qMax(result, it.value());
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,134 @@
+#include "mtuprober.h"
+
+#include <QElapsedTimer>
+#include <winsock2.h>
+#include <iphlpapi.h>
+#include <icmpapi.h>
+#include "utils/logger.h"
+
+MtuProber::MtuProber() : icmpHandle_(IcmpCreateFile())
+{
+    if (icmpHandle_ == INVALID_HANDLE_VALUE)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "IcmpCreateFile failed for MTU probes:" << GetLastError();
+    }
+}
+
+MtuProber::~MtuProber()
+{
+    if (icmpHandle_ != INVALID_HANDLE_VALUE)
+    {
+        IcmpCloseHandle(icmpHandle_);
+    }
+}
+
+bool MtuProber::isValid() const
+{
+    return icmpHandle_ != INVALID_HANDLE_VALUE;
+}
+
+int MtuProber::probe(const QString &ip, const QVector<int> &sizes, int timeoutMs)
+{
+    if (icmpHandle_ == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+
+    struct Probe
+    {
+        int size;
+        HANDLE hEvent;
+        QByteArray replyBuffer;
+    };
+
+    const IPAddr ipaddr = inet_addr(ip.toStdString().c_str());
+    IP_OPTION_INFORMATION options;
+    memset(&options, 0, sizeof(options));
+    options.Ttl = 128;
+    options.Flags = IP_FLAG_DF;
+
+    QVector<Probe> probes;
+    probes.reserve(sizes.count() * PROBES_PER_SIZE);
+    for (int size : sizes)
+    {
+        const QByteArray data(size, 'w');
+        for (int i = 0; i < PROBES_PER_SIZE; ++i)
+        {
+            Probe probe;
+            probe.size = size;
+            probe.hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+            if (probe.hEvent == NULL)
+            {
+                qCDebug(LOG_PACKET_SIZE) << "CreateEvent failed:" << GetLastError();
+                break;
+            }
+            // the reply contains the echoed data, IO_STATUS_BLOCK is required for the asynchronous calls
+            probe.replyBuffer.resize(static_cast<int>(sizeof(ICMP_ECHO_REPLY) + size + 8 + sizeof(IO_STATUS_BLOCK)));
+
+            const DWORD ret = IcmpSendEcho2(icmpHandle_, probe.hEvent, NULL, NULL, ipaddr,
+                                            (LPVOID)data.constData(), static_cast<WORD>(size), &options,
+                                            probe.replyBuffer.data(), probe.replyBuffer.size(), timeoutMs);
+            if (ret == 0 && GetLastError() != ERROR_IO_PENDING)
+            {
+                qCDebug(LOG_PACKET_SIZE) << "IcmpSendEcho2 failed for size" << size << ":" << GetLastError();
+                CloseHandle(probe.hEvent);
+                break;
+            }
+            probes << probe;
+        }
+    }
+
+    int result = -1;
+    int largestPending = -1;
+    for (const Probe &probe : qAsConst(probes))
+    {
+        largestPending = qMax(largestPending, probe.size);
+    }
+
+    QVector<int> pending;
+    for (int i = 0; i < probes.count(); ++i)
+    {
+        pending << i;
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    // stop as soon as the largest sent size is answered, nothing can beat it
+    while (!pending.isEmpty() && result < largestPending && elapsedTimer.elapsed() < timeoutMs)
+    {
+        QVector<HANDLE> events;
+        for (int ind : qAsConst(pending))
+        {
+            events << probes[ind].hEvent;
+        }
+        Q_ASSERT(events.count() <= MAXIMUM_WAIT_OBJECTS);
+
+        const DWORD ret = WaitForMultipleObjects(static_cast<DWORD>(events.count()), events.constData(), FALSE,
+                                                 static_cast<DWORD>(timeoutMs - elapsedTimer.elapsed()));
+        if (ret >= WAIT_OBJECT_0 + static_cast<DWORD>(events.count()))
+        {
+            break;
+        }
+
+        const int ind = pending.takeAt(static_cast<int>(ret - WAIT_OBJECT_0));
+        Probe &probe = probes[ind];
+        if (IcmpParseReplies(probe.replyBuffer.data(), probe.replyBuffer.size()) > 0)
+        {
+            const ICMP_ECHO_REPLY *reply = reinterpret_cast<const ICMP_ECHO_REPLY *>(probe.replyBuffer.constData());
+            // IP_PACKET_TOO_BIG is returned for the sizes which need the fragmentation
+            if (reply->Status == IP_SUCCESS)
+            {
+                result = qMax(result, probe.size);
+            }
+        }
+    }
+
+    // closing the handle cancels the outstanding requests, so the reply buffers can be released after that
+    IcmpCloseHandle(icmpHandle_);
+    icmpHandle_ = IcmpCreateFile();
+    for (const Probe &probe : qAsConst(probes))
+    {
+        CloseHandle(probe.hEvent);
+    }
+    return result;
+}
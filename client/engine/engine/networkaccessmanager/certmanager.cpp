@@ -33,10 +33,21 @@ CertManager::CertManager()
             qCDebug(LOG_BASIC) << "can't load SSL certificates from resources";
         }
     }
+
+    // parse the store once, it is shared by all SSL contexts
+    store_ = X509_STORE_new();
+    for (int i = 0; i < certs_.count(); ++i)
+    {
+        if (certs_[i].cert)
+        {
+            X509_STORE_add_cert(store_, certs_[i].cert);
+        }
+    }
 }
 
 CertManager::~CertManager()
 {
+    X509_STORE_free(store_);
     cleanCerts();
 }
 
@@ -50,6 +61,11 @@ X509 *CertManager::getCert(int ind)
     return certs_[ind].cert;
 }
 
+X509_STORE *CertManager::getX509Store()
+{
+    return store_;
+}
+
 void CertManager::parseCertsBundle(QByteArray &arr)
 {
     QString s = arr;
@@ -15,6 +15,9 @@ public:
     int count();
     X509 *getCert(int ind);
 
+    // the returned store is owned by CertManager, call X509_STORE_up_ref when passing it to SSL_CTX_set_cert_store
+    X509_STORE *getX509Store();
+
 private:
     struct CertDescr
     {
@@ -27,6 +30,7 @@ private:
     void cleanCerts();
 
     QVector<CertDescr> certs_;
+    X509_STORE *store_;
 };
 
 #endif // CERTMANAGER_H
@@ -11,7 +11,7 @@
 CurlNetworkManager2 *g_this = nullptr;
 
 CurlNetworkManager2::CurlNetworkManager2(QObject *parent) : QThread(parent),
-    bNeedFinish_(false)
+    bNeedFinish_(false), reusedConnectionsCount_(0), newConnectionsCount_(0)
   #if defined(Q_OS_MAC)
     , certPath_(QCoreApplication::applicationDirPath() + "/../resources/cert.pem")
   #elif defined (Q_OS_LINUX)
@@ -28,14 +28,31 @@ CurlNetworkManager2::CurlNetworkManager2(QObject *parent) : QThread(parent),
 
     g_this = this;
 
+    multiHandle_ = curl_multi_init();
+    // connections are kept in the multi handle cache and reused by subsequent requests,
+    // parallel requests to the same host are multiplexed over one connection if the server supports HTTP/2
+    curl_multi_setopt(multiHandle_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multiHandle_, CURLMOPT_MAXCONNECTS, MAX_CACHED_CONNECTIONS);
+
+    // TLS session IDs/tickets are shared between all easy handles, so new connections to the API use abbreviated handshakes.
+    // All easy handles are used only from the run() thread, so no lock functions are needed.
+    shareHandle_ = curl_share_init();
+    curl_share_setopt(shareHandle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
     start(LowPriority);
 }
 
 CurlNetworkManager2::~CurlNetworkManager2()
 {
-    bNeedFinish_ = true;
-    waitCondition_.wakeAll();
+    {
+        QMutexLocker locker(&mutex_);
+        bNeedFinish_ = true;
+        waitCondition_.wakeAll();
+    }
+    curl_multi_wakeup(multiHandle_);
     wait();
+    curl_multi_cleanup(multiHandle_);
+    curl_share_cleanup(shareHandle_);
 }
 
 size_t CurlNetworkManager2::writeDataCallback(void *ptr, size_t size, size_t count, void *id)
@@ -55,6 +72,26 @@ size_t CurlNetworkManager2::writeDataCallback(void *ptr, size_t size, size_t cou
     return size*count;
 }
 
+size_t CurlNetworkManager2::headerCallback(char *buffer, size_t size, size_t count, void *id)
+{
+    // the status line of each response (also of the redirects and of "100 Continue"), the last one is of the body
+    const QByteArray line = QByteArray::fromRawData(buffer, static_cast<int>(size * count));
+    if (line.startsWith("HTTP/"))
+    {
+        const QList<QByteArray> parts = line.simplified().split(' ');
+        if (parts.count() >= 2)
+        {
+            QMutexLocker locker(&g_this->mutex_);
+            auto it = g_this->activeRequests_.find(*static_cast<quint64 *>(id));
+            if (it != g_this->activeRequests_.end())
+            {
+                it.value()->setHttpStatusCode(parts[1].toInt());
+            }
+        }
+    }
+    return size * count;
+}
+
 int CurlNetworkManager2::progressCallback(void *id,   curl_off_t dltotal,   curl_off_t dlnow,   curl_off_t ultotal,   curl_off_t ulnow)
 {
     Q_UNUSED(ultotal);
@@ -79,14 +116,11 @@ CURLcode CurlNetworkManager2::sslctx_function(CURL *curl, void *sslctx, void *pa
 {
     Q_UNUSED(curl);
 
-    X509_STORE *store = X509_STORE_new();
-    SSL_CTX_set_cert_store((SSL_CTX *)sslctx, store);
-
+    // the store is parsed once in CertManager, SSL_CTX takes one more reference on it
     CertManager *certManager = static_cast<CertManager *>(parm);
-    for (int i = 0; i < certManager->count(); ++i)
-    {
-        X509_STORE_add_cert(store, certManager->getCert(i));
-    }
+    X509_STORE *store = certManager->getX509Store();
+    X509_STORE_up_ref(store);
+    SSL_CTX_set_cert_store((SSL_CTX *)sslctx, store);
 
     return CURLE_OK;
 }
@@ -120,12 +154,12 @@ void CurlNetworkManager2::abort(CurlReply *reply)
     QMutexLocker lock(&mutex_);
     activeRequests_.remove(reply->id());
     idsMap_.remove(reply->id());
+    curl_multi_wakeup(multiHandle_);
 }
 
 void CurlNetworkManager2::run()
 {
     //BIND_CRASH_HANDLER_FOR_THREAD();
-    CURLM *multi_handle = curl_multi_init();
     int still_running = 0;
     QMap<CURL *, quint64> map;
 
@@ -135,32 +169,22 @@ void CurlNetworkManager2::run()
 
     while (true)
     {
-        mutex_.lock();
-        while (still_running == 0 && queue_.isEmpty() && !bNeedFinish_)
-        {
-            waitCondition_.wait(&mutex_);
-        }
-        mutex_.unlock();
-
-        if (bNeedFinish_)
+        QQueue<quint64> newRequests;
         {
-            break;
-        }
-
-        mutex_.lock();
-        bool isExistRequest = false;
-        quint64 id;
-        if (!queue_.isEmpty())
-        {
-            id = queue_.dequeue();
-            isExistRequest = true;
+            QMutexLocker locker(&mutex_);
+            while (still_running == 0 && queue_.isEmpty() && !bNeedFinish_)
+            {
+                waitCondition_.wait(&mutex_);
+            }
+            if (bNeedFinish_)
+            {
+                break;
+            }
+            // take all pending requests at once, so they are executed concurrently in the multi handle
+            newRequests.swap(queue_);
         }
-        mutex_.unlock();
-
 
-        still_running = 0;
-
-        if (isExistRequest)
+        for (quint64 id : qAsConst(newRequests))
         {
             CURL *curl = nullptr;
             bool isMakeRequestCalled = false;
@@ -176,7 +200,7 @@ void CurlNetworkManager2::run()
             if (curl)
             {
                 map[curl] = id;
-                curl_multi_add_handle(multi_handle, curl);
+                curl_multi_add_handle(multiHandle_, curl);
             }
             else
             {
@@ -193,11 +217,6 @@ void CurlNetworkManager2::run()
                 }
             }
         }
-        else
-        {
-            int numfds;
-            curl_multi_wait(multi_handle, NULL, 0, 1000, &numfds);
-        }
 
         // check for aborted requests
         {
@@ -211,7 +230,7 @@ void CurlNetworkManager2::run()
                 }
                 if (!bFound)
                 {
-                    curl_multi_remove_handle(multi_handle, it.key());
+                    curl_multi_remove_handle(multiHandle_, it.key());
                     curl_easy_cleanup(it.key());
                     it = map.erase(it);
                 }
@@ -222,14 +241,14 @@ void CurlNetworkManager2::run()
             }
         }
 
-        curl_multi_perform(multi_handle, &still_running);
+        curl_multi_perform(multiHandle_, &still_running);
 
         // check finished requests
         struct CURLMsg *m;
         do
         {
             int msgq = 0;
-            m = curl_multi_info_read(multi_handle, &msgq);
+            m = curl_multi_info_read(multiHandle_, &msgq);
             if (m && (m->msg == CURLMSG_DONE))
             {
                 CURL *e = m->easy_handle;
@@ -237,22 +256,23 @@ void CurlNetworkManager2::run()
                 auto it = map.find(e);
                 if (it != map.end())
                 {
+                    updateConnectionStatistics(e);
+
+                    {
+                        QMutexLocker locker(&mutex_);
+                        auto request = activeRequests_.find(it.value());
+                        if (request != activeRequests_.end())
                         {
-                            QMutexLocker locker(&mutex_);
-                            auto request = activeRequests_.find(it.value());
-                            if (request != activeRequests_.end())
-                            {
-                                request.value()->setCurlErrorCode(m->data.result);
-                                emit request.value()->finished();
-                                activeRequests_.erase(request);
-                            }
+                            request.value()->setCurlErrorCode(m->data.result);
+                            emit request.value()->finished();
+                            activeRequests_.erase(request);
                         }
+                    }
 
-                        map.remove(e);
+                    map.remove(e);
 
-                    curl_multi_remove_handle(multi_handle, e);
+                    curl_multi_remove_handle(multiHandle_, e);
                     curl_easy_cleanup(e);
-
                 }
                 else
                 {
@@ -261,17 +281,19 @@ void CurlNetworkManager2::run()
             }
         } while(m);
 
-        if (bNeedFinish_)
+        // wait for activity on any of the running transfers;
+        // curl_multi_wakeup() from handleRequest()/abort() interrupts the wait, so new requests start without delay
+        if (still_running > 0)
         {
-            break;
+            int numfds;
+            curl_multi_poll(multiHandle_, NULL, 0, 1000, &numfds);
         }
     }
 
     // delete not finished requests
     for (auto it = map.begin(); it != map.end(); ++it)
     {
-        //delete it.value();
-        curl_multi_remove_handle(multi_handle, it.key());
+        curl_multi_remove_handle(multiHandle_, it.key());
         curl_easy_cleanup(it.key());
     }
     {
@@ -281,8 +303,6 @@ void CurlNetworkManager2::run()
     }
     map.clear();
 
-    curl_multi_cleanup(multi_handle);
-
 #ifdef MAKE_CURL_LOG_FILE
     fclose(logFile_);
 #endif
@@ -296,6 +316,7 @@ void CurlNetworkManager2::handleRequest(quint64 id)
     {
         queue_.enqueue(id);
         waitCondition_.wakeAll();
+        curl_multi_wakeup(multiHandle_);
     }
 }
 
@@ -356,9 +377,22 @@ CURL *CurlNetworkManager2::makeGetRequest(CurlReply *curlReply)
 
         if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeDataCallback) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, idsMap_[curlReply->id()].get()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_HEADERDATA, idsMap_[curlReply->id()].get()) != CURLE_OK) goto failed;
+        if (curlReply->networkRequest().resumeFrom() < 0)
+        {
+            if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) goto failed;
+        }
+        else if (curlReply->networkRequest().resumeFrom() > 0)
+        {
+            // fails with CURLE_RANGE_ERROR if the server doesn't support the ranges
+            if (curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(curlReply->networkRequest().resumeFrom())) != CURLE_OK) goto failed;
+        }
+        if (curlReply->networkRequest().maxReceiveSpeed() > 0)
+        {
+            if (curl_easy_setopt(curl, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(curlReply->networkRequest().maxReceiveSpeed())) != CURLE_OK) goto failed;
+        }
         if (curl_easy_setopt(curl, CURLOPT_URL, curlReply->networkRequest().url().toString().toStdString().c_str()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS , curlReply->networkRequest().timeout()) != CURLE_OK) goto failed;
 
         if (curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback) != CURLE_OK) goto failed;
@@ -368,6 +402,7 @@ CURL *CurlNetworkManager2::makeGetRequest(CurlReply *curlReply)
         if (!setupResolveHosts(curlReply, curl)) goto failed;
         if (!setupSslVerification(curlReply, curl)) goto failed;
         if (!setupProxy(curlReply, curl)) goto failed;
+        if (!setupConnectionReuse(curlReply, curl)) goto failed;
 
         return curl;
     }
@@ -392,7 +427,6 @@ CURL *CurlNetworkManager2::makePostRequest(CurlReply *curlReply)
         if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, idsMap_[curlReply->id()].get()) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK)  goto failed;
         if (curl_easy_setopt(curl, CURLOPT_URL, curlReply->networkRequest().url().toString().toStdString().c_str()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
 
         struct curl_slist *list = NULL;
         list = curl_slist_append(list, curlReply->networkRequest().contentTypeHeader().toStdString().c_str());
@@ -411,6 +445,7 @@ CURL *CurlNetworkManager2::makePostRequest(CurlReply *curlReply)
         if (!setupResolveHosts(curlReply, curl)) goto failed;
         if (!setupSslVerification(curlReply, curl)) goto failed;
         if (!setupProxy(curlReply, curl)) goto failed;
+        if (!setupConnectionReuse(curlReply, curl)) goto failed;
 
         return curl;
     }
@@ -455,7 +490,6 @@ CURL *CurlNetworkManager2::makeDeleteRequest(CurlReply *curlReply)
 
         if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_URL, curlReply->networkRequest().url().toString().toStdString().c_str()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE") != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS , curlReply->networkRequest().timeout()) != CURLE_OK) goto failed;
 
@@ -466,6 +500,7 @@ CURL *CurlNetworkManager2::makeDeleteRequest(CurlReply *curlReply)
         if (!setupResolveHosts(curlReply, curl)) goto failed;
         if (!setupSslVerification(curlReply, curl)) goto failed;
         if (!setupProxy(curlReply, curl)) goto failed;
+        if (!setupConnectionReuse(curlReply, curl)) goto failed;
 
         return curl;
     }
@@ -511,6 +546,7 @@ bool CurlNetworkManager2::setupSslVerification(CurlReply *curlReply, CURL *curl)
         if (curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, *sslctx_function) != CURLE_OK) return false;
         if (curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, &certManager_) != CURLE_OK) return false;
     }
+    if (curl_easy_setopt(curl, CURLOPT_SHARE, shareHandle_) != CURLE_OK) return false;
 
 #ifdef MAKE_CURL_LOG_FILE
     if (curl_easy_setopt(curl, CURLOPT_VERBOSE, 1) != CURLE_OK) return false;
@@ -519,6 +555,54 @@ bool CurlNetworkManager2::setupSslVerification(CurlReply *curlReply, CURL *curl)
     return true;
 }
 
+bool CurlNetworkManager2::setupConnectionReuse(CurlReply *curlReply, CURL *curl)
+{
+    // Curl identifies a cached connection by the hostname, port and proxy, but not by the IP which was actually used.
+    // If the resolved IPs for the host have changed (for example, after failover to other IPs), we force a new connection,
+    // which then replaces the outdated one in the cache.
+    const NetworkRequest &request = curlReply->networkRequest();
+    const QUrl url = request.url();
+    const int defaultPort = url.scheme().compare("http", Qt::CaseInsensitive) == 0 ? 80 : 443;
+    QString key = url.scheme().toLower() + "://" + url.host() + ":" + QString::number(url.port(defaultPort));
+    if (request.proxySettings().isProxyEnabled())
+    {
+        key += ";" + request.proxySettings().address() + ":" + QString::number(request.proxySettings().getPort());
+    }
+
+    auto it = hostIps_.find(key);
+    if (it != hostIps_.end() && it.value() != curlReply->ips())
+    {
+        if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) return false;
+    }
+    hostIps_[key] = curlReply->ips();
+
+    // prefer waiting for a connection which can be multiplexed rather than opening a new one
+    if (curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1) != CURLE_OK) return false;
+    if (curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1) != CURLE_OK) return false;
+    // the result is not checked, since curl may be built without HTTP/2 support; HTTP/1.1 is used in that case
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    return true;
+}
+
+void CurlNetworkManager2::updateConnectionStatistics(CURL *curl)
+{
+    long numConnects = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &numConnects) != CURLE_OK)
+    {
+        return;
+    }
+
+    if (numConnects == 0)
+    {
+        reusedConnectionsCount_++;
+    }
+    else
+    {
+        newConnectionsCount_ += numConnects;
+        qCDebug(LOG_CURL_MANAGER) << "Connections statistics: reused =" << reusedConnectionsCount_ << ", new handshakes =" << newConnectionsCount_;
+    }
+}
+
 bool CurlNetworkManager2::setupProxy(CurlReply *curlReply, CURL *curl)
 {
     QString proxyString;
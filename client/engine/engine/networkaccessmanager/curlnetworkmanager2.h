@@ -1,6 +1,7 @@
 #ifndef CURLNETWORKMANAGER2_H
 #define CURLNETWORKMANAGER2_H
 
+#include <QHash>
 #include <QQueue>
 #include <QThread>
 #include <QWaitCondition>
@@ -15,6 +16,7 @@
 //#define MAKE_CURL_LOG_FILE      1
 
 // Implementing queries with curl library. Don't use it directly, use NetworkAccessManager instead.
+// All requests are processed in one thread with a single curl multi handle, so they run concurrently rather than one after another.
 class CurlNetworkManager2 : public QThread
 {
     Q_OBJECT
@@ -37,6 +39,8 @@ private slots:
 private:
     CurlInitController curlInit_;
     CertManager certManager_;
+    CURLM *multiHandle_;            // all requests are executed concurrently in this multi handle
+    CURLSH *shareHandle_;           // TLS session cache shared by all requests
     QQueue<quint64> queue_;
     QWaitCondition waitCondition_;
     bool bNeedFinish_;
@@ -54,6 +58,11 @@ private:
 
     QMap<quint64, QSharedPointer<quint64> > idsMap_;   // need for curl callback functions, we pass pointer to quint64
 
+    static constexpr int MAX_CACHED_CONNECTIONS = 16;
+    QHash<QString, QStringList> hostIps_;   // last used IPs for host:port;proxy, accessed only from run() thread
+    quint64 reusedConnectionsCount_;
+    quint64 newConnectionsCount_;
+
     CurlReply *invokeRequest(CurlReply::REQUEST_TYPE type, const NetworkRequest &request, const QStringList &ips, const QByteArray &data = QByteArray());
 
     void setIdIntoMap(quint64 id);
@@ -66,9 +75,12 @@ private:
     bool setupResolveHosts(CurlReply *curlReply, CURL *curl);
     bool setupSslVerification(CurlReply *curlReply, CURL *curl);
     bool setupProxy(CurlReply *curlReply, CURL *curl);
+    bool setupConnectionReuse(CurlReply *curlReply, CURL *curl);
+    void updateConnectionStatistics(CURL *curl);
 
     static CURLcode sslctx_function(CURL *curl, void *sslctx, void *parm);
     static size_t writeDataCallback(void *ptr, size_t size, size_t count, void *id);
+    static size_t headerCallback(char *buffer, size_t size, size_t count, void *id);
     static int progressCallback(void *id,   curl_off_t dltotal,   curl_off_t dlnow,   curl_off_t ultotal,   curl_off_t ulnow);
 };
 
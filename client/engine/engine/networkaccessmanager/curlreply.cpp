@@ -2,7 +2,7 @@
 #include "curlnetworkmanager2.h"
 
 CurlReply::CurlReply(QObject *parent, const NetworkRequest &networkRequest, const QStringList &ips, REQUEST_TYPE requestType, const QByteArray &postData, CurlNetworkManager2 *manager)
-    : QObject(parent), mutex_(QMutex::Recursive), networkRequest_(networkRequest), ips_(ips), requestType_(requestType), postData_(postData), manager_(manager)
+    : QObject(parent), mutex_(QMutex::Recursive), httpStatusCode_(0), networkRequest_(networkRequest), ips_(ips), requestType_(requestType), postData_(postData), manager_(manager)
 {
     static std::atomic<quint64> id(0);
     id_ = id++;
@@ -31,6 +31,12 @@ void CurlReply::setCurlErrorCode(CURLcode curlErrorCode)
     curlErrorCode_ = curlErrorCode;
 }
 
+void CurlReply::setHttpStatusCode(int httpStatusCode)
+{
+    QMutexLocker locker(&mutex_);
+    httpStatusCode_ = httpStatusCode;
+}
+
 CurlReply::REQUEST_TYPE CurlReply::requestType() const
 {
     return requestType_;
@@ -105,3 +111,8 @@ QString CurlReply::errorString() const
     return str;
 }
 
+int CurlReply::httpStatusCode() const
+{
+    QMutexLocker locker(&mutex_);
+    return httpStatusCode_;
+}
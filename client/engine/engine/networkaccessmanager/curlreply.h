@@ -19,6 +19,7 @@ public:
     bool isSSLError() const;
     bool isSuccess() const;
     QString errorString() const;
+    int httpStatusCode() const;     // of the GET requests, 0 until the status line is received
 
 signals:
     void finished();
@@ -34,6 +35,7 @@ private:
     QStringList ips() const;
     void appendNewData(const QByteArray &newData);
     void setCurlErrorCode(CURLcode curlErrorCode);
+    void setHttpStatusCode(int httpStatusCode);
     REQUEST_TYPE requestType() const;
     const QByteArray &postData() const;
 
@@ -43,6 +45,7 @@ private:
     QByteArray data_;
     mutable QMutex mutex_;
     CURLcode curlErrorCode_;
+    int httpStatusCode_;
 
     quint64 id_;
     NetworkRequest networkRequest_;
@@ -3,6 +3,7 @@
 #include <QTimer>
 #include "utils/ipvalidation.h"
 #include "engine/dnsresolver/dnsrequest.h"
+#include "engine/enginemetrics.h"
 
 class DnsCache2::Usages
 {
@@ -38,12 +39,11 @@ private:
 };
 
 DnsCache2::DnsCache2(QObject *parent, int cacheTimeoutMs /*= 60000*/, int reviewCacheIntervalMs /*= 1000*/) : QObject(parent),
-    cacheTimeoutMs_(cacheTimeoutMs)
+    cacheTimeoutMs_(cacheTimeoutMs), reviewCacheIntervalMs_(reviewCacheIntervalMs)
 {
     usages_ = new Usages;
-    QTimer *timer = new QTimer(this);
-    connect(timer, SIGNAL(timeout()), SLOT(onTimer()));
-    timer->start(reviewCacheIntervalMs);
+    timer_.setSingleShot(true);
+    connect(&timer_, SIGNAL(timeout()), SLOT(onTimer()));
 }
 
 DnsCache2::~DnsCache2()
@@ -58,18 +58,32 @@ void DnsCache2::resolve(const QString &hostname, quint64 id, bool bypassCache /*
     if (!bypassCache)
     {
         auto it = cache_.find(hostname);
-        if (it != cache_.end())
+        if (it != cache_.end() && QDateTime::currentMSecsSinceEpoch() < it.value().expireTime)
         {
-            emit resolved(true, it.value().ips, id, true, 0);
+            if (EngineMetrics::instance().isEnabled())
+            {
+                EngineMetrics::instance().addCount("windscribe_dns_cache_lookups_total", "result", "hit");
+            }
+            if (it.value().isNegative)
+            {
+                emit resolved(false, QStringList(), id, true, 0);
+            }
+            else
+            {
+                it.value().hits++;
+                it.value().dnsServers = dnsServers;
+                it.value().timeoutMs = timeoutMs;
+                emit resolved(true, it.value().ips, id, true, 0);
+            }
             return;
         }
     }
 
-    DnsRequest *dnsRequest = new DnsRequest(this, hostname, dnsServers, timeoutMs);
-    dnsRequest->setProperty("requestId", id);
-    dnsRequest->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
-    connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
-    dnsRequest->lookup();
+    if (EngineMetrics::instance().isEnabled())
+    {
+        EngineMetrics::instance().addCount("windscribe_dns_cache_lookups_total", "result", bypassCache ? "bypass" : "miss");
+    }
+    startDnsRequest(hostname, id, dnsServers, timeoutMs, false);
 }
 
 void DnsCache2::notifyFinished(quint64 id)
@@ -94,42 +108,102 @@ void DnsCache2::onDnsRequestFinished()
 
     qint64 startTimeMs = dnsRequest->property("startTime").toLongLong(&bOk);
     Q_ASSERT(bOk);
-    qint64 timeRequest = QDateTime::currentMSecsSinceEpoch() - startTimeMs;
+    qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    qint64 timeRequest = curTime - startTimeMs;
     Q_ASSERT(timeRequest >= 0);
 
+    bool isPrefetch = dnsRequest->property("isPrefetch").toBool();
+
     bool bSuccess = false;
     if (!dnsRequest->isError())
     {
-        cache_[dnsRequest->hostname()].ips = dnsRequest->ips();
-        cache_[dnsRequest->hostname()].time = QDateTime::currentMSecsSinceEpoch();
+        qint64 lifetimeMs = cacheTimeoutMs_;
+        if (dnsRequest->ttl() > 0)
+        {
+            lifetimeMs = qBound((qint64)MIN_TTL_MS, (qint64)dnsRequest->ttl() * 1000, (qint64)MAX_TTL_MS);
+        }
+
+        CacheItem &item = cache_[dnsRequest->hostname()];
+        item.ips = dnsRequest->ips();
+        item.time = curTime;
+        item.expireTime = curTime + lifetimeMs;
+        item.isNegative = false;
+        item.hits = 0;
+        item.isPrefetching = false;
+        item.dnsServers = dnsRequest->property("dnsServers").toStringList();
+        item.timeoutMs = dnsRequest->property("timeoutMs").toInt();
+
+        scheduleEvent(item.time + (qint64)(lifetimeMs * PREFETCH_AT_LIFETIME), dnsRequest->hostname(), item.time, true);
+        scheduleEvent(item.expireTime, dnsRequest->hostname(), item.time, false);
         bSuccess = true;
 
         checkForNewIps();
     }
+    else
+    {
+        auto it = cache_.find(dnsRequest->hostname());
+        if (it != cache_.end())
+        {
+            // keep the previous answer until it expires
+            it.value().isPrefetching = false;
+        }
+        else if (dnsRequest->isNegativeAnswer())
+        {
+            CacheItem &item = cache_[dnsRequest->hostname()];
+            item.time = curTime;
+            item.expireTime = curTime + NEGATIVE_TTL_MS;
+            item.isNegative = true;
+            scheduleEvent(item.expireTime, dnsRequest->hostname(), item.time, false);
+        }
+    }
 
-    emit resolved(bSuccess, dnsRequest->ips(), requestId, false, timeRequest);
+    if (!isPrefetch)
+    {
+        emit resolved(bSuccess, dnsRequest->ips(), requestId, false, timeRequest);
+    }
     dnsRequest->deleteLater();
 }
 
 void DnsCache2::onTimer()
 {
     bool bChanged = false;
-    // delete outdated and unused IPs from cache
-    auto it = cache_.begin();
-    while (it != cache_.end())
+    qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+
+    while (!events_.empty() && events_.top().time <= curTime)
     {
-        qint64 curTime = QDateTime::currentMSecsSinceEpoch();
-        if ((curTime - it.value().time) > cacheTimeoutMs_ && !usages_->isHostnameUsed(it.key()))
+        ScheduledEvent event = events_.top();
+        events_.pop();
+
+        auto it = cache_.find(event.hostname);
+        if (it == cache_.end() || it.value().time != event.itemTime)
         {
-            it = cache_.erase(it);
-            bChanged = true;
+            // the item was removed or updated after the event was scheduled
+            continue;
+        }
+
+        if (event.isPrefetch)
+        {
+            // refresh hot hostnames in the background, so that requests never wait for resolution
+            if (it.value().hits >= PREFETCH_MIN_HITS && !it.value().isPrefetching && !it.value().isNegative)
+            {
+                it.value().isPrefetching = true;
+                startDnsRequest(event.hostname, 0, it.value().dnsServers, it.value().timeoutMs, true);
+            }
+        }
+        else if (usages_->isHostnameUsed(event.hostname))
+        {
+            // don't delete IPs from the cache while they are used by requests (they are whitelisted in the firewall)
+            scheduleEvent(curTime + reviewCacheIntervalMs_, event.hostname, event.itemTime, false);
         }
         else
         {
-            ++it;
+            cache_.erase(it);
+            bChanged = true;
         }
     }
 
+    restartTimer();
+
     if (bChanged)
     {
         checkForNewIps();
@@ -158,3 +232,38 @@ void DnsCache2::checkForNewIps()
     }
 }
 
+
+void DnsCache2::startDnsRequest(const QString &hostname, quint64 id, const QStringList &dnsServers, int timeoutMs, bool isPrefetch)
+{
+    DnsRequest *dnsRequest = new DnsRequest(this, hostname, dnsServers, timeoutMs);
+    dnsRequest->setProperty("requestId", id);
+    dnsRequest->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
+    dnsRequest->setProperty("isPrefetch", isPrefetch);
+    dnsRequest->setProperty("dnsServers", dnsServers);
+    dnsRequest->setProperty("timeoutMs", timeoutMs);
+    connect(dnsRequest, SIGNAL(finished()), SLOT(onDnsRequestFinished()));
+    dnsRequest->lookup();
+}
+
+void DnsCache2::scheduleEvent(qint64 time, const QString &hostname, qint64 itemTime, bool isPrefetch)
+{
+    ScheduledEvent event;
+    event.time = time;
+    event.hostname = hostname;
+    event.itemTime = itemTime;
+    event.isPrefetch = isPrefetch;
+    events_.push(event);
+    restartTimer();
+}
+
+void DnsCache2::restartTimer()
+{
+    if (events_.empty())
+    {
+        timer_.stop();
+        return;
+    }
+
+    qint64 interval = events_.top().time - QDateTime::currentMSecsSinceEpoch();
+    timer_.start(interval > 0 ? (int)qMin(interval, (qint64)MAX_TTL_MS) : 0);
+}
@@ -4,7 +4,13 @@
 #include <QMap>
 #include <QObject>
 #include <QHostInfo>
+#include <QTimer>
+#include <queue>
 
+// DNS cache for NetworkAccessManager.
+// Entries expire according to the TTL of the DNS answer (or cacheTimeoutMs, if TTL is unknown).
+// Failed answers (NXDOMAIN, SERVFAIL) are cached for a short time to avoid repeating the lookups.
+// Entries which were requested several times are refreshed in the background before they expire.
 class DnsCache2 : public QObject
 {
     Q_OBJECT
@@ -29,25 +35,47 @@ private slots:
     void checkForNewIps();
 
 private:
+    static constexpr int MIN_TTL_MS = 5000;
+    static constexpr int MAX_TTL_MS = 60 * 60 * 1000;
+    static constexpr int NEGATIVE_TTL_MS = 5000;
+    static constexpr int PREFETCH_MIN_HITS = 2;     // the hostname is considered hot if it was requested from the cache at least so many times
+    static constexpr double PREFETCH_AT_LIFETIME = 0.8;
+
     struct CacheItem
     {
-        qint64 time;
+        qint64 time;            // time when the answer has been received
+        qint64 expireTime;
         QStringList ips;
+        bool isNegative;
+        int hits;
+        bool isPrefetching;
+        QStringList dnsServers;
+        int timeoutMs;
 
-        CacheItem() : time(0) {}
+        CacheItem() : time(0), expireTime(0), isNegative(false), hits(0), isPrefetching(false), timeoutMs(5000) {}
     };
 
-    struct PendingRequest
+    struct ScheduledEvent
     {
+        qint64 time;
         QString hostname;
-        quint64 id;
+        qint64 itemTime;        // time of the cache item for which the event was scheduled, outdated events are ignored
+        bool isPrefetch;
+
+        bool operator>(const ScheduledEvent &other) const { return time > other.time; }
     };
 
     QMap<QString, CacheItem> cache_;
     Usages *usages_;
     QSet<QString> lastWhitelistIps_;
     int cacheTimeoutMs_;
+    int reviewCacheIntervalMs_;
+    QTimer timer_;
+    std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, std::greater<ScheduledEvent> > events_;
 
+    void startDnsRequest(const QString &hostname, quint64 id, const QStringList &dnsServers, int timeoutMs, bool isPrefetch);
+    void scheduleEvent(qint64 time, const QString &hostname, qint64 itemTime, bool isPrefetch);
+    void restartTimer();
 };
 
 #endif // DNSCACHE2_H
@@ -230,6 +230,11 @@ bool NetworkReply::isSuccess() const
     return error_ == NoError;
 }
 
+int NetworkReply::httpStatusCode() const
+{
+    return curlReply_ ? curlReply_->httpStatusCode() : 0;
+}
+
 void NetworkReply::setCurlReply(CurlReply *curlReply)
 {
     curlReply_ = curlReply;
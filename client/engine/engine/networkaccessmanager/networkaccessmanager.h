@@ -23,6 +23,7 @@ public:
     QByteArray readAll();
     NetworkError error() const;
     bool isSuccess() const;
+    int httpStatusCode() const;     // 0 if not received yet
 
 signals:
     void finished();
@@ -1,6 +1,7 @@
 #include "networkrequest.h"
 
-NetworkRequest::NetworkRequest(const QUrl &url, int timeout, bool bUseDnsCache) : url_(url), timeout_(timeout), bUseDnsCache_(bUseDnsCache), bIgnoreSslErrors_(false)
+NetworkRequest::NetworkRequest(const QUrl &url, int timeout, bool bUseDnsCache) : url_(url), timeout_(timeout), bUseDnsCache_(bUseDnsCache), bIgnoreSslErrors_(false),
+    resumeFrom_(-1), maxReceiveSpeed_(0)
 {
 }
 
@@ -73,3 +74,23 @@ const ProxySettings &NetworkRequest::proxySettings() const
 {
     return proxySettings_;
 }
+
+void NetworkRequest::setResumeFrom(qint64 offset)
+{
+    resumeFrom_ = offset;
+}
+
+qint64 NetworkRequest::resumeFrom() const
+{
+    return resumeFrom_;
+}
+
+void NetworkRequest::setMaxReceiveSpeed(qint64 bytesPerSecond)
+{
+    maxReceiveSpeed_ = bytesPerSecond;
+}
+
+qint64 NetworkRequest::maxReceiveSpeed() const
+{
+    return maxReceiveSpeed_;
+}
@@ -7,7 +7,7 @@
 class NetworkRequest
 {
 public:
-    explicit NetworkRequest() {}
+    explicit NetworkRequest() : timeout_(0), bUseDnsCache_(false), bIgnoreSslErrors_(false), resumeFrom_(-1), maxReceiveSpeed_(0) {}
     explicit NetworkRequest(const QUrl &url, int timeout, bool bUseDnsCache);
 
     void setUrl(const QUrl &url);
@@ -31,6 +31,15 @@ public:
     void setProxySettings(const ProxySettings &proxySettings);
     const ProxySettings &proxySettings() const;
 
+    // the offset to continue the download from (a range request), -1 for not resumable downloads;
+    // the resumable downloads are requested without the content encoding, so the offsets are in the file bytes
+    void setResumeFrom(qint64 offset);
+    qint64 resumeFrom() const;
+
+    // bytes per second, 0 is unlimited
+    void setMaxReceiveSpeed(qint64 bytesPerSecond);
+    qint64 maxReceiveSpeed() const;
+
 private:
     QUrl url_;
     int timeout_;
@@ -39,6 +48,8 @@ private:
     bool bIgnoreSslErrors_;
     QString header_;
     QStringList dnsServers_;
+    qint64 resumeFrom_;
+    qint64 maxReceiveSpeed_;
 };
 
 #endif // NETWORKREQUEST_H
@@ -9,10 +9,15 @@
 #include <net/if.h>
 #include <unistd.h>
 #include <linux/wireless.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <climits>
+#include <errno.h>
 
 const int typeIdNetworkInterface = qRegisterMetaType<ProtoTypes::NetworkInterface>("ProtoTypes::NetworkInterface");
 
-NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IHelper *helper) : INetworkDetectionManager (parent)
+NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IHelper *helper) : INetworkDetectionManager (parent),
+    ncm_(nullptr), netlinkFd_(-1), netlinkNotifier_(nullptr)
 {
     Q_UNUSED(helper);
 
@@ -20,14 +25,27 @@ NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IH
     getDefaultRouteInterface(isOnline_);
     updateNetworkInfo(false);
 
-    ncm_ = new QNetworkConfigurationManager(this);
-    connect(ncm_, &QNetworkConfigurationManager::configurationAdded, this, &NetworkDetectionManager_linux::onNetworkUpdated);
-    connect(ncm_, &QNetworkConfigurationManager::configurationChanged, this, &NetworkDetectionManager_linux::onNetworkUpdated);
-    connect(ncm_, &QNetworkConfigurationManager::configurationRemoved, this, &NetworkDetectionManager_linux::onNetworkUpdated);
+    updateTimer_.setSingleShot(true);
+    updateTimer_.setInterval(UPDATE_DEBOUNCE_INTERVAL);
+    connect(&updateTimer_, &QTimer::timeout, this, &NetworkDetectionManager_linux::onUpdateTimer);
+
+    if (!openNetlinkSubscription())
+    {
+        qCDebug(LOG_BASIC) << "NetworkDetectionManager_linux: can't subscribe to rtnetlink, using QNetworkConfigurationManager";
+        ncm_ = new QNetworkConfigurationManager(this);
+        connect(ncm_, &QNetworkConfigurationManager::configurationAdded, this, &NetworkDetectionManager_linux::onNetworkUpdated);
+        connect(ncm_, &QNetworkConfigurationManager::configurationChanged, this, &NetworkDetectionManager_linux::onNetworkUpdated);
+        connect(ncm_, &QNetworkConfigurationManager::configurationRemoved, this, &NetworkDetectionManager_linux::onNetworkUpdated);
+    }
 }
 
 NetworkDetectionManager_linux::~NetworkDetectionManager_linux()
 {
+    delete netlinkNotifier_;
+    if (netlinkFd_ != -1)
+    {
+        close(netlinkFd_);
+    }
 }
 
 void NetworkDetectionManager_linux::getCurrentNetworkInterface(ProtoTypes::NetworkInterface &networkInterface)
@@ -42,9 +60,110 @@ bool NetworkDetectionManager_linux::isOnline()
 
 void NetworkDetectionManager_linux::onNetworkUpdated(const QNetworkConfiguration &/*config*/)
 {
+    friendlyNames_.clear();
     updateNetworkInfo(true);
 }
 
+void NetworkDetectionManager_linux::onNetlinkActivated()
+{
+    bool isRelevant = false;
+    char buf[16384];
+    while (true)
+    {
+        ssize_t len = recv(netlinkFd_, buf, sizeof(buf), 0);
+        if (len < 0)
+        {
+            // the socket buffer overflowed, some of the changes are lost
+            if (errno == ENOBUFS)
+            {
+                isRelevant = true;
+                continue;
+            }
+            break;
+        }
+        if (len == 0)
+        {
+            break;
+        }
+        for (const nlmsghdr *hdr = reinterpret_cast<const nlmsghdr *>(buf); NLMSG_OK(hdr, len); hdr = NLMSG_NEXT(hdr, len))
+        {
+            if (isRelevantNetlinkMessage(hdr))
+            {
+                isRelevant = true;
+                // the connection name can change with the link or the address (another Wi-Fi network)
+                if (hdr->nlmsg_type != RTM_NEWROUTE && hdr->nlmsg_type != RTM_DELROUTE)
+                {
+                    friendlyNames_.clear();
+                }
+            }
+        }
+    }
+
+    if (isRelevant && !updateTimer_.isActive())
+    {
+        updateTimer_.start();
+    }
+}
+
+void NetworkDetectionManager_linux::onUpdateTimer()
+{
+    updateNetworkInfo(true);
+}
+
+bool NetworkDetectionManager_linux::openNetlinkSubscription()
+{
+    netlinkFd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (netlinkFd_ == -1)
+    {
+        return false;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV4_ROUTE;
+    if (bind(netlinkFd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1)
+    {
+        close(netlinkFd_);
+        netlinkFd_ = -1;
+        return false;
+    }
+
+    netlinkNotifier_ = new QSocketNotifier(netlinkFd_, QSocketNotifier::Read);
+    connect(netlinkNotifier_, &QSocketNotifier::activated, this, &NetworkDetectionManager_linux::onNetlinkActivated);
+    return true;
+}
+
+// the changes of the default route and of the current interface, the changes of the other interfaces
+// (docker, VPN adapters) don't matter until they become the default route
+bool NetworkDetectionManager_linux::isRelevantNetlinkMessage(const nlmsghdr *hdr) const
+{
+    const int curIndex = networkInterface_.interface_index();
+    switch (hdr->nlmsg_type)
+    {
+        case RTM_NEWROUTE:
+        case RTM_DELROUTE:
+        {
+            const rtmsg *rt = static_cast<const rtmsg *>(NLMSG_DATA(hdr));
+            return rt->rtm_dst_len == 0 && rt->rtm_table == RT_TABLE_MAIN;
+        }
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+        {
+            const ifinfomsg *ifi = static_cast<const ifinfomsg *>(NLMSG_DATA(hdr));
+            return !isOnline_ || ifi->ifi_index == curIndex;
+        }
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+        {
+            const ifaddrmsg *ifa = static_cast<const ifaddrmsg *>(NLMSG_DATA(hdr));
+            return static_cast<int>(ifa->ifa_index) == curIndex;
+        }
+        default:
+            return false;
+    }
+}
+
 void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal)
 {
     bool newIsOnline;
@@ -73,41 +192,97 @@ void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal)
     }
 }
 
+// the interface of the default IPv4 route with the lowest metric in the main table (the tun interfaces are skipped),
+// isOnline is true if there is any default route
 QString NetworkDetectionManager_linux::getDefaultRouteInterface(bool &isOnline)
 {
-    QString strReply;
-    FILE *file = popen("/etc/windscribe/route -n | grep '^0\\.0\\.0\\.0'", "r");
-    if (file)
+    isOnline = false;
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd == -1)
     {
-        char szLine[4096];
-        while(fgets(szLine, sizeof(szLine), file) != 0)
-        {
-            strReply += szLine;
-        }
-        pclose(file);
+        qCDebug(LOG_BASIC) << "NetworkDetectionManager_linux::getDefaultRouteInterface socket error" << errno;
+        return QString();
     }
 
-    const QStringList lines = strReply.split('\n', QString::SkipEmptyParts);
-
-    isOnline = !lines.isEmpty();
+    struct
+    {
+        nlmsghdr hdr;
+        rtmsg msg;
+    } request;
+    memset(&request, 0, sizeof(request));
+    request.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(rtmsg));
+    request.hdr.nlmsg_type = RTM_GETROUTE;
+    request.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.hdr.nlmsg_seq = 1;
+    request.msg.rtm_family = AF_INET;
+    request.msg.rtm_table = RT_TABLE_MAIN;
 
-    for (auto &it : lines)
+    QString ifname;
+    quint32 bestPriority = UINT_MAX;
+    if (send(fd, &request, request.hdr.nlmsg_len, 0) >= 0)
     {
-        const QStringList pars = it.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-        if (pars.size() == 8)
+        char buf[16384];
+        bool isDone = false;
+        while (!isDone)
         {
-            if (!pars[7].startsWith("tun") && !pars[7].startsWith("utun"))
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len <= 0)
             {
-                return pars[7];
+                break;
+            }
+            for (const nlmsghdr *hdr = reinterpret_cast<const nlmsghdr *>(buf); NLMSG_OK(hdr, len); hdr = NLMSG_NEXT(hdr, len))
+            {
+                if (hdr->nlmsg_type == NLMSG_DONE || hdr->nlmsg_type == NLMSG_ERROR)
+                {
+                    isDone = true;
+                    break;
+                }
+                if (hdr->nlmsg_type != RTM_NEWROUTE)
+                {
+                    continue;
+                }
+
+                const rtmsg *rt = static_cast<const rtmsg *>(NLMSG_DATA(hdr));
+                if (rt->rtm_family != AF_INET || rt->rtm_dst_len != 0 || rt->rtm_table != RT_TABLE_MAIN)
+                {
+                    continue;
+                }
+
+                int oif = 0;
+                quint32 priority = 0;
+                int attrLen = RTM_PAYLOAD(hdr);
+                for (const rtattr *attr = RTM_RTA(rt); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen))
+                {
+                    if (attr->rta_type == RTA_OIF)
+                    {
+                        oif = *static_cast<const int *>(RTA_DATA(attr));
+                    }
+                    else if (attr->rta_type == RTA_PRIORITY)
+                    {
+                        priority = *static_cast<const quint32 *>(RTA_DATA(attr));
+                    }
+                }
+
+                isOnline = true;
+                char name[IF_NAMESIZE];
+                if (oif != 0 && if_indextoname(oif, name) != nullptr)
+                {
+                    const QString routeIfname = QString::fromLatin1(name);
+                    if (!routeIfname.startsWith("tun") && !routeIfname.startsWith("utun") && priority < bestPriority)
+                    {
+                        ifname = routeIfname;
+                        bestPriority = priority;
+                    }
+                }
             }
-        }
-        else
-        {
-            qDebug(LOG_BASIC) << "NetworkDetectionManager_linux::getDefaultRouteInterface parse error";
-            return QString();
         }
     }
-    return QString();
+    else
+    {
+        qCDebug(LOG_BASIC) << "NetworkDetectionManager_linux::getDefaultRouteInterface send error" << errno;
+    }
+    close(fd);
+    return ifname;
 }
 
 void NetworkDetectionManager_linux::getInterfacePars(const QString &ifname, ProtoTypes::NetworkInterface &outNetworkInterface)
@@ -211,6 +386,12 @@ bool NetworkDetectionManager_linux::checkWirelessByIfName(const QString &ifname)
 
 QString NetworkDetectionManager_linux::getFriendlyNameByIfName(const QString &ifname)
 {
+    auto it = friendlyNames_.constFind(ifname);
+    if (it != friendlyNames_.constEnd())
+    {
+        return it.value();
+    }
+
     QString strReply;
     FILE *file = popen("nmcli -t -f NAME,DEVICE c show", "r");
     if (file)
@@ -231,10 +412,12 @@ QString NetworkDetectionManager_linux::getFriendlyNameByIfName(const QString &if
         {
             if (pars[1] == ifname)
             {
+                friendlyNames_[ifname] = pars[0];
                 return pars[0];
             }
         }
     }
+    friendlyNames_[ifname] = QString();
     return QString();
 }
 
@@ -1,11 +1,19 @@
 #ifndef NETWORKDETECTIONMANAGER_LINUX_H
 #define NETWORKDETECTIONMANAGER_LINUX_H
 
+#include <QHash>
 #include <QMutex>
 #include <QNetworkConfigurationManager>
+#include <QSocketNotifier>
+#include <QTimer>
 #include "engine/helper/ihelper.h"
 #include "inetworkdetectionmanager.h"
 
+struct nlmsghdr;
+
+// The default route and the interface state are read from rtnetlink. The manager subscribes to the route, link
+// and address changes and updates the state only when a change concerns the default route or its interface,
+// the updates are coalesced by updateTimer_. QNetworkConfigurationManager is used if the netlink socket fails.
 class NetworkDetectionManager_linux : public INetworkDetectionManager
 {
     Q_OBJECT
@@ -17,12 +25,23 @@ public:
 
 private slots:
     void onNetworkUpdated(const QNetworkConfiguration &config);
+    void onNetlinkActivated();
+    void onUpdateTimer();
 
 private:
+    static constexpr int UPDATE_DEBOUNCE_INTERVAL = 500;    // ms
+
     bool isOnline_;
     ProtoTypes::NetworkInterface networkInterface_;
     QNetworkConfigurationManager *ncm_;
 
+    int netlinkFd_;
+    QSocketNotifier *netlinkNotifier_;
+    QTimer updateTimer_;
+    QHash<QString, QString> friendlyNames_;     // ifname -> the NetworkManager connection name, cleared on the link changes
+
+    bool openNetlinkSubscription();
+    bool isRelevantNetlinkMessage(const nlmsghdr *hdr) const;
 
     void updateNetworkInfo(bool bWithEmitSignal);
     QString getDefaultRouteInterface(bool &isOnline);
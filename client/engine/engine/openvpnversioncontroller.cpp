@@ -2,6 +2,9 @@
 
 #include <QDir>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
 #include <QProcess>
 #include <QSettings>
 
@@ -154,6 +157,14 @@ QString OpenVpnVersionController::detectVersion(const QString &path)
     {
         return "";
     }
+
+    const QByteArray hash = fileHash(path);
+    const QString version = cachedVersion(path, hash);
+    if (!version.isEmpty())
+    {
+        return version;
+    }
+
     QProcess process;
     process.setProcessChannelMode(QProcess::MergedChannels);
     process.start(path, QStringList() << "--version");
@@ -167,6 +178,10 @@ QString OpenVpnVersionController::detectVersion(const QString &path)
     Q_ASSERT(list.count() == 1);
     if (list.count() == 1)
     {
+        if (!list[0].isEmpty())
+        {
+            saveCachedVersion(path, hash, list[0]);
+        }
         return list[0];
     }
     else
@@ -174,3 +189,48 @@ QString OpenVpnVersionController::detectVersion(const QString &path)
         return "";
     }
 }
+
+QString OpenVpnVersionController::cachedVersion(const QString &path, const QByteArray &hash)
+{
+    const QFileInfo fi(path);
+    QSettings settings;
+    const QVariantMap item = settings.value("openvpnVersionCache/" + path.toUtf8().toHex()).toMap();
+    if (item.value("size").toLongLong() == fi.size() &&
+        item.value("modified").toLongLong() == fi.lastModified().toMSecsSinceEpoch() &&
+        !hash.isEmpty() && item.value("hash").toByteArray() == hash)
+    {
+        return item.value("version").toString();
+    }
+    return "";
+}
+
+void OpenVpnVersionController::saveCachedVersion(const QString &path, const QByteArray &hash, const QString &version)
+{
+    if (hash.isEmpty())
+    {
+        return;
+    }
+    const QFileInfo fi(path);
+    QVariantMap item;
+    item["size"] = fi.size();
+    item["modified"] = fi.lastModified().toMSecsSinceEpoch();
+    item["hash"] = hash;
+    item["version"] = version;
+    QSettings settings;
+    settings.setValue("openvpnVersionCache/" + path.toUtf8().toHex(), item);
+}
+
+QByteArray OpenVpnVersionController::fileHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+    {
+        return QByteArray();
+    }
+    return hash.result();
+}
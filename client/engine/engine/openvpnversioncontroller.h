@@ -3,6 +3,7 @@
 
 #include <QStringList>
 #include <QMutex>
+#include <atomic>
 
 //thread safe
 class OpenVpnVersionController
@@ -31,10 +32,15 @@ private:
     QStringList openVpnFilesList_;
     int selectedInd_;
     QMutex mutex_;
-    bool bUseWinTun_;
+    std::atomic<bool> bUseWinTun_;
 
     QString getOpenVpnBinaryPath();
     QString detectVersion(const QString &path);
+    // the binary changes with an app update only, so its version is kept in the settings by path, size, modification
+    // time and hash, the process is not started on the next runs
+    QString cachedVersion(const QString &path, const QByteArray &hash);
+    void saveCachedVersion(const QString &path, const QByteArray &hash, const QString &version);
+    static QByteArray fileHash(const QString &path);
 };
 
 #endif // OPENVPNVERSIONCONTROLLER_H
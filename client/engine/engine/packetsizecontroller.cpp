@@ -1,5 +1,10 @@
 #include "packetsizecontroller.h"
 
+#include <QDateTime>
+#include <QElapsedTimer>
+#include "mtuprober.h"
+#include "dnsresolver/dnsrequest.h"
+#include "dnsresolver/dnsserversconfiguration.h"
 #include "utils/hardcodedsettings.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
@@ -18,10 +23,10 @@ void PacketSizeController::setPacketSize(const ProtoTypes::PacketSize &packetSiz
     setPacketSizeImpl(packetSize);
 }
 
-void PacketSizeController::detectAppropriatePacketSize(const QString &hostname)
+void PacketSizeController::detectAppropriatePacketSize(const QString &hostname, const QString &networkId)
 {
     QMutexLocker locker(&mutex_);
-    QMetaObject::invokeMethod(this, "detectAppropriatePacketSizeImpl", Q_ARG(QString, hostname));
+    QMetaObject::invokeMethod(this, "detectAppropriatePacketSizeImpl", Q_ARG(QString, hostname), Q_ARG(QString, networkId));
 }
 
 void PacketSizeController::earlyStop()
@@ -39,14 +44,31 @@ void PacketSizeController::setPacketSizeImpl(const ProtoTypes::PacketSize &packe
     }
 }
 
-void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostname)
+void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostname, const QString &networkId)
 {
     {
         QMutexLocker locker(&mutex_);
         earlyStop_ = false;
     }
 
-    const int mtu = getIdealPacketSize(hostname);
+    // the path MTU depends on the network and on the server behind the hostname
+    const QString cacheKey = networkId.isEmpty() ? QString() : networkId + "/" + hostname;
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    int mtu = -1;
+    auto it = cache_.find(cacheKey);
+    if (!cacheKey.isEmpty() && it != cache_.end() && curTime - it.value().time < CACHE_TTL_MS)
+    {
+        mtu = it.value().mtu;
+        qCDebug(LOG_PACKET_SIZE) << "Using mtu detected for the network" << (curTime - it.value().time) / 1000 << "s ago";
+    }
+    else
+    {
+        mtu = getIdealPacketSize(hostname);
+        if (mtu > 0 && !cacheKey.isEmpty())
+        {
+            cache_[cacheKey] = { mtu, curTime };
+        }
+    }
     const bool is_error = mtu < 0;
 
     QMutexLocker locker(&mutex_);
@@ -64,7 +86,6 @@ void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostna
 
 int PacketSizeController::getIdealPacketSize(const QString &hostname)
 {
-    int mtu = 1470;
     QString modifiedHostname = hostname;
 
     // if this is IP, use without change
@@ -81,30 +102,81 @@ int PacketSizeController::getIdealPacketSize(const QString &hostname)
 
     qCDebug(LOG_PACKET_SIZE) << "Detecting packet size via:" << modifiedHostname;
 
-    bool success = false;
-    while (mtu >= 1300)
+    QVector<int> sizes;
+    for (int mtu = MAX_MTU; mtu >= MIN_MTU; mtu -= MTU_STEP)
+    {
+        sizes << mtu;
+    }
+
+    int mtu = -1;
+    MtuProber prober;
+    const QString ip = prober.isValid() ? resolveHostname(modifiedHostname) : QString();
+    if (!ip.isEmpty())
+    {
+        QElapsedTimer elapsedTimer;
+        elapsedTimer.start();
+        mtu = prober.probe(ip, sizes, PROBE_TIMEOUT_MS);
+        qCDebug(LOG_PACKET_SIZE) << "MTU probes to" << ip << "finished in" << elapsedTimer.elapsed() << "ms";
+    }
+    else
+    {
+        mtu = searchWithPingUtility(modifiedHostname, sizes);
+    }
+
+    if (mtu < 0)
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Couldn't find appropriate MTU -- check internet connection";
+        return -1;
+    }
+
+    return mtu;
+}
+
+// the fallback if ICMP socket can't be used: a binary search over the sizes (sorted in descending order)
+// with the ping utility, about log2(n) sequential pings instead of n
+int PacketSizeController::searchWithPingUtility(const QString &hostname, const QVector<int> &sizes)
+{
+    int lo = 0;
+    int hi = sizes.count() - 1;
+    int found = -1;     // the index of the largest size succeeded so far
+    while (lo <= hi)
     {
-        QMutexLocker locker(&mutex_);
-        if (earlyStop_)
         {
-            qCDebug(LOG_PACKET_SIZE) << "Exiting packet size detection loop early";
-            break;
+            QMutexLocker locker(&mutex_);
+            if (earlyStop_)
+            {
+                qCDebug(LOG_PACKET_SIZE) << "Exiting packet size detection loop early";
+                return -1;
+            }
         }
 
-        bool pingSuccess = Utils::pingWithMtu(modifiedHostname, mtu);
-        if (pingSuccess)
+        const int mid = (lo + hi) / 2;
+        if (Utils::pingWithMtu(hostname, sizes[mid]))
+        {
+            found = mid;
+            hi = mid - 1;   // the larger sizes
+        }
+        else
         {
-            success = true;
-            break;
+            lo = mid + 1;
         }
-        mtu -= 10;
     }
+    return found >= 0 ? sizes[found] : -1;
+}
 
-    if (!success)
+QString PacketSizeController::resolveHostname(const QString &hostname)
+{
+    if (IpValidation::instance().isIp(hostname))
     {
-        qCDebug(LOG_PACKET_SIZE) << "Couldn't find appropriate MTU -- check internet connection";
-        return -1;
+        return hostname;
     }
 
-    return mtu;
+    DnsRequest dnsRequest(nullptr, hostname, DnsServersConfiguration::instance().getCurrentDnsServers());
+    dnsRequest.lookupBlocked();
+    if (dnsRequest.isError() || dnsRequest.ips().isEmpty())
+    {
+        qCDebug(LOG_PACKET_SIZE) << "Can't resolve" << hostname << "for MTU probes:" << dnsRequest.errorString();
+        return QString();
+    }
+    return dnsRequest.ips().first();
 }
@@ -2,9 +2,13 @@
 #define PACKETSIZECONTROLLER_H
 
 #include <QObject>
+#include <QHash>
 #include <QMutex>
+#include <QVector>
 #include "utils/protobuf_includes.h"
 
+// The detection sends the don't fragment probes of all the candidate sizes in one round (see MtuProber),
+// the results are cached per network (network or SSID name) and API hostname for CACHE_TTL_MS.
 class PacketSizeController : public QObject
 {
     Q_OBJECT
@@ -12,22 +16,38 @@ public:
     explicit PacketSizeController(QObject *parent = nullptr);
 
     void setPacketSize(const ProtoTypes::PacketSize &packetSize);
-    void detectAppropriatePacketSize(const QString &hostname);
+    void detectAppropriatePacketSize(const QString &hostname, const QString &networkId);
     void earlyStop();
 signals:
     void packetSizeChanged(bool isAuto, int mtu);
     void finishedPacketSizeDetection(bool isError);
 
 private slots:
-    void detectAppropriatePacketSizeImpl(const QString &hostname);
+    void detectAppropriatePacketSizeImpl(const QString &hostname, const QString &networkId);
 
 private:
+    static constexpr int MIN_MTU = 1300;
+    static constexpr int MAX_MTU = 1470;
+    static constexpr int MTU_STEP = 10;
+    static constexpr int PROBE_TIMEOUT_MS = 1000;
+    static constexpr qint64 CACHE_TTL_MS = 60 * 60 * 1000;
+
+    struct CachedMtu
+    {
+        int mtu;
+        qint64 time;
+    };
+
     QMutex mutex_;
     bool earlyStop_;
     ProtoTypes::PacketSize packetSize_;
     void setPacketSizeImpl(const ProtoTypes::PacketSize &packetSize);
 
+    QHash<QString, CachedMtu> cache_;   // accessed in the controller's thread only
+
     int getIdealPacketSize(const QString &hostname);
+    int searchWithPingUtility(const QString &hostname, const QVector<int> &sizes);
+    static QString resolveHostname(const QString &hostname);
 };
 
 #endif // PACKETSIZECONTROLLER_H
@@ -6,7 +6,8 @@
 #include "utils/hardcodedsettings.h"
 
 KeepAliveManager::KeepAliveManager(QObject *parent, IConnectStateController *stateController) : QObject(parent),
-    isEnabled_(false), curConnectState_(CONNECT_STATE_DISCONNECTED), pingHostIcmp_(this, stateController)
+    isEnabled_(false), curConnectState_(CONNECT_STATE_DISCONNECTED), curTimeout_(KEEP_ALIVE_TIMEOUT),
+    prevTotalBytesIn_(0), isTrafficSinceTimer_(false), isTrafficFlowing_(false), pingHostIcmp_(this, stateController)
 {
     connect(stateController, SIGNAL(stateChanged(CONNECT_STATE,DISCONNECT_REASON,ProtoTypes::ConnectError,LocationID)), SLOT(onConnectStateChanged(CONNECT_STATE,DISCONNECT_REASON,ProtoTypes::ConnectError,LocationID)));
     connect(&timer_, SIGNAL(timeout()), SLOT(onTimer()));
@@ -35,6 +36,7 @@ void KeepAliveManager::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REA
     Q_UNUSED(location);
 
     curConnectState_ = state;
+    resetTrafficState();
     if (state == CONNECT_STATE_CONNECTED && isEnabled_)
     {
         DnsRequest *dnsRequest = new DnsRequest(this, HardcodedSettings::instance().serverUrl(), DnsServersConfiguration::instance().getCurrentDnsServers());
@@ -47,7 +49,55 @@ void KeepAliveManager::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REA
     }
 }
 
+void KeepAliveManager::onStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes)
+{
+    Q_UNUSED(bytesOut);
+
+    // only the received bytes prove that the tunnel works
+    if (isTotalBytes)
+    {
+        if (bytesIn > prevTotalBytesIn_)
+        {
+            isTrafficSinceTimer_ = true;
+        }
+        prevTotalBytesIn_ = bytesIn;
+    }
+    else if (bytesIn > 0)
+    {
+        isTrafficSinceTimer_ = true;
+    }
+}
+
 void KeepAliveManager::onTimer()
+{
+    if (isTrafficSinceTimer_)
+    {
+        // the traffic keeps the tunnel alive, the request isn't needed
+        isTrafficSinceTimer_ = false;
+        isTrafficFlowing_ = true;
+        startTimer(KEEP_ALIVE_TIMEOUT);
+    }
+    else if (isTrafficFlowing_)
+    {
+        // the counters have stalled while connected, check the tunnel now
+        isTrafficFlowing_ = false;
+        sendPing();
+        startTimer(KEEP_ALIVE_TIMEOUT);
+    }
+    else
+    {
+        sendPing();
+        startTimer(qMin(curTimeout_ * 2, static_cast<int>(MAX_KEEP_ALIVE_TIMEOUT)));
+    }
+}
+
+void KeepAliveManager::startTimer(int timeout)
+{
+    curTimeout_ = timeout;
+    timer_.start(curTimeout_);
+}
+
+void KeepAliveManager::sendPing()
 {
     for (int i = 0; i < ips_.count(); ++i)
     {
@@ -65,6 +115,14 @@ void KeepAliveManager::onTimer()
     }
 }
 
+void KeepAliveManager::resetTrafficState()
+{
+    curTimeout_ = KEEP_ALIVE_TIMEOUT;
+    prevTotalBytesIn_ = 0;
+    isTrafficSinceTimer_ = false;
+    isTrafficFlowing_ = false;
+}
+
 void KeepAliveManager::onDnsRequestFinished()
 {
     DnsRequest *dnsRequest = qobject_cast<DnsRequest *>(sender());
@@ -80,7 +138,7 @@ void KeepAliveManager::onDnsRequestFinished()
 
         if (curConnectState_ == CONNECT_STATE_CONNECTED && isEnabled_)
         {
-            timer_.start(KEEP_ALIVE_TIMEOUT);
+            startTimer(KEEP_ALIVE_TIMEOUT);
         }
     }
     else
@@ -108,4 +166,10 @@ void KeepAliveManager::onPingFinished(bool bSuccess, int timems, const QString &
             break;
         }
     }
+
+    // retry soon (the next IP) instead of backing off
+    if (!bSuccess && timer_.isActive() && curTimeout_ > FAST_KEEP_ALIVE_TIMEOUT)
+    {
+        startTimer(FAST_KEEP_ALIVE_TIMEOUT);
+    }
 }
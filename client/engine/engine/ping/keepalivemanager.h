@@ -11,7 +11,10 @@
     #include "pinghost_icmp_mac.h"
 #endif
 
-// If enabled, when user is connected to the tunnel send an ICMP request to windscribe.com every 10s.
+// If enabled, when user is connected to the tunnel send an ICMP request to windscribe.com.
+// The request is skipped while the tunnel receives traffic (see onStatisticsUpdated), when the tunnel is idle the interval
+// is doubled after each successful request, from 10s up to 80s. When the traffic stops, or a request fails,
+// the next request is sent sooner.
 class KeepAliveManager : public QObject
 {
     Q_OBJECT
@@ -20,6 +23,10 @@ public:
 
     void setEnabled(bool isEnabled);
 
+public slots:
+    // from ConnectionManager::statisticsUpdated()
+    void onStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+
 private slots:
     void onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
     void onTimer();
@@ -30,7 +37,18 @@ private:
     bool isEnabled_;
     CONNECT_STATE curConnectState_;
     static constexpr int KEEP_ALIVE_TIMEOUT = 10000;
+    static constexpr int MAX_KEEP_ALIVE_TIMEOUT = 80000;
+    static constexpr int FAST_KEEP_ALIVE_TIMEOUT = 2000;
     QTimer timer_;
+    int curTimeout_;
+
+    quint64 prevTotalBytesIn_;
+    bool isTrafficSinceTimer_;      // received bytes since the previous onTimer()
+    bool isTrafficFlowing_;         // the previous onTimer() saw the traffic
+
+    void startTimer(int timeout);
+    void sendPing();
+    void resetTrafficState();
 
     struct IP_DESCR
     {
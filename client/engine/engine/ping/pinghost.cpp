@@ -1,13 +1,18 @@
 #include "pinghost.h"
+#include "../connectstatecontroller/iconnectstatecontroller.h"
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+#include <QTimer>
+#include "engine/tests/networkrecorder.h"
+#endif
 
 const int typeIdPingType = qRegisterMetaType<PingHost::PING_TYPE>("PingHost::PING_TYPE");
 
 
 PingHost::PingHost(QObject *parent, IConnectStateController *stateController) : QObject(parent),
-    pingHostTcp_(this, stateController), pingHostIcmp_(this, stateController)
+    connectStateController_(stateController), pingHostTcp_(this, stateController), pingHostIcmp_(this, stateController)
 {
-    connect(&pingHostTcp_, SIGNAL(pingFinished(bool,int,QString,bool)), SIGNAL(pingFinished(bool,int,QString,bool)));
-    connect(&pingHostIcmp_, SIGNAL(pingFinished(bool,int,QString,bool)), SIGNAL(pingFinished(bool,int,QString,bool)));
+    connect(&pingHostTcp_, SIGNAL(pingFinished(bool,int,QString,bool)), SLOT(onPingFinished(bool,int,QString,bool)));
+    connect(&pingHostIcmp_, SIGNAL(pingFinished(bool,int,QString,bool)), SLOT(onPingFinished(bool,int,QString,bool)));
 }
 
 void PingHost::addHostForPing(const QString &ip, PingHost::PING_TYPE pingType)
@@ -37,6 +42,20 @@ void PingHost::enableProxy()
 
 void PingHost::addHostForPingImpl(const QString &ip, PingHost::PING_TYPE pingType)
 {
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    if (NetworkRecorder::instance().isReplaying())
+    {
+        NetworkRecorder::PingAnswer answer;
+        NetworkRecorder::instance().replayPing(ip, answer);
+        const bool bSuccess = answer.success && !answer.isLost;
+        const bool bFromDisconnectedState = isFromDisconnectedState();
+        QTimer::singleShot(answer.timeMs, this, [this, ip, answer, bSuccess, bFromDisconnectedState]() {
+            emit pingFinished(bSuccess, bSuccess ? answer.timeMs : 0, ip, bFromDisconnectedState);
+        });
+        return;
+    }
+#endif
+
     if (pingType == PING_TCP)
     {
         pingHostTcp_.addHostForPing(ip);
@@ -74,3 +93,27 @@ void PingHost::enableProxyImpl()
     pingHostTcp_.enableProxy();
     pingHostIcmp_.enableProxy();
 }
+
+void PingHost::onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState)
+{
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    if (NetworkRecorder::instance().isRecording())
+    {
+        NetworkRecorder::PingAnswer answer;
+        answer.success = bSuccess;
+        answer.timeMs = timems;
+        NetworkRecorder::instance().recordPing(ip, answer);
+    }
+#endif
+    emit pingFinished(bSuccess, timems, ip, isFromDisconnectedState);
+}
+
+bool PingHost::isFromDisconnectedState() const
+{
+    if (connectStateController_)
+    {
+        const CONNECT_STATE state = connectStateController_->currentState();
+        return state == CONNECT_STATE_DISCONNECTED || state == CONNECT_STATE_CONNECTING;
+    }
+    return true;
+}
@@ -38,7 +38,10 @@ private slots:
     void disableProxyImpl();
     void enableProxyImpl();
 
+    void onPingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState);
+
 private:
+    IConnectStateController *connectStateController_;
     PingHost_TCP pingHostTcp_;
 #ifdef Q_OS_WIN
     PingHost_ICMP_win pingHostIcmp_;
@@ -46,6 +49,7 @@ private:
     PingHost_ICMP_mac pingHostIcmp_;
 #endif
 
+    bool isFromDisconnectedState() const;
 };
 
 #endif // PINGHOST_H
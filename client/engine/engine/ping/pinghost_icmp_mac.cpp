@@ -1,4 +1,13 @@
 #include "pinghost_icmp_mac.h"
+#include <QDateTime>
+#include <sstream>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include "utils/ipvalidation.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
@@ -6,14 +15,23 @@
 #include "ipv4_header.h"
 
 PingHost_ICMP_mac::PingHost_ICMP_mac(QObject *parent, IConnectStateController *stateController) : QObject(parent),
-    connectStateController_(stateController)
+    connectStateController_(stateController), socket_(-1), isRawSocket_(false),
+    identifier_(static_cast<unsigned short>(getpid() & 0xFFFF)), nextSequenceNumber_(0), socketNotifier_(nullptr),
+    socketTimeoutTimer_(this)    // child of this object to be moved into the ping thread together with it
 {
+    socketTimeoutTimer_.setInterval(SOCKET_TIMEOUT_TIMER_INTERVAL);
+    connect(&socketTimeoutTimer_, SIGNAL(timeout()), SLOT(onSocketTimeoutTimer()));
 
+    if (openSocket())
+    {
+        qCDebug(LOG_PING) << "ICMP pings use" << (isRawSocket_ ? "raw" : "datagram") << "socket";
+    }
 }
 
 PingHost_ICMP_mac::~PingHost_ICMP_mac()
 {
     clearPings();
+    closeSocket();
 }
 
 void PingHost_ICMP_mac::addHostForPing(const QString &ip)
@@ -27,7 +45,11 @@ void PingHost_ICMP_mac::addHostForPing(const QString &ip)
 }
 
 void PingHost_ICMP_mac::clearPings()
-{   
+{
+    socketPings_.clear();
+    socketPingsByIp_.clear();
+    socketTimeoutTimer_.stop();
+
     for (QMap<QString, PingInfo *>::iterator it = pingingHosts_.begin(); it != pingingHosts_.end(); ++it)
     {
         it.value()->process->blockSignals(true);
@@ -114,13 +136,129 @@ void PingHost_ICMP_mac::onProcessFinished(int exitCode, QProcess::ExitStatus exi
 }
 
 
+void PingHost_ICMP_mac::onSocketReadyRead()
+{
+    while (true)
+    {
+        char buf[1500];
+        char control[CMSG_SPACE(sizeof(timeval))];
+        sockaddr_in from;
+        iovec iov;
+        iov.iov_base = buf;
+        iov.iov_len = sizeof(buf);
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &from;
+        msg.msg_namelen = sizeof(from);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t size = recvmsg(socket_, &msg, 0);
+        if (size <= 0)
+        {
+            break;
+        }
+
+        timeval recvTime;
+        bool isKernelTimestamp = false;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP)
+            {
+                memcpy(&recvTime, CMSG_DATA(cmsg), sizeof(recvTime));
+                isKernelTimestamp = true;
+            }
+        }
+        if (!isKernelTimestamp)
+        {
+            gettimeofday(&recvTime, NULL);
+        }
+
+        // the raw sockets (and the datagram sockets on Mac) return the packet with the IP header
+        std::istringstream is(std::string(buf, size));
+        if ((static_cast<unsigned char>(buf[0]) >> 4) == 4)
+        {
+            ipv4_header ipv4Header;
+            is >> ipv4Header;
+        }
+        icmp_header icmpHeader;
+        is >> icmpHeader;
+        if (!is || icmpHeader.type() != icmp_header::echo_reply)
+        {
+            continue;
+        }
+        // the kernel replaces the identifier for the datagram sockets on Linux, such sockets receive only own replies
+        if (isRawSocket_ && icmpHeader.identifier() != identifier_)
+        {
+            continue;
+        }
+
+        auto it = socketPings_.find(icmpHeader.sequence_number());
+        if (it == socketPings_.end())
+        {
+            continue;
+        }
+
+        char fromIp[INET_ADDRSTRLEN];
+        if (inet_ntop(AF_INET, &from.sin_addr, fromIp, sizeof(fromIp)) == NULL || it.value().ip != QLatin1String(fromIp))
+        {
+            continue;
+        }
+
+        const qint64 timeMs = (recvTime.tv_sec - it.value().sendTime.tv_sec) * 1000LL + (recvTime.tv_usec - it.value().sendTime.tv_usec) / 1000;
+        finishSocketPing(it.key(), true, static_cast<int>(qMax(0LL, timeMs)));
+    }
+
+    processNextPings();
+}
+
+void PingHost_ICMP_mac::onSocketTimeoutTimer()
+{
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    QVector<unsigned short> timedOutPings;
+    for (auto it = socketPings_.constBegin(); it != socketPings_.constEnd(); ++it)
+    {
+        if (curTime - it.value().sendTimeMs >= PING_TIMEOUT)
+        {
+            timedOutPings << it.key();
+        }
+    }
+
+    for (unsigned short sequenceNumber : qAsConst(timedOutPings))
+    {
+        finishSocketPing(sequenceNumber, false, 0);
+    }
+
+    if (socketPings_.isEmpty())
+    {
+        socketTimeoutTimer_.stop();
+    }
+    processNextPings();
+}
+
 bool PingHost_ICMP_mac::hostAlreadyPingingOrInWaitingQueue(const QString &ip)
 {
-    return pingingHosts_.find(ip) != pingingHosts_.end() || waitingPingsQueue_.indexOf(ip) != -1;
+    return pingingHosts_.find(ip) != pingingHosts_.end() || socketPingsByIp_.contains(ip) || waitingPingsQueue_.indexOf(ip) != -1;
 }
 
 void PingHost_ICMP_mac::processNextPings()
 {
+    if (socket_ >= 0)
+    {
+        while (socketPings_.count() < MAX_PARALLEL_SOCKET_PINGS && !waitingPingsQueue_.isEmpty())
+        {
+            QString ip = waitingPingsQueue_.dequeue();
+            if (!sendSocketPing(ip))
+            {
+                emit pingFinished(false, 0, ip, isFromDisconnectedState());
+            }
+        }
+        return;
+    }
+
     if (pingingHosts_.count() < MAX_PARALLEL_PINGS && !waitingPingsQueue_.isEmpty())
     {
         QString ip = waitingPingsQueue_.dequeue();
@@ -133,14 +271,7 @@ void PingHost_ICMP_mac::processNextPings()
         pingInfo->process = new QProcess(this);
         connect(pingInfo->process, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onProcessFinished(int,QProcess::ExitStatus)));
 
-        if (connectStateController_)
-        {
-            pingInfo->process->setProperty("fromDisconnectedState", connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED || connectStateController_->currentState() == CONNECT_STATE_CONNECTING);
-        }
-        else
-        {
-            pingInfo->process->setProperty("fromDisconnectedState", true);
-        }
+        pingInfo->process->setProperty("fromDisconnectedState", isFromDisconnectedState());
 
         pingInfo->process->setProperty("ip", ip);
 
@@ -173,4 +304,129 @@ int PingHost_ICMP_mac::extractTimeMs(const QString &str)
     return -1;
 }
 
+bool PingHost_ICMP_mac::openSocket()
+{
+    // the datagram ICMP sockets do not require root (allowed on Mac and on Linux with net.ipv4.ping_group_range)
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+    isRawSocket_ = false;
+    if (socket_ < 0)
+    {
+        socket_ = ::socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+        isRawSocket_ = true;
+    }
+    if (socket_ < 0)
+    {
+        qCDebug(LOG_PING) << "Can't open ICMP socket, the ping utility will be used:" << strerror(errno);
+        return false;
+    }
+
+    int on = 1;
+    if (setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0)
+    {
+        qCDebug(LOG_PING) << "Can't enable SO_TIMESTAMP for ICMP socket:" << strerror(errno);
+    }
+    // many replies can arrive at once during the locations sweep
+    int receiveBufferSize = 256 * 1024;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+    int flags = fcntl(socket_, F_GETFL, 0);
+    if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        qCDebug(LOG_PING) << "Can't set ICMP socket to non-blocking mode:" << strerror(errno);
+        closeSocket();
+        return false;
+    }
+
+    socketNotifier_ = new QSocketNotifier(socket_, QSocketNotifier::Read, this);
+    connect(socketNotifier_, SIGNAL(activated(int)), SLOT(onSocketReadyRead()));
+    return true;
+}
+
+void PingHost_ICMP_mac::closeSocket()
+{
+    if (socketNotifier_)
+    {
+        delete socketNotifier_;
+        socketNotifier_ = nullptr;
+    }
+    if (socket_ >= 0)
+    {
+        ::close(socket_);
+        socket_ = -1;
+    }
+}
+
+bool PingHost_ICMP_mac::sendSocketPing(const QString &ip)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, ip.toLatin1().constData(), &addr.sin_addr) != 1)
+    {
+        qCDebug(LOG_PING) << "Incorrect IP for ICMP ping:" << ip;
+        return false;
+    }
+
+    unsigned short sequenceNumber = nextSequenceNumber_++;
+    while (socketPings_.contains(sequenceNumber))
+    {
+        sequenceNumber = nextSequenceNumber_++;
+    }
+
+    const std::string body("windscribe ping");
+    icmp_header echoRequest;
+    echoRequest.type(icmp_header::echo_request);
+    echoRequest.code(0);
+    echoRequest.identifier(identifier_);
+    echoRequest.sequence_number(sequenceNumber);
+    compute_checksum(echoRequest, body.begin(), body.end());
+
+    std::ostringstream os;
+    os << echoRequest << body;
+    const std::string packet = os.str();
 
+    SocketPingInfo spi;
+    spi.ip = ip;
+    spi.sequenceNumber = sequenceNumber;
+    spi.isFromDisconnectedState = isFromDisconnectedState();
+    spi.sendTimeMs = QDateTime::currentMSecsSinceEpoch();
+    gettimeofday(&spi.sendTime, NULL);
+
+    if (sendto(socket_, packet.data(), packet.size(), 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0)
+    {
+        qCDebug(LOG_PING) << "Can't send ICMP echo request to" << ip << ":" << strerror(errno);
+        return false;
+    }
+
+    socketPings_[sequenceNumber] = spi;
+    socketPingsByIp_[ip] = sequenceNumber;
+    if (!socketTimeoutTimer_.isActive())
+    {
+        socketTimeoutTimer_.start();
+    }
+    return true;
+}
+
+void PingHost_ICMP_mac::finishSocketPing(unsigned short sequenceNumber, bool bSuccess, int timeMs)
+{
+    auto it = socketPings_.find(sequenceNumber);
+    if (it == socketPings_.end())
+    {
+        return;
+    }
+
+    const SocketPingInfo spi = it.value();
+    socketPings_.erase(it);
+    socketPingsByIp_.remove(spi.ip);
+    emit pingFinished(bSuccess, bSuccess ? timeMs : 0, spi.ip, spi.isFromDisconnectedState);
+}
+
+bool PingHost_ICMP_mac::isFromDisconnectedState() const
+{
+    if (connectStateController_)
+    {
+        const CONNECT_STATE state = connectStateController_->currentState();
+        return state == CONNECT_STATE_DISCONNECTED || state == CONNECT_STATE_CONNECTING;
+    }
+    return true;
+}
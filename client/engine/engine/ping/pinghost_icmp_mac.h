@@ -8,7 +8,14 @@
 #include <QMap>
 #include <QProcess>
 #include <QMutex>
+#include <QHash>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <sys/time.h>
 
+// Pings are sent from a single ICMP socket (SOCK_DGRAM if allowed for the user, otherwise SOCK_RAW),
+// the replies are matched by the sequence number and timed with the kernel receive timestamps (SO_TIMESTAMP).
+// If no ICMP socket can be opened, falls back to the ping utility process per host.
 // todo proxy support for icmp ping
 class PingHost_ICMP_mac : public QObject
 {
@@ -29,6 +36,8 @@ signals:
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onSocketReadyRead();
+    void onSocketTimeoutTimer();
 
 private:
 
@@ -38,6 +47,16 @@ private:
         QProcess *process;
     };
 
+    // ping sent from the ICMP socket
+    struct SocketPingInfo
+    {
+        QString ip;
+        unsigned short sequenceNumber;
+        timeval sendTime;
+        qint64 sendTimeMs;
+        bool isFromDisconnectedState;
+    };
+
     QMutex mutex_;
     IConnectStateController *connectStateController_;
 
@@ -45,9 +64,28 @@ private:
     QMap<QString, PingInfo *> pingingHosts_;
     QQueue<QString> waitingPingsQueue_;
 
+    static constexpr int MAX_PARALLEL_SOCKET_PINGS = 256;
+    static constexpr int PING_TIMEOUT = 2000;
+    static constexpr int SOCKET_TIMEOUT_TIMER_INTERVAL = 100;
+
+    int socket_;
+    bool isRawSocket_;      // replies on a raw socket contain the IP header and echoes of the other processes
+    unsigned short identifier_;
+    unsigned short nextSequenceNumber_;
+    QSocketNotifier *socketNotifier_;
+    QTimer socketTimeoutTimer_;
+    QHash<unsigned short, SocketPingInfo> socketPings_;    // sequence number -> ping
+    QHash<QString, unsigned short> socketPingsByIp_;
+
     bool hostAlreadyPingingOrInWaitingQueue(const QString &ip);
     void processNextPings();
     int extractTimeMs(const QString &str);
+
+    bool openSocket();
+    void closeSocket();
+    bool sendSocketPing(const QString &ip);
+    void finishSocketPing(unsigned short sequenceNumber, bool bSuccess, int timeMs);
+    bool isFromDisconnectedState() const;
 };
 
 #endif // PINGHOST_ICMP_MAC_H
@@ -10,7 +10,7 @@
 #include "Utils/logger.h"
 
 PingHost_ICMP_win::PingHost_ICMP_win(QObject *parent, IConnectStateController *stateController) : QObject(parent),
-    mutex_(QMutex::Recursive), connectStateController_(stateController)
+    mutex_(QMutex::Recursive), connectStateController_(stateController), nextIcmpHandle_(0), nextPingId_(1)
 {
 
 }
@@ -32,14 +32,40 @@ void PingHost_ICMP_win::addHostForPing(const QString &ip)
 
 void PingHost_ICMP_win::clearPings()
 {
-    QMutexLocker locker(&mutex_);
-    for (QMap<QString, PingInfo *>::iterator it = pingingHosts_.begin(); it != pingingHosts_.end(); ++it)
+    QList<PingInfo *> pings;
     {
-        IcmpCloseHandle(it.value()->hIcmpFile);
-        delete it.value();
+        QMutexLocker locker(&mutex_);
+
+        // closing the handles cancels all the outstanding requests, but the driver may still write a reply buffer
+        // until the request completes and signals its event
+        for (HANDLE hIcmpFile : qAsConst(icmpHandles_))
+        {
+            IcmpCloseHandle(hIcmpFile);
+        }
+        icmpHandles_.clear();
+        nextIcmpHandle_ = 0;
+
+        pings = pingsById_.values();
+        pingingHosts_.clear();
+        pingsById_.clear();
+        waitingPingsQueue_.clear();
+    }
+
+    // the cancelled requests complete together, they are waited outside the lock with one deadline
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    for (PingInfo *pingInfo : qAsConst(pings))
+    {
+        const DWORD timeout = static_cast<DWORD>(qMax<qint64>(0, PING_TIMEOUT - waitTimer.elapsed()));
+        if (pingInfo->hEvent && WaitForSingleObject(pingInfo->hEvent, timeout) != WAIT_OBJECT_0)
+        {
+            // not completed, the buffer is leaked rather than freed under the driver
+            qCDebug(LOG_PING) << "The echo request is not completed, its buffer is not released:" << pingInfo->ip;
+            UnregisterWaitEx(pingInfo->hWait, INVALID_HANDLE_VALUE);
+            continue;
+        }
+        releasePing(pingInfo, true);
     }
-    pingingHosts_.clear();
-    waitingPingsQueue_.clear();
 }
 
 void PingHost_ICMP_win::setProxySettings(const ProxySettings & /*proxySettings*/)
@@ -57,97 +83,170 @@ void PingHost_ICMP_win::enableProxy()
     //todo
 }
 
-bool PingHost_ICMP_win::hostAlreadyPingingOrInWaitingQueue(const QString &ip)
+void PingHost_ICMP_win::onEchoFinished(quint64 id)
 {
-    return pingingHosts_.find(ip) != pingingHosts_.end() || waitingPingsQueue_.indexOf(ip) != -1;
-}
+    QMutexLocker locker(&mutex_);
+    auto it = pingsById_.find(id);
+    // the ping could be cancelled by clearPings()
+    if (it == pingsById_.end())
+    {
+        return;
+    }
+
+    PingInfo *pingInfo = it.value();
+    pingsById_.erase(it);
+    pingingHosts_.remove(pingInfo->ip);
 
-VOID NTAPI PingHost_ICMP_win::icmpCallback(IN PVOID ApcContext, IN PIO_STATUS_BLOCK IoStatusBlock, IN ULONG /*Reserved*/)
-{
-    USER_ARG *userArg = static_cast<USER_ARG *>(ApcContext);
-    QMutexLocker locker(&(userArg->this_->mutex_));
     int timeMs = -1;
-    if (IoStatusBlock->Status == 0) // success
+    if (IcmpParseReplies(pingInfo->replyBuffer.data(), pingInfo->replyBuffer.size()) > 0)
     {
-        if (IcmpParseReplies(userArg->pingInfo->replyBuffer, userArg->pingInfo->replySize) > 0)
+        const ICMP_ECHO_REPLY *reply = reinterpret_cast<const ICMP_ECHO_REPLY *>(pingInfo->replyBuffer.constData());
+        if (reply->Status == IP_SUCCESS)
         {
-            timeMs = userArg->pingInfo->elapsedTimer.elapsed();
+            timeMs = static_cast<int>(pingInfo->elapsedNs / 1000000);
         }
     }
 
-    QString ip = userArg->pingInfo->ip;
-    auto it = userArg->this_->pingingHosts_.find(ip);
-    if (it != userArg->this_->pingingHosts_.end())
+    const QString ip = pingInfo->ip;
+    const bool bFromDisconnectedState = pingInfo->isFromDisconnectedState_;
+    releasePing(pingInfo, false);
+
+    if (timeMs != -1)
     {
-        PingInfo *pingInfo = it.value();
-        bool bFromDisconnectedState = userArg->pingInfo->isFromDisconnectedState_;
-        userArg->this_->pingingHosts_.remove(ip);
-        IcmpCloseHandle(pingInfo->hIcmpFile);
-        delete pingInfo;
-        if (timeMs != -1)
-        {
-            Q_EMIT userArg->this_->pingFinished(true, timeMs, ip, bFromDisconnectedState);
-        }
-        else
-        {
-            Q_EMIT userArg->this_->pingFinished(false, 0, ip, bFromDisconnectedState);
-        }
+        Q_EMIT pingFinished(true, timeMs, ip, bFromDisconnectedState);
+    }
+    else
+    {
+        Q_EMIT pingFinished(false, 0, ip, bFromDisconnectedState);
     }
-    userArg->this_->waitingPingsQueue_.removeAll(ip);
-    userArg->this_->processNextPings();
 
-    delete userArg;
+    processNextPings();
+}
+
+bool PingHost_ICMP_win::hostAlreadyPingingOrInWaitingQueue(const QString &ip)
+{
+    return pingingHosts_.find(ip) != pingingHosts_.end() || waitingPingsQueue_.indexOf(ip) != -1;
+}
+
+VOID CALLBACK PingHost_ICMP_win::waitCallback(PVOID context, BOOLEAN /*timerOrWaitFired*/)
+{
+    // called in a thread of the system thread pool, the ping info is not released until the object's thread gets the result
+    PingInfo *pingInfo = static_cast<PingInfo *>(context);
+    pingInfo->elapsedNs = pingInfo->elapsedTimer.nsecsElapsed();
+    QMetaObject::invokeMethod(pingInfo->this_, "onEchoFinished", Qt::QueuedConnection, Q_ARG(quint64, pingInfo->id));
 }
 
 void PingHost_ICMP_win::processNextPings()
 {
-    if (pingingHosts_.count() < MAX_PARALLEL_PINGS && !waitingPingsQueue_.isEmpty())
+    while (pingingHosts_.count() < MAX_PARALLEL_PINGS && !waitingPingsQueue_.isEmpty())
     {
         QString ip = waitingPingsQueue_.dequeue();
         Q_ASSERT(IpValidation::instance().isIp(ip));
 
-        const char dataForSend[] = "HelloBufferBuffer";
-
-        PingInfo *pingInfo = new PingInfo();
-        pingInfo->ip = ip;
-
+        bool isFromDisconnectedState = true;
         if (connectStateController_)
         {
-            pingInfo->isFromDisconnectedState_ = (connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED || connectStateController_->currentState() == CONNECT_STATE_CONNECTING);
+            const CONNECT_STATE state = connectStateController_->currentState();
+            isFromDisconnectedState = (state == CONNECT_STATE_DISCONNECTED || state == CONNECT_STATE_CONNECTING);
         }
-        else
+
+        if (!startPing(ip, isFromDisconnectedState))
         {
-            pingInfo->isFromDisconnectedState_ = true;
+            Q_EMIT pingFinished(false, 0, ip, isFromDisconnectedState);
         }
+    }
+}
 
-        pingInfo->hIcmpFile = IcmpCreateFile();
-        if (pingInfo->hIcmpFile == INVALID_HANDLE_VALUE)
-        {
-            qCDebug(LOG_PING) << "IcmpCreateFile failed:" << GetLastError();
+bool PingHost_ICMP_win::startPing(const QString &ip, bool isFromDisconnectedState)
+{
+    static const char dataForSend[] = "HelloBufferBuffer";
 
-            Q_EMIT pingFinished(false, 0, ip, pingInfo->isFromDisconnectedState_);
-            delete pingInfo;
-            waitingPingsQueue_.removeAll(ip);
-            processNextPings();
-            return;
-        }
+    HANDLE hIcmpFile = getIcmpHandle();
+    if (hIcmpFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    PingInfo *pingInfo = new PingInfo();
+    pingInfo->id = nextPingId_++;
+    pingInfo->this_ = this;
+    pingInfo->ip = ip;
+    pingInfo->isFromDisconnectedState_ = isFromDisconnectedState;
+    // an ICMP error message (8 bytes) and the IO_STATUS_BLOCK of the request are written to the buffer too
+    pingInfo->replyBuffer.resize(sizeof(ICMP_ECHO_REPLY) + sizeof(dataForSend) + 8 + sizeof(IO_STATUS_BLOCK));
+
+    // manual reset, it stays signaled after the completion for the wait in clearPings()
+    pingInfo->hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (pingInfo->hEvent == NULL)
+    {
+        qCDebug(LOG_PING) << "CreateEvent failed:" << GetLastError();
+        delete pingInfo;
+        return false;
+    }
 
-        pingInfo->replySize = sizeof(ICMP_ECHO_REPLY) + sizeof(dataForSend) + 8;
-        pingInfo->replyBuffer = new unsigned char[pingInfo->replySize];
+    if (!RegisterWaitForSingleObject(&pingInfo->hWait, pingInfo->hEvent, waitCallback, pingInfo, INFINITE, WT_EXECUTEONLYONCE))
+    {
+        qCDebug(LOG_PING) << "RegisterWaitForSingleObject failed:" << GetLastError();
+        pingInfo->hWait = NULL;
+        releasePing(pingInfo, false);
+        return false;
+    }
 
-        unsigned long ipaddr = inet_addr(ip.toStdString().c_str());
+    IPAddr ipaddr = inet_addr(ip.toStdString().c_str());
 
-        pingingHosts_[ip] = pingInfo;
+    pingingHosts_[ip] = pingInfo;
+    pingsById_[pingInfo->id] = pingInfo;
 
-        USER_ARG *userArg = new USER_ARG();
-        userArg->this_ = this;
-        userArg->pingInfo = pingInfo;
+    pingInfo->elapsedTimer.start();
+    DWORD ret = IcmpSendEcho2(hIcmpFile, pingInfo->hEvent, NULL, NULL,
+                              ipaddr, (LPVOID)dataForSend, sizeof(dataForSend), NULL,
+                              pingInfo->replyBuffer.data(), pingInfo->replyBuffer.size(), PING_TIMEOUT);
+    if (ret == 0 && GetLastError() != ERROR_IO_PENDING)
+    {
+        qCDebug(LOG_PING) << "IcmpSendEcho2 failed:" << GetLastError();
+        pingingHosts_.remove(ip);
+        pingsById_.remove(pingInfo->id);
+        releasePing(pingInfo, true);
+        return false;
+    }
+    return true;
+}
 
-        pingInfo->elapsedTimer.start();
-        IcmpSendEcho2(pingInfo->hIcmpFile, NULL, icmpCallback, userArg,
-                                 ipaddr, (LPVOID)dataForSend, sizeof(dataForSend), NULL,
-                                 pingInfo->replyBuffer, pingInfo->replySize, 2000);
+void PingHost_ICMP_win::releasePing(PingInfo *pingInfo, bool bWaitForCallback)
+{
+    if (pingInfo->hWait)
+    {
+        // INVALID_HANDLE_VALUE waits for the callback to complete, if it is running
+        UnregisterWaitEx(pingInfo->hWait, bWaitForCallback ? INVALID_HANDLE_VALUE : NULL);
+    }
+    if (pingInfo->hEvent)
+    {
+        CloseHandle(pingInfo->hEvent);
     }
+    delete pingInfo;
 }
 
+HANDLE PingHost_ICMP_win::getIcmpHandle()
+{
+    // a single ICMP handle can have many outstanding requests, a few handles are enough
+    if (icmpHandles_.isEmpty())
+    {
+        for (int i = 0; i < ICMP_HANDLES_POOL_SIZE; ++i)
+        {
+            HANDLE hIcmpFile = IcmpCreateFile();
+            if (hIcmpFile == INVALID_HANDLE_VALUE)
+            {
+                qCDebug(LOG_PING) << "IcmpCreateFile failed:" << GetLastError();
+                break;
+            }
+            icmpHandles_ << hIcmpFile;
+        }
+        if (icmpHandles_.isEmpty())
+        {
+            return INVALID_HANDLE_VALUE;
+        }
+    }
 
+    nextIcmpHandle_ = (nextIcmpHandle_ + 1) % icmpHandles_.count();
+    return icmpHandles_[nextIcmpHandle_];
+}
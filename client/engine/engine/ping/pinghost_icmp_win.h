@@ -9,8 +9,12 @@
 #include <QMap>
 #include <QMutex>
 #include <QElapsedTimer>
+#include <QVector>
 #include <winternl.h>
 
+// Echo requests are issued with IcmpSendEcho2 on a small pool of ICMP handles, each request signals its own event.
+// The events are waited by the system thread pool (RegisterWaitForSingleObject), which takes the receive time
+// with QueryPerformanceCounter (QElapsedTimer) as soon as the reply is signaled and passes the result to the object's thread.
 // todo proxy support for icmp ping
 class PingHost_ICMP_win : public QObject
 {
@@ -29,48 +33,46 @@ public:
 signals:
     void pingFinished(bool bSuccess, int timems, const QString &ip, bool isFromDisconnectedState);
 
+private slots:
+    void onEchoFinished(quint64 id);
+
 private:
 
     struct PingInfo
     {
+        quint64 id;
+        PingHost_ICMP_win *this_;
         QString ip;
         bool isFromDisconnectedState_;
         QElapsedTimer elapsedTimer;
-        HANDLE hIcmpFile;
-
-        LPVOID replyBuffer;
-        DWORD replySize;
+        qint64 elapsedNs;       // set by the thread pool callback
+        HANDLE hEvent;
+        HANDLE hWait;
+        QByteArray replyBuffer;
 
-        PingInfo() : isFromDisconnectedState_(false), hIcmpFile(0), replyBuffer(NULL),
-                     replySize(0) {}
-
-        ~PingInfo()
-        {
-            if (replyBuffer)
-            {
-                delete[] replyBuffer;
-            }
-        }
+        PingInfo() : id(0), this_(nullptr), isFromDisconnectedState_(false), elapsedNs(0), hEvent(NULL), hWait(NULL) {}
     };
 
     QMutex mutex_;
     IConnectStateController *connectStateController_;
 
-    static constexpr int MAX_PARALLEL_PINGS = 10;
+    static constexpr int MAX_PARALLEL_PINGS = 256;
+    static constexpr int ICMP_HANDLES_POOL_SIZE = 4;
+    static constexpr int PING_TIMEOUT = 2000;
+
     QMap<QString, PingInfo *> pingingHosts_;
+    QMap<quint64, PingInfo *> pingsById_;
     QQueue<QString> waitingPingsQueue_;
-
-    struct USER_ARG
-    {
-        PingHost_ICMP_win *this_;
-        PingInfo *pingInfo;
-    };
+    QVector<HANDLE> icmpHandles_;
+    int nextIcmpHandle_;
+    quint64 nextPingId_;
 
     bool hostAlreadyPingingOrInWaitingQueue(const QString &ip);
-    static VOID NTAPI icmpCallback(IN PVOID ApcContext, IN PIO_STATUS_BLOCK IoStatusBlock, IN ULONG Reserved);
+    static VOID CALLBACK waitCallback(PVOID context, BOOLEAN timerOrWaitFired);
     void processNextPings();
-
-
+    bool startPing(const QString &ip, bool isFromDisconnectedState);
+    void releasePing(PingInfo *pingInfo, bool bWaitForCallback);
+    HANDLE getIcmpHandle();
 };
 
 #endif // PINGHOST_ICMP_WIN_H
@@ -3,8 +3,10 @@
 #include <QTimer>
 #include "../connectstatecontroller/iconnectstatecontroller.h"
 
-PingHost_TCP::PingHost_TCP(QObject *parent, IConnectStateController *stateController) : QObject(parent), connectStateController_(stateController), bProxyEnabled_(true)
+PingHost_TCP::PingHost_TCP(QObject *parent, IConnectStateController *stateController) : QObject(parent), connectStateController_(stateController), bProxyEnabled_(true),
+    worker_(new TcpPingWorker(this))
 {
+    connect(worker_, SIGNAL(pingFinished(bool,int,QString)), SLOT(onWorkerPingFinished(bool,int,QString)), Qt::QueuedConnection);
 }
 
 PingHost_TCP::~PingHost_TCP()
@@ -14,6 +16,16 @@ PingHost_TCP::~PingHost_TCP()
 
 void PingHost_TCP::addHostForPing(const QString &ip)
 {
+    if (!(bProxyEnabled_ && proxySettings_.option() != PROXY_OPTION_NONE))
+    {
+        if (!workerPings_.contains(ip) && !hostAlreadyPingingOrInWaitingQueue(ip))
+        {
+            workerPings_[ip] = isFromDisconnectedState();
+            worker_->addPing(ip);
+        }
+        return;
+    }
+
     if (!hostAlreadyPingingOrInWaitingQueue(ip))
     {
         waitingPingsQueue_.enqueue(ip);
@@ -31,6 +43,9 @@ void PingHost_TCP::clearPings()
     }
     pingingHosts_.clear();
     waitingPingsQueue_.clear();
+
+    worker_->clearPings();
+    workerPings_.clear();
 }
 
 void PingHost_TCP::setProxySettings(const ProxySettings &proxySettings)
@@ -97,6 +112,18 @@ void PingHost_TCP::onSocketTimeout()
     processError(obj);
 }
 
+void PingHost_TCP::onWorkerPingFinished(bool bSuccess, int timems, const QString &ip)
+{
+    auto it = workerPings_.find(ip);
+    // the ping could be cancelled by clearPings()
+    if (it != workerPings_.end())
+    {
+        bool bFromDisconnectedState = it.value();
+        workerPings_.erase(it);
+        emit pingFinished(bSuccess, timems, ip, bFromDisconnectedState);
+    }
+}
+
 inline bool PingHost_TCP::hostAlreadyPingingOrInWaitingQueue(const QString &ip)
 {
     return pingingHosts_.find(ip) != pingingHosts_.end() || waitingPingsQueue_.indexOf(ip) != -1;
@@ -104,7 +131,7 @@ inline bool PingHost_TCP::hostAlreadyPingingOrInWaitingQueue(const QString &ip)
 
 void PingHost_TCP::processNextPings()
 {
-    if (pingingHosts_.count() < MAX_PARALLEL_PINGS && !waitingPingsQueue_.isEmpty())
+    while (pingingHosts_.count() < MAX_PARALLEL_PINGS && !waitingPingsQueue_.isEmpty())
     {
         QString ip = waitingPingsQueue_.dequeue();
 
@@ -120,14 +147,7 @@ void PingHost_TCP::processNextPings()
         connect(pingInfo->tcpSocket, SIGNAL(connected()), SLOT(onSocketConnected()));
         connect(pingInfo->tcpSocket, SIGNAL(bytesWritten(qint64)), SLOT(onSocketBytesWritten(qint64)));
         connect(pingInfo->tcpSocket, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(onSocketError(QAbstractSocket::SocketError)));
-        if (connectStateController_)
-        {
-            pingInfo->tcpSocket->setProperty("fromDisconnectedState", connectStateController_->currentState() == CONNECT_STATE_DISCONNECTED || connectStateController_->currentState() == CONNECT_STATE_CONNECTING);
-        }
-        else
-        {
-            pingInfo->tcpSocket->setProperty("fromDisconnectedState", true);
-        }
+        pingInfo->tcpSocket->setProperty("fromDisconnectedState", isFromDisconnectedState());
 
         pingInfo->tcpSocket->setProperty("ip", ip);
         pingInfo->timer->setProperty("ip", ip);
@@ -157,3 +177,12 @@ void PingHost_TCP::processError(QObject *obj)
     processNextPings();
 }
 
+bool PingHost_TCP::isFromDisconnectedState() const
+{
+    if (connectStateController_)
+    {
+        const CONNECT_STATE state = connectStateController_->currentState();
+        return state == CONNECT_STATE_DISCONNECTED || state == CONNECT_STATE_CONNECTING;
+    }
+    return true;
+}
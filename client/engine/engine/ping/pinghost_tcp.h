@@ -6,11 +6,15 @@
 #include <QTcpSocket>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QQueue>
 #include "engine/proxy/proxysettings.h"
+#include "tcppingworker.h"
 
 class IConnectStateController;
 
+// Without proxy the pings are made by TcpPingWorker, with proxy by QTcpSocket per host.
+
 class PingHost_TCP : public QObject
 {
     Q_OBJECT
@@ -34,6 +38,7 @@ private slots:
     void onSocketBytesWritten(qint64 bytes);
     void onSocketError(QAbstractSocket::SocketError socketError);
     void onSocketTimeout();
+    void onWorkerPingFinished(bool bSuccess, int timems, const QString &ip);
 
 private:
     struct PingInfo
@@ -45,7 +50,7 @@ private:
     };
 
     enum {PING_TIMEOUT = 2000};
-    static constexpr int MAX_PARALLEL_PINGS = 10;
+    static constexpr int MAX_PARALLEL_PINGS = 32;
 
     IConnectStateController *connectStateController_;
     ProxySettings proxySettings_;
@@ -54,7 +59,11 @@ private:
     QMap<QString, PingInfo *> pingingHosts_;
     QQueue<QString> waitingPingsQueue_;
 
+    TcpPingWorker *worker_;
+    QHash<QString, bool> workerPings_;     // ip -> isFromDisconnectedState
+
     bool hostAlreadyPingingOrInWaitingQueue(const QString &ip);
+    bool isFromDisconnectedState() const;
     void processNextPings();
     void processError(QObject *obj);
 };
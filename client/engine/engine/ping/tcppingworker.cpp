@@ -0,0 +1,248 @@
+#include "tcppingworker.h"
+#include "utils/crashhandler.h"
+#include "utils/logger.h"
+
+#ifdef Q_OS_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_WIN
+    typedef WSAPOLLFD PollFd;
+    typedef int SockLen;
+    const qintptr INVALID_SOCKET_HANDLE = static_cast<qintptr>(INVALID_SOCKET);
+
+    int pollSockets(PollFd *fds, int count, int timeout)
+    {
+        return WSAPoll(fds, static_cast<ULONG>(count), timeout);
+    }
+#else
+    typedef pollfd PollFd;
+    typedef socklen_t SockLen;
+    const qintptr INVALID_SOCKET_HANDLE = -1;
+
+    int pollSockets(PollFd *fds, int count, int timeout)
+    {
+        return poll(fds, static_cast<nfds_t>(count), timeout);
+    }
+#endif
+
+} // namespace
+
+TcpPingWorker::TcpPingWorker(QObject *parent) : QThread(parent), bNeedClear_(false), bNeedFinish_(false)
+{
+#ifdef Q_OS_WIN
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    start(HighPriority);
+}
+
+TcpPingWorker::~TcpPingWorker()
+{
+    mutex_.lock();
+    bNeedFinish_ = true;
+    waitCondition_.wakeAll();
+    mutex_.unlock();
+    wait();
+#ifdef Q_OS_WIN
+    WSACleanup();
+#endif
+}
+
+void TcpPingWorker::addPing(const QString &ip)
+{
+    QMutexLocker locker(&mutex_);
+    queue_.enqueue(ip);
+    waitCondition_.wakeAll();
+}
+
+void TcpPingWorker::clearPings()
+{
+    QMutexLocker locker(&mutex_);
+    queue_.clear();
+    bNeedClear_ = true;
+    waitCondition_.wakeAll();
+}
+
+void TcpPingWorker::run()
+{
+    BIND_CRASH_HANDLER_FOR_THREAD();
+    QVector<PollFd> fds;
+
+    while (true)
+    {
+        QStringList newPings;
+        {
+            QMutexLocker locker(&mutex_);
+            if (bNeedClear_)
+            {
+                closeAllPings();
+                bNeedClear_ = false;
+            }
+            if (!bNeedFinish_ && queue_.isEmpty() && pings_.isEmpty())
+            {
+                waitCondition_.wait(&mutex_);
+            }
+            if (bNeedFinish_)
+            {
+                break;
+            }
+            while (!queue_.isEmpty() && (pings_.count() + newPings.count()) < MAX_PARALLEL_PINGS)
+            {
+                newPings << queue_.dequeue();
+            }
+        }
+
+        for (const QString &ip : qAsConst(newPings))
+        {
+            if (!startPing(ip))
+            {
+                emit pingFinished(false, 0, ip);
+            }
+        }
+
+        if (pings_.isEmpty())
+        {
+            continue;
+        }
+
+        fds.resize(pings_.count());
+        for (int i = 0; i < pings_.count(); ++i)
+        {
+            fds[i].fd = pings_[i].socket;
+            fds[i].events = POLLOUT;
+            fds[i].revents = 0;
+        }
+
+        const int ret = pollSockets(fds.data(), fds.count(), POLL_INTERVAL);
+
+        // from the end, because finishPing() removes the ping from the vector
+        for (int i = pings_.count() - 1; i >= 0; --i)
+        {
+            if (ret > 0 && fds[i].revents != 0)
+            {
+                int socketError = 0;
+                SockLen len = sizeof(socketError);
+                if (getsockopt(pings_[i].socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&socketError), &len) != 0)
+                {
+                    socketError = -1;
+                }
+                const bool bSuccess = (fds[i].revents & POLLOUT) && !(fds[i].revents & (POLLERR | POLLHUP)) && socketError == 0;
+                finishPing(i, bSuccess);
+            }
+            else if (pings_[i].elapsedTimer.elapsed() >= PING_TIMEOUT)
+            {
+                finishPing(i, false);
+            }
+        }
+    }
+
+    closeAllPings();
+}
+
+bool TcpPingWorker::startPing(const QString &ip)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PING_PORT);
+    if (inet_pton(AF_INET, ip.toLatin1().constData(), &addr.sin_addr) != 1)
+    {
+        qCDebug(LOG_PING) << "TcpPingWorker: incorrect IP" << ip;
+        return false;
+    }
+
+    const qintptr s = static_cast<qintptr>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (s == INVALID_SOCKET_HANDLE)
+    {
+        qCDebug(LOG_PING) << "TcpPingWorker: can't create socket";
+        return false;
+    }
+
+    // reset the connection on close, so thousands of pings do not leave the sockets in TIME_WAIT
+    linger lingerOpt;
+    lingerOpt.l_onoff = 1;
+    lingerOpt.l_linger = 0;
+    setsockopt(s, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char *>(&lingerOpt), sizeof(lingerOpt));
+
+#ifdef Q_OS_WIN
+    u_long nonBlocking = 1;
+    const bool isNonBlocking = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+    const int flags = fcntl(s, F_GETFL, 0);
+    const bool isNonBlocking = flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    if (!isNonBlocking)
+    {
+        qCDebug(LOG_PING) << "TcpPingWorker: can't set non-blocking mode";
+        closeSocket(s);
+        return false;
+    }
+
+    PingInfo pingInfo;
+    pingInfo.ip = ip;
+    pingInfo.socket = s;
+    pingInfo.elapsedTimer.start();
+
+    if (::connect(s, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == 0)
+    {
+        // connected immediately (possible for the local addresses)
+        pings_ << pingInfo;
+        finishPing(pings_.count() - 1, true);
+        return true;
+    }
+
+#ifdef Q_OS_WIN
+    const bool isInProgress = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    const bool isInProgress = errno == EINPROGRESS;
+#endif
+    if (!isInProgress)
+    {
+        closeSocket(s);
+        return false;
+    }
+
+    pings_ << pingInfo;
+    return true;
+}
+
+void TcpPingWorker::finishPing(int ind, bool bSuccess)
+{
+    const PingInfo &pingInfo = pings_[ind];
+    const int timeMs = static_cast<int>(pingInfo.elapsedTimer.nsecsElapsed() / 1000000);
+    const QString ip = pingInfo.ip;
+    closeSocket(pingInfo.socket);
+    pings_.remove(ind);
+    emit pingFinished(bSuccess, bSuccess ? timeMs : 0, ip);
+}
+
+void TcpPingWorker::closeAllPings()
+{
+    for (const PingInfo &pingInfo : qAsConst(pings_))
+    {
+        closeSocket(pingInfo.socket);
+    }
+    pings_.clear();
+}
+
+void TcpPingWorker::closeSocket(qintptr socket)
+{
+#ifdef Q_OS_WIN
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    close(static_cast<int>(socket));
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef TCPPINGWORKER_H
+#define TCPPINGWORKER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+// Worker thread for TCP pings without proxy. Connects to port 443 of the hosts with non-blocking sockets,
+// all pending connects are waited in a single poll() (WSAPoll() on Windows) call.
+// The ping time is the time of the TCP handshake measured with the monotonic clock.
+class TcpPingWorker : public QThread
+{
+    Q_OBJECT
+public:
+    explicit TcpPingWorker(QObject *parent);
+    virtual ~TcpPingWorker();
+
+    void addPing(const QString &ip);
+    // cancels all pings, no pingFinished signals for them
+    void clearPings();
+
+signals:
+    void pingFinished(bool bSuccess, int timems, const QString &ip);
+
+protected:
+    void run() override;
+
+private:
+    static constexpr int MAX_PARALLEL_PINGS = 256;
+    static constexpr int PING_TIMEOUT = 2000;
+    static constexpr int POLL_INTERVAL = 10;    // ms, the new pings are picked up at least so often
+    static constexpr int PING_PORT = 443;
+
+    struct PingInfo
+    {
+        QString ip;
+        qintptr socket;
+        QElapsedTimer elapsedTimer;
+    };
+
+    QMutex mutex_;
+    QWaitCondition waitCondition_;
+    QQueue<QString> queue_;
+    bool bNeedClear_;
+    bool bNeedFinish_;
+
+    // accessed only from run() thread
+    QVector<PingInfo> pings_;
+
+    bool startPing(const QString &ip);
+    void finishPing(int ind, bool bSuccess);
+    void closeAllPings();
+    static void closeSocket(qintptr socket);
+};
+
+#endif // TCPPINGWORKER_H
@@ -0,0 +1,260 @@
+#include "processtelemetry_win.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <psapi.h>
+#include <tlhelp32.h>
+#include "openvpnversioncontroller.h"
+#include "utils/logger.h"
+
+namespace {
+quint64 fileTimeToUInt64(const FILETIME &ft)
+{
+    return (static_cast<quint64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+}
+
+ProcessTelemetry_win::ProcessTelemetry_win(QObject *parent) : QObject(parent),
+    prevWallTimeMs_(0), numberOfProcessors_(1), samples_(SAMPLES_COUNT), nextSample_(0), samplesCount_(0),
+    samplesSinceRescan_(0), baselineWorkingSet_(0), baselineHandles_(0), baselineSamples_(0), isRegressionReported_(false)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    numberOfProcessors_ = qMax(1, static_cast<int>(si.dwNumberOfProcessors));
+
+    wallTimer_.start();
+    connect(&timer_, SIGNAL(timeout()), SLOT(onTimer()));
+    rescan();
+    timer_.start(SAMPLE_INTERVAL);
+}
+
+ProcessTelemetry_win::~ProcessTelemetry_win()
+{
+    for (int i = 0; i < PROCESSES_COUNT; ++i)
+    {
+        closeProcess(i);
+    }
+}
+
+void ProcessTelemetry_win::rescan()
+{
+    samplesSinceRescan_ = 0;
+
+    // the app itself
+    if (processes_[PROCESS_APP].handle == NULL)
+    {
+        processes_[PROCESS_APP].pid = GetCurrentProcessId();
+        processes_[PROCESS_APP].handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, processes_[PROCESS_APP].pid);
+    }
+
+    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (hSnapshot == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    QString names[PROCESSES_COUNT];
+    for (int i = PROCESS_APP + 1; i < PROCESSES_COUNT; ++i)
+    {
+        names[i] = executableName(i);
+        // the exited processes are found again below
+        if (processes_[i].handle != NULL && WaitForSingleObject(processes_[i].handle, 0) == WAIT_OBJECT_0)
+        {
+            closeProcess(i);
+        }
+    }
+
+    PROCESSENTRY32W entry;
+    entry.dwSize = sizeof(entry);
+    if (Process32FirstW(hSnapshot, &entry))
+    {
+        do
+        {
+            const QString exeName = QString::fromWCharArray(entry.szExeFile);
+            for (int i = PROCESS_APP + 1; i < PROCESSES_COUNT; ++i)
+            {
+                if (processes_[i].handle == NULL && !names[i].isEmpty() && exeName.compare(names[i], Qt::CaseInsensitive) == 0)
+                {
+                    HANDLE handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, entry.th32ProcessID);
+                    if (handle != NULL)
+                    {
+                        processes_[i].handle = handle;
+                        processes_[i].pid = entry.th32ProcessID;
+                        processes_[i].isCpuTimeValid = false;
+                    }
+                    break;
+                }
+            }
+        } while (Process32NextW(hSnapshot, &entry));
+    }
+    CloseHandle(hSnapshot);
+}
+
+void ProcessTelemetry_win::onTimer()
+{
+    bool isNeedRescan = (++samplesSinceRescan_ >= RESCAN_SAMPLES);
+    for (int i = PROCESS_APP + 1; i < PROCESSES_COUNT && !isNeedRescan; ++i)
+    {
+        isNeedRescan = (processes_[i].handle != NULL && WaitForSingleObject(processes_[i].handle, 0) == WAIT_OBJECT_0);
+    }
+    if (isNeedRescan)
+    {
+        rescan();
+    }
+
+    const qint64 wallTimeMs = wallTimer_.elapsed();
+    const qint64 wallDeltaMs = wallTimeMs - prevWallTimeMs_;
+    prevWallTimeMs_ = wallTimeMs;
+
+    SAMPLE &sample = samples_[nextSample_];
+    sample.timestamp = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < PROCESSES_COUNT; ++i)
+    {
+        sample.processes[i] = PROCESS_SAMPLE();
+        sampleProcess(i, wallDeltaMs, sample.processes[i]);
+    }
+    nextSample_ = (nextSample_ + 1) % SAMPLES_COUNT;
+    samplesCount_ = qMin(samplesCount_ + 1, static_cast<int>(SAMPLES_COUNT));
+
+    checkRegression(sample.processes[PROCESS_APP]);
+}
+
+void ProcessTelemetry_win::sampleProcess(int process, qint64 wallDeltaMs, PROCESS_SAMPLE &outSample)
+{
+    PROCESS_INFO &pi = processes_[process];
+    if (pi.handle == NULL)
+    {
+        return;
+    }
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(pi.handle, &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return;
+    }
+    const quint64 cpuTime = fileTimeToUInt64(kernelTime) + fileTimeToUInt64(userTime);
+    if (pi.isCpuTimeValid && wallDeltaMs > 0)
+    {
+        // the cpu time is in 100 ns units, 10000 per ms
+        outSample.cpuPercent = static_cast<float>(100.0 * (cpuTime - pi.prevCpuTime) / (wallDeltaMs * 10000.0 * numberOfProcessors_));
+    }
+    pi.prevCpuTime = cpuTime;
+    pi.isCpuTimeValid = true;
+
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(pi.handle, &pmc, sizeof(pmc)))
+    {
+        outSample.workingSet = pmc.WorkingSetSize;
+    }
+    DWORD handles = 0;
+    if (GetProcessHandleCount(pi.handle, &handles))
+    {
+        outSample.handles = handles;
+    }
+    outSample.isValid = true;
+}
+
+void ProcessTelemetry_win::checkRegression(const PROCESS_SAMPLE &appSample)
+{
+    if (!appSample.isValid)
+    {
+        return;
+    }
+
+    if (baselineSamples_ < BASELINE_SAMPLES)
+    {
+        baselineWorkingSet_ = qMax(baselineWorkingSet_, appSample.workingSet);
+        baselineHandles_ = qMax(baselineHandles_, appSample.handles);
+        baselineSamples_++;
+        return;
+    }
+
+    const bool isWorkingSetRegressed = appSample.workingSet > baselineWorkingSet_ * 2 &&
+                                       appSample.workingSet > baselineWorkingSet_ + WORKING_SET_MARGIN;
+    const bool isHandlesRegressed = appSample.handles > baselineHandles_ * 2 &&
+                                    appSample.handles > baselineHandles_ + HANDLES_MARGIN;
+    if ((isWorkingSetRegressed || isHandlesRegressed) && !isRegressionReported_)
+    {
+        isRegressionReported_ = true;
+        qCWarning(LOG_BASIC) << "ProcessTelemetry: the footprint of the app has grown, working set:"
+                             << appSample.workingSet / 1024 << "KB (baseline" << baselineWorkingSet_ / 1024 << "KB), handles:"
+                             << appSample.handles << "(baseline" << baselineHandles_ << ")" << qPrintable(summary());
+    }
+    else if (!isWorkingSetRegressed && !isHandlesRegressed)
+    {
+        isRegressionReported_ = false;
+    }
+}
+
+QString ProcessTelemetry_win::summary() const
+{
+    QString str = QString("\n  processes telemetry, %1 samples every %2 s:").arg(samplesCount_).arg(SAMPLE_INTERVAL / 1000);
+    const int latest = (nextSample_ + SAMPLES_COUNT - 1) % SAMPLES_COUNT;
+    for (int i = 0; i < PROCESSES_COUNT; ++i)
+    {
+        double cpuSum = 0;
+        float cpuMax = 0;
+        quint64 workingSetMax = 0;
+        quint32 handlesMax = 0;
+        int validCount = 0;
+        for (int s = 0; s < samplesCount_; ++s)
+        {
+            const PROCESS_SAMPLE &ps = samples_[s].processes[i];
+            if (ps.isValid)
+            {
+                cpuSum += ps.cpuPercent;
+                cpuMax = qMax(cpuMax, ps.cpuPercent);
+                workingSetMax = qMax(workingSetMax, ps.workingSet);
+                handlesMax = qMax(handlesMax, ps.handles);
+                validCount++;
+            }
+        }
+        if (validCount == 0)
+        {
+            continue;
+        }
+
+        const PROCESS_SAMPLE &last = samples_[latest].processes[i];
+        str += QString("\n    %1: cpu %2% (avg %3%, max %4%), working set %5 KB (max %6 KB), handles %7 (max %8)")
+                .arg(processName(i))
+                .arg(last.cpuPercent, 0, 'f', 1).arg(cpuSum / validCount, 0, 'f', 1).arg(cpuMax, 0, 'f', 1)
+                .arg(last.workingSet / 1024).arg(workingSetMax / 1024)
+                .arg(last.handles).arg(handlesMax);
+    }
+    return str;
+}
+
+QString ProcessTelemetry_win::processName(int process)
+{
+    switch (process)
+    {
+        case PROCESS_APP: return "app (GUI and engine)";
+        case PROCESS_SERVICE: return "service";
+        case PROCESS_OPENVPN: return "openvpn";
+        case PROCESS_WIREGUARD: return "wireguard";
+        case PROCESS_STUNNEL: return "stunnel";
+        case PROCESS_WSTUNNEL: return "wstunnel";
+        default: return QString();
+    }
+}
+
+QString ProcessTelemetry_win::executableName(int process) const
+{
+    switch (process)
+    {
+        case PROCESS_SERVICE: return "WindscribeService.exe";
+        case PROCESS_OPENVPN: return QFileInfo(OpenVpnVersionController::instance().getSelectedOpenVpnExecutable()).fileName();
+        case PROCESS_WIREGUARD: return "WireguardService.exe";
+        case PROCESS_STUNNEL: return "tstunnel.exe";
+        case PROCESS_WSTUNNEL: return "wstunnel.exe";
+        default: return QString();
+    }
+}
+
+void ProcessTelemetry_win::closeProcess(int process)
+{
+    if (processes_[process].handle != NULL)
+    {
+        CloseHandle(processes_[process].handle);
+    }
+    processes_[process] = PROCESS_INFO();
+}
@@ -0,0 +1,93 @@
+#ifndef PROCESSTELEMETRY_WIN_H
+#define PROCESSTELEMETRY_WIN_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <windows.h>
+
+// Samples the CPU, the working set and the handle count of the processes of the app (the app itself with the GUI and
+// the engine, the service, OpenVPN, WireGuard, stunnel and wstunnel) into a fixed-size ring buffer.
+// The handles of the processes are kept open between the samples, the process list is walked only when one of them
+// exits, on rescan() and every few minutes. The processes of the service (LocalSystem) may be inaccessible
+// to the non-elevated app, they are skipped then.
+// Logs a warning when the footprint of the app itself grows well over the baseline (its first samples).
+// Windows only: it's owned by MeasurementCpuUsage, which exists only there (PDH), and the engine has no process
+// sampling on Mac/Linux to extend. A port would read /proc/<pid>/stat on Linux and proc_pid_rusage() on Mac, where
+// the helper and the tunnel processes run as root and can't be read by the app.
+class ProcessTelemetry_win : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessTelemetry_win(QObject *parent);
+    ~ProcessTelemetry_win() override;
+
+    void rescan();
+    QString summary() const;
+
+private slots:
+    void onTimer();
+
+private:
+    static constexpr int SAMPLE_INTERVAL = 30000;
+    static constexpr int SAMPLES_COUNT = 120;       // one hour
+    static constexpr int RESCAN_SAMPLES = 10;
+    static constexpr int BASELINE_SAMPLES = 4;
+    // the footprint of the app is regressed if it's both over twice the baseline and over the baseline + the margin
+    static constexpr quint64 WORKING_SET_MARGIN = 100 * 1024 * 1024;
+    static constexpr quint32 HANDLES_MARGIN = 1000;
+
+    enum PROCESS { PROCESS_APP, PROCESS_SERVICE, PROCESS_OPENVPN, PROCESS_WIREGUARD, PROCESS_STUNNEL, PROCESS_WSTUNNEL, PROCESSES_COUNT };
+
+    struct PROCESS_INFO
+    {
+        HANDLE handle;
+        DWORD pid;
+        quint64 prevCpuTime;     // in 100 ns
+        bool isCpuTimeValid;
+
+        PROCESS_INFO() : handle(NULL), pid(0), prevCpuTime(0), isCpuTimeValid(false) {}
+    };
+
+    struct PROCESS_SAMPLE
+    {
+        bool isValid;
+        float cpuPercent;
+        quint64 workingSet;
+        quint32 handles;
+
+        PROCESS_SAMPLE() : isValid(false), cpuPercent(0), workingSet(0), handles(0) {}
+    };
+
+    struct SAMPLE
+    {
+        qint64 timestamp;
+        PROCESS_SAMPLE processes[PROCESSES_COUNT];
+    };
+
+    QTimer timer_;
+    QElapsedTimer wallTimer_;
+    qint64 prevWallTimeMs_;
+    int numberOfProcessors_;
+    PROCESS_INFO processes_[PROCESSES_COUNT];
+
+    QVector<SAMPLE> samples_;       // the ring buffer
+    int nextSample_;
+    int samplesCount_;
+    int samplesSinceRescan_;
+
+    quint64 baselineWorkingSet_;
+    quint32 baselineHandles_;
+    int baselineSamples_;
+    bool isRegressionReported_;
+
+    static QString processName(int process);
+    QString executableName(int process) const;
+    void closeProcess(int process);
+    void sampleProcess(int process, qint64 wallDeltaMs, PROCESS_SAMPLE &outSample);
+    void checkRegression(const PROCESS_SAMPLE &appSample);
+};
+
+#endif // PROCESSTELEMETRY_WIN_H
@@ -4,35 +4,47 @@
 #elif defined Q_OS_MAC
     #include "autodetectproxy_mac.h"
 #endif
+#include <QDataStream>
 #include <QHostInfo>
+#include <QRunnable>
+#include <QThreadPool>
+#include <functional>
+#include "utils/crashhandler.h"
+#include "utils/logger.h"
+#include "utils/settingsstore.h"
+
+namespace {
+
+const char *AUTO_DETECT_CACHE_KEY = "proxyAutoDetectCache";
+const quint32 AUTO_DETECT_CACHE_VERSION = 1;
+
+// runs the system proxy detection on a pool thread
+class DetectTask : public QRunnable
+{
+public:
+    explicit DetectTask(std::function<void()> func) : func_(func) {}
+    void run() override
+    {
+        BIND_CRASH_HANDLER_FOR_THREAD();
+        func_();
+    }
+
+private:
+    std::function<void()> func_;
+};
+
+} // namespace
 
 bool ProxyServerController::updateProxySettings(const ProxySettings &proxySettings)
 {
     ProxySettings newProxySettings;
 
-    if (proxySettings.option() == PROXY_OPTION_AUTODETECT)
+    isAutoDetect_ = (proxySettings.option() == PROXY_OPTION_AUTODETECT);
+    if (isAutoDetect_)
     {
-        bool bSuccess = false;
-#ifdef Q_OS_WIN
-        ProxySettings autoProxySettings = AutoDetectProxy_win::detect(bSuccess);
-#elif defined Q_OS_MAC
-        ProxySettings autoProxySettings = AutoDetectProxy_mac::detect(bSuccess);
-#elif defined Q_OS_LINUX
-        //todo linux
-        ProxySettings autoProxySettings;
-#endif
-        if (!bSuccess)
-        {
-            newProxySettings.setOption(PROXY_OPTION_NONE);
-            newProxySettings.setAddress("");
-            newProxySettings.setPassword("");
-            newProxySettings.setPort(0);
-            newProxySettings.setUsername("");
-        }
-        else
-        {
-            newProxySettings = autoProxySettings;
-        }
+        // the last known answer now, the detection refreshes it in the background
+        startDetection();
+        return applyAutoDetectedSettings();
     }
     else if (proxySettings.option() == PROXY_OPTION_HTTP || proxySettings.option() == PROXY_OPTION_SOCKS)
     {
@@ -44,11 +56,7 @@ bool ProxyServerController::updateProxySettings(const ProxySettings &proxySettin
         }
         else
         {
-            newProxySettings.setOption(PROXY_OPTION_NONE);
-            newProxySettings.setAddress("");
-            newProxySettings.setPassword("");
-            newProxySettings.setPort(0);
-            newProxySettings.setUsername("");
+            newProxySettings = noneProxySettings();
         }
     }
     else
@@ -68,7 +76,170 @@ const ProxySettings &ProxyServerController::getCurrentProxySettings()
     return proxySettings_;
 }
 
-ProxyServerController::ProxyServerController() : bInitialized_(false)
+bool ProxyServerController::setNetwork(const QString &networkKey)
 {
+    if (networkKey == networkKey_)
+    {
+        return false;
+    }
+    networkKey_ = networkKey;
 
+    if (!isAutoDetect_)
+    {
+        return false;
+    }
+    startDetection();
+    return applyAutoDetectedSettings();
+}
+
+ProxyServerController::ProxyServerController() : bInitialized_(false), isAutoDetect_(false),
+    isDetectionRunning_(false), isDetectionPending_(false)
+{
+    loadAutoDetectCache();
+}
+
+bool ProxyServerController::applyAutoDetectedSettings()
+{
+    const ProxySettings newProxySettings = autoDetectCache_.value(networkKey_, noneProxySettings());
+    const bool isModified = !bInitialized_ || newProxySettings != proxySettings_;
+    proxySettings_ = newProxySettings;
+    bInitialized_ = true;
+    return isModified;
+}
+
+void ProxyServerController::startDetection()
+{
+    if (isDetectionRunning_)
+    {
+        isDetectionPending_ = true;
+        return;
+    }
+    isDetectionRunning_ = true;
+    isDetectionPending_ = false;
+
+    const QString networkKey = networkKey_;
+    QThreadPool::globalInstance()->start(new DetectTask([this, networkKey]() {
+        bool bSuccess = false;
+#ifdef Q_OS_WIN
+        const ProxySettings autoProxySettings = AutoDetectProxy_win::detect(bSuccess);
+#elif defined Q_OS_MAC
+        const ProxySettings autoProxySettings = AutoDetectProxy_mac::detect(bSuccess);
+#elif defined Q_OS_LINUX
+        //todo linux
+        const ProxySettings autoProxySettings;
+#endif
+        QMetaObject::invokeMethod(this, [this, networkKey, bSuccess, autoProxySettings]() {
+            onDetectionFinished(networkKey, bSuccess, autoProxySettings);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ProxyServerController::onDetectionFinished(const QString &networkKey, bool bSuccess, const ProxySettings &proxySettings)
+{
+    isDetectionRunning_ = false;
+
+    // a failed detection keeps the last known answer of the network
+    if (bSuccess)
+    {
+        putToAutoDetectCache(networkKey, proxySettings);
+    }
+    else if (!autoDetectCache_.contains(networkKey))
+    {
+        putToAutoDetectCache(networkKey, noneProxySettings());
+    }
+
+    if (isDetectionPending_ && isAutoDetect_)
+    {
+        startDetection();
+    }
+    else
+    {
+        isDetectionPending_ = false;
+    }
+
+    if (isAutoDetect_ && networkKey == networkKey_ && applyAutoDetectedSettings())
+    {
+        qCDebug(LOG_BASIC) << "Autodetected proxy settings changed";
+        Q_EMIT proxySettingsChanged();
+    }
+}
+
+ProxySettings ProxyServerController::noneProxySettings()
+{
+    ProxySettings proxySettings;
+    proxySettings.setOption(PROXY_OPTION_NONE);
+    proxySettings.setAddress("");
+    proxySettings.setPassword("");
+    proxySettings.setPort(0);
+    proxySettings.setUsername("");
+    return proxySettings;
+}
+
+void ProxyServerController::putToAutoDetectCache(const QString &networkKey, const ProxySettings &proxySettings)
+{
+    autoDetectCacheOrder_.removeOne(networkKey);
+    autoDetectCacheOrder_ << networkKey;
+    autoDetectCache_[networkKey] = proxySettings;
+    while (autoDetectCacheOrder_.count() > MAX_CACHED_NETWORKS)
+    {
+        autoDetectCache_.remove(autoDetectCacheOrder_.takeFirst());
+    }
+    saveAutoDetectCache();
+}
+
+void ProxyServerController::loadAutoDetectCache()
+{
+    QByteArray arr = SettingsStore::instance().value(AUTO_DETECT_CACHE_KEY).toByteArray();
+    if (arr.isEmpty())
+    {
+        return;
+    }
+
+    QDataStream stream(&arr, QIODevice::ReadOnly);
+    quint32 version;
+    quint32 count;
+    stream >> version >> count;
+    if (stream.status() != QDataStream::Ok || version != AUTO_DETECT_CACHE_VERSION)
+    {
+        return;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString networkKey, address, username, password;
+        qint32 option;
+        quint32 port;
+        stream >> networkKey >> option >> address >> port >> username >> password;
+
+        ProxySettings proxySettings;
+        proxySettings.setOption(static_cast<PROXY_OPTION>(option));
+        proxySettings.setAddress(address);
+        proxySettings.setPort(port);
+        proxySettings.setUsername(username);
+        proxySettings.setPassword(password);
+        autoDetectCache_[networkKey] = proxySettings;
+        autoDetectCacheOrder_ << networkKey;
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        autoDetectCache_.clear();
+        autoDetectCacheOrder_.clear();
+    }
+}
+
+void ProxyServerController::saveAutoDetectCache() const
+{
+    QByteArray arr;
+    {
+        QDataStream stream(&arr, QIODevice::WriteOnly);
+        stream << AUTO_DETECT_CACHE_VERSION << static_cast<quint32>(autoDetectCacheOrder_.count());
+        for (const QString &networkKey : autoDetectCacheOrder_)
+        {
+            const ProxySettings proxySettings = autoDetectCache_.value(networkKey);
+            stream << networkKey << static_cast<qint32>(proxySettings.option()) << proxySettings.address()
+                   << static_cast<quint32>(proxySettings.getPort()) << proxySettings.getUsername()
+                   << proxySettings.getPassword();
+        }
+    }
+    // the writes are coalesced by SettingsStore
+    SettingsStore::instance().setValue(AUTO_DETECT_CACHE_KEY, arr);
 }
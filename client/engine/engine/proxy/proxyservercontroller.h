@@ -1,11 +1,19 @@
 #ifndef PROXYSERVERCONTROLLER_H
 #define PROXYSERVERCONTROLLER_H
 
+#include <QHash>
+#include <QObject>
+#include <QStringList>
 #include "proxysettings.h"
 
 // contains current proxy settings, autodetect proxy settings if need
-class ProxyServerController
+// The system detection (WPAD and the PAC script on Windows) can block for seconds, so it runs on a pool thread:
+// updateProxySettings() and setNetwork() answer at once with the last detected settings of the network (none if
+// the network wasn't seen yet) and start a refresh, proxySettingsChanged is emitted if the refresh changes them.
+// The cache is kept in the settings, so the first answer after the app start is the known one too.
+class ProxyServerController : public QObject
 {
+    Q_OBJECT
 public:
     static ProxyServerController &instance()
     {
@@ -16,11 +24,35 @@ public:
     bool updateProxySettings(const ProxySettings &proxySettings);
     const ProxySettings &getCurrentProxySettings();
 
+    // the key of the current network for the cache of the detected settings
+    bool setNetwork(const QString &networkKey);
+
+signals:
+    void proxySettingsChanged();
+
 private:
     ProxyServerController();
 
     ProxySettings proxySettings_;
     bool bInitialized_;
+
+    bool isAutoDetect_;
+    QString networkKey_;
+    static constexpr int MAX_CACHED_NETWORKS = 50;
+
+    QHash<QString, ProxySettings> autoDetectCache_;    // the last detected settings per network
+    QStringList autoDetectCacheOrder_;                  // the networks of the cache, the last detected one last
+    bool isDetectionRunning_;
+    bool isDetectionPending_;       // the network changed while the detection was running
+
+    bool applyAutoDetectedSettings();
+    void startDetection();
+    void onDetectionFinished(const QString &networkKey, bool bSuccess, const ProxySettings &proxySettings);
+    static ProxySettings noneProxySettings();
+
+    void putToAutoDetectCache(const QString &networkKey, const ProxySettings &proxySettings);
+    void loadAutoDetectCache();
+    void saveAutoDetectCache() const;
 };
 
 #endif // PROXYSERVERCONTROLLER_H
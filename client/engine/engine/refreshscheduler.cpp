@@ -0,0 +1,155 @@
+#include "refreshscheduler.h"
+#include <QRandomGenerator>
+
+RefreshScheduler::RefreshScheduler(QObject *parent, IConnectStateController *connectStateController) : QObject(parent),
+    isConnected_(false)
+{
+    connect(connectStateController, &IConnectStateController::stateChanged, this, &RefreshScheduler::onConnectStateChanged);
+    connect(&timer_, &QTimer::timeout, this, &RefreshScheduler::onTimer);
+    timer_.setSingleShot(true);
+    elapsedTimer_.start();
+}
+
+void RefreshScheduler::applicationActivated()
+{
+    if (jobs_[JOB_SESSION_STATUS].isActive)
+    {
+        const qint64 nowMs = elapsedTimer_.elapsed();
+        jobs_[JOB_SESSION_STATUS].dueMs = nowMs;
+        runBatch(nowMs);
+    }
+}
+
+void RefreshScheduler::start(JOB job)
+{
+    jobs_[job].isActive = true;
+    jobs_[job].dueMs = elapsedTimer_.elapsed() + jitteredPeriod(job);
+    restartTimer();
+}
+
+void RefreshScheduler::stop(JOB job)
+{
+    jobs_[job].isActive = false;
+    restartTimer();
+}
+
+void RefreshScheduler::stopAll()
+{
+    for (int i = 0; i < JOBS_COUNT; ++i)
+    {
+        jobs_[i].isActive = false;
+    }
+    timer_.stop();
+}
+
+void RefreshScheduler::onTimer()
+{
+    runBatch(elapsedTimer_.elapsed());
+}
+
+void RefreshScheduler::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON /*reason*/, ProtoTypes::ConnectError /*err*/, const LocationID & /*location*/)
+{
+    isConnected_ = (state == CONNECT_STATE_CONNECTED);
+
+    // the session status is polled faster while connected, don't wait for the rest of the disconnected period
+    JOB_STATE &session = jobs_[JOB_SESSION_STATUS];
+    if (isConnected_ && session.isActive)
+    {
+        session.dueMs = qMin(session.dueMs, elapsedTimer_.elapsed() + jitteredPeriod(JOB_SESSION_STATUS));
+        restartTimer();
+    }
+}
+
+qint64 RefreshScheduler::period(JOB job) const
+{
+    switch (job)
+    {
+        case JOB_SESSION_STATUS:
+            return isConnected_ ? SESSION_STATUS_CONNECTED_PERIOD : SESSION_STATUS_DISCONNECTED_PERIOD;
+        case JOB_NOTIFICATIONS:
+            return NOTIFICATIONS_PERIOD;
+        case JOB_SERVER_RESOURCES:
+            return SERVER_RESOURCES_PERIOD;
+        case JOB_SERVER_CREDENTIALS:
+            return SERVER_CREDENTIALS_PERIOD;
+        default:
+            Q_ASSERT(false);
+            return SERVER_RESOURCES_PERIOD;
+    }
+}
+
+qint64 RefreshScheduler::jitteredPeriod(JOB job) const
+{
+    const qint64 p = period(job);
+    const qint64 jitter = p * JITTER_PERCENT / 100;
+    return p - jitter + static_cast<qint64>(QRandomGenerator::global()->bounded(static_cast<double>(2 * jitter + 1)));
+}
+
+void RefreshScheduler::runBatch(qint64 nowMs)
+{
+    bool isAnyDue = false;
+    for (int i = 0; i < JOBS_COUNT; ++i)
+    {
+        isAnyDue = isAnyDue || (jobs_[i].isActive && jobs_[i].dueMs <= nowMs);
+    }
+
+    if (isAnyDue)
+    {
+        for (int i = 0; i < JOBS_COUNT; ++i)
+        {
+            const JOB job = static_cast<JOB>(i);
+            const qint64 advance = qMin(period(job) / 4, MAX_BATCH_ADVANCE);
+            if (jobs_[i].isActive && jobs_[i].dueMs <= nowMs + advance)
+            {
+                runJob(job, nowMs);
+            }
+        }
+    }
+    restartTimer();
+}
+
+void RefreshScheduler::runJob(JOB job, qint64 nowMs)
+{
+    // rescheduled before the signal, the slot may start() the job again
+    jobs_[job].dueMs = nowMs + jitteredPeriod(job);
+
+    switch (job)
+    {
+        case JOB_SESSION_STATUS:
+            emit sessionStatusRefreshNeeded();
+            break;
+        case JOB_NOTIFICATIONS:
+            emit notificationsRefreshNeeded();
+            break;
+        case JOB_SERVER_RESOURCES:
+            emit serverResourcesRefreshNeeded();
+            break;
+        case JOB_SERVER_CREDENTIALS:
+            emit serverCredentialsRefreshNeeded();
+            break;
+        default:
+            Q_ASSERT(false);
+            break;
+    }
+}
+
+void RefreshScheduler::restartTimer()
+{
+    qint64 nextDueMs = -1;
+    for (int i = 0; i < JOBS_COUNT; ++i)
+    {
+        if (jobs_[i].isActive && (nextDueMs < 0 || jobs_[i].dueMs < nextDueMs))
+        {
+            nextDueMs = jobs_[i].dueMs;
+        }
+    }
+
+    if (nextDueMs < 0)
+    {
+        timer_.stop();
+    }
+    else
+    {
+        timer_.start(static_cast<int>(qMax<qint64>(0, nextDueMs - elapsedTimer_.elapsed())));
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include "connectstatecontroller/iconnectstatecontroller.h"
+
+// One timer for the periodic requests to the server API (the session status, the notifications and the server
+// resources with the check for update). When one of the jobs is due, the jobs due soon after it are run in the
+// same batch, so the requests go out back-to-back over the already resolved and connected API host instead of waking
+// up the app and doing the DNS and TLS setup for each of them. Every period is randomized by JITTER_PERCENT,
+// so the apps started at the same time (e.g. thousands of seats after a reboot of the office) don't stay in sync.
+//
+// The session status, as specified by the 'Standardize Server API Interactions' document in the Hub, is fetched:
+// - On app launch (the LoginController class handles this case)
+// - Every minute when connected, every hour otherwise (also covers the every 24 hours case)
+// - When the app returns to the foreground (gets focus)
+//
+// The server credentials and the OpenVPN config are refetched before they are considered stale
+// (ApiInfo::ovpnConfigRefetchRequired()), so the connect doesn't wait for them.
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum JOB { JOB_SESSION_STATUS, JOB_NOTIFICATIONS, JOB_SERVER_RESOURCES, JOB_SERVER_CREDENTIALS, JOBS_COUNT };
+
+    explicit RefreshScheduler(QObject *parent, IConnectStateController *connectStateController);
+
+    void applicationActivated();
+
+    // schedules the job one period from now, also when it's already scheduled
+    void start(JOB job);
+    void stop(JOB job);
+    void stopAll();
+
+signals:
+    void sessionStatusRefreshNeeded();
+    void notificationsRefreshNeeded();
+    void serverResourcesRefreshNeeded();
+    void serverCredentialsRefreshNeeded();
+
+private slots:
+    void onTimer();
+    void onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
+
+private:
+    static constexpr qint64 SESSION_STATUS_CONNECTED_PERIOD = 60 * 1000;
+    static constexpr qint64 SESSION_STATUS_DISCONNECTED_PERIOD = 60 * 60 * 1000;
+    static constexpr qint64 NOTIFICATIONS_PERIOD = 60 * 60 * 1000;
+    static constexpr qint64 SERVER_RESOURCES_PERIOD = 24 * 60 * 60 * 1000;
+    // with the jitter still within the 24 hours of ApiInfo::ovpnConfigRefetchRequired()
+    static constexpr qint64 SERVER_CREDENTIALS_PERIOD = 20 * 60 * 60 * 1000;
+    static constexpr int JITTER_PERCENT = 10;
+    // a job is pulled into the running batch if it's due within a quarter of its period, but not earlier than this
+    static constexpr qint64 MAX_BATCH_ADVANCE = 5 * 60 * 1000;
+
+    struct JOB_STATE
+    {
+        bool isActive;
+        qint64 dueMs;
+
+        JOB_STATE() : isActive(false), dueMs(0) {}
+    };
+
+    QTimer timer_;
+    QElapsedTimer elapsedTimer_;
+    JOB_STATE jobs_[JOBS_COUNT];
+    bool isConnected_;
+
+    qint64 period(JOB job) const;
+    qint64 jitteredPeriod(JOB job) const;
+    void runBatch(qint64 nowMs);
+    void runJob(JOB job, qint64 nowMs);
+    void restartTimer();
+};
+
+#endif // REFRESHSCHEDULER_H
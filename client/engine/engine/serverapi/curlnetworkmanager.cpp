@@ -7,9 +7,39 @@
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
 #include <QStandardPaths>
+#include <QDateTime>
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+#include <QTimer>
+#include "engine/tests/networkrecorder.h"
+
+namespace {
+
+QString methodName(CurlRequest::MethodType type)
+{
+    switch (type)
+    {
+        case CurlRequest::METHOD_GET: return "GET";
+        case CurlRequest::METHOD_POST: return "POST";
+        case CurlRequest::METHOD_PUT: return "PUT";
+        case CurlRequest::METHOD_DELETE: return "DELETE";
+    }
+    return QString();
+}
+
+// GET and DELETE keep the URL with the query in the get data
+QString recorderKey(const CurlRequest *curlRequest)
+{
+    const bool isGetData = curlRequest->getMethodType() == CurlRequest::METHOD_GET ||
+                           curlRequest->getMethodType() == CurlRequest::METHOD_DELETE;
+    return NetworkRecorder::apiKey(methodName(curlRequest->getMethodType()),
+                                   isGetData ? curlRequest->getGetData() : curlRequest->getUrl());
+}
+
+} // namespace
+#endif
 
 CurlNetworkManager::CurlNetworkManager(QObject *parent) : QThread(parent),
-    bIgnoreSslErrors_(false), bNeedFinish_(false), bProxyEnabled_(true)
+    bIgnoreSslErrors_(false), bNeedFinish_(false), bProxyEnabled_(true), multiHandle_(NULL)
 #if defined(Q_OS_MAC)
   , certPath_(QCoreApplication::applicationDirPath() + "/../resources/cert.pem")
 #elif defined (Q_OS_LINUX)
@@ -40,18 +70,31 @@ size_t write_to_bytearray(void *ptr, size_t size, size_t count, void *stream)
     return size*count;
 }
 
+size_t write_to_stream(void *ptr, size_t size, size_t count, void *stream)
+{
+    static_cast<ICurlAnswerStream *>(stream)->addData(static_cast<const char *>(ptr), size*count);
+    return size*count;
+}
+
+size_t header_callback(char *buffer, size_t size, size_t count, void *userdata)
+{
+    const QByteArray header(buffer, static_cast<int>(size*count));
+    const int ind = header.indexOf(':');
+    if (ind > 0 && header.left(ind).trimmed().toLower() == "etag")
+    {
+        *static_cast<QString *>(userdata) = QString::fromLatin1(header.mid(ind + 1).trimmed());
+    }
+    return size*count;
+}
+
 CURLcode sslctx_function(CURL *curl, void *sslctx, void *parm)
 {
     Q_UNUSED(curl);
 
-    X509_STORE *store = X509_STORE_new();
-    SSL_CTX_set_cert_store((SSL_CTX *)sslctx, store);
-
     CertManager *certManager = static_cast<CertManager *>(parm);
-    for (int i = 0; i < certManager->count(); ++i)
-    {
-        X509_STORE_add_cert(store, certManager->getCert(i));
-    }
+    X509_STORE *store = certManager->getX509Store();
+    X509_STORE_up_ref(store);
+    SSL_CTX_set_cert_store((SSL_CTX *)sslctx, store);
 
     return CURLE_OK;
 }
@@ -62,11 +105,7 @@ void CurlNetworkManager::get(CurlRequest *curlRequest, uint timeout, const QStri
     curlRequest->setTimeout(timeout);
     curlRequest->setHostname(hostname);
     curlRequest->setIps(ips);
-
-    mutexQueue_.lock();
-    queue_.enqueue(curlRequest);
-    waitCondition_.wakeAll();
-    mutexQueue_.unlock();
+    enqueue(curlRequest);
 }
 
 void CurlNetworkManager::post(CurlRequest *curlRequest, uint timeout, const QString &contentTypeHeader,
@@ -77,11 +116,7 @@ void CurlNetworkManager::post(CurlRequest *curlRequest, uint timeout, const QStr
     curlRequest->setContentTypeHeader(contentTypeHeader);
     curlRequest->setHostname(hostname);
     curlRequest->setIps(ips);
-
-    mutexQueue_.lock();
-    queue_.enqueue(curlRequest);
-    waitCondition_.wakeAll();
-    mutexQueue_.unlock();
+    enqueue(curlRequest);
 }
 
 void CurlNetworkManager::put(CurlRequest *curlRequest, uint timeout, const QString &contentTypeHeader, const QString &hostname, const QStringList &ips)
@@ -91,11 +126,7 @@ void CurlNetworkManager::put(CurlRequest *curlRequest, uint timeout, const QStri
     curlRequest->setContentTypeHeader(contentTypeHeader);
     curlRequest->setHostname(hostname);
     curlRequest->setIps(ips);
-
-    mutexQueue_.lock();
-    queue_.enqueue(curlRequest);
-    waitCondition_.wakeAll();
-    mutexQueue_.unlock();
+    enqueue(curlRequest);
 }
 
 void CurlNetworkManager::deleteResource(CurlRequest *curlRequest, uint timeout, const QString &hostname, const QStringList &ips)
@@ -104,6 +135,18 @@ void CurlNetworkManager::deleteResource(CurlRequest *curlRequest, uint timeout,
     curlRequest->setTimeout(timeout);
     curlRequest->setHostname(hostname);
     curlRequest->setIps(ips);
+    enqueue(curlRequest);
+}
+
+void CurlNetworkManager::enqueue(CurlRequest *curlRequest)
+{
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    if (NetworkRecorder::instance().isReplaying())
+    {
+        replay(curlRequest);
+        return;
+    }
+#endif
 
     mutexQueue_.lock();
     queue_.enqueue(curlRequest);
@@ -111,6 +154,56 @@ void CurlNetworkManager::deleteResource(CurlRequest *curlRequest, uint timeout,
     mutexQueue_.unlock();
 }
 
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+void CurlNetworkManager::replay(CurlRequest *curlRequest)
+{
+    NetworkRecorder::ApiAnswer answer;
+    const QString key = recorderKey(curlRequest);
+    if (!NetworkRecorder::instance().replayApi(key, answer))
+    {
+        qCDebug(LOG_CURL_MANAGER) << "No recorded answer for" << key;
+        answer.curlCode = CURLE_COULDNT_CONNECT;
+    }
+    else if (answer.isLost)
+    {
+        answer.curlCode = CURLE_OPERATION_TIMEDOUT;
+        answer.httpCode = 0;
+        answer.body.clear();
+    }
+
+    QTimer::singleShot(answer.timeMs, this, [this, curlRequest, answer]() {
+        const CURLcode curlCode = static_cast<CURLcode>(answer.curlCode);
+        curlRequest->setHttpResponseCode(answer.httpCode);
+        QSharedPointer<ICurlAnswerStream> stream(curlRequest->createAnswerStream());
+        if (stream)
+        {
+            stream->addData(answer.body.constData(), answer.body.size());
+            if (curlCode == CURLE_OK)
+            {
+                stream->finish();
+            }
+            curlRequest->setAnswerStream(stream);
+        }
+        else
+        {
+            curlRequest->setAnswer(answer.body);
+        }
+        const QString ip = curlRequest->isHasNextIp() ? curlRequest->getNextIp() : curlRequest->getHostname();
+        curlRequest->setConnectedIp(curlCode == CURLE_OK ? ip : QString());
+        curlRequest->setCurlRetCode(curlCode);
+        emit finished(curlRequest);
+    });
+}
+
+size_t CurlNetworkManager::writeToStreamAndCopy(void *ptr, size_t size, size_t count, void *attempt)
+{
+    Attempt *a = static_cast<Attempt *>(attempt);
+    a->stream->addData(static_cast<const char *>(ptr), size*count);
+    a->answer.append(static_cast<const char *>(ptr), static_cast<int>(size*count));
+    return size*count;
+}
+#endif
+
 void CurlNetworkManager::setIgnoreSslErrors(bool bIgnore)
 {
     QMutexLocker lock(&mutexAccess_);
@@ -146,9 +239,8 @@ void CurlNetworkManager::setProxyEnabled(bool bEnabled)
 void CurlNetworkManager::run()
 {
     BIND_CRASH_HANDLER_FOR_THREAD();
-    CURLM *multi_handle = curl_multi_init();
+    multiHandle_ = curl_multi_init();
     int still_running = 0;
-    QMap<CURL *, CurlRequest *> map;
 
 #ifdef MAKE_CURL_LOG_FILE
     logFile_ = fopen(logFilePath_.toStdString().c_str(), "w+");
@@ -165,95 +257,72 @@ void CurlNetworkManager::run()
         }
         else
         {
-            if (still_running == 0)
+            if (attempts_.isEmpty())
             {
                 waitCondition_.wait(&mutexQueue_);
             }
         }
         mutexQueue_.unlock();
 
-        still_running = 0;
-
         if (request)
         {
-            CURL *curl = makeRequest(request);
-            if (curl)
-            {
-                map[curl] = request;
-                curl_multi_add_handle(multi_handle, curl);
-                curl_multi_perform(multi_handle, &still_running);
-            }
-            else
+            if (!startAttempt(request))
             {
                 Q_ASSERT(false);
-                emit finished(request);
+                finishRequest(request, nullptr, CURLE_FAILED_INIT);
             }
+            curl_multi_perform(multiHandle_, &still_running);
         }
         else
         {
             int numfds;
-            curl_multi_wait(multi_handle, NULL, 0, 1000, &numfds);
-            curl_multi_perform(multi_handle, &still_running);
+            // wake up earlier if a request may need the next staggered attempt
+            curl_multi_wait(multiHandle_, NULL, 0, isRacingInProgress() ? RACE_STAGGER_MS : 1000, &numfds);
+            curl_multi_perform(multiHandle_, &still_running);
         }
 
+        checkRaces();
+
         // check finished requests
         struct CURLMsg *m;
         do
         {
             int msgq = 0;
-            m = curl_multi_info_read(multi_handle, &msgq);
+            m = curl_multi_info_read(multiHandle_, &msgq);
             if (m && (m->msg == CURLMSG_DONE))
             {
                 CURL *e = m->easy_handle;
-
-                auto it = map.find(e);
-                if (it != map.end())
+                auto it = attempts_.find(e);
+                if (it != attempts_.end())
                 {
-                    CurlRequest *curlRequest = it.value();
-                    // if we have another IPs for connect, try it
-                    if (m->data.result != CURLE_OK && /*!isCurlSslError(m->data.result) &&*/ curlRequest->isHasNextIp())
-                    {
-                        //qDebug() << "===== Try another IP";
-                        map.remove(e);
-                        curl_multi_remove_handle(multi_handle, e);
-                        curl_easy_cleanup(e);
+                    Attempt *attempt = it.value();
+                    CurlRequest *curlRequest = attempt->request;
+                    const RaceState &raceState = races_[curlRequest];
 
-                        CURL *curl = makeRequest(curlRequest);
-                        if (curl)
-                        {
-                            map[curl] = curlRequest;
-                            curl_multi_add_handle(multi_handle, curl);
-                            still_running++;
-                        }
-                        else
+                    if (m->data.result == CURLE_OK || raceState.hasWinner)
+                    {
+                        finishRequest(curlRequest, attempt, m->data.result);
+                    }
+                    // the failed attempt is replaced with the next IP right away, the others keep racing
+                    else if (raceState.attempts.count() > 1 || curlRequest->isHasNextIp())
+                    {
+                        const CURLcode curlRetCode = m->data.result;
+                        removeAttempt(e);
+                        if (curlRequest->isHasNextIp() && !startAttempt(curlRequest))
                         {
                             qCDebug(LOG_CURL_MANAGER) << "Can't create curl object";
                             Q_ASSERT(false);
-                            emit finished(curlRequest);
+                        }
+                        if (races_[curlRequest].attempts.isEmpty())
+                        {
+                            finishRequest(curlRequest, nullptr, curlRetCode);
                         }
                     }
                     else
                     {
-                        curl_off_t download;
-                        if (curl_easy_getinfo(e, CURLINFO_SIZE_DOWNLOAD_T, &download) != CURLE_OK)
-                        {
-                            Q_ASSERT(false);
-                        }
-                        // check if gzip compression used
-                        //Q_ASSERT(download < 30000);
-
-                        curlRequest->setCurlRetCode(m->data.result);
-                        emit finished(curlRequest);
-
-                        map.remove(e);
-                        curl_multi_remove_handle(multi_handle, e);
-                        curl_easy_cleanup(e);
+                        finishRequest(curlRequest, attempt, m->data.result);
                     }
                 }
-                else
-                {
-                    Q_ASSERT(false);
-                }
             }
         } while(m);
 
@@ -264,38 +333,217 @@ void CurlNetworkManager::run()
     }
 
     // delete not finished requests
-    for (auto it = map.begin(); it != map.end(); ++it)
+    const QList<CurlRequest *> requests = races_.keys();
+    for (CurlRequest *curlRequest : requests)
     {
-        delete it.value();
-        curl_multi_remove_handle(multi_handle, it.key());
-        curl_easy_cleanup(it.key());
+        removeAllAttempts(curlRequest);
+        delete curlRequest;
     }
-    map.clear();
+    races_.clear();
 
-    curl_multi_cleanup(multi_handle);
+    curl_multi_cleanup(multiHandle_);
+    multiHandle_ = NULL;
 
 #ifdef MAKE_CURL_LOG_FILE
     fclose(logFile_);
 #endif
 }
 
-CURL *CurlNetworkManager::makeRequest(CurlRequest *curlRequest)
+bool CurlNetworkManager::startAttempt(CurlRequest *curlRequest)
+{
+    Attempt *attempt = new Attempt();
+    attempt->request = curlRequest;
+    attempt->ip = curlRequest->getNextIp();
+    attempt->shareHandle = NULL;
+    attempt->stream = QSharedPointer<ICurlAnswerStream>(curlRequest->createAnswerStream());
+
+    CURL *curl = makeRequest(curlRequest, attempt);
+    if (curl && attempt->stream)
+    {
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+        // the recorder needs the body, which the stream doesn't keep
+        const bool isCopy = NetworkRecorder::instance().isRecording();
+        if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, isCopy ? writeToStreamAndCopy : write_to_stream) != CURLE_OK ||
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, isCopy ? static_cast<void *>(attempt) : attempt->stream.data()) != CURLE_OK)
+#else
+        if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_stream) != CURLE_OK ||
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, attempt->stream.data()) != CURLE_OK)
+#endif
+        {
+            curl_easy_cleanup(curl);
+            curl = NULL;
+        }
+    }
+    if (!curl)
+    {
+        if (attempt->shareHandle)
+        {
+            curl_share_cleanup(attempt->shareHandle);
+        }
+        delete attempt;
+        return false;
+    }
+
+    RaceState &raceState = races_[curlRequest];
+    raceState.attempts << curl;
+    raceState.lastAttemptTime = QDateTime::currentMSecsSinceEpoch();
+    if (raceState.startTime == 0)
+    {
+        raceState.startTime = raceState.lastAttemptTime;
+    }
+    attempts_[curl] = attempt;
+    curl_multi_add_handle(multiHandle_, curl);
+    return true;
+}
+
+void CurlNetworkManager::removeAttempt(CURL *curl)
+{
+    Attempt *attempt = attempts_.take(curl);
+    Q_ASSERT(attempt != nullptr);
+
+    curl_multi_remove_handle(multiHandle_, curl);
+    curl_easy_cleanup(curl);
+    // the share handle can be freed only after the easy handle
+    if (attempt->shareHandle)
+    {
+        curl_share_cleanup(attempt->shareHandle);
+    }
+
+    auto it = races_.find(attempt->request);
+    if (it != races_.end())
+    {
+        it.value().attempts.removeOne(curl);
+    }
+    delete attempt;
+}
+
+void CurlNetworkManager::removeAllAttempts(CurlRequest *curlRequest)
+{
+    auto it = races_.find(curlRequest);
+    if (it != races_.end())
+    {
+        const QVector<CURL *> attempts = it.value().attempts;
+        for (CURL *curl : attempts)
+        {
+            removeAttempt(curl);
+        }
+    }
+}
+
+void CurlNetworkManager::finishRequest(CurlRequest *curlRequest, Attempt *attempt, CURLcode curlRetCode)
+{
+    if (attempt)
+    {
+        long responseCode = 0;
+        CURL *curl = attempts_.key(attempt, nullptr);
+        if (curl && curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode) == CURLE_OK)
+        {
+            curlRequest->setHttpResponseCode(responseCode);
+        }
+        curlRequest->setETag(attempt->etag);
+        curlRequest->setAnswer(attempt->answer);
+        if (attempt->stream && curlRetCode == CURLE_OK)
+        {
+            attempt->stream->finish();
+        }
+        curlRequest->setAnswerStream(attempt->stream);
+        curlRequest->setConnectedIp(curlRetCode == CURLE_OK ? attempt->ip : QString());
+    }
+    curlRequest->setCurlRetCode(curlRetCode);
+
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    if (NetworkRecorder::instance().isRecording())
+    {
+        NetworkRecorder::ApiAnswer answer;
+        answer.curlCode = curlRetCode;
+        answer.httpCode = curlRequest->getHttpResponseCode();
+        answer.body = attempt ? attempt->answer : QByteArray();
+        const qint64 startTime = races_.value(curlRequest).startTime;
+        answer.timeMs = startTime != 0 ? static_cast<int>(QDateTime::currentMSecsSinceEpoch() - startTime) : 0;
+        NetworkRecorder::instance().recordApi(recorderKey(curlRequest), answer);
+    }
+#endif
+
+    removeAllAttempts(curlRequest);
+    races_.remove(curlRequest);
+
+    // the request can be deleted by the receiver at any moment after this signal
+    emit finished(curlRequest);
+}
+
+void CurlNetworkManager::checkRaces()
+{
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    const QList<CurlRequest *> requests = races_.keys();
+    for (CurlRequest *curlRequest : requests)
+    {
+        RaceState &raceState = races_[curlRequest];
+        if (raceState.hasWinner)
+        {
+            continue;
+        }
+
+        // the first attempt which completed the TLS handshake wins, the rest are cancelled
+        CURL *winner = nullptr;
+        for (CURL *curl : qAsConst(raceState.attempts))
+        {
+            curl_off_t appConnectTime = 0;
+            if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnectTime) == CURLE_OK && appConnectTime > 0)
+            {
+                winner = curl;
+                break;
+            }
+        }
+
+        if (winner)
+        {
+            raceState.hasWinner = true;
+            const QVector<CURL *> attempts = raceState.attempts;
+            for (CURL *curl : attempts)
+            {
+                if (curl != winner)
+                {
+                    removeAttempt(curl);
+                }
+            }
+        }
+        else if (curlRequest->isHasNextIp() && raceState.attempts.count() < MAX_PARALLEL_ATTEMPTS &&
+                 (curTime - raceState.lastAttemptTime) >= RACE_STAGGER_MS)
+        {
+            startAttempt(curlRequest);
+        }
+    }
+}
+
+bool CurlNetworkManager::isRacingInProgress() const
+{
+    for (auto it = races_.constBegin(); it != races_.constEnd(); ++it)
+    {
+        if (!it.value().hasWinner && it.key()->isHasNextIp())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CURL *CurlNetworkManager::makeRequest(CurlRequest *curlRequest, Attempt *attempt)
 {
     if (curlRequest->getMethodType() == CurlRequest::METHOD_GET)
     {
-        return makeGetRequest(curlRequest);
+        return makeGetRequest(curlRequest, attempt);
     }
     else if (curlRequest->getMethodType() == CurlRequest::METHOD_POST)
     {
-        return makePostRequest(curlRequest);
+        return makePostRequest(curlRequest, attempt);
     }
     else if (curlRequest->getMethodType() == CurlRequest::METHOD_PUT)
     {
-        return makePutRequest(curlRequest);
+        return makePutRequest(curlRequest, attempt);
     }
     else if (curlRequest->getMethodType() == CurlRequest::METHOD_DELETE)
     {
-        return makeDeleteRequest(curlRequest);
+        return makeDeleteRequest(curlRequest, attempt);
     }
     else
     {
@@ -304,7 +552,7 @@ CURL *CurlNetworkManager::makeRequest(CurlRequest *curlRequest)
     }
 }
 
-CURL *CurlNetworkManager::makeGetRequest(CurlRequest *curlRequest)
+CURL *CurlNetworkManager::makeGetRequest(CurlRequest *curlRequest, Attempt *attempt)
 {
     CURL *curl = curl_easy_init();
 
@@ -312,12 +560,23 @@ CURL *CurlNetworkManager::makeGetRequest(CurlRequest *curlRequest)
     {
         if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_bytearray) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, curlRequest->getAnswerPointer()) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, &attempt->answer) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_URL, curlRequest->getGetData().toStdString().c_str()) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS , curlRequest->getTimeout()) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_HEADERDATA, &attempt->etag) != CURLE_OK) goto failed;
+
+        if (!curlRequest->getIfNoneMatch().isEmpty())
+        {
+            struct curl_slist *list = NULL;
+            list = curl_slist_append(list, ("If-None-Match: " + curlRequest->getIfNoneMatch()).toStdString().c_str());
+            if (list == NULL) goto failed;
+            curlRequest->addCurlListForFreeLater(list);
+            if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list) != CURLE_OK) goto failed;
+        }
 
-        if (!setupResolveHosts(curlRequest, curl)) goto failed;
+        if (!setupResolveHosts(attempt, curl)) goto failed;
         if (!setupSslVerification(curl)) goto failed;
         if (!setupProxy(curl)) goto failed;
 
@@ -332,7 +591,7 @@ failed:
     return NULL;
 }
 
-CURL *CurlNetworkManager::makePostRequest(CurlRequest *curlRequest)
+CURL *CurlNetworkManager::makePostRequest(CurlRequest *curlRequest, Attempt *attempt)
 {
     CURL *curl = curl_easy_init();
 
@@ -340,7 +599,7 @@ CURL *CurlNetworkManager::makePostRequest(CurlRequest *curlRequest)
     {
         if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_bytearray) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK)  goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, curlRequest->getAnswerPointer()) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, &attempt->answer) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_URL, curlRequest->getUrl().toStdString().c_str()) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
 
@@ -350,11 +609,12 @@ CURL *CurlNetworkManager::makePostRequest(CurlRequest *curlRequest)
         curlRequest->addCurlListForFreeLater(list);
 
         if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, curlRequest->getPostData().size()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, curlRequest->getPostData().data()) != CURLE_OK) goto failed;
+        // not copied: the request outlives its attempts, and the racing attempts share one buffer
+        if (curl_easy_setopt(curl, CURLOPT_POSTFIELDS, curlRequest->getPostData().constData()) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS , curlRequest->getTimeout()) != CURLE_OK) goto failed;
 
-        if (!setupResolveHosts(curlRequest, curl)) goto failed;
+        if (!setupResolveHosts(attempt, curl)) goto failed;
         if (!setupSslVerification(curl)) goto failed;
         if (!setupProxy(curl)) goto failed;
 
@@ -369,10 +629,10 @@ failed:
     return NULL;
 }
 
-CURL *CurlNetworkManager::makePutRequest(CurlRequest *curlRequest)
+CURL *CurlNetworkManager::makePutRequest(CurlRequest *curlRequest, Attempt *attempt)
 {
     // the same as making post, only add CURLOPT_CUSTOMREQUEST field
-    CURL *curl = makePostRequest(curlRequest);
+    CURL *curl = makePostRequest(curlRequest, attempt);
     if (curl)
     {
         if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT") != CURLE_OK)
@@ -388,7 +648,7 @@ CURL *CurlNetworkManager::makePutRequest(CurlRequest *curlRequest)
     }
 }
 
-CURL *CurlNetworkManager::makeDeleteRequest(CurlRequest *curlRequest)
+CURL *CurlNetworkManager::makeDeleteRequest(CurlRequest *curlRequest, Attempt *attempt)
 {
     CURL *curl = curl_easy_init();
 
@@ -396,13 +656,13 @@ CURL *CurlNetworkManager::makeDeleteRequest(CurlRequest *curlRequest)
     {
         if (curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_bytearray) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, curlRequest->getAnswerPointer()) != CURLE_OK) goto failed;
+        if (curl_easy_setopt(curl, CURLOPT_WRITEDATA, &attempt->answer) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_URL, curlRequest->getGetData().toStdString().c_str()) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE") != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, curlRequest->getTimeout()) != CURLE_OK) goto failed;
 
-        if (!setupResolveHosts(curlRequest, curl)) goto failed;
+        if (!setupResolveHosts(attempt, curl)) goto failed;
         if (!setupSslVerification(curl)) goto failed;
         if (!setupProxy(curl)) goto failed;
 
@@ -417,20 +677,21 @@ failed:
     return NULL;
 }
 
-bool CurlNetworkManager::setupResolveHosts(CurlRequest *curlRequest, CURL *curl)
+bool CurlNetworkManager::setupResolveHosts(Attempt *attempt, CURL *curl)
 {
-    if (curlRequest->isHasNextIp())
+    if (!attempt->ip.isEmpty())
     {
-        CURLSH *share_handle = curl_share_init();
-        if (curl_share_setopt(share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) != CURLSHE_OK) return false;
-        if (curl_easy_setopt(curl, CURLOPT_SHARE, share_handle) != CURLE_OK) return false;
+        // each attempt has its own DNS cache, so parallel attempts to the same hostname use different IPs
+        attempt->shareHandle = curl_share_init();
+        if (curl_share_setopt(attempt->shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) != CURLSHE_OK) return false;
+        if (curl_easy_setopt(curl, CURLOPT_SHARE, attempt->shareHandle) != CURLE_OK) return false;
 
         struct curl_slist *hosts = NULL;
-        QString s = curlRequest->getHostname() + ":443" + ":" + curlRequest->getNextIp();
+        QString s = attempt->request->getHostname() + ":443" + ":" + attempt->ip;
         hosts = curl_slist_append(NULL, s.toStdString().c_str());
         if (hosts == NULL) return false;
 
-        curlRequest->addCurlListForFreeLater(hosts);
+        attempt->request->addCurlListForFreeLater(hosts);
         if (curl_easy_setopt(curl, CURLOPT_RESOLVE, hosts) != CURLE_OK) return false;
     }
     return true;
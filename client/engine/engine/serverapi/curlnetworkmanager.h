@@ -1,6 +1,7 @@
 #ifndef CURLNETWORKMANAGER_H
 #define CURLNETWORKMANAGER_H
 
+#include <QHash>
 #include <QQueue>
 #include <QThread>
 #include <QWaitCondition>
@@ -61,13 +62,58 @@ private:
     FILE *logFile_;
 #endif
 
-    CURL *makeRequest(CurlRequest *curlRequest);
-    CURL *makeGetRequest(CurlRequest *curlRequest);
-    CURL *makePostRequest(CurlRequest *curlRequest);
-    CURL *makePutRequest(CurlRequest *curlRequest);
-    CURL *makeDeleteRequest(CurlRequest *curlRequest);
+    // If the request has several IPs, connections to them are raced: a new attempt to the next IP is started
+    // every RACE_STAGGER_MS (or immediately, if the previous attempt failed) until one of them completes the TLS handshake.
+    static constexpr int MAX_PARALLEL_ATTEMPTS = 3;
+    static constexpr int RACE_STAGGER_MS = 300;
+
+    // one connection attempt to a specific IP
+    struct Attempt
+    {
+        CurlRequest *request;
+        QString ip;
+        QByteArray answer;
+        QSharedPointer<ICurlAnswerStream> stream;   // if set, used instead of answer
+        QString etag;
+        CURLSH *shareHandle;
+    };
+
+    struct RaceState
+    {
+        QVector<CURL *> attempts;
+        qint64 lastAttemptTime;
+        bool hasWinner;
+        qint64 startTime;       // of the first attempt, for NetworkRecorder
+
+        RaceState() : lastAttemptTime(0), hasWinner(false), startTime(0) {}
+    };
+
+    // accessed only from run() thread
+    CURLM *multiHandle_;
+    QMap<CURL *, Attempt *> attempts_;
+    QHash<CurlRequest *, RaceState> races_;
+
+    void enqueue(CurlRequest *curlRequest);
+#ifdef WINDSCRIBE_NETWORK_RECORDER
+    // NetworkRecorder replay: the recorded answer after the recorded time, in the thread of the caller
+    void replay(CurlRequest *curlRequest);
+    static size_t writeToStreamAndCopy(void *ptr, size_t size, size_t count, void *attempt);
+#endif
+
+    bool startAttempt(CurlRequest *curlRequest);
+    void removeAttempt(CURL *curl);
+    void removeAllAttempts(CurlRequest *curlRequest);
+    void finishRequest(CurlRequest *curlRequest, Attempt *attempt, CURLcode curlRetCode);
+    void checkRaces();
+    bool isRacingInProgress() const;
+
+    CURL *makeRequest(CurlRequest *curlRequest, Attempt *attempt);
+    CURL *makeGetRequest(CurlRequest *curlRequest, Attempt *attempt);
+    CURL *makePostRequest(CurlRequest *curlRequest, Attempt *attempt);
+    CURL *makePutRequest(CurlRequest *curlRequest, Attempt *attempt);
+    CURL *makeDeleteRequest(CurlRequest *curlRequest, Attempt *attempt);
 
-    bool setupResolveHosts(CurlRequest *curlRequest, CURL *curl);
+    bool setupResolveHosts(Attempt *attempt, CURL *curl);
     bool setupSslVerification(CURL *curl);
     bool setupProxy(CURL *curl);
 };
@@ -1,6 +1,6 @@
 #include "curlrequest.h"
 
-CurlRequest::CurlRequest() : curlCode_(CURLE_FAILED_INIT), methodType_(METHOD_GET), timeout_(0)
+CurlRequest::CurlRequest() : curlCode_(CURLE_FAILED_INIT), methodType_(METHOD_GET), timeout_(0), httpResponseCode_(0)
 {
 }
 
@@ -31,7 +31,7 @@ void CurlRequest::setPostData(const QByteArray &data)
     postData_ = data;
 }
 
-QByteArray CurlRequest::getPostData() const
+const QByteArray &CurlRequest::getPostData() const
 {
     return postData_;
 }
@@ -46,14 +46,34 @@ QString CurlRequest::getUrl() const
     return strUrl_;
 }
 
+void CurlRequest::setAnswer(const QByteArray &answer)
+{
+    answer_ = answer;
+}
+
 QByteArray CurlRequest::getAnswer() const
 {
     return answer_;
 }
 
-const QByteArray *CurlRequest::getAnswerPointer() const
+void CurlRequest::setAnswerStreamFactory(const std::function<ICurlAnswerStream *()> &factory)
+{
+    answerStreamFactory_ = factory;
+}
+
+ICurlAnswerStream *CurlRequest::createAnswerStream() const
+{
+    return answerStreamFactory_ ? answerStreamFactory_() : nullptr;
+}
+
+void CurlRequest::setAnswerStream(const QSharedPointer<ICurlAnswerStream> &stream)
+{
+    answerStream_ = stream;
+}
+
+QSharedPointer<ICurlAnswerStream> CurlRequest::getAnswerStream() const
 {
-    return &answer_;
+    return answerStream_;
 }
 
 void CurlRequest::setCurlRetCode(CURLcode code)
@@ -140,3 +160,48 @@ bool CurlRequest::isHasNextIp() const
 {
     return !ips_.isEmpty();
 }
+
+void CurlRequest::setConnectedIp(const QString &ip)
+{
+    connectedIp_ = ip;
+}
+
+QString CurlRequest::getConnectedIp() const
+{
+    return connectedIp_;
+}
+
+void CurlRequest::setIfNoneMatch(const QString &etag)
+{
+    ifNoneMatch_ = etag;
+}
+
+QString CurlRequest::getIfNoneMatch() const
+{
+    return ifNoneMatch_;
+}
+
+void CurlRequest::setHttpResponseCode(long code)
+{
+    httpResponseCode_ = code;
+}
+
+long CurlRequest::getHttpResponseCode() const
+{
+    return httpResponseCode_;
+}
+
+bool CurlRequest::isNotModified() const
+{
+    return httpResponseCode_ == 304;
+}
+
+void CurlRequest::setETag(const QString &etag)
+{
+    etag_ = etag;
+}
+
+QString CurlRequest::getETag() const
+{
+    return etag_;
+}
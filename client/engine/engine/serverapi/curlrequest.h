@@ -2,13 +2,25 @@
 #define CURLREQUEST_H
 
 #include <QQueue>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QVector>
 #include <curl/curl.h>
+#include <functional>
 #include "../types/types.h"
 #include "../types/protocoltype.h"
 
+// Receives the answer incrementally, chunk by chunk, in the curl thread.
+class ICurlAnswerStream
+{
+public:
+    virtual ~ICurlAnswerStream() {}
+    virtual void addData(const char *data, size_t size) = 0;
+    // in the curl thread, after the last chunk of the attempt which completed the request successfully
+    virtual void finish() {}
+};
+
 class CurlRequest
 {
 public:
@@ -19,13 +31,20 @@ public:
     QString getGetData() const;
 
     void setPostData(const QByteArray &data);
-    QByteArray getPostData() const;
+    const QByteArray &getPostData() const;
 
     void setUrl(const QString &strUrl);
     QString getUrl() const;
 
+    void setAnswer(const QByteArray &answer);
     QByteArray getAnswer() const;
-    const QByteArray *getAnswerPointer() const;
+
+    // If the factory is set, the answer is passed to a stream object (one per connection attempt) instead of being
+    // accumulated in getAnswer(). The stream of the attempt that completed the request is returned by getAnswerStream().
+    void setAnswerStreamFactory(const std::function<ICurlAnswerStream *()> &factory);
+    ICurlAnswerStream *createAnswerStream() const;
+    void setAnswerStream(const QSharedPointer<ICurlAnswerStream> &stream);
+    QSharedPointer<ICurlAnswerStream> getAnswerStream() const;
 
     void setCurlRetCode(CURLcode code);
     CURLcode getCurlRetCode() const;
@@ -51,6 +70,22 @@ public:
     QString getNextIp();
     bool isHasNextIp() const;
 
+    // IP of the attempt which completed the request, empty if the request failed
+    void setConnectedIp(const QString &ip);
+    QString getConnectedIp() const;
+
+    // conditional GET: if the ETag is set, the server may answer 304 Not Modified with an empty body
+    void setIfNoneMatch(const QString &etag);
+    QString getIfNoneMatch() const;
+
+    void setHttpResponseCode(long code);
+    long getHttpResponseCode() const;
+    bool isNotModified() const;
+
+    // ETag header of the answer, empty if the server did not send it
+    void setETag(const QString &etag);
+    QString getETag() const;
+
 private:
     QString getData_;
     QByteArray postData_;
@@ -64,6 +99,12 @@ private:
     QVector<CURLSH *> curlShareHandles_;
     QString hostname_;
     QQueue<QString> ips_;
+    QString connectedIp_;
+    QString ifNoneMatch_;
+    long httpResponseCode_;
+    QString etag_;
+    std::function<ICurlAnswerStream *()> answerStreamFactory_;
+    QSharedPointer<ICurlAnswerStream> answerStream_;
 };
 
 #endif // CURLREQUEST_H
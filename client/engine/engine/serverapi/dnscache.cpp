@@ -38,7 +38,7 @@ void DnsCache::resolve(const QString &hostname, int cacheTimeout, void *userData
             qint64 curTime = QDateTime::currentMSecsSinceEpoch();
             if ((curTime - it.value().time) <= cacheTimeout)
             {
-                emit resolved(true, userData, requestStartTime, it.value().ips);
+                emit resolved(true, userData, requestStartTime, preferredIpFirst(hostname, it.value().ips));
                 return;
             }
         }
@@ -59,6 +59,11 @@ void DnsCache::resolve(const QString &hostname, int cacheTimeout, void *userData
     }
 }
 
+void DnsCache::setPreferredIp(const QString &hostname, const QString &ip)
+{
+    preferredIps_[hostname] = ip;
+}
+
 void DnsCache::onDnsRequestFinished()
 {
     DnsRequest *dnsRequest = qobject_cast<DnsRequest *>(sender());
@@ -86,7 +91,7 @@ void DnsCache::onDnsRequestFinished()
     {
         if (it->hostname == dnsRequest->hostname())
         {
-            emit resolved(bSuccess, it->userData, it->requestStartTime, ips);
+            emit resolved(bSuccess, it->userData, it->requestStartTime, preferredIpFirst(dnsRequest->hostname(), ips));
             it = pendingHosts_.erase(it);
         }
         else
@@ -100,6 +105,25 @@ void DnsCache::onDnsRequestFinished()
     dnsRequest->deleteLater();
 }
 
+QStringList DnsCache::preferredIpFirst(const QString &hostname, const QStringList &ips) const
+{
+    auto it = preferredIps_.find(hostname);
+    if (it == preferredIps_.end())
+    {
+        return ips;
+    }
+
+    int ind = ips.indexOf(it.value());
+    if (ind <= 0)
+    {
+        return ips;
+    }
+
+    QStringList result = ips;
+    result.move(ind, 0);
+    return result;
+}
+
 void DnsCache::checkForNewIps(const QStringList &newIps)
 {
     bool bNewIps = false;
@@ -15,6 +15,9 @@ public:
     void resolve(const QString &hostname, void *userData, qint64 requestStartTime);
     void resolve(const QString &hostname, int cacheTimeout, void *userData, qint64 requestStartTime);
 
+    // remember the IP which answered first for the hostname, it will be returned first in the subsequent resolves
+    void setPreferredIp(const QString &hostname, const QString &ip);
+
 signals:
     void resolved(bool success, void *userData, qint64 requestStartTime, const QStringList &ips);
     void ipsInCachChanged(const QStringList &ips);
@@ -41,9 +44,12 @@ private:
         qint64 requestStartTime;
     };
 
+    QMap<QString, QString> preferredIps_;
+
     QSet<QString> resolvingHostsInProgress_;
     QVector<PendingResolvingHosts> pendingHosts_;
 
+    QStringList preferredIpFirst(const QString &hostname, const QStringList &ips) const;
     void checkForNewIps(const QStringList &newIps);
     void checkForNewIps(const QString &ip);
 };
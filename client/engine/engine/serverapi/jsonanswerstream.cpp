@@ -0,0 +1,22 @@
+#include "jsonanswerstream.h"
+#include <QElapsedTimer>
+
+JsonAnswerStream::JsonAnswerStream() : isParsed_(false), parseTimeUs_(0)
+{
+    parseError_.error = QJsonParseError::NoError;
+    parseError_.offset = 0;
+}
+
+void JsonAnswerStream::addData(const char *data, size_t size)
+{
+    answer_.append(data, static_cast<int>(size));
+}
+
+void JsonAnswerStream::finish()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    document_ = QJsonDocument::fromJson(answer_, &parseError_);
+    parseTimeUs_ = elapsedTimer.nsecsElapsed() / 1000;
+    isParsed_ = true;
+}
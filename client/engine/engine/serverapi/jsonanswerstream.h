@@ -0,0 +1,33 @@
+#ifndef JSONANSWERSTREAM_H
+#define JSONANSWERSTREAM_H
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include "curlrequest.h"
+
+// Accumulates the answer and parses it as JSON in the curl thread when the request completes,
+// so the handler in the engine thread gets the document ready.
+class JsonAnswerStream : public ICurlAnswerStream
+{
+public:
+    JsonAnswerStream();
+
+    void addData(const char *data, size_t size) override;
+    void finish() override;
+
+    const QByteArray &answer() const { return answer_; }
+    bool isParsed() const { return isParsed_; }
+    const QJsonDocument &document() const { return document_; }
+    const QJsonParseError &parseError() const { return parseError_; }
+    qint64 parseTimeUs() const { return parseTimeUs_; }
+
+private:
+    QByteArray answer_;
+    bool isParsed_;
+    QJsonDocument document_;
+    QJsonParseError parseError_;
+    qint64 parseTimeUs_;
+};
+
+#endif // JSONANSWERSTREAM_H
@@ -0,0 +1,188 @@
+#include "locationsjsonstreamparser.h"
+#include <QJsonDocument>
+#include "utils/logger.h"
+
+LocationsJsonStreamParser::LocationsJsonStreamParser() : depth_(0), isInString_(false), isEscape_(false),
+    isError_(false), isStarted_(false), isFinished_(false), isExpectingKey_(false), isReadingKey_(false),
+    isInDataArray_(false), captureType_(CAPTURE_NONE), isInfoFound_(false), isDataFound_(false),
+    skippedElementsCount_(0), totalBytes_(0), peakBufferSize_(0), parseTimeNs_(0)
+{
+}
+
+void LocationsJsonStreamParser::addData(const char *data, size_t size)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    totalBytes_ += static_cast<int>(size);
+
+    // start of the captured part in the current chunk, if the capture is in progress
+    size_t captureFrom = 0;
+
+    for (size_t i = 0; i < size && !isError_; ++i)
+    {
+        const char c = data[i];
+
+        if (isInString_)
+        {
+            if (isEscape_)
+            {
+                isEscape_ = false;
+            }
+            else if (c == '\\')
+            {
+                isEscape_ = true;
+            }
+            else if (c == '"')
+            {
+                isInString_ = false;
+                isReadingKey_ = false;
+            }
+            else if (isReadingKey_)
+            {
+                currentKey_.append(c);
+            }
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            continue;
+        }
+
+        if (!isStarted_ || isFinished_)
+        {
+            // the answer must be a single JSON object
+            if (c == '{' && !isStarted_)
+            {
+                isStarted_ = true;
+                depth_ = 1;
+                isExpectingKey_ = true;
+            }
+            else
+            {
+                isError_ = true;
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+        case '"':
+            isInString_ = true;
+            if (depth_ == 1 && isExpectingKey_)
+            {
+                isExpectingKey_ = false;
+                isReadingKey_ = true;
+                currentKey_.clear();
+            }
+            break;
+        case ':':
+            if (depth_ == 1)
+            {
+                valueKey_ = currentKey_;
+            }
+            break;
+        case ',':
+            if (depth_ == 1)
+            {
+                isExpectingKey_ = true;
+                valueKey_.clear();
+            }
+            break;
+        case '{':
+        case '[':
+            if (depth_ == 1 && c == '{' && valueKey_ == "info")
+            {
+                captureType_ = CAPTURE_INFO;
+                captureFrom = i;
+            }
+            else if (depth_ == 1 && c == '[' && valueKey_ == "data")
+            {
+                isInDataArray_ = true;
+            }
+            else if (depth_ == 2 && isInDataArray_)
+            {
+                if (c == '{')
+                {
+                    captureType_ = CAPTURE_DATA_ELEMENT;
+                    captureFrom = i;
+                }
+                else
+                {
+                    qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping non-object 'data' element";
+                    skippedElementsCount_++;
+                }
+            }
+            depth_++;
+            break;
+        case '}':
+        case ']':
+            depth_--;
+            if (depth_ == 0)
+            {
+                isFinished_ = true;
+            }
+            else if ((depth_ == 1 && captureType_ == CAPTURE_INFO) || (depth_ == 2 && captureType_ == CAPTURE_DATA_ELEMENT))
+            {
+                buffer_.append(data + captureFrom, static_cast<int>(i - captureFrom + 1));
+                peakBufferSize_ = qMax(peakBufferSize_, buffer_.size());
+                onCaptureFinished();
+            }
+            else if (depth_ == 1 && isInDataArray_)
+            {
+                isInDataArray_ = false;
+                isDataFound_ = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // keep the incomplete element until the next chunk
+    if (captureType_ != CAPTURE_NONE && !isError_)
+    {
+        buffer_.append(data + captureFrom, static_cast<int>(size - captureFrom));
+        peakBufferSize_ = qMax(peakBufferSize_, buffer_.size());
+    }
+
+    parseTimeNs_ += elapsedTimer.nsecsElapsed();
+}
+
+bool LocationsJsonStreamParser::isCompleted() const
+{
+    return isFinished_ && !isError_;
+}
+
+void LocationsJsonStreamParser::onCaptureFinished()
+{
+    QJsonParseError errCode;
+    QJsonDocument doc = QJsonDocument::fromJson(buffer_, &errCode);
+    if (errCode.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        isError_ = true;
+    }
+    else if (captureType_ == CAPTURE_INFO)
+    {
+        info_ = doc.object();
+        isInfoFound_ = true;
+    }
+    else
+    {
+        apiinfo::Location location;
+        if (location.initFromJson(doc.object(), forceDisconnectNodes_))
+        {
+            locations_ << location;
+        }
+        else
+        {
+            qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping invalid/incomplete 'data' element at index"
+                                    << (locations_.count() + skippedElementsCount_) << "(" << buffer_ << ")";
+            skippedElementsCount_++;
+        }
+    }
+
+    buffer_.clear();
+    captureType_ = CAPTURE_NONE;
+}
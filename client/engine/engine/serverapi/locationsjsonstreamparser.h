@@ -0,0 +1,69 @@
+#ifndef LOCATIONSJSONSTREAMPARSER_H
+#define LOCATIONSJSONSTREAMPARSER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVector>
+#include "curlrequest.h"
+#include "engine/apiinfo/location.h"
+
+// Incremental parser of the ServerLocations answer: {"info": {...}, "data": [{location}, {location}, ...]}.
+// The answer is fed chunk by chunk from the curl callback. Only the currently received element of the "data" array
+// is buffered, each complete element is decoded into apiinfo::Location right away, so the whole answer and
+// the whole QJsonDocument are never held in memory.
+class LocationsJsonStreamParser : public ICurlAnswerStream
+{
+public:
+    LocationsJsonStreamParser();
+
+    void addData(const char *data, size_t size) override;
+
+    // true if the answer was a complete JSON object and all elements of "data" were valid JSON
+    bool isCompleted() const;
+    bool isInfoFound() const { return isInfoFound_; }
+    bool isDataFound() const { return isDataFound_; }
+
+    const QJsonObject &info() const { return info_; }
+    const QVector<apiinfo::Location> &locations() const { return locations_; }
+    const QStringList &forceDisconnectNodes() const { return forceDisconnectNodes_; }
+    int skippedElementsCount() const { return skippedElementsCount_; }
+
+    int totalBytes() const { return totalBytes_; }
+    int peakBufferSize() const { return peakBufferSize_; }
+    qint64 parseTimeMs() const { return parseTimeNs_ / 1000000; }
+
+private:
+    enum CAPTURE_TYPE { CAPTURE_NONE, CAPTURE_INFO, CAPTURE_DATA_ELEMENT };
+
+    void onCaptureFinished();
+
+    int depth_;
+    bool isInString_;
+    bool isEscape_;
+    bool isError_;
+    bool isStarted_;
+    bool isFinished_;
+
+    // key tracking for the top-level object
+    bool isExpectingKey_;
+    bool isReadingKey_;
+    QByteArray currentKey_;
+    QByteArray valueKey_;       // key of the top-level value currently being read
+    bool isInDataArray_;
+
+    CAPTURE_TYPE captureType_;
+    QByteArray buffer_;
+
+    bool isInfoFound_;
+    bool isDataFound_;
+    QJsonObject info_;
+    QVector<apiinfo::Location> locations_;
+    QStringList forceDisconnectNodes_;
+    int skippedElementsCount_;
+
+    int totalBytes_;
+    int peakBufferSize_;
+    qint64 parseTimeNs_;
+};
+
+#endif // LOCATIONSJSONSTREAMPARSER_H
@@ -15,12 +15,74 @@
 #include "version/appversion.h"
 #include "../tests/sessionandlocations_test.h"
 #include "utils/extraconfig.h"
+#include "locationsjsonstreamparser.h"
+#include "jsonanswerstream.h"
+#include "engine/enginemetrics.h"
 #include <algorithm>
 
 #ifdef Q_OS_LINUX
     #include "utils/linuxutils.h"
 #endif
 
+namespace {
+
+// for the metrics, in the order of the REPLY_ types
+const char *const REPLY_NAMES[] = {
+    "access_ips", "login", "session", "server_locations", "server_credentials", "delete_session", "server_configs",
+    "port_map", "my_ip", "check_update", "record_install", "debug_log", "speed_rating", "ping_test", "notifications",
+    "static_ips", "confirm_email", "wireguard_init", "wireguard_connect", "web_session"
+};
+
+// Appends the log as the base64 form field to the post data, slice by slice: the full UTF-8 and base64 copies
+// of a multi-megabyte log are never made, the post data is the only large buffer besides the log itself.
+void appendLogFileField(QByteArray &postData, const QString &log)
+{
+    // a multiple of 3, so the base64 of the slices is the same as of the whole
+    const int SLICE_BYTES = 48 * 1024;
+    const int SLICE_CHARS = 16 * 1024;
+
+    postData += "logfile=";
+    // UTF-8 of the usual log is 1 byte per char, and about 6% of the base64 chars are escaped
+    postData.reserve(postData.size() + int(qint64(log.size()) * 4 / 3 * 106 / 100) + 16);
+
+    QByteArray pending;
+    auto appendBase64 = [&postData](const QByteArray &bytes) {
+        const QByteArray base64 = bytes.toBase64();
+        for (char c : base64)
+        {
+            if (c == '+')
+                postData += "%2B";
+            else if (c == '/')
+                postData += "%2F";
+            else if (c == '=')
+                postData += "%3D";
+            else
+                postData += c;
+        }
+    };
+
+    for (int pos = 0; pos < log.size(); )
+    {
+        int len = qMin(SLICE_CHARS, log.size() - pos);
+        // don't split a surrogate pair between the slices
+        if (pos + len < log.size() && log.at(pos + len - 1).isHighSurrogate())
+            len++;
+        pending += log.midRef(pos, len).toUtf8();
+        pos += len;
+
+        const int whole = pending.size() / SLICE_BYTES * SLICE_BYTES;
+        if (whole > 0)
+        {
+            appendBase64(pending.left(whole));
+            pending.remove(0, whole);
+        }
+    }
+    if (!pending.isEmpty())
+        appendBase64(pending);
+}
+
+} // namespace
+
 class ServerAPI::BaseRequest
 {
 public:
@@ -80,7 +142,6 @@ private:
 namespace
 {
 // Interval, in ms, between polling requests, to remove expired and timed out.
-const int REQUEST_POLL_INTERVAL_MS = 100;
 
 
 
@@ -150,17 +211,18 @@ class ServerLocationsRequest : public AuthenticatedRequest
 public:
     ServerLocationsRequest(const QString &authhash, const QString &language,
                            const QString &revision, bool isPro,
-                           ProtocolType protocol, QStringList alcList, const QString &hostname,
-                           int replyType, uint timeout, uint userRole)
+                           ProtocolType protocol, QStringList alcList, bool isConditional,
+                           const QString &hostname, int replyType, uint timeout, uint userRole)
         : AuthenticatedRequest(authhash, hostname, replyType, timeout, userRole),
           language_(language), revision_(revision), isPro_(isPro),
-          protocol_(protocol), alcList_(alcList) {}
+          protocol_(protocol), alcList_(alcList), isConditional_(isConditional) {}
 
     const QString &getLanguage() const { return language_; }
     const QString &getRevision() const { return revision_; }
     bool getIsPro() const { return isPro_; }
     ProtocolType getProtocol() const { return protocol_; }
     const QStringList &getAlcList() const { return alcList_; }
+    bool isConditional() const { return isConditional_; }
 
 private:
     QString language_;
@@ -168,6 +230,7 @@ private:
     bool isPro_;
     ProtocolType protocol_;
     QStringList alcList_;
+    bool isConditional_;
 };
 
 class ServerCredentialsRequest : public AuthenticatedRequest
@@ -208,6 +271,8 @@ public:
 
     const QString &getUsername() const { return username_; }
     const QString &getLogStr() const { return logStr_; }
+    // the log isn't needed once the post data is made, it's the largest part of the memory of the upload
+    void releaseLogStr() { logStr_ = QString(); }
 
 private:
     QString username_;
@@ -379,8 +444,8 @@ ServerAPI::ServerAPI(QObject *parent) : QObject(parent),
     handleCurlReplyFuncTable_[REPLY_WIREGUARD_CONNECT] = &ServerAPI::handleWgConfigsConnectCurl;
     handleCurlReplyFuncTable_[REPLY_WEB_SESSION] = &ServerAPI::handleWebSessionCurl;
 
+    requestTimer_.setSingleShot(true);
     connect(&requestTimer_, SIGNAL(timeout()), SLOT(onRequestTimer()));
-    requestTimer_.start(REQUEST_POLL_INTERVAL_MS);
 }
 
 ServerAPI::~ServerAPI()
@@ -540,6 +605,25 @@ void ServerAPI::onRequestTimer()
             ++it;
         }
     }
+
+    restartRequestTimer();
+}
+
+void ServerAPI::restartRequestTimer()
+{
+    // the requests are few, the scan is done only when they change instead of polling them
+    const qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    qint64 nextTime = -1;
+    for (const auto *rd : activeRequests_) {
+        const qint64 time = rd->isActive() ? rd->getStartTime() + rd->getTimeout() + 1 : curTime;
+        if (nextTime == -1 || time < nextTime)
+            nextTime = time;
+    }
+
+    if (nextTime == -1)
+        requestTimer_.stop();
+    else
+        requestTimer_.start(static_cast<int>(qMax<qint64>(0, nextTime - curTime)));
 }
 
 // works with direct IP
@@ -619,9 +703,11 @@ void ServerAPI::serverLocations(const QString &authHash, const QString &language
         hostname = modifiedHostname;
     }
 
+    // the login (isNeedCheckRequestsEnabled == false) always needs the full list, the refreshes from the engine
+    // already have it and can be answered with 304 Not Modified
     submitDnsRequest(createRequest<ServerLocationsRequest>(
         authHash, language, revision, isPro, protocol,
-        std::move(alcList), hostname, REPLY_SERVER_LOCATIONS, NETWORK_TIMEOUT, userRole));
+        std::move(alcList), isNeedCheckRequestsEnabled, hostname, REPLY_SERVER_LOCATIONS, NETWORK_TIMEOUT, userRole));
 }
 
 void ServerAPI::serverCredentials(const QString &authHash, uint userRole, ProtocolType protocol, bool isNeedCheckRequestsEnabled)
@@ -715,6 +801,7 @@ void ServerAPI::myIP(bool isDisconnected, uint userRole, bool isNeedCheckRequest
         if (rd->getReplyType() == REPLY_MY_IP)
             rd->setActive(false);
     }
+    restartRequestTimer();
 
     if (isNeedCheckRequestsEnabled && !bIsRequestsEnabled_)
     {
@@ -807,6 +894,7 @@ void ServerAPI::cancelPingTest(quint64 cmdId)
         if (ping_rd && ping_rd->getCommandId() == cmdId)
             rd->setActive(false);
     }
+    restartRequestTimer();
 }
 
 void ServerAPI::notifications(const QString &authHash, uint userRole, bool isNeedCheckRequestsEnabled)
@@ -878,12 +966,20 @@ void ServerAPI::onDnsResolved(bool success, void *userData, qint64 requestStartT
         rd->setWaitingHandlerType(BaseRequest::HandlerType::NONE);
 
     // If there is no active curl request, we are done.
-    if (!rd->isWaitingForCurlResponse())
+    if (!rd->isWaitingForCurlResponse()) {
         rd->setActive(false);
+        restartRequestTimer();
+    }
 }
 
 void ServerAPI::onCurlNetworkRequestFinished(CurlRequest *curlRequest)
 {
+    // next requests to this hostname will try the IP that won the connection race first
+    if (!curlRequest->getConnectedIp().isEmpty())
+    {
+        dnsCache_->setPreferredIp(curlRequest->getHostname(), curlRequest->getConnectedIp());
+    }
+
     // Make sure the request is pending.
     auto *rd = curlToRequestMap_.take(curlRequest);
     Q_ASSERT(!rd || rd->isCurlRequestSubmitted());
@@ -912,8 +1008,11 @@ void ServerAPI::onCurlNetworkRequestFinished(CurlRequest *curlRequest)
             rd->setWaitingHandlerType(BaseRequest::HandlerType::NONE);
 
         // We are done with this request.
+        EngineMetrics::instance().observeMs("windscribe_api_request_ms", QDateTime::currentMSecsSinceEpoch() - rd->getStartTime(),
+                                            "request", REPLY_NAMES[reply_type]);
         rd->setCurlRequestSubmitted(false);
         rd->setActive(false);
+        restartRequestTimer();
     }
 }
 
@@ -921,6 +1020,7 @@ void ServerAPI::handleRequestTimeout(BaseRequest *rd)
 {
     const auto reply_type = rd->getReplyType();
     Q_ASSERT(reply_type >= 0 && reply_type < NUM_REPLY_TYPES);
+    EngineMetrics::instance().addCount("windscribe_api_request_timeouts_total", "request", REPLY_NAMES[reply_type]);
 
     if (rd->isWaitingForCurlResponse()) {
         Q_ASSERT(handleCurlReplyFuncTable_[reply_type] != nullptr);
@@ -992,6 +1092,7 @@ void ServerAPI::handleSessionDnsResolve(BaseRequest *rd, bool success, const QSt
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+    curl_request->setAnswerStreamFactory([]() { return new JsonAnswerStream(); });
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1078,6 +1179,13 @@ void ServerAPI::handleServerLocationsDnsResolve(BaseRequest *rd, bool success,
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+#if !defined(TEST_CREATE_API_FILES) && !defined(TEST_API_FROM_FILES)
+    curl_request->setAnswerStreamFactory([]() { return new LocationsJsonStreamParser(); });
+    if (crd->isConditional() && !locationsEtag_.isEmpty() && locationsEtagUrl_ == url.toString())
+    {
+        curl_request->setIfNoneMatch(locationsEtag_);
+    }
+#endif
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1172,6 +1280,7 @@ void ServerAPI::handlePortMapDnsResolve(BaseRequest *rd, bool success, const QSt
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+    curl_request->setAnswerStreamFactory([]() { return new JsonAnswerStream(); });
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1319,6 +1428,7 @@ void ServerAPI::handleCheckUpdateDnsResolve(BaseRequest *rd, bool success, const
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+    curl_request->setAnswerStreamFactory([]() { return new JsonAnswerStream(); });
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1344,15 +1454,18 @@ void ServerAPI::handleDebugLogDnsResolve(BaseRequest *rd, bool success, const QS
     QUrlQuery postData;
     postData.addQueryItem("time", strTimestamp);
     postData.addQueryItem("client_auth_hash", md5Hash);
-    QByteArray ba = crd->getLogStr().toUtf8();
-    postData.addQueryItem("logfile", ba.toBase64());
     if (!crd->getUsername().isEmpty())
         postData.addQueryItem("username", crd->getUsername());
     postData.addQueryItem("platform", Utils::getPlatformNameSafe());
     postData.addQueryItem("app_version", AppVersion::instance().semanticVersionString());
 
+    QByteArray postDataBytes = postData.toString(QUrl::FullyEncoded).toUtf8();
+    postDataBytes += '&';
+    appendLogFileField(postDataBytes, crd->getLogStr());
+    crd->releaseLogStr();
+
     auto *curl_request = crd->createCurlRequest();
-    curl_request->setPostData(postData.toString(QUrl::FullyEncoded).toUtf8());
+    curl_request->setPostData(postDataBytes);
     curl_request->setUrl(url.toString());
     submitCurlRequest(crd, CurlRequest::METHOD_POST,
         "Content-type: application/x-www-form-urlencoded", crd->getHostname(), ips);
@@ -1411,6 +1524,7 @@ void ServerAPI::handleNotificationsDnsResolve(BaseRequest *rd, bool success, con
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+    curl_request->setAnswerStreamFactory([]() { return new JsonAnswerStream(); });
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1561,6 +1675,7 @@ void ServerAPI::handleStaticIpsDnsResolve(BaseRequest *rd, bool success, const Q
 
     auto *curl_request = crd->createCurlRequest();
     curl_request->setGetData(url.toString());
+    curl_request->setAnswerStreamFactory([]() { return new JsonAnswerStream(); });
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
@@ -1585,6 +1700,24 @@ void ServerAPI::handlePingTestDnsResolve(BaseRequest *rd, bool success, const QS
     submitCurlRequest(crd, CurlRequest::METHOD_GET, QString(), crd->getHostname(), ips);
 }
 
+QByteArray ServerAPI::answerData(CurlRequest *curlRequest)
+{
+    QSharedPointer<JsonAnswerStream> stream = qSharedPointerDynamicCast<JsonAnswerStream>(curlRequest->getAnswerStream());
+    return stream ? stream->answer() : curlRequest->getAnswer();
+}
+
+QJsonDocument ServerAPI::answerJson(CurlRequest *curlRequest, const QByteArray &arr, QJsonParseError *errCode)
+{
+    // normally already parsed in the curl thread, unless the answer was replaced (the test files)
+    QSharedPointer<JsonAnswerStream> stream = qSharedPointerDynamicCast<JsonAnswerStream>(curlRequest->getAnswerStream());
+    if (stream && stream->isParsed() && stream->answer() == arr)
+    {
+        *errCode = stream->parseError();
+        return stream->document();
+    }
+    return QJsonDocument::fromJson(arr, errCode);
+}
+
 void ServerAPI::handleAccessIpsCurl(BaseRequest *rd, bool success)
 {
     const int userRole = rd->getUserRole();
@@ -1682,7 +1815,7 @@ void ServerAPI::handleSessionReplyCurl(BaseRequest *rd, bool success)
     }
     else
     {
-        QByteArray arr = curlRequest->getAnswer();
+        QByteArray arr = answerData(curlRequest);
 
 #ifdef TEST_API_FROM_FILES
         arr = SessionAndLocationsTest::instance().getSessionData();
@@ -1699,7 +1832,7 @@ void ServerAPI::handleSessionReplyCurl(BaseRequest *rd, bool success)
 #endif
 
         QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
+        QJsonDocument doc = answerJson(curlRequest, arr, &errCode);
         if (errCode.error != QJsonParseError::NoError || !doc.isObject())
         {
             if (replyType == REPLY_LOGIN)
@@ -1886,92 +2019,79 @@ void ServerAPI::handleServerLocationsCurl(BaseRequest *rd, bool success)
         const auto *crd = dynamic_cast<ServerLocationsRequest*>(rd);
         Q_ASSERT(crd);
         lastLocationsLanguage_ = crd->getLanguage();
-        QByteArray arr = curlRequest->getAnswer();
 
-#ifdef TEST_CREATE_API_FILES
-        QFile file("c:\\5\\locations.api");
-        if (file.open(QIODevice::WriteOnly))
+        if (curlRequest->isNotModified())
         {
-            file.write(arr);
+            qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, not modified (ETag matched)";
+            emit serverLocationsAnswer(SERVER_RETURN_SUCCESS, QVector<apiinfo::Location>(), QStringList(), userRole);
+            return;
         }
+
+        // normally the answer has already been parsed incrementally in the curl thread
+        QSharedPointer<LocationsJsonStreamParser> parser =
+                qSharedPointerDynamicCast<LocationsJsonStreamParser>(curlRequest->getAnswerStream());
+        if (!parser)
+        {
+            QByteArray arr = curlRequest->getAnswer();
+
+#ifdef TEST_CREATE_API_FILES
+            QFile file("c:\\5\\locations.api");
+            if (file.open(QIODevice::WriteOnly))
+            {
+                file.write(arr);
+            }
 #endif
 
 #ifdef TEST_API_FROM_FILES
-        arr = SessionAndLocationsTest::instance().getLocationsData();
+            arr = SessionAndLocationsTest::instance().getLocationsData();
 #endif
+            parser.reset(new LocationsJsonStreamParser());
+            parser->addData(arr.constData(), arr.size());
+        }
 
-        QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
-        if (errCode.error != QJsonParseError::NoError || !doc.isObject())
+        if (!parser->isCompleted())
         {
-            qCDebugMultiline(LOG_SERVER_API) << arr;
             qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json";
             emit serverLocationsAnswer(SERVER_RETURN_INCORRECT_JSON, QVector<apiinfo::Location>(), QStringList(), userRole);
             return;
         }
-        QJsonObject jsonObject = doc.object();
 
-        if (!jsonObject.contains("info"))
+        if (!parser->isInfoFound())
         {
-            qCDebugMultiline(LOG_SERVER_API) << arr;
             qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json (info field not found)";
             emit serverLocationsAnswer(SERVER_RETURN_INCORRECT_JSON, QVector<apiinfo::Location>(), QStringList(), userRole);
             return;
         }
 
-        if (!jsonObject.contains("data"))
+        if (!parser->isDataFound())
         {
-            qCDebugMultiline(LOG_SERVER_API) << arr;
             qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json (data field not found)";
             emit serverLocationsAnswer(SERVER_RETURN_INCORRECT_JSON, QVector<apiinfo::Location>(), QStringList(), userRole);
             return;
         }
         // parse revision number
-        QJsonObject jsonInfo = jsonObject["info"].toObject();
+        const QJsonObject &jsonInfo = parser->info();
         bool isChanged = jsonInfo["changed"].toInt() != 0;
         int newRevision = jsonInfo["revision"].toInt();
         QString revisionHash = jsonInfo["revision_hash"].toString();
 
+        qCDebug(LOG_SERVER_API) << "API request ServerLocations parsed" << parser->totalBytes() << "bytes in" << parser->parseTimeMs()
+                                << "ms, peak buffer size =" << parser->peakBufferSize() << "bytes";
+
         if (isChanged)
         {
             qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, revision changed =" << newRevision
                                     << ", revision_hash =" << revisionHash;
 
-            // parse locations array
-            const QJsonArray jsonData = jsonObject["data"].toArray();
-
-            QVector<apiinfo::Location> serverLocations;
-            QStringList forceDisconnectNodes;
-
-            for (int i = 0; i < jsonData.size(); ++i)
-            {
-                if (jsonData.at(i).isObject())
-                {
-                    apiinfo::Location sl;
-                    QJsonObject dataElement = jsonData.at(i).toObject();
-                    if (sl.initFromJson(dataElement, forceDisconnectNodes)) {
-                        serverLocations << sl;
-                    }
-                    else
-                    {
-                        QJsonDocument invalidData(dataElement);
-                        qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping invalid/incomplete 'data' element at index" << i
-                                                << "(" << invalidData.toJson(QJsonDocument::Compact) << ")";
-                    }
-                }
-                else {
-                    qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping non-object 'data' element at index" << i;
-                }
-            }
-
-            if (serverLocations.empty())
+            if (parser->locations().empty())
             {
-                qCDebugMultiline(LOG_SERVER_API) << arr;
                 qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json, no valid 'data' elements were found";
-                emit serverLocationsAnswer(SERVER_RETURN_INCORRECT_JSON, serverLocations, QStringList(), userRole);
+                emit serverLocationsAnswer(SERVER_RETURN_INCORRECT_JSON, parser->locations(), QStringList(), userRole);
             }
             else {
-                emit serverLocationsAnswer(SERVER_RETURN_SUCCESS, serverLocations, forceDisconnectNodes, userRole);
+                locationsEtag_ = curlRequest->getETag();
+                locationsEtagUrl_ = curlRequest->getGetData();
+                emit serverLocationsAnswer(SERVER_RETURN_SUCCESS, parser->locations(), parser->forceDisconnectNodes(), userRole);
             }
         }
         else
@@ -2107,10 +2227,10 @@ void ServerAPI::handlePortMapCurl(BaseRequest *rd, bool success)
     }
     else
     {
-        QByteArray arr = curlRequest->getAnswer();
+        QByteArray arr = answerData(curlRequest);
 
         QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
+        QJsonDocument doc = answerJson(curlRequest, arr, &errCode);
         if (errCode.error != QJsonParseError::NoError || !doc.isObject())
         {
             qCDebugMultiline(LOG_SERVER_API) << arr;
@@ -2209,10 +2329,10 @@ void ServerAPI::handleCheckUpdateCurl(BaseRequest *rd, bool success)
     }
     else
     {
-        QByteArray arr = curlRequest->getAnswer();
+        QByteArray arr = answerData(curlRequest);
 
         QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
+        QJsonDocument doc = answerJson(curlRequest, arr, &errCode);
         if (errCode.error != QJsonParseError::NoError || !doc.isObject())
         {
             qCDebugMultiline(LOG_SERVER_API) << arr;
@@ -2443,10 +2563,10 @@ void ServerAPI::handleNotificationsCurl(BaseRequest *rd, bool success)
     }
     else
     {
-        QByteArray arr = curlRequest->getAnswer();
+        QByteArray arr = answerData(curlRequest);
 
         QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
+        QJsonDocument doc = answerJson(curlRequest, arr, &errCode);
         if (errCode.error != QJsonParseError::NoError || !doc.isObject())
         {
             qCDebugMultiline(LOG_SERVER_API) << arr;
@@ -2689,10 +2809,10 @@ void ServerAPI::handleStaticIpsCurl(BaseRequest *rd, bool success)
     }
     else
     {
-        QByteArray arr = curlRequest->getAnswer();
+        QByteArray arr = answerData(curlRequest);
 
         QJsonParseError errCode;
-        QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
+        QJsonDocument doc = answerJson(curlRequest, arr, &errCode);
         if (errCode.error != QJsonParseError::NoError || !doc.isObject())
         {
             qCDebugMultiline(LOG_SERVER_API) << arr;
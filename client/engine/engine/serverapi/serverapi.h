@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QJsonDocument>
+#include <QJsonParseError>
 #include "engine/apiinfo/apiinfo.h"
 #include "engine/apiinfo/notification.h"
 #include "engine/apiinfo/portmap.h"
@@ -146,6 +148,7 @@ private:
         // if (request)
         {
             activeRequests_.push_back(request);
+            restartRequestTimer();
         }
         return request;
     }
@@ -155,6 +158,12 @@ private:
                            const QStringList &ips);
 
     void handleRequestTimeout(BaseRequest *rd);
+    // arms the timer for the earliest deadline of the active requests, or right away to delete the inactive ones
+    void restartRequestTimer();
+
+    // the answer of a request made with JsonAnswerStream is in the stream, parsed in the curl thread
+    static QByteArray answerData(CurlRequest *curlRequest);
+    static QJsonDocument answerJson(CurlRequest *curlRequest, const QByteArray &arr, QJsonParseError *errCode);
 
     void handleLoginDnsResolve(BaseRequest *rd, bool success, const QStringList &ips);
     void handleSessionDnsResolve(BaseRequest *rd, bool success, const QStringList &ips);
@@ -202,6 +211,10 @@ private:
 
     QString lastLocationsLanguage_;
 
+    // ETag of the latest full ServerLocations answer and the URL it belongs to, sent as If-None-Match on refreshes
+    QString locationsEtag_;
+    QString locationsEtagUrl_;
+
     DnsCache *dnsCache_;
 
     QString hostname_;
@@ -218,7 +231,7 @@ private:
     QMap<const CurlRequest*, BaseRequest*> curlToRequestMap_;
     HandleDnsResolveFunc handleDnsResolveFuncTable_[NUM_REPLY_TYPES];
     HandleCurlReplyFunc handleCurlReplyFuncTable_[NUM_REPLY_TYPES];
-    QTimer requestTimer_;
+    QTimer requestTimer_;   // single shot
 };
 
 #endif // SERVERAPI_H
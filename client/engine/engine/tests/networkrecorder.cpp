@@ -0,0 +1,272 @@
+#include "networkrecorder.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+#include <algorithm>
+#include <iterator>
+#include "utils/extraconfig.h"
+#include "utils/logger.h"
+
+namespace {
+
+const unsigned int RANDOM_SEED = 1;
+// the values of these keys are replaced in the recorded answers
+const char *SENSITIVE_KEYS[] = { "session_auth_hash", "client_auth_hash", "temp_session", "username", "password",
+                                 "email", "PresharedKey", "PrivateKey" };
+const char *SCRUBBED_VALUE = "scrubbed";
+
+QJsonValue scrubJson(const QJsonValue &value)
+{
+    if (value.isObject())
+    {
+        QJsonObject obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it)
+        {
+            if (std::find(std::begin(SENSITIVE_KEYS), std::end(SENSITIVE_KEYS), it.key()) != std::end(SENSITIVE_KEYS))
+            {
+                it.value() = SCRUBBED_VALUE;
+            }
+            else
+            {
+                it.value() = scrubJson(it.value());
+            }
+        }
+        return obj;
+    }
+    else if (value.isArray())
+    {
+        QJsonArray arr = value.toArray();
+        for (int i = 0; i < arr.size(); ++i)
+        {
+            arr[i] = scrubJson(arr[i]);
+        }
+        return arr;
+    }
+    return value;
+}
+
+} // namespace
+
+NetworkRecorder::NetworkRecorder() : mode_(MODE_OFF), extraLatencyMs_(0), lossPercent_(0), random_(RANDOM_SEED)
+{
+    const QString replayPath = ExtraConfig::instance().getNetworkReplayPath();
+    const QString recordPath = ExtraConfig::instance().getNetworkRecordPath();
+    if (!replayPath.isEmpty())
+    {
+        bool success;
+        const int extraLatencyMs = ExtraConfig::instance().getNetworkReplayLatency(success);
+        const int lossPercent = ExtraConfig::instance().getNetworkReplayLossPercent(success);
+        startReplay(replayPath, extraLatencyMs, lossPercent);
+    }
+    else if (!recordPath.isEmpty())
+    {
+        startRecord(recordPath);
+    }
+}
+
+bool NetworkRecorder::startRecord(const QString &path)
+{
+    QMutexLocker locker(&mutex_);
+    clear();
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qCDebug(LOG_BASIC) << "Can't open the network record file" << path;
+        return false;
+    }
+    mode_ = MODE_RECORD;
+    qCDebug(LOG_BASIC) << "Network record to" << path;
+    return true;
+}
+
+bool NetworkRecorder::startReplay(const QString &path, int extraLatencyMs, int lossPercent)
+{
+    QMutexLocker locker(&mutex_);
+    clear();
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly))
+    {
+        qCDebug(LOG_BASIC) << "Can't open the network replay file" << path;
+        return false;
+    }
+    load();
+    file_.close();
+    extraLatencyMs_ = extraLatencyMs;
+    lossPercent_ = lossPercent;
+    mode_ = MODE_REPLAY;
+    qCDebug(LOG_BASIC) << "Network replay from" << path << ": API keys" << api_.count() << ", hostnames"
+                       << dns_.count() << ", pings" << allPings_.count() << ", extra latency" << extraLatencyMs_
+                       << "ms, loss" << lossPercent_ << "%";
+    return true;
+}
+
+void NetworkRecorder::stop()
+{
+    QMutexLocker locker(&mutex_);
+    clear();
+}
+
+QString NetworkRecorder::apiKey(const QString &method, const QString &url)
+{
+    return method + " " + QUrl(url).path();
+}
+
+QByteArray NetworkRecorder::scrubApiBody(const QByteArray &body)
+{
+    const QJsonDocument doc = QJsonDocument::fromJson(body);
+    if (doc.isObject())
+    {
+        return QJsonDocument(scrubJson(doc.object()).toObject()).toJson(QJsonDocument::Compact);
+    }
+    else if (doc.isArray())
+    {
+        return QJsonDocument(scrubJson(doc.array()).toArray()).toJson(QJsonDocument::Compact);
+    }
+    return QByteArray();
+}
+
+void NetworkRecorder::recordApi(const QString &key, const ApiAnswer &answer)
+{
+    const QByteArray body = scrubApiBody(answer.body);
+    if (body.isEmpty() && !answer.body.isEmpty())
+    {
+        qCDebug(LOG_BASIC) << "Network record: the answer of" << key << "isn't JSON, not recorded";
+        return;
+    }
+
+    QJsonObject obj;
+    obj["type"] = "api";
+    obj["key"] = key;
+    obj["curlCode"] = answer.curlCode;
+    obj["httpCode"] = static_cast<int>(answer.httpCode);
+    obj["body"] = QString::fromLatin1(body.toBase64());
+    obj["ms"] = answer.timeMs;
+    writeLine(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+void NetworkRecorder::recordDns(const QString &hostname, const DnsAnswer &answer)
+{
+    QJsonObject obj;
+    obj["type"] = "dns";
+    obj["hostname"] = hostname;
+    obj["ips"] = QJsonArray::fromStringList(answer.ips);
+    obj["aresErrorCode"] = answer.aresErrorCode;
+    obj["ttl"] = answer.ttl;
+    obj["ms"] = answer.timeMs;
+    writeLine(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+void NetworkRecorder::recordPing(const QString &ip, const PingAnswer &answer)
+{
+    QJsonObject obj;
+    obj["type"] = "ping";
+    obj["ip"] = ip;
+    obj["success"] = answer.success;
+    obj["ms"] = answer.timeMs;
+    writeLine(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+template<typename T> void NetworkRecorder::simulate(T &answer)
+{
+    answer.timeMs += extraLatencyMs_;
+    answer.isLost = lossPercent_ > 0 && std::uniform_int_distribution<int>(0, 99)(random_) < lossPercent_;
+}
+
+bool NetworkRecorder::replayApi(const QString &key, ApiAnswer &outAnswer)
+{
+    QMutexLocker locker(&mutex_);
+    auto it = api_.find(key);
+    if (it == api_.end())
+    {
+        return false;
+    }
+    outAnswer = it->answers[it->next];
+    it->next = qMin(it->next + 1, it->answers.count() - 1);
+    simulate(outAnswer);
+    return true;
+}
+
+bool NetworkRecorder::replayDns(const QString &hostname, DnsAnswer &outAnswer)
+{
+    QMutexLocker locker(&mutex_);
+    auto it = dns_.find(hostname);
+    if (it == dns_.end())
+    {
+        return false;
+    }
+    outAnswer = it->answers[it->next];
+    it->next = qMin(it->next + 1, it->answers.count() - 1);
+    simulate(outAnswer);
+    return true;
+}
+
+bool NetworkRecorder::replayPing(const QString &ip, PingAnswer &outAnswer)
+{
+    QMutexLocker locker(&mutex_);
+    auto it = pings_.constFind(ip);
+    const QVector<PingAnswer> &samples = it != pings_.constEnd() ? *it : allPings_;
+    if (samples.isEmpty())
+    {
+        return false;
+    }
+    outAnswer = samples[std::uniform_int_distribution<int>(0, samples.count() - 1)(random_)];
+    simulate(outAnswer);
+    return true;
+}
+
+void NetworkRecorder::clear()
+{
+    mode_ = MODE_OFF;
+    file_.close();
+    api_.clear();
+    dns_.clear();
+    pings_.clear();
+    allPings_.clear();
+}
+
+void NetworkRecorder::load()
+{
+    while (!file_.atEnd())
+    {
+        const QJsonObject obj = QJsonDocument::fromJson(file_.readLine()).object();
+        const QString type = obj["type"].toString();
+        if (type == "api")
+        {
+            ApiAnswer answer;
+            answer.curlCode = obj["curlCode"].toInt();
+            answer.httpCode = obj["httpCode"].toInt();
+            answer.body = QByteArray::fromBase64(obj["body"].toString().toLatin1());
+            answer.timeMs = obj["ms"].toInt();
+            api_[obj["key"].toString()].answers << answer;
+        }
+        else if (type == "dns")
+        {
+            DnsAnswer answer;
+            for (const QJsonValue &ip : obj["ips"].toArray())
+            {
+                answer.ips << ip.toString();
+            }
+            answer.aresErrorCode = obj["aresErrorCode"].toInt();
+            answer.ttl = obj["ttl"].toInt();
+            answer.timeMs = obj["ms"].toInt();
+            dns_[obj["hostname"].toString()].answers << answer;
+        }
+        else if (type == "ping")
+        {
+            PingAnswer answer;
+            answer.success = obj["success"].toBool();
+            answer.timeMs = obj["ms"].toInt();
+            pings_[obj["ip"].toString()] << answer;
+            allPings_ << answer;
+        }
+    }
+}
+
+void NetworkRecorder::writeLine(const QByteArray &json)
+{
+    QMutexLocker locker(&mutex_);
+    file_.write(json + "\n");
+    file_.flush();
+}
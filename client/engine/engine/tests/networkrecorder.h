@@ -0,0 +1,111 @@
+#ifndef NETWORKRECORDER_H
+#define NETWORKRECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <random>
+
+// Record/replay of the network answers for the deterministic benchmarks of the startup, login and failover.
+// ws-network-record-file=<file> in windscribe_extra.conf appends the API answers (CurlNetworkManager), the DNS answers
+// (DnsRequest) and the ping results (PingHost) to the file, one JSON object per line, with their timing.
+// ws-network-replay-file=<file> answers from the file instead of the network, after the recorded time:
+//   API - by the method and the URL path (the query has the auth hash and the timestamps), in the recorded order
+//         per key, the last answer repeats;
+//   DNS - by the hostname, the same way;
+//   ping - a random sample of the RTTs recorded for the IP (of all the IPs, if it wasn't pinged), the seed is fixed.
+// ws-network-replay-latency-ms and ws-network-replay-loss-percent add latency and loss to the replayed answers,
+// the lost ones fail after the recorded time. The replay is off if the file can't be read.
+// The credentials (auth hashes, server credentials, WireGuard keys) are replaced in the recorded JSON answers, the
+// answers which are not JSON (the OpenVPN configs) aren't recorded. Compiled only with WINDSCRIBE_NETWORK_RECORDER
+// (the debug and the benchmark builds, see engine.pri), the hooks are under the same define.
+class NetworkRecorder
+{
+public:
+    static NetworkRecorder &instance()
+    {
+        static NetworkRecorder nr;
+        return nr;
+    }
+
+    struct ApiAnswer
+    {
+        int curlCode = 0;
+        long httpCode = 0;
+        QByteArray body;
+        int timeMs = 0;
+        bool isLost = false;
+    };
+
+    struct DnsAnswer
+    {
+        QStringList ips;
+        int aresErrorCode = 0;
+        int ttl = 0;
+        int timeMs = 0;
+        bool isLost = false;
+    };
+
+    struct PingAnswer
+    {
+        bool success = false;
+        int timeMs = 0;
+        bool isLost = false;
+    };
+
+    // instead of windscribe_extra.conf, for the benchmarks
+    bool startRecord(const QString &path);
+    bool startReplay(const QString &path, int extraLatencyMs, int lossPercent);
+    void stop();
+
+    bool isRecording() const { return mode_ == MODE_RECORD; }
+    bool isReplaying() const { return mode_ == MODE_REPLAY; }
+
+    static QString apiKey(const QString &method, const QString &url);
+    // the answer with the values of the credential keys replaced, empty if it isn't a JSON document
+    static QByteArray scrubApiBody(const QByteArray &body);
+
+    void recordApi(const QString &key, const ApiAnswer &answer);
+    void recordDns(const QString &hostname, const DnsAnswer &answer);
+    void recordPing(const QString &ip, const PingAnswer &answer);
+
+    // false if nothing was recorded for the key
+    bool replayApi(const QString &key, ApiAnswer &outAnswer);
+    bool replayDns(const QString &hostname, DnsAnswer &outAnswer);
+    bool replayPing(const QString &ip, PingAnswer &outAnswer);
+
+private:
+    NetworkRecorder();
+
+    enum MODE { MODE_OFF, MODE_RECORD, MODE_REPLAY };
+
+    template<typename T> struct Sequence
+    {
+        QVector<T> answers;
+        int next = 0;
+    };
+
+    std::atomic<MODE> mode_;
+    QMutex mutex_;
+    QFile file_;
+    int extraLatencyMs_;
+    int lossPercent_;
+    std::mt19937 random_;
+
+    QHash<QString, Sequence<ApiAnswer> > api_;
+    QHash<QString, Sequence<DnsAnswer> > dns_;
+    QHash<QString, QVector<PingAnswer> > pings_;
+    QVector<PingAnswer> allPings_;
+
+    void load();
+    void clear();
+    void writeLine(const QByteArray &json);
+    // the extra latency and the loss, under mutex_
+    template<typename T> void simulate(T &answer);
+};
+
+#endif // NETWORKRECORDER_H
@@ -14,6 +14,10 @@ const int typeIdUpdateVersionState = qRegisterMetaType<ProtoTypes::Protocol>("Pr
 const int typeIdUpdateVersionError = qRegisterMetaType<ProtoTypes::Protocol>("ProtoTypes::UpdateVersionError");
 const int typeIdUpdateChannel = qRegisterMetaType<ProtoTypes::UpdateChannel>("ProtoTypes::UpdateChannel");
 const int typeIdWebSessionPurpose = qRegisterMetaType<ProtoTypes::WebSessionPurpose>("ProtoTypes::WebSessionPurpose");
+const int typeIdThroughput = qRegisterMetaType<ProtoTypes::Throughput>("ProtoTypes::Throughput");
+const int typeIdThroughputHistory = qRegisterMetaType<ProtoTypes::ThroughputHistory>("ProtoTypes::ThroughputHistory");
+const int typeIdTunnelSpeedTestResult = qRegisterMetaType<ProtoTypes::TunnelSpeedTestResult>("ProtoTypes::TunnelSpeedTestResult");
+const int typeIdProxySharingTraffic = qRegisterMetaType<ProtoTypes::ProxySharingTraffic>("ProtoTypes::ProxySharingTraffic");
 
 QString loginRetToString(LOGIN_RET ret)
 {
@@ -143,6 +147,10 @@ QString dnsPolicyTypeToString(DNS_POLICY_TYPE d)
     {
         return "ControlD";
     }
+    else if (d == DNS_TYPE_CLOUDFLARE_DOH)
+    {
+        return "Cloudflare (DoH)";
+    }
     else
     {
         Q_ASSERT(false);
@@ -34,7 +34,7 @@ enum PROXY_SHARING_TYPE { PROXY_SHARING_HTTP, PROXY_SHARING_SOCKS };
 
 enum ORDER_LOCATIONS_TYPE { ORDER_LOCATIONS_BY_GEOGRAPHY, ORDER_LOCATIONS_BY_ALPHABETICALLY, ORDER_LOCATIONS_BY_LATENCY };
 
-enum DNS_POLICY_TYPE { DNS_TYPE_OS_DEFAULT = 0, DNS_TYPE_OPEN_DNS, DNS_TYPE_CLOUDFLARE, DNS_TYPE_GOOGLE, DNS_TYPE_CONTROLD };
+enum DNS_POLICY_TYPE { DNS_TYPE_OS_DEFAULT = 0, DNS_TYPE_OPEN_DNS, DNS_TYPE_CLOUDFLARE, DNS_TYPE_GOOGLE, DNS_TYPE_CONTROLD, DNS_TYPE_CLOUDFLARE_DOH };
 
 QString loginRetToString(LOGIN_RET ret);
 ProtoTypes::LoginError loginRetToProtobuf(LOGIN_RET ret);
@@ -1,8 +1,12 @@
 #include "connecteduserscounter.h"
 
+#include <algorithm>
+#include "utils/logger.h"
+
 ConnectedUsersCounter::ConnectedUsersCounter(QObject *parent) : QObject(parent)
 {
     lastCnt_ = 0;
+    connect(&trafficTimer_, SIGNAL(timeout()), SLOT(onTrafficTimer()));
 }
 
 void ConnectedUsersCounter::newUserConnected(const QString &hostname)
@@ -40,6 +44,9 @@ void ConnectedUsersCounter::userDiconnected(const QString &hostname)
 void ConnectedUsersCounter::reset()
 {
     connections_.clear();
+    trafficSources_.clear();
+    traffic_.clear();
+    trafficTimer_.stop();
     checkUsersCount();
 }
 
@@ -56,3 +63,87 @@ void ConnectedUsersCounter::checkUsersCount()
         emit usersCountChanged();
     }
 }
+
+void ConnectedUsersCounter::addTrafficSource(const QString &hostname, const QObject *connection, const std::function<quint64()> &bytesRelayed)
+{
+    Q_ASSERT(!trafficSources_.contains(connection));
+    trafficSources_.insert(connection, TrafficSource { hostname, bytesRelayed });
+    traffic_[hostname];
+    if (!trafficTimer_.isActive())
+    {
+        trafficTimer_.start(TRAFFIC_INTERVAL_MS);
+        sampleTimer_.start();
+        logTimer_.start();
+    }
+}
+
+void ConnectedUsersCounter::removeTrafficSource(const QObject *connection)
+{
+    auto it = trafficSources_.find(connection);
+    if (it == trafficSources_.end())
+    {
+        return;
+    }
+    traffic_[it->hostname].bytesClosed += it->bytesRelayed();
+    trafficSources_.erase(it);
+}
+
+QVector<ConnectedUsersCounter::HostTraffic> ConnectedUsersCounter::getTopTalkers(int count) const
+{
+    QVector<HostTraffic> hosts;
+    for (auto it = traffic_.constBegin(); it != traffic_.constEnd(); ++it)
+    {
+        if (it->bytesTotal > 0)
+        {
+            hosts << HostTraffic { it.key(), connections_.value(it.key()), it->bytesTotal, it->bytesPerSec };
+        }
+    }
+    std::sort(hosts.begin(), hosts.end(), [](const HostTraffic &h1, const HostTraffic &h2) {
+        return h1.bytesPerSec != h2.bytesPerSec ? h1.bytesPerSec > h2.bytesPerSec : h1.bytesTotal > h2.bytesTotal;
+    });
+    if (hosts.count() > count)
+    {
+        hosts.resize(count);
+    }
+    return hosts;
+}
+
+void ConnectedUsersCounter::onTrafficTimer()
+{
+    // the counters are summed per host here, the relays only increase their own atomic counter
+    QHash<QString, quint64> bytes;
+    for (const TrafficSource &source : qAsConst(trafficSources_))
+    {
+        bytes[source.hostname] += source.bytesRelayed();
+    }
+
+    const qint64 elapsedMs = qMax(sampleTimer_.restart(), static_cast<qint64>(1));
+    bool isChanged = false;
+    for (auto it = traffic_.begin(); it != traffic_.end(); ++it)
+    {
+        const quint64 bytesTotal = it->bytesClosed + bytes.value(it.key());
+        const quint64 bytesPerSec = (bytesTotal - qMin(bytesTotal, it->bytesTotal)) * 1000 / elapsedMs;
+        isChanged = isChanged || bytesTotal != it->bytesTotal || bytesPerSec != it->bytesPerSec;
+        it->bytesTotal = bytesTotal;
+        it->bytesPerSec = bytesPerSec;
+    }
+    if (!isChanged)
+    {
+        if (trafficSources_.isEmpty())
+        {
+            trafficTimer_.stop();
+        }
+        return;
+    }
+
+    Q_EMIT trafficChanged();
+    if (logTimer_.elapsed() >= TRAFFIC_LOG_INTERVAL_MS)
+    {
+        logTimer_.restart();
+        for (const HostTraffic &host : getTopTalkers(TOP_TALKERS_LOG_COUNT))
+        {
+            qCDebug(LOG_BASIC) << "Shared gateway client" << host.hostname << "connections:" << host.connections
+                               << "KB/s:" << host.bytesPerSec / 1024 << "total MB:" << host.bytesTotal / (1024 * 1024);
+        }
+    }
+}
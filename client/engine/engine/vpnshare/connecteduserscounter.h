@@ -2,12 +2,25 @@
 #define CONNECTEDUSERSCOUNTER_H
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
+#include <QTimer>
+#include <QVector>
+#include <functional>
 
 class ConnectedUsersCounter : public QObject
 {
     Q_OBJECT
 public:
+    struct HostTraffic
+    {
+        QString hostname;
+        int connections;
+        quint64 bytesTotal;
+        quint64 bytesPerSec;
+    };
+
     explicit ConnectedUsersCounter(QObject *parent);
     void newUserConnected(const QString &hostname);
     void userDiconnected(const QString &hostname);
@@ -15,14 +28,44 @@ public:
 
     int getConnectedUsersCount();
 
+    // the traffic of the connection is attributed to the hostname, the counter of the connection (bytesRelayed)
+    // is read every TRAFFIC_INTERVAL_MS from the thread of this object and at the removal
+    void addTrafficSource(const QString &hostname, const QObject *connection, const std::function<quint64()> &bytesRelayed);
+    void removeTrafficSource(const QObject *connection);
+    // the hosts with the most bytes per second (then the most bytes), since the start or the reset
+    QVector<HostTraffic> getTopTalkers(int count) const;
+
 signals:
     void usersCountChanged();
+    // after each sample that changed the traffic
+    void trafficChanged();
+
+private slots:
+    void onTrafficTimer();
 
 private:
     enum { MAX_NOT_ACTIVITY_TIME = 10000 };
+    enum { TRAFFIC_INTERVAL_MS = 2000, TRAFFIC_LOG_INTERVAL_MS = 60000, TOP_TALKERS_LOG_COUNT = 3 };
     QMap<QString, int> connections_;
     int lastCnt_;
 
+    struct TrafficSource
+    {
+        QString hostname;
+        std::function<quint64()> bytesRelayed;
+    };
+    struct Traffic
+    {
+        quint64 bytesClosed = 0;    // of the removed connections
+        quint64 bytesTotal = 0;
+        quint64 bytesPerSec = 0;
+    };
+    QHash<const QObject *, TrafficSource> trafficSources_;
+    QHash<QString, Traffic> traffic_;
+    QTimer trafficTimer_;
+    QElapsedTimer sampleTimer_;
+    QElapsedTimer logTimer_;
+
     void checkUsersCount();
 };
 
@@ -9,7 +9,7 @@ namespace HttpProxyServer {
 HttpProxyConnection::HttpProxyConnection(qintptr socketDescriptor, const QString &hostname, QObject *parent) : QObject(parent),
     socket_(nullptr), socketExternal_(nullptr), socketDescriptor_(socketDescriptor),
     hostname_(hostname), state_(READ_CLIENT_REQUEST), writeAllSocket_(nullptr),
-    writeAllSocketExternal_(nullptr), httpError_(), bAlreadyClosedAndEmitFinished_(false)
+    writeAllSocketExternal_(nullptr), relay_(nullptr), bytesRelayed_(0), httpError_(), bAlreadyClosedAndEmitFinished_(false)
 {
     httpError_.status = HttpProxyReply::ok;
     //qDebug() << QThread::currentThreadId();
@@ -125,6 +125,7 @@ void HttpProxyConnection::onExternalSocketConnected()
                 extraContent_.clear();
             }
             state_ = RELAY_BETWEEN_CLIENT_SERVER;
+            startRelay();
         }
         else
         {
@@ -200,6 +201,7 @@ void HttpProxyConnection::onExternalSocketReadyRead()
                 writeAllSocket_->write(QByteArray(arr.data() + parsed, remainingData));
             }
             state_ = RELAY_BETWEEN_CLIENT_SERVER;
+            startRelay();
         }
         else if (ret == TRI_FALSE)
         {
@@ -227,11 +229,44 @@ void HttpProxyConnection::onExternalSocketError(QAbstractSocket::SocketError soc
     }
 }
 
+void HttpProxyConnection::onRelayFinished()
+{
+    closeSocketsAndEmitFinished();
+}
+
+void HttpProxyConnection::startRelay()
+{
+    // the relay reads the sockets from now, the data written before by SocketWriteAll is already in the write buffers
+    // of the sockets and goes first, its tracking of bytesWritten() is stopped so it doesn't interfere with the relay
+    disconnect(socket_, SIGNAL(readyRead()), this, SLOT(onSocketReadyRead()));
+    disconnect(socketExternal_, SIGNAL(readyRead()), this, SLOT(onExternalSocketReadyRead()));
+    if (writeAllSocket_)
+    {
+        writeAllSocket_->detach();
+    }
+    if (writeAllSocketExternal_)
+    {
+        writeAllSocketExternal_->detach();
+    }
+
+    relay_ = new SocketRelay(this, socket_, socketExternal_, &bytesRelayed_);
+    connect(relay_, SIGNAL(finished()), SLOT(onRelayFinished()));
+    relay_->start();
+}
+
 void HttpProxyConnection::closeSocketsAndEmitFinished()
 {
     if (!bAlreadyClosedAndEmitFinished_)
     {
         bAlreadyClosedAndEmitFinished_ = true;
+        if (relay_)
+        {
+            relay_->close();
+            const qint64 elapsedMs = qMax(relay_->elapsedMs(), static_cast<qint64>(1));
+            qCDebug(LOG_HTTP_SERVER) << "Relay finished for" << hostname_ << "sent:" << relay_->bytesForward()
+                                     << "received:" << relay_->bytesBackward() << "bytes in" << elapsedMs << "ms,"
+                                     << (relay_->bytesForward() + relay_->bytesBackward()) * 1000 / elapsedMs / 1024 << "KB/s";
+        }
         if (socket_)
         {
             socket_->close();
@@ -7,6 +7,7 @@
 #include "httpproxywebanswerparser.h"
 #include "httpproxyreply.h"
 #include "../socketutils/socketwriteall.h"
+#include "../socketutils/socketrelay.h"
 
 namespace HttpProxyServer {
 
@@ -18,6 +19,9 @@ public:
 
     bool start(qintptr socketDescriptor);
 
+    // the bytes relayed in both directions, can be read from any thread
+    quint64 bytesRelayed() const { return bytesRelayed_; }
+
 public slots:
     void start();
     void forceClose();
@@ -36,6 +40,8 @@ private slots:
     void onExternalSocketReadyRead();
     void onExternalSocketError(QAbstractSocket::SocketError socketError);
 
+    void onRelayFinished();
+
 private:
     QTcpSocket *socket_;
     QTcpSocket *socketExternal_;
@@ -51,11 +57,14 @@ private:
 
     SocketWriteAll *writeAllSocket_;
     SocketWriteAll *writeAllSocketExternal_;
+    SocketRelay *relay_;
+    std::atomic<quint64> bytesRelayed_;
 
     QByteArray extraContent_;
     HttpProxyReply httpError_;
 
     bool bAlreadyClosedAndEmitFinished_;
+    void startRelay();
     void closeSocketsAndEmitFinished();
 };
 
@@ -2,19 +2,13 @@
 
 #include <QThread>
 #include <QTimer>
+#include "utils/logger.h"
 
 namespace HttpProxyServer {
 
 HttpProxyConnectionManager::HttpProxyConnectionManager(QObject *parent, int threadsCount, ConnectedUsersCounter *usersCounter) : QObject(parent),
-    usersCounter_(usersCounter)
+    threadPool_(new ProxyThreadPool(this, threadsCount)), usersCounter_(usersCounter)
 {
-    Q_ASSERT(threadsCount > 0);
-    for (int i = 0; i < threadsCount; i++)
-    {
-        QThread *thread = new QThread(this);
-        threads_[thread] = 0;
-        thread->start(QThread::LowPriority);
-    }
 }
 
 void HttpProxyConnectionManager::newConnection(qintptr socketDescriptor)
@@ -29,17 +23,22 @@ void HttpProxyConnectionManager::newConnection(qintptr socketDescriptor)
     getpeername(socketDescriptor, (sockaddr*)&addr, &addr_len);
     char *ip = inet_ntoa(addr.sin_addr);
     usersCounter_->newUserConnected(ip);
-    QThread *thread = getLessBusyThread();
     HttpProxyConnection *connection = new HttpProxyConnection(socketDescriptor, ip);
     connect(connection, SIGNAL(finished(QString)), SLOT(onConnectionFinished(QString)));
-    addConnectionToThread(thread, connection);
+    //qDebug() << "Connection started:" << connection;
+    Q_ASSERT(!connections_.contains(connection));
+    connections_.insert(connection);
+    const auto bytesRelayed = [connection]() { return connection->bytesRelayed(); };
+    threadPool_->addConnection(connection, bytesRelayed);
+    usersCounter_->addTrafficSource(ip, connection, bytesRelayed);
+    QTimer::singleShot(0, connection, SLOT(start()));
 
     //qDebug() << "Count of connections:" << connections_.count();
 }
 
 void HttpProxyConnectionManager::closeAllConnections()
 {
-     for(auto c : connections_.keys())
+     for(auto c : connections_)
      {
          QMetaObject::invokeMethod(c, "forceClose", Qt::QueuedConnection);
      }
@@ -47,14 +46,7 @@ void HttpProxyConnectionManager::closeAllConnections()
 
 void HttpProxyConnectionManager::stop()
 {
-    for(auto thread : threads_.keys())
-    {
-        thread->exit();
-    }
-    for(auto thread : threads_.keys())
-    {
-        thread->wait();
-    }
+    threadPool_->stop();
 }
 
 void HttpProxyConnectionManager::onConnectionFinished(const QString &hostname)
@@ -62,52 +54,25 @@ void HttpProxyConnectionManager::onConnectionFinished(const QString &hostname)
     HttpProxyConnection *connection = static_cast<HttpProxyConnection *>(sender());
     usersCounter_->userDiconnected(hostname);
     //qDebug() << "Connection finished:" << connection;
-    QMap<HttpProxyConnection *, QThread *>::iterator it = connections_.find(connection);
-    Q_ASSERT(it != connections_.end());
-
-    QMap<QThread *, quint32>::iterator itThread = threads_.find(it.value());
-    Q_ASSERT(itThread != threads_.end());
-    itThread.value()--;
-
-    it.key()->deleteLater();
-    connections_.erase(it);
+    Q_ASSERT(connections_.contains(connection));
+    threadPool_->removeConnection(connection);
+    usersCounter_->removeTrafficSource(connection);
+    connections_.remove(connection);
+    connection->deleteLater();
 
     //qDebug() << "Count of connections:" << connections_.count();
 
 }
 
-QThread *HttpProxyConnectionManager::getLessBusyThread()
-{
-    Q_ASSERT(threads_.count() > 0);
-    quint32 min = threads_.begin().value();
-    QThread *thread = threads_.begin().key();
-    for (QMap<QThread *, quint32>::iterator it = threads_.begin() + 1; it != threads_.end(); ++it)
-    {
-        if (it.value() < min)
-        {
-            min = it.value();
-            thread = it.key();
-        }
-    }
-    return thread;
-}
-
-void HttpProxyConnectionManager::addConnectionToThread(QThread *thread, HttpProxyConnection *connection)
-{
-    //qDebug() << "Connection started:" << connection;
-    connection->moveToThread(thread);
-    QTimer::singleShot(0, connection, SLOT(start()));
-    Q_ASSERT(!connections_.contains(connection));
-    connections_[connection] = thread;
-    threads_[thread]++;
-}
-
-void HttpProxyConnectionManager::dumpThreads()
+QVector<ProxyThreadPool::ThreadLoad> HttpProxyConnectionManager::dumpThreads() const
 {
-    for (QMap<QThread *, quint32>::iterator it = threads_.begin(); it != threads_.end(); ++it)
+    const QVector<ProxyThreadPool::ThreadLoad> load = threadPool_->threadsLoad();
+    for (const ProxyThreadPool::ThreadLoad &thread : load)
     {
-        qDebug() << "Thread:" << it.key() << "Value:" << it.value();
+        qCDebug(LOG_HTTP_SERVER) << "Thread:" << thread.index << "connections:" << thread.connections << "KB/s:"
+                                 << thread.bytesPerSec / 1024 << "event loop latency:" << thread.eventLoopLatencyMs << "ms";
     }
+    return load;
 }
 
 } // namespace HttpProxyServer
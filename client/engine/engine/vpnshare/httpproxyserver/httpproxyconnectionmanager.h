@@ -2,9 +2,10 @@
 #define HTTPPROXYCONNECTIONMANAGER_H
 
 #include <QObject>
-#include <QMap>
+#include <QSet>
 #include "httpproxyconnection.h"
 #include "../connecteduserscounter.h"
+#include "../socketutils/proxythreadpool.h"
 
 namespace HttpProxyServer {
 
@@ -12,6 +13,7 @@ class HttpProxyConnectionManager : public QObject
 {
     Q_OBJECT
 public:
+    // 0 threads - as many as the cores
     explicit HttpProxyConnectionManager(QObject *parent, int threadsCount, ConnectedUsersCounter *usersCounter);
 
 public:
@@ -19,17 +21,16 @@ public:
     void closeAllConnections();
     void stop();
 
+    // the load of the worker threads, also written to the log
+    QVector<ProxyThreadPool::ThreadLoad> dumpThreads() const;
+
 private slots:
     void onConnectionFinished(const QString &hostname);
 
 private:
-    QMap<QThread *, quint32> threads_;
-    QMap<HttpProxyConnection *, QThread *> connections_;
+    ProxyThreadPool *threadPool_;
+    QSet<HttpProxyConnection *> connections_;
     ConnectedUsersCounter *usersCounter_;
-
-    QThread *getLessBusyThread();
-    void addConnectionToThread(QThread *thread, HttpProxyConnection *connection);
-    void dumpThreads();
 };
 
 } // namespace HttpProxyServer
@@ -1,4 +1,5 @@
 #include "httpproxyrequestparser.h"
+#include "httpproxyscanner.h"
 
 namespace HttpProxyServer {
 
@@ -11,14 +12,25 @@ HttpProxyRequestParser::HttpProxyRequestParser() : state_(method_start)
 TRI_BOOL HttpProxyRequestParser::parse(const QByteArray &arr, quint32 &outParsed)
 {
     const char *data = arr.data();
-    for (int i = 0; i < arr.size(); ++i)
+    const int size = arr.size();
+    int i = 0;
+    while (i < size)
     {
+        // the delimiters go through the state machine, the text between them is appended at once
+        const int runLength = consumeRun(data + i, size - i);
+        if (runLength > 0)
+        {
+            i += runLength;
+            continue;
+        }
+
         TRI_BOOL res = consume(data[i]);
         if (res == TRI_TRUE || res == TRI_FALSE)
         {
             outParsed = i + 1;
             return res;
         }
+        ++i;
     }
 
     outParsed = arr.size();
@@ -289,6 +301,33 @@ TRI_BOOL HttpProxyRequestParser::consume(char input)
         }
 }
 
+int HttpProxyRequestParser::consumeRun(const char *data, int size)
+{
+    int len = 0;
+    switch (state_)
+    {
+        case method:
+            len = HttpProxyScanner::tokenLength(data, size);
+            request_.method.append(data, len);
+            break;
+        case uri:
+            len = HttpProxyScanner::nonCtlLength(data, size, true);
+            request_.uri.append(data, len);
+            break;
+        case header_name:
+            len = HttpProxyScanner::tokenLength(data, size);
+            request_.headers.back().name.append(data, len);
+            break;
+        case header_value:
+            len = HttpProxyScanner::nonCtlLength(data, size, false);
+            request_.headers.back().value.append(data, len);
+            break;
+        default:
+            break;
+    }
+    return len;
+}
+
 bool HttpProxyRequestParser::is_char(int c)
 {
     return c >= 0 && c <= 127;
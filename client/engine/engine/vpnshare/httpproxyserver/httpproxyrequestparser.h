@@ -21,6 +21,9 @@ private:
     HttpProxyRequest request_;
 
     TRI_BOOL consume(char input);
+    // appends the run of the ordinary characters of the current state at once and returns its length,
+    // 0 if the next character must go through consume()
+    int consumeRun(const char *data, int size);
 
     static bool is_char(int c);
     static bool is_ctl(int c);
@@ -0,0 +1,126 @@
+#include "httpproxyscanner.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define HTTPPROXYSCANNER_SSE2
+    #include <emmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__)
+    #define HTTPPROXYSCANNER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace HttpProxyServer {
+
+namespace {
+
+#ifdef HTTPPROXYSCANNER_SSE2
+inline int firstBitIndex(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long ind;
+    _BitScanForward(&ind, mask);
+    return static_cast<int>(ind);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+inline bool isCtl(unsigned char c)
+{
+    return c <= 31 || c == 127;
+}
+
+// the same rules as is_char, is_ctl and is_tspecial of the parsers
+struct TokenTable
+{
+    bool isToken[256];
+
+    TokenTable()
+    {
+        const char separators[] = "()<>@,;:\\\"/[]?={} \t";
+        for (int c = 0; c < 256; ++c)
+        {
+            isToken[c] = c <= 127 && !isCtl(static_cast<unsigned char>(c));
+        }
+        for (const char *p = separators; *p; ++p)
+        {
+            isToken[static_cast<unsigned char>(*p)] = false;
+        }
+    }
+};
+
+const TokenTable g_tokenTable;
+
+} // namespace
+
+int HttpProxyScanner::nonCtlLength(const char *data, int size, bool stopAtSpace)
+{
+    int i = 0;
+#if defined(HTTPPROXYSCANNER_SSE2)
+    const __m128i ctlMax = _mm_set1_epi8(31);
+    const __m128i del = _mm_set1_epi8(127);
+    const __m128i space = _mm_set1_epi8(stopAtSpace ? ' ' : 127);
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        // unsigned v <= 31 is max(v, 31) == 31
+        __m128i stop = _mm_cmpeq_epi8(_mm_max_epu8(v, ctlMax), ctlMax);
+        stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, del));
+        stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, space));
+        const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(stop));
+        if (mask != 0)
+        {
+            return i + firstBitIndex(mask);
+        }
+    }
+#elif defined(HTTPPROXYSCANNER_NEON)
+    const uint8x16_t ctlEnd = vdupq_n_u8(32);
+    const uint8x16_t del = vdupq_n_u8(127);
+    const uint8x16_t space = vdupq_n_u8(stopAtSpace ? ' ' : 127);
+    for (; i + 16 <= size; i += 16)
+    {
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+        const uint8x16_t stop = vorrq_u8(vcltq_u8(v, ctlEnd), vorrq_u8(vceqq_u8(v, del), vceqq_u8(v, space)));
+        // 4 bits per byte of the comparison result
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(stop), 4)), 0);
+        if (mask != 0)
+        {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        if (isCtl(c) || (stopAtSpace && c == ' '))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+int HttpProxyScanner::tokenLength(const char *data, int size)
+{
+    // the header names are short, a table is faster than the vector setup here
+    int i = 0;
+    while (i < size && g_tokenTable.isToken[static_cast<unsigned char>(data[i])])
+    {
+        ++i;
+    }
+    return i;
+}
+
+int HttpProxyScanner::lengthBeforeCr(const char *data, int size)
+{
+    // memchr of the C runtimes is vectorized already
+    const void *p = memchr(data, '\r', static_cast<size_t>(size));
+    return p ? static_cast<int>(static_cast<const char *>(p) - data) : size;
+}
+
+} // namespace HttpProxyServer
@@ -0,0 +1,22 @@
+#ifndef HTTPPROXYSCANNER_H
+#define HTTPPROXYSCANNER_H
+
+namespace HttpProxyServer {
+
+// Finds the ends of the runs of ordinary characters in the data for the HTTP parsers, so the parsers append a whole
+// URI, header name or value at once instead of passing it to the state machine character by character.
+// The delimiters are searched 16 bytes at a time with SSE2 or NEON when available.
+class HttpProxyScanner
+{
+public:
+    // the length of the run without control characters (0-31, 127) and, if stopAtSpace, spaces
+    static int nonCtlLength(const char *data, int size, bool stopAtSpace);
+    // the length of the run of token characters (not control characters, not separators and not 8-bit)
+    static int tokenLength(const char *data, int size);
+    // the length of the run before '\r'
+    static int lengthBeforeCr(const char *data, int size);
+};
+
+} // namespace HttpProxyServer
+
+#endif // HTTPPROXYSCANNER_H
@@ -7,7 +7,8 @@ HttpProxyServer::HttpProxyServer(QObject *parent) : QTcpServer(parent)
 {
     usersCounter_ = new ConnectedUsersCounter(this);
     connect(usersCounter_, SIGNAL(usersCountChanged()), SIGNAL(usersCountChanged()));
-    connectionManager_ = new HttpProxyConnectionManager(this, 4, usersCounter_);
+    connect(usersCounter_, SIGNAL(trafficChanged()), SIGNAL(trafficChanged()));
+    connectionManager_ = new HttpProxyConnectionManager(this, 0, usersCounter_);
 }
 
 HttpProxyServer::~HttpProxyServer()
@@ -47,6 +48,11 @@ int HttpProxyServer::getConnectedUsersCount()
     return usersCounter_->getConnectedUsersCount();
 }
 
+QVector<ConnectedUsersCounter::HostTraffic> HttpProxyServer::getTopTalkers(int count)
+{
+    return usersCounter_->getTopTalkers(count);
+}
+
 void HttpProxyServer::closeActiveConnections()
 {
     connectionManager_->closeAllConnections();
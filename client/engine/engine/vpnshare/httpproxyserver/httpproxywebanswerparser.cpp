@@ -1,4 +1,5 @@
 #include "httpproxywebanswerparser.h"
+#include "httpproxyscanner.h"
 
 namespace HttpProxyServer {
 
@@ -10,14 +11,25 @@ HttpProxyWebAnswerParser::HttpProxyWebAnswerParser() : state_(method_start)
 TRI_BOOL HttpProxyWebAnswerParser::parse(const QByteArray &arr, quint32 &outParsed)
 {
     const char *data = arr.data();
-    for (int i = 0; i < arr.size(); ++i)
+    const int size = arr.size();
+    int i = 0;
+    while (i < size)
     {
+        // the delimiters go through the state machine, the text between them is appended at once
+        const int runLength = consumeRun(data + i, size - i);
+        if (runLength > 0)
+        {
+            i += runLength;
+            continue;
+        }
+
         TRI_BOOL res = consume(data[i]);
         if (res == TRI_TRUE || res == TRI_FALSE)
         {
             outParsed = i + 1;
             return res;
         }
+        ++i;
     }
 
     outParsed = arr.size();
@@ -166,6 +178,29 @@ TRI_BOOL HttpProxyWebAnswerParser::consume(char input)
     }
 }
 
+int HttpProxyWebAnswerParser::consumeRun(const char *data, int size)
+{
+    int len = 0;
+    switch (state_)
+    {
+        case method:
+            len = HttpProxyScanner::lengthBeforeCr(data, size);
+            answer_.answer.append(data, len);
+            break;
+        case header_name:
+            len = HttpProxyScanner::tokenLength(data, size);
+            answer_.headers.back().name.append(data, len);
+            break;
+        case header_value:
+            len = HttpProxyScanner::nonCtlLength(data, size, false);
+            answer_.headers.back().value.append(data, len);
+            break;
+        default:
+            break;
+    }
+    return len;
+}
+
 bool HttpProxyWebAnswerParser::is_char(int c)
 {
     return c >= 0 && c <= 127;
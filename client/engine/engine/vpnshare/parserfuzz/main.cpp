@@ -0,0 +1,143 @@
+#include "proxyparsersfuzz.h"
+
+// Two builds of the harness for the parsers of the VPN sharing proxies:
+//  - libFuzzer (qmake CONFIG+=libfuzzer with clang): parserfuzz corpus/ -max_len=4096
+//    every input is checked with ParserFuzz::checkInput under the address sanitizer;
+//  - corpus runner (the default): parserfuzz [--iterations N] <corpus files or directories>
+//    checks the inputs the same way, then measures the throughput of each parser and the worst time per input,
+//    to compare the parsers before and after an optimization.
+
+#ifdef PARSERFUZZ_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const quint8 *data, size_t size)
+{
+    ParserFuzz::FuzzInput input;
+    if (ParserFuzz::decodeInput(data, size, input))
+    {
+        ParserFuzz::checkInput(input);
+    }
+    return 0;
+}
+
+#else
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <stdio.h>
+
+namespace {
+
+struct ParserStats
+{
+    int inputsCount;
+    qint64 bytes;           // of all the iterations
+    qint64 totalNs;
+    double worstNs;         // per parse of one input
+    QString worstInput;
+
+    ParserStats() : inputsCount(0), bytes(0), totalNs(0), worstNs(0) {}
+};
+
+QStringList corpusFiles(const QStringList &paths)
+{
+    QStringList files;
+    for (const QString &path : paths)
+    {
+        const QFileInfo fi(path);
+        if (fi.isDir())
+        {
+            for (const QFileInfo &entry : QDir(path).entryInfoList(QDir::Files, QDir::Name))
+            {
+                files << entry.filePath();
+            }
+        }
+        else
+        {
+            files << path;
+        }
+    }
+    return files;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("parserfuzz");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks and measures the parsers of the VPN sharing proxies on a corpus");
+    parser.addHelpOption();
+    const QCommandLineOption iterationsOption("iterations", "Parses of each input to measure.", "count", "1000");
+    parser.addOption(iterationsOption);
+    parser.addPositionalArgument("corpus", "Files or directories of the fuzzer inputs.");
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const QStringList files = corpusFiles(parser.positionalArguments());
+    if (files.isEmpty())
+    {
+        parser.showHelp(1);
+    }
+
+    ParserStats stats[ParserFuzz::PARSER_COUNT];
+    for (const QString &filename : files)
+    {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            fprintf(stderr, "Can't open %s\n", qPrintable(filename));
+            return 1;
+        }
+        const QByteArray arr = file.readAll();
+        ParserFuzz::FuzzInput input;
+        if (!ParserFuzz::decodeInput(reinterpret_cast<const quint8 *>(arr.constData()), arr.size(), input))
+        {
+            continue;
+        }
+        ParserFuzz::checkInput(input);
+
+        // the throughput of the parsers themselves, the data is passed at once
+        QElapsedTimer timer;
+        timer.start();
+        quint32 parsed = 0;     // keeps the calls from being optimized out
+        for (int i = 0; i < iterations; ++i)
+        {
+            parsed += ParserFuzz::parse(input.type, input.data, 0).parsed;
+        }
+        const qint64 elapsedNs = timer.nsecsElapsed();
+
+        ParserStats &s = stats[input.type];
+        s.inputsCount++;
+        s.bytes += qint64(input.data.size()) * iterations;
+        s.totalNs += elapsedNs;
+        const double ns = double(elapsedNs) / iterations;
+        if (ns > s.worstNs)
+        {
+            s.worstNs = ns;
+            s.worstInput = QFileInfo(filename).fileName() + QString(" (%1 bytes)").arg(input.data.size());
+        }
+        Q_UNUSED(parsed);
+    }
+
+    printf("%d inputs checked, %d iterations\n", files.size(), iterations);
+    for (int t = 0; t < ParserFuzz::PARSER_COUNT; ++t)
+    {
+        const ParserStats &s = stats[t];
+        if (s.inputsCount == 0)
+        {
+            continue;
+        }
+        // includes the construction of the parser and the copies of the extracted fields
+        printf("%s: %d inputs, %.1f MB/s, worst %.0f ns per input: %s\n",
+               ParserFuzz::parserName(static_cast<ParserFuzz::PARSER_TYPE>(t)), s.inputsCount,
+               s.totalNs > 0 ? s.bytes * 1000.0 / s.totalNs : 0.0, s.worstNs, qPrintable(s.worstInput));
+    }
+    return 0;
+}
+
+#endif // PARSERFUZZ_LIBFUZZER
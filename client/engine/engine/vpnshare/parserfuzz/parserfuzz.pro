@@ -0,0 +1,43 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+QT += core
+QT -= gui
+TARGET = parserfuzz
+
+BUILD_LIBS_PATH = $$PWD/../../../../../build-libs
+
+# the parsers of the proxy servers include utils/boost_includes.h
+INCLUDEPATH += $$PWD/../../.. \
+               $$BUILD_LIBS_PATH/boost/include
+
+win32 {
+    DEFINES += "WINVER=0x0601"
+    DEFINES += "_WIN32_WINNT=0x0601"
+    LIBS += Ws2_32.lib
+}
+
+# qmake CONFIG+=libfuzzer QMAKE_CXX=clang++ QMAKE_LINK=clang++
+libfuzzer {
+    DEFINES += PARSERFUZZ_LIBFUZZER
+    QMAKE_CXXFLAGS += -fsanitize=fuzzer,address -g
+    QMAKE_LFLAGS += -fsanitize=fuzzer,address
+}
+
+SOURCES += \
+        main.cpp \
+        proxyparsersfuzz.cpp \
+        ../httpproxyserver/httpproxyrequestparser.cpp \
+        ../httpproxyserver/httpproxyscanner.cpp \
+        ../httpproxyserver/httpproxywebanswerparser.cpp \
+        ../socksproxyserver/socksproxycommandparser.cpp \
+        ../socksproxyserver/socksproxyidentreqparser.cpp
+
+HEADERS += \
+        proxyparsersfuzz.h \
+        ../httpproxyserver/httpproxyrequestparser.h \
+        ../httpproxyserver/httpproxyscanner.h \
+        ../httpproxyserver/httpproxywebanswerparser.h \
+        ../socksproxyserver/socksproxycommandparser.h \
+        ../socksproxyserver/socksproxyidentreqparser.h
@@ -0,0 +1,154 @@
+#include "proxyparsersfuzz.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../httpproxyserver/httpproxyrequestparser.h"
+#include "../httpproxyserver/httpproxywebanswerparser.h"
+#include "../socksproxyserver/socksproxycommandparser.h"
+#include "../socksproxyserver/socksproxyidentreqparser.h"
+
+namespace ParserFuzz {
+
+namespace {
+
+void appendHeaders(const QVector<HttpProxyServer::HttpProxyHeader> &headers, std::string &out)
+{
+    for (const HttpProxyServer::HttpProxyHeader &header : headers)
+    {
+        out += '\n';
+        out += header.name;
+        out += ": ";
+        out += header.value;
+    }
+}
+
+// feeds the data in chunks until the parser returns a result other than TRI_INDETERMINATE, like the connections do
+template<typename PARSE_FUNC>
+int parseChunks(const QByteArray &data, int chunkSize, quint32 &outParsed, PARSE_FUNC parseFunc)
+{
+    const int step = chunkSize > 0 ? chunkSize : qMax(data.size(), 1);
+    outParsed = 0;
+    for (int offs = 0; offs < data.size(); offs += step)
+    {
+        const QByteArray chunk = QByteArray::fromRawData(data.constData() + offs, qMin(step, data.size() - offs));
+        quint32 parsed = 0;
+        const int res = parseFunc(chunk, parsed);
+        if (parsed > quint32(chunk.size()))
+        {
+            fprintf(stderr, "the parser consumed %u bytes of %d\n", parsed, chunk.size());
+            abort();
+        }
+        outParsed += parsed;
+        if (res != HttpProxyServer::TRI_INDETERMINATE)
+        {
+            return res;
+        }
+    }
+    return HttpProxyServer::TRI_INDETERMINATE;
+}
+
+} // namespace
+
+const char *parserName(PARSER_TYPE type)
+{
+    switch (type)
+    {
+        case PARSER_HTTP_REQUEST:
+            return "HttpProxyRequestParser";
+        case PARSER_HTTP_WEB_ANSWER:
+            return "HttpProxyWebAnswerParser";
+        case PARSER_SOCKS_COMMAND:
+            return "SocksProxyCommandParser";
+        case PARSER_SOCKS_IDENT_REQ:
+            return "SocksProxyIdentReqParser";
+        default:
+            return "unknown";
+    }
+}
+
+ParseResult parse(PARSER_TYPE type, const QByteArray &data, int chunkSize)
+{
+    // the enums of the HTTP and SOCKS parsers have the same values
+    static_assert(int(HttpProxyServer::TRI_INDETERMINATE) == int(SocksProxyServer::TRI_INDETERMINATE),
+                  "TRI_BOOL values differ");
+
+    ParseResult r;
+    if (type == PARSER_HTTP_REQUEST)
+    {
+        HttpProxyServer::HttpProxyRequestParser parser;
+        r.result = parseChunks(data, chunkSize, r.parsed, [&parser](const QByteArray &arr, quint32 &parsed)
+        {
+            return static_cast<int>(parser.parse(arr, parsed));
+        });
+        const HttpProxyServer::HttpProxyRequest &request = parser.getRequest();
+        r.fields = request.method + ' ' + request.uri + ' ' + std::to_string(request.http_version_major) + '.' +
+                   std::to_string(request.http_version_minor);
+        appendHeaders(request.headers, r.fields);
+    }
+    else if (type == PARSER_HTTP_WEB_ANSWER)
+    {
+        HttpProxyServer::HttpProxyWebAnswerParser parser;
+        r.result = parseChunks(data, chunkSize, r.parsed, [&parser](const QByteArray &arr, quint32 &parsed)
+        {
+            return static_cast<int>(parser.parse(arr, parsed));
+        });
+        r.fields = parser.getAnswer().answer;
+        appendHeaders(parser.getAnswer().headers, r.fields);
+    }
+    else if (type == PARSER_SOCKS_COMMAND)
+    {
+        SocksProxyServer::SocksProxyCommandParser parser;
+        r.result = parseChunks(data, chunkSize, r.parsed, [&parser](const QByteArray &arr, quint32 &parsed)
+        {
+            return static_cast<int>(parser.parse(arr, parsed));
+        });
+        // the structure is zeroed by the parser, so the padding bytes compare too
+        r.fields.assign(reinterpret_cast<const char *>(&parser.cmd()), sizeof(SocksProxyServer::socks5_req));
+    }
+    else
+    {
+        SocksProxyServer::SocksProxyIdentReqParser parser;
+        r.result = parseChunks(data, chunkSize, r.parsed, [&parser](const QByteArray &arr, quint32 &parsed)
+        {
+            return parser.parse(arr, parsed) ? static_cast<int>(HttpProxyServer::TRI_TRUE)
+                                             : static_cast<int>(HttpProxyServer::TRI_INDETERMINATE);
+        });
+        r.fields.assign(reinterpret_cast<const char *>(&parser.identReq()), sizeof(SocksProxyServer::socks5_ident_req));
+    }
+    return r;
+}
+
+bool decodeInput(const quint8 *input, size_t size, FuzzInput &outInput)
+{
+    if (size < 1)
+    {
+        return false;
+    }
+    outInput.type = static_cast<PARSER_TYPE>(input[0] & 0x03);
+    outInput.chunkSize = input[0] >> 2;
+    outInput.data = QByteArray(reinterpret_cast<const char *>(input + 1), static_cast<int>(size - 1));
+    return true;
+}
+
+void checkInput(const FuzzInput &input)
+{
+    const ParseResult whole = parse(input.type, input.data, 0);
+    if (whole.parsed > quint32(input.data.size()))
+    {
+        fprintf(stderr, "%s consumed %u bytes of %d\n", parserName(input.type), whole.parsed, input.data.size());
+        abort();
+    }
+
+    const int chunkSizes[] = { input.chunkSize, 1 };
+    for (int chunkSize : chunkSizes)
+    {
+        if (chunkSize > 0 && !(parse(input.type, input.data, chunkSize) == whole))
+        {
+            fprintf(stderr, "%s: the result for the chunks of %d bytes differs from the result for the whole data\n",
+                    parserName(input.type), chunkSize);
+            abort();
+        }
+    }
+}
+
+} // namespace ParserFuzz
@@ -0,0 +1,46 @@
+#ifndef PARSERFUZZ_PROXYPARSERSFUZZ_H
+#define PARSERFUZZ_PROXYPARSERSFUZZ_H
+
+#include <QByteArray>
+#include <string>
+
+namespace ParserFuzz {
+
+enum PARSER_TYPE { PARSER_HTTP_REQUEST, PARSER_HTTP_WEB_ANSWER, PARSER_SOCKS_COMMAND, PARSER_SOCKS_IDENT_REQ, PARSER_COUNT };
+
+const char *parserName(PARSER_TYPE type);
+
+// The result of the parsing and everything the parser extracted, to compare the runs of the parsers
+struct ParseResult
+{
+    int result;             // TRI_BOOL of the parser, the ident request parser returns TRI_TRUE or TRI_INDETERMINATE
+    quint32 parsed;         // consumed bytes in total
+    std::string fields;
+
+    bool operator==(const ParseResult &other) const
+    {
+        return result == other.result && parsed == other.parsed && fields == other.fields;
+    }
+};
+
+// chunkSize == 0 passes the data to the parser at once, otherwise in chunks as they come from the socket
+ParseResult parse(PARSER_TYPE type, const QByteArray &data, int chunkSize);
+
+// The fuzzer input: the low 2 bits of the first byte select the parser, the rest bits are the chunk size
+// (0 is the whole data), the following bytes are the data to parse.
+struct FuzzInput
+{
+    PARSER_TYPE type;
+    int chunkSize;
+    QByteArray data;
+};
+
+bool decodeInput(const quint8 *input, size_t size, FuzzInput &outInput);
+
+// Parses the data at once, in the chunks of the input and byte by byte. Aborts if the results differ
+// or the parser reports more bytes than it was given; the sanitizers of the fuzzer build catch the rest.
+void checkInput(const FuzzInput &input);
+
+} // namespace ParserFuzz
+
+#endif // PARSERFUZZ_PROXYPARSERSFUZZ_H
@@ -0,0 +1,35 @@
+#include "echoserver.h"
+
+#include <QTcpSocket>
+
+namespace ProxyLoadTest {
+
+EchoServer::EchoServer(QObject *parent) : QTcpServer(parent)
+{
+    setMaxPendingConnections(1000);
+}
+
+bool EchoServer::start()
+{
+    return listen(QHostAddress::LocalHost, 0);
+}
+
+void EchoServer::incomingConnection(qintptr socketDescriptor)
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor))
+    {
+        delete socket;
+        return;
+    }
+    connect(socket, SIGNAL(readyRead()), SLOT(onSocketReadyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+}
+
+void EchoServer::onSocketReadyRead()
+{
+    QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+    socket->write(socket->readAll());
+}
+
+} // namespace ProxyLoadTest
@@ -0,0 +1,28 @@
+#ifndef PROXYLOADTEST_ECHOSERVER_H
+#define PROXYLOADTEST_ECHOSERVER_H
+
+#include <QTcpServer>
+
+namespace ProxyLoadTest {
+
+// The destination of the tunnels: sends back everything it receives. Runs in its own thread, so the load generator
+// measures the proxy and not the echo side.
+class EchoServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit EchoServer(QObject *parent = nullptr);
+
+public slots:
+    bool start();
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private slots:
+    void onSocketReadyRead();
+};
+
+} // namespace ProxyLoadTest
+
+#endif // PROXYLOADTEST_ECHOSERVER_H
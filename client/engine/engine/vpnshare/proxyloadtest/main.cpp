@@ -0,0 +1,96 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+#include <stdio.h>
+#include "echoserver.h"
+#include "proxyloadgenerator.h"
+
+// Load generator for the proxies of the VPN sharing (HttpProxyServer and SocksProxyServer). The tunnels are opened
+// to the echo server of the tool, so the proxy must run on this machine, e.g.:
+//   proxyloadtest --type socks --proxy 127.0.0.1:1080 --sessions 10000 --concurrency 2000 --pid <engine pid>
+// Thousands of concurrent sessions may need a larger limit of the open files (ulimit -n).
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("proxyloadtest");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic load for the VPN sharing HTTP and SOCKS5 proxies");
+    parser.addHelpOption();
+    const QCommandLineOption typeOption("type", "Proxy type: http or socks.", "type", "http");
+    const QCommandLineOption proxyOption("proxy", "Address of the proxy.", "host:port");
+    const QCommandLineOption sessionsOption("sessions", "Sessions in total.", "count", "1000");
+    const QCommandLineOption concurrencyOption("concurrency", "Sessions open at once.", "count", "100");
+    const QCommandLineOption payloadOption("payload", "Bytes sent and echoed in each session.", "bytes", "65536");
+    const QCommandLineOption timeoutOption("timeout", "Timeout of a session.", "ms", "30000");
+    const QCommandLineOption pidOption("pid", "Process of the proxy (the engine), to measure its CPU.", "pid");
+    parser.addOptions({ typeOption, proxyOption, sessionsOption, concurrencyOption, payloadOption, timeoutOption, pidOption });
+    parser.process(app);
+
+    ProxyLoadTest::LoadParameters params;
+    const QString type = parser.value(typeOption);
+    if (type == "http")
+    {
+        params.type = ProxyLoadTest::PROXY_HTTP;
+    }
+    else if (type == "socks")
+    {
+        params.type = ProxyLoadTest::PROXY_SOCKS;
+    }
+    else
+    {
+        fprintf(stderr, "Unknown proxy type: %s\n", qPrintable(type));
+        return 1;
+    }
+
+    const QStringList proxy = parser.value(proxyOption).split(':');
+    if (proxy.size() != 2 || !params.proxyAddress.setAddress(proxy[0]) || proxy[1].toUShort() == 0)
+    {
+        fprintf(stderr, "The proxy address must be set as ip:port\n");
+        parser.showHelp(1);
+    }
+    params.proxyPort = proxy[1].toUShort();
+    params.sessionsCount = qMax(1, parser.value(sessionsOption).toInt());
+    params.concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+    params.payloadSize = qMax(0, parser.value(payloadOption).toInt());
+    params.timeoutMs = qMax(1, parser.value(timeoutOption).toInt());
+    params.proxyPid = parser.value(pidOption).toLongLong();
+
+    QThread echoThread;
+    ProxyLoadTest::EchoServer *echoServer = new ProxyLoadTest::EchoServer();
+    echoServer->moveToThread(&echoThread);
+    QObject::connect(&echoThread, SIGNAL(finished()), echoServer, SLOT(deleteLater()));
+    echoThread.start();
+
+    bool isEchoStarted = false;
+    QMetaObject::invokeMethod(echoServer, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, isEchoStarted));
+    if (!isEchoStarted)
+    {
+        fprintf(stderr, "Can't start the echo server\n");
+        echoThread.quit();
+        echoThread.wait();
+        return 1;
+    }
+    params.targetPort = echoServer->serverPort();
+
+    QString error;
+    if (!ProxyLoadTest::ProxyLoadSession::validateRequests(params.targetPort, error))
+    {
+        fprintf(stderr, "%s\n", qPrintable(error));
+        echoThread.quit();
+        echoThread.wait();
+        return 1;
+    }
+
+    ProxyLoadTest::ProxyLoadGenerator generator(nullptr, params);
+    QObject::connect(&generator, SIGNAL(finished()), &app, SLOT(quit()));
+    generator.start();
+    app.exec();
+
+    echoThread.quit();
+    echoThread.wait();
+
+    printf("%s", qPrintable(generator.report()));
+    return 0;
+}
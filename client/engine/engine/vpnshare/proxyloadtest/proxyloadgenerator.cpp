@@ -0,0 +1,184 @@
+#include "proxyloadgenerator.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+#elif defined(Q_OS_MAC)
+    #include <libproc.h>
+    #include <mach/mach_time.h>
+#elif defined(Q_OS_LINUX)
+    #include <unistd.h>
+#endif
+
+namespace ProxyLoadTest {
+
+ProxyLoadGenerator::ProxyLoadGenerator(QObject *parent, const LoadParameters &params) : QObject(parent),
+    params_(params), startedCount_(0), finishedCount_(0), failedCount_(0), peakActiveCount_(0), totalBytes_(0),
+    elapsedMs_(0), startCpuMs_(-1), endCpuMs_(-1)
+{
+    payload_.resize(params_.payloadSize);
+    for (int i = 0; i < payload_.size(); ++i)
+    {
+        payload_[i] = static_cast<char>(i * 31 + 7);
+    }
+    tunnelMs_.reserve(params_.sessionsCount);
+    echoMs_.reserve(params_.sessionsCount);
+}
+
+void ProxyLoadGenerator::start()
+{
+    if (params_.proxyPid != 0)
+    {
+        startCpuMs_ = processCpuTimeMs(params_.proxyPid);
+    }
+    elapsedTimer_.start();
+    while (startedCount_ < params_.sessionsCount && startedCount_ - finishedCount_ < params_.concurrency)
+    {
+        startSession();
+    }
+}
+
+QString ProxyLoadGenerator::report() const
+{
+    QString str;
+    QTextStream out(&str);
+    const double seconds = qMax<qint64>(elapsedMs_, 1) / 1000.0;
+    const int succeededCount = finishedCount_ - failedCount_;
+
+    out << (params_.type == PROXY_HTTP ? "HTTP" : "SOCKS5") << " proxy " << params_.proxyAddress.toString() << ":"
+        << params_.proxyPort << ", " << params_.sessionsCount << " sessions, " << params_.concurrency
+        << " concurrent, payload " << params_.payloadSize << " bytes\n";
+    out << "sessions: " << succeededCount << " succeeded, " << failedCount_ << " failed, peak " << peakActiveCount_
+        << " open at once, " << elapsedMs_ << " ms\n";
+    out << "connections per second: " << QString::number(succeededCount / seconds, 'f', 1) << "\n";
+    out << "throughput: " << QString::number(totalBytes_ / seconds / (1024 * 1024), 'f', 2) << " MiB/s\n";
+    out << "tunnel setup latency: p50 " << QString::number(percentile(tunnelMs_, 0.5), 'f', 2) << " ms, p99 "
+        << QString::number(percentile(tunnelMs_, 0.99), 'f', 2) << " ms\n";
+    out << "payload echo latency: p50 " << QString::number(percentile(echoMs_, 0.5), 'f', 2) << " ms, p99 "
+        << QString::number(percentile(echoMs_, 0.99), 'f', 2) << " ms\n";
+    if (params_.proxyPid != 0)
+    {
+        if (startCpuMs_ >= 0 && endCpuMs_ >= 0)
+        {
+            // 100% is one core
+            out << "proxy process CPU: " << (endCpuMs_ - startCpuMs_) << " ms, "
+                << QString::number((endCpuMs_ - startCpuMs_) * 100.0 / qMax<qint64>(elapsedMs_, 1), 'f', 1) << "%\n";
+        }
+        else
+        {
+            out << "proxy process CPU: can't read the times of the process " << params_.proxyPid << "\n";
+        }
+    }
+    for (auto it = errors_.cbegin(); it != errors_.cend(); ++it)
+    {
+        out << "error \"" << it.key() << "\": " << it.value() << "\n";
+    }
+    return str;
+}
+
+void ProxyLoadGenerator::onSessionFinished(bool success, const QString &error, double tunnelMs, double echoMs, qint64 bytes)
+{
+    sender()->deleteLater();
+    finishedCount_++;
+    if (success)
+    {
+        tunnelMs_ << tunnelMs;
+        echoMs_ << echoMs;
+        totalBytes_ += bytes;
+    }
+    else
+    {
+        failedCount_++;
+        errors_[error]++;
+    }
+
+    if (startedCount_ < params_.sessionsCount)
+    {
+        startSession();
+    }
+    else if (finishedCount_ == params_.sessionsCount)
+    {
+        elapsedMs_ = elapsedTimer_.elapsed();
+        if (params_.proxyPid != 0)
+        {
+            endCpuMs_ = processCpuTimeMs(params_.proxyPid);
+        }
+        emit finished();
+    }
+}
+
+void ProxyLoadGenerator::startSession()
+{
+    ProxyLoadSession *session = new ProxyLoadSession(this, params_.type, params_.proxyAddress, params_.proxyPort,
+                                                     params_.targetPort, payload_, params_.timeoutMs);
+    connect(session, SIGNAL(finished(bool, QString, double, double, qint64)),
+            SLOT(onSessionFinished(bool, QString, double, double, qint64)));
+    startedCount_++;
+    peakActiveCount_ = qMax(peakActiveCount_, startedCount_ - finishedCount_);
+    session->start();
+}
+
+double ProxyLoadGenerator::percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty())
+    {
+        return 0;
+    }
+    const int ind = qMin(values.size() - 1, static_cast<int>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + ind, values.end());
+    return values[ind];
+}
+
+qint64 ProxyLoadGenerator::processCpuTimeMs(qint64 pid)
+{
+#ifdef Q_OS_WIN
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (hProcess == NULL)
+    {
+        return -1;
+    }
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    const BOOL ret = GetProcessTimes(hProcess, &creationTime, &exitTime, &kernelTime, &userTime);
+    CloseHandle(hProcess);
+    if (!ret)
+    {
+        return -1;
+    }
+    const quint64 kernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    const quint64 user = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return static_cast<qint64>((kernel + user) / 10000);     // 100 ns units
+#elif defined(Q_OS_MAC)
+    struct proc_taskinfo taskInfo;
+    if (proc_pidinfo(static_cast<int>(pid), PROC_PIDTASKINFO, 0, &taskInfo, sizeof(taskInfo)) != sizeof(taskInfo))
+    {
+        return -1;
+    }
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    const quint64 ticks = taskInfo.pti_total_user + taskInfo.pti_total_system;
+    return static_cast<qint64>(ticks * timebase.numer / timebase.denom / 1000000);
+#elif defined(Q_OS_LINUX)
+    QFile file(QString("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+    // the fields after the command name (which may contain spaces), utime and stime are the 14th and 15th fields
+    const QByteArray stat = file.readAll();
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13)
+    {
+        return -1;
+    }
+    const qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong();
+    return ticks * 1000 / sysconf(_SC_CLK_TCK);
+#else
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
+} // namespace ProxyLoadTest
@@ -0,0 +1,70 @@
+#ifndef PROXYLOADTEST_PROXYLOADGENERATOR_H
+#define PROXYLOADTEST_PROXYLOADGENERATOR_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QVector>
+#include "proxyloadsession.h"
+
+namespace ProxyLoadTest {
+
+struct LoadParameters
+{
+    PROXY_TYPE type;
+    QHostAddress proxyAddress;
+    quint16 proxyPort;
+    quint16 targetPort;
+    int sessionsCount;          // in total
+    int concurrency;            // sessions open at once
+    int payloadSize;
+    int timeoutMs;
+    qint64 proxyPid;            // 0 if the CPU of the proxy process is not measured
+
+    LoadParameters() : type(PROXY_HTTP), proxyPort(0), targetPort(0), sessionsCount(1000), concurrency(100),
+        payloadSize(64 * 1024), timeoutMs(30000), proxyPid(0) {}
+};
+
+// Keeps the given number of ProxyLoadSession open until all the sessions are done, then emits the report.
+class ProxyLoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProxyLoadGenerator(QObject *parent, const LoadParameters &params);
+
+    void start();
+    QString report() const;
+
+signals:
+    void finished();
+
+private slots:
+    void onSessionFinished(bool success, const QString &error, double tunnelMs, double echoMs, qint64 bytes);
+
+private:
+    LoadParameters params_;
+    QByteArray payload_;
+
+    int startedCount_;
+    int finishedCount_;
+    int failedCount_;
+    int peakActiveCount_;
+    qint64 totalBytes_;
+    QVector<double> tunnelMs_;
+    QVector<double> echoMs_;
+    QMap<QString, int> errors_;
+
+    QElapsedTimer elapsedTimer_;
+    qint64 elapsedMs_;
+    qint64 startCpuMs_;
+    qint64 endCpuMs_;
+
+    void startSession();
+
+    static double percentile(QVector<double> values, double p);
+    // the user + kernel time of the process, -1 if it can't be read
+    static qint64 processCpuTimeMs(qint64 pid);
+};
+
+} // namespace ProxyLoadTest
+
+#endif // PROXYLOADTEST_PROXYLOADGENERATOR_H
@@ -0,0 +1,199 @@
+#include "proxyloadsession.h"
+
+#include "../httpproxyserver/httpproxyrequestparser.h"
+
+namespace ProxyLoadTest {
+
+ProxyLoadSession::ProxyLoadSession(QObject *parent, PROXY_TYPE type, const QHostAddress &proxyAddress, quint16 proxyPort,
+                                   quint16 targetPort, const QByteArray &payload, int timeoutMs) : QObject(parent),
+    type_(type), proxyAddress_(proxyAddress), proxyPort_(proxyPort), targetPort_(targetPort), payload_(payload),
+    state_(STATE_CONNECTING), tunnelNs_(0), echoedBytes_(0)
+{
+    connect(&socket_, SIGNAL(connected()), SLOT(onSocketConnected()));
+    connect(&socket_, SIGNAL(readyRead()), SLOT(onSocketReadyRead()));
+    connect(&socket_, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(onSocketError(QAbstractSocket::SocketError)));
+    timeoutTimer_.setSingleShot(true);
+    timeoutTimer_.setInterval(timeoutMs);
+    connect(&timeoutTimer_, SIGNAL(timeout()), SLOT(onTimeout()));
+}
+
+void ProxyLoadSession::start()
+{
+    elapsedTimer_.start();
+    timeoutTimer_.start();
+    socket_.connectToHost(proxyAddress_, proxyPort_);
+}
+
+QByteArray ProxyLoadSession::httpConnectRequest(quint16 targetPort)
+{
+    const QByteArray target = "127.0.0.1:" + QByteArray::number(targetPort);
+    return "CONNECT " + target + " HTTP/1.1\r\nHost: " + target + "\r\n\r\n";
+}
+
+QByteArray ProxyLoadSession::socksConnectRequest(quint16 targetPort)
+{
+    // version 5, CONNECT, reserved, IPv4 127.0.0.1, port in network order
+    const char req[] = { 0x05, 0x01, 0x00, 0x01, 0x7F, 0x00, 0x00, 0x01,
+                         static_cast<char>(targetPort >> 8), static_cast<char>(targetPort & 0xFF) };
+    return QByteArray(req, sizeof(req));
+}
+
+bool ProxyLoadSession::validateRequests(quint16 targetPort, QString &outError)
+{
+    const QByteArray httpRequest = httpConnectRequest(targetPort);
+    HttpProxyServer::HttpProxyRequestParser httpParser;
+    quint32 parsed;
+    if (httpParser.parse(httpRequest, parsed) != HttpProxyServer::TRI_TRUE || parsed != quint32(httpRequest.size()) ||
+        httpParser.getRequest().method != "CONNECT" ||
+        httpParser.getRequest().uri != "127.0.0.1:" + std::to_string(targetPort))
+    {
+        outError = "the HTTP CONNECT request is not accepted by HttpProxyRequestParser";
+        return false;
+    }
+
+    const QByteArray socksRequest = socksConnectRequest(targetPort);
+    SocksProxyServer::SocksProxyCommandParser socksParser;
+    if (socksParser.parse(socksRequest, parsed) != SocksProxyServer::TRI_TRUE || parsed != quint32(socksRequest.size()) ||
+        socksParser.cmd().Version != 0x05 || socksParser.cmd().Cmd != 0x01 || socksParser.cmd().AddrType != 0x01 ||
+        socksParser.cmd().DestPort != targetPort)
+    {
+        outError = "the SOCKS5 CONNECT request is not accepted by SocksProxyCommandParser";
+        return false;
+    }
+    return true;
+}
+
+void ProxyLoadSession::onSocketConnected()
+{
+    socket_.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    if (type_ == PROXY_HTTP)
+    {
+        state_ = STATE_HTTP_CONNECT;
+        socket_.write(httpConnectRequest(targetPort_));
+    }
+    else
+    {
+        // version 5, one method: no authentication
+        const char identReq[] = { 0x05, 0x01, 0x00 };
+        state_ = STATE_SOCKS_METHOD;
+        socket_.write(identReq, sizeof(identReq));
+    }
+}
+
+void ProxyLoadSession::onSocketReadyRead()
+{
+    if (state_ == STATE_ECHO)
+    {
+        processEcho(socket_.readAll().size());
+        return;
+    }
+
+    readBuf_ += socket_.readAll();
+    quint32 parsed = 0;
+    if (state_ == STATE_HTTP_CONNECT)
+    {
+        const HttpProxyServer::TRI_BOOL res = httpAnswerParser_.parse(readBuf_, parsed);
+        if (res == HttpProxyServer::TRI_TRUE)
+        {
+            // "HTTP/1.x 200 ..."
+            const std::string &answer = httpAnswerParser_.getAnswer().answer;
+            if (answer.compare(0, 5, "HTTP/") != 0 || answer.find(" 200") == std::string::npos)
+            {
+                finish(false, "the proxy answered: " + QString::fromStdString(answer));
+                return;
+            }
+            onTunnelEstablished(readBuf_.mid(parsed));
+        }
+        else if (res == HttpProxyServer::TRI_FALSE)
+        {
+            finish(false, "malformed answer to HTTP CONNECT");
+        }
+        else
+        {
+            readBuf_.clear();   // consumed by the parser
+        }
+    }
+    else if (state_ == STATE_SOCKS_METHOD)
+    {
+        if (readBuf_.size() < 2)
+        {
+            return;
+        }
+        if (readBuf_[0] != 0x05 || readBuf_[1] != 0x00)
+        {
+            finish(false, "the SOCKS5 proxy rejected the method without authentication");
+            return;
+        }
+        readBuf_.remove(0, 2);
+        state_ = STATE_SOCKS_CONNECT;
+        socket_.write(socksConnectRequest(targetPort_));
+    }
+    else if (state_ == STATE_SOCKS_CONNECT)
+    {
+        // the reply has the same layout as the request, the Cmd field holds the reply code
+        const SocksProxyServer::TRI_BOOL res = socksReplyParser_.parse(readBuf_, parsed);
+        if (res == SocksProxyServer::TRI_TRUE)
+        {
+            if (socksReplyParser_.cmd().Version != 0x05 || socksReplyParser_.cmd().Cmd != 0x00)
+            {
+                finish(false, QString("the SOCKS5 proxy answered with the code %1").arg(socksReplyParser_.cmd().Cmd));
+                return;
+            }
+            onTunnelEstablished(readBuf_.mid(parsed));
+        }
+        else if (res == SocksProxyServer::TRI_FALSE)
+        {
+            finish(false, "malformed answer to SOCKS5 CONNECT");
+        }
+        else
+        {
+            readBuf_.clear();
+        }
+    }
+}
+
+void ProxyLoadSession::onSocketError(QAbstractSocket::SocketError /*socketError*/)
+{
+    finish(false, socket_.errorString());
+}
+
+void ProxyLoadSession::onTimeout()
+{
+    finish(false, "timeout");
+}
+
+void ProxyLoadSession::onTunnelEstablished(const QByteArray &extraData)
+{
+    tunnelNs_ = elapsedTimer_.nsecsElapsed();
+    state_ = STATE_ECHO;
+    readBuf_.clear();
+    socket_.write(payload_);
+    processEcho(extraData.size());
+}
+
+void ProxyLoadSession::processEcho(qint64 bytes)
+{
+    echoedBytes_ += bytes;
+    if (echoedBytes_ >= payload_.size())
+    {
+        finish(echoedBytes_ == payload_.size(), echoedBytes_ == payload_.size() ? QString() : "the echo is longer than the payload");
+    }
+}
+
+void ProxyLoadSession::finish(bool success, const QString &error)
+{
+    if (state_ == STATE_FINISHED)
+    {
+        return;
+    }
+    const bool isTunnelEstablished = (state_ == STATE_ECHO);
+    state_ = STATE_FINISHED;
+    timeoutTimer_.stop();
+    socket_.abort();
+
+    const double tunnelMs = isTunnelEstablished ? tunnelNs_ / 1e6 : 0;
+    const double echoMs = success ? (elapsedTimer_.nsecsElapsed() - tunnelNs_) / 1e6 : 0;
+    emit finished(success, error, tunnelMs, echoMs, success ? payload_.size() * 2 : 0);
+}
+
+} // namespace ProxyLoadTest
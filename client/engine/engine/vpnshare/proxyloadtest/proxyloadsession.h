@@ -0,0 +1,68 @@
+#ifndef PROXYLOADTEST_PROXYLOADSESSION_H
+#define PROXYLOADTEST_PROXYLOADSESSION_H
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QTimer>
+#include "../httpproxyserver/httpproxywebanswerparser.h"
+#include "../socksproxyserver/socksproxycommandparser.h"
+
+namespace ProxyLoadTest {
+
+enum PROXY_TYPE { PROXY_HTTP, PROXY_SOCKS };
+
+// One client of the proxy: opens the tunnel to the target (HTTP CONNECT or SOCKS5 CONNECT without authentication),
+// sends the payload through it and waits for the echo of the whole payload.
+// The answers of the proxy are checked with the parsers of the proxy servers.
+class ProxyLoadSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProxyLoadSession(QObject *parent, PROXY_TYPE type, const QHostAddress &proxyAddress, quint16 proxyPort,
+                              quint16 targetPort, const QByteArray &payload, int timeoutMs);
+
+    void start();
+
+    // the requests are checked once with the request parsers of the servers before the load starts
+    static QByteArray httpConnectRequest(quint16 targetPort);
+    static QByteArray socksConnectRequest(quint16 targetPort);
+    static bool validateRequests(quint16 targetPort, QString &outError);
+
+signals:
+    // tunnelMs: from the start to the established tunnel, echoMs: the round trip of the payload
+    void finished(bool success, const QString &error, double tunnelMs, double echoMs, qint64 bytes);
+
+private slots:
+    void onSocketConnected();
+    void onSocketReadyRead();
+    void onSocketError(QAbstractSocket::SocketError socketError);
+    void onTimeout();
+
+private:
+    enum STATE { STATE_CONNECTING, STATE_HTTP_CONNECT, STATE_SOCKS_METHOD, STATE_SOCKS_CONNECT, STATE_ECHO, STATE_FINISHED };
+
+    PROXY_TYPE type_;
+    QHostAddress proxyAddress_;
+    quint16 proxyPort_;
+    quint16 targetPort_;
+    QByteArray payload_;
+
+    QTcpSocket socket_;
+    QTimer timeoutTimer_;
+    QElapsedTimer elapsedTimer_;
+    STATE state_;
+    QByteArray readBuf_;
+    HttpProxyServer::HttpProxyWebAnswerParser httpAnswerParser_;
+    SocksProxyServer::SocksProxyCommandParser socksReplyParser_;
+    qint64 tunnelNs_;
+    qint64 echoedBytes_;
+
+    void onTunnelEstablished(const QByteArray &extraData);
+    void processEcho(qint64 bytes);
+    void finish(bool success, const QString &error);
+};
+
+} // namespace ProxyLoadTest
+
+#endif // PROXYLOADTEST_PROXYLOADSESSION_H
@@ -0,0 +1,38 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+QT += core network
+QT -= gui
+TARGET = proxyloadtest
+
+BUILD_LIBS_PATH = $$PWD/../../../../../build-libs
+
+# the parsers of the proxy servers include utils/boost_includes.h
+INCLUDEPATH += $$PWD/../../.. \
+               $$BUILD_LIBS_PATH/boost/include
+
+win32 {
+    DEFINES += "WINVER=0x0601"
+    DEFINES += "_WIN32_WINNT=0x0601"
+    LIBS += Ws2_32.lib
+}
+
+SOURCES += \
+        main.cpp \
+        echoserver.cpp \
+        proxyloadgenerator.cpp \
+        proxyloadsession.cpp \
+        ../httpproxyserver/httpproxyrequestparser.cpp \
+        ../httpproxyserver/httpproxyscanner.cpp \
+        ../httpproxyserver/httpproxywebanswerparser.cpp \
+        ../socksproxyserver/socksproxycommandparser.cpp
+
+HEADERS += \
+        echoserver.h \
+        proxyloadgenerator.h \
+        proxyloadsession.h \
+        ../httpproxyserver/httpproxyrequestparser.h \
+        ../httpproxyserver/httpproxyscanner.h \
+        ../httpproxyserver/httpproxywebanswerparser.h \
+        ../socksproxyserver/socksproxycommandparser.h
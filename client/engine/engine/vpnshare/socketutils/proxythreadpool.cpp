@@ -0,0 +1,207 @@
+#include "proxythreadpool.h"
+
+#include "utils/logger.h"
+
+ProxyThreadPool::ProxyThreadPool(QObject *parent, int threadsCount) : QObject(parent)
+{
+    if (threadsCount <= 0)
+    {
+        threadsCount = qMax(QThread::idealThreadCount(), 1);
+    }
+    for (int i = 0; i < threadsCount; i++)
+    {
+        Worker worker;
+        worker.thread = new QThread(this);
+        worker.probeContext = new QObject();
+        worker.probeContext->moveToThread(worker.thread);
+        connect(worker.thread, &QThread::finished, worker.probeContext, &QObject::deleteLater);
+        worker.probe = std::make_shared<Probe>();
+        worker.connections = 0;
+        worker.bytesPerSec = 0;
+        worker.thread->start(QThread::LowPriority);
+        workers_ << worker;
+    }
+
+    connect(&loadTimer_, SIGNAL(timeout()), SLOT(onLoadTimer()));
+    loadTimer_.start(LOAD_INTERVAL_MS);
+    sampleTimer_.start();
+}
+
+void ProxyThreadPool::addConnection(QObject *connection, const std::function<quint64()> &bytesRelayed)
+{
+    Q_ASSERT(!connections_.contains(connection));
+    const int worker = leastLoadedWorker();
+    connection->moveToThread(workers_[worker].thread);
+    workers_[worker].connections++;
+
+    Connection c;
+    c.worker = worker;
+    c.bytesRelayed = bytesRelayed;
+    c.lastBytes = 0;
+    c.bytesPerSec = 0;
+    c.age.start();
+    connections_.insert(connection, c);
+}
+
+void ProxyThreadPool::removeConnection(QObject *connection)
+{
+    auto it = connections_.find(connection);
+    Q_ASSERT(it != connections_.end());
+    Worker &worker = workers_[it->worker];
+    worker.connections--;
+    worker.bytesPerSec -= qMin(worker.bytesPerSec, it->bytesPerSec);
+    connections_.erase(it);
+}
+
+void ProxyThreadPool::stop()
+{
+    loadTimer_.stop();
+    for (const Worker &worker : qAsConst(workers_))
+    {
+        worker.thread->exit();
+    }
+    for (const Worker &worker : qAsConst(workers_))
+    {
+        worker.thread->wait();
+    }
+}
+
+QVector<ProxyThreadPool::ThreadLoad> ProxyThreadPool::threadsLoad() const
+{
+    QVector<ThreadLoad> result;
+    for (int i = 0; i < workers_.count(); ++i)
+    {
+        result << ThreadLoad { i, workers_[i].connections, workers_[i].bytesPerSec, workers_[i].probe->latencyMs.load() };
+    }
+    return result;
+}
+
+void ProxyThreadPool::onLoadTimer()
+{
+    const qint64 elapsedMs = qMax(sampleTimer_.restart(), static_cast<qint64>(1));
+    for (Worker &worker : workers_)
+    {
+        worker.bytesPerSec = 0;
+    }
+    for (Connection &c : connections_)
+    {
+        const quint64 bytes = c.bytesRelayed();
+        c.bytesPerSec = (bytes - c.lastBytes) * 1000 / elapsedMs;
+        c.lastBytes = bytes;
+        workers_[c.worker].bytesPerSec += c.bytesPerSec;
+    }
+    for (Worker &worker : workers_)
+    {
+        probeEventLoop(worker);
+    }
+    migrateBusyConnection();
+}
+
+quint64 ProxyThreadPool::load(const Worker &worker) const
+{
+    return worker.bytesPerSec + worker.connections * CONNECTION_COST_BYTES_PER_SEC;
+}
+
+bool ProxyThreadPool::isOverloaded(const Worker &worker) const
+{
+    return worker.probe->latencyMs > OVERLOADED_LATENCY_MS;
+}
+
+int ProxyThreadPool::leastLoadedWorker() const
+{
+    Q_ASSERT(workers_.count() > 0);
+    int best = 0;
+    for (int i = 1; i < workers_.count(); ++i)
+    {
+        const bool isOverloaded = this->isOverloaded(workers_[i]);
+        const bool isBestOverloaded = this->isOverloaded(workers_[best]);
+        if (isOverloaded != isBestOverloaded)
+        {
+            if (!isOverloaded)
+            {
+                best = i;
+            }
+        }
+        else if (load(workers_[i]) < load(workers_[best]))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void ProxyThreadPool::probeEventLoop(Worker &worker)
+{
+    if (worker.probe->isPending)
+    {
+        // the event loop hasn't got to the previous probe yet, it's late at least by this time
+        worker.probe->latencyMs = qMax(worker.probe->latencyMs.load(), static_cast<int>(worker.probeTimer.elapsed()));
+        return;
+    }
+    worker.probe->isPending = true;
+    worker.probeTimer.start();
+    const std::shared_ptr<Probe> probe = worker.probe;
+    const QElapsedTimer posted = worker.probeTimer;
+    QMetaObject::invokeMethod(worker.probeContext, [probe, posted]() {
+        probe->latencyMs = static_cast<int>(posted.elapsed());
+        probe->isPending = false;
+    }, Qt::QueuedConnection);
+}
+
+void ProxyThreadPool::migrateBusyConnection()
+{
+    int busiest = 0;
+    int idlest = -1;
+    for (int i = 0; i < workers_.count(); ++i)
+    {
+        if (workers_[i].bytesPerSec > workers_[busiest].bytesPerSec)
+        {
+            busiest = i;
+        }
+        if (!isOverloaded(workers_[i]) && (idlest == -1 || workers_[i].bytesPerSec < workers_[idlest].bytesPerSec))
+        {
+            idlest = i;
+        }
+    }
+    if (idlest == -1 || idlest == busiest || workers_[busiest].bytesPerSec < MIN_MIGRATE_BYTES_PER_SEC ||
+        workers_[busiest].bytesPerSec <= 2 * workers_[idlest].bytesPerSec)
+    {
+        return;
+    }
+
+    // a connection slower than the gap narrows it, the one with a half of the gap evens the threads
+    const quint64 gap = workers_[busiest].bytesPerSec - workers_[idlest].bytesPerSec;
+    QObject *best = nullptr;
+    quint64 bestDistance = 0;
+    for (auto it = connections_.constBegin(); it != connections_.constEnd(); ++it)
+    {
+        if (it->worker != busiest || it->bytesPerSec == 0 || it->bytesPerSec >= gap || it->age.elapsed() < MIN_MIGRATE_AGE_MS)
+        {
+            continue;
+        }
+        const quint64 distance = qMax(gap, 2 * it->bytesPerSec) - qMin(gap, 2 * it->bytesPerSec);
+        if (best == nullptr || distance < bestDistance)
+        {
+            best = it.key();
+            bestDistance = distance;
+        }
+    }
+    if (best == nullptr)
+    {
+        return;
+    }
+
+    Connection &c = connections_[best];
+    qCDebug(LOG_BASIC) << "Proxy connection with" << c.bytesPerSec / 1024 << "KB/s moved from the thread" << busiest
+                       << "(" << workers_[busiest].bytesPerSec / 1024 << "KB/s ) to" << idlest
+                       << "(" << workers_[idlest].bytesPerSec / 1024 << "KB/s )";
+    // moveToThread() only from the thread of the object, its sockets and relay are its children and move with it
+    QThread *target = workers_[idlest].thread;
+    QMetaObject::invokeMethod(best, [best, target]() { best->moveToThread(target); }, Qt::QueuedConnection);
+
+    workers_[busiest].connections--;
+    workers_[busiest].bytesPerSec -= c.bytesPerSec;
+    workers_[idlest].connections++;
+    workers_[idlest].bytesPerSec += c.bytesPerSec;
+    c.worker = idlest;
+}
@@ -0,0 +1,93 @@
+#ifndef PROXYTHREADPOOL_H
+#define PROXYTHREADPOOL_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// The worker threads of the proxy servers with the connections balanced by the measured load, not by their count.
+// Every LOAD_INTERVAL_MS the pool samples the bytes relayed by each connection and the latency of the event loop of
+// each thread (the delay of a queued call to it).
+// A new connection goes to the thread with the least load: the bytes per second plus CONNECTION_COST_BYTES_PER_SEC
+// per connection, so that a burst of the new connections, idle yet, spreads. The threads with the event loop late
+// more than OVERLOADED_LATENCY_MS are taken only if all of them are.
+// If the busiest thread relays more than twice the bytes of the least busy one, the connection (older than
+// MIN_MIGRATE_AGE_MS) which brings them closest is moved from one to the other, one connection per interval.
+class ProxyThreadPool : public QObject
+{
+    Q_OBJECT
+public:
+    struct ThreadLoad
+    {
+        int index;
+        int connections;
+        quint64 bytesPerSec;
+        int eventLoopLatencyMs;
+    };
+
+    // 0 threads - as many as the cores
+    explicit ProxyThreadPool(QObject *parent, int threadsCount);
+
+    // moves the connection (it has no parent) to the least loaded thread,
+    // bytesRelayed is called from the thread of the pool and must be safe for it
+    void addConnection(QObject *connection, const std::function<quint64()> &bytesRelayed);
+    void removeConnection(QObject *connection);
+    void stop();
+
+    QVector<ThreadLoad> threadsLoad() const;
+
+private slots:
+    void onLoadTimer();
+
+private:
+    static constexpr int LOAD_INTERVAL_MS = 1000;
+    static constexpr quint64 CONNECTION_COST_BYTES_PER_SEC = 16 * 1024;
+    static constexpr int OVERLOADED_LATENCY_MS = 50;
+    static constexpr quint64 MIN_MIGRATE_BYTES_PER_SEC = 1024 * 1024;
+    static constexpr qint64 MIN_MIGRATE_AGE_MS = 10000;
+
+    // written by the worker thread
+    struct Probe
+    {
+        std::atomic<bool> isPending { false };
+        std::atomic<int> latencyMs { 0 };
+    };
+
+    struct Worker
+    {
+        QThread *thread;
+        QObject *probeContext;      // lives in the thread
+        std::shared_ptr<Probe> probe;
+        QElapsedTimer probeTimer;
+        int connections;
+        quint64 bytesPerSec;
+    };
+
+    struct Connection
+    {
+        int worker;
+        std::function<quint64()> bytesRelayed;
+        quint64 lastBytes;
+        quint64 bytesPerSec;
+        QElapsedTimer age;
+    };
+
+    QVector<Worker> workers_;
+    QHash<QObject *, Connection> connections_;
+    QTimer loadTimer_;
+    QElapsedTimer sampleTimer_;
+
+    quint64 load(const Worker &worker) const;
+    bool isOverloaded(const Worker &worker) const;
+    int leastLoadedWorker() const;
+    void probeEventLoop(Worker &worker);
+    void migrateBusyConnection();
+};
+
+#endif // PROXYTHREADPOOL_H
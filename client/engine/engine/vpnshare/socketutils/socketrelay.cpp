@@ -0,0 +1,339 @@
+#include "socketrelay.h"
+
+#ifdef Q_OS_LINUX
+    #include <QSocketNotifier>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+SocketRelay::SocketRelay(QObject *parent, QTcpSocket *socket1, QTcpSocket *socket2, std::atomic<quint64> *bytesTotal) : QObject(parent),
+    socket1_(socket1), socket2_(socket2), bytesForward_(0), bytesBackward_(0), bytesTotal_(bytesTotal),
+    isFinished_(false)
+#ifdef Q_OS_LINUX
+    , isNative_(false), fd1_(-1), fd2_(-1)
+#endif
+{
+#ifdef Q_OS_LINUX
+    for (NativeDirection &d : directions_)
+    {
+        d.srcFd = -1;
+        d.dstFd = -1;
+        d.pipeFds[0] = -1;
+        d.pipeFds[1] = -1;
+        d.bytesInPipe = 0;
+        d.isEof = false;
+        d.isDone = false;
+        d.readNotifier = nullptr;
+        d.writeNotifier = nullptr;
+    }
+#endif
+}
+
+SocketRelay::~SocketRelay()
+{
+    close();
+}
+
+void SocketRelay::start()
+{
+    elapsedTimer_.start();
+
+    // Qt stops reading from the OS socket when its read buffer is full, so the backpressure reaches the sender
+    socket1_->setReadBufferSize(MAX_PENDING_BYTES);
+    socket2_->setReadBufferSize(MAX_PENDING_BYTES);
+
+    connect(socket1_, SIGNAL(readyRead()), SLOT(onReadyRead1()));
+    connect(socket2_, SIGNAL(readyRead()), SLOT(onReadyRead2()));
+    connect(socket1_, SIGNAL(bytesWritten(qint64)), SLOT(onBytesWritten1()));
+    connect(socket2_, SIGNAL(bytesWritten(qint64)), SLOT(onBytesWritten2()));
+    connect(socket1_, SIGNAL(disconnected()), SLOT(onDisconnected()));
+    connect(socket2_, SIGNAL(disconnected()), SLOT(onDisconnected()));
+
+    // the data received before the relay was started
+    relay(socket1_, socket2_, bytesForward_);
+    relay(socket2_, socket1_, bytesBackward_);
+#ifdef Q_OS_LINUX
+    tryStartNative();
+#endif
+}
+
+void SocketRelay::close()
+{
+#ifdef Q_OS_LINUX
+    closeNative();
+#endif
+    isFinished_ = true;
+}
+
+quint64 SocketRelay::bytesForward() const
+{
+    return bytesForward_;
+}
+
+quint64 SocketRelay::bytesBackward() const
+{
+    return bytesBackward_;
+}
+
+qint64 SocketRelay::elapsedMs() const
+{
+    return elapsedTimer_.isValid() ? elapsedTimer_.elapsed() : 0;
+}
+
+void SocketRelay::onReadyRead1()
+{
+    relay(socket1_, socket2_, bytesForward_);
+#ifdef Q_OS_LINUX
+    tryStartNative();
+#endif
+}
+
+void SocketRelay::onReadyRead2()
+{
+    relay(socket2_, socket1_, bytesBackward_);
+#ifdef Q_OS_LINUX
+    tryStartNative();
+#endif
+}
+
+void SocketRelay::onBytesWritten1()
+{
+    // socket1 has room again, continue the reading from socket2
+    relay(socket2_, socket1_, bytesBackward_);
+#ifdef Q_OS_LINUX
+    tryStartNative();
+#endif
+}
+
+void SocketRelay::onBytesWritten2()
+{
+    relay(socket1_, socket2_, bytesForward_);
+#ifdef Q_OS_LINUX
+    tryStartNative();
+#endif
+}
+
+void SocketRelay::onDisconnected()
+{
+    // the data left in the read buffers goes to the write buffers, QTcpSocket::close() writes them out
+    relay(socket1_, socket2_, bytesForward_);
+    relay(socket2_, socket1_, bytesBackward_);
+    emitFinished();
+}
+
+void SocketRelay::relay(QTcpSocket *src, QTcpSocket *dst, quint64 &bytesCounter)
+{
+    if (isFinished_)
+    {
+        return;
+    }
+    static thread_local QByteArray buffer(BUFFER_SIZE, Qt::Uninitialized);
+    while (dst->bytesToWrite() < MAX_PENDING_BYTES)
+    {
+        const qint64 bytesRead = src->read(buffer.data(), buffer.size());
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        dst->write(buffer.constData(), bytesRead);
+        bytesCounter += bytesRead;
+        if (bytesTotal_)
+        {
+            *bytesTotal_ += bytesRead;
+        }
+    }
+}
+
+void SocketRelay::emitFinished()
+{
+    if (!isFinished_)
+    {
+        isFinished_ = true;
+        emit finished();
+    }
+}
+
+void SocketRelay::onNativeActivated()
+{
+#ifdef Q_OS_LINUX
+    if (!isNative_)
+    {
+        return;
+    }
+    if (!pumpNative(directions_[0], bytesForward_) || !pumpNative(directions_[1], bytesBackward_) ||
+        (directions_[0].isDone && directions_[1].isDone))
+    {
+        closeNative();
+        emitFinished();
+    }
+#endif
+}
+
+#ifdef Q_OS_LINUX
+
+void SocketRelay::tryStartNative()
+{
+    if (isNative_ || isFinished_)
+    {
+        return;
+    }
+    // all the data buffered by Qt must be relayed before the descriptors are taken
+    if (socket1_->state() != QAbstractSocket::ConnectedState || socket2_->state() != QAbstractSocket::ConnectedState ||
+        socket1_->bytesAvailable() > 0 || socket2_->bytesAvailable() > 0 ||
+        socket1_->bytesToWrite() > 0 || socket2_->bytesToWrite() > 0)
+    {
+        return;
+    }
+    if (initNative())
+    {
+        onNativeActivated();
+    }
+}
+
+bool SocketRelay::initNative()
+{
+    // the sockets are closed by QTcpSocket::abort() below, the relay continues with the duplicated descriptors
+    fd1_ = ::dup(socket1_->socketDescriptor());
+    fd2_ = ::dup(socket2_->socketDescriptor());
+    int pipe1[2] = { -1, -1 };
+    int pipe2[2] = { -1, -1 };
+    if (fd1_ == -1 || fd2_ == -1 || ::pipe2(pipe1, O_NONBLOCK | O_CLOEXEC) == -1 || ::pipe2(pipe2, O_NONBLOCK | O_CLOEXEC) == -1)
+    {
+        for (int fd : { fd1_, fd2_, pipe1[0], pipe1[1], pipe2[0], pipe2[1] })
+        {
+            if (fd != -1)
+            {
+                ::close(fd);
+            }
+        }
+        fd1_ = -1;
+        fd2_ = -1;
+        return false;   // continue with the Qt sockets
+    }
+
+    socket1_->blockSignals(true);
+    socket2_->blockSignals(true);
+    socket1_->abort();
+    socket2_->abort();
+
+    directions_[0].srcFd = fd1_;
+    directions_[0].dstFd = fd2_;
+    directions_[0].pipeFds[0] = pipe1[0];
+    directions_[0].pipeFds[1] = pipe1[1];
+    directions_[1].srcFd = fd2_;
+    directions_[1].dstFd = fd1_;
+    directions_[1].pipeFds[0] = pipe2[0];
+    directions_[1].pipeFds[1] = pipe2[1];
+    for (NativeDirection &d : directions_)
+    {
+        d.bytesInPipe = 0;
+        d.isEof = false;
+        d.isDone = false;
+        d.readNotifier = new QSocketNotifier(d.srcFd, QSocketNotifier::Read, this);
+        d.writeNotifier = new QSocketNotifier(d.dstFd, QSocketNotifier::Write, this);
+        d.writeNotifier->setEnabled(false);
+        connect(d.readNotifier, SIGNAL(activated(int)), SLOT(onNativeActivated()));
+        connect(d.writeNotifier, SIGNAL(activated(int)), SLOT(onNativeActivated()));
+    }
+    isNative_ = true;
+    return true;
+}
+
+void SocketRelay::closeNative()
+{
+    if (!isNative_)
+    {
+        return;
+    }
+    isNative_ = false;
+    for (NativeDirection &d : directions_)
+    {
+        // can be called from the notifiers signals
+        d.readNotifier->setEnabled(false);
+        d.readNotifier->deleteLater();
+        d.readNotifier = nullptr;
+        d.writeNotifier->setEnabled(false);
+        d.writeNotifier->deleteLater();
+        d.writeNotifier = nullptr;
+        ::close(d.pipeFds[0]);
+        ::close(d.pipeFds[1]);
+        d.pipeFds[0] = -1;
+        d.pipeFds[1] = -1;
+    }
+    ::close(fd1_);
+    ::close(fd2_);
+    fd1_ = -1;
+    fd2_ = -1;
+}
+
+bool SocketRelay::pumpNative(NativeDirection &direction, quint64 &bytesCounter)
+{
+    // the sockets are non-blocking (set by Qt, shared by the duplicated descriptors),
+    // SIGPIPE is ignored by the Qt network module
+    if (direction.isDone)
+    {
+        return true;
+    }
+    bool isProgress = true;
+    while (isProgress)
+    {
+        isProgress = false;
+        if (!direction.isEof && direction.bytesInPipe < PIPE_CAPACITY)
+        {
+            const ssize_t n = ::splice(direction.srcFd, nullptr, direction.pipeFds[1], nullptr,
+                                       PIPE_CAPACITY - direction.bytesInPipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0)
+            {
+                direction.bytesInPipe += n;
+                isProgress = true;
+            }
+            else if (n == 0)
+            {
+                direction.isEof = true;
+            }
+            else if (errno != EAGAIN && errno != EINTR)
+            {
+                return false;
+            }
+        }
+        if (direction.bytesInPipe > 0)
+        {
+            const ssize_t n = ::splice(direction.pipeFds[0], nullptr, direction.dstFd, nullptr,
+                                       direction.bytesInPipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0)
+            {
+                direction.bytesInPipe -= n;
+                bytesCounter += n;
+                if (bytesTotal_)
+                {
+                    *bytesTotal_ += n;
+                }
+                isProgress = true;
+            }
+            else if (n < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                return false;
+            }
+        }
+    }
+
+    if (direction.isEof && direction.bytesInPipe == 0)
+    {
+        // everything read from the source is written, the peer gets the EOF, the replies still come the other way
+        ::shutdown(direction.dstFd, SHUT_WR);
+        direction.isDone = true;
+    }
+    updateNotifiers(direction);
+    return true;
+}
+
+void SocketRelay::updateNotifiers(NativeDirection &direction)
+{
+    // stop reading while the pipe is full, wait for the destination only while there is something to write
+    direction.readNotifier->setEnabled(!direction.isDone && !direction.isEof && direction.bytesInPipe < PIPE_CAPACITY);
+    direction.writeNotifier->setEnabled(!direction.isDone && direction.bytesInPipe > 0);
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SOCKETRELAY_H
+#define SOCKETRELAY_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QSocketNotifier;
+
+// Relays data between two connected sockets in both directions.
+// The data is read into a fixed-size buffer shared by all the relays of the thread (it doesn't hold the data between
+// the events) and is read from the source only while the destination has less than MAX_PENDING_BYTES to write (backpressure).
+// On Linux, when the Qt buffers of both sockets are empty, the descriptors are taken from the QTcpSockets
+// and the data goes through a pipe with splice(), without copying to the user space.
+// The optional bytesTotal is increased by the bytes of both directions, it can be read from any thread.
+class SocketRelay : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SocketRelay(QObject *parent, QTcpSocket *socket1, QTcpSocket *socket2, std::atomic<quint64> *bytesTotal = nullptr);
+    ~SocketRelay() override;
+
+    void start();
+    void close();
+
+    // bytes written to socket2 and to socket1
+    quint64 bytesForward() const;
+    quint64 bytesBackward() const;
+    qint64 elapsedMs() const;
+
+signals:
+    // one of the sockets was closed or failed (with splice() both directions reached the EOF), the data received
+    // before is written to the other socket
+    void finished();
+
+private slots:
+    void onReadyRead1();
+    void onReadyRead2();
+    void onBytesWritten1();
+    void onBytesWritten2();
+    void onDisconnected();
+    void onNativeActivated();
+
+private:
+    static constexpr int BUFFER_SIZE = 64 * 1024;
+    static constexpr qint64 MAX_PENDING_BYTES = 256 * 1024;
+
+    QTcpSocket *socket1_;
+    QTcpSocket *socket2_;
+    quint64 bytesForward_;
+    quint64 bytesBackward_;
+    std::atomic<quint64> *bytesTotal_;
+    QElapsedTimer elapsedTimer_;
+    bool isFinished_;
+
+    void relay(QTcpSocket *src, QTcpSocket *dst, quint64 &bytesCounter);
+    void emitFinished();
+
+#ifdef Q_OS_LINUX
+    struct NativeDirection
+    {
+        int srcFd;
+        int dstFd;
+        int pipeFds[2];
+        qint64 bytesInPipe;
+        bool isEof;
+        bool isDone;            // the EOF was passed to the destination (shutdown of its writing side)
+        QSocketNotifier *readNotifier;
+        QSocketNotifier *writeNotifier;
+    };
+    static constexpr qint64 PIPE_CAPACITY = 64 * 1024;   // default pipe size on Linux
+
+    bool isNative_;
+    int fd1_;
+    int fd2_;
+    NativeDirection directions_[2];
+
+    void tryStartNative();
+    bool initNative();
+    void closeNative();
+    // returns false on an error, a direction which reached the EOF is half-closed and the relay continues
+    // in the other one until it is drained too
+    bool pumpNative(NativeDirection &direction, quint64 &bytesCounter);
+    void updateNotifiers(NativeDirection &direction);
+#endif
+};
+
+#endif // SOCKETRELAY_H
@@ -1,45 +1,42 @@
 #include "socketwriteall.h"
 
 SocketWriteAll::SocketWriteAll(QObject *parent, QTcpSocket *socket) : QObject(parent),
-    socket_(socket), bEmitAllDataWritten_(false)
+    socket_(socket), bytesPending_(0), bEmitAllDataWritten_(false)
 {
     connect(socket_, SIGNAL(bytesWritten(qint64)), SLOT(onBytesWritten(qint64)));
 }
 
 void SocketWriteAll::write(const QByteArray &arr)
 {
-    if (arr_.isEmpty())
+    // QTcpSocket buffers all the data, only the bytes not written yet are counted
+    const qint64 written = socket_->write(arr);
+    if (written > 0)
     {
-        arr_ = arr;
-        socket_->write(arr_);
-    }
-    else
-    {
-        arr_.append(arr);
+        bytesPending_ += written;
     }
 }
 
 void SocketWriteAll::setEmitAllDataWritten()
 {
-    if (arr_.isEmpty())
+    if (bytesPending_ == 0)
     {
         emit allDataWriteFinished();
     }
     bEmitAllDataWritten_ = true;
 }
 
+void SocketWriteAll::detach()
+{
+    disconnect(socket_, SIGNAL(bytesWritten(qint64)), this, SLOT(onBytesWritten(qint64)));
+    bytesPending_ = 0;
+    bEmitAllDataWritten_ = false;
+}
+
 void SocketWriteAll::onBytesWritten(qint64 bytes)
 {
-    arr_.remove(0, bytes);
-    if (!arr_.isEmpty())
-    {
-        socket_->write(arr_);
-    }
-    else
+    bytesPending_ = qMax(bytesPending_ - bytes, static_cast<qint64>(0));
+    if (bytesPending_ == 0 && bEmitAllDataWritten_)
     {
-        if (bEmitAllDataWritten_)
-        {
-            emit allDataWriteFinished();
-        }
+        emit allDataWriteFinished();
     }
 }
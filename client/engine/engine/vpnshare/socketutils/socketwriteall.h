@@ -12,6 +12,9 @@ public:
     void write(const QByteArray &arr);
 
     void setEmitAllDataWritten();
+    // stops tracking the socket, the data written before stays in the write buffer of the socket
+    // (e.g. before the socket is handed to SocketRelay, which tracks bytesToWrite() itself)
+    void detach();
 
 signals:
     void allDataWriteFinished();
@@ -21,7 +24,7 @@ private slots:
 
 private:
     QTcpSocket *socket_;
-    QByteArray arr_;
+    qint64 bytesPending_;
     bool bEmitAllDataWritten_;
 };
 
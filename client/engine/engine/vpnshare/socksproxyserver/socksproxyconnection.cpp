@@ -10,7 +10,7 @@ SocksProxyConnection::SocksProxyConnection(qintptr socketDescriptor, const QStri
                                            QObject *parent)
     : QObject(parent), socket_(nullptr), socketExternal_(nullptr),
     socketDescriptor_(socketDescriptor), hostname_(hostname), state_(READ_IDENT_REQ),
-    writeAllSocket_(0), writeAllSocketExternal_(0), bAlreadyClosedAndEmitFinished_(false)
+    writeAllSocket_(0), writeAllSocketExternal_(0), relay_(nullptr), bytesRelayed_(0), bAlreadyClosedAndEmitFinished_(false)
 {
 }
 
@@ -156,10 +156,9 @@ void SocksProxyConnection::onSocketReadyRead()
             Q_ASSERT(false);
         }
     }
-    else if (state_ == RELAY_BETWEEN_CLIENT_SERVER)
+    else if (state_ == CONNECT_TO_HOST)
     {
-        writeAllSocketExternal_->write(socketReadArr_);
-        socketReadArr_.clear();
+        // the client data sent before the reply, it is written to the host when connected
     }
     else
     {
@@ -185,7 +184,13 @@ void SocksProxyConnection::onExternalSocketConnected()
         //resp.BindPort = 0x00;
         //memset(&resp.BindAddr.IPv4, 0, sizeof(resp.BindAddr.IPv4));
         writeAllSocket_->write(getByteArrayFromSocks5Resp(resp));
+        if (!socketReadArr_.isEmpty())
+        {
+            writeAllSocketExternal_->write(socketReadArr_);
+            socketReadArr_.clear();
+        }
         state_ = RELAY_BETWEEN_CLIENT_SERVER;
+        startRelay();
     }
     else
     {
@@ -248,9 +253,27 @@ void SocksProxyConnection::onExternalSocketReadyRead()
 
 void SocksProxyConnection::onExternalSocketError(QAbstractSocket::SocketError socketError)
 {
-    Q_UNUSED(socketError);
     if (state_ == CONNECT_TO_HOST)
     {
+        // reply with the failure to the client and close, the connection must not hang
+        socks5_resp resp;
+        memcpy(&resp, &commandParser_.cmd(), sizeof(resp));
+        if (socketError == QAbstractSocket::ConnectionRefusedError)
+        {
+            resp.Reply = 0x05;  // connection refused
+        }
+        else if (socketError == QAbstractSocket::HostNotFoundError)
+        {
+            resp.Reply = 0x04;  // host unreachable
+        }
+        else
+        {
+            resp.Reply = 0x01;  // general SOCKS server failure
+        }
+        disconnect(socket_, SIGNAL(readyRead()), this, SLOT(onSocketReadyRead()));
+        writeAllSocket_->write(getByteArrayFromSocks5Resp(resp));
+        connect(writeAllSocket_, SIGNAL(allDataWriteFinished()), SLOT(closeSocketsAndEmitFinished()));
+        writeAllSocket_->setEmitAllDataWritten();
     }
     /*Q_UNUSED(socketError);
     if (state_ == CONNECTING_TO_EXTERNAL_SERVER)
@@ -262,11 +285,35 @@ void SocksProxyConnection::onExternalSocketError(QAbstractSocket::SocketError so
     }*/
 }
 
+void SocksProxyConnection::startRelay()
+{
+    // the relay reads the sockets from now, the data written before by SocketWriteAll is already in the write buffers
+    // of the sockets and goes first, its tracking of bytesWritten() is stopped so it doesn't interfere with the relay
+    disconnect(socket_, SIGNAL(readyRead()), this, SLOT(onSocketReadyRead()));
+    disconnect(socketExternal_, SIGNAL(readyRead()), this, SLOT(onExternalSocketReadyRead()));
+    if (writeAllSocket_)
+    {
+        writeAllSocket_->detach();
+    }
+    if (writeAllSocketExternal_)
+    {
+        writeAllSocketExternal_->detach();
+    }
+
+    relay_ = new SocketRelay(this, socket_, socketExternal_, &bytesRelayed_);
+    connect(relay_, SIGNAL(finished()), SLOT(closeSocketsAndEmitFinished()));
+    relay_->start();
+}
+
 void SocksProxyConnection::closeSocketsAndEmitFinished()
 {
     if (!bAlreadyClosedAndEmitFinished_)
     {
         bAlreadyClosedAndEmitFinished_ = true;
+        if (relay_)
+        {
+            relay_->close();
+        }
         if (socket_)
         {
             socket_->close();
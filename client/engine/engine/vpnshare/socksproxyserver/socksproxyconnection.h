@@ -8,6 +8,7 @@
 #include "socksproxyreadexactly.h"
 #include "socksproxyidentreqparser.h"
 #include "../socketutils/socketwriteall.h"
+#include "../socketutils/socketrelay.h"
 #include "socksproxycommandparser.h"
 
 namespace SocksProxyServer {
@@ -20,6 +21,9 @@ public:
 
     bool start(qintptr socketDescriptor);
 
+    // the bytes relayed in both directions, can be read from any thread
+    quint64 bytesRelayed() const { return bytesRelayed_; }
+
 public slots:
     void start();
     void forceClose();
@@ -50,6 +54,8 @@ private:
     QByteArray socketReadArr_;
     SocketWriteAll *writeAllSocket_;
     SocketWriteAll *writeAllSocketExternal_;
+    SocketRelay *relay_;
+    std::atomic<quint64> bytesRelayed_;
 
     SocksProxyIdentReqParser identReqParser_;
     SocksProxyCommandParser commandParser_;
@@ -58,6 +64,7 @@ private:
     bool bAlreadyClosedAndEmitFinished_;
 
     QByteArray getByteArrayFromSocks5Resp(const socks5_resp &resp);
+    void startRelay();
 
 };
 
@@ -7,15 +7,8 @@
 namespace SocksProxyServer {
 
 SocksProxyConnectionManager::SocksProxyConnectionManager(QObject *parent, int threadsCount, ConnectedUsersCounter *usersCounter) : QObject(parent),
-    usersCounter_(usersCounter)
+    threadPool_(new ProxyThreadPool(this, threadsCount)), usersCounter_(usersCounter)
 {
-    Q_ASSERT(threadsCount > 0);
-    for (int i = 0; i < threadsCount; i++)
-    {
-        QThread *thread = new QThread(this);
-        threads_[thread] = 0;
-        thread->start(QThread::LowPriority);
-    }
 }
 
 void SocksProxyConnectionManager::newConnection(qintptr socketDescriptor)
@@ -31,16 +24,21 @@ void SocksProxyConnectionManager::newConnection(qintptr socketDescriptor)
     char *ip = inet_ntoa(addr.sin_addr);
     usersCounter_->newUserConnected(ip);
 
-    QThread *thread = getLessBusyThread();
     SocksProxyConnection *connection = new SocksProxyConnection(socketDescriptor, ip);
     connect(connection, SIGNAL(finished(QString)), SLOT(onConnectionFinished(QString)));
-    addConnectionToThread(thread, connection);
+    //qCDebug(LOG_SOCKS_SERVER) << "Connection started:" << connection;
+    Q_ASSERT(!connections_.contains(connection));
+    connections_.insert(connection);
+    const auto bytesRelayed = [connection]() { return connection->bytesRelayed(); };
+    threadPool_->addConnection(connection, bytesRelayed);
+    usersCounter_->addTrafficSource(ip, connection, bytesRelayed);
+    QTimer::singleShot(0, connection, SLOT(start()));
     //qCDebug(LOG_SOCKS_SERVER) << "Count of connections:" << connections_.count();
 }
 
 void SocksProxyConnectionManager::closeAllConnections()
 {
-    for(auto c : connections_.keys())
+    for(auto c : connections_)
     {
         QMetaObject::invokeMethod(c, "forceClose", Qt::QueuedConnection);
     }
@@ -48,14 +46,7 @@ void SocksProxyConnectionManager::closeAllConnections()
 
 void SocksProxyConnectionManager::stop()
 {
-    for(auto thread : threads_.keys())
-    {
-        thread->exit();
-    }
-    for(auto thread : threads_.keys())
-    {
-        thread->wait();
-    }
+    threadPool_->stop();
 }
 
 void SocksProxyConnectionManager::onConnectionFinished(const QString &hostname)
@@ -64,43 +55,24 @@ void SocksProxyConnectionManager::onConnectionFinished(const QString &hostname)
 
     SocksProxyConnection *connection = static_cast<SocksProxyConnection *>(sender());
     //qCDebug(LOG_SOCKS_SERVER) << "Connection finished:" << connection;
-    QMap<SocksProxyConnection *, QThread *>::iterator it = connections_.find(connection);
-    Q_ASSERT(it != connections_.end());
-
-    QMap<QThread *, quint32>::iterator itThread = threads_.find(it.value());
-    Q_ASSERT(itThread != threads_.end());
-    itThread.value()--;
-
-    it.key()->deleteLater();
-    connections_.erase(it);
+    Q_ASSERT(connections_.contains(connection));
+    threadPool_->removeConnection(connection);
+    usersCounter_->removeTrafficSource(connection);
+    connections_.remove(connection);
+    connection->deleteLater();
 
     //qCDebug(LOG_SOCKS_SERVER) << "Count of connections:" << connections_.count();
 }
 
-QThread *SocksProxyConnectionManager::getLessBusyThread()
+QVector<ProxyThreadPool::ThreadLoad> SocksProxyConnectionManager::dumpThreads() const
 {
-    Q_ASSERT(threads_.count() > 0);
-    quint32 min = threads_.begin().value();
-    QThread *thread = threads_.begin().key();
-    for (QMap<QThread *, quint32>::iterator it = threads_.begin() + 1; it != threads_.end(); ++it)
+    const QVector<ProxyThreadPool::ThreadLoad> load = threadPool_->threadsLoad();
+    for (const ProxyThreadPool::ThreadLoad &thread : load)
     {
-        if (it.value() < min)
-        {
-            min = it.value();
-            thread = it.key();
-        }
+        qCDebug(LOG_SOCKS_SERVER) << "Thread:" << thread.index << "connections:" << thread.connections << "KB/s:"
+                                  << thread.bytesPerSec / 1024 << "event loop latency:" << thread.eventLoopLatencyMs << "ms";
     }
-    return thread;
-}
-
-void SocksProxyConnectionManager::addConnectionToThread(QThread *thread, SocksProxyConnection *connection)
-{
-    //qCDebug(LOG_SOCKS_SERVER) << "Connection started:" << connection;
-    connection->moveToThread(thread);
-    QTimer::singleShot(0, connection, SLOT(start()));
-    Q_ASSERT(!connections_.contains(connection));
-    connections_[connection] = thread;
-    threads_[thread]++;
+    return load;
 }
 
 } // namespace SocksProxyServer
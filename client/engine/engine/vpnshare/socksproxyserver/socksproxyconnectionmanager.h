@@ -2,9 +2,10 @@
 #define SOCKSPROXYCONNECTIONMANAGER_H
 
 #include <QObject>
-#include <QMap>
+#include <QSet>
 #include "socksproxyconnection.h"
 #include "../connecteduserscounter.h"
+#include "../socketutils/proxythreadpool.h"
 
 namespace SocksProxyServer {
 
@@ -12,6 +13,7 @@ class SocksProxyConnectionManager : public QObject
 {
     Q_OBJECT
 public:
+    // 0 threads - as many as the cores
     explicit SocksProxyConnectionManager(QObject *parent, int threadsCount, ConnectedUsersCounter *usersCounter);
 
 public:
@@ -19,16 +21,16 @@ public:
     void closeAllConnections();
     void stop();
 
+    // the load of the worker threads, also written to the log
+    QVector<ProxyThreadPool::ThreadLoad> dumpThreads() const;
+
 private slots:
     void onConnectionFinished(const QString &hostname);
 
 private:
-    QMap<QThread *, quint32> threads_;
-    QMap<SocksProxyConnection *, QThread *> connections_;
+    ProxyThreadPool *threadPool_;
+    QSet<SocksProxyConnection *> connections_;
     ConnectedUsersCounter *usersCounter_;
-
-    QThread *getLessBusyThread();
-    void addConnectionToThread(QThread *thread, SocksProxyConnection *connection);
 };
 
 } // namespace SocksProxyServer
@@ -7,7 +7,9 @@ SocksProxyServer::SocksProxyServer(QObject *parent) : QTcpServer(parent)
 {
     usersCounter_ = new ConnectedUsersCounter(this);
     connect(usersCounter_, SIGNAL(usersCountChanged()), SIGNAL(usersCountChanged()));
-    connectionManager_ = new SocksProxyConnectionManager(this, 4, usersCounter_);
+    connect(usersCounter_, SIGNAL(trafficChanged()), SIGNAL(trafficChanged()));
+    // one event loop per core, the connections are spread over them
+    connectionManager_ = new SocksProxyConnectionManager(this, 0, usersCounter_);
 }
 
 SocksProxyServer::~SocksProxyServer()
@@ -46,6 +48,11 @@ int SocksProxyServer::getConnectedUsersCount()
     return usersCounter_->getConnectedUsersCount();
 }
 
+QVector<ConnectedUsersCounter::HostTraffic> SocksProxyServer::getTopTalkers(int count)
+{
+    return usersCounter_->getTopTalkers(count);
+}
+
 void SocksProxyServer::closeActiveConnections()
 {
     connectionManager_->closeAllConnections();
@@ -19,11 +19,13 @@ public:
     void stopServer();
 
     int getConnectedUsersCount();
+    QVector<ConnectedUsersCounter::HostTraffic> getTopTalkers(int count);
 
     void closeActiveConnections();
 
 signals:
     void usersCountChanged();
+    void trafficChanged();
 
 protected:
     virtual void incomingConnection(qintptr socketDescriptor);
@@ -38,6 +38,7 @@ void VpnShareController::startProxySharing(PROXY_SHARING_TYPE proxyType)
     {
         httpProxyServer_ = new HttpProxyServer::HttpProxyServer(this);
         connect(httpProxyServer_, SIGNAL(usersCountChanged()), SLOT(onProxyUsersCountChanged()));
+        connect(httpProxyServer_, SIGNAL(trafficChanged()), SLOT(onProxyTrafficChanged()));
 
         uint port;
         bool isStarted = false;
@@ -56,6 +57,7 @@ void VpnShareController::startProxySharing(PROXY_SHARING_TYPE proxyType)
     {
         socksProxyServer_ = new SocksProxyServer::SocksProxyServer(this);
         connect(socksProxyServer_, SIGNAL(usersCountChanged()), SLOT(onProxyUsersCountChanged()));
+        connect(socksProxyServer_, SIGNAL(trafficChanged()), SLOT(onProxyTrafficChanged()));
 
         uint port;
         bool isStarted = false;
@@ -145,6 +147,32 @@ void VpnShareController::onProxyUsersCountChanged()
     Q_EMIT connectedProxyUsersChanged(cntUsers);
 }
 
+void VpnShareController::onProxyTrafficChanged()
+{
+    QMutexLocker locker(&mutex_);
+
+    QVector<ConnectedUsersCounter::HostTraffic> hosts;
+    if (httpProxyServer_)
+    {
+        hosts = httpProxyServer_->getTopTalkers(TOP_TALKERS_COUNT);
+    }
+    else if (socksProxyServer_)
+    {
+        hosts = socksProxyServer_->getTopTalkers(TOP_TALKERS_COUNT);
+    }
+
+    ProtoTypes::ProxySharingTraffic traffic;
+    for (const ConnectedUsersCounter::HostTraffic &host : qAsConst(hosts))
+    {
+        ProtoTypes::ProxySharingClient *client = traffic.add_top_clients();
+        client->set_address(host.hostname.toStdString());
+        client->set_connections_count(host.connections);
+        client->set_bytes_total(host.bytesTotal);
+        client->set_bytes_per_sec(host.bytesPerSec);
+    }
+    Q_EMIT proxyTrafficChanged(traffic);
+}
+
 void VpnShareController::startWifiSharing(const QString &ssid, const QString &password)
 {
     QMutexLocker locker(&mutex_);
@@ -263,15 +291,14 @@ void VpnShareController::onDisconnectedFromVPNEvent()
     }
 }
 
-bool VpnShareController::isUpdateIcsInProgress()
+void VpnShareController::waitForUpdateIcsFinished()
 {
 #ifdef Q_OS_WIN
     if (wifiSharing_)
     {
-        return wifiSharing_->isUpdateIcsInProgress();
+        wifiSharing_->waitForUpdateIcsFinished();
     }
 #endif
-    return false;
 }
 
 
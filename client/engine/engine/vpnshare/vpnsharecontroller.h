@@ -23,7 +23,7 @@ public:
     void onConnectingOrConnectedToVPNEvent(const QString &vpnAdapterName);
     void onDisconnectedFromVPNEvent();
 
-    bool isUpdateIcsInProgress();
+    void waitForUpdateIcsFinished();
 
     void startProxySharing(PROXY_SHARING_TYPE proxyType);
     void stopProxySharing();
@@ -40,12 +40,16 @@ public:
 signals:
     void connectedWifiUsersChanged(int usersCount);
     void connectedProxyUsersChanged(int usersCount);
+    void proxyTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic);
 
 private slots:
     void onWifiUsersCountChanged();
     void onProxyUsersCountChanged();
+    void onProxyTrafficChanged();
 
 private:
+    enum { TOP_TALKERS_COUNT = 3 };
+
     QMutex mutex_;
     IHelper *helper_;
     HttpProxyServer::HttpProxyServer *httpProxyServer_;
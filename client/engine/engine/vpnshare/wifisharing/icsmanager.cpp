@@ -1,5 +1,5 @@
 #include "icsmanager.h"
-#include <QCoreApplication>
+#include <QDeadlineTimer>
 #include <QDir>
 #include <QStandardPaths>
 #include "Utils/logger.h"
@@ -7,7 +7,7 @@
 #define WINDSCRIBE_UPDATE_ICS_EVENT_NAME L"Global\\WindscribeUpdateIcsEvent1034"
 
 IcsManager::IcsManager(QObject *parent, IHelper *helper) : QThread(parent),
-    bNeedFinish_(false), isUpdateIcsCmdInProgress_(false), cmdIdInProgress_(0), hWaitFunc_(0)
+    isUpdateIcsCmdInProgress_(false), hWaitFunc_(0)
 {
     helper_ = dynamic_cast<Helper_win *>(helper);
     Q_ASSERT(helper_);
@@ -16,7 +16,6 @@ IcsManager::IcsManager(QObject *parent, IHelper *helper) : QThread(parent),
     dir.mkpath(strPath);
     path_ = strPath + "/ics.dat";
     hEvent_ = CreateEvent(NULL, TRUE, FALSE, WINDSCRIBE_UPDATE_ICS_EVENT_NAME);
-    updateIcsExePath_ = QCoreApplication::applicationDirPath() + "/ChangeIcs.exe";
 }
 
 IcsManager::~IcsManager()
@@ -44,28 +43,13 @@ bool IcsManager::startIcs()
         return false;
     }
 
-    QString cmdLine = "\"" + updateIcsExePath_ + "\" -save \"" + path_ + "\"";
-    unsigned long cmdId;
-
-    if (helper_->executeChangeIcs(0, path_, "", "", cmdId, ""))
-    {
-        qCDebug(LOG_WLAN_MANAGER) << cmdLine;
-
-        QString logStr;
-        bool bFinished = false;
-        while (!bFinished)
-        {
-            helper_->getUnblockingCmdStatus(cmdId, logStr, bFinished);
-            QThread::msleep(1);
-        }
-        qCDebug(LOG_WLAN_MANAGER) << logStr;
-        return true;
-    }
-    else
+    if (!helper_->executeChangeIcs(0, path_, "", "", ""))
     {
-        qCDebug(LOG_WLAN_MANAGER) << "Failed start process:" << cmdLine;
+        qCDebug(LOG_WLAN_MANAGER) << "Failed to save ICS settings:" << path_;
         return false;
     }
+    qCDebug(LOG_WLAN_MANAGER) << "ICS settings saved:" << path_;
+    return true;
 }
 
 bool IcsManager::stopIcs()
@@ -76,35 +60,15 @@ bool IcsManager::stopIcs()
         return false;
     }
 
-    // wait for finish update ics cmd
-    while (isUpdateIcsCmdInProgress_)
-    {
-        QThread::msleep(1);
-    }
+    waitForUpdateIcsFinished();
 
-    QString cmdLine = "\"" + updateIcsExePath_ + "\" -restore \"" + path_ + "\"";
-    unsigned long cmdId;
-
-    if (helper_->executeChangeIcs(1, path_, "", "", cmdId, ""))
+    if (!helper_->executeChangeIcs(1, path_, "", "", ""))
     {
-        qCDebug(LOG_WLAN_MANAGER) << cmdLine;
-
-        QString logStr;
-        bool bFinished = false;
-        while (!bFinished)
-        {
-            helper_->getUnblockingCmdStatus(cmdId, logStr, bFinished);
-            QThread::msleep(1);
-        }
-
-        qCDebug(LOG_WLAN_MANAGER) << logStr;
-        return true;
-    }
-    else
-    {
-        qCDebug(LOG_WLAN_MANAGER) << "Failed start process:" << cmdLine;
+        qCDebug(LOG_WLAN_MANAGER) << "Failed to restore ICS settings:" << path_;
         return false;
     }
+    qCDebug(LOG_WLAN_MANAGER) << "ICS settings restored:" << path_;
+    return true;
 }
 
 bool IcsManager::changeIcsSettings(const GUID &publicGuid, const GUID &privateGuid)
@@ -131,10 +95,19 @@ bool IcsManager::changeIcsSettings(const GUID &publicGuid, const GUID &privateGu
     return true;
 }
 
-bool IcsManager::isUpdateIcsInProgress()
+void IcsManager::waitForUpdateIcsFinished()
 {
+    // including the change queued in lastCmdInfo_, it's started by the callback before the flag is cleared
     QMutexLocker locker(&mutexCmdInProgress_);
-    return isUpdateIcsCmdInProgress_;
+    QDeadlineTimer deadline(WAIT_UPDATE_ICS_TIMEOUT_MS);
+    while (isUpdateIcsCmdInProgress_)
+    {
+        if (!waitCmdFinished_.wait(&mutexCmdInProgress_, deadline))
+        {
+            qCDebug(LOG_WLAN_MANAGER) << "IcsManager::waitForUpdateIcsFinished(), timeout";
+            break;
+        }
+    }
 }
 
 QString IcsManager::guidToStr(const GUID &guid)
@@ -154,10 +127,9 @@ void IcsManager::executeNextUpdateIcsCmd(const GUID &publicGuid, const GUID &pri
     QString strPublicGuid = guidToStr(publicGuid);
     QString strPrivateGuid = guidToStr(privateGuid);
 
-    QString cmdLine = "\"" + updateIcsExePath_ + "\" -change " + strPublicGuid + " " + strPrivateGuid;
-    if (helper_->executeChangeIcs(2, "", strPublicGuid, strPrivateGuid, cmdIdInProgress_, QString::fromStdWString(WINDSCRIBE_UPDATE_ICS_EVENT_NAME)))
+    if (helper_->executeChangeIcs(2, "", strPublicGuid, strPrivateGuid, QString::fromStdWString(WINDSCRIBE_UPDATE_ICS_EVENT_NAME)))
     {
-        qCDebug(LOG_WLAN_MANAGER) << cmdLine;
+        qCDebug(LOG_WLAN_MANAGER) << "Change ICS settings:" << strPublicGuid << strPrivateGuid;
 
         isUpdateIcsCmdInProgress_ = true;
         RegisterWaitForSingleObject(&hWaitFunc_, hEvent_, waitEventCallback,
@@ -165,7 +137,7 @@ void IcsManager::executeNextUpdateIcsCmd(const GUID &publicGuid, const GUID &pri
     }
     else
     {
-        qCDebug(LOG_WLAN_MANAGER) << "Failed start process:" << cmdLine;
+        qCDebug(LOG_WLAN_MANAGER) << "Failed to change ICS settings:" << strPublicGuid << strPrivateGuid;
     }
 }
 
@@ -176,10 +148,7 @@ void IcsManager::waitEventCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired)
     IcsManager *this_ = static_cast<IcsManager *>(lpParameter);
     QMutexLocker locker(&this_->mutexCmdInProgress_);
     UnregisterWaitEx(this_->hWaitFunc_, NULL);
-    QString logStr;
-    bool bFinished = false;
-    this_->helper_->getUnblockingCmdStatus(this_->cmdIdInProgress_, logStr, bFinished);
-    qCDebug(LOG_WLAN_MANAGER) << logStr;
+    qCDebug(LOG_WLAN_MANAGER) << "ICS settings changed";
     this_->isUpdateIcsCmdInProgress_ = false;
 
     if (this_->lastCmdInfo_.isValid)
@@ -187,4 +156,8 @@ void IcsManager::waitEventCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired)
         this_->executeNextUpdateIcsCmd(this_->lastCmdInfo_.publicGuid, this_->lastCmdInfo_.privateGuid);
         this_->lastCmdInfo_.isValid = false;
     }
+    if (!this_->isUpdateIcsCmdInProgress_)
+    {
+        this_->waitCmdFinished_.wakeAll();
+    }
 }
@@ -9,7 +9,9 @@
 #include <Rpc.h>
 
 // IcsManager works through helper, because need admin rights
-// and 64 bit version of helper for Win64
+// and 64 bit version of helper for Win64.
+// The helper keeps the ICS session: save and restore return when they are done, change is applied
+// in the background and the helper signals hEvent_ when it's finished.
 class IcsManager : public QThread
 {
     Q_OBJECT
@@ -22,18 +24,19 @@ public:
     bool stopIcs();
     bool changeIcsSettings(const GUID &publicGuid, const GUID &privateGuid);
 
-    bool isUpdateIcsInProgress();
+    void waitForUpdateIcsFinished();
 
 private:
+    // the service applies a change in well under a second, a stuck one must not hold the connect forever
+    static constexpr int WAIT_UPDATE_ICS_TIMEOUT_MS = 10000;
+
     Helper_win *helper_;
 
     QString path_;
-    QString updateIcsExePath_;
-    bool bNeedFinish_;
 
     bool isUpdateIcsCmdInProgress_;
-    unsigned long cmdIdInProgress_;
     QMutex mutexCmdInProgress_;
+    QWaitCondition waitCmdFinished_;
     HANDLE hEvent_;
     HANDLE hWaitFunc_;
 
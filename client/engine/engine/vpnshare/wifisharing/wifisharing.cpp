@@ -100,9 +100,9 @@ int WifiSharing::getConnectedUsersCount()
     return wlanManager_->getConnectedUsersCount();
 }
 
-bool WifiSharing::isUpdateIcsInProgress()
+void WifiSharing::waitForUpdateIcsFinished()
 {
-    return icsManager_->isUpdateIcsInProgress();
+    icsManager_->waitForUpdateIcsFinished();
 }
 
 void WifiSharing::onWlanStarted()
@@ -29,7 +29,7 @@ public:
 
     int getConnectedUsersCount();
 
-    bool isUpdateIcsInProgress();
+    void waitForUpdateIcsFinished();
 
 signals:
     void usersCountChanged();
@@ -0,0 +1,123 @@
+#include "allowedips.h"
+
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+quint32 maskOf(int prefix)
+{
+    return prefix == 0 ? 0 : (0xFFFFFFFFu << (32 - prefix));
+}
+
+bool parseIpv4(const QStringRef &str, quint32 &ip)
+{
+    const QVector<QStringRef> octets = str.split('.');
+    if (octets.size() != 4)
+    {
+        return false;
+    }
+    ip = 0;
+    for (const QStringRef &octet : octets)
+    {
+        bool ok = false;
+        const uint value = octet.toUInt(&ok);
+        if (!ok || value > 255)
+        {
+            return false;
+        }
+        ip = (ip << 8) | value;
+    }
+    return true;
+}
+
+} // namespace
+
+bool AllowedIps::parse(const QString &allowedIps)
+{
+    networks_.clear();
+    prefixes_.clear();
+
+    const QVector<QStringRef> entries = allowedIps.splitRef(QRegExp("[,; ]"), QString::SkipEmptyParts);
+    networks_.reserve(entries.size());
+    prefixes_.reserve(entries.size());
+    for (const QStringRef &entry : entries)
+    {
+        const int slash = entry.indexOf('/');
+        quint32 ip = 0;
+        if (!parseIpv4(slash < 0 ? entry : entry.left(slash), ip))
+        {
+            return false;
+        }
+        uint prefix = 32;
+        if (slash >= 0)
+        {
+            bool ok = false;
+            prefix = entry.mid(slash + 1).toUInt(&ok);
+            if (!ok || prefix > 32)
+            {
+                return false;
+            }
+        }
+        networks_ << (ip & maskOf(prefix));
+        prefixes_ << prefix;
+    }
+    normalize();
+    return true;
+}
+
+QString AllowedIps::toString() const
+{
+    QString str;
+    str.reserve(networks_.size() * 19);
+    for (int i = 0; i < networks_.size(); ++i)
+    {
+        if (i > 0)
+        {
+            str += ',';
+        }
+        const quint32 ip = networks_[i];
+        str += QString::number(ip >> 24) + '.' + QString::number((ip >> 16) & 0xFF) + '.' +
+               QString::number((ip >> 8) & 0xFF) + '.' + QString::number(ip & 0xFF) + '/' + QString::number(prefixes_[i]);
+    }
+    return str;
+}
+
+void AllowedIps::normalize()
+{
+    // sorted by the address, the wider prefix first for the same address
+    QVector<int> order(networks_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int i1, int i2) {
+        return networks_[i1] != networks_[i2] ? networks_[i1] < networks_[i2] : prefixes_[i1] < prefixes_[i2];
+    });
+
+    // the sorted list as a stack, every entry is merged with its sibling on the top of the stack while it can be
+    QVector<quint32> networks;
+    QVector<quint8> prefixes;
+    networks.reserve(order.size());
+    prefixes.reserve(order.size());
+    for (int i : qAsConst(order))
+    {
+        quint32 network = networks_[i];
+        quint8 prefix = prefixes_[i];
+        if (!networks.isEmpty() && (network & maskOf(prefixes.last())) == networks.last())
+        {
+            continue;   // covered by the previous one
+        }
+        while (!networks.isEmpty() && prefix > 1 && prefixes.last() == prefix &&
+               (networks.last() ^ network) == (1u << (32 - prefix)) && (network & (1u << (32 - prefix))))
+        {
+            networks.removeLast();
+            prefixes.removeLast();
+            prefix--;
+            network &= maskOf(prefix);
+        }
+        networks << network;
+        prefixes << prefix;
+    }
+    networks_ = networks;
+    prefixes_ = prefixes;
+}
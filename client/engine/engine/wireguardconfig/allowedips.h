@@ -0,0 +1,30 @@
+#ifndef ALLOWEDIPS_H
+#define ALLOWEDIPS_H
+
+#include <QString>
+#include <QVector>
+
+// The IPv4 AllowedIPs of a WireGuard peer as the network addresses (host order) and their prefix lengths, sorted, with
+// the prefixes covered by others dropped and the sibling prefixes merged. The split route configs with thousands of
+// entries become a lot fewer routes for the helper to add. The merge stops at /1, the helpers treat /0 as the
+// default route (and "0.0.0.0/1, 128.0.0.0/1" is the way to have all the traffic without it).
+class AllowedIps
+{
+public:
+    AllowedIps() = default;
+
+    // false if any of the entries is not an IPv4 address with an optional prefix length
+    bool parse(const QString &allowedIps);
+    QString toString() const;
+
+    int count() const { return networks_.size(); }
+    bool isEmpty() const { return networks_.isEmpty(); }
+
+private:
+    QVector<quint32> networks_;
+    QVector<quint8> prefixes_;
+
+    void normalize();
+};
+
+#endif // ALLOWEDIPS_H
@@ -1,4 +1,6 @@
 #include "getwireguardconfig.h"
+#include <QTimer>
+#include "wireguardconnectcache.h"
 #include "engine/serverapi/serverapi.h"
 #include "utils/protobuf_includes.h"
 
@@ -6,7 +8,7 @@ const QString GetWireGuardConfig::KEY_WIREGUARD_CONFIG = "wireguardConfig";
 
 GetWireGuardConfig::GetWireGuardConfig(QObject *parent, ServerAPI *serverAPI, uint serverApiUserRole) : QObject(parent), serverAPI_(serverAPI),
     serverApiUserRole_(serverApiUserRole),
-    isRequestAlreadyInProgress_(false), simpleCrypt_(0x4572A4ACF31A31BA)
+    isRequestAlreadyInProgress_(false), crypt_(0x4572A4ACF31A31BA)
 {
     connect(serverAPI_, &ServerAPI::wgConfigsInitAnswer, this, &GetWireGuardConfig::onWgConfigsInitAnswer, Qt::QueuedConnection);
     connect(serverAPI_, &ServerAPI::wgConfigsConnectAnswer, this, &GetWireGuardConfig::onWgConfigsConnectAnswer, Qt::QueuedConnection);
@@ -27,15 +29,18 @@ void GetWireGuardConfig::getWireGuardConfig(const QString &serverName, bool dele
     isRetryConnectRequest_ = false;
     isRetryInitRequest_ = false;
 
-    wireGuardConfig_.reset();
     // restore a key-pair and peer parameters stored on disk
     // if they are not found in settings, they will be generated and saved later by this class flow.
-    QString publicKey, privateKey, presharedKey, allowedIPs;
-    if (getWireGuardKeyPair(publicKey, privateKey) && getWireGuardPeerInfo(presharedKey, allowedIPs))
+    if (restoreStoredConfig())
     {
-        wireGuardConfig_.setKeyPair(publicKey, privateKey);
-        wireGuardConfig_.setPeerPresharedKey(presharedKey);
-        wireGuardConfig_.setPeerAllowedIPs(allowedIPs);
+        QString ipAddress, dnsAddress;
+        if (WireGuardConnectCache::instance().get(wireGuardConfig_.clientPublicKey(), serverName_, ipAddress, dnsAddress))
+        {
+            wireGuardConfig_.setClientIpAddress(ipAddress);
+            wireGuardConfig_.setClientDnsAddress(dnsAddress);
+            emitAnswerLater(SERVER_RETURN_SUCCESS);
+            return;
+        }
         serverAPI_->wgConfigsConnect(apiinfo::ApiInfo::getAuthHash(), serverApiUserRole_, true, wireGuardConfig_.clientPublicKey(), serverName_);
     }
     else
@@ -44,6 +49,35 @@ void GetWireGuardConfig::getWireGuardConfig(const QString &serverName, bool dele
     }
 }
 
+void GetWireGuardConfig::prefetchWireGuardConfig(const QString &serverName)
+{
+    if (isRequestAlreadyInProgress_)
+    {
+        Q_ASSERT(false);
+        return;
+    }
+
+    isRequestAlreadyInProgress_ = true;
+    serverName_ = serverName;
+    deleteOldestKey_ = false;
+    isErrorCode1311Guard_ = true;   // never reset the keys in the background
+    isRetryConnectRequest_ = true;
+    isRetryInitRequest_ = true;
+
+    // the keys are registered only by the real connection
+    if (!restoreStoredConfig())
+    {
+        emitAnswerLater(SERVER_RETURN_NETWORK_ERROR);
+        return;
+    }
+    if (WireGuardConnectCache::instance().contains(wireGuardConfig_.clientPublicKey(), serverName_))
+    {
+        emitAnswerLater(SERVER_RETURN_SUCCESS);
+        return;
+    }
+    serverAPI_->wgConfigsConnect(apiinfo::ApiInfo::getAuthHash(), serverApiUserRole_, true, wireGuardConfig_.clientPublicKey(), serverName_);
+}
+
 void GetWireGuardConfig::onWgConfigsInitAnswer(SERVER_API_RET_CODE retCode, uint userRole, bool isErrorCode, int errorCode, const QString &presharedKey, const QString &allowedIps)
 {
     if (serverApiUserRole_ != userRole)
@@ -136,6 +170,8 @@ void GetWireGuardConfig::onWgConfigsConnectAnswer(SERVER_API_RET_CODE retCode, u
 
     wireGuardConfig_.setClientIpAddress(WireGuardConfig::stripIpv6Address(ipAddress));
     wireGuardConfig_.setClientDnsAddress(WireGuardConfig::stripIpv6Address(dnsAddress));
+    WireGuardConnectCache::instance().put(wireGuardConfig_.clientPublicKey(), serverName_,
+                                          wireGuardConfig_.clientIpAddress(), wireGuardConfig_.clientDnsAddress());
     isRequestAlreadyInProgress_ = false;
     emit getWireGuardConfigAnswer(SERVER_RETURN_SUCCESS, wireGuardConfig_);
 }
@@ -156,6 +192,29 @@ void GetWireGuardConfig::submitWireGuardInitRequest(bool generateKeyPair)
     serverAPI_->wgConfigsInit(apiinfo::ApiInfo::getAuthHash(), serverApiUserRole_, true, wireGuardConfig_.clientPublicKey(), deleteOldestKey_);
 }
 
+bool GetWireGuardConfig::restoreStoredConfig()
+{
+    wireGuardConfig_.reset();
+    QString publicKey, privateKey, presharedKey, allowedIPs;
+    if (getWireGuardKeyPair(publicKey, privateKey) && getWireGuardPeerInfo(presharedKey, allowedIPs))
+    {
+        wireGuardConfig_.setKeyPair(publicKey, privateKey);
+        wireGuardConfig_.setPeerPresharedKey(presharedKey);
+        wireGuardConfig_.setPeerAllowedIPs(allowedIPs);
+        return true;
+    }
+    return false;
+}
+
+void GetWireGuardConfig::emitAnswerLater(SERVER_API_RET_CODE retCode)
+{
+    // keep the answer asynchronous, as it is when it comes from ServerAPI
+    QTimer::singleShot(0, this, [this, retCode]() {
+        isRequestAlreadyInProgress_ = false;
+        emit getWireGuardConfigAnswer(retCode, wireGuardConfig_);
+    });
+}
+
 bool GetWireGuardConfig::getWireGuardKeyPair(QString &publicKey, QString &privateKey)
 {
     ProtoApiInfo::WireGuardConfig wgConfig = readWireGuardConfigFromSettings();
@@ -204,7 +263,7 @@ ProtoApiInfo::WireGuardConfig GetWireGuardConfig::readWireGuardConfigFromSetting
         QString s = settings.value(KEY_WIREGUARD_CONFIG, "").toString();
         if (!s.isEmpty())
         {
-            QByteArray arr = simpleCrypt_.decryptToByteArray(s);
+            QByteArray arr = crypt_.decryptToByteArray(s);
             ProtoApiInfo::WireGuardConfig wgConfig;
             if (wgConfig.ParseFromArray(arr.data(), arr.size()))
             {
@@ -221,11 +280,13 @@ void GetWireGuardConfig::writeWireGuardConfigToSettings(const ProtoApiInfo::Wire
     size_t size = wgConfig.ByteSizeLong();
     QByteArray arr(size, Qt::Uninitialized);
     wgConfig.SerializeToArray(arr.data(), size);
-    settings.setValue(KEY_WIREGUARD_CONFIG, simpleCrypt_.encryptToString(arr));
+    settings.setValue(KEY_WIREGUARD_CONFIG, crypt_.encryptToString(arr));
 }
 
 void GetWireGuardConfig::removeWireGuardSettings()
 {
+    WireGuardConnectCache::instance().clear();
+
     QSettings settings;
     settings.remove(KEY_WIREGUARD_CONFIG);
 
@@ -4,13 +4,14 @@
 #include <QObject>
 #include "engine/types/types.h"
 #include "wireguardconfig.h"
-#include "utils/simplecrypt.h"
+#include "utils/aesgcmcrypt.h"
 
 class ServerAPI;
 
 // manages the logic of getting a WireGuard config using ServerAPI (wgConfigsInit(...) and wgConfigsConnect(...) functions)
 // also saves/restores some values of WireGuard config as permanent in settings
 // should be used before making connection
+// the answers of wgConfigsConnect are kept in WireGuardConnectCache and reused while they are fresh
 
 class GetWireGuardConfig : public QObject
 {
@@ -19,6 +20,8 @@ public:
     GetWireGuardConfig(QObject *parent, ServerAPI *serverAPI, uint serverApiUserRole);
 
     void getWireGuardConfig(const QString &serverName, bool deleteOldestKey);
+    // only fills the cache with the connect answer for the server, never registers or resets the keys
+    void prefetchWireGuardConfig(const QString &serverName);
     static void removeWireGuardSettings();
 
 signals:
@@ -40,9 +43,11 @@ private:
     bool isRetryConnectRequest_;
     bool isRetryInitRequest_;
     bool isRequestAlreadyInProgress_;
-    SimpleCrypt simpleCrypt_;
+    AesGcmCrypt crypt_;
 
     void submitWireGuardInitRequest(bool generateKeyPair);
+    bool restoreStoredConfig();
+    void emitAnswerLater(SERVER_API_RET_CODE retCode);
 
     bool getWireGuardKeyPair(QString &publicKey, QString &privateKey);
     void setWireGuardKeyPair(const QString &publicKey, const QString &privateKey);
@@ -0,0 +1,64 @@
+#include "wireguardconfigprefetcher.h"
+#include "engine/serverapi/serverapi.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+WireGuardConfigPrefetcher::WireGuardConfigPrefetcher(QObject *parent, ServerAPI *serverAPI) : QObject(parent),
+    serverAPI_(serverAPI), getConfig_(nullptr), isBusy_(false)
+{
+}
+
+void WireGuardConfigPrefetcher::prefetch(const QStringList &serverNames)
+{
+    for (const QString &serverName : serverNames)
+    {
+        if (!serverName.isEmpty() && !queue_.contains(serverName))
+        {
+            queue_ << serverName;
+        }
+    }
+
+    if (!isBusy_)
+    {
+        prefetchNext();
+    }
+}
+
+void WireGuardConfigPrefetcher::stop()
+{
+    queue_.clear();
+    isBusy_ = false;
+    SAFE_DELETE_LATER(getConfig_);
+}
+
+void WireGuardConfigPrefetcher::onGetWireGuardConfigAnswer(SERVER_API_RET_CODE retCode, const WireGuardConfig &config)
+{
+    Q_UNUSED(config);
+    if (retCode != SERVER_RETURN_SUCCESS)
+    {
+        // don't try the rest, the next connection gets the config from the API as usual
+        qCDebug(LOG_CONNECTION) << "WireGuard config prefetch failed, retCode =" << retCode;
+        stop();
+        return;
+    }
+    prefetchNext();
+}
+
+void WireGuardConfigPrefetcher::prefetchNext()
+{
+    if (queue_.isEmpty())
+    {
+        isBusy_ = false;
+        return;
+    }
+
+    if (!getConfig_)
+    {
+        // an own user role, so the answers are not mixed up with the ones of the connection
+        getConfig_ = new GetWireGuardConfig(this, serverAPI_, serverAPI_->getAvailableUserRole());
+        connect(getConfig_, &GetWireGuardConfig::getWireGuardConfigAnswer, this, &WireGuardConfigPrefetcher::onGetWireGuardConfigAnswer);
+    }
+
+    isBusy_ = true;
+    getConfig_->prefetchWireGuardConfig(queue_.takeFirst());
+}
@@ -0,0 +1,31 @@
+#ifndef WIREGUARDCONFIGPREFETCHER_H
+#define WIREGUARDCONFIGPREFETCHER_H
+
+#include <QObject>
+#include <QStringList>
+#include "getwireguardconfig.h"
+
+// fetches the WireGuard configs of the servers into WireGuardConnectCache in the background, one request at a time,
+// so the next connection to these servers starts without the wgConfigsConnect round trip
+class WireGuardConfigPrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    WireGuardConfigPrefetcher(QObject *parent, ServerAPI *serverAPI);
+
+    void prefetch(const QStringList &serverNames);
+    void stop();
+
+private slots:
+    void onGetWireGuardConfigAnswer(SERVER_API_RET_CODE retCode, const WireGuardConfig &config);
+
+private:
+    ServerAPI *serverAPI_;
+    GetWireGuardConfig *getConfig_;
+    QStringList queue_;
+    bool isBusy_;
+
+    void prefetchNext();
+};
+
+#endif // WIREGUARDCONFIGPREFETCHER_H
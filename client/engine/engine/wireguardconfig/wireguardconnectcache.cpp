@@ -0,0 +1,68 @@
+#include "wireguardconnectcache.h"
+
+bool WireGuardConnectCache::get(const QString &publicKey, const QString &serverName, QString &ipAddress, QString &dnsAddress)
+{
+    QMutexLocker locker(&mutex_);
+    auto it = entries_.find(key(publicKey, serverName));
+    if (it == entries_.end())
+    {
+        return false;
+    }
+    if (isExpired(it.value()))
+    {
+        entries_.erase(it);
+        return false;
+    }
+    ipAddress = it->ipAddress;
+    dnsAddress = it->dnsAddress;
+    return true;
+}
+
+bool WireGuardConnectCache::contains(const QString &publicKey, const QString &serverName)
+{
+    QString ipAddress, dnsAddress;
+    return get(publicKey, serverName, ipAddress, dnsAddress);
+}
+
+void WireGuardConnectCache::put(const QString &publicKey, const QString &serverName, const QString &ipAddress, const QString &dnsAddress)
+{
+    QMutexLocker locker(&mutex_);
+    Entry entry;
+    entry.serverName = serverName;
+    entry.ipAddress = ipAddress;
+    entry.dnsAddress = dnsAddress;
+    entry.fetchTime = QDateTime::currentDateTimeUtc();
+    entries_[key(publicKey, serverName)] = entry;
+}
+
+void WireGuardConnectCache::remove(const QString &serverName)
+{
+    QMutexLocker locker(&mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); )
+    {
+        if (it->serverName == serverName)
+        {
+            it = entries_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void WireGuardConnectCache::clear()
+{
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+}
+
+QString WireGuardConnectCache::key(const QString &publicKey, const QString &serverName)
+{
+    return publicKey + "/" + serverName;
+}
+
+bool WireGuardConnectCache::isExpired(const Entry &entry) const
+{
+    return entry.fetchTime.secsTo(QDateTime::currentDateTimeUtc()) >= ENTRY_LIFETIME_SECS;
+}
@@ -0,0 +1,47 @@
+#ifndef WIREGUARDCONNECTCACHE_H
+#define WIREGUARDCONNECTCACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// in-memory cache of the answers of wgConfigsConnect (the client ip and dns for the server), per public key and server name,
+// so the connection to a recently used or a prefetched location doesn't wait for the API call
+class WireGuardConnectCache
+{
+public:
+    static WireGuardConnectCache &instance()
+    {
+        static WireGuardConnectCache wcc;
+        return wcc;
+    }
+
+    bool get(const QString &publicKey, const QString &serverName, QString &ipAddress, QString &dnsAddress);
+    bool contains(const QString &publicKey, const QString &serverName);
+    void put(const QString &publicKey, const QString &serverName, const QString &ipAddress, const QString &dnsAddress);
+    void remove(const QString &serverName);
+    void clear();
+
+private:
+    WireGuardConnectCache() {}
+
+    // the API doesn't tell how long the address is reserved for the key, so the entries expire after this time
+    static constexpr qint64 ENTRY_LIFETIME_SECS = 6 * 60 * 60;
+
+    struct Entry
+    {
+        QString serverName;
+        QString ipAddress;
+        QString dnsAddress;
+        QDateTime fetchTime;
+    };
+
+    QMutex mutex_;
+    QHash<QString, Entry> entries_;
+
+    static QString key(const QString &publicKey, const QString &serverName);
+    bool isExpired(const Entry &entry) const;
+};
+
+#endif // WIREGUARDCONNECTCACHE_H
@@ -1,6 +1,7 @@
 #include "engineserver.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 #include "ipc/server.h"
 #include "ipc/protobufcommand.h"
 #include "engine/openvpnversioncontroller.h"
@@ -15,13 +16,29 @@ EngineServer::EngineServer(QObject *parent) : QObject(parent)
   , engine_(NULL)
   , threadEngine_(NULL)
   , bClientAuthReceived_(false)
+  , isPendingStatistics_(false)
+  , pendingBytesIn_(0)
+  , pendingBytesOut_(0)
+  , isPendingTotalBytes_(false)
+  , coalescedUpdatesCount_(0)
 {
     curEngineSettings_.loadFromSettings();
+
+    bulkFlushTimer_ = new QTimer(this);
+    bulkFlushTimer_->setSingleShot(true);
+    connect(bulkFlushTimer_, SIGNAL(timeout()), SLOT(onBulkFlushTimer()));
+
+    saveSettingsTimer_ = new QTimer(this);
+    saveSettingsTimer_->setSingleShot(true);
+    saveSettingsTimer_->setInterval(SAVE_SETTINGS_DELAY_MS);
+    connect(saveSettingsTimer_, SIGNAL(timeout()), SLOT(onSaveSettingsTimer()));
 }
 
 EngineServer::~EngineServer()
 {
+    saveSettingsTimer_->stop();
     curEngineSettings_.saveToSettings();
+    SettingsStore::instance().flush();
 
     const auto connectionKeys = connections_.keys();
     for (auto connection : connectionKeys)
@@ -94,6 +111,7 @@ bool EngineServer::handleCommand(IPC::Command *command)
             connect(engine_, SIGNAL(wifiSharingStateChanged(bool, QString)), SLOT(onEngineWifiSharingStateChanged(bool, QString)));
             connect(engine_, SIGNAL(vpnSharingConnectedWifiUsersCountChanged(int)), SLOT(onEngineConnectedWifiUsersCountChanged(int)));
             connect(engine_, SIGNAL(vpnSharingConnectedProxyUsersCountChanged(int)), SLOT(onEngineConnectedProxyUsersCountChanged(int)));
+            connect(engine_, SIGNAL(vpnSharingProxyTrafficChanged(ProtoTypes::ProxySharingTraffic)), SLOT(onEngineProxySharingTrafficChanged(ProtoTypes::ProxySharingTraffic)));
             connect(engine_, SIGNAL(signOutFinished()), SLOT(onEngineSignOutFinished()));
             connect(engine_, SIGNAL(gotoCustomOvpnConfigModeFinished()), SLOT(onEngineGotoCustomOvpnConfigModeFinished()));
             connect(engine_, SIGNAL(detectionCpuUsageAfterConnected(QStringList)), SLOT(onEngineDetectionCpuUsageAfterConnected(QStringList)));
@@ -103,6 +121,9 @@ bool EngineServer::handleCommand(IPC::Command *command)
             connect(engine_, SIGNAL(confirmEmailFinished(bool)), SLOT(onEngineConfirmEmailFinished(bool)));
             connect(engine_, SIGNAL(sendDebugLogFinished(bool)), SLOT(onEngineSendDebugLogFinished(bool)));
             connect(engine_, SIGNAL(webSessionToken(ProtoTypes::WebSessionPurpose, QString)), SLOT(onEngineWebSessionToken(ProtoTypes::WebSessionPurpose, QString)));
+            connect(engine_, SIGNAL(throughputUpdated(ProtoTypes::Throughput)), SLOT(onEngineThroughputUpdated(ProtoTypes::Throughput)));
+            connect(engine_, SIGNAL(throughputHistory(ProtoTypes::ThroughputHistory)), SLOT(onEngineThroughputHistory(ProtoTypes::ThroughputHistory)));
+            connect(engine_, SIGNAL(tunnelSpeedTestFinished(ProtoTypes::TunnelSpeedTestResult)), SLOT(onEngineTunnelSpeedTestFinished(ProtoTypes::TunnelSpeedTestResult)));
             connect(engine_, SIGNAL(macAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)), SLOT(onMacAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)));
             connect(engine_, SIGNAL(sendUserWarning(ProtoTypes::UserWarningType)), SLOT(onEngineSendUserWarning(ProtoTypes::UserWarningType)));
             connect(engine_, SIGNAL(internetConnectivityChanged(bool)), SLOT(onEngineInternetConnectivityChanged(bool)));
@@ -276,6 +297,16 @@ bool EngineServer::handleCommand(IPC::Command *command)
         engine_->getWebSessionToken(cmd.getProtoObj().purpose());
         return true;
     }
+    else if (command->getStringId() == IPCClientCommands::GetThroughputHistory::descriptor()->full_name())
+    {
+        engine_->getThroughputHistory();
+        return true;
+    }
+    else if (command->getStringId() == IPCClientCommands::StartTunnelSpeedTest::descriptor()->full_name())
+    {
+        engine_->startTunnelSpeedTest();
+        return true;
+    }
     else if (command->getStringId() == IPCClientCommands::SendConfirmEmail::descriptor()->full_name())
     {
         engine_->sendConfirmEmail();
@@ -355,7 +386,7 @@ bool EngineServer::handleCommand(IPC::Command *command)
             {
                 engine_->setSettings(curEngineSettings_);
             }
-            curEngineSettings_.saveToSettings();
+            saveSettingsTimer_->start();
 
             //todo ?
             //Q_EMIT engineSettingsChanged(curEngineSettings_, connection);
@@ -396,8 +427,8 @@ bool EngineServer::handleCommand(IPC::Command *command)
 
         engine_->forceUpdateServerLocations();
 
-        IConnectStateController *eCSC = engine_->getConnectStateController();
-        sendConnectStateChanged(eCSC->currentState(), eCSC->disconnectReason(), eCSC->connectionError(), eCSC->locationId());
+        const ConnectStateSnapshot connectState = engine_->getConnectStateController()->snapshot();
+        sendConnectStateChanged(connectState.state, connectState.reason, connectState.err, connectState.location);
 
         return true;
     }
@@ -502,6 +533,11 @@ void EngineServer::onServerCallbackAcceptFunction(IPC::IConnection *connection)
     connect(dynamic_cast<QObject*>(connection), SIGNAL(stateChanged(int, IPC::IConnection *)), SLOT(onConnectionStateCallback(int, IPC::IConnection *)), Qt::QueuedConnection);
 }
 
+QSharedPointer<const EngineServer::LocationsSnapshot> EngineServer::getLocationsSnapshot() const
+{
+    return locationsSnapshot_;
+}
+
 void EngineServer::sendCommand(IPC::Command *command)
 {
     if ((command->getStringId() != IPCClientCommands::Login::descriptor()->full_name()) &&
@@ -765,11 +801,24 @@ void EngineServer::onEngineConnectStateChanged(CONNECT_STATE state, DISCONNECT_R
 
 void EngineServer::onEngineStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes)
 {
-    IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> cmd;
-    cmd.getProtoObj().set_bytes_in(bytesIn);
-    cmd.getProtoObj().set_bytes_out(bytesOut);
-    cmd.getProtoObj().set_is_total_bytes(isTotalBytes);
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    if (isPendingStatistics_)
+    {
+        coalescedUpdatesCount_++;
+    }
+    // the totals replace the pending value, the increments are added to it
+    if (isTotalBytes || !isPendingStatistics_)
+    {
+        pendingBytesIn_ = bytesIn;
+        pendingBytesOut_ = bytesOut;
+        isPendingTotalBytes_ = isTotalBytes;
+    }
+    else
+    {
+        pendingBytesIn_ += bytesIn;
+        pendingBytesOut_ += bytesOut;
+    }
+    isPendingStatistics_ = true;
+    scheduleBulkFlush();
 }
 
 void EngineServer::onEngineProtocolPortChanged(const ProtoTypes::Protocol &protocol, const uint port)
@@ -856,6 +905,13 @@ void EngineServer::onEngineConnectedProxyUsersCountChanged(int usersCount)
     sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
 }
 
+void EngineServer::onEngineProxySharingTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic)
+{
+    IPC::ProtobufCommand<IPCServerCommands::ProxySharingInfoChanged> cmd;
+    *cmd.getProtoObj().mutable_proxy_sharing_info()->mutable_traffic() = traffic;
+    sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
+}
+
 void EngineServer::onEngineSignOutFinished()
 {
     IPC::ProtobufCommand<IPCServerCommands::SignOutFinished> cmd;
@@ -925,19 +981,52 @@ void EngineServer::onEngineWebSessionToken(ProtoTypes::WebSessionPurpose purpose
     sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
 }
 
-void EngineServer::onEngineLocationsModelItemsUpdated(const LocationID &bestLocation,  const QString &staticIpDeviceName, QSharedPointer<QVector<locationsmodel::LocationItem> > items)
+void EngineServer::onEngineThroughputUpdated(const ProtoTypes::Throughput &throughput)
 {
-    IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> cmd;
+    // the meter emits once per interval, no coalescing needed
+    IPC::ProtobufCommand<IPCServerCommands::ThroughputUpdated> cmd;
+    *cmd.getProtoObj().mutable_throughput() = throughput;
+    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+}
 
-    *cmd.getProtoObj().mutable_best_location() = bestLocation.toProtobuf();
-    cmd.getProtoObj().set_static_ip_device_name(staticIpDeviceName.toStdString());
+void EngineServer::onEngineThroughputHistory(const ProtoTypes::ThroughputHistory &history)
+{
+    IPC::ProtobufCommand<IPCServerCommands::ThroughputHistoryUpdated> cmd;
+    *cmd.getProtoObj().mutable_history() = history;
+    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+}
+
+void EngineServer::onEngineTunnelSpeedTestFinished(const ProtoTypes::TunnelSpeedTestResult &result)
+{
+    IPC::ProtobufCommand<IPCServerCommands::TunnelSpeedTestFinished> cmd;
+    *cmd.getProtoObj().mutable_result() = result;
+    sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
+}
 
+void EngineServer::onEngineLocationsModelItemsUpdated(const LocationID &bestLocation,  const QString &staticIpDeviceName, QSharedPointer<QVector<locationsmodel::LocationItem> > items)
+{
+    QSharedPointer<LocationsSnapshot> snapshot(new LocationsSnapshot());
+    snapshot->staticIpDeviceName = staticIpDeviceName;
     for (const locationsmodel::LocationItem &li : *items)
     {
-        ProtoTypes::Location *l = cmd.getProtoObj().mutable_locations()->add_locations();
+        ProtoTypes::Location *l = snapshot->locations.add_locations();
         li.fillProtobuf(l);
     }
+    snapshot->serializedLocations.resize(static_cast<int>(snapshot->locations.ByteSizeLong()));
+    snapshot->locations.SerializeToArray(snapshot->serializedLocations.data(), snapshot->serializedLocations.size());
 
+    // the server list is refreshed periodically and mostly doesn't change, the same list keeps the version,
+    // so the GUI doesn't rebuild its models
+    if (locationsSnapshot_.isNull() || locationsSnapshot_->staticIpDeviceName != snapshot->staticIpDeviceName ||
+        locationsSnapshot_->serializedLocations != snapshot->serializedLocations)
+    {
+        snapshot->version = locationsSnapshot_.isNull() ? 1 : locationsSnapshot_->version + 1;
+        locationsSnapshot_ = snapshot;
+    }
+
+    IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> cmd;
+    *cmd.getProtoObj().mutable_best_location() = bestLocation.toProtobuf();
+    cmd.getProtoObj().set_snapshot_version(locationsSnapshot_->version);
     sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
 }
 
@@ -976,10 +1065,18 @@ void EngineServer::onEngineLocationsModelCustomConfigItemsUpdated(QSharedPointer
 
 void EngineServer::onEngineLocationsModelPingChangedChanged(const LocationID &id, PingTime timeMs)
 {
-    IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> cmd;
-    *cmd.getProtoObj().mutable_id() = id.toProtobuf();
-    cmd.getProtoObj().set_pingtime(timeMs.toInt());
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    auto it = pendingPings_.find(id);
+    if (it != pendingPings_.end())
+    {
+        it.value() = timeMs.toInt();
+        coalescedUpdatesCount_++;
+    }
+    else
+    {
+        pendingPings_.insert(id, timeMs.toInt());
+        pendingPingsOrder_ << id;
+    }
+    scheduleBulkFlush();
 }
 
 void EngineServer::onMacAddrSpoofingChanged(const ProtoTypes::MacAddrSpoofing &macAddrSpoofing)
@@ -1027,6 +1124,56 @@ void EngineServer::onHostsFileBecameWritable()
     sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
 }
 
+void EngineServer::onSaveSettingsTimer()
+{
+    curEngineSettings_.saveToSettings();
+}
+
+void EngineServer::onBulkFlushTimer()
+{
+    const qint64 lagMs = bulkFlushScheduledTime_.elapsed() - BULK_FLUSH_INTERVAL_MS;
+    if (lagMs > GUI_LAG_WARNING_MS && (!lastGuiLagLogTime_.isValid() || lastGuiLagLogTime_.elapsed() > GUI_LAG_LOG_PERIOD_MS))
+    {
+        qCDebug(LOG_IPC) << "The GUI thread falls behind the engine updates by" << lagMs << "ms, pending pings:"
+                         << pendingPings_.count() << ", coalesced updates:" << coalescedUpdatesCount_;
+        lastGuiLagLogTime_.start();
+    }
+
+    // the speeds of the interval in one command, the GUI applies them in one pass
+    if (!pendingPingsOrder_.isEmpty())
+    {
+        IPC::ProtobufCommand<IPCServerCommands::LocationsSpeedChanged> cmd;
+        for (const LocationID &id : qAsConst(pendingPingsOrder_))
+        {
+            IPCServerCommands::LocationSpeedChanged *speed = cmd.getProtoObj().add_speeds();
+            *speed->mutable_id() = id.toProtobuf();
+            speed->set_pingtime(pendingPings_.value(id));
+        }
+        sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    }
+    pendingPings_.clear();
+    pendingPingsOrder_.clear();
+
+    if (isPendingStatistics_)
+    {
+        IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> cmd;
+        cmd.getProtoObj().set_bytes_in(pendingBytesIn_);
+        cmd.getProtoObj().set_bytes_out(pendingBytesOut_);
+        cmd.getProtoObj().set_is_total_bytes(isPendingTotalBytes_);
+        isPendingStatistics_ = false;
+        sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    }
+}
+
+void EngineServer::scheduleBulkFlush()
+{
+    if (!bulkFlushTimer_->isActive())
+    {
+        bulkFlushScheduledTime_.start();
+        bulkFlushTimer_->start(BULK_FLUSH_INTERVAL_MS);
+    }
+}
+
 void EngineServer::sendCmdToAllAuthorizedAndGetStateClients(IPC::Command *cmd, bool bWithLog)
 {
     if (bWithLog) {
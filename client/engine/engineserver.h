@@ -2,7 +2,10 @@
 #define ENGINESERVER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QTimer>
+#include <QVector>
 #include "ipc/iserver.h"
 #include "clientconnectiondescr.h"
 #include "engine/engine.h"
@@ -11,9 +14,22 @@ class EngineServer : public QObject
 {
     Q_OBJECT
 public:
+    // The last API locations list. Immutable once published, a new list is a new snapshot with the next version.
+    // The list is serialized once per version, the bytes are compared with the next list and written to the GUI cache.
+    struct LocationsSnapshot
+    {
+        quint32 version;
+        QString staticIpDeviceName;
+        ProtoTypes::ArrayLocations locations;
+        QByteArray serializedLocations;
+    };
+
     explicit EngineServer(QObject *parent = nullptr);
     virtual ~EngineServer();
 
+    // the snapshot announced by the last LocationsUpdated command, null before the first one
+    QSharedPointer<const LocationsSnapshot> getLocationsSnapshot() const;
+
     void sendCommand(IPC::Command *command);
     void sendCmdToAllAuthorizedAndGetStateClients(IPC::Command *cmd, bool bWithLog);
     //void sendCmdToAllAuthorizedAndGetStateClientsOfType(const IPC::Command &cmd, bool bWithLog, unsigned int clientId, bool* bLogged = nullptr);
@@ -58,6 +74,7 @@ private slots:
     void onEngineWifiSharingStateChanged(bool bEnabled, const QString &ssid);
     void onEngineConnectedWifiUsersCountChanged(int usersCount);
     void onEngineConnectedProxyUsersCountChanged(int usersCount);
+    void onEngineProxySharingTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic);
     void onEngineSignOutFinished();
 
     void onEngineGotoCustomOvpnConfigModeFinished();
@@ -74,6 +91,9 @@ private slots:
     void onEngineSendDebugLogFinished(bool bSuccess);
     void onEngineConfirmEmailFinished(bool bSuccess);
     void onEngineWebSessionToken(ProtoTypes::WebSessionPurpose purpose, const QString &token);
+    void onEngineThroughputUpdated(const ProtoTypes::Throughput &throughput);
+    void onEngineThroughputHistory(const ProtoTypes::ThroughputHistory &history);
+    void onEngineTunnelSpeedTestFinished(const ProtoTypes::TunnelSpeedTestResult &result);
 
     void onEngineLocationsModelItemsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer< QVector<locationsmodel::LocationItem> > items);
     void onEngineLocationsModelItemsUpdatedCliOnly(const LocationID &bestLocation, QSharedPointer< QVector<locationsmodel::LocationItem> > items);
@@ -88,22 +108,49 @@ private slots:
 
     void onHostsFileBecameWritable();
 
+    void onBulkFlushTimer();
+    void onSaveSettingsTimer();
+
 private:
     IPC::IServer *server_;
 
     Engine *engine_;
     QThread *threadEngine_;
     EngineSettings curEngineSettings_;
+    // the settings are written once the changes stop for SAVE_SETTINGS_DELAY_MS, and in the destructor
+    static constexpr int SAVE_SETTINGS_DELAY_MS = 1000;
+    QTimer *saveSettingsTimer_;
 
     bool bClientAuthReceived_;
     QHash<IPC::IConnection *, ClientConnectionDescr> connections_;
 
+    // The control commands (states, settings, replies) are sent at once, the bulk updates (pings of the locations,
+    // statistics) are coalesced to the last value per key and sent once per BULK_FLUSH_INTERVAL_MS,
+    // so a burst of them doesn't delay the control commands and costs the GUI one update per key.
+    static constexpr int BULK_FLUSH_INTERVAL_MS = 50;
+    static constexpr int GUI_LAG_WARNING_MS = 500;         // the flush timer is late by this, the GUI thread falls behind
+    static constexpr int GUI_LAG_LOG_PERIOD_MS = 10000;
+
+    QTimer *bulkFlushTimer_;
+    QElapsedTimer bulkFlushScheduledTime_;
+    QElapsedTimer lastGuiLagLogTime_;
+    QHash<LocationID, int> pendingPings_;
+    QVector<LocationID> pendingPingsOrder_;
+    bool isPendingStatistics_;
+    quint64 pendingBytesIn_;
+    quint64 pendingBytesOut_;
+    bool isPendingTotalBytes_;
+    quint64 coalescedUpdatesCount_;
+
+    QSharedPointer<const LocationsSnapshot> locationsSnapshot_;
+
     //void serverCallbackAcceptFunction(IPC::IConnection *connection);
     bool handleCommand(IPC::Command *command);
     void sendEngineInitReturnCode(ENGINE_INIT_RET_CODE retCode);
     void sendConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &locationId);
 
     void sendFirewallStateChanged(bool isEnabled);
+    void scheduleBulkFlush();
 };
 
 #endif // ENGINESERVER_H
@@ -1,5 +1,6 @@
 #include "windscribeapplication.h"
 #include "utils/logger.h"
+#include "utils/eventloopwatchdog.h"
 #include <QAbstractEventDispatcher>
 
 #ifdef Q_OS_MAC
@@ -41,6 +42,7 @@ void setupDockClickHandler()
 WindscribeApplication::WindscribeApplication(int &argc, char **argv) : QApplication(argc, argv),
     bNeedAskClose_(false), bWasRestartOS_(false)
 {
+    startupElapsedTimer_.start();
     setQuitOnLastWindowClosed(false);
 #ifdef Q_OS_WIN
     QAbstractEventDispatcher::instance()->installNativeEventFilter(&windowsNativeEventFilter_);
@@ -113,6 +115,33 @@ void WindscribeApplication::onWinIniChanged()
 }
 #endif
 
+bool WindscribeApplication::notify(QObject *receiver, QEvent *e)
+{
+    if (eventTimingCallback_ && (e->type() == QEvent::Paint || e->type() == QEvent::UpdateRequest))
+    {
+        const QEvent::Type type = e->type();
+        const qint64 startNs = startupElapsedTimer_.nsecsElapsed();
+        bool ret = QApplication::notify(receiver, e);
+        eventTimingCallback_(receiver, type, startNs, startupElapsedTimer_.nsecsElapsed() - startNs);
+        return ret;
+    }
+
+    if (e->type() != QEvent::MetaCall)
+    {
+        return QApplication::notify(receiver, e);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool ret = QApplication::notify(receiver, e);
+    const qint64 elapsedMs = timer.elapsed();
+    if (elapsedMs >= EventLoopWatchdog::SLOW_INVOCATION_THRESHOLD_MS)
+    {
+        EventLoopWatchdog::instance().recordSlowInvocation(receiver, elapsedMs);
+    }
+    return ret;
+}
+
 bool WindscribeApplication::event(QEvent *e)
 {
     if (e->type() == QEvent::Close)
@@ -3,6 +3,8 @@
 
 #include <QApplication>
 #include <QTranslator>
+#include <QElapsedTimer>
+#include <functional>
 
 #ifdef Q_OS_WIN
     #include "windowsnativeeventfilter.h"
@@ -34,6 +36,13 @@ public:
     void clearNeedAskClose() { bNeedAskClose_ = false; }
 
     void onActivateFromAnotherInstance();
+
+    // since the application object was created
+    qint64 startupElapsedMs() const { return startupElapsedTimer_.elapsed(); }
+
+    // if set, the paint and update request events of all the widgets are timed (GUI benchmark mode)
+    typedef std::function<void(QObject *receiver, QEvent::Type type, qint64 startNs, qint64 elapsedNs)> EventTimingCallback;
+    void setEventTimingCallback(const EventTimingCallback &callback) { eventTimingCallback_ = callback; }
 #ifdef Q_OS_WIN
     void onWinIniChanged();
 #endif
@@ -47,12 +56,17 @@ signals:
     void winIniChanged();
 #endif
 
+    // times the queued slot invocations of all the threads for EventLoopWatchdog
+    bool notify(QObject *receiver, QEvent *e) override;
+
 protected:
     bool event(QEvent *e) override;
 
 private:
     bool bNeedAskClose_;
     bool bWasRestartOS_;
+    QElapsedTimer startupElapsedTimer_;
+    EventTimingCallback eventTimingCallback_;
 #ifdef Q_OS_WIN
     WindowsNativeEventFilter windowsNativeEventFilter_;
 #endif
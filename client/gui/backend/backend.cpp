@@ -2,11 +2,13 @@
 
 #include "utils/logger.h"
 #include "utils/utils.h"
+#include "ipc/commandstats.h"
 #include "ipc/connection.h"
 #include "ipc/protobufcommand.h"
 #include "utils/utils.h"
 #include "utils/executable_signature/executable_signature.h"
 #include "persistentstate.h"
+#include "locationsmodel/locationssnapshotcache.h"
 #include "engine/engineserver.h"
 #include <QCoreApplication>
 
@@ -18,6 +20,7 @@ Backend::Backend(QObject *parent) : QObject(parent),
     bLastLoginWithAuthHash_(false),
     isCleanupFinished_(false),
     cmdId_(0),
+    appliedLocationsSnapshotVersion_(0),
     isFirewallEnabled_(false),
     isExternalConfigMode_(false)
 {
@@ -25,6 +28,10 @@ Backend::Backend(QObject *parent) : QObject(parent),
 
     locationsModel_ = new LocationsModel(this);
 
+    engineSettingsTimer_.setSingleShot(true);
+    engineSettingsTimer_.setInterval(ENGINE_SETTINGS_DELAY_MS);
+    connect(&engineSettingsTimer_, SIGNAL(timeout()), SLOT(onEngineSettingsTimer()));
+
     connect(&connectStateHelper_, SIGNAL(connectStateChanged(ProtoTypes::ConnectState)), SIGNAL(connectStateChanged(ProtoTypes::ConnectState)));
     connect(&emergencyConnectStateHelper_, SIGNAL(connectStateChanged(ProtoTypes::ConnectState)), SIGNAL(emergencyConnectStateChanged(ProtoTypes::ConnectState)));
     connect(&firewallStateHelper_, SIGNAL(firewallStateChanged(bool)), SIGNAL(firewallStateChanged(bool)));
@@ -81,6 +88,7 @@ void Backend::basicClose()
 void Backend::cleanup(bool isExitWithRestart, bool isFirewallChecked, bool isFirewallAlwaysOn, bool isLaunchOnStart)
 {
     qCDebug(LOG_BASIC) << "Backend::cleanup()";
+    flushEngineSettings();
 
     //Q_ASSERT(isInitFinished());
 
@@ -135,6 +143,22 @@ bool Backend::isSavedApiSettingsExists() const
     return isSavedApiSettingsExists_;
 }
 
+bool Backend::loadLocationsSnapshot()
+{
+    LocationsSnapshotCache::Snapshot snapshot;
+    if (!LocationsSnapshotCache::load(snapshot))
+    {
+        return false;
+    }
+    locationsModel_->updateApiLocations(snapshot.bestLocation, snapshot.staticIpDeviceName, snapshot.locations);
+    return true;
+}
+
+void Backend::clearLocationsSnapshot()
+{
+    LocationsSnapshotCache::clear();
+}
+
 void Backend::loginWithAuthHash(const QString &authHash)
 {
     bLastLoginWithAuthHash_ = true;
@@ -172,6 +196,8 @@ void Backend::signOut(bool keepFirewallOn)
 
 void Backend::sendConnect(const LocationID &lid)
 {
+    // the engine must connect with the last changes of the preferences
+    flushEngineSettings();
     connectStateHelper_.connectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::Connect> cmd;
     *cmd.getProtoObj().mutable_locationdid() = lid.toProtobuf();
@@ -206,6 +232,7 @@ void Backend::forceCliStateUpdate()
 
 void Backend::firewallOn(bool updateHelperFirst)
 {
+    flushEngineSettings();
     if (updateHelperFirst) firewallStateHelper_.firewallOnClickFromGUI();
     IPC::ProtobufCommand<IPCClientCommands::Firewall> cmd;
     cmd.getProtoObj().set_is_enable(true);
@@ -234,6 +261,7 @@ bool Backend::isFirewallAlwaysOn()
 
 void Backend::emergencyConnectClick()
 {
+    flushEngineSettings();
     emergencyConnectStateHelper_.connectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::EmergencyConnect> cmd;
     qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
@@ -343,6 +371,20 @@ void Backend::getWebSessionTokenForAddEmail()
     engineServer_->sendCommand(&cmd);
 }
 
+void Backend::startTunnelSpeedTest()
+{
+    IPC::ProtobufCommand<IPCClientCommands::StartTunnelSpeedTest> cmd;
+    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+    engineServer_->sendCommand(&cmd);
+}
+
+void Backend::getThroughputHistory()
+{
+    IPC::ProtobufCommand<IPCClientCommands::GetThroughputHistory> cmd;
+    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+    engineServer_->sendCommand(&cmd);
+}
+
 void Backend::speedRating(int rating, const QString &localExternalIp)
 {
     IPC::ProtobufCommand<IPCClientCommands::SpeedRating> cmd;
@@ -392,6 +434,7 @@ void Backend::sendAdvancedParametersChanged()
 
 void Backend::sendEngineSettingsIfChanged()
 {
+    engineSettingsTimer_.stop();
     if(!google::protobuf::util::MessageDifferencer::Equals(preferences_.getEngineSettings(), latestEngineSettings_))
     {
         qCDebug(LOG_BASIC) << "Engine settings changed, sent to engine";
@@ -403,6 +446,24 @@ void Backend::sendEngineSettingsIfChanged()
     }
 }
 
+void Backend::scheduleEngineSettingsUpdate()
+{
+    engineSettingsTimer_.start();
+}
+
+void Backend::flushEngineSettings()
+{
+    if (engineSettingsTimer_.isActive())
+    {
+        sendEngineSettingsIfChanged();
+    }
+}
+
+void Backend::onEngineSettingsTimer()
+{
+    sendEngineSettingsIfChanged();
+}
+
 LocationsModel *Backend::getLocationsModel()
 {
     return locationsModel_;
@@ -445,6 +506,15 @@ const ProtoTypes::SessionStatus &Backend::getSessionStatus() const
 }
 
 void Backend::onConnectionNewCommand(IPC::Command *command)
+{
+    // the engine commands come in the process without serialization, only the handling time is counted
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    handleCommand(command);
+    IPC::CommandStats::instance().record(command->getStringId(), 0, elapsedTimer.nsecsElapsed() / 1000);
+}
+
+void Backend::handleCommand(IPC::Command *command)
 {
     if (command->getStringId() == IPCServerCommands::AuthReply::descriptor()->full_name())
     {
@@ -517,8 +587,30 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     else if (command->getStringId() == IPCServerCommands::LocationsUpdated::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> *>(command);
-        locationsModel_->updateApiLocations(cmd->getProtoObj().best_location(), QString::fromStdString(cmd->getProtoObj().static_ip_device_name()), cmd->getProtoObj().locations());
-        Q_EMIT locationsUpdated();
+        if (cmd->getProtoObj().has_snapshot_version())
+        {
+            // the engine is in this process, the list is read from its snapshot without a copy
+            if (cmd->getProtoObj().snapshot_version() == appliedLocationsSnapshotVersion_)
+            {
+                locationsModel_->updateBestLocation(cmd->getProtoObj().best_location());
+            }
+            else
+            {
+                QSharedPointer<const EngineServer::LocationsSnapshot> snapshot = engineServer_->getLocationsSnapshot();
+                Q_ASSERT(!snapshot.isNull() && snapshot->version == cmd->getProtoObj().snapshot_version());
+                locationsModel_->updateApiLocations(cmd->getProtoObj().best_location(), snapshot->staticIpDeviceName, snapshot->locations);
+                appliedLocationsSnapshotVersion_ = snapshot->version;
+                LocationsSnapshotCache::save(cmd->getProtoObj().best_location(), snapshot->staticIpDeviceName, snapshot->serializedLocations);
+                Q_EMIT locationsUpdated();
+            }
+        }
+        else
+        {
+            // EngineServer always sets snapshot_version, this is for a command which carries the list itself
+            locationsModel_->updateApiLocations(cmd->getProtoObj().best_location(), QString::fromStdString(cmd->getProtoObj().static_ip_device_name()), cmd->getProtoObj().locations());
+            LocationsSnapshotCache::save(cmd->getProtoObj().best_location(), QString::fromStdString(cmd->getProtoObj().static_ip_device_name()), cmd->getProtoObj().locations());
+            Q_EMIT locationsUpdated();
+        }
     }
     else if (command->getStringId() == IPCServerCommands::BestLocationUpdated::descriptor()->full_name())
     {
@@ -531,10 +623,16 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
         locationsModel_->updateCustomConfigLocations(cmd->getProtoObj().locations());
         Q_EMIT locationsUpdated();
     }
-    else if (command->getStringId() == IPCServerCommands::LocationSpeedChanged::descriptor()->full_name())
+    else if (command->getStringId() == IPCServerCommands::LocationsSpeedChanged::descriptor()->full_name())
     {
-        IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> *>(command);
-        locationsModel_->changeConnectionSpeed(LocationID::createFromProtoBuf(cmd->getProtoObj().id()), (int)cmd->getProtoObj().pingtime());
+        IPC::ProtobufCommand<IPCServerCommands::LocationsSpeedChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LocationsSpeedChanged> *>(command);
+        QHash<LocationID, PingTime> speeds;
+        speeds.reserve(cmd->getProtoObj().speeds_size());
+        for (const IPCServerCommands::LocationSpeedChanged &speed : cmd->getProtoObj().speeds())
+        {
+            speeds.insert(LocationID::createFromProtoBuf(speed.id()), (int)speed.pingtime());
+        }
+        locationsModel_->changeConnectionSpeeds(speeds);
     }
     else if (command->getStringId() == IPCServerCommands::ConnectStateChanged::descriptor()->full_name())
     {
@@ -581,6 +679,16 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
         IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> *>(command);
         Q_EMIT statisticsUpdated(cmd->getProtoObj().bytes_in(), cmd->getProtoObj().bytes_out(), cmd->getProtoObj().is_total_bytes());
     }
+    else if (command->getStringId() == IPCServerCommands::ThroughputUpdated::descriptor()->full_name())
+    {
+        IPC::ProtobufCommand<IPCServerCommands::ThroughputUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::ThroughputUpdated> *>(command);
+        Q_EMIT throughputUpdated(cmd->getProtoObj().throughput());
+    }
+    else if (command->getStringId() == IPCServerCommands::ThroughputHistoryUpdated::descriptor()->full_name())
+    {
+        IPC::ProtobufCommand<IPCServerCommands::ThroughputHistoryUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::ThroughputHistoryUpdated> *>(command);
+        Q_EMIT throughputHistoryUpdated(cmd->getProtoObj().history());
+    }
     else if (command->getStringId() == IPCServerCommands::RequestCredentialsForOvpnConfig::descriptor()->full_name())
     {
         Q_EMIT requestCustomOvpnConfigCredentials();
@@ -702,6 +810,11 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
             Q_EMIT webSessionTokenForAddEmail(QString::fromStdString(cmd->getProtoObj().temp_session_token()));
         }
     }
+    else if (command->getStringId() == IPCServerCommands::TunnelSpeedTestFinished::descriptor()->full_name())
+    {
+        IPC::ProtobufCommand<IPCServerCommands::TunnelSpeedTestFinished> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::TunnelSpeedTestFinished> *>(command);
+        Q_EMIT tunnelSpeedTestFinished(cmd->getProtoObj().result());
+    }
 }
 
 void Backend::abortInitialization()
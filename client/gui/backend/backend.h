@@ -35,6 +35,9 @@ public:
     void login(const QString &username, const QString &password, const QString &code2fa);
     bool isCanLoginWithAuthHash() const;
     bool isSavedApiSettingsExists() const;
+    // fills the locations model from the locations of the previous run, before the engine is ready
+    bool loadLocationsSnapshot();
+    void clearLocationsSnapshot();
     QString getCurrentAuthHash() const;
     void loginWithAuthHash(const QString &authHash);
     void loginWithLastLoginSettings();
@@ -71,6 +74,8 @@ public:
     void sendDebugLog();
     void getWebSessionTokenForEditAccountDetails();
     void getWebSessionTokenForAddEmail();
+    void startTunnelSpeedTest();
+    void getThroughputHistory();
 
     void speedRating(int rating, const QString &localExternalIp);
 
@@ -83,6 +88,8 @@ public:
 
     void sendAdvancedParametersChanged();
     void sendEngineSettingsIfChanged();
+    // coalesces the changes of the preferences made within ENGINE_SETTINGS_DELAY_MS into one SetSettings command
+    void scheduleEngineSettingsUpdate();
 
     LocationsModel *getLocationsModel();
 
@@ -111,6 +118,7 @@ public:
 
 private slots:
     void onConnectionNewCommand(IPC::Command *command);
+    void onEngineSettingsTimer();
 
 signals:
     // emited when connected to engine and received the engine settings, or error in initState variable
@@ -140,11 +148,14 @@ signals:
     void confirmEmailResult(bool bSuccess);
     void debugLogResult(bool bSuccess);
     void statisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+    void throughputUpdated(const ProtoTypes::Throughput &throughput);
+    void throughputHistoryUpdated(const ProtoTypes::ThroughputHistory &history);
 
     void proxySharingInfoChanged(const ProtoTypes::ProxySharingInfo &psi);
     void wifiSharingInfoChanged(const ProtoTypes::WifiSharingInfo &wsi);
     void webSessionTokenForEditAccountDetails(const QString &temp_session_token);
     void webSessionTokenForAddEmail(const QString &temp_session_token);
+    void tunnelSpeedTestFinished(const ProtoTypes::TunnelSpeedTestResult &result);
 
     void requestCustomOvpnConfigCredentials();
 
@@ -170,6 +181,8 @@ private:
 
     ProtoTypes::SessionStatus latestSessionStatus_;
     ProtoTypes::EngineSettings latestEngineSettings_;
+    QTimer engineSettingsTimer_;
+    static constexpr int ENGINE_SETTINGS_DELAY_MS = 250;
     ConnectStateHelper connectStateHelper_;
     ConnectStateHelper emergencyConnectStateHelper_;
     FirewallStateHelper firewallStateHelper_;
@@ -180,6 +193,7 @@ private:
     quint32 cmdId_;
 
     LocationsModel *locationsModel_;
+    quint32 appliedLocationsSnapshotVersion_;   // 0 if none
 
     bool isFirewallEnabled_;
 
@@ -192,6 +206,8 @@ private:
 
     ProtoTypes::NetworkInterface currentNetworkInterface_;
 
+    void handleCommand(IPC::Command *command);
+    void flushEngineSettings();
     QString generateNewFriendlyName();
     void updateAccountInfo();
     void getOpenVpnVersionsFromInitCommand(const IPCServerCommands::InitFinished &state);
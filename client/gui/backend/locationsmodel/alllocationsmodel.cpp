@@ -7,8 +7,7 @@ AllLocationsModel::AllLocationsModel(QObject *parent) : BasicLocationsModel(pare
 
 void AllLocationsModel::update(QVector<QSharedPointer<LocationModelItem> > locations)
 {
-    clearLocations();
-
+    QVector<LocationModelItem *> newLocations;
     for (QSharedPointer<LocationModelItem> lmi : qAsConst(locations))
     {
         if (lmi->id.isCustomConfigsLocation())
@@ -23,10 +22,8 @@ void AllLocationsModel::update(QVector<QSharedPointer<LocationModelItem> > locat
 
         LocationModelItem *nlmi = new LocationModelItem();
         *nlmi = *lmi;
-        locations_ << nlmi;
+        newLocations << nlmi;
     }
 
-
-    sort();
-    emit itemsUpdated(locations_);
+    replaceLocations(newLocations);
 }
@@ -18,14 +18,21 @@ void BasicCitiesModel::setOrderLocationsType(ProtoTypes::OrderLocationType order
 }
 
 void BasicCitiesModel::changeConnectionSpeed(const LocationID &id, const PingTime &speed)
+{
+    QHash<LocationID, PingTime> speeds;
+    speeds.insert(id, speed);
+    changeConnectionSpeeds(speeds);
+}
+
+void BasicCitiesModel::changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds)
 {
     for (CityModelItem *cmi : qAsConst(cities_))
     {
-        if (cmi->id == id)
+        auto it = speeds.constFind(cmi->id);
+        if (it != speeds.constEnd())
         {
-            cmi->pingTimeMs = speed;
-            emit connectionSpeedChanged(id, speed);
-            break;
+            cmi->pingTimeMs = it.value();
+            emit connectionSpeedChanged(cmi->id, it.value());
         }
     }
 }
@@ -66,6 +73,21 @@ void BasicCitiesModel::clearCities()
     cities_.clear();
 }
 
+void BasicCitiesModel::replaceCities(const QVector<CityModelItem *> &cities)
+{
+    QVector<CityModelItem *> newCities = cities;
+    sort(newCities);
+
+    const LocationsModelDiff diff = LocationsModelDiff::make(cities_, newCities);
+    clearCities();
+    cities_ = newCities;
+
+    if (!diff.isEmpty())
+    {
+        emit itemsChanged(cities_, diff);
+    }
+}
+
 void BasicCitiesModel::sort(QVector<CityModelItem *> &cities)
 {
     Q_UNUSED(cities);
@@ -1,9 +1,11 @@
 #ifndef BASICCITIESMODEL_H
 #define BASICCITIESMODEL_H
 
+#include <QHash>
 #include <QObject>
 #include <QSharedPointer>
 #include "locationmodelitem.h"
+#include "locationsmodeldiff.h"
 #include "types/locationid.h"
 
 class BasicCitiesModel : public QObject
@@ -17,6 +19,7 @@ public:
 
     virtual void setOrderLocationsType(ProtoTypes::OrderLocationType orderLocationsType);
     void changeConnectionSpeed(const LocationID &id, const PingTime &speed);
+    void changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds);
     virtual void setIsFavorite(const LocationID &id, bool isFavorite);
     virtual void setFreeSessionStatus(bool isFreeSessionStatus);
 
@@ -24,6 +27,8 @@ public:
 
 signals:
     void itemsUpdated(QVector<CityModelItem*> items);  // only for direct connection
+    // the items replaced by update(), not emitted if nothing changed
+    void itemsChanged(QVector<CityModelItem*> items, const LocationsModelDiff &diff);  // only for direct connection
     void connectionSpeedChanged(const LocationID &id, const PingTime &timeMs);
     void isFavoriteChanged(const LocationID &id, bool isFavorite);
     void freeSessionStatusChanged(bool isFreeSessionStatus);
@@ -35,6 +40,7 @@ protected:
     bool isFreeSessionStatus_;
 
     void clearCities();
+    void replaceCities(const QVector<CityModelItem *> &cities);
     virtual void sort(QVector<CityModelItem *> &cities);
 };
 
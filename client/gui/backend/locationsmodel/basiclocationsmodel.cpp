@@ -1,10 +1,18 @@
 #include "basiclocationsmodel.h"
-#include "sortlocationsalgorithms.h"
+
+#include <algorithm>
+#include <numeric>
 
 BasicLocationsModel::BasicLocationsModel(QObject *parent) : QObject(parent), orderLocationsType_(ProtoTypes::ORDER_LOCATION_BY_GEOGRAPHY),
     isFreeSessionStatus_(false)
 {
+    // connected before the views, so the index is reset when they get the update
+    connect(this, SIGNAL(itemsUpdated(QVector<LocationModelItem*>)), SLOT(onItemsUpdated()), Qt::DirectConnection);
+    connect(this, SIGNAL(itemsChanged(QVector<LocationModelItem*>, LocationsModelDiff)), SLOT(onItemsUpdated()), Qt::DirectConnection);
 
+    resortTimer_.setSingleShot(true);
+    resortTimer_.setInterval(RESORT_DELAY_MS);
+    connect(&resortTimer_, SIGNAL(timeout()), SLOT(onResortTimer()));
 }
 
 BasicLocationsModel::~BasicLocationsModel()
@@ -15,26 +23,55 @@ BasicLocationsModel::~BasicLocationsModel()
 void BasicLocationsModel::setOrderLocationsType(ProtoTypes::OrderLocationType orderLocationsType)
 {
     orderLocationsType_ = orderLocationsType;
-    sort();
+    // the latency changes aren't tracked in the other orders, so the keys are recomputed
+    sortKeys_ = makeSortKeys(locations_);
+    pendingResortIds_.clear();
+    sort(locations_, sortKeys_);
     emit itemsUpdated(locations_);
 }
 
 void BasicLocationsModel::changeConnectionSpeed(LocationID id, PingTime speed)
 {
-    const bool location_found = [&]() {
-        for (auto *lmi : locations_) {
-            for (auto &cmi : lmi->cities) {
-                if (cmi.id == id) {
-                    cmi.pingTimeMs = speed;
-                    return true;
-                }
+    QHash<LocationID, PingTime> speeds;
+    speeds.insert(id, speed);
+    changeConnectionSpeeds(speeds);
+}
+
+void BasicLocationsModel::changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds)
+{
+    for (LocationModelItem *lmi : qAsConst(locations_))
+    {
+        for (auto &cmi : lmi->cities)
+        {
+            auto it = speeds.constFind(cmi.id);
+            if (it == speeds.constEnd())
+            {
+                continue;
+            }
+            cmi.pingTimeMs = it.value();
+            emit connectionSpeedChanged(cmi.id, it.value());
+
+            // only the latency order depends on the ping, the region is repositioned with the others of the same sweep
+            if (orderLocationsType_ == ProtoTypes::ORDER_LOCATION_BY_LATENCY)
+            {
+                pendingResortIds_.insert(lmi->id);
             }
         }
-        return false;
-    }();
+    }
 
-    if (location_found)
-        emit connectionSpeedChanged(id, speed);
+    if (pendingResortIds_.isEmpty())
+    {
+        return;
+    }
+    if (!resortTimer_.isActive())
+    {
+        resortPendingTimer_.start();
+        resortTimer_.start();
+    }
+    else if (resortPendingTimer_.elapsed() < RESORT_MAX_DELAY_MS)
+    {
+        resortTimer_.start();   // restarted
+    }
 }
 
 void BasicLocationsModel::setIsFavorite(LocationID id, bool isFavorite)
@@ -67,6 +104,88 @@ QVector<LocationModelItem *> BasicLocationsModel::items()
     return locations_;
 }
 
+QVector<LocationModelItem> BasicLocationsModel::filteredItems(const QString &filter)
+{
+    QVector<LocationModelItem> result;
+    if (filter.isEmpty())
+    {
+        result.reserve(locations_.count());
+        for (const LocationModelItem *lmi : qAsConst(locations_))
+        {
+            result << *lmi;
+        }
+        return result;
+    }
+
+    if (!searchIndex_.isBuilt())
+    {
+        searchIndex_.build(locations_);
+    }
+
+    int lastRegion = -1;
+    bool isWholeRegion = false;
+    const QVector<int> &entries = searchIndex_.search(filter);
+    for (int ind : entries)
+    {
+        const LocationsSearchIndex::Entry &entry = searchIndex_.entry(ind);
+        if (entry.region != lastRegion)
+        {
+            lastRegion = entry.region;
+            isWholeRegion = entry.city < 0;
+            result << *locations_[entry.region];
+            if (!isWholeRegion)
+            {
+                result.last().cities.clear();
+            }
+        }
+        if (!isWholeRegion && entry.city >= 0)
+        {
+            result.last().cities << locations_[entry.region]->cities[entry.city];
+        }
+    }
+    return result;
+}
+
+void BasicLocationsModel::onItemsUpdated()
+{
+    searchIndex_.clear();
+}
+
+void BasicLocationsModel::onResortTimer()
+{
+    const SortLocationsAlgorithms::LessThan lessThanFunc = lessThan();
+    LocationsModelDiff diff;
+
+    // the other regions are still sorted by their keys, so each changed one is moved with a binary search
+    for (const LocationID &id : qAsConst(pendingResortIds_))
+    {
+        const int ind = std::find_if(locations_.begin(), locations_.end(),
+                                     [&id](const LocationModelItem *lmi) { return lmi->id == id; }) - locations_.begin();
+        if (ind == locations_.count())
+        {
+            continue;
+        }
+        LocationModelItem *lmi = locations_[ind];
+        const LocationSortKey key = SortLocationsAlgorithms::makeSortKey(*lmi);
+        locations_.remove(ind);
+        sortKeys_.remove(ind);
+
+        const int newInd = std::upper_bound(sortKeys_.begin(), sortKeys_.end(), key, lessThanFunc) - sortKeys_.begin();
+        locations_.insert(newInd, lmi);
+        sortKeys_.insert(newInd, key);
+        if (newInd != ind)
+        {
+            diff.moved << id;
+        }
+    }
+    pendingResortIds_.clear();
+
+    if (!diff.isEmpty())
+    {
+        emit itemsChanged(locations_, diff);
+    }
+}
+
 void BasicLocationsModel::clearLocations()
 {
     for (LocationModelItem *lmi : qAsConst(locations_))
@@ -74,24 +193,82 @@ void BasicLocationsModel::clearLocations()
         delete lmi;
     }
     locations_.clear();
+    sortKeys_.clear();
 }
 
-void BasicLocationsModel::sort()
+void BasicLocationsModel::sort(QVector<LocationModelItem *> &locations, QVector<LocationSortKey> &sortKeys)
+{
+    Q_ASSERT(locations.count() == sortKeys.count());
+    const SortLocationsAlgorithms::LessThan lessThanFunc = lessThan();
+
+    // the comparisons use the precomputed keys only
+    QVector<int> order(locations.count());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int ind1, int ind2) {
+        return lessThanFunc(sortKeys[ind1], sortKeys[ind2]);
+    });
+
+    QVector<LocationModelItem *> sortedLocations;
+    QVector<LocationSortKey> sortedKeys;
+    sortedLocations.reserve(order.count());
+    sortedKeys.reserve(order.count());
+    for (int ind : qAsConst(order))
+    {
+        sortedLocations << locations[ind];
+        sortedKeys << sortKeys[ind];
+    }
+    locations.swap(sortedLocations);
+    sortKeys.swap(sortedKeys);
+}
+
+void BasicLocationsModel::replaceLocations(const QVector<LocationModelItem *> &locations)
+{
+    QVector<LocationModelItem *> newLocations = locations;
+    QVector<LocationSortKey> newSortKeys = makeSortKeys(newLocations);
+    sort(newLocations, newSortKeys);
+
+    // a server list refresh usually changes a few loads or nothing at all, the views update only the changed items
+    const LocationsModelDiff diff = LocationsModelDiff::make(locations_, newLocations);
+    clearLocations();
+    locations_ = newLocations;
+    sortKeys_ = newSortKeys;
+    // the keys of the new items are up to date
+    pendingResortIds_.clear();
+
+    if (!diff.isEmpty())
+    {
+        emit itemsChanged(locations_, diff);
+    }
+}
+
+SortLocationsAlgorithms::LessThan BasicLocationsModel::lessThan() const
 {
     if (orderLocationsType_ == ProtoTypes::ORDER_LOCATION_BY_GEOGRAPHY)
     {
-        std::sort(locations_.begin(), locations_.end(), SortLocationsAlgorithms::lessThanByGeography);
+        return SortLocationsAlgorithms::lessThanByGeography;
     }
     else if (orderLocationsType_ == ProtoTypes::ORDER_LOCATION_BY_ALPHABETICALLY)
     {
-        std::sort(locations_.begin(), locations_.end(), SortLocationsAlgorithms::lessThanByAlphabetically);
+        return SortLocationsAlgorithms::lessThanByAlphabetically;
     }
     else if (orderLocationsType_ == ProtoTypes::ORDER_LOCATION_BY_LATENCY)
     {
-        std::sort(locations_.begin(), locations_.end(), SortLocationsAlgorithms::lessThanByLatency);
+        return SortLocationsAlgorithms::lessThanByLatency;
     }
     else
     {
         Q_ASSERT(false);
+        return SortLocationsAlgorithms::lessThanByGeography;
+    }
+}
+
+QVector<LocationSortKey> BasicLocationsModel::makeSortKeys(const QVector<LocationModelItem *> &locations)
+{
+    QVector<LocationSortKey> keys;
+    keys.reserve(locations.count());
+    for (const LocationModelItem *lmi : locations)
+    {
+        keys << SortLocationsAlgorithms::makeSortKey(*lmi);
     }
+    return keys;
 }
@@ -1,9 +1,16 @@
 #ifndef BASICLOCATIONSMODEL_H
 #define BASICLOCATIONSMODEL_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
+#include <QTimer>
 #include "locationmodelitem.h"
+#include "locationsmodeldiff.h"
+#include "locationssearchindex.h"
+#include "sortlocationsalgorithms.h"
 
 class BasicLocationsModel : public QObject
 {
@@ -16,24 +23,50 @@ public:
 
     void setOrderLocationsType(ProtoTypes::OrderLocationType orderLocationsType);
     void changeConnectionSpeed(LocationID id, PingTime speed);
+    void changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds);
     void setIsFavorite(LocationID id, bool isFavorite);
     void setFreeSessionStatus(bool isFreeSessionStatus);
 
     QVector<LocationModelItem *> items();
+    // copies of the items containing the filter text: the whole region if its title matches,
+    // otherwise the region with the matched cities only
+    QVector<LocationModelItem> filteredItems(const QString &filter);
 
 signals:
     void itemsUpdated(QVector<LocationModelItem*> items);  // only for direct connection
+    // the items replaced by update(), not emitted if nothing changed
+    void itemsChanged(QVector<LocationModelItem*> items, const LocationsModelDiff &diff);  // only for direct connection
     void connectionSpeedChanged(LocationID id, PingTime timeMs);
     void isFavoriteChanged(LocationID id, bool isFavorite);
     void freeSessionStatusChanged(bool isFreeSessionStatus);
 
+private slots:
+    void onItemsUpdated();
+    void onResortTimer();
+
 protected:
     QVector<LocationModelItem *> locations_;
     ProtoTypes::OrderLocationType orderLocationsType_;
     bool isFreeSessionStatus_;
+    LocationsSearchIndex searchIndex_;  // built on the first search after the items update
 
     void clearLocations();
-    void sort();
+    void sort(QVector<LocationModelItem *> &locations, QVector<LocationSortKey> &sortKeys);
+    void replaceLocations(const QVector<LocationModelItem *> &locations);
+
+private:
+    // the ping sweep has no end signal here: the changed regions are repositioned once the changes stop for
+    // RESORT_DELAY_MS, so the list doesn't jump on every ping, or after RESORT_MAX_DELAY_MS of a steady trickle
+    static constexpr int RESORT_DELAY_MS = 1000;
+    static constexpr int RESORT_MAX_DELAY_MS = 5000;
+
+    QVector<LocationSortKey> sortKeys_;     // the same order as locations_
+    QSet<LocationID> pendingResortIds_;     // the regions with the changed latency
+    QTimer resortTimer_;
+    QElapsedTimer resortPendingTimer_;      // since the first of the pending changes
+
+    SortLocationsAlgorithms::LessThan lessThan() const;
+    static QVector<LocationSortKey> makeSortKeys(const QVector<LocationModelItem *> &locations);
 };
 
 #endif // BASICLOCATIONSMODEL_H
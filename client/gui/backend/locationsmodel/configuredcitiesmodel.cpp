@@ -7,8 +7,7 @@ ConfiguredCitiesModel::ConfiguredCitiesModel(QObject *parent) : BasicCitiesModel
 
 void ConfiguredCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> locations)
 {
-    clearCities();
-
+    QVector<CityModelItem *> newCities;
     int cityId{};
 
     for (QSharedPointer<LocationModelItem> lmi : locations)
@@ -19,12 +18,11 @@ void ConfiguredCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> lo
             CityModelItem *cmi = new CityModelItem();
             *cmi = lmi->cities[i];
             cmi->initialInd_ = cityId++;
-            cities_ << cmi;
+            newCities << cmi;
         }
     }
 
-    sort(cities_);
-    emit itemsUpdated(cities_);
+    replaceCities(newCities);
 }
 
 void ConfiguredCitiesModel::sort(QVector<CityModelItem *> &cities)
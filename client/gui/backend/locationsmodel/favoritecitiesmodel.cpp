@@ -7,7 +7,10 @@ FavoriteCitiesModel::FavoriteCitiesModel(QObject *parent) : BasicCitiesModel(par
 
 void FavoriteCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> locations)
 {
-    clearCities();
+    // the old items are deleted after the diff
+    const QVector<CityModelItem *> oldCities = cities_;
+    const QVector<CityModelItem *> oldFavoriteCities = favoriteCities_;
+    cities_.clear();
 
     for (auto lmi : qAsConst(locations))
     {
@@ -24,7 +27,13 @@ void FavoriteCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> loca
 
     selectOnlyFavorite();
     sort(favoriteCities_);
-    emit itemsUpdated(favoriteCities_);
+
+    const LocationsModelDiff diff = LocationsModelDiff::make(oldFavoriteCities, favoriteCities_);
+    qDeleteAll(oldCities);
+    if (!diff.isEmpty())
+    {
+        emit itemsChanged(favoriteCities_, diff);
+    }
 }
 
 void FavoriteCitiesModel::setOrderLocationsType(ProtoTypes::OrderLocationType orderLocationsType)
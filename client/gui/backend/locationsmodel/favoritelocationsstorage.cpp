@@ -1,7 +1,7 @@
 #include "favoritelocationsstorage.h"
 
 #include <QDataStream>
-#include <QSettings>
+#include "utils/settingsstore.h"
 
 void FavoriteLocationsStorage::addToFavorites(const LocationID &locationId)
 {
@@ -34,11 +34,9 @@ int FavoriteLocationsStorage::size() const
 void FavoriteLocationsStorage::readFromSettings()
 {
     favoriteLocations_.clear();
-    QSettings settings;
-
-    if (settings.contains("favoriteLocations"))
+    if (SettingsStore::instance().contains("favoriteLocations"))
     {
-        QByteArray buf = settings.value("favoriteLocations").toByteArray();
+        QByteArray buf = SettingsStore::instance().value("favoriteLocations").toByteArray();
 
         ProtoTypes::ArrayLocationId arrIds;
         if (arrIds.ParseFromArray(buf.data(), buf.size()))
@@ -67,7 +65,6 @@ void FavoriteLocationsStorage::writeToSettings()
     QByteArray arr(size, Qt::Uninitialized);
     arrIds.SerializeToArray(arr.data(), size);
 
-    QSettings settings;
-    settings.setValue("favoriteLocations", arr);
+    SettingsStore::instance().setValue("favoriteLocations", arr);
     isFavoriteLocationsSetModified_ = false;
 }
@@ -9,26 +9,29 @@
 //note regarding this todo: passing qsharedpointer's via signal/slots may be a bit tricky (probably need to inform the moc)
 struct CityModelItem
 {
-    int initialInd_;        // ind of item without sorting
+    int initialInd_ = 0;    // ind of item without sorting
     LocationID id;
     QString city;
     QString nick;
     QString countryCode;
     PingTime pingTimeMs;
-    bool bShowPremiumStarOnly;
-    bool isFavorite;
+    int pingJitterMs = 0;
+    int pingP95Ms = 0;
+    int pingLossPercent = 0;
+    bool bShowPremiumStarOnly = false;
+    bool isFavorite = false;
 
     QString staticIpCountryCode;
     QString staticIpType;
     QString staticIp;
 
-    bool isDisabled;
-    bool isCustomConfigCorrect;
+    bool isDisabled = false;
+    bool isCustomConfigCorrect = false;
     QString customConfigType;
     QString customConfigErrorMessage;
 
-    int linkSpeed;
-    int locationLoad;
+    int linkSpeed = 0;
+    int locationLoad = 0;
 
     QString makeTitle() const
     {
@@ -49,14 +52,14 @@ struct CityModelItem
 
 struct LocationModelItem
 {
-    int initialInd_;        // ind of item without sorting
+    int initialInd_ = 0;    // ind of item without sorting
     LocationID id;
     QString title;
     QString countryCode;
-    bool isShowP2P;
-    bool isPremiumOnly;
-    bool is10gbps;
-    int locationLoad;
+    bool isShowP2P = false;
+    bool isPremiumOnly = false;
+    bool is10gbps = false;
+    int locationLoad = 0;
     QVector<CityModelItem> cities;
 
 
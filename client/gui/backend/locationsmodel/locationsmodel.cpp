@@ -61,6 +61,9 @@ void LocationsModel::updateApiLocations(const ProtoTypes::LocationId &bestLocati
             cmi.nick = QString::fromStdString(city.nick());
             cmi.countryCode = lmi->id.isStaticIpsLocation() ? QString::fromStdString(city.static_ip_country_code()) : lmi->countryCode;
             cmi.pingTimeMs = city.ping_time();
+            cmi.pingJitterMs = city.ping_jitter();
+            cmi.pingP95Ms = city.ping_p95();
+            cmi.pingLossPercent = city.ping_loss_percent();
             cmi.bShowPremiumStarOnly = city.is_premium_only();
             cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
             cmi.isDisabled = city.is_disabled();
@@ -204,6 +207,9 @@ void LocationsModel::updateCustomConfigLocations(const ProtoTypes::ArrayLocation
             cmi.nick = QString::fromStdString(city.nick());
             cmi.countryCode = lmi->id.isStaticIpsLocation() ? QString::fromStdString(city.static_ip_country_code()) : lmi->countryCode;
             cmi.pingTimeMs = city.ping_time();
+            cmi.pingJitterMs = city.ping_jitter();
+            cmi.pingP95Ms = city.ping_p95();
+            cmi.pingLossPercent = city.ping_loss_percent();
             cmi.bShowPremiumStarOnly = city.is_premium_only();
             cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
             cmi.isDisabled = city.is_disabled();
@@ -369,37 +375,42 @@ void LocationsModel::setFreeSessionStatus(bool isFreeSessionStatus)
 
 void LocationsModel::changeConnectionSpeed(LocationID id, PingTime speed)
 {
-    [&]() {
-        for (auto lmi : apiLocations_) {
-            for (auto &cmi : lmi->cities) {
-                if (cmi.id == id) {
-                    cmi.pingTimeMs = speed;
-                    return;
-                }
-            }
-        }
-        for (auto lmi : customConfigLocations_) {
+    QHash<LocationID, PingTime> speeds;
+    speeds.insert(id, speed);
+    changeConnectionSpeeds(speeds);
+}
+
+void LocationsModel::changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds)
+{
+    auto updateCities = [&speeds](const QVector< QSharedPointer<LocationModelItem> > &locations) {
+        for (const auto &lmi : locations) {
             for (auto &cmi : lmi->cities) {
-                if (cmi.id == id) {
-                    cmi.pingTimeMs = speed;
-                    return;
+                auto it = speeds.constFind(cmi.id);
+                if (it != speeds.constEnd()) {
+                    cmi.pingTimeMs = it.value();
                 }
             }
         }
-    }();
+    };
+    updateCities(apiLocations_);
+    updateCities(customConfigLocations_);
 
-    allLocations_->changeConnectionSpeed(id, speed);
-    configuredLocations_->changeConnectionSpeed(id, speed);
-    staticIpsLocations_->changeConnectionSpeed(id, speed);
-    favoriteLocations_->changeConnectionSpeed(id, speed);
-    emit locationSpeedChanged(id, speed);
+    allLocations_->changeConnectionSpeeds(speeds);
+    configuredLocations_->changeConnectionSpeeds(speeds);
+    staticIpsLocations_->changeConnectionSpeeds(speeds);
+    favoriteLocations_->changeConnectionSpeeds(speeds);
 
-    // additionally emit signal if id is best location
-    if (!id.isStaticIpsLocation() && !id.isCustomConfigsLocation())
+    for (auto it = speeds.constBegin(); it != speeds.constEnd(); ++it)
     {
-        if (id.apiLocationToBestLocation() == bestLocationId_)
+        emit locationSpeedChanged(it.key(), it.value());
+
+        // additionally emit signal if id is best location
+        if (!it.key().isStaticIpsLocation() && !it.key().isCustomConfigsLocation())
         {
-            emit locationSpeedChanged(bestLocationId_, speed);
+            if (it.key().apiLocationToBestLocation() == bestLocationId_)
+            {
+                emit locationSpeedChanged(bestLocationId_, it.value());
+            }
         }
     }
 }
@@ -43,6 +43,8 @@ public:
 
     void setFreeSessionStatus(bool isFreeSessionStatus);
     void changeConnectionSpeed(LocationID id, PingTime speed);
+    // the speeds of a ping interval, applied in one pass over the items
+    void changeConnectionSpeeds(const QHash<LocationID, PingTime> &speeds);
 
     //LocationID getLocationIdByName(const QString &location) const;
 
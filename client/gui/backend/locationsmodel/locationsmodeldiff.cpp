@@ -0,0 +1,170 @@
+#include "locationsmodeldiff.h"
+
+#include <QHash>
+#include <QSet>
+
+namespace {
+
+// marks the longest strictly increasing subsequence of the values, O(n log n)
+QVector<bool> markLongestIncreasing(const QVector<int> &values)
+{
+    QVector<int> tails;     // tails[k] - the index of the smallest tail of the increasing subsequences of length k + 1
+    QVector<int> prev(values.count(), -1);
+    for (int i = 0; i < values.count(); ++i)
+    {
+        int lo = 0;
+        int hi = tails.count();
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) / 2;
+            if (values[tails[mid]] < values[i])
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        if (lo > 0)
+        {
+            prev[i] = tails[lo - 1];
+        }
+        if (lo == tails.count())
+        {
+            tails << i;
+        }
+        else
+        {
+            tails[lo] = i;
+        }
+    }
+
+    QVector<bool> marks(values.count(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = prev[i])
+    {
+        marks[i] = true;
+    }
+    return marks;
+}
+
+template<typename T>
+LocationsModelDiff makeDiff(const QVector<T *> &oldItems, const QVector<T *> &newItems)
+{
+    LocationsModelDiff diff;
+
+    QHash<LocationID, int> oldIndexes;
+    oldIndexes.reserve(oldItems.count());
+    for (int i = 0; i < oldItems.count(); ++i)
+    {
+        oldIndexes.insert(oldItems[i]->id, i);
+    }
+
+    QSet<LocationID> newIds;
+    QVector<int> keptOldIndexes;    // in the new order
+    for (const T *item : newItems)
+    {
+        newIds.insert(item->id);
+        auto it = oldIndexes.constFind(item->id);
+        if (it == oldIndexes.constEnd())
+        {
+            diff.inserted << item->id;
+        }
+        else
+        {
+            keptOldIndexes << it.value();
+            if (!LocationsModelDiff::isEqual(*oldItems[it.value()], *item))
+            {
+                diff.changed << item->id;
+            }
+        }
+    }
+
+    for (const T *item : oldItems)
+    {
+        if (!newIds.contains(item->id))
+        {
+            diff.removed << item->id;
+        }
+    }
+
+    const QVector<bool> keptOrder = markLongestIncreasing(keptOldIndexes);
+    for (int i = 0; i < keptOldIndexes.count(); ++i)
+    {
+        if (!keptOrder[i])
+        {
+            diff.moved << oldItems[keptOldIndexes[i]]->id;
+        }
+    }
+    return diff;
+}
+
+} // namespace
+
+bool LocationsModelDiff::isEmpty() const
+{
+    return isOnlyChanged() && changed.isEmpty();
+}
+
+bool LocationsModelDiff::isOnlyChanged() const
+{
+    return inserted.isEmpty() && removed.isEmpty() && moved.isEmpty();
+}
+
+LocationsModelDiff LocationsModelDiff::make(const QVector<LocationModelItem *> &oldItems, const QVector<LocationModelItem *> &newItems)
+{
+    return makeDiff(oldItems, newItems);
+}
+
+LocationsModelDiff LocationsModelDiff::make(const QVector<CityModelItem *> &oldItems, const QVector<CityModelItem *> &newItems)
+{
+    return makeDiff(oldItems, newItems);
+}
+
+bool LocationsModelDiff::isEqual(const CityModelItem &item1, const CityModelItem &item2)
+{
+    return item1.initialInd_ == item2.initialInd_ &&
+           item1.id == item2.id &&
+           item1.city == item2.city &&
+           item1.nick == item2.nick &&
+           item1.countryCode == item2.countryCode &&
+           !(item1.pingTimeMs != item2.pingTimeMs) &&
+           item1.pingJitterMs == item2.pingJitterMs &&
+           item1.pingP95Ms == item2.pingP95Ms &&
+           item1.pingLossPercent == item2.pingLossPercent &&
+           item1.bShowPremiumStarOnly == item2.bShowPremiumStarOnly &&
+           item1.isFavorite == item2.isFavorite &&
+           item1.staticIpCountryCode == item2.staticIpCountryCode &&
+           item1.staticIpType == item2.staticIpType &&
+           item1.staticIp == item2.staticIp &&
+           item1.isDisabled == item2.isDisabled &&
+           item1.isCustomConfigCorrect == item2.isCustomConfigCorrect &&
+           item1.customConfigType == item2.customConfigType &&
+           item1.customConfigErrorMessage == item2.customConfigErrorMessage &&
+           item1.linkSpeed == item2.linkSpeed &&
+           item1.locationLoad == item2.locationLoad;
+}
+
+bool LocationsModelDiff::isEqual(const LocationModelItem &item1, const LocationModelItem &item2)
+{
+    if (!(item1.initialInd_ == item2.initialInd_ &&
+          item1.id == item2.id &&
+          item1.title == item2.title &&
+          item1.countryCode == item2.countryCode &&
+          item1.isShowP2P == item2.isShowP2P &&
+          item1.isPremiumOnly == item2.isPremiumOnly &&
+          item1.is10gbps == item2.is10gbps &&
+          item1.locationLoad == item2.locationLoad &&
+          item1.cities.count() == item2.cities.count()))
+    {
+        return false;
+    }
+    for (int i = 0; i < item1.cities.count(); ++i)
+    {
+        if (!isEqual(item1.cities[i], item2.cities[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
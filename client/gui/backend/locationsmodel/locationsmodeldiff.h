@@ -0,0 +1,28 @@
+#ifndef LOCATIONSMODELDIFF_H
+#define LOCATIONSMODELDIFF_H
+
+#include <QVector>
+#include "locationmodelitem.h"
+
+// The difference between two snapshots of the model items, keyed by LocationID:
+// the kept items are moved if they are out of the longest sequence of the items which kept their relative order,
+// and changed if any of their data (including the cities of a region) differs.
+struct LocationsModelDiff
+{
+    QVector<LocationID> inserted;
+    QVector<LocationID> removed;
+    QVector<LocationID> moved;
+    QVector<LocationID> changed;
+
+    bool isEmpty() const;
+    // only the data of the items changed, the list itself is the same
+    bool isOnlyChanged() const;
+
+    static LocationsModelDiff make(const QVector<LocationModelItem *> &oldItems, const QVector<LocationModelItem *> &newItems);
+    static LocationsModelDiff make(const QVector<CityModelItem *> &oldItems, const QVector<CityModelItem *> &newItems);
+
+    static bool isEqual(const CityModelItem &item1, const CityModelItem &item2);
+    static bool isEqual(const LocationModelItem &item1, const LocationModelItem &item2);
+};
+
+#endif // LOCATIONSMODELDIFF_H
@@ -0,0 +1,145 @@
+#include "locationssearchindex.h"
+
+LocationsSearchIndex::LocationsSearchIndex() : isBuilt_(false), hasLastResult_(false)
+{
+}
+
+void LocationsSearchIndex::build(const QVector<LocationModelItem *> &items)
+{
+    clear();
+    for (int r = 0; r < items.count(); ++r)
+    {
+        const LocationModelItem *lmi = items[r];
+        addEntry(r, -1, lmi->title + '\n' + lmi->countryCode);
+        for (int c = 0; c < lmi->cities.count(); ++c)
+        {
+            const CityModelItem &cmi = lmi->cities[c];
+            QString text = cmi.city + '\n' + cmi.nick;
+            if (cmi.countryCode.compare(lmi->countryCode, Qt::CaseInsensitive) != 0)
+            {
+                text += '\n' + cmi.countryCode;
+            }
+            addEntry(r, c, text);
+        }
+    }
+    isBuilt_ = true;
+}
+
+void LocationsSearchIndex::clear()
+{
+    isBuilt_ = false;
+    entries_.clear();
+    texts_.clear();
+    trigrams_.clear();
+    hasLastResult_ = false;
+    lastText_.clear();
+    lastResult_.clear();
+}
+
+const QVector<int> &LocationsSearchIndex::search(const QString &text)
+{
+    const QString foldedText = fold(text);
+    if (hasLastResult_ && foldedText == lastText_)
+    {
+        return lastResult_;
+    }
+
+    QVector<int> candidates;
+    bool allEntries = false;
+    if (hasLastResult_ && foldedText.contains(lastText_))
+    {
+        // the text became longer, the result can only shrink
+        candidates = lastResult_;
+    }
+    else if (foldedText.size() >= 3)
+    {
+        // the entry contains all the trigrams of the text, the shortest posting list is enough to check
+        const QVector<int> *shortest = nullptr;
+        for (int i = 0; i + 3 <= foldedText.size(); ++i)
+        {
+            auto it = trigrams_.constFind(trigram(foldedText.constData() + i));
+            if (it == trigrams_.constEnd())
+            {
+                // nothing contains this trigram
+                shortest = nullptr;
+                break;
+            }
+            if (!shortest || it->count() < shortest->count())
+            {
+                shortest = &it.value();
+            }
+        }
+        if (shortest)
+        {
+            candidates = *shortest;
+        }
+    }
+    else
+    {
+        allEntries = true;
+    }
+
+    lastResult_.clear();
+    if (allEntries)
+    {
+        for (int i = 0; i < texts_.count(); ++i)
+        {
+            if (texts_[i].contains(foldedText))
+            {
+                lastResult_ << i;
+            }
+        }
+    }
+    else
+    {
+        for (int i : qAsConst(candidates))
+        {
+            if (texts_[i].contains(foldedText))
+            {
+                lastResult_ << i;
+            }
+        }
+    }
+    lastText_ = foldedText;
+    hasLastResult_ = true;
+    return lastResult_;
+}
+
+QString LocationsSearchIndex::fold(const QString &str)
+{
+    // the compatibility decomposition splits the accented letters into the letter and the combining mark
+    const QString decomposed = str.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar &c : decomposed)
+    {
+        if (c.category() != QChar::Mark_NonSpacing)
+        {
+            result += c.toCaseFolded();
+        }
+    }
+    return result;
+}
+
+void LocationsSearchIndex::addEntry(int region, int city, const QString &text)
+{
+    const int ind = entries_.count();
+    entries_ << Entry{ region, city };
+    texts_ << fold(text);
+
+    const QString &folded = texts_.last();
+    for (int i = 0; i + 3 <= folded.size(); ++i)
+    {
+        QVector<int> &list = trigrams_[trigram(folded.constData() + i)];
+        // the same trigram can repeat in the text
+        if (list.isEmpty() || list.last() != ind)
+        {
+            list << ind;
+        }
+    }
+}
+
+quint64 LocationsSearchIndex::trigram(const QChar *c)
+{
+    return (static_cast<quint64>(c[0].unicode()) << 32) | (static_cast<quint64>(c[1].unicode()) << 16) | c[2].unicode();
+}
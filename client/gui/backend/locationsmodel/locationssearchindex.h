@@ -0,0 +1,48 @@
+#ifndef LOCATIONSSEARCHINDEX_H
+#define LOCATIONSSEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "locationmodelitem.h"
+
+// Substring search over the locations for the filter-as-you-type: the region title and country code,
+// the city name, nick and country code (if it differs from the region's one).
+// The texts are case and diacritic folded ("São Paulo" is found by "sao") and indexed by trigrams.
+// The last result is kept: when the text grows (the next typed character), only that result is rechecked.
+class LocationsSearchIndex
+{
+public:
+    struct Entry
+    {
+        int region;
+        int city;   // -1 for the region itself
+    };
+
+    LocationsSearchIndex();
+
+    void build(const QVector<LocationModelItem *> &items);
+    void clear();
+    bool isBuilt() const { return isBuilt_; }
+
+    // the indexes of the matched entries, ordered as the items (a region goes before its cities)
+    const QVector<int> &search(const QString &text);
+    const Entry &entry(int ind) const { return entries_[ind]; }
+
+    static QString fold(const QString &str);
+
+private:
+    bool isBuilt_;
+    QVector<Entry> entries_;
+    QVector<QString> texts_;                // the folded texts of the entries
+    QHash<quint64, QVector<int> > trigrams_;  // trigram -> the entries containing it, ascending
+
+    bool hasLastResult_;
+    QString lastText_;
+    QVector<int> lastResult_;
+
+    void addEntry(int region, int city, const QString &text);
+    static quint64 trigram(const QChar *c);
+};
+
+#endif // LOCATIONSSEARCHINDEX_H
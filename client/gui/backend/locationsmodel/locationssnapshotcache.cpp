@@ -0,0 +1,98 @@
+#include "locationssnapshotcache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include "utils/logger.h"
+
+namespace {
+
+const quint32 MAGIC = 0x57534c53;   // "WSLS"
+const quint32 VERSION = 1;
+
+QByteArray serialize(const google::protobuf::Message &message)
+{
+    QByteArray arr(static_cast<int>(message.ByteSizeLong()), Qt::Uninitialized);
+    message.SerializeToArray(arr.data(), arr.size());
+    return arr;
+}
+
+} // namespace
+
+bool LocationsSnapshotCache::load(Snapshot &snapshot)
+{
+    QFile file(filePath());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic, version;
+    QByteArray bestLocation, locations;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION)
+    {
+        return false;
+    }
+    stream >> bestLocation >> snapshot.staticIpDeviceName >> locations;
+    if (stream.status() != QDataStream::Ok ||
+        !snapshot.bestLocation.ParseFromArray(bestLocation.data(), bestLocation.size()) ||
+        !snapshot.locations.ParseFromArray(locations.data(), locations.size()))
+    {
+        qCDebug(LOG_BASIC) << "The locations snapshot is broken, ignored";
+        return false;
+    }
+    return snapshot.locations.locations_size() > 0;
+}
+
+void LocationsSnapshotCache::save(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
+                                  const ProtoTypes::ArrayLocations &locations)
+{
+    save(bestLocation, staticIpDeviceName, serialize(locations));
+}
+
+void LocationsSnapshotCache::save(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
+                                  const QByteArray &serializedLocations)
+{
+    const QString path = filePath();
+    if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).absolutePath()))
+    {
+        return;
+    }
+
+    // written to a temporary file and renamed, a crash never leaves a partial snapshot
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << MAGIC << VERSION << serialize(bestLocation) << staticIpDeviceName << serializedLocations;
+    if (stream.status() != QDataStream::Ok || !file.commit())
+    {
+        qCDebug(LOG_BASIC) << "Failed to save the locations snapshot";
+    }
+}
+
+void LocationsSnapshotCache::clear()
+{
+    const QString path = filePath();
+    if (!path.isEmpty())
+    {
+        QFile::remove(path);
+    }
+}
+
+QString LocationsSnapshotCache::filePath()
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheLocation.isEmpty())
+    {
+        return QString();
+    }
+    return cacheLocation + "/locations_snapshot";
+}
@@ -0,0 +1,32 @@
+#ifndef LOCATIONSSNAPSHOTCACHE_H
+#define LOCATIONSSNAPSHOTCACHE_H
+
+#include <QString>
+#include "ipc/generated_proto/types.pb.h"
+
+// The last API locations received from the engine, on disk. On start the GUI fills the locations model from it
+// before the engine is initialized and logged in, the list from the engine replaces it then.
+// Another cache version or a broken file is a miss.
+class LocationsSnapshotCache
+{
+public:
+    struct Snapshot
+    {
+        ProtoTypes::LocationId bestLocation;
+        QString staticIpDeviceName;
+        ProtoTypes::ArrayLocations locations;
+    };
+
+    static bool load(Snapshot &snapshot);
+    static void save(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
+                     const ProtoTypes::ArrayLocations &locations);
+    // the locations already serialized
+    static void save(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
+                     const QByteArray &serializedLocations);
+    static void clear();
+
+private:
+    static QString filePath();
+};
+
+#endif // LOCATIONSSNAPSHOTCACHE_H
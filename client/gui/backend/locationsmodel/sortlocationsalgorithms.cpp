@@ -1,62 +1,58 @@
 #include "sortlocationsalgorithms.h"
 
 
-bool SortLocationsAlgorithms::lessThanByGeography(LocationModelItem *item1, LocationModelItem *item2)
+LocationSortKey SortLocationsAlgorithms::makeSortKey(const LocationModelItem &item)
 {
-    if (item1->id.isBestLocation() && !item2->id.isBestLocation())
-    {
-        return true;
-    }
-    else if (!item1->id.isBestLocation() && item2->id.isBestLocation())
-    {
-        return false;
-    }
-    return item1->initialInd_ < item2->initialInd_;
+    LocationSortKey key;
+    key.isBestLocation = item.id.isBestLocation();
+    key.initialInd = item.initialInd_;
+    key.averageLatency = item.calcAveragePing();
+    key.title = item.title;
+    return key;
 }
 
-bool SortLocationsAlgorithms::lessThanByAlphabetically(LocationModelItem *item1, LocationModelItem *item2)
+bool SortLocationsAlgorithms::lessThanByGeography(const LocationSortKey &key1, const LocationSortKey &key2)
 {
-    if (item1->id.isBestLocation() && !item2->id.isBestLocation())
+    if (key1.isBestLocation != key2.isBestLocation)
     {
-        return true;
+        return key1.isBestLocation;
     }
-    else if (!item1->id.isBestLocation() && item2->id.isBestLocation())
-    {
-        return false;
-    }
-    return item1->title < item2->title;
+    return key1.initialInd < key2.initialInd;
 }
 
-bool SortLocationsAlgorithms::lessThanByLatency(LocationModelItem *item1, LocationModelItem *item2)
+bool SortLocationsAlgorithms::lessThanByAlphabetically(const LocationSortKey &key1, const LocationSortKey &key2)
 {
-    if (item1->id.isBestLocation() && !item2->id.isBestLocation())
+    if (key1.isBestLocation != key2.isBestLocation)
     {
-        return true;
+        return key1.isBestLocation;
     }
-    else if (!item1->id.isBestLocation() && item2->id.isBestLocation())
+    return key1.title < key2.title;
+}
+
+bool SortLocationsAlgorithms::lessThanByLatency(const LocationSortKey &key1, const LocationSortKey &key2)
+{
+    if (key1.isBestLocation != key2.isBestLocation)
     {
-        return false;
+        return key1.isBestLocation;
     }
 
-    qint32 item1AverageLatency = item1->calcAveragePing();
-    qint32 item2AverageLatency = item2->calcAveragePing();
-    if (item1AverageLatency == item2AverageLatency)
+    if (key1.averageLatency == key2.averageLatency)
     {
-        return item1->title < item2->title;
+        return key1.title < key2.title;
     }
     else
     {
-        if (item1AverageLatency == -1)
+        if (key1.averageLatency == -1)
         {
             return false;
         }
-        else if (item2AverageLatency == -1)
+        else if (key2.averageLatency == -1)
         {
             return true;
         }
         else
         {
-            return item1AverageLatency < item2AverageLatency;
+            return key1.averageLatency < key2.averageLatency;
         }
     }
 }
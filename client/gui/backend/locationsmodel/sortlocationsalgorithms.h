@@ -3,12 +3,25 @@
 
 #include "locationmodelitem.h"
 
+// The values of a region compared by the sort orders, computed once per region instead of in every comparison.
+struct LocationSortKey
+{
+    bool isBestLocation = false;
+    int initialInd = 0;
+    qint32 averageLatency = -1;
+    QString title;
+};
+
 class SortLocationsAlgorithms
 {
 public:
-    static bool lessThanByGeography(LocationModelItem *item1, LocationModelItem *item2);
-    static bool lessThanByAlphabetically(LocationModelItem *item1, LocationModelItem *item2);
-    static bool lessThanByLatency(LocationModelItem *item1, LocationModelItem *item2);
+    typedef bool (*LessThan)(const LocationSortKey &key1, const LocationSortKey &key2);
+
+    static LocationSortKey makeSortKey(const LocationModelItem &item);
+
+    static bool lessThanByGeography(const LocationSortKey &key1, const LocationSortKey &key2);
+    static bool lessThanByAlphabetically(const LocationSortKey &key1, const LocationSortKey &key2);
+    static bool lessThanByLatency(const LocationSortKey &key1, const LocationSortKey &key2);
 
     static bool lessThanByAlphabeticallyCityItem(const CityModelItem &item1, const CityModelItem &item2);
 };
@@ -7,8 +7,7 @@ StaticIpsCitiesModel::StaticIpsCitiesModel(QObject *parent) : BasicCitiesModel(p
 
 void StaticIpsCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> locations)
 {
-    clearCities();
-
+    QVector<CityModelItem *> newCities;
     for (QSharedPointer<LocationModelItem> lmi : locations)
     {
         if (lmi->id.isStaticIpsLocation())
@@ -17,11 +16,10 @@ void StaticIpsCitiesModel::update(QVector<QSharedPointer<LocationModelItem>> loc
             {
                 CityModelItem *cmi = new CityModelItem();
                 *cmi = lmi->cities[i];
-                cities_ << cmi;
+                newCities << cmi;
             }
         }
     }
 
-    sort(cities_);
-    emit itemsUpdated(cities_);
+    replaceCities(newCities);
 }
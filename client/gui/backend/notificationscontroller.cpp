@@ -1,12 +1,12 @@
 #include "notificationscontroller.h"
 
 #include <QDataStream>
-#include <QSettings>
+#include "utils/settingsstore.h"
 #include <algorithm>
 // #include <QDebug>
 
 NotificationsController::NotificationsController(QObject *parent) : QObject(parent),
-    latestTotal_(0), latestUnreadCnt_(0)
+    latestTotal_(0), latestUnreadCnt_(0), isNotificationsChanged_(false), isShownIdsChanged_(false)
 {
     readFromSettings();
 }
@@ -66,35 +66,95 @@ void NotificationsController::checkForUnreadPopup()
 
 void NotificationsController::updateNotifications(const ProtoTypes::ArrayApiNotification &arr)
 {
-    notifications_ = arr;
-    updateState();
+    QByteArray serialized(static_cast<int>(arr.ByteSizeLong()), Qt::Uninitialized);
+    arr.SerializeToArray(serialized.data(), serialized.size());
+    if (serialized != serializedNotifications_)
+    {
+        mergeNotifications(arr);
+        serializedNotifications_ = serialized;
+        isNotificationsChanged_ = true;
+        updateState();
+    }
     checkForUnreadPopup();
 }
 
 void NotificationsController::setNotificationReaded(qint64 notificationId)
 {
-    idOfShownNotifications_.insert(notificationId);
-    updateState();
+    if (!idOfShownNotifications_.contains(notificationId))
+    {
+        idOfShownNotifications_.insert(notificationId);
+        isShownIdsChanged_ = true;
+        removeUnread(notificationId);
+        updateState();
+    }
 }
 
-void NotificationsController::updateState()
+void NotificationsController::mergeNotifications(const ProtoTypes::ArrayApiNotification &arr)
 {
-    int unreaded = 0;
-    unreadPopupNotificationIds_.clear();
+    QSet<qint64> newIds;
+    newIds.reserve(arr.api_notifications_size());
+    for (int i = 0; i < arr.api_notifications_size(); ++i)
+    {
+        const ProtoTypes::ApiNotification &notification = arr.api_notifications(i);
+        newIds.insert(notification.id());
+        if (!idOfShownNotifications_.contains(notification.id()))
+        {
+            // added, or changed in place (the popup flag)
+            addUnread(notification);
+        }
+    }
+    for (int i = 0; i < notifications_.api_notifications_size(); ++i)
+    {
+        const qint64 id = notifications_.api_notifications(i).id();
+        if (!newIds.contains(id))
+        {
+            removeUnread(id);
+        }
+    }
+    notifications_ = arr;
 
-    for(int i = 0; i < notifications_.api_notifications_size(); ++i)
+    // the read flags are kept only for the notifications the server still returns
+    if (!newIds.isEmpty())
     {
-        if (idOfShownNotifications_.find(notifications_.api_notifications(i).id()) == idOfShownNotifications_.end())
+        for (auto it = idOfShownNotifications_.begin(); it != idOfShownNotifications_.end(); )
         {
-            if (notifications_.api_notifications(i).popup() == 1)
+            if (!newIds.contains(*it))
             {
-                unreadPopupNotificationIds_.push_back(notifications_.api_notifications(i).id());
+                it = idOfShownNotifications_.erase(it);
+                isShownIdsChanged_ = true;
+            }
+            else
+            {
+                ++it;
             }
-            unreaded++;
         }
     }
+}
 
+void NotificationsController::addUnread(const ProtoTypes::ApiNotification &notification)
+{
+    const bool isPopup = notification.popup() == 1;
+    unreadNotifications_[notification.id()] = isPopup;
+    if (isPopup)
+    {
+        unreadPopupNotificationIds_.insert(notification.id());
+    }
+    else
+    {
+        unreadPopupNotificationIds_.remove(notification.id());
+    }
+}
+
+void NotificationsController::removeUnread(qint64 notificationId)
+{
+    unreadNotifications_.remove(notificationId);
+    unreadPopupNotificationIds_.remove(notificationId);
+}
+
+void NotificationsController::updateState()
+{
     // updates connect window logo
+    const int unreaded = unreadNotifications_.size();
     if (latestTotal_ != notifications_.api_notifications_size() || latestUnreadCnt_ != unreaded)
     {
         latestTotal_ = notifications_.api_notifications_size();
@@ -105,32 +165,34 @@ void NotificationsController::updateState()
 
 void NotificationsController::saveToSettings()
 {
-    QSettings settings;
+    if (!isNotificationsChanged_ && !isShownIdsChanged_)
+    {
+        return;
+    }
 
-    size_t size = notifications_.ByteSizeLong();
-    QByteArray arr(size, Qt::Uninitialized);
-    notifications_.SerializeToArray(arr.data(), size);
+    SettingsStore &settings = SettingsStore::instance();
 
-    settings.setValue("notifications", arr);
+    if (isNotificationsChanged_)
+    {
+        settings.setValue("notifications", serializedNotifications_);
+    }
 
-    QByteArray arrShownPopups;
+    if (isShownIdsChanged_)
     {
-        QDataStream stream(&arrShownPopups, QIODevice::WriteOnly);
-        stream << idOfShownNotifications_;
+        QByteArray arrShownPopups;
+        {
+            QDataStream stream(&arrShownPopups, QIODevice::WriteOnly);
+            stream << idOfShownNotifications_;
+        }
+        settings.setValue("idForShownPopups", arrShownPopups);
     }
-    settings.setValue("idForShownPopups", arrShownPopups);
-    settings.sync();
+    isNotificationsChanged_ = false;
+    isShownIdsChanged_ = false;
 }
 
 void NotificationsController::readFromSettings()
 {
-    QSettings settings;
-
-    if (settings.contains("notifications"))
-    {
-        QByteArray arr = settings.value("notifications").toByteArray();
-        notifications_.ParseFromArray(arr.data(), arr.size());
-    }
+    SettingsStore &settings = SettingsStore::instance();
 
     if (settings.contains("idForShownPopups"))
     {
@@ -138,6 +200,17 @@ void NotificationsController::readFromSettings()
         QDataStream stream(&arr, QIODevice::ReadOnly);
         stream >> idOfShownNotifications_;
     }
+
+    if (settings.contains("notifications"))
+    {
+        QByteArray arr = settings.value("notifications").toByteArray();
+        ProtoTypes::ArrayApiNotification notifications;
+        if (notifications.ParseFromArray(arr.data(), arr.size()))
+        {
+            mergeNotifications(notifications);
+            serializedNotifications_ = arr;
+        }
+    }
     updateState();
     checkForUnreadPopup();
 }
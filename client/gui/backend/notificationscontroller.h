@@ -1,9 +1,9 @@
 #ifndef NOTIFICATIONSCONTROLLER_H
 #define NOTIFICATIONSCONTROLLER_H
 
+#include <QHash>
 #include <QObject>
 #include <QSet>
-#include <QVector>
 #include "utils/protobuf_includes.h"
 
 class NotificationsController : public QObject
@@ -29,15 +29,23 @@ signals:
     void newPopupMessage(int messageId);
 
 private:
+    // the list is merged by ID on update, the unread ones are kept apart so the counters don't rescan it
     ProtoTypes::ArrayApiNotification notifications_;
+    QByteArray serializedNotifications_;        // for the cheap check of an unchanged list
     QSet<qint64> idOfShownNotifications_;
-    QVector<int> unreadPopupNotificationIds_;
+    QHash<qint64, bool> unreadNotifications_;   // id -> is popup
+    QSet<qint64> unreadPopupNotificationIds_;
 
     int latestTotal_;
     int latestUnreadCnt_;
+    bool isNotificationsChanged_;
+    bool isShownIdsChanged_;
 
     void saveToSettings();
     void readFromSettings();
+    void mergeNotifications(const ProtoTypes::ArrayApiNotification &arr);
+    void addUnread(const ProtoTypes::ApiNotification &notification);
+    void removeUnread(qint64 notificationId);
     void updateState();
     void checkForUnreadPopup();
 };
@@ -3,14 +3,13 @@
 #include <QRect>
 #include <QSettings>
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 
 void PersistentState::load()
 {
-    QSettings settings;
-
-    if (settings.contains("persistentGuiSettings"))
+    if (SettingsStore::instance().contains("persistentGuiSettings"))
     {
-        QByteArray arr = settings.value("persistentGuiSettings").toByteArray();
+        QByteArray arr = SettingsStore::instance().value("persistentGuiSettings").toByteArray();
         state_.ParseFromArray(arr.data(), arr.size());
     }
     // if can't load from version 2
@@ -31,13 +30,12 @@ void PersistentState::load()
 
 void PersistentState::save()
 {
-    QSettings settings;
-
+    // only cached here, written to QSettings by the coalesced flush of the store
     int size = state_.ByteSizeLong();
     QByteArray arr(size, Qt::Uninitialized);
     state_.SerializeToArray(arr.data(), size);
 
-    settings.setValue("persistentGuiSettings", arr);
+    SettingsStore::instance().setValue("persistentGuiSettings", arr);
 }
 
 void PersistentState::setFirewallState(bool bFirewallOn)
@@ -135,6 +133,20 @@ ProtoTypes::NetworkWhiteList PersistentState::networkWhitelist() const
     return state_.network_white_list();
 }
 
+void PersistentState::setWasLoggedIn(bool isLoggedIn)
+{
+    if (state_.was_logged_in() != isLoggedIn)
+    {
+        state_.set_was_logged_in(isLoggedIn);
+        save();
+    }
+}
+
+bool PersistentState::wasLoggedIn() const
+{
+    return state_.was_logged_in();
+}
+
 PersistentState::PersistentState()
 {
     load();
@@ -38,6 +38,10 @@ public:
     void setNetworkWhitelist(const ProtoTypes::NetworkWhiteList &list);
     ProtoTypes::NetworkWhiteList networkWhitelist() const;
 
+    // the last session ended logged in, the next start shows the connect window before the engine is ready
+    void setWasLoggedIn(bool isLoggedIn);
+    bool wasLoggedIn() const;
+
 
 
 
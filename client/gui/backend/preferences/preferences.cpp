@@ -16,6 +16,10 @@
 Preferences::Preferences(QObject *parent) : QObject(parent)
   , receivingEngineSettings_(false)
 {
+    saveGuiSettingsTimer_.setSingleShot(true);
+    saveGuiSettingsTimer_.setInterval(SAVE_GUI_SETTINGS_DELAY_MS);
+    connect(&saveGuiSettingsTimer_, SIGNAL(timeout()), SLOT(onSaveGuiSettingsTimer()));
+
 #if defined(Q_OS_LINUX)
     // ProtoTypes::ConnectionSettings has IKEv2 as default protocol in default instance.
     // But Linux doesn't support IKEv2. It is necessary to change with UDP.
@@ -36,7 +40,7 @@ void Preferences::setLaunchOnStartup(bool b)
     if (guiSettings_.is_launch_on_startup() != b)
     {
         guiSettings_.set_is_launch_on_startup(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit isLaunchOnStartupChanged(guiSettings_.is_launch_on_startup());
     }
 }
@@ -51,7 +55,7 @@ void Preferences::setAutoConnect(bool b)
     if (guiSettings_.is_auto_connect() != b)
     {
         guiSettings_.set_is_auto_connect(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit isAutoConnectChanged(guiSettings_.is_auto_connect());
     }
 }
@@ -89,7 +93,7 @@ void Preferences::setMinimizeAndCloseToTray(bool b)
     if (guiSettings_.is_minimize_and_close_to_tray() != b)
     {
         guiSettings_.set_is_minimize_and_close_to_tray(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit minimizeAndCloseToTrayChanged(b);
     }
 }
@@ -105,7 +109,7 @@ void Preferences::setHideFromDock(bool b)
     if (guiSettings_.is_hide_from_dock() != b)
     {
         guiSettings_.set_is_hide_from_dock(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit hideFromDockChanged(guiSettings_.is_hide_from_dock());
     }
 }
@@ -123,7 +127,7 @@ void Preferences::setStartMinimized(bool b)
     if(guiSettings_.is_start_minimized() != b)
     {
         guiSettings_.set_is_start_minimized(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit isStartMinimizedChanged(b);
     }
 }
@@ -139,7 +143,7 @@ void Preferences::setShowNotifications(bool b)
     if (guiSettings_.is_show_notifications() != b)
     {
         guiSettings_.set_is_show_notifications(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit isShowNotificationsChanged(guiSettings_.is_show_notifications());
     }
 }
@@ -154,7 +158,7 @@ void Preferences::setBackgroundSettings(const ProtoTypes::BackgroundSettings &ba
     if (!google::protobuf::util::MessageDifferencer::Equals(guiSettings_.background_settings(), backgroundSettings))
     {
         *guiSettings_.mutable_background_settings() = backgroundSettings;
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit backgroundSettingsChanged(backgroundSettings);
     }
 }
@@ -169,7 +173,7 @@ void Preferences::setDockedToTray(bool b)
     if (guiSettings_.is_docked_to_tray() != b)
     {
         guiSettings_.set_is_docked_to_tray(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit isDockedToTrayChanged(guiSettings_.is_docked_to_tray());
     }
 }
@@ -198,7 +202,7 @@ void Preferences::setLocationOrder(ProtoTypes::OrderLocationType o)
     if (guiSettings_.order_location() != o)
     {
         guiSettings_.set_order_location(o);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit locationOrderChanged(guiSettings_.order_location());
     }
 }
@@ -213,7 +217,7 @@ void Preferences::setLatencyDisplay(ProtoTypes::LatencyDisplayType l)
     if (guiSettings_.latency_display() != l)
     {
         guiSettings_.set_latency_display(l);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit latencyDisplayChanged(guiSettings_.latency_display());
     }
 }
@@ -380,7 +384,7 @@ void Preferences::setShareSecureHotspot(const ProtoTypes::ShareSecureHotspot &ss
     if(!google::protobuf::util::MessageDifferencer::Equals(guiSettings_.share_secure_hotspot(), ss))
     {
         *guiSettings_.mutable_share_secure_hotspot() = ss;
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit shareSecureHotspotChanged(guiSettings_.share_secure_hotspot());
     }
 }
@@ -395,7 +399,7 @@ void Preferences::setShareProxyGateway(const ProtoTypes::ShareProxyGateway &sp)
     if(!google::protobuf::util::MessageDifferencer::Equals(guiSettings_.share_proxy_gateway(), sp))
     {
         *guiSettings_.mutable_share_proxy_gateway() = sp;
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit shareProxyGatewayChanged(guiSettings_.share_proxy_gateway());
     }
 }
@@ -519,7 +523,7 @@ void Preferences::setSplitTunnelingApps(QList<ProtoTypes::SplitTunnelingApp> app
     *st.mutable_network_routes() = guiSettings_.split_tunneling().network_routes();
 
     *guiSettings_.mutable_split_tunneling() = st;
-    saveGuiSettings();
+    scheduleSaveGuiSettings();
     emit splitTunnelingChanged(st);
 }
 
@@ -546,7 +550,7 @@ void Preferences::setSplitTunnelingNetworkRoutes(QList<ProtoTypes::SplitTunnelin
     *st.mutable_apps() = guiSettings_.split_tunneling().apps();
 
     *guiSettings_.mutable_split_tunneling() = st;
-    saveGuiSettings();
+    scheduleSaveGuiSettings();
     emit splitTunnelingChanged(st);
 }
 
@@ -563,7 +567,7 @@ void Preferences::setSplitTunnelingSettings(ProtoTypes::SplitTunnelingSettings s
     *st.mutable_apps() = guiSettings_.split_tunneling().apps();
     *st.mutable_network_routes() = guiSettings_.split_tunneling().network_routes();
     *guiSettings_.mutable_split_tunneling() = st;
-    saveGuiSettings();
+    scheduleSaveGuiSettings();
     emit splitTunnelingChanged(st);
 }
 
@@ -623,8 +627,9 @@ ProtoTypes::EngineSettings Preferences::getEngineSettings() const
     return engineSettings_;
 }
 
-void Preferences::saveGuiSettings() const
+void Preferences::saveGuiSettings()
 {
+    saveGuiSettingsTimer_.stop();
     QSettings settings;
 
     int size = guiSettings_.ByteSizeLong();
@@ -634,6 +639,16 @@ void Preferences::saveGuiSettings() const
     settings.setValue("guiSettings", arr);
 }
 
+void Preferences::scheduleSaveGuiSettings()
+{
+    saveGuiSettingsTimer_.start();
+}
+
+void Preferences::onSaveGuiSettingsTimer()
+{
+    saveGuiSettings();
+}
+
 void Preferences::loadGuiSettings()
 {
     QSettings settings;
@@ -710,7 +725,7 @@ void Preferences::setShowLocationLoad(bool b)
     if (guiSettings_.is_show_location_health() != b)
     {
         guiSettings_.set_is_show_location_health(b);
-        saveGuiSettings();
+        scheduleSaveGuiSettings();
         emit showLocationLoadChanged(guiSettings_.is_show_location_health());
     }
 }
@@ -2,6 +2,7 @@
 #define PREFERENCES_H
 
 #include <QObject>
+#include <QTimer>
 //#include "../types/types.h"
 #include "../types/dnswhileconnectedinfo.h"
 #include "utils/protobuf_includes.h"
@@ -130,7 +131,8 @@ public:
 
     ProtoTypes::EngineSettings getEngineSettings() const;
 
-    void saveGuiSettings() const;
+    // the setters save the gui settings after SAVE_GUI_SETTINGS_DELAY_MS, so a burst of changes is one write
+    void saveGuiSettings();
     void loadGuiSettings();
     void validateAndUpdateIfNeeded();
 
@@ -188,11 +190,19 @@ signals:
 
     void reportErrorToUser(QString title, QString desc);
 
+private slots:
+    void onSaveGuiSettingsTimer();
+
 private:
     ProtoTypes::EngineSettings engineSettings_;
     ProtoTypes::GuiSettings guiSettings_;
 
     bool receivingEngineSettings_;
+
+    QTimer saveGuiSettingsTimer_;
+    static constexpr int SAVE_GUI_SETTINGS_DELAY_MS = 500;
+
+    void scheduleSaveGuiSettings();
 };
 
 #endif // PREFERENCES_H
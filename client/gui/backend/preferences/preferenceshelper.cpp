@@ -45,6 +45,20 @@ QString PreferencesHelper::getProxyGatewayAddress() const
     return proxyGatewayAddress_;
 }
 
+void PreferencesHelper::setProxyGatewayTraffic(const ProtoTypes::ProxySharingTraffic &traffic)
+{
+    if (!google::protobuf::util::MessageDifferencer::Equals(traffic, proxyGatewayTraffic_))
+    {
+        proxyGatewayTraffic_ = traffic;
+        emit proxyGatewayTrafficChanged(proxyGatewayTraffic_);
+    }
+}
+
+const ProtoTypes::ProxySharingTraffic &PreferencesHelper::getProxyGatewayTraffic() const
+{
+    return proxyGatewayTraffic_;
+}
+
 void PreferencesHelper::setAvailableOpenVpnVersions(const QStringList &list)
 {
     if (list != availableOpenVpnVersions_)
@@ -67,50 +81,46 @@ QVector<ProtoTypes::TapAdapterType> PreferencesHelper::getAvailableTapAdapters(c
 void PreferencesHelper::setPortMap(const ProtoTypes::ArrayPortMap &arr)
 {
     portMap_ = arr;
-    emit portMapChanged();
-}
 
-QVector<ProtoTypes::Protocol> PreferencesHelper::getAvailableProtocols()
-{
+    // the windows and the combo boxes ask on every refresh, the answers are prepared once per port map
 #if defined(Q_OS_WINDOWS)
     bool is32bit = !WinUtils::isWindows64Bit();
 #endif
-
-    QVector<ProtoTypes::Protocol> p;
+    availableProtocols_.clear();
+    portsByProtocol_.clear();
     for (int i = 0; i < portMap_.port_map_item_size(); ++i)
     {
-#if defined(Q_OS_LINUX)
         const auto protocol = portMap_.port_map_item(i).protocol();
+        QVector<uint> &ports = portsByProtocol_[protocol];
+        for (int p = 0; p < portMap_.port_map_item(i).ports_size(); ++p)
+        {
+            ports << portMap_.port_map_item(i).ports(p);
+        }
+
+#if defined(Q_OS_LINUX)
         if (protocol == ProtoTypes::Protocol::PROTOCOL_IKEV2) {
             continue;
         }
 #elif defined(Q_OS_WINDOWS)
-        const auto protocol = portMap_.port_map_item(i).protocol();
         if (is32bit && ((protocol == ProtoTypes::Protocol::PROTOCOL_WIREGUARD) || (protocol == ProtoTypes::Protocol::PROTOCOL_WSTUNNEL)))
         {
             continue;
         }
 #endif
-        p << portMap_.port_map_item(i).protocol();
+        availableProtocols_ << protocol;
     }
-    return p;
+
+    emit portMapChanged();
 }
 
-QVector<uint> PreferencesHelper::getAvailablePortsForProtocol(ProtoTypes::Protocol protocol)
+QVector<ProtoTypes::Protocol> PreferencesHelper::getAvailableProtocols()
 {
-    QVector<uint> v;
-    for (int i = 0; i < portMap_.port_map_item_size(); ++i)
-    {
-        if (portMap_.port_map_item(i).protocol() == protocol)
-        {
-            for (int p = 0; p < portMap_.port_map_item(i).ports_size(); ++p)
-            {
-                v << portMap_.port_map_item(i).ports(p);
-            }
-        }
-    }
+    return availableProtocols_;
+}
 
-    return v;
+QVector<uint> PreferencesHelper::getAvailablePortsForProtocol(ProtoTypes::Protocol protocol)
+{
+    return portsByProtocol_.value(protocol);
 }
 
 void PreferencesHelper::setWifiSharingSupported(bool bSupported)
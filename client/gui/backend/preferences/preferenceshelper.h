@@ -2,6 +2,7 @@
 #define PREFERENCESHELPER_H
 
 #include <QObject>
+#include <QHash>
 #include <QVector>
 #include "utils/protobuf_includes.h"
 
@@ -17,6 +18,9 @@ public:
     void setProxyGatewayAddress(const QString &address);
     QString getProxyGatewayAddress() const;
 
+    void setProxyGatewayTraffic(const ProtoTypes::ProxySharingTraffic &traffic);
+    const ProtoTypes::ProxySharingTraffic &getProxyGatewayTraffic() const;
+
     void setAvailableOpenVpnVersions(const QStringList &list);
     QStringList getAvailableOpenVpnVersions();
 
@@ -48,6 +52,7 @@ signals:
     void availableOpenVpnVersionsChanged(const QStringList &list);
     void wifiSharingSupportedChanged(bool bSupported);
     void proxyGatewayAddressChanged(const QString &address);
+    void proxyGatewayTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic);
     void ipv6StateInOSChanged(bool bEnabled);
     void installedTapAdapterChanged(ProtoTypes::TapAdapterType tapAdapter);
     void isFirewallBlockedChanged(bool bFirewallBlocked);
@@ -59,9 +64,12 @@ private:
     QStringList availableOpenVpnVersions_;
 
     ProtoTypes::ArrayPortMap portMap_;
+    QVector<ProtoTypes::Protocol> availableProtocols_;
+    QHash<int, QVector<uint> > portsByProtocol_;
     bool isWifiSharingSupported_;
 
     QString proxyGatewayAddress_;
+    ProtoTypes::ProxySharingTraffic proxyGatewayTraffic_;
     bool bIpv6StateInOS_;
 
     bool isFirewallBlocked_;
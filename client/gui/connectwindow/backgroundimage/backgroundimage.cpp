@@ -56,14 +56,14 @@ void BackgroundImage::changeFlag(const QString &countryCode)
         if (countryCode_.isEmpty())
         {
             QSharedPointer<IndependentPixmap> indPix = ImageResourcesSvg::instance().getScaledFlag(
-                   countryCode, WIDTH * G_SCALE, 176 * G_SCALE);
+                   countryCode, WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE);
             imageChanger_.setImage(indPix, false);
             switchConnectGradient(false);
         }
         else if (countryCode_ != countryCode)
         {
             QSharedPointer<IndependentPixmap> indPix = ImageResourcesSvg::instance().getScaledFlag(
-                   countryCode, WIDTH * G_SCALE, 176 * G_SCALE);
+                   countryCode, WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE);
             imageChanger_.setImage(indPix, true);
             switchConnectGradient(false);
         }
@@ -164,14 +164,14 @@ void BackgroundImage::handleBackgroundsChange()
     else if (curBackgroundSettings_.background_type() == ProtoTypes::BackgroundType::BACKGROUND_TYPE_NONE)
     {
         QSharedPointer<IndependentPixmap> indPix = ImageResourcesSvg::instance().getScaledFlag(
-            "noflag", WIDTH * G_SCALE, 176 * G_SCALE);
+            "noflag", WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE);
         imageChanger_.setImage(indPix, false);
         switchConnectGradient(false);
     }
     else if (curBackgroundSettings_.background_type() == ProtoTypes::BackgroundType::BACKGROUND_TYPE_COUNTRY_FLAGS)
     {
         QSharedPointer<IndependentPixmap> indPix = ImageResourcesSvg::instance().getScaledFlag(
-            (countryCode_.isEmpty() ? "noflag" : countryCode_), WIDTH * G_SCALE, 176 * G_SCALE);
+            (countryCode_.isEmpty() ? "noflag" : countryCode_), WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE);
         imageChanger_.setImage(indPix, false);
         switchConnectGradient(false);
     }
@@ -191,7 +191,7 @@ void BackgroundImage::safeChangeToDisconnectedImage(bool bShowPrevChangeAnimatio
     else
     {
         imageChanger_.setImage(ImageResourcesSvg::instance().getScaledFlag(
-                                   "noflag", WIDTH * G_SCALE, 176 * G_SCALE), bShowPrevChangeAnimation);
+                                   "noflag", WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE), bShowPrevChangeAnimation);
         switchConnectGradient(false);
     }
 }
@@ -206,11 +206,16 @@ void BackgroundImage::safeChangeToConnectedImage(bool bShowPrevChangeAnimation)
     else
     {
         imageChanger_.setImage(ImageResourcesSvg::instance().getScaledFlag(
-                                   "noflag", WIDTH * G_SCALE, 176 * G_SCALE), bShowPrevChangeAnimation);
+                                   "noflag", WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE), bShowPrevChangeAnimation);
         switchConnectGradient(false);
     }
 }
 
+void BackgroundImage::prefetchFlag(const QString &countryCode)
+{
+    ImageResourcesSvg::instance().prefetchScaledFlag(countryCode, WIDTH * G_SCALE, FLAG_HEIGHT * G_SCALE);
+}
+
 void BackgroundImage::switchConnectGradient(bool isCustomBackground)
 {
     if (isCustomBackground)
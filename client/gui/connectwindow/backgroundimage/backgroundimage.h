@@ -27,6 +27,9 @@ public:
 
     void updateScaling();
 
+    // renders the flag background of a country in advance, for a location likely to be selected next
+    static void prefetchFlag(const QString &countryCode);
+
 signals:
     void updated();
 
@@ -36,6 +39,7 @@ private slots:
 
 private:
     static constexpr int WIDTH = 332;
+    static constexpr int FLAG_HEIGHT = 176;
     static constexpr int ANIMATION_DURATION = 500;
 
     QString connectingGradient_;
@@ -8,8 +8,12 @@
 namespace ConnectWindow {
 
 ImageChanger::ImageChanger(QObject *parent, int animationDuration) : QObject(parent),
-    pixmap_(nullptr), opacityCurImage_(1.0), opacityPrevImage_(0.0), animationDuration_(animationDuration)
+    pixmap_(nullptr), isPixmapDirty_(false), opacityCurImage_(1.0), opacityPrevImage_(0.0), animationDuration_(animationDuration)
 {
+    updatePixmapTimer_.setSingleShot(true);
+    updatePixmapTimer_.setInterval(FRAME_INTERVAL_MS);
+    connect(&updatePixmapTimer_, SIGNAL(timeout()), SLOT(updatePixmap()));
+
     connect(&opacityAnimation_, SIGNAL(valueChanged(QVariant)), SLOT(onOpacityChanged(QVariant)));
     connect(&opacityAnimation_, SIGNAL(finished()), SLOT(onOpacityFinished()));
 
@@ -36,7 +40,7 @@ void ImageChanger::setImage(QSharedPointer<IndependentPixmap> pixmap, bool bShow
         curImage_.pixmap = pixmap;
         opacityPrevImage_ = 0.0;
         opacityCurImage_ = 1.0;
-        updatePixmap();
+        requestUpdatePixmap();
     }
     else
     {
@@ -58,7 +62,7 @@ void ImageChanger::setImage(QSharedPointer<IndependentPixmap> pixmap, bool bShow
         opacityAnimation_.setDuration((1.0 - opacityCurImage_) * animationDuration_);
 
         opacityAnimation_.start();
-        updatePixmap();
+        requestUpdatePixmap();
     }
     onMainWindowIsActiveChanged(MainWindowState::instance().isActive());
 }
@@ -75,7 +79,7 @@ void ImageChanger::setMovie(QSharedPointer<QMovie> movie, bool bShowPrevChangeAn
         curImage_.movie = movie;
         opacityPrevImage_ = 0.0;
         opacityCurImage_ = 1.0;
-        connect(curImage_.movie.get(), SIGNAL(updated(QRect)), SLOT(updatePixmap()));
+        connect(curImage_.movie.get(), SIGNAL(updated(QRect)), SLOT(requestUpdatePixmap()));
         curImage_.movie->start();
     }
     else
@@ -98,7 +102,7 @@ void ImageChanger::setMovie(QSharedPointer<QMovie> movie, bool bShowPrevChangeAn
         opacityAnimation_.setEndValue(1.0);
         opacityAnimation_.setDuration((1.0 - opacityCurImage_) * animationDuration_);
 
-        connect(curImage_.movie.get(), SIGNAL(updated(QRect)), SLOT(updatePixmap()));
+        connect(curImage_.movie.get(), SIGNAL(updated(QRect)), SLOT(requestUpdatePixmap()));
         curImage_.movie->start();
         opacityAnimation_.start();
     }
@@ -109,7 +113,7 @@ void ImageChanger::onOpacityChanged(const QVariant &value)
 {
     opacityPrevImage_ = 1.0 - value.toDouble();
     opacityCurImage_ = value.toDouble();
-    updatePixmap();
+    requestUpdatePixmap();
 }
 
 void ImageChanger::onOpacityFinished()
@@ -121,15 +125,37 @@ void ImageChanger::onOpacityFinished()
     {
         prevImage_.clear(this);
     }
-    updatePixmap();
+    requestUpdatePixmap();
+}
+
+void ImageChanger::requestUpdatePixmap()
+{
+    isPixmapDirty_ = true;
+    // composed on the activation, nobody sees it now
+    if (!MainWindowState::instance().isActive())
+    {
+        return;
+    }
+    // not restarted, so a stream of the movie frames and animation steps is composed once per interval
+    if (!updatePixmapTimer_.isActive())
+    {
+        updatePixmapTimer_.start();
+    }
 }
 
 void ImageChanger::updatePixmap()
 {
-    SAFE_DELETE(pixmap_);
+    isPixmapDirty_ = false;
 
-    pixmap_ = new QPixmap(WIDTH * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio(), 176 * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio());
-    pixmap_->setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
+    const int devicePixelRatio = DpiScaleManager::instance().curDevicePixelRatio();
+    const QSize size(WIDTH * G_SCALE * devicePixelRatio, 176 * G_SCALE * devicePixelRatio);
+    // the pixmap is reused while the scale is the same
+    if (!pixmap_ || pixmap_->size() != size || pixmap_->devicePixelRatio() != devicePixelRatio)
+    {
+        SAFE_DELETE(pixmap_);
+        pixmap_ = new QPixmap(size);
+        pixmap_->setDevicePixelRatio(devicePixelRatio);
+    }
     pixmap_->fill(QColor(2, 13, 28));
 
     // prev and current gradient info
@@ -225,6 +251,10 @@ void ImageChanger::updatePixmap()
 
 void ImageChanger::onMainWindowIsActiveChanged(bool isActive)
 {
+    if (isActive && isPixmapDirty_ && !updatePixmapTimer_.isActive())
+    {
+        updatePixmapTimer_.start();
+    }
     if (curImage_.isValid() && curImage_.isMovie && curImage_.movie)
     {
         curImage_.movie->setPaused(!isActive);
@@ -237,7 +267,8 @@ void ImageChanger::onMainWindowIsActiveChanged(bool isActive)
 
 void ImageChanger::generateCustomGradient(const QSize &size)
 {
-    if (customGradient_.isNull() || customGradient_.size() != size)
+    // the pixmap size is in the device pixels
+    if (customGradient_.isNull() || customGradient_.size() != size * DpiScaleManager::instance().curDevicePixelRatio())
     {
         customGradient_ = QPixmap(size * DpiScaleManager::instance().curDevicePixelRatio());
         customGradient_.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
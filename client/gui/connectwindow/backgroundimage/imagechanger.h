@@ -4,11 +4,14 @@
 #include <QObject>
 #include <QVariantAnimation>
 #include <QMovie>
+#include <QTimer>
 #include "../../graphicresources/independentpixmap.h"
 
 namespace ConnectWindow {
 
-// Provides smooth image change and gif animation
+// Provides smooth image change and gif animation.
+// The movie frames and the animation steps only mark the pixmap dirty, it's composed at most once per frame interval
+// and not composed at all (the movie is paused) while the main window is minimized or hidden.
 class ImageChanger : public QObject
 {
     Q_OBJECT
@@ -26,13 +29,17 @@ signals:
 private slots:
     void onOpacityChanged(const QVariant &value);
     void onOpacityFinished();
+    void requestUpdatePixmap();
     void updatePixmap();
     void onMainWindowIsActiveChanged(bool isActive);
 
 private:
     static constexpr int WIDTH = 332;
+    static constexpr int FRAME_INTERVAL_MS = 16;
 
     QPixmap *pixmap_;
+    bool isPixmapDirty_;
+    QTimer updatePixmapTimer_;
     qreal opacityCurImage_;
     qreal opacityPrevImage_;
     int animationDuration_;
@@ -4,6 +4,7 @@
 #include <math.h>
 #include "graphicresources/imageresourcessvg.h"
 #include "dpiscalemanager.h"
+#include "idlemodecontroller.h"
 
 namespace ConnectWindow {
 
@@ -65,6 +66,10 @@ ConnectButton::ConnectButton(ScalableGraphicsObject *parent) : ClickableGraphics
     noInternetRingRotationAnimation_.setDuration(1200);
     noInternetRingRotationAnimation_.setLoopCount(-1);
 
+    // the endless rotations are paused while the window is hidden
+    IdleModeController::instance().addAnimation(&connectingRingRotationAnimation_);
+    IdleModeController::instance().addAnimation(&noInternetRingRotationAnimation_);
+
     noInternetRingOpacityAnimation_.setTargetObject(svgItemConnectingNoInternetRing_);
     noInternetRingOpacityAnimation_.setPropertyName("opacity");
     noInternetRingOpacityAnimation_.setStartValue(0.0);
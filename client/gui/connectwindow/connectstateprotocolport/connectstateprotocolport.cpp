@@ -8,6 +8,7 @@
 #include "commongraphics/commongraphics.h"
 #include "languagecontroller.h"
 #include "dpiscalemanager.h"
+#include "idlemodecontroller.h"
 
 const int PROTOCOL_OPACITY_ANIMATION_DURATION = 500;
 
@@ -35,6 +36,7 @@ ConnectStateProtocolPort::ConnectStateProtocolPort(ScalableGraphicsObject *paren
     setAcceptHoverEvents(true);
     protocolTestTunnelTimer_.setInterval(PROTOCOL_OPACITY_ANIMATION_DURATION);
     connect(&protocolTestTunnelTimer_, SIGNAL(timeout()), SLOT(onProtocolTestTunnelTimerTick()));
+    IdleModeController::instance().addAnimationTimer(&protocolTestTunnelTimer_);
     connect(&protocolOpacityAnimation_, SIGNAL(valueChanged(QVariant)), SLOT(onProtocolOpacityAnimationChanged(QVariant)));
 
     connectionBadgeDots_ = new ConnectionBadgeDots(this);
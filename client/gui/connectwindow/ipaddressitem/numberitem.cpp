@@ -2,6 +2,7 @@
 
 #include <QTimer>
 #include <QEasingCurve>
+#include "idlemodecontroller.h"
 
 NumberItem::NumberItem(QObject *parent, NumbersPixmap *numbersPixmap) : QObject(parent),
     numbersPixmap_(numbersPixmap), curNum_(0), offs_(0), stopOffs_(0), stopAccelerationOffs_(0),
@@ -10,6 +11,7 @@ NumberItem::NumberItem(QObject *parent, NumbersPixmap *numbersPixmap) : QObject(
 {
     timer_ = new QTimer(this);
     connect(timer_, SIGNAL(timeout()), SLOT(onTimer()));
+    IdleModeController::instance().addAnimationTimer(timer_);
 }
 
 void NumberItem::setNumber(int num)
@@ -3,6 +3,7 @@
 #include <QTimer>
 #include "utils/utils.h"
 #include "dpiscalemanager.h"
+#include "idlemodecontroller.h"
 
 OctetItem::OctetItem(QObject *parent, NumbersPixmap *numbersPixmap) : QObject(parent), numbersPixmap_(numbersPixmap)
 {
@@ -16,6 +17,7 @@ OctetItem::OctetItem(QObject *parent, NumbersPixmap *numbersPixmap) : QObject(pa
 
     timer_ = new QTimer(this);
     connect(timer_, SIGNAL(timeout()), SLOT(onTimer()));
+    IdleModeController::instance().addAnimationTimer(timer_);
 }
 
 void OctetItem::setOctetNumber(int num, bool bWithAnimation)
@@ -13,18 +13,7 @@ QFont *FontManager::getFontWithCustomScale(double scale, int size, bool isBold,
 {
     Q_ASSERT(QApplication::instance()->thread() == QThread::currentThread());
 
-    QString key = QString::number(size);
-    if (isBold)
-    {
-        key += "_1";
-    }
-    else
-    {
-        key += "_0";
-    }
-
-    key += "_" + QString::number(stretch);
-    key += "_" + QString::number(scale, 'f', 2 );
+    const quint64 key = fontKey(scale, size, isBold, stretch, letterSpacing);
     // qDebug() << "Font key: " << key;
 
     auto it = fonts_.find(key);
@@ -67,14 +56,41 @@ QString FontManager::getFontStyleSheet(int size, bool isBold)
     return s;
 }
 
+QStaticText FontManager::getStaticText(const QString &text, int size, bool isBold)
+{
+    const QPair<quint64, QString> key(fontKey(G_SCALE, size, isBold, 100, 0.0), text);
+    auto it = staticTexts_.find(key);
+    if (it == staticTexts_.end())
+    {
+        QStaticText staticText(text);
+        staticText.setTextFormat(Qt::PlainText);
+        staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+        staticText.prepare(QTransform(), *getFont(size, isBold));
+        it = staticTexts_.insert(key, staticText);
+    }
+    return it.value();
+}
+
 void FontManager::clearCache()
 {
     fonts_.clear();
+    staticTexts_.clear();
 }
 
 void FontManager::languageChanged()
 {
     clearFontMap();
+    staticTexts_.clear();
+}
+
+quint64 FontManager::fontKey(double scale, int size, bool isBold, int stretch, qreal letterSpacing)
+{
+    // 15 bits of the size, 16 bits for each of the stretch, scale and letter spacing (both in hundredths), the bold flag
+    return (static_cast<quint64>(size & 0x7FFF) << 49) |
+           (static_cast<quint64>(static_cast<quint16>(stretch)) << 33) |
+           (static_cast<quint64>(static_cast<quint16>(qRound(scale * 100))) << 17) |
+           (static_cast<quint64>(static_cast<quint16>(qRound(letterSpacing * 100))) << 1) |
+           static_cast<quint64>(isBold);
 }
 
 QColor FontManager::getLocationsFooterColor()
@@ -1,9 +1,10 @@
 #ifndef FONTMANAGER_H
 #define FONTMANAGER_H
 
-#include <QMap>
+#include <QHash>
 #include <QSharedPointer>
 #include <QColor>
+#include <QStaticText>
 #include "fontdescr.h"
 
 // manages fonts, use different fonts, depending current language
@@ -20,6 +21,8 @@ public:
     QFont *getFont(int size, bool isBold, int stretch = 100, qreal letterSpacing = 0.0);
     QFont *getFont(const FontDescr &fd);
     QString getFontStyleSheet(int size, bool isBold);
+    // the plain text prepared for drawing with getFont(size, isBold), shared by all the callers until the cache is cleared
+    QStaticText getStaticText(const QString &text, int size, bool isBold);
     void clearCache();
 
     void languageChanged();
@@ -44,8 +47,10 @@ private:
     FontManager();
     ~FontManager();
 
-    QMap<QString, QFont *> fonts_;
+    QHash<quint64, QFont *> fonts_;
+    QHash<QPair<quint64, QString>, QStaticText> staticTexts_;
 
+    static quint64 fontKey(double scale, int size, bool isBold, int stretch, qreal letterSpacing);
     void clearFontMap();
 };
 
@@ -9,6 +9,17 @@
 #include "dpiscalemanager.h"
 #include "utils/widgetutils.h"
 
+namespace {
+
+// the images of different device pixel ratios are kept apart, nothing has to be dropped on a scale change
+QString uniqName(const QString &name, int width, int height)
+{
+    return name + "_" + QString::number(width) + "_" + QString::number(height) + "_" +
+           QString::number(DpiScaleManager::instance().curDevicePixelRatio());
+}
+
+} // namespace
+
 ImageResourcesJpg::ImageResourcesJpg()
 {
     QDirIterator it(":/jpg", QDirIterator::Subdirectories);
@@ -43,8 +54,8 @@ void ImageResourcesJpg::clearHash()
 // get pixmap with custom size
 QSharedPointer<IndependentPixmap> ImageResourcesJpg::getIndependentPixmap(const QString &name, int width, int height)
 {
-    QString uniqName = name + "_" + QString::number(width) + "_" + QString::number(height);
-    auto it = hashIndependent_.find(uniqName);
+    const QString key = uniqName(name, width, height);
+    auto it = hashIndependent_.find(key);
     if (it != hashIndependent_.end())
     {
         return it.value();
@@ -53,7 +64,7 @@ QSharedPointer<IndependentPixmap> ImageResourcesJpg::getIndependentPixmap(const
     {
         if (loadFromResourceWithCustomSize(name, width, height))
         {
-            return hashIndependent_.find(uniqName).value();
+            return hashIndependent_.find(key).value();
         }
         else
         {
@@ -97,7 +108,7 @@ bool ImageResourcesJpg::loadFromResourceWithCustomSize(const QString &name, int
     painter.setRenderHint(QPainter::Antialiasing);
     painter.drawImage(QRect(0, 0, pixmap.width(), pixmap.height()), img, QRect(0, 0, img.width(), img.height()));
     pixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
-    hashIndependent_[name + "_" + QString::number(width) + "_" + QString::number(height)] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
+    hashIndependent_[uniqName(name, width, height)] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
     return true;
 }
 
@@ -1,17 +1,60 @@
 #include "imageresourcessvg.h"
 
+#include <QDir>
 #include <QDirIterator>
 #include <QSvgRenderer>
 #include <QPainter>
 #include <QApplication>
 #include <QScreen>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
+#include "utils/tracespan.h"
 #include "dpiscalemanager.h"
 #include "utils/widgetutils.h"
 
-ImageResourcesSvg::ImageResourcesSvg() : QThread(nullptr), bNeedFinish_(false), bFininishedGracefully_(false), mutex_(QMutex::Recursive)
+namespace {
+
+// runs ImageResourcesSvg::preloadNext() on a pool thread
+class PreloadTask : public QRunnable
+{
+public:
+    explicit PreloadTask(std::function<void()> func) : func_(func) {}
+    void run() override
+    {
+        BIND_CRASH_HANDLER_FOR_THREAD();
+        func_();
+    }
+
+private:
+    std::function<void()> func_;
+};
+
+const char *FLAG_ATLAS_NAME = "flags/atlas";  // in SvgRasterCache and pendingRenders_
+const char *NO_FLAG_NAME = "flags/noflag";    // is in the hash once the atlas is there
+
+qint64 imageBytes(const QSize &size)
 {
+    return static_cast<qint64>(size.width()) * size.height() * 4;
+}
+
+} // namespace
+
+ImageResourcesSvg::ImageResourcesSvg() : QThread(nullptr), curScale_(G_SCALE),
+    curDevicePixelRatio_(DpiScaleManager::instance().curDevicePixelRatio()), isImagesUpdatedScheduled_(false),
+    bNeedFinish_(false), bFininishedGracefully_(false), mutex_(QMutex::Recursive), scaledBytes_(0),
+    isScaledPrefetchRunning_(false), nextPreloadInd_(0)
+{
+    // one core is left for the GUI thread, which renders the images it needs right away
+    preloadPool_.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    // the icon extraction goes through the shell, a few at a time are enough
+    iconPool_.setMaxThreadCount(2);
 }
 
 ImageResourcesSvg::~ImageResourcesSvg()
@@ -22,23 +65,70 @@ ImageResourcesSvg::~ImageResourcesSvg()
 void ImageResourcesSvg::clearHash()
 {
     hashIndependent_.clear();
+    retainedScales_.clear();
+    clearScaled();
     iconHashes_.clear();
+    failedIcons_.clear();
 }
 
-
-void ImageResourcesSvg::clearHashAndStartPreloading()
+void ImageResourcesSvg::updateScaleAndStartPreloading()
 {
     bNeedFinish_ = true;
     wait();
-    clearHash();
     bNeedFinish_ = false;
+    {
+        QMutexLocker locker(&mutex_);
+        const int devicePixelRatio = DpiScaleManager::instance().curDevicePixelRatio();
+        if (!qFuzzyCompare(curScale_, G_SCALE) || curDevicePixelRatio_ != devicePixelRatio)
+        {
+            // the current images are retained, the ones of the new scale are taken back if it was used recently
+            ScaleImages cur;
+            cur.scale = curScale_;
+            cur.devicePixelRatio = curDevicePixelRatio_;
+            cur.images.swap(hashIndependent_);
+            for (int i = 0; i < retainedScales_.size(); ++i)
+            {
+                if (qFuzzyCompare(retainedScales_[i].scale, G_SCALE) && retainedScales_[i].devicePixelRatio == devicePixelRatio)
+                {
+                    hashIndependent_.swap(retainedScales_[i].images);
+                    retainedScales_.removeAt(i);
+                    break;
+                }
+            }
+            retainedScales_.prepend(cur);
+            while (retainedScales_.size() > MAX_RETAINED_SCALES - 1)
+            {
+                retainedScales_.removeLast();
+            }
+            curScale_ = G_SCALE;
+            curDevicePixelRatio_ = devicePixelRatio;
+            // the custom sizes are in the pixels of the scale
+            clearScaled();
+            qCDebug(LOG_BASIC) << "ImageResourcesSvg: scale" << curScale_ << "x" << curDevicePixelRatio_ << "," << hashIndependent_.size() << "images retained";
+        }
+        iconHashes_.clear();
+    }
+    // only the images missing for the scale are rendered
     start(Priority::LowestPriority);
 }
 
+void ImageResourcesSvg::releaseMemory()
+{
+    bNeedFinish_ = true;
+    wait();
+    preloadPool_.waitForDone();
+    iconPool_.waitForDone();
+    bNeedFinish_ = false;
+    QMutexLocker locker(&mutex_);
+    clearHash();
+}
+
 void ImageResourcesSvg::finishGracefully()
 {
     bNeedFinish_ = true;
     wait();
+    preloadPool_.waitForDone();
+    iconPool_.waitForDone();
     clearHash();
     bFininishedGracefully_ = true;
 }
@@ -54,6 +144,12 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIndependentPixmap(const
     }
     else
     {
+        QSharedPointer<IndependentPixmap> placeholder = createPlaceholder(name);
+        if (placeholder)
+        {
+            renderInBackground(name);
+            return placeholder;
+        }
         if (loadFromResource(name))
         {
             return hashIndependent_.find(name).value();
@@ -76,30 +172,62 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIconIndependentPixmap(co
     }
     else
     {
-        if (loadIconFromResource(name))
+        if (!failedIcons_.contains(name))
         {
-            return iconHashes_.find(name).value();
+            loadIconInBackground(name);
         }
-        else
+        return nullptr;
+    }
+}
+
+QSharedPointer<IndependentPixmap> ImageResourcesSvg::getFlag(const QString &flagName)
+{
+    QMutexLocker locker(&mutex_);
+    const QString name = "flags/" + flagName;
+    if (!hasFlagAtlas())
+    {
+        QSharedPointer<IndependentPixmap> placeholder = createPlaceholder(name);
+        if (placeholder)
+        {
+            loadFlagAtlasInBackground();
+            return placeholder;
+        }
+        QSize cellSize;
+        QImage atlas = renderFlagAtlas(curScale_, curDevicePixelRatio_, &cellSize);
+        if (atlas.isNull())
         {
-            // qCDebug(LOG_BASIC) << "Failed to load Icon: " << name;
-            // Q_ASSERT(false);
             return nullptr;
         }
+        addFlagAtlas(atlas, cellSize, curDevicePixelRatio_);
     }
+
+    auto it = hashIndependent_.find(name);
+    if (it == hashIndependent_.end())
+    {
+        it = hashIndependent_.find(NO_FLAG_NAME);
+    }
+    return it != hashIndependent_.end() ? it.value() : nullptr;
 }
 
-QSharedPointer<IndependentPixmap> ImageResourcesSvg::getFlag(const QString &flagName)
+void ImageResourcesSvg::prefetchScaledFlag(const QString &flagName, int width, int height, int flags)
 {
     QMutexLocker locker(&mutex_);
-    QSharedPointer<IndependentPixmap> ret = getIndependentPixmap("flags/" + flagName);
-    if (ret)
+    ScaledRequest request;
+    request.name = "flags/" + flagName;
+    request.width = width;
+    request.height = height;
+    request.flags = flags;
+    if (hashScaled_.contains(scaledName(request.name, width, height, flags)))
     {
-        return ret;
+        return;
+    }
+    if (isScaledPrefetchRunning_)
+    {
+        nextScaledPrefetch_ = request;
     }
     else
     {
-        return getIndependentPixmap("flags/noflag");
+        startScaledPrefetch(request);
     }
 }
 
@@ -121,78 +249,434 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getScaledFlag(const QString
 void ImageResourcesSvg::run()
 {
     BIND_CRASH_HANDLER_FOR_THREAD();
+    TraceSpan traceSpan("gui", "ImageResourcesSvg preload");
+    // the scale doesn't change while the thread runs, updateScaleAndStartPreloading() waits for it
+    {
+        // the renders of the scales which are not retained anymore are dropped from the disk too
+        QList<QPair<double, int> > scalesInUse;
+        {
+            QMutexLocker locker(&mutex_);
+            scalesInUse << qMakePair(curScale_, curDevicePixelRatio_);
+            for (const ScaleImages &scaleImages : qAsConst(retainedScales_))
+            {
+                scalesInUse << qMakePair(scaleImages.scale, scaleImages.devicePixelRatio);
+            }
+        }
+        rasterCache_.prune(scalesInUse);
+    }
+    preloadNames_ = preloadOrder();
+    nextPreloadInd_ = 0;
+    for (int i = 0; i < preloadPool_.maxThreadCount(); ++i)
+    {
+        preloadPool_.start(new PreloadTask([this]() { preloadNext(); }));
+    }
+    preloadPool_.waitForDone();
+
+    if (!bNeedFinish_)
+    {
+        bool isNeedFlagAtlas;
+        {
+            QMutexLocker locker(&mutex_);
+            isNeedFlagAtlas = !hasFlagAtlas();
+        }
+        if (isNeedFlagAtlas)
+        {
+            QSize cellSize;
+            QImage atlas = renderFlagAtlas(curScale_, curDevicePixelRatio_, &cellSize);
+            QMutexLocker locker(&mutex_);
+            if (!atlas.isNull() && !hasFlagAtlas())
+            {
+                addFlagAtlas(atlas, cellSize, curDevicePixelRatio_);
+            }
+        }
+        qCDebug(LOG_BASIC) << "ImageResourcesSvg::run() - all SVGs loaded";
+    }
+}
+
+QStringList ImageResourcesSvg::preloadOrder()
+{
+    // the images of the windows (the root and the subdirs), the flags go to the atlas
+    QStringList names;
     QDirIterator it(":/svg", QDirIterator::Subdirectories);
-    while (!bNeedFinish_ && it.hasNext())
+    while (it.hasNext())
     {
         it.next();
         if (it.fileInfo().isFile())
         {
-            QMutexLocker locker(&mutex_);
             QString name = it.fileInfo().filePath().mid(6, it.fileInfo().filePath().length() - 10);
-            loadFromResource(name);
+            if (!name.startsWith("flags/"))
+            {
+                names << name;
+            }
+        }
+    }
+    return names;
+}
+
+void ImageResourcesSvg::preloadNext()
+{
+    int ind;
+    while (!bNeedFinish_ && (ind = nextPreloadInd_++) < preloadNames_.count())
+    {
+        const QString &name = preloadNames_[ind];
+        {
+            QMutexLocker locker(&mutex_);
+            if (hashIndependent_.contains(name))
+            {
+                continue;
+            }
+        }
+
+        // rendered without the lock, so the GUI thread doesn't wait for the preloading
+        QSize defaultSize;
+        QImage image = renderFromResource(name, curScale_, curDevicePixelRatio_, &defaultSize);
+        if (!image.isNull())
+        {
+            QPixmap pixmap = QPixmap::fromImage(image);
+            pixmap.setDevicePixelRatio(curDevicePixelRatio_);
+            QMutexLocker locker(&mutex_);
+            if (defaultSize.isValid())
+            {
+                defaultSizes_[name] = defaultSize;
+            }
+            if (!hashIndependent_.contains(name))
+            {
+                hashIndependent_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
+                if (pendingRenders_.remove(name))
+                {
+                    scheduleImagesUpdated();
+                }
+            }
+        }
+    }
+}
+
+QImage ImageResourcesSvg::renderFromResource(const QString &name, double scale, int devicePixelRatio, QSize *defaultSize) const
+{
+    QFile file(":/svg/" + name + ".svg");
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QImage();
+    }
+    const QByteArray svg = file.readAll();
+    const QByteArray svgHash = QCryptographicHash::hash(svg, QCryptographicHash::Md5);
+
+    QImage image = rasterCache_.load(name, svgHash, scale, devicePixelRatio);
+    if (!image.isNull())
+    {
+        return image;
+    }
+
+    QSvgRenderer render(svg);
+    if (!render.isValid())
+    {
+        return QImage();
+    }
+    if (defaultSize)
+    {
+        *defaultSize = render.defaultSize();
+    }
+    image = QImage(render.defaultSize() * scale * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        render.render(&painter);
+    }
+    rasterCache_.save(name, svgHash, scale, devicePixelRatio, image);
+    return image;
+}
+
+QSharedPointer<IndependentPixmap> ImageResourcesSvg::createPlaceholder(const QString &name)
+{
+    QSharedPointer<IndependentPixmap> previous;
+    for (const ScaleImages &scaleImages : qAsConst(retainedScales_))
+    {
+        previous = scaleImages.images.value(name);
+        if (previous)
+        {
+            break;
         }
     }
-    qCDebug(LOG_BASIC) << "ImageResourcesSvg::run() - all SVGs loaded";
+    if (!previous)
+    {
+        return nullptr;
+    }
+
+    // the size must be exactly the one of the render, the windows are laid out by it
+    auto it = defaultSizes_.find(name);
+    if (it == defaultSizes_.end())
+    {
+        // parsed only, much cheaper than the rasterization
+        QSvgRenderer render(":/svg/" + name + ".svg");
+        if (!render.isValid())
+        {
+            return nullptr;
+        }
+        it = defaultSizes_.insert(name, render.defaultSize());
+    }
+    const QSize size = it.value() * curScale_ * curDevicePixelRatio_;
+    QPixmap pixmap = previous->getScaledPixmap(size.width(), size.height());
+    pixmap.setDevicePixelRatio(curDevicePixelRatio_);
+    return QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
 }
 
-bool ImageResourcesSvg::loadIconFromResource(const QString &name)
+void ImageResourcesSvg::renderInBackground(const QString &name)
 {
-    if (QFile::exists(name))
+    if (pendingRenders_.contains(name))
     {
-        QPixmap p = WidgetUtils::extractProgramIcon(name);
-        if (!p.isNull())
+        return;
+    }
+    pendingRenders_.insert(name);
+    const double scale = curScale_;
+    const int devicePixelRatio = curDevicePixelRatio_;
+    preloadPool_.start(new PreloadTask([this, name, scale, devicePixelRatio]() {
+        QSize defaultSize;
+        QImage image = renderFromResource(name, scale, devicePixelRatio, &defaultSize);
+        QMutexLocker locker(&mutex_);
+        pendingRenders_.remove(name);
+        if (defaultSize.isValid())
+        {
+            defaultSizes_[name] = defaultSize;
+        }
+        // dropped if the scale changed meanwhile
+        if (!image.isNull() && qFuzzyCompare(scale, curScale_) && devicePixelRatio == curDevicePixelRatio_ &&
+            !hashIndependent_.contains(name))
         {
-            iconHashes_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(p));
-            return true;
+            QPixmap pixmap = QPixmap::fromImage(image);
+            pixmap.setDevicePixelRatio(devicePixelRatio);
+            hashIndependent_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
+            scheduleImagesUpdated();
         }
+    }));
+}
+
+void ImageResourcesSvg::scheduleImagesUpdated()
+{
+    // one signal for the renders finished in a row
+    if (!isImagesUpdatedScheduled_.exchange(true))
+    {
+        QMetaObject::invokeMethod(this, [this]() {
+            isImagesUpdatedScheduled_ = false;
+            emit imagesUpdated();
+        }, Qt::QueuedConnection);
     }
+}
 
-    return false;
+QStringList ImageResourcesSvg::flagNames()
+{
+    // the position of a flag in the atlas is its index in this list
+    static const QStringList names = []() {
+        QStringList list;
+        for (const QFileInfo &fileInfo : QDir(":/svg/flags", "*.svg", QDir::Name, QDir::Files).entryInfoList())
+        {
+            list << fileInfo.completeBaseName();
+        }
+        return list;
+    }();
+    return names;
+}
+
+QImage ImageResourcesSvg::renderFlagAtlas(double scale, int devicePixelRatio, QSize *cellSize) const
+{
+    TraceSpan traceSpan("gui", "ImageResourcesSvg flag atlas");
+    const QStringList names = flagNames();
+    if (names.isEmpty())
+    {
+        return QImage();
+    }
+    const int rows = (names.count() + FLAG_ATLAS_COLUMNS - 1) / FLAG_ATLAS_COLUMNS;
+
+    QVector<QByteArray> svgs;
+    svgs.reserve(names.count());
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (const QString &name : names)
+    {
+        QFile file(":/svg/flags/" + name + ".svg");
+        svgs << (file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray());
+        hash.addData(name.toUtf8());
+        hash.addData(svgs.last());
+    }
+    const QByteArray svgsHash = hash.result();
+
+    QImage atlas = rasterCache_.load(FLAG_ATLAS_NAME, svgsHash, scale, devicePixelRatio);
+    if (!atlas.isNull())
+    {
+        *cellSize = QSize(atlas.width() / FLAG_ATLAS_COLUMNS, atlas.height() / rows);
+        return atlas;
+    }
+
+    std::vector<std::unique_ptr<QSvgRenderer> > renderers;
+    renderers.reserve(svgs.count());
+    QSize maxSize;
+    for (const QByteArray &svg : qAsConst(svgs))
+    {
+        renderers.emplace_back(new QSvgRenderer(svg));
+        if (renderers.back()->isValid())
+        {
+            maxSize = maxSize.expandedTo(renderers.back()->defaultSize() * scale * devicePixelRatio);
+        }
+    }
+    if (maxSize.isEmpty())
+    {
+        return QImage();
+    }
+
+    atlas = QImage(maxSize.width() * FLAG_ATLAS_COLUMNS, maxSize.height() * rows, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    {
+        QPainter painter(&atlas);
+        for (int i = 0; i < static_cast<int>(renderers.size()); ++i)
+        {
+            if (renderers[i]->isValid())
+            {
+                const QSize size = renderers[i]->defaultSize() * scale * devicePixelRatio;
+                renderers[i]->render(&painter, QRectF(QPointF(i % FLAG_ATLAS_COLUMNS * maxSize.width(), i / FLAG_ATLAS_COLUMNS * maxSize.height()), size));
+            }
+        }
+    }
+    rasterCache_.save(FLAG_ATLAS_NAME, svgsHash, scale, devicePixelRatio, atlas);
+    *cellSize = maxSize;
+    return atlas;
+}
+
+bool ImageResourcesSvg::hasFlagAtlas() const
+{
+    return hashIndependent_.contains(NO_FLAG_NAME);
+}
+
+void ImageResourcesSvg::addFlagAtlas(const QImage &atlas, const QSize &cellSize, int devicePixelRatio)
+{
+    // one pixmap for all the flags, drawn by parts
+    QPixmap pixmap = QPixmap::fromImage(atlas);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    const QStringList names = flagNames();
+    for (int i = 0; i < names.count(); ++i)
+    {
+        const QRect sourceRect(QPoint(i % FLAG_ATLAS_COLUMNS * cellSize.width(), i / FLAG_ATLAS_COLUMNS * cellSize.height()), cellSize);
+        hashIndependent_["flags/" + names[i]] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap, sourceRect));
+    }
+}
+
+void ImageResourcesSvg::loadFlagAtlasInBackground()
+{
+    if (pendingRenders_.contains(FLAG_ATLAS_NAME))
+    {
+        return;
+    }
+    pendingRenders_.insert(FLAG_ATLAS_NAME);
+    const double scale = curScale_;
+    const int devicePixelRatio = curDevicePixelRatio_;
+    preloadPool_.start(new PreloadTask([this, scale, devicePixelRatio]() {
+        QSize cellSize;
+        QImage atlas = renderFlagAtlas(scale, devicePixelRatio, &cellSize);
+        QMutexLocker locker(&mutex_);
+        pendingRenders_.remove(FLAG_ATLAS_NAME);
+        // dropped if the scale changed meanwhile
+        if (!atlas.isNull() && qFuzzyCompare(scale, curScale_) && devicePixelRatio == curDevicePixelRatio_ && !hasFlagAtlas())
+        {
+            addFlagAtlas(atlas, cellSize, devicePixelRatio);
+            scheduleImagesUpdated();
+        }
+    }));
+}
+
+void ImageResourcesSvg::loadIconInBackground(const QString &name)
+{
+    if (pendingIcons_.contains(name))
+    {
+        return;
+    }
+    pendingIcons_.insert(name);
+    // the size of the scale, in device pixels
+    const double scale = curScale_;
+    const int devicePixelRatio = curDevicePixelRatio_;
+    const int size = qRound(ICON_SIZE * scale) * devicePixelRatio;
+    iconPool_.start(new PreloadTask([this, name, scale, devicePixelRatio, size]() {
+        QImage image;
+        const QFileInfo fileInfo(name);
+        if (fileInfo.exists())
+        {
+            const QDateTime lastModified = fileInfo.lastModified();
+            image = iconCache_.load(name, lastModified, size, devicePixelRatio);
+            if (image.isNull())
+            {
+                image = WidgetUtils::extractProgramIcon(name, size);
+                if (!image.isNull())
+                {
+                    // the Windows icons are of the system size
+                    if (image.width() != size || image.height() != size)
+                    {
+                        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+                    }
+                    image.setDevicePixelRatio(devicePixelRatio);
+                }
+                iconCache_.save(name, lastModified, size, image);
+            }
+        }
+
+        // the pixmap is made in the GUI thread
+        QMetaObject::invokeMethod(this, [this, name, scale, devicePixelRatio, image]() {
+            QMutexLocker locker(&mutex_);
+            pendingIcons_.remove(name);
+            if (!qFuzzyCompare(scale, curScale_) || devicePixelRatio != curDevicePixelRatio_)
+            {
+                return;     // of the previous scale, requested again by the next paint
+            }
+            if (image.isNull())
+            {
+                failedIcons_.insert(name);
+            }
+            else
+            {
+                iconHashes_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(QPixmap::fromImage(image)));
+                scheduleImagesUpdated();
+            }
+        }, Qt::QueuedConnection);
+    }));
 }
 
 bool ImageResourcesSvg::loadFromResource(const QString &name)
 {
-    QSvgRenderer render(":/svg/" + name + ".svg");
-    if (!render.isValid())
+    QSize defaultSize;
+    QImage image = renderFromResource(name, curScale_, curDevicePixelRatio_, &defaultSize);
+    if (image.isNull())
     {
         return false;
     }
-    QPixmap pixmap(render.defaultSize() * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio());
-    pixmap.fill(Qt::transparent);
-    QPainter painter(&pixmap);
-    render.render(&painter);
-
-    pixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
+    if (defaultSize.isValid())
+    {
+        defaultSizes_[name] = defaultSize;
+    }
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(curDevicePixelRatio_);
     hashIndependent_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
     return true;
 }
 
-bool ImageResourcesSvg::loadFromResourceWithCustomSize(const QString &name, int width, int height,
-                                                       int flags)
+QImage ImageResourcesSvg::renderWithCustomSize(const QString &name, int width, int height, int flags, int devicePixelRatio)
 {
     QSvgRenderer render(":/svg/" + name + ".svg");
     if (!render.isValid())
     {
-        return false;
+        return QImage();
     }
-    const auto sizeScale = DpiScaleManager::instance().curDevicePixelRatio();
-    QSize realSize(width * sizeScale, height * sizeScale);
+    QSize realSize(width * devicePixelRatio, height * devicePixelRatio);
     if (flags & IMAGE_FLAG_SQUARE) {
         if (realSize.width() > realSize.height())
             realSize.setHeight(realSize.width());
         else
             realSize.setWidth(realSize.height());
     }
-    QPixmap pixmap(realSize);
-    pixmap.fill(Qt::transparent);
+    QImage image(realSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
     {
-        QRectF rc(0, 0, width * sizeScale, height * sizeScale);
+        QRectF rc(0, 0, width * devicePixelRatio, height * devicePixelRatio);
         rc.moveTo((realSize.width() - rc.width()) / 2, (realSize.height() - rc.height()) / 2);
-        QPainter painter(&pixmap);
+        QPainter painter(&image);
         render.render(&painter,rc);
     }
     if (flags & IMAGE_FLAG_GRAYED) {
-        auto image = pixmap.toImage();
+        image = image.convertToFormat(QImage::Format_ARGB32);
         for (int i = 0; i < image.height(); ++i) {
             auto *scanline = reinterpret_cast<QRgb*>(image.scanLine(i));
             for (int j = 0; j < image.width(); ++j) {
@@ -201,37 +685,96 @@ bool ImageResourcesSvg::loadFromResourceWithCustomSize(const QString &name, int
                 scanline[j] = QColor(gray, gray, gray, alpha).lighter(200).rgba();
             }
         }
-        pixmap = QPixmap::fromImage(image);
     }
+    return image;
+}
 
-    pixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
-
+QString ImageResourcesSvg::scaledName(const QString &name, int width, int height, int flags)
+{
     QString modifiedName = name + "_" + QString::number(width) + "_" + QString::number(height);
     if (flags) modifiedName += "_" + QString::number(flags);
-    hashIndependent_[modifiedName] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
-    return true;
+    return modifiedName;
+}
+
+QSharedPointer<IndependentPixmap> ImageResourcesSvg::addScaled(const QString &modifiedName, const QImage &image, int devicePixelRatio)
+{
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    QSharedPointer<IndependentPixmap> ret(new IndependentPixmap(pixmap));
+    hashScaled_[modifiedName] = ret;
+    scaledLru_.prepend(modifiedName);
+    scaledBytes_ += imageBytes(image.size());
+
+    // the backgrounds of the connect window are large, only the recent ones are kept
+    while (scaledBytes_ > MAX_SCALED_BYTES && scaledLru_.size() > 1)
+    {
+        QSharedPointer<IndependentPixmap> dropped = hashScaled_.take(scaledLru_.takeLast());
+        if (dropped)
+        {
+            scaledBytes_ -= imageBytes(dropped->originalPixmapSize());
+        }
+    }
+    return ret;
+}
+
+void ImageResourcesSvg::clearScaled()
+{
+    hashScaled_.clear();
+    scaledLru_.clear();
+    scaledBytes_ = 0;
+}
+
+void ImageResourcesSvg::startScaledPrefetch(const ScaledRequest &request)
+{
+    isScaledPrefetchRunning_ = true;
+    const int devicePixelRatio = curDevicePixelRatio_;
+    preloadPool_.start(new PreloadTask([this, request, devicePixelRatio]() {
+        QImage image = renderWithCustomSize(request.name, request.width, request.height, request.flags, devicePixelRatio);
+        QMutexLocker locker(&mutex_);
+        isScaledPrefetchRunning_ = false;
+        const QString modifiedName = scaledName(request.name, request.width, request.height, request.flags);
+        // dropped if the scale changed meanwhile
+        if (!image.isNull() && devicePixelRatio == curDevicePixelRatio_ && !hashScaled_.contains(modifiedName))
+        {
+            addScaled(modifiedName, image, devicePixelRatio);
+        }
+
+        // only the latest request made meanwhile, the ones before were passed over
+        if (!nextScaledPrefetch_.name.isEmpty() && !bNeedFinish_)
+        {
+            const ScaledRequest next = nextScaledPrefetch_;
+            nextScaledPrefetch_ = ScaledRequest();
+            if (!hashScaled_.contains(scaledName(next.name, next.width, next.height, next.flags)))
+            {
+                startScaledPrefetch(next);
+            }
+        }
+    }));
 }
 
 QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIndependentPixmapScaled(const QString &name, int width,
                                                                  int height, int flags)
 {
-    QString modifiedName = name + "_" + QString::number(width) + "_" + QString::number(height);
-    if (flags) modifiedName += "_" + QString::number(flags);
-    auto it = hashIndependent_.find(modifiedName);
-    if (it != hashIndependent_.end())
+    const QString modifiedName = scaledName(name, width, height, flags);
+    auto it = hashScaled_.find(modifiedName);
+    if (it != hashScaled_.end())
     {
+        if (scaledLru_.first() != modifiedName)
+        {
+            scaledLru_.removeOne(modifiedName);
+            scaledLru_.prepend(modifiedName);
+        }
         return it.value();
     }
     else
     {
-        if (loadFromResourceWithCustomSize(name, width, height, flags))
-        {
-            return hashIndependent_.find(modifiedName).value();
-        }
-        else
+        const int devicePixelRatio = DpiScaleManager::instance().curDevicePixelRatio();
+        QImage image = renderWithCustomSize(name, width, height, flags, devicePixelRatio);
+        if (image.isNull())
         {
             //Q_ASSERT(false);
             return nullptr;
         }
+        return addScaled(modifiedName, image, devicePixelRatio);
     }
 }
@@ -4,8 +4,22 @@
 #include <QThread>
 #include <QPixmap>
 #include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
 #include "independentpixmap.h"
+#include "svgrastercache.h"
+#include "programiconcache.h"
 
+// The SVGs rasterized for the current scale. run() preloads all of them on the pool threads, then the flags;
+// a missing image is rendered on request. The flags are rendered into one atlas per scale, the flag pixmaps are
+// parts of it. The renders are kept in SvgRasterCache for the next start.
+// The images of the last MAX_RETAINED_SCALES scales are kept in memory, so moving the window between two monitors
+// doesn't render them again. After a scale change, an image which is not rendered yet for the new scale but exists
+// for a previous one is returned stretched (a placeholder of the right size) and rendered on the pool,
+// imagesUpdated() is emitted when such renders are done.
+// The program icons are extracted on the icon pool (through ProgramIconCache), null is returned until then.
 class ImageResourcesSvg : public QThread
 {
     Q_OBJECT
@@ -23,7 +37,9 @@ public:
         return ir;
     }
 
-    void clearHashAndStartPreloading();
+    void updateScaleAndStartPreloading();
+    // stops the preloading and drops the rasterized images, the next requests render them again (from SvgRasterCache)
+    void releaseMemory();
     void finishGracefully();
 
     QSharedPointer<IndependentPixmap> getIndependentPixmap(const QString &name);
@@ -31,24 +47,90 @@ public:
 
     QSharedPointer<IndependentPixmap> getFlag(const QString &flagName);
     QSharedPointer<IndependentPixmap> getScaledFlag(const QString &flagName, int width, int height, int flags = 0);
+    // renders the flag for a later getScaledFlag() on the pool, a request made while one is rendered replaces
+    // the previous pending one
+    void prefetchScaledFlag(const QString &flagName, int width, int height, int flags = 0);
+
+signals:
+    void imagesUpdated();
 
 protected:
     void run() override;
 
 private:
+    static constexpr int MAX_RETAINED_SCALES = 3;
+    static constexpr int FLAG_ATLAS_COLUMNS = 10;
+    static constexpr qint64 MAX_SCALED_BYTES = 32 * 1024 * 1024;
+    static constexpr int ICON_SIZE = 18;    // of the program icons, before the scale
+
+    struct ScaleImages
+    {
+        double scale;
+        int devicePixelRatio;
+        QHash<QString, QSharedPointer<IndependentPixmap> > images;
+    };
+
     ImageResourcesSvg();
     virtual ~ImageResourcesSvg();
 
     QHash<QString, QSharedPointer<IndependentPixmap> > iconHashes_;
-    QHash<QString, QSharedPointer<IndependentPixmap> > hashIndependent_;
+    QSet<QString> pendingIcons_;
+    QSet<QString> failedIcons_;    // not retried on each paint
+    QHash<QString, QSharedPointer<IndependentPixmap> > hashIndependent_;     // of the current scale
+    QList<ScaleImages> retainedScales_;     // the previous scales, the most recent first
+    // the custom sizes of the current scale, the least recently used are dropped over MAX_SCALED_BYTES
+    QHash<QString, QSharedPointer<IndependentPixmap> > hashScaled_;
+    QList<QString> scaledLru_;     // the most recent first
+    qint64 scaledBytes_;
+    double curScale_;
+    int curDevicePixelRatio_;
+    QHash<QString, QSize> defaultSizes_;    // of the SVGs, don't depend on the scale
+    QSet<QString> pendingRenders_;
+    std::atomic<bool> isImagesUpdatedScheduled_;
     std::atomic<bool> bNeedFinish_;
     bool bFininishedGracefully_;
     QMutex mutex_;
 
+    struct ScaledRequest
+    {
+        QString name;
+        int width = 0;
+        int height = 0;
+        int flags = 0;
+    };
+    bool isScaledPrefetchRunning_;
+    ScaledRequest nextScaledPrefetch_;
+
+    SvgRasterCache rasterCache_;
+    QThreadPool preloadPool_;
+    QStringList preloadNames_;
+    ProgramIconCache iconCache_;
+    QThreadPool iconPool_;
+    std::atomic<int> nextPreloadInd_;
+
+    static QStringList preloadOrder();
+    void preloadNext();
+    // thread-safe, without the mutex
+    QImage renderFromResource(const QString &name, double scale, int devicePixelRatio, QSize *defaultSize) const;
+    QSharedPointer<IndependentPixmap> createPlaceholder(const QString &name);
+    void renderInBackground(const QString &name);
+    void scheduleImagesUpdated();
+
+    static QStringList flagNames();
+    // thread-safe, without the mutex; the cells are the size of the largest flag
+    QImage renderFlagAtlas(double scale, int devicePixelRatio, QSize *cellSize) const;
+    bool hasFlagAtlas() const;
+    void addFlagAtlas(const QImage &atlas, const QSize &cellSize, int devicePixelRatio);
+    void loadFlagAtlasInBackground();
 
-    bool loadIconFromResource(const QString &name);
+    void loadIconInBackground(const QString &name);
     bool loadFromResource(const QString &name);
-    bool loadFromResourceWithCustomSize(const QString &name, int width, int height, int flags);
+    // thread-safe, without the mutex
+    static QImage renderWithCustomSize(const QString &name, int width, int height, int flags, int devicePixelRatio);
+    static QString scaledName(const QString &name, int width, int height, int flags);
+    QSharedPointer<IndependentPixmap> addScaled(const QString &modifiedName, const QImage &image, int devicePixelRatio);
+    void clearScaled();
+    void startScaledPrefetch(const ScaledRequest &request);
     QSharedPointer<IndependentPixmap> getIndependentPixmapScaled(const QString &name, int width, int height, int flags);
     void clearHash();
 };
@@ -2,7 +2,11 @@
 #include <QIcon>
 #include <QPixmap>
 
-IndependentPixmap::IndependentPixmap(const QPixmap &pixmap): pixmap_(pixmap)
+IndependentPixmap::IndependentPixmap(const QPixmap &pixmap): pixmap_(pixmap), sourceRect_(pixmap.rect())
+{
+}
+
+IndependentPixmap::IndependentPixmap(const QPixmap &pixmap, const QRect &sourceRect): pixmap_(pixmap), sourceRect_(sourceRect)
 {
 }
 
@@ -12,57 +16,68 @@ IndependentPixmap::~IndependentPixmap()
 
 QSize IndependentPixmap::originalPixmapSize() const
 {
-    return pixmap_.size();
+    return sourceRect_.size();
 }
 
 int IndependentPixmap::width() const
 {
-    return pixmap_.width() / pixmap_.devicePixelRatio();
+    return sourceRect_.width() / pixmap_.devicePixelRatio();
 }
 
 int IndependentPixmap::height() const
 {
-    return pixmap_.height() / pixmap_.devicePixelRatio();
+    return sourceRect_.height() / pixmap_.devicePixelRatio();
 }
 
 void IndependentPixmap::draw(int x, int y, QPainter *painter)
 {
-    painter->drawPixmap(x, y, pixmap_);
+    painter->drawPixmap(QPointF(x, y), pixmap_, sourceRect_);
 }
 
 void IndependentPixmap::draw(int x, int y, int w, int h, QPainter *painter)
 {
-    painter->drawPixmap(x, y, w, h, pixmap_);
+    painter->drawPixmap(QRectF(x, y, w, h), pixmap_, sourceRect_);
 }
 
 void IndependentPixmap::draw(int x, int y, QPainter *painter, int x1, int y1, int w, int h)
 {
-    painter->drawPixmap(x, y, pixmap_, x1*pixmap_.devicePixelRatio(), y1*pixmap_.devicePixelRatio(), w*pixmap_.devicePixelRatio(), h*pixmap_.devicePixelRatio());
+    painter->drawPixmap(x, y, pixmap_, sourceRect_.x() + x1*pixmap_.devicePixelRatio(), sourceRect_.y() + y1*pixmap_.devicePixelRatio(),
+                        w*pixmap_.devicePixelRatio(), h*pixmap_.devicePixelRatio());
 }
 
 void IndependentPixmap::draw(const QRect &rect, QPainter *painter)
 {
-    painter->drawPixmap(rect, pixmap_);
+    painter->drawPixmap(QRectF(rect), pixmap_, sourceRect_);
 }
 
 QIcon IndependentPixmap::getIcon() const
 {
-    return QIcon(pixmap_);
+    return QIcon(subPixmap());
 }
 
 QIcon IndependentPixmap::getScaledIcon() const
 {
-    QIcon icon(pixmap_.scaled(20,20,Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    QIcon icon(subPixmap().scaled(20,20,Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
     return icon;
 }
 
 QPixmap IndependentPixmap::getScaledPixmap(int width, int height) const
 {
-    QPixmap pm(pixmap_.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    QPixmap pm(subPixmap().scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
     return pm;
 }
 
 QBitmap IndependentPixmap::mask() const
 {
-    return pixmap_.mask();
+    return subPixmap().mask();
+}
+
+QPixmap IndependentPixmap::subPixmap() const
+{
+    // the copy is only made for the parts of an atlas
+    if (sourceRect_ == pixmap_.rect())
+    {
+        return pixmap_;
+    }
+    return pixmap_.copy(sourceRect_);
 }
@@ -13,6 +13,8 @@ class IndependentPixmap
 {
 public:
     explicit IndependentPixmap(const QPixmap &pixmap);
+    // a part of a shared pixmap (an atlas), sourceRect is in the pixels of the pixmap
+    IndependentPixmap(const QPixmap &pixmap, const QRect &sourceRect);
     virtual ~IndependentPixmap();
 
     QSize originalPixmapSize() const;
@@ -33,6 +35,9 @@ public:
 
 private:
     QPixmap pixmap_;
+    QRect sourceRect_;
+
+    QPixmap subPixmap() const;
 };
 
 #endif // INDEPENDENTPIXMAP_H
@@ -0,0 +1,78 @@
+#include "programiconcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const int VERSION = 2;
+const char *MTIME_KEY = "mtime";
+const char *DPR_KEY = "dpr";     // not kept by PNG itself, the Mac icons are rendered for the screen
+
+} // namespace
+
+ProgramIconCache::ProgramIconCache()
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheLocation.isEmpty())
+    {
+        dir_ = cacheLocation + "/icons/v" + QString::number(VERSION);
+        if (!QDir().mkpath(dir_))
+        {
+            dir_.clear();
+        }
+    }
+}
+
+QImage ProgramIconCache::load(const QString &exePath, const QDateTime &lastModified, int size, qreal devicePixelRatio) const
+{
+    if (dir_.isEmpty())
+    {
+        return QImage();
+    }
+
+    // the text is read from the header, the pixels only if the executable is the same
+    QImageReader reader(filePath(exePath, size, devicePixelRatio), "png");
+    if (reader.text(MTIME_KEY) != QString::number(lastModified.toMSecsSinceEpoch()) ||
+        !qFuzzyCompare(reader.text(DPR_KEY).toDouble(), devicePixelRatio))
+    {
+        return QImage();
+    }
+    QImage image = reader.read();
+    if (!image.isNull())
+    {
+        image.setDevicePixelRatio(devicePixelRatio);
+    }
+    return image;
+}
+
+void ProgramIconCache::save(const QString &exePath, const QDateTime &lastModified, int size, const QImage &image) const
+{
+    if (dir_.isEmpty() || image.isNull())
+    {
+        return;
+    }
+
+    // written to a temporary file and renamed, the other threads never read a partial file
+    QSaveFile file(filePath(exePath, size, image.devicePixelRatio()));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    QImage imageWithTime = image;
+    imageWithTime.setText(MTIME_KEY, QString::number(lastModified.toMSecsSinceEpoch()));
+    imageWithTime.setText(DPR_KEY, QString::number(image.devicePixelRatio()));
+    if (imageWithTime.save(&file, "png"))
+    {
+        file.commit();
+    }
+}
+
+QString ProgramIconCache::filePath(const QString &exePath, int size, qreal devicePixelRatio) const
+{
+    const QString key = exePath + "|" + QString::number(size) + "@" + QString::number(devicePixelRatio);
+    return dir_ + "/" + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex() + ".png";
+}
@@ -0,0 +1,27 @@
+#ifndef PROGRAMICONCACHE_H
+#define PROGRAMICONCACHE_H
+
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+
+// The icons extracted from the executables of the split tunneling apps, on disk. A PNG per executable path and size
+// (in device pixels) and device pixel ratio keeps the modification time of the executable it was extracted from,
+// a changed executable or another device pixel ratio is a miss.
+// Stateless apart from the directory, safe to use from several threads.
+class ProgramIconCache
+{
+public:
+    ProgramIconCache();
+
+    QImage load(const QString &exePath, const QDateTime &lastModified, int size, qreal devicePixelRatio) const;
+    // the image has the device pixel ratio it was requested for
+    void save(const QString &exePath, const QDateTime &lastModified, int size, const QImage &image) const;
+
+private:
+    QString dir_;
+
+    QString filePath(const QString &exePath, int size, qreal devicePixelRatio) const;
+};
+
+#endif // PROGRAMICONCACHE_H
@@ -0,0 +1,137 @@
+#include "svgrastercache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const quint32 MAGIC = 0x57535643;   // "WSVC"
+const quint32 VERSION = 2;
+const int MD5_SIZE = 16;
+// magic, version, width, height, bytes per line, MD5 of the SVG
+const int HEADER_SIZE = 5 * sizeof(quint32) + MD5_SIZE;
+
+} // namespace
+
+SvgRasterCache::SvgRasterCache()
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheLocation.isEmpty())
+    {
+        rootDir_ = cacheLocation + "/svg";
+        dir_ = rootDir_ + "/v" + QString::number(VERSION);
+        if (!QDir().mkpath(dir_))
+        {
+            dir_.clear();
+        }
+    }
+}
+
+QImage SvgRasterCache::load(const QString &name, const QByteArray &svgHash, double scale, int devicePixelRatio) const
+{
+    if (dir_.isEmpty())
+    {
+        return QImage();
+    }
+
+    QFile file(filePath(name, scale, devicePixelRatio));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE)
+    {
+        return QImage();
+    }
+    const uchar *data = file.map(0, file.size());
+    if (!data)
+    {
+        return QImage();
+    }
+
+    QImage image;
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char *>(data), HEADER_SIZE));
+    quint32 magic, version, width, height, bytesPerLine;
+    stream >> magic >> version >> width >> height >> bytesPerLine;
+    const QByteArray fileSvgHash = QByteArray::fromRawData(reinterpret_cast<const char *>(data) + HEADER_SIZE - MD5_SIZE, MD5_SIZE);
+    if (magic == MAGIC && version == VERSION && fileSvgHash == svgHash &&
+        static_cast<qint64>(bytesPerLine) * height == file.size() - HEADER_SIZE)
+    {
+        // copied, the mapping is released with the file
+        image = QImage(data + HEADER_SIZE, width, height, bytesPerLine, QImage::Format_ARGB32_Premultiplied).copy();
+    }
+    file.unmap(const_cast<uchar *>(data));
+    return image;
+}
+
+void SvgRasterCache::save(const QString &name, const QByteArray &svgHash, double scale, int devicePixelRatio, const QImage &image) const
+{
+    if (dir_.isEmpty() || image.isNull() || svgHash.size() != MD5_SIZE)
+    {
+        return;
+    }
+    Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+    if (!QDir().mkpath(dir_ + "/" + scaleDirName(scale, devicePixelRatio)))
+    {
+        return;
+    }
+    // written to a temporary file and renamed, the other threads and instances never map a partial file
+    QSaveFile file(filePath(name, scale, devicePixelRatio));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    {
+        QDataStream stream(&file);
+        stream << MAGIC << VERSION << static_cast<quint32>(image.width()) << static_cast<quint32>(image.height())
+               << static_cast<quint32>(image.bytesPerLine());
+    }
+    file.write(svgHash);
+    file.write(reinterpret_cast<const char *>(image.constBits()), static_cast<qint64>(image.bytesPerLine()) * image.height());
+    file.commit();
+}
+
+void SvgRasterCache::prune(const QList<QPair<double, int> > &scalesInUse) const
+{
+    if (dir_.isEmpty())
+    {
+        return;
+    }
+
+    const QString versionDirName = QFileInfo(dir_).fileName();
+    const QStringList versionDirs = QDir(rootDir_).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &name : versionDirs)
+    {
+        if (name != versionDirName)
+        {
+            QDir(rootDir_ + "/" + name).removeRecursively();
+        }
+    }
+
+    QStringList keep;
+    for (const auto &scale : scalesInUse)
+    {
+        keep << scaleDirName(scale.first, scale.second);
+    }
+    const QStringList scaleDirs = QDir(dir_).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &name : scaleDirs)
+    {
+        if (!keep.contains(name))
+        {
+            QDir(dir_ + "/" + name).removeRecursively();
+        }
+    }
+}
+
+QString SvgRasterCache::scaleDirName(double scale, int devicePixelRatio)
+{
+    return QString::number(scale, 'f', 2) + "_" + QString::number(devicePixelRatio);
+}
+
+QString SvgRasterCache::filePath(const QString &name, double scale, int devicePixelRatio) const
+{
+    return dir_ + "/" + scaleDirName(scale, devicePixelRatio) + "/" +
+           QString::fromLatin1(QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Md5).toHex());
+}
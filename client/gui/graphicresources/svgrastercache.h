@@ -0,0 +1,33 @@
+#ifndef SVGRASTERCACHE_H
+#define SVGRASTERCACHE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// The rasterized SVGs on disk, so the next start with the same scale doesn't render them again.
+// A file per (name, scale, device pixel ratio) keeps the MD5 of the SVG it was rendered from and the raw
+// premultiplied pixels, it's mapped on load. A changed SVG or another cache version is a miss.
+// The files of a scale are in their own directory, prune() removes the scales which are not used anymore.
+// Stateless apart from the directory, safe to use from several threads.
+class SvgRasterCache
+{
+public:
+    SvgRasterCache();
+
+    QImage load(const QString &name, const QByteArray &svgHash, double scale, int devicePixelRatio) const;
+    void save(const QString &name, const QByteArray &svgHash, double scale, int devicePixelRatio, const QImage &image) const;
+    // removes the files of the other scales (scale, device pixel ratio) and of the previous cache versions
+    void prune(const QList<QPair<double, int> > &scalesInUse) const;
+
+private:
+    QString rootDir_;
+    QString dir_;       // of the current version
+
+    static QString scaleDirName(double scale, int devicePixelRatio);
+    QString filePath(const QString &name, double scale, int devicePixelRatio) const;
+};
+
+#endif // SVGRASTERCACHE_H
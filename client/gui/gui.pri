@@ -66,6 +66,9 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/backend/locationsmodel/favoritecitiesmodel.cpp \
     $$PWD/backend/locationsmodel/favoritelocationsstorage.cpp \
     $$PWD/backend/locationsmodel/locationsmodel.cpp \
+    $$PWD/backend/locationsmodel/locationsmodeldiff.cpp \
+    $$PWD/backend/locationsmodel/locationssearchindex.cpp \
+    $$PWD/backend/locationsmodel/locationssnapshotcache.cpp \
     $$PWD/backend/locationsmodel/sortlocationsalgorithms.cpp \
     $$PWD/backend/locationsmodel/staticipscitiesmodel.cpp \
     $$PWD/backend/preferences/accountinfo.cpp \
@@ -111,7 +114,9 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/locationswindow/widgetlocations/widgetcitieslist.cpp \
     $$PWD/locationswindow/widgetlocations/widgetlocations.cpp \
     $$PWD/locationswindow/widgetlocations/widgetlocationslist.cpp \
+    $$PWD/idlemodecontroller.cpp \
     $$PWD/mainwindowstate.cpp \
+    $$PWD/memorypressurecontroller.cpp \
     $$PWD/preferenceswindow/connectionwindow/packetsizeeditboxitem.cpp \
     $$PWD/overlaysconnectwindow//upgradewindowitem.cpp \
     $$PWD/overlaysconnectwindow/updatewindowitem.cpp \
@@ -161,6 +166,7 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/dpiscalemanager.cpp \
     $$PWD/freetrafficnotificationcontroller.cpp \
     $$PWD/guitest.cpp \
+    $$PWD/locationsbenchmark.cpp \
     $$PWD/systemtray/locationstraymenubutton.cpp \
     $$PWD/systemtray/locationstraymenuitemdelegate.cpp \
     $$PWD/systemtray/locationstraymenuwidget.cpp \
@@ -180,6 +186,8 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/graphicresources/fontmanager.cpp \
     $$PWD/graphicresources/imageresourcessvg.cpp \
     $$PWD/graphicresources/imageresourcesjpg.cpp \
+    $$PWD/graphicresources/svgrastercache.cpp \
+    $$PWD/graphicresources/programiconcache.cpp \
     $$PWD/emergencyconnectwindow/emergencyconnectwindowitem.cpp \
     $$PWD/emergencyconnectwindow/textlinkbutton.cpp \
     $$PWD/commongraphics/commongraphics.cpp \
@@ -224,6 +232,7 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/preferenceswindow/sharewindow/proxygatewayitem.cpp \
     $$PWD/preferenceswindow/editboxitem.cpp \
     $$PWD/preferenceswindow/sharewindow/proxyipaddressitem.cpp \
+    $$PWD/preferenceswindow/sharewindow/proxytoptalkersitem.cpp \
     $$PWD/preferenceswindow/debugwindow/viewlogitem.cpp \
     $$PWD/preferenceswindow/debugwindow/advancedparametersitem.cpp \
     $$PWD/preferenceswindow/connectionwindow/firewallmodeitem.cpp \
@@ -283,6 +292,9 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/backend/locationsmodel/favoritelocationsstorage.h \
     $$PWD/backend/locationsmodel/locationmodelitem.h \
     $$PWD/backend/locationsmodel/locationsmodel.h \
+    $$PWD/backend/locationsmodel/locationsmodeldiff.h \
+    $$PWD/backend/locationsmodel/locationssearchindex.h \
+    $$PWD/backend/locationsmodel/locationssnapshotcache.h \
     $$PWD/backend/locationsmodel/sortlocationsalgorithms.h \
     $$PWD/backend/locationsmodel/staticipscitiesmodel.h \
     $$PWD/backend/preferences/accountinfo.h \
@@ -325,7 +337,9 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/locationswindow/widgetlocations/widgetcitieslist.h \
     $$PWD/locationswindow/widgetlocations/widgetlocations.h \
     $$PWD/locationswindow/widgetlocations/widgetlocationslist.h \
+    $$PWD/idlemodecontroller.h \
     $$PWD/mainwindowstate.h \
+    $$PWD/memorypressurecontroller.h \
     $$PWD/overlaysconnectwindow/generalmessagetwobuttonwindowitem.h \
     $$PWD/overlaysconnectwindow/igeneralmessagetwobuttonwindow.h \
     $$PWD/overlaysconnectwindow/generalmessagewindowitem.h \
@@ -389,6 +403,7 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/dpiscalemanager.h \
     $$PWD/freetrafficnotificationcontroller.h \
     $$PWD/guitest.h \
+    $$PWD/locationsbenchmark.h \
     $$PWD/systemtray/locationstraymenubutton.h \
     $$PWD/systemtray/locationstraymenuitemdelegate.h \
     $$PWD/systemtray/locationstraymenuwidget.h \
@@ -399,6 +414,8 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/graphicresources/fontmanager.h \
     $$PWD/graphicresources/imageresourcessvg.h \
     $$PWD/graphicresources/imageresourcesjpg.h \
+    $$PWD/graphicresources/svgrastercache.h \
+    $$PWD/graphicresources/programiconcache.h \
     $$PWD/loginwindow/logginginwindowitem.h \
     $$PWD/connectwindow/connectwindowitem.h \
     $$PWD/locationswindow/locationswindow.h \
@@ -462,6 +479,7 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/preferenceswindow/sharewindow/proxygatewayitem.h \
     $$PWD/preferenceswindow/editboxitem.h \
     $$PWD/preferenceswindow/sharewindow/proxyipaddressitem.h \
+    $$PWD/preferenceswindow/sharewindow/proxytoptalkersitem.h \
     $$PWD/preferenceswindow/debugwindow/viewlogitem.h \
     $$PWD/preferenceswindow/debugwindow/advancedparametersitem.h \
     $$PWD/preferenceswindow/connectionwindow/firewallmodeitem.h \
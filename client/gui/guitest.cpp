@@ -201,19 +201,36 @@ GuiTest::GuiTest(QWidget *parent) : QObject(parent),
 void GuiTest::addCommand(Qt::Key qtKey)
 {
     TEvent e;
-    e.isKey = true;
+    e.type = EVENT_COMMAND;
     e.key = qtKey;
     events_.enqueue(e);
 }
 
+void GuiTest::addKey(Qt::Key qtKey, const QString &text)
+{
+    TEvent e;
+    e.type = EVENT_KEY;
+    e.key = qtKey;
+    e.text = text;
+    events_.enqueue(e);
+}
+
 void GuiTest::addDelay(int ms)
 {
     TEvent e;
-    e.isKey = false;
+    e.type = EVENT_DELAY;
     e.timeoutMs = ms;
     events_.enqueue(e);
 }
 
+void GuiTest::addCallback(std::function<void()> callback)
+{
+    TEvent e;
+    e.type = EVENT_CALLBACK;
+    e.callback = callback;
+    events_.enqueue(e);
+}
+
 void GuiTest::start()
 {
     handleNext();
@@ -539,17 +556,34 @@ void GuiTest::handleNext()
     if (!events_.isEmpty())
     {
         TEvent e = events_.dequeue();
-        if (e.isKey)
+        if (e.type == EVENT_COMMAND)
         {
             QKeyEvent event(QEvent::KeyPress, e.key, Qt::ControlModifier);
             QApplication::sendEvent(mainWindow_, &event);
             handleNext();
         }
+        else if (e.type == EVENT_KEY)
+        {
+            QKeyEvent pressEvent(QEvent::KeyPress, e.key, Qt::NoModifier, e.text);
+            QApplication::sendEvent(mainWindow_, &pressEvent);
+            QKeyEvent releaseEvent(QEvent::KeyRelease, e.key, Qt::NoModifier, e.text);
+            QApplication::sendEvent(mainWindow_, &releaseEvent);
+            handleNext();
+        }
+        else if (e.type == EVENT_CALLBACK)
+        {
+            e.callback();
+            handleNext();
+        }
         else
         {
             QTimer::singleShot(e.timeoutMs, this, SLOT(handleNext()));
         }
     }
+    else
+    {
+        emit finished();
+    }
 }
 
 QVector<GuiTest::CMD_ID> GuiTest::getTransitions(const GuiTest::TCurState &s)
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QQueue>
 #include <QMap>
+#include <functional>
 
 class GuiTest : public QObject
 {
@@ -12,7 +13,10 @@ public:
     explicit GuiTest(QWidget *parent);
 
     void addCommand(Qt::Key qtKey);
+    // press and release of the key without modifiers, as typed by the user
+    void addKey(Qt::Key qtKey, const QString &text = QString());
     void addDelay(int ms);
+    void addCallback(std::function<void()> callback);
 
     void start();
 
@@ -65,17 +69,24 @@ public:
         }
     };
 
+signals:
+    void finished();
+
 private slots:
     void handleNext();
 
 private:
     QWidget *mainWindow_;
 
+    enum EVENT_TYPE { EVENT_COMMAND, EVENT_KEY, EVENT_DELAY, EVENT_CALLBACK };
+
     struct TEvent
     {
-        bool isKey;
+        EVENT_TYPE type;
         Qt::Key key;
+        QString text;
         int timeoutMs;
+        std::function<void()> callback;
     };
 
     QQueue<TEvent> events_;
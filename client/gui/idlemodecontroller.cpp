@@ -0,0 +1,177 @@
+#include "idlemodecontroller.h"
+
+#include <QAbstractEventDispatcher>
+#include <QTimerEvent>
+#include "mainwindowstate.h"
+#include "utils/logger.h"
+
+bool IdleModeController::isIdle() const
+{
+    return isIdle_;
+}
+
+void IdleModeController::addAnimationTimer(QTimer *timer)
+{
+    Q_ASSERT(timer);
+    timers_.insert(timer);
+    // the timer events are filtered to catch the timers started in the idle mode
+    timer->installEventFilter(this);
+    connect(timer, SIGNAL(destroyed(QObject*)), SLOT(onObjectDestroyed(QObject*)), Qt::UniqueConnection);
+    if (isIdle_ && timer->isActive())
+    {
+        suspendTimer(timer);
+    }
+}
+
+void IdleModeController::addAnimation(QAbstractAnimation *animation)
+{
+    Q_ASSERT(animation);
+    animations_.insert(animation);
+    connect(animation, SIGNAL(stateChanged(QAbstractAnimation::State, QAbstractAnimation::State)),
+            SLOT(onAnimationStateChanged(QAbstractAnimation::State, QAbstractAnimation::State)), Qt::UniqueConnection);
+    connect(animation, SIGNAL(destroyed(QObject*)), SLOT(onObjectDestroyed(QObject*)), Qt::UniqueConnection);
+    if (isIdle_ && animation->state() == QAbstractAnimation::Running)
+    {
+        suspendAnimation(animation);
+    }
+}
+
+int IdleModeController::wakeupsPerMinute() const
+{
+    return wakeupsPerMinute_;
+}
+
+bool IdleModeController::eventFilter(QObject *watched, QEvent *event)
+{
+    if (isIdle_ && event->type() == QEvent::Timer)
+    {
+        QTimer *timer = static_cast<QTimer *>(watched);
+        if (timers_.contains(timer) && static_cast<QTimerEvent *>(event)->timerId() == timer->timerId())
+        {
+            suspendTimer(timer);
+            return true;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void IdleModeController::onMainWindowIsActiveChanged(bool isActive)
+{
+    if (isIdle_ == !isActive)
+    {
+        return;
+    }
+    isIdle_ = !isActive;
+    qCDebug(LOG_BASIC) << "Idle mode:" << isIdle_;
+
+    if (isIdle_)
+    {
+        for (QTimer *timer : qAsConst(timers_))
+        {
+            if (timer->isActive())
+            {
+                suspendTimer(timer);
+            }
+        }
+        for (QAbstractAnimation *animation : qAsConst(animations_))
+        {
+            if (animation->state() == QAbstractAnimation::Running)
+            {
+                suspendAnimation(animation);
+            }
+        }
+    }
+    else
+    {
+        // only the ones stopped by the idle mode, a timer the owner has started again keeps its own interval
+        const QSet<QTimer *> timers = suspendedTimers_;
+        suspendedTimers_.clear();
+        for (QTimer *timer : timers)
+        {
+            if (!timer->isActive())
+            {
+                timer->start();
+            }
+        }
+        const QSet<QAbstractAnimation *> animations = suspendedAnimations_;
+        suspendedAnimations_.clear();
+        for (QAbstractAnimation *animation : animations)
+        {
+            if (animation->state() == QAbstractAnimation::Paused)
+            {
+                animation->resume();
+            }
+        }
+    }
+}
+
+void IdleModeController::onAnimationStateChanged(QAbstractAnimation::State newState, QAbstractAnimation::State oldState)
+{
+    Q_UNUSED(oldState);
+    QAbstractAnimation *animation = static_cast<QAbstractAnimation *>(sender());
+    if (newState == QAbstractAnimation::Stopped)
+    {
+        // stopped by its owner, not resumed
+        suspendedAnimations_.remove(animation);
+    }
+    else if (isIdle_ && newState == QAbstractAnimation::Running)
+    {
+        // not paused inside of the state change of the animation
+        QMetaObject::invokeMethod(this, [this, animation]() {
+            if (isIdle_ && animations_.contains(animation) && animation->state() == QAbstractAnimation::Running)
+            {
+                suspendAnimation(animation);
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void IdleModeController::onObjectDestroyed(QObject *obj)
+{
+    // only the pointers are compared, the object is already destroyed
+    timers_.remove(static_cast<QTimer *>(obj));
+    suspendedTimers_.remove(static_cast<QTimer *>(obj));
+    animations_.remove(static_cast<QAbstractAnimation *>(obj));
+    suspendedAnimations_.remove(static_cast<QAbstractAnimation *>(obj));
+}
+
+void IdleModeController::onEventDispatcherAwake()
+{
+    wakeups_++;
+}
+
+void IdleModeController::onMinuteTimer()
+{
+    wakeupsPerMinute_ = wakeups_;
+    wakeups_ = 0;
+    emit wakeupsPerMinuteChanged(wakeupsPerMinute_);
+}
+
+IdleModeController::IdleModeController() : isIdle_(!MainWindowState::instance().isActive()),
+    wakeups_(0), wakeupsPerMinute_(0)
+{
+    connect(&MainWindowState::instance(), SIGNAL(isActiveChanged(bool)), SLOT(onMainWindowIsActiveChanged(bool)));
+
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    if (dispatcher)
+    {
+        connect(dispatcher, SIGNAL(awake()), SLOT(onEventDispatcherAwake()), Qt::DirectConnection);
+    }
+    // the counter's own timer is one of the wakeups, the very coarse type lets the OS align it with the others
+    minuteTimer_.setTimerType(Qt::VeryCoarseTimer);
+    minuteTimer_.setInterval(60 * 1000);
+    connect(&minuteTimer_, SIGNAL(timeout()), SLOT(onMinuteTimer()));
+    minuteTimer_.start();
+}
+
+void IdleModeController::suspendTimer(QTimer *timer)
+{
+    timer->stop();
+    suspendedTimers_.insert(timer);
+}
+
+void IdleModeController::suspendAnimation(QAbstractAnimation *animation)
+{
+    animation->pause();
+    suspendedAnimations_.insert(animation);
+}
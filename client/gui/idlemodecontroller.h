@@ -0,0 +1,62 @@
+#ifndef IDLEMODECONTROLLER_H
+#define IDLEMODECONTROLLER_H
+
+#include <QAbstractAnimation>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+// singleton, the wakeup budget of the GUI while only the tray icon is visible (the main window minimized or hidden,
+// see MainWindowState): the registered animation timers and animations are suspended in the idle mode and resumed
+// on the activation, the ones started while idle are suspended on their first tick.
+// Also counts the wakeups of the GUI event loop per minute for the debug window.
+class IdleModeController : public QObject
+{
+    Q_OBJECT
+
+public:
+    static IdleModeController &instance()
+    {
+        static IdleModeController c;
+        return c;
+    }
+
+    bool isIdle() const;
+
+    // the registered objects must not be deleted before they are stopped or destroyed (the destroyed() is tracked)
+    void addAnimationTimer(QTimer *timer);
+    void addAnimation(QAbstractAnimation *animation);
+
+    int wakeupsPerMinute() const;
+
+signals:
+    void wakeupsPerMinuteChanged(int wakeups);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onMainWindowIsActiveChanged(bool isActive);
+    void onAnimationStateChanged(QAbstractAnimation::State newState, QAbstractAnimation::State oldState);
+    void onObjectDestroyed(QObject *obj);
+    void onEventDispatcherAwake();
+    void onMinuteTimer();
+
+private:
+    IdleModeController();
+
+    bool isIdle_;
+    QSet<QTimer *> timers_;
+    QSet<QTimer *> suspendedTimers_;
+    QSet<QAbstractAnimation *> animations_;
+    QSet<QAbstractAnimation *> suspendedAnimations_;
+
+    QTimer minuteTimer_;
+    int wakeups_;
+    int wakeupsPerMinute_;
+
+    void suspendTimer(QTimer *timer);
+    void suspendAnimation(QAbstractAnimation *animation);
+};
+
+#endif // IDLEMODECONTROLLER_H
@@ -1,6 +1,7 @@
 #include "localipcserver.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
+#include "ipc/connection.h"
 #include "ipc/server.h"
 #include "ipc/protobufcommand.h"
 #include "backend/persistentstate.h"
@@ -59,7 +60,13 @@ void LocalIPCServer::onServerCallbackAcceptFunction(IPC::IConnection *connection
 
     connections_.append(connection);
 
-    connect(dynamic_cast<QObject*>(connection), SIGNAL(newCommand(IPC::Command *, IPC::IConnection *)), SLOT(onConnectionCommandCallback(IPC::Command *, IPC::IConnection *)));
+    // the commands are handled right in newCommand, they are freed with the arena of their batch
+    IPC::Connection *ipcConnection = dynamic_cast<IPC::Connection *>(connection);
+    if (ipcConnection)
+    {
+        ipcConnection->setArenaDecoding(true);
+    }
+    connect(dynamic_cast<QObject*>(connection), SIGNAL(newCommand(IPC::Command *, IPC::IConnection *)), SLOT(onConnectionCommandCallback(IPC::Command *, IPC::IConnection *)), Qt::DirectConnection);
     connect(dynamic_cast<QObject*>(connection), SIGNAL(stateChanged(int, IPC::IConnection *)), SLOT(onConnectionStateCallback(int, IPC::IConnection *)));
 }
 
@@ -118,9 +125,7 @@ void LocalIPCServer::onConnectionCommandCallback(IPC::Command *command, IPC::ICo
     }
     else if (command->getStringId() == CliIpc::GetState::descriptor()->full_name())
     {
-        IPC::ProtobufCommand<CliIpc::State> cmd;
-        cmd.getProtoObj().set_is_logged_in(isLoggedIn_);
-        sendCommand(cmd);
+        sendState();
     }
     else if (command->getStringId() == CliIpc::Firewall::descriptor()->full_name())
     {
@@ -184,6 +189,7 @@ void LocalIPCServer::onConnectionStateCallback(int state, IPC::IConnection *conn
 
 void LocalIPCServer::onBackendConnectStateChanged(const ProtoTypes::ConnectState &connectState)
 {
+    connectState_ = connectState;
     IPC::ProtobufCommand<CliIpc::ConnectStateChanged> cmd;
     *cmd.getProtoObj().mutable_connect_state() = connectState;
     sendCommand(cmd);
@@ -199,12 +205,21 @@ void LocalIPCServer::onBackendFirewallStateChanged(bool isEnabled)
 
 void LocalIPCServer::onBackendLoginFinished(bool /*isLoginFromSavedSettings*/)
 {
-    isLoggedIn_ = true;
+    if (!isLoggedIn_)
+    {
+        isLoggedIn_ = true;
+        // the CLI waiting for the login sends its command at once
+        sendState();
+    }
 }
 
 void LocalIPCServer::onBackendSignOutFinished()
 {
-    isLoggedIn_ = false;
+    if (isLoggedIn_)
+    {
+        isLoggedIn_ = false;
+        sendState();
+    }
 }
 
 void LocalIPCServer::sendCommand(const IPC::Command &command)
@@ -214,3 +229,12 @@ void LocalIPCServer::sendCommand(const IPC::Command &command)
         connection->sendCommand(command);
     }
 }
+
+void LocalIPCServer::sendState()
+{
+    IPC::ProtobufCommand<CliIpc::State> cmd;
+    cmd.getProtoObj().set_is_logged_in(isLoggedIn_);
+    *cmd.getProtoObj().mutable_connect_state() = connectState_;
+    cmd.getProtoObj().set_is_firewall_enabled(backend_->isFirewallEnabled());
+    sendCommand(cmd);
+}
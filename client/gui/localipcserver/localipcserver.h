@@ -36,9 +36,10 @@ private:
     IPC::IServer *server_;
     QVector<IPC::IConnection *> connections_;
     bool isLoggedIn_;
-
+    ProtoTypes::ConnectState connectState_;
 
     void sendCommand(const IPC::Command &command);
+    void sendState();
 };
 
 #endif // LOCALIPCSERVER_H
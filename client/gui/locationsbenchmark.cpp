@@ -0,0 +1,286 @@
+#include "locationsbenchmark.h"
+
+#include <QFile>
+#include <QKeyEvent>
+#include <QTextStream>
+#include <algorithm>
+#include "application/windscribeapplication.h"
+#include "backend/locationsmodel/locationsmodel.h"
+#include "commongraphics/commongraphics.h"
+#include "dpiscalemanager.h"
+#include "guitest.h"
+#include "locationswindow/locationswindow.h"
+#include "types/locationid.h"
+#include "utils/logger.h"
+
+LocationsBenchmark::LocationsBenchmark(const QString &reportPath) : QWidget(nullptr),
+    reportPath_(reportPath), curPhase_(-1)
+{
+    setWindowTitle("Windscribe locations benchmark");
+
+    locationsModel_ = new LocationsModel(this);
+    locationsWindow_ = new LocationsWindow(this, locationsModel_);
+    connect(locationsWindow_, SIGNAL(heightChanged()), SLOT(onLocationsWindowHeightChanged()));
+
+    guiTest_ = new GuiTest(this);
+    connect(guiTest_, SIGNAL(finished()), SLOT(onScriptFinished()));
+}
+
+LocationsBenchmark::~LocationsBenchmark()
+{
+    WindscribeApplication::instance()->setEventTimingCallback(nullptr);
+}
+
+void LocationsBenchmark::start()
+{
+    const ProtoTypes::ArrayLocations locations = fixtureLocations();
+    const LocationID bestLocation = LocationID::createApiLocationId(1, "City 1-1", "Nick 1-1").apiLocationToBestLocation();
+    locationsModel_->updateApiLocations(bestLocation.toProtobuf(), QString(), locations);
+
+    locationsWindow_->setCountVisibleItemSlots(7);
+    onLocationsWindowHeightChanged();
+    show();
+
+    WindscribeApplication::instance()->setEventTimingCallback(
+        [this](QObject *receiver, QEvent::Type type, qint64 startNs, qint64 elapsedNs)
+        {
+            onEventTimed(receiver, type, startNs, elapsedNs);
+        });
+
+    addScript();
+    guiTest_->start();
+}
+
+void LocationsBenchmark::keyPressEvent(QKeyEvent *event)
+{
+    locationsWindow_->handleKeyPressEvent(event);
+}
+
+void LocationsBenchmark::keyReleaseEvent(QKeyEvent *event)
+{
+    locationsWindow_->handleKeyReleaseEvent(event);
+}
+
+void LocationsBenchmark::onLocationsWindowHeightChanged()
+{
+    locationsWindow_->setGeometry(0, 0, WINDOW_WIDTH * G_SCALE, locationsWindow_->tabAndFooterHeight() * G_SCALE);
+    setFixedSize(locationsWindow_->size());
+}
+
+void LocationsBenchmark::onScriptFinished()
+{
+    WindscribeApplication::instance()->setEventTimingCallback(nullptr);
+
+    const QString str = report();
+    QFile file(reportPath_);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        file.write(str.toUtf8());
+        qCDebug(LOG_BASIC) << "Locations benchmark report written to" << reportPath_;
+    }
+    else
+    {
+        qCDebug(LOG_BASIC) << "Can't write the locations benchmark report to" << reportPath_;
+    }
+    qApp->quit();
+}
+
+void LocationsBenchmark::addScript()
+{
+    // let the window show and settle before the measurements
+    guiTest_->addDelay(1000);
+
+    addPhase("scroll", [this]()
+    {
+        for (int i = 0; i < 40; ++i)
+        {
+            guiTest_->addKey(Qt::Key_Down);
+            guiTest_->addDelay(30);
+        }
+        for (int i = 0; i < 40; ++i)
+        {
+            guiTest_->addKey(Qt::Key_Up);
+            guiTest_->addDelay(30);
+        }
+    });
+
+    // the accent is on the best location after the scrolling, each step moves it to the next region
+    addPhase("expand", [this]()
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            guiTest_->addKey(Qt::Key_Down);
+            guiTest_->addDelay(50);
+            guiTest_->addKey(Qt::Key_Return);
+            guiTest_->addDelay(400);
+            guiTest_->addKey(Qt::Key_Return);
+            guiTest_->addDelay(400);
+        }
+    });
+
+    addPhase("filter", [this]()
+    {
+        const QString filter = "Location";
+        for (const QChar &ch : filter)
+        {
+            guiTest_->addKey(static_cast<Qt::Key>(ch.toUpper().unicode()), ch);
+            guiTest_->addDelay(120);
+        }
+        guiTest_->addDelay(800);
+    });
+
+    // from the search tab to the first tab and back
+    addPhase("tabs", [this]()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int t = 0; t < 4; ++t)
+            {
+                guiTest_->addKey(Qt::Key_Left);
+                guiTest_->addDelay(400);
+            }
+            for (int t = 0; t < 4; ++t)
+            {
+                guiTest_->addKey(Qt::Key_Right);
+                guiTest_->addDelay(400);
+            }
+        }
+    });
+}
+
+void LocationsBenchmark::addPhase(const QString &name, const std::function<void()> &steps)
+{
+    guiTest_->addCallback([this, name]()
+    {
+        Phase phase;
+        phase.name = name;
+        phase.startNs = WindscribeApplication::instance()->startupElapsedMs() * 1000000;
+        phase.endNs = phase.startNs;
+        phases_ << phase;
+        curPhase_ = phases_.size() - 1;
+    });
+    steps();
+    guiTest_->addCallback([this]()
+    {
+        phases_[curPhase_].endNs = WindscribeApplication::instance()->startupElapsedMs() * 1000000;
+        curPhase_ = -1;
+    });
+}
+
+void LocationsBenchmark::onEventTimed(QObject *receiver, QEvent::Type type, qint64 startNs, qint64 elapsedNs)
+{
+    if (curPhase_ < 0)
+    {
+        return;
+    }
+    Phase &phase = phases_[curPhase_];
+    if (type == QEvent::UpdateRequest)
+    {
+        // one frame is the repaint of the top-level window, the paint events of its widgets are sent inside it
+        if (receiver == this)
+        {
+            phase.frameStartNs << startNs;
+            phase.frameNs << elapsedNs;
+        }
+    }
+    else if (receiver->isWidgetType())
+    {
+        phase.paintNs[receiver->metaObject()->className()] << elapsedNs;
+    }
+}
+
+QString LocationsBenchmark::report() const
+{
+    QString str;
+    QTextStream out(&str);
+    out << "Locations window benchmark: " << FIXTURE_LOCATIONS_COUNT << " locations x " << FIXTURE_CITIES_COUNT
+        << " cities, scale " << G_SCALE << "\n";
+
+    for (const Phase &phase : phases_)
+    {
+        const double durationMs = (phase.endNs - phase.startNs) / 1e6;
+        QVector<qint64> intervalNs;
+        for (int i = 1; i < phase.frameStartNs.size(); ++i)
+        {
+            intervalNs << phase.frameStartNs[i] - phase.frameStartNs[i - 1];
+        }
+
+        out << "\n[" << phase.name << "] " << QString::number(durationMs, 'f', 0) << " ms, " << phase.frameNs.size()
+            << " frames\n";
+        out << "  frame time: p50 " << QString::number(percentileMs(phase.frameNs, 0.5), 'f', 2) << " ms, p99 "
+            << QString::number(percentileMs(phase.frameNs, 0.99), 'f', 2) << " ms, max "
+            << QString::number(percentileMs(phase.frameNs, 1.0), 'f', 2) << " ms\n";
+        out << "  frame interval: p50 " << QString::number(percentileMs(intervalNs, 0.5), 'f', 2) << " ms, p99 "
+            << QString::number(percentileMs(intervalNs, 0.99), 'f', 2) << " ms, max "
+            << QString::number(percentileMs(intervalNs, 1.0), 'f', 2) << " ms\n";
+
+        // the most expensive widget classes first
+        QVector<QPair<qint64, QString> > classes;
+        for (auto it = phase.paintNs.cbegin(); it != phase.paintNs.cend(); ++it)
+        {
+            qint64 totalNs = 0;
+            for (qint64 ns : it.value())
+            {
+                totalNs += ns;
+            }
+            classes << qMakePair(totalNs, it.key());
+        }
+        std::sort(classes.begin(), classes.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b)
+        {
+            return a.first > b.first;
+        });
+
+        for (const auto &c : classes)
+        {
+            const QVector<qint64> &values = phase.paintNs[c.second];
+            out << "  paint " << c.second << ": " << values.size() << " events, total "
+                << QString::number(c.first / 1e6, 'f', 2) << " ms, mean "
+                << QString::number(c.first / 1e6 / values.size(), 'f', 3) << " ms, p99 "
+                << QString::number(percentileMs(values, 0.99), 'f', 3) << " ms\n";
+        }
+    }
+    return str;
+}
+
+ProtoTypes::ArrayLocations LocationsBenchmark::fixtureLocations()
+{
+    const char *countryCodes[] = { "us", "ca", "gb", "de", "fr", "nl", "jp", "au" };
+    const int countryCodesCount = sizeof(countryCodes) / sizeof(countryCodes[0]);
+
+    ProtoTypes::ArrayLocations locations;
+    for (int i = 1; i <= FIXTURE_LOCATIONS_COUNT; ++i)
+    {
+        ProtoTypes::Location *location = locations.add_locations();
+        *location->mutable_id() = LocationID::createTopApiLocationId(i).toProtobuf();
+        location->set_name(QString("Location %1").arg(i).toStdString());
+        location->set_country_code(countryCodes[i % countryCodesCount]);
+        location->set_is_premium_only(i % 5 == 0);
+        location->set_is_p2p_supported(i % 3 != 0);
+
+        for (int c = 1; c <= FIXTURE_CITIES_COUNT; ++c)
+        {
+            const QString cityName = QString("City %1-%2").arg(i).arg(c);
+            const QString nick = QString("Nick %1-%2").arg(i).arg(c);
+            ProtoTypes::City *city = location->add_cities();
+            *city->mutable_id() = LocationID::createApiLocationId(i, cityName, nick).toProtobuf();
+            city->set_name(cityName.toStdString());
+            city->set_nick(nick.toStdString());
+            city->set_ping_time(20 + (i * 37 + c * 11) % 300);
+            city->set_is_premium_only(c % 4 == 0);
+            city->set_link_speed(c % 3 == 0 ? 10000 : 1000);
+            city->set_health((i * 13 + c * 7) % 100);
+        }
+    }
+    return locations;
+}
+
+double LocationsBenchmark::percentileMs(QVector<qint64> values, double p)
+{
+    if (values.isEmpty())
+    {
+        return 0;
+    }
+    const int ind = qMin(values.size() - 1, static_cast<int>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + ind, values.end());
+    return values[ind] / 1e6;
+}
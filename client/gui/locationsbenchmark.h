@@ -0,0 +1,65 @@
+#ifndef LOCATIONSBENCHMARK_H
+#define LOCATIONSBENCHMARK_H
+
+#include <QWidget>
+#include <QHash>
+#include <QVector>
+#include <functional>
+#include "ipc/generated_proto/types.pb.h"
+
+class GuiTest;
+class LocationsModel;
+class LocationsWindow;
+
+// Rendering benchmark of the locations window, started with the --benchmark-locations command line flag.
+// Loads a fixture list of locations into the model, then scrolls, expands regions, types a filter and switches
+// the tabs with GuiTest. Times the frames of the window and the paint events of each widget class,
+// writes the report to the file and quits the application.
+class LocationsBenchmark : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LocationsBenchmark(const QString &reportPath);
+    ~LocationsBenchmark() override;
+
+    void start();
+
+    static constexpr int FIXTURE_LOCATIONS_COUNT = 60;
+    static constexpr int FIXTURE_CITIES_COUNT = 6;
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+    void keyReleaseEvent(QKeyEvent *event) override;
+
+private slots:
+    void onLocationsWindowHeightChanged();
+    void onScriptFinished();
+
+private:
+    struct Phase
+    {
+        QString name;
+        qint64 startNs;
+        qint64 endNs;
+        QVector<qint64> frameStartNs;
+        QVector<qint64> frameNs;
+        QHash<QString, QVector<qint64> > paintNs;     // by the class name of the widget
+    };
+
+    QString reportPath_;
+    LocationsModel *locationsModel_;
+    LocationsWindow *locationsWindow_;
+    GuiTest *guiTest_;
+    QVector<Phase> phases_;
+    int curPhase_;      // -1 between the phases
+
+    void addScript();
+    void addPhase(const QString &name, const std::function<void()> &steps);
+    void onEventTimed(QObject *receiver, QEvent::Type type, qint64 startNs, qint64 elapsedNs);
+    QString report() const;
+
+    static ProtoTypes::ArrayLocations fixtureLocations();
+    static double percentileMs(QVector<qint64> values, double p);
+};
+
+#endif // LOCATIONSBENCHMARK_H
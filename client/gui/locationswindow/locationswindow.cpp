@@ -28,6 +28,7 @@ LocationsWindow::LocationsWindow(QWidget *parent, LocationsModel *locationsModel
     connect(locationsTab_, SIGNAL(addStaticIpClicked()), SIGNAL(addStaticIpClicked()));
     connect(locationsTab_, SIGNAL(clearCustomConfigClicked()), SIGNAL(clearCustomConfigClicked()));
     connect(locationsTab_, SIGNAL(addCustomConfigClicked()), SIGNAL(addCustomConfigClicked()));
+    connect(locationsTab_, SIGNAL(countryAccented(QString)), SIGNAL(countryAccented(QString)));
 
     connect(&LanguageController::instance(), SIGNAL(languageChanged()), SLOT(onLanguageChanged()));
 }
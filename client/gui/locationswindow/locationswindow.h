@@ -42,6 +42,7 @@ signals:
     void addStaticIpClicked();
     void clearCustomConfigClicked();
     void addCustomConfigClicked();
+    void countryAccented(const QString &countryCode);
 
 protected:
     void paintEvent(QPaintEvent *event)        override;
@@ -28,6 +28,8 @@ ItemWidgetCity::ItemWidgetCity(IWidgetLocationsInfo *widgetLocationsInfo, const
 {
     setMouseTracking(true);
     setFocusPolicy(Qt::NoFocus);
+    // the background is filled in paintEvent, nothing under the row is repainted when a part of it changes
+    setAttribute(Qt::WA_OpaquePaintEvent);
 
     cityLightWidget_ = QSharedPointer<LightWidget>(new LightWidget(this));
     cityLightWidget_->setText(cityModelItem.city);
@@ -118,7 +120,7 @@ void ItemWidgetCity::setFavourited(bool favorited)
     {
         favLightWidget_->setIcon("locations/FAV_ICON_DESELECTED");
     }
-    update();
+    update(favLightWidget_->rect());
 }
 
 void ItemWidgetCity::setSelectable(bool selectable)
@@ -280,7 +282,8 @@ void ItemWidgetCity::paintEvent(QPaintEvent *event)
         // qDebug() << "Drawing static location";
         painter.setOpacity(0.5);
         painter.setPen(Qt::white);
-        staticIpTextLayout_->draw(&painter, QPoint(staticIpLightWidget_->rect().x(), staticIpLightWidget_->rect().y()));
+        painter.setFont(staticIpLightWidget_->font());
+        painter.drawStaticText(staticIpLightWidget_->rect().topLeft(), staticIpStaticText_);
 
     }
     else if (isForbidden())
@@ -318,12 +321,14 @@ void ItemWidgetCity::paintEvent(QPaintEvent *event)
     painter.save();
     painter.setOpacity(curTextOpacity_);
     painter.setPen(Qt::white);
-    cityTextLayout_->draw(&painter, QPoint(cityLightWidget_->rect().x(), cityLightWidget_->rect().y()));
+    painter.setFont(cityLightWidget_->font());
+    painter.drawStaticText(cityLightWidget_->rect().topLeft(), cityStaticText_);
 
     // city text for non-static and non-custom views only
     if (!cityModelItem_.id.isStaticIpsLocation() && !cityModelItem_.id.isCustomConfigsLocation())
     {
-        nickTextLayout_->draw(&painter, QPoint(nickLightWidget_->rect().x(), nickLightWidget_->rect().y()));
+        painter.setFont(nickLightWidget_->font());
+        painter.drawStaticText(nickLightWidget_->rect().topLeft(), nickStaticText_);
     }
     painter.restore();
 
@@ -352,7 +357,7 @@ void ItemWidgetCity::paintEvent(QPaintEvent *event)
     else if (!showingLatencyAsPingBar_)
     {
         // draw bubble
-        int latencyRectWidth = 33;
+        int latencyRectWidth = LATENCY_RECT_WIDTH;
         int latencyRectHeight = 20;
         int scaledX = (WINDOW_WIDTH - latencyRectWidth - 8) * G_SCALE;
         int scaledY = (LOCATION_ITEM_HEIGHT - latencyRectHeight) / 2 *G_SCALE - 1*G_SCALE;
@@ -363,17 +368,15 @@ void ItemWidgetCity::paintEvent(QPaintEvent *event)
         painter.setPen(Qt::NoPen);
         painter.drawRoundedRect(latencyRect, 4*G_SCALE, 4*G_SCALE);
 
-        // draw latency text
-        QFont font = *FontManager::instance().getFont(11, false);
-        QString latencyText = QString::number(pingTime_.toInt());
+        // draw latency text, the few distinct values are cached for all the widgets
+        QFont *font = FontManager::instance().getFont(11, false);
+        QStaticText latencyText = FontManager::instance().getStaticText(QString::number(pingTime_.toInt()), 11, false);
         painter.setBrush(Qt::white);
         painter.setPen(Qt::white);
-        painter.setFont(font);
-        painter.drawText(QRect((scaledX + latencyRectWidth/2*G_SCALE) - CommonGraphics::textWidth(latencyText, font)/2,
-                               (scaledY + latencyRectHeight/2*G_SCALE) - CommonGraphics::textHeight(font)/2 ,
-                               CommonGraphics::textWidth(latencyText, font),
-                               CommonGraphics::textHeight(font)),
-                         latencyText);
+        painter.setFont(*font);
+        painter.drawStaticText((scaledX + latencyRectWidth/2*G_SCALE) - qRound(latencyText.size().width())/2,
+                               (scaledY + latencyRectHeight/2*G_SCALE) - CommonGraphics::textHeight(*font)/2,
+                               latencyText);
     }
     else if (showPingIcon_)
     {
@@ -585,7 +588,7 @@ void ItemWidgetCity::onCityLightWidgetHoveringChanged(bool hovering)
 void ItemWidgetCity::onTextOpacityAnimationValueChanged(const QVariant &value)
 {
     curTextOpacity_ = value.toDouble();
-    update();
+    update(textOpacityRegion());
 }
 
 void ItemWidgetCity::updateFavoriteIcon()
@@ -603,7 +606,7 @@ void ItemWidgetCity::updateFavoriteIcon()
         }
         showFavIcon_ = true;
     }
-    update();
+    update(favLightWidget_->rect());
 }
 
 void ItemWidgetCity::clickFavorite()
@@ -630,7 +633,7 @@ void ItemWidgetCity::updatePingBarIcon()
         showPingIcon_ = false;
     }
 
-    update();
+    update(pingRect());
 }
 
 const QString ItemWidgetCity::pingIconNameString(int connectionSpeedIndex)
@@ -660,23 +663,29 @@ void ItemWidgetCity::recreateTextLayouts()
                                                           cityLightWidget_->font(),
                                                           static_cast<int>(CITY_CAPTION_MAX_WIDTH * G_SCALE));
 
-    cityTextLayout_ = QSharedPointer<QTextLayout>(new QTextLayout(cityText, cityLightWidget_->font()));
-    cityTextLayout_->beginLayout();
-    cityTextLayout_->createLine();
-    cityTextLayout_->endLayout();
-    cityTextLayout_->setCacheEnabled(true);
-
-    nickTextLayout_ = QSharedPointer<QTextLayout>(new QTextLayout(nickLightWidget_->text(), nickLightWidget_->font()));
-    nickTextLayout_->beginLayout();
-    nickTextLayout_->createLine();
-    nickTextLayout_->endLayout();
-    nickTextLayout_->setCacheEnabled(true);
-
-    staticIpTextLayout_ = QSharedPointer<QTextLayout>(new QTextLayout(staticIpLightWidget_->text(),staticIpLightWidget_->font()));
-    staticIpTextLayout_->beginLayout();
-    staticIpTextLayout_->createLine();
-    staticIpTextLayout_->endLayout();
-    staticIpTextLayout_->setCacheEnabled(true);
+    cityStaticText_ = FontManager::instance().getStaticText(cityText, 16, true);
+    nickStaticText_ = FontManager::instance().getStaticText(nickLightWidget_->text(), 16, false);
+    staticIpStaticText_ = FontManager::instance().getStaticText(staticIpLightWidget_->text(), 13, false);
+}
+
+QRect ItemWidgetCity::pingRect() const
+{
+    // the ping bars, the latency bubble or the error icon, all at the right edge
+    int left = (WINDOW_WIDTH - LATENCY_RECT_WIDTH - 8) * G_SCALE;
+    return QRect(left, 0, WINDOW_WIDTH * G_SCALE - left, LOCATION_ITEM_HEIGHT * G_SCALE);
+}
+
+QRegion ItemWidgetCity::textOpacityRegion() const
+{
+    // the config icon and the captions at the left, and the load line at the bottom
+    int right = qMax(cityLightWidget_->rect().right(), nickLightWidget_->rect().right()) + 1;
+    QRegion region(0, 0, right, LOCATION_ITEM_HEIGHT * G_SCALE);
+    if (widgetLocationsInfo_->isShowLocationLoad() && cityModelItem_.locationLoad > 0)
+    {
+        int bottom = static_cast<int>(LOCATION_ITEM_HEIGHT*G_SCALE) - 1;
+        region += QRect(0, bottom - 1, WINDOW_WIDTH * G_SCALE, 2);
+    }
+    return region;
 }
 
 void ItemWidgetCity::update10gbpsIcon()
@@ -2,6 +2,8 @@
 #define LOCATIONITEMCITYWIDGET_H
 
 #include <QLabel>
+#include <QRegion>
+#include <QStaticText>
 #include "backend/locationsmodel/basiclocationsmodel.h"
 #include "iitemwidget.h"
 #include "iwidgetlocationsinfo.h"
@@ -82,16 +84,21 @@ private:
     void update10gbpsIcon();
     void clickFavorite();
 
+    // the parts of the row repainted on their own changes
+    QRect pingRect() const;
+    QRegion textOpacityRegion() const;
+
     QSharedPointer<LightWidget> favLightWidget_;
     QSharedPointer<LightWidget> pingIconLightWidget_;
     QSharedPointer<LightWidget> tenGbpsLightWidget_;
 
-    QSharedPointer<QTextLayout> cityTextLayout_;
+    // the texts are from the FontManager cache, shared with the other widgets showing the same captions
+    QStaticText cityStaticText_;
     QSharedPointer<LightWidget> cityLightWidget_;
-    QSharedPointer<QTextLayout> nickTextLayout_;
+    QStaticText nickStaticText_;
     QSharedPointer<LightWidget> nickLightWidget_;
 
-    QSharedPointer<QTextLayout> staticIpTextLayout_;
+    QStaticText staticIpStaticText_;
     QSharedPointer<LightWidget> staticIpLightWidget_;
 
     double curTextOpacity_;
@@ -99,6 +106,7 @@ private:
     QVariantAnimation textOpacityAnimation_;
 
     const int CITY_CAPTION_MAX_WIDTH = 210;
+    const int LATENCY_RECT_WIDTH = 33;
 };
 
 }
@@ -13,7 +13,7 @@
 
 namespace GuiLocations {
 
-ItemWidgetHeader::ItemWidgetHeader(IWidgetLocationsInfo *widgetLocationsInfo, LocationModelItem *locationModelItem, QWidget *parent) : IItemWidget(parent)
+ItemWidgetHeader::ItemWidgetHeader(IWidgetLocationsInfo *widgetLocationsInfo, const LocationModelItem *locationModelItem, QWidget *parent) : IItemWidget(parent)
   , widgetLocationsInfo_(widgetLocationsInfo)
   , locationID_(locationModelItem->id)
   , countryCode_(locationModelItem->countryCode)
@@ -28,7 +28,6 @@ ItemWidgetHeader::ItemWidgetHeader(IWidgetLocationsInfo *widgetLocationsInfo, Lo
   , expandAnimationProgress_(0.0)
   , textOpacity_(OPACITY_UNHOVER_TEXT)
   , textForLayout_(locationModelItem->title)
-  , textLayout_(nullptr)
   , showP2pIcon_(locationModelItem->isShowP2P)
   , p2pHovering_(false)
 {
@@ -210,7 +209,8 @@ void ItemWidgetHeader::paintEvent(QPaintEvent * /*event*/)
     painter.save();
     painter.setOpacity(textOpacity_);
     painter.setPen(Qt::white);
-    textLayout_->draw(&painter, QPoint(textLayoutRect().x(), textLayoutRect().y()));
+    painter.setFont(*FontManager::instance().getFont(16, true));
+    painter.drawStaticText(textRect_.topLeft(), staticText_);
     painter.restore();
 
     // p2p
@@ -374,27 +374,15 @@ void ItemWidgetHeader::onExpandRotationAnimationValueChanged(const QVariant &val
     update();
 }
 
-QFont ItemWidgetHeader::textLayoutFont()
-{
-    return *FontManager::instance().getFont(16, true);
-}
-
-QRect ItemWidgetHeader::textLayoutRect()
-{
-    QFont f = textLayoutFont();
-    return QRect(64*G_SCALE,
-                 (LOCATION_ITEM_HEIGHT*G_SCALE - CommonGraphics::textHeight(f))/2,
-                 CommonGraphics::textWidth(textForLayout_, f),
-                 CommonGraphics::textHeight(f));
-}
-
 void ItemWidgetHeader::recreateTextLayout()
 {
-    textLayout_ = QSharedPointer<QTextLayout>(new QTextLayout(textForLayout_, textLayoutFont()));
-    textLayout_->beginLayout();
-    textLayout_->createLine();
-    textLayout_->endLayout();
-    textLayout_->setCacheEnabled(true);
+    // the text and its rect depend only on the title and the scale, they aren't measured on every paint
+    QFont f = *FontManager::instance().getFont(16, true);
+    staticText_ = FontManager::instance().getStaticText(textForLayout_, 16, true);
+    textRect_ = QRect(64*G_SCALE,
+                      (LOCATION_ITEM_HEIGHT*G_SCALE - CommonGraphics::textHeight(f))/2,
+                      CommonGraphics::textWidth(textForLayout_, f),
+                      CommonGraphics::textHeight(f));
 }
 
 QRect ItemWidgetHeader::p2pRect()
@@ -2,7 +2,7 @@
 #define LOCATIONITEMREGIONHEADERWIDGET_H
 
 #include <QLabel>
-#include <QTextLayout>
+#include <QStaticText>
 #include "backend/locationsmodel/basiclocationsmodel.h"
 #include "iitemwidget.h"
 #include "commonwidgets/iconwidget.h"
@@ -14,7 +14,7 @@ class ItemWidgetHeader : public IItemWidget
 {
     Q_OBJECT
 public:
-    explicit ItemWidgetHeader(IWidgetLocationsInfo *widgetLocationsInfo, LocationModelItem *locationItem, QWidget *parent = nullptr);
+    explicit ItemWidgetHeader(IWidgetLocationsInfo *widgetLocationsInfo, const LocationModelItem *locationItem, QWidget *parent = nullptr);
     ~ItemWidgetHeader() override;
 
     bool isExpanded() const override;
@@ -79,9 +79,8 @@ private:
     // text
     double textOpacity_;
     QString textForLayout_;
-    QSharedPointer<QTextLayout> textLayout_;
-    QFont textLayoutFont();
-    QRect textLayoutRect();
+    QStaticText staticText_;    // from the FontManager cache, shared with the other widgets of the same title
+    QRect textRect_;
     void recreateTextLayout();
 
     // p2p
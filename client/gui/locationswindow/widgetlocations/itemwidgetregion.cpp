@@ -10,7 +10,9 @@
 
 namespace GuiLocations {
 
-ItemWidgetRegion::ItemWidgetRegion(IWidgetLocationsInfo * widgetLocationsInfo, LocationModelItem *locationModelItem, QWidget *parent) : QWidget(parent)
+ItemWidgetRegion::ItemWidgetRegion(IWidgetLocationsInfo * widgetLocationsInfo, const LocationModelItem &locationModelItem, QWidget *parent) : QWidget(parent)
+  , cityItems_(locationModelItem.cities)
+  , cities_(locationModelItem.cities.count(), nullptr)
   , widgetLocationsInfo_(widgetLocationsInfo)
   , muteAccentChanges_(false)
   , citySubMenuState_(COLLAPSED)
@@ -19,7 +21,7 @@ ItemWidgetRegion::ItemWidgetRegion(IWidgetLocationsInfo * widgetLocationsInfo, L
 
     height_ = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
 
-    regionHeaderWidget_ = new ItemWidgetHeader(widgetLocationsInfo, locationModelItem, this);
+    regionHeaderWidget_ = new ItemWidgetHeader(widgetLocationsInfo, &locationModelItem, this);
     connect(regionHeaderWidget_, SIGNAL(clicked()), SLOT(onRegionHeaderClicked()));
     connect(regionHeaderWidget_, SIGNAL(accented()), SLOT(onRegionHeaderAccented()));
     connect(regionHeaderWidget_, SIGNAL(hoverEnter()), SLOT(onRegionHeaderHoverEnter()));
@@ -42,8 +44,11 @@ ItemWidgetRegion::~ItemWidgetRegion()
 
     for (auto *city : qAsConst(cities_))
     {
-        city->disconnect();
-        city->deleteLater();
+        if (city)
+        {
+            city->disconnect();
+            city->deleteLater();
+        }
     }
     cities_.clear();
 }
@@ -55,7 +60,7 @@ const LocationID ItemWidgetRegion::getId() const
 
 bool ItemWidgetRegion::expandable() const
 {
-    return cities_.count() > 0;
+    return cityItems_.count() > 0;
 }
 
 bool ItemWidgetRegion::expandedOrExpanding()
@@ -77,7 +82,10 @@ void ItemWidgetRegion::setExpandedWithoutAnimation(bool expand)
     regionHeaderWidget_->setExpandedWithoutAnimation(expand);
     for (auto *city : qAsConst(cities_))
     {
-        city->setSelectable(expand);
+        if (city)
+        {
+            city->setSelectable(expand);
+        }
     }
     recalcItemPositions();
 }
@@ -92,7 +100,10 @@ void ItemWidgetRegion::expand()
     // qCDebug(LOG_LOCATION_LIST) << "Expanding: " << regionHeaderWidget_->name();
     for (auto *city : qAsConst(cities_))
     {
-        city->setSelectable(true);
+        if (city)
+        {
+            city->setSelectable(true);
+        }
     }
 
     regionHeaderWidget_->setExpanded(true);
@@ -109,7 +120,10 @@ void ItemWidgetRegion::collapse()
 
     for (auto *city : qAsConst(cities_))
     {
-        city->setSelectable(false);
+        if (city)
+        {
+            city->setSelectable(false);
+        }
     }
 
     regionHeaderWidget_->setExpanded(false);
@@ -122,58 +136,115 @@ void ItemWidgetRegion::collapse()
 
 void ItemWidgetRegion::addCity(const CityModelItem &city)
 {
-    auto cityWidget = new ItemWidgetCity(widgetLocationsInfo_, city, this);
-    connect(cityWidget, SIGNAL(clicked()), SLOT(onCityItemClicked()));
-    connect(cityWidget, SIGNAL(accented()), SLOT(onCityItemAccented()));
-    connect(cityWidget, SIGNAL(hoverEnter()), SLOT(onCityItemHoverEnter()));
-    connect(cityWidget, SIGNAL(favoriteClicked(ItemWidgetCity *, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*, bool)));
-    cities_.append(cityWidget);
-    cityWidget->show();
-    recalcItemPositions();
+    // the widget is created when the city gets into the viewport
+    cityItems_.append(city);
+    cities_.append(nullptr);
+    recalcHeight();
 }
 
-QVector<IItemWidget*> ItemWidgetRegion::selectableWidgets()
+int ItemWidgetRegion::cityCount() const
 {
-    QVector<IItemWidget *> widgets;
-    widgets.append(regionHeaderWidget_);
-    if (expandedOrExpanding())
+    return cityItems_.count();
+}
+
+IItemWidget *ItemWidgetRegion::itemWidget(int cityIndex)
+{
+    if (cityIndex < 0)
     {
-        for (auto *city : qAsConst(cities_))
+        return regionHeaderWidget_;
+    }
+    if (cityIndex >= cities_.count())
+    {
+        return nullptr;
+    }
+    if (!cities_[cityIndex])
+    {
+        createCityWidget(cityIndex);
+    }
+    return cities_[cityIndex];
+}
+
+bool ItemWidgetRegion::containsItemWidget(IItemWidget *itemWidget) const
+{
+    return itemWidget == regionHeaderWidget_ || cities_.contains(static_cast<ItemWidgetCity *>(itemWidget));
+}
+
+void ItemWidgetRegion::updateVisibleCities(int top, int bottom, IItemWidget *keepWidget)
+{
+    // the cities below the current (possibly animated) height are clipped by the region
+    bottom = qMin(bottom, height_ - 1);
+
+    const int itemHeight = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
+    for (int i = 0; i < cities_.count(); ++i)
+    {
+        const int cityTop = itemHeight * (i + 1);
+        const bool isVisible = cityTop <= bottom && cityTop + itemHeight > top;
+        if (isVisible && !cities_[i])
+        {
+            createCityWidget(i);
+        }
+        else if (!isVisible && cities_[i] && cities_[i] != keepWidget)
         {
-            widgets.append(city);
+            deleteCityWidget(i);
         }
     }
-    return widgets;
 }
 
-QVector<ItemWidgetCity *> ItemWidgetRegion::cityWidgets()
+void ItemWidgetRegion::setFavorited(LocationID id, bool isFavorite)
 {
-    return cities_;
+    for (int i = 0; i < cityItems_.count(); ++i)
+    {
+        if (cityItems_[i].id == id)
+        {
+            cityItems_[i].isFavorite = isFavorite;
+            if (cities_[i])
+            {
+                cities_[i]->setFavourited(isFavorite);
+            }
+            break;
+        }
+    }
 }
 
-void ItemWidgetRegion::setFavorited(LocationID id, bool isFavorite)
+void ItemWidgetRegion::setLatencyMs(LocationID id, PingTime pingTime)
 {
-    for (auto *city : qAsConst(cities_))
+    for (int i = 0; i < cityItems_.count(); ++i)
     {
-        if (city->getId() == id)
+        if (cityItems_[i].id == id)
         {
-            city->setFavourited(isFavorite);
+            cityItems_[i].pingTimeMs = pingTime;
+            if (cities_[i])
+            {
+                cities_[i]->setLatencyMs(pingTime);
+            }
             break;
         }
     }
 }
 
+void ItemWidgetRegion::setShowLatencyMs(bool showLatencyMs)
+{
+    // the new city widgets take the setting from IWidgetLocationsInfo
+    for (auto *city : qAsConst(cities_))
+    {
+        if (city)
+        {
+            city->setShowLatencyMs(showLatencyMs);
+        }
+    }
+}
+
 void ItemWidgetRegion::recalcItemPositions()
 {
     // qDebug() << "Region recalc item positions";
     regionHeaderWidget_->setGeometry(0,0, WINDOW_WIDTH * G_SCALE, qCeil(LOCATION_ITEM_HEIGHT * G_SCALE));
 
-    int height = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
-
-    for (auto *city : qAsConst(cities_))
+    for (int i = 0; i < cities_.count(); ++i)
     {
-        city->setGeometry(0, height, WINDOW_WIDTH * G_SCALE, qCeil(LOCATION_ITEM_HEIGHT * G_SCALE));
-        height += city->geometry().height();
+        if (cities_[i])
+        {
+            updateCityGeometry(i);
+        }
     }
     recalcHeight();
 }
@@ -196,7 +267,10 @@ void ItemWidgetRegion::updateScaling()
     regionHeaderWidget_->updateScaling();
     for (auto *city : qAsConst(cities_))
     {
-        city->updateScaling();
+        if (city)
+        {
+            city->updateScaling();
+        }
     }
     recalcItemPositions();
 }
@@ -263,13 +337,7 @@ void ItemWidgetRegion::onExpandingHeightAnimationValueChanged(const QVariant &va
 
 int ItemWidgetRegion::expandedHeight()
 {
-    int height = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
-    for (auto *city : qAsConst(cities_))
-    {
-        height += city->geometry().height();
-    }
-
-    return height;
+    return qCeil(LOCATION_ITEM_HEIGHT * G_SCALE) * (cityItems_.count() + 1);
 }
 
 void ItemWidgetRegion::onCityItemAccented()
@@ -277,6 +345,36 @@ void ItemWidgetRegion::onCityItemAccented()
     emit accented(static_cast<IItemWidget*>(sender()));
 }
 
+ItemWidgetCity *ItemWidgetRegion::createCityWidget(int cityIndex)
+{
+    auto cityWidget = new ItemWidgetCity(widgetLocationsInfo_, cityItems_[cityIndex], this);
+    connect(cityWidget, SIGNAL(clicked()), SLOT(onCityItemClicked()));
+    connect(cityWidget, SIGNAL(accented()), SLOT(onCityItemAccented()));
+    connect(cityWidget, SIGNAL(hoverEnter()), SLOT(onCityItemHoverEnter()));
+    connect(cityWidget, SIGNAL(favoriteClicked(ItemWidgetCity *, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*, bool)));
+    cityWidget->setSelectable(expandedOrExpanding());
+    cities_[cityIndex] = cityWidget;
+    updateCityGeometry(cityIndex);
+    cityWidget->show();
+    return cityWidget;
+}
+
+void ItemWidgetRegion::deleteCityWidget(int cityIndex)
+{
+    ItemWidgetCity *cityWidget = cities_[cityIndex];
+    cities_[cityIndex] = nullptr;
+    cityWidget->disconnect();
+    cityWidget->hide();
+    cityWidget->deleteLater();
+    emit itemWidgetDeleted(cityWidget);
+}
+
+void ItemWidgetRegion::updateCityGeometry(int cityIndex)
+{
+    const int itemHeight = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
+    cities_[cityIndex]->setGeometry(0, itemHeight * (cityIndex + 1), WINDOW_WIDTH * G_SCALE, itemHeight);
+}
+
 
 } // namespace
 
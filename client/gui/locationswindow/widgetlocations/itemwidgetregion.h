@@ -8,11 +8,14 @@
 
 namespace GuiLocations {
 
+// The region header with the cities of the region below it.
+// The widgets of the cities are created only for the part of the region visible in the list (see updateVisibleCities),
+// the region keeps the model items of all its cities.
 class ItemWidgetRegion : public QWidget
 {
     Q_OBJECT
 public:
-    explicit ItemWidgetRegion(IWidgetLocationsInfo *widgetLocationInfo, LocationModelItem *locationItem, QWidget *parent = nullptr);
+    explicit ItemWidgetRegion(IWidgetLocationsInfo *widgetLocationInfo, const LocationModelItem &locationItem, QWidget *parent = nullptr);
     ~ItemWidgetRegion();
 
     enum CITY_SUBMENU_STATE { EXPANDED, COLLAPSED, EXPANDING, COLLAPSING };
@@ -28,10 +31,19 @@ public:
     void collapse();
 
     void addCity(const CityModelItem &city);
-    QVector<IItemWidget *> selectableWidgets();
-    QVector<ItemWidgetCity *> cityWidgets();
+    int cityCount() const;
+
+    // cityIndex -1 for the region header, the city widget is created if it doesn't exist
+    IItemWidget *itemWidget(int cityIndex);
+    bool containsItemWidget(IItemWidget *itemWidget) const;
+
+    // creates the city widgets intersecting with [top, bottom] (in the region coordinates)
+    // and deletes the rest of them, except keepWidget (the accented item of the list)
+    void updateVisibleCities(int top, int bottom, IItemWidget *keepWidget);
 
     void setFavorited(LocationID id, bool isFavorite);
+    void setLatencyMs(LocationID id, PingTime pingTime);
+    void setShowLatencyMs(bool showLatencyMs);
 
     void recalcItemPositions();
     void recalcHeight();
@@ -44,6 +56,7 @@ signals:
     void clicked(ItemWidgetCity *cityWidget);
     void clicked(ItemWidgetRegion *regionWidget);
     void favoriteClicked(ItemWidgetCity *cityWidget, bool favorited);
+    void itemWidgetDeleted(IItemWidget *itemWidget);
 
 private slots:
     void onRegionHeaderAccented();
@@ -56,7 +69,8 @@ private slots:
 
 private:
     ItemWidgetHeader *regionHeaderWidget_;
-    QVector<ItemWidgetCity *> cities_;
+    QVector<CityModelItem> cityItems_;
+    QVector<ItemWidgetCity *> cities_;  // the same size as cityItems_, nullptr for the cities out of the viewport
     IWidgetLocationsInfo *widgetLocationsInfo_;
 
     bool muteAccentChanges_;
@@ -65,6 +79,10 @@ private:
     QVariantAnimation expandingHeightAnimation_;
     int height_;
     int expandedHeight();
+
+    ItemWidgetCity *createCityWidget(int cityIndex);
+    void deleteCityWidget(int cityIndex);
+    void updateCityGeometry(int cityIndex);
 };
 
 }
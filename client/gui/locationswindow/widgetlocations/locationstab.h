@@ -76,6 +76,7 @@ signals:
     void addStaticIpClicked();
     void clearCustomConfigClicked();
     void addCustomConfigClicked();
+    void countryAccented(const QString &countryCode);
 
 private slots:
     void onWhiteLinePosChanged(const QVariant &value);
@@ -8,6 +8,7 @@
 #include "widgetlocationssizes.h"
 #include "graphicresources/fontmanager.h"
 #include "commongraphics/commongraphics.h"
+#include "idlemodecontroller.h"
 
 // #include <QDebug>
 
@@ -24,6 +25,7 @@ ScrollBar::ScrollBar(QWidget *parent) : QScrollBar(parent)
 {
     scrollTimer_.setInterval(1);
     connect(&scrollTimer_, SIGNAL(timeout()), SLOT(onScollTimerTick()));
+    IdleModeController::instance().addAnimationTimer(&scrollTimer_);
     setStyleSheet(customStyleSheet());
 
     opacityAnimation_.setDuration(250);
@@ -107,6 +107,8 @@ void WidgetCities::setModel(BasicCitiesModel *citiesModel)
     citiesModel_ = citiesModel;
     connect(citiesModel_, SIGNAL(itemsUpdated(QVector<CityModelItem*>)),
                            SLOT(onItemsUpdated(QVector<CityModelItem*>)), Qt::DirectConnection);
+    connect(citiesModel_, SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)),
+                           SLOT(onItemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), Qt::DirectConnection);
     connect(citiesModel_, SIGNAL(connectionSpeedChanged(LocationID, PingTime)), SLOT(onConnectionSpeedChanged(LocationID, PingTime)), Qt::DirectConnection);
     connect(citiesModel_, SIGNAL(isFavoriteChanged(LocationID, bool)), SLOT(onIsFavoriteChanged(LocationID, bool)), Qt::DirectConnection);
 }
@@ -523,6 +525,27 @@ void WidgetCities::onItemsUpdated(QVector<CityModelItem *> items)
     update();
 }
 
+void WidgetCities::onItemsChanged(QVector<CityModelItem *> items, const LocationsModelDiff &diff)
+{
+    if (!diff.isOnlyChanged())
+    {
+        onItemsUpdated(items);
+        return;
+    }
+
+    // the same cities in the same order, only the changed widgets are recreated
+    LocationID lastAccentedLocationId = widgetCitiesList_->lastAccentedLocationId();
+    for (const CityModelItem *item : qAsConst(items))
+    {
+        if (diff.changed.contains(item->id))
+        {
+            widgetCitiesList_->updateCity(*item);
+        }
+    }
+    widgetCitiesList_->accentItem(lastAccentedLocationId);
+    update();
+}
+
 void WidgetCities::onConnectionSpeedChanged(LocationID id, PingTime timeMs)
 {
     const auto widgetList = widgetCitiesList_->itemWidgets();
@@ -636,12 +659,7 @@ void WidgetCities::updateWidgetList(QVector<CityModelItem *> items)
     LocationID lastAccentedLocationId = widgetCitiesList_->lastAccentedLocationId();
 
     // qCDebug(LOG_LOCATION_LIST) << name_ << " caching previous display state";
-    widgetCitiesList_->clearWidgets();
-    for (auto *item : qAsConst(items))
-    {
-        const auto &itemRef = *item;
-        widgetCitiesList_->addCity(itemRef);
-    }
+    widgetCitiesList_->setCities(items);
 
     // qCDebug(LOG_LOCATION_LIST) << name_ << " restoring display state";
 
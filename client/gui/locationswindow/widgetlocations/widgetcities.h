@@ -72,6 +72,7 @@ signals:
 
 private slots:
     void onItemsUpdated(QVector<CityModelItem*> items);
+    void onItemsChanged(QVector<CityModelItem*> items, const LocationsModelDiff &diff);
     void onConnectionSpeedChanged(LocationID id, PingTime timeMs);
     void onIsFavoriteChanged(LocationID id, bool isFavorite);
     void onFreeSessionStatusChanged(bool isFreeSessionStatus);
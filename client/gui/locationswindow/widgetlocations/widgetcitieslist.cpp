@@ -36,22 +36,44 @@ void WidgetCitiesList::clearWidgets()
         regionWidget->deleteLater();
     }
     itemWidgets_.clear();
+    itemIndexes_.clear();
 }
 
-void WidgetCitiesList::addCity(const CityModelItem &city)
+void WidgetCitiesList::setCities(const QVector<CityModelItem *> &cities)
 {
-    auto cityWidget = new ItemWidgetCity(widgetLocationsInfo_, city, this);
-    connect(cityWidget, SIGNAL(clicked()), SLOT(onCityItemClicked()));
-    connect(cityWidget, SIGNAL(accented()), SLOT(onCityItemAccented()));
-    connect(cityWidget, SIGNAL(hoverEnter()), SLOT(onCityItemHoverEnter()));
-    connect(cityWidget, SIGNAL(favoriteClicked(ItemWidgetCity *, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*, bool)));
-    cityWidget->setSelectable(true);
-    cityWidget->show();
-    itemWidgets_.push_back(cityWidget);
+    clearWidgets();
+    itemWidgets_.reserve(cities.count());
+    itemIndexes_.reserve(cities.count());
+    for (const CityModelItem *city : cities)
+    {
+        itemIndexes_.insert(city->id, itemWidgets_.count());
+        itemWidgets_.push_back(createCityWidget(*city));
+    }
+    recalcItemPositions();
+}
 
-    // qDebug() << "Added: " << cityWidget->name();
+void WidgetCitiesList::updateCity(const CityModelItem &city)
+{
+    const int i = itemIndexes_.value(city.id, -1);
+    if (i < 0)
+    {
+        return;
+    }
 
-    recalcItemPositions();
+    ItemWidgetCity *oldWidget = itemWidgets_[i];
+    // the accent is restored by the caller with accentItem()
+    if (lastAccentedItemWidget_ == oldWidget)
+    {
+        lastAccentedItemWidget_ = nullptr;
+    }
+    recentlyAccentedWidgets_.removeAll(oldWidget);
+    const QRect geometry = oldWidget->geometry();
+    oldWidget->disconnect();
+    oldWidget->deleteLater();
+
+    // the same height, the other widgets stay in place
+    itemWidgets_[i] = createCityWidget(city);
+    itemWidgets_[i]->setGeometry(geometry);
 }
 
 void WidgetCitiesList::updateScaling()
@@ -101,16 +123,7 @@ QVector<ItemWidgetCity *> WidgetCitiesList::itemWidgets()
 
 int WidgetCitiesList::selectableIndex(LocationID locationId)
 {
-    int i = 0;
-    for (const auto *widget : qAsConst(itemWidgets_))
-    {
-        if (widget->getId() == locationId)
-        {
-            return i;
-        }
-        i++;
-    }
-    return -1;
+    return itemIndexes_.value(locationId, -1);
 }
 
 const LocationID WidgetCitiesList::lastAccentedLocationId() const
@@ -124,13 +137,10 @@ const LocationID WidgetCitiesList::lastAccentedLocationId() const
 
 void WidgetCitiesList::accentItem(LocationID locationId)
 {
-    for (auto *widget : qAsConst(itemWidgets_))
+    const int i = itemIndexes_.value(locationId, -1);
+    if (i >= 0)
     {
-        if (widget->getId() == locationId)
-        {
-            widget->setAccented(true);
-            break;
-        }
+        itemWidgets_[i]->setAccented(true);
     }
 }
 
@@ -149,41 +159,20 @@ bool WidgetCitiesList::hasAccentItem()
 
 void WidgetCitiesList::moveAccentUp()
 {
-    IItemWidget *lastWidget = nullptr;
-    IItemWidget *currentWidget =  nullptr;
-    for (auto *widget : qAsConst(itemWidgets_))
-    {
-        lastWidget = currentWidget;
-        currentWidget = widget;
-
-        if (widget->isAccented())
-        {
-            break;
-        }
-    }
-
-    if (lastWidget != nullptr)
+    const int ind = accentItemIndex();
+    if (ind > 0)
     {
         // qDebug() << "Selection by moveAccentUp";
-        lastWidget->setAccented(true);
+        itemWidgets_[ind - 1]->setAccented(true);
     }
 }
 
 void WidgetCitiesList::moveAccentDown()
 {
-    QVectorIterator<ItemWidgetCity *> it(itemWidgets_);
-    while (it.hasNext())
+    const int ind = accentItemIndex();
+    if (ind >= 0 && ind < itemWidgets_.count() - 1)
     {
-        if (it.next()->isAccented())
-        {
-            break;
-        }
-    }
-
-    if (it.hasNext())
-    {
-        auto widget = it.next();
-        widget->setAccented(true);
+        itemWidgets_[ind + 1]->setAccented(true);
     }
 }
 
@@ -209,14 +198,8 @@ IItemWidget *WidgetCitiesList::lastAccentedItemWidget()
 
 IItemWidget *WidgetCitiesList::selectableWidget(LocationID locationId)
 {
-    for (auto *widget : qAsConst(itemWidgets_))
-    {
-        if (widget->getId() == locationId)
-        {
-            return widget;
-        }
-    }
-    return nullptr;
+    const int i = itemIndexes_.value(locationId, -1);
+    return i >= 0 ? itemWidgets_[i] : nullptr;
 }
 
 void WidgetCitiesList::onCityItemAccented()
@@ -258,6 +241,18 @@ void WidgetCitiesList::onCityItemHoverEnter()
     }
 }
 
+ItemWidgetCity *WidgetCitiesList::createCityWidget(const CityModelItem &city)
+{
+    auto cityWidget = new ItemWidgetCity(widgetLocationsInfo_, city, this);
+    connect(cityWidget, SIGNAL(clicked()), SLOT(onCityItemClicked()));
+    connect(cityWidget, SIGNAL(accented()), SLOT(onCityItemAccented()));
+    connect(cityWidget, SIGNAL(hoverEnter()), SLOT(onCityItemHoverEnter()));
+    connect(cityWidget, SIGNAL(favoriteClicked(ItemWidgetCity *, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*, bool)));
+    cityWidget->setSelectable(true);
+    cityWidget->show();
+    return cityWidget;
+}
+
 void WidgetCitiesList::recalcItemPositions()
 {
     // qDebug() << "City List recalc";
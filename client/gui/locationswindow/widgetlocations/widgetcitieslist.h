@@ -1,6 +1,7 @@
 #ifndef CITYITEMLISTWIDGET_H
 #define CITYITEMLISTWIDGET_H
 
+#include <QHash>
 #include <QWidget>
 #include "cursorupdatehelper.h"
 #include "itemwidgetcity.h"
@@ -15,7 +16,10 @@ public:
     ~WidgetCitiesList();
 
     void clearWidgets();
-    void addCity(const CityModelItem &city);
+    // replaces the widgets, the positions are calculated once for the whole list
+    void setCities(const QVector<CityModelItem *> &cities);
+    // recreates the widget of the city with the same id, keeping its position
+    void updateCity(const CityModelItem &city);
 
     void updateScaling();
     void accentWidgetContainingCursor();
@@ -51,12 +55,14 @@ private:
     int height_;
     std::unique_ptr<CursorUpdateHelper> cursorUpdateHelper_;
     QVector<ItemWidgetCity *> itemWidgets_;
+    QHash<LocationID, int> itemIndexes_;    // into itemWidgets_, for the lookups and the keyboard navigation
     IItemWidget *lastAccentedItemWidget_;
     QVector<IItemWidget *> recentlyAccentedWidgets_;
 
     IWidgetLocationsInfo *widgetLocationsInfo_; // deleted elsewhere
 
     bool muteAccentChanges_;
+    ItemWidgetCity *createCityWidget(const CityModelItem &city);
     void recalcItemPositions();
     void updateCursorWithWidget(IItemWidget *widget);
     void safeEmitLocationIdSelected(IItemWidget *widget);
@@ -72,7 +72,8 @@ WidgetLocations::WidgetLocations(QWidget *parent, const QString name) : QScrollA
     connect(widgetLocationsList_, SIGNAL(heightChanged(int)), SLOT(onLocationItemListWidgetHeightChanged(int)));
     connect(widgetLocationsList_, SIGNAL(favoriteClicked(ItemWidgetCity*,bool)), SLOT(onLocationItemListWidgetFavoriteClicked(ItemWidgetCity *, bool)));
     connect(widgetLocationsList_, SIGNAL(locationIdSelected(LocationID)), SLOT(onLocationItemListWidgetLocationIdSelected(LocationID)));
-    connect(widgetLocationsList_, SIGNAL(regionExpanding(ItemWidgetRegion*)), SLOT(onLocationItemListWidgetRegionExpanding(ItemWidgetRegion*)));
+    connect(widgetLocationsList_, SIGNAL(regionExpanding(LocationID)), SLOT(onLocationItemListWidgetRegionExpanding(LocationID)));
+    connect(widgetLocationsList_, SIGNAL(countryAccented(QString)), SIGNAL(countryAccented(QString)));
     widgetLocationsList_->setGeometry(0,0, WINDOW_WIDTH*G_SCALE - getScrollBarWidth(), 0);
     widgetLocationsList_->show();
 
@@ -101,6 +102,8 @@ void WidgetLocations::setModel(BasicLocationsModel *locationsModel)
     locationsModel_ = locationsModel;
     connect(locationsModel_, SIGNAL(itemsUpdated(QVector<LocationModelItem*>)),
                            SLOT(onItemsUpdated(QVector<LocationModelItem*>)), Qt::DirectConnection);
+    connect(locationsModel_, SIGNAL(itemsChanged(QVector<LocationModelItem*>, LocationsModelDiff)),
+                           SLOT(onItemsChanged(QVector<LocationModelItem*>, LocationsModelDiff)), Qt::DirectConnection);
     connect(locationsModel_, SIGNAL(connectionSpeedChanged(LocationID, PingTime)), SLOT(onConnectionSpeedChanged(LocationID, PingTime)), Qt::DirectConnection);
     connect(locationsModel_, SIGNAL(isFavoriteChanged(LocationID, bool)), SLOT(onIsFavoriteChanged(LocationID, bool)), Qt::DirectConnection);
     connect(locationsModel, SIGNAL(freeSessionStatusChanged(bool)), SLOT(onFreeSessionStatusChanged(bool)));
@@ -109,7 +112,7 @@ void WidgetLocations::setModel(BasicLocationsModel *locationsModel)
 void WidgetLocations::setFilterString(QString text)
 {
     filterString_ = text;
-    updateWidgetList(locationsModel_->items());
+    updateWidgetList(true);
 
     if (filterString_.isEmpty())
     {
@@ -224,11 +227,7 @@ bool WidgetLocations::isShowLatencyInMs()
 void WidgetLocations::setShowLatencyInMs(bool showLatencyInMs)
 {
     bShowLatencyInMs_ = showLatencyInMs;
-    const auto widgetList = widgetLocationsList_->cityWidgets();
-    for (auto *w : widgetList)
-    {
-        w->setShowLatencyMs(showLatencyInMs);
-    }
+    widgetLocationsList_->setShowLatencyMs(showLatencyInMs);
 }
 
 bool WidgetLocations::isShowLocationLoad()
@@ -370,7 +369,7 @@ void WidgetLocations::handleKeyEvent(QKeyEvent *event)
     {
         if (widgetLocationsList_->hasAccentItem())
         {
-            if (widgetLocationsList_->accentItemSelectableIndex() < widgetLocationsList_->selectableWidgets().count() - 1)
+            if (widgetLocationsList_->accentItemSelectableIndex() < widgetLocationsList_->selectableCount() - 1)
             {
                 if (accentItemViewportIndex() >= countOfAvailableItemSlots_ - 1)
                 {
@@ -433,8 +432,7 @@ void WidgetLocations::handleKeyEvent(QKeyEvent *event)
             {
                 LocationID locId = widgetLocationsList_->lastAccentedLocationId();
                 widgetLocationsList_->expand(locId);
-                ItemWidgetRegion *widget = widgetLocationsList_->regionWidget(locId);
-                regionExpandingAnimation(widget);
+                regionExpandingAnimation(locId);
             }
         }
         else // city
@@ -459,12 +457,15 @@ int WidgetLocations::gestureScrollingElapsedTime()
 
 void WidgetLocations::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event)
-
-    // draw background for when list is < size of viewport
+    // draw background for when list is < size of viewport, only the exposed part
     QPainter painter(viewport());
-    QRect bkgd(0,0,geometry().width(), geometry().height());
-    painter.fillRect(bkgd, FontManager::instance().getMidnightColor());
+    painter.fillRect(event->rect(), FontManager::instance().getMidnightColor());
+}
+
+void WidgetLocations::resizeEvent(QResizeEvent *event)
+{
+    QScrollArea::resizeEvent(event);
+    widgetLocationsList_->updateVisibleRows();
 }
 
 // called by change in the vertical scrollbar
@@ -508,36 +509,28 @@ void WidgetLocations::mouseDoubleClickEvent(QMouseEvent *event)
 
 void WidgetLocations::onItemsUpdated(QVector<LocationModelItem *> items)
 {
+    Q_UNUSED(items)
     //qCDebug(LOG_LOCATION_LIST) << "Items updated: " << name_;
-    updateWidgetList(items);
+    updateWidgetList(false);
+}
+
+void WidgetLocations::onItemsChanged(QVector<LocationModelItem *> items, const LocationsModelDiff &diff)
+{
+    Q_UNUSED(items)
+    // only the widgets of the changed regions are recreated, the inserted/removed/moved ones are merged by id
+    updateWidgetList(true, diff.changed);
 }
 
 void WidgetLocations::onConnectionSpeedChanged(LocationID id, PingTime timeMs)
 {
     // qCDebug(LOG_LOCATION_LIST) << "Search widget speed change";
-    const auto widgetList = widgetLocationsList_->cityWidgets();
-    for (auto *w : widgetList)
-    {
-        if (w->getId() == id)
-        {
-            w->setLatencyMs(timeMs);
-            break;
-        }
-    }
+    widgetLocationsList_->setLatencyMs(id, timeMs);
 }
 
 void WidgetLocations::onIsFavoriteChanged(LocationID id, bool isFavorite)
 {
     // qDebug() << "SearchWidget setting";
-    const auto widgetList = widgetLocationsList_->itemWidgets();
-    for (auto *region : widgetList)
-    {
-        if (region->getId().toTopLevelLocation() == id.toTopLevelLocation())
-        {
-            region->setFavorited(id, isFavorite);
-            break;
-        }
-    }
+    widgetLocationsList_->setFavorited(id, isFavorite);
 }
 
 void WidgetLocations::onFreeSessionStatusChanged(bool isFreeSessionStatus)
@@ -578,7 +571,7 @@ void WidgetLocations::onLocationItemListWidgetLocationIdSelected(LocationID id)
     }
 }
 
-void WidgetLocations::onLocationItemListWidgetRegionExpanding(ItemWidgetRegion *region)
+void WidgetLocations::onLocationItemListWidgetRegionExpanding(LocationID region)
 {
     int regionVI = regionViewportIndex(region);
     int diff = regionOutOfViewBy(region);
@@ -596,9 +589,9 @@ void WidgetLocations::onScrollAnimationValueChanged(const QVariant &value)
 {
     // qDebug() << "ScrollAnimation: " << value.toInt();
 
+    // the moved list is scrolled by Qt, only the uncovered strip of the viewport is repainted
     widgetLocationsList_->move(0, value.toInt());
     lastScrollPos_ = widgetLocationsList_->geometry().y();
-    viewport()->update();
 }
 
 void WidgetLocations::onScrollAnimationFinished()
@@ -616,8 +609,6 @@ void WidgetLocations::onScrollAnimationForKeyPressValueChanged(const QVariant &v
 
     widgetLocationsList_->move(0, value.toInt());
     lastScrollPos_ = widgetLocationsList_->geometry().y();
-    viewport()->update();
-
 }
 
 void WidgetLocations::onScrollAnimationForKeyPressFinished()
@@ -649,7 +640,7 @@ void WidgetLocations::onScrollBarStopScroll(bool lastScrollDirectionUp)
     }
 }
 
-void WidgetLocations::updateWidgetList(QVector<LocationModelItem *> items)
+void WidgetLocations::updateWidgetList(bool keepUnchangedWidgets, const QVector<LocationID> &changedIds)
 {
     // qCDebug(LOG_LOCATION_LIST) << name_ << " updating locations widget list";
 
@@ -658,32 +649,8 @@ void WidgetLocations::updateWidgetList(QVector<LocationModelItem *> items)
     LocationID topSelectableLocationIdInViewport = topViewportSelectableLocationId();
     LocationID lastAccentedLocationId = widgetLocationsList_->lastAccentedLocationId();
 
-    //qCDebug(LOG_LOCATION_LIST) << name_ << " caching previous display state ";
-    widgetLocationsList_->clearWidgets();
-    for (LocationModelItem *item: qAsConst(items))
-    {
-        if (item->title.contains(filterString_, Qt::CaseInsensitive))
-        {
-            // add item and all children to list
-            widgetLocationsList_->addRegionWidget(item);
-
-            for (const CityModelItem &cityItem: qAsConst(item->cities))
-            {
-                widgetLocationsList_->addCityToRegion(cityItem, item);
-            }
-        }
-        else
-        {
-            for (const CityModelItem &cityItem: qAsConst(item->cities))
-            {
-                if (cityItem.city.contains(filterString_, Qt::CaseInsensitive) ||
-                    cityItem.nick.contains(filterString_, Qt::CaseInsensitive))
-                {
-                    widgetLocationsList_->addCityToRegion(cityItem, item);
-                }
-            }
-        }
-    }
+    // on the filter change or a keyed model update the widgets of the unchanged regions are kept
+    widgetLocationsList_->setItems(locationsModel_->filteredItems(filterString_), keepUnchangedWidgets, changedIds);
     // qCDebug(LOG_LOCATION_LIST) << name_ << " restoring display state";
 
     // restoring previous widget state
@@ -814,14 +781,13 @@ const LocationID WidgetLocations::topViewportSelectableLocationId()
 {
     int index = viewportOffsetIndex();
 
-    auto widgets = widgetLocationsList_->selectableWidgets();
-    if (index < 0 || index > widgets.count() - 1)
+    if (index < 0 || index > widgetLocationsList_->selectableCount() - 1)
     {
         // qDebug(LOG_BASIC) << "Err: Can't index selectable items with: " << index;
         return LocationID();
     }
 
-    return widgets[index]->getId();
+    return widgetLocationsList_->selectableLocationId(index);
 }
 
 int WidgetLocations::viewportOffsetIndex()
@@ -872,18 +838,18 @@ QRect WidgetLocations::globalLocationsListViewportRect()
                  viewport()->geometry().width(), viewport()->geometry().height());
 }
 
-int WidgetLocations::regionViewportIndex(ItemWidgetRegion *region)
+int WidgetLocations::regionViewportIndex(LocationID region)
 {
     int topItemSelIndex = widgetLocationsList_->selectableIndex(topViewportSelectableLocationId());
-    int regionSelIndex = widgetLocationsList_->selectableIndex(region->getId());
+    int regionSelIndex = widgetLocationsList_->selectableIndex(region);
     return regionSelIndex - topItemSelIndex;
 }
 
-int WidgetLocations::regionOutOfViewBy(ItemWidgetRegion *region)
+int WidgetLocations::regionOutOfViewBy(LocationID region)
 {
     // qDebug() << "Checking for need to scroll due to expand";
     int rvi = regionViewportIndex(region);
-    int bottomCityViewportIndex  = rvi + region->cityWidgets().count();
+    int bottomCityViewportIndex  = rvi + widgetLocationsList_->cityCount(region);
     return bottomCityViewportIndex - countOfAvailableItemSlots_;
 }
 
@@ -938,7 +904,7 @@ int WidgetLocations::previousPositionIncrement(int value)
     return last;
 }
 
-void WidgetLocations::regionExpandingAnimation(ItemWidgetRegion *region)
+void WidgetLocations::regionExpandingAnimation(LocationID region)
 {
     int regionVI = regionViewportIndex(region);
     int diff = regionOutOfViewBy(region);
@@ -57,6 +57,7 @@ public:
 
 protected:
     virtual void paintEvent(QPaintEvent *event)            override;
+    virtual void resizeEvent(QResizeEvent *event)          override;
     virtual void scrollContentsBy(int dx, int dy)          override;
     virtual void mousePressEvent(QMouseEvent *event)       override;
     virtual void mouseDoubleClickEvent(QMouseEvent *event) override;
@@ -65,9 +66,11 @@ signals:
     void selected(LocationID id);
     void clickedOnPremiumStarCity();
     void switchFavorite(LocationID id, bool isFavorite);
+    void countryAccented(const QString &countryCode);
 
 private slots:
     void onItemsUpdated(QVector<LocationModelItem*> items);
+    void onItemsChanged(QVector<LocationModelItem*> items, const LocationsModelDiff &diff);
     void onConnectionSpeedChanged(LocationID id, PingTime timeMs);
     void onIsFavoriteChanged(LocationID id, bool isFavorite);
     void onFreeSessionStatusChanged(bool isFreeSessionStatus);
@@ -77,7 +80,7 @@ private slots:
     void onLocationItemListWidgetHeightChanged(int listWidgetHeight);
     void onLocationItemListWidgetFavoriteClicked(ItemWidgetCity *cityWidget, bool favorited);
     void onLocationItemListWidgetLocationIdSelected(LocationID id);
-    void onLocationItemListWidgetRegionExpanding(ItemWidgetRegion *region);
+    void onLocationItemListWidgetRegionExpanding(LocationID region);
 
     void onScrollAnimationValueChanged(const QVariant &value);
     void onScrollAnimationFinished();
@@ -111,7 +114,7 @@ private:
 
     bool showLocationLoad_;
 
-    void updateWidgetList(QVector<LocationModelItem *> items);
+    void updateWidgetList(bool keepUnchangedWidgets, const QVector<LocationID> &changedIds = QVector<LocationID>());
 
     // scrolling
     void scrollToIndex(int index);
@@ -133,8 +136,8 @@ private:
     bool locationIdInViewport(LocationID location);
     bool isGlobalPointInViewport(const QPoint &pt);
     QRect globalLocationsListViewportRect();
-    int regionViewportIndex(ItemWidgetRegion *region);
-    int regionOutOfViewBy(ItemWidgetRegion *region);
+    int regionViewportIndex(LocationID region);
+    int regionOutOfViewBy(LocationID region);
 
     // helper
     int getScrollBarWidth();
@@ -144,7 +147,7 @@ private:
     int previousPositionIncrement(int value);
 
     bool heightChanging_;
-    void regionExpandingAnimation(ItemWidgetRegion *region);
+    void regionExpandingAnimation(LocationID region);
 
 
 };
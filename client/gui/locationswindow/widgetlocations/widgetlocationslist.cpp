@@ -1,5 +1,6 @@
 #include "widgetlocationslist.h"
 
+#include <QHash>
 #include <QPainter>
 #include <QtMath>
 #include "commongraphics/commongraphics.h"
@@ -12,6 +13,8 @@ namespace GuiLocations {
 
 WidgetLocationsList::WidgetLocationsList(IWidgetLocationsInfo * widgetLocationsInfo, QWidget *parent) : QWidget(parent)
   , height_(0)
+  , isSelectableRowsValid_(false)
+  , muteAccentChanges_(false)
   , lastAccentedItemWidget_(nullptr)
   , widgetLocationsInfo_(widgetLocationsInfo)
 {
@@ -23,47 +26,83 @@ WidgetLocationsList::WidgetLocationsList(IWidgetLocationsInfo * widgetLocationsI
 WidgetLocationsList::~WidgetLocationsList()
 {
     // qDebug() << "Deleting list object";
-    clearWidgets();
+    clearItems();
 }
 
-void WidgetLocationsList::clearWidgets()
+void WidgetLocationsList::clearItems()
 {
     lastAccentedItemWidget_ = nullptr;
     recentlyAccentedWidgets_.clear();
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    for (RegionRow &region : regions_)
     {
-        regionWidget->disconnect();
-        regionWidget->deleteLater();
+        if (region.widget)
+        {
+            deleteRegionWidget(region.widget);
+            region.widget = nullptr;
+        }
     }
-    itemWidgets_.clear();
+    regions_.clear();
+    regionIndexes_.clear();
+    isSelectableRowsValid_ = false;
 }
 
-void WidgetLocationsList::addRegionWidget(LocationModelItem *item)
+void WidgetLocationsList::setItems(const QVector<LocationModelItem> &items, bool keepUnchangedWidgets,
+                                   const QVector<LocationID> &changedIds)
 {
-    auto regionWidget = new ItemWidgetRegion(widgetLocationsInfo_, item, this);
-    connect(regionWidget, SIGNAL(heightChanged(int)), SLOT(onRegionWidgetHeightChanged(int)));
-    connect(regionWidget, SIGNAL(clicked(ItemWidgetCity *)), SLOT(onLocationItemCityClicked(ItemWidgetCity *)));
-    connect(regionWidget, SIGNAL(clicked(ItemWidgetRegion *)), SLOT(onLocationItemRegionClicked(ItemWidgetRegion *)));
-    connect(regionWidget, SIGNAL(accented(IItemWidget *)), SLOT(onSelectableLocationItemAccented(IItemWidget *)));
-    connect(regionWidget, SIGNAL(favoriteClicked(ItemWidgetCity*, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*,bool)));
-    itemWidgets_.append(regionWidget);
-    regionWidget->setGeometry(0, 0, static_cast<int>(WINDOW_WIDTH *G_SCALE), static_cast<int>(qCeil(LOCATION_ITEM_HEIGHT * G_SCALE)));
-    regionWidget->show();
-    recalcItemPositions();
-}
+    QVector<RegionRow> oldRegions;
+    oldRegions.swap(regions_);
 
-void WidgetLocationsList::addCityToRegion(const CityModelItem &city, LocationModelItem *region)
-{
-    auto matchingId = [&](ItemWidgetRegion  *regionWidget){
-        return regionWidget->getId() == region->id;
-    };
+    // the regions can be moved by the model update (e.g. sorted by latency), so the old ones are looked up by id
+    QHash<LocationID, int> oldIndexes;
+    if (keepUnchangedWidgets)
+    {
+        oldIndexes.reserve(oldRegions.count());
+        for (int i = 0; i < oldRegions.count(); ++i)
+        {
+            oldIndexes.insert(oldRegions[i].item.id, i);
+        }
+    }
 
-    if (!(std::find_if(itemWidgets_.begin(), itemWidgets_.end(), matchingId) != itemWidgets_.end()))
+    regionIndexes_.clear();
+    regionIndexes_.reserve(items.count());
+    regions_.reserve(items.count());
+    for (const LocationModelItem &item : items)
     {
-        addRegionWidget(region);
+        RegionRow region;
+        region.item = item;
+        const int oldInd = oldIndexes.value(item.id, -1);
+        if (oldInd >= 0)
+        {
+            RegionRow &oldRegion = oldRegions[oldInd];
+            region.expanded = oldRegion.expanded;
+            if (oldRegion.widget && !changedIds.contains(item.id) && isSameCities(oldRegion.item, item))
+            {
+                region.widget = oldRegion.widget;
+                region.height = oldRegion.height;
+                oldRegion.widget = nullptr;
+            }
+        }
+        if (!region.widget)
+        {
+            region.height = regionTargetHeight(region);
+        }
+        if (!regionIndexes_.contains(item.id))
+        {
+            regionIndexes_.insert(item.id, regions_.count());
+        }
+        regions_ << region;
+    }
+
+    for (RegionRow &oldRegion : oldRegions)
+    {
+        if (oldRegion.widget)
+        {
+            deleteRegionWidget(oldRegion.widget);
+            oldRegion.widget = nullptr;
+        }
     }
-    itemWidgets_.last()->addCity(city);
 
+    isSelectableRowsValid_ = false;
     recalcItemPositions();
 }
 
@@ -71,146 +110,230 @@ void WidgetLocationsList::updateScaling()
 {
     // update scaling for each widget instead of recalcItemPositions
     // relying on resizeEvent after setGeometry on region items blocks expanding animation for some reason
-    // this will trigger recalcItemPositions() anyway
-    for (auto *itemWidget : qAsConst(itemWidgets_))
+    for (RegionRow &region : regions_)
     {
-        itemWidget->updateScaling();
+        region.height = regionTargetHeight(region);
+        if (region.widget)
+        {
+            region.widget->updateScaling();
+        }
     }
+    recalcItemPositions();
 }
 
-void WidgetLocationsList::accentWidgetContainingCursor()
+void WidgetLocationsList::updateVisibleRows()
 {
-    const auto widgets = selectableWidgets();
-    for (auto *selectableWidget : widgets)
+    if (!parentWidget())
     {
-        if (selectableWidget->containsCursor())
+        return;
+    }
+
+    const int overscan = OVERSCAN_ROWS * qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
+    const int top = -geometry().y() - overscan;
+    const int bottom = -geometry().y() + parentWidget()->height() + overscan;
+
+    for (int i = 0; i < regions_.count(); ++i)
+    {
+        RegionRow &region = regions_[i];
+        const bool isVisible = region.top <= bottom && region.top + region.height > top;
+        if (isVisible && !region.widget)
         {
-            // qDebug() << "Selecting by containing cursor";
-            selectableWidget->setAccented(true);
-            updateCursorWithSelectableWidget(selectableWidget);
-            break;
+            createRegionWidget(i);
+        }
+        else if (!isVisible && region.widget &&
+                 !(lastAccentedItemWidget_ && region.widget->containsItemWidget(lastAccentedItemWidget_)))
+        {
+            deleteRegionWidget(region.widget);
+            region.widget = nullptr;
+        }
+
+        if (region.widget)
+        {
+            region.widget->updateVisibleCities(top - region.top, bottom - region.top, lastAccentedItemWidget_);
         }
     }
 }
 
+void WidgetLocationsList::accentWidgetContainingCursor()
+{
+    IItemWidget *selectableWidget = widgetAtGlobalPt(QCursor::pos());
+    if (selectableWidget)
+    {
+        // qDebug() << "Selecting by containing cursor";
+        selectableWidget->setAccented(true);
+        updateCursorWithSelectableWidget(selectableWidget);
+    }
+}
+
 void WidgetLocationsList::selectWidgetContainingGlobalPt(const QPoint &pt)
 {
-    const auto widgets = selectableWidgets();
-    for (auto *selectableWidget : widgets)
+    IItemWidget *selectableWidget = widgetAtGlobalPt(pt);
+    if (selectableWidget)
     {
-        if (selectableWidget->containsGlobalPoint(pt))
-        {
-            //qDebug() << "Selecting: " << selectableWidget->name();
-            selectableWidget->setAccented(true);
-            safeEmitLocationIdSelected(selectableWidget);
-            break;
-        }
+        //qDebug() << "Selecting: " << selectableWidget->name();
+        selectableWidget->setAccented(true);
+        safeEmitLocationIdSelected(selectableWidget);
     }
 }
 
 void WidgetLocationsList::expand(LocationID locId)
 {
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    const int ind = regionIndex(locId);
+    if (ind >= 0)
     {
-        if (regionWidget->getId() == locId)
-        {
-            regionWidget->expand();
-        }
+        setRegionExpanded(ind, true, true);
     }
 }
 
 void WidgetLocationsList::collapse(LocationID locId)
 {
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    const int ind = regionIndex(locId);
+    if (ind >= 0)
     {
-        if (regionWidget->getId() == locId)
-        {
-            regionWidget->collapse();
-        }
+        setRegionExpanded(ind, false, true);
     }
 }
 
 void WidgetLocationsList::expandAllLocationsWithoutAnimation()
 {
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    for (int i = 0; i < regions_.count(); ++i)
     {
-        if (regionWidget->expandable())
+        if (regions_[i].item.cities.count() > 0)
         {
-            regionWidget->setExpandedWithoutAnimation(true);
+            setRegionExpanded(i, true, false);
         }
     }
+    recalcItemPositions();
 }
 
 void WidgetLocationsList::collapseAllLocationsWithoutAnimation()
 {
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    for (int i = 0; i < regions_.count(); ++i)
     {
-        regionWidget->setExpandedWithoutAnimation(false);
+        setRegionExpanded(i, false, false);
     }
+    recalcItemPositions();
 }
 
 void WidgetLocationsList::expandLocationIds(QVector<LocationID> locIds)
 {
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    for (const LocationID locId : qAsConst(locIds))
     {
-        for (const LocationID locId : qAsConst(locIds))
+        const int ind = regionIndex(locId);
+        if (ind >= 0)
         {
-            if (regionWidget->getId() == locId)
-            {
-                regionWidget->setExpandedWithoutAnimation(true);
-            }
+            setRegionExpanded(ind, true, false);
         }
     }
+    recalcItemPositions();
 }
 
 QVector<LocationID> WidgetLocationsList::expandedOrExpandingLocationIds()
 {
     QVector<LocationID> expanded;
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    for (const RegionRow &region : qAsConst(regions_))
     {
-        if (regionWidget->expandedOrExpanding())
+        if (region.expanded)
         {
-            expanded.append(regionWidget->getId());
+            expanded.append(region.item.id);
         }
     }
     return expanded;
 }
 
-QVector<ItemWidgetRegion *> WidgetLocationsList::itemWidgets()
+void WidgetLocationsList::setFavorited(LocationID id, bool isFavorite)
 {
-    return itemWidgets_;
+    for (RegionRow &region : regions_)
+    {
+        if (region.item.id.toTopLevelLocation() == id.toTopLevelLocation())
+        {
+            for (CityModelItem &city : region.item.cities)
+            {
+                if (city.id == id)
+                {
+                    city.isFavorite = isFavorite;
+                }
+            }
+            if (region.widget)
+            {
+                region.widget->setFavorited(id, isFavorite);
+            }
+            break;
+        }
+    }
 }
 
-int WidgetLocationsList::selectableIndex(LocationID locationId)
+void WidgetLocationsList::setLatencyMs(LocationID id, PingTime pingTime)
+{
+    for (RegionRow &region : regions_)
+    {
+        for (CityModelItem &city : region.item.cities)
+        {
+            if (city.id == id)
+            {
+                city.pingTimeMs = pingTime;
+                if (region.widget)
+                {
+                    region.widget->setLatencyMs(id, pingTime);
+                }
+                return;
+            }
+        }
+    }
+}
+
+void WidgetLocationsList::setShowLatencyMs(bool showLatencyMs)
 {
-    int i = 0;
-    const auto widgets = selectableWidgets();
-    for (auto *widget : widgets)
+    for (const RegionRow &region : qAsConst(regions_))
     {
-        if (widget->getId() == locationId)
+        if (region.widget)
         {
-            return i;
+            region.widget->setShowLatencyMs(showLatencyMs);
         }
-        i++;
     }
-    return -1;
+}
+
+int WidgetLocationsList::selectableCount()
+{
+    return selectableRows().count();
+}
+
+LocationID WidgetLocationsList::selectableLocationId(int index)
+{
+    const QVector<SelectableRow> &rows = selectableRows();
+    if (index < 0 || index >= rows.count())
+    {
+        return LocationID();
+    }
+    return rowLocationId(rows[index]);
+}
+
+int WidgetLocationsList::selectableIndex(LocationID locationId)
+{
+    return selectableRowIndex(locationId);
+}
+
+int WidgetLocationsList::cityCount(LocationID regionId) const
+{
+    const int ind = regionIndex(regionId);
+    return ind >= 0 ? regions_[ind].item.cities.count() : 0;
 }
 
 void WidgetLocationsList::accentFirstSelectableItem()
 {
-    const auto widgets = selectableWidgets();
-    if (widgets.count() > 0)
+    const QVector<SelectableRow> &rows = selectableRows();
+    if (rows.count() > 0)
     {
-        widgets[0]->setAccented(true);
+        rowWidget(rows[0])->setAccented(true);
     }
 }
 
 void WidgetLocationsList::accentFirstSelectableItemWithoutAnimation()
 {
-    QVector<IItemWidget *> widgets = selectableWidgets();
-    if (widgets.count() > 0)
+    const QVector<SelectableRow> &rows = selectableRows();
+    if (rows.count() > 0)
     {
-        widgets[0]->setAccentedWithoutAnimation(true);
+        rowWidget(rows[0])->setAccentedWithoutAnimation(true);
     }
 }
 
@@ -221,45 +344,21 @@ bool WidgetLocationsList::hasAccentItem()
 
 void WidgetLocationsList::moveAccentUp()
 {
-    IItemWidget *lastWidget = nullptr;
-    IItemWidget *currentWidget =  nullptr;
-    const auto widgets = selectableWidgets();
-    for (auto *widget : widgets)
-    {
-        lastWidget = currentWidget;
-        currentWidget = widget;
-
-        if (widget->isAccented())
-        {
-            break;
-        }
-    }
-
-    if (lastWidget != nullptr)
+    const int ind = accentItemSelectableIndex();
+    if (ind > 0)
     {
         // qDebug() << "Selection by moveAccentUp";
-        lastWidget->setAccented(true);
+        rowWidget(selectableRows()[ind - 1])->setAccented(true);
     }
 }
 
 void WidgetLocationsList::moveAccentDown()
 {
-    auto list = selectableWidgets();
-    QVectorIterator<IItemWidget *> it(list);
-    while (it.hasNext())
-    {
-        if (it.next()->isAccented())
-        {
-            break;
-        }
-    }
-
-    if (it.hasNext())
+    const int ind = accentItemSelectableIndex();
+    if (ind >= 0 && ind < selectableRows().count() - 1)
     {
-        auto widget = it.next();
         // qDebug() << "Selection by moveAccentDown";
-
-        widget->setAccented(true);
+        rowWidget(selectableRows()[ind + 1])->setAccented(true);
     }
 }
 
@@ -289,94 +388,42 @@ const LocationID WidgetLocationsList::lastAccentedLocationId() const
 
 void WidgetLocationsList::accentItem(LocationID locationId)
 {
-    const auto widgets = selectableWidgets();
-    for (auto *widget : widgets)
+    const int ind = selectableRowIndex(locationId);
+    if (ind >= 0)
     {
-        if (widget->getId() == locationId)
-        {
-            widget->setAccented(true);
-            break;
-        }
+        rowWidget(selectableRows()[ind])->setAccented(true);
     }
 }
 
 void WidgetLocationsList::accentItemWithoutAnimation(LocationID locationId)
 {
-    const auto widgets = selectableWidgets();
-    for (auto *widget : widgets)
+    const int ind = selectableRowIndex(locationId);
+    if (ind >= 0)
     {
-        if (widget->getId() == locationId)
-        {
-            widget->setAccentedWithoutAnimation(true);
-            break;
-        }
+        rowWidget(selectableRows()[ind])->setAccentedWithoutAnimation(true);
     }
 }
 
 void WidgetLocationsList::setMuteAccentChanges(bool mute)
 {
-    for (auto *region : qAsConst(itemWidgets_))
-    {
-        region->setMuteAccentChanges(mute);
-    }
-}
-
-IItemWidget *WidgetLocationsList::selectableWidget(LocationID locationId)
-{
-    const auto widgets = selectableWidgets();
-    for (auto *widget : widgets)
-    {
-        if (widget->getId() == locationId)
-        {
-            return widget;
-        }
-    }
-    return nullptr;
-}
-
-ItemWidgetRegion *WidgetLocationsList::regionWidget(LocationID locationId)
-{
-    for (ItemWidgetRegion *regionWidget : qAsConst(itemWidgets_))
+    muteAccentChanges_ = mute;
+    for (const RegionRow &region : qAsConst(regions_))
     {
-        if (regionWidget->getId() == locationId)
+        if (region.widget)
         {
-            return regionWidget;
+            region.widget->setMuteAccentChanges(mute);
         }
     }
-    return nullptr;
 }
 
-IItemWidget *WidgetLocationsList::itemWidget(LocationID locationId)
-{
-    const auto widgets = cityWidgets();
-    for (ItemWidgetCity *w : widgets)
-    {
-        if (w->getId() == locationId)
-        {
-            return w;
-        }
-    }
-    return nullptr;
-}
-
-QVector<ItemWidgetCity *> WidgetLocationsList::cityWidgets()
-{
-    QVector<ItemWidgetCity *> cityWidgets;
-    for (auto *regionWidget : qAsConst(itemWidgets_))
-    {
-        cityWidgets.append(regionWidget->cityWidgets());
-    }
-    return cityWidgets;
-}
-
-QVector<IItemWidget *> WidgetLocationsList::selectableWidgets()
+IItemWidget *WidgetLocationsList::selectableWidget(LocationID locationId)
 {
-    QVector<IItemWidget *> selectableItemWidgets;
-    for (auto *regionWidget : qAsConst(itemWidgets_))
+    const int ind = selectableRowIndex(locationId);
+    if (ind < 0)
     {
-        selectableItemWidgets.append(regionWidget->selectableWidgets());
+        return nullptr;
     }
-    return selectableItemWidgets;
+    return rowWidget(selectableRows()[ind]);
 }
 
 void WidgetLocationsList::updateCursorWithSelectableWidget(IItemWidget *widget)
@@ -411,11 +458,28 @@ void WidgetLocationsList::paintEvent(QPaintEvent *event)
     // qDebug() << "List repainting";
 }
 
+void WidgetLocationsList::moveEvent(QMoveEvent *event)
+{
+    // the list is moved by the scroll area when scrolling
+    QWidget::moveEvent(event);
+    updateVisibleRows();
+}
+
 void WidgetLocationsList::onRegionWidgetHeightChanged(int height)
 {
     auto regionWidget = static_cast<ItemWidgetRegion*>(sender());
-    regionWidget->setGeometry(0, 0, static_cast<int>(WINDOW_WIDTH * G_SCALE), static_cast<int>(height));
-    recalcItemPositions();
+    for (RegionRow &region : regions_)
+    {
+        if (region.widget == regionWidget)
+        {
+            if (region.height != height)
+            {
+                region.height = height;
+                recalcItemPositions();
+            }
+            break;
+        }
+    }
 }
 
 void WidgetLocationsList::onLocationItemCityClicked(ItemWidgetCity *cityWidget)
@@ -442,14 +506,14 @@ void WidgetLocationsList::onLocationItemRegionClicked(ItemWidgetRegion *regionWi
         {
             if (regionWidget->expandedOrExpanding())
             {
-                regionWidget->collapse();
+                collapse(regionWidget->getId());
             }
             else
             {
                 if (regionWidget->expandable())
                 {
-                    regionWidget->expand();
-                    emit regionExpanding(regionWidget);
+                    expand(regionWidget->getId());
+                    emit regionExpanding(regionWidget->getId());
                 }
             }
         }
@@ -472,16 +536,35 @@ void WidgetLocationsList::onSelectableLocationItemAccented(IItemWidget *itemWidg
     updateCursorWithSelectableWidget(itemWidget);
     recentlyAccentedWidgets_.append(itemWidget);
     lastAccentedItemWidget_ = itemWidget;
+
+    const int regionInd = regionIndex(itemWidget->getId().toTopLevelLocation());
+    if (regionInd >= 0)
+    {
+        emit countryAccented(regions_[regionInd].item.countryCode);
+    }
+}
+
+void WidgetLocationsList::onItemWidgetDeleted(IItemWidget *itemWidget)
+{
+    recentlyAccentedWidgets_.removeAll(itemWidget);
+    if (lastAccentedItemWidget_ == itemWidget)
+    {
+        lastAccentedItemWidget_ = nullptr;
+    }
 }
 
 void WidgetLocationsList::recalcItemPositions()
 {
     // qDebug() << "List repositioning items";
     int heightSoFar = 0;
-    for (auto *itemWidget : qAsConst(itemWidgets_))
+    for (RegionRow &region : regions_)
     {
-        itemWidget->setGeometry(0, heightSoFar, static_cast<int>(WINDOW_WIDTH * G_SCALE), itemWidget->geometry().height());
-        heightSoFar += itemWidget->geometry().height();
+        region.top = heightSoFar;
+        if (region.widget)
+        {
+            region.widget->setGeometry(0, region.top, static_cast<int>(WINDOW_WIDTH * G_SCALE), region.height);
+        }
+        heightSoFar += region.height;
     }
 
     if (heightSoFar != height_)
@@ -489,6 +572,182 @@ void WidgetLocationsList::recalcItemPositions()
         height_ = heightSoFar;
         emit heightChanged(heightSoFar);
     }
+    updateVisibleRows();
+}
+
+const QVector<WidgetLocationsList::SelectableRow> &WidgetLocationsList::selectableRows()
+{
+    if (!isSelectableRowsValid_)
+    {
+        selectableRows_.clear();
+        selectableIndexes_.clear();
+        for (int i = 0; i < regions_.count(); ++i)
+        {
+            // the first row wins for a repeated id, as with the scan before
+            if (!selectableIndexes_.contains(regions_[i].item.id))
+            {
+                selectableIndexes_.insert(regions_[i].item.id, selectableRows_.count());
+            }
+            selectableRows_.append({ i, -1 });
+            if (regions_[i].expanded)
+            {
+                for (int c = 0; c < regions_[i].item.cities.count(); ++c)
+                {
+                    if (!selectableIndexes_.contains(regions_[i].item.cities[c].id))
+                    {
+                        selectableIndexes_.insert(regions_[i].item.cities[c].id, selectableRows_.count());
+                    }
+                    selectableRows_.append({ i, c });
+                }
+            }
+        }
+        isSelectableRowsValid_ = true;
+    }
+    return selectableRows_;
+}
+
+int WidgetLocationsList::selectableRowIndex(LocationID locationId)
+{
+    selectableRows();
+    return selectableIndexes_.value(locationId, -1);
+}
+
+LocationID WidgetLocationsList::rowLocationId(const SelectableRow &row) const
+{
+    const LocationModelItem &item = regions_[row.region].item;
+    return row.city < 0 ? item.id : item.cities[row.city].id;
+}
+
+IItemWidget *WidgetLocationsList::rowWidget(const SelectableRow &row)
+{
+    if (!regions_[row.region].widget)
+    {
+        createRegionWidget(row.region);
+    }
+    return regions_[row.region].widget->itemWidget(row.city);
+}
+
+IItemWidget *WidgetLocationsList::widgetAtGlobalPt(const QPoint &pt)
+{
+    const QPoint localPt = mapFromGlobal(pt);
+    if (localPt.x() < 0 || localPt.x() >= width())
+    {
+        return nullptr;
+    }
+
+    const int itemHeight = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
+    for (int i = 0; i < regions_.count(); ++i)
+    {
+        const RegionRow &region = regions_[i];
+        if (localPt.y() >= region.top && localPt.y() < region.top + region.height)
+        {
+            const int row = (localPt.y() - region.top) / itemHeight;
+            if (row == 0)
+            {
+                return rowWidget({ i, -1 });
+            }
+            if (region.expanded && row <= region.item.cities.count())
+            {
+                return rowWidget({ i, row - 1 });
+            }
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+int WidgetLocationsList::regionIndex(LocationID locationId) const
+{
+    return regionIndexes_.value(locationId, -1);
+}
+
+int WidgetLocationsList::regionTargetHeight(const RegionRow &region) const
+{
+    const int itemHeight = qCeil(LOCATION_ITEM_HEIGHT * G_SCALE);
+    return region.expanded ? itemHeight * (region.item.cities.count() + 1) : itemHeight;
+}
+
+void WidgetLocationsList::setRegionExpanded(int regionInd, bool expanded, bool animated)
+{
+    RegionRow &region = regions_[regionInd];
+    region.expanded = expanded;
+    isSelectableRowsValid_ = false;
+
+    if (animated && region.widget)
+    {
+        // the height follows the animation of the widget (onRegionWidgetHeightChanged)
+        if (expanded)
+        {
+            region.widget->expand();
+        }
+        else
+        {
+            region.widget->collapse();
+        }
+        return;
+    }
+
+    region.height = regionTargetHeight(region);
+    if (region.widget)
+    {
+        region.widget->setExpandedWithoutAnimation(expanded);
+    }
+    if (animated)
+    {
+        recalcItemPositions();
+    }
+}
+
+void WidgetLocationsList::createRegionWidget(int regionInd)
+{
+    RegionRow &region = regions_[regionInd];
+    auto regionWidget = new ItemWidgetRegion(widgetLocationsInfo_, region.item, this);
+    regionWidget->setMuteAccentChanges(muteAccentChanges_);
+    regionWidget->setExpandedWithoutAnimation(region.expanded);
+    connect(regionWidget, SIGNAL(heightChanged(int)), SLOT(onRegionWidgetHeightChanged(int)));
+    connect(regionWidget, SIGNAL(clicked(ItemWidgetCity *)), SLOT(onLocationItemCityClicked(ItemWidgetCity *)));
+    connect(regionWidget, SIGNAL(clicked(ItemWidgetRegion *)), SLOT(onLocationItemRegionClicked(ItemWidgetRegion *)));
+    connect(regionWidget, SIGNAL(accented(IItemWidget *)), SLOT(onSelectableLocationItemAccented(IItemWidget *)));
+    connect(regionWidget, SIGNAL(itemWidgetDeleted(IItemWidget *)), SLOT(onItemWidgetDeleted(IItemWidget *)));
+    connect(regionWidget, SIGNAL(favoriteClicked(ItemWidgetCity*, bool)), SIGNAL(favoriteClicked(ItemWidgetCity*,bool)));
+    region.widget = regionWidget;
+    regionWidget->setGeometry(0, region.top, static_cast<int>(WINDOW_WIDTH * G_SCALE), region.height);
+    regionWidget->show();
+}
+
+void WidgetLocationsList::deleteRegionWidget(ItemWidgetRegion *regionWidget)
+{
+    for (int i = recentlyAccentedWidgets_.count() - 1; i >= 0; --i)
+    {
+        if (regionWidget->containsItemWidget(recentlyAccentedWidgets_[i]))
+        {
+            recentlyAccentedWidgets_.remove(i);
+        }
+    }
+    if (lastAccentedItemWidget_ && regionWidget->containsItemWidget(lastAccentedItemWidget_))
+    {
+        lastAccentedItemWidget_ = nullptr;
+    }
+
+    regionWidget->disconnect();
+    regionWidget->hide();
+    regionWidget->deleteLater();
+}
+
+bool WidgetLocationsList::isSameCities(const LocationModelItem &item1, const LocationModelItem &item2)
+{
+    if (item1.cities.count() != item2.cities.count())
+    {
+        return false;
+    }
+    for (int i = 0; i < item1.cities.count(); ++i)
+    {
+        if (!(item1.cities[i].id == item2.cities[i].id))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 } // namespace
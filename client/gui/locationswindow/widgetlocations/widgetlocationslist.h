@@ -1,12 +1,16 @@
 #ifndef LOCATIONITEMLISTWIDGET_H
 #define LOCATIONITEMLISTWIDGET_H
 
+#include <QHash>
 #include <QWidget>
 #include "itemwidgetregion.h"
 #include "cursorupdatehelper.h"
 
 namespace GuiLocations {
 
+// The list keeps the model items of all the regions and a flat index of the selectable rows (the region headers
+// and the cities of the expanded regions). The widgets are created only for the regions in the viewport
+// (plus OVERSCAN_ROWS above and below it) and deleted when they scroll out; the accented item is kept alive.
 class WidgetLocationsList : public QWidget
 {
     Q_OBJECT
@@ -14,12 +18,14 @@ public:
     explicit WidgetLocationsList(IWidgetLocationsInfo * widgetLocationsInfo, QWidget *parent = nullptr);
     ~WidgetLocationsList() override;
 
-    void clearWidgets();
-    void addRegionWidget(LocationModelItem *item);
-
-    void addCityToRegion(const CityModelItem &city, LocationModelItem *region);
+    void clearItems();
+    // keepUnchangedWidgets: the items are the same as the previous ones except changedIds (the regions),
+    // so the widgets of the other regions shown with the same cities are kept
+    void setItems(const QVector<LocationModelItem> &items, bool keepUnchangedWidgets,
+                  const QVector<LocationID> &changedIds = QVector<LocationID>());
 
     void updateScaling();
+    void updateVisibleRows();
     void accentWidgetContainingCursor();
     void selectWidgetContainingGlobalPt(const QPoint &pt);
 
@@ -30,11 +36,15 @@ public:
     void expandLocationIds(QVector<LocationID> locIds);
 
     QVector<LocationID> expandedOrExpandingLocationIds();
-    QVector<ItemWidgetRegion *> itemWidgets();
-    QVector<ItemWidgetCity *> cityWidgets();
-    QVector<IItemWidget *> selectableWidgets(); // regions + expanded cities
 
+    void setFavorited(LocationID id, bool isFavorite);
+    void setLatencyMs(LocationID id, PingTime pingTime);
+    void setShowLatencyMs(bool showLatencyMs);
+
+    int selectableCount();
+    LocationID selectableLocationId(int index);
     int selectableIndex(LocationID locationId);
+    int cityCount(LocationID regionId) const;
     const LocationID lastAccentedLocationId() const;
     void accentItem(LocationID locationId);
     void accentItemWithoutAnimation(LocationID locationId);
@@ -48,18 +58,18 @@ public:
     int accentItemSelectableIndex();
     IItemWidget *lastAccentedItemWidget();
     IItemWidget *selectableWidget(LocationID locationId);
-    ItemWidgetRegion *regionWidget(LocationID locationId);
-    IItemWidget *itemWidget(LocationID locationId);
 
 signals:
     void heightChanged(int height);
     void favoriteClicked(ItemWidgetCity *cityWidget, bool favorited);
     void cityItemClicked(ItemWidgetCity *cityWidget);
     void locationIdSelected(LocationID id);
-    void regionExpanding(ItemWidgetRegion *regionWidget);
+    void regionExpanding(LocationID regionId);
+    void countryAccented(const QString &countryCode);
 
 protected:
     virtual void paintEvent(QPaintEvent *event) override;
+    virtual void moveEvent(QMoveEvent *event) override;
 
 private slots:
     void onRegionWidgetHeightChanged(int height);
@@ -67,11 +77,34 @@ private slots:
     void onLocationItemCityClicked(ItemWidgetCity *cityWidget);
     void onLocationItemRegionClicked(ItemWidgetRegion *regionWidget);
     void onSelectableLocationItemAccented(IItemWidget *itemWidget);
+    void onItemWidgetDeleted(IItemWidget *itemWidget);
 
 private:
+    static constexpr int OVERSCAN_ROWS = 3;
+
+    struct RegionRow
+    {
+        LocationModelItem item;     // only the cities passed the filter
+        bool expanded = false;      // expanded or expanding
+        int top = 0;
+        int height = 0;             // the current height, animated while expanding/collapsing
+        ItemWidgetRegion *widget = nullptr; // nullptr while the region is out of the viewport
+    };
+
+    struct SelectableRow
+    {
+        int region;
+        int city;   // -1 for the region header
+    };
+
     int height_;
     std::unique_ptr<CursorUpdateHelper> cursorUpdateHelper_;
-    QVector<ItemWidgetRegion *> itemWidgets_; // Note: spinning up this many widgets is not scalable design. If locations list grows we may experience UI slowdowns. It seems okay for now.
+    QVector<RegionRow> regions_;
+    QHash<LocationID, int> regionIndexes_;
+    QVector<SelectableRow> selectableRows_;
+    QHash<LocationID, int> selectableIndexes_;  // into selectableRows_, rebuilt with it
+    bool isSelectableRowsValid_;
+    bool muteAccentChanges_;
     IItemWidget *lastAccentedItemWidget_;
     QVector<IItemWidget *> recentlyAccentedWidgets_;
 
@@ -81,6 +114,19 @@ private:
     void updateCursorWithSelectableWidget(IItemWidget *widget);
 
     void safeEmitLocationIdSelected(IItemWidget *widget);
+
+    const QVector<SelectableRow> &selectableRows();
+    int selectableRowIndex(LocationID locationId);
+    LocationID rowLocationId(const SelectableRow &row) const;
+    IItemWidget *rowWidget(const SelectableRow &row);
+    IItemWidget *widgetAtGlobalPt(const QPoint &pt);
+
+    int regionIndex(LocationID locationId) const;
+    int regionTargetHeight(const RegionRow &region) const;
+    void setRegionExpanded(int regionInd, bool expanded, bool animated);
+    void createRegionWidget(int regionInd);
+    void deleteRegionWidget(ItemWidgetRegion *regionWidget);
+    static bool isSameCities(const LocationModelItem &item1, const LocationModelItem &item2);
 };
 
 }
@@ -13,6 +13,7 @@
 #include "graphicresources/imageresourcessvg.h"
 #include "dpiscalemanager.h"
 #include "utils/mergelog.h"
+#include "ipc/commandstats.h"
 
 namespace LogViewer {
 
@@ -47,11 +48,21 @@ LogViewerWindow::LogViewerWindow(QWidget *parent)
     btnExportLog_->setText(tr("Export to file..."));
     connect(btnExportLog_, SIGNAL(clicked(bool)), SLOT(onExportClick()));
 
+    btnExportTimeline_ = new QPushButton(this);
+    btnExportTimeline_->setText(tr("Export timeline..."));
+    connect(btnExportTimeline_, SIGNAL(clicked(bool)), SLOT(onExportTimelineClick()));
+
+    btnIpcStats_ = new QPushButton(this);
+    btnIpcStats_->setText(tr("IPC statistics"));
+    connect(btnIpcStats_, SIGNAL(clicked(bool)), SLOT(onIpcStatsClick()));
+
     auto *hLayout = new QHBoxLayout();
     hLayout->setAlignment(Qt::AlignLeft);
     hLayout->addWidget(cbMergePerLine_);
     hLayout->addWidget(cbColorHighlighting_);
     hLayout->addWidget(btnExportLog_);
+    hLayout->addWidget(btnExportTimeline_);
+    hLayout->addWidget(btnIpcStats_);
     hLayout->addStretch(1);
 
     layout_ = new QVBoxLayout(this);
@@ -109,6 +120,30 @@ void LogViewerWindow::onExportClick()
     }
 }
 
+void LogViewerWindow::onExportTimelineClick()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save timeline"), QString(), tr("Chrome trace files (*.json)"));
+    if (!fileName.isEmpty())
+    {
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly))
+        {
+            file.write(MergeLog::mergeTraces());
+        }
+        else
+        {
+            QMessageBox::information(this, "Export timeline", "Failed to export timeline");
+        }
+    }
+}
+
+void LogViewerWindow::onIpcStatsClick()
+{
+    // replaces the log until the merge option is toggled
+    textEdit_->setPlainText(IPC::CommandStats::instance().toText());
+    highlightBlocks();
+}
+
 void LogViewerWindow::updateScaling()
 {
     textEdit_->setFont(*FontManager::instance().getFontWithCustomScale(currentScale(), 12, false));
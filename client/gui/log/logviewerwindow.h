@@ -24,6 +24,8 @@ private slots:
     void updateLog(bool doMergePerLine);
     void updateColorHighlighting(bool isColorHighlighting);
     void onExportClick();
+    void onExportTimelineClick();
+    void onIpcStatsClick();
 
 protected:
     void updateScaling() override;
@@ -39,6 +41,8 @@ private:
     QCheckBox *cbMergePerLine_;
     QCheckBox *cbColorHighlighting_;
     QPushButton *btnExportLog_;
+    QPushButton *btnExportTimeline_;
+    QPushButton *btnIpcStats_;
     bool isColorHighlighting_;
 };
 
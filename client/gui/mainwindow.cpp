@@ -15,6 +15,7 @@
 #include <QScreen>
 
 #include "application/windscribeapplication.h"
+#include "utils/tracespan.h"
 #include "commongraphics/commongraphics.h"
 #include "backend/persistentstate.h"
 
@@ -23,6 +24,7 @@
 #include "utils/logger.h"
 #include "utils/writeaccessrightschecker.h"
 #include "utils/mergelog.h"
+#include "utils/settingsstore.h"
 #include "languagecontroller.h"
 #include "multipleaccountdetection/multipleaccountdetectionfactory.h"
 #include "dialogs/dialoggetusernamepassword.h"
@@ -35,10 +37,12 @@
 #include "launchonstartup/launchonstartup.h"
 #include "showingdialogstate.h"
 #include "mainwindowstate.h"
+#include "memorypressurecontroller.h"
 #include "utils/interfaceutils.h"
 #include "utils/iauthchecker.h"
 #include "utils/authcheckerfactory.h"
 #include "systemtray/locationstraymenuscalemanager.h"
+#include "connectwindow/backgroundimage/backgroundimage.h"
 
 #if defined(Q_OS_WIN)
     #include "utils/winutils.h"
@@ -78,6 +82,7 @@ MainWindow::MainWindow() :
     bDisconnectFromTrafficExceed_(false),
     isInitializationAborted_(false),
     isLoginOkAndConnectWindowVisible_(false),
+    isStartupSnapshotShown_(false),
     revealingConnectWindow_(false),
     internetConnected_(false),
     currentlyShowingUserWarningMessage_(false),
@@ -95,8 +100,11 @@ MainWindow::MainWindow() :
     isSpontaneousCloseEvent_(false),
     isExitingAfterUpdate_(false),
     downloadRunning_(false),
-    ignoreUpdateUntilNextRun_(false)
+    ignoreUpdateUntilNextRun_(false),
+    isFirstPaintLogged_(false),
+    isWarmStart_(false)
 {
+    TraceSpan traceSpan("gui", "MainWindow construction");
     g_mainWindow = this;
 
     // Initialize "fallback" tray icon geometry.
@@ -194,6 +202,7 @@ MainWindow::MainWindow() :
     connect(locationsWindow_, SIGNAL(addStaticIpClicked()), SLOT(onLocationsAddStaticIpClicked()));
     connect(locationsWindow_, SIGNAL(clearCustomConfigClicked()), SLOT(onLocationsClearCustomConfigClicked()));
     connect(locationsWindow_, SIGNAL(addCustomConfigClicked()), SLOT(onLocationsAddCustomConfigClicked()));
+    connect(locationsWindow_, SIGNAL(countryAccented(QString)), SLOT(onLocationsCountryAccented(QString)));
     locationsWindow_->setLatencyDisplay(backend_->getPreferences()->latencyDisplay());
     locationsWindow_->connect(backend_->getPreferences(), SIGNAL(latencyDisplayChanged(ProtoTypes::LatencyDisplayType)), SLOT(setLatencyDisplay(ProtoTypes::LatencyDisplayType)) );
     locationsWindow_->setShowLocationLoad(backend_->getPreferences()->isShowLocationLoad());
@@ -368,12 +377,17 @@ MainWindow::MainWindow() :
     backend_->getLocationsModel()->setOrderLocationsType(backend_->getPreferences()->locationOrder());
 
     connect(&DpiScaleManager::instance(), SIGNAL(scaleChanged(double)), SLOT(onScaleChanged()));
+    connect(&ImageResourcesSvg::instance(), SIGNAL(imagesUpdated()), SLOT(onImagesUpdated()));
     connect(&DpiScaleManager::instance(), SIGNAL(newScreen(QScreen*)), SLOT(onDpiScaleManagerNewScreen(QScreen*)));
+    connect(&MemoryPressureController::instance(), SIGNAL(releaseMemoryRequested()), SLOT(onReleaseMemoryRequested()));
 
     backend_->init();
 
     mainWindowController_->changeWindow(MainWindowController::WINDOW_ID_INITIALIZATION);
-    mainWindowController_->getInitWindow()->startWaitingAnimation();
+    if (!showStartupSnapshot())
+    {
+        mainWindowController_->getInitWindow()->startWaitingAnimation();
+    }
 
     mainWindowController_->setIsDockedToTray(backend_->getPreferences()->isDockedToTray());
     bMoveEnabled_ = !backend_->getPreferences()->isDockedToTray();
@@ -407,6 +421,20 @@ void MainWindow::showAfterLaunch()
     // Report the tray geometry after we've given the app some startup time.
     qCDebug(LOG_BASIC) << "Tray Icon geometry:" << trayIcon_.geometry();
 
+    QCommandLineParser cmdParser;
+    cmdParser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    QCommandLineOption osRestartOption("os_restart");
+    cmdParser.addOption(osRestartOption);
+    QCommandLineOption warmStartOption("warm_start");
+    cmdParser.addOption(warmStartOption);
+    // parse() and not process(), the options of the OS (e.g. -psn_ on Mac) don't end the app
+    cmdParser.parse(WindscribeApplication::instance()->arguments());
+
+    if (cmdParser.isSet(warmStartOption)) {
+        enterWarmStart();
+        return;
+    }
+
     #ifdef Q_OS_MACOS
     // Do not showMinimized if hide from dock is enabled.  Otherwise, the app will fail to show
     // itself when the user selects 'Show' in the app's system tray menu.
@@ -423,11 +451,6 @@ void MainWindow::showAfterLaunch()
     }
     #if defined(Q_OS_WIN) || defined(Q_OS_LINUX)
     else if (backend_ && backend_->getPreferences()->isMinimizeAndCloseToTray()) {
-        QCommandLineParser cmdParser;
-        cmdParser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
-        QCommandLineOption osRestartOption("os_restart");
-        cmdParser.addOption(osRestartOption);
-        cmdParser.process(*WindscribeApplication::instance());
         if (cmdParser.isSet(osRestartOption)) {
             showMinimized();
             return;
@@ -437,6 +460,55 @@ void MainWindow::showAfterLaunch()
     show();
 }
 
+void MainWindow::enterWarmStart()
+{
+    // the window stays hidden (the engine starts as usual), the resources of the first show are prepared
+    // at a lower priority so that the startup of the OS isn't slowed. Only the GUI thread is lowered (the preloading
+    // has its own low priority threads), the engine thread and the tunnel processes keep the normal priority.
+    // The priority is restored when the preloading finishes, at the latest after WARM_START_TIMEOUT_MS.
+    qCDebug(LOG_BASIC) << "Warm start, the window is shown on the first activation";
+    isWarmStart_ = true;
+    QThread::currentThread()->setPriority(QThread::LowPriority);
+    connect(&ImageResourcesSvg::instance(), &QThread::finished, this, &MainWindow::restoreWarmStartPriority,
+            Qt::UniqueConnection);
+    QTimer::singleShot(WARM_START_TIMEOUT_MS, this, &MainWindow::restoreWarmStartPriority);
+#if defined(Q_OS_MAC)
+    desiredDockIconVisibility_ = false;
+    hideShowDockIconImpl(false);
+#endif
+    ImageResourcesSvg::instance().updateScaleAndStartPreloading();
+    FontManager::instance().getFont(12, false);
+    FontManager::instance().getFont(12, true);
+    FontManager::instance().getFont(16, true);
+    if (backend_)
+        setBackendAppActiveState(false);
+}
+
+void MainWindow::leaveWarmStart()
+{
+    if (!isWarmStart_)
+        return;
+    isWarmStart_ = false;
+    qCDebug(LOG_BASIC) << "Warm start finished";
+    restoreWarmStartPriority();
+#if defined(Q_OS_MAC)
+    if (!backend_->getPreferences()->isHideFromDock()) {
+        desiredDockIconVisibility_ = true;
+        hideShowDockIconImpl(true);
+    }
+#endif
+}
+
+void MainWindow::restoreWarmStartPriority()
+{
+    disconnect(&ImageResourcesSvg::instance(), &QThread::finished, this, &MainWindow::restoreWarmStartPriority);
+    if (QThread::currentThread()->priority() == QThread::LowPriority)
+    {
+        qCDebug(LOG_BASIC) << "Warm start preparation finished, normal priority";
+        QThread::currentThread()->setPriority(QThread::NormalPriority);
+    }
+}
+
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 {
     // qDebug() << "MainWindow eventFilter: " << event->type();
@@ -527,6 +599,7 @@ void MainWindow::doClose(QCloseEvent *event, bool isFromSigTerm_mac)
 
     // Save favorites here for the reason above.
     backend_->getLocationsModel()->saveFavorites();
+    SettingsStore::instance().flush();
 
     if (WindscribeApplication::instance()->isExitWithRestart() || isFromSigTerm_mac)
     {
@@ -844,6 +917,14 @@ void MainWindow::paintEvent(QPaintEvent *event)
           p.fillRect(QRect(0, 0, width(), height()),Qt::cyan);
     }*/
 
+    if (!isFirstPaintLogged_)
+    {
+        isFirstPaintLogged_ = true;
+        qCDebug(LOG_BASIC) << "Startup time to the first paint:" << WindscribeApplication::instance()->startupElapsedMs() << "ms";
+        TraceSpan::record("gui", "first paint (from the application start)",
+                          TraceSpan::nowUs() - WindscribeApplication::instance()->startupElapsedMs() * 1000);
+    }
+
 #ifdef Q_OS_MAC
     mainWindowController_->updateNativeShadowIfNeeded();
 #endif
@@ -956,6 +1037,12 @@ void MainWindow::onLoginTwoFactorAuthWindowClick(const QString &username, const
 
 void MainWindow::onConnectWindowConnectClick()
 {
+    // e.g. from the tray menu, the engine is not ready yet
+    if (isStartupSnapshotShown_)
+    {
+        return;
+    }
+
     if (backend_->isDisconnected())
     {
         mainWindowController_->collapseLocations();
@@ -1371,6 +1458,12 @@ void MainWindow::onExitWindowReject()
 
 void MainWindow::onLocationSelected(LocationID id)
 {
+    // the tray menu is filled from the snapshot, the engine is not ready yet
+    if (isStartupSnapshotShown_)
+    {
+        return;
+    }
+
     qCDebug(LOG_USER) << "Location selected:" << id.getHashString();
 
     LocationsModel::LocationInfo li;
@@ -1470,6 +1563,15 @@ void MainWindow::onLocationsAddCustomConfigClicked()
     }
 }
 
+void MainWindow::onLocationsCountryAccented(const QString &countryCode)
+{
+    // the background of the location under the cursor is rendered before it's clicked
+    if (backend_->getPreferences()->backgroundSettings().background_type() == ProtoTypes::BackgroundType::BACKGROUND_TYPE_COUNTRY_FLAGS)
+    {
+        ConnectWindow::BackgroundImage::prefetchFlag(countryCode);
+    }
+}
+
 void MainWindow::onBackendInitFinished(ProtoTypes::InitState initState)
 {
     setVariablesToInitState();
@@ -1506,7 +1608,8 @@ void MainWindow::onBackendInitFinished(ProtoTypes::InitState initState)
 
         if (backend_->isCanLoginWithAuthHash())
         {
-            if (!backend_->isSavedApiSettingsExists())
+            // the cached connect window stays until the login finishes
+            if (!backend_->isSavedApiSettingsExists() && !isStartupSnapshotShown_)
             {
                 mainWindowController_->getLoggingInWindow()->setMessage(QT_TRANSLATE_NOOP("LoginWindow::LoggingInWindowItem", "Logging you in..."));
                 mainWindowController_->changeWindow(MainWindowController::WINDOW_ID_LOGGING_IN);
@@ -1563,6 +1666,11 @@ void MainWindow::onBackendInitFinished(ProtoTypes::InitState initState)
 
 void MainWindow::onBackendInitTooLong()
 {
+    // the init window is hidden under the snapshot, the flag stays set until the login finishes
+    if (isStartupSnapshotShown_)
+    {
+        mainWindowController_->changeWindow(MainWindowController::WINDOW_ID_INITIALIZATION);
+    }
     mainWindowController_->getInitWindow()->setCloseButtonVisible(true);
     mainWindowController_->getInitWindow()->setAdditionalMessage(
         tr("This is taking a while, something could be wrong.\n"
@@ -1571,6 +1679,8 @@ void MainWindow::onBackendInitTooLong()
 
 void MainWindow::onBackendLoginFinished(bool /*isLoginFromSavedSettings*/)
 {
+    hideStartupSnapshot();
+    PersistentState::instance().setWasLoggedIn(true);
     mainWindowController_->getPreferencesWindow()->setLoggedIn(true);
     mainWindowController_->getTwoFactorAuthWindow()->clearCurrentCredentials();
 
@@ -1629,6 +1739,8 @@ void MainWindow::onBackendLoginStepMessage(ProtoTypes::LoginMessage msg)
 
 void MainWindow::onBackendLoginError(ProtoTypes::LoginError loginError, const QString &errorMessage)
 {
+    hideStartupSnapshot();
+
     if (loginError == ProtoTypes::LOGIN_ERROR_BAD_USERNAME)
     {
         if (backend_->isLastLoginWithAuthHash())
@@ -2036,6 +2148,8 @@ void MainWindow::onSplitTunnelingStateChanged(bool isActive)
 
 void MainWindow::onBackendSignOutFinished()
 {
+    PersistentState::instance().setWasLoggedIn(false);
+    backend_->clearLocationsSnapshot();
     loginAttemptsController_.reset();
     isPrevSessionStatusInitialized_ = false;
     mainWindowController_->getPreferencesWindow()->setLoggedIn(false);
@@ -2164,6 +2278,7 @@ void MainWindow::onBackendProxySharingInfoChanged(const ProtoTypes::ProxySharing
         else
         {
             mainWindowController_->getBottomInfoWindow()->setProxyGatewayFeatures(false, ProtoTypes::PROXY_SHARING_HTTP);
+            backend_->getPreferencesHelper()->setProxyGatewayTraffic(ProtoTypes::ProxySharingTraffic());
         }
     }
 
@@ -2171,6 +2286,11 @@ void MainWindow::onBackendProxySharingInfoChanged(const ProtoTypes::ProxySharing
     {
         mainWindowController_->getBottomInfoWindow()->setProxyGatewayUsersCount(psi.users_count());
     }
+
+    if (psi.has_traffic())
+    {
+        backend_->getPreferencesHelper()->setProxyGatewayTraffic(psi.traffic());
+    }
 }
 
 void MainWindow::onBackendWifiSharingInfoChanged(const ProtoTypes::WifiSharingInfo &wsi)
@@ -2591,7 +2711,7 @@ void MainWindow::onPreferencesUpdateEngineSettings()
 	// Issues with initializing certain preferences state (See ApiResolution and App Internal DNS)
     if (!backend_->getPreferences()->isReceivingEngineSettings()) 
     {
-        backend_->sendEngineSettingsIfChanged();
+        backend_->scheduleEngineSettingsUpdate();
     }
 }
 
@@ -2736,6 +2856,7 @@ void MainWindow::hideShowDockIconImpl(bool bAllowActivateAndShow)
 void MainWindow::activateAndShow()
 {
     // qDebug() << "ActivateAndShow()";
+    leaveWarmStart();
 #ifdef Q_OS_MAC
     const bool kAllowMoveBetweenSpaces = backend_->getPreferences()->isHideFromDock();
     WidgetUtils_mac::allowMoveBetweenSpacesForWindow(this, kAllowMoveBetweenSpaces);
@@ -2954,7 +3075,7 @@ void MainWindow::onTrayActivated(QSystemTrayIcon::ActivationReason reason)
             // qDebug() << "Tray triggered";
             deactivationTimer_.stop();
 #if defined(Q_OS_WIN)
-            if (isMinimized() || !backend_->getPreferences()->isDockedToTray()) {
+            if (isWarmStart_ || isMinimized() || !backend_->getPreferences()->isDockedToTray()) {
                 activateAndShow();
                 setBackendAppActiveState(true);
             } else {
@@ -3131,6 +3252,7 @@ void MainWindow::loadTrayMenuItems()
 #if !defined(USE_LOCATIONS_TRAY_MENU_NATIVE)
     LocationsTrayMenuScaleManager::instance().setTrayIconGeometry(trayIcon_.geometry());
     for (int i = 0; i < LOCATIONS_TRAY_MENU_NUM_TYPES; ++i) {
+        locationsTrayMenuWidget_[i]->updateItems();
         locationsTrayMenuWidget_[i]->setFontForItems(trayMenu_.font());
         // Force geometry update of the menu, because widget size could have been changed.
         // Send the resize event, so it will make the menu to rebuild its size based on items.
@@ -3169,6 +3291,11 @@ void MainWindow::onLocationsTrayMenuLocationSelected(int type, QString locationT
     #endif
 #endif
 
+    if (isStartupSnapshotShown_)
+    {
+        return;
+    }
+
     const LocationsModel *lm = backend_->getLocationsModel();
     if (type != LOCATIONS_TRAY_MENU_TYPE_GENERIC) {
         auto id = (type == LOCATIONS_TRAY_MENU_TYPE_CUSTOM_CONFIGS)
@@ -3230,13 +3357,29 @@ void MainWindow::onLocationsTrayMenuLocationSelected(int type, QString locationT
 
 void MainWindow::onScaleChanged()
 {
-    ImageResourcesSvg::instance().clearHashAndStartPreloading();
-    ImageResourcesJpg::instance().clearHash();
-    FontManager::instance().clearCache();
+    // the fonts and the JPG images are cached per scale, the SVGs of the recent scales are retained
+    TraceSpan traceSpan("gui", "MainWindow::onScaleChanged");
+    ImageResourcesSvg::instance().updateScaleAndStartPreloading();
     mainWindowController_->updateScaling();
     updateTrayIconType(currentAppIconType_);
 }
 
+void MainWindow::onImagesUpdated()
+{
+    // the placeholders are replaced with the renders of the current scale
+    mainWindowController_->repaint();
+}
+
+void MainWindow::onReleaseMemoryRequested()
+{
+    // the windows in use are kept on the memory notifications of the OS
+    if (!MainWindowState::instance().isActive())
+    {
+        cleanupAdvParametersWindow();
+        cleanupLogViewerWindow();
+    }
+}
+
 void MainWindow::onDpiScaleManagerNewScreen(QScreen *screen)
 {
     Q_UNUSED(screen)
@@ -3600,6 +3743,40 @@ void MainWindow::setVariablesToInitState()
     backend_->getPreferencesHelper()->setIsExternalConfigMode(false);
 }
 
+bool MainWindow::showStartupSnapshot()
+{
+    if (!PersistentState::instance().wasLoggedIn() || !backend_->loadLocationsSnapshot())
+    {
+        return false;
+    }
+
+    // the same choice as after the login, the custom configs are not in the snapshot
+    LocationsModel::LocationInfo li;
+    if (!backend_->getLocationsModel()->getLocationInfo(PersistentState::instance().lastLocation(), li))
+    {
+        backend_->getLocationsModel()->getLocationInfo(backend_->getLocationsModel()->getBestLocationId(), li);
+    }
+    if (li.id.isValid())
+    {
+        mainWindowController_->getConnectWindow()->updateLocationInfo(li.id, li.firstName, li.secondName, li.countryCode, li.pingTime);
+    }
+
+    qCDebug(LOG_BASIC) << "Showing the state of the previous run until the engine is ready";
+    isStartupSnapshotShown_ = true;
+    mainWindowController_->setConnectWindowReadOnly(true);
+    mainWindowController_->changeWindow(MainWindowController::WINDOW_ID_CONNECT);
+    return true;
+}
+
+void MainWindow::hideStartupSnapshot()
+{
+    if (isStartupSnapshotShown_)
+    {
+        isStartupSnapshotShown_ = false;
+        mainWindowController_->setConnectWindowReadOnly(false);
+    }
+}
+
 void MainWindow::openStaticIpExternalWindow()
 {
     QDesktopServices::openUrl(QUrl( QString("https://%1/staticips?cpid=app_windows").arg(HardcodedSettings::instance().serverUrl())));
@@ -3612,6 +3789,8 @@ void MainWindow::openUpgradeExternalWindow()
 
 void MainWindow::gotoLoginWindow()
 {
+    hideStartupSnapshot();
+    PersistentState::instance().setWasLoggedIn(false);
     mainWindowController_->getLoginWindow()->setFirewallTurnOffButtonVisibility(backend_->isFirewallEnabled());
     mainWindowController_->changeWindow(MainWindowController::WINDOW_ID_LOGIN);
 }
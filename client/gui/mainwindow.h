@@ -151,6 +151,7 @@ private slots:
     void onLocationsAddStaticIpClicked();
     void onLocationsClearCustomConfigClicked();
     void onLocationsAddCustomConfigClicked();
+    void onLocationsCountryAccented(const QString &countryCode);
 
     void onLanguageChanged();
 
@@ -256,6 +257,8 @@ private slots:
     void onMainWindowControllerSendServerRatingDown();
 
     void onScaleChanged();
+    void onImagesUpdated();
+    void onReleaseMemoryRequested();
     void onDpiScaleManagerNewScreen(QScreen *screen);
     void onFocusWindowChanged(QWindow *focusWindow);
     void onWindowDeactivateAndHideImpl();
@@ -328,6 +331,8 @@ private:
 
     bool isInitializationAborted_;
     bool isLoginOkAndConnectWindowVisible_;
+    // the connect window shows the state of the previous run, read-only until the engine logs in
+    bool isStartupSnapshotShown_;
     static constexpr int TIME_BEFORE_SHOW_SHUTDOWN_WINDOW = 1500;   // ms
 
     void hideSupplementaryWidgets();
@@ -339,6 +344,8 @@ private:
     void setInitialFirewallState();
     void handleDisconnectWithError(const ProtoTypes::ConnectState &connectState);
     void setVariablesToInitState();
+    bool showStartupSnapshot();
+    void hideStartupSnapshot();
 
     void openStaticIpExternalWindow();
     void openUpgradeExternalWindow();
@@ -390,6 +397,14 @@ private:
 
     bool downloadRunning_;
     bool ignoreUpdateUntilNextRun_;
+    bool isFirstPaintLogged_;
+    // started by the launcher with -warm_start: hidden, tray icon only, until the first activation,
+    // the GUI thread prepares the resources at a lower priority for up to WARM_START_TIMEOUT_MS
+    static constexpr int WARM_START_TIMEOUT_MS = 30000;
+    bool isWarmStart_;
+    void enterWarmStart();
+    void leaveWarmStart();
+    void restoreWarmStartPriority();
     void cleanupAdvParametersWindow();
     void cleanupLogViewerWindow();
 
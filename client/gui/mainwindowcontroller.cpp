@@ -44,6 +44,7 @@ MainWindowController::MainWindowController(QWidget *parent, LocationsWindow *loc
     locationListAnimationState_(LOCATION_LIST_ANIMATION_COLLAPSED),
     preferencesState_(PREFERENCES_STATE_COLLAPSED),
     isAtomicAnimationActive_(false),
+    isConnectWindowReadOnly_(false),
     expandLocationsListAnimation_(NULL),
     collapseBottomInfoWindowAnimation_(NULL),
     expandLocationsAnimationGroup_(NULL),
@@ -138,6 +139,10 @@ MainWindowController::MainWindowController(QWidget *parent, LocationsWindow *loc
     shadowManager_->addRectangle(QRect(0, 0, 0, 0), ShadowManager::SHAPE_ID_PREFERENCES, false);
     connect(shadowManager_, SIGNAL(shadowUpdated()), SIGNAL(shadowUpdated()));
 
+    deferredScalingTimer_ = new QTimer(this);
+    deferredScalingTimer_->setInterval(0);
+    connect(deferredScalingTimer_, SIGNAL(timeout()), SLOT(onDeferredScalingTimer()));
+
     connect(&TooltipController::instance(), SIGNAL(sendServerRatingUp()), SLOT(onTooltipControllerSendServerRatingUp()));
     connect(&TooltipController::instance(), SIGNAL(sendServerRatingDown()), SLOT(onTooltipControllerSendServerRatingDown()));
 
@@ -150,6 +155,13 @@ void MainWindowController::updateScaling()
     updateMainAndViewGeometry(true);
 }
 
+void MainWindowController::repaint()
+{
+    scene_->update();
+    view_->viewport()->update();
+    locationsWindow_->update();
+}
+
 void MainWindowController::updateLocationsWindowAndTabGeometry()
 {
     //locationsWindow_->updateLocationsTabGeometry();
@@ -170,26 +182,31 @@ void MainWindowController::updateLocationsWindowAndTabGeometryStatic()
 {
     static double prevScale = 1.0;
 
+    // the windows the shadows and geometries below depend on are always updated right away
+    deferredScalingUpdates_.clear();
     initWindow_->updateScaling();
     loginWindow_->updateScaling();
-    loggingInWindow_->updateScaling();
-    emergencyConnectWindow_->updateScaling();
-    externalConfigWindow_->updateScaling();
-    twoFactorAuthWindow_->updateScaling();
-    exitWindow_->updateScaling();
+    updateScalingOfWindow(loggingInWindow_->getGraphicsObject(), [this]() { loggingInWindow_->updateScaling(); });
+    updateScalingOfWindow(emergencyConnectWindow_->getGraphicsObject(), [this]() { emergencyConnectWindow_->updateScaling(); });
+    updateScalingOfWindow(externalConfigWindow_->getGraphicsObject(), [this]() { externalConfigWindow_->updateScaling(); });
+    updateScalingOfWindow(twoFactorAuthWindow_->getGraphicsObject(), [this]() { twoFactorAuthWindow_->updateScaling(); });
+    updateScalingOfWindow(exitWindow_->getGraphicsObject(), [this]() { exitWindow_->updateScaling(); });
     connectWindow_->updateScaling();
     locationsWindow_->updateScaling();
     preferencesWindow_->updateScaling();
-    newsFeedWindow_->updateScaling();
-    updateWindow_->updateScaling();
-    upgradeAccountWindow_->updateScaling();
+    updateScalingOfWindow(newsFeedWindow_->getGraphicsObject(), [this]() { newsFeedWindow_->updateScaling(); });
+    updateScalingOfWindow(updateWindow_->getGraphicsObject(), [this]() { updateWindow_->updateScaling(); });
+    updateScalingOfWindow(upgradeAccountWindow_->getGraphicsObject(), [this]() { upgradeAccountWindow_->updateScaling(); });
     preferencesWindowHeight_ = preferencesWindowHeight_* (G_SCALE / prevScale);
     prevScale = G_SCALE;
 
     bottomInfoWindow_->updateScaling();
     updateAppItem_->updateScaling();
-    generalMessageWindow_->updateScaling();
-
+    updateScalingOfWindow(generalMessageWindow_->getGraphicsObject(), [this]() { generalMessageWindow_->updateScaling(); });
+    if (!deferredScalingUpdates_.isEmpty())
+    {
+        deferredScalingTimer_->start();
+    }
 
     int height = locationsWindow_->tabAndFooterHeight();
     if (locationListAnimationState_ == LOCATION_LIST_ANIMATION_COLLAPSED) height = 0 ;
@@ -316,8 +333,53 @@ MainWindowController::WINDOW_ID MainWindowController::currentWindow()
     return curWindow_;
 }
 
+void MainWindowController::setConnectWindowReadOnly(bool isReadOnly)
+{
+    isConnectWindowReadOnly_ = isReadOnly;
+    // otherwise the running animation or the next switch to the connect window applies it
+    if (curWindow_ == WINDOW_ID_CONNECT && !isAtomicAnimationActive_ && preferencesState_ == PREFERENCES_STATE_COLLAPSED)
+    {
+        connectWindow_->setClickable(!isReadOnly);
+    }
+}
+
+void MainWindowController::updateScalingOfWindow(QGraphicsObject *graphicsObject, std::function<void()> updateFunc)
+{
+    if (graphicsObject->isVisible())
+    {
+        updateFunc();
+    }
+    else
+    {
+        deferredScalingUpdates_.enqueue(updateFunc);
+    }
+}
+
+void MainWindowController::finishDeferredScalingUpdates()
+{
+    deferredScalingTimer_->stop();
+    while (!deferredScalingUpdates_.isEmpty())
+    {
+        deferredScalingUpdates_.dequeue()();
+    }
+}
+
+void MainWindowController::onDeferredScalingTimer()
+{
+    if (!deferredScalingUpdates_.isEmpty())
+    {
+        deferredScalingUpdates_.dequeue()();
+    }
+    if (deferredScalingUpdates_.isEmpty())
+    {
+        deferredScalingTimer_->stop();
+    }
+}
+
 void MainWindowController::changeWindow(MainWindowController::WINDOW_ID windowId)
 {
+    finishDeferredScalingUpdates();
+
     if (isAtomicAnimationActive_)
     {
         queueWindowChanges_.enqueue(windowId);
@@ -1257,7 +1319,7 @@ void MainWindowController::gotoConnectWindow()
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_LOGIN_WINDOW, false);
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_INIT_WINDOW, false);
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_CONNECT_WINDOW, true);
-        connectWindow_->setClickable(true);
+        connectWindow_->setClickable(!isConnectWindowReadOnly_);
         connectWindow_->getGraphicsObject()->setVisible(true);
         connectWindow_->getGraphicsObject()->show();
 
@@ -1303,7 +1365,7 @@ void MainWindowController::gotoConnectWindow()
         connect(revealConnectOpacityAnimation, &QPropertyAnimation::finished, [this]()
         {
             emit revealConnectWindowStateChanged(false);
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             initWindow_->getGraphicsObject()->setVisible(false);
             initWindow_->resetState();
             updateMainAndViewGeometry(false);
@@ -1368,7 +1430,7 @@ void MainWindowController::gotoConnectWindow()
 
         connect(anim, &QPropertyAnimation::finished, [this]() {
             newsFeedWindow_->getGraphicsObject()->hide();
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             bottomInfoWindow_->setClickable(true);
 
             if (bottomInfoWindow_->getGraphicsObject()->isVisible())
@@ -1405,7 +1467,7 @@ void MainWindowController::gotoConnectWindow()
 
         connect(anim, &QPropertyAnimation::finished, [this]() {
             updateWindow_->getGraphicsObject()->hide();
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             bottomInfoWindow_->setClickable(true);
 
             if (bottomInfoWindow_->getGraphicsObject()->isVisible())
@@ -1442,7 +1504,7 @@ void MainWindowController::gotoConnectWindow()
 
         connect(anim, &QPropertyAnimation::finished, [this]() {
             upgradeAccountWindow_->getGraphicsObject()->hide();
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             bottomInfoWindow_->setClickable(true);
 
             if (bottomInfoWindow_->getGraphicsObject()->isVisible())
@@ -1480,7 +1542,7 @@ void MainWindowController::gotoConnectWindow()
 
         connect(anim, &QPropertyAnimation::finished, [this]() {
             generalMessageWindow_->getGraphicsObject()->hide();
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             bottomInfoWindow_->setClickable(true);
 
             if (bottomInfoWindow_->getGraphicsObject()->isVisible())
@@ -1510,7 +1572,7 @@ void MainWindowController::gotoConnectWindow()
         curWindow_ = WINDOW_ID_CONNECT;
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_LOGIN_WINDOW, false);
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_CONNECT_WINDOW, true);
-        connectWindow_->setClickable(true);
+        connectWindow_->setClickable(!isConnectWindowReadOnly_);
         connectWindow_->getGraphicsObject()->setVisible(true);
         externalConfigWindow_->getGraphicsObject()->setVisible(false);
         externalConfigWindow_->setClickable(false);
@@ -1532,7 +1594,7 @@ void MainWindowController::gotoConnectWindow()
         curWindow_ = WINDOW_ID_CONNECT;
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_LOGIN_WINDOW, false);
         shadowManager_->setVisible(ShadowManager::SHAPE_ID_CONNECT_WINDOW, true);
-        connectWindow_->setClickable(true);
+        connectWindow_->setClickable(!isConnectWindowReadOnly_);
         connectWindow_->getGraphicsObject()->setVisible(true);
         twoFactorAuthWindow_->resetState();
         twoFactorAuthWindow_->getGraphicsObject()->setVisible(false);
@@ -2030,7 +2092,7 @@ void MainWindowController::closeExitWindow()
 
         connect(anim, &QPropertyAnimation::finished, [this]() {
             exitWindow_->getGraphicsObject()->hide();
-            connectWindow_->setClickable(true);
+            connectWindow_->setClickable(!isConnectWindowReadOnly_);
             bottomInfoWindow_->setClickable(true);
 
             if (bottomInfoWindow_->getGraphicsObject()->isVisible())
@@ -2552,7 +2614,7 @@ void MainWindowController::collapsePreferencesFromConnect(bool bSkipBottomInfoWi
         TooltipController::instance().hideAllTooltips();
         updateMainAndViewGeometry(false);
 
-        connectWindow_->setClickable(true);
+        connectWindow_->setClickable(!isConnectWindowReadOnly_);
         bottomInfoWindow_->setClickable(true);
         invalidateShadow_mac();
 
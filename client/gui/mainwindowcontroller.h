@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QGraphicsView>
 #include <QQueue>
+#include <QTimer>
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
 #include "utils/shadowmanager.h"
@@ -57,6 +58,8 @@ public:
                                   Preferences *preferences, AccountInfo *accountInfo);
 
     void updateScaling();
+    // repaints the windows, e.g. after the images of the new scale are rendered
+    void repaint();
     void updateMaskForGraphicsView();
     void updateMainAndViewGeometry(bool updateShadow);
 
@@ -66,6 +69,8 @@ public:
     bool preferencesVisible();
     WINDOW_ID currentWindow();
     void changeWindow(WINDOW_ID windowId);
+    // the connect window is shown but doesn't take the clicks, e.g. the cached state before the engine is ready
+    void setConnectWindowReadOnly(bool isReadOnly);
 
     void expandLocations();
     void collapseLocations();
@@ -121,6 +126,8 @@ signals:
     void sendServerRatingDown();
 
 private slots:
+    void onDeferredScalingTimer();
+
     void onExpandLocationsListAnimationFinished();
     void onExpandLocationsListAnimationValueChanged(const QVariant &value);
     void onExpandLocationsListAnimationStateChanged(QAbstractAnimation::State newState, QAbstractAnimation::State oldState);
@@ -196,8 +203,14 @@ private:
     int preferencesWindowHeight_;
 
     bool isAtomicAnimationActive_;      // animation which cannot be interrupted is active
+    bool isConnectWindowReadOnly_;
     QQueue<WINDOW_ID> queueWindowChanges_;
 
+    // updateScaling() of the hidden windows, done one per event loop iteration after the visible ones
+    // (or at once before a window change)
+    QQueue<std::function<void()> > deferredScalingUpdates_;
+    QTimer *deferredScalingTimer_;
+
     // TODO: check for leaks
     QPropertyAnimation *expandLocationsListAnimation_;
     QPropertyAnimation *collapseBottomInfoWindowAnimation_;
@@ -242,6 +255,8 @@ private:
     void centerMainGeometryAndUpdateView();
     void updateViewAndScene(int width, int height, int shadowSize, bool updateShadow);
     void updateLocationsWindowAndTabGeometryStatic();
+    void updateScalingOfWindow(QGraphicsObject *graphicsObject, std::function<void()> updateFunc);
+    void finishDeferredScalingUpdates();
 
     void invalidateShadow_mac();
     void setMaskForGraphicsView();
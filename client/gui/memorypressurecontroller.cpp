@@ -0,0 +1,123 @@
+#include "memorypressurecontroller.h"
+
+#include <QDateTime>
+#include <QPixmapCache>
+#include "mainwindowstate.h"
+#include "graphicresources/imageresourcessvg.h"
+#include "graphicresources/imageresourcesjpg.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+#ifdef Q_OS_WIN
+    #include <Windows.h>
+#elif defined Q_OS_MAC
+    #include "utils/macutils.h"
+#elif defined Q_OS_LINUX
+    #include <malloc.h>
+#endif
+
+quint64 MemoryPressureController::currentMemoryUsage() const
+{
+    return Utils::getCurrentProcessMemoryUsage();
+}
+
+qint64 MemoryPressureController::lastReleasedBytes() const
+{
+    return lastReleasedBytes_;
+}
+
+void MemoryPressureController::releaseMemory(const QString &reason)
+{
+    const quint64 usageBefore = currentMemoryUsage();
+
+    emit releaseMemoryRequested();
+    ImageResourcesSvg::instance().releaseMemory();
+    ImageResourcesJpg::instance().clearHash();
+    QPixmapCache::clear();
+#ifdef Q_OS_LINUX
+    // the freed heap is returned to the OS, glibc keeps it otherwise
+    malloc_trim(0);
+#endif
+
+    lastReleaseTime_ = QDateTime::currentMSecsSinceEpoch();
+    lastReleasedBytes_ = qMax<qint64>(static_cast<qint64>(usageBefore) - static_cast<qint64>(currentMemoryUsage()), 0);
+    qCDebug(LOG_BASIC) << "Released the GUI caches (" << reason << "), memory usage:"
+                       << Utils::humanReadableByteCount(currentMemoryUsage(), true) << ", released:"
+                       << Utils::humanReadableByteCount(lastReleasedBytes_, true);
+    emit memoryReleased();
+}
+
+void MemoryPressureController::onMainWindowIsActiveChanged(bool isActive)
+{
+    // the docked window is hidden and shown often, released only if it stays hidden
+    if (isActive)
+    {
+        releaseTimer_.stop();
+        isReleasedSinceHide_ = false;
+    }
+    else if (!isReleasedSinceHide_)
+    {
+        releaseTimer_.start();
+    }
+}
+
+void MemoryPressureController::onReleaseTimer()
+{
+    isReleasedSinceHide_ = true;
+    releaseMemory("hidden");
+}
+
+#ifdef Q_OS_WIN
+void MemoryPressureController::onLowMemoryNotification()
+{
+    // the event stays signaled while the memory is low, checked again after the interval
+    lowMemoryNotifier_->setEnabled(false);
+    QTimer::singleShot(MIN_RELEASE_INTERVAL, this, [this]() {
+        lowMemoryNotifier_->setEnabled(true);
+    });
+    releaseMemory("low memory");
+}
+#endif
+
+MemoryPressureController::MemoryPressureController() : lastReleaseTime_(0), lastReleasedBytes_(0),
+    isReleasedSinceHide_(false)
+{
+    connect(&MainWindowState::instance(), SIGNAL(isActiveChanged(bool)), SLOT(onMainWindowIsActiveChanged(bool)));
+
+    releaseTimer_.setSingleShot(true);
+    releaseTimer_.setTimerType(Qt::VeryCoarseTimer);
+    releaseTimer_.setInterval(RELEASE_DELAY);
+    connect(&releaseTimer_, SIGNAL(timeout()), SLOT(onReleaseTimer()));
+
+#ifdef Q_OS_WIN
+    lowMemoryNotifier_ = nullptr;
+    lowMemoryNotification_ = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+    if (lowMemoryNotification_)
+    {
+        lowMemoryNotifier_ = new QWinEventNotifier(lowMemoryNotification_, this);
+        connect(lowMemoryNotifier_, SIGNAL(activated(HANDLE)), SLOT(onLowMemoryNotification()));
+    }
+    else
+    {
+        qCDebug(LOG_BASIC) << "CreateMemoryResourceNotification failed:" << GetLastError();
+    }
+#elif defined Q_OS_MAC
+    MacUtils::setMemoryPressureHandler([this]() {
+        if (QDateTime::currentMSecsSinceEpoch() - lastReleaseTime_ >= MIN_RELEASE_INTERVAL)
+        {
+            releaseMemory("memory pressure");
+        }
+    });
+#endif
+}
+
+MemoryPressureController::~MemoryPressureController()
+{
+#ifdef Q_OS_WIN
+    if (lowMemoryNotification_)
+    {
+        delete lowMemoryNotifier_;
+        CloseHandle(lowMemoryNotification_);
+    }
+#endif
+}
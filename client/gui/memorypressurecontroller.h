@@ -0,0 +1,63 @@
+#ifndef MEMORYPRESSURECONTROLLER_H
+#define MEMORYPRESSURECONTROLLER_H
+
+#include <QObject>
+#include <QTimer>
+
+#ifdef Q_OS_WIN
+#include <QWinEventNotifier>
+#endif
+
+// singleton, the memory-pressure mode of the GUI: after the main window has been minimized or hidden for
+// RELEASE_DELAY (see MainWindowState), or on the low memory notifications of the OS (Windows and Mac), the caches
+// are dropped to the minimal working set: the rasterized images, the backgrounds and the pixmap cache of Qt.
+// releaseMemoryRequested() lets the owners release the window-specific resources.
+// Everything dropped is recreated on request, the first show after a release is a bit slower.
+class MemoryPressureController : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MemoryPressureController &instance()
+    {
+        static MemoryPressureController c;
+        return c;
+    }
+
+    // the resident memory of the GUI process in bytes
+    quint64 currentMemoryUsage() const;
+    qint64 lastReleasedBytes() const;
+
+    void releaseMemory(const QString &reason);
+
+signals:
+    void releaseMemoryRequested();
+    void memoryReleased();
+
+private slots:
+    void onMainWindowIsActiveChanged(bool isActive);
+    void onReleaseTimer();
+#ifdef Q_OS_WIN
+    void onLowMemoryNotification();
+#endif
+
+private:
+    MemoryPressureController();
+    ~MemoryPressureController();
+
+    static constexpr int RELEASE_DELAY = 60 * 1000;
+    // the notifications of the OS repeat while the memory is low
+    static constexpr int MIN_RELEASE_INTERVAL = 60 * 1000;
+
+    QTimer releaseTimer_;
+    qint64 lastReleaseTime_;
+    qint64 lastReleasedBytes_;
+    bool isReleasedSinceHide_;
+
+#ifdef Q_OS_WIN
+    HANDLE lowMemoryNotification_;
+    QWinEventNotifier *lowMemoryNotifier_;
+#endif
+};
+
+#endif // MEMORYPRESSURECONTROLLER_H
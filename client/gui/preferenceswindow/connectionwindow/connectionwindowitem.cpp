@@ -65,6 +65,8 @@ ConnectionWindowItem::ConnectionWindowItem(ScalableGraphicsObject *parent, Prefe
     connect(connectionModeItem_, SIGNAL(buttonHoverLeave(ConnectionModeItem::ButtonType)),
         SLOT(onConnectionModeHoverLeave(ConnectionModeItem::ButtonType)));
     addItem(connectionModeItem_);
+    // the page can be created after the external config mode was set
+    connectionModeItem_->setVisible(!preferencesHelper->isExternalConfigMode());
 
 #ifndef Q_OS_LINUX
     packetSizeItem_ = new PacketSizeItem(this);
@@ -11,6 +11,10 @@
 #include "tooltips/tooltipcontroller.h"
 #include "utils/logger.h"
 #include "utils/hardcodedsettings.h"
+#include "utils/utils.h"
+#include "utils/eventloopwatchdog.h"
+#include "idlemodecontroller.h"
+#include "memorypressurecontroller.h"
 
 extern QWidget *g_mainWindow;
 
@@ -105,6 +109,26 @@ DebugWindowItem::DebugWindowItem(ScalableGraphicsObject *parent, Preferences *pr
     viewLicensesItem_->setText(tr("View Licenses"));
     viewLicensesItem_->setUrl(QString("https://%1/terms/oss").arg(HardcodedSettings::instance().serverUrl()));
     addItem(viewLicensesItem_);
+
+    wakeupsItem_ = new TextItem(this, QString(), 50);
+    onWakeupsPerMinuteChanged(IdleModeController::instance().wakeupsPerMinute());
+    connect(&IdleModeController::instance(), SIGNAL(wakeupsPerMinuteChanged(int)), SLOT(onWakeupsPerMinuteChanged(int)));
+    addItem(wakeupsItem_);
+
+    eventLoopStallsItem_ = new TextItem(this, QString(), 50);
+    onEventLoopStallDetected();
+    connect(&EventLoopWatchdog::instance(), SIGNAL(stallDetected()), SLOT(onEventLoopStallDetected()));
+    addItem(eventLoopStallsItem_);
+
+    memoryUsageItem_ = new TextItem(this, QString(), 50);
+    onMemoryUsageTimer();
+    // suspended with the other timers while the window is hidden
+    memoryUsageTimer_.setInterval(MEMORY_USAGE_UPDATE_INTERVAL);
+    connect(&memoryUsageTimer_, SIGNAL(timeout()), SLOT(onMemoryUsageTimer()));
+    IdleModeController::instance().addAnimationTimer(&memoryUsageTimer_);
+    memoryUsageTimer_.start();
+    connect(&MemoryPressureController::instance(), SIGNAL(memoryReleased()), SLOT(onMemoryUsageTimer()));
+    addItem(memoryUsageItem_);
 }
 
 QString DebugWindowItem::caption()
@@ -182,6 +206,30 @@ void DebugWindowItem::onIPv6StateChanged(bool isChecked)
 }
 #endif
 
+void DebugWindowItem::onWakeupsPerMinuteChanged(int wakeups)
+{
+    // the debug info, not translated
+    wakeupsItem_->setText(QString("GUI wakeups per minute: %1").arg(wakeups));
+}
+
+void DebugWindowItem::onEventLoopStallDetected()
+{
+    // the debug info, not translated
+    eventLoopStallsItem_->setText(QString("Longest event loop stalls: %1").arg(EventLoopWatchdog::instance().shortSummary()));
+}
+
+void DebugWindowItem::onMemoryUsageTimer()
+{
+    // the debug info, not translated
+    const MemoryPressureController &controller = MemoryPressureController::instance();
+    QString text = QString("GUI memory usage: %1").arg(Utils::humanReadableByteCount(controller.currentMemoryUsage(), true));
+    if (controller.lastReleasedBytes() > 0)
+    {
+        text += QString(" (last release: %1)").arg(Utils::humanReadableByteCount(controller.lastReleasedBytes(), true));
+    }
+    memoryUsageItem_->setText(text);
+}
+
 void DebugWindowItem::onApiResolutionChanged(const ProtoTypes::ApiResolution &ar)
 {
     preferences_->setApiResolution(ar);
@@ -12,6 +12,7 @@
 #include "apiresolutionitem.h"
 #include "tooltips/tooltiptypes.h"
 #include "../openurlitem.h"
+#include "../textitem.h"
 
 
 enum DEBUG_SCREEN { DEBUG_SCREEN_HOME, DEBUG_SCREEN_ADVANCED_PARAMETERS };
@@ -62,6 +63,9 @@ private slots:
     void onApiResolutionPreferencesChanged(const ProtoTypes::ApiResolution &ar);
 
     void onLanguageChanged();
+    void onWakeupsPerMinuteChanged(int wakeups);
+    void onEventLoopStallDetected();
+    void onMemoryUsageTimer();
 
 #ifdef Q_OS_WIN
     void onIPv6StateChanged(bool isChecked);
@@ -74,6 +78,8 @@ protected:
     void hideOpenPopups() override;
 
 private:
+    static constexpr int MEMORY_USAGE_UPDATE_INTERVAL = 5000;
+
     SubPageItem *advParamtersItem_;
     ViewLogItem *viewLogItem_;
 
@@ -85,6 +91,10 @@ private:
     ComboBoxItem *comboBoxDnsManager_;
 #endif
     OpenUrlItem *viewLicensesItem_;
+    TextItem *wakeupsItem_;
+    TextItem *eventLoopStallsItem_;
+    TextItem *memoryUsageItem_;
+    QTimer memoryUsageTimer_;
 
     Preferences *preferences_;
     PreferencesHelper *preferencesHelper_;
@@ -12,7 +12,11 @@ namespace PreferencesWindow {
 
 
 PreferencesWindowItem::PreferencesWindowItem(QGraphicsObject *parent, Preferences *preferences, PreferencesHelper *preferencesHelper, AccountInfo *accountInfo) : ScalableGraphicsObject(parent),
-    curScale_(1.0), isShowSubPage_(false)
+    preferences_(preferences), preferencesHelper_(preferencesHelper), accountInfo_(accountInfo),
+    curScale_(1.0), accountWindowItem_(nullptr), connectionWindowItem_(nullptr), shareWindowItem_(nullptr), debugWindowItem_(nullptr),
+    networkWhiteListWindowItem_(nullptr), proxySettingsWindowItem_(nullptr), splitTunnelingWindowItem_(nullptr),
+    splitTunnelingAppsWindowItem_(nullptr), splitTunnelingAppsSearchWindowItem_(nullptr), splitTunnelingIpsAndHostnamesWindowItem_(nullptr),
+    isLoggedIn_(false), isCurrentNetworkSet_(false), isPacketSizeDetectionOn_(false), isShowSubPage_(false)
 {
     setFlags(QGraphicsObject::ItemIsFocusable);
     installEventFilter(this);
@@ -53,59 +57,12 @@ PreferencesWindowItem::PreferencesWindowItem(QGraphicsObject *parent, Preference
 
     generalWindowItem_ = new GeneralWindowItem(nullptr, preferences, preferencesHelper);
 
-    accountWindowItem_ = new AccountWindowItem(nullptr, accountInfo);
-    accountWindowItem_->setLoggedIn(false);
-    connect(accountWindowItem_, SIGNAL(sendConfirmEmailClick()), SIGNAL(sendConfirmEmailClick()));
-    connect(accountWindowItem_, SIGNAL(noAccountLoginClick()), SIGNAL(noAccountLoginClick()));
-    connect(accountWindowItem_, SIGNAL(editAccountDetailsClick()), SIGNAL(editAccountDetailsClick()));
-    connect(accountWindowItem_, SIGNAL(addEmailButtonClick()), SIGNAL(addEmailButtonClick()));
-
-    connectionWindowItem_ = new ConnectionWindowItem(nullptr, preferences, preferencesHelper);
-    shareWindowItem_ = new ShareWindowItem(nullptr, preferences, preferencesHelper);
-    debugWindowItem_ = new DebugWindowItem(nullptr, preferences, preferencesHelper);
-
-    connect(connectionWindowItem_, SIGNAL(networkWhitelistPageClick()), SLOT(onNetworkWhitelistPageClick()));
-    connect(connectionWindowItem_, SIGNAL(splitTunnelingPageClick()), SLOT(onSplitTunnelingPageClick()));
-    connect(connectionWindowItem_, SIGNAL(proxySettingsPageClick()), SLOT(onProxySettingsPageClick()));
-    connect(connectionWindowItem_, SIGNAL(cycleMacAddressClick()), SIGNAL(cycleMacAddressClick()));
-    connect(connectionWindowItem_, SIGNAL(detectAppropriatePacketSizeButtonClicked()), SIGNAL(detectAppropriatePacketSizeButtonClicked()));
-
-    connect(debugWindowItem_, SIGNAL(viewLogClick()), SIGNAL(viewLogClick()));
-    connect(debugWindowItem_, SIGNAL(sendLogClick()), SIGNAL(sendDebugLogClick()));
-    connect(debugWindowItem_, SIGNAL(advParametersClick()), SLOT(onAdvParametersClick()));
-#ifdef Q_OS_WIN
-    connect(debugWindowItem_, SIGNAL(setIpv6StateInOS(bool,bool)), SIGNAL(setIpv6StateInOS(bool,bool)));
-#endif
     scrollAreaItem_->setItem(generalWindowItem_);
     pageCaption_ = generalWindowItem_->caption();
 
+    warmUpTimer_.setSingleShot(true);
+    connect(&warmUpTimer_, SIGNAL(timeout()), SLOT(onWarmUpTimer()));
 
-    networkWhiteListWindowItem_ = new NetworkWhiteListWindowItem(nullptr, preferences);
-    proxySettingsWindowItem_ = new ProxySettingsWindowItem(nullptr, preferences);
-    // advancedParametersWindowItem_ = new AdvancedParametersWindowItem(nullptr, preferences);
-    splitTunnelingWindowItem_ = new SplitTunnelingWindowItem(nullptr, preferences);
-    splitTunnelingAppsWindowItem_ = new SplitTunnelingAppsWindowItem(nullptr, preferences);
-    splitTunnelingAppsSearchWindowItem_ = new SplitTunnelingAppsSearchWindowItem(nullptr, preferences);
-    splitTunnelingIpsAndHostnamesWindowItem_ = new SplitTunnelingIpsAndHostnamesWindowItem(nullptr, preferences);
-
-    connect(splitTunnelingWindowItem_, SIGNAL(appsPageClick()), SLOT(onSplitTunnelingAppsClick()));
-    connect(splitTunnelingWindowItem_, SIGNAL(ipsAndHostnamesPageClick()), SLOT(onSplitTunnelingIpsAndHostnamesClick()));
-    connect(splitTunnelingAppsWindowItem_, SIGNAL(searchButtonClicked()), SLOT(onSplitTunnelingAppsSearchClick()));
-    connect(splitTunnelingAppsWindowItem_, SIGNAL(addButtonClicked()), SIGNAL(splitTunnelingAppsAddButtonClick()));
-    connect(splitTunnelingAppsWindowItem_, SIGNAL(appsUpdated(QList<ProtoTypes::SplitTunnelingApp>)), SLOT(onAppsWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp>)));
-    connect(splitTunnelingAppsWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
-    connect(splitTunnelingAppsWindowItem_, SIGNAL(escape()), SLOT(onStAppsEscape()));
-
-    connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(appsUpdated(QList<ProtoTypes::SplitTunnelingApp>)), SLOT(onAppsSearchWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp>)));
-    connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(searchModeExited()), SLOT(onSearchModeExit()));
-    connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
-    connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(escape()), SLOT(onStAppsSearchEscape()));
-
-    connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(networkRoutesUpdated(QList<ProtoTypes::SplitTunnelingNetworkRoute>)), SLOT(onNetworkRoutesUpdated(QList<ProtoTypes::SplitTunnelingNetworkRoute>)));
-    connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
-    connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(escape()), SLOT(onIpsAndHostnameEscape()));
-
-    connect(networkWhiteListWindowItem_, SIGNAL(currentNetworkUpdated(ProtoTypes::NetworkInterface)), SLOT(onCurrentNetworkUpdated(ProtoTypes::NetworkInterface)));
     updatePositions();
 }
 
@@ -206,13 +163,13 @@ void PreferencesWindowItem::setCurrentTab(PREFERENCES_TAB_TYPE tab, CONNECTION_S
         if (subpage == CONNECTION_SCREEN_NETWORK_WHITELIST)
         {
             tabControlItem_->setCurrentTab(TAB_CONNECTION);
-            connectionWindowItem_->setScreen(CONNECTION_SCREEN_NETWORK_WHITELIST);
+            connectionWindowItem()->setScreen(CONNECTION_SCREEN_NETWORK_WHITELIST);
             onNetworkWhitelistPageClick();
         }
         else if (subpage == CONNECTION_SCREEN_SPLIT_TUNNELING)
         {
             tabControlItem_->setCurrentTab(TAB_CONNECTION);
-            connectionWindowItem_->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
+            connectionWindowItem()->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
             setPreferencesWindowToSplitTunnelingHome();
         }
     }
@@ -226,26 +183,62 @@ void PreferencesWindowItem::setScrollBarVisibility(bool on)
 void PreferencesWindowItem::setLoggedIn(bool loggedIn)
 {
     tabControlItem_->setLoggedIn(loggedIn);
-    accountWindowItem_->setLoggedIn(loggedIn);
-    splitTunnelingAppsWindowItem_->setLoggedIn(loggedIn);
-    splitTunnelingAppsSearchWindowItem_->setLoggedIn(loggedIn);
-    splitTunnelingIpsAndHostnamesWindowItem_->setLoggedIn(loggedIn);
+    isLoggedIn_ = loggedIn;
+    if (accountWindowItem_)
+    {
+        accountWindowItem_->setLoggedIn(loggedIn);
+    }
+    if (splitTunnelingAppsWindowItem_)
+    {
+        splitTunnelingAppsWindowItem_->setLoggedIn(loggedIn);
+    }
+    if (splitTunnelingAppsSearchWindowItem_)
+    {
+        splitTunnelingAppsSearchWindowItem_->setLoggedIn(loggedIn);
+    }
+    if (splitTunnelingIpsAndHostnamesWindowItem_)
+    {
+        splitTunnelingIpsAndHostnamesWindowItem_->setLoggedIn(loggedIn);
+    }
+
+    if (loggedIn)
+    {
+        warmUpTimer_.start(WARM_UP_DELAY_MS);
+    }
+    else
+    {
+        warmUpTimer_.stop();
+    }
 }
 
 void PreferencesWindowItem::setConfirmEmailResult(bool bSuccess)
 {
-    accountWindowItem_->setConfirmEmailResult(bSuccess);
+    if (accountWindowItem_)
+    {
+        accountWindowItem_->setConfirmEmailResult(bSuccess);
+    }
 }
 
 void PreferencesWindowItem::setDebugLogResult(bool bSuccess)
 {
-    debugWindowItem_->setDebugLogResult(bSuccess);
+    if (debugWindowItem_)
+    {
+        debugWindowItem_->setDebugLogResult(bSuccess);
+    }
 }
 
 void PreferencesWindowItem::updateNetworkState(ProtoTypes::NetworkInterface network)
 {
-    networkWhiteListWindowItem_->setCurrentNetwork(network);
-    connectionWindowItem_->setCurrentNetwork(network);
+    isCurrentNetworkSet_ = true;
+    currentNetwork_ = network;
+    if (networkWhiteListWindowItem_)
+    {
+        networkWhiteListWindowItem_->setCurrentNetwork(network);
+    }
+    if (connectionWindowItem_)
+    {
+        connectionWindowItem_->setCurrentNetwork(network);
+    }
 }
 
 void PreferencesWindowItem::onResizeStarted()
@@ -277,36 +270,36 @@ void PreferencesWindowItem::changeTab(PREFERENCES_TAB_TYPE tab)
     }
     else if (tab == TAB_ACCOUNT)
     {
-        scrollAreaItem_->setItem(accountWindowItem_);
-        accountWindowItem_->updateScaling();
+        scrollAreaItem_->setItem(accountWindowItem());
+        accountWindowItem()->updateScaling();
         setShowSubpageMode(false);
-        pageCaption_ = accountWindowItem_->caption();
+        pageCaption_ = accountWindowItem()->caption();
         update();
     }
     else if (tab == TAB_CONNECTION)
     {
-        scrollAreaItem_->setItem(connectionWindowItem_);
-        connectionWindowItem_->updateScaling();
-        connectionWindowItem_->setScreen(CONNECTION_SCREEN_HOME);
+        scrollAreaItem_->setItem(connectionWindowItem());
+        connectionWindowItem()->updateScaling();
+        connectionWindowItem()->setScreen(CONNECTION_SCREEN_HOME);
         setShowSubpageMode(false);
-        pageCaption_ = connectionWindowItem_->caption();
+        pageCaption_ = connectionWindowItem()->caption();
         update();
     }
     else if (tab == TAB_SHARE)
     {
-        scrollAreaItem_->setItem(shareWindowItem_);
-        shareWindowItem_->updateScaling();
+        scrollAreaItem_->setItem(shareWindowItem());
+        shareWindowItem()->updateScaling();
         setShowSubpageMode(false);
-        pageCaption_ = shareWindowItem_->caption();
+        pageCaption_ = shareWindowItem()->caption();
         update();
     }
     else if (tab == TAB_DEBUG)
     {
-        scrollAreaItem_->setItem(debugWindowItem_);
-        debugWindowItem_->updateScaling();
-        debugWindowItem_->setScreen(DEBUG_SCREEN_HOME);
+        scrollAreaItem_->setItem(debugWindowItem());
+        debugWindowItem()->updateScaling();
+        debugWindowItem()->setScreen(DEBUG_SCREEN_HOME);
         setShowSubpageMode(false);
-        pageCaption_ = debugWindowItem_->caption();
+        pageCaption_ = debugWindowItem()->caption();
         update();
     }
     else
@@ -326,7 +319,7 @@ void PreferencesWindowItem::moveOnePageBack()
 
     if (currentTab == TAB_CONNECTION)
     {
-        CONNECTION_SCREEN_TYPE screen = connectionWindowItem_->getScreen();
+        CONNECTION_SCREEN_TYPE screen = connectionWindowItem()->getScreen();
 
         if (screen == CONNECTION_SCREEN_NETWORK_WHITELIST)
         {
@@ -334,7 +327,7 @@ void PreferencesWindowItem::moveOnePageBack()
         }
         else if (screen == CONNECTION_SCREEN_SPLIT_TUNNELING)
         {
-            SPLIT_TUNNEL_SCREEN splitTunnelScreen = splitTunnelingWindowItem_->getScreen();
+            SPLIT_TUNNEL_SCREEN splitTunnelScreen = splitTunnelingWindowItem()->getScreen();
 
             if (splitTunnelScreen == SPLIT_TUNNEL_SCREEN_HOME)
             {
@@ -378,23 +371,23 @@ void PreferencesWindowItem::onBackArrowButtonClicked()
 
 void PreferencesWindowItem::onNetworkWhitelistPageClick()
 {
-    scrollAreaItem_->setItem(networkWhiteListWindowItem_);
-    networkWhiteListWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_NETWORK_WHITELIST);
+    scrollAreaItem_->setItem(networkWhiteListWindowItem());
+    networkWhiteListWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_NETWORK_WHITELIST);
     setShowSubpageMode(true);
-    pageCaption_ = networkWhiteListWindowItem_->caption();
+    pageCaption_ = networkWhiteListWindowItem()->caption();
     setFocus();
     update();
 }
 
 void PreferencesWindowItem::setPreferencesWindowToSplitTunnelingHome()
 {
-    scrollAreaItem_->setItem(splitTunnelingWindowItem_);
-    splitTunnelingWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
-    splitTunnelingWindowItem_->setScreen(SPLIT_TUNNEL_SCREEN_HOME);
+    scrollAreaItem_->setItem(splitTunnelingWindowItem());
+    splitTunnelingWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
+    splitTunnelingWindowItem()->setScreen(SPLIT_TUNNEL_SCREEN_HOME);
     setShowSubpageMode(true);
-    pageCaption_ = splitTunnelingWindowItem_->caption();
+    pageCaption_ = splitTunnelingWindowItem()->caption();
     setFocus();
     update();
 }
@@ -406,11 +399,11 @@ void PreferencesWindowItem::onSplitTunnelingPageClick()
 
 void PreferencesWindowItem::onProxySettingsPageClick()
 {
-    scrollAreaItem_->setItem(proxySettingsWindowItem_);
-    proxySettingsWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_PROXY_SETTINGS);
+    scrollAreaItem_->setItem(proxySettingsWindowItem());
+    proxySettingsWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_PROXY_SETTINGS);
     setShowSubpageMode(true);
-    pageCaption_ = proxySettingsWindowItem_->caption();
+    pageCaption_ = proxySettingsWindowItem()->caption();
     setFocus();
     update();
 }
@@ -430,31 +423,31 @@ void PreferencesWindowItem::onAdvParametersClick()
 
 void PreferencesWindowItem::setPreferencesWindowToSplitTunnelingAppsHome()
 {
-    scrollAreaItem_->setItem(splitTunnelingAppsWindowItem_);
-    splitTunnelingAppsWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
-    splitTunnelingWindowItem_->setScreen(SPLIT_TUNNEL_SCREEN_APPS);
+    scrollAreaItem_->setItem(splitTunnelingAppsWindowItem());
+    splitTunnelingAppsWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
+    splitTunnelingWindowItem()->setScreen(SPLIT_TUNNEL_SCREEN_APPS);
     setShowSubpageMode(true);
-    pageCaption_ = splitTunnelingAppsWindowItem_->caption();
+    pageCaption_ = splitTunnelingAppsWindowItem()->caption();
     update();
 }
 
 void PreferencesWindowItem::setPreferencesWindowToSplitTunnelingAppsSearch()
 {
-    scrollAreaItem_->setItem(splitTunnelingAppsSearchWindowItem_);
-    splitTunnelingAppsSearchWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
-    splitTunnelingWindowItem_->setScreen(SPLIT_TUNNEL_SCREEN_APPS_SEARCH);
-    splitTunnelingAppsSearchWindowItem_->updateProgramList();
+    scrollAreaItem_->setItem(splitTunnelingAppsSearchWindowItem());
+    splitTunnelingAppsSearchWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
+    splitTunnelingWindowItem()->setScreen(SPLIT_TUNNEL_SCREEN_APPS_SEARCH);
+    splitTunnelingAppsSearchWindowItem()->updateProgramList();
     setShowSubpageMode(true);
-    pageCaption_ = splitTunnelingAppsSearchWindowItem_->caption();
+    pageCaption_ = splitTunnelingAppsSearchWindowItem()->caption();
     update();
-    splitTunnelingAppsSearchWindowItem_->setFocusOnSearchBar();
+    splitTunnelingAppsSearchWindowItem()->setFocusOnSearchBar();
 }
 
 void PreferencesWindowItem::addApplicationManually(QString filename)
 {
-    QList<ProtoTypes::SplitTunnelingApp> apps = splitTunnelingAppsWindowItem_->getApps();
+    QList<ProtoTypes::SplitTunnelingApp> apps = splitTunnelingAppsWindowItem()->getApps();
 
     QString friendlyName = Utils::fileNameFromFullPath(filename);
 
@@ -466,8 +459,11 @@ void PreferencesWindowItem::addApplicationManually(QString filename)
     apps.append(app);
 
     updateSplitTunnelingAppsCount(apps);
-    splitTunnelingAppsWindowItem_->addAppManually(app); // handles setApps trickle down
-    splitTunnelingAppsSearchWindowItem_->setApps(apps);
+    splitTunnelingAppsWindowItem()->addAppManually(app); // handles setApps trickle down
+    if (splitTunnelingAppsSearchWindowItem_)
+    {
+        splitTunnelingAppsSearchWindowItem_->setApps(apps);
+    }
 }
 
 void PreferencesWindowItem::updateScaling()
@@ -482,22 +478,27 @@ void PreferencesWindowItem::updateScaling()
 
 void PreferencesWindowItem::updatePageSpecific()
 {
-    if (connectionWindowItem_->getScreen() == CONNECTION_SCREEN_SPLIT_TUNNELING
+    if (connectionWindowItem_ && splitTunnelingWindowItem_
+        && connectionWindowItem_->getScreen() == CONNECTION_SCREEN_SPLIT_TUNNELING
         && splitTunnelingWindowItem_->getScreen() == SPLIT_TUNNEL_SCREEN_APPS_SEARCH)
     {
-        splitTunnelingAppsSearchWindowItem_->updateProgramList();
+        splitTunnelingAppsSearchWindowItem()->updateProgramList();
     }
 }
 
 void PreferencesWindowItem::setPacketSizeDetectionState(bool on)
 {
-    connectionWindowItem_->setPacketSizeDetectionState(on);
+    isPacketSizeDetectionOn_ = on;
+    if (connectionWindowItem_)
+    {
+        connectionWindowItem_->setPacketSizeDetectionState(on);
+    }
 }
 
 void PreferencesWindowItem::showPacketSizeDetectionError(const QString &title,
                                                          const QString &message)
 {
-    connectionWindowItem_->showPacketSizeDetectionError(title, message);
+    connectionWindowItem()->showPacketSizeDetectionError(title, message);
 }
 
 void PreferencesWindowItem::onSplitTunnelingAppsClick()
@@ -512,14 +513,14 @@ void PreferencesWindowItem::onSplitTunnelingAppsSearchClick()
 
 void PreferencesWindowItem::onSplitTunnelingIpsAndHostnamesClick()
 {
-    scrollAreaItem_->setItem(splitTunnelingIpsAndHostnamesWindowItem_);
-    splitTunnelingIpsAndHostnamesWindowItem_->updateScaling();
-    connectionWindowItem_->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
-    splitTunnelingWindowItem_->setScreen(SPLIT_TUNNEL_SCREEN_IPS_AND_HOSTNAMES);
+    scrollAreaItem_->setItem(splitTunnelingIpsAndHostnamesWindowItem());
+    splitTunnelingIpsAndHostnamesWindowItem()->updateScaling();
+    connectionWindowItem()->setScreen(CONNECTION_SCREEN_SPLIT_TUNNELING);
+    splitTunnelingWindowItem()->setScreen(SPLIT_TUNNEL_SCREEN_IPS_AND_HOSTNAMES);
     setShowSubpageMode(true);
-    pageCaption_ = splitTunnelingIpsAndHostnamesWindowItem_->caption();
+    pageCaption_ = splitTunnelingIpsAndHostnamesWindowItem()->caption();
     update();
-    splitTunnelingIpsAndHostnamesWindowItem_->setFocusOnTextEntry();
+    splitTunnelingIpsAndHostnamesWindowItem()->setFocusOnTextEntry();
 }
 
 void PreferencesWindowItem::updateSplitTunnelingAppsCount(QList<ProtoTypes::SplitTunnelingApp> apps)
@@ -529,7 +530,7 @@ void PreferencesWindowItem::updateSplitTunnelingAppsCount(QList<ProtoTypes::Spli
     {
         if (app.active()) activeApps++;
     }
-    splitTunnelingWindowItem_->setAppsCount(activeApps);
+    splitTunnelingWindowItem()->setAppsCount(activeApps);
 }
 
 void PreferencesWindowItem::updatePositions()
@@ -549,18 +550,24 @@ void PreferencesWindowItem::updatePositions()
 void PreferencesWindowItem::onAppsSearchWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp> apps)
 {
     updateSplitTunnelingAppsCount(apps);
-    splitTunnelingAppsWindowItem_->setApps(apps);
+    if (splitTunnelingAppsWindowItem_)
+    {
+        splitTunnelingAppsWindowItem_->setApps(apps);
+    }
 }
 
 void PreferencesWindowItem::onAppsWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp> apps)
 {
     updateSplitTunnelingAppsCount(apps);
-    splitTunnelingAppsSearchWindowItem_->setApps(apps);
+    if (splitTunnelingAppsSearchWindowItem_)
+    {
+        splitTunnelingAppsSearchWindowItem_->setApps(apps);
+    }
 }
 
 void PreferencesWindowItem::onNetworkRoutesUpdated(QList<ProtoTypes::SplitTunnelingNetworkRoute> routes)
 {
-    splitTunnelingWindowItem_->setNetworkRoutesCount(routes.count());
+    splitTunnelingWindowItem()->setNetworkRoutesCount(routes.count());
 }
 
 void PreferencesWindowItem::onSearchModeExit()
@@ -588,6 +595,14 @@ void PreferencesWindowItem::onCurrentNetworkUpdated(ProtoTypes::NetworkInterface
     emit currentNetworkUpdated(network);
 }
 
+void PreferencesWindowItem::onWarmUpTimer()
+{
+    if (warmUpNextPage())
+    {
+        warmUpTimer_.start(WARM_UP_INTERVAL_MS);
+    }
+}
+
 void PreferencesWindowItem::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Escape)
@@ -618,6 +633,194 @@ QRectF PreferencesWindowItem::getBottomResizeArea()
     return QRectF(0, curHeight_ - BOTTOM_AREA_HEIGHT*G_SCALE, boundingRect().width(), BOTTOM_AREA_HEIGHT*G_SCALE );
 }
 
+AccountWindowItem *PreferencesWindowItem::accountWindowItem()
+{
+    if (!accountWindowItem_)
+    {
+        accountWindowItem_ = new AccountWindowItem(nullptr, accountInfo_);
+        accountWindowItem_->setLoggedIn(isLoggedIn_);
+        connect(accountWindowItem_, SIGNAL(sendConfirmEmailClick()), SIGNAL(sendConfirmEmailClick()));
+        connect(accountWindowItem_, SIGNAL(noAccountLoginClick()), SIGNAL(noAccountLoginClick()));
+        connect(accountWindowItem_, SIGNAL(editAccountDetailsClick()), SIGNAL(editAccountDetailsClick()));
+        connect(accountWindowItem_, SIGNAL(addEmailButtonClick()), SIGNAL(addEmailButtonClick()));
+    }
+    return accountWindowItem_;
+}
+
+ConnectionWindowItem *PreferencesWindowItem::connectionWindowItem()
+{
+    if (!connectionWindowItem_)
+    {
+        connectionWindowItem_ = new ConnectionWindowItem(nullptr, preferences_, preferencesHelper_);
+        if (isCurrentNetworkSet_)
+        {
+            connectionWindowItem_->setCurrentNetwork(currentNetwork_);
+        }
+        if (isPacketSizeDetectionOn_)
+        {
+            connectionWindowItem_->setPacketSizeDetectionState(true);
+        }
+        connect(connectionWindowItem_, SIGNAL(networkWhitelistPageClick()), SLOT(onNetworkWhitelistPageClick()));
+        connect(connectionWindowItem_, SIGNAL(splitTunnelingPageClick()), SLOT(onSplitTunnelingPageClick()));
+        connect(connectionWindowItem_, SIGNAL(proxySettingsPageClick()), SLOT(onProxySettingsPageClick()));
+        connect(connectionWindowItem_, SIGNAL(cycleMacAddressClick()), SIGNAL(cycleMacAddressClick()));
+        connect(connectionWindowItem_, SIGNAL(detectAppropriatePacketSizeButtonClicked()), SIGNAL(detectAppropriatePacketSizeButtonClicked()));
+    }
+    return connectionWindowItem_;
+}
+
+ShareWindowItem *PreferencesWindowItem::shareWindowItem()
+{
+    if (!shareWindowItem_)
+    {
+        shareWindowItem_ = new ShareWindowItem(nullptr, preferences_, preferencesHelper_);
+    }
+    return shareWindowItem_;
+}
+
+DebugWindowItem *PreferencesWindowItem::debugWindowItem()
+{
+    if (!debugWindowItem_)
+    {
+        debugWindowItem_ = new DebugWindowItem(nullptr, preferences_, preferencesHelper_);
+        connect(debugWindowItem_, SIGNAL(viewLogClick()), SIGNAL(viewLogClick()));
+        connect(debugWindowItem_, SIGNAL(sendLogClick()), SIGNAL(sendDebugLogClick()));
+        connect(debugWindowItem_, SIGNAL(advParametersClick()), SLOT(onAdvParametersClick()));
+#ifdef Q_OS_WIN
+        connect(debugWindowItem_, SIGNAL(setIpv6StateInOS(bool,bool)), SIGNAL(setIpv6StateInOS(bool,bool)));
+#endif
+    }
+    return debugWindowItem_;
+}
+
+NetworkWhiteListWindowItem *PreferencesWindowItem::networkWhiteListWindowItem()
+{
+    if (!networkWhiteListWindowItem_)
+    {
+        networkWhiteListWindowItem_ = new NetworkWhiteListWindowItem(nullptr, preferences_);
+        if (isCurrentNetworkSet_)
+        {
+            networkWhiteListWindowItem_->setCurrentNetwork(currentNetwork_);
+        }
+        connect(networkWhiteListWindowItem_, SIGNAL(currentNetworkUpdated(ProtoTypes::NetworkInterface)), SLOT(onCurrentNetworkUpdated(ProtoTypes::NetworkInterface)));
+    }
+    return networkWhiteListWindowItem_;
+}
+
+ProxySettingsWindowItem *PreferencesWindowItem::proxySettingsWindowItem()
+{
+    if (!proxySettingsWindowItem_)
+    {
+        proxySettingsWindowItem_ = new ProxySettingsWindowItem(nullptr, preferences_);
+    }
+    return proxySettingsWindowItem_;
+}
+
+SplitTunnelingWindowItem *PreferencesWindowItem::splitTunnelingWindowItem()
+{
+    if (!splitTunnelingWindowItem_)
+    {
+        splitTunnelingWindowItem_ = new SplitTunnelingWindowItem(nullptr, preferences_);
+        connect(splitTunnelingWindowItem_, SIGNAL(appsPageClick()), SLOT(onSplitTunnelingAppsClick()));
+        connect(splitTunnelingWindowItem_, SIGNAL(ipsAndHostnamesPageClick()), SLOT(onSplitTunnelingIpsAndHostnamesClick()));
+    }
+    return splitTunnelingWindowItem_;
+}
+
+SplitTunnelingAppsWindowItem *PreferencesWindowItem::splitTunnelingAppsWindowItem()
+{
+    if (!splitTunnelingAppsWindowItem_)
+    {
+        splitTunnelingAppsWindowItem_ = new SplitTunnelingAppsWindowItem(nullptr, preferences_);
+        splitTunnelingAppsWindowItem_->setLoggedIn(isLoggedIn_);
+        connect(splitTunnelingAppsWindowItem_, SIGNAL(searchButtonClicked()), SLOT(onSplitTunnelingAppsSearchClick()));
+        connect(splitTunnelingAppsWindowItem_, SIGNAL(addButtonClicked()), SIGNAL(splitTunnelingAppsAddButtonClick()));
+        connect(splitTunnelingAppsWindowItem_, SIGNAL(appsUpdated(QList<ProtoTypes::SplitTunnelingApp>)), SLOT(onAppsWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp>)));
+        connect(splitTunnelingAppsWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
+        connect(splitTunnelingAppsWindowItem_, SIGNAL(escape()), SLOT(onStAppsEscape()));
+    }
+    return splitTunnelingAppsWindowItem_;
+}
+
+SplitTunnelingAppsSearchWindowItem *PreferencesWindowItem::splitTunnelingAppsSearchWindowItem()
+{
+    if (!splitTunnelingAppsSearchWindowItem_)
+    {
+        splitTunnelingAppsSearchWindowItem_ = new SplitTunnelingAppsSearchWindowItem(nullptr, preferences_);
+        splitTunnelingAppsSearchWindowItem_->setLoggedIn(isLoggedIn_);
+        connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(appsUpdated(QList<ProtoTypes::SplitTunnelingApp>)), SLOT(onAppsSearchWindowAppsUpdated(QList<ProtoTypes::SplitTunnelingApp>)));
+        connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(searchModeExited()), SLOT(onSearchModeExit()));
+        connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
+        connect(splitTunnelingAppsSearchWindowItem_, SIGNAL(escape()), SLOT(onStAppsSearchEscape()));
+    }
+    return splitTunnelingAppsSearchWindowItem_;
+}
+
+SplitTunnelingIpsAndHostnamesWindowItem *PreferencesWindowItem::splitTunnelingIpsAndHostnamesWindowItem()
+{
+    if (!splitTunnelingIpsAndHostnamesWindowItem_)
+    {
+        splitTunnelingIpsAndHostnamesWindowItem_ = new SplitTunnelingIpsAndHostnamesWindowItem(nullptr, preferences_);
+        splitTunnelingIpsAndHostnamesWindowItem_->setLoggedIn(isLoggedIn_);
+        connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(networkRoutesUpdated(QList<ProtoTypes::SplitTunnelingNetworkRoute>)), SLOT(onNetworkRoutesUpdated(QList<ProtoTypes::SplitTunnelingNetworkRoute>)));
+        connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(nativeInfoErrorMessage(QString,QString)), SIGNAL(nativeInfoErrorMessage(QString,QString)));
+        connect(splitTunnelingIpsAndHostnamesWindowItem_, SIGNAL(escape()), SLOT(onIpsAndHostnameEscape()));
+    }
+    return splitTunnelingIpsAndHostnamesWindowItem_;
+}
+
+// creates the first page not created yet, returns false if all of them are created
+bool PreferencesWindowItem::warmUpNextPage()
+{
+    if (!connectionWindowItem_)
+    {
+        connectionWindowItem();
+    }
+    else if (!accountWindowItem_)
+    {
+        accountWindowItem();
+    }
+    else if (!debugWindowItem_)
+    {
+        debugWindowItem();
+    }
+    else if (!shareWindowItem_)
+    {
+        shareWindowItem();
+    }
+    else if (!networkWhiteListWindowItem_)
+    {
+        networkWhiteListWindowItem();
+    }
+    else if (!proxySettingsWindowItem_)
+    {
+        proxySettingsWindowItem();
+    }
+#ifndef Q_OS_LINUX
+    else if (!splitTunnelingWindowItem_)
+    {
+        splitTunnelingWindowItem();
+    }
+    else if (!splitTunnelingAppsWindowItem_)
+    {
+        splitTunnelingAppsWindowItem();
+    }
+    else if (!splitTunnelingAppsSearchWindowItem_)
+    {
+        splitTunnelingAppsSearchWindowItem();
+    }
+    else if (!splitTunnelingIpsAndHostnamesWindowItem_)
+    {
+        splitTunnelingIpsAndHostnamesWindowItem();
+    }
+#endif
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
 void PreferencesWindowItem::updateChildItemsAfterHeightChanged()
 {
     tabControlItem_->setHeight(curHeight_  - 99*G_SCALE);
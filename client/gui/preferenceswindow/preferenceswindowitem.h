@@ -3,6 +3,7 @@
 
 #include <QGraphicsObject>
 #include <QGraphicsView>
+#include <QTimer>
 #include "ipreferenceswindow.h"
 #include "bottomresizeitem.h"
 #include "scrollareaitem.h"
@@ -121,6 +122,8 @@ private slots:
 
     void onCurrentNetworkUpdated(ProtoTypes::NetworkInterface network);
 
+    void onWarmUpTimer();
+
 protected:
     void keyPressEvent(QKeyEvent *event) override;
 
@@ -133,6 +136,14 @@ private:
     static constexpr int BOTTOM_RESIZE_ORIGIN_X = 167;
     static constexpr int BOTTOM_RESIZE_OFFSET_Y = 13;
 
+    // the pages not created yet are created one per tick after the login
+    static constexpr int WARM_UP_DELAY_MS = 3000;
+    static constexpr int WARM_UP_INTERVAL_MS = 50;
+
+    Preferences *preferences_;
+    PreferencesHelper *preferencesHelper_;
+    AccountInfo *accountInfo_;
+
     BottomResizeItem *bottomResizeItem_;
     int curHeight_;
     double curScale_;
@@ -145,6 +156,8 @@ private:
     IPreferencesTabControl *tabControlItem_;
     ScrollAreaItem *scrollAreaItem_;
     GeneralWindowItem *generalWindowItem_;
+
+    // the rest of the pages are created on the first use (or by the warm-up), nullptr until then
     AccountWindowItem *accountWindowItem_;
     ConnectionWindowItem *connectionWindowItem_;
     ShareWindowItem *shareWindowItem_;
@@ -159,6 +172,14 @@ private:
     SplitTunnelingAppsSearchWindowItem *splitTunnelingAppsSearchWindowItem_;
     SplitTunnelingIpsAndHostnamesWindowItem *splitTunnelingIpsAndHostnamesWindowItem_;
 
+    // the state set before the pages were created
+    bool isLoggedIn_;
+    bool isCurrentNetworkSet_;
+    ProtoTypes::NetworkInterface currentNetwork_;
+    bool isPacketSizeDetectionOn_;
+
+    QTimer warmUpTimer_;
+
     bool isShowSubPage_;
     QString pageCaption_;
 
@@ -168,6 +189,18 @@ private:
     bool roundedFooter_;
     QColor footerColor_;
 
+    AccountWindowItem *accountWindowItem();
+    ConnectionWindowItem *connectionWindowItem();
+    ShareWindowItem *shareWindowItem();
+    DebugWindowItem *debugWindowItem();
+    NetworkWhiteListWindowItem *networkWhiteListWindowItem();
+    ProxySettingsWindowItem *proxySettingsWindowItem();
+    SplitTunnelingWindowItem *splitTunnelingWindowItem();
+    SplitTunnelingAppsWindowItem *splitTunnelingAppsWindowItem();
+    SplitTunnelingAppsSearchWindowItem *splitTunnelingAppsSearchWindowItem();
+    SplitTunnelingIpsAndHostnamesWindowItem *splitTunnelingIpsAndHostnamesWindowItem();
+    bool warmUpNextPage();
+
     void moveOnePageBack();
 
     void setShowSubpageMode(bool isShowSubPage);
@@ -29,9 +29,13 @@ ProxyGatewayItem::ProxyGatewayItem(ScalableGraphicsObject *parent, PreferencesHe
     comboBoxProxyType_->setCurrentItem(allProxyTypes.begin()->second);
     connect(comboBoxProxyType_, SIGNAL(currentItemChanged(QVariant)), SLOT(onProxyTypeItemChanged(QVariant)));
 
-    proxyIpAddressItem_ = new ProxyIpAddressItem(this, true);
+    proxyIpAddressItem_ = new ProxyIpAddressItem(this, false);
     connect(preferencesHelper, SIGNAL(proxyGatewayAddressChanged(QString)), SLOT(onProxyGatewayAddressChanged(QString)));
 
+    proxyTopTalkersItem_ = new ProxyTopTalkersItem(this);
+    proxyTopTalkersItem_->setTraffic(preferencesHelper->getProxyGatewayTraffic());
+    connect(preferencesHelper, SIGNAL(proxyGatewayTrafficChanged(ProtoTypes::ProxySharingTraffic)), SLOT(onProxyGatewayTrafficChanged(ProtoTypes::ProxySharingTraffic)));
+
     connect(&expandEnimation_, SIGNAL(valueChanged(QVariant)), SLOT(onExpandAnimationValueChanged(QVariant)));
     expandEnimation_.setStartValue(collapsedHeight_);
     expandEnimation_.setEndValue(expandedHeight_);
@@ -100,7 +104,7 @@ void ProxyGatewayItem::updateCollapsedAndExpandedHeights()
                                                             boundingRect().width() - 40*G_SCALE - checkBoxButton_->boundingRect().width(),
                                                             tr(descriptionText_.toStdString().c_str()), Qt::TextWordWrap);
     collapsedHeight_ = descriptionRect_.y() + descriptionRect_.height() + 10*G_SCALE;
-    expandedHeight_ = collapsedHeight_ + (43 + 43)*G_SCALE;
+    expandedHeight_ = collapsedHeight_ + (43 + 43 + ProxyTopTalkersItem::HEIGHT)*G_SCALE;
 }
 
 void ProxyGatewayItem::updatePositions()
@@ -111,6 +115,7 @@ void ProxyGatewayItem::updatePositions()
     line_->setPos(24*G_SCALE, collapsedHeight_ - 3*G_SCALE);
     comboBoxProxyType_->setPos(0, collapsedHeight_);
     proxyIpAddressItem_->setPos(0, collapsedHeight_ + comboBoxProxyType_->boundingRect().height());
+    proxyTopTalkersItem_->setPos(0, proxyIpAddressItem_->pos().y() + proxyIpAddressItem_->boundingRect().height());
 }
 
 void ProxyGatewayItem::onCheckBoxStateChanged(bool isChecked)
@@ -152,6 +157,11 @@ void ProxyGatewayItem::onProxyGatewayAddressChanged(const QString &address)
     proxyIpAddressItem_->setIP(address);
 }
 
+void ProxyGatewayItem::onProxyGatewayTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic)
+{
+    proxyTopTalkersItem_->setTraffic(traffic);
+}
+
 void ProxyGatewayItem::onLanguageChanged()
 {
     updateCollapsedAndExpandedHeights();
@@ -6,6 +6,7 @@
 #include "../comboboxitem.h"
 #include "commongraphics/checkboxbutton.h"
 #include "proxyipaddressitem.h"
+#include "proxytoptalkersitem.h"
 #include "backend/preferences/preferences.h"
 #include "backend/preferences/preferenceshelper.h"
 
@@ -31,6 +32,7 @@ private slots:
     void onProxyTypeItemChanged(QVariant v);
 
     void onProxyGatewayAddressChanged(const QString &address);
+    void onProxyGatewayTrafficChanged(const ProtoTypes::ProxySharingTraffic &traffic);
 
     void onLanguageChanged();
 
@@ -48,6 +50,7 @@ private:
     QVariantAnimation expandEnimation_;
     ComboBoxItem *comboBoxProxyType_;
     ProxyIpAddressItem *proxyIpAddressItem_;
+    ProxyTopTalkersItem *proxyTopTalkersItem_;
 
     ProtoTypes::ShareProxyGateway sp_;
     DividerLine *line_;
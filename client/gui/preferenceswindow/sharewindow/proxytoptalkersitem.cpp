@@ -0,0 +1,74 @@
+#include "proxytoptalkersitem.h"
+
+#include <QPainter>
+
+#include "../basepage.h"
+#include "graphicresources/fontmanager.h"
+#include "dpiscalemanager.h"
+#include "utils/utils.h"
+
+namespace PreferencesWindow {
+
+ProxyTopTalkersItem::ProxyTopTalkersItem(ScalableGraphicsObject *parent) : ScalableGraphicsObject(parent)
+{
+    line_ = new DividerLine(this, 276);
+    updatePositions();
+}
+
+QRectF ProxyTopTalkersItem::boundingRect() const
+{
+    return QRectF(0, 0, PAGE_WIDTH*G_SCALE, HEIGHT*G_SCALE);
+}
+
+void ProxyTopTalkersItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    qreal initialOpacity = painter->opacity();
+
+    painter->fillRect(boundingRect().adjusted(24*G_SCALE, 0, 0, 0), QBrush(QColor(16, 22, 40)));
+
+    QFont *font = FontManager::instance().getFont(12, true);
+    painter->setFont(*font);
+    painter->setPen(QColor(255, 255, 255));
+    QRectF rowRect(40*G_SCALE, 8*G_SCALE, boundingRect().width() - 56*G_SCALE, 24*G_SCALE);
+    painter->drawText(rowRect, Qt::AlignVCenter, tr("Top clients"));
+
+    painter->setOpacity(0.5 * initialOpacity);
+    rowRect.translate(0, 24*G_SCALE);
+    rowRect.setHeight(22*G_SCALE);
+    if (traffic_.top_clients_size() == 0)
+    {
+        painter->drawText(rowRect, Qt::AlignVCenter, tr("No traffic"));
+        return;
+    }
+    for (int i = 0; i < qMin(traffic_.top_clients_size(), ROWS_COUNT); ++i)
+    {
+        const ProtoTypes::ProxySharingClient &client = traffic_.top_clients(i);
+        painter->drawText(rowRect, Qt::AlignVCenter, QString::fromStdString(client.address()));
+        const QString rate = Utils::humanReadableByteCount(client.bytes_per_sec(), true) + tr("/s");
+        painter->drawText(rowRect, Qt::AlignRight | Qt::AlignVCenter,
+                          rate + "  " + Utils::humanReadableByteCount(client.bytes_total(), true));
+        rowRect.translate(0, 22*G_SCALE);
+    }
+}
+
+void ProxyTopTalkersItem::setTraffic(const ProtoTypes::ProxySharingTraffic &traffic)
+{
+    traffic_ = traffic;
+    update();
+}
+
+void ProxyTopTalkersItem::updateScaling()
+{
+    ScalableGraphicsObject::updateScaling();
+    updatePositions();
+}
+
+void ProxyTopTalkersItem::updatePositions()
+{
+    line_->setPos(24*G_SCALE, (HEIGHT - 3)*G_SCALE);
+}
+
+} // namespace PreferencesWindow
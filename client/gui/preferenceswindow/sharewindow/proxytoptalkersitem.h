@@ -0,0 +1,37 @@
+#ifndef PROXYTOPTALKERSITEM_H
+#define PROXYTOPTALKERSITEM_H
+
+#include "commongraphics/scalablegraphicsobject.h"
+#include "../dividerline.h"
+#include "utils/protobuf_includes.h"
+
+namespace PreferencesWindow {
+
+// the LAN clients of the proxy gateway with the most traffic, a row per client
+class ProxyTopTalkersItem : public ScalableGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProxyTopTalkersItem(ScalableGraphicsObject *parent);
+
+    static constexpr int ROWS_COUNT = 3;
+    static constexpr int HEIGHT = 8 + 24 + ROWS_COUNT * 22 + 8;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+    void setTraffic(const ProtoTypes::ProxySharingTraffic &traffic);
+
+    void updateScaling() override;
+
+private:
+    ProtoTypes::ProxySharingTraffic traffic_;
+    DividerLine *line_;
+
+    void updatePositions();
+};
+
+} // namespace PreferencesWindow
+
+#endif // PROXYTOPTALKERSITEM_H
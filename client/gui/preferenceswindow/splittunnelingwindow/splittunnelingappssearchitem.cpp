@@ -1,6 +1,9 @@
 #include "splittunnelingappssearchitem.h"
 
 #include <QFileInfo>
+#include <QRunnable>
+#include <functional>
+#include "utils/crashhandler.h"
 #include "utils/utils.h"
 #include "dpiscalemanager.h"
 #ifdef Q_OS_WIN
@@ -11,9 +14,75 @@
 
 namespace PreferencesWindow {
 
+namespace {
+
+class EnumerationTask : public QRunnable
+{
+public:
+    explicit EnumerationTask(std::function<void()> func) : func_(func) {}
+    void run() override
+    {
+        BIND_CRASH_HANDLER_FOR_THREAD();
+        func_();
+    }
+
+private:
+    std::function<void()> func_;
+};
+
+// runs on the pool, the installed programs of a machine may be hundreds
+QList<ProtoTypes::SplitTunnelingApp> enumerateSystemApps()
+{
+    QList<ProtoTypes::SplitTunnelingApp> systemApps;
+
+#ifdef Q_OS_WIN
+    const auto runningPrograms = WinUtils::enumerateRunningProgramLocations();
+    for (const QString &exePath : runningPrograms)
+    {
+        if (!exePath.contains("C:\\Windows")
+                && !exePath.contains("Windscribe.exe"))
+        {
+            QFile f(exePath);
+            QString name = QFileInfo(f).fileName();
+
+            ProtoTypes::SplitTunnelingApp app;
+            app.set_name(name.toStdString());
+            app.set_type(ProtoTypes::SPLIT_TUNNELING_APP_TYPE_SYSTEM);
+            app.set_full_name(exePath.toStdString());
+            systemApps.append(app);
+        }
+    }
+#elif defined Q_OS_MAC
+    const auto installedPrograms = MacUtils::enumerateInstalledPrograms();
+    for (const QString &binPath : installedPrograms)
+    {
+        if (!binPath.contains("Windscribe"))
+        {
+            QFile f(binPath);
+            QString name = QFileInfo(f).fileName();
+
+            ProtoTypes::SplitTunnelingApp app;
+            app.set_name(name.toStdString());
+            app.set_type(ProtoTypes::SPLIT_TUNNELING_APP_TYPE_SYSTEM);
+            app.set_full_name(binPath.toStdString());
+            systemApps.append(app);
+        }
+    }
+#elif defined Q_OS_LINUX
+        //todo linux
+        //Q_ASSERT(false);
+#endif
+
+    return systemApps;
+}
+
+} // namespace
+
 SplitTunnelingAppsSearchItem::SplitTunnelingAppsSearchItem(ScalableGraphicsObject *parent) : BaseItem(parent, 50)
-    , loggedIn_(false)
+    , loggedIn_(false), lastEnumerationId_(0)
 {
+    enumerationPool_.setMaxThreadCount(1);
+
     searchLineEditItem_ = new SearchLineEditItem(this);
     searchLineEditItem_->setPos(0, 0);
     connect(searchLineEditItem_, SIGNAL(textChanged(QString)), SLOT(onSearchTextChanged(QString)));
@@ -22,6 +91,12 @@ SplitTunnelingAppsSearchItem::SplitTunnelingAppsSearchItem(ScalableGraphicsObjec
     connect(searchLineEditItem_, SIGNAL(focusIn()), SLOT(onSearchBoxFocusIn()));
 }
 
+SplitTunnelingAppsSearchItem::~SplitTunnelingAppsSearchItem()
+{
+    // the task posts its result to this object
+    enumerationPool_.waitForDone();
+}
+
 void SplitTunnelingAppsSearchItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
     Q_UNUSED(painter);
@@ -144,7 +219,24 @@ void SplitTunnelingAppsSearchItem::toggleAppItemActive(AppSearchItem *item)
 
 void SplitTunnelingAppsSearchItem::updateProgramList()
 {
-    updateSystemApps();
+    updateDrawBasedOnFilterText(searchLineEditItem_->getText());
+
+    const int enumerationId = ++lastEnumerationId_;
+    enumerationPool_.start(new EnumerationTask([this, enumerationId]() {
+        const QList<ProtoTypes::SplitTunnelingApp> systemApps = enumerateSystemApps();
+        QMetaObject::invokeMethod(this, [this, enumerationId, systemApps]() {
+            onSystemAppsEnumerated(enumerationId, systemApps);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void SplitTunnelingAppsSearchItem::onSystemAppsEnumerated(int enumerationId, const QList<ProtoTypes::SplitTunnelingApp> &systemApps)
+{
+    if (enumerationId != lastEnumerationId_)
+    {
+        return;
+    }
+    systemApps_ = systemApps;
     updateDrawBasedOnFilterText(searchLineEditItem_->getText());
 }
 
@@ -317,49 +409,6 @@ void SplitTunnelingAppsSearchItem::removeAppFromApps(ProtoTypes::SplitTunnelingA
     }
 }
 
-void SplitTunnelingAppsSearchItem::updateSystemApps()
-{
-    systemApps_.clear();
-
-#ifdef Q_OS_WIN
-    const auto runningPrograms = WinUtils::enumerateRunningProgramLocations();
-    for (const QString &exePath : runningPrograms)
-    {
-        if (!exePath.contains("C:\\Windows")
-                && !exePath.contains("Windscribe.exe"))
-        {
-            QFile f(exePath);
-            QString name = QFileInfo(f).fileName();
-
-            ProtoTypes::SplitTunnelingApp app;
-            app.set_name(name.toStdString());
-            app.set_type(ProtoTypes::SPLIT_TUNNELING_APP_TYPE_SYSTEM);
-            app.set_full_name(exePath.toStdString());
-            systemApps_.append(app);
-        }
-    }
-#elif defined Q_OS_MAC
-    const auto installedPrograms = MacUtils::enumerateInstalledPrograms();
-    for (const QString &binPath : installedPrograms)
-    {
-        if (!binPath.contains("Windscribe"))
-        {
-            QFile f(binPath);
-            QString name = QFileInfo(f).fileName();
-
-            ProtoTypes::SplitTunnelingApp app;
-            app.set_name(name.toStdString());
-            app.set_type(ProtoTypes::SPLIT_TUNNELING_APP_TYPE_SYSTEM);
-            app.set_full_name(binPath.toStdString());
-            systemApps_.append(app);
-        }
-    }
-#elif defined Q_OS_LINUX
-        //todo linux
-        //Q_ASSERT(false);
-#endif
-}
-
 QList<ProtoTypes::SplitTunnelingApp> SplitTunnelingAppsSearchItem::activeAndSystemApps()
 {
     QList<ProtoTypes::SplitTunnelingApp> activeAndSystemApps;
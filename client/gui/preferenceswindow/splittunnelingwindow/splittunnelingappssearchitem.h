@@ -1,6 +1,7 @@
 #ifndef SPLITTUNNELINGAPPSSEARCHITEM_H
 #define SPLITTUNNELINGAPPSSEARCHITEM_H
 
+#include <QThreadPool>
 #include "../baseitem.h"
 #include "searchlineedititem.h"
 #include "appsearchitem.h"
@@ -12,6 +13,7 @@ class SplitTunnelingAppsSearchItem : public BaseItem
     Q_OBJECT
 public:
     explicit SplitTunnelingAppsSearchItem(ScalableGraphicsObject * parent);
+    ~SplitTunnelingAppsSearchItem() override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
 
     QList<ProtoTypes::SplitTunnelingApp> getApps();
@@ -20,6 +22,7 @@ public:
     void setLoggedIn(bool loggedIn);
 
     void toggleAppItemActive(AppSearchItem *item);
+    // the current list is drawn right away, the system apps are enumerated on the pool and drawn when ready
     void updateProgramList();
 
     void updateScaling() override;
@@ -58,7 +61,9 @@ private:
     void removeAppFromApps(ProtoTypes::SplitTunnelingApp app);
 
     QList<ProtoTypes::SplitTunnelingApp> systemApps_;
-    void updateSystemApps();
+    QThreadPool enumerationPool_;
+    int lastEnumerationId_;     // the results of the older enumerations are dropped
+    void onSystemAppsEnumerated(int enumerationId, const QList<ProtoTypes::SplitTunnelingApp> &systemApps);
     QList<ProtoTypes::SplitTunnelingApp> activeAndSystemApps();
     void emitNotLoggedInErrorMessage();
 
@@ -6,7 +6,11 @@ LocationsTrayMenuNative::LocationsTrayMenuNative(QWidget *parent) :
     QMenu(parent)
   , locationType_(LOCATIONS_TRAY_MENU_TYPE_GENERIC)
   , bIsFreeSession_(false)
+  , isMenuDirty_(false)
+  , isMenuOpen_(false)
 {
+    connect(this, SIGNAL(aboutToShow()), SLOT(onAboutToShow()));
+    connect(this, SIGNAL(aboutToHide()), SLOT(onAboutToHide()));
 }
 
 void LocationsTrayMenuNative::setMenuType(LocationsTrayMenuType type)
@@ -21,11 +25,26 @@ void LocationsTrayMenuNative::setMenuType(LocationsTrayMenuType type)
 void LocationsTrayMenuNative::setLocationsModel(LocationsModel *locationsModel)
 {
     connect(locationsModel->getAllLocationsModel(), SIGNAL(itemsUpdated(QVector<LocationModelItem*>)), SLOT(onItemsUpdated(QVector<LocationModelItem *>)));
+    connect(locationsModel->getAllLocationsModel(), SIGNAL(itemsChanged(QVector<LocationModelItem*>, LocationsModelDiff)), SLOT(onItemsUpdated(QVector<LocationModelItem *>)));
     connect(locationsModel->getAllLocationsModel(), SIGNAL(connectionSpeedChanged(LocationID,PingTime)), SLOT(onConnectionSpeedChanged(LocationID,PingTime)));
     connect(locationsModel->getAllLocationsModel(), SIGNAL(freeSessionStatusChanged(bool)), SLOT(onSessionStatusChanged(bool)));
     connect(locationsModel->getFavoriteLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onFavoritesUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getFavoriteLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onFavoritesUpdated(QVector<CityModelItem *>)));
     connect(locationsModel->getStaticIpsLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onStaticIpsUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getStaticIpsLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onStaticIpsUpdated(QVector<CityModelItem *>)));
     connect(locationsModel->getConfiguredLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onCustomConfigsUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getConfiguredLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onCustomConfigsUpdated(QVector<CityModelItem *>)));
+}
+
+void LocationsTrayMenuNative::onAboutToShow()
+{
+    isMenuOpen_ = true;
+    updateMenu();
+}
+
+void LocationsTrayMenuNative::onAboutToHide()
+{
+    isMenuOpen_ = false;
 }
 
 void LocationsTrayMenuNative::onMenuActionTriggered(QAction *action)
@@ -61,7 +80,7 @@ void LocationsTrayMenuNative::onItemsUpdated(QVector<LocationModelItem *> items)
             continue;
 
         LocationDesc desc;
-        desc.menu = nullptr;
+        desc.id = item->id;
         desc.name = item->title;
         desc.title = item->title;
         desc.countryCode = item->countryCode;
@@ -89,7 +108,7 @@ void LocationsTrayMenuNative::onItemsUpdated(QVector<LocationModelItem *> items)
         locationsDesc_.push_back(desc);
     }
 
-    rebuildMenu();
+    setMenuDirty();
 }
 
 void LocationsTrayMenuNative::onFavoritesUpdated(QVector<CityModelItem*> items)
@@ -106,7 +125,7 @@ void LocationsTrayMenuNative::onFavoritesUpdated(QVector<CityModelItem*> items)
             continue;
 
         LocationDesc desc;
-        desc.menu = nullptr;
+        desc.id = item->id;
         desc.name = desc.title = item->makeTitle();
         desc.countryCode = item->countryCode;
         desc.flags = ITEM_FLAG_IS_VALID;
@@ -120,7 +139,7 @@ void LocationsTrayMenuNative::onFavoritesUpdated(QVector<CityModelItem*> items)
         locationsDesc_.push_back(desc);
     }
 
-    rebuildMenu();
+    setMenuDirty();
 }
 
 void LocationsTrayMenuNative::onStaticIpsUpdated(QVector<CityModelItem*> items)
@@ -137,7 +156,7 @@ void LocationsTrayMenuNative::onStaticIpsUpdated(QVector<CityModelItem*> items)
             continue;
 
         LocationDesc desc;
-        desc.menu = nullptr;
+        desc.id = item->id;
         desc.name = desc.title = item->makeTitle();
         desc.countryCode = item->countryCode;
         desc.flags = ITEM_FLAG_IS_ENABLED | ITEM_FLAG_IS_VALID;
@@ -145,7 +164,7 @@ void LocationsTrayMenuNative::onStaticIpsUpdated(QVector<CityModelItem*> items)
         locationsDesc_.push_back(desc);
     }
 
-    rebuildMenu();
+    setMenuDirty();
 }
 
 void LocationsTrayMenuNative::onCustomConfigsUpdated(QVector<CityModelItem*> items)
@@ -161,7 +180,7 @@ void LocationsTrayMenuNative::onCustomConfigsUpdated(QVector<CityModelItem*> ite
         if (item->city.isEmpty())
             continue;
         LocationDesc desc;
-        desc.menu = nullptr;
+        desc.id = item->id;
         desc.name = desc.title = item->makeTitle();
         desc.flags = 0;
         if (!item->isDisabled && item->isCustomConfigCorrect)
@@ -170,14 +189,14 @@ void LocationsTrayMenuNative::onCustomConfigsUpdated(QVector<CityModelItem*> ite
         locationsDesc_.push_back(desc);
     }
 
-    rebuildMenu();
+    setMenuDirty();
 }
 
 void LocationsTrayMenuNative::onSessionStatusChanged(bool bFreeSessionStatus)
 {
     if (bIsFreeSession_ != bFreeSessionStatus) {
         bIsFreeSession_ = bFreeSessionStatus;
-        rebuildMenu();
+        setMenuDirty();
     }
 }
 
@@ -193,60 +212,127 @@ void LocationsTrayMenuNative::onConnectionSpeedChanged(LocationID id, PingTime t
         const bool wasEnabled = !!(desc.flags & ITEM_FLAG_IS_ENABLED);
         const bool isEnabled = (desc.flags & ITEM_FLAG_IS_VALID) && timeMs.toConnectionSpeed() != 0;
         if (wasEnabled != isEnabled) {
-            desc.flags |= ITEM_FLAG_IS_ENABLED;
-            rebuildMenu();
+            if (isEnabled)
+                desc.flags |= ITEM_FLAG_IS_ENABLED;
+            else
+                desc.flags &= ~ITEM_FLAG_IS_ENABLED;
+            setMenuDirty();
         }
     }
 }
 
-void LocationsTrayMenuNative::rebuildMenu()
+void LocationsTrayMenuNative::setMenuDirty()
+{
+    isMenuDirty_ = true;
+    // QWidget::isVisible() is false for the native menus
+    if (isMenuOpen_)
+        updateMenu();
+}
+
+void LocationsTrayMenuNative::updateMenu()
 {
-    clear();
+    if (!isMenuDirty_)
+        return;
+    isMenuDirty_ = false;
+
+    QHash<LocationID, MenuItem> oldItems;
+    oldItems.swap(menuItems_);
+    menuItems_.reserve(locationsDesc_.count());
+    QList<QAction *> newActions;
+    newActions.reserve(locationsDesc_.count());
+
+    for (const auto &desc : qAsConst(locationsDesc_)) {
+        const bool hasSubmenu = desc.cities.count() &&
+            (!(desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) || !bIsFreeSession_);
+        MenuItem item = oldItems.take(desc.id);
+        if (item.action && (item.submenu != nullptr) != hasSubmenu) {
+            deleteMenuItem(item);
+            item = MenuItem();
+        }
+        if (!item.action) {
+            if (hasSubmenu) {
+                item.submenu = new QMenu(this);
+                item.action = item.submenu->menuAction();
+                connect(item.submenu, SIGNAL(triggered(QAction*)),
+                        SLOT(onSubmenuActionTriggered(QAction*)));
+            } else {
+                item.action = new QAction(this);
+            }
+        }
+        updateMenuItem(item, desc);
+        menuItems_.insert(desc.id, item);
+        newActions.append(item.action);
+    }
+    for (auto &item : oldItems)
+        deleteMenuItem(item);
+
+    // the order of the locations changes rarely, then the kept actions are only re-added
+    if (actions() != newActions) {
+        const QList<QAction *> currentActions = actions();
+        for (QAction *action : currentActions)
+            removeAction(action);
+        addActions(newActions);
+    }
+}
 
-    for (auto &desc : locationsDesc_) {
-        desc.menu = nullptr;
-        QString itemName = desc.title;
-        if ((desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) && bIsFreeSession_)
-            itemName += " (Pro)";
+void LocationsTrayMenuNative::updateMenuItem(MenuItem &item, const LocationDesc &desc)
+{
+    QString itemName = desc.title;
+    if ((desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) && bIsFreeSession_)
+        itemName += " (Pro)";
 
-        QSharedPointer<IndependentPixmap> flag;
-        if (!desc.countryCode.isEmpty()) {
+    // the flag is rendered only for a new item, another country or another scale
+    const double scale = G_SCALE;
+    if (!desc.countryCode.isEmpty() && (item.countryCode != desc.countryCode || item.iconScale != scale)) {
 #if defined(Q_OS_MAC)
-            const int flags = ImageResourcesSvg::IMAGE_FLAG_SQUARE;
+        const int flags = ImageResourcesSvg::IMAGE_FLAG_SQUARE;
 #else
-            const int flags = 0;
+        const int flags = 0;
 #endif
-            flag = ImageResourcesSvg::instance().getScaledFlag(
-                desc.countryCode, 20 * G_SCALE, 10 * G_SCALE, flags);
-        }
+        QSharedPointer<IndependentPixmap> flag = ImageResourcesSvg::instance().getScaledFlag(
+            desc.countryCode, 20 * G_SCALE, 10 * G_SCALE, flags);
+        if (flag)
+            item.action->setIcon(flag->getIcon());
+        item.countryCode = desc.countryCode;
+        item.iconScale = scale;
+    } else if (desc.countryCode.isEmpty() && !item.countryCode.isEmpty()) {
+        item.action->setIcon(QIcon());
+        item.countryCode.clear();
+    }
 
-        if (desc.cities.count() && 
-            (!(desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) || !bIsFreeSession_)) {
-            desc.menu = addMenu(itemName);
-            desc.menu->setEnabled(!!(desc.flags & ITEM_FLAG_IS_ENABLED));
-            if (flag)
-                desc.menu->setIcon(flag->getIcon());
-            connect(desc.menu, SIGNAL(triggered(QAction*)),
-                    SLOT(onSubmenuActionTriggered(QAction*)));
-        } else {
-            QAction *action = addAction(itemName);
-            action->setEnabled(desc.cities.count() == 0 && (desc.flags & ITEM_FLAG_IS_ENABLED));
-            action->setWhatsThis(desc.name);
-            if (flag)
-                action->setIcon(flag->getIcon());
-        }
-        if (desc.menu) {
-            for (int i = 0; i < desc.cities.count(); ++i) {
-                const auto &city = desc.cities[i];
-                const bool isActionEnabled = !city.isPro || !bIsFreeSession_;
-                QString visibleName = city.cityName;
-                if (!isActionEnabled)
-                    visibleName += " (Pro)";
-                auto *action = desc.menu->addAction(visibleName);
-                action->setObjectName(city.cityName);
-                action->setWhatsThis(city.locationName);
-                action->setEnabled(isActionEnabled);
-            }
+    // the setters of QAction do nothing for the same values
+    if (item.submenu) {
+        item.submenu->setTitle(itemName);
+        item.submenu->setEnabled(!!(desc.flags & ITEM_FLAG_IS_ENABLED));
+
+        const QList<QAction *> cityActions = item.submenu->actions();
+        for (int i = 0; i < desc.cities.count(); ++i) {
+            const auto &city = desc.cities[i];
+            const bool isActionEnabled = !city.isPro || !bIsFreeSession_;
+            QString visibleName = city.cityName;
+            if (!isActionEnabled)
+                visibleName += " (Pro)";
+            QAction *action = i < cityActions.count() ? cityActions[i] : item.submenu->addAction(visibleName);
+            action->setText(visibleName);
+            action->setObjectName(city.cityName);
+            action->setWhatsThis(city.locationName);
+            action->setEnabled(isActionEnabled);
         }
+        for (int i = desc.cities.count(); i < cityActions.count(); ++i)
+            delete cityActions[i];
+    } else {
+        item.action->setText(itemName);
+        item.action->setEnabled(desc.cities.count() == 0 && (desc.flags & ITEM_FLAG_IS_ENABLED));
+        item.action->setWhatsThis(desc.name);
     }
 }
+
+void LocationsTrayMenuNative::deleteMenuItem(MenuItem &item)
+{
+    if (item.submenu)
+        delete item.submenu;
+    else
+        delete item.action;
+    item.submenu = nullptr;
+    item.action = nullptr;
+}
@@ -20,6 +20,8 @@ signals:
     void locationSelected(int type, QString locationTitle, int cityIndex);
 
 private slots:
+    void onAboutToShow();
+    void onAboutToHide();
     void onMenuActionTriggered(QAction *action);
     void onSubmenuActionTriggered(QAction *action);
     void onItemsUpdated(QVector<LocationModelItem*> items);
@@ -38,7 +40,7 @@ private:
     };
     struct LocationDesc
     {
-        QMenu *menu;
+        LocationID id;
         QString name;
         QString title;
         QString countryCode;
@@ -50,12 +52,29 @@ private:
     static constexpr int ITEM_FLAG_IS_VALID = 1 << 1;
     static constexpr int ITEM_FLAG_IS_PREMIUM_ONLY = 1 << 2;
 
-    void rebuildMenu();
+    // the action of a location, it's the menu action of the submenu for the locations with cities
+    struct MenuItem
+    {
+        QAction *action = nullptr;
+        QMenu *submenu = nullptr;
+        QString countryCode;
+        double iconScale = 0;
+    };
+
+    void setMenuDirty();
+    void updateMenu();
+    void updateMenuItem(MenuItem &item, const LocationDesc &desc);
+    static void deleteMenuItem(MenuItem &item);
 
     LocationsTrayMenuType locationType_;
     bool bIsFreeSession_;
     QVector<LocationDesc> locationsDesc_;
     QHash<LocationID, int> locationsMap_;
+    // the model updates only change the descriptions, the actions are updated when the menu is about to show
+    // (or at once while it's open) and are reused by LocationID
+    QHash<LocationID, MenuItem> menuItems_;
+    bool isMenuDirty_;
+    bool isMenuOpen_;
 };
 
 #endif // LOCATIONSTRAYMENUNATIVE_H
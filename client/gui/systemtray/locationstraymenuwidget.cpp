@@ -17,6 +17,7 @@ LocationsTrayMenuWidget::LocationsTrayMenuWidget(LocationsTrayMenuType type, QWi
     QWidget(parent)
   , locationType_(type)
   , bIsFreeSession_(false)
+  , isItemsDirty_(false)
   , currentSubmenu_(nullptr)
   , visibleItemsCount_(20)
 {
@@ -100,11 +101,15 @@ void LocationsTrayMenuWidget::handleMouseWheel()
 void LocationsTrayMenuWidget::setLocationsModel(LocationsModel *locationsModel)
 {
     connect(locationsModel->getAllLocationsModel(), SIGNAL(itemsUpdated(QVector<LocationModelItem*>)), SLOT(onItemsUpdated(QVector<LocationModelItem *>)));
+    connect(locationsModel->getAllLocationsModel(), SIGNAL(itemsChanged(QVector<LocationModelItem*>, LocationsModelDiff)), SLOT(onItemsUpdated(QVector<LocationModelItem *>)));
     connect(locationsModel->getAllLocationsModel(), SIGNAL(connectionSpeedChanged(LocationID,PingTime)), SLOT(onConnectionSpeedChanged(LocationID,PingTime)));
     connect(locationsModel->getAllLocationsModel(), SIGNAL(freeSessionStatusChanged(bool)), SLOT(onSessionStatusChanged(bool)));
     connect(locationsModel->getFavoriteLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onFavoritesUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getFavoriteLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onFavoritesUpdated(QVector<CityModelItem *>)));
     connect(locationsModel->getStaticIpsLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onStaticIpsUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getStaticIpsLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onStaticIpsUpdated(QVector<CityModelItem *>)));
     connect(locationsModel->getConfiguredLocationsModel(), SIGNAL(itemsUpdated(QVector<CityModelItem*>)), SLOT(onCustomConfigsUpdated(QVector<CityModelItem *>)));
+    connect(locationsModel->getConfiguredLocationsModel(), SIGNAL(itemsChanged(QVector<CityModelItem*>, LocationsModelDiff)), SLOT(onCustomConfigsUpdated(QVector<CityModelItem *>)));
 }
 
 void LocationsTrayMenuWidget::setFontForItems(const QFont &font)
@@ -177,18 +182,6 @@ void LocationsTrayMenuWidget::onScrollDownClick()
     updateBackground_mac();
 }
 
-void LocationsTrayMenuWidget::clearItems()
-{
-    map_.clear();
-    listWidget_->clear();
-
-    qDeleteAll(menuMap_);
-    menuMap_.clear();
-
-    downButton_->setVisible(false);
-    upButton_->setVisible(false);
-}
-
 void LocationsTrayMenuWidget::recalcSize()
 {
     QStyleOptionMenuItem opt;
@@ -240,85 +233,170 @@ void LocationsTrayMenuWidget::updateShortenedTexts()
     }
 }
 
+void LocationsTrayMenuWidget::updateItems()
+{
+    if (!isItemsDirty_)
+        return;
+    isItemsDirty_ = false;
+
+    // the list items are reused by LocationID, only the moved ones are taken and inserted again
+    QHash<LocationID, QListWidgetItem *> oldMap;
+    oldMap.swap(map_);
+    map_.reserve(items_.count());
+    for (int row = 0; row < items_.count(); ++row)
+    {
+        const ItemDesc &desc = items_[row];
+        QListWidgetItem *listItem = oldMap.take(desc.id);
+        if (!listItem)
+        {
+            listItem = new QListWidgetItem();
+            listWidget_->insertItem(row, listItem);
+        }
+        else if (listWidget_->item(row) != listItem)
+        {
+            listWidget_->takeItem(listWidget_->row(listItem));
+            listWidget_->insertItem(row, listItem);
+        }
+        updateListItem(listItem, desc);
+        map_[desc.id] = listItem;
+    }
+
+    // the rows after the new items are the removed locations
+    while (listWidget_->count() > items_.count())
+    {
+        QListWidgetItem *listItem = listWidget_->takeItem(listWidget_->count() - 1);
+        deleteSubmenu(listItem);
+        delete listItem;
+    }
+
+    recalcSize();
+    updateShortenedTexts();
+    updateButtonsState();
+    updateBackground_mac();
+}
+
+void LocationsTrayMenuWidget::setItemsDirty()
+{
+    isItemsDirty_ = true;
+    if (isVisible())
+        updateItems();
+}
+
+void LocationsTrayMenuWidget::setItems(QVector<ItemDesc> &&items)
+{
+    items_ = std::move(items);
+    itemsMap_.clear();
+    itemsMap_.reserve(items_.count());
+    for (int i = 0; i < items_.count(); ++i)
+        itemsMap_[items_[i].id] = i;
+    setItemsDirty();
+}
+
+void LocationsTrayMenuWidget::updateListItem(QListWidgetItem *listItem, const ItemDesc &desc)
+{
+    // QListWidgetItem::setData does nothing for the same value, so the unchanged items aren't repainted
+    QString itemName = desc.name;
+    if ((desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) && bIsFreeSession_)
+        itemName += " (Pro)";
+    // the custom config names are set by updateShortenedTexts()
+    if (locationType_ != LOCATIONS_TRAY_MENU_TYPE_CUSTOM_CONFIGS)
+        listItem->setText(itemName);
+    listItem->setData(USER_ROLE_FLAGS, desc.flags);
+    listItem->setData(USER_ROLE_TITLE, desc.title);
+    listItem->setData(USER_ROLE_ORIGINAL_NAME, desc.name);
+    listItem->setData(USER_ROLE_COUNTRY_CODE, desc.countryCode);
+
+    if (!(desc.flags & ITEM_FLAG_HAS_SUBMENU))
+    {
+        deleteSubmenu(listItem);
+        return;
+    }
+
+    LocationsTrayMenuWidgetSubmenu *submenu = menuMap_.value(listItem);
+    if (!submenu)
+    {
+        submenu = new LocationsTrayMenuWidgetSubmenu(this);
+        connect(submenu, SIGNAL(triggered(QAction*)), SLOT(onSubmenuActionTriggered(QAction*)));
+        menuMap_[listItem] = submenu;
+    }
+
+    QVector<bool> cityProInfo(desc.cities.count());
+    const QList<QAction *> cityActions = submenu->actions();
+    for (int i = 0; i < desc.cities.count(); ++i)
+    {
+        const CityDesc &city = desc.cities[i];
+        cityProInfo[i] = city.isPro;
+        const bool isEnabled = !city.isPro || !bIsFreeSession_;
+        QString visibleName = city.name;
+        if (!isEnabled)
+            visibleName += " (Pro)";
+        QAction *action = i < cityActions.count() ? cityActions[i] : submenu->addAction(visibleName);
+        action->setText(visibleName);
+        action->setObjectName(city.name);
+        action->setEnabled(isEnabled);
+    }
+    for (int i = desc.cities.count(); i < cityActions.count(); ++i)
+        delete cityActions[i];
+    listItem->setData(USER_ROLE_CITY_INFO, QVariant::fromValue(cityProInfo));
+}
+
+void LocationsTrayMenuWidget::deleteSubmenu(const QListWidgetItem *listItem)
+{
+    LocationsTrayMenuWidgetSubmenu *submenu = menuMap_.take(listItem);
+    if (!submenu)
+        return;
+    if (currentSubmenu_ == submenu)
+        currentSubmenu_ = nullptr;
+    delete submenu;
+}
+
 void LocationsTrayMenuWidget::onItemsUpdated(QVector<LocationModelItem *> items)
 {
     if (locationType_ != LOCATIONS_TRAY_MENU_TYPE_GENERIC)
         return;
 
-    clearItems();
-
+    QVector<ItemDesc> descs;
+    descs.reserve(items.count());
     for (const LocationModelItem *item: qAsConst(items))
     {
-        if (item->id.isCustomConfigsLocation())
+        if (item->id.isCustomConfigsLocation() || item->cities.isEmpty())
         {
             continue;
         }
 
-        QString itemName = item->title;
-        const QVector<CityModelItem> cities = item->cities;
+        ItemDesc desc;
+        desc.id = item->id;
+        desc.title = item->title;
+        desc.name = item->title;
+        desc.countryCode = item->countryCode;
 
-        if (cities.count() > 0)
+        bool containsAtLeastOneNonProCity = false;
+        desc.cities.resize(item->cities.count());
+        for (int i = 0; i < item->cities.count(); ++i)
         {
-            bool containsAtLeastOneNonProCity = false;
-            for (const CityModelItem &city: cities)
-            {
-                if (!city.bShowPremiumStarOnly)
-                {
-                    containsAtLeastOneNonProCity = true;
-                    break;
-                }
-            }
-
-            if (!containsAtLeastOneNonProCity && bIsFreeSession_)
-            {
-                itemName += " (Pro)";
-            }
-
-            QListWidgetItem *listItem = new QListWidgetItem(itemName);
-            listWidget_->addItem(listItem);
-
-            int itemFlags = ITEM_FLAG_IS_VALID | ITEM_FLAG_HAS_SUBMENU;
-            if (containsAtLeastOneNonProCity || !bIsFreeSession_)
-            {
-                const auto connectionSpeed = PingTime(item->calcAveragePing()).toConnectionSpeed();
-                if (connectionSpeed != 0)
-                    itemFlags |= ITEM_FLAG_IS_ENABLED;
-            }
-            if (!containsAtLeastOneNonProCity)
-                itemFlags |= ITEM_FLAG_IS_PREMIUM_ONLY;
-            if (!item->countryCode.isEmpty())
-                itemFlags |= ITEM_FLAG_HAS_COUNTRY;
-
-            listItem->setData(USER_ROLE_FLAGS, itemFlags);
-            listItem->setData(USER_ROLE_TITLE, item->title);
-            listItem->setData(USER_ROLE_ORIGINAL_NAME, item->title);
-            listItem->setData(USER_ROLE_COUNTRY_CODE, item->countryCode);
-
-            auto *submenu = new LocationsTrayMenuWidgetSubmenu(this);
-            QVector<bool> cityProInfo(cities.count());
-            for (int i = 0; i < cities.count(); ++i) {
-                const auto &city = cities[i];
-                QString cityName = city.makeTitle();
-                QString visibleName = cityName;
-                cityProInfo[i] = city.bShowPremiumStarOnly;
-                bool isEnabled = !city.bShowPremiumStarOnly || !bIsFreeSession_;
-                if (!isEnabled)
-                    visibleName += " (Pro)";
-                auto *action = submenu->addAction(visibleName);
-                action->setObjectName(cityName);
-                action->setEnabled(isEnabled);
-            }
-            connect(submenu, SIGNAL(triggered(QAction*)), SLOT(onSubmenuActionTriggered(QAction*)));
-            listItem->setData(USER_ROLE_CITY_INFO, QVariant::fromValue(cityProInfo));
+            const CityModelItem &city = item->cities[i];
+            desc.cities[i].name = city.makeTitle();
+            desc.cities[i].isPro = city.bShowPremiumStarOnly;
+            if (!city.bShowPremiumStarOnly)
+                containsAtLeastOneNonProCity = true;
+        }
 
-            map_[item->id] = listItem;
-            menuMap_[listItem] = submenu;
+        desc.flags = ITEM_FLAG_IS_VALID | ITEM_FLAG_HAS_SUBMENU;
+        if (containsAtLeastOneNonProCity || !bIsFreeSession_)
+        {
+            const auto connectionSpeed = PingTime(item->calcAveragePing()).toConnectionSpeed();
+            if (connectionSpeed != 0)
+                desc.flags |= ITEM_FLAG_IS_ENABLED;
         }
+        if (!containsAtLeastOneNonProCity)
+            desc.flags |= ITEM_FLAG_IS_PREMIUM_ONLY;
+        if (!item->countryCode.isEmpty())
+            desc.flags |= ITEM_FLAG_HAS_COUNTRY;
+
+        descs.push_back(desc);
     }
 
-    recalcSize();
-    updateButtonsState();
-    updateBackground_mac();
+    setItems(std::move(descs));
 }
 
 void LocationsTrayMenuWidget::onFavoritesUpdated(QVector<CityModelItem*> items)
@@ -326,40 +404,31 @@ void LocationsTrayMenuWidget::onFavoritesUpdated(QVector<CityModelItem*> items)
     if (locationType_ != LOCATIONS_TRAY_MENU_TYPE_FAVORITES)
         return;
 
-    clearItems();
-
+    QVector<ItemDesc> descs;
+    descs.reserve(items.count());
     for (const CityModelItem *item : qAsConst(items))
     {
         if (item->city.isEmpty())
             continue;
 
-        QString itemTitle = item->makeTitle();
-        QString itemName = itemTitle;
-        int itemFlags = ITEM_FLAG_IS_VALID;
+        ItemDesc desc;
+        desc.id = item->id;
+        desc.title = desc.name = item->makeTitle();
+        desc.countryCode = item->countryCode;
+        desc.flags = ITEM_FLAG_IS_VALID;
         if (item->bShowPremiumStarOnly && bIsFreeSession_) {
-            itemName += " (Pro)";
-            itemFlags |= ITEM_FLAG_IS_PREMIUM_ONLY;
+            desc.flags |= ITEM_FLAG_IS_PREMIUM_ONLY;
         } else {
             if (item->pingTimeMs != 0)
-                itemFlags |= ITEM_FLAG_IS_ENABLED;
+                desc.flags |= ITEM_FLAG_IS_ENABLED;
         }
         if (!item->countryCode.isEmpty())
-            itemFlags |= ITEM_FLAG_HAS_COUNTRY;
-
-        QListWidgetItem *listItem = new QListWidgetItem(itemName);
-        listWidget_->addItem(listItem);
+            desc.flags |= ITEM_FLAG_HAS_COUNTRY;
 
-        listItem->setData(USER_ROLE_FLAGS, itemFlags);
-        listItem->setData(USER_ROLE_TITLE, itemTitle);
-        listItem->setData(USER_ROLE_ORIGINAL_NAME, itemName);
-        listItem->setData(USER_ROLE_COUNTRY_CODE, item->countryCode);
-
-        map_[item->id] = listItem;
+        descs.push_back(desc);
     }
 
-    recalcSize();
-    updateButtonsState();
-    updateBackground_mac();
+    setItems(std::move(descs));
 }
 
 void LocationsTrayMenuWidget::onStaticIpsUpdated(QVector<CityModelItem*> items)
@@ -367,32 +436,25 @@ void LocationsTrayMenuWidget::onStaticIpsUpdated(QVector<CityModelItem*> items)
     if (locationType_ != LOCATIONS_TRAY_MENU_TYPE_STATIC_IPS)
         return;
 
-    clearItems();
-
+    QVector<ItemDesc> descs;
+    descs.reserve(items.count());
     for (const CityModelItem *item : qAsConst(items))
     {
         if (item->staticIp.isEmpty())
             continue;
 
-        const QString itemName = item->makeTitle();
-        QListWidgetItem *listItem = new QListWidgetItem(itemName);
-        listWidget_->addItem(listItem);
-
-        int itemFlags = ITEM_FLAG_IS_ENABLED | ITEM_FLAG_IS_VALID;
+        ItemDesc desc;
+        desc.id = item->id;
+        desc.title = desc.name = item->makeTitle();
+        desc.countryCode = item->countryCode;
+        desc.flags = ITEM_FLAG_IS_ENABLED | ITEM_FLAG_IS_VALID;
         if (!item->countryCode.isEmpty())
-            itemFlags |= ITEM_FLAG_HAS_COUNTRY;
+            desc.flags |= ITEM_FLAG_HAS_COUNTRY;
 
-        listItem->setData(USER_ROLE_FLAGS, itemFlags);
-        listItem->setData(USER_ROLE_TITLE, itemName);
-        listItem->setData(USER_ROLE_ORIGINAL_NAME, itemName);
-        listItem->setData(USER_ROLE_COUNTRY_CODE, item->countryCode);
-
-        map_[item->id] = listItem;
+        descs.push_back(desc);
     }
 
-    recalcSize();
-    updateButtonsState();
-    updateBackground_mac();
+    setItems(std::move(descs));
 }
 
 void LocationsTrayMenuWidget::onCustomConfigsUpdated(QVector<CityModelItem*> items)
@@ -400,32 +462,24 @@ void LocationsTrayMenuWidget::onCustomConfigsUpdated(QVector<CityModelItem*> ite
     if (locationType_ != LOCATIONS_TRAY_MENU_TYPE_CUSTOM_CONFIGS)
         return;
 
-    clearItems();
-
+    QVector<ItemDesc> descs;
+    descs.reserve(items.count());
     for (const CityModelItem *item : qAsConst(items))
     {
         if (item->city.isEmpty())
             continue;
 
-        const QString itemName = item->makeTitle();
-        QListWidgetItem *listItem = new QListWidgetItem(itemName);
-        listWidget_->addItem(listItem);
-
-        int itemFlags = 0;
+        ItemDesc desc;
+        desc.id = item->id;
+        desc.title = desc.name = item->makeTitle();
+        desc.flags = 0;
         if (!item->isDisabled && item->isCustomConfigCorrect)
-            itemFlags |= ITEM_FLAG_IS_ENABLED | ITEM_FLAG_IS_VALID;
+            desc.flags |= ITEM_FLAG_IS_ENABLED | ITEM_FLAG_IS_VALID;
 
-        listItem->setData(USER_ROLE_FLAGS, itemFlags);
-        listItem->setData(USER_ROLE_TITLE, itemName);
-        listItem->setData(USER_ROLE_ORIGINAL_NAME, itemName);
-
-        map_[item->id] = listItem;
+        descs.push_back(desc);
     }
 
-    recalcSize();
-    updateShortenedTexts();
-    updateButtonsState();
-    updateBackground_mac();
+    setItems(std::move(descs));
 }
 
 void LocationsTrayMenuWidget::onSessionStatusChanged(bool bFreeSessionStatus)
@@ -436,36 +490,14 @@ void LocationsTrayMenuWidget::onSessionStatusChanged(bool bFreeSessionStatus)
         locationType_ != LOCATIONS_TRAY_MENU_TYPE_FAVORITES)
         return;
 
-    for (int ind = 0; ind < listWidget_->count(); ++ind)
+    for (ItemDesc &desc : items_)
     {
-        QListWidgetItem *item = listWidget_->item(ind);
-
-        QString itemName = item->data(USER_ROLE_ORIGINAL_NAME).toString();
-        int flags = item->data(USER_ROLE_FLAGS).toInt();
-
-        if ((flags & ITEM_FLAG_IS_PREMIUM_ONLY) && bIsFreeSession_) {
-            itemName += " (Pro)";
-            flags &= ~ITEM_FLAG_IS_ENABLED;
-        } else if (flags & ITEM_FLAG_IS_VALID) {
-            flags |= ITEM_FLAG_IS_ENABLED;
-        }
-        item->setText(itemName);
-        item->setData(USER_ROLE_FLAGS, flags);
-
-        auto *submenu = menuMap_[item];
-        if (submenu) {
-            const auto cityProInfo = item->data(USER_ROLE_CITY_INFO).value<QVector<bool>>();
-            for (int i = 0; i < submenu->actions().count(); ++i) {
-                auto *action = submenu->actions().at(i);
-                QString visibleName = action->objectName();
-                bool isEnabled = !cityProInfo[i] || !bIsFreeSession_;
-                if (!isEnabled)
-                    visibleName += " (Pro)";
-                action->setText(visibleName);
-                action->setEnabled(isEnabled);
-            }
-        }
+        if ((desc.flags & ITEM_FLAG_IS_PREMIUM_ONLY) && bIsFreeSession_)
+            desc.flags &= ~ITEM_FLAG_IS_ENABLED;
+        else if (desc.flags & ITEM_FLAG_IS_VALID)
+            desc.flags |= ITEM_FLAG_IS_ENABLED;
     }
+    setItemsDirty();
 }
 
 void LocationsTrayMenuWidget::onConnectionSpeedChanged(LocationID id, PingTime timeMs)
@@ -474,16 +506,20 @@ void LocationsTrayMenuWidget::onConnectionSpeedChanged(LocationID id, PingTime t
         locationType_ != LOCATIONS_TRAY_MENU_TYPE_FAVORITES)
         return;
 
-    auto it = map_.find(id);
-    if (it != map_.end())
+    auto it = itemsMap_.find(id);
+    if (it != itemsMap_.end())
     {
-        QListWidgetItem *item = it.value();
-        int flags = item->data(USER_ROLE_FLAGS).toInt();
+        ItemDesc &desc = items_[it.value()];
+        int flags = desc.flags;
         if ((flags & ITEM_FLAG_IS_VALID) && timeMs.toConnectionSpeed() != 0)
             flags |= ITEM_FLAG_IS_ENABLED;
         else
             flags &= ~ITEM_FLAG_IS_ENABLED;
-        item->setData(USER_ROLE_FLAGS, flags);
+        if (flags != desc.flags)
+        {
+            desc.flags = flags;
+            setItemsDirty();
+        }
     }
 }
 
@@ -45,6 +45,8 @@ public:
 
     void setLocationsModel(LocationsModel *locationsModel);
     void setFontForItems(const QFont &font);
+    // applies the model updates received while the menu was closed, call it before the menu is shown
+    void updateItems();
 
     static constexpr int USER_ROLE_FLAGS = Qt::UserRole + 1;
     static constexpr int USER_ROLE_TITLE = Qt::UserRole + 2;
@@ -76,8 +78,27 @@ private slots:
     void onConnectionSpeedChanged(LocationID id, PingTime timeMs);
 
 private:
+    struct CityDesc
+    {
+        QString name;
+        bool isPro;
+    };
+    struct ItemDesc
+    {
+        LocationID id;
+        QString title;          // USER_ROLE_TITLE
+        QString name;           // USER_ROLE_ORIGINAL_NAME, without the " (Pro)" suffix
+        QString countryCode;
+        int flags;
+        QVector<CityDesc> cities;
+    };
+
     LocationsTrayMenuType locationType_;
     bool bIsFreeSession_;
+    // the model updates change items_ only, the list is updated from it when the menu is visible
+    QVector<ItemDesc> items_;
+    QHash<LocationID, int> itemsMap_;
+    bool isItemsDirty_;
     QHash<LocationID, QListWidgetItem *> map_;
     QHash<const QListWidgetItem *, LocationsTrayMenuWidgetSubmenu *> menuMap_;
     LocationsTrayMenuItemDelegate *locationsTrayMenuItemDelegate_;
@@ -87,7 +108,10 @@ private:
     LocationsTrayMenuButton *downButton_;
     int visibleItemsCount_;
 
-    void clearItems();
+    void setItemsDirty();
+    void setItems(QVector<ItemDesc> &&items);
+    void updateListItem(QListWidgetItem *listItem, const ItemDesc &desc);
+    void deleteSubmenu(const QListWidgetItem *listItem);
     void recalcSize();
     void updateShortenedTexts();
     void updateSubmenuForSelection();
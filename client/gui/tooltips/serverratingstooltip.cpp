@@ -5,6 +5,7 @@
 #include "commongraphics/commongraphics.h"
 #include "graphicresources/fontmanager.h"
 #include "dpiscalemanager.h"
+#include "idlemodecontroller.h"
 
 ServerRatingsTooltip::ServerRatingsTooltip(QWidget *parent) : ITooltip(parent)
   , state_(SERVER_RATING_NONE)
@@ -29,6 +30,7 @@ ServerRatingsTooltip::ServerRatingsTooltip(QWidget *parent) : ITooltip(parent)
     hoverTimer_.setInterval(50);
     hoverTimer_.setSingleShot(false);
     connect(&hoverTimer_, SIGNAL(timeout()), SLOT(onHoverTimerTick()));
+    IdleModeController::instance().addAnimationTimer(&hoverTimer_);
 
     updateScaling();
 }
@@ -56,6 +56,7 @@ ProtoEnumToString::ProtoEnumToString()
     map_["DNS_POLICY_CLOUDFLARE"] = "Cloudflare";
     map_["DNS_POLICY_GOOGLE"] = "Google";
     map_["DNS_POLICY_CONTROLD"] = "ControlD";
+    map_["DNS_POLICY_CLOUDFLARE_DOH"] = "Cloudflare (DoH)";
 
     map_["DNS_MANAGER_AUTOMATIC"] = "Automatic";
     map_["DNS_MANAGER_RESOLV_CONF"] = "Resolvconf";
@@ -3,15 +3,20 @@
 #include <QScreen>
 #include <QWindow>
 #include <QMessageBox>
+#include <QStandardPaths>
+#include <QScopeGuard>
 #include "gui/dpiscalemanager.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
 #include "utils/extraconfig.h"
+#include "utils/eventloopwatchdog.h"
+#include "utils/settingsstore.h"
 #include "version/appversion.h"
 #include "engine/openvpnversioncontroller.h"
 #include "gui/application/windscribeapplication.h"
 #include "gui/graphicresources/imageresourcessvg.h"
 #include "gui/application/singleappinstance.h"
+#include "gui/locationsbenchmark.h"
 
 #ifdef Q_OS_WIN
     #include "gui/utils/scaleutils_win.h"
@@ -139,6 +144,8 @@ int main(int argc, char *argv[])
 #endif
 
     Logger::instance().install("gui", true, false);
+    // on any return from main(), not in the static destructor of the logger
+    auto stopLogger = qScopeGuard([] { Logger::instance().stop(); });
 
     qCDebug(LOG_BASIC) << "App start time:" << QDateTime::currentDateTime().toString();
     qCDebug(LOG_BASIC) << "App version:" << AppVersion::instance().fullVersionString();
@@ -193,13 +200,36 @@ int main(int argc, char *argv[])
 
     DpiScaleManager::instance();    // init dpi scale manager
 
+    // --benchmark-locations [report file]: the rendering benchmark of the locations window instead of the app
+    const int benchmarkArgInd = a.arguments().indexOf("--benchmark-locations");
+    if (benchmarkArgInd != -1)
+    {
+        QString reportPath = a.arguments().value(benchmarkArgInd + 1);
+        if (reportPath.isEmpty() || reportPath.startsWith("--"))
+        {
+            reportPath = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/locations_benchmark.txt";
+        }
+        LocationsBenchmark benchmark(reportPath);
+        benchmark.start();
+        int ret = a.exec();
+        ImageResourcesSvg::instance().finishGracefully();
+        appSingleInstGuard.release();
+        return ret;
+    }
+
     MainWindow w;
 #if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
     g_MainWindow = &w;
 #endif
     w.showAfterLaunch();
 
+    EventLoopWatchdog::instance().watch(QThread::currentThread(), "GUI");
+
     int ret = a.exec();
+
+    EventLoopWatchdog::instance().unwatch(QThread::currentThread());
+    EventLoopWatchdog::instance().stop();
+    SettingsStore::instance().flush();
 #if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
     g_MainWindow = nullptr;
 #endif
@@ -1,6 +1,7 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include <string>
 #include <vector>
 
 namespace IPC
@@ -14,6 +15,11 @@ public:
 
     virtual std::vector<char> getData() const = 0;
 
+    // serialization to the buffer of the caller: getDataSize() must be called right before writeData(),
+    // buf has getDataSize() bytes
+    virtual size_t getDataSize() const = 0;
+    virtual void writeData(char *buf) const = 0;
+
     // return unique static string ID for command
     virtual std::string getStringId() const = 0;
 
@@ -7,366 +7,404 @@
 namespace IPC
 {
 
-Command *CommandFactory::makeCommand(const std::string strId, char *buf, int size)
+namespace
+{
+
+template<class T> Command *make(char *buf, int size, google::protobuf::Arena *arena)
+{
+    if (arena)
+    {
+        return google::protobuf::Arena::Create<ProtobufCommand<T> >(arena, buf, size, arena);
+    }
+    return new ProtobufCommand<T>(buf, size);
+}
+
+} // namespace
+
+Command *CommandFactory::makeCommand(const std::string &strId, char *buf, int size, google::protobuf::Arena *arena)
 {
     // client commands
     if (strId == IPCClientCommands::ClientAuth::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ClientAuth>(buf, size);
+        return make<IPCClientCommands::ClientAuth>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::ClientPing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ClientPing>(buf, size);
+        return make<IPCClientCommands::ClientPing>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Init::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Init>(buf, size);
+        return make<IPCClientCommands::Init>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::GetState::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::GetState>(buf, size);
+        return make<IPCClientCommands::GetState>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Cleanup::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Cleanup>(buf, size);
+        return make<IPCClientCommands::Cleanup>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::GetSettings::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::GetSettings>(buf, size);
+        return make<IPCClientCommands::GetSettings>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SetSettings::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SetSettings>(buf, size);
+        return make<IPCClientCommands::SetSettings>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Login::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Login>(buf, size);
+        return make<IPCClientCommands::Login>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SignOut::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SignOut>(buf, size);
+        return make<IPCClientCommands::SignOut>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Connect::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Connect>(buf, size);
+        return make<IPCClientCommands::Connect>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Disconnect::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Disconnect>(buf, size);
+        return make<IPCClientCommands::Disconnect>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::Firewall::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::Firewall>(buf, size);
+        return make<IPCClientCommands::Firewall>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::EnableBfe_win::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::EnableBfe_win>(buf, size);
+        return make<IPCClientCommands::EnableBfe_win>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::ApplicationActivated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ApplicationActivated>(buf, size);
+        return make<IPCClientCommands::ApplicationActivated>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::RecordInstall::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::RecordInstall>(buf, size);
+        return make<IPCClientCommands::RecordInstall>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SendConfirmEmail::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SendConfirmEmail>(buf, size);
+        return make<IPCClientCommands::SendConfirmEmail>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SendDebugLog::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SendDebugLog>(buf, size);
+        return make<IPCClientCommands::SendDebugLog>(buf, size, arena);
+    }
+    else if (strId == IPCClientCommands::GetThroughputHistory::descriptor()->full_name())
+    {
+        return make<IPCClientCommands::GetThroughputHistory>(buf, size, arena);
+    }
+    else if (strId == IPCClientCommands::StartTunnelSpeedTest::descriptor()->full_name())
+    {
+        return make<IPCClientCommands::StartTunnelSpeedTest>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::GetWebSessionToken::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::GetWebSessionToken>(buf, size);
+        return make<IPCClientCommands::GetWebSessionToken>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SetBlockConnect::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SetBlockConnect>(buf, size);
+        return make<IPCClientCommands::SetBlockConnect>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::ClearCredentials::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ClearCredentials>(buf, size);
+        return make<IPCClientCommands::ClearCredentials>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::StartWifiSharing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::StartWifiSharing>(buf, size);
+        return make<IPCClientCommands::StartWifiSharing>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::StopWifiSharing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::StopWifiSharing>(buf, size);
+        return make<IPCClientCommands::StopWifiSharing>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::StartProxySharing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::StartProxySharing>(buf, size);
+        return make<IPCClientCommands::StartProxySharing>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::StopProxySharing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::StopProxySharing>(buf, size);
+        return make<IPCClientCommands::StopProxySharing>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::EmergencyConnect::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::EmergencyConnect>(buf, size);
+        return make<IPCClientCommands::EmergencyConnect>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::EmergencyDisconnect::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::EmergencyDisconnect>(buf, size);
+        return make<IPCClientCommands::EmergencyDisconnect>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SpeedRating::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SpeedRating>(buf, size);
+        return make<IPCClientCommands::SpeedRating>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::GotoCustomOvpnConfigMode::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::GotoCustomOvpnConfigMode>(buf, size);
+        return make<IPCClientCommands::GotoCustomOvpnConfigMode>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::ContinueWithCredentialsForOvpnConfig::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ContinueWithCredentialsForOvpnConfig>(buf, size);
+        return make<IPCClientCommands::ContinueWithCredentialsForOvpnConfig>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::GetIpv6StateInOS::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::GetIpv6StateInOS>(buf, size);
+        return make<IPCClientCommands::GetIpv6StateInOS>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SetIpv6StateInOS::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SetIpv6StateInOS>(buf, size);
+        return make<IPCClientCommands::SetIpv6StateInOS>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::SplitTunneling::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::SplitTunneling>(buf, size);
+        return make<IPCClientCommands::SplitTunneling>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::ForceCliStateUpdate::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::ForceCliStateUpdate>(buf, size);
+        return make<IPCClientCommands::ForceCliStateUpdate>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::DetectPacketSize::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::DetectPacketSize>(buf, size);
+        return make<IPCClientCommands::DetectPacketSize>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::UpdateVersion::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::UpdateVersion>(buf,size);
+        return make<IPCClientCommands::UpdateVersion>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::UpdateWindowInfo::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::UpdateWindowInfo>(buf, size);
+        return make<IPCClientCommands::UpdateWindowInfo>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::MakeHostsWritableWin::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::MakeHostsWritableWin>(buf, size);
+        return make<IPCClientCommands::MakeHostsWritableWin>(buf, size, arena);
     }
     else if (strId == IPCClientCommands::AdvancedParametersChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCClientCommands::AdvancedParametersChanged>(buf, size);
+        return make<IPCClientCommands::AdvancedParametersChanged>(buf, size, arena);
     }
     // servers commands
     else if (strId == IPCServerCommands::AuthReply::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::AuthReply>(buf, size);
+        return make<IPCServerCommands::AuthReply>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::InitFinished::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::InitFinished>(buf, size);
+        return make<IPCServerCommands::InitFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::FirewallStateChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::FirewallStateChanged>(buf, size);
+        return make<IPCServerCommands::FirewallStateChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LoginFinished::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LoginFinished>(buf, size);
+        return make<IPCServerCommands::LoginFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LoginStepMessage::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LoginStepMessage>(buf, size);
+        return make<IPCServerCommands::LoginStepMessage>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LoginError::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LoginError>(buf, size);
+        return make<IPCServerCommands::LoginError>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::EngineSettingsChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::EngineSettingsChanged>(buf, size);
+        return make<IPCServerCommands::EngineSettingsChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LocationSpeedChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LocationSpeedChanged>(buf, size);
+        return make<IPCServerCommands::LocationSpeedChanged>(buf, size, arena);
+    }
+    else if (strId == IPCServerCommands::LocationsSpeedChanged::descriptor()->full_name())
+    {
+        return make<IPCServerCommands::LocationsSpeedChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::NetworkChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::NetworkChanged>(buf, size);
+        return make<IPCServerCommands::NetworkChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::ConfirmEmailResult::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::ConfirmEmailResult>(buf, size);
+        return make<IPCServerCommands::ConfirmEmailResult>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::DebugLogResult::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::DebugLogResult>(buf, size);
+        return make<IPCServerCommands::DebugLogResult>(buf, size, arena);
+    }
+    else if (strId == IPCServerCommands::TunnelSpeedTestFinished::descriptor()->full_name())
+    {
+        return make<IPCServerCommands::TunnelSpeedTestFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::StatisticsUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::StatisticsUpdated>(buf, size);
+        return make<IPCServerCommands::StatisticsUpdated>(buf, size, arena);
+    }
+    else if (strId == IPCServerCommands::ThroughputUpdated::descriptor()->full_name())
+    {
+        return make<IPCServerCommands::ThroughputUpdated>(buf, size, arena);
+    }
+    else if (strId == IPCServerCommands::ThroughputHistoryUpdated::descriptor()->full_name())
+    {
+        return make<IPCServerCommands::ThroughputHistoryUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::CleanupFinished::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::CleanupFinished>(buf, size);
+        return make<IPCServerCommands::CleanupFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::RequestCredentialsForOvpnConfig::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::RequestCredentialsForOvpnConfig>(buf, size);
+        return make<IPCServerCommands::RequestCredentialsForOvpnConfig>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::Ipv6StateInOS::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::Ipv6StateInOS>(buf, size);
+        return make<IPCServerCommands::Ipv6StateInOS>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::SessionStatusUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::SessionStatusUpdated>(buf, size);
+        return make<IPCServerCommands::SessionStatusUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LocationsUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LocationsUpdated>(buf, size);
+        return make<IPCServerCommands::LocationsUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::BestLocationUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::BestLocationUpdated>(buf, size);
+        return make<IPCServerCommands::BestLocationUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::CustomConfigLocationsUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::CustomConfigLocationsUpdated>(buf, size);
+        return make<IPCServerCommands::CustomConfigLocationsUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::ConnectStateChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::ConnectStateChanged>(buf, size);
+        return make<IPCServerCommands::ConnectStateChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::ProxySharingInfoChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::ProxySharingInfoChanged>(buf, size);
+        return make<IPCServerCommands::ProxySharingInfoChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::WifiSharingInfoChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::WifiSharingInfoChanged>(buf, size);
+        return make<IPCServerCommands::WifiSharingInfoChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::EmergencyConnectStateChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::EmergencyConnectStateChanged>(buf, size);
+        return make<IPCServerCommands::EmergencyConnectStateChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::SignOutFinished::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::SignOutFinished>(buf, size);
+        return make<IPCServerCommands::SignOutFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::NotificationsUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::NotificationsUpdated>(buf, size);
+        return make<IPCServerCommands::NotificationsUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::CheckUpdateInfoUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::CheckUpdateInfoUpdated>(buf, size);
+        return make<IPCServerCommands::CheckUpdateInfoUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::MyIpUpdated::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::MyIpUpdated>(buf, size);
+        return make<IPCServerCommands::MyIpUpdated>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::CustomOvpnConfigModeInitFinished::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::CustomOvpnConfigModeInitFinished>(buf, size);
+        return make<IPCServerCommands::CustomOvpnConfigModeInitFinished>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::SessionDeleted::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::SessionDeleted>(buf, size);
+        return make<IPCServerCommands::SessionDeleted>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::TestTunnelResult::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::TestTunnelResult>(buf, size);
+        return make<IPCServerCommands::TestTunnelResult>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::LostConnectionToHelper::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::LostConnectionToHelper>(buf, size);
+        return make<IPCServerCommands::LostConnectionToHelper>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::HighCpuUsage::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::HighCpuUsage>(buf, size);
+        return make<IPCServerCommands::HighCpuUsage>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::BackendPing::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::BackendPing>(buf, size);
+        return make<IPCServerCommands::BackendPing>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::UserWarning::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::UserWarning>(buf, size);
+        return make<IPCServerCommands::UserWarning>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::InternetConnectivityChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::InternetConnectivityChanged>(buf, size);
+        return make<IPCServerCommands::InternetConnectivityChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::ProtocolPortChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::ProtocolPortChanged>(buf, size);
+        return make<IPCServerCommands::ProtocolPortChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::PacketSizeDetectionState::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::PacketSizeDetectionState>(buf, size);
+        return make<IPCServerCommands::PacketSizeDetectionState>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::UpdateVersionChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::UpdateVersionChanged>(buf, size);
+        return make<IPCServerCommands::UpdateVersionChanged>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::HostsFileBecameWritable::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::HostsFileBecameWritable>(buf, size);
+        return make<IPCServerCommands::HostsFileBecameWritable>(buf, size, arena);
     }
     else if (strId == IPCServerCommands::WebSessionToken::descriptor()->full_name())
     {
-        return new ProtobufCommand<IPCServerCommands::WebSessionToken>(buf, size);
+        return make<IPCServerCommands::WebSessionToken>(buf, size, arena);
     }
     // CLI commands
     else if (strId == CliIpc::Connect::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::Connect>(buf, size);
+        return make<CliIpc::Connect>(buf, size, arena);
     }
     else if (strId == CliIpc::ConnectToLocationAnswer::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::ConnectToLocationAnswer>(buf, size);
+        return make<CliIpc::ConnectToLocationAnswer>(buf, size, arena);
     }
     else if (strId == CliIpc::ConnectStateChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::ConnectStateChanged>(buf, size);
+        return make<CliIpc::ConnectStateChanged>(buf, size, arena);
     }
     else if (strId == CliIpc::Disconnect::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::Disconnect>(buf, size);
+        return make<CliIpc::Disconnect>(buf, size, arena);
     }
     else if (strId == CliIpc::AlreadyDisconnected::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::AlreadyDisconnected>(buf, size);
+        return make<CliIpc::AlreadyDisconnected>(buf, size, arena);
     }
     else if (strId == CliIpc::ShowLocations::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::ShowLocations>(buf, size);
+        return make<CliIpc::ShowLocations>(buf, size, arena);
     }
     else if (strId == CliIpc::LocationsShown::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::LocationsShown>(buf, size);
+        return make<CliIpc::LocationsShown>(buf, size, arena);
     }
     else if (strId == CliIpc::GetState::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::GetState>(buf, size);
+        return make<CliIpc::GetState>(buf, size, arena);
     }
     else if (strId == CliIpc::State::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::State>(buf, size);
+        return make<CliIpc::State>(buf, size, arena);
     }
     else if (strId == CliIpc::Firewall::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::Firewall>(buf, size);
+        return make<CliIpc::Firewall>(buf, size, arena);
     }
     else if (strId == CliIpc::FirewallStateChanged::descriptor()->full_name())
     {
-        return new ProtobufCommand<CliIpc::FirewallStateChanged>(buf, size);
+        return make<CliIpc::FirewallStateChanged>(buf, size, arena);
     }
 
 
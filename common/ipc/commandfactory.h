@@ -3,6 +3,8 @@
 
 #include "command.h"
 
+namespace google { namespace protobuf { class Arena; } }
+
 namespace IPC
 {
 
@@ -11,7 +13,8 @@ static const int CLIENT_CMD_ClientAuth = 0;
 class CommandFactory
 {
 public:
-    static Command *makeCommand(const std::string strId, char *buf, int size);
+    // with an arena, the command is on it and must not be deleted, it's freed by the reset of the arena
+    static Command *makeCommand(const std::string &strId, char *buf, int size, google::protobuf::Arena *arena = NULL);
 };
 
 } // namespace IPC
@@ -0,0 +1,53 @@
+#include "commandstats.h"
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+
+namespace IPC
+{
+
+void CommandStats::record(const std::string &stringId, qint64 bytes, qint64 timeUs)
+{
+    QMutexLocker locker(&mutex_);
+    Counters &c = counters_[QString::fromStdString(stringId)];
+    c.count++;
+    c.bytes += bytes;
+    c.maxBytes = qMax(c.maxBytes, bytes);
+    c.timeUs += timeUs;
+    c.maxTimeUs = qMax(c.maxTimeUs, timeUs);
+}
+
+QString CommandStats::toText() const
+{
+    QMutexLocker locker(&mutex_);
+
+    // the most expensive commands first
+    QVector<QString> ids;
+    ids.reserve(counters_.size());
+    for (auto it = counters_.constBegin(); it != counters_.constEnd(); ++it)
+    {
+        ids << it.key();
+    }
+    std::sort(ids.begin(), ids.end(), [this](const QString &id1, const QString &id2) {
+        return counters_[id1].timeUs > counters_[id2].timeUs;
+    });
+
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6").arg("command", -50).arg("count", 8).arg("bytes", 12).arg("max bytes", 10)
+                                         .arg("total ms", 10).arg("max ms", 8);
+    for (const QString &id : qAsConst(ids))
+    {
+        const Counters &c = counters_[id];
+        lines << QString("%1 %2 %3 %4 %5 %6").arg(id, -50).arg(c.count, 8).arg(c.bytes, 12).arg(c.maxBytes, 10)
+                                             .arg(c.timeUs / 1000.0, 10, 'f', 1).arg(c.maxTimeUs / 1000.0, 8, 'f', 1);
+    }
+    return lines.join("\n");
+}
+
+QHash<QString, CommandStats::Counters> CommandStats::counters() const
+{
+    QMutexLocker locker(&mutex_);
+    return counters_;
+}
+
+} // namespace IPC
@@ -0,0 +1,46 @@
+#ifndef COMMANDSTATS_H
+#define COMMANDSTATS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <string>
+
+namespace IPC
+{
+
+// Per command type counters of the IPC: the count, the serialized bytes (zero for the commands passed in the process
+// without serialization) and the time of the encoding/decoding or the handling. Shown in the log viewer and
+// exported by the metrics endpoint of the engine.
+class CommandStats
+{
+public:
+    static CommandStats &instance()
+    {
+        static CommandStats s;
+        return s;
+    }
+
+    struct Counters
+    {
+        qint64 count = 0;
+        qint64 bytes = 0;
+        qint64 maxBytes = 0;
+        qint64 timeUs = 0;
+        qint64 maxTimeUs = 0;
+    };
+
+    void record(const std::string &stringId, qint64 bytes, qint64 timeUs);
+    QString toText() const;
+    QHash<QString, Counters> counters() const;
+
+private:
+    CommandStats() {}
+
+    mutable QMutex mutex_;      // the engine and the GUI threads
+    QHash<QString, Counters> counters_;
+};
+
+} // namespace IPC
+
+#endif // COMMANDSTATS_H
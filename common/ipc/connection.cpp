@@ -1,20 +1,27 @@
 #include "connection.h"
 #include "commandfactory.h"
+#include "commandstats.h"
+#include <QElapsedTimer>
 #include <QTimer>
+#include <google/protobuf/arena.h>
 
 namespace IPC
 {
 
-Connection::Connection(QLocalSocket *localSocket) : localSocket_(localSocket), bytesWrittingInProgress_(0)
+Connection::Connection(QLocalSocket *localSocket) : localSocket_(localSocket), writePos_(0), readPos_(0),
+    isProcessReadBufferScheduled_(false), bytesWrittingInProgress_(0)
 {
+    init();
     QObject::connect(localSocket_, SIGNAL(disconnected()), SLOT(onSocketDisconnected()));
     QObject::connect(localSocket_, SIGNAL(bytesWritten(qint64)), SLOT(onSocketBytesWritten(qint64)));
     QObject::connect(localSocket_, SIGNAL(readyRead()), SLOT(onReadyRead()));
     QObject::connect(localSocket_, SIGNAL(error(QLocalSocket::LocalSocketError)), SLOT(onSocketError(QLocalSocket::LocalSocketError)));
 }
 
-Connection::Connection() : localSocket_(NULL), bytesWrittingInProgress_(0)
+Connection::Connection() : localSocket_(NULL), writePos_(0), readPos_(0),
+    isProcessReadBufferScheduled_(false), bytesWrittingInProgress_(0)
 {
+    init();
 }
 
 Connection::~Connection()
@@ -22,6 +29,24 @@ Connection::~Connection()
     safeDeleteSocket();
 }
 
+void Connection::setArenaDecoding(bool isEnabled)
+{
+    if (!isEnabled)
+    {
+        arena_.reset();
+        arenaInitialBlock_.clear();
+        return;
+    }
+    if (!arena_)
+    {
+        arenaInitialBlock_.resize(ARENA_INITIAL_BLOCK_SIZE);
+        google::protobuf::ArenaOptions options;
+        options.initial_block = arenaInitialBlock_.data();
+        options.initial_block_size = arenaInitialBlock_.size();
+        arena_.reset(new google::protobuf::Arena(options));
+    }
+}
+
 void Connection::connect()
 {
     safeDeleteSocket();
@@ -44,40 +69,42 @@ void Connection::sendCommand(const Command &commandl)
 {
     Q_ASSERT(localSocket_ != NULL);
 
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
     // command structure
     // 1) (int) size of protobuf message in bytes
     // 2) (int) size of message string id in bytes
     // 3) (string) message string id
     // 4) (byte array) body of protobuf message
 
-    std::vector<char> buf = commandl.getData();
-    int sizeOfBuf = buf.size();
-    std::string strId = commandl.getStringId();
-    int sizeOfStringId = strId.length();
+    const int sizeOfBuf = static_cast<int>(commandl.getDataSize());
+    const std::string strId = commandl.getStringId();
+    const int sizeOfStringId = strId.length();
 
     Q_ASSERT(sizeOfStringId > 0);
 
-    bool isWriteBufIsEmpty = writeBuf_.isEmpty();
+    const bool isWriteBufIsEmpty = writePos_ == writeBuf_.size();
 
-    writeBuf_.append((const char *)&sizeOfBuf, sizeof(sizeOfBuf));
-    writeBuf_.append((const char *)&sizeOfStringId, sizeof(sizeOfStringId));
-    writeBuf_.append(strId.c_str(), sizeOfStringId);
+    // the command is serialized in place at the end of the write buffer
+    const int offset = writeBuf_.size();
+    writeBuf_.resize(offset + sizeof(sizeOfBuf) + sizeof(sizeOfStringId) + sizeOfStringId + sizeOfBuf);
+    char *p = writeBuf_.data() + offset;
+    memcpy(p, &sizeOfBuf, sizeof(sizeOfBuf));
+    p += sizeof(sizeOfBuf);
+    memcpy(p, &sizeOfStringId, sizeof(sizeOfStringId));
+    p += sizeof(sizeOfStringId);
+    memcpy(p, strId.c_str(), sizeOfStringId);
+    p += sizeOfStringId;
     if (sizeOfBuf > 0)
     {
-        writeBuf_.append(&buf[0], sizeOfBuf);
+        commandl.writeData(p);
     }
+    CommandStats::instance().record(strId, sizeOfBuf, elapsedTimer.nsecsElapsed() / 1000);
+
     if (isWriteBufIsEmpty)
     {
-        qint64 bytesWritten = localSocket_->write(writeBuf_);
-        if (bytesWritten == -1)
-        {
-            emit stateChanged(CONNECTION_DISCONNECTED, this);
-        }
-        else
-        {
-            bytesWrittingInProgress_ += bytesWritten;
-            writeBuf_.remove(0, bytesWritten);
-        }
+        writeToSocket();
     }
 }
 
@@ -112,18 +139,9 @@ void Connection::onSocketBytesWritten(qint64 bytes)
 {
     bytesWrittingInProgress_ -= bytes;
 
-    if (!writeBuf_.isEmpty())
+    if (writePos_ != writeBuf_.size())
     {
-        qint64 bytesWritten = localSocket_->write(writeBuf_);
-        if (bytesWritten == -1)
-        {
-           emit stateChanged(CONNECTION_DISCONNECTED, this);
-        }
-        else
-        {
-            bytesWrittingInProgress_ += bytesWritten;
-            writeBuf_.remove(0, bytesWritten);
-        }
+        writeToSocket();
     }
     else if (bytesWrittingInProgress_ == 0)
     {
@@ -133,11 +151,56 @@ void Connection::onSocketBytesWritten(qint64 bytes)
 
 void Connection::onReadyRead()
 {
-    readBuf_.append(localSocket_->readAll());
+    // read straight to the end of the buffer
+    const qint64 bytesAvailable = localSocket_->bytesAvailable();
+    if (bytesAvailable > 0)
+    {
+        const int oldSize = readBuf_.size();
+        readBuf_.resize(oldSize + bytesAvailable);
+        const qint64 bytesRead = localSocket_->read(readBuf_.data() + oldSize, bytesAvailable);
+        readBuf_.resize(oldSize + qMax(bytesRead, static_cast<qint64>(0)));
+    }
+    processReadBuffer();
+}
+
+void Connection::processReadBuffer()
+{
+    isProcessReadBufferScheduled_ = false;
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
     while (canReadCommand())
     {
         Command *cmd = readCommand();
         emit newCommand(cmd, this);
+
+        // a burst of commands should not block the event loop, the rest is decoded in the next call
+        if (elapsedTimer.elapsed() >= MAX_DECODE_TIME_MS && canReadCommand())
+        {
+            if (!isProcessReadBufferScheduled_)
+            {
+                isProcessReadBufferScheduled_ = true;
+                QMetaObject::invokeMethod(this, "processReadBuffer", Qt::QueuedConnection);
+            }
+            break;
+        }
+    }
+
+    // the commands of the batch were handled by the receivers, free them at once
+    if (arena_)
+    {
+        arena_->Reset();
+    }
+
+    if (readPos_ == readBuf_.size())
+    {
+        readBuf_.resize(0);
+        readPos_ = 0;
+    }
+    else if (readPos_ > readBuf_.size() / 2)
+    {
+        readBuf_.remove(0, readPos_);
+        readPos_ = 0;
     }
 }
 
@@ -148,16 +211,47 @@ void Connection::onSocketError(QLocalSocket::LocalSocketError socketError)
     emit stateChanged(CONNECTION_ERROR, this);
 }
 
+void Connection::init()
+{
+    // the reserved capacity stays when the buffers are emptied
+    writeBuf_.reserve(INITIAL_BUFFER_SIZE);
+    readBuf_.reserve(INITIAL_BUFFER_SIZE);
+}
+
+void Connection::writeToSocket()
+{
+    qint64 bytesWritten = localSocket_->write(writeBuf_.constData() + writePos_, writeBuf_.size() - writePos_);
+    if (bytesWritten == -1)
+    {
+        emit stateChanged(CONNECTION_DISCONNECTED, this);
+        return;
+    }
+
+    bytesWrittingInProgress_ += bytesWritten;
+    writePos_ += bytesWritten;
+    if (writePos_ == writeBuf_.size())
+    {
+        writeBuf_.resize(0);
+        writePos_ = 0;
+    }
+    else if (writePos_ > writeBuf_.size() / 2)
+    {
+        writeBuf_.remove(0, writePos_);
+        writePos_ = 0;
+    }
+}
+
 bool Connection::canReadCommand()
 {
-    if (readBuf_.size() > (int)(sizeof(int) * 2))
+    const int available = readBuf_.size() - readPos_;
+    if (available > (int)(sizeof(int) * 2))
     {
         int sizeOfCmd;
         int sizeOfId;
-        memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-        memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+        memcpy(&sizeOfCmd, readBuf_.constData() + readPos_, sizeof(int));
+        memcpy(&sizeOfId, readBuf_.constData() + readPos_ + sizeof(int), sizeof(int));
 
-        if (readBuf_.size() >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
+        if (available >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
         {
             return true;
         }
@@ -167,15 +261,20 @@ bool Connection::canReadCommand()
 
 Command *Connection::readCommand()
 {
+    char *p = readBuf_.data() + readPos_;
     int sizeOfCmd;
     int sizeOfId;
-    memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-    memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+    memcpy(&sizeOfCmd, p, sizeof(int));
+    memcpy(&sizeOfId, p + sizeof(int), sizeof(int));
 
-    std::string strId(readBuf_.data() + sizeof(int) * 2, sizeOfId);
+    // reuses the capacity of the string, the body is parsed from the buffer
+    readStringId_.assign(p + sizeof(int) * 2, sizeOfId);
 
-    Command *cmd = CommandFactory::makeCommand(strId, readBuf_.data() + sizeof(int) * 2 + sizeOfId, sizeOfCmd);
-    readBuf_.remove(0, sizeof(int) * 2 + sizeOfId + sizeOfCmd);
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    Command *cmd = CommandFactory::makeCommand(readStringId_, p + sizeof(int) * 2 + sizeOfId, sizeOfCmd, arena_.data());
+    CommandStats::instance().record(readStringId_, sizeOfCmd, elapsedTimer.nsecsElapsed() / 1000);
+    readPos_ += sizeof(int) * 2 + sizeOfId + sizeOfCmd;
     return cmd;
 }
 
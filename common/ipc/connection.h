@@ -3,8 +3,11 @@
 
 #include <QLocalSocket>
 #include <QObject>
+#include <QScopedPointer>
 #include "iserver.h"
 
+namespace google { namespace protobuf { class Arena; } }
+
 namespace IPC
 {
 
@@ -20,6 +23,11 @@ public:
     void close() override;
     void sendCommand(const Command &commandl) override;
 
+    // The commands of a read batch are decoded on one protobuf arena (with their sub-messages and strings) and
+    // freed together by the reset of the arena after the batch. The commands are valid only during the emission of
+    // newCommand, so the receivers must be connected directly and must not delete them.
+    void setArenaDecoding(bool isEnabled);
+
 signals:
     void newCommand(IPC::Command *cmd, IPC::IConnection *connection) override;
     void stateChanged(int state, IPC::IConnection *connection) override;
@@ -31,14 +39,31 @@ private slots:
     void onSocketBytesWritten(qint64 bytes);
     void onReadyRead();
     void onSocketError(QLocalSocket::LocalSocketError socketError);
+    void processReadBuffer();
 
 private:
+    static constexpr int INITIAL_BUFFER_SIZE = 64 * 1024;
+    static constexpr int MAX_DECODE_TIME_MS = 10;   // then the decoding yields to the event loop
+    static constexpr int ARENA_INITIAL_BLOCK_SIZE = 64 * 1024;
+
     QLocalSocket *localSocket_;
 
+    // the buffers are consumed from the positions and compacted when the consumed part is the larger half,
+    // so each byte is moved O(1) times on average
     QByteArray writeBuf_;
+    int writePos_;
     QByteArray readBuf_;
+    int readPos_;
+    std::string readStringId_;
+    bool isProcessReadBufferScheduled_;
     qint64 bytesWrittingInProgress_;
+    // the first block of the arena is reused by every batch, the larger batches add blocks until the reset;
+    // the block is declared first to outlive the arena
+    QByteArray arenaInitialBlock_;
+    QScopedPointer<google::protobuf::Arena> arena_;
 
+    void init();
+    void writeToSocket();
     bool canReadCommand();
     Command *readCommand();
 
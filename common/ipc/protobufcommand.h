@@ -1,50 +1,80 @@
 #ifndef PROTOBUFCOMMAND_H
 #define PROTOBUFCOMMAND_H
 
+#include <google/protobuf/arena.h>
 #include "command.h"
 #include "../utils/clean_sensitive_info.h"
 
 namespace IPC
 {
 
+// The message is a member, or is on the arena when one is given (the sub-messages and the strings of the decoded
+// message are allocated there too, and freed with the arena).
 template <class T>
 class ProtobufCommand : public Command
 {
 public:
-    ProtobufCommand(char *buf = NULL, int size = 0)
+    ProtobufCommand(char *buf = NULL, int size = 0, google::protobuf::Arena *arena = NULL) :
+        protoObj(arena ? google::protobuf::Arena::CreateMessage<T>(arena) : &localProtoObj)
     {
         if (buf != NULL && size != 0)
         {
-            protoObj.ParseFromArray(buf, size);
+            protoObj->ParseFromArray(buf, size);
         }
     }
 
+    ProtobufCommand(const ProtobufCommand &other) : Command(other), localProtoObj(*other.protoObj), protoObj(&localProtoObj)
+    {
+    }
+
+    ProtobufCommand &operator=(const ProtobufCommand &other)
+    {
+        if (this != &other)
+        {
+            localProtoObj = *other.protoObj;
+            protoObj = &localProtoObj;
+        }
+        return *this;
+    }
+
     std::vector<char> getData() const override
     {
-        size_t size = protoObj.ByteSizeLong();
+        size_t size = protoObj->ByteSizeLong();
         std::vector<char> buf(size);
         if (size > 0)
         {
-            protoObj.SerializeToArray(&buf[0], size);
+            protoObj->SerializeToArray(&buf[0], size);
         }
         return buf;
     }
 
+    size_t getDataSize() const override
+    {
+        return protoObj->ByteSizeLong();
+    }
+
+    void writeData(char *buf) const override
+    {
+        // the size is cached by getDataSize()
+        protoObj->SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8 *>(buf));
+    }
+
     std::string getStringId() const override
     {
-        return protoObj.descriptor()->full_name();
+        return protoObj->descriptor()->full_name();
     }
 
     std::string getDebugString() const override
     {
-        return "[" + protoObj.descriptor()->name() + "] "
-               + Utils::cleanSensitiveInfo(protoObj.DebugString());
+        return "[" + protoObj->descriptor()->name() + "] "
+               + Utils::cleanSensitiveInfo(protoObj->DebugString());
     }
 
-    T &getProtoObj() { return protoObj; }
+    T &getProtoObj() { return *protoObj; }
 
 private:
-    T protoObj;
+    T localProtoObj;
+    T *protoObj;
 };
 
 } // namespace IPC
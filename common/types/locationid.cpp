@@ -1,11 +1,82 @@
 #include "locationid.h"
+#include <QReadWriteLock>
+#include <QVector>
 
 const int typeIdLocationId = qRegisterMetaType<LocationID>("LocationID");
 
+namespace {
+
+// the strings are never removed, there are only as many of them as the locations, static ips and custom configs
+class CityStrings
+{
+public:
+    static CityStrings &instance()
+    {
+        static CityStrings cs;
+        return cs;
+    }
+
+    quint32 intern(const QString &str)
+    {
+        if (str.isEmpty())
+        {
+            return 0;
+        }
+        {
+            QReadLocker locker(&lock_);
+            auto it = handles_.constFind(str);
+            if (it != handles_.constEnd())
+            {
+                return it.value();
+            }
+        }
+        QWriteLocker locker(&lock_);
+        auto it = handles_.constFind(str);
+        if (it != handles_.constEnd())
+        {
+            return it.value();
+        }
+        const quint32 handle = static_cast<quint32>(strings_.size());
+        strings_ << str;
+        handles_.insert(str, handle);
+        return handle;
+    }
+
+    QString string(quint32 handle)
+    {
+        QReadLocker locker(&lock_);
+        Q_ASSERT(handle < static_cast<quint32>(strings_.size()));
+        return strings_[handle];
+    }
+
+private:
+    CityStrings() : strings_(1) {}
+
+    QReadWriteLock lock_;
+    QHash<QString, quint32> handles_;
+    QVector<QString> strings_;
+};
+
+} // namespace
+
+LocationID::LocationID(int type, int id, const QString &city) : LocationID(type, id, CityStrings::instance().intern(city))
+{
+}
+
+LocationID::LocationID(int type, int id, quint32 city) : type_(type), id_(id), city_(city),
+    hash_(::qHash((static_cast<quint64>(static_cast<quint32>(id)) << 32) | city) ^ static_cast<uint>(type))
+{
+}
+
 QString LocationID::getHashString() const
 {
     Q_ASSERT(type_ != INVALID_LOCATION);
-    return QString::number(id_) + QString::number(type_) + city_;
+    return QString::number(id_) + QString::number(type_) + city();
+}
+
+QString LocationID::city() const
+{
+    return city_ == 0 ? QString() : CityStrings::instance().string(city_);
 }
 
 LocationID LocationID::createTopApiLocationId(int id)
@@ -51,7 +122,7 @@ LocationID LocationID::createFromProtoBuf(const ProtoTypes::LocationId &lid)
 bool LocationID::isTopLevelLocation() const
 {
     Q_ASSERT(type_ != INVALID_LOCATION);
-    return city_.isEmpty();
+    return city_ == 0;
 }
 
 LocationID LocationID::bestLocationToApiLocation() const
@@ -69,7 +140,7 @@ LocationID LocationID::apiLocationToBestLocation() const
 LocationID LocationID::toTopLevelLocation() const
 {
     Q_ASSERT(type_ == API_LOCATION || type_ == BEST_LOCATION);      // applicable only for API locations and best location
-    return LocationID(type_, id_, QString());
+    return LocationID(type_, id_, 0u);
 }
 
 ProtoTypes::LocationId LocationID::toProtobuf() const
@@ -77,6 +148,6 @@ ProtoTypes::LocationId LocationID::toProtobuf() const
     ProtoTypes::LocationId lid;
     lid.set_type(type_);
     lid.set_id(id_);
-    lid.set_city(city_.toStdString());
+    lid.set_city(city().toStdString());
     return lid;
 }
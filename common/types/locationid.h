@@ -7,11 +7,13 @@
 #include "utils/protobuf_includes.h"
 
 // Uniquely identifies a location among all locations (API locations, statis IPs locations, custom config locations, best location).
+// The city string is interned into a process-wide table, so the copies, the comparison and the hashing (precomputed)
+// don't touch the string. The protobuf form carries the string itself, the handles are valid only in this process.
 class LocationID
 {
 public:
 
-    LocationID() : type_(INVALID_LOCATION), id_(0) {}
+    LocationID() : type_(INVALID_LOCATION), id_(0), city_(0), hash_(0) {}
 
     static LocationID createTopApiLocationId(int id);
     static LocationID createTopStaticLocationId();
@@ -22,14 +24,7 @@ public:
     static LocationID createCustomConfigLocationId(const QString &filename);
     static LocationID createFromProtoBuf(const ProtoTypes::LocationId &lid);
 
-    LocationID& operator=(LocationID rhs)
-    {
-        type_ = rhs.type_;
-        id_ = rhs.id_;
-        city_ = rhs.city_;
-        return *this;
-    }
-
+    LocationID& operator=(const LocationID&) = default;
     LocationID(const LocationID&) = default;
 
     bool operator== (const LocationID &other) const
@@ -53,11 +48,13 @@ public:
     LocationID toTopLevelLocation() const;
     ProtoTypes::LocationId toProtobuf() const;
 
+    // for logging, the hash of the location is hash()
     QString getHashString() const;
+    inline uint hash() const { return hash_; }
 
-    int type() { return type_; }
-    int id() { return id_; }
-    QString city() { return city_; }
+    int type() const { return type_; }
+    int id() const { return id_; }
+    QString city() const;
 
 private:
     static constexpr int INVALID_LOCATION = 0;
@@ -66,21 +63,23 @@ private:
     static constexpr int CUSTOM_CONFIGS_LOCATION = 3;
     static constexpr int STATIC_IPS_LOCATION = 4;
 
-    LocationID(unsigned char type, int id, const QString &city) : type_(type), id_(id), city_(city) {}
+    LocationID(int type, int id, const QString &city);
+    LocationID(int type, int id, quint32 city);
 
     // the location is uniquely determined by these three values
     int type_;
     int id_;        // used for API_LOCATION and BEST_LOCATION
-    QString city_;  // user for all locations:
+    quint32 city_;  // the interned string (0 is the empty one), user for all locations:
                     // for API_LOCATION and BEST_LOCATION this is a city + nickname string
                     // for CUSTOM_OVPN_CONFIGS_LOCATION this is config filename
                     // for STATIC_IPS_LOCATION this is city + ip string
                     // for top level location - empty value
+    uint hash_;
 };
 
 inline uint qHash(const LocationID &key, uint seed)
 {
-    return qHash(key.getHashString(), seed);
+    return key.hash() ^ seed;
 }
 
 Q_DECLARE_METATYPE(LocationID)
@@ -0,0 +1,114 @@
+#include "aesgcmcrypt.h"
+
+#include <QCryptographicHash>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "logger.h"
+
+namespace {
+
+// frees the context on all the return paths
+class EvpCipherCtx
+{
+public:
+    EvpCipherCtx() : ctx_(EVP_CIPHER_CTX_new()) {}
+    ~EvpCipherCtx() { if (ctx_) EVP_CIPHER_CTX_free(ctx_); }
+    EVP_CIPHER_CTX *get() const { return ctx_; }
+
+private:
+    EVP_CIPHER_CTX *ctx_;
+    Q_DISABLE_COPY(EvpCipherCtx)
+};
+
+} // namespace
+
+AesGcmCrypt::AesGcmCrypt(quint64 key) : legacyCrypt_(key)
+{
+    QByteArray keyBytes;
+    for (int i = 0; i < 8; ++i)
+    {
+        keyBytes.append(static_cast<char>((key >> (i * 8)) & 0xff));
+    }
+    key_ = QCryptographicHash::hash("AesGcmCrypt" + keyBytes, QCryptographicHash::Sha256);
+}
+
+QByteArray AesGcmCrypt::encryptToByteArray(const QByteArray &plaintext)
+{
+    // the ciphertext is written straight to its place in the result
+    QByteArray result(HEADER_SIZE + plaintext.size(), Qt::Uninitialized);
+    unsigned char *out = reinterpret_cast<unsigned char *>(result.data());
+    out[0] = VERSION;
+    unsigned char *iv = out + 1;
+    unsigned char *tag = iv + IV_SIZE;
+    unsigned char *cipher = tag + TAG_SIZE;
+
+    EvpCipherCtx ctx;
+    int len = 0;
+    if (!ctx.get() || RAND_bytes(iv, IV_SIZE) != 1 ||
+        EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), NULL, NULL, NULL) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, IV_SIZE, NULL) != 1 ||
+        EVP_EncryptInit_ex(ctx.get(), NULL, NULL, reinterpret_cast<const unsigned char *>(key_.constData()), iv) != 1 ||
+        EVP_EncryptUpdate(ctx.get(), NULL, &len, out, 1) != 1 ||     // the version byte as the additional data
+        EVP_EncryptUpdate(ctx.get(), cipher, &len, reinterpret_cast<const unsigned char *>(plaintext.constData()), plaintext.size()) != 1 ||
+        EVP_EncryptFinal_ex(ctx.get(), cipher + len, &len) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, TAG_SIZE, tag) != 1)
+    {
+        qCDebug(LOG_BASIC) << "AesGcmCrypt: encryption failed";
+        return QByteArray();
+    }
+    return result;
+}
+
+QString AesGcmCrypt::encryptToString(const QByteArray &plaintext)
+{
+    return QString::fromLatin1(encryptToByteArray(plaintext).toBase64());
+}
+
+QByteArray AesGcmCrypt::decryptToByteArray(const QByteArray &cypher)
+{
+    if (isLegacyFormat(cypher))
+    {
+        return legacyCrypt_.decryptToByteArray(cypher);
+    }
+    if (cypher.size() < HEADER_SIZE || cypher.at(0) != VERSION)
+    {
+        qCDebug(LOG_BASIC) << "AesGcmCrypt: unknown format";
+        return QByteArray();
+    }
+
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(cypher.constData());
+    const unsigned char *iv = in + 1;
+    const unsigned char *tag = iv + IV_SIZE;
+    const unsigned char *cipher = tag + TAG_SIZE;
+    const int cipherSize = cypher.size() - HEADER_SIZE;
+
+    QByteArray result(cipherSize, Qt::Uninitialized);
+    unsigned char *out = reinterpret_cast<unsigned char *>(result.data());
+
+    EvpCipherCtx ctx;
+    int len = 0;
+    if (!ctx.get() ||
+        EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), NULL, NULL, NULL) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, IV_SIZE, NULL) != 1 ||
+        EVP_DecryptInit_ex(ctx.get(), NULL, NULL, reinterpret_cast<const unsigned char *>(key_.constData()), iv) != 1 ||
+        EVP_DecryptUpdate(ctx.get(), NULL, &len, in, 1) != 1 ||
+        EVP_DecryptUpdate(ctx.get(), out, &len, cipher, cipherSize) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, TAG_SIZE, const_cast<unsigned char *>(tag)) != 1 ||
+        EVP_DecryptFinal_ex(ctx.get(), out + len, &len) != 1)
+    {
+        qCDebug(LOG_BASIC) << "AesGcmCrypt: the integrity check failed";
+        return QByteArray();
+    }
+    return result;
+}
+
+QByteArray AesGcmCrypt::decryptToByteArray(const QString &cyphertext)
+{
+    return decryptToByteArray(QByteArray::fromBase64(cyphertext.toLatin1()));
+}
+
+bool AesGcmCrypt::isLegacyFormat(const QByteArray &cypher)
+{
+    // the version byte of SimpleCrypt
+    return !cypher.isEmpty() && cypher.at(0) == 0x03;
+}
@@ -0,0 +1,38 @@
+#ifndef AESGCMCRYPT_H
+#define AESGCMCRYPT_H
+
+#include <QByteArray>
+#include <QString>
+#include "simplecrypt.h"
+
+// Encryption of the persisted blobs (the api info, the engine settings), AES-256-GCM through OpenSSL (AES-NI
+// where the CPU has it) in one pass without intermediate copies, instead of the byte loop of SimpleCrypt.
+// Format: version (1 byte, 0x10) | IV (12 bytes) | tag (16 bytes) | ciphertext, the version byte is authenticated
+// as well, so a corrupted or truncated blob is detected. The key is derived from the same 64-bit constant as before,
+// it shields the data from curious eyes like SimpleCrypt did, not from someone who has the binary.
+// The blobs of SimpleCrypt (version 3) are still decrypted, they are rewritten in the new format on the next save.
+class AesGcmCrypt
+{
+public:
+    explicit AesGcmCrypt(quint64 key);
+
+    QByteArray encryptToByteArray(const QByteArray &plaintext);
+    QString encryptToString(const QByteArray &plaintext);
+
+    // empty on an error (a wrong key, a corrupted blob)
+    QByteArray decryptToByteArray(const QByteArray &cypher);
+    QByteArray decryptToByteArray(const QString &cyphertext);
+
+private:
+    static constexpr char VERSION = 0x10;
+    static constexpr int IV_SIZE = 12;
+    static constexpr int TAG_SIZE = 16;
+    static constexpr int HEADER_SIZE = 1 + IV_SIZE + TAG_SIZE;
+
+    QByteArray key_;
+    SimpleCrypt legacyCrypt_;
+
+    static bool isLegacyFormat(const QByteArray &cypher);
+};
+
+#endif // AESGCMCRYPT_H
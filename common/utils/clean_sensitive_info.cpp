@@ -1,4 +1,5 @@
 #include "clean_sensitive_info.h"
+#include "multipatternmatcher.h"
 #include <QStandardPaths>
 #include <QString>
 #include <string>
@@ -12,17 +13,34 @@ template<typename T> T QStringCast(QString source) { return source; }
 template<> std::string QStringCast(QString source) { return source.toStdString(); }
 template<> std::wstring QStringCast(QString source) { return source.toStdWString(); }
 
+template<typename T> const typename T::value_type *StringData(const T &str) { return str.data(); }
+template<> const QChar *StringData(const QString &str) { return str.constData(); }
+
+template<typename T> size_t StringLength(const T &str) { return static_cast<size_t>(str.size()); }
+
+template<typename T> void AppendToString(T &str, const T &source, size_t pos, size_t length)
+{
+    str.append(source, pos, length);
+}
+template<> void AppendToString(QString &str, const QString &source, size_t pos, size_t length)
+{
+    str.append(source.constData() + pos, static_cast<int>(length));
+}
+
 #define REGISTER_SENSITIVE_REPLACEMENT(x) \
     replacements.push_back(std::make_pair( \
         QStringCast<T>(QStandardPaths::writableLocation(QStandardPaths::x)), \
         QStringCast<T>(QString("%" #x "%").toUpper())))
 
+// The paths and one matcher for all of them, so a string is scanned once whatever the number of the paths.
 template<typename T>
-const std::vector<std::pair<T, T>> &GetSensitiveReplacements()
+struct SensitiveReplacements
 {
-    static std::vector<std::pair<T,T>> replacements;
-    static bool is_replacements_init = false;
-    if (!is_replacements_init) {
+    std::vector<std::pair<T, T>> replacements;
+    MultiPatternMatcher<typename T::value_type> matcher;
+
+    SensitiveReplacements()
+    {
         // This will clean most home-related OS paths ("~" and "C:/Users/<USER>").
         REGISTER_SENSITIVE_REPLACEMENT(HomeLocation);
         // This is important for Linux: cleans "/run/user/<USER>". On Mac and Windows, probably is
@@ -31,37 +49,42 @@ const std::vector<std::pair<T, T>> &GetSensitiveReplacements()
         // This is important for Android: cleans "<USER>". On desktop OSes, most likely is under "~"
         // or "C:/Users/<USER>".
         REGISTER_SENSITIVE_REPLACEMENT(GenericDataLocation);
-        is_replacements_init = true;
+
+        // at the same position the path registered first wins, the same as with the replacements one by one
+        for (const auto &replacement : replacements)
+            matcher.addPattern(StringData(replacement.first), StringLength(replacement.first));
+        matcher.build();
     }
-    return replacements;
-}
+};
 
 #undef REGISTER_SENSITIVE_REPLACEMENT
-}  // namespace
 
 template<typename T>
-typename std::enable_if<std::is_base_of<QString,T>::value>::type
-ReplaceInString(T& str, const std::pair<T, T>& rep)
+const SensitiveReplacements<T> &GetSensitiveReplacements()
 {
-    str.replace(rep.first, rep.second);
+    static const SensitiveReplacements<T> replacements;
+    return replacements;
 }
 
-template<typename T>
-typename std::enable_if<
-    std::is_base_of<std::basic_string<typename T::traits_type::char_type>, T>::value>::type
-ReplaceInString(T& str, const std::pair<T,T>& rep)
-{
-    const auto start_pos = str.find(rep.first);
-    if (start_pos != T::npos)
-        str.replace(start_pos, rep.first.length(), rep.second);
-}
+}  // namespace
 
 template <typename T>
 T CleanSensitiveInfoHelper<T>::process()
 {
-    T result{ value_ };
-    for (const auto &replacement : GetSensitiveReplacements<T>())
-        ReplaceInString(result, replacement);
+    const SensitiveReplacements<T> &sensitive = GetSensitiveReplacements<T>();
+    const auto matches = sensitive.matcher.findAll(StringData(value_), StringLength(value_));
+    if (matches.empty())
+        return value_;
+
+    T result;
+    result.reserve(value_.size());
+    size_t pos = 0;
+    for (const auto &match : matches) {
+        AppendToString(result, value_, pos, match.pos - pos);
+        result.append(sensitive.replacements[match.patternIndex].second);
+        pos = match.pos + match.length;
+    }
+    AppendToString(result, value_, pos, StringLength(value_) - pos);
     return result;
 }
 
@@ -71,4 +94,3 @@ template class CleanSensitiveInfoHelper<std::string>;
 template class CleanSensitiveInfoHelper<std::wstring>;
 
 }  // namespace Utils
-
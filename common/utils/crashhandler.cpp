@@ -343,6 +343,7 @@ void CrashHandler::handleException(ExceptionInfo info)
                              info.exceptionPointers))
         CRASH_LOG("Wrote minidump: %ls", filename.c_str());
 
+    CRASH_FLUSH_LOG();
     TerminateProcess(GetCurrentProcess(), 1);
 }
 
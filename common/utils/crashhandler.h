@@ -14,9 +14,11 @@
 
 #if defined(WINDSCRIBE_SERVICE)
 #define CRASH_LOG(...) Logger::instance().out(__VA_ARGS__);
+#define CRASH_FLUSH_LOG() Logger::instance().flushOnCrash();
 #define CRASH_ASSERT(x) assert((x))
 #else
 #define CRASH_LOG(...) qCDebug(LOG_BASIC, __VA_ARGS__)
+#define CRASH_FLUSH_LOG() /* */
 #define CRASH_ASSERT(x) Q_ASSERT(x)
 #endif
 
@@ -0,0 +1,228 @@
+#include "eventloopwatchdog.h"
+#include <QTimer>
+#include <algorithm>
+#include "utils/logger.h"
+
+const int EventLoopWatchdog::histogramBounds_[HISTOGRAM_BUCKETS - 1] = { 10, 50, 100, 250, 500, 1000, 5000 };
+
+EventLoopWatchdog::EventLoopWatchdog() : QThread(nullptr),
+    bNeedFinish_(false)
+{
+    elapsed_.start();
+}
+
+EventLoopWatchdog::~EventLoopWatchdog()
+{
+    stop();
+}
+
+void EventLoopWatchdog::watch(QThread *thread, const QString &name)
+{
+    QSharedPointer<WATCHED_LOOP> loop(new WATCHED_LOOP);
+    loop->name = name;
+    loop->thread = thread;
+    loop->lastBeatMs = elapsed_.elapsed();
+    for (std::atomic<int> &bucket : loop->histogram)
+    {
+        bucket = 0;
+    }
+    loop->maxStallMs = 0;
+    loop->stallMs = 0;
+
+    QTimer *timer = new QTimer;
+    timer->setInterval(HEARTBEAT_INTERVAL);
+    const QElapsedTimer elapsed = elapsed_;
+    QWeakPointer<WATCHED_LOOP> weakLoop = loop;
+    connect(timer, &QTimer::timeout, timer, [weakLoop, elapsed]() {
+        QSharedPointer<WATCHED_LOOP> loop = weakLoop.toStrongRef();
+        if (loop)
+        {
+            const qint64 nowMs = elapsed.elapsed();
+            const qint64 driftMs = nowMs - loop->lastBeatMs.exchange(nowMs, std::memory_order_relaxed) - HEARTBEAT_INTERVAL;
+            loop->histogram[histogramBucket(driftMs)].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    timer->moveToThread(thread);
+    QMetaObject::invokeMethod(timer, "start", Qt::QueuedConnection);
+    loop->heartbeatTimer = timer;
+
+    QMutexLocker locker(&mutex_);
+    loops_ << loop;
+    if (!isRunning())
+    {
+        bNeedFinish_ = false;
+        start(QThread::LowPriority);
+    }
+}
+
+void EventLoopWatchdog::unwatch(QThread *thread)
+{
+    qCDebug(LOG_BASIC) << "EventLoopWatchdog:" << summary();
+
+    QMutexLocker locker(&mutex_);
+    for (auto it = loops_.begin(); it != loops_.end(); )
+    {
+        if ((*it)->thread == thread)
+        {
+            // the loop can be already stopped (after exec() or a finished thread), deleteLater() would never run
+            if (thread == QThread::currentThread() || thread->isFinished())
+            {
+                delete (*it)->heartbeatTimer;
+            }
+            else
+            {
+                (*it)->heartbeatTimer->deleteLater();
+            }
+            it = loops_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void EventLoopWatchdog::stop()
+{
+    {
+        QMutexLocker locker(&mutex_);
+        bNeedFinish_ = true;
+        waitCondition_.wakeAll();
+    }
+    wait();
+}
+
+void EventLoopWatchdog::recordSlowInvocation(QObject *receiver, qint64 durationMs)
+{
+    QString name = receiver->metaObject()->className();
+    if (!receiver->objectName().isEmpty())
+    {
+        name += "(" + receiver->objectName() + ")";
+    }
+
+    QMutexLocker locker(&mutex_);
+    QString threadName = QThread::currentThread()->objectName();
+    for (const QSharedPointer<WATCHED_LOOP> &loop : qAsConst(loops_))
+    {
+        if (loop->thread == QThread::currentThread())
+        {
+            threadName = loop->name;
+            break;
+        }
+    }
+
+    SLOW_INVOCATION &si = slowInvocations_[name + "/" + threadName];
+    if (si.count == 0)
+    {
+        si.receiver = name;
+        si.threadName = threadName;
+    }
+    si.maxMs = qMax(si.maxMs, durationMs);
+    si.count++;
+}
+
+QString EventLoopWatchdog::summary() const
+{
+    QMutexLocker locker(&mutex_);
+    QString str;
+    for (const QSharedPointer<WATCHED_LOOP> &loop : loops_)
+    {
+        str += QString("\n  %1: max stall %2 ms, heartbeat drift (ms) histogram:").arg(loop->name).arg(loop->maxStallMs.load());
+        for (int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        {
+            const QString bucket = (i < HISTOGRAM_BUCKETS - 1) ? QString("<%1").arg(histogramBounds_[i])
+                                                               : QString(">=%1").arg(histogramBounds_[HISTOGRAM_BUCKETS - 2]);
+            str += QString(" %1:%2").arg(bucket).arg(loop->histogram[i].load());
+        }
+    }
+
+    QVector<SLOW_INVOCATION> slowest;
+    for (const SLOW_INVOCATION &si : slowInvocations_)
+    {
+        slowest << si;
+    }
+    std::sort(slowest.begin(), slowest.end(), [](const SLOW_INVOCATION &a, const SLOW_INVOCATION &b) {
+        return a.maxMs > b.maxMs;
+    });
+    if (slowest.size() > MAX_SLOW_INVOCATIONS)
+    {
+        slowest.resize(MAX_SLOW_INVOCATIONS);
+    }
+    str += QString("\n  queued slot invocations over %1 ms:").arg(SLOW_INVOCATION_THRESHOLD_MS);
+    for (const SLOW_INVOCATION &si : qAsConst(slowest))
+    {
+        str += QString("\n    %1 in %2: max %3 ms, %4 times").arg(si.receiver, si.threadName).arg(si.maxMs).arg(si.count);
+    }
+    return str;
+}
+
+QString EventLoopWatchdog::shortSummary() const
+{
+    QMutexLocker locker(&mutex_);
+    QStringList parts;
+    for (const QSharedPointer<WATCHED_LOOP> &loop : loops_)
+    {
+        parts << QString("%1 %2 ms").arg(loop->name).arg(loop->maxStallMs.load());
+    }
+    return parts.join(", ");
+}
+
+void EventLoopWatchdog::run()
+{
+    while (true)
+    {
+        QVector<QSharedPointer<WATCHED_LOOP> > loops;
+        {
+            QMutexLocker locker(&mutex_);
+            if (!bNeedFinish_)
+            {
+                waitCondition_.wait(&mutex_, CHECK_INTERVAL);
+            }
+            if (bNeedFinish_)
+            {
+                break;
+            }
+            loops = loops_;
+        }
+
+        for (const QSharedPointer<WATCHED_LOOP> &loop : qAsConst(loops))
+        {
+            checkLoop(*loop);
+        }
+    }
+}
+
+void EventLoopWatchdog::checkLoop(WATCHED_LOOP &loop)
+{
+    const qint64 sinceBeatMs = elapsed_.elapsed() - loop.lastBeatMs.load(std::memory_order_relaxed) - HEARTBEAT_INTERVAL;
+    if (sinceBeatMs >= STALL_THRESHOLD_MS)
+    {
+        if (loop.stallMs == 0)
+        {
+            qCDebug(LOG_BASIC) << "EventLoopWatchdog: the" << loop.name << "event loop is stalled for" << sinceBeatMs << "ms";
+        }
+        loop.stallMs = sinceBeatMs;
+    }
+    else if (loop.stallMs > 0)
+    {
+        qCDebug(LOG_BASIC) << "EventLoopWatchdog: the" << loop.name << "event loop resumed after a stall of at least" << loop.stallMs << "ms";
+        if (loop.stallMs > loop.maxStallMs.load())
+        {
+            loop.maxStallMs = loop.stallMs;
+        }
+        loop.stallMs = 0;
+        emit stallDetected();
+    }
+}
+
+int EventLoopWatchdog::histogramBucket(qint64 driftMs)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        if (driftMs < histogramBounds_[i])
+        {
+            return i;
+        }
+    }
+    return HISTOGRAM_BUCKETS - 1;
+}
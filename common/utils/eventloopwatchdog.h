@@ -0,0 +1,94 @@
+#ifndef EVENTLOOPWATCHDOG_H
+#define EVENTLOOPWATCHDOG_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+// singleton, the latency instrumentation of the event loops of the app (GUI, engine, worker threads).
+// A timer in each of the watched threads stores a heartbeat and the drift of it (into a histogram of lock-free atomics),
+// the watchdog thread checks the heartbeats and logs the event loops which have not processed events for longer than
+// the threshold (for example, blocked by a helper call), and how long the stall was when the loop resumes.
+// Also keeps the slowest queued slot invocations (reported by WindscribeApplication::notify()).
+class EventLoopWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    static EventLoopWatchdog &instance()
+    {
+        static EventLoopWatchdog w;
+        return w;
+    }
+
+    // thread must be running its event loop, the watchdog thread is started with the first watched loop
+    void watch(QThread *thread, const QString &name);
+    void unwatch(QThread *thread);
+    void stop();
+
+    // thread safe; a queued slot invocation of receiver took durationMs
+    void recordSlowInvocation(QObject *receiver, qint64 durationMs);
+
+    // the multi-line summary for the log (histograms of the drifts and the slowest invocations)
+    QString summary() const;
+    // one line for the debug window
+    QString shortSummary() const;
+
+    static constexpr int SLOW_INVOCATION_THRESHOLD_MS = 50;
+
+signals:
+    void stallDetected();
+
+protected:
+    void run() override;
+
+private:
+    EventLoopWatchdog();
+    virtual ~EventLoopWatchdog();
+
+    static constexpr int HEARTBEAT_INTERVAL = 100;
+    static constexpr int CHECK_INTERVAL = 100;
+    static constexpr int STALL_THRESHOLD_MS = 500;
+    static constexpr int MAX_SLOW_INVOCATIONS = 10;
+    static constexpr int HISTOGRAM_BUCKETS = 8;
+    // the upper bounds (exclusive) of the drift buckets in ms, the last bucket is unbounded
+    static const int histogramBounds_[HISTOGRAM_BUCKETS - 1];
+
+    struct WATCHED_LOOP
+    {
+        QString name;
+        QThread *thread;
+        QObject *heartbeatTimer;
+        std::atomic<qint64> lastBeatMs;
+        std::atomic<int> histogram[HISTOGRAM_BUCKETS];
+        std::atomic<qint64> maxStallMs;
+        qint64 stallMs;     // > 0 while the stall is being reported, only the watchdog thread uses it
+    };
+
+    struct SLOW_INVOCATION
+    {
+        QString receiver;
+        QString threadName;
+        qint64 maxMs;
+        int count;
+
+        SLOW_INVOCATION() : maxMs(0), count(0) {}
+    };
+
+    QElapsedTimer elapsed_;
+    QVector<QSharedPointer<WATCHED_LOOP> > loops_;
+    QHash<QString, SLOW_INVOCATION> slowInvocations_;   // by the receiver
+
+    mutable QMutex mutex_;
+    QWaitCondition waitCondition_;
+    bool bNeedFinish_;
+
+    void checkLoop(WATCHED_LOOP &loop);
+    static int histogramBucket(qint64 driftMs);
+};
+
+#endif // EVENTLOOPWATCHDOG_H
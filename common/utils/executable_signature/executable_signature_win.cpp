@@ -2,14 +2,149 @@
 
 #include <WinTrust.h>
 #include <SoftPub.h>
+#include <bcrypt.h>
 
+#include <algorithm>
 #include <codecvt>
+#include <cwctype>
+#include <map>
+#include <mutex>
 
 #include "executable_signature_defs.h"
 #include "executable_signature.h"
 
 #pragma comment(lib, "wintrust")
 #pragma comment(lib, "crypt32.lib")
+#pragma comment(lib, "bcrypt.lib")
+
+namespace {
+
+// The identity of the file contents: the file ID, size and time of the last write, and the SHA-256 of the contents.
+struct FileIdentity
+{
+    DWORD volumeSerialNumber;
+    ULONGLONG fileIndex;
+    ULONGLONG size;
+    ULONGLONG lastWriteTime;
+    std::string sha256;
+
+    bool operator==(const FileIdentity &other) const
+    {
+        return volumeSerialNumber == other.volumeSerialNumber && fileIndex == other.fileIndex && size == other.size &&
+               lastWriteTime == other.lastWriteTime && sha256 == other.sha256;
+    }
+};
+
+bool sha256OfFile(HANDLE hFile, std::string &outHash)
+{
+    BCRYPT_ALG_HANDLE hAlg = NULL;
+    BCRYPT_HASH_HANDLE hHash = NULL;
+    bool isOk = false;
+    if (BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_SHA256_ALGORITHM, NULL, 0) == 0 &&
+        BCryptCreateHash(hAlg, &hHash, NULL, 0, NULL, 0, 0) == 0)
+    {
+        std::string buf(64 * 1024, '\0');
+        DWORD bytesRead = 0;
+        isOk = true;
+        while (ReadFile(hFile, &buf[0], static_cast<DWORD>(buf.size()), &bytesRead, NULL) && bytesRead > 0)
+        {
+            if (BCryptHashData(hHash, reinterpret_cast<PUCHAR>(&buf[0]), bytesRead, 0) != 0)
+            {
+                isOk = false;
+                break;
+            }
+        }
+        if (isOk && GetLastError() != ERROR_SUCCESS && GetLastError() != ERROR_HANDLE_EOF)
+        {
+            isOk = false;
+        }
+        outHash.assign(32, '\0');
+        isOk = isOk && BCryptFinishHash(hHash, reinterpret_cast<PUCHAR>(&outHash[0]), 32, 0) == 0;
+    }
+    if (hHash != NULL) BCryptDestroyHash(hHash);
+    if (hAlg != NULL) BCryptCloseAlgorithmProvider(hAlg, 0);
+    return isOk;
+}
+
+// the file is opened without the write sharing, so it can't change while it is read
+bool readFileIdentity(const std::wstring &exePath, FileIdentity &outIdentity)
+{
+    HANDLE hFile = CreateFileW(exePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    BY_HANDLE_FILE_INFORMATION info;
+    bool isOk = GetFileInformationByHandle(hFile, &info) != FALSE;
+    if (isOk)
+    {
+        outIdentity.volumeSerialNumber = info.dwVolumeSerialNumber;
+        outIdentity.fileIndex = (static_cast<ULONGLONG>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        outIdentity.size = (static_cast<ULONGLONG>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        outIdentity.lastWriteTime = (static_cast<ULONGLONG>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                                    info.ftLastWriteTime.dwLowDateTime;
+        SetLastError(ERROR_SUCCESS);
+        isOk = sha256OfFile(hFile, outIdentity.sha256);
+    }
+    CloseHandle(hFile);
+    return isOk;
+}
+
+// The successful verifications of the process, so the executables started again on reconnects are not verified
+// with WinVerifyTrust each time. An entry is used only for the same file contents and only for a short time.
+class VerifiedFilesCache
+{
+public:
+    static constexpr ULONGLONG VALIDITY_MS = 5 * 60 * 1000;
+
+    bool isVerified(const std::wstring &exePath, const FileIdentity &identity)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto it = entries_.find(key(exePath));
+        if (it == entries_.end())
+        {
+            return false;
+        }
+        if (GetTickCount64() - it->second.verifiedTick > VALIDITY_MS || !(it->second.identity == identity))
+        {
+            entries_.erase(it);
+            return false;
+        }
+        return true;
+    }
+
+    void add(const std::wstring &exePath, const FileIdentity &identity)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        Entry &entry = entries_[key(exePath)];
+        entry.identity = identity;
+        entry.verifiedTick = GetTickCount64();
+    }
+
+private:
+    struct Entry
+    {
+        FileIdentity identity;
+        ULONGLONG verifiedTick;
+    };
+
+    std::mutex mutex_;
+    std::map<std::wstring, Entry> entries_;
+
+    static std::wstring key(const std::wstring &exePath)
+    {
+        std::wstring str = exePath;
+        std::replace(str.begin(), str.end(), L'/', L'\\');
+        std::transform(str.begin(), str.end(), str.begin(), ::towlower);
+        return str;
+    }
+};
+
+VerifiedFilesCache g_verifiedFilesCache;
+
+} // namespace
 
 ExecutableSignaturePrivate::ExecutableSignaturePrivate(ExecutableSignature* const q) : ExecutableSignaturePrivateBase(q)
 {
@@ -27,6 +162,29 @@ bool ExecutableSignaturePrivate::verify(const std::string& exePath)
 }
 
 bool ExecutableSignaturePrivate::verify(const std::wstring& exePath)
+{
+    FileIdentity identity;
+    const bool isIdentityRead = readFileIdentity(exePath, identity);
+    if (isIdentityRead && g_verifiedFilesCache.isVerified(exePath, identity))
+    {
+        return true;
+    }
+
+    if (!verifyUncached(exePath))
+    {
+        return false;
+    }
+
+    // cached only if the file did not change during the verification
+    FileIdentity identityAfter;
+    if (isIdentityRead && readFileIdentity(exePath, identityAfter) && identityAfter == identity)
+    {
+        g_verifiedFilesCache.add(exePath, identity);
+    }
+    return true;
+}
+
+bool ExecutableSignaturePrivate::verifyUncached(const std::wstring& exePath)
 {
     if (!verifyEmbeddedSignature(exePath))
 	{
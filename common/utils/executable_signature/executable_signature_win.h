@@ -17,6 +17,7 @@ public:
 private:
     explicit ExecutableSignaturePrivate(ExecutableSignature* const q);
 
+    bool verifyUncached(const std::wstring &exePath);
     bool verifyEmbeddedSignature(const std::wstring &exePath);
     bool checkWindscribeCertificate(PCCERT_CONTEXT pCertContext);
 
@@ -17,8 +17,21 @@ const QString WS_TT_TIMEOUT_STR     = WS_PREFIX + "tunnel-test-timeout";
 const QString WS_TT_RETRY_DELAY_STR = WS_PREFIX + "tunnel-test-retry-delay";
 const QString WS_TT_ATTEMPTS_STR    = WS_PREFIX + "tunnel-test-attempts";
 
+const QString WS_UPDATE_DOWNLOAD_SPEED_LIMIT_STR = WS_PREFIX + "update-download-speed-limit";
+
 const QString WS_STAGING_STR    = WS_PREFIX + "staging";
 
+const QString WS_RENDEZVOUS_NODE_SELECTION_STR = WS_PREFIX + "rendezvous-node-selection";
+
+const QString WS_SPEED_TEST_URL_STR = WS_PREFIX + "speedtest-url";
+
+const QString WS_METRICS_PORT_STR = WS_PREFIX + "metrics-port";
+
+const QString WS_NETWORK_RECORD_STR = WS_PREFIX + "network-record-file";
+const QString WS_NETWORK_REPLAY_STR = WS_PREFIX + "network-replay-file";
+const QString WS_NETWORK_REPLAY_LATENCY_STR = WS_PREFIX + "network-replay-latency-ms";
+const QString WS_NETWORK_REPLAY_LOSS_STR = WS_PREFIX + "network-replay-loss-percent";
+
 void ExtraConfig::writeConfig(const QString &cfg)
 {
     QMutexLocker locker(&mutex_);
@@ -199,6 +212,16 @@ int ExtraConfig::getTunnelTestAttempts(bool &success)
     return attempts;
 }
 
+int ExtraConfig::getUpdateDownloadSpeedLimit(bool &success)
+{
+    int limit = getIntFromExtraConfigLines(WS_UPDATE_DOWNLOAD_SPEED_LIMIT_STR, success);
+    if (success && limit < 0) {
+        limit = 0;
+    }
+
+    return limit;
+}
+
 bool ExtraConfig::getOverrideUpdateChannelToInternal()
 {
     return getFlagFromExtraConfigLines(WS_UPDATE_CHANNEL_INTERNAL);
@@ -209,6 +232,45 @@ bool ExtraConfig::getIsStaging()
     return getFlagFromExtraConfigLines(WS_STAGING_STR);
 }
 
+bool ExtraConfig::getUseRendezvousNodeSelection()
+{
+    return getFlagFromExtraConfigLines(WS_RENDEZVOUS_NODE_SELECTION_STR);
+}
+
+QString ExtraConfig::getSpeedTestUrl()
+{
+    return getStringFromExtraConfigLines(WS_SPEED_TEST_URL_STR);
+}
+
+int ExtraConfig::getMetricsPort(bool &success)
+{
+    const int port = getIntFromExtraConfigLines(WS_METRICS_PORT_STR, success);
+    success = success && port > 0 && port <= 65535;
+    return success ? port : 0;
+}
+
+QString ExtraConfig::getNetworkRecordPath()
+{
+    return getStringFromExtraConfigLines(WS_NETWORK_RECORD_STR);
+}
+
+QString ExtraConfig::getNetworkReplayPath()
+{
+    return getStringFromExtraConfigLines(WS_NETWORK_REPLAY_STR);
+}
+
+int ExtraConfig::getNetworkReplayLatency(bool &success)
+{
+    const int latency = getIntFromExtraConfigLines(WS_NETWORK_REPLAY_LATENCY_STR, success);
+    return success ? qMax(0, latency) : 0;
+}
+
+int ExtraConfig::getNetworkReplayLossPercent(bool &success)
+{
+    const int loss = getIntFromExtraConfigLines(WS_NETWORK_REPLAY_LOSS_STR, success);
+    return success ? qBound(0, loss, 100) : 0;
+}
+
 int ExtraConfig::getIntFromLineWithString(const QString &line, const QString &str, bool &success)
 {
     int endOfId = line.indexOf(str, Qt::CaseInsensitive) + str.length();
@@ -249,6 +311,26 @@ int ExtraConfig::getIntFromExtraConfigLines(const QString &variableName, bool &s
     return 0;
 }
 
+QString ExtraConfig::getStringFromExtraConfigLines(const QString &variableName)
+{
+    const QString strExtraConfig = getExtraConfig();
+    const QStringList strs = strExtraConfig.split("\n");
+
+    for (const QString &line : strs)
+    {
+        QString lineTrimmed = line.trimmed();
+        if (lineTrimmed.startsWith(variableName, Qt::CaseInsensitive))
+        {
+            int equals = lineTrimmed.indexOf("=", variableName.length());
+            if (equals != -1)
+            {
+                return lineTrimmed.mid(equals + 1).trimmed();
+            }
+        }
+    }
+    return QString();
+}
+
 bool ExtraConfig::getFlagFromExtraConfigLines(const QString &flagName)
 {
     const QString strExtraConfig = getExtraConfig();
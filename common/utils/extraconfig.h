@@ -40,8 +40,22 @@ public:
     int getTunnelTestRetryDelay(bool &success);
     int getTunnelTestAttempts(bool &success);
 
+    // in KB/s, 0 is unlimited
+    int getUpdateDownloadSpeedLimit(bool &success);
+
     bool getOverrideUpdateChannelToInternal();
     bool getIsStaging();
+    // nodes of a location are ordered by the rendezvous hash of the device id instead of weighted random
+    bool getUseRendezvousNodeSelection();
+    // the download for the tunnel speed test, empty if not set
+    QString getSpeedTestUrl();
+    // the port of the local metrics endpoint of the engine (127.0.0.1 only), not listened if not set
+    int getMetricsPort(bool &success);
+    // the files of NetworkRecorder, empty if not set
+    QString getNetworkRecordPath();
+    QString getNetworkReplayPath();
+    int getNetworkReplayLatency(bool &success);
+    int getNetworkReplayLossPercent(bool &success);
 
 private:
     ExtraConfig();
@@ -54,6 +68,7 @@ private:
     int getIntFromLineWithString(const QString &line, const QString &str, bool &success);
     int getIntFromExtraConfigLines(const QString &variableName, bool &success);
     bool getFlagFromExtraConfigLines(const QString &flagName);
+    QString getStringFromExtraConfigLines(const QString &variableName);
 
     bool isLegalOpenVpnCommand(const QString &command) const;
 
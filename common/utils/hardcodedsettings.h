@@ -25,6 +25,10 @@ public:
     const QStringList googleDns() const;
     const QStringList cloudflareDns() const;
     const QStringList controldDns() const;
+    // the DNS-over-HTTPS endpoint of Cloudflare, by IP (the certificate covers it), so it doesn't need DNS itself
+    QString cloudflareDohUrl() const { return "https://1.1.1.1/dns-query"; }
+    // the download for the tunnel speed test (25 MB), can be overridden with ws-speedtest-url in the extra config
+    QString speedTestUrl() const { return "https://speed.cloudflare.com/__down?bytes=25000000"; }
     const QStringList apiIps() const { return apiIps_; }
 
     QString emergencyUsername() const { return emergencyUsername_; }
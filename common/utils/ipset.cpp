@@ -0,0 +1,185 @@
+#include "ipset.h"
+#include <QHostAddress>
+#include <algorithm>
+
+IpSet::IpSet() : isNormalized_(true)
+{
+}
+
+IpSet::IpSet(const QStringList &ips) : isNormalized_(true)
+{
+    ranges_.reserve(ips.count());
+    for (const QString &ip : ips)
+    {
+        add(ip);
+    }
+}
+
+bool IpSet::add(const QString &ip)
+{
+    quint32 addr;
+    int prefixLength;
+    if (!parse(ip, addr, prefixLength))
+    {
+        return false;
+    }
+    add(addr, prefixLength);
+    return true;
+}
+
+void IpSet::add(quint32 ip, int prefixLength)
+{
+    Q_ASSERT(prefixLength >= 0 && prefixLength <= 32);
+    const quint32 hostMask = prefixLength == 0 ? 0xFFFFFFFF : ((1ULL << (32 - prefixLength)) - 1);
+    const quint32 first = ip & ~hostMask;
+    ranges_ << Range(first, first | hostMask);
+    isNormalized_ = false;
+}
+
+void IpSet::add(const IpSet &other)
+{
+    ranges_ << other.ranges_;
+    isNormalized_ = false;
+}
+
+bool IpSet::contains(quint32 ip) const
+{
+    normalize();
+    // the first range starting after ip, the one before it may contain ip
+    auto it = std::upper_bound(ranges_.cbegin(), ranges_.cend(), ip, [](quint32 value, const Range &r) {
+        return value < r.first;
+    });
+    return it != ranges_.cbegin() && ip <= (it - 1)->second;
+}
+
+bool IpSet::contains(const QString &ip) const
+{
+    quint32 addr;
+    int prefixLength;
+    return parse(ip, addr, prefixLength) && prefixLength == 32 && contains(addr);
+}
+
+bool IpSet::isEmpty() const
+{
+    return ranges_.isEmpty();
+}
+
+quint64 IpSet::addressCount() const
+{
+    normalize();
+    quint64 count = 0;
+    for (const Range &r : qAsConst(ranges_))
+    {
+        count += static_cast<quint64>(r.second) - r.first + 1;
+    }
+    return count;
+}
+
+IpSet IpSet::subtracted(const IpSet &other) const
+{
+    normalize();
+    other.normalize();
+
+    IpSet result;
+    int j = 0;
+    for (const Range &r : qAsConst(ranges_))
+    {
+        quint64 first = r.first;
+        const quint64 last = r.second;
+        while (j < other.ranges_.count() && other.ranges_[j].second < first)
+        {
+            j++;
+        }
+        for (int k = j; k < other.ranges_.count() && other.ranges_[k].first <= last && first <= last; ++k)
+        {
+            if (other.ranges_[k].first > first)
+            {
+                result.ranges_ << Range(static_cast<quint32>(first), other.ranges_[k].first - 1);
+            }
+            first = static_cast<quint64>(other.ranges_[k].second) + 1;
+        }
+        if (first <= last)
+        {
+            result.ranges_ << Range(static_cast<quint32>(first), r.second);
+        }
+    }
+    return result;   // sorted and disjoint
+}
+
+QStringList IpSet::toCidrList() const
+{
+    normalize();
+    QStringList list;
+    list.reserve(ranges_.count());
+    for (const Range &r : qAsConst(ranges_))
+    {
+        quint64 first = r.first;
+        const quint64 last = r.second;
+        while (first <= last)
+        {
+            // the largest block aligned at first which doesn't go over last
+            quint64 size = (first == 0) ? (1ULL << 32) : (first & (~first + 1));
+            while (first + size - 1 > last)
+            {
+                size >>= 1;
+            }
+            int prefixLength = 32;
+            for (quint64 s = size; s > 1; s >>= 1)
+            {
+                prefixLength--;
+            }
+            const QString addr = QHostAddress(static_cast<quint32>(first)).toString();
+            list << (prefixLength == 32 ? addr : addr + "/" + QString::number(prefixLength));
+            first += size;
+        }
+    }
+    return list;
+}
+
+QString IpSet::toFirewallString() const
+{
+    return toCidrList().join(';');
+}
+
+bool IpSet::operator==(const IpSet &other) const
+{
+    normalize();
+    other.normalize();
+    return ranges_ == other.ranges_;
+}
+
+void IpSet::normalize() const
+{
+    if (isNormalized_)
+    {
+        return;
+    }
+    std::sort(ranges_.begin(), ranges_.end());
+    int count = 0;
+    for (int i = 0; i < ranges_.count(); ++i)
+    {
+        // overlapping or contiguous with the previous one
+        if (count > 0 && static_cast<quint64>(ranges_[i].first) <= static_cast<quint64>(ranges_[count - 1].second) + 1)
+        {
+            ranges_[count - 1].second = qMax(ranges_[count - 1].second, ranges_[i].second);
+        }
+        else
+        {
+            ranges_[count++] = ranges_[i];
+        }
+    }
+    ranges_.resize(count);
+    isNormalized_ = true;
+}
+
+bool IpSet::parse(const QString &ip, quint32 &outIp, int &outPrefixLength)
+{
+    const QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(ip.contains('/') ? ip : ip + "/32");
+    if (subnet.first.protocol() != QAbstractSocket::IPv4Protocol)
+    {
+        return false;
+    }
+    outIp = subnet.first.toIPv4Address();
+    outPrefixLength = subnet.second;
+    return true;
+}
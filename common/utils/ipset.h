@@ -0,0 +1,50 @@
+#ifndef IPSET_H
+#define IPSET_H
+
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Set of IPv4 addresses, stored as the sorted, merged ranges of the addresses (host order).
+// The adds are appended and merged on the first read, the membership is a binary search, and the set is given to
+// the firewall and split tunneling backends as the minimal list of CIDR blocks.
+// IPv6 isn't kept: the firewalls block all of IPv6 and the backends expect IPv4 only.
+class IpSet
+{
+public:
+    IpSet();
+    explicit IpSet(const QStringList &ips);
+
+    // "1.2.3.4" or "1.2.3.0/24", returns false for anything else
+    bool add(const QString &ip);
+    void add(quint32 ip, int prefixLength = 32);
+    void add(const IpSet &other);
+
+    bool contains(quint32 ip) const;
+    bool contains(const QString &ip) const;
+    bool isEmpty() const;
+    // the number of addresses
+    quint64 addressCount() const;
+
+    // the addresses of this set which are not in the other one
+    IpSet subtracted(const IpSet &other) const;
+
+    // sorted CIDR blocks, a single address without the prefix ("1.2.3.4", "1.2.4.0/23")
+    QStringList toCidrList() const;
+    QString toFirewallString() const;   // toCidrList() joined with ';'
+
+    bool operator==(const IpSet &other) const;
+    bool operator!=(const IpSet &other) const { return !(*this == other); }
+
+private:
+    typedef QPair<quint32, quint32> Range;   // first, last
+
+    mutable QVector<Range> ranges_;
+    mutable bool isNormalized_;
+
+    void normalize() const;
+    static bool parse(const QString &ip, quint32 &outIp, int &outPrefixLength);
+};
+
+#endif // IPSET_H
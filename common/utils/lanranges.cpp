@@ -0,0 +1,35 @@
+#include "lanranges.h"
+
+const QStringList &LanRanges::privateNetworks()
+{
+    return ranges().privateNetworks;
+}
+
+const QStringList &LanRanges::inboundExtras()
+{
+    return ranges().inboundExtras;
+}
+
+bool LanRanges::isLanAddress(const QString &ip)
+{
+    return ranges().lan.contains(ip);
+}
+
+const LanRanges::Ranges &LanRanges::ranges()
+{
+    static const Ranges r = []() {
+        const IpSet privateSet(QStringList() << "10.0.0.0/8" << "172.16.0.0/12" << "192.168.0.0/16");
+        const IpSet loopbackSet(QStringList() << "127.0.0.0/8");
+        const IpSet multicastSet(QStringList() << "224.0.0.0/4");
+
+        Ranges ranges;
+        ranges.privateNetworks = privateSet.toCidrList();
+        IpSet inboundExtraSet = loopbackSet;
+        inboundExtraSet.add(multicastSet);
+        ranges.inboundExtras = inboundExtraSet.toCidrList();
+        ranges.lan = privateSet;
+        ranges.lan.add(multicastSet);
+        return ranges;
+    }();
+    return r;
+}
@@ -0,0 +1,30 @@
+#ifndef LANRANGES_H
+#define LANRANGES_H
+
+#include <QStringList>
+#include "ipset.h"
+
+// The address ranges of "Allow LAN traffic", built and prefix-merged once and shared by the firewall backends and
+// the check of the local address in the preferences, so the rules and the check can't disagree.
+class LanRanges
+{
+public:
+    // the private networks (RFC 1918), allowed in both directions
+    static const QStringList &privateNetworks();
+    // the sources allowed inbound in addition: the loopback and the multicast addresses
+    static const QStringList &inboundExtras();
+
+    // a private or a multicast address, "a.b.c.d"
+    static bool isLanAddress(const QString &ip);
+
+private:
+    struct Ranges
+    {
+        IpSet lan;
+        QStringList privateNetworks;
+        QStringList inboundExtras;
+    };
+    static const Ranges &ranges();
+};
+
+#endif // LANRANGES_H
@@ -148,6 +148,15 @@ QString getLocalIP()
     return sLocalIP;
 }
 
+bool pingWithMtu(const QString &url, int mtu)
+{
+    // -M do sets the don't fragment flag, as -D on Mac and -f on Windows
+    const QString cmd = QString("ping -c 1 -W 1 -M do -s %1 %2 2> /dev/null").arg(mtu).arg(url);
+    QString result = Utils::execCmd(cmd).trimmed();
+    // only a reply line, the "Frag needed and DF set" error line has an icmp_seq= too
+    return result.contains(" bytes from ");
+}
+
 static QString getNetlinkIP(int family, const char* buffer)
 {
     char dst[INET6_ADDRSTRLEN] = {0};
@@ -11,6 +11,7 @@ namespace LinuxUtils
     QString getLinuxKernelVersion();
     const QString getLastInstallPlatform();
     QString getLocalIP();
+    bool pingWithMtu(const QString &url, int mtu);
 
     // CLI
     bool isGuiAlreadyRunning();
@@ -2,14 +2,19 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QDateTime>
+#include <QThread>
+#include "logringbuffer.h"
 
 QFile *Logger::file_ = NULL;
 QMutex Logger::mutex_;
-QString Logger::strLog_;
 QString Logger::logPath_;
 QString Logger::prevLogPath_;
 bool Logger::consoleOutput_;
 QtMessageHandler Logger::prevMessageHandler_ = NULL;
+LogRingBuffer *Logger::ringBuffer_ = NULL;
+QAtomicInt Logger::droppedLines_;
+QAtomicInt Logger::isStopFlusher_;
+QThread *Logger::flusherThread_ = NULL;
 
 Q_LOGGING_CATEGORY(LOG_BASIC, "basic")
 Q_LOGGING_CATEGORY(LOG_IPC, "ipc")
@@ -38,6 +43,7 @@ Q_LOGGING_CATEGORY(LOG_LAUNCH_ON_STARTUP, "launch_on_startup")
 Q_LOGGING_CATEGORY(LOG_CONNECTED_DNS, "connected_dns")
 Q_LOGGING_CATEGORY(LOG_AUTH_HELPER, "auth_helper")
 Q_LOGGING_CATEGORY(LOG_DNS_RESOLVER, "dns_resolver")
+Q_LOGGING_CATEGORY(LOG_TRACE, "trace")
 
 
 Q_LOGGING_CATEGORY(LOG_USER,  "user")
@@ -68,6 +74,9 @@ void Logger::install(const QString &name, bool consoleOutput, bool recoveryMode)
     file_ = new QFile(logFilePath);
     file_->open(openModeFlag);
     consoleOutput_ = consoleOutput;
+    ringBuffer_ = new LogRingBuffer(RING_BUFFER_CAPACITY);
+    flusherThread_ = QThread::create(flusherLoop);
+    flusherThread_->start(QThread::LowPriority);
     prevMessageHandler_ = qInstallMessageHandler(myMessageHandler);
 }
 
@@ -77,12 +86,29 @@ Logger::Logger()
 
 Logger::~Logger()
 {
+    // stopped from main() already, the thread must not outlive it
+    Q_ASSERT(!flusherThread_);
+    flushRingBuffer();
+
     QMutexLocker lock(&mutex_);
     if (file_)
     {
         file_->close();
         delete file_;
+        file_ = NULL;
+    }
+}
+
+void Logger::stop()
+{
+    if (flusherThread_)
+    {
+        isStopFlusher_.storeRelease(1);
+        flusherThread_->wait();
+        delete flusherThread_;
+        flusherThread_ = NULL;
     }
+    flushRingBuffer();
 }
 
 void Logger::copyToPrevLog()
@@ -96,19 +122,21 @@ void Logger::copyToPrevLog()
 
 void Logger::myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &s)
 {
+    if (ringBuffer_)
     {
-        QMutexLocker lock(&mutex_);
+        QString str = qFormatLogMessage(type, context, s);
+        QString strDateTime = QDateTime::currentDateTimeUtc().toString("ddMMyy hh:mm:ss:zzz");
+        str.replace("{gmt_time}", strDateTime);
 
-        if (file_)
+        if (!ringBuffer_->push(str))
         {
-            QString str = qFormatLogMessage(type, context, s);
-            QString strDateTime = QDateTime::currentDateTimeUtc().toString("ddMMyy hh:mm:ss:zzz");
-            str.replace("{gmt_time}", strDateTime);
-
-            file_->write(str.toLocal8Bit());
-            file_->write("\r\n");
-            file_->flush();
-            strLog_ += str + "\n";
+            droppedLines_.fetchAndAddRelaxed(1);
+        }
+
+        // the process is going to abort, the line must be in the file before; after stop() there is no flusher
+        if (type == QtFatalMsg || isStopFlusher_.loadAcquire())
+        {
+            flushRingBuffer();
         }
     }
     if (consoleOutput_)
@@ -117,23 +145,42 @@ void Logger::myMessageHandler(QtMsgType type, const QMessageLogContext &context,
     }
 }
 
-QString Logger::getLogStr()
+void Logger::flushRingBuffer()
 {
     QMutexLocker lock(&mutex_);
-    QString ret;
-    QFile prevFileLog(prevLogPath_);
-    if (prevFileLog.open(QIODevice::ReadOnly))
+    if (!ringBuffer_ || !file_)
     {
-        ret = prevFileLog.readAll();
-        ret += "----------------------------------------------------------------\n";
-        prevFileLog.close();
+        return;
+    }
+
+    QByteArray batch;
+    QString str;
+    while (ringBuffer_->pop(str))
+    {
+        batch += str.toLocal8Bit();
+        batch += "\r\n";
+    }
+
+    const int droppedLines = droppedLines_.fetchAndStoreRelaxed(0);
+    if (droppedLines > 0)
+    {
+        const QString dropped = QString("Logger: %1 lines dropped, the log buffer is full").arg(droppedLines);
+        batch += dropped.toLocal8Bit();
+        batch += "\r\n";
+    }
+
+    if (!batch.isEmpty())
+    {
+        file_->write(batch);
+        file_->flush();
     }
-    ret += strLog_;
-    return ret;
 }
 
-QString Logger::getCurrentLogStr()
+void Logger::flusherLoop()
 {
-    QMutexLocker lock(&mutex_);
-    return strLog_;
+    while (!isStopFlusher_)
+    {
+        flushRingBuffer();
+        QThread::msleep(FLUSH_INTERVAL);
+    }
 }
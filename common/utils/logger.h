@@ -3,6 +3,7 @@
 
 #include <QFile>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QLoggingCategory>
 
 #include "clean_sensitive_info.h"
@@ -36,6 +37,7 @@ Q_DECLARE_LOGGING_CATEGORY(LOG_LAUNCH_ON_STARTUP)
 Q_DECLARE_LOGGING_CATEGORY(LOG_CONNECTED_DNS)
 Q_DECLARE_LOGGING_CATEGORY(LOG_AUTH_HELPER)
 Q_DECLARE_LOGGING_CATEGORY(LOG_DNS_RESOLVER)
+Q_DECLARE_LOGGING_CATEGORY(LOG_TRACE)
 
 
 // for GUI
@@ -44,6 +46,11 @@ Q_DECLARE_LOGGING_CATEGORY(LOG_LOCATION_LIST)
 Q_DECLARE_LOGGING_CATEGORY(LOG_PREFERENCES)
 
 
+class LogRingBuffer;
+class QThread;
+
+// the log lines are formatted in the calling thread and queued to a lock-free ring buffer,
+// the flusher thread writes them to the file in batches, so the callers never wait on the disk
 class Logger
 {
 public:
@@ -54,9 +61,10 @@ public:
     }
 
     void install(const QString &name, bool consoleOutput, bool recoveryMode);
+    // stops and joins the flusher thread at the app shutdown (before the static destructors), the lines logged
+    // later are written by the callers
+    void stop();
     void setConsoleOutput(bool on);
-    QString getLogStr();
-    QString getCurrentLogStr();
 
 private:
     Logger();
@@ -65,16 +73,25 @@ private:
     static void myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &s);
 
 private:
+    static constexpr int RING_BUFFER_CAPACITY = 16384;     // lines, when full the new lines are dropped and counted
+    static constexpr int FLUSH_INTERVAL = 50;              // ms
+
     static QtMessageHandler prevMessageHandler_;
 
     static QFile *file_;
-    static QMutex mutex_;
-    static QString strLog_;
+    static QMutex mutex_;       // file_ and the consumer side of ringBuffer_
     static QString logPath_;
     static QString prevLogPath_;
     static bool consoleOutput_;
 
+    static LogRingBuffer *ringBuffer_;
+    static QAtomicInt droppedLines_;
+    static QAtomicInt isStopFlusher_;
+    static QThread *flusherThread_;
+
     static void copyToPrevLog();
+    static void flushRingBuffer();
+    static void flusherLoop();
 };
 
 
@@ -0,0 +1,87 @@
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+// Bounded lock-free queue of the log lines, many producers and one consumer (D. Vyukov's bounded queue).
+// Each cell has a sequence number: the producers reserve a cell by CAS on the enqueue position and publish it
+// with the sequence, the consumer takes the cells in order. When the queue is full, push() fails without waiting.
+class LogRingBuffer
+{
+public:
+    explicit LogRingBuffer(int capacity) : cells_(new Cell[capacity]), mask_(capacity - 1), enqueuePos_(0), dequeuePos_(0)
+    {
+        Q_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        for (int i = 0; i < capacity; ++i)
+        {
+            cells_[i].sequence.store(i);
+        }
+    }
+
+    ~LogRingBuffer()
+    {
+        delete[] cells_;
+    }
+
+    // thread-safe
+    bool push(const QString &str)
+    {
+        quint32 pos = enqueuePos_.load();
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            const qint32 dif = static_cast<qint32>(cell->sequence.loadAcquire() - pos);
+            if (dif == 0)
+            {
+                if (enqueuePos_.testAndSetRelaxed(pos, pos + 1, pos))
+                {
+                    break;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false;   // full
+            }
+            else
+            {
+                pos = enqueuePos_.load();
+            }
+        }
+        cell->str = str;
+        cell->sequence.storeRelease(pos + 1);
+        return true;
+    }
+
+    // only one consumer at a time
+    bool pop(QString &str)
+    {
+        Cell &cell = cells_[dequeuePos_ & mask_];
+        if (static_cast<qint32>(cell.sequence.loadAcquire() - (dequeuePos_ + 1)) < 0)
+        {
+            return false;   // empty
+        }
+        str.swap(cell.str);
+        cell.str.clear();
+        cell.sequence.storeRelease(dequeuePos_ + mask_ + 1);
+        dequeuePos_++;
+        return true;
+    }
+
+private:
+    Q_DISABLE_COPY(LogRingBuffer)
+
+    struct Cell
+    {
+        QAtomicInteger<quint32> sequence;
+        QString str;
+    };
+
+    Cell *cells_;
+    const quint32 mask_;
+    QAtomicInteger<quint32> enqueuePos_;
+    quint32 dequeuePos_;
+};
+
+#endif // LOGRINGBUFFER_H
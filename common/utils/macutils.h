@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QList>
+#include <functional>
 
 namespace MacUtils
 {
@@ -35,6 +36,9 @@ namespace MacUtils
     bool verifyAppBundleIntegrity();
 
     bool isParentProcessGui();
+
+    // the handler is called on the main thread on the memory pressure warnings of the OS
+    void setMemoryPressureHandler(std::function<void()> handler);
 }
 
 
@@ -276,3 +276,20 @@ bool MacUtils::isParentProcessGui()
     }
     return false;
 }
+
+void MacUtils::setMemoryPressureHandler(std::function<void()> handler)
+{
+    // the source lives until the exit, a new handler replaces the previous one
+    static dispatch_source_t source = nullptr;
+    if (source)
+    {
+        dispatch_source_cancel(source);
+    }
+    source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                    DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                    dispatch_get_main_queue());
+    dispatch_source_set_event_handler(source, ^{
+        handler();
+    });
+    dispatch_resume(source);
+}
@@ -5,11 +5,14 @@
 #include <QStandardPaths>
 #include <QTextStream>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
-#include <thread>
-#include <future>
+#include <vector>
 
 namespace
 {
@@ -59,6 +62,114 @@ QDateTime parseDateTimeFormat2(const std::string &datestr)
     }
 }
 
+// reads the lines with the date of one log file in order
+class LogFileReader
+{
+public:
+    LogFileReader(const QString &filename, int source, bool useMinMax, const QDateTime &min, const QDateTime &max) :
+        filename_(filename.toStdString()), source_(source), useMinMax_(useMinMax), min_(min), max_(max),
+        currentYearOffset_(QDateTime::currentDateTime().date().year() - 1900), msecs_(0)
+    {
+    }
+
+    // (re)opens the file, the next() must be called to read the first line
+    bool open()
+    {
+        file_.close();
+        file_.clear();
+        file_.open(filename_);
+        msecs_ = 0;
+        return !file_.fail();
+    }
+
+    bool next()
+    {
+        while (std::getline(file_, line_))
+        {
+            if (line_.empty() || line_[0] != '[')
+                continue;
+            const auto datestr = line_.substr(1, 19);
+
+            const auto datetime = isYearInDatePresent(datestr)
+                ? parseDateTimeFormat1(datestr)
+                    .addYears(100)
+                : parseDateTimeFormat2(datestr)
+                    .addYears(currentYearOffset_);
+
+            if (useMinMax_ && (datetime < min_ || datetime > max_))
+                continue;
+
+            // a line without a correct date keeps the time of the previous one, so the file stays sorted
+            if (datetime.isValid())
+                msecs_ = datetime.toMSecsSinceEpoch();
+            return true;
+        }
+        file_.close();
+        return false;
+    }
+
+    qint64 msecs() const { return msecs_; }
+    int source() const { return source_; }
+    const std::string &line() const { return line_; }
+
+private:
+    std::string filename_;
+    int source_;
+    bool useMinMax_;
+    QDateTime min_;
+    QDateTime max_;
+    int currentYearOffset_;
+
+    std::ifstream file_;
+    std::string line_;
+    qint64 msecs_;
+};
+
+const char *TRACE_SPAN_MARKER = "trace_span ";
+
+// appends the spans of the log file as the complete events ("ph":"X") of the process pid
+void appendTraceEvents(const QString &filename, int pid, QJsonArray &events)
+{
+    std::ifstream file(filename.toStdString());
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t pos = line.find(TRACE_SPAN_MARKER);
+        if (pos == std::string::npos)
+            continue;
+
+        // <category> <start us> <duration us> <thread id> <name>
+        std::istringstream stream(line.substr(pos + strlen(TRACE_SPAN_MARKER)));
+        std::string category, name;
+        long long startUs, durationUs;
+        unsigned long long threadId;
+        if (!(stream >> category >> startUs >> durationUs >> threadId))
+            continue;
+        std::getline(stream >> std::ws, name);
+
+        QJsonObject event;
+        event["name"] = QString::fromStdString(name);
+        event["cat"] = QString::fromStdString(category);
+        event["ph"] = "X";
+        event["ts"] = static_cast<double>(startUs);
+        event["dur"] = static_cast<double>(durationUs);
+        event["pid"] = pid;
+        event["tid"] = static_cast<double>(threadId);
+        events.append(event);
+    }
+}
+
+QJsonObject processNameEvent(int pid, const QString &name)
+{
+    QJsonObject args;
+    args["name"] = name;
+    QJsonObject event;
+    event["name"] = "process_name";
+    event["ph"] = "M";
+    event["pid"] = pid;
+    event["args"] = args;
+    return event;
+}
 
 }  // namespace
 
@@ -82,6 +193,22 @@ QString MergeLog::mergePrevLogs(bool doMergePerLine)
                  wgPrevServiceLogFilename, doMergePerLine);
 }
 
+QByteArray MergeLog::mergeTraces()
+{
+    // the events don't have to be sorted, the viewers sort them by ts
+    enum { GUI_PID = 1, SERVICE_PID = 2 };
+    QJsonArray events;
+    events.append(processNameEvent(GUI_PID, "Windscribe"));
+    events.append(processNameEvent(SERVICE_PID, "Windscribe service"));
+    appendTraceEvents(guiLogLocation(), GUI_PID, events);
+    appendTraceEvents(serviceLogLocation(), SERVICE_PID, events);
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
 bool MergeLog::canMerge()
 {
     quint64 mergedFileSize = 0;
@@ -111,59 +238,6 @@ bool MergeLog::canMerge()
     return mergedFileSize < MAX_COMBINED_LOG_SIZE;
 }
 
-int MergeLog::mergeTask(QMutex *mutex, QMultiMap<quint64, QPair<LineSource, QString>> *lines, const QString *filename, LineSource source, bool useMinMax, QDateTime min, QDateTime max)
-{
-    int datasize = 0;
-    const int kCurrentYearOffset = QDateTime::currentDateTime().date().year() - 1900;
-    QDateTime prevDateTime;
-
-    std::ifstream file;
-    file.open(filename->toStdString());
-    if (file.fail())
-    {
-        return 0;
-    }
-
-    int timestamp = 0;
-    std::string line;
-    while (std::getline(file, line))
-    {
-        if (line[0] != '[')
-            continue;
-        const auto datestr = line.substr(1, 19);
-
-        const auto datetime = isYearInDatePresent(datestr)
-            ? parseDateTimeFormat1(datestr)
-                .addYears(100)
-            : parseDateTimeFormat2(datestr)
-                .addYears(kCurrentYearOffset);
-
-        if (useMinMax && (datetime < min || datetime > max))
-            continue;
-        if (prevDateTime != datetime) {
-            prevDateTime = datetime;
-            timestamp = 0;
-        }
-
-        // In QMultiMap, elements with the same key will be placed in a reverse order.
-        // https://doc.qt.io/qt-5/qmap-iterator.html#details
-        // To deal with the issue, we create a compound key: 44 bits for a timestamp, 2 bits
-        // for the source, and 18 additional lower bits for a "timestamp" (line serial
-        // number). We assume the maximum number of lines with unique timestamp never
-        // exceeds 262143, which is quite reasonable (it looks infeasible to output 250k+
-        // lines to a log file within 1 ms).
-        const auto key = (static_cast<quint64>(datetime.toMSecsSinceEpoch()) << 20)
-                       | (static_cast<quint64>(source) << 18) | qMin(timestamp++, 0x3ffff);
-
-        {
-            QMutexLocker locker(mutex);
-            lines->insert(key, qMakePair(source, QString::fromStdString(line)));
-        }
-        datasize += line.length() + 3;
-    }
-    return datasize;
-}
-
 const QString MergeLog::guiLogLocation()
 {
     QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
@@ -227,36 +301,63 @@ QString MergeLog::merge(const QString &guiLogFilename, const QString &serviceLog
                         const QString &servicePrevLogFilename, const QString &wireguardServiceLogFilename,
                         bool doMergePerLine)
 {
-    QMutex mutex;
-    QMultiMap<quint64, QPair<LineSource, QString>> lines;
+    // first pass: the time range of the GUI log, the count of lines and the size of the result
+    int linesCount = 0;
     int estimatedLogSize = 0;
 
-    auto futureGuiLog = std::async(MergeLog::mergeTask, &mutex, &lines, &guiLogFilename, LineSource::GUI, false, QDateTime(), QDateTime());
-    estimatedLogSize += futureGuiLog.get();
-
     QDateTime minDate, maxDate;
     bool isUseMinMaxDate = false;
-    if (lines.count() > 1)
     {
-        minDate = QDateTime::fromMSecsSinceEpoch(lines.firstKey() >> 20); // Strip source and timestamp.
-        maxDate = QDateTime::fromMSecsSinceEpoch(lines.lastKey() >> 20);
-        isUseMinMaxDate = true;
+        LogFileReader guiReader(guiLogFilename, static_cast<int>(LineSource::GUI), false, QDateTime(), QDateTime());
+        qint64 minMsecs = 0, maxMsecs = 0;
+        int guiLinesCount = 0;
+        if (guiReader.open())
+        {
+            while (guiReader.next())
+            {
+                if (guiLinesCount == 0 || guiReader.msecs() < minMsecs)
+                    minMsecs = guiReader.msecs();
+                if (guiLinesCount == 0 || guiReader.msecs() > maxMsecs)
+                    maxMsecs = guiReader.msecs();
+                guiLinesCount++;
+                estimatedLogSize += guiReader.line().length() + 3;
+            }
+        }
+        if (guiLinesCount > 1)
+        {
+            minDate = QDateTime::fromMSecsSinceEpoch(minMsecs);
+            maxDate = QDateTime::fromMSecsSinceEpoch(maxMsecs);
+            isUseMinMaxDate = true;
+        }
+        linesCount += guiLinesCount;
     }
 
-    auto futureService = std::async(MergeLog::mergeTask, &mutex, &lines, &serviceLogFilename, LineSource::SERVICE, isUseMinMaxDate, minDate, maxDate);
-    auto futureServicePrev = std::async(MergeLog::mergeTask, &mutex, &lines, &servicePrevLogFilename, LineSource::SERVICE, isUseMinMaxDate, minDate, maxDate);
-    estimatedLogSize += futureService.get() + futureServicePrev.get();
+    std::vector<LogFileReader> readers;
+    readers.reserve(4);
+    readers.emplace_back(guiLogFilename, static_cast<int>(LineSource::GUI), false, QDateTime(), QDateTime());
+    readers.emplace_back(serviceLogFilename, static_cast<int>(LineSource::SERVICE), isUseMinMaxDate, minDate, maxDate);
+    readers.emplace_back(servicePrevLogFilename, static_cast<int>(LineSource::SERVICE), isUseMinMaxDate, minDate, maxDate);
+    readers.emplace_back(wireguardServiceLogFilename, static_cast<int>(LineSource::WIREGUARD_SERVICE), isUseMinMaxDate, minDate, maxDate);
 
-    auto futureWGService = std::async(MergeLog::mergeTask, &mutex, &lines, &wireguardServiceLogFilename, LineSource::WIREGUARD_SERVICE, isUseMinMaxDate, minDate, maxDate);
-    estimatedLogSize += futureWGService.get();
+    for (size_t i = 1; i < readers.size(); ++i)
+    {
+        if (readers[i].open())
+        {
+            while (readers[i].next())
+            {
+                linesCount++;
+                estimatedLogSize += readers[i].line().length() + 3;
+            }
+        }
+    }
 
     if (!doMergePerLine)
         estimatedLogSize += 400;  // Account for log separation lines.
 
     QString result;
     result.reserve(estimatedLogSize);
-    auto logAppendFun = [&result](const QPair<LineSource, QString> &data) {
-        switch (data.first) {
+    auto logAppendFun = [&result](LineSource source, const std::string &line) {
+        switch (source) {
         case LineSource::GUI:
             result.append("G ");
             break;
@@ -269,49 +370,55 @@ QString MergeLog::merge(const QString &guiLogFilename, const QString &serviceLog
         default:
             break;
         }
-        result.append(data.second);
+        result.append(QString::fromStdString(line));
         result.append("\n");
     };
 
     // cut out the part of the log if the count of lines  exceeds MAX_COUNT_OF_LINES (keep 10% begin and 90% end of log)
     int cutCount = 0;
     int cutBeginInd = 0;
-    int cutEndInd = lines.count();
-    if (lines.count() > MAX_COUNT_OF_LINES)
+    int cutEndInd = linesCount;
+    if (linesCount > MAX_COUNT_OF_LINES)
     {
-        cutCount = lines.count() - MAX_COUNT_OF_LINES;
+        cutCount = linesCount - MAX_COUNT_OF_LINES;
         cutBeginInd = MAX_COUNT_OF_LINES / 10;
-        cutEndInd = lines.count() - MAX_COUNT_OF_LINES * 0.9;
+        cutEndInd = linesCount - MAX_COUNT_OF_LINES * 0.9;
     }
 
-    if (doMergePerLine) {
+    // second pass: k-way merge of the sorted files by (time, source), the lines of the same time keep the file order
+    // onlySource == NUM_LINE_SOURCES outputs all the lines, the index of a line is its index in the merged log anyway
+    auto mergeFun = [&](LineSource onlySource, const char *separator) {
+        std::vector<bool> hasLine(readers.size());
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            hasLine[i] = readers[i].open() && readers[i].next();
+        }
+
+        bool is_first_line = true;
         int ind = 0;
-        for (auto it = lines.constBegin(); it != lines.constEnd(); ++it)
+        while (true)
         {
-            // cut out middle
-            if (cutCount == 0 || ind < cutBeginInd || ind > cutEndInd)
+            int minInd = -1;
+            for (size_t i = 0; i < readers.size(); ++i)
             {
-                logAppendFun(it.value());
-            }
-            ind++;
-        }
-    } else {
-        const char *separators[] = { nullptr, "Engine", "Service" };
-        for (int i = 0; i < static_cast<int>(LineSource::NUM_LINE_SOURCES); ++i) {
-            const auto current_source = static_cast<LineSource>(i);
-            bool is_first_line = true;
-            int ind = 0;
-            for (auto it = lines.constBegin(); it != lines.constEnd(); ++it) {
-                if (it.value().first != current_source)
+                if (hasLine[i] && (minInd == -1 || readers[i].msecs() < readers[minInd].msecs() ||
+                                   (readers[i].msecs() == readers[minInd].msecs() && readers[i].source() < readers[minInd].source())))
                 {
-                    ind++;
-                    continue;
+                    minInd = static_cast<int>(i);
                 }
+            }
+            if (minInd == -1)
+                break;
+
+            LogFileReader &reader = readers[minInd];
+            const auto source = static_cast<LineSource>(reader.source());
+            if (onlySource == LineSource::NUM_LINE_SOURCES || onlySource == source)
+            {
                 if (is_first_line) {
                     is_first_line = false;
-                    if (separators[i]) {
+                    if (separator) {
                         result.append("---");
-                        result.append(separators[i]);
+                        result.append(separator);
                         result.append(QString().fill('-',189));
                         result.append("\n");
                     }
@@ -319,12 +426,21 @@ QString MergeLog::merge(const QString &guiLogFilename, const QString &serviceLog
                 // cut out middle
                 if (cutCount == 0 || ind < cutBeginInd || ind > cutEndInd)
                 {
-                    logAppendFun(it.value());
+                    logAppendFun(source, reader.line());
                 }
-                ind++;
             }
+            ind++;
+            hasLine[minInd] = reader.next();
+        }
+    };
+
+    if (doMergePerLine) {
+        mergeFun(LineSource::NUM_LINE_SOURCES, nullptr);
+    } else {
+        const char *separators[] = { nullptr, "Engine", "Service" };
+        for (int i = 0; i < static_cast<int>(LineSource::NUM_LINE_SOURCES); ++i) {
+            mergeFun(static_cast<LineSource>(i), separators[i]);
         }
     }
     return result;
 }
-
@@ -3,26 +3,30 @@
 
 #include <QDateTime>
 #include <QString>
-#include <QMutex>
-#include <vector>
 
 // merge logs files log_gui.txt, windscribeservice.log, and WireguardServiceLog.txt (Windows only) to one,
 // cutting out the middle of the log if the count of lines exceeds MAX_COUNT_OF_LINES
+// each file is already sorted by time, so the files are streamed through a k-way merge: two linear passes
+// (count and merge) without keeping the lines in memory except the result
 class MergeLog
 {
 public:
     static QString mergeLogs(bool doMergePerLine);
     static QString mergePrevLogs(bool doMergePerLine);
+    // the trace spans (see TraceSpan) of the current GUI and service logs in one timeline,
+    // as the Chrome tracing JSON (chrome://tracing, ui.perfetto.dev)
+    static QByteArray mergeTraces();
 
     // This is a quick hack to prevent GUI crash as result of merging files that are too large for the program
     static bool canMerge();
 private:
+    friend class BenchmarkEngine;
+
     static constexpr int MAX_COUNT_OF_LINES = 100000;
     static QString merge(const QString &guiLogFilename, const QString &serviceLogFilename, const QString &servicePrevLogFilename,
                          const QString &wireguardServiceLogFilename, bool doMergePerLine);
 
     enum class LineSource { GUI, SERVICE, WIREGUARD_SERVICE, NUM_LINE_SOURCES };
-    static int mergeTask(QMutex *mutex, QMultiMap<quint64, QPair<LineSource, QString>> *lines, const QString *filename, LineSource source, bool useMinMax, QDateTime min, QDateTime max);
 
     static const QString guiLogLocation();
     static const QString serviceLogLocation();
@@ -0,0 +1,162 @@
+#ifndef MULTIPATTERNMATCHER_H
+#define MULTIPATTERNMATCHER_H
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+
+// Aho-Corasick automaton over the characters of type C: built once for a set of patterns, it finds the occurrences
+// of all of them in one pass over the text instead of one pass per pattern.
+// The matches don't overlap, the leftmost one wins, and at the same position the pattern added first.
+template<typename C>
+class MultiPatternMatcher
+{
+public:
+    struct Match
+    {
+        size_t pos;
+        size_t length;
+        int patternIndex;       // in the order of addPattern(), the empty patterns are counted too
+    };
+
+    MultiPatternMatcher() : nodes_(1), patternsCount_(0), isBuilt_(false) {}
+
+    void addPattern(const C *pattern, size_t length)
+    {
+        const int patternIndex = patternsCount_++;
+        if (length == 0)
+        {
+            return;
+        }
+        int node = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            int next = child(node, pattern[i]);
+            if (next < 0)
+            {
+                next = static_cast<int>(nodes_.size());
+                nodes_.push_back(Node());
+                nodes_[next].depth = nodes_[node].depth + 1;
+                auto &edges = nodes_[node].next;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(), std::make_pair(pattern[i], 0), lessChar),
+                             std::make_pair(pattern[i], next));
+            }
+            node = next;
+        }
+        // the same pattern twice, the first one wins
+        if (nodes_[node].output < 0)
+        {
+            nodes_[node].output = patternIndex;
+        }
+        isBuilt_ = false;
+    }
+
+    // the failure links, must be called after the last addPattern()
+    void build()
+    {
+        std::deque<int> queue;
+        for (const auto &edge : nodes_[0].next)
+        {
+            nodes_[edge.second].fail = 0;
+            queue.push_back(edge.second);
+        }
+        while (!queue.empty())
+        {
+            const int node = queue.front();
+            queue.pop_front();
+            const int fail = nodes_[node].fail;
+            nodes_[node].outputLink = nodes_[fail].output >= 0 ? fail : nodes_[fail].outputLink;
+            for (const auto &edge : nodes_[node].next)
+            {
+                int f = fail;
+                int next = child(f, edge.first);
+                while (next < 0 && f != 0)
+                {
+                    f = nodes_[f].fail;
+                    next = child(f, edge.first);
+                }
+                nodes_[edge.second].fail = (next >= 0 && next != edge.second) ? next : 0;
+                queue.push_back(edge.second);
+            }
+        }
+        isBuilt_ = true;
+    }
+
+    bool isEmpty() const { return nodes_.size() == 1; }
+
+    // ordered by the position
+    std::vector<Match> findAll(const C *text, size_t length) const
+    {
+        std::vector<Match> candidates;
+        if (isEmpty() || !isBuilt_)
+        {
+            return candidates;
+        }
+
+        int node = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            int next = child(node, text[i]);
+            while (next < 0 && node != 0)
+            {
+                node = nodes_[node].fail;
+                next = child(node, text[i]);
+            }
+            node = next >= 0 ? next : 0;
+
+            for (int out = nodes_[node].output >= 0 ? node : nodes_[node].outputLink; out >= 0; out = nodes_[out].outputLink)
+            {
+                const size_t len = static_cast<size_t>(nodes_[out].depth);
+                candidates.push_back(Match{ i + 1 - len, len, nodes_[out].output });
+            }
+        }
+
+        // usually none or a few, so sorting them is cheaper than the leftmost logic in the automaton
+        std::sort(candidates.begin(), candidates.end(), [](const Match &a, const Match &b) {
+            return a.pos != b.pos ? a.pos < b.pos : a.patternIndex < b.patternIndex;
+        });
+        std::vector<Match> matches;
+        size_t end = 0;
+        for (const Match &m : candidates)
+        {
+            if (m.pos >= end)
+            {
+                matches.push_back(m);
+                end = m.pos + m.length;
+            }
+        }
+        return matches;
+    }
+
+private:
+    struct Node
+    {
+        std::vector<std::pair<C, int>> next;    // sorted by the character
+        int fail;
+        int output;             // the pattern ending here, -1 if none
+        int outputLink;         // the nearest node by the failure links with a pattern, -1 if none
+        int depth;
+
+        Node() : fail(0), output(-1), outputLink(-1), depth(0) {}
+    };
+
+    std::vector<Node> nodes_;
+    int patternsCount_;
+    bool isBuilt_;
+
+    static bool lessChar(const std::pair<C, int> &a, const std::pair<C, int> &b) { return a.first < b.first; }
+
+    int child(int node, C c) const
+    {
+        const auto &edges = nodes_[node].next;
+        const auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0), lessChar);
+        return (it != edges.end() && it->first == c) ? it->second : -1;
+    }
+};
+
+}  // namespace Utils
+
+#endif  // MULTIPATTERNMATCHER_H
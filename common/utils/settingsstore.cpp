@@ -0,0 +1,159 @@
+#include "settingsstore.h"
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include "logger.h"
+
+bool SettingsStore::contains(const QString &key)
+{
+    QMutexLocker locker(&mutex_);
+    return entry(key).isExists;
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue)
+{
+    QMutexLocker locker(&mutex_);
+    const Entry &e = entry(key);
+    return e.isExists ? e.value : defaultValue;
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    QMutexLocker locker(&mutex_);
+    Entry &e = cache_[key];
+    if (e.isExists && e.value == value)
+    {
+        return;
+    }
+    e.isExists = true;
+    e.value = value;
+    markDirty(key);
+}
+
+void SettingsStore::remove(const QString &key)
+{
+    QMutexLocker locker(&mutex_);
+    if (!entry(key).isExists)
+    {
+        return;
+    }
+    Entry &e = cache_[key];
+    e.isExists = false;
+    e.value = QVariant();
+    markDirty(key);
+}
+
+bool SettingsStore::flush()
+{
+    QMutexLocker flushLocker(&flushMutex_);
+
+    QHash<QString, Entry> entries;
+    QStringList namespaces;
+    {
+        QMutexLocker locker(&mutex_);
+        isFlushScheduled_ = false;
+        if (dirtyKeys_.isEmpty())
+        {
+            return true;
+        }
+        for (auto it = dirtyKeys_.constBegin(); it != dirtyKeys_.constEnd(); ++it)
+        {
+            namespaces << it.key();
+            for (const QString &key : it.value())
+            {
+                entries[key] = cache_.value(key);
+            }
+        }
+        dirtyKeys_.clear();
+    }
+
+    QSettings settings;
+    // a crash in the middle of the sync leaves the previous file, not a truncated one
+    settings.setAtomicSyncRequired(true);
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        if (it.value().isExists)
+        {
+            settings.setValue(it.key(), it.value().value);
+        }
+        else
+        {
+            settings.remove(it.key());
+        }
+    }
+    settings.sync();
+
+    if (settings.status() != QSettings::NoError)
+    {
+        qCDebug(LOG_BASIC) << "SettingsStore: failed to write" << namespaces << ", status =" << settings.status();
+        QMutexLocker locker(&mutex_);
+        for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        {
+            markDirty(it.key());
+        }
+        return false;
+    }
+    return true;
+}
+
+void SettingsStore::onFlushTimer()
+{
+    flush();
+}
+
+SettingsStore::SettingsStore() : QObject(nullptr), flushTimer_(nullptr), isFlushScheduled_(false)
+{
+    // created before the move, a child can't be created for an object of another thread
+    flushTimer_ = new QTimer(this);
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(FLUSH_DELAY_MS);
+    connect(flushTimer_, SIGNAL(timeout()), SLOT(onFlushTimer()));
+
+    // the timer lives in the main thread, the store can be created first by the engine thread
+    if (QCoreApplication::instance())
+    {
+        moveToThread(QCoreApplication::instance()->thread());
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SettingsStore::flush, Qt::DirectConnection);
+    }
+}
+
+const SettingsStore::Entry &SettingsStore::entry(const QString &key)
+{
+    auto it = cache_.find(key);
+    if (it == cache_.end())
+    {
+        QSettings settings;
+        Entry e;
+        e.isExists = settings.contains(key);
+        if (e.isExists)
+        {
+            e.value = settings.value(key);
+        }
+        it = cache_.insert(key, e);
+    }
+    return it.value();
+}
+
+void SettingsStore::markDirty(const QString &key)
+{
+    dirtyKeys_[keyNamespace(key)].insert(key);
+    scheduleFlush();
+}
+
+void SettingsStore::scheduleFlush()
+{
+    if (!isFlushScheduled_)
+    {
+        isFlushScheduled_ = true;
+        // the timer can only be started from its thread
+        QMetaObject::invokeMethod(flushTimer_, "start", Qt::QueuedConnection);
+    }
+}
+
+QString SettingsStore::keyNamespace(const QString &key)
+{
+    const int ind = key.indexOf('/');
+    return ind == -1 ? key : key.left(ind);
+}
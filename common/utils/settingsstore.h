@@ -0,0 +1,67 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QVariant>
+
+class QTimer;
+
+// singleton, the write-back cache in front of QSettings (the default scope) for the GUI and the engine.
+// Reads are served from memory after the first one, writes only mark the key dirty (grouped by the namespace,
+// the part of the key before the first '/') and a flush is coalesced on a timer, so a burst of changes costs
+// one registry/plist round trip. All the dirty keys of a flush go to QSettings in one sync(), the keys of a failed
+// sync stay dirty and are retried. flush() must be called at shutdown (done in main()).
+// The commit is crash safe per file: the ini/plist files are rewritten through a temporary file and a rename
+// (QSettings::setAtomicSyncRequired), a registry value is replaced atomically by Windows.
+// Thread safe, the keys written here must not be accessed through QSettings directly.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+public:
+    static SettingsStore &instance()
+    {
+        static SettingsStore s;
+        return s;
+    }
+
+    bool contains(const QString &key);
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant());
+    void setValue(const QString &key, const QVariant &value);
+    void remove(const QString &key);
+
+    // false if QSettings failed to write, the keys stay dirty
+    bool flush();
+
+    static constexpr int FLUSH_DELAY_MS = 2000;
+
+private slots:
+    void onFlushTimer();
+
+private:
+    SettingsStore();
+
+    struct Entry
+    {
+        bool isExists;
+        QVariant value;
+    };
+
+    QMutex mutex_;
+    QMutex flushMutex_;             // one flush at a time
+    QHash<QString, Entry> cache_;
+    QHash<QString, QSet<QString>> dirtyKeys_;   // namespace -> keys
+    QTimer *flushTimer_;
+    bool isFlushScheduled_;
+
+    // mutex_ must be locked
+    const Entry &entry(const QString &key);
+    void markDirty(const QString &key);
+    void scheduleFlush();
+
+    static QString keyNamespace(const QString &key);
+};
+
+#endif // SETTINGSSTORE_H
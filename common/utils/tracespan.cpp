@@ -0,0 +1,28 @@
+#include "tracespan.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include "logger.h"
+
+TraceSpan::TraceSpan(const char *category, const char *name) : category_(category), name_(name), startUs_(nowUs())
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    record(category_, name_, startUs_);
+}
+
+qint64 TraceSpan::nowUs()
+{
+    // the wall clock has the milliseconds precision only, so the monotonic clock is added to the time of the first call
+    static const qint64 baseUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    static const QElapsedTimer elapsedTimer = []() { QElapsedTimer timer; timer.start(); return timer; }();
+    return baseUs + elapsedTimer.nsecsElapsed() / 1000;
+}
+
+void TraceSpan::record(const char *category, const char *name, qint64 startUs)
+{
+    qCDebug(LOG_TRACE).noquote() << QString("trace_span %1 %2 %3 %4 %5").arg(category).arg(startUs).arg(nowUs() - startUs)
+                                    .arg(reinterpret_cast<quintptr>(QThread::currentThreadId())).arg(name);
+}
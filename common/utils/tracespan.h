@@ -0,0 +1,27 @@
+#ifndef TRACESPAN_H
+#define TRACESPAN_H
+
+#include <QtGlobal>
+
+// The spans of the startup timeline (GUI and engine). Each span is written to the log as one line
+// "trace_span <category> <start, us since the epoch> <duration, us> <thread id> <name>",
+// MergeLog::mergeTraces() collects these lines from the GUI and the service logs to a Chrome tracing JSON.
+// TraceSpan measures its scope, record() is for the spans which end in another function (a callback).
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name);
+    ~TraceSpan();
+
+    static qint64 nowUs();
+    static void record(const char *category, const char *name, qint64 startUs);
+
+private:
+    const char *category_;
+    const char *name_;
+    qint64 startUs_;
+
+    Q_DISABLE_COPY(TraceSpan)
+};
+
+#endif // TRACESPAN_H
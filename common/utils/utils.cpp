@@ -3,14 +3,21 @@
 #include <time.h>
 #include <thread>
 #include <limits>
+#include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QEventLoop>
+#include <QTimer>
 #include "logger.h"
 
 #ifdef Q_OS_WIN
     #include <Windows.h>
+    #include <psapi.h>
     #include "winutils.h"
 #elif defined Q_OS_MAC
     #include "macutils.h"
+    #include <mach/mach.h>
     #include "network_utils/network_utils_mac.h"
     #include <math.h>
     #include <unistd.h>
@@ -306,11 +313,7 @@ bool Utils::pingWithMtu(const QString &url, int mtu)
 #elif defined Q_OS_MAC
     return NetworkUtils_mac::pingWithMtu(url, mtu);
 #elif defined Q_OS_LINUX
-    //todo linux
-    Q_ASSERT(false);
-    Q_UNUSED(url);
-    Q_UNUSED(mtu);
-    return true;
+    return LinuxUtils::pingWithMtu(url, mtu);
 #endif
 }
 
@@ -334,6 +337,37 @@ unsigned long Utils::getCurrentPid()
 #endif
 }
 
+quint64 Utils::getCurrentProcessMemoryUsage()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    {
+        return pmc.WorkingSetSize;
+    }
+#elif defined Q_OS_MAC
+    // the footprint is what the Activity Monitor shows
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    {
+        return info.phys_footprint;
+    }
+#elif defined Q_OS_LINUX
+    // the second field is the resident set in pages
+    QFile file("/proc/self/statm");
+    if (file.open(QIODevice::ReadOnly))
+    {
+        const QList<QByteArray> fields = file.readAll().split(' ');
+        if (fields.count() > 1)
+        {
+            return fields[1].toULongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+
 const QString Utils::filenameEscapeSpaces(const QString &filename)
 {
     QString result("");
@@ -414,6 +448,25 @@ bool Utils::removeDirectory(const QString dir)
     return d.removeRecursively();
 }
 
+bool Utils::waitInEventLoop(const std::function<bool()> &isFinished, int timeoutMs, int checkPeriodMs)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    // wakes up the wait, nothing else to do
+    QTimer checkTimer;
+    checkTimer.start(checkPeriodMs);
+
+    while (!isFinished())
+    {
+        if (elapsedTimer.elapsed() >= timeoutMs)
+        {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
 bool Utils::accessibilityPermissions()
 {
 #ifdef Q_OS_MAC
@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QStringList>
+#include <functional>
 #include "protobuf_includes.h"
 
 #define SAFE_DELETE(x) if (x) { delete x; x = nullptr; }
@@ -30,6 +31,8 @@ namespace Utils {
     bool accessibilityPermissions();
 
     unsigned long getCurrentPid();
+    // the resident memory of the process in bytes (the working set on Windows, the footprint on Mac), 0 on a failure
+    quint64 getCurrentProcessMemoryUsage();
     bool isGuiAlreadyRunning();
 
     QString generateRandomMacAddress();
@@ -51,6 +54,10 @@ namespace Utils {
     bool copyDirectoryRecursive(QString fromDir, QString toDir);
     bool removeDirectory(const QString dir);
 
+    // processes the events of the thread until isFinished() or the timeout, sleeps while there are no events,
+    // isFinished() is checked at least every checkPeriodMs for the states changed by the other threads
+    bool waitInEventLoop(const std::function<bool()> &isFinished, int timeoutMs, int checkPeriodMs = 10);
+
 #if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
     QString execCmd(const QString &cmd);
 #endif
@@ -11,13 +11,10 @@
 #elif defined Q_OS_LINUX
 #endif
 
-#ifdef Q_OS_WIN
-Q_GUI_EXPORT QPixmap qt_pixmapFromWinHICON(HICON icon);
-#endif
-
-QPixmap WidgetUtils::extractProgramIcon(QString filePath)
+QImage WidgetUtils::extractProgramIcon(const QString &filePath, int size)
 {
 #ifdef Q_OS_WIN
+    Q_UNUSED(size);
     if (filePath.contains("WindowsApps"))
     {
         return WidgetUtils_win::extractWindowsAppProgramIcon(filePath);
@@ -27,12 +24,13 @@ QPixmap WidgetUtils::extractProgramIcon(QString filePath)
         return WidgetUtils_win::extractProgramIcon(filePath);
     }
 #elif defined Q_OS_MAC
-    return WidgetUtils_mac::extractProgramIcon(filePath);
+    return WidgetUtils_mac::extractProgramIcon(filePath, size);
 #elif defined Q_OS_LINUX
     //todo linux
     Q_ASSERT(false);
     Q_UNUSED(filePath);
-    return QPixmap();
+    Q_UNUSED(size);
+    return QImage();
 #endif 
 }
 
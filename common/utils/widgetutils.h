@@ -1,12 +1,15 @@
 #ifndef WIDGETUTILS_H
 #define WIDGETUTILS_H
 
+#include <QImage>
 #include <QPixmap>
 #include <QScreen>
 
 namespace WidgetUtils {
 
-QPixmap extractProgramIcon(QString filePath);
+// safe to call from any thread (no QPixmap/QIcon), size is the side in device pixels where the platform
+// lets choose it (Mac), the Windows icons are of the system size
+QImage extractProgramIcon(const QString &filePath, int size);
 
 QScreen *slightlySaferScreenAt(QPoint pt);
 
@@ -1,12 +1,12 @@
 #ifndef WIDGETUTILS_MAC_H
 #define WIDGETUTILS_MAC_H
 
-#include <QPixmap>
+#include <QImage>
 #include <QWidget>
 
 namespace WidgetUtils_mac {
 
-QPixmap extractProgramIcon(const QString &filePath);
+QImage extractProgramIcon(const QString &filePath, int size);
 void allowMinimizeForFramelessWindow(QWidget *window);
 void allowMoveBetweenSpacesForWindow(QWidget *window, bool allow);
 void setNeedsDisplayForWindow(QWidget *window);
@@ -1,20 +1,36 @@
 #import <Cocoa/Cocoa.h>
 #include <AppKit/AppKit.h>
 
-#include <QIcon>
 #include "widgetutils_mac.h"
 #include "macutils.h"
-#include "dpiscalemanager.h"
 
 #include <QDebug>
 
-QPixmap WidgetUtils_mac::extractProgramIcon(const QString &filePath)
+QImage WidgetUtils_mac::extractProgramIcon(const QString &filePath, int size)
 {
-    // TODO: QIcon constructor sometimes throws this WARNING into log:
-    // "libpng warning: iCCP: known incorrect sRGB profile"
-    QIcon icon(filePath);
-    int size = 18 * G_SCALE;
-    return QPixmap(icon.pixmap(QSize(size, size)));
+    // drawn with CoreGraphics into the buffer of the QImage, QIcon and QPixmap are for the GUI thread only
+    @autoreleasepool {
+        NSImage *icon = [[NSWorkspace sharedWorkspace] iconForFile:filePath.toNSString()];
+        NSRect rect = NSMakeRect(0, 0, size, size);
+        CGImageRef cgImage = [icon CGImageForProposedRect:&rect context:nil hints:nil];
+        if (!cgImage || size <= 0)
+        {
+            return QImage();
+        }
+        QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+        CGContextRef context = CGBitmapContextCreate(image.bits(), size, size, 8, image.bytesPerLine(), colorSpace,
+                                                     kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host);
+        CGColorSpaceRelease(colorSpace);
+        if (!context)
+        {
+            return QImage();
+        }
+        CGContextDrawImage(context, CGRectMake(0, 0, size, size), cgImage);
+        CGContextRelease(context);
+        return image;
+    }
 }
 
 void WidgetUtils_mac::allowMinimizeForFramelessWindow(QWidget *window)
@@ -7,23 +7,23 @@
 #include <QFileInfo>
 #include <QXmlStreamReader>
 
-Q_GUI_EXPORT QPixmap qt_pixmapFromWinHICON(HICON icon);
+Q_GUI_EXPORT QImage qt_imageFromWinHICON(HICON icon);
 Q_GUI_EXPORT HICON qt_pixmapToWinHICON(const QPixmap &p);
 
-QPixmap WidgetUtils_win::extractProgramIcon(QString filePath)
+QImage WidgetUtils_win::extractProgramIcon(QString filePath)
 {
     HICON icon;
     HINSTANCE instance = NULL;
     icon = ExtractIconA(instance, (LPSTR)filePath.toLocal8Bit().constData(), 0);
 
-    QPixmap p;
+    QImage p;
     if (icon != NULL && (int) icon != 1)
     {
-        p = QPixmap(qt_pixmapFromWinHICON(icon));
+        p = qt_imageFromWinHICON(icon);
     }
     else
     {
-        // qDebug() << "Failed to call qt_pixmapFromWinHICON: " << filePath << "(" << icon << ")";
+        // qDebug() << "Failed to call qt_imageFromWinHICON: " << filePath << "(" << icon << ")";
     }
 
     DestroyIcon(icon);
@@ -31,7 +31,7 @@ QPixmap WidgetUtils_win::extractProgramIcon(QString filePath)
     return p;
 }
 
-QPixmap WidgetUtils_win::extractWindowsAppProgramIcon(QString filePath)
+QImage WidgetUtils_win::extractWindowsAppProgramIcon(QString filePath)
 {
     // Get Manifest XML filename -- it contains location of logo
     QDir d = QFileInfo(filePath).absoluteDir();
@@ -103,24 +103,24 @@ QPixmap WidgetUtils_win::extractWindowsAppProgramIcon(QString filePath)
         }
     }
 
-    QPixmap logoPixmap;
+    QImage logoImage;
     if (!logoFilePathScaled.isEmpty())
-        logoPixmap = QPixmap(logoFilePathScaled);
+        logoImage = QImage(logoFilePathScaled);
     else if (!logoFilePath.isEmpty())
-        logoPixmap = QPixmap(logoFilePath);
+        logoImage = QImage(logoFilePath);
 
-    if (!logoPixmap.isNull()) {
+    if (!logoImage.isNull()) {
         // Fill transparent background with a WindowsApps background color.
         // This should also be parsed from the manifest, but apparently it is always the same.
-        QPixmap filledPixmap(logoPixmap.size());
-        filledPixmap.fill(QColor("#0078D4"));
-        QPainter painter(&filledPixmap);
-        painter.drawPixmap(0, 0, logoPixmap);
+        QImage filledImage(logoImage.size(), QImage::Format_ARGB32_Premultiplied);
+        filledImage.fill(QColor("#0078D4"));
+        QPainter painter(&filledImage);
+        painter.drawImage(0, 0, logoImage);
         painter.end();
-        logoPixmap = filledPixmap;
+        logoImage = filledImage;
     }
 
-    return logoPixmap;
+    return logoImage;
 }
 
 namespace
@@ -1,12 +1,13 @@
 #ifndef WIDGETUTILS_WIN_H
 #define WIDGETUTILS_WIN_H
 
+#include <QImage>
 #include <QPixmap>
 
 namespace WidgetUtils_win {
 
-QPixmap extractProgramIcon(QString filePath);
-QPixmap extractWindowsAppProgramIcon(QString filePath);
+QImage extractProgramIcon(QString filePath);
+QImage extractWindowsAppProgramIcon(QString filePath);
 void updateSystemTrayIcon(const QPixmap &pixmap, QString tooltip);
 void fixSystemTrayIconDblClick();
 
@@ -8,16 +8,21 @@
 
 #include <QTimer>
 
-BackendCommander::BackendCommander(CliCommand cmd, const QString &location) : QObject()
+BackendCommander::BackendCommander(CliCommand cmd, const QString &location, bool isWait) : QObject()
     , ipcState_(IPC_INIT_STATE)
     , connection_(nullptr)
     , command_(cmd)
     , locationStr_(location)
+    , isWait_(isWait)
     , bCommandSent_(false)
     , bLogginInMessageShown_(false)
 {
     unsigned long cliPid = Utils::getCurrentPid();
     qCDebug(LOG_BASIC) << "CLI pid: " << cliPid;
+
+    loginTimer_.setSingleShot(true);
+    loginTimer_.setInterval(MAX_LOGIN_TIME_MS);
+    connect(&loginTimer_, &QTimer::timeout, this, &BackendCommander::onLoginTimeout);
  }
 
 BackendCommander::~BackendCommander()
@@ -62,33 +67,7 @@ void BackendCommander::onConnectionNewCommand(IPC::Command *command, IPC::IConne
     else if (bCommandSent_ && command->getStringId() == CliIpc::ConnectStateChanged::descriptor()->full_name())
     {
         IPC::ProtobufCommand<CliIpc::ConnectStateChanged> *cmd = static_cast<IPC::ProtobufCommand<CliIpc::ConnectStateChanged> *>(command);
-
-
-        if (command_ >= CLI_COMMAND_CONNECT && command_ <= CLI_COMMAND_DISCONNECT)
-        {
-            if (cmd->getProtoObj().connect_state().connect_state_type() == ProtoTypes::CONNECTED)
-            {
-                if (cmd->getProtoObj().connect_state().has_location())
-                {
-                    LocationID currentLocation = LocationID::createFromProtoBuf(cmd->getProtoObj().connect_state().location());
-
-                    QString locationConnectedTo;
-                    if (currentLocation.isBestLocation())
-                    {
-                        locationConnectedTo = tr("Best Location");
-                    }
-                    else
-                    {
-                        locationConnectedTo = QString::fromStdString(cmd->getProtoObj().connect_state().location().city());
-                    }
-                    emit finished(tr("Connected to ") + locationConnectedTo);
-                }
-            }
-            else if (cmd->getProtoObj().connect_state().connect_state_type() == ProtoTypes::DISCONNECTED)
-            {
-                emit finished(tr("Disconnected"));
-            }
-        }
+        handleConnectState(cmd->getProtoObj().connect_state());
     }
     else if (bCommandSent_ && command->getStringId() == CliIpc::AlreadyDisconnected::descriptor()->full_name())
     {
@@ -97,32 +76,55 @@ void BackendCommander::onConnectionNewCommand(IPC::Command *command, IPC::IConne
     else if (command->getStringId() == CliIpc::State::descriptor()->full_name())
     {
         IPC::ProtobufCommand<CliIpc::State> *cmd = static_cast<IPC::ProtobufCommand<CliIpc::State> *>(command);
-        if (cmd->getProtoObj().is_logged_in())
-        {
-            sendCommand();
-        }
-        else
+        if (command_ == CLI_COMMAND_STATUS)
         {
-            if (loggedInTimer_.isValid() && loggedInTimer_.elapsed() > MAX_LOGIN_TIME_MS)
-            {
-                loggedInTimer_.invalidate();
-                emit finished("Aborting: Gui did not login in time");
-            }
-            else
+            // answered from the State at once, the login isn't needed
+            if (!bCommandSent_)
             {
-                if (!bLogginInMessageShown_)
+                bCommandSent_ = true;
+                QString msg = connectStateString(cmd->getProtoObj().connect_state());
+                msg += "\n" + (cmd->getProtoObj().is_firewall_enabled() ? tr("Firewall is ON") : tr("Firewall is OFF"));
+                if (!cmd->getProtoObj().is_logged_in())
+                {
+                    msg += "\n" + tr("GUI is not logged in");
+                }
+                if (isWait_)
+                {
+                    emit report(msg);
+                }
+                else
                 {
-                    bLogginInMessageShown_ = true;
-                    emit report("GUI is not logged in. Waiting for the login...");
+                    emit finished(msg);
                 }
-                QTimer::singleShot(100, this, &BackendCommander::sendStateCommand);
             }
         }
+        else if (cmd->getProtoObj().is_logged_in())
+        {
+            loginTimer_.stop();
+            if (!bCommandSent_)
+            {
+                sendCommand();
+            }
+        }
+        else if (!bCommandSent_ && !bLogginInMessageShown_)
+        {
+            // the GUI sends the State again when the login finishes
+            bLogginInMessageShown_ = true;
+            emit report("GUI is not logged in. Waiting for the login...");
+            loginTimer_.start();
+        }
     }
     else if (command->getStringId() == CliIpc::FirewallStateChanged::descriptor()->full_name())
     {
         IPC::ProtobufCommand<CliIpc::FirewallStateChanged> *cmd = static_cast<IPC::ProtobufCommand<CliIpc::FirewallStateChanged> *>(command);
-        if (cmd->getProtoObj().is_firewall_enabled())
+        if (command_ == CLI_COMMAND_STATUS)
+        {
+            if (bCommandSent_)
+            {
+                emit report(cmd->getProtoObj().is_firewall_enabled() ? tr("Firewall is ON") : tr("Firewall is OFF"));
+            }
+        }
+        else if (cmd->getProtoObj().is_firewall_enabled())
         {
             if (cmd->getProtoObj().is_firewall_always_on())
             {
@@ -146,7 +148,6 @@ void BackendCommander::onConnectionStateChanged(int state, IPC::IConnection * /*
     {
         qCDebug(LOG_BASIC) << "Connected to GUI server";
         ipcState_ = IPC_CONNECTED;
-        loggedInTimer_.start();
         sendStateCommand();
     }
     else if (state == IPC::CONNECTION_DISCONNECTED)
@@ -218,3 +219,69 @@ void BackendCommander::sendStateCommand()
     connection_->sendCommand(cmd);
 }
 
+void BackendCommander::onLoginTimeout()
+{
+    emit finished("Aborting: Gui did not login in time");
+}
+
+void BackendCommander::handleConnectState(const ProtoTypes::ConnectState &connectState)
+{
+    if (command_ == CLI_COMMAND_STATUS)
+    {
+        // until the CLI is stopped
+        emit report(connectStateString(connectState));
+        return;
+    }
+    if (command_ < CLI_COMMAND_CONNECT || command_ > CLI_COMMAND_DISCONNECT)
+    {
+        return;
+    }
+
+    if (connectState.connect_state_type() == ProtoTypes::CONNECTED)
+    {
+        if (connectState.has_location())
+        {
+            emit finished(connectStateString(connectState));
+        }
+    }
+    else if (connectState.connect_state_type() == ProtoTypes::DISCONNECTED)
+    {
+        emit finished(isWait_ ? connectStateString(connectState) : tr("Disconnected"));
+    }
+    else if (isWait_)
+    {
+        emit report(connectStateString(connectState));
+    }
+}
+
+QString BackendCommander::connectStateString(const ProtoTypes::ConnectState &connectState)
+{
+    QString locationStr;
+    if (connectState.has_location())
+    {
+        if (LocationID::createFromProtoBuf(connectState.location()).isBestLocation())
+        {
+            locationStr = tr("Best Location");
+        }
+        else
+        {
+            locationStr = QString::fromStdString(connectState.location().city());
+        }
+    }
+
+    switch (connectState.connect_state_type())
+    {
+        case ProtoTypes::CONNECTED:
+            return tr("Connected to ") + locationStr;
+        case ProtoTypes::CONNECTING:
+            return locationStr.isEmpty() ? tr("Connecting...") : tr("Connecting to ") + locationStr;
+        case ProtoTypes::DISCONNECTING:
+            return tr("Disconnecting...");
+        default:
+            if (connectState.disconnect_reason() == ProtoTypes::DISCONNECTED_WITH_ERROR)
+            {
+                return tr("Disconnected with error: ") + QString::fromStdString(ProtoTypes::ConnectError_Name(connectState.connect_error()));
+            }
+            return tr("Disconnected");
+    }
+}
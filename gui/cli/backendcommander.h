@@ -3,15 +3,17 @@
 
 #include <QElapsedTimer>
 #include <QObject>
+#include <QTimer>
 #include "cliapplication.h"
 #include "ipc/iconnection.h"
 #include "ipc/command.h"
+#include "utils/protobuf_includes.h"
 
 class BackendCommander : public QObject
 {
     Q_OBJECT
 public:
-    BackendCommander(CliCommand cmd, const QString &location);
+    BackendCommander(CliCommand cmd, const QString &location, bool isWait);
     ~BackendCommander();
 
     void initAndSend();
@@ -23,6 +25,7 @@ signals:
 private slots:
     void onConnectionNewCommand(IPC::Command *command, IPC::IConnection *connection);
     void onConnectionStateChanged(int state, IPC::IConnection *connection);
+    void onLoginTimeout();
 
 private:
     enum IPC_STATE { IPC_INIT_STATE, IPC_CONNECTING, IPC_CONNECTED };
@@ -32,14 +35,17 @@ private:
     static constexpr int MAX_LOGIN_TIME_MS = 10000;   // 10 sec - maximum waiting time for login in the GUI
     IPC::IConnection *connection_;
     QElapsedTimer connectingTimer_;
-    QElapsedTimer loggedInTimer_;
+    QTimer loginTimer_;         // the GUI pushes the State on login, no polling
     CliCommand command_;
     QString locationStr_;
+    bool isWait_;
     bool bCommandSent_;
     bool bLogginInMessageShown_;
 
     void sendCommand();
     void sendStateCommand();
+    void handleConnectState(const ProtoTypes::ConnectState &connectState);
+    static QString connectStateString(const ProtoTypes::ConnectState &connectState);
 };
 
 #endif // BACKENDCOMMANDER_H
@@ -101,6 +101,7 @@ linux {
 SOURCES += \
         ../../common/utils/ipvalidation.cpp \
         $$COMMON_PATH/ipc/commandfactory.cpp \
+        $$COMMON_PATH/ipc/commandstats.cpp \
         $$COMMON_PATH/ipc/connection.cpp \
         $$COMMON_PATH/ipc/generated_proto/clientcommands.pb.cc \
         $$COMMON_PATH/ipc/generated_proto/servercommands.pb.cc \
@@ -130,6 +131,7 @@ HEADERS += \
     ../../common/utils/ipvalidation.h \
     $$COMMON_PATH/ipc/command.h \
     $$COMMON_PATH/ipc/commandfactory.h \
+    $$COMMON_PATH/ipc/commandstats.h \
     $$COMMON_PATH/ipc/connection.h \
     $$COMMON_PATH/ipc/generated_proto/clientcommands.pb.h \
     $$COMMON_PATH/ipc/generated_proto/servercommands.pb.h \
@@ -143,6 +145,7 @@ HEADERS += \
     $$COMMON_PATH/utils/extraconfig.h \
     $$COMMON_PATH/utils/languagesutil.h \
     $$COMMON_PATH/utils/logger.h \
+    $$COMMON_PATH/utils/logringbuffer.h \
     $$COMMON_PATH/utils/utils.h \
     $$COMMON_PATH/utils/hardcodedsettings.h \
     $$COMMON_PATH/utils/simplecrypt.h \
@@ -150,6 +153,7 @@ HEADERS += \
     $$COMMON_PATH/version/windscribe_version.h \
     $$COMMON_PATH/utils/executable_signature/executable_signature.h \
     $$COMMON_PATH/utils/clean_sensitive_info.h \
+    $$COMMON_PATH/utils/multipatternmatcher.h \
     backendcommander.h \
     cliapplication.h
 
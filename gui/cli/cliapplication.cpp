@@ -4,6 +4,7 @@
 
 CliApplication::CliApplication(int &argc, char **argv) : QCoreApplication (argc, argv)
     ,locationStr_("")
+    ,isWait_(false)
 {
 
 }
@@ -13,6 +14,7 @@ CliCommand CliApplication::cliCommand()
     CliCommand command = CLI_COMMAND_NONE;
 
     QStringList args = arguments();
+    isWait_ = args.removeAll("--wait") > 0;
 
     if (args.length() > 1)
     {
@@ -65,6 +67,10 @@ CliCommand CliApplication::cliCommand()
         {
             command = CLI_COMMAND_LOCATIONS;
         }
+        else if (arg1 == "status")
+        {
+            command = CLI_COMMAND_STATUS;
+        }
     }
 
     return command;
@@ -74,3 +80,8 @@ const QString &CliApplication::location()
 {
     return locationStr_;
 }
+
+bool CliApplication::isWait() const
+{
+    return isWait_;
+}
@@ -7,7 +7,7 @@ enum CliCommand { CLI_COMMAND_NONE, CLI_COMMAND_HELP ,
                   CLI_COMMAND_CONNECT, CLI_COMMAND_CONNECT_BEST, CLI_COMMAND_CONNECT_LOCATION,
                   CLI_COMMAND_DISCONNECT,
                   CLI_COMMAND_FIREWALL_ON, CLI_COMMAND_FIREWALL_OFF,
-                  CLI_COMMAND_LOCATIONS };
+                  CLI_COMMAND_LOCATIONS, CLI_COMMAND_STATUS };
 
 class CliApplication : public QCoreApplication
 {
@@ -17,9 +17,12 @@ public:
 
     CliCommand cliCommand();
     const QString &location();
+    // --wait: report every connect state change until the command is done, "status" keeps reporting them
+    bool isWait() const;
 
 private:
     QString locationStr_;
+    bool isWait_;
 };
 
 #endif // CLIAPPLICATION_H
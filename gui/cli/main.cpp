@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QDateTime>
+#include <QScopeGuard>
 #include <iostream>
 #include "backendcommander.h"
 #include "cliapplication.h"
@@ -37,6 +38,8 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName("Windscribe");
 
     Logger::instance().install("cli", false, false);
+    // on any return from main(), not in the static destructor of the logger
+    auto stopLogger = qScopeGuard([] { Logger::instance().stop(); });
 
     qCDebug(LOG_BASIC) << "CLI start time:" << QDateTime::currentDateTime().toString();
     qCDebug(LOG_BASIC) << "OS Version:" << Utils::getOSVersion();
@@ -62,10 +65,13 @@ int main(int argc, char *argv[])
         std::cout << "disconnect                - Disconnects from current datacenter              " << std::endl;
         std::cout << "firewall on|off           - Turn firewall ON/OFF                     " << std::endl;
         std::cout << "locations                 - View a list of available locations" << std::endl;
+        std::cout << "status                    - Shows the connection and firewall state" << std::endl;
+        std::cout << std::endl;
+        std::cout << "--wait                    - Reports every connection state change while waiting; with status, keeps reporting them" << std::endl;
         return 0;
     }
 
-    BackendCommander *backendCommander = new BackendCommander(a.cliCommand(), a.location());
+    BackendCommander *backendCommander = new BackendCommander(a.cliCommand(), a.location(), a.isWait());
 
     QObject::connect(backendCommander, &BackendCommander::finished, [&](const QString &msg) {
         logAndCout(msg);
@@ -32,7 +32,12 @@
             bundlePath = [bundlePath stringByDeletingLastPathComponent];
         }
         
-        [workspace launchApplication:bundlePath];
+        // the client starts hidden, with the tray icon only, and prepares itself at a lower priority
+        NSDictionary *configuration = @{ NSWorkspaceLaunchConfigurationArguments: @[@"-warm_start"] };
+        [workspace launchApplicationAtURL:[NSURL fileURLWithPath:bundlePath]
+                                  options:NSWorkspaceLaunchDefault
+                            configuration:configuration
+                                    error:nil];
     }
 }
 
@@ -17,7 +17,14 @@ int main()
     PathAddBackslash(szPath);
     wcscat(szPath, L"Windscribe.exe");
 
-    if (CreateProcess(szPath, NULL, NULL, NULL, FALSE, NULL, NULL, NULL, &cif, &pi))
+    // the client starts hidden, with the tray icon only, and prepares itself at a lower priority
+    // (it lowers only its GUI thread, the priority class is inherited by the tunnel processes)
+    WCHAR szCmdLine[MAX_PATH + 32];
+    wcscpy(szCmdLine, L"\"");
+    wcscat(szCmdLine, szPath);
+    wcscat(szCmdLine, L"\" -warm_start");
+
+    if (CreateProcess(szPath, szCmdLine, NULL, NULL, FALSE, NULL, NULL, NULL, &cif, &pi))
     {
         CloseHandle(pi.hThread);
         CloseHandle(pi.hProcess);
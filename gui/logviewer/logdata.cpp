@@ -2,6 +2,7 @@
 
 #include <QFile>
 #include <QTextStream>
+#include <iterator>
 
 
 namespace
@@ -21,10 +22,19 @@ int getLogDataEntryStringSize(const LogDataEntry &entry)
 }
 }  // namespace
 
-LogData::LogData() : timestampCounter_(0)
+LogData::LogData() : timestampCounter_(0), isAppendOnlyUpdate_(false), appendedAfterKey_(0)
 {
 }
 
+bool LogData::getAppendedData(LogDataStorage::const_iterator *begin) const
+{
+    Q_ASSERT(begin);
+    if (!isAppendOnlyUpdate_)
+        return false;
+    *begin = data_.upperBound(appendedAfterKey_);
+    return true;
+}
+
 QPair<int, int> LogData::getDataSizeForType(LogDataType type) const
 {
     Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
@@ -66,6 +76,7 @@ void LogData::clearDataByLogType(LogDataType type)
 {
     Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
     bool updated = false;
+    isAppendOnlyUpdate_ = false;
     if (type == LOG_TYPE_MIXED) {
         typeInfo_.clear();
         data_.clear();
@@ -89,6 +100,7 @@ void LogData::clearDataByLogType(LogDataType type)
 void LogData::clearDataByLogIndex(quint32 index)
 {
     bool updated = false;
+    isAppendOnlyUpdate_ = false;
     typeInfo_.clear();
     LogDataMutableIterator it(data_);
     while (it.hasNext()) {
@@ -130,10 +142,18 @@ void LogData::addLines(QStringList lines, LogDataType type, quint32 index,
     default:
         break;
     }
+    const bool wasEmpty = data_.isEmpty();
+    const int prevCount = data_.size();
+    if (!wasEmpty)
+        appendedAfterKey_ = data_.lastKey();
     for (auto &line : qAsConst(lines)) {
         processLine(line, type, index, kCurrentYearOffset,
             (rangeCheck != LogRangeCheckType::NONE) ? range : nullptr);
     }
+    // All the new lines are after the old ones, if the count of lines after the old last key is the
+    // count of the added lines.
+    isAppendOnlyUpdate_ = !wasEmpty &&
+        std::distance(data_.upperBound(appendedAfterKey_), data_.end()) == data_.size() - prevCount;
     emit dataUpdated();
 }
 
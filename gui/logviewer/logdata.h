@@ -33,6 +33,9 @@ public:
     bool hasType(LogDataType type) const { return typeInfo_.contains(type); }
     QPair<int, int> getDataSizeForType(LogDataType type) const;
     const LogDataStorage &data() const { return data_; }
+    // True if the last update only added lines after the previously last one (e.g. tailing a log),
+    // |begin| is set to the first added line then.
+    bool getAppendedData(LogDataStorage::const_iterator *begin) const;
     bool save(const QString &filename) const;
 
 signals:
@@ -51,6 +54,8 @@ private:
     LogDataStorage data_;
     QDateTime lastDateTime_;
     qint32 timestampCounter_;
+    bool isAppendOnlyUpdate_;
+    quint64 appendedAfterKey_;
 };
 
 #endif  // LOGDATA_H
@@ -1,9 +1,11 @@
 #include "logwatcher.h"
 
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
 #include <QMutexLocker>
 #include <QTextStream>
+#include <cstring>
 
 
 LogWatcher::LogWatcher() : log_index_(0), is_watch_done_(false)
@@ -34,6 +36,8 @@ bool LogWatcher::add(const QString &filename, LogDataType type, LogRangeCheckTyp
         it->datasize = 0;
         it->position = 0;
         it->rangecheck = rangeCheck;
+        it->head.clear();
+        it->partialLineSince = 0;
     }
     return true;
 }
@@ -65,21 +69,26 @@ void LogWatcher::run()
 {
     QStringList currentLogFiles;
     QList<LogFileInfo> currentLogInfo;
+    QList<bool> currentFlushPartialLine;
 
     while (!is_watch_done_) {
-        // Pick a modified log to process.
+        // Pick a modified log to process, or a log with a stale unterminated last line.
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
         mutex_.lock();
         for (auto it = logs_.begin(); it != logs_.end(); ++it) {
             const auto datasize = QFileInfo(it.key()).size();
-            if (datasize != it->datasize) {
+            const bool flushPartialLine = it->partialLineSince != 0
+                && now - it->partialLineSince >= kPartialLineTimeoutMs;
+            if (datasize != it->datasize || flushPartialLine) {
                 currentLogFiles.append(it.key());
                 currentLogInfo.append(it.value());
+                currentFlushPartialLine.append(flushPartialLine);
             }
         }
         mutex_.unlock();
         if (!currentLogFiles.isEmpty()) {
             for (int i = 0; i < currentLogFiles.size(); ++i)
-                process(currentLogFiles[i], &currentLogInfo[i]);
+                process(currentLogFiles[i], &currentLogInfo[i], currentFlushPartialLine[i]);
             // Update log info.
             mutex_.lock();
             for (int i = 0; i < currentLogFiles.size(); ++i) {
@@ -87,11 +96,14 @@ void LogWatcher::run()
                 if (it != logs_.end()) {
                     it->position = currentLogInfo[i].position;
                     it->datasize = currentLogInfo[i].datasize;
+                    it->head = currentLogInfo[i].head;
+                    it->partialLineSince = currentLogInfo[i].partialLineSince;
                 }
             }
             mutex_.unlock();
             currentLogFiles.clear();
             currentLogInfo.clear();
+            currentFlushPartialLine.clear();
         } else {
             // Nothing updated: yield resources for 50ms.
             QThread::msleep(50);
@@ -99,14 +111,17 @@ void LogWatcher::run()
     }
 }
 
-void LogWatcher::process(const QString &filename, LogFileInfo *info)
+void LogWatcher::process(const QString &filename, LogFileInfo *info, bool flushPartialLine)
 {
     Q_ASSERT(!filename.isEmpty() && info);
     auto rangeCheck = info->rangecheck;
-    QFileInfo fi(filename);
-    const auto current_datasize = fi.size();
-    if (info->datasize > current_datasize) {
+    QFile qf(filename);
+    if (!qf.open(QIODevice::ReadOnly))
+        return;
+    const auto current_datasize = qf.size();
+    if (isRotated(&qf, current_datasize, info)) {
         info->position = 0;
+        info->partialLineSince = 0;
         emit logIndexRemoved(info->index);
     } else {
         if (rangeCheck == LogRangeCheckType::MIN_TO_MAX)
@@ -115,20 +130,63 @@ void LogWatcher::process(const QString &filename, LogFileInfo *info)
     info->datasize = current_datasize;
     if (!current_datasize)
         return;
-    QStringList lines;
-    QFile qf(filename);
-    if (!qf.open(QIODevice::ReadOnly))
+    const qint64 newDataSize = current_datasize - info->position;
+    if (newDataSize <= 0)
         return;
-    QTextStream qts(&qf);
-    qts.seek(info->position);
-    while (!qts.atEnd())
-        lines.append(qts.readLine());
-    info->position = qts.pos();
+    // Map only the new tail of the file and split it into lines in place.
+    uchar *data = qf.map(info->position, newDataSize);
+    if (!data)
+        return;
+    QStringList lines;
+    const char *begin = reinterpret_cast<const char *>(data);
+    const char *end = begin + newDataSize;
+    // The unterminated last line is left for the next read, unless it's stale.
+    const char *lastNewline = begin + newDataSize;
+    while (lastNewline > begin && lastNewline[-1] != '\n')
+        --lastNewline;
+    if (lastNewline < end) {
+        if (flushPartialLine) {
+            info->partialLineSince = 0;
+        } else {
+            if (info->partialLineSince == 0)
+                info->partialLineSince = QDateTime::currentMSecsSinceEpoch();
+            end = lastNewline;
+        }
+    } else {
+        info->partialLineSince = 0;
+    }
+    const char *lineStart = begin;
+    while (lineStart < end) {
+        const char *lineEnd = static_cast<const char *>(memchr(lineStart, '\n', end - lineStart));
+        const char *next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd)
+            lineEnd = end;
+        if (lineEnd > lineStart && lineEnd[-1] == '\r')
+            --lineEnd;
+        // the locale codec, the same as QTextStream
+        lines.append(QString::fromLocal8Bit(lineStart, static_cast<int>(lineEnd - lineStart)));
+        lineStart = next;
+    }
+    info->position += end - begin;
+    qf.unmap(data);
     qf.close();
     if (!lines.empty())
         emit logLinesReady(lines, info->type, info->index, rangeCheck);
 }
 
+bool LogWatcher::isRotated(QFile *file, qint64 datasize, LogFileInfo *info) const
+{
+    // Compare the beginning known so far, it's longer while the file is small.
+    const QByteArray head = file->read(kHeadSize);
+    file->seek(0);
+    const int common = qMin(head.size(), info->head.size());
+    const bool rotated = info->datasize > datasize
+        || (info->position > 0 && head.left(common) != info->head.left(common));
+    if (rotated || head.size() > info->head.size())
+        info->head = head;
+    return rotated;
+}
+
 // static
 LogDataType LogWatcher::detectLogType(const QString &filename)
 {
@@ -2,6 +2,7 @@
 #define LOGWATCHER_H
 
 #include <memory>
+#include <QByteArray>
 #include <QMap>
 #include <QMutex>
 #include <QThread>
@@ -31,22 +32,34 @@ signals:
     void logIndexRemoved(quint32 index);
 
 private:
+    // The file is read from |position| (the end of the last complete line) to its end. A rotated
+    // file (rewritten or replaced, e.g. by Logger::copyToPrevLog on restart) is detected by a
+    // smaller size or by another beginning of the file, and is read again from the start.
     struct LogFileInfo {
         LogFileInfo() : position(0), datasize(-1), index(0), type(LOG_TYPE_UNKNOWN),
-                        rangecheck(LogRangeCheckType::NONE) {}
+                        rangecheck(LogRangeCheckType::NONE), partialLineSince(0) {}
         LogFileInfo(LogDataType theType, quint32 theIndex, LogRangeCheckType rangeCheck)
-            : position(0), datasize(-1), index(theIndex), type(theType), rangecheck(rangeCheck) {}
+            : position(0), datasize(-1), index(theIndex), type(theType), rangecheck(rangeCheck),
+              partialLineSince(0) {}
         qint64 position;
         qint64 datasize;
         quint32 index;
         LogDataType type;
         LogRangeCheckType rangecheck;
+        QByteArray head;          // First bytes of the file, to detect the rotation.
+        qint64 partialLineSince;  // When the unterminated last line was seen, 0 if there's none.
     };
     using LogFileMutableIterator = QMutableMapIterator<QString, LogFileInfo>;
     using LogFileStorage = QMultiMap<QString, LogFileInfo>;
 
     void run() override;
-    void process(const QString &filename, LogFileInfo *info);
+    void process(const QString &filename, LogFileInfo *info, bool flushPartialLine);
+    bool isRotated(QFile *file, qint64 datasize, LogFileInfo *info) const;
+
+    // An unterminated last line is kept until the writer completes it, or emitted as it is
+    // after this time (a file which doesn't end with a newline).
+    static constexpr qint64 kPartialLineTimeoutMs = 1000;
+    static constexpr int kHeadSize = 64;
 
     QMutex mutex_;
     LogFileStorage logs_;
@@ -54,7 +54,8 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
                            openFilePath_(QStandardPaths::writableLocation(
                                QStandardPaths::DataLocation)),
                            isFilterCI_(true), isHideUnmatched_(true), textVisibilityMask_(0),
-                           currentFilterMatch_(-1), previousFilterMatch_(-1)
+                           currentFilterMatch_(-1), previousFilterMatch_(-1),
+                           highlightGeneration_(1)
 {
     // Default path for logs.
     openFilePath_.replace(qApp->applicationName(), "Windscribe2");
@@ -132,6 +133,7 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
     timeEdit_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
     timeEdit_->setPalette(window_backround_palette);
     timeEdit_->setAutoFillBackground(true);
+    connect(timeEdit_->verticalScrollBar(), SIGNAL(valueChanged(int)), SLOT(onLogScrolled()));
     QSplitter *splitter = new QSplitter(this);
     for (int i = 0; i < NUM_LOG_TYPES; ++i) {
         textLabel_[i] = new QLabel(tr(kLogTitles[i]) + ":", this);
@@ -377,10 +379,16 @@ void MainWindow::gotoNextMatch()
 void MainWindow::onDataUpdated()
 {
     updatePlaceholderText();
-    updateDisplay();
+    if (!appendToDisplay())
+        updateDisplay();
     updateScroll();
 }
 
+void MainWindow::onLogScrolled()
+{
+    highlightVisibleLines();
+}
+
 LogDataType MainWindow::chooseLogType(const QString &filename)
 {
     // TODO: make a more convenient UI dialog with radio buttons.
@@ -515,22 +523,64 @@ void MainWindow::updateHighlight(bool update_matching_lines_only)
     if (!isHideUnmatched_ && !filterMatches_.isEmpty() && currentFilterMatch_ >= 0)
         currentFilterMatchLine = filterMatches_[currentFilterMatch_];
 
-    setOverrideCursorIfNeeded();
+    if (!update_matching_lines_only) {
+        // The settings changed, all the lines need to be highlighted again when they get visible.
+        ++highlightGeneration_;
+        highlightVisibleLines();
+        return;
+    }
+
     for (int i = 0; i < NUM_LOG_TYPES; ++i) {
         if (!textWidget_[i]->isVisible())
             continue;
         TextHighlighter th(logHightlightMode_, currentFilterMatchLine,
                            kIsMulti ? static_cast<LogDataType>(i) : LOG_TYPE_MIXED);
         QList<int> lineNumbers;
-        if (update_matching_lines_only) {
-            if (previousFilterMatch_ >= 0)
-                lineNumbers.push_back(filterMatches_[previousFilterMatch_]);
-            if (currentFilterMatch_ >= 0)
-                lineNumbers.push_back(filterMatches_[currentFilterMatch_]);
+        if (previousFilterMatch_ >= 0)
+            lineNumbers.push_back(filterMatches_[previousFilterMatch_]);
+        if (currentFilterMatch_ >= 0)
+            lineNumbers.push_back(filterMatches_[currentFilterMatch_]);
+        if (!lineNumbers.isEmpty())
+            th.processDocument(textEdit_[i]->document(), lineNumbers);
+    }
+}
+
+void MainWindow::highlightVisibleLines()
+{
+    const int kMarginLines = 100;
+    const bool kIsMulti = logDisplayMode_ == LogDisplayMode::MULTI_COLUMNS
+        && logData_->numTypes() > 1;
+
+    int currentFilterMatchLine = -1;
+    if (!isHideUnmatched_ && !filterMatches_.isEmpty() && currentFilterMatch_ >= 0)
+        currentFilterMatchLine = filterMatches_[currentFilterMatch_];
+
+    for (int i = 0; i < NUM_LOG_TYPES; ++i) {
+        if (!textWidget_[i]->isVisible())
+            continue;
+        const auto *edit = textEdit_[i];
+        const int blockCount = edit->document()->blockCount();
+        const int firstLine = qMax(0,
+            edit->cursorForPosition(QPoint(0, 0)).blockNumber() - kMarginLines);
+        const int lastLine = qMin(blockCount - 1, edit->cursorForPosition(
+            QPoint(0, edit->viewport()->height() - 1)).blockNumber() + kMarginLines);
+
+        auto &highlighted = highlightedLines_[i];
+        if (highlighted.size() != blockCount)
+            highlighted.resize(blockCount);
+        QList<int> lineNumbers;
+        for (int line = firstLine; line <= lastLine; ++line) {
+            if (highlighted[line] != highlightGeneration_) {
+                highlighted[line] = highlightGeneration_;
+                lineNumbers.push_back(line);
+            }
         }
+        if (lineNumbers.isEmpty())
+            continue;
+        TextHighlighter th(logHightlightMode_, currentFilterMatchLine,
+                           kIsMulti ? static_cast<LogDataType>(i) : LOG_TYPE_MIXED);
         th.processDocument(textEdit_[i]->document(), lineNumbers);
     }
-    restoreOverrideCursor();
 }
 
 void MainWindow::updateDisplay()
@@ -655,6 +705,7 @@ void MainWindow::updateDisplay()
     }
 
     timeEdit_->setPlainText(time_string);
+    ++highlightGeneration_;
 
     for (int i = 0; i < NUM_LOG_TYPES; ++i) {
         const bool is_empty = texts[i].trimmed().isEmpty();
@@ -678,9 +729,9 @@ void MainWindow::updateDisplay()
 
     if (logHightlightMode_) {
         if (textVisibilityMask_ == oldvismask)
-            updateHighlight();
+            highlightVisibleLines();
         else
-            QTimer::singleShot(0, [&]() { updateHighlight(); });
+            QTimer::singleShot(0, [&]() { highlightVisibleLines(); });
     }
 
     if (!filterMatches_.isEmpty())
@@ -688,6 +739,46 @@ void MainWindow::updateDisplay()
     updateMatchLabel();
 }
 
+bool MainWindow::appendToDisplay()
+{
+    // Fast path for tailing the logs: new lines at the end of a single column log without filter
+    // are appended to the documents instead of rebuilding them.
+    const bool kIsMulti = logDisplayMode_ == LogDisplayMode::MULTI_COLUMNS
+        && logData_->numTypes() > 1;
+    LogData::LogDataStorage::const_iterator it;
+    if (kIsMulti || !currentFilter_.isEmpty() || textVisibilityMask_ != 1
+        || !logData_->getAppendedData(&it))
+        return false;
+
+    const char *kTypeMarker[] = { "G", "E", "S" };
+    QString time_string, text;
+    for (; it != logData_->data().constEnd(); ++it) {
+        time_string.append(it->timestamp + "\n");
+        if (it->type == LOG_TYPE_AUX)
+            text.append(QString("%1\n").arg(it->text));
+        else
+            text.append(QString("%1>[%2] %3\n").arg(kTypeMarker[it->type], it->label, it->text));
+    }
+    if (text.isEmpty())
+        return true;
+
+    // The last (empty) line is filled by the appended text, it has to be highlighted again.
+    if (!highlightedLines_[0].isEmpty())
+        highlightedLines_[0].last() = 0;
+
+    const int scrollPos = timeEdit_->verticalScrollBar()->value();
+    QTextCursor timeCursor(timeEdit_->document());
+    timeCursor.movePosition(QTextCursor::End);
+    timeCursor.insertText(time_string);
+    QTextCursor textCursor(textEdit_[0]->document());
+    textCursor.movePosition(QTextCursor::End);
+    textCursor.insertText(text);
+    timeEdit_->verticalScrollBar()->setValue(scrollPos);
+
+    highlightVisibleLines();
+    return true;
+}
+
 void MainWindow::updateScroll()
 {
     if (logAutoScrollMode_) {
@@ -44,6 +44,7 @@ private slots:
     void gotoPrevMatch();
     void gotoNextMatch();
     void onDataUpdated();
+    void onLogScrolled();
 
 private:
     enum class LogDisplayMode { SINGLE_COLUMN, MULTI_COLUMNS };
@@ -57,7 +58,9 @@ private:
     void updatePlaceholderText();
     void updateScale();
     void updateHighlight(bool update_matching_lines_only = false);
+    void highlightVisibleLines();
     void updateDisplay();
+    bool appendToDisplay();
     void updateScroll();
     void updateMatchLabel();
  
@@ -96,6 +99,10 @@ private:
     int currentFilterMatch_;
     int previousFilterMatch_;
     QVector<int> filterMatches_;
+    // Highlighting is applied only to the visible lines (and a margin around them), the lines get
+    // highlighted while scrolling. The generation of the highlight settings each line has got.
+    int highlightGeneration_;
+    QVector<int> highlightedLines_[NUM_LOG_TYPES];
 };
 
 #endif  // MAINWINDOW_H
@@ -30,6 +30,9 @@ Archive::Archive(const wstring &name)
  Total=0;
  Completed=0;
  res=SZ_OK;
+ nextExtractBlock=0;
+ runningExtractThreads=0;
+ isExtractCancelled=false;
 
  #ifdef _WIN32
  LPCWSTR name1 = name.c_str();
@@ -114,6 +117,8 @@ Archive::Archive(const wstring &name)
 
 Archive::~Archive()
 {
+ stopExtraction();
+
  #ifdef _WIN32
  FreeResource(hGlobal); // done with data
  #endif
@@ -621,32 +626,14 @@ u16string Archive::getFileName(const UInt32 &i, UInt16 *&temp, size_t &tempSize)
  return file_name;
 }
 
-void Archive::printPercent(const size_t &processedSize)
+UInt64 Archive::getPercent()
 {
-//Print percent
- char s[32];
- unsigned size;
- char c = '%';
-
- if (Total != 0)
+ //res is set by the extraction threads
+ std::lock_guard<std::mutex> lock(extractMutex);
+ if (Total != 0 && res == SZ_OK)
  {
-  Completed += processedSize;
   val = Completed * max_percent / Total;
  }
- ConvertUInt64ToString(val, s);
- size = static_cast<unsigned>(strlen(s));
- s[size++] = c;
- s[size] = 0;
-
- Print(" (");
- Print(s);
- Print(")");
-
-}
-
-
-UInt64 Archive::getPercent()
-{
  return val;
 }
 
@@ -760,155 +747,300 @@ void Archive::calcTotal(const std::list<std::wstring> &files, const std::list<st
 
 
 
-SRes Archive::extractionFile(const UInt32 &i)
+SRes Archive::startExtraction()
 {
- size_t offset = 0;
- size_t outSizeProcessed = 0;
+ extractBlocks.clear();
+ nextExtractBlock = 0;
+ Completed = 0;
 
- unsigned isDir = SzArEx_IsDir(&db, i);
-
- u16string file_name = getFileName(i, temp, tempSize);
-
- if(file_name.empty()==true)
+ std::vector<size_t> blockByFolder(db.db.NumFolders, static_cast<size_t>(-1));
+ for (UInt32 i = 0; i < db.NumFiles; i++)
  {
-  return res;
- }
-
- //The file which needs to be derived is found
- bool extract=false;
- unsigned int n=0;
- u16string source1;
-
- //We look for in the list
- wstring  file_name1 = wstring(file_name.begin(), file_name.end());
+  if (SzArEx_IsDir(&db, i))
+  {
+   continue;
+  }
 
- for (std::list<wstring>::iterator it=file_list.begin(); it != file_list.end(); ++it)
-   {
-    if(*it==file_name1)
-    {
-     extract=true;
+  u16string file_name = getFileName(i, temp, tempSize);
+  if (file_name.empty())
+  {
+   return res;
+  }
 
-     break;
-    }
-    n++;
-   }
+  const wstring file_name1 = wstring(file_name.begin(), file_name.end());
+  auto it = std::find(file_list.begin(), file_list.end(), file_name1);
+  if (it == file_list.end())
+  {
+   continue;
+  }
+  std::list<wstring>::iterator it1 = path_list.begin();
+  std::advance(it1, std::distance(file_list.begin(), it));
 
+  ExtractItem item;
+  item.fileIndex = i;
+  item.destination = *it1 + L"\\" + file_name1.substr(file_name1.rfind('/') + 1);
+  std::replace(item.destination.begin(), item.destination.end(), L'/', L'\\');
 
- if(extract==true)
+  //The empty files have no data in the blocks, they are created here
+  const UInt32 folderIndex = db.FileToFolder[i];
+  if (folderIndex == static_cast<UInt32>(-1) || SzArEx_GetFileSize(&db, i) == 0)
+  {
+   Print(("Extracting " + ConvertToString(item.destination) + "\n").c_str());
+   createParentDirs(item.destination);
+   HANDLE hFile = CreateFileW(item.destination.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (hFile == INVALID_HANDLE_VALUE)
    {
-       Print("Extracting ");
-       res = PrintString(temp);
-       if (res != SZ_OK)
-       {
-           return res;
-       }
-
-       if (isDir)
-       {
-           Print("/");
-       }
-       else
-       {
-           res = SzArEx_Extract(&db, &lookStream.vt, i,
-                                &blockIndex, &outBuffer, &outBufferSize,
-                                &offset, &outSizeProcessed,
-                                &allocImp, &allocTempImp);
-
-           if (res != SZ_OK)
-           {
-               return res;
-           }
-       }
-
-       if(outSizeProcessed==0) return res;
-
-       CSzFile outFile;
-       size_t processedSize;
-       size_t j;
-       const UInt16 *destPath;
-       std::u16string  destination1;
-
-
-       //To take file name from a path
-
-       std::u16string file;
-
-       file = file_name.substr(file_name.rfind('/')+1);
+    PrintError(("can not open output file " + ConvertToString(item.destination)).c_str());
+    res = SZ_ERROR_FAIL;
+    return res;
+   }
+   CloseHandle(hFile);
+   continue;
+  }
 
-       std::u16string str;
+  if (blockByFolder[folderIndex] == static_cast<size_t>(-1))
+  {
+   blockByFolder[folderIndex] = extractBlocks.size();
+   extractBlocks.push_back(std::vector<ExtractItem>());
+  }
+  extractBlocks[blockByFolder[folderIndex]].push_back(item);
+ }
 
+ //Parentheses because of the min/max macros of Windows.h
+ unsigned int threadsCount = (std::max)(1u, std::thread::hardware_concurrency());
+ threadsCount = (std::min)(threadsCount, static_cast<unsigned int>(MAX_EXTRACT_THREADS));
+ threadsCount = (std::min)(threadsCount, static_cast<unsigned int>((std::max)(static_cast<size_t>(1), extractBlocks.size())));
 
-       std::list<wstring>::iterator it1 = path_list.begin();
-       std::advance(it1,n);
-       str = std::u16string((*it1).begin(), (*it1).end());
+ char s[32];
+ ConvertUInt32ToString(static_cast<UInt32>(extractBlocks.size()), s);
+ Print((string("Extracting ") + s + " blocks").c_str());
+ ConvertUInt32ToString(threadsCount, s);
+ Print((string(" with ") + s + " threads\n").c_str());
 
-       str.resize(str.length()+1);
-       str.back() = '/';
+ runningExtractThreads = threadsCount;
+ for (unsigned int i = 0; i < threadsCount; i++)
+ {
+  extractThreads.push_back(std::thread(&Archive::extractionThread, this));
+ }
+ return res;
+}
 
-       destination1 = str + file;
+bool Archive::waitExtraction(unsigned int timeoutMs)
+{
+ {
+  std::unique_lock<std::mutex> lock(extractMutex);
+  if (!extractFinished.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return runningExtractThreads == 0; }))
+  {
+   return false;
+  }
+ }
 
+ for (std::thread &thread : extractThreads)
+ {
+  thread.join();
+ }
+ extractThreads.clear();
+ return true;
+}
 
-       //To create folders
-       for (j = 0; j < destination1.length(); j++)
-       {
-           if ((destination1.at(j) == '/')||
-                   (destination1.at(j) == '\\'))
-           {
-               destination1.at(j) = 0;
-               MyCreateDir(reinterpret_cast<const UInt16 *>(destination1.c_str()));
-               destination1.at(j) = CHAR_PATH_SEPARATOR;
-           }
-       }
+void Archive::stopExtraction()
+{
+ {
+  std::lock_guard<std::mutex> lock(extractMutex);
+  isExtractCancelled = true;
+ }
+ for (std::thread &thread : extractThreads)
+ {
+  thread.join();
+ }
+ extractThreads.clear();
+}
 
+void Archive::setExtractError(SRes error)
+{
+ std::lock_guard<std::mutex> lock(extractMutex);
+ if (res == SZ_OK)
+ {
+  res = error;
+ }
+}
 
+bool Archive::isExtractStopped()
+{
+ std::lock_guard<std::mutex> lock(extractMutex);
+ return isExtractCancelled || res != SZ_OK;
+}
 
+void Archive::extractionThread()
+{
+ //Every thread reads the archive in memory with its own position
+ CFileInStream1 stream;
+ stream.file.pData = pData;
+ stream.file.Position = 0;
+ stream.file.Length = file_size;
+ FileInStream_CreateVTable1(&stream);
+
+ CLookToRead2 look;
+ LookToRead2_CreateVTable(&look, False);
+ look.buf = static_cast<Byte*>(ISzAlloc_Alloc(&allocImp, kInputBufSize));
+ if (!look.buf)
+ {
+  setExtractError(SZ_ERROR_MEM);
+ }
+ else
+ {
+  look.bufSize = kInputBufSize;
+  look.realStream = &stream.vt;
+  LookToRead2_Init(&look);
+
+  UInt32 blockIndex = 0xFFFFFFFF;
+  Byte *outBuffer = nullptr;
+  size_t outBufferSize = 0;
+  while (!isExtractStopped())
+  {
+   const size_t ind = nextExtractBlock++;
+   if (ind >= extractBlocks.size())
+   {
+    break;
+   }
+   SRes blockRes = extractBlock(extractBlocks[ind], &look.vt, blockIndex, outBuffer, outBufferSize);
+   if (blockRes != SZ_OK)
+   {
+    setExtractError(blockRes);
+    break;
+   }
+  }
+  ISzAlloc_Free(&allocImp, outBuffer);
+  ISzAlloc_Free(&allocImp, look.buf);
+ }
 
-       destPath =  reinterpret_cast<const UInt16 *>(destination1.c_str());
+ std::lock_guard<std::mutex> lock(extractMutex);
+ runningExtractThreads--;
+ extractFinished.notify_all();
+}
 
+void Archive::createParentDirs(const wstring &path)
+{
+ wstring dir = path;
+ for (size_t j = 0; j < dir.length(); j++)
+ {
+  if (dir[j] == L'\\')
+  {
+   dir[j] = 0;
+   CreateDirectoryW(dir.c_str(), nullptr);
+   dir[j] = L'\\';
+  }
+ }
+}
 
-       if ((isDir)&&(path_list.empty()==true))
-       {
-        MyCreateDir(destPath);
-        PrintLF();
-        return res;
-       }
-       else
-       {
-        if(OutFile_OpenUtf16(&outFile, destPath))
-         {
-          PrintString(destPath);
-          PrintError("can not open output file");
-          res = SZ_ERROR_FAIL;
-          return res;
-         }
-       }
+SRes Archive::extractBlock(const std::vector<ExtractItem> &items, ILookInStream *stream,
+                           UInt32 &blockIndex, Byte *&outBuffer, size_t &outBufferSize)
+{
+ struct PendingWrite
+ {
+  HANDLE hFile;
+  OVERLAPPED overlapped;
+  DWORD size;
+ };
 
-       processedSize = outSizeProcessed;
+ //The OVERLAPPED structures must not move until the writes complete
+ std::list<PendingWrite> writes;
+ std::vector<HANDLE> files;
+ SRes blockRes = SZ_OK;
 
-       printPercent(processedSize);
+ for (const ExtractItem &item : items)
+ {
+  size_t offset = 0;
+  size_t outSizeProcessed = 0;
+  //The first item decodes the block, the rest of them take the data from the same buffer
+  blockRes = SzArEx_Extract(&db, stream, item.fileIndex,
+                            &blockIndex, &outBuffer, &outBufferSize,
+                            &offset, &outSizeProcessed,
+                            &allocImp, &allocTempImp);
+  if (blockRes != SZ_OK)
+  {
+   PrintError("can not decode block");
+   break;
+  }
 
-       //Saving of the unpacked file
-       if((File_Write(&outFile, outBuffer + offset, &processedSize) != 0) || (processedSize != outSizeProcessed))
-       {
-        PrintError("can not write output file");
-        res = SZ_ERROR_FAIL;
-        return res;
-       }
+  Print(("Extracting " + ConvertToString(item.destination) + "\n").c_str());
 
+  createParentDirs(item.destination);
 
-       if(File_Close(&outFile))
-       {
-        PrintError("can not close output file");
-        res = SZ_ERROR_FAIL;
-        return res;
-       }
+  HANDLE hFile = CreateFileW(item.destination.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+   PrintError(("can not open output file " + ConvertToString(item.destination)).c_str());
+   blockRes = SZ_ERROR_FAIL;
+   break;
+  }
+  files.push_back(hFile);
 
+  //The size is set beforehand, so the file is allocated in one piece
+  LARGE_INTEGER fileSize;
+  fileSize.QuadPart = static_cast<LONGLONG>(outSizeProcessed);
+  if (SetFilePointerEx(hFile, fileSize, nullptr, FILE_BEGIN))
+  {
+   SetEndOfFile(hFile);
+  }
 
-       PrintLF();
+  for (size_t pos = 0; pos < outSizeProcessed; pos += WRITE_CHUNK_SIZE)
+  {
+   writes.push_back(PendingWrite());
+   PendingWrite &write = writes.back();
+   memset(&write.overlapped, 0, sizeof(write.overlapped));
+   write.hFile = hFile;
+   write.size = static_cast<DWORD>((std::min)(static_cast<size_t>(WRITE_CHUNK_SIZE), outSizeProcessed - pos));
+   write.overlapped.Offset = static_cast<DWORD>(pos);
+   write.overlapped.OffsetHigh = static_cast<DWORD>(static_cast<UInt64>(pos) >> 32);
+   write.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+   if (write.overlapped.hEvent == nullptr ||
+       (!WriteFile(hFile, outBuffer + offset + pos, write.size, nullptr, &write.overlapped) && GetLastError() != ERROR_IO_PENDING))
+   {
+    if (write.overlapped.hEvent != nullptr)
+    {
+     CloseHandle(write.overlapped.hEvent);
+    }
+    writes.pop_back();
+    PrintError(("can not write output file " + ConvertToString(item.destination)).c_str());
+    blockRes = SZ_ERROR_FAIL;
+    break;
+   }
+  }
+  if (blockRes != SZ_OK)
+  {
+   break;
+  }
+ }
 
+ //Waiting all the writes of the block, even after an error, they use the block's buffer
+ for (PendingWrite &write : writes)
+ {
+  DWORD written = 0;
+  if (!GetOverlappedResult(write.hFile, &write.overlapped, &written, TRUE) || written != write.size)
+  {
+   if (blockRes == SZ_OK)
+   {
+    PrintError("can not write output file");
+    blockRes = SZ_ERROR_FAIL;
    }
+  }
+  Completed += written;
+  CloseHandle(write.overlapped.hEvent);
+ }
 
- return res;
+ for (HANDLE hFile : files)
+ {
+  if (!CloseHandle(hFile) && blockRes == SZ_OK)
+  {
+   PrintError("can not close output file");
+   blockRes = SZ_ERROR_FAIL;
+  }
+ }
+ return blockRes;
 }
 
 bool Archive::is_finish()
@@ -59,6 +59,12 @@ typedef struct
 #include <string>
 #include <list>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 typedef struct
 {
@@ -99,7 +105,7 @@ class Archive
 
     UInt64 importantTotalUnpacked;
     UInt64 Total;
-    UInt64 Completed;
+    std::atomic<UInt64> Completed;     // the bytes written by the extraction threads
     SRes res;
 
     std::list<std::wstring> file_list;
@@ -176,7 +182,34 @@ class Archive
 
 
     std::u16string getFileName(const UInt32 &i, UInt16 *&temp, size_t &tempSize);
-    void printPercent(const size_t &processedSize);
+
+    // The selected files grouped by the solid block (folder) of the archive. The blocks are independent,
+    // each extraction thread decodes the next block with its own input stream and writes the files of the block
+    // with the overlapped I/O, the writes of the whole block are waited before its buffer is reused.
+    struct ExtractItem
+    {
+        UInt32 fileIndex;
+        std::wstring destination;
+    };
+
+    static constexpr unsigned int MAX_EXTRACT_THREADS = 8;    // each thread keeps a decoded block in memory
+    static constexpr size_t WRITE_CHUNK_SIZE = static_cast<size_t>(1) << 20;
+
+    std::vector<std::vector<ExtractItem>> extractBlocks;
+    std::atomic<size_t> nextExtractBlock;
+    std::vector<std::thread> extractThreads;
+    unsigned int runningExtractThreads;
+    bool isExtractCancelled;
+    std::mutex extractMutex;
+    std::condition_variable extractFinished;
+
+    void extractionThread();
+    SRes extractBlock(const std::vector<ExtractItem> &items, ILookInStream *stream,
+                      UInt32 &blockIndex, Byte *&outBuffer, size_t &outBufferSize);
+    void createParentDirs(const std::wstring &path);
+    void setExtractError(SRes error);
+    bool isExtractStopped();
+    void stopExtraction();
 
  public:
     Archive(const std::wstring &name);
@@ -188,7 +221,10 @@ class Archive
    //extract files[i] to path paths[i]
     void calcTotal(const std::list<std::wstring> &files, const std::list<std::wstring> &paths);
     UInt32 getNumFiles();
-    SRes extractionFile(const UInt32 &i);
+    // starts extracting the files of calcTotal() on the thread pool, the progress is reported by getPercent()
+    SRes startExtraction();
+    // true when all the threads are finished (the result is returned by finish())
+    bool waitExtraction(unsigned int timeoutMs);
     UInt64 getPercent();
     UInt64 getMaxPercent();
     bool is_finish();
@@ -37,34 +37,37 @@ int Files::executeStep()
 		fillPathList();
 
 		archive_->calcTotal(fileList_, pathList_);
-		curFileInd_ = 0;
 		state_++;
 		return 0;
 	}
-	else
+	else if (state_ == 1)
 	{
-		SRes res = archive_->extractionFile(curFileInd_);
+		SRes res = archive_->startExtraction();
 		if (res != SZ_OK)
 		{
 			archive_->finish();
 			lastError_ = L"Can't extract file.";
 			return -1;
 		}
-		else 
+		state_++;
+		return 0;
+	}
+	else
+	{
+		// the files are extracted by the archive's threads, the step only reports the progress of the written bytes
+		if (!archive_->waitExtraction(PROGRESS_INTERVAL_MS))
+		{
+			int progress = (int)(archive_->getPercent() * 100 / archive_->getMaxPercent());
+			return (std::min)(progress, 99);
+		}
+
+		SRes res = archive_->finish();
+		if (res != SZ_OK)
 		{
-			int progress = ((double)curFileInd_ / (double)archive_->getNumFiles()) * 100.0;
-
-			if (curFileInd_ >= (archive_->getNumFiles() - 1))
-			{
-				archive_->finish();
-				return 100;
-			}
-			else
-			{
-curFileInd_++;
-			}
-			return progress;
+			lastError_ = L"Can't extract file.";
+			return -1;
 		}
+		return 100;
 	}
 
 	return 100;
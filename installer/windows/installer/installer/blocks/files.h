@@ -19,10 +19,11 @@ public:
 	virtual int executeStep();
 
  private:
+   static constexpr unsigned int PROGRESS_INTERVAL_MS = 100;
+
    std::wstring installPath_;
    Archive *archive_;
    int state_;
-   unsigned int curFileInd_;
    std::list<std::wstring> fileList_;
    std::list<std::wstring> pathList_;
 
@@ -537,8 +537,9 @@ def build_installer_win32(configdata, qt_root, msvc_root, crt_root, win_cert_pas
     archive_filename = os.path.normpath(os.path.join(pathhelper.ROOT_DIR, installer_info["subdir"], "../windscribe.7z"))
     print(archive_filename)
     ziptool = os.path.join(pathhelper.TOOLS_DIR, "bin", "7z.exe")
+    # Solid blocks of 16 MB, so the installer can decode them in parallel.
     iutl.RunCommand([ziptool, "a", archive_filename, os.path.join(BUILD_INSTALLER_FILES, "*"),
-                     "-y", "-bso0", "-bsp2"])
+                     "-ms=16m", "-y", "-bso0", "-bsp2"])
     # Build and sign the installer.
     buildenv = os.environ.copy()
     buildenv.update({"MAKEFLAGS": "S"})
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# ------------------------------------------------------------------------------
+# Windscribe Build System
+# Copyright (c) 2020-2021, Windscribe Limited. All rights reserved.
+# ------------------------------------------------------------------------------
+# Purpose: makes the binary patch of an installer against the installer of a previous version,
+# applied by the auto-updater (client/engine/engine/autoupdater/updatepatch.h).
+# The patch is expected next to the new installer as "<installer url>.patch-from-<semantic version>".
+# Usage: make_update_patch.py <old installer> <new installer> <patch>
+import struct
+import sys
+import zlib
+
+PATCH_MAGIC = b"WSPATCH1"
+BLOCK_SIZE = 32
+EXTEND_CHUNK = 4096
+COMMAND_COPY = 0
+COMMAND_INSERT = 1
+MAX_COMMAND_LENGTH = 0xFFFFFFFF
+
+
+def index_blocks(old):
+    # the first offset of every aligned block
+    blocks = {}
+    for offset in range(0, len(old) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        blocks.setdefault(old[offset:offset + BLOCK_SIZE], offset)
+    return blocks
+
+
+def make_commands(old, new):
+    blocks = index_blocks(old)
+    commands = []
+    insert_start = 0
+    pos = 0
+    while pos + BLOCK_SIZE <= len(new):
+        offset = blocks.get(new[pos:pos + BLOCK_SIZE])
+        if offset is None:
+            pos += 1
+            continue
+        # extend the match back into the pending insert and forward
+        start = pos
+        while start > insert_start and offset > 0 and old[offset - 1] == new[start - 1]:
+            start -= 1
+            offset -= 1
+        end = pos + BLOCK_SIZE
+        old_end = offset + (end - start)
+        while new[end:end + EXTEND_CHUNK] == old[old_end:old_end + EXTEND_CHUNK] and end + EXTEND_CHUNK <= len(new):
+            end += EXTEND_CHUNK
+            old_end += EXTEND_CHUNK
+        while end < len(new) and old_end < len(old) and old[old_end] == new[end]:
+            end += 1
+            old_end += 1
+        if start > insert_start:
+            commands.append((COMMAND_INSERT, new[insert_start:start]))
+        commands.append((COMMAND_COPY, offset, end - start))
+        insert_start = end
+        pos = end
+    if insert_start < len(new):
+        commands.append((COMMAND_INSERT, new[insert_start:]))
+    return commands
+
+
+def encode_commands(commands):
+    parts = []
+    for command in commands:
+        if command[0] == COMMAND_COPY:
+            offset, length = command[1], command[2]
+            while length > 0:
+                chunk = min(length, MAX_COMMAND_LENGTH)
+                parts.append(struct.pack(">BQI", COMMAND_COPY, offset, chunk))
+                offset += chunk
+                length -= chunk
+        else:
+            parts.append(struct.pack(">BI", COMMAND_INSERT, len(command[1])))
+            parts.append(command[1])
+    return b"".join(parts)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: make_update_patch.py <old installer> <new installer> <patch>")
+        return 1
+    with open(sys.argv[1], "rb") as f:
+        old = f.read()
+    with open(sys.argv[2], "rb") as f:
+        new = f.read()
+    raw = encode_commands(make_commands(old, new))
+    with open(sys.argv[3], "wb") as f:
+        f.write(PATCH_MAGIC)
+        f.write(struct.pack(">Q", len(new)))
+        # the format of qCompress(): the big-endian size of the uncompressed data and the zlib stream
+        f.write(struct.pack(">I", len(raw)))
+        f.write(zlib.compress(raw, 9))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())